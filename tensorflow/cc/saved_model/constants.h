@@ -51,6 +51,10 @@ inline constexpr char kSavedModelFilenameCpb[] = "saved_model.cpb";
 // SavedModel text format proto filename.
 inline constexpr char kSavedModelFilenamePbTxt[] = "saved_model.pbtxt";
 
+// SavedModel memmapped constants package filename.
+inline constexpr char kSavedModelMemmappedConstantsFilename[] =
+    "saved_model_constants.mmap";
+
 // Subdirectory where debugging related files are written.
 inline constexpr char kSavedModelDebugDirectory[] = "debug";
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/fingerprinting.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
+#include "tensorflow/cc/saved_model/memmapped_constants.h"
 #include "tensorflow/cc/saved_model/metrics.h"
 #include "tensorflow/cc/saved_model/reader.h"
 #include "tensorflow/cc/saved_model/util.h"
@@ -268,6 +269,44 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Sets `options` to `session_options` with, if `constants_dir` is not empty,
+// the Env mapping its memmapped constants package, returned in
+// `constants_env`.
+Status GetSessionOptions(const SessionOptions& session_options,
+                         const string& constants_dir, SessionOptions* options,
+                         std::unique_ptr<Env>* constants_env) {
+  *options = session_options;
+  if (constants_dir.empty()) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(MapSavedModelConstants(constants_dir, session_options.env,
+                                            constants_env));
+  if (*constants_env != nullptr) {
+    LOG(INFO) << "Mapping the memmapped constants in " << constants_dir;
+    options->env = constants_env->get();
+  }
+  return absl::OkStatus();
+}
+
+// Returns the directory of the graph to load, which is `constants_dir` when
+// the constants are memmapped.
+const string& GraphDir(const string& export_dir, const string& constants_dir) {
+  return constants_dir.empty() ? export_dir : constants_dir;
+}
+
+// Returns `session_options` tuned for a SavedModelBundleLite.
+SessionOptions LiteSessionOptions(const SessionOptions& session_options) {
+  SessionOptions rewritten_options(session_options);
+  // We disallow calls to Session::Extend() on the returned session, so we can
+  // reduce memory consumption by not storing the original GraphDef.
+  rewritten_options.config.mutable_experimental()
+      ->set_optimize_for_static_graph(true);
+  // Disallowing the `RunOptions.output_partition_graphs` option (typically used
+  // in debugging and tests) allows us to reduce memory consumption further by
+  // not storing the rewritten subgraph for each signature.
+  rewritten_options.config.mutable_experimental()
+      ->set_disable_output_partition_graphs(true);
+  return rewritten_options;
+}
+
 }  // namespace
 
 SavedModelBundleInterface::~SavedModelBundleInterface() = default;
@@ -295,14 +334,18 @@ Status LoadGraphDefIntoSession(const SessionOptions& session_options,
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
+                              const string& constants_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
-  TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
-                                                    &bundle->meta_graph_def));
+  TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(
+      GraphDir(export_dir, constants_dir), tags, &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
-  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
-      session_options, bundle->meta_graph_def, &bundle->session));
+  SessionOptions options;
+  TF_RETURN_IF_ERROR(GetSessionOptions(session_options, constants_dir,
+                                       &options, &bundle->constants_env));
+  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(options, bundle->meta_graph_def,
+                                              &bundle->session));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return absl::OkStatus();
@@ -422,20 +465,25 @@ class LiteSessionWrapper : public Session {
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
+                              const string& constants_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundleLite* const bundle) {
   MetaGraphDef meta_graph_def;
-  TF_RETURN_IF_ERROR(
-      ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph_def));
+  TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(
+      GraphDir(export_dir, constants_dir), tags, &meta_graph_def));
+  SessionOptions options;
+  std::unique_ptr<Env> constants_env;
+  TF_RETURN_IF_ERROR(GetSessionOptions(session_options, constants_dir,
+                                       &options, &constants_env));
   std::unique_ptr<Session> session;
   TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(
-      session_options, std::move(*meta_graph_def.mutable_graph_def()),
-      &session));
+      options, std::move(*meta_graph_def.mutable_graph_def()), &session));
   TF_RETURN_IF_ERROR(
       RestoreSession(run_options, meta_graph_def, export_dir, &session));
   *bundle = SavedModelBundleLite(
       std::make_unique<LiteSessionWrapper>(std::move(session)),
-      std::move(*meta_graph_def.mutable_signature_def()));
+      std::move(*meta_graph_def.mutable_signature_def()),
+      std::move(constants_env));
   return absl::OkStatus();
 }
 
@@ -443,6 +491,7 @@ template <typename BundleType>
 Status LoadSavedModelGeneric(const SessionOptions& session_options,
                              const RunOptions& run_options,
                              const string& export_dir,
+                             const string& constants_dir,
                              const std::unordered_set<string>& tags,
                              BundleType* const bundle) {
   metrics::SavedModelReadApi(kCCLoadLabel).IncrementBy(1);
@@ -456,8 +505,8 @@ Status LoadSavedModelGeneric(const SessionOptions& session_options,
 
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status = LoadSavedModelInternal(
+      session_options, run_options, export_dir, constants_dir, tags, bundle);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -479,8 +528,9 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle) {
-  return LoadSavedModelGeneric<SavedModelBundle>(session_options, run_options,
-                                                 export_dir, tags, bundle);
+  return LoadSavedModelGeneric<SavedModelBundle>(
+      session_options, run_options, export_dir, /*constants_dir=*/"", tags,
+      bundle);
 }
 
 Status RestoreSession(const RunOptions& run_options,
@@ -518,23 +568,40 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle) {
-  SessionOptions rewritten_options(session_options);
-  // We disallow calls to Session::Extend() on the returned session, so we can
-  // reduce memory consumption by not storing the original GraphDef.
-  rewritten_options.config.mutable_experimental()
-      ->set_optimize_for_static_graph(true);
-  // Disallowing the `RunOptions.output_partition_graphs` option (typically used
-  // in debugging and tests) allows us to reduce memory consumption further by
-  // not storing the rewritten subgraph for each signature.
-  rewritten_options.config.mutable_experimental()
-      ->set_disable_output_partition_graphs(true);
   // TODO(mrry): Consider specializing the session creation to reduce peak
   // RAM consumption by using `Session::Create(GraphDef&&)`.
-  TF_RETURN_IF_ERROR(LoadSavedModelGeneric(rewritten_options, run_options,
-                                           export_dir, tags, bundle));
+  TF_RETURN_IF_ERROR(LoadSavedModelGeneric(
+      LiteSessionOptions(session_options), run_options, export_dir,
+      /*constants_dir=*/"", tags, bundle));
   return absl::OkStatus();
 }
 
+Status LoadSavedModelWithMemmappedConstants(
+    const SessionOptions& session_options, const RunOptions& run_options,
+    const string& export_dir, const string& constants_dir,
+    const std::unordered_set<string>& tags, SavedModelBundle* const bundle) {
+  if (constants_dir.empty()) {
+    return errors::InvalidArgument(
+        "No memmapped constants directory for SavedModel ", export_dir);
+  }
+  return LoadSavedModelGeneric<SavedModelBundle>(
+      session_options, run_options, export_dir, constants_dir, tags, bundle);
+}
+
+Status LoadSavedModelWithMemmappedConstants(
+    const SessionOptions& session_options, const RunOptions& run_options,
+    const string& export_dir, const string& constants_dir,
+    const std::unordered_set<string>& tags,
+    SavedModelBundleLite* const bundle) {
+  if (constants_dir.empty()) {
+    return errors::InvalidArgument(
+        "No memmapped constants directory for SavedModel ", export_dir);
+  }
+  return LoadSavedModelGeneric(LiteSessionOptions(session_options),
+                               run_options, export_dir, constants_dir, tags,
+                               bundle);
+}
+
 bool MaybeSavedModelDirectory(const string& export_dir) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
@@ -18,11 +18,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 #define TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 
+#include <memory>
 #include <string>
 #include <unordered_set>
+#include <utility>
 
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/public/session.h"
 
@@ -62,6 +65,10 @@ struct SavedModelBundle : public SavedModelBundleInterface {
     return meta_graph_def.signature_def();
   }
 
+  /// The Env of `session` mapping the memmapped constants of the SavedModel,
+  /// if it was loaded with LoadSavedModelWithMemmappedConstants(). Declared
+  /// before `session` to outlive it.
+  std::unique_ptr<Env> constants_env;
   std::unique_ptr<Session> session;
   MetaGraphDef meta_graph_def;
   std::unique_ptr<GraphDebugInfo> debug_info;
@@ -73,11 +80,22 @@ class SavedModelBundleLite : public SavedModelBundleInterface {
  public:
   SavedModelBundleLite() = default;
   SavedModelBundleLite(SavedModelBundleLite&& other) = default;
-  SavedModelBundleLite& operator=(SavedModelBundleLite&& other) = default;
+  SavedModelBundleLite& operator=(SavedModelBundleLite&& other) {
+    // Replaces the session before the Env it may use.
+    session_ = std::move(other.session_);
+    signatures_ = std::move(other.signatures_);
+    constants_env_ = std::move(other.constants_env_);
+    return *this;
+  }
 
+  /// `constants_env` is the Env of `session` mapping the memmapped constants
+  /// of the SavedModel, if it has any.
   SavedModelBundleLite(std::unique_ptr<Session> session,
-                       protobuf::Map<string, SignatureDef> signatures)
-      : session_(std::move(session)), signatures_(std::move(signatures)) {}
+                       protobuf::Map<string, SignatureDef> signatures,
+                       std::unique_ptr<Env> constants_env = nullptr)
+      : constants_env_(std::move(constants_env)),
+        session_(std::move(session)),
+        signatures_(std::move(signatures)) {}
 
   /// A TensorFlow Session does not Close itself on destruction. To avoid
   /// resource leaks, we explicitly call Close on Sessions that we create.
@@ -93,6 +111,8 @@ class SavedModelBundleLite : public SavedModelBundleInterface {
   }
 
  private:
+  // Declared before `session_` to outlive it.
+  std::unique_ptr<Env> constants_env_;
   std::unique_ptr<Session> session_;
   protobuf::Map<string, SignatureDef> signatures_;
 };
@@ -135,6 +155,20 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* bundle);
 
+/// Like LoadSavedModel(), but loads the graph written to `constants_dir` by
+/// ExternalizeSavedModelConstants() for the SavedModel in `export_dir`, whose
+/// large constants are memmapped from the package in `constants_dir` rather
+/// than parsed into heap tensors. Variables and assets are still restored from
+/// `export_dir`, which is left unchanged so any other loader can still use it.
+Status LoadSavedModelWithMemmappedConstants(
+    const SessionOptions& session_options, const RunOptions& run_options,
+    const string& export_dir, const string& constants_dir,
+    const std::unordered_set<string>& tags, SavedModelBundle* bundle);
+Status LoadSavedModelWithMemmappedConstants(
+    const SessionOptions& session_options, const RunOptions& run_options,
+    const string& export_dir, const string& constants_dir,
+    const std::unordered_set<string>& tags, SavedModelBundleLite* bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
@@ -0,0 +1,257 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/memmapped_constants.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
+
+namespace tensorflow {
+namespace {
+
+// Renames the `output` output of the nodes in `nodes` to `tensor` in the
+// function tensor name `tensor_name`, e.g. "c:output:0" to "c:tensor:0".
+void RenameConstOutput(const absl::flat_hash_set<std::string>& nodes,
+                       std::string* tensor_name) {
+  const std::vector<absl::string_view> parts =
+      absl::StrSplit(*tensor_name, ':');
+  if (parts.size() == 3 && parts[1] == "output" && nodes.contains(parts[0])) {
+    *tensor_name = absl::StrCat(parts[0], ":tensor:", parts[2]);
+  }
+}
+
+// Moves the values of large constants to a memmapped package, which is
+// created when the first one is moved.
+class ConstantExternalizer {
+ public:
+  ConstantExternalizer(Env* env, const std::string& package_path,
+                       int64_t min_bytes)
+      : env_(env), package_path_(package_path), min_bytes_(min_bytes) {}
+
+  Status Externalize(GraphDef* graph_def) {
+    for (NodeDef& node : *graph_def->mutable_node()) {
+      bool externalized;
+      TF_RETURN_IF_ERROR(MaybeExternalize(&node, &externalized));
+    }
+    for (FunctionDef& function :
+         *graph_def->mutable_library()->mutable_function()) {
+      TF_RETURN_IF_ERROR(Externalize(&function));
+    }
+    return absl::OkStatus();
+  }
+
+  // Writes the package, if any constant was moved.
+  Status Finish() {
+    if (writer_ == nullptr) return absl::OkStatus();
+    return writer_->FlushAndClose();
+  }
+
+  int num_externalized() const { return num_externalized_; }
+
+ private:
+  Status Externalize(FunctionDef* function) {
+    absl::flat_hash_set<std::string> externalized_nodes;
+    for (NodeDef& node : *function->mutable_node_def()) {
+      bool externalized;
+      TF_RETURN_IF_ERROR(MaybeExternalize(&node, &externalized));
+      if (externalized) externalized_nodes.insert(node.name());
+    }
+    if (externalized_nodes.empty()) return absl::OkStatus();
+
+    // The output of ImmutableConst is named `tensor` rather than `output`.
+    for (NodeDef& node : *function->mutable_node_def()) {
+      for (std::string& input : *node.mutable_input()) {
+        RenameConstOutput(externalized_nodes, &input);
+      }
+    }
+    for (auto& ret : *function->mutable_ret()) {
+      RenameConstOutput(externalized_nodes, &ret.second);
+    }
+    return absl::OkStatus();
+  }
+
+  Status MaybeExternalize(NodeDef* node, bool* externalized) {
+    *externalized = false;
+    if (node->op() != "Const") return absl::OkStatus();
+    // ImmutableConst only has a CPU kernel.
+    DeviceNameUtils::ParsedName device;
+    if (!node->device().empty() &&
+        DeviceNameUtils::ParseFullOrLocalName(node->device(), &device) &&
+        device.has_type && device.type != DEVICE_CPU) {
+      return absl::OkStatus();
+    }
+    const auto value = node->attr().find("value");
+    if (value == node->attr().end() || !value->second.has_tensor()) {
+      return absl::OkStatus();
+    }
+    const TensorProto& proto = value->second.tensor();
+    if (proto.dtype() == DT_STRING || proto.dtype() == DT_RESOURCE ||
+        proto.dtype() == DT_VARIANT) {
+      return absl::OkStatus();
+    }
+    // Checks the size before parsing the value.
+    const PartialTensorShape shape(proto.tensor_shape());
+    const int64_t dtype_size = DataTypeSize(proto.dtype());
+    if (dtype_size == 0 || shape.num_elements() <= 0 ||
+        shape.num_elements() < min_bytes_ / dtype_size) {
+      return absl::OkStatus();
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      return errors::InvalidArgument("Invalid value of constant ",
+                                     node->name());
+    }
+    if (tensor.TotalBytes() < min_bytes_) return absl::OkStatus();
+
+    if (writer_ == nullptr) {
+      writer_ = std::make_unique<MemmappedFileSystemWriter>();
+      TF_RETURN_IF_ERROR(writer_->InitializeToFile(env_, package_path_));
+    }
+    const std::string region_name =
+        absl::StrCat(MemmappedFileSystem::kMemmappedPackagePrefix, "const_",
+                     num_externalized_);
+    TF_RETURN_IF_ERROR(writer_->SaveTensor(tensor, region_name));
+    ++num_externalized_;
+
+    NodeDef immutable_const;
+    immutable_const.set_name(node->name());
+    immutable_const.set_op("ImmutableConst");
+    immutable_const.set_device(node->device());
+    *immutable_const.mutable_input() = node->input();
+    for (const auto& attr : node->attr()) {
+      // Keeps the internal attributes, e.g. the colocation constraints.
+      if (absl::StartsWith(attr.first, "_")) {
+        immutable_const.mutable_attr()->insert(attr);
+      }
+    }
+    AddNodeAttr("dtype", tensor.dtype(), &immutable_const);
+    AttrValue shape_attr;
+    tensor.shape().AsProto(shape_attr.mutable_shape());
+    AddNodeAttr("shape", std::move(shape_attr), &immutable_const);
+    AddNodeAttr("memory_region_name", region_name, &immutable_const);
+    if (node->has_experimental_debug_info()) {
+      *immutable_const.mutable_experimental_debug_info() =
+          node->experimental_debug_info();
+    }
+    *node = std::move(immutable_const);
+    *externalized = true;
+    return absl::OkStatus();
+  }
+
+  Env* const env_;
+  const std::string package_path_;
+  const int64_t min_bytes_;
+  std::unique_ptr<MemmappedFileSystemWriter> writer_;
+  int num_externalized_ = 0;
+};
+
+}  // namespace
+
+absl::StatusOr<int> ExternalizeConstants(Env* env,
+                                         const std::string& package_path,
+                                         int64_t min_bytes,
+                                         SavedModel* saved_model) {
+  if (min_bytes <= 0) {
+    return errors::InvalidArgument(
+        "The minimum size of the memmapped constants must be positive, got ",
+        min_bytes);
+  }
+  ConstantExternalizer externalizer(env, package_path, min_bytes);
+  for (MetaGraphDef& meta_graph : *saved_model->mutable_meta_graphs()) {
+    TF_RETURN_IF_ERROR(
+        externalizer.Externalize(meta_graph.mutable_graph_def()));
+  }
+  TF_RETURN_IF_ERROR(externalizer.Finish());
+  return externalizer.num_externalized();
+}
+
+Status ExternalizeSavedModelConstants(const std::string& export_dir,
+                                      const std::string& constants_dir,
+                                      int64_t min_bytes) {
+  if (io::CleanPath(export_dir) == io::CleanPath(constants_dir)) {
+    return errors::InvalidArgument(
+        "The memmapped constants of SavedModel ", export_dir,
+        " must be written to another directory");
+  }
+  Env* env = Env::Default();
+  const std::string package_path =
+      io::JoinPath(constants_dir, kSavedModelMemmappedConstantsFilename);
+  TF_ASSIGN_OR_RETURN(bool package_exists,
+                      internal::FileExists(env, package_path));
+  if (package_exists) {
+    return errors::AlreadyExists(constants_dir,
+                                 " already has memmapped constants");
+  }
+  SavedModel saved_model;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(
+      env, io::JoinPath(export_dir, kSavedModelFilenamePb), &saved_model));
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(constants_dir));
+  TF_ASSIGN_OR_RETURN(
+      int num_externalized,
+      ExternalizeConstants(env, package_path, min_bytes, &saved_model));
+  LOG(INFO) << "Moved " << num_externalized << " constants of SavedModel "
+            << export_dir << " to " << package_path;
+  // The rewritten graph is written even without any memmapped constant, so
+  // that `constants_dir` can always be loaded.
+  return WriteBinaryProto(
+      env, io::JoinPath(constants_dir, kSavedModelFilenamePb), saved_model);
+}
+
+Status MapSavedModelConstants(const std::string& constants_dir, Env* base_env,
+                              std::unique_ptr<Env>* env) {
+  env->reset();
+  const std::string package_path =
+      io::JoinPath(constants_dir, kSavedModelMemmappedConstantsFilename);
+  TF_ASSIGN_OR_RETURN(bool package_exists,
+                      internal::FileExists(base_env, package_path));
+  if (!package_exists) return absl::OkStatus();
+  auto memmapped_env = std::make_unique<MemmappedEnv>(base_env);
+  TF_RETURN_IF_ERROR(memmapped_env->InitializeFromFile(package_path));
+  *env = std::move(memmapped_env);
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
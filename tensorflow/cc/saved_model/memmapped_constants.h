@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Memmapped constants of SavedModels.
+//
+// The values of large constants of a SavedModel can be moved into a memmapped
+// package, written to a separate directory with a copy of saved_model.pb whose
+// `Const` nodes are replaced by `ImmutableConst` nodes reading the package.
+// LoadSavedModelWithMemmappedConstants() maps the package instead of parsing
+// the values into heap tensors, so loading is faster and the constants don't
+// use any memory until they are read, which can be shared by the processes
+// loading the same model. The original SavedModel is left unchanged, so the
+// other loaders keep working on it.
+//
+// The tensors produced by `ImmutableConst` keep the package mapped, so they
+// stay valid after the session and its Env are destroyed.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_MEMMAPPED_CONSTANTS_H_
+#define TENSORFLOW_CC_SAVED_MODEL_MEMMAPPED_CONSTANTS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+
+namespace tensorflow {
+
+// Default minimum size in bytes of the constants moved to the package.
+inline constexpr int64_t kDefaultMinMemmappedConstantBytes = 64 << 10;
+
+// Moves the values of the `Const` nodes of at least `min_bytes` in the graphs
+// and functions of `saved_model` to a memmapped package written to
+// `package_path`, and replaces the nodes by `ImmutableConst` nodes. Constants
+// of string, resource and variant types and constants placed on other devices
+// than CPU are kept. The package is only written if a constant is moved.
+//
+// Returns the number of constants moved.
+absl::StatusOr<int> ExternalizeConstants(Env* env,
+                                         const std::string& package_path,
+                                         int64_t min_bytes,
+                                         SavedModel* saved_model);
+
+// Moves the large constants of the SavedModel in `export_dir` with
+// ExternalizeConstants() to the kSavedModelMemmappedConstantsFilename package
+// in `constants_dir`, and writes the rewritten saved_model.pb next to it.
+// `export_dir` is not modified. Fails if `constants_dir` already has a
+// package or is `export_dir`.
+Status ExternalizeSavedModelConstants(
+    const std::string& export_dir, const std::string& constants_dir,
+    int64_t min_bytes = kDefaultMinMemmappedConstantBytes);
+
+// Sets `env` to an Env that maps the memmapped constants package in
+// `constants_dir` and uses `base_env` for everything else, or to null if
+// there is no package. The sessions running the rewritten graph must use
+// `env`, which must outlive them.
+Status MapSavedModelConstants(const std::string& constants_dir, Env* base_env,
+                              std::unique_ptr<Env>* env);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_MEMMAPPED_CONSTANTS_H_
@@ -0,0 +1,188 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/memmapped_constants.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64_t kMinBytes = 1024;
+
+void AddConst(const string& name, const Tensor& value,
+              protobuf::RepeatedPtrField<NodeDef>* nodes) {
+  NodeDef* node = nodes->Add();
+  node->set_name(name);
+  node->set_op("Const");
+  AddNodeAttr("dtype", value.dtype(), node);
+  AddNodeAttr("value", value, node);
+}
+
+Tensor Iota(int64_t size) {
+  Tensor tensor(DT_FLOAT, TensorShape({size}));
+  test::FillIota<float>(&tensor, 0.0f);
+  return tensor;
+}
+
+// Returns a SavedModel computing "y" = Identity("large") with a constant of
+// kMinBytes bytes "large" and a smaller constant "small".
+SavedModel MakeSavedModel() {
+  SavedModel saved_model;
+  MetaGraphDef* meta_graph = saved_model.add_meta_graphs();
+  meta_graph->mutable_meta_info_def()->add_tags(kSavedModelTagServe);
+  GraphDef* graph = meta_graph->mutable_graph_def();
+  AddConst("large", Iota(kMinBytes / sizeof(float)), graph->mutable_node());
+  AddConst("small", Iota(2), graph->mutable_node());
+  NodeDef* identity = graph->add_node();
+  identity->set_name("y");
+  identity->set_op("Identity");
+  identity->add_input("large");
+  AddNodeAttr("T", DT_FLOAT, identity);
+  return saved_model;
+}
+
+TEST(MemmappedConstantsTest, ExternalizesLargeConstants) {
+  const string package_path = io::JoinPath(testing::TmpDir(), "large.mmap");
+  SavedModel saved_model = MakeSavedModel();
+  TF_ASSERT_OK_AND_ASSIGN(
+      int num_externalized,
+      ExternalizeConstants(Env::Default(), package_path, kMinBytes,
+                           &saved_model));
+  EXPECT_EQ(num_externalized, 1);
+
+  const GraphDef& graph = saved_model.meta_graphs(0).graph_def();
+  const NodeDef& large = graph.node(0);
+  EXPECT_EQ(large.op(), "ImmutableConst");
+  EXPECT_EQ(large.attr().count("value"), 0);
+  EXPECT_EQ(large.attr().at("dtype").type(), DT_FLOAT);
+  EXPECT_EQ(graph.node(1).op(), "Const");
+
+  MemmappedEnv env(Env::Default());
+  TF_ASSERT_OK(env.InitializeFromFile(package_path));
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_ASSERT_OK(env.NewReadOnlyMemoryRegionFromFile(
+      large.attr().at("memory_region_name").s(), &region));
+  const Tensor expected = Iota(kMinBytes / sizeof(float));
+  ASSERT_EQ(region->length(), expected.TotalBytes());
+  EXPECT_EQ(memcmp(region->data(), expected.tensor_data().data(),
+                   region->length()),
+            0);
+}
+
+TEST(MemmappedConstantsTest, RenamesFunctionOutputs) {
+  const string package_path =
+      io::JoinPath(testing::TmpDir(), "function.mmap");
+  SavedModel saved_model;
+  FunctionDef* function = saved_model.add_meta_graphs()
+                              ->mutable_graph_def()
+                              ->mutable_library()
+                              ->add_function();
+  AddConst("c", Iota(kMinBytes), function->mutable_node_def());
+  NodeDef* identity = function->add_node_def();
+  identity->set_name("i");
+  identity->set_op("Identity");
+  identity->add_input("c:output:0");
+  (*function->mutable_ret())["c_out"] = "c:output:0";
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      int num_externalized,
+      ExternalizeConstants(Env::Default(), package_path, kMinBytes,
+                           &saved_model));
+  EXPECT_EQ(num_externalized, 1);
+  EXPECT_EQ(function->node_def(0).op(), "ImmutableConst");
+  EXPECT_EQ(function->node_def(1).input(0), "c:tensor:0");
+  EXPECT_EQ(function->ret().at("c_out"), "c:tensor:0");
+}
+
+TEST(MemmappedConstantsTest, NoPackageWithoutLargeConstants) {
+  const string package_path = io::JoinPath(testing::TmpDir(), "none.mmap");
+  SavedModel saved_model = MakeSavedModel();
+  TF_ASSERT_OK_AND_ASSIGN(
+      int num_externalized,
+      ExternalizeConstants(Env::Default(), package_path, 2 * kMinBytes,
+                           &saved_model));
+  EXPECT_EQ(num_externalized, 0);
+  EXPECT_FALSE(Env::Default()->FileExists(package_path).ok());
+}
+
+TEST(MemmappedConstantsTest, LoadsExternalizedConstants) {
+  const string export_dir = io::JoinPath(testing::TmpDir(), "saved_model");
+  const string constants_dir =
+      io::JoinPath(testing::TmpDir(), "saved_model_constants");
+  const string saved_model_path =
+      io::JoinPath(export_dir, kSavedModelFilenamePb);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(
+      WriteBinaryProto(Env::Default(), saved_model_path, MakeSavedModel()));
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      ExternalizeSavedModelConstants(export_dir, export_dir, kMinBytes)));
+  TF_ASSERT_OK(
+      ExternalizeSavedModelConstants(export_dir, constants_dir, kMinBytes));
+  EXPECT_TRUE(absl::IsAlreadyExists(
+      ExternalizeSavedModelConstants(export_dir, constants_dir, kMinBytes)));
+
+  // The original SavedModel is unchanged and still loads without the package.
+  SavedModel original;
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(), saved_model_path, &original));
+  EXPECT_EQ(original.meta_graphs(0).graph_def().node(0).op(), "Const");
+  EXPECT_FALSE(Env::Default()
+                   ->FileExists(io::JoinPath(
+                       export_dir, kSavedModelMemmappedConstantsFilename))
+                   .ok());
+  {
+    SavedModelBundleLite bundle;
+    TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                                {kSavedModelTagServe}, &bundle));
+  }
+
+  std::vector<Tensor> outputs;
+  {
+    SavedModelBundleLite bundle;
+    TF_ASSERT_OK(LoadSavedModelWithMemmappedConstants(
+        SessionOptions(), RunOptions(), export_dir, constants_dir,
+        {kSavedModelTagServe}, &bundle));
+    TF_ASSERT_OK(bundle.GetSession()->Run({}, {"y:0"}, {}, &outputs));
+  }
+  // The output aliases the package, which stays mapped after the bundle and
+  // its Env are destroyed.
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(outputs[0], Iota(kMinBytes / sizeof(float)));
+}
+
+}  // namespace
+}  // namespace tensorflow
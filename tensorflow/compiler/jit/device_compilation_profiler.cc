@@ -62,14 +62,12 @@ void RegisterExecutionForCluster(
 // signature before  we attempt to compile it.
 constexpr int64_t kDefaultCompilationThreshold = 2;
 
-// Maximum number of ongoing compilations.
-constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
-
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
   mutex_lock lock(mu_);
   cluster_compile_stats_.clear();
+  padded_signatures_.clear();
 }
 
 absl::StatusOr<DeviceCompilationProfiler::ClusterCompileStats>
@@ -181,7 +179,8 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
 
   if (compile_mode == DeviceCompileMode::kAsync) {
     // Asynchronous compilation is enabled.
-    if (num_ongoing_compilations_ >= kMaxNumOngoingCompilations) {
+    // Maximum number of ongoing compilations.
+    if (num_ongoing_compilations_ >= GetNumAsyncDeviceCompilerThreads()) {
       VLOG(2) << "Not asynchronously compiling cluster " << function.name()
               << " because of too many ongoing compilations.";
       return false;
@@ -198,6 +197,22 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   return reached_compile_threshold;
 }
 
+void DeviceCompilationProfiler::RegisterPaddedExecution(
+    const NameAttrList& function, const void* executable, int64_t size) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  ++it->second.padded_execution_count;
+  if (padded_signatures_[function.name()].emplace(executable, size).second) {
+    ++it->second.padded_signature_count;
+    VLOG(1) << "Padded a new input signature of " << function.name()
+            << " to a shape bucket, padded_signature_count="
+            << it->second.padded_signature_count
+            << " compile_count=" << it->second.compile_count;
+  }
+}
+
 void DeviceCompilationProfiler::IncrementOngoingAsyncCompilations() {
   mutex_lock lock(mu_);
   num_ongoing_compilations_++;
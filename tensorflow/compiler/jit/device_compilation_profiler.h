@@ -18,7 +18,10 @@ limitations under the License.
 
 #include <cstdint>
 #include <string>
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 
@@ -46,12 +49,23 @@ class DeviceCompilationProfiler : public ResourceBase {
     // tagged megamorphic, it stays megamorphic forever.
     bool is_megamorphic = false;
 
+    // The number of executions which ran on an executable compiled for inputs
+    // padded to a shape bucket.
+    int64_t padded_execution_count = 0;
+
+    // The number of distinct unpadded input signatures which ran on a padded
+    // executable. Without shape bucketing each of them would have been
+    // compiled separately.
+    int64_t padded_signature_count = 0;
+
     std::string DebugString() const {
       return absl::StrCat(
           "DeviceCompilationProfiler::ClusterCompileStats {compile_count=",
           compile_count, ", execution_count=", execution_count,
           ", cumulative_compile_time_us=", cumulative_compile_time_us,
-          ", is_megamorphic=", is_megamorphic, "}");
+          ", is_megamorphic=", is_megamorphic,
+          ", padded_execution_count=", padded_execution_count,
+          ", padded_signature_count=", padded_signature_count, "}");
     }
   };
 
@@ -78,6 +92,14 @@ class DeviceCompilationProfiler : public ResourceBase {
                                      int64_t compile_time_us,
                                      bool used_persistent_cache);
 
+  // Registers an execution of `function` on `executable`, which was compiled
+  // for inputs padded to a shape bucket, with inputs whose leading dimension is
+  // `size`. The executable and the size identify the unpadded input signature,
+  // so that the number of compilations avoided can be reported without
+  // building a signature on every execution.
+  void RegisterPaddedExecution(const NameAttrList& function,
+                               const void* executable, int64_t size);
+
   void IncrementOngoingAsyncCompilations();
   void DecrementOngoingAsyncCompilations();
   int64_t GetNumOngoingAsyncCompilations() const;
@@ -90,6 +112,12 @@ class DeviceCompilationProfiler : public ResourceBase {
   absl::flat_hash_map<std::string, ClusterCompileStats> cluster_compile_stats_
       TF_GUARDED_BY(mu_);
 
+  // Maps cluster names to the padded executables and the unpadded leading
+  // dimensions which ran on them.
+  absl::flat_hash_map<std::string,
+                      absl::flat_hash_set<std::pair<const void*, int64_t>>>
+      padded_signatures_ TF_GUARDED_BY(mu_);
+
   int64_t num_ongoing_compilations_ TF_GUARDED_BY(mu_) = 0;
 
   DeviceCompilationProfiler(const DeviceCompilationProfiler&) = delete;
@@ -15,19 +15,37 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
+#include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 
 namespace tensorflow {
 namespace {
 
+// Overrides --tf_xla_async_compilation_threads until it goes out of scope.
+class ScopedAsyncCompilationThreads {
+ public:
+  explicit ScopedAsyncCompilationThreads(int64_t num_threads)
+      : previous_(GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads) {
+    GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads = num_threads;
+  }
+  ~ScopedAsyncCompilationThreads() {
+    GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads = previous_;
+  }
+
+ private:
+  const int64_t previous_;
+};
+
 TEST(DeviceCompilationProfilerTest, RegisterExecution) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -81,6 +99,25 @@ TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   }
 }
 
+TEST(DeviceCompilationProfilerTest, RegisterPaddedExecution) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  // Three distinct unpadded signatures on two bucket executables, one of them
+  // executed twice.
+  int executable_a, executable_b;
+  profiler->RegisterPaddedExecution(function, &executable_a, /*size=*/5);
+  profiler->RegisterPaddedExecution(function, &executable_a, /*size=*/6);
+  profiler->RegisterPaddedExecution(function, &executable_a, /*size=*/6);
+  profiler->RegisterPaddedExecution(function, &executable_b, /*size=*/5);
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.padded_execution_count, 4);
+  EXPECT_EQ(stats.padded_signature_count, 3);
+}
+
 TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilations) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -212,6 +249,32 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 }
 
+TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsyncMoreThreads) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+  ScopedAsyncCompilationThreads async_compilation_threads(20);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  for (int i = 0; i < kNumAsyncDeviceCompilerThreads; ++i) {
+    profiler->IncrementOngoingAsyncCompilations();
+  }
+  profiler->RegisterExecution(function);
+  profiler->RegisterExecution(function);
+
+  // The default limit of ongoing compilations is reached, but the configured
+  // one isn't.
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+
+  for (int i = kNumAsyncDeviceCompilerThreads; i < 20; ++i) {
+    profiler->IncrementOngoingAsyncCompilations();
+  }
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterLazy) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
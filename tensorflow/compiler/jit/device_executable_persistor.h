@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/log/log.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
@@ -74,6 +77,12 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If positive, the least recently used entries with
+    // `persistence_prefix` are evicted from `persistent_cache_directory`
+    // after every save so that the entries fit in this many bytes. Lets a
+    // directory shared by many processes stay bounded.
+    int64_t persistent_cache_max_size_bytes = 0;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -137,6 +146,16 @@ class DeviceExecutablePersistor {
   absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
   TryToReadSerializedEntry(const XlaSerializedCacheKey& key) const;
 
+  // Records a use of the entry at `file_path` for LRU eviction. The entry
+  // itself is never rewritten, so its use time is kept in a sidecar file.
+  void MarkEntryUsed(const std::string& file_path) const;
+
+  // Deletes the least recently used entries in `persistent_cache_directory_`
+  // until they fit in `persistent_cache_max_size_bytes_`. Never deletes
+  // `keep_path`. Other processes may evict concurrently, so entries which
+  // disappear while scanning are skipped.
+  Status EvictEntriesIfNeeded(const std::string& keep_path) const;
+
   // Checks if the loaded `entry` matches the expected `key` and `hlo_module`.
   Status VerifyLoadedCacheEntry(const XlaSerializedCacheKey& key,
                                 const xla::HloModuleProto& hlo_module,
@@ -146,6 +165,9 @@ class DeviceExecutablePersistor {
       const XlaSerializedCacheKey& key) const;
   std::string GetFilePath(const XlaSerializedCacheKey& key) const;
 
+  // Suffix of the sidecar file which records the last use of an entry.
+  static constexpr char kUsedSuffix[] = ".used";
+
   const DeviceType device_type_;
   const bool disable_strict_signature_checks_;
   const std::string persistence_prefix_;
@@ -157,6 +179,9 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  // If positive, the size limit of the entries in the cache directory.
+  const int64_t persistent_cache_max_size_bytes_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +195,9 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      persistent_cache_max_size_bytes_(config.persistent_cache_max_size_bytes) {
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -236,10 +263,84 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  Status status = ReadTextOrBinaryProto(env, file_path, &entry);
+  if (absl::IsNotFound(status)) {
+    // Evicted by another process after the existence check.
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  TF_RETURN_IF_ERROR(status);
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType, ClientType>::MarkEntryUsed(
+    const std::string& file_path) const {
+  if (persistent_cache_max_size_bytes_ <= 0 ||
+      persistent_cache_directory_read_only_) {
+    return;
+  }
+  Status status = WriteStringToFile(Env::Default(),
+                                    absl::StrCat(file_path, kUsedSuffix), "");
+  if (!status.ok()) {
+    VLOG(1) << "Failed to record use of " << file_path << ": " << status;
+  }
+}
+
+template <typename ExecutableType, typename ClientType>
+Status
+DeviceExecutablePersistor<ExecutableType, ClientType>::EvictEntriesIfNeeded(
+    const std::string& keep_path) const {
+  struct CachedFile {
+    std::string path;
+    int64_t size;
+    int64_t last_used_nsec;
+  };
+
+  Env* env = Env::Default();
+  std::vector<std::string> paths;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+      io::JoinPath(persistent_cache_directory_,
+                   absl::StrCat(persistence_prefix_,
+                                persistence_prefix_.empty() ? "" : "__",
+                                "*.pb")),
+      &paths));
+
+  std::vector<CachedFile> files;
+  int64_t total_size = 0;
+  for (std::string& path : paths) {
+    FileStatistics stat;
+    if (!env->Stat(path, &stat).ok()) continue;
+    int64_t last_used_nsec = stat.mtime_nsec;
+    FileStatistics used_stat;
+    if (env->Stat(absl::StrCat(path, kUsedSuffix), &used_stat).ok()) {
+      last_used_nsec = std::max(last_used_nsec, used_stat.mtime_nsec);
+    }
+    total_size += stat.length;
+    files.push_back({std::move(path), stat.length, last_used_nsec});
+  }
+  if (total_size <= persistent_cache_max_size_bytes_) {
+    return absl::OkStatus();
+  }
+
+  std::sort(files.begin(), files.end(),
+            [](const CachedFile& a, const CachedFile& b) {
+              return a.last_used_nsec < b.last_used_nsec;
+            });
+  for (const CachedFile& file : files) {
+    if (total_size <= persistent_cache_max_size_bytes_) break;
+    if (file.path == keep_path) continue;
+    Status status = env->DeleteFile(file.path);
+    if (!status.ok() && !absl::IsNotFound(status)) {
+      VLOG(1) << "Failed to evict " << file.path << ": " << status;
+      continue;
+    }
+    env->DeleteFile(absl::StrCat(file.path, kUsedSuffix)).IgnoreError();
+    VLOG(2) << "Evicted persistent cache entry " << file.path;
+    total_size -= file.size;
+  }
+  return absl::OkStatus();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -306,7 +407,12 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
         "Could not create a unique file inside ", persistent_cache_directory_));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  const std::string file_path = GetFilePath(entry.key());
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_path, file_path));
+  if (persistent_cache_max_size_bytes_ > 0) {
+    TF_RETURN_IF_ERROR(EvictEntriesIfNeeded(file_path));
+  }
+  return absl::OkStatus();
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -376,6 +482,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
       VerifyLoadedCacheEntry(cache_key, hlo_module, *serialized_entry));
 
   VLOG(1) << "Loading cached entry for: " << signature_str;
+  MarkEntryUsed(GetFilePath(cache_key));
   return compiler_client->LoadExecutable(options, compilation_result,
                                          serialized_entry->executable());
 }
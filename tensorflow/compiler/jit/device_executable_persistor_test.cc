@@ -631,5 +631,45 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistEvictsEntriesOverMaxSize) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "bounded");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillRepeatedly(Return(serialized_xla_executable_));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/1, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  const std::string first_path = GetFilePath(
+      CreateCacheKey(/*signature_hash=*/1, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix()),
+      cache_dir);
+  uint64_t entry_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(first_path, &entry_size));
+
+  // Only one entry fits, so persisting a second one evicts the first.
+  config.persistent_cache_max_size_bytes = entry_size + entry_size / 2;
+  XlaDeviceExecutablePersistor bounded_persistor(
+      config, DefaultXlaOptions().device_type);
+  TF_EXPECT_OK(bounded_persistor.TryToPersistExecutable(
+      /*signature_hash=*/2, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(first_path)));
+  auto key = CreateCacheKey(/*signature_hash=*/2, compilation_result_add_,
+                            persistor.device_type(),
+                            persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, cache_dir));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
 }  // namespace
 }  // namespace tensorflow
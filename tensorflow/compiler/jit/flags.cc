@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/flags.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <mutex>  // NOLINT
 #include <optional>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
@@ -88,6 +91,22 @@ bool SetterForXlaCallModuleDisabledChecks(const string& value) {
   return true;
 }
 
+bool SetterForXlaShapeBuckets(const string& value) {
+  std::vector<int64_t> buckets;
+  for (absl::string_view bucket :
+       absl::StrSplit(value, ',', absl::SkipEmpty())) {
+    int64_t size;
+    if (!absl::SimpleAtoi(bucket, &size) || size <= 0) {
+      return false;
+    }
+    buckets.push_back(size);
+  }
+  absl::c_sort(buckets);
+  buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+  ops_flags->tf_xla_shape_buckets = std::move(buckets);
+  return true;
+}
+
 void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
   std::vector<Flag> new_flags = {
       Flag("tf_xla_auto_jit", SetterForXlaAutoJitFlag, "0",
@@ -108,6 +127,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_min_cluster_size_per_boundary_tensor",
+           &mark_for_compilation_flags
+                ->tf_xla_min_cluster_size_per_boundary_tensor,
+           "If positive, minimum number of operators in an XLA compilation "
+           "per tensor entering or leaving it, counting tensors that cross "
+           "devices twice. Ignored for operators placed on an XLA device or "
+           "operators explicitly marked for compilation."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -175,6 +201,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_persistent_cache_max_size_bytes",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_max_size_bytes,
+           "If positive, the least recently used entries of the persistent "
+           "cache are evicted to keep the cache directory under this many "
+           "bytes. Safe to use with many processes sharing one directory."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -228,6 +259,8 @@ void AllocateAndParseFlags() {
       0;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_general = 0;
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
+  mark_for_compilation_flags->tf_xla_min_cluster_size_per_boundary_tensor =
+      0.0;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
@@ -245,6 +278,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_persistent_cache_max_size_bytes = 0;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -263,6 +297,8 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_async_compilation_threads = 0;
+  ops_flags->tf_xla_donate_input_buffers = false;
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +370,26 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_async_compilation_threads",
+            &ops_flags->tf_xla_async_compilation_threads,
+            "The number of threads used for asynchronous compilation, which "
+            "also bounds the number of clusters compiled in the background at "
+            "once. Raising it shortens the time spent on the fallback path "
+            "when many clusters are first executed together, e.g. after a "
+            "deployment. 0 uses the default of 10."),
+       Flag("tf_xla_shape_buckets", SetterForXlaShapeBuckets, "",
+            "A comma-separated list of sizes. When set, the leading dimension "
+            "of XLA cluster inputs is padded up to the smallest size in the "
+            "list which holds it, and outputs are sliced back, so that inputs "
+            "with different leading dimensions reuse one executable. Only "
+            "sound for clusters which are independent across the leading "
+            "dimension. Disabled by default."),
+       Flag("tf_xla_donate_input_buffers",
+            &ops_flags->tf_xla_donate_input_buffers,
+            "If true, XLA cluster outputs may alias inputs of the same shape, "
+            "and inputs which are not used after the cluster donate their "
+            "buffers to the outputs. Reduces peak device memory, but costs a "
+            "copy for aliased inputs which are still in use."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
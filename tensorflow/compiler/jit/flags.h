@@ -62,6 +62,13 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If positive, minimum number of operators in an XLA compilation per tensor
+  // entering or leaving it. Tensors produced or consumed on another device
+  // count twice since they imply a transfer. Rejects small clusters whose
+  // launch and transfer overhead outweighs the benefit of compiling them.
+  // Ignored like `tf_xla_min_cluster_size`.
+  float tf_xla_min_cluster_size_per_boundary_tensor;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -111,6 +118,11 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If positive, least recently used entries are evicted from the persistent
+  // cache directory to keep it under this many bytes. Defaults to 0 (no
+  // limit).
+  int64_t tf_xla_persistent_cache_max_size_bytes;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -151,6 +163,21 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // The number of threads compiling clusters asynchronously, which also bounds
+  // the number of ongoing asynchronous compilations. 0 (the default) uses
+  // kNumAsyncDeviceCompilerThreads.
+  int64_t tf_xla_async_compilation_threads;
+  // Sorted sizes to which the leading dimension of cluster inputs is padded
+  // before compilation, so that inputs with different leading dimensions share
+  // an executable. Outputs are sliced back to the actual size. Only sound for
+  // clusters whose computation is independent across the leading dimension.
+  // Empty (the default) disables bucketing.
+  std::vector<int64_t> tf_xla_shape_buckets;
+  // If true, clusters are compiled with their outputs aliasing inputs of the
+  // same shape, and input tensors nothing else references are donated to the
+  // outputs instead of allocating new buffers. Defaults to false, since an
+  // aliased input which is still referenced costs a device-to-device copy.
+  bool tf_xla_donate_input_buffers;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -105,12 +107,14 @@ class ExecutableClosure {
   explicit ExecutableClosure(
       ClientType* client, ExecutableType* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      std::optional<ShapeBucket> shape_bucket = std::nullopt)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        shape_bucket_(shape_bucket) {}
 
   ExecutableClosure(ExecutableClosure&&) = default;
   ExecutableClosure& operator=(ExecutableClosure&&) = default;
@@ -124,6 +128,9 @@ class ExecutableClosure {
     return resource_var_snapshots_;
   }
   int num_constant_args() const { return num_constant_args_; }
+  const std::optional<ShapeBucket>& shape_bucket() const {
+    return shape_bucket_;
+  }
 
  private:
   ClientType* client_;
@@ -131,6 +138,7 @@ class ExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  std::optional<ShapeBucket> shape_bucket_;
 
   ExecutableClosure(const ExecutableClosure&) = delete;
   void operator=(const ExecutableClosure&) = delete;
@@ -373,7 +381,8 @@ Status CompileToLocalExecutable(
     DeviceCompileMode compile_mode, bool may_alias_resource_update,
     xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable,
+    std::optional<ShapeBucket>* shape_bucket = nullptr) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -414,6 +423,34 @@ Status CompileToLocalExecutable(
   XlaCompiler::CompileOptions compile_options =
       GenerateCompileOptions(has_ref_vars, may_alias_resource_update);
 
+  // With shape buckets configured, first try the executable compiled for the
+  // args padded to their bucket. It is only usable if its outputs can be sliced
+  // back; otherwise fall back to compiling for the unpadded args.
+  const std::vector<int64_t>& buckets =
+      GetXlaOpsCommonFlags()->tf_xla_shape_buckets;
+  if (shape_bucket != nullptr && !buckets.empty() &&
+      !platform_info.is_on_xla_device()) {
+    *shape_bucket = std::nullopt;
+    std::vector<XlaCompiler::Argument> padded_args = args;
+    if (std::optional<ShapeBucket> bucket =
+            PadArgumentsToShapeBucket(buckets, padded_args)) {
+      TF_RETURN_IF_ERROR(xla_device_compiler->CompileIfNeeded(
+          options, function, padded_args, compile_options, compile_mode,
+          profiler, compilation_result, executable));
+      // Lazy or asynchronous compilation of the bucket hasn't happened yet.
+      if (*compilation_result == nullptr) return absl::OkStatus();
+      if (*executable != nullptr &&
+          CanSliceOutputsFromShapeBucket(**compilation_result, *bucket)) {
+        profiler->RegisterPaddedExecution(function, *executable, bucket->size);
+        *shape_bucket = bucket;
+        return absl::OkStatus();
+      }
+      VLOG(1) << "Outputs of " << function.name()
+              << " can't be sliced from shape bucket " << bucket->bucket_size
+              << ", compiling for the unpadded arguments.";
+    }
+  }
+
   return xla_device_compiler->CompileIfNeeded(
       options, function, args, compile_options, compile_mode, profiler,
       compilation_result, executable);
@@ -569,16 +606,17 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     return;
   }
 
+  std::optional<ShapeBucket> shape_bucket;
   Status status = CompileToLocalExecutable(
       ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
       xla_compiler_args, DeviceCompileMode::kStrict,
       /*may_alias_resource_update=*/true, &client, &compilation_result,
-      &executable);
+      &executable, &shape_bucket);
   OP_REQUIRES_OK_ASYNC(ctx, status, done);
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, resources = resources_, shape_bucket]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -600,6 +638,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
           GetAllocator(ctx->device(), GetStream(ctx), platform_info);
       XlaComputationLaunchContext launch_context =
           GetLaunchContext(platform_info, ctx, client, allocator.get());
+      launch_context.set_shape_bucket(shape_bucket);
 
       const xla::HloInputOutputAliasConfig& input_output_alias =
           executable->executable()->module().input_output_alias_config();
@@ -742,6 +781,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   xla::PjRtClient* pjrt_client = nullptr;
   xla::PjRtLoadedExecutable* pjrt_executable = nullptr;
   ResourceVarsSnapshot variables_snapshot;
+  std::optional<ShapeBucket> shape_bucket;
 
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
   bool cannot_compile_cluster;
@@ -787,7 +827,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          /*may_alias_resource_update=*/false, &client, &kernel, &executable,
+          &shape_bucket);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -840,7 +881,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     XlaExecutableClosureStore::KeyT key =
         XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
             client, executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            constants_.size(), shape_bucket));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with XLA. compilation_key: " << key;
   }
@@ -908,6 +949,7 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       GetAllocator(ctx->device(), GetStream(ctx), platform_info_);
   XlaComputationLaunchContext launch_context =
       GetLaunchContext(platform_info_, ctx, closure.client(), allocator.get());
+  launch_context.set_shape_bucket(closure.shape_bucket());
 
   // We're missing the must-be-constant inputs, tell `PopulateInputs`
   // about this.  We don't actually need these inputs because they've
@@ -112,6 +112,11 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If positive, clusters need at least this many effective nodes per
+    // (weighted) tensor crossing their boundary.  See
+    // `CountClusterBoundaryTensors`.
+    float min_cluster_size_per_boundary_tensor;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -311,6 +316,12 @@ class MarkForCompilationPassImpl {
   // tf_xla_min_cluster_size, are applied here.
   Status CreateClusters();
 
+  // Estimates the launch overhead of every cluster by counting the distinct
+  // tensors flowing into and out of it.  A tensor which is produced or
+  // consumed on a different device counts twice, since it also implies a
+  // transfer between devices (often a host transfer).
+  absl::flat_hash_map<const Cluster*, int> CountClusterBoundaryTensors();
+
   Status DumpDebugInfo();
 
   bool IsCompilationCandidate(Node* n) const {
@@ -970,10 +981,16 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
   }
 
+  absl::flat_hash_map<const Cluster*, int> boundary_tensors;
+  if (debug_options_.min_cluster_size_per_boundary_tensor > 0) {
+    boundary_tensors = CountClusterBoundaryTensors();
+  }
+
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
-  // * have more than debug_options_.xla_min_cluster_size elements (applicable
+  // * have more than debug_options_.xla_min_cluster_size elements, and enough
+  //   elements to amortize the tensors crossing their boundary (applicable
   //   only if compilation is enabled, otherwise there will be no such
   //   candidates).
   for (Node* n : compilation_candidates_) {
@@ -989,7 +1006,16 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
-    if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
+    // Clusters with no tensor crossing their boundary have no entry.
+    auto boundary_it = boundary_tensors.find(cluster);
+    const int num_boundary_tensors =
+        boundary_it != boundary_tensors.end() ? boundary_it->second : 0;
+    const bool amortizes_boundary =
+        cluster->effective_cluster_size() >=
+        debug_options_.min_cluster_size_per_boundary_tensor *
+            num_boundary_tensors;
+    if ((cluster->effective_cluster_size() >= debug_options_.min_cluster_size &&
+         amortizes_boundary) ||
         cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
       string& name = cluster_names[cluster->cycles_graph_node_id()];
@@ -1016,6 +1042,44 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   return absl::OkStatus();
 }
 
+absl::flat_hash_map<const MarkForCompilationPassImpl::Cluster*, int>
+MarkForCompilationPassImpl::CountClusterBoundaryTensors() {
+  auto cluster_of = [&](Node* n) -> const Cluster* {
+    if (!IsCompilationCandidate(n) || declustered_nodes_.contains(n)) {
+      return nullptr;
+    }
+    return GetClusterForNode(n);
+  };
+  auto device_of = [](const Node* n) -> const string& {
+    return !n->assigned_device_name().empty() ? n->assigned_device_name()
+                                              : n->requested_device();
+  };
+
+  // Tensors are identified by (node id, output index).
+  absl::flat_hash_map<const Cluster*, absl::flat_hash_set<std::pair<int, int>>>
+      inputs, outputs;
+  absl::flat_hash_map<const Cluster*, int> boundary_tensors;
+  for (Node* n : compilation_candidates_) {
+    const Cluster* cluster = cluster_of(n);
+    if (cluster == nullptr) continue;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge() || cluster_of(e->src()) == cluster) continue;
+      if (inputs[cluster].insert({e->src()->id(), e->src_output()}).second) {
+        boundary_tensors[cluster] +=
+            device_of(e->src()) == device_of(n) ? 1 : 2;
+      }
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || cluster_of(e->dst()) == cluster) continue;
+      if (outputs[cluster].insert({n->id(), e->src_output()}).second) {
+        boundary_tensors[cluster] +=
+            device_of(e->dst()) == device_of(n) ? 1 : 2;
+      }
+    }
+  }
+  return boundary_tensors;
+}
+
 Status MarkForCompilationPassImpl::DumpDebugInfo() {
   TF_RET_CHECK(initialized_ && edges_contracted_ && clusters_created_);
 
@@ -1922,6 +1986,8 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.min_cluster_size_per_boundary_tensor =
+      flags->tf_xla_min_cluster_size_per_boundary_tensor;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1941,6 +2007,8 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.min_cluster_size_per_boundary_tensor =
+      flags->tf_xla_min_cluster_size_per_boundary_tensor;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -142,6 +143,39 @@ TEST(XlaCompilationTest, Chains) {
   EXPECT_TRUE(clusters.find("D") == clusters.cend());
 }
 
+TEST(XlaCompilationTest, RejectClustersDominatedByBoundaryTensors) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  {
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a =
+        ops::SourceOp("UncompilableNullary", builder.opts().WithName("A"));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    Node* c = ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+    Node* d =
+        ops::UnaryOp("UncompilableUnary", c, builder.opts().WithName("D"));
+    Node* e = ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    Node* f = ops::UnaryOp("Relu", e, builder.opts().WithName("F"));
+    Node* g = ops::UnaryOp("Relu", f, builder.opts().WithName("G"));
+    ops::UnaryOp("Relu", g, builder.opts().WithName("H"));
+    TF_EXPECT_OK(GraphDefBuilderToGraph(builder, graph.get()));
+  }
+
+  // {B, C} has two ops for two boundary tensors, {E, F, G, H} has four ops for
+  // one boundary tensor.
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const float old_value = flags->tf_xla_min_cluster_size_per_boundary_tensor;
+  flags->tf_xla_min_cluster_size_per_boundary_tensor = 2.0;
+  auto status = MarkForCompilationPassTestHelper::MarkForCompilation(&graph);
+  flags->tf_xla_min_cluster_size_per_boundary_tensor = old_value;
+  TF_ASSERT_OK(status);
+
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(4, clusters.size());
+  EXPECT_TRUE(clusters.find("B") == clusters.cend());
+  EXPECT_TRUE(clusters.find("C") == clusters.cend());
+  EXPECT_EQ(clusters["E"], clusters["H"]);
+}
+
 TEST(XlaCompilationTest, UncompilableCycles) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   {
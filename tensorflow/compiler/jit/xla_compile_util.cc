@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -77,6 +78,12 @@ absl::StatusOr<std::unique_ptr<Graph>> CreateSingleOpGraph(
   return graph;
 }
 
+int64_t GetNumAsyncDeviceCompilerThreads() {
+  const int64_t num_threads =
+      GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads;
+  return num_threads > 0 ? num_threads : kNumAsyncDeviceCompilerThreads;
+}
+
 bool UsePjRtForSingleDeviceCompilation(const DeviceType& device_type) {
   const auto& rollout_config = GetXlaOpsCommonFlags()->tf_xla_use_device_api;
   return rollout_config.IsEnabledInXlaLaunchForDevice(device_type) ||
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILE_UTIL_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILE_UTIL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -23,7 +24,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 
 namespace tensorflow {
-// The number of compiler threads to use for asynchronous device compilation.
+// The default number of compiler threads to use for asynchronous device
+// compilation.
 inline constexpr int64_t kNumAsyncDeviceCompilerThreads = 10;
 
 enum class DeviceCompileMode {
@@ -45,6 +47,10 @@ absl::StatusOr<std::unique_ptr<Graph>> CreateSingleOpGraph(
     const NodeDef& node_def, absl::Span<const XlaArgument> args,
     absl::Span<const DataType> result_types);
 
+// Returns the number of compiler threads to use for asynchronous device
+// compilation, as set by `tf_xla_async_compilation_threads`.
+int64_t GetNumAsyncDeviceCompilerThreads();
+
 // Checks if single device compilation and execution with PJRT is enabled for
 // `device_type` in either the XlaLaunch op or the XlaCompileOnDemand op.
 bool UsePjRtForSingleDeviceCompilation(const DeviceType& device_type);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -27,6 +28,22 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Sets --tf_xla_async_compilation_threads, and restores its previous value on
+// destruction.
+class ScopedAsyncCompilationThreads {
+ public:
+  explicit ScopedAsyncCompilationThreads(int64_t num_threads)
+      : previous_(GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads) {
+    GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads = num_threads;
+  }
+  ~ScopedAsyncCompilationThreads() {
+    GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads = previous_;
+  }
+
+ private:
+  const int64_t previous_;
+};
+
 TEST_F(OpsTestBase, CreateSingleOpGraph) {
   TF_EXPECT_OK(NodeDefBuilder("identity_op", "Identity")
                    .Input(FakeInput(DT_FLOAT))
@@ -119,6 +136,16 @@ TEST(XlaCompileUtilTest, PjRtXlaCompileOnDemandFlagTest) {
   EXPECT_FALSE(UsePjRtForSingleDeviceCompilation(DeviceType(DEVICE_CPU)));
 }
 
+TEST(XlaCompileUtilTest, NumAsyncDeviceCompilerThreads) {
+  EXPECT_EQ(GetNumAsyncDeviceCompilerThreads(), kNumAsyncDeviceCompilerThreads);
+
+  {
+    ScopedAsyncCompilationThreads async_compilation_threads(32);
+    EXPECT_EQ(GetNumAsyncDeviceCompilerThreads(), 32);
+  }
+  EXPECT_EQ(GetNumAsyncDeviceCompilerThreads(), kNumAsyncDeviceCompilerThreads);
+}
+
 TEST(XlaCompileUtilTest, PjRtDeviceCompilerResourceName) {
   EXPECT_EQ(GetPjRtDeviceCompilerResourceName(DeviceType(DEVICE_TPU)),
             "pjrt_device_compiler_TPU");
@@ -336,5 +336,24 @@ TEST_F(XlaCompilerOptionsTest, GenerateCompileOptions) {
   EXPECT_FALSE(option4.alias_resource_update);
 }
 
+TEST_F(XlaCompilerOptionsTest, GenerateCompileOptionsDonateInputBuffers) {
+  EXPECT_FALSE(GenerateCompileOptions(/*has_ref_vars=*/false,
+                                      /*may_alias_resource_update=*/true)
+                   .alias_parameters_with_outputs);
+
+  GetXlaOpsCommonFlags()->tf_xla_donate_input_buffers = true;
+  XlaCompiler::CompileOptions option1 = GenerateCompileOptions(
+      /*has_ref_vars=*/false, /*may_alias_resource_update=*/true);
+  XlaCompiler::CompileOptions option2 = GenerateCompileOptions(
+      /*has_ref_vars=*/false, /*may_alias_resource_update=*/false);
+  XlaCompiler::CompileOptions option3 = GenerateCompileOptions(
+      /*has_ref_vars=*/true, /*may_alias_resource_update=*/true);
+  GetXlaOpsCommonFlags()->tf_xla_donate_input_buffers = false;
+
+  EXPECT_TRUE(option1.alias_parameters_with_outputs);
+  EXPECT_FALSE(option2.alias_parameters_with_outputs);
+  EXPECT_FALSE(option3.alias_parameters_with_outputs);
+}
+
 }  // namespace
 }  // namespace tensorflow
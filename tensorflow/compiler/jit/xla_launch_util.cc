@@ -16,10 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <set>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -35,6 +37,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
+#include "xla/layout_util.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/pjrt_stream_executor_client.h"
@@ -112,6 +115,61 @@ absl::StatusOr<std::vector<int>> GetConstantInputIndicesFromContext(
   return constant_input_indices;
 }
 
+std::optional<ShapeBucket> PadArgumentsToShapeBucket(
+    absl::Span<const int64_t> buckets,
+    std::vector<XlaCompiler::Argument>& args) {
+  std::optional<int64_t> size;
+  for (const XlaCompiler::Argument& arg : args) {
+    if (arg.kind == XlaCompiler::Argument::kResource) return std::nullopt;
+    if (arg.kind != XlaCompiler::Argument::kParameter) continue;
+    const TensorShape* shape = std::get_if<TensorShape>(&arg.shape);
+    if (shape == nullptr || shape->dims() == 0) return std::nullopt;
+    if (size.has_value() && *size != shape->dim_size(0)) return std::nullopt;
+    size = shape->dim_size(0);
+  }
+  if (!size.has_value()) return std::nullopt;
+
+  auto bucket = absl::c_lower_bound(buckets, *size);
+  if (bucket == buckets.end() || *bucket == *size) return std::nullopt;
+
+  for (XlaCompiler::Argument& arg : args) {
+    if (arg.kind != XlaCompiler::Argument::kParameter) continue;
+    std::get<TensorShape>(arg.shape).set_dim(0, *bucket);
+  }
+  return ShapeBucket{*size, *bucket};
+}
+
+// Returns true if `shape` is an array whose leading dimension is major-most,
+// so that a prefix of its buffer holds a prefix of its leading dimension.
+static bool IsLeadingDimensionMajor(const xla::Shape& shape) {
+  return shape.IsArray() && shape.rank() > 0 &&
+         (!shape.has_layout() ||
+          xla::LayoutUtil::IsMonotonicWithDim0Major(shape.layout()));
+}
+
+bool CanSliceOutputsFromShapeBucket(
+    const XlaCompiler::CompilationResult& compilation_result,
+    const ShapeBucket& bucket) {
+  if (!compilation_result.resource_updates.empty()) return false;
+  for (const XlaOutputDescription& output : compilation_result.outputs) {
+    if (output.is_constant || output.type == DT_RESOURCE ||
+        output.shape.dims() == 0 ||
+        output.shape.dim_size(0) != bucket.bucket_size) {
+      return false;
+    }
+  }
+  const xla::Shape& output_shape = compilation_result.xla_output_shape;
+  if (output_shape.IsTuple()) {
+    for (const xla::Shape& shape : output_shape.tuple_shapes()) {
+      if (!IsLeadingDimensionMajor(shape)) return false;
+    }
+  } else if (!IsLeadingDimensionMajor(output_shape)) {
+    return false;
+  }
+  return absl::c_all_of(compilation_result.xla_input_shapes,
+                        IsLeadingDimensionMajor);
+}
+
 XlaComputationLaunchContext::XlaComputationLaunchContext(
     xla::LocalClient* client, se::DeviceMemoryAllocator* xla_allocator,
     int device_ordinal, bool allocate_xla_tensors, bool use_multiple_streams)
@@ -126,6 +184,43 @@ XlaComputationLaunchContext::XlaComputationLaunchContext(
   }
 }
 
+// Returns `t`'s buffer grown to `size` bytes if the allocation backing `t`
+// starts at its data and has room for them. This holds for the outputs of
+// executions on a shape bucket, which are slices of a padded buffer, so chained
+// clusters on the same bucket don't copy their inputs. The rows past `t` hold
+// whatever the earlier execution computed for its padding, which is sound for
+// the clusters shape buckets are for, as they are independent across the
+// leading dimension.
+static std::optional<se::DeviceMemoryBase> GetPaddedBufferInPlace(
+    const Tensor& t, uint64_t size) {
+  const TensorBuffer* buffer = DMAHelper::buffer(&t);
+  if (buffer == nullptr) return std::nullopt;
+  TensorBuffer* root = const_cast<TensorBuffer*>(buffer)->root_buffer();
+  if (root->data() != t.data() || root->size() < size) return std::nullopt;
+  return se::DeviceMemoryBase(root->data(), size);
+}
+
+// Returns a new buffer of `size` bytes holding `buffer` followed by zeros.
+static absl::StatusOr<se::OwningDeviceMemory> PadBuffer(
+    se::DeviceMemoryBase buffer, uint64_t size, se::Stream* stream,
+    int device_ordinal, se::DeviceMemoryAllocator* allocator) {
+  TF_RET_CHECK(buffer.size() <= size);
+  TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory padded,
+                      allocator->Allocate(device_ordinal, size));
+  se::DeviceMemoryBase dst = *padded;
+  se::DeviceMemoryBase tail =
+      dst.GetByteSlice(buffer.size(), size - buffer.size());
+  if (stream == nullptr) {
+    // Host platform: device memory is host memory.
+    std::memcpy(dst.opaque(), buffer.opaque(), buffer.size());
+    std::memset(tail.opaque(), 0, tail.size());
+  } else {
+    TF_RETURN_IF_ERROR(stream->Memcpy(&dst, buffer, buffer.size()));
+    TF_RETURN_IF_ERROR(stream->MemZero(&tail, tail.size()));
+  }
+  return padded;
+}
+
 // Fills in `execution_input` with `buffer` for `index`.
 static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
                                          xla::ShapeIndex index,
@@ -179,8 +274,13 @@ XlaComputationLaunchContext::PopulateInputs(
                           ? resource_var_it->second
                           : &(ctx->input(arg_num - missing_ctx_input_prefix));
     CHECK(t);
+    // Inputs which are not resource variables are only aliased with outputs
+    // if the computation was compiled with `alias_parameters_with_outputs`.
     bool donate_buffer =
-        t->RefCountIsOne() && is_updated_resource_variable &&
+        t->RefCountIsOne() &&
+        (is_updated_resource_variable ||
+         (!is_resource_variable &&
+          !ctx->input_is_ref(arg_num - missing_ctx_input_prefix))) &&
         input_output_alias.ParameterHasAlias(i, xla::ShapeIndex{});
     VLOG(3) << "Processing input: " << i
             << "; is_resource_variable=" << is_resource_variable
@@ -199,6 +299,28 @@ XlaComputationLaunchContext::PopulateInputs(
     arguments.emplace_back(device_shape, host_shape);
     xla::ExecutionInput& execution_input = arguments.back();
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
+    if (shape_bucket_.has_value() && !is_resource_variable) {
+      TF_RET_CHECK(t->dims() > 0 && t->dim_size(0) == shape_bucket_->size &&
+                   device_shape.dimensions(0) == shape_bucket_->bucket_size);
+      const uint64_t padded_size = xla::ShapeUtil::ByteSizeOf(device_shape);
+      if (std::optional<se::DeviceMemoryBase> padded =
+              GetPaddedBufferInPlace(*t, padded_size)) {
+        // The buffer starts at `t`'s data, so that a donated buffer aliased
+        // with an output is recognized by GetOrCreateTensorForOutput.
+        dmem = *padded;
+      } else {
+        // The padded copy is owned and so donated to the execution, which
+        // frees it unless it reuses it for an output.
+        TF_ASSIGN_OR_RETURN(
+            *execution_input.MutableBuffer(xla::ShapeIndex{}),
+            PadBuffer(dmem, padded_size,
+                      ctx->op_device_context()
+                          ? ctx->op_device_context()->stream()
+                          : nullptr,
+                      device_ordinal_, xla_allocator_));
+        continue;
+      }
+    }
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                  donate_buffer, device_ordinal_,
                                  xla_allocator_);
@@ -462,6 +584,10 @@ Status XlaComputationLaunchContext::PopulateOutputs(
               resource_vars, ctx->expected_output_dtype(i), shape, allocator,
               allocate_xla_tensors_, stream, use_multiple_streams_,
               definition_event));
+      if (shape_bucket_.has_value()) {
+        // Drops the rows computed for padding; shares the buffer.
+        output_tensor = output_tensor.Slice(0, shape_bucket_->size);
+      }
       ctx->set_output(i, output_tensor);
       ++output_num;
     }
@@ -880,6 +1006,15 @@ Status RunPjRtExecutable(
 
     TF_ASSIGN_OR_RETURN(absl::string_view fingerprint,
                         executable->FingerprintExecutable());
+    // Lets the selector avoid the devices that are low on memory.
+    absl::StatusOr<tsl::AllocatorStats> allocator_stats =
+        device->GetAllocatorStats();
+    if (allocator_stats.ok() && allocator_stats->bytes_limit.has_value()) {
+      device_selector_resource->selector()->UpdateFreeMemory(
+          pjrt_device_id,
+          *allocator_stats->bytes_limit - allocator_stats->bytes_in_use,
+          *allocator_stats->bytes_limit);
+    }
     device_selector_resource->selector()->Enqueue(pjrt_device_id, fingerprint);
   }
   TF_ASSIGN_OR_RETURN(
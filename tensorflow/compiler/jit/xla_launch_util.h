@@ -18,13 +18,16 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_UTIL_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_UTIL_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <vector>
 
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/xla_tensor.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
 #include "xla/pjrt/pjrt_client.h"
@@ -152,6 +155,29 @@ absl::StatusOr<std::vector<std::unique_ptr<xla::PjRtBuffer>>> RunPjRtExecutable(
     xla::PjRtDevice* device, xla::PjRtClient* pjrt_client,
     xla::PjRtLoadedExecutable* executable);
 
+// Describes an execution whose inputs have a leading dimension of `size`, run
+// on an executable compiled for inputs padded to `bucket_size`.
+struct ShapeBucket {
+  int64_t size;
+  int64_t bucket_size;
+};
+
+// Pads the leading dimension of the parameters in `args` up to the smallest of
+// the sorted `buckets` which holds it. Leaves `args` untouched and returns
+// std::nullopt unless there are no resource arguments, all parameters share
+// the same leading dimension and that dimension needs padding.
+std::optional<ShapeBucket> PadArgumentsToShapeBucket(
+    absl::Span<const int64_t> buckets,
+    std::vector<XlaCompiler::Argument>& args);
+
+// Returns true if the outputs of `compilation_result`, compiled for arguments
+// padded to `bucket`, can be sliced back to `bucket.size`: there must be no
+// resource updates and every output must be a computed, row-major tensor whose
+// leading dimension is `bucket.bucket_size`.
+bool CanSliceOutputsFromShapeBucket(
+    const XlaCompiler::CompilationResult& compilation_result,
+    const ShapeBucket& bucket);
+
 // Helper class to perform the marshalling of TensorFlow inputs and outputs to
 // ShapedBuffers suitable for passing to an XLA computation.
 class XlaComputationLaunchContext {
@@ -178,6 +204,16 @@ class XlaComputationLaunchContext {
                             absl::Span<VariableInfo const> variable_args,
                             Device* device);
 
+  // Makes PopulateInputs pad the leading dimension of inputs to
+  // `bucket.bucket_size` and PopulateOutputs slice outputs back to
+  // `bucket.size`. Inputs whose allocation already has room for the padding,
+  // such as the outputs of an earlier execution on the same bucket, are passed
+  // in place, and may be donated. Not supported with XLA tensors.
+  void set_shape_bucket(std::optional<ShapeBucket> bucket) {
+    CHECK(!bucket.has_value() || !allocate_xla_tensors_);
+    shape_bucket_ = bucket;
+  }
+
   // Add all inputs within `ctx` as XLA arguments (returned by arguments()).
   // `variables` is a map from TensorFlow argument number to resource variable.
   //
@@ -216,6 +252,7 @@ class XlaComputationLaunchContext {
   bool allocate_xla_tensors_;
   bool use_multiple_streams_;
   int device_ordinal_;
+  std::optional<ShapeBucket> shape_bucket_;
 };
 
 // A simple TensorBuffer implementation that allows us to create Tensors that
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/tfrt_cpu_pjrt_client.h"
+#include "xla/shape_util.h"
 #include "xla/tests/literal_test_util.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device.h"
@@ -523,6 +526,68 @@ TEST(XlaLaunchUtilTest, GetPjRtExecuteOptions) {
   EXPECT_TRUE(options.use_major_to_minor_data_layout_for_callbacks);
 }
 
+XlaCompiler::Argument MakeParameter(const TensorShape& shape) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+TEST(XlaLaunchUtilTest, PadArgumentsToShapeBucket) {
+  std::vector<XlaCompiler::Argument> args = {MakeParameter({5, 3}),
+                                             MakeParameter({5})};
+  std::optional<ShapeBucket> bucket =
+      PadArgumentsToShapeBucket({4, 8, 16}, args);
+  ASSERT_TRUE(bucket.has_value());
+  EXPECT_EQ(bucket->size, 5);
+  EXPECT_EQ(bucket->bucket_size, 8);
+  EXPECT_EQ(std::get<TensorShape>(args[0].shape), TensorShape({8, 3}));
+  EXPECT_EQ(std::get<TensorShape>(args[1].shape), TensorShape({8}));
+}
+
+TEST(XlaLaunchUtilTest, PadArgumentsToShapeBucketSkipsIneligibleArgs) {
+  // Already the size of a bucket.
+  std::vector<XlaCompiler::Argument> args = {MakeParameter({4, 3})};
+  EXPECT_FALSE(PadArgumentsToShapeBucket({4, 8}, args).has_value());
+  // Larger than all buckets.
+  args = {MakeParameter({9, 3})};
+  EXPECT_FALSE(PadArgumentsToShapeBucket({4, 8}, args).has_value());
+  // Mismatched leading dimensions.
+  args = {MakeParameter({3, 3}), MakeParameter({5})};
+  EXPECT_FALSE(PadArgumentsToShapeBucket({4, 8}, args).has_value());
+  EXPECT_EQ(std::get<TensorShape>(args[0].shape), TensorShape({3, 3}));
+  // Scalars.
+  args = {MakeParameter({})};
+  EXPECT_FALSE(PadArgumentsToShapeBucket({4, 8}, args).has_value());
+  // Resources.
+  args = {MakeParameter({3}), MakeParameter({3})};
+  args[1].kind = XlaCompiler::Argument::kResource;
+  EXPECT_FALSE(PadArgumentsToShapeBucket({4, 8}, args).has_value());
+}
+
+TEST(XlaLaunchUtilTest, CanSliceOutputsFromShapeBucket) {
+  const ShapeBucket bucket{5, 8};
+  XlaCompiler::CompilationResult result;
+  result.xla_input_shapes = {xla::ShapeUtil::MakeShape(xla::F32, {8, 3})};
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {8, 2})});
+  result.outputs.resize(1);
+  result.outputs[0].type = DT_FLOAT;
+  result.outputs[0].shape = TensorShape({8, 2});
+  EXPECT_TRUE(CanSliceOutputsFromShapeBucket(result, bucket));
+
+  // Reductions over the leading dimension can't be sliced.
+  result.outputs[0].shape = TensorShape({2});
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {2})});
+  EXPECT_FALSE(CanSliceOutputsFromShapeBucket(result, bucket));
+
+  result.outputs[0].shape = TensorShape({8, 2});
+  result.outputs[0].is_constant = true;
+  EXPECT_FALSE(CanSliceOutputsFromShapeBucket(result, bucket));
+}
+
 TEST_F(PjRtExecutionUtilTest, RunPjRtExecutable) {
   XlaOpRegistry::RegisterCompilationKernels();
   TF_EXPECT_OK(NodeDefBuilder("AddV2", "AddV2")
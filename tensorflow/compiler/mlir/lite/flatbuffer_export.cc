@@ -39,7 +39,6 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
-#include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -569,6 +568,8 @@ class Translator {
         supported_backends_(toco_flags.supported_backends().begin(),
                             toco_flags.supported_backends().end()),
         use_buffer_offset_(toco_flags.use_buffer_offset()),
+        buffer_alignment_(std::max<size_t>(toco_flags.buffer_alignment(),
+                                           kFbAlignment)),
         custom_option_alignment_(custom_option_alignment) {
     // The first buffer must be empty according to the schema definition.
     empty_buffer_ = tflite::CreateBuffer(builder_);
@@ -722,8 +723,9 @@ class Translator {
   bool CheckGpuDelegateCompatibility(uint8_t* model_buffer_pointer);
 
   // Append constant and custom op buffers at the end of the flatbuffer and
-  // calculate the offsets
-  void AppendBufferData(absl::Cord& result);
+  // calculate the offsets. The buffer data is moved out of the maps, so each
+  // buffer is released as soon as it is in `result`.
+  void AppendBufferData(std::string& result);
 
   // Update constant & custom op buffer offsets
   // Return false if fail to update offset
@@ -887,6 +889,9 @@ class Translator {
 
   bool require_use_buffer_offset_ = false;
 
+  // Alignment of the constant buffers stored after the flatbuffer.
+  size_t buffer_alignment_ = kFbAlignment;
+
   std::optional<size_t> custom_option_alignment_ = std::nullopt;
 
   // Map from mlir constant attribute to the buffer index. This is used to
@@ -3329,6 +3334,12 @@ std::optional<std::string> Translator::Translate(
     op_or_arg_name_mapper = &default_op_or_arg_name_mapper;
   if (!UpdateEntryFunction(module)) return std::nullopt;
   if (!IsValidTFLiteMlirModule(module)) return std::nullopt;
+  if (toco_flags.buffer_alignment() < 0 ||
+      toco_flags.buffer_alignment() % kFbAlignment != 0) {
+    LOG(ERROR) << "buffer_alignment must be a multiple of " << kFbAlignment
+               << ", got " << toco_flags.buffer_alignment();
+    return std::nullopt;
+  }
   auto translator = std::unique_ptr<Translator>(
       new Translator(module, toco_flags, tags, op_or_arg_name_mapper, metadata,
                      custom_option_alignment));
@@ -3587,91 +3598,85 @@ std::optional<std::string> Translator::TranslateInternal() {
     }
   }
 
-  absl::Cord result;
-  auto fbs = absl::string_view(
+  // Return serialized string for the built FlatBuffer. The model is copied
+  // into its final string once, rather than through an intermediate Cord.
+  std::string result(
       reinterpret_cast<const char*>(builder_.GetBufferPointer()),
       builder_.GetSize());
-  result.Append(fbs);
-
-  // Return serialized string for the built FlatBuffer.
   if (use_buffer_offset_) {
     // Pad to be 16 bytes aligned
-    {
-      std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-      result.Append(std::move(pad));
-    }
+    result.append(kFbAlignment - result.size() % kFbAlignment, '\0');
     AppendBufferData(result);
-    std::string result_str = std::string(std::move(result));
-    auto mutable_model = tflite::GetMutableModel(result_str.data());
+    auto mutable_model = tflite::GetMutableModel(result.data());
     bool ret = UpdateBufferOffsets(mutable_model);
     if (!ret) {
       return std::nullopt;
     }
-    return result_str;
   }
-  return std::string(result);
+  return result;
 }
 
-void Translator::AppendBufferData(absl::Cord& result) {
+void Translator::AppendBufferData(std::string& result) {
   std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> hashcode_to_pos;
   // Buffer data should be exported only once.
   assert(!buffer_data_exported_);
 
-  auto it = buffer_data_map_.begin();
-  while (it != buffer_data_map_.end()) {
-    std::string buffer = it->second;
-    int64_t index = it->first;
+  // Reserve an upper bound of the final size, so that appending the buffers
+  // never reallocates (and copies) the whole model.
+  size_t max_size = result.size() + 3 * kFbAlignment;
+  for (const auto& it : buffer_data_map_) {
+    max_size += it.second.size() + buffer_alignment_ + kFbAlignment;
+  }
+  for (const auto& it : custom_op_data_map_) {
+    max_size += it.second.size() + kFbAlignment +
+                custom_option_alignment_.value_or(0);
+  }
+  result.reserve(max_size);
+
+  for (auto& it : buffer_data_map_) {
+    // Free the buffer once it is appended, so that the constants are not held
+    // twice.
+    std::string buffer = std::move(it.second);
+    int64_t index = it.first;
     int64_t offset = result.size();
     int64_t size = buffer.size();
     uint64_t hash = tsl::Fingerprint64(buffer);
     if (hashcode_to_pos.find(hash) == hashcode_to_pos.end()) {
+      if (buffer_alignment_ > kFbAlignment &&
+          result.size() % buffer_alignment_ != 0) {
+        result.append(buffer_alignment_ - result.size() % buffer_alignment_,
+                      '\0');
+        offset = result.size();
+      }
       hashcode_to_pos[hash] = std::make_pair(offset, size);
       buffer_idx_map_[index] = std::make_pair(offset, size);
-      result.Append(std::move(buffer));
+      result.append(buffer);
       // Pad to be 16 bytes aligned.
-      {
-        std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-        result.Append(std::move(pad));
-      }
+      result.append(kFbAlignment - result.size() % kFbAlignment, '\0');
     } else {
       // only update offset/index.
       buffer_idx_map_[index] = hashcode_to_pos[hash];
     }
-    buffer_data_map_.erase(it);
-    it = buffer_data_map_.begin();
     buffer_data_exported_ = true;
   }
-  // pad 16 bytes for the last buffer for XNNPack
-  result.Append("\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0");
-  // pad to be 16 bytes aligned
-  {
-    std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-    result.Append(std::move(pad));
-  }
+  buffer_data_map_.clear();
+  // pad to be 16 bytes aligned. `result` is already aligned here, so this pads
+  // the 16 bytes XNNPack needs after the last buffer.
+  result.append(kFbAlignment - result.size() % kFbAlignment, '\0');
 
   for (auto& it : custom_op_data_map_) {
-    {
-      std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-      result.Append(std::move(pad));
-    }
+    result.append(kFbAlignment - result.size() % kFbAlignment, '\0');
     if (custom_option_alignment_.has_value()) {
-      {
-        auto alignment = custom_option_alignment_.value();
-        std::string pad(alignment - result.size() % alignment, '\0');
-        result.Append(std::move(pad));
-      }
+      auto alignment = custom_option_alignment_.value();
+      result.append(alignment - result.size() % alignment, '\0');
     }
-    auto buffer = std::string(it.second.begin(), it.second.end());
     int64_t offset = result.size();
     int64_t size = it.second.size();
     custom_op_idx_map_[it.first] = std::make_pair(offset, size);
-    result.Append(std::move(buffer));
+    result.append(it.second.begin(), it.second.end());
   }
   // pad to be 16 bytes aligned
-  {
-    std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-    result.Append(std::move(pad));
-  }
+  result.append(kFbAlignment - result.size() % kFbAlignment, '\0');
 }
 
 bool Translator::UpdateBufferOffsets(tflite::Model* mutable_model) {
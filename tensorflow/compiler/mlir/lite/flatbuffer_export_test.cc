@@ -0,0 +1,162 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/lite/flatbuffer_export.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"  // from @llvm-project
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/DialectRegistry.h"  // from @llvm-project
+#include "mlir/IR/MLIRContext.h"  // from @llvm-project
+#include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "mlir/Parser/Parser.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/schema/schema_generated.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tflite {
+namespace {
+
+// Returns a TFL module whose entry function adds `num_constants` constants of
+// `constant_size` floats to its input. The constant `i` is filled with `i + 1`.
+std::string LargeModel(int num_constants, int constant_size) {
+  const std::string type = absl::StrCat("tensor<", constant_size, "xf32>");
+  std::string body;
+  for (int i = 0; i < num_constants; ++i) {
+    absl::StrAppend(&body, "  %c", i,
+                    " = \"tfl.pseudo_const\"() {value = dense<", i + 1,
+                    ".0> : ", type, "} : () -> ", type, "\n");
+    absl::StrAppend(&body, "  %", i + 1, " = \"tfl.add\"(%", i, ", %c", i,
+                    ") {fused_activation_function = \"NONE\"} : (", type,
+                    ", ", type, ") -> ", type, "\n");
+  }
+  return absl::StrCat(
+      "func.func @main(%0: ", type, ") -> ", type,
+      " attributes {tf.entry_function = {inputs = \"input\", outputs = "
+      "\"output\"}} {\n",
+      body, "  func.return %", num_constants, " : ", type, "\n}\n");
+}
+
+class LargeModelExporter {
+ public:
+  LargeModelExporter(int num_constants, int constant_size) {
+    registry_.insert<mlir::TFL::TensorFlowLiteDialect,
+                     mlir::arith::ArithDialect, mlir::func::FuncDialect>();
+    context_.appendDialectRegistry(registry_);
+    module_ = mlir::parseSourceString<mlir::ModuleOp>(
+        LargeModel(num_constants, constant_size), &context_);
+  }
+
+  bool Export(bool use_buffer_offset, std::string* result,
+              int64_t buffer_alignment = 0) {
+    FlatbufferExportOptions options;
+    options.toco_flags.set_use_buffer_offset(use_buffer_offset);
+    options.toco_flags.set_buffer_alignment(buffer_alignment);
+    return MlirToFlatBufferTranslateFunction(*module_, options, result);
+  }
+
+ private:
+  mlir::DialectRegistry registry_;
+  mlir::MLIRContext context_;
+  mlir::OwningOpRef<mlir::ModuleOp> module_;
+};
+
+// Returns the first float of each non-empty buffer of `model`, in ascending
+// order, and checks that the buffers stored after the flatbuffer are aligned to
+// `alignment` bytes.
+std::vector<float> BufferValues(const std::string& model,
+                                int64_t alignment = 16) {
+  std::vector<float> values;
+  for (const Buffer* buffer : *GetModel(model.data())->buffers()) {
+    const char* data = nullptr;
+    if (buffer->data() != nullptr && buffer->data()->size() > 0) {
+      data = reinterpret_cast<const char*>(buffer->data()->data());
+    } else if (buffer->offset() > 1) {
+      EXPECT_EQ(buffer->offset() % alignment, 0);
+      EXPECT_LE(buffer->offset() + buffer->size(), model.size());
+      data = model.data() + buffer->offset();
+    }
+    if (data == nullptr) continue;
+    float value;
+    std::memcpy(&value, data, sizeof(value));
+    values.push_back(value);
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+TEST(FlatbufferExportTest, BufferOffsetsMatchInlinedBuffers) {
+  constexpr int kNumConstants = 5;
+  LargeModelExporter exporter(kNumConstants, /*constant_size=*/64);
+  std::string inlined, offsets;
+  ASSERT_TRUE(exporter.Export(/*use_buffer_offset=*/false, &inlined));
+  ASSERT_TRUE(exporter.Export(/*use_buffer_offset=*/true, &offsets));
+  EXPECT_EQ(offsets.size() % 16, 0);
+
+  std::vector<float> expected;
+  for (int i = 0; i < kNumConstants; ++i) expected.push_back(i + 1);
+  EXPECT_EQ(BufferValues(inlined), expected);
+  EXPECT_EQ(BufferValues(offsets), expected);
+}
+
+TEST(FlatbufferExportTest, PageAlignedBuffers) {
+  constexpr int kNumConstants = 3;
+  LargeModelExporter exporter(kNumConstants, /*constant_size=*/100);
+  std::string model;
+  ASSERT_TRUE(exporter.Export(/*use_buffer_offset=*/true, &model,
+                              /*buffer_alignment=*/4096));
+  EXPECT_EQ(BufferValues(model, /*alignment=*/4096),
+            std::vector<float>({1, 2, 3}));
+}
+
+TEST(FlatbufferExportTest, RejectsUnalignedBufferAlignment) {
+  LargeModelExporter exporter(/*num_constants=*/1, /*constant_size=*/8);
+  std::string model;
+  EXPECT_FALSE(exporter.Export(/*use_buffer_offset=*/true, &model,
+                               /*buffer_alignment=*/24));
+}
+
+// Tracks the time of exporting a model with many large constants, with the
+// constants either inlined or appended after the flatbuffer.
+void BM_ExportLargeModel(::testing::benchmark::State& state) {
+  const int num_constants = state.range(0);
+  const int constant_size = state.range(1);
+  const bool use_buffer_offset = state.range(2);
+  LargeModelExporter exporter(num_constants, constant_size);
+  for (auto s : state) {
+    std::string result;
+    CHECK(exporter.Export(use_buffer_offset, &result));
+  }
+  state.SetBytesProcessed(state.iterations() * num_constants * constant_size *
+                          sizeof(float));
+}
+
+BENCHMARK(BM_ExportLargeModel)
+    ->Args({1000, 256, false})
+    ->Args({1000, 256, true})
+    ->Args({16, 1 << 20, false})
+    ->Args({16, 1 << 20, true});
+
+}  // namespace
+}  // namespace tflite
@@ -278,6 +278,8 @@ absl::Status PopulateQuantizationSpecs(
     quant_specs->weight_quantization = true;
     quant_specs->disable_per_channel =
         toco_flags.disable_per_channel_quantization();
+    quant_specs->weight_block_size = toco_flags.weight_block_size();
+    quant_specs->weight_block_int4 = toco_flags.weight_block_int4();
     if (toco_flags.quantize_to_float16()) {
       quant_specs->inference_type = DT_HALF;
       quant_specs->inference_input_type = DT_HALF;
@@ -21,6 +21,23 @@ module {
     return %arg0 : tensor<1x100x32x4xf32>
   }
 
+  // CHECK-LABEL: func.func private @test_norms
+  func.func private @test_norms(%arg0: tensor<1x8x64xf32>, %arg1: tensor<64xf32>, %arg2: tensor<64xf32>) -> tensor<1x8x64xf32> {
+    // CHECK: %0 = "tfl.custom"(%arg0, %arg1, %arg2) <{custom_code = "odml.layer_norm", custom_option = #tfl<const_bytes : "0x{{.*}}">}> : (tensor<1x8x64xf32>, tensor<64xf32>, tensor<64xf32>) -> tensor<1x8x64xf32>
+    // CHECK: %1 = "tfl.custom"(%0, %arg1) <{custom_code = "odml.rms_norm", custom_option = #tfl<const_bytes : "0x{{.*}}">}> : (tensor<1x8x64xf32>, tensor<64xf32>) -> tensor<1x8x64xf32>
+    %0 = stablehlo.composite "odml.layer_norm" %arg0, %arg1, %arg2 {composite_attributes = {epsilon = 9.99999974E-6 : f32}, decomposition = @odml.layer_norm.impl} : (tensor<1x8x64xf32>, tensor<64xf32>, tensor<64xf32>) -> tensor<1x8x64xf32>
+    %1 = stablehlo.composite "odml.rms_norm" %0, %arg1 {composite_attributes = {epsilon = 9.99999997E-7 : f32}, decomposition = @odml.rms_norm.impl} : (tensor<1x8x64xf32>, tensor<64xf32>) -> tensor<1x8x64xf32>
+    return %1 : tensor<1x8x64xf32>
+  }
+  func.func private @odml.layer_norm.impl(%arg0: tensor<1x8x64xf32>, %arg1: tensor<64xf32>, %arg2: tensor<64xf32>) -> tensor<1x8x64xf32> {
+    // No decomposition provided for test case.
+    return %arg0 : tensor<1x8x64xf32>
+  }
+  func.func private @odml.rms_norm.impl(%arg0: tensor<1x8x64xf32>, %arg1: tensor<64xf32>) -> tensor<1x8x64xf32> {
+    // No decomposition provided for test case.
+    return %arg0 : tensor<1x8x64xf32>
+  }
+
   // CHECK-LABEL: func.func private @test_multiple_kv_caches
   func.func private @test_multiple_kv_caches(%arg0: tensor<1x500x4x4xf32>, %arg1: tensor<1x500x4x4xf32>, %arg2: tensor<100xi64>, %arg3: tensor<1x100x4x4xf32>, %arg4: tensor<1x100x4x4xf32>) -> (tensor<1x500x4x4xf32>, tensor<1x500x4x4xf32>) {
     // CHECK: %0:2 = "tfl.custom"(%arg2, %arg3, %arg4) <{custom_code = "odml.update_kv_cache", custom_option = #tfl<const_bytes : "0x6B765F63616368655F6D6178006C617965725F696E646578006E756D5F6C6179657273000325190E030001000300F40100000200050505092501">}> : (tensor<100xi64>, tensor<1x100x4x4xf32>, tensor<1x100x4x4xf32>) -> (tensor<1x500x4x4xf32>, tensor<1x500x4x4xf32>)
@@ -44,7 +44,8 @@ namespace {
 bool IsSupportedComposite(::mlir::stablehlo::CompositeOp op) {
   // List of supported composites to represent using CustomOp.
   return llvm::is_contained(
-      {"odml.update_kv_cache", "odml.scaled_dot_product_attention"},
+      {"odml.update_kv_cache", "odml.scaled_dot_product_attention",
+       "odml.layer_norm", "odml.rms_norm"},
       op.getName());
 }
 
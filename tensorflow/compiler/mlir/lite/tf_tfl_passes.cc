@@ -496,7 +496,10 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
                    .RunAndRewriteDynamicRangeQuantizationPasses()) {
       AddDynamicRangeQuantizationPasses(pass_config, *pass_manager);
     }
-    pass_manager->addPass(mlir::createCanonicalizerPass());
+    // Only the functions are left to canonicalize here, so run it on each
+    // function to use the threads of the context on large models.
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::createCanonicalizerPass());
 
     if (pass_config.reduce_type_precision ||
         toco_flags.reduce_type_precision()) {
@@ -286,12 +286,27 @@ absl::Status ApplyDynamicRangeQuantizationFromOldQuantizer(
       break;
   }
 
-  bool use_updated_hybrid_scheme = !quant_specs.disable_per_channel;
-  if (::tflite::optimize::QuantizeWeights(
-          &q_builder, input_model, quantized_type, use_updated_hybrid_scheme,
-          ::tflite::optimize::QuantizerType::OLD_QUANTIZER) != kTfLiteOk) {
-    return absl::InvalidArgumentError(
-        "Quantize weights transformation failed.");
+  if (quant_specs.weight_block_size > 0) {
+    if (quantized_type != ::tflite::optimize::BufferType::QUANTIZED_INT8) {
+      return absl::InvalidArgumentError(
+          "Block-wise weight quantization requires int8 inference type.");
+    }
+    if (::tflite::optimize::QuantizeWeightsBlockwise(
+            &q_builder, input_model, quant_specs.weight_block_size,
+            quant_specs.weight_block_int4 ? ::tflite::TensorType_INT4
+                                          : ::tflite::TensorType_INT8) !=
+        kTfLiteOk) {
+      return absl::InvalidArgumentError(
+          "Block-wise quantize weights transformation failed.");
+    }
+  } else {
+    bool use_updated_hybrid_scheme = !quant_specs.disable_per_channel;
+    if (::tflite::optimize::QuantizeWeights(
+            &q_builder, input_model, quantized_type, use_updated_hybrid_scheme,
+            ::tflite::optimize::QuantizerType::OLD_QUANTIZER) != kTfLiteOk) {
+      return absl::InvalidArgumentError(
+          "Quantize weights transformation failed.");
+    }
   }
   const uint8_t* q_buffer = q_builder.GetBufferPointer();
   *result =
@@ -523,7 +538,7 @@ absl::Status ConvertTFExecutorToTFLOrFlatbuffer(
       return status_handler.Combine(status);
     }
   } else {
-    *result = translated_result;
+    *result = std::move(translated_result);
   }
 
   if (mlir::failed(module.verifyInvariants())) {
@@ -73,6 +73,16 @@ struct QuantizationSpecs {
   // in MLIR dynamic range quantizer with int8 weight data type.
   int64_t minimum_elements_for_weights = 1024;
 
+  // If positive, the filters of hybrid fully connected ops are quantized
+  // block-wise, with one scale per `weight_block_size` consecutive input
+  // values of each output channel. Used in the old TOCO dynamic range
+  // quantizer.
+  int64_t weight_block_size = 0;
+
+  // Whether the block-wise quantized weights are stored as int4 rather than
+  // int8.
+  bool weight_block_int4 = false;
+
   // Whether to calculate scales in float to keep quantized values the same with
   // old TOCO quantizer.
   bool legacy_float_scale = false;
@@ -17,7 +17,9 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
@@ -31,6 +33,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
@@ -85,6 +89,49 @@ REGISTER_KERNEL_BUILDER(Name("CreateTRTResourceHandle")
                             .HostMemory("resource_handle"),
                         CreateTRTResourceHandle);
 
+// Sets the TensorRT version and the compute capability of the GPU of `ctx` that
+// the serialized engines of `engine_instance` are valid for.
+Status SetEnginePlatform(OpKernelContext* ctx,
+                         TRTEngineInstance* engine_instance) {
+  if (ctx->op_device_context() == nullptr ||
+      ctx->op_device_context()->stream() == nullptr) {
+    return errors::Internal("No GPU stream to get the compute capability of ",
+                            ctx->device()->name(), " from");
+  }
+  engine_instance->set_tensorrt_version(
+      absl::StrJoin(GetLoadedTensorRTVersion(), "."));
+  se::Stream* stream = ctx->op_device_context()->stream();
+  engine_instance->set_compute_capability(
+      stream->GetCudaComputeCapability().ToString());
+  return OkStatus();
+}
+
+// Returns true if the serialized engine of `engine_instance` was built for the
+// TensorRT version and GPU of `ctx`. Engines serialized without this
+// information are assumed to match.
+StatusOr<bool> MatchesEnginePlatform(OpKernelContext* ctx,
+                                     const TRTEngineInstance& engine_instance) {
+  TRTEngineInstance current;
+  TF_RETURN_IF_ERROR(SetEnginePlatform(ctx, &current));
+  if (!engine_instance.tensorrt_version().empty() &&
+      engine_instance.tensorrt_version() != current.tensorrt_version()) {
+    LOG(WARNING) << "Dropping TRT engine built with TensorRT "
+                 << engine_instance.tensorrt_version()
+                 << ", the loaded TensorRT version is "
+                 << current.tensorrt_version();
+    return false;
+  }
+  if (!engine_instance.compute_capability().empty() &&
+      engine_instance.compute_capability() != current.compute_capability()) {
+    LOG(WARNING) << "Dropping TRT engine built for compute capability "
+                 << engine_instance.compute_capability() << " on device "
+                 << ctx->device()->name() << " with compute capability "
+                 << current.compute_capability();
+    return false;
+  }
+  return true;
+}
+
 class InitializeTRTResource : public OpKernel {
  public:
   explicit InitializeTRTResource(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -134,6 +181,11 @@ class InitializeTRTResource : public OpKernel {
 
       TRTEngineInstance engine_instance;
       engine_instance.ParseFromString(record);
+      // Engines of another platform are rebuilt lazily by TRTEngineOp.
+      StatusOr<bool> matches_platform =
+          MatchesEnginePlatform(ctx, engine_instance);
+      OP_REQUIRES_OK(ctx, matches_platform.status());
+      if (!*matches_platform) continue;
       std::vector<TensorShape> engine_input_shapes;
       const auto& input_shapes = engine_instance.input_shapes();
       engine_input_shapes.reserve(input_shapes.size());
@@ -250,6 +302,7 @@ class SerializeTRTResource : public OpKernel {
             engine->GetCudaEngine()->serialize());
         engine_instance.set_serialized_engine(engine_data->data(),
                                               engine_data->size());
+        OP_REQUIRES_OK(ctx, SetEnginePlatform(ctx, &engine_instance));
 
         if (export_trt_engines_env) {
           const std::string engine_filename =
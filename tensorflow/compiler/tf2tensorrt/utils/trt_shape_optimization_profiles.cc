@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 
 #include "absl/algorithm/container.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
@@ -487,14 +488,21 @@ int TrtShapeOptimizationProfile::GetProfileNumber(
       "TrtShapeOptimizationProfile::GetProfileNumber",
       tensorflow::profiler::TraceMeLevel::kInfo);
   if (!need_profiles_) return 0;
-  // TODO(tfeher): Return the best profile not just the first compatible.
-  for (int i = 0; i < profiles_.size(); i++) {
+  int best_profile = -1;
+  int64_t best_distance = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < profiles_.size() && best_distance > 0; i++) {
     if (profiles_[i].IncludesShapes(shapes, HasShapeTensor(),
                                     actual_shape_values_, is_pruned_input_,
                                     is_shape_tensor_)) {
-      return i;
+      const int64_t distance =
+          profiles_[i].OptDistance(shapes, is_pruned_input_);
+      if (distance < best_distance) {
+        best_profile = i;
+        best_distance = distance;
+      }
     }
   }
+  if (best_profile >= 0) return best_profile;
   VLOG(1) << "Profile not found for input shapes " << DebugString(shapes);
   VLOG(2) << "  and shape values " << DebugString(actual_shape_values_);
   return -1;
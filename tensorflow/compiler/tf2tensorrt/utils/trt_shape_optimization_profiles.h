@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_SHAPE_OPTIMIZATION_PROFILES_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_SHAPE_OPTIMIZATION_PROFILES_H_
 
+#include <cstdint>
+#include <cstdlib>
 #include <list>
 #include <string>
 #include <unordered_set>
@@ -190,6 +192,22 @@ struct OptimizationProfileConfig {
     }
     return true;
   }
+
+  // Returns how far the given shapes are from the opt dimensions of the
+  // profile, as the sum of the absolute differences of the dimensions. TRT
+  // selects the kernels for the opt dimensions, so among the profiles that
+  // include the shapes, the one with the smallest distance is the best fit.
+  int64_t OptDistance(const std::vector<TensorShape>& shapes,
+                      const std::vector<bool>& is_pruned_input) const {
+    int64_t distance = 0;
+    for (int i = 0; i < shapes.size(); i++) {
+      if (is_pruned_input[i]) continue;
+      for (int dim = 0; dim < shapes[i].dims(); dim++) {
+        distance += std::abs(opt[i].d[dim] - shapes[i].dim_size(dim));
+      }
+    }
+    return distance;
+  }
 };
 
 // Manages Optimization profiles during TRT Engine construction.
@@ -228,7 +246,8 @@ class TrtShapeOptimizationProfile {
   void clear() { profiles_.clear(); }
 
   // Returns the profile number that should be used to execute the network with
-  // the given input shapes. Returns -1 if none of cached profiles are
+  // the given input shapes, i.e. the compatible profile whose opt dimensions
+  // are closest to the shapes. Returns -1 if none of cached profiles are
   // compatible with the given input shapes.
   int GetProfileNumber(const std::vector<TensorShape>& shapes);
 
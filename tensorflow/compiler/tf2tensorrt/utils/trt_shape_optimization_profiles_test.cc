@@ -250,6 +250,41 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, SelectsClosestProfile) {
+  // Only the implicit batch mode compatible profiles overlap.
+  if (strategy_ != ProfileStrategy::kImplicitBatchModeCompatible) return;
+
+  nvinfer1::Dims3 dims(-1, 8, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  profile.SetInputMask(std::vector<bool>(2, true));
+  // Profile 0 covers batch sizes [1, 16], profile 1 covers [1, 4].
+  for (int batch_size : {16, 4}) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, nvinfer1::Dims3(batch_size, 8, 10));
+    profile.AddShape(DimVecToShapeVec(dim_vec, true));
+  }
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  profile.InitProfiles(input_partial_shapes, strategy_);
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+  profile.SetShapeTensorMask(network_.get());
+
+  // Both profiles include a batch of 3, the opt dimensions of profile 1 are
+  // closer.
+  std::vector<nvinfer1::Dims3> small_batch(2, nvinfer1::Dims3(3, 8, 10));
+  EXPECT_EQ(1, profile.GetProfileNumber(DimVecToShapeVec(small_batch)));
+  std::vector<nvinfer1::Dims3> large_batch(2, nvinfer1::Dims3(10, 8, 10));
+  EXPECT_EQ(0, profile.GetProfileNumber(DimVecToShapeVec(large_batch)));
+  std::vector<nvinfer1::Dims3> exact_batch(2, nvinfer1::Dims3(4, 8, 10));
+  EXPECT_EQ(1, profile.GetProfileNumber(DimVecToShapeVec(exact_batch)));
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tf2xla/mlir_bridge_rollout_policy.h"
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -194,6 +195,8 @@ Status ExecuteGraph(XlaContext* xla_context, std::unique_ptr<Graph> graph,
 //   `resource_updates` is a ResourceUpdate, whose `index` is the index of a
 //   resource variable argument to the computation to be updated, and `type` is
 //   the type of the final output.
+// - If `alias_parameters_with_outputs` is true, non-constant outputs may alias
+//   parameters of the same shape (see XlaCompiler::CompileOptions).
 Status BuildComputation(
     const std::vector<XlaCompiler::Argument>& args,
     const std::vector<XlaExpression>& retvals,
@@ -204,8 +207,9 @@ Status BuildComputation(
     const XlaShapeLayoutHelpers::ShapeDeterminationFns& shape_determination_fns,
     bool is_entry_computation, bool return_updated_values_for_all_resources,
     bool always_return_tuple, bool use_tuple_arg, bool alias_resource_update,
-    xla::XlaBuilder* builder, xla::XlaComputation* computation,
-    int* num_computation_outputs, int* num_nonconst_outputs,
+    bool alias_parameters_with_outputs, xla::XlaBuilder* builder,
+    xla::XlaComputation* computation, int* num_computation_outputs,
+    int* num_nonconst_outputs,
     std::vector<XlaCompiler::OutputDescription>* outputs,
     std::vector<XlaCompiler::ResourceUpdate>* resource_updates,
     xla::Shape* output_shape, absl::Span<int const> input_mapping) {
@@ -446,6 +450,46 @@ Status BuildComputation(
     }
   }
 
+  if (is_entry_computation && alias_parameters_with_outputs &&
+      !use_tuple_arg) {
+    // Let every remaining non-constant output alias a plain parameter of the
+    // same shape. The aliases are "may alias", so the runtime only reuses the
+    // parameter's buffer if the caller donates it.
+    TF_ASSIGN_OR_RETURN(xla::ProgramShape program_shape,
+                        builder->GetProgramShape());
+    absl::flat_hash_set<int64_t> aliased_params;
+    absl::flat_hash_set<int64_t> aliased_outputs;
+    for (const xla::XlaBuilder::InputOutputAlias& alias : aliases) {
+      aliased_params.insert(alias.param_number);
+      aliased_outputs.insert(
+          alias.output_index.empty() ? 0 : alias.output_index[0]);
+    }
+    for (int64_t i = 0; i < *num_nonconst_outputs; ++i) {
+      if (aliased_outputs.contains(i)) continue;
+      xla::ShapeIndex output_index =
+          returns_tuple ? xla::ShapeIndex({i}) : xla::ShapeIndex({});
+      const xla::Shape& output_shape =
+          xla::ShapeUtil::GetSubshape(program_shape.result(), output_index);
+      if (!output_shape.IsArray() || output_shape.is_dynamic()) continue;
+      for (int xla_arg = 0; xla_arg < input_mapping.size() &&
+                            xla_arg < program_shape.parameters_size();
+           ++xla_arg) {
+        if (aliased_params.contains(xla_arg) ||
+            args[input_mapping[xla_arg]].kind !=
+                XlaCompiler::Argument::kParameter ||
+            !xla::Shape::Equal()(program_shape.parameters(xla_arg),
+                                 output_shape)) {
+          continue;
+        }
+        VLOG(3) << "Aliasing parameter " << xla_arg << " with output "
+                << output_index.ToString();
+        aliases.push_back({output_index, xla_arg, xla::ShapeIndex{}});
+        aliased_params.insert(xla_arg);
+        break;
+      }
+    }
+  }
+
   for (xla::XlaBuilder::InputOutputAlias& alias : aliases) {
     builder->SetUpAlias(alias.output_index, alias.param_number,
                         alias.param_index);
@@ -1565,7 +1609,8 @@ Status XlaCompiler::CompileGraph(const XlaCompiler::CompileOptions& options,
       options.is_entry_computation,
       options.return_updated_values_for_all_resources,
       options.always_return_tuple, options.use_tuple_arg,
-      options.alias_resource_update, builder.get(), result->computation.get(),
+      options.alias_resource_update, options.alias_parameters_with_outputs,
+      builder.get(), result->computation.get(),
       &num_computation_outputs, &num_nonconst_outputs, &result->outputs,
       &result->resource_updates, &result->xla_output_shape,
       result->input_mapping));
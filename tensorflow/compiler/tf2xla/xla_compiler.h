@@ -134,6 +134,11 @@ class XlaCompiler {
     // Resource updates are converted into input / output of xla. The two
     // buffers are aliased with other if this option is true.
     bool alias_resource_update = false;
+
+    // If true, non-constant outputs may alias plain (non-resource) parameters
+    // of the same shape, so that the buffers of inputs which are not used
+    // after the computation can be donated to its results.
+    bool alias_parameters_with_outputs = false;
   };
 
   using OutputDescription = ::tensorflow::XlaOutputDescription;
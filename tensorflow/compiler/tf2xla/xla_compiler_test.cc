@@ -1976,6 +1976,47 @@ TEST_F(XlaCompilerTest, AliasResourceUpdates) {
   EXPECT_EQ(alias.entries(0).parameter_number(), 0);
 }
 
+TEST_F(XlaCompilerTest, AliasParametersWithOutputs) {
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  auto a = ops::_Arg(scope.WithOpName("A"), DT_INT32, 0);
+  auto b = ops::_Arg(scope.WithOpName("B"), DT_INT32, 1);
+  auto c = ops::Neg(scope.WithOpName("C"), b);
+  auto d = ops::Neg(scope.WithOpName("D"), a);
+  auto e = ops::Neg(scope.WithOpName("E"), c);
+  auto c_retval = ops::_Retval(scope.WithOpName("CRetval"), c, 0);
+  auto d_retval = ops::_Retval(scope.WithOpName("DRetval"), d, 1);
+  auto e_retval = ops::_Retval(scope.WithOpName("ERetval"), e, 2);
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_INT32;
+  args[0].shape = TensorShape({2});
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({3});
+
+  XlaCompiler compiler(DefaultOptions());
+
+  XlaCompiler::CompileOptions compile_options;
+  compile_options.alias_parameters_with_outputs = true;
+
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(compiler.CompileGraph(compile_options, "neg", std::move(graph),
+                                     args, &result));
+
+  // Each parameter aliases the first output with its shape.
+  const xla::HloInputOutputAliasProto& alias =
+      result.computation->proto().input_output_alias();
+  ASSERT_EQ(alias.entries_size(), 2);
+  EXPECT_THAT(alias.entries(0).output_shape_index(), ::testing::ElementsAre(0));
+  EXPECT_EQ(alias.entries(0).parameter_number(), 1);
+  EXPECT_EQ(alias.entries(0).kind(), xla::Kind::MAY_ALIAS);
+  EXPECT_THAT(alias.entries(1).output_shape_index(), ::testing::ElementsAre(1));
+  EXPECT_EQ(alias.entries(1).parameter_number(), 0);
+}
+
 // Tests that passing in an exact duplicate input to SetDeviceToHostMetadata
 // is not an error.
 TEST_F(XlaCompilerTest, SetDeviceToHostMetadataExactDuplicate) {
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/all_to_all.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/collective_util.h"
@@ -36,11 +39,32 @@ limitations under the License.
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+// Returns the value of the environment variable `name`, or 0 if it is unset or
+// invalid.
+int64_t ReadBytesFromEnv(const char* name) {
+  int64_t bytes;
+  Status status = ReadInt64FromEnvVar(name, /*default_val=*/0, &bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 0;
+  }
+  return std::max<int64_t>(bytes, 0);
+}
+}  // namespace
+
 AllToAll::AllToAll()
-    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr), counter_(0) {}
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      max_in_flight_bytes_(0),
+      done_(nullptr),
+      counter_(0),
+      next_send_(0),
+      in_flight_bytes_(0) {}
 
 StatusCallback AllToAll::CheckCounterAndCallDone() {
   return [this](const Status& s) {
@@ -49,12 +73,13 @@ StatusCallback AllToAll::CheckCounterAndCallDone() {
       mutex_lock l(mu_);
       status_.Update(s);
       ++counter_;
-      // For all devices other than itself, there's a send and a receive. We
+      // For all devices other than itself, there are sends and receives. We
       // wait until all of them complete.
-      if (counter_ < 2 * col_params_->group.group_size) {
+      const int num_pieces = sends_.size() + recvs_.size();
+      if (counter_ < num_pieces) {
         return;
       }
-      CHECK_LE(counter_, 2 * col_params_->group.group_size);  // Crash ok.
+      CHECK_LE(counter_, num_pieces);  // Crash ok.
       final_status = status_;
     }
     if (!final_status.ok()) {
@@ -91,10 +116,33 @@ Status AllToAll::InitializeCollectiveContext(
       &col_ctx->device_locality);
 }
 
+void AllToAll::AddPieces(int peer, const Tensor& chunk, int64_t chunk_bytes,
+                         std::vector<Piece>* pieces) {
+  const int64_t num_elements = chunk.NumElements();
+  const int64_t element_bytes = DataTypeSize(chunk.dtype());
+  const int64_t piece_elements =
+      element_bytes > 0 ? std::max<int64_t>(chunk_bytes / element_bytes, 1) : 0;
+  if (chunk_bytes == 0 || piece_elements == 0 ||
+      num_elements <= piece_elements) {
+    pieces->push_back({peer, /*index=*/-1, chunk});
+    return;
+  }
+  Tensor flat;
+  CHECK(flat.CopyFrom(chunk, TensorShape({num_elements})));  // Crash ok.
+  for (int64_t begin = 0, index = 0; begin < num_elements;
+       begin += piece_elements, ++index) {
+    pieces->push_back(
+        {peer, static_cast<int>(index),
+         flat.Slice(begin, std::min(begin + piece_elements, num_elements))});
+  }
+}
+
 void AllToAll::Run(StatusCallback done) {
   done_ = std::move(done);
-  input_chunks_.reserve(col_params_->group.group_size);
-  output_chunks_.reserve(col_params_->group.group_size);
+  const int64_t chunk_bytes =
+      ReadBytesFromEnv("TF_COLLECTIVE_ALL_TO_ALL_CHUNK_BYTES");
+  max_in_flight_bytes_ =
+      ReadBytesFromEnv("TF_COLLECTIVE_ALL_TO_ALL_MAX_IN_FLIGHT_BYTES");
   if (col_ctx_->input->SharesBufferWith(*col_ctx_->output)) {
     // The input is forwarded to the output, and we need to use a temp buffer.
     output_buffer_ = Tensor(
@@ -103,27 +151,78 @@ void AllToAll::Run(StatusCallback done) {
   } else {
     output_buffer_ = *col_ctx_->output;
   }
-  for (int i = 0; i < col_params_->group.group_size; ++i) {
-    input_chunks_.push_back(col_ctx_->input->SubSlice(i));
+  // At step s, member r sends to member r + s and receives from member r - s,
+  // so that no member receives from all the others at once.
+  const int group_size = col_params_->group.group_size;
+  const int default_rank = col_params_->default_rank;
+  for (int step = 0; step < group_size; ++step) {
+    const int target = (default_rank + step) % group_size;
+    AddPieces(target, col_ctx_->input->SubSlice(target), chunk_bytes, &sends_);
+    const int source = (default_rank - step + group_size) % group_size;
     // Select output index based on user specified rank, if available.
-    int output_index = col_params_->group.members[i].rank;
-    output_chunks_.push_back(output_buffer_.SubSlice(output_index));
+    const int output_index = col_params_->group.members[source].rank;
+    AddPieces(source, output_buffer_.SubSlice(output_index), chunk_bytes,
+              &recvs_);
   }
 
-  for (int i = 0; i < col_params_->group.group_size; ++i) {
-    auto default_rank = col_params_->default_rank;
-    // Issue send request from current device to all devices in group.
-    DispatchSend(default_rank, i, &input_chunks_[i], CheckCounterAndCallDone());
-    // Issue receive requests from all devices to current device.
-    DispatchRecv(i, default_rank, &output_chunks_[i],
+  // Issue receive requests from all devices to current device. Received
+  // pieces are written in place, so only the sends are bounded.
+  for (Piece& recv : recvs_) {
+    DispatchRecv(recv.peer, default_rank, recv.index, &recv.tensor,
                  CheckCounterAndCallDone());
   }
+  // Issue send requests from current device to all devices in group.
+  DispatchSends();
+}
+
+void AllToAll::DispatchSends() {
+  std::vector<Piece*> to_send;
+  int num_skipped = 0;
+  Status status;
+  {
+    mutex_lock l(mu_);
+    while (next_send_ < sends_.size()) {
+      Piece& send = sends_[next_send_];
+      const int64_t bytes = send.tensor.TotalBytes();
+      if (!status_.ok()) {
+        ++num_skipped;
+      } else if (max_in_flight_bytes_ > 0 && in_flight_bytes_ > 0 &&
+                 in_flight_bytes_ + bytes > max_in_flight_bytes_) {
+        break;
+      } else {
+        in_flight_bytes_ += bytes;
+        to_send.push_back(&send);
+      }
+      ++next_send_;
+    }
+    status = status_;
+  }
+  for (Piece* send : to_send) {
+    const int64_t bytes = send->tensor.TotalBytes();
+    DispatchSend(col_params_->default_rank, send->peer, send->index,
+                 &send->tensor, [this, bytes](const Status& s) {
+                   {
+                     mutex_lock l(mu_);
+                     in_flight_bytes_ -= bytes;
+                     status_.Update(s);
+                   }
+                   DispatchSends();
+                   CheckCounterAndCallDone()(s);
+                 });
+  }
+  // The last call may complete the collective, so `this` must not be used
+  // afterwards.
+  for (int i = 0; i < num_skipped; ++i) {
+    CheckCounterAndCallDone()(status);
+  }
 }
 
-void AllToAll::DispatchSend(int src_rank, int target_rank, const Tensor* tensor,
-                            const StatusCallback& done) {
+void AllToAll::DispatchSend(int src_rank, int target_rank, int index,
+                            const Tensor* tensor, const StatusCallback& done) {
   string send_buf_key =
-      strings::StrCat(col_ctx_->exec_key, src_rank, target_rank);
+      index < 0 ? strings::StrCat(col_ctx_->exec_key, src_rank, target_rank)
+                : strings::StrCat(col_ctx_->exec_key, src_rank, target_rank,
+                                  ":", index);
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[target_rank].device.name(),
       col_params_->group.members[target_rank].task, send_buf_key,
@@ -132,10 +231,12 @@ void AllToAll::DispatchSend(int src_rank, int target_rank, const Tensor* tensor,
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
-void AllToAll::DispatchRecv(int src_rank, int target_rank, Tensor* tensor,
-                            const StatusCallback& done) {
+void AllToAll::DispatchRecv(int src_rank, int target_rank, int index,
+                            Tensor* tensor, const StatusCallback& done) {
   string recv_buf_key =
-      strings::StrCat(col_ctx_->exec_key, src_rank, target_rank);
+      index < 0 ? strings::StrCat(col_ctx_->exec_key, src_rank, target_rank)
+                : strings::StrCat(col_ctx_->exec_key, src_rank, target_rank,
+                                  ":", index);
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[src_rank].device.name(),
       col_params_->group.members[src_rank].task,
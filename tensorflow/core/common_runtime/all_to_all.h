@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ALL_TO_ALL_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_ALL_TO_ALL_H_
 
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <string>
@@ -27,6 +28,21 @@ limitations under the License.
 namespace tensorflow {
 
 // Implementation of collective all-to-all.
+//
+// Each member sends to the other members in a rotated order, starting with the
+// next rank, so that at any time the members send to different peers instead
+// of all sending to the same peer at once. For large tensors, the chunk for
+// each peer can be split into smaller pieces, with a bound on the bytes of the
+// pieces being sent, so that sending a piece overlaps with sending the next
+// one and the transfer buffers of the peers are not all pinned at once:
+//
+//   TF_COLLECTIVE_ALL_TO_ALL_CHUNK_BYTES: the maximum size of a piece, or 0 to
+//     send the chunk for each peer whole.
+//   TF_COLLECTIVE_ALL_TO_ALL_MAX_IN_FLIGHT_BYTES: the maximum size of the
+//     pieces being sent, or 0 for no limit.
+//
+// All members of a group split their chunks independently, so the settings
+// must be identical on every worker.
 class AllToAll : public CollectiveImplementationInterface {
  public:
   AllToAll();
@@ -45,22 +61,41 @@ class AllToAll : public CollectiveImplementationInterface {
  private:
   std::shared_ptr<CollectiveContext> col_ctx_;
   const CollectiveParams* col_params_;  // Not owned
-  std::vector<Tensor> input_chunks_;
+  // A piece of the chunk sent to or received from a peer.
+  struct Piece {
+    int peer;
+    // Index of the piece in the chunk, or -1 if the chunk is not split.
+    int index;
+    Tensor tensor;
+  };
+
+  std::vector<Piece> sends_;  // In dispatch order.
   Tensor output_buffer_;
-  std::vector<Tensor> output_chunks_;
+  std::vector<Piece> recvs_;
+  int64_t max_in_flight_bytes_;
   StatusCallback done_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
   int counter_ TF_GUARDED_BY(mu_);
+  size_t next_send_ TF_GUARDED_BY(mu_);
+  int64_t in_flight_bytes_ TF_GUARDED_BY(mu_);
 
-  void DispatchSend(int src_rank, int target_rank, const Tensor* tensor,
-                    const StatusCallback& done);
+  // Appends the pieces of `chunk`, exchanged with `peer`, to `pieces`.
+  static void AddPieces(int peer, const Tensor& chunk, int64_t chunk_bytes,
+                        std::vector<Piece>* pieces);
+
+  // Dispatches the pending sends that fit within max_in_flight_bytes_. Once
+  // an error occurred, the pending sends are completed with that error instead.
+  void DispatchSends();
+
+  void DispatchSend(int src_rank, int target_rank, int index,
+                    const Tensor* tensor, const StatusCallback& done);
 
-  void DispatchRecv(int src_rank, int target_rank, Tensor* tensor,
+  void DispatchRecv(int src_rank, int target_rank, int index, Tensor* tensor,
                     const StatusCallback& done);
 
-  // Atomically increments counter_ by one for sending, one for receiving.
-  // Invokes done when counter_ reaches 2.
+  // Atomically increments counter_ by one for each sent and received piece.
+  // Invokes done when all pieces complete.
   // The purpose of checking counter_ is to ensure that done_ is called once.
   StatusCallback CheckCounterAndCallDone();
 };
@@ -95,6 +95,52 @@ TEST_F(AllToAllTest, SuccessDifferentRank) {
                                   test::AsTensor<double>({9., 6., 3.}));
 }
 
+TEST_F(AllToAllTest, SuccessChunked) {
+  // Splits the chunk for each peer into pieces of 2 elements, with at most 2
+  // pieces being sent at a time.
+  setenv("TF_COLLECTIVE_ALL_TO_ALL_CHUNK_BYTES", "16", /*overwrite=*/1);
+  setenv("TF_COLLECTIVE_ALL_TO_ALL_MAX_IN_FLIGHT_BYTES", "32",
+         /*overwrite=*/1);
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                      /*num_devices_per_worker*/ 3, DEVICE_CPU);
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < 3; ++i) {
+    Tensor tensor(DT_DOUBLE, TensorShape({3, 5}));
+    for (int j = 0; j < tensor.NumElements(); ++j) {
+      tensor.flat<double>()(j) = 100 * i + j;
+    }
+    tensors.push_back(tensor);
+  }
+  std::vector<Tensor> outputs(3);
+  BlockingCounter counter(3);
+  for (int i = 0; i < 3; ++i) {
+    SchedClosure([this, &tensors, &outputs, i, &counter]() {
+      auto col_params = CreateCollectiveParams(*test_env_, i, "AllToAll",
+                                               ALL_TO_ALL_COLLECTIVE, DT_DOUBLE,
+                                               tensors[i].shape());
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          col_params->group.members[i].device.name(), &device));
+      outputs[i] = Tensor(DT_DOUBLE, tensors[i].shape());
+      TF_CHECK_OK(RunCollective(test_env_.get(), col_params.get(), device,
+                                &tensors[i], &outputs[i]));
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  unsetenv("TF_COLLECTIVE_ALL_TO_ALL_CHUNK_BYTES");
+  unsetenv("TF_COLLECTIVE_ALL_TO_ALL_MAX_IN_FLIGHT_BYTES");
+  for (int i = 0; i < 3; ++i) {
+    Tensor expected(DT_DOUBLE, TensorShape({3, 5}));
+    for (int j = 0; j < 3; ++j) {
+      for (int k = 0; k < 5; ++k) {
+        expected.matrix<double>()(j, k) = 100 * j + 5 * i + k;
+      }
+    }
+    test::ExpectTensorEqual<double>(outputs[i], expected);
+  }
+}
+
 TEST_F(AllToAllTest, Failure) {
   test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
                                       /*num_devices_per_worker*/ 3, DEVICE_CPU);
@@ -55,6 +55,8 @@ const char kScopedAllocatorAttrName[] = "_scoped_allocator";
 static absl::flat_hash_set<std::string>* kBlockList =
     new absl::flat_hash_set<std::string>({
         "StatelessRandomGetKeyCounter",
+        // Folding would copy the mapped tensor into a heap constant.
+        "ImmutableConst",
     });
 
 // Always allow these ops to fold even if their shape information is incomplete.
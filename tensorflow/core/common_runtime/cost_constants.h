@@ -44,6 +44,11 @@ inline constexpr char kGcuWithSmearCostName[] = "gcu_with_smear";
 inline constexpr char kGcuNoSmearCostName[] = "gcu_no_smear";
 inline constexpr char kGcuNonBatchingCostName[] = "gcu_non_batching";
 
+// Per-request costs recorded by the TFRT graph executor: the time spent in
+// op kernels of the request, and the wall time of its graph execution.
+inline constexpr char kTfrtOpCostName[] = "tfrt_op";
+inline constexpr char kTfrtGraphExecutionCostName[] = "tfrt_graph_execution";
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_CONSTANTS_H_
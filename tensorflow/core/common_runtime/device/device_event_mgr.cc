@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -33,6 +34,18 @@ namespace {
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
 static const int kNumThreads = 2;
+
+bool UseHostCallbacks() {
+  bool use_host_callbacks;
+  Status status = ReadBoolFromEnvVar("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+                                     /*default_val=*/false,
+                                     &use_host_callbacks);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return false;
+  }
+  return use_host_callbacks;
+}
 }  // namespace
 
 namespace device_event_mgr {
@@ -100,6 +113,7 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(UseHostCallbacks()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
@@ -107,6 +121,10 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) host_callbacks_done_.wait(l);
+  }
 
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
@@ -188,6 +206,32 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   }
 }
 
+bool EventMgr::EnqueueHostCallback(se::Stream* stream,
+                                   std::function<void()>* func) {
+  {
+    mutex_lock l(mu_);
+    ++num_pending_host_callbacks_;
+  }
+  // The host callback runs on a thread of the driver, which must not call back
+  // into the driver, so it only schedules `func` on threadpool_.
+  auto callback = std::make_shared<std::function<void()>>(std::move(*func));
+  Status status = stream->DoHostCallback([this, callback]() {
+    threadpool_.Schedule(std::move(*callback));
+    mutex_lock l(mu_);
+    if (--num_pending_host_callbacks_ == 0) host_callbacks_done_.notify_all();
+  });
+  if (status.ok()) return true;
+
+  LOG(WARNING) << "Falling back to polling events in the EventMgr, since the "
+                  "stream does not support host callbacks: "
+               << status;
+  use_host_callbacks_.store(false, std::memory_order_relaxed);
+  *func = std::move(*callback);
+  mutex_lock l(mu_);
+  if (--num_pending_host_callbacks_ == 0) host_callbacks_done_.notify_all();
+  return false;
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
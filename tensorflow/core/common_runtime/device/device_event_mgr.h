@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_EVENT_MGR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_EVENT_MGR_H_
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -67,7 +69,16 @@ class EventMgr {
   // Execute `func` when all pending stream actions have completed.  func must
   // be brief and non-blocking since it executes in the one thread used for all
   // such callbacks and also buffer deletions.
+  //
+  // If TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS is true, the completion of the
+  // stream work is signaled by a host callback enqueued on the stream instead
+  // of polling an event, which removes the polling delay from the latency of
+  // func.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_.load(std::memory_order_relaxed) &&
+        EnqueueHostCallback(stream, &func)) {
+      return;
+    }
     mutex_lock l(mu_);
     EnqueueCallback(stream, std::move(func));
     PollEvents(stream);
@@ -90,6 +101,12 @@ class EventMgr {
   void EnqueueCallback(se::Stream* stream, std::function<void()> func)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Set up `func` to be scheduled on threadpool_ by a host callback on
+  // `stream`. Returns false and leaves `func` unchanged if the stream does not
+  // support host callbacks, and then disables them.
+  bool EnqueueHostCallback(se::Stream* stream, std::function<void()>* func)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // This function should be called at roughly the same tempo as QueueTensors()
   // to check whether pending events have recorded, and then retire them.
   //
@@ -116,6 +133,12 @@ class EventMgr {
       callbacks_ TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
+
+  // Whether completions are signaled by host callbacks instead of events.
+  std::atomic<bool> use_host_callbacks_;
+  // Host callbacks enqueued on streams that have not run yet.
+  int64_t num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
   // The main PollLoop for the event manager runs in this threadpool.
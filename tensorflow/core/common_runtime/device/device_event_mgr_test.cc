@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
 #include <atomic>
+#include <vector>
 
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -134,6 +135,37 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that every callback runs when signaled by host callbacks. They may run
+// concurrently on the threadpool, so their order is not checked.
+TEST(EventMgr, HostCallbacks) {
+  setenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS", "true", /*overwrite=*/1);
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  {
+    TEST_EventMgr em(stream_exec, GPUOptions());
+    TEST_EventMgrHelper th(&em);
+    TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+    mutex mu;
+    std::vector<int> done;
+    Notification note;
+    for (int i = 0; i < 3; ++i) {
+      em.ThenExecute(stream.get(), [&mu, &done, &note, i]() {
+        mutex_lock l(mu);
+        done.push_back(i);
+        if (done.size() == 3) note.Notify();
+      });
+    }
+    note.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(done, ::testing::UnorderedElementsAre(0, 1, 2));
+    }
+    // No event was polled.
+    EXPECT_EQ(0, th.queue_size());
+    EXPECT_EQ(0, th.free_size());
+  }
+  unsetenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS");
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -76,6 +78,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/device_profiler_session.h"
+#include "tensorflow/core/profiler/lib/step_stats_sampler.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -688,17 +691,29 @@ Status DirectSession::RunInternal(
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
+  profiler::StepStatsSampler* step_stats_sampler =
+      profiler::StepStatsSampler::Global();
+  const bool sample_step_stats = step_stats_sampler->SampleStep();
+  // Stats of sampled steps go to `sampled_step_stats` unless they are also
+  // returned in `run_metadata`.
+  std::unique_ptr<StepStats> sampled_step_stats;
   if (run_metadata != nullptr &&
       (do_trace || update_cost_model ||
        run_options.report_tensor_allocations_upon_oom())) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
+  } else if (sample_step_stats) {
+    sampled_step_stats = std::make_unique<StepStats>();
+    run_state.collector.reset(
+        new StepStatsCollector(sampled_step_stats.get()));
+    args.stats_collector = run_state.collector.get();
   }
 
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
     device_profiler_session = DeviceProfilerSession::Create();
+    if (run_state.collector) run_state.collector->EnableHardwareCounters();
   }
 
   // Register this step with session's cancellation manager, so that
@@ -795,6 +810,12 @@ Status DirectSession::RunInternal(
     run_state.collector->Finalize();
   }
 
+  if (sample_step_stats) {
+    step_stats_sampler->AddStepStats(sampled_step_stats
+                                         ? std::move(*sampled_step_stats)
+                                         : run_metadata->step_stats());
+  }
+
   // Build and return the cost model as instructed.
   if (update_cost_model) {
     // Build the cost model
@@ -258,6 +258,8 @@ const NodeDef& AttrBuilder::BuildNodeDef() {
 void AttrBuilder::CopyAttributes(const AttrBuilder& other) {
   encoded_attrs_.insert(other.encoded_attrs_.begin(),
                         other.encoded_attrs_.end());
+  cached_cache_key_ = std::nullopt;
+  cached_attrs_fingerprint_ = std::nullopt;
 }
 
 Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
@@ -306,13 +308,19 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
 }
 
 tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const StringPiece device) const {
+    const StringPiece device) {
+  if (!cached_attrs_fingerprint_) {
+    tensorflow::Fprint128 attrs = {0, 0};
+    for (const auto& p : encoded_attrs_) {
+      CombineUnordered(
+          CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)),
+          &attrs);
+    }
+    cached_attrs_fingerprint_ = attrs;
+  }
   tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
   f = tsl::FingerprintCat128(f, tensorflow::Fingerprint128(device));
-  for (const auto& p : encoded_attrs_) {
-    CombineUnordered(
-        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
-  }
+  CombineUnordered(*cached_attrs_fingerprint_, &f);
   return f;
 }
 
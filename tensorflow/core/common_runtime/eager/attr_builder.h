@@ -108,6 +108,7 @@ class AttrBuilder : public AbstractOpAttrs {
     encoded_attrs_.clear();
     node_def_finalized_ = false;
     cached_cache_key_ = std::nullopt;
+    cached_attrs_fingerprint_ = std::nullopt;
     device_for_cached_cache_key_.clear();
   }
 
@@ -123,6 +124,7 @@ class AttrBuilder : public AbstractOpAttrs {
     AddAttrIfNotPresent(attr_name, attr_tmp_);
     node_def_finalized_ = false;
     cached_cache_key_ = std::nullopt;
+    cached_attrs_fingerprint_ = std::nullopt;
     return *this;
   }
 
@@ -131,6 +133,7 @@ class AttrBuilder : public AbstractOpAttrs {
   AttrBuilder& Set(StringPiece attr_name, const AttrValue& value) {
     AddAttrIfNotPresent(attr_name, value);
     cached_cache_key_ = std::nullopt;
+    cached_attrs_fingerprint_ = std::nullopt;
     return *this;
   }
 
@@ -183,7 +186,7 @@ class AttrBuilder : public AbstractOpAttrs {
       absl::InlinedVector<DataType, 4>* type_list) const override;
 
  private:
-  tensorflow::Fprint128 BuildCacheKeyForDevice(StringPiece device) const;
+  tensorflow::Fprint128 BuildCacheKeyForDevice(StringPiece device);
 
   template <class T>
   void SetInAttrValueMap(AttrValueMap* m, const string& attr_name,
@@ -207,6 +210,9 @@ class AttrBuilder : public AbstractOpAttrs {
 
   std::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+  // Device independent part of the cache key, so that looking up the key for
+  // another device, e.g. after placement, does not hash all attributes again.
+  std::optional<tensorflow::Fprint128> cached_attrs_fingerprint_;
 };
 
 template <>
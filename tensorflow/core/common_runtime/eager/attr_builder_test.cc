@@ -85,6 +85,25 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrTypeMap, CacheKeyForAnotherDevice) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 1.0);
+  AttrBuilder b("op_name");
+  b.Set("x", 1.0);
+  b.Set("T", TF_FLOAT);
+
+  // The key after switching devices matches the key computed from scratch.
+  a.CacheKey("");
+  EXPECT_TRUE(a.CacheKey("cpu:0") == b.CacheKey("cpu:0"));
+
+  AttrBuilder c("op_name");
+  c.CopyAttributes(a);
+  c.CacheKey("cpu:0");
+  c.Set("y", 2.0);
+  EXPECT_FALSE(c.CacheKey("cpu:0") == b.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -32,12 +33,22 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+std::unique_ptr<thread::ThreadPool> CreateParallelPool(bool async) {
+  int64_t num_threads = 0;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_ASYNC_PARALLEL_THREADS", 0,
+                                  &num_threads));
+  if (!async || num_threads <= 0) return nullptr;
+  return std::make_unique<thread::ThreadPool>(
+      tensorflow::Env::Default(), "eager_async_parallel", num_threads);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
                              int in_flight_nodes_limit)
     : next_node_id_(0),
       ok_(true),
+      parallel_pool_(CreateParallelPool(async)),
       thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
@@ -239,7 +250,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
   DCHECK(item->state != NodeState::kDONE);
   item->state = NodeState::kDONE;
 
-  bool async = item->node->AsAsync() != nullptr;
+  bool async = item->node->AsAsync() != nullptr || item->run_in_pool;
   // If executing synchronously we don't need to notify if status is OK since
   // the node  was never added to the unfinished_nodes_ list and nobody should
   // ever be waiting for it.
@@ -305,7 +316,9 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
   }
 
   for (auto& item : items_to_destroy) {
-    item->node->Abort(status);
+    // Nodes running on the pool are still running, and report their own
+    // status once done.
+    if (!item->run_in_pool) item->node->Abort(status);
   }
   // nodes_to_destroy will be destructed here, while not holding
   // node_queue_mutex_. This is important because, unfortunately, some nodes'
@@ -349,6 +362,8 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    std::vector<const TensorHandle*> outputs;
+    bool run_in_pool = false;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -364,6 +379,15 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      if (parallel_pool_ != nullptr) {
+        run_in_pool = PrepareToRunInPoolLocked(curr_item.get(), &outputs, &l);
+        // The queue was cleared by an error while waiting.
+        if (!run_in_pool && !status_.ok()) continue;
+      }
+    }
+    if (run_in_pool) {
+      RunItemInPool(std::move(curr_item), std::move(outputs));
+      continue;
     }
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
@@ -425,6 +449,55 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+bool EagerExecutor::PrepareToRunInPoolLocked(
+    NodeItem* item, std::vector<const TensorHandle*>* outputs,
+    mutex_lock* lock) {
+  std::vector<const TensorHandle*> inputs;
+  const bool independent =
+      item->node->AsAsync() == nullptr &&
+      item->node->GetDataDependencies(&inputs, outputs);
+  auto ready = [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_) {
+    if (!independent) return num_nodes_in_pool_ == 0;
+    for (const TensorHandle* input : inputs) {
+      if (pending_outputs_.contains(input)) return false;
+    }
+    return true;
+  };
+  // Nodes running on the pool always finish and notify `nodes_pending_`.
+  while (status_.ok() && !ready()) {
+    nodes_pending_.wait(*lock);
+  }
+  if (!independent || !status_.ok()) return false;
+
+  DCHECK(!node_queue_.empty() && item == node_queue_.front().get());
+  item->state = NodeState::kSCHEDULED;
+  item->run_in_pool = true;
+  unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), item->id,
+                                 std::move(node_queue_.front()));
+  node_queue_.pop();
+  pending_outputs_.insert(outputs->begin(), outputs->end());
+  ++num_nodes_in_pool_;
+  return true;
+}
+
+void EagerExecutor::RunItemInPool(core::RefCountPtr<NodeItem> item,
+                                  std::vector<const TensorHandle*> outputs) {
+  DVLOG(3) << "Running Node in pool: [id " << item->id << "] "
+           << item->node->DebugString();
+  NodeItem* item_ref = item.release();
+  parallel_pool_->Schedule([this, item_ref, outputs = std::move(outputs)]() {
+    core::RefCountPtr<NodeItem> item(item_ref);
+    Status status = item->node->Run();
+    NodeDone(item, status, /*from_queue=*/false);
+    mutex_lock l(node_queue_mutex_);
+    for (const TensorHandle* output : outputs) {
+      pending_outputs_.erase(output);
+    }
+    --num_nodes_in_pool_;
+    nodes_pending_.notify_all();
+  });
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -27,6 +27,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/version.h"
 
@@ -44,6 +46,7 @@ namespace tensorflow {
 
 class AsyncEagerNode;
 class AsyncRemoteExecuteNode;
+class TensorHandle;
 namespace eager {
 class EagerClient;
 }
@@ -79,6 +82,16 @@ class EagerNode {
 
   // Indicates whether a node failure should make the executor unusable.
   virtual bool Fatal() const { return true; }
+
+  // Returns true if this node has no side effects, so that it may run
+  // concurrently with other nodes as long as its `inputs` are ready. In that
+  // case `inputs` and `outputs` are set to the handles it reads and produces.
+  // Nodes returning false are run in program order after all earlier nodes.
+  virtual bool GetDataDependencies(
+      std::vector<const TensorHandle*>* inputs,
+      std::vector<const TensorHandle*>* outputs) const {
+    return false;
+  }
 };
 
 class AsyncEagerNode : public EagerNode {
@@ -110,9 +123,13 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
 // device of the input handle. Fix that.
 // TODO(agarwal): Implement support for control dependencies.
-// TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
+//
+// In async mode, setting TF_EAGER_ASYNC_PARALLEL_THREADS to a positive value
+// runs synchronous nodes without side effects (see
+// EagerNode::GetDataDependencies) on a pool with that many threads, as soon as
+// the nodes producing their inputs are done. Other nodes wait for all earlier
+// nodes to finish, so side effects are still observed in program order.
 class EagerExecutor {
  public:
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
@@ -195,6 +212,8 @@ class EagerExecutor {
     uint64 id;
     std::unique_ptr<EagerNode> node;
     NodeState state;
+    // True if the node runs on `parallel_pool_`.
+    bool run_in_pool = false;
   };
 
   const char* StateStringLocked()
@@ -211,6 +230,17 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+
+  // Waits until `item`, the front of `node_queue_`, may be dispatched. Returns
+  // true if it was moved to `unfinished_nodes_` to run on `parallel_pool_`,
+  // and false if it must run inline or if an error happened while waiting
+  // (in which case `item` is no longer in the queue).
+  bool PrepareToRunInPoolLocked(NodeItem* item,
+                                std::vector<const TensorHandle*>* outputs,
+                                mutex_lock* lock)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+  void RunItemInPool(core::RefCountPtr<NodeItem> item,
+                     std::vector<const TensorHandle*> outputs);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -258,6 +288,16 @@ class EagerExecutor {
   ExecutorState state_ TF_GUARDED_BY(node_queue_mutex_) =
       ExecutorState::kActive;
 
+  // Handles produced by the nodes running on `parallel_pool_`, and the number
+  // of these nodes.
+  absl::flat_hash_set<const TensorHandle*> pending_outputs_
+      TF_GUARDED_BY(node_queue_mutex_);
+  int64_t num_nodes_in_pool_ TF_GUARDED_BY(node_queue_mutex_) = 0;
+
+  // Runs independent nodes in parallel, or nullptr. Declared before `thread_`
+  // so that the pool outlives the thread scheduling on it.
+  const std::unique_ptr<thread::ThreadPool> parallel_pool_;
+
   // Thread object that calls the `Run` method in async mode.This thread runs
   // until state_ is set to kShuttingDown. It is `nullptr` in sync mode.
   const std::unique_ptr<Thread> thread_;
@@ -14,9 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <atomic>
+#include <cstdlib>
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +107,44 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// A node reading and producing fake handles, which runs `fn`.
+class TestDataNode : public EagerNode {
+ public:
+  TestDataNode(std::vector<const TensorHandle*> inputs,
+               std::vector<const TensorHandle*> outputs,
+               std::function<void()> fn, bool independent = true)
+      : inputs_(std::move(inputs)),
+        outputs_(std::move(outputs)),
+        fn_(std::move(fn)),
+        independent_(independent) {}
+
+  Status Run() override {
+    fn_();
+    return absl::OkStatus();
+  }
+  void Abort(Status status) override {}
+  string DebugString() const override { return "testDataNode"; }
+
+  bool GetDataDependencies(
+      std::vector<const TensorHandle*>* inputs,
+      std::vector<const TensorHandle*>* outputs) const override {
+    *inputs = inputs_;
+    *outputs = outputs_;
+    return independent_;
+  }
+
+ private:
+  std::vector<const TensorHandle*> inputs_;
+  std::vector<const TensorHandle*> outputs_;
+  std::function<void()> fn_;
+  bool independent_;
+};
+
+const TensorHandle* FakeHandle(int i) {
+  static int handles[4];
+  return reinterpret_cast<const TensorHandle*>(&handles[i]);
+}
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +324,46 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+TEST(EagerExecutorTest, TestAsyncExecutorRunsIndependentNodesInParallel) {
+  setenv("TF_EAGER_ASYNC_PARALLEL_THREADS", "4", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_ASYNC_PARALLEL_THREADS");
+
+  // The first node blocks until the second one runs, which is only possible
+  // if they run in parallel. The third node reads the output of the first,
+  // and the last one, which is not independent, runs after all of them.
+  Notification c_ran;
+  std::atomic<bool> a_done(false);
+  std::atomic<bool> b_saw_a(false);
+  std::atomic<int> num_done(0);
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::make_unique<TestDataNode>(
+      std::vector<const TensorHandle*>{}, std::vector{FakeHandle(0)}, [&]() {
+        c_ran.WaitForNotification();
+        a_done = true;
+        ++num_done;
+      })));
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::make_unique<TestDataNode>(
+      std::vector<const TensorHandle*>{}, std::vector{FakeHandle(2)}, [&]() {
+        c_ran.Notify();
+        ++num_done;
+      })));
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::make_unique<TestDataNode>(
+      std::vector{FakeHandle(0)}, std::vector{FakeHandle(1)}, [&]() {
+        b_saw_a = a_done.load();
+        ++num_done;
+      })));
+  std::atomic<int> num_done_before_d(0);
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::make_unique<TestDataNode>(
+      std::vector<const TensorHandle*>{}, std::vector<const TensorHandle*>{},
+      [&]() { num_done_before_d = num_done.load(); },
+      /*independent=*/false)));
+
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  EXPECT_TRUE(b_saw_a);
+  EXPECT_EQ(num_done_before_d, 3);
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
 }  // namespace
 }  // namespace tensorflow
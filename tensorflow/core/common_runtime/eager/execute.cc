@@ -1386,7 +1386,9 @@ Status GetOrCreateKernelAndDevice(
   std::unordered_map<int, DtypeAndPartialTensorShape>
       input_resource_variable_dtypes_and_shapes;
   const KernelDef* kernel_def = nullptr;
-  if (!op->is_function()) {
+  // The KernelDef is only needed to wrap a primitive op in a function, so
+  // skip building the NodeDef on the dispatch path of primitive ops.
+  if (!op->is_function() && ctx.RunEagerOpAsFunction()) {
     const NodeDef* node_def = &op->MutableAttrs()->BuildNodeDef();
     kernel_def = GetKernelDef(*op, node_def, device);
   }
@@ -23,6 +23,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/platform.h"
@@ -38,6 +39,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/execute.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -227,6 +230,31 @@ class AsyncExecuteNode : public EagerNode {
     }
   }
 
+  bool GetDataDependencies(
+      std::vector<const TensorHandle*>* inputs,
+      std::vector<const TensorHandle*>* outputs) const override {
+    // Functions and stateful kernels may have side effects, and resources are
+    // shared by reference; keep their order. Graph collection also relies on
+    // program order.
+    const OpKernel* op_kernel = kernel_->kernel();
+    if (op_kernel == nullptr || kernel_->IsFunction() ||
+        graph_collector_ != nullptr) {
+      return false;
+    }
+    const OpDef* op_def = nullptr;
+    if (!OpRegistry::Global()->LookUpOpDef(op_kernel->type_string(), &op_def)
+             .ok() ||
+        op_def->is_stateful()) {
+      return false;
+    }
+    for (const TensorHandle* h : inputs_) {
+      if (h->dtype == DT_RESOURCE) return false;
+    }
+    inputs->assign(inputs_.begin(), inputs_.end());
+    outputs->assign(retvals_.begin(), retvals_.end());
+    return true;
+  }
+
   std::string DebugString() const override {
     std::string out = "[AsyncExecuteNode]";
     strings::StrAppend(&out, " kernel: ", kernel_->name());
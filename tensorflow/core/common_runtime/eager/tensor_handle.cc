@@ -66,8 +66,64 @@ string SafeDeviceDebugString(Device* device) {
   }
 }
 
+// Maximum number of freed TensorHandles kept for reuse by each thread.
+constexpr size_t kMaxFreeTensorHandlesPerThread = 64;
+
+// Freed TensorHandle allocations of the current thread.
+class TensorHandleFreeList {
+ public:
+  ~TensorHandleFreeList() {
+    for (void* ptr : free_) ::operator delete(ptr);
+    destroyed_ = true;
+  }
+
+  static TensorHandleFreeList* Get() {
+    // Handles may be destroyed by thread-local destructors running after the
+    // free list of their thread is gone.
+    if (destroyed_) return nullptr;
+    thread_local TensorHandleFreeList free_list;
+    return &free_list;
+  }
+
+  void* Pop() {
+    if (free_.empty()) return nullptr;
+    void* ptr = free_.back();
+    free_.pop_back();
+    return ptr;
+  }
+
+  bool Push(void* ptr) {
+    if (free_.size() >= kMaxFreeTensorHandlesPerThread) return false;
+    free_.push_back(ptr);
+    return true;
+  }
+
+ private:
+  static thread_local bool destroyed_;
+  std::vector<void*> free_;
+};
+
+thread_local bool TensorHandleFreeList::destroyed_ = false;
+
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  if (size == sizeof(TensorHandle)) {
+    TensorHandleFreeList* free_list = TensorHandleFreeList::Get();
+    void* ptr = free_list != nullptr ? free_list->Pop() : nullptr;
+    if (ptr != nullptr) return ptr;
+  }
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(TensorHandle)) {
+    TensorHandleFreeList* free_list = TensorHandleFreeList::Get();
+    if (free_list != nullptr && free_list->Push(ptr)) return;
+  }
+  ::operator delete(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
@@ -128,6 +128,11 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // defined.
   void Release();
 
+  // Eager ops create and destroy a TensorHandle per output, so handles are
+  // recycled through a small per-thread free list instead of the heap.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   tensorflow::DataType DataType() const override;
   Status Shape(tensorflow::PartialTensorShape* shape) const override;
   Status NumDims(int* num_dims) const override;
@@ -654,6 +654,19 @@ TEST_F(RemoteTensorHandleTest, SetRemoteMirrorShapeTwice) {
                        HasSubstr("Trying to change shape to")));
 }
 
+TEST(TensorHandle_LocalTest, RecyclesHandles) {
+  TensorHandle* h0 = TensorHandle::CreateLocalHandle(Tensor(1.0f));
+  void* address = h0;
+  h0->Unref();
+
+  TensorHandle* h1 = TensorHandle::CreateLocalHandle(Tensor(2.0f));
+  EXPECT_EQ(address, h1);
+  const tensorflow::Tensor* t = nullptr;
+  TF_ASSERT_OK(h1->Tensor(&t));
+  EXPECT_EQ(t->scalar<float>()(), 2.0f);
+  h1->Unref();
+}
+
 TEST(TensorHandle_LocalTest, TensorFromDeviceSameDevice) {
   std::vector<std::unique_ptr<Device>> devices;
   devices.push_back(
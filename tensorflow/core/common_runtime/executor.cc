@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -62,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -147,7 +149,11 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `work_stealing` is true, ready nodes are handed to a fixed set of
+  // workers that steal from each other, see `ExecutorState::WorkQueues`.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing = false)
+      : immutable_state_(p), work_stealing_(work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -225,11 +231,17 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const bool work_stealing_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
 };
 
+// The work stealing queues and the index of the queue owned by the worker
+// running on this thread, if any. See `ExecutorState::WorkStealingLoop()`.
+thread_local const void* current_work_queues = nullptr;
+thread_local int current_worker_index = -1;
+
 // The state associated with one invocation of ExecutorImpl::Run.
 //
 // ExecutorState dispatches nodes when they become ready, and delegates to an
@@ -284,7 +296,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool work_stealing = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -297,6 +310,58 @@ class ExecutorState {
   typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
 
   struct AsyncState;
+  struct WorkQueues;
+
+  // The objects ProcessInline() needs to run nodes.
+  struct ProcessScratch {
+    TaggedNodeSeq ready;
+    TensorValueVec inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+    // Initialized by InitParams().
+    OpKernelContext::Params params;
+    EntryVector outputs = EntryVector(1);
+  };
+
+  // Caches the `ProcessScratch` objects of a step, so that ProcessInline()
+  // does not allocate them on every call. Lock-free: each slot holds at most
+  // one idle object, and objects beyond the slots are freed on release.
+  class ScratchPool {
+   public:
+    ScratchPool() = default;
+    ~ScratchPool() {
+      for (auto& slot : slots_) delete slot.load(std::memory_order_relaxed);
+    }
+
+    // Returns an idle object, or nullptr if there is none.
+    std::unique_ptr<ProcessScratch> Acquire() {
+      for (auto& slot : slots_) {
+        if (slot.load(std::memory_order_relaxed) != nullptr) {
+          ProcessScratch* scratch =
+              slot.exchange(nullptr, std::memory_order_acquire);
+          if (scratch != nullptr) return absl::WrapUnique(scratch);
+        }
+      }
+      return nullptr;
+    }
+
+    void Release(std::unique_ptr<ProcessScratch> scratch) {
+      for (auto& slot : slots_) {
+        ProcessScratch* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, scratch.get(),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+          scratch.release();
+          return;
+        }
+      }
+    }
+
+   private:
+    std::atomic<ProcessScratch*> slots_[8] = {};
+
+    ScratchPool(const ScratchPool&) = delete;
+    void operator=(const ScratchPool&) = delete;
+  };
 
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
@@ -304,6 +369,9 @@ class ExecutorState {
   void ProcessInline(TaggedNodeReadyQueue* inline_ready,
                      int64_t scheduled_nsec);
 
+  // Sets the fields of "params" that are the same for every node of the step.
+  void InitParams(OpKernelContext::Params* params);
+
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
@@ -346,6 +414,12 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c, int sample_rate = 0);
 
+  // Runs the nodes in `work_queues`, starting with the queue at `index`, until
+  // all queues are empty. Does not touch the `ExecutorState` after running
+  // the last node of the step, which may delete it.
+  static void WorkStealingLoop(std::shared_ptr<WorkQueues> work_queues,
+                               int index);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -401,6 +475,12 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Not null in work stealing mode. Shared with the running workers.
+  std::shared_ptr<WorkQueues> work_queues_;
+
+  // Shared with the running ProcessInline() calls.
+  const std::shared_ptr<ScratchPool> scratch_pool_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -416,10 +496,142 @@ class ExecutorState {
   Status status_ TF_GUARDED_BY(mu_);
 };
 
+// Ready nodes in work stealing mode.
+//
+// Instead of allocating a closure for every ready node and handing it to
+// `runner_`, ready nodes are pushed to one of `num_workers` queues, and at most
+// `num_workers` closures run `WorkStealingLoop()`. Each running worker owns one
+// queue: it pushes and pops at the front of its queue without locking, and
+// steals from the back of the other queues when its own is empty. Threads that
+// are not workers (e.g. completing asynchronous kernels) push to the back of
+// the queues in turn.
+template <class PropagatorStateType>
+struct ExecutorState<PropagatorStateType>::WorkQueues {
+  struct ReadyNode {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+  // Empty `std::optional`s mark the absence of a node.
+  typedef Eigen::RunQueue<std::optional<ReadyNode>, 128> Queue;
+
+  WorkQueues(ExecutorState* state, int num_workers,
+             const Executor::Args::Runner& runner)
+      : state(state),
+        runner(runner),
+        num_workers(num_workers),
+        queues(new Queue[num_workers]),
+        owned(new std::atomic<bool>[num_workers]) {
+    for (int i = 0; i < num_workers; ++i) owned[i] = false;
+  }
+
+  // Returns the index of a queue no running worker owns, marking it owned, or
+  // -1 if all workers are running.
+  int Claim() {
+    for (int i = 0; i < num_workers; ++i) {
+      bool expected = false;
+      if (!owned[i].load(std::memory_order_relaxed) &&
+          owned[i].compare_exchange_strong(expected, true)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  bool Empty() const {
+    for (int i = 0; i < num_workers; ++i) {
+      if (!queues[i].Empty()) return false;
+    }
+    return true;
+  }
+
+  // Pops a node from the queue at `index`, or steals one from another queue.
+  std::optional<ReadyNode> Pop(int index) {
+    std::optional<ReadyNode> node = queues[index].PopFront();
+    for (int i = 1; !node && i < num_workers; ++i) {
+      node = queues[(index + i) % num_workers].PopBack();
+    }
+    return node;
+  }
+
+  // Pushes `nodes` and starts workers for them if some are not running.
+  // `work_queues` is taken by value as the `ExecutorState` may be deleted
+  // once the nodes are pushed.
+  static void Push(std::shared_ptr<WorkQueues> work_queues,
+                   const TaggedNodeSeq& nodes, int64_t scheduled_nsec) {
+    WorkQueues* const self = work_queues.get();
+    for (const TaggedNode& tagged_node : nodes) {
+      std::optional<ReadyNode> rejected;
+      if (current_work_queues == self) {
+        rejected = self->queues[current_worker_index].PushFront(
+            ReadyNode{tagged_node, scheduled_nsec});
+      } else {
+        const unsigned index =
+            self->next_queue.fetch_add(1, std::memory_order_relaxed);
+        rejected = self->queues[index % self->num_workers].PushBack(
+            ReadyNode{tagged_node, scheduled_nsec});
+      }
+      if (rejected) {
+        // The queue is full, run this node from its own closure.
+        ExecutorState* state = self->state;
+        self->runner([state, node = *rejected]() {
+          state->Process(node.tagged_node, node.scheduled_nsec);
+        });
+      }
+    }
+    // Pairs with the fence in `WorkStealingLoop()`: either a worker that is
+    // about to exit sees the new nodes, or we see its queue as unowned.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const int index = self->Claim();
+      if (index < 0) break;
+      self->runner([work_queues, index]() {
+        WorkStealingLoop(work_queues, index);
+      });
+    }
+  }
+
+  // Not owned. Only valid while a node of the step is pending.
+  ExecutorState* const state;
+  const Executor::Args::Runner runner;
+  const int num_workers;
+  std::unique_ptr<Queue[]> queues;
+  // Whether a running worker owns the queue at the same index.
+  std::unique_ptr<std::atomic<bool>[]> owned;
+  std::atomic<unsigned> next_queue{0};
+};
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::WorkStealingLoop(
+    std::shared_ptr<WorkQueues> work_queues, int index) {
+  // A kernel may run another executor inline, so restore the outer worker.
+  const void* const outer_work_queues = current_work_queues;
+  const int outer_worker_index = current_worker_index;
+  current_work_queues = work_queues.get();
+  current_worker_index = index;
+  while (true) {
+    std::optional<typename WorkQueues::ReadyNode> node =
+        work_queues->Pop(index);
+    if (node) {
+      work_queues->state->Process(node->tagged_node, node->scheduled_nsec);
+      continue;
+    }
+    // Give up the queue, then look again for a node pushed by a thread that
+    // saw the queue as still owned and thus did not start a worker.
+    work_queues->owned[index].store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (work_queues->Empty()) break;
+    index = work_queues->Claim();
+    if (index < 0) break;
+    current_worker_index = index;
+  }
+  current_work_queues = outer_work_queues;
+  current_worker_index = outer_worker_index;
+}
+
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -449,12 +661,20 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
+      scratch_pool_(std::make_shared<ScratchPool>()),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (work_stealing && !run_all_kernels_inline_) {
+    int num_workers = session_config_ != nullptr
+                          ? session_config_->inter_op_parallelism_threads()
+                          : 0;
+    if (num_workers <= 0) num_workers = port::MaxParallelism();
+    work_queues_ = std::make_shared<WorkQueues>(this, num_workers, runner_);
+  }
 }
 
 template <class PropagatorStateType>
@@ -737,18 +957,8 @@ void ExecutorState<PropagatorStateType>::Process(const TaggedNode& tagged_node,
 }
 
 template <class PropagatorStateType>
-void ExecutorState<PropagatorStateType>::ProcessInline(
-    TaggedNodeReadyQueue* inline_ready, int64_t scheduled_nsec) {
-  WithContext wc(context_);
-  auto ready = std::make_unique<TaggedNodeSeq>();
-
-  // Parameters passed to OpKernel::Compute.
-  auto inputs = std::make_unique<TensorValueVec>();
-
-  AllocatorAttributeVec input_alloc_attrs;
-
-  auto params = std::make_unique<OpKernelContext::Params>();
-
+void ExecutorState<PropagatorStateType>::InitParams(
+    OpKernelContext::Params* params) {
   params->step_id = step_id_;
   // Override device's threadpool if user provides an intra_op_threadpool
   Device* device = immutable_state_.params().device;
@@ -799,11 +1009,33 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
   // Set the device_context for this device, if it exists.
   params->op_device_context = device_context_;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ProcessInline(
+    TaggedNodeReadyQueue* inline_ready, int64_t scheduled_nsec) {
+  WithContext wc(context_);
+  // Keeps the pool alive after the last NodeDone() below, which may let
+  // another thread finish the step and delete this ExecutorState.
+  std::shared_ptr<ScratchPool> scratch_pool = scratch_pool_;
+  std::unique_ptr<ProcessScratch> scratch = scratch_pool->Acquire();
+  if (scratch == nullptr) {
+    scratch = std::make_unique<ProcessScratch>();
+    InitParams(&scratch->params);
+  }
+  TaggedNodeSeq* const ready = &scratch->ready;
+
+  // Parameters passed to OpKernel::Compute.
+  TensorValueVec* const inputs = &scratch->inputs;
+  AllocatorAttributeVec& input_alloc_attrs = scratch->input_alloc_attrs;
+  OpKernelContext::Params* const params = &scratch->params;
+
+  Device* device = immutable_state_.params().device;
 
   Status s;
   NodeExecStatsInterface* stats = nullptr;
 
-  EntryVector outputs(1);
+  EntryVector& outputs = scratch->outputs;
 
   bool completed = false;
   int64_t last_iter_num = -1;
@@ -896,7 +1128,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
     } else {
       // Prepares inputs.
       bool is_input_dead = false;
-      s = PrepareInputs(item, first_input, inputs.get(), &input_alloc_attrs,
+      s = PrepareInputs(item, first_input, inputs, &input_alloc_attrs,
                         &is_input_dead);
       if (!s.ok()) {
         // Clear inputs.
@@ -907,7 +1139,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
         propagator_.MaybeMarkCompleted(tagged_node);
         activity_watcher::ActivityEnd(activity_id);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, ready.get(), stats, inline_ready);
+        completed = NodeDone(s, ready, stats, inline_ready);
         continue;
       }
 
@@ -926,7 +1158,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
                      activity_id);
         launched_asynchronously = true;
       } else {
-        s = ProcessSync(item, params.get(), &outputs, stats);
+        s = ProcessSync(item, params, &outputs, stats);
       }
     }
 
@@ -948,7 +1180,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       activity_watcher::ActivityEnd(activity_id);
       // Propagates outputs.
       if (s.ok()) {
-        propagator_.PropagateOutputs(tagged_node, &outputs, ready.get());
+        propagator_.PropagateOutputs(tagged_node, &outputs, ready);
       }
 
       // Clear outputs without deallocating the `outputs` vector.
@@ -961,10 +1193,11 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
         scheduled_nsec = nodestats::NowInNsec();
       }
       // Postprocess.
-      completed = NodeDone(s, ready.get(), stats, inline_ready);
+      completed = NodeDone(s, ready, stats, inline_ready);
     }
   }  // while !inline_ready.empty()
 
+  scratch_pool->Release(std::move(scratch));
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
 }
@@ -1277,6 +1510,18 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
 
+  if (immutable_state_.has_collective_inputs() && ready->size() > 1) {
+    // Schedules the producers of the inputs of collectives first, so that the
+    // collectives start early and overlap with the rest of the computation:
+    // they are dispatched to the thread pool, or run inline, first. The ready
+    // nodes come in the arbitrary order their inputs completed, so an in place
+    // partition, which does not allocate unlike a stable one, is enough.
+    std::partition(ready->begin(), ready->end(),
+                   [](const TaggedNode& tagged_node) {
+                     return tagged_node.node_item->is_collective_input;
+                   });
+  }
+
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
@@ -1298,6 +1543,26 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_queues_ != nullptr) {
+    // Inline inexpensive nodes as usual, and push everything else to the
+    // work stealing queues.
+    TaggedNodeSeq pushed_nodes;
+    for (auto& tagged_node : *ready) {
+      if (inline_ready != nullptr &&
+          (tagged_node.get_is_dead() ||
+           !kernel_stats_->IsExpensive(*tagged_node.node_item))) {
+        inline_ready->push_back(tagged_node);
+      } else {
+        pushed_nodes.push_back(tagged_node);
+      }
+    }
+    if (inline_ready != nullptr && inline_ready->empty()) {
+      inline_ready->push_back(pushed_nodes.back());
+      pushed_nodes.pop_back();
+    }
+    if (!pushed_nodes.empty()) {
+      WorkQueues::Push(work_queues_, pushed_nodes, scheduled_nsec);
+    }
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
@@ -1517,11 +1782,12 @@ void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        work_stealing_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1575,6 +1841,28 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Same as the default executor, with work stealing scheduling of ready nodes.
+// Select it with `ConfigProto.Experimental.executor_type`.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = std::make_unique<ExecutorImpl>(params,
+                                                 /*work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -0,0 +1,162 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the per-node dispatch cost of the executors, on synthetic
+// graphs of trivial kernels so that scheduling dominates. Every benchmark runs
+// once per executor type and reports "ns/node", the wall time per executed
+// node.
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/cc/ops/while_loop.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs `g`, which executes `num_nodes` nodes per step, using the executor
+// registered as `executor_type`.
+void RunGraph(::testing::benchmark::State& state,
+              const std::string& executor_type, Graph* g, int64_t num_nodes) {
+  FixupSourceAndSinkEdges(g);
+  SessionOptions options;
+  options.config.set_inter_op_parallelism_threads(4);
+  test::Benchmark("cpu", g, &options, nullptr, nullptr, executor_type.c_str(),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetLabel(strings::StrCat("Nodes = ", num_nodes));
+  state.SetItemsProcessed(num_nodes * static_cast<int64_t>(state.iterations()));
+  // Nanoseconds of wall time per executed node.
+  state.counters["ns/node"] = ::benchmark::Counter(
+      num_nodes * 1e-9, ::benchmark::Counter::kIsIterationInvariantRate |
+                            ::benchmark::Counter::kInvert);
+}
+
+// A chain of `depth` no-ops linked by control edges: no parallelism at all.
+void BM_Chain(::testing::benchmark::State& state,
+              const std::string& executor_type) {
+  const int depth = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* prev = test::graph::NoOp(g, {});
+  for (int i = 1; i < depth; ++i) {
+    prev = test::graph::NoOp(g, {prev});
+  }
+  RunGraph(state, executor_type, g, depth);
+}
+
+// One no-op fanning out to `width` no-ops that fan back in to one no-op, so
+// that `width` nodes become ready at once.
+void BM_FanOut(::testing::benchmark::State& state,
+               const std::string& executor_type) {
+  const int width = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* root = test::graph::NoOp(g, {});
+  std::vector<Node*> leaves;
+  leaves.reserve(width);
+  for (int i = 0; i < width; ++i) {
+    leaves.push_back(test::graph::NoOp(g, {root}));
+  }
+  test::graph::NoOp(g, leaves);
+  RunGraph(state, executor_type, g, width + 2);
+}
+
+// `width` independent chains of `depth` Identity kernels on a scalar, i.e.
+// many small kernels that pass tensors around.
+void BM_SmallKernels(::testing::benchmark::State& state,
+                     const std::string& executor_type) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  for (int i = 0; i < width; ++i) {
+    Node* prev = test::graph::Constant(g, Tensor(static_cast<float>(i)));
+    for (int j = 0; j < depth; ++j) {
+      prev = test::graph::Identity(g, prev);
+    }
+  }
+  RunGraph(state, executor_type, g, width * (depth + 1));
+}
+
+// A Switch/Merge while loop of `loop_iters` iterations that increments a
+// counter. The number of executed nodes is approximate: all loop nodes but
+// Enter and Exit are counted once per iteration.
+void BM_WhileLoop(::testing::benchmark::State& state,
+                  const std::string& executor_type) {
+  const int loop_iters = state.range(0);
+  Scope root = Scope::NewRootScope().ExitOnError();
+  const std::vector<Output> inputs = {ops::Const(root, 0),
+                                      ops::Const(root, loop_iters),
+                                      ops::Const(root, 1)};
+  const int num_nodes_before_loop = root.graph()->num_op_nodes();
+  ops::OutputList outputs;
+  TF_CHECK_OK(ops::BuildWhileLoop(
+      root, inputs,
+      [](const Scope& s, const std::vector<Output>& inputs, Output* output) {
+        *output = ops::Less(s, inputs[0], inputs[1]);
+        return s.status();
+      },
+      [](const Scope& s, const std::vector<Output>& inputs,
+         std::vector<Output>* outputs) {
+        *outputs = {ops::Add(s, inputs[0], inputs[2]), inputs[1], inputs[2]};
+        return s.status();
+      },
+      "loop", &outputs));
+  const int num_enter_exit_nodes = 2 * inputs.size();
+  const int num_loop_nodes = root.graph()->num_op_nodes() -
+                             num_nodes_before_loop - num_enter_exit_nodes;
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(root.ToGraph(g));
+  RunGraph(state, executor_type, g,
+           static_cast<int64_t>(num_loop_nodes) * loop_iters +
+               num_nodes_before_loop + num_enter_exit_nodes);
+}
+
+// Registers `benchmark` for ExecutorImpl, in its default and work stealing
+// modes, with the arguments in "...".
+#define BENCHMARK_FOR_MULTI_THREADED_EXECUTORS(benchmark, ...)           \
+  BENCHMARK_CAPTURE(benchmark, executor, "")->UseRealTime() __VA_ARGS__; \
+  BENCHMARK_CAPTURE(benchmark, work_stealing, "WORK_STEALING")           \
+      ->UseRealTime() __VA_ARGS__
+
+// Also registers `benchmark` for SingleThreadedExecutorImpl, which does not
+// support control flow.
+#define BENCHMARK_FOR_ALL_EXECUTORS(benchmark, ...)               \
+  BENCHMARK_FOR_MULTI_THREADED_EXECUTORS(benchmark, __VA_ARGS__); \
+  BENCHMARK_CAPTURE(benchmark, single_threaded,                   \
+                    "SINGLE_THREADED_EXECUTOR")                   \
+      ->UseRealTime() __VA_ARGS__
+
+BENCHMARK_FOR_ALL_EXECUTORS(BM_Chain, ->Arg(16)->Arg(1024)->Arg(16384));
+BENCHMARK_FOR_ALL_EXECUTORS(BM_FanOut, ->Arg(16)->Arg(1024)->Arg(16384));
+BENCHMARK_FOR_ALL_EXECUTORS(BM_SmallKernels,
+                            ->ArgPair(1, 1024)
+                            ->ArgPair(64, 64)
+                            ->ArgPair(1024, 16));
+BENCHMARK_FOR_MULTI_THREADED_EXECUTORS(BM_WhileLoop,
+                                       ->Arg(10)->Arg(1000)->Arg(10000));
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,7 +25,9 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -76,9 +78,9 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
-    const int version = graph->versions().producer();
+  // Returns the parameters of an executor of a graph of version 'version' on
+  // device_.
+  LocalExecutorParams Params(int version) {
     LocalExecutorParams params;
     params.device = device_.get();
     params.create_kernel =
@@ -90,9 +92,23 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
+    return params;
+  }
+
+  // Resets executor_ with a new executor based on a graph 'gdef'. Uses the
+  // executor registered as 'executor_type' if not empty.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
+    const LocalExecutorParams params = Params(graph->versions().producer());
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -265,6 +281,21 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -300,6 +331,23 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
     rendez->Unref();
   }
 }
+
+TEST_F(ExecutorTest, WorkStealingConcurrentAddAssign) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildConcurrentAddAssign(g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
 #endif
 
 TEST_F(ExecutorTest, SimpleSwitchLive) {
@@ -442,6 +490,68 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
+TEST_F(ExecutorTest, MarksTransitiveCollectiveInputs) {
+  // _Send uses distributed communication, like the collective ops. a, b and
+  // c feed it through data edges, and e only through a control edge.
+  //
+  // a -> b -> c -> _Send
+  // d -> e ----------^
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* a = test::graph::Constant(g.get(), V(1.0));
+  Node* b = test::graph::Identity(g.get(), a);
+  Node* c = test::graph::Add(g.get(), b, b);
+  Node* send = test::graph::Send(g.get(), c, "c", BOB, 1, ALICE);
+  Node* d = test::graph::Constant(g.get(), V(2.0));
+  Node* e = test::graph::Identity(g.get(), d);
+  g->AddControlEdge(e, send);
+
+  ImmutableExecutorState state(Params(g->versions().producer()));
+  TF_ASSERT_OK(state.Initialize(*g));
+  const GraphView& gview = state.graph_view();
+  EXPECT_TRUE(state.has_collective_inputs());
+  EXPECT_TRUE(gview.node(a->id())->is_collective_input);
+  EXPECT_TRUE(gview.node(b->id())->is_collective_input);
+  EXPECT_TRUE(gview.node(c->id())->is_collective_input);
+  EXPECT_FALSE(gview.node(send->id())->is_collective_input);
+  EXPECT_FALSE(gview.node(d->id())->is_collective_input);
+  EXPECT_FALSE(gview.node(e->id())->is_collective_input);
+}
+
+TEST_F(ExecutorTest, NoCollectiveInputsWithoutCollectives) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* a = test::graph::Constant(g.get(), V(1.0));
+  Node* b = test::graph::Identity(g.get(), a);
+
+  ImmutableExecutorState state(Params(g->versions().producer()));
+  TF_ASSERT_OK(state.Initialize(*g));
+  EXPECT_FALSE(state.has_collective_inputs());
+  EXPECT_FALSE(state.graph_view().node(a->id())->is_collective_input);
+  EXPECT_FALSE(state.graph_view().node(b->id())->is_collective_input);
+}
+
+TEST_F(ExecutorTest, CollectiveInputsRunFirst) {
+  // Sends the result of a chain of ops, next to many independent ops: the
+  // collective inputs are partitioned first without changing the result.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  Node* sum = in;
+  for (int i = 0; i < 10; ++i) {
+    test::graph::Identity(g.get(), in);
+    sum = test::graph::Add(g.get(), sum, in);
+  }
+  test::graph::Send(g.get(), sum, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(11.0, V(out));
+}
+
 static void BM_executor(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int depth = state.range(1);
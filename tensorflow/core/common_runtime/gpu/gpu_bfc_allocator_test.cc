@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/framework/device_id.h"
+#include "tsl/lib/core/bits.h"
 #include "tsl/lib/gtl/inlined_vector.h"
 #include "tsl/lib/random/simple_philox.h"
 #include "tsl/platform/logging.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tsl/platform/test_benchmark.h"
 #include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
+#include "tsl/profiler/lib/scoped_memory_debug_annotation.h"
 
 namespace tsl {
 namespace {
@@ -299,6 +301,91 @@ TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   }
 }
 
+TEST_P(GPUBFCAllocatorTest, ThreadCacheReusesFreedChunks) {
+  GPUBFCAllocator::Options options;
+  options.thread_cache_bytes = 1 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  void* p1 = a.AllocateRaw(1, 1000);
+  a.DeallocateRaw(p1);
+  // Served from the thread cache: the chunk is still in use for the bins.
+  void* p2 = a.AllocateRaw(1, 900);
+  EXPECT_EQ(p1, p2);
+  CheckStats(&a, 1, 1024, 1024, 1024);
+
+  // Chunks above `thread_cache_max_chunk_bytes` are not cached.
+  void* large = a.AllocateRaw(1, 1 << 20);
+  a.DeallocateRaw(large);
+  CheckStats(&a, 2, 1024, 1024 + (1 << 20), 1 << 20);
+  a.DeallocateRaw(p2);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCacheIsFlushedUnderPressure) {
+  GPUBFCAllocator::Options options;
+  options.thread_cache_bytes = 1 << 20;
+  constexpr size_t kChunkSize = 64 << 10;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 20, "GPU_0_bfc", options);
+
+  // Fill the whole pool with cacheable chunks, and cache all of them.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, kChunkSize));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 16 * kChunkSize);
+
+  // The cached chunks are returned to the bins and coalesced.
+  void* big = a.AllocateRaw(1, 8 * kChunkSize);
+  EXPECT_NE(big, nullptr);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 8 * kChunkSize);
+  a.DeallocateRaw(big);
+}
+
+TEST_P(GPUBFCAllocatorTest, TimelineAndFragmentation) {
+  GPUBFCAllocator::Options options;
+  options.timeline_size = 4;
+  constexpr size_t kChunkSize = 64 << 10;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 20, "GPU_0_bfc", options);
+
+  std::vector<void*> ptrs;
+  {
+    tsl::profiler::ScopedMemoryDebugAnnotation annotation("alloc_op",
+                                                          /*step_id=*/7);
+    for (int i = 0; i < 4; ++i) {
+      ptrs.push_back(a.AllocateRaw(1, kChunkSize));
+    }
+  }
+  // Leaves two free chunks of `kChunkSize` bytes in the same bin.
+  a.DeallocateRaw(ptrs[0]);
+  a.DeallocateRaw(ptrs[2]);
+
+  MemoryDump md = a.RecordMemoryMap();
+  // Only the last four events are kept, oldest first.
+  ASSERT_EQ(md.event_size(), 4);
+  EXPECT_EQ(md.event(0).action_count(), 2);
+  EXPECT_TRUE(md.event(0).is_allocation());
+  EXPECT_EQ(md.event(0).address(), reinterpret_cast<uint64>(ptrs[2]));
+  EXPECT_EQ(md.event(0).size(), kChunkSize);
+  EXPECT_EQ(md.event(0).op_name(), "alloc_op");
+  EXPECT_EQ(md.event(0).step_id(), 7);
+  EXPECT_EQ(md.event(1).bytes_in_use(), 4 * kChunkSize);
+  EXPECT_FALSE(md.event(3).is_allocation());
+  EXPECT_EQ(md.event(3).address(), reinterpret_cast<uint64>(ptrs[2]));
+  EXPECT_EQ(md.event(3).bytes_in_use(), 2 * kChunkSize);
+
+  EXPECT_EQ(md.stats().num_regions(), 1);
+  EXPECT_EQ(md.stats().largest_free_chunk(), (1 << 20) - 4 * kChunkSize);
+  const int bin = tsl::Log2Floor64(kChunkSize >> 8);
+  EXPECT_EQ(md.bin_summary(bin).largest_free_chunk(), kChunkSize);
+  EXPECT_FLOAT_EQ(md.bin_summary(bin).fragmentation(), 0.5);
+
+  a.DeallocateRaw(ptrs[1]);
+  a.DeallocateRaw(ptrs[3]);
+}
+
 TEST_P(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   GPUBFCAllocator a(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
   GPUBFCAllocator b(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
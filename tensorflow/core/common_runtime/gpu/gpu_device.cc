@@ -1861,8 +1861,10 @@ Status BaseGPUDeviceFactory::CreateDevices(
     auto allocator_adapter = std::make_unique<se::MultiDeviceAdapter>(
         gpu_manager, std::move(allocator_id_stream_tuples));
 
-    // TODO(chuanhao): Use the correct NUMA_NODE.
-    const int64_t numa_node = 0;
+    // The host allocator is shared by the GPUs of the client, so its pinned
+    // memory is placed on the NUMA node closest to the first one.
+    const int numa_node =
+        device_localities.at(tsl::TfDeviceId(0)).numa_node();
 
     std::unique_ptr<tsl::Allocator> pjrt_gpu_host_allocator(
         process_state->GetGpuHostAllocator(/*options=*/{}, numa_node));
@@ -1926,7 +1928,7 @@ Status BaseGPUDeviceFactory::CreateDevices(
       std::unique_ptr<xla::PjRtClient> pjrt_client =
           std::make_unique<xla::StreamExecutorGpuClient>(
               platform_name, xla_client, std::move(pjrt_devices),
-              /*process_index=*/numa_node,
+              /*process_index=*/0,
               /*allocator=*/std::move(allocator_adapter),
               /*host_memory_allocator=*/std::move(pjrt_gpu_host_allocator),
               /*should_stage_host_to_device_transfers=*/true,
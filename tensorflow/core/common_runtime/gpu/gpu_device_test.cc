@@ -21,6 +21,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif  // defined(__linux__)
+
 #include "xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/tests/test_macros.h"
@@ -222,6 +226,44 @@ TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsyncPreallocate)) {
   EXPECT_EQ(status.code(), error::OK);
 }
 
+#if defined(__linux__)
+TEST_F(GPUDeviceTest, PinnedHostAllocationRestoresThreadAffinity) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+
+  // A thread allowed on every CPU has no NUMA node affinity on a multi-node
+  // host, and a single CPU is narrower than any node, so neither mask can be
+  // restored through the node affinity.
+  cpu_set_t all_cpus;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(all_cpus), &all_cpus), 0);
+  cpu_set_t single_cpu;
+  CPU_ZERO(&single_cpu);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &all_cpus)) {
+      CPU_SET(cpu, &single_cpu);
+      break;
+    }
+  }
+  Allocator* allocator = GPUProcessState::singleton()->GetGpuHostAllocator(
+      opts.config.gpu_options(), /*numa_node=*/0);
+  std::vector<void*> ptrs;
+  for (const cpu_set_t& cpuset : {all_cpus, single_cpu}) {
+    ASSERT_EQ(sched_setaffinity(0, sizeof(cpuset), &cpuset), 0);
+    // Kept allocated so that each allocation pins a new region.
+    ptrs.push_back(
+        allocator->AllocateRaw(Allocator::kAllocatorAlignment, 64 << 20));
+    EXPECT_NE(ptrs.back(), nullptr);
+    cpu_set_t thread_cpuset;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(thread_cpuset), &thread_cpuset), 0);
+    EXPECT_TRUE(CPU_EQUAL(&thread_cpuset, &cpuset));
+  }
+  for (void* ptr : ptrs) allocator->DeallocateRaw(ptr);
+  sched_setaffinity(0, sizeof(all_cpus), &all_cpus);
+}
+#endif  // defined(__linux__)
+
 TEST_F(GPUDeviceTest, FailedToParseVisibleDeviceList) {
   SessionOptions opts = MakeSessionOptions("0,abc");
   std::vector<std::unique_ptr<Device>> devices;
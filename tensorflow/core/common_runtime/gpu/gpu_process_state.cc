@@ -21,6 +21,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif  // defined(__linux__)
+
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -43,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/bfc_allocator.h"
 #include "tsl/framework/device_id.h"
@@ -54,6 +59,49 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+// Allocates pinned host memory from a thread bound to `numa_node`, so that the
+// driver places the pinned pages on that node rather than on the node of
+// whichever thread first needs the memory.
+class NumaDeviceHostAllocator : public DeviceHostAllocator {
+ public:
+  NumaDeviceHostAllocator(se::StreamExecutor* stream_exec, int numa_node,
+                          const std::vector<Visitor>& alloc_visitors,
+                          const std::vector<Visitor>& free_visitors)
+      : DeviceHostAllocator(stream_exec, numa_node, alloc_visitors,
+                            free_visitors),
+        numa_node_(numa_node) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    if (port::NUMAGetThreadNodeAffinity() == numa_node_) {
+      return DeviceHostAllocator::Alloc(alignment, num_bytes, bytes_received);
+    }
+#if defined(__linux__)
+    // Saves the exact CPU mask of the thread, which need not be that of a NUMA
+    // node, e.g. when the thread has no node affinity.
+    cpu_set_t thread_cpuset;
+    if (sched_getaffinity(0, sizeof(thread_cpuset), &thread_cpuset) == 0) {
+      port::NUMASetThreadNodeAffinity(numa_node_);
+      void* ptr =
+          DeviceHostAllocator::Alloc(alignment, num_bytes, bytes_received);
+      if (sched_setaffinity(0, sizeof(thread_cpuset), &thread_cpuset) != 0) {
+        LOG(ERROR) << "Could not restore the CPU affinity of the thread after "
+                      "allocating pinned memory on NUMA node "
+                   << numa_node_;
+      }
+      return ptr;
+    }
+#endif  // defined(__linux__)
+    // Without a way to restore the CPU mask, the thread is not rebound.
+    return DeviceHostAllocator::Alloc(alignment, num_bytes, bytes_received);
+  }
+
+ private:
+  const int numa_node_;
+};
+}  // namespace
+
 // NOLINTNEXTLINE(clang-diagnostic-unused-function)
 static bool UseCudaMallocAllocator() {
   const char* allocator_env = std::getenv("TF_GPU_ALLOCATOR");
@@ -295,16 +343,16 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     // we take a unique lock and populate these vectors.
     tf_shared_lock lock(mu_);
 
-    if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
-        !gpu_host_allocators_.empty() &&
-        gpu_host_allocators_[0].recording_allocator != nullptr) {
-      return gpu_host_allocators_[0].recording_allocator.get();
-    }
     if (static_cast<int>(gpu_host_allocators_.size()) > numa_node) {
+      const AllocatorParts& allocator_parts = gpu_host_allocators_[numa_node];
+      if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
+          allocator_parts.recording_allocator != nullptr) {
+        return allocator_parts.recording_allocator.get();
+      }
 #ifdef TF_GPU_USE_PJRT
-      return gpu_host_allocators_[0].allocator_not_owned;
+      return allocator_parts.allocator_not_owned;
 #else
-      return gpu_host_allocators_[0].allocator.get();
+      return allocator_parts.allocator.get();
 #endif  // TF_GPU_USE_PJRT
     }
   }
@@ -345,6 +393,14 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     }
     mem_limit_bytes = limit_mb * (1LL << 20);
   }
+  // Pinned memory reserved when the allocator of a NUMA node is created, so
+  // that the first transfers of a step do not pin memory.
+  int64_t preallocate_mb = 0;
+  Status preallocate_status = tsl::ReadInt64FromEnvVar(
+      "TF_GPU_HOST_MEM_PREALLOCATE_IN_MB", 0, &preallocate_mb);
+  if (!preallocate_status.ok()) {
+    LOG(ERROR) << "GetGpuHostAllocator: " << preallocate_status.message();
+  }
 
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
     while (gpu_host_alloc_visitors_.size() <= numa_node) {
@@ -353,9 +409,20 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     while (gpu_host_free_visitors_.size() <= numa_node) {
       gpu_host_free_visitors_.push_back({});
     }
-    SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+    // Allocators are created for every node up to numa_node.
+    const int allocator_numa_node = gpu_host_allocators_.size();
+    SubAllocator* sub_allocator;
+    if (port::NUMAEnabled()) {
+      sub_allocator = new NumaDeviceHostAllocator(
+          se, allocator_numa_node,
+          gpu_host_alloc_visitors_[allocator_numa_node],
+          gpu_host_free_visitors_[allocator_numa_node]);
+    } else {
+      sub_allocator = new DeviceHostAllocator(
+          se, allocator_numa_node,
+          gpu_host_alloc_visitors_[allocator_numa_node],
+          gpu_host_free_visitors_[allocator_numa_node]);
+    }
 
     tsl::BFCAllocator::Options allocator_opts;
     allocator_opts.allow_growth =
@@ -364,6 +431,19 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
         new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
                               /*name=*/"gpu_host_bfc", allocator_opts);
 
+    if (preallocate_mb > 0) {
+      // The BFC allocator keeps the region after the deallocation.
+      void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                         preallocate_mb * (1LL << 20));
+      if (ptr == nullptr) {
+        LOG(WARNING) << "Could not preallocate " << preallocate_mb
+                     << " MB of pinned host memory on NUMA node "
+                     << allocator_numa_node;
+      } else {
+        allocator->DeallocateRaw(ptr);
+      }
+    }
+
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
       // at the cost of performance.
@@ -390,7 +470,7 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
       ProcessState::MemDesc md;
       md.loc = ProcessState::MemDesc::CPU;
-      md.dev_index = 0;
+      md.dev_index = allocator_numa_node;
       md.gpu_registered = true;
       md.nic_registered = false;
       allocator_parts.recording_allocator =
@@ -400,12 +480,12 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     }
   }
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
-    return gpu_host_allocators_[0].recording_allocator.get();
+    return gpu_host_allocators_[numa_node].recording_allocator.get();
   } else {
 #ifdef TF_GPU_USE_PJRT
-    return gpu_host_allocators_[0].allocator_not_owned;
+    return gpu_host_allocators_[numa_node].allocator_not_owned;
 #else
-    return gpu_host_allocators_[0].allocator.get();
+    return gpu_host_allocators_[numa_node].allocator.get();
 #endif  // TF_GPU_USE_PJRT
   }
 }
@@ -17,15 +17,20 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_scheduling_metrics_storage.h"
 #include "tsl/framework/serving_device_selector.h"
 
@@ -42,12 +47,25 @@ ABSL_CONST_INIT int64_t (*NowNs)() = +[]() -> int64_t {
 
 using DeviceStates = GpuServingDeviceSelector::DeviceStates;
 
+namespace {
+int64_t NumEnqueuedPrograms(
+    const tsl::ServingDeviceSelector::DeviceState& device_state) {
+  int64_t num_programs = 0;
+  for (const auto& programs : device_state.enqueued_programs) {
+    num_programs += programs.size();
+  }
+  return num_programs;
+}
+}  // namespace
+
 GpuServingDeviceSelector::GpuServingDeviceSelector(
     const int num_devices,
     std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy)
     : device_states_(num_devices),
       device_selector_policy_(std::move(device_selector_policy)),
-      req_id_counter_(0) {}
+      req_id_counter_(0),
+      low_memory_(num_devices, false),
+      queue_depths_(num_devices) {}
 
 tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
     absl::string_view program_fingerprint) {
@@ -56,13 +74,22 @@ tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
   device_states.states = absl::Span<const DeviceState>(device_states_);
   auto [it, emplaced] =
       execution_info_.try_emplace(program_fingerprint, ExecutionInfo());
-  const int device_index =
+  int device_index =
       device_selector_policy_->SelectDevice(program_fingerprint, device_states);
+  // Overrides the policy if it selected a device the program should not run
+  // on.
+  std::optional<std::vector<int>> candidates =
+      CandidateDevices(program_fingerprint);
+  if (candidates.has_value() &&
+      !absl::c_linear_search(*candidates, device_index)) {
+    device_index = LeastLoadedDevice(*candidates);
+  }
 
   ServingDeviceSelector::EnqueueHelper(
       device_states_.at(device_index), device_index, it->second,
       program_fingerprint, /*priority=*/0, req_id_counter_++,
       /*priority_queue_count=*/1, /*prefetch_results=*/0, NowNs());
+  UpdateQueueDepth(device_index);
 
   return tsl::DeviceReservation(device_index, this);
 }
@@ -89,6 +116,7 @@ void GpuServingDeviceSelector::Enqueue(int32_t index_on_host,
                                        /*priority=*/0, /*req_id=*/-1,
                                        /*priority_queue_count=*/1,
                                        /*prefetch_results=*/0, NowNs());
+  UpdateQueueDepth(index_on_host);
 
   int64_t total_estimated_time_ns = TotalEstimatedTimeTillIdleNs();
   GpuSchedulingMetricsStorage::GetGlobalStorage().TotalGpuLoadNs().Set(
@@ -101,6 +129,7 @@ void GpuServingDeviceSelector::Completed(int32_t index_on_host,
   DeviceState& device_state = device_states_.at(index_on_host);
   ServingDeviceSelector::CompletedHelper(device_state, index_on_host, 0,
                                          min_exec_time_, had_error, NowNs());
+  UpdateQueueDepth(index_on_host);
 
   int64_t total_estimated_time_ns = TotalEstimatedTimeTillIdleNs();
   GpuSchedulingMetricsStorage::GetGlobalStorage().TotalGpuLoadNs().Set(
@@ -116,6 +145,79 @@ int64_t GpuServingDeviceSelector::TotalEstimatedTimeTillIdleNs() {
   return total_gpu_load_ns;
 }
 
+void GpuServingDeviceSelector::SetResidentDevices(
+    absl::string_view fingerprint, absl::Span<const int> device_indices) {
+  absl::MutexLock lock(&mu_);
+  if (device_indices.empty()) {
+    resident_devices_.erase(fingerprint);
+    return;
+  }
+  std::vector<int>& devices = resident_devices_[fingerprint];
+  devices.clear();
+  for (const int device_index : device_indices) {
+    if (device_index < 0 || device_index >= device_states_.size()) {
+      LOG(ERROR) << "Ignoring invalid resident device " << device_index
+                 << " of program " << fingerprint;
+      continue;
+    }
+    devices.push_back(device_index);
+  }
+  if (devices.empty()) resident_devices_.erase(fingerprint);
+}
+
+void GpuServingDeviceSelector::UpdateFreeMemory(int32_t index_on_host,
+                                                int64_t free_bytes,
+                                                int64_t total_bytes) {
+  absl::MutexLock lock(&mu_);
+  low_memory_.at(index_on_host) =
+      total_bytes > 0 && free_bytes < kMinFreeMemoryFraction * total_bytes;
+}
+
+void GpuServingDeviceSelector::UpdateQueueDepth(int32_t index_on_host) {
+  queue_depths_.at(index_on_host)
+      .Set(NumEnqueuedPrograms(device_states_.at(index_on_host)));
+}
+
+std::optional<std::vector<int>> GpuServingDeviceSelector::CandidateDevices(
+    absl::string_view fingerprint) {
+  std::vector<int> devices;
+  auto resident = resident_devices_.find(fingerprint);
+  if (resident != resident_devices_.end()) {
+    devices = resident->second;
+  } else {
+    if (!absl::c_linear_search(low_memory_, true)) return std::nullopt;
+    for (int i = 0; i < device_states_.size(); ++i) devices.push_back(i);
+  }
+  std::vector<int> candidates;
+  for (const int device_index : devices) {
+    if (!low_memory_[device_index]) candidates.push_back(device_index);
+  }
+  if (candidates.empty()) {
+    if (resident == resident_devices_.end()) return std::nullopt;
+    return devices;
+  }
+  return candidates;
+}
+
+int GpuServingDeviceSelector::LeastLoadedDevice(
+    absl::Span<const int> candidates) {
+  const int64_t now_ns = NowNs();
+  int selected_device = candidates.front();
+  std::tuple<int64_t, int64_t> min_load;
+  for (int i = 0; i < candidates.size(); ++i) {
+    const std::tuple<int64_t, int64_t> load = {
+        ServingDeviceSelector::EstimateTimeTillIdleNs(
+            device_states_.at(candidates[i]), 0,
+            min_exec_time_.value_or(kDefaultEstimateNs), now_ns),
+        queue_depths_.at(candidates[i]).Get()};
+    if (i == 0 || load < min_load) {
+      selected_device = candidates[i];
+      min_load = load;
+    }
+  }
+  return selected_device;
+}
+
 /*static*/ void GpuServingDeviceSelector::OverwriteNowNsFunctionForTest(
     int64_t (*now_ns)()) {
   NowNs = now_ns;
@@ -17,14 +17,19 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/resource_base.h"
+#include "tsl/framework/real_time_in_memory_metric.h"
 #include "tsl/framework/serving_device_selector.h"
 
 namespace tensorflow {
@@ -71,6 +76,27 @@ class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
   // time stats to avoid incorrect estimates.
   void Completed(int32_t index_on_host, bool had_error = false);
 
+  // Restricts the program `fingerprint` to the devices `device_indices`, e.g.
+  // because its weights are only resident on them. An empty `device_indices`
+  // removes the restriction.
+  void SetResidentDevices(absl::string_view fingerprint,
+                          absl::Span<const int> device_indices);
+
+  // Records the free memory of the device `index_on_host`. Devices with less
+  // than kMinFreeMemoryFraction of their memory free are avoided, unless all
+  // the devices a program may run on are.
+  void UpdateFreeMemory(int32_t index_on_host, int64_t free_bytes,
+                        int64_t total_bytes);
+
+  static constexpr double kMinFreeMemoryFraction = 0.05;
+
+  // Gets the metrics for the number of programs this selector has queued on
+  // the device `index_on_host`.
+  const tsl::RealTimeInMemoryMetric<int64_t>& QueueDepth(
+      int32_t index_on_host) const {
+    return queue_depths_.at(index_on_host);
+  }
+
  private:
   friend class ServingDeviceSelectorTestHelper;
   static void OverwriteNowNsFunctionForTest(int64_t (*now_ns)());
@@ -81,6 +107,20 @@ class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
   // Only for metrics reporting purposes.
   int64_t TotalEstimatedTimeTillIdleNs() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Exports the number of programs queued on the device `index_on_host`.
+  void UpdateQueueDepth(int32_t index_on_host)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the devices the program `fingerprint` may run on, or nullopt if
+  // it may run on any device.
+  std::optional<std::vector<int>> CandidateDevices(
+      absl::string_view fingerprint) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the device of `candidates` which is estimated to become idle the
+  // soonest, then with the lowest QueueDepth().
+  int LeastLoadedDevice(absl::Span<const int> candidates)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   absl::Mutex mu_;
   absl::FixedArray<DeviceState, 8> device_states_ ABSL_GUARDED_BY(mu_);
   std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy_;
@@ -89,6 +129,13 @@ class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
   absl::node_hash_map<std::string, ExecutionInfo> execution_info_
       ABSL_GUARDED_BY(mu_);
   std::optional<int64_t> min_exec_time_ ABSL_GUARDED_BY(mu_);
+  // Map from program fingerprint to the devices holding its weights.
+  absl::flat_hash_map<std::string, std::vector<int>> resident_devices_
+      ABSL_GUARDED_BY(mu_);
+  // Whether each device is low on free memory.
+  absl::FixedArray<bool, 8> low_memory_ ABSL_GUARDED_BY(mu_);
+  // Set with `mu_` held, and may be read without it.
+  absl::FixedArray<tsl::RealTimeInMemoryMetric<int64_t>, 8> queue_depths_;
 };
 
 }  // namespace gpu
@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/time/clock.h"
@@ -135,6 +136,94 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+TEST(GpuServingDeviceSelector, ResidentDevices) {
+  GpuServingDeviceSelector selector(/*num_devices=*/4,
+                                    std::make_unique<tsl::RoundRobinPolicy>());
+  selector.SetResidentDevices("large_model", {2, 3});
+  std::vector<tsl::DeviceReservation> reservations;
+  for (int i = 0; i < 4; ++i) {
+    reservations.push_back(selector.ReserveDevice("large_model"));
+    EXPECT_GE(reservations.back().device_index(), 2);
+  }
+  // The programs are spread over the resident devices.
+  EXPECT_NE(reservations[0].device_index(), reservations[1].device_index());
+
+  selector.SetResidentDevices("large_model", {});
+  reservations.clear();
+  for (int i = 0; i < 4; ++i) {
+    reservations.push_back(selector.ReserveDevice("large_model"));
+  }
+  EXPECT_EQ(reservations[0].device_index(), 0);
+}
+
+TEST(GpuServingDeviceSelector, AvoidsDevicesLowOnMemory) {
+  GpuServingDeviceSelector selector(/*num_devices=*/2,
+                                    std::make_unique<tsl::RoundRobinPolicy>());
+  selector.UpdateFreeMemory(0, /*free_bytes=*/1, /*total_bytes=*/100);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(selector.ReserveDevice("TensorFlow").device_index(), 1);
+  }
+
+  // Programs still run when all the devices are low on memory.
+  selector.UpdateFreeMemory(1, /*free_bytes=*/1, /*total_bytes=*/100);
+  EXPECT_EQ(selector.ReserveDevice("TensorFlow").device_index(), 0);
+
+  selector.UpdateFreeMemory(0, /*free_bytes=*/50, /*total_bytes=*/100);
+  selector.UpdateFreeMemory(1, /*free_bytes=*/50, /*total_bytes=*/100);
+  EXPECT_EQ(selector.ReserveDevice("TensorFlow").device_index(), 1);
+  EXPECT_EQ(selector.ReserveDevice("TensorFlow").device_index(), 0);
+}
+
+TEST(GpuServingDeviceSelector, ExportsQueueDepth) {
+  GpuServingDeviceSelector selector(/*num_devices=*/2,
+                                    std::make_unique<tsl::RoundRobinPolicy>());
+  selector.Enqueue(1, "TensorFlow");
+  selector.Enqueue(1, "TensorFlow");
+  EXPECT_EQ(selector.QueueDepth(0).Get(), 0);
+  EXPECT_EQ(selector.QueueDepth(1).Get(), 2);
+  selector.Completed(1);
+  EXPECT_EQ(selector.QueueDepth(1).Get(), 1);
+  selector.Completed(1);
+  EXPECT_EQ(selector.QueueDepth(1).Get(), 0);
+
+  {
+    tsl::DeviceReservation reservation = selector.ReserveDevice("TensorFlow");
+    EXPECT_EQ(selector.QueueDepth(reservation.device_index()).Get(), 1);
+  }
+  EXPECT_EQ(selector.QueueDepth(0).Get(), 0);
+  EXPECT_EQ(selector.QueueDepth(1).Get(), 0);
+}
+
+TEST(GpuServingDeviceSelector, QueueDepthIsPerSelector) {
+  GpuServingDeviceSelector selector(/*num_devices=*/2,
+                                    std::make_unique<tsl::RoundRobinPolicy>());
+  GpuServingDeviceSelector other_selector(
+      /*num_devices=*/2, std::make_unique<tsl::RoundRobinPolicy>());
+  selector.Enqueue(1, "TensorFlow");
+  other_selector.Enqueue(1, "TensorFlow");
+  other_selector.Enqueue(1, "TensorFlow");
+  other_selector.Completed(1);
+  other_selector.Completed(1);
+  EXPECT_EQ(selector.QueueDepth(1).Get(), 1);
+  EXPECT_EQ(other_selector.QueueDepth(1).Get(), 0);
+}
+
+TEST(GpuServingDeviceSelector, PicksTheShortestQueueAmongTies) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(/*num_devices=*/3,
+                                    std::make_unique<tsl::RoundRobinPolicy>());
+  selector.SetResidentDevices("large_model", {1, 2});
+  // Programs that never completed are estimated to take no time, so both
+  // devices become idle at the same time.
+  selector.Enqueue(1, "TensorFlow");
+  selector.Enqueue(1, "TensorFlow");
+  selector.Enqueue(2, "TensorFlow");
+  // The policy picks device 0, on which the program may not run.
+  tsl::DeviceReservation reservation = selector.ReserveDevice("large_model");
+  EXPECT_EQ(reservation.device_index(), 2);
+  EXPECT_EQ(selector.QueueDepth(2).Get(), 2);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_debug_info_builder.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -54,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -63,6 +65,28 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// Graphs with fewer nodes are not worth preparing in parallel.
+static constexpr int kMinNodeDefsToPrepareInParallel = 1024;
+
+// Returns the pool which prepares the NodeDefs of large graphs for all the
+// conversions of the process that are not given one, or nullptr unless
+// TF_GRAPH_CONSTRUCTOR_NUM_THREADS opts into it with more than one thread.
+thread::ThreadPool* SharedPrepareThreadPool() {
+  static thread::ThreadPool* pool = []() -> thread::ThreadPool* {
+    int64_t num_threads;
+    Status status = ReadInt64FromEnvVar("TF_GRAPH_CONSTRUCTOR_NUM_THREADS",
+                                        /*default_val=*/0, &num_threads);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      return nullptr;
+    }
+    if (num_threads <= 1) return nullptr;
+    return new thread::ThreadPool(Env::Default(), "graph_constructor",
+                                  std::min<int64_t>(num_threads, 32));
+  }();
+  return pool;
+}
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge" ||
          node_def.op() == "_XlaMerge";
@@ -107,7 +131,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -162,6 +187,9 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // Prepares the NodeDefs of large graphs in parallel if set. Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef absl::Span<const NodeDef* const> NodeDefSlice;
@@ -223,6 +251,10 @@ class GraphConstructor {
   Status BuildNodeIndex();
   Status InitFromEdges();
   Status Convert();
+  // Adds the default attrs to, and validates, the NodeDefs of a large graph in
+  // parallel. The results are used by Convert() in place of its own lookup and
+  // validation, so that errors are still reported in topological order.
+  void PrepareNodeDefsInParallel();
   Status AddBackEdges();
   Status UpdateVersionDef();
   Status PopulateReturnTensors();
@@ -300,6 +332,9 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Returns the i^th node in the graph for in-place modification, or nullptr
+  // if the nodes are not owned. Must not be called after consume_node_def(i).
+  virtual NodeDef* mutable_node_def(int i) { return nullptr; }
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -406,6 +441,10 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // Set by PrepareNodeDefsInParallel(). Empty if the NodeDefs were not
+  // prepared, otherwise the status of preparing each NodeDef.
+  std::vector<Status> prepare_status_;
+
   GraphConstructor(const GraphConstructor&) = delete;
   void operator=(const GraphConstructor&) = delete;
 };
@@ -477,6 +516,11 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  NodeDef* mutable_node_def(int i) override {
+    CHECK(!is_consumed_[i])
+        << "NodeDef " << i << " accessed after it was consumed.";
+    return graph_def_.mutable_node(i);
+  }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   std::optional<FunctionDefLibrary> consume_library() override {
     return std::move(*graph_def_.mutable_library());
@@ -1185,6 +1229,9 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The functions must be added first, since they are ops of the graph.
+  PrepareNodeDefsInParallel();
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1297,6 +1344,8 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (!prepare_status_.empty()) {
+      TF_RETURN_IF_ERROR(prepare_status_[o]);
     } else {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
@@ -1364,6 +1413,37 @@ Status GraphConstructor::Convert() {
   return absl::OkStatus();
 }
 
+void GraphConstructor::PrepareNodeDefsInParallel() {
+  // When importing, Convert() modifies the NodeDefs before validating them.
+  const int64_t num_nodes = node_def_count();
+  if (opts_.importing || num_nodes < kMinNodeDefsToPrepareInParallel ||
+      mutable_node_def(0) == nullptr) {
+    return;
+  }
+  thread::ThreadPool* pool = opts_.thread_pool != nullptr
+                                 ? opts_.thread_pool
+                                 : SharedPrepareThreadPool();
+  if (pool == nullptr) return;
+
+  prepare_status_.resize(num_nodes);
+  pool->ParallelFor(
+      num_nodes, /*cost_per_unit=*/10000, [this](int64_t start, int64_t end) {
+        for (int64_t i = start; i < end; ++i) {
+          NodeDef* node_def = mutable_node_def(i);
+          const OpDef* op_def;
+          Status& status = prepare_status_[i];
+          status = g_->op_registry()->LookUpOpDef(node_def->op(), &op_def);
+          if (!status.ok()) continue;
+          if (opts_.add_default_attributes) {
+            AddDefaultsToNodeDef(*op_def, node_def);
+          }
+          if (opts_.validate_nodes) {
+            status = ValidateNodeDef(*node_def, *op_def);
+          }
+        }
+      });
+}
+
 Status GraphConstructor::AddBackEdges() {
   // Add the back edges after all nodes are created.
   for (const auto& e : back_edges_) {
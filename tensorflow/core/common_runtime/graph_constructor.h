@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 
 namespace tensorflow {
 class ShapeRefiner;
@@ -52,6 +53,13 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If set, the NodeDefs of large graphs get their default attrs and are
+  // validated on this pool, before the graph is built. Only used when
+  // ConvertGraphDefToGraph owns the GraphDef. Not owned. If null, a pool
+  // shared by the process is used when TF_GRAPH_CONSTRUCTOR_NUM_THREADS is
+  // set above 1, and the NodeDefs are prepared serially otherwise.
+  thread::ThreadPool* thread_pool = nullptr;
 };
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
@@ -898,6 +898,50 @@ TEST_F(GraphConstructorTest, SimpleModel) {
   EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
 }
 
+TEST_F(GraphConstructorTest, LargeModelPreparedInParallel) {
+  thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/4);
+  GraphDef gdef;
+  for (int i = 0; i < 2000; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestDefaultAttr");
+  }
+  gdef.add_node()->set_name("input");
+  gdef.mutable_node(gdef.node_size() - 1)->set_op("TestInput");
+  NodeDef* mul = gdef.add_node();
+  mul->set_name("t1");
+  mul->set_op("TestMul");
+  mul->add_input("input");
+  mul->add_input("input:1");
+  gdef.mutable_node(0)->add_input("^t1");
+
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &thread_pool;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, std::move(gdef), &graph_));
+  EXPECT_EQ(graph_.num_op_nodes(), 2002);
+  Node* n = FindNode("n1999");
+  ASSERT_NE(n, nullptr);
+  int64_t default_int;
+  TF_EXPECT_OK(GetNodeAttr(n->attrs(), "default_int", &default_int));
+  EXPECT_EQ(default_int, 31415);
+  EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
+  EXPECT_TRUE(HasControlEdge("t1", "n0"));
+
+  // Errors are reported in the same order as when preparing serially.
+  GraphDef bad_gdef;
+  for (int i = 0; i < 2000; ++i) {
+    NodeDef* node = bad_gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op(i == 1500   ? "FirstUnknownOp"
+                 : i == 1800 ? "SecondUnknownOp"
+                             : "TestDefaultAttr");
+  }
+  Graph bad_graph(OpRegistry::Global());
+  Status s = ConvertGraphDefToGraph(opts, std::move(bad_gdef), &bad_graph);
+  EXPECT_TRUE(absl::StrContains(s.message(), "FirstUnknownOp")) << s;
+}
+
 TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   ExpectOK(
       "node { name: 'W1' op: 'TestParams' }"
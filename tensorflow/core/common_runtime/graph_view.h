@@ -85,6 +85,10 @@ struct NodeItem {
                                     // node's input types.
   bool is_distributed_communication : 1;  // True iff the op is registered to
                                           // use distributed communication.
+  bool is_collective_input : 1;  // True iff this node transitively feeds,
+                                 // through data edges, an op using
+                                 // distributed communication, e.g. a
+                                 // collective.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hardware_counters.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/logging.h"
+#endif
+
+namespace tensorflow {
+
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// The perf events of a thread, read together as a group whose leader counts
+// the cycles.
+class ThreadPerfEvents {
+ public:
+  ThreadPerfEvents() {
+    fds_[0] = Open(PERF_COUNT_HW_CPU_CYCLES, /*group_fd=*/-1);
+    fds_[1] = Open(PERF_COUNT_HW_INSTRUCTIONS, fds_[0]);
+    fds_[2] = Open(PERF_COUNT_HW_CACHE_MISSES, fds_[0]);
+    for (int fd : fds_) {
+      if (fd < 0) {
+        LOG_FIRST_N(WARNING, 1)
+            << "Hardware counters are not available: " << strerror(errno);
+        return;
+      }
+    }
+    ok_ = ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0;
+  }
+
+  ~ThreadPerfEvents() {
+    for (int fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+  }
+
+  bool Read(HardwareCounterValues* values) const {
+    if (!ok_) return false;
+    // Layout of a PERF_FORMAT_GROUP read.
+    struct {
+      uint64_t nr;
+      uint64_t values[kNumEvents];
+    } data;
+    if (read(fds_[0], &data, sizeof(data)) != sizeof(data) ||
+        data.nr != kNumEvents) {
+      return false;
+    }
+    values->cycles = data.values[0];
+    values->instructions = data.values[1];
+    values->llc_misses = data.values[2];
+    return true;
+  }
+
+ private:
+  static constexpr int kNumEvents = 3;
+
+  static int Open(uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group_fd < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                   group_fd, /*flags=*/0);
+  }
+
+  int fds_[kNumEvents] = {-1, -1, -1};
+  bool ok_ = false;
+
+  ThreadPerfEvents(const ThreadPerfEvents&) = delete;
+  void operator=(const ThreadPerfEvents&) = delete;
+};
+
+}  // namespace
+
+bool ReadThreadHardwareCounters(HardwareCounterValues* values) {
+  static thread_local ThreadPerfEvents events;
+  return events.Read(values);
+}
+#else
+bool ReadThreadHardwareCounters(HardwareCounterValues* values) {
+  return false;
+}
+#endif  // defined(__linux__) && !defined(__ANDROID__)
+
+}  // namespace tensorflow
@@ -0,0 +1,39 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+
+// CPU hardware event counts of a thread, in user space.
+struct HardwareCounterValues {
+  int64_t cycles = 0;
+  int64_t instructions = 0;
+  int64_t llc_misses = 0;
+};
+
+// Reads the hardware counters of the calling thread into `values`, using Linux
+// perf events. The counters of a thread are opened the first time it reads
+// them and stay open until it exits, so a read is a single system call.
+//
+// Returns false if the counters are not available, e.g. on other platforms, on
+// machines without a (virtual) PMU, or if perf_event_paranoid forbids them.
+bool ReadThreadHardwareCounters(HardwareCounterValues* values);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
@@ -0,0 +1,41 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hardware_counters.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(HardwareCountersTest, CountersIncrease) {
+  HardwareCounterValues start;
+  if (!ReadThreadHardwareCounters(&start)) {
+    GTEST_SKIP() << "Hardware counters are not available.";
+  }
+  std::vector<float> data(1 << 20, 1.0f);
+  float sum = 0;
+  for (float x : data) sum += x;
+  HardwareCounterValues end;
+  ASSERT_TRUE(ReadThreadHardwareCounters(&end));
+  EXPECT_EQ(sum, data.size());
+  EXPECT_GT(end.cycles, start.cycles);
+  EXPECT_GT(end.instructions, start.instructions + data.size());
+  EXPECT_GE(end.llc_misses, start.llc_misses);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,354 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+namespace {
+// Key to be used for BufRendezvous by HierarchicalRingReducer.
+string HierarchicalRingBufKey(const string& exec_key, int phase, int step,
+                              int src_rank) {
+  return strings::StrCat(exec_key, ":", phase, ":", step, ":", src_rank);
+}
+
+// Indices of the passes of the algorithm, used in the buffer keys.
+constexpr int kIntraTaskReducePhase = 0;
+constexpr int kInterTaskReducePhase = 1;
+constexpr int kInterTaskGatherPhase = 2;
+constexpr int kIntraTaskGatherPhase = 3;
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr), devices_per_task_(0) {}
+
+/* static */
+bool HierarchicalRingReducer::IsSupported(const CollGroupParams& group) {
+  if (group.num_tasks <= 0 || group.group_size % group.num_tasks != 0 ||
+      static_cast<int>(group.members.size()) != group.group_size) {
+    return false;
+  }
+  const int devices_per_task = group.group_size / group.num_tasks;
+  for (int di = 0; di < group.group_size; ++di) {
+    // Devices of the same task must be adjacent, in blocks of
+    // `devices_per_task`.
+    const bool starts_task = di % devices_per_task == 0;
+    const bool same_task_as_prior =
+        di > 0 && group.members[di].task == group.members[di - 1].task;
+    if (starts_task == same_task_as_prior) return false;
+  }
+  return true;
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalRingReduce");
+  const CollGroupParams& group = col_params->group;
+  if (!IsSupported(group)) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires the same number of devices on each "
+        "task, but group ",
+        group.group_key, " has ", group.group_size, " devices on ",
+        group.num_tasks, " tasks");
+  }
+  const int devices_per_task = group.group_size / group.num_tasks;
+  const int task_idx = col_params->default_rank / devices_per_task;
+  const int local_idx = col_params->default_rank % devices_per_task;
+
+  auto& impl = col_params->instance.impl_details;
+  impl.subdiv_permutations.assign(2, {});
+  for (int li = 0; li < devices_per_task; ++li) {
+    impl.subdiv_permutations[0].push_back(task_idx * devices_per_task + li);
+  }
+  for (int ti = 0; ti < group.num_tasks; ++ti) {
+    impl.subdiv_permutations[1].push_back(ti * devices_per_task + local_idx);
+  }
+  col_params->subdiv_rank = {local_idx, task_idx};
+
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  devices_per_task_ =
+      col_params_->group.group_size / col_params_->group.num_tasks;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    // We are running in a blockable thread and the callback can't block so
+    // just wait here on the copy.
+    Notification note;
+    Status status;
+    tsl::profiler::TraceMe activity("MemCpyAsync",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+  done(RunHierarchicalReduce());
+}
+
+Status HierarchicalRingReducer::RunHierarchicalReduce() {
+  const int num_tasks = col_params_->group.num_tasks;
+  const auto& perms = col_params_->instance.impl_details.subdiv_permutations;
+  const int local_idx = col_params_->subdiv_rank[0];
+  const int task_idx = col_params_->subdiv_rank[1];
+  Allocator* allocator = col_ctx_->device->GetAllocator(
+      col_ctx_->op_ctx->output_alloc_attr(0));
+
+  // The output is split into one chunk per device of the task. After the
+  // task-local reduce-scatter this device owns chunk `owned_chunk`.
+  std::unique_ptr<CollectiveAdapter> ca(
+      MakeCollectiveAdapter(col_ctx_->output, devices_per_task_, allocator));
+  Status s = RunRingPass(kIntraTaskReducePhase, perms[0], local_idx,
+                         /*reduce=*/true, ca.get());
+  const int owned_chunk = (local_idx + 1) % devices_per_task_;
+  // Chunk sizes only depend on the local index, so devices which skip the
+  // inter-task passes because their chunk is empty all do.
+  if (s.ok() && ca->ChunkBytes(owned_chunk) > 0) {
+    // The owned chunk is reduced across tasks by splitting it again, into one
+    // chunk per task. `inter_ca` takes the alias tensor over, but still
+    // writes to the buffer of `ca`.
+    Tensor owned = ca->ChunkAlias(owned_chunk);
+    std::unique_ptr<CollectiveAdapter> inter_ca(
+        MakeCollectiveAdapter(&owned, num_tasks, allocator));
+    s = RunRingPass(kInterTaskReducePhase, perms[1], task_idx,
+                    /*reduce=*/true, inter_ca.get());
+    if (s.ok() && col_params_->final_op) {
+      // Only this device holds the fully reduced values of this chunk, so
+      // each element is finalized exactly once.
+      Tensor final_chunk = inter_ca->ChunkAlias((task_idx + 1) % num_tasks);
+      s = Finalize(inter_ca.get(), &final_chunk);
+    }
+    if (s.ok()) {
+      s = RunRingPass(kInterTaskGatherPhase, perms[1], task_idx,
+                      /*reduce=*/false, inter_ca.get());
+    }
+  }
+  if (s.ok()) {
+    s = RunRingPass(kIntraTaskGatherPhase, perms[0], local_idx,
+                    /*reduce=*/false, ca.get());
+  }
+  // Recover the output from the adapter even on failure, so that the op
+  // context does not see a moved-from tensor.
+  ca->ConsumeFinalValue(col_ctx_->output);
+  return s;
+}
+
+Status HierarchicalRingReducer::RunRingPass(int phase,
+                                            const std::vector<int>& ring,
+                                            int rank, bool reduce,
+                                            CollectiveAdapter* ca) {
+  const int n = static_cast<int>(ring.size());
+  if (n <= 1) return absl::OkStatus();
+  tsl::profiler::TraceMe activity(
+      [&] { return strings::StrCat("HierarchicalRingPass:", phase); },
+      tsl::profiler::TraceMeLevel::kInfo);
+  const int send_to = ring[(rank + 1) % n];
+  const int recv_from = ring[(rank + n - 1) % n];
+  const CollGroupMember& send_member = col_params_->group.members[send_to];
+  const CollGroupMember& recv_member = col_params_->group.members[recv_from];
+  const bool merge = reduce && col_params_->merge_op != nullptr;
+
+  // Allocate the receive buffers of all the steps up front, so that a single
+  // wait makes them safe to be written by remote peers.
+  std::vector<Tensor> tmp_chunks;
+  if (merge) {
+    for (int step = 0; step < n - 1; ++step) {
+      tmp_chunks.push_back(ca->TempChunk((rank + 2 * n - step - 1) % n));
+    }
+    TF_RETURN_IF_ERROR(WaitForQueuedEvents());
+  }
+
+  for (int step = 0; step < n - 1; ++step) {
+    // In a reduce-scatter, rank r starts by sending its chunk r and then
+    // forwards the partial sums it received. In an all-gather it starts with
+    // the chunk (r + 1) % n it owns after the reduce-scatter.
+    const int send_chunk = reduce ? (rank + n - step) % n
+                                  : (rank + n + 1 - step) % n;
+    const int recv_chunk = (send_chunk + n - 1) % n;
+    Tensor send_tensor = ca->ChunkAlias(send_chunk);
+    Tensor recv_tensor = ca->ChunkAlias(recv_chunk);
+    Tensor* recv_dst = merge ? &tmp_chunks[step] : &recv_tensor;
+
+    Notification send_note;
+    Notification recv_note;
+    Status send_status;
+    Status recv_status;
+    // All the devices of the ring agree on the chunk sizes, so both ends of a
+    // transfer skip empty chunks.
+    const bool do_send = ca->ChunkBytes(send_chunk) > 0;
+    const bool do_recv = ca->ChunkBytes(recv_chunk) > 0;
+    if (do_send) {
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          send_member.device.name(), send_member.task,
+          HierarchicalRingBufKey(col_ctx_->exec_key, phase, step,
+                                 col_params_->default_rank),
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), &send_tensor,
+          col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+          [&send_note, &send_status](const Status& s) {
+            send_status = s;
+            send_note.Notify();
+          });
+    }
+    if (do_recv) {
+      col_ctx_->col_exec->remote_access()->RecvFromPeer(
+          recv_member.device.name(), recv_member.task, recv_member.is_local,
+          HierarchicalRingBufKey(col_ctx_->exec_key, phase, step, recv_from),
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), recv_dst,
+          col_ctx_->device_locality, phase,
+          col_ctx_->op_ctx->cancellation_manager(),
+          [&recv_note, &recv_status](const Status& s) {
+            recv_status = s;
+            recv_note.Notify();
+          });
+    }
+    if (do_send) {
+      send_note.WaitForNotification();
+      if (!send_status.ok()) StartAbort(send_status);
+    }
+    if (do_recv) {
+      recv_note.WaitForNotification();
+      if (!recv_status.ok()) StartAbort(recv_status);
+    }
+    TF_RETURN_IF_ERROR(send_status);
+    TF_RETURN_IF_ERROR(recv_status);
+    if (merge && do_recv) {
+      Status s = collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &recv_tensor, recv_dst);
+      if (!s.ok()) {
+        StartAbort(s);
+        return s;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::Finalize(CollectiveAdapter* ca,
+                                         Tensor* chunk) {
+  if (chunk->NumElements() == 0) return absl::OkStatus();
+  Tensor group_size_tensor = ca->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type != DEVICE_CPU) {
+    Tensor group_size_val = group_size_tensor;
+    group_size_tensor = ca->Scalar(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+        AllocationAttributes());
+    Notification note;
+    Status status;
+    col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, col_ctx_->device, &group_size_tensor,
+        [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+  Status s = collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, chunk, &group_size_tensor);
+  if (!s.ok()) StartAbort(s);
+  return s;
+}
+
+Status HierarchicalRingReducer::WaitForQueuedEvents() {
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info == nullptr) return absl::OkStatus();
+  tsl::profiler::TraceMe activity("WaitForQueuedEvents",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  Notification note;
+  Status s = gpu_info->default_context->ThenExecute(
+      col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+  if (!s.ok()) {
+    return errors::Internal(
+        "Failed to dispatch ThenExecute in HierarchicalRingReducer");
+  }
+  note.WaitForNotification();
+  return absl::OkStatus();
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  {
+    mutex_lock l(status_mu_);
+    if (!status_.ok()) return;
+    LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+    status_.Update(s);
+  }
+  // On cancellation all pending sends and receives are cancelled already.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups spanning
+// several tasks, selected with the "hierarchical_ring" communication hint.
+//
+// With L devices on each of H tasks, the tensor is split into L chunks. The
+// devices of each task first reduce-scatter the chunks over a task-local ring,
+// so that each device holds the task's partial sum of one chunk. The devices
+// holding the same chunk on different tasks then all-reduce it over a ring
+// spanning the tasks, and finally each task all-gathers the chunks over its
+// local ring. Only 2 * (H - 1) / H of a chunk, i.e. of 1/L of the tensor, is
+// sent across tasks by each device, and the H rings of remote transfers run
+// in parallel, instead of every step of a flat ring waiting on the slowest
+// remote link.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Returns true if `group` can be reduced hierarchically, i.e. its members
+  // are sorted by task and every task contributes the same number of devices.
+  static bool IsSupported(const CollGroupParams& group);
+
+  // Establishes two subdivs: subdiv 0 is the ring of devices within this
+  // device's task and subdiv 1 is the ring of devices with the same local
+  // index on every task.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Executes the hierarchical all-reduce. Must be called in a blockable
+  // thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs the n - 1 steps of a reduce-scatter (if `reduce`) or an all-gather
+  // over the chunks of `ca`, between the devices of `ring` (group ranks), in
+  // which this device has rank `rank`. After the reduce-scatter, the device
+  // at rank r holds the reduced chunk (r + 1) % n; the all-gather distributes
+  // these chunks to all the devices of the ring. `phase` makes the buffer keys
+  // of consecutive passes distinct.
+  Status RunRingPass(int phase, const std::vector<int>& ring, int rank,
+                     bool reduce, CollectiveAdapter* ca);
+
+  // Runs the intra-task, inter-task and intra-task passes on the output,
+  // which already holds a copy of the input.
+  Status RunHierarchicalReduce();
+
+  // Applies the final op to `chunk`, a chunk of the final value.
+  Status Finalize(CollectiveAdapter* ca, Tensor* chunk);
+
+  // Blocks until queued work on the compute stream of a GPU device is done,
+  // so that freshly allocated buffers can be written by remote peers.
+  Status WaitForQueuedEvents();
+
+  // Starts aborting outstanding transfers in the collective executor, unless
+  // the collective is being cancelled.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  int devices_per_task_;
+
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(op, op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> kernel = CreateOpKernel(
+      DeviceType(device->device_type()), device,
+      device->GetAllocator(AllocatorAttributes()), node_def,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return kernel;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  // Reduces a tensor of `num_elements` values across `num_workers` tasks with
+  // `num_devices` devices each, and checks that every device gets the mean.
+  void RunMean(int num_workers, int num_devices, int num_elements) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<Tensor> tensors;
+    for (int rank = 0; rank < group_size; ++rank) {
+      Tensor t(DT_FLOAT, TensorShape({num_elements}));
+      for (int i = 0; i < num_elements; ++i) {
+        t.flat<float>()(i) = rank * 100 + i;
+      }
+      tensors.push_back(t);
+    }
+    Tensor expected(DT_FLOAT, TensorShape({num_elements}));
+    for (int i = 0; i < num_elements; ++i) {
+      expected.flat<float>()(i) = 100.0f * (group_size - 1) / 2 + i;
+    }
+
+    BlockingCounter counter(group_size);
+    for (int rank = 0; rank < group_size; ++rank) {
+      SchedClosure([this, &tensors, rank, &counter]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, rank, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+            DT_FLOAT, tensors[rank].shape());
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[rank].device.name(), &device));
+        std::unique_ptr<OpKernel> merge_op = GetBinOp("Add", DT_FLOAT, device);
+        std::unique_ptr<OpKernel> final_op = GetBinOp("Div", DT_FLOAT, device);
+        col_params->merge_op = merge_op.get();
+        col_params->final_op = final_op.get();
+        TF_CHECK_OK(RunCollective(test_env_.get(), col_params.get(), device,
+                                  &tensors[rank], &tensors[rank]));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (int rank = 0; rank < group_size; ++rank) {
+      test::ExpectTensorNear<float>(expected, tensors[rank], 1e-4);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(HierarchicalRingReducerTest, InitializeParams) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 3,
+                                      /*num_devices_per_worker*/ 2, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env_, /*rank*/ 3, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({8}));
+  HierarchicalRingReducer reducer;
+  TF_ASSERT_OK(reducer.InitializeCollectiveParams(col_params.get()));
+  const auto& perms = col_params->instance.impl_details.subdiv_permutations;
+  ASSERT_EQ(perms.size(), 2);
+  EXPECT_EQ(perms[0], std::vector<int>({2, 3}));
+  EXPECT_EQ(perms[1], std::vector<int>({1, 3, 5}));
+  EXPECT_EQ(col_params->subdiv_rank, std::vector<int>({1, 1}));
+}
+
+TEST_F(HierarchicalRingReducerTest, RequiresSameDevicesPerTask) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 2,
+                                      /*num_devices_per_worker*/ 2, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env_, /*rank*/ 0, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({8}));
+  EXPECT_TRUE(HierarchicalRingReducer::IsSupported(col_params->group));
+  col_params->group.members[1].task = col_params->group.members[2].task;
+  EXPECT_FALSE(HierarchicalRingReducer::IsSupported(col_params->group));
+  HierarchicalRingReducer reducer;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reducer.InitializeCollectiveParams(col_params.get())));
+}
+
+TEST_F(HierarchicalRingReducerTest, SingleTask) { RunMean(1, 3, 1001); }
+
+TEST_F(HierarchicalRingReducerTest, OneDevicePerTask) { RunMean(3, 1, 1001); }
+
+TEST_F(HierarchicalRingReducerTest, MultipleTasks) { RunMean(2, 3, 1001); }
+
+TEST_F(HierarchicalRingReducerTest, FewerElementsThanDevices) {
+  RunMean(2, 4, 3);
+}
+
+}  // namespace
+}  // namespace tensorflow
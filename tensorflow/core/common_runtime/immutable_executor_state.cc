@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -65,6 +67,30 @@ void GetMaxPendingCounts(const Node* n, size_t* max_pending,
   *max_pending = initial_count;
   *max_dead_count = num_in_edges;
 }
+
+// Returns, indexed by node id, whether the node is a transitive producer,
+// through data edges, of an op using distributed communication. E.g. in
+// backprop, the whole chain of ops computing a gradient before its
+// all-reduce.
+std::vector<bool> FindCollectiveInputs(const Graph& graph) {
+  std::vector<bool> is_collective_input(graph.num_node_ids(), false);
+  std::vector<const Node*> stack;
+  for (const Node* n : graph.op_nodes()) {
+    if (IsDistributedCommunication(n)) stack.push_back(n);
+  }
+  while (!stack.empty()) {
+    const Node* n = stack.back();
+    stack.pop_back();
+    for (const Edge* in_edge : n->in_edges()) {
+      if (in_edge->IsControlEdge()) continue;
+      const Node* src = in_edge->src();
+      if (is_collective_input[src->id()]) continue;
+      is_collective_input[src->id()] = true;
+      stack.push_back(src);
+    }
+  }
+  return is_collective_input;
+}
 }  // namespace
 
 ImmutableExecutorState::FrameInfo* ImmutableExecutorState::EnsureFrameInfo(
@@ -96,6 +122,8 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
 
   pending_ids_.resize(gview_.num_nodes());
 
+  const std::vector<bool> is_collective_input = FindCollectiveInputs(graph);
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
@@ -196,6 +224,8 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    item->is_collective_input = is_collective_input[id];
+    has_collective_inputs_ |= item->is_collective_input;
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
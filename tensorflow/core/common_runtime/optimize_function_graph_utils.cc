@@ -18,14 +18,17 @@ limitations under the License.
 #include <cstdlib>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -48,9 +51,13 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/host_info.h"
@@ -771,6 +778,154 @@ OptimizeFunctionGraphOrReadFromFileCache(
   return optimized_function_graph_info;
 }
 
+namespace {
+
+// Maximum number of optimized graphs kept by the in-memory cache.
+constexpr size_t kMaxMemoryCacheEntries = 256;
+
+bool IsMemoryCacheEnabled() {
+  bool enabled = false;
+  TF_CHECK_OK(
+      ReadBoolFromEnvVar("TF_FUNCTION_GRAPH_MEMORY_CACHE", false, &enabled));
+  return enabled;
+}
+
+// Process-wide cache of optimized function graphs, stored as protos so that
+// every hit gets its own copy of the graph.
+class OptimizedFunctionGraphMemoryCache {
+ public:
+  static OptimizedFunctionGraphMemoryCache* Global() {
+    static auto* cache = new OptimizedFunctionGraphMemoryCache;
+    return cache;
+  }
+
+  std::optional<OptimizedFunctionGraph> Lookup(const Fprint128& key) {
+    mutex_lock l(mu_);
+    auto it = graphs_.find(key);
+    if (it == graphs_.end()) return std::nullopt;
+    return it->second;
+  }
+
+  void Insert(const Fprint128& key, OptimizedFunctionGraph graph) {
+    mutex_lock l(mu_);
+    if (graphs_.size() >= kMaxMemoryCacheEntries) return;
+    graphs_.emplace(key, std::move(graph));
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<Fprint128, OptimizedFunctionGraph, Fprint128Hasher>
+      graphs_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the key of an instantiation in the in-memory cache, or nullopt if it
+// can not be cached.
+std::optional<Fprint128> GetMemoryCacheKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device) {
+  // Component functions are optimized by their caller, and these options carry
+  // state which is not part of the key.
+  if (options.is_component_function || options.optimize_graph_fn ||
+      options.graph_collector != nullptr ||
+      options.include_optimized_graph_in_debug_string) {
+    return std::nullopt;
+  }
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? input_lib_def : options.lib_def;
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) return std::nullopt;
+
+  // The library is identified by its content rather than its address.
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  string key = Canonicalize(function_name, attrs, key_options);
+  absl::StrAppend(&key, "|", options.is_multi_device_function, ",",
+                  options.default_device_to_target, ",",
+                  options.int_args_and_retvals_on_device, ",",
+                  options.allow_soft_placement, ",",
+                  options.shape_inference_on_tfe_dialect_import, ",",
+                  options.xla_compile_device_type);
+  if (options.ret_indices.has_value()) {
+    absl::StrAppend(&key, "|ret_indices:",
+                    absl::StrJoin(*options.ret_indices, ","));
+  }
+  FunctionLibraryDefinition reachable = lib_def->ReachableDefinitions(*fdef);
+  std::vector<string> function_names = reachable.ListFunctionNames();
+  std::sort(function_names.begin(), function_names.end());
+  string serialized;
+  SerializeToStringDeterministic(*fdef, &serialized);
+  absl::StrAppend(&key, "|", serialized);
+  for (const string& name : function_names) {
+    SerializeToStringDeterministic(*reachable.Find(name), &serialized);
+    absl::StrAppend(&key, "|", serialized);
+  }
+  std::vector<string> device_names;
+  for (const Device* device : dev_set.devices()) {
+    device_names.push_back(device->name());
+  }
+  std::sort(device_names.begin(), device_names.end());
+  absl::StrAppend(&key, "|devices:", absl::StrJoin(device_names, ","), "|cpu:",
+                  cpu_device->name(), "|default:",
+                  default_device == nullptr ? "" : default_device->name());
+  for (const CompositeDevice* device : composite_devices) {
+    absl::StrAppend(&key, "|", device->name(), ":",
+                    absl::StrJoin(*device->underlying_devices(), ","));
+  }
+  return Fingerprint128(key);
+}
+
+}  // namespace
+
+absl::StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env) {
+  std::optional<Fprint128> key;
+  if (IsMemoryCacheEnabled()) {
+    key = GetMemoryCacheKey(function_name, attrs, options, dev_set,
+                            input_lib_def, composite_devices, cpu_device,
+                            default_device);
+  }
+  if (!key.has_value()) {
+    return OptimizeFunctionGraphOrReadFromFileCache(
+        function_name, attrs, options, dev_set, input_lib_def,
+        composite_devices, cpu_device, default_device, env);
+  }
+
+  auto* cache = OptimizedFunctionGraphMemoryCache::Global();
+  std::optional<OptimizedFunctionGraph> cached = cache->Lookup(*key);
+  if (cached.has_value()) {
+    absl::StatusOr<OptimizedFunctionGraphInfo> info =
+        OptimizedFunctionGraphInfo::FromProto(std::move(*cached));
+    if (info.ok()) {
+      VLOG(1) << "Found optimized graph of function " << function_name
+              << " in the in-memory cache";
+      metrics::UpdateFunctionGraphOptimizationSavingTime(
+          info->optimization_duration_usecs,
+          metrics::GraphOptimizationSource::kJit);
+      metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+          1, metrics::GraphOptimizationSource::kJit);
+      return info;
+    }
+    LOG(WARNING) << "Failed to restore the optimized graph of function "
+                 << function_name << " from the in-memory cache: "
+                 << info.status();
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      OptimizedFunctionGraphInfo info,
+      OptimizeFunctionGraphOrReadFromFileCache(
+          function_name, attrs, options, dev_set, input_lib_def,
+          composite_devices, cpu_device, default_device, env));
+  cache->Insert(*key, OptimizedFunctionGraphInfo::ToProto(info));
+  return info;
+}
+
 absl::StatusOr<
     std::unique_ptr<std::unordered_map<string, std::unique_ptr<Graph>>>>
 PreprocessAndPartitionGraph(
@@ -76,6 +76,20 @@ OptimizeFunctionGraphOrReadFromFileCache(
     Device* default_device, Env* env,
     absl::Duration caching_threshold_duration = kCachingThresholdDuration);
 
+// Like OptimizeFunctionGraphOrReadFromFileCache, but if the
+// TF_FUNCTION_GRAPH_MEMORY_CACHE environment variable is true, first looks the
+// optimized graph up in a process-wide in-memory cache shared by all the
+// ProcessFunctionLibraryRuntime instances, e.g. of sessions loading the same
+// model. Entries are keyed by the fingerprints of the function and the
+// functions reachable from it, `attrs`, the instantiation options and the
+// devices, so that only identical instantiations share a graph.
+absl::StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env);
+
 // Pre-processes, partitions and post-optimizes the input graph; returns
 // subgraph result (maps from device name to the subgraph); returns error if any
 // optimization or partitioning step fails.
@@ -246,5 +246,40 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizeFunctionGraphTest, ReadFromMemoryCache) {
+  setenv("TF_FUNCTION_GRAPH_MEMORY_CACHE", "true", 1);
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDevice();
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 2, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  // Two libraries with the same content, e.g. of two sessions, share the
+  // optimized graph, which reports the time of the first optimization.
+  std::vector<OptimizedFunctionGraphInfo> results;
+  for (int i = 0; i < 2; ++i) {
+    FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+    absl::StatusOr<OptimizedFunctionGraphInfo> info =
+        OptimizeFunctionGraphOrReadFromCache(
+            "FindDevice", {}, opts, device_set, &lib_def,
+            /*composite_devices=*/{}, devices[0].get(), devices[1].get(),
+            Env::Default());
+    TF_ASSERT_OK(info.status());
+    results.push_back(std::move(*info));
+  }
+  EXPECT_EQ(results[0].optimization_duration_usecs,
+            results[1].optimization_duration_usecs);
+  EXPECT_EQ(results[0].function_graph->num_nodes(),
+            results[1].function_graph->num_nodes());
+  EXPECT_NE(results[0].function_graph.get(), results[1].function_graph.get());
+  EXPECT_THAT(results[1].ret_types, ElementsAre(DT_STRING));
+  unsetenv("TF_FUNCTION_GRAPH_MEMORY_CACHE");
+}
+
 }  // namespace
 }  // namespace tensorflow
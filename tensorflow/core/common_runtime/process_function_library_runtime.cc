@@ -576,7 +576,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   absl::StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info =
       (!optimized_graph_proto.has_value() ||
        !optimized_graph_proto.value().ok())
-          ? OptimizeFunctionGraphOrReadFromFileCache(
+          ? OptimizeFunctionGraphOrReadFromCache(
                 function_name, attrs, options, *dev_set, lib_def_,
                 composite_devices, cpu_device, default_device, env_)
           : OptimizedFunctionGraphInfo::FromProto(
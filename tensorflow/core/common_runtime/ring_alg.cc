@@ -16,8 +16,11 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
@@ -39,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 // Set true for greater intelligibility of debug mode log messages.
 #define READABLE_KEYS false
@@ -53,6 +57,9 @@ constexpr size_t kMaxChunkSizeBytes = (4 * 1024 * 1024);
 // through the collectives API. A reasonable value would be a small
 // multiple of the number of NICs adjacent to each device.
 constexpr int kMaxSubdivsPerDeviceDefault = 2;
+// Upper bound on the number of chunks that each ring carries at once when
+// pipelining is enabled through TF_COLLECTIVE_RING_PIPELINE_DEPTH.
+constexpr int kMaxRingPipelineDepth = 16;
 
 namespace tensorflow {
 namespace {
@@ -107,6 +114,24 @@ RingAlg::RingAlg(CollectiveType type, const string& name)
       num_subdivs_(-1) {}
 
 namespace {
+// Returns the maximum number of chunks in flight on each ring. With a depth
+// greater than 1 a large tensor is split into more, smaller chunks, so that
+// receiving a chunk overlaps with reducing and sending the previous chunk of
+// the same ring instead of waiting for a whole chunk to arrive. All members of
+// a group compute their subdivisions independently, so the setting must be
+// identical on every worker.
+int RingPipelineDepth() {
+  int64_t depth;
+  Status status = ReadInt64FromEnvVar("TF_COLLECTIVE_RING_PIPELINE_DEPTH",
+                                      /*default_val=*/1, &depth);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 1;
+  }
+  return static_cast<int>(
+      std::clamp<int64_t>(depth, 1, kMaxRingPipelineDepth));
+}
+
 Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
   // This function generates subdivision_offsets. Expect it to be empty when
   // called.
@@ -153,13 +178,33 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
                             col_params->instance.impl_details.collective_name);
   }
 
-  int subdiv_stride = kAvgDevPerTask / num_subdivs;
+  // If the chunks are still too large, pipeline them: every ring gets
+  // `pipeline_depth` subdivisions with the same permutation, which are in
+  // flight at the same time. RingField indices are int16, which bounds the
+  // total number of chunks.
+  const int max_pipeline_depth = RingPipelineDepth();
+  const int num_rings = num_subdivs;
+  int pipeline_depth = 1;
+  while (chunk_size > kMaxChunkSizeBytes &&
+         pipeline_depth < max_pipeline_depth &&
+         col_params->group.group_size * num_rings * (pipeline_depth + 1) <=
+             std::numeric_limits<int16>::max()) {
+    ++pipeline_depth;
+    chunk_size = tensor_size /
+                 (col_params->group.group_size * num_rings * pipeline_depth);
+  }
+  num_subdivs = num_rings * pipeline_depth;
+
+  int subdiv_stride = kAvgDevPerTask / num_rings;
   if (subdiv_stride == 0) subdiv_stride = 1;
   col_params->instance.impl_details.subdiv_offsets.reserve(num_subdivs);
-  for (int sdi = 0; sdi < num_subdivs; ++sdi) {
-    int subdiv_offset = subdiv_stride * sdi;
-    if (sdi % 2 == 1) subdiv_offset *= -1;
-    col_params->instance.impl_details.subdiv_offsets.push_back(subdiv_offset);
+  for (int stage = 0; stage < pipeline_depth; ++stage) {
+    for (int sdi = 0; sdi < num_rings; ++sdi) {
+      int subdiv_offset = subdiv_stride * sdi;
+      if (sdi % 2 == 1) subdiv_offset *= -1;
+      col_params->instance.impl_details.subdiv_offsets.push_back(
+          subdiv_offset);
+    }
   }
 
   if (VLOG_IS_ON(2)) {
@@ -169,8 +214,9 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
       strings::StrAppend(&subdiv_buf, " ", subdiv_offset);
     }
     VLOG(2) << "Dynamically generated " << num_subdivs
-            << " subdiv_offsets:" << subdiv_buf << " tensor_size "
-            << tensor_size << " chunk_size " << chunk_size;
+            << " subdiv_offsets:" << subdiv_buf << " for " << num_rings
+            << " rings with pipeline depth " << pipeline_depth
+            << " tensor_size " << tensor_size << " chunk_size " << chunk_size;
   }
 
   return absl::OkStatus();
@@ -408,7 +454,8 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0),
+      rf->wire_chunk.IsInitialized() ? &rf->wire_chunk : &rf->chunk,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +471,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (rf->wire_chunk.IsInitialized()) dst_tensor = &rf->wire_chunk;
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
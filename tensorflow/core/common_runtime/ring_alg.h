@@ -75,6 +75,8 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    // If initialized, compressed values sent and received instead of chunk.
+    Tensor wire_chunk;
     Status status;
     string DebugString() const;
   };
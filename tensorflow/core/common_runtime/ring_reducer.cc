@@ -64,6 +64,11 @@ void RingReducer::Run(StatusCallback done) {
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  // Compression converts the chunks with Eigen on the host, so it is limited
+  // to float values in CPU memory.
+  compress_ = col_params_->instance.impl_details.compression == "bfloat16" &&
+              col_params_->instance.data_type == DT_FLOAT &&
+              col_params_->group.device_type == DEVICE_CPU;
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -168,6 +173,21 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  if (compress_) {
+    // The same buffer serves both passes, so it is allocated even if this
+    // field does not send or receive in the first one.
+    rf->wire_chunk = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        DT_BFLOAT16, TensorShape({rf->chunk.NumElements()}));
+  }
+}
+
+void RingReducer::CompressChunk(RingField* rf) {
+  rf->wire_chunk.flat<bfloat16>() = rf->chunk.flat<float>().cast<bfloat16>();
+}
+
+void RingReducer::DecompressChunk(RingField* rf, Tensor* dst) {
+  dst->flat<float>() = rf->wire_chunk.flat<bfloat16>().cast<float>();
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -253,6 +273,12 @@ bool RingReducer::RunAsyncParts() {
           case RF_RECV:
             CHECK_GT(recv_pending_count, 0);
             --recv_pending_count;
+            if (compress_) {
+              // Values are reduced at full precision.
+              DecompressChunk(rf, (!rf->second_pass && col_params_->merge_op)
+                                      ? &rf->tmp_chunk
+                                      : &rf->chunk);
+            }
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
               Status s = collective_util::ComputeBinOp(
@@ -286,6 +312,15 @@ bool RingReducer::RunAsyncParts() {
             break;
           case RF_SEND_READY:
             if (rf->do_send) {
+              if (compress_) {
+                CompressChunk(rf);
+                // The device holding a final value starts the second pass
+                // without receiving it. It keeps the rounded value that the
+                // other devices receive, so that all the results agree.
+                if (rf->second_pass && !rf->do_recv) {
+                  DecompressChunk(rf, &rf->chunk);
+                }
+              }
               rf->action = RF_SEND;
               auto send_complete = [this, rf, &ready_queue,
                                     &aborted](Status s) {
@@ -49,8 +49,15 @@ class RingReducer : public RingAlg {
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
 
+  // Converts the values of `rf` to bfloat16 in its `wire_chunk`.
+  void CompressChunk(RingField* rf);
+  // Converts the bfloat16 `wire_chunk` of `rf` back to float into `dst`.
+  void DecompressChunk(RingField* rf, Tensor* dst);
+
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
+  // True if values are exchanged as bfloat16, see `CollImplDetails`.
+  bool compress_ = false;
 
   friend class RingReducerTest;
   friend class RingReducerInitParamsTest;
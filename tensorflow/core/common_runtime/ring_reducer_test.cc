@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 
 #include <algorithm>
+#include <cstdlib>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
@@ -356,6 +357,43 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivUsesDefault) {
   RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {0, 1, 2, 3}}, {0, 0});
 }
 
+TEST_F(RingReducerInitParamsTest, AutomaticSubdivPipelinesLargeChunks) {
+  const int kNumDevsPerWorker = 1;
+  const int kNumWorkers = 4;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+
+  // The 2 default rings would carry 12.5 MiB chunks of a 100 MiB tensor.
+  // Pipelining splits them further, until chunks are at most 4 MiB, with each
+  // ring carrying 4 chunks at once.
+  setenv("TF_COLLECTIVE_RING_PIPELINE_DEPTH", "8", /*overwrite=*/1);
+  cp->default_rank = 0;
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.impl_details.max_subdivs_per_device = 0;
+  cp->instance.shape = TensorShape({104857600 / DataTypeSize(DT_FLOAT)});
+  RunSubdivPermsTest(cp.get(),
+                     {{0, 1, 2, 3},
+                      {0, 1, 2, 3},
+                      {0, 1, 2, 3},
+                      {0, 1, 2, 3},
+                      {0, 1, 2, 3},
+                      {0, 1, 2, 3},
+                      {0, 1, 2, 3},
+                      {0, 1, 2, 3}},
+                     {0, 0, 0, 0, 0, 0, 0, 0});
+
+  // The pipeline depth bounds the number of chunks.
+  setenv("TF_COLLECTIVE_RING_PIPELINE_DEPTH", "2", /*overwrite=*/1);
+  cp->instance.impl_details.subdiv_offsets.clear();
+  RunSubdivPermsTest(cp.get(),
+                     {{0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}},
+                     {0, 0, 0, 0});
+  unsetenv("TF_COLLECTIVE_RING_PIPELINE_DEPTH");
+}
+
 TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
   const int kNumDevsPerWorker = 1;
   const int kNumWorkers = 4;
@@ -374,6 +412,36 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
   RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {0});
 }
 
+TEST_F(RingReducerTest, CompressesToBfloat16) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 3;
+  const int kTensorLen = 1001;
+  Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+       DEVICE_CPU, /*num_subdivs*/ 1, /*fail_after*/ 0);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    instances_[di]->col_params_->instance.impl_details.compression =
+        "bfloat16";
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < kTensorLen; ++i) {
+        // Values which are not exactly representable in bfloat16.
+        const float value = 1.0f + 0.001f * i + 0.0003f * di;
+        t->flat<float>()(i) = value;
+        expected[i] += value / (kNumWorkers * kNumDevices);
+      }
+    });
+  }
+  Reduce(/*fail_after*/ 0);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    // All the devices get the same rounded result.
+    test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                   instances_[di]->tensor());
+  }
+  test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                instances_[0]->tensor(), 0.05);
+}
+
 // TODO(b/113171733): change to use TEST_P.
 #define DEF_TEST(B, T, W, D, S, L, A)                                         \
   TEST_F(RingReducerTest,                                                     \
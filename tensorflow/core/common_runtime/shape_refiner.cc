@@ -22,11 +22,14 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -64,6 +67,33 @@ namespace {
 constexpr char kArgOp[] = "_Arg";
 constexpr char kRetvalOp[] = "_Retval";
 
+// Returns the key of the shapes inferred for a call of `fname` with the
+// inputs of `c`. Unknown dimensions are not distinguished, since the shapes
+// returned by a function body are copied into the outer context by value.
+std::string FunctionShapesKey(const std::string& fname, AttrSlice attributes,
+                              absl::Span<const Tensor* const> input_tensors,
+                              InferenceContext* c) {
+  std::string key = Canonicalize(fname, attributes);
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    absl::StrAppend(&key, ";", c->DebugString(c->input(i)));
+    const std::vector<ShapeAndType>* handle_data =
+        c->input_handle_shapes_and_types(i);
+    if (handle_data != nullptr) {
+      for (const ShapeAndType& shape_and_type : *handle_data) {
+        absl::StrAppend(&key, ",", c->DebugString(shape_and_type.shape), ":",
+                        static_cast<int>(shape_and_type.dtype), ":",
+                        shape_and_type.type.SerializeAsString());
+      }
+    }
+    if (i < input_tensors.size() && input_tensors[i] != nullptr) {
+      TensorProto proto;
+      input_tensors[i]->AsProtoTensorContent(&proto);
+      absl::StrAppend(&key, "=", proto.SerializeAsString());
+    }
+  }
+  return key;
+}
+
 }  // namespace
 
 // Runs shape inference for the given node using the given ShapeRefiner.
@@ -158,9 +188,73 @@ Status ShapeRefiner::InferShapesForFunctionSubNode(
 // NOTE: Recursive user-defined functions are not supported.
 // Maybe we won't support recursive functions at all in TF, because of
 // other maintainability issues.
-Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
-                                            AttrSlice attributes,
-                                            InferenceContext* outer_context) {
+Status ShapeRefiner::InferShapesForFunction(
+    const FunctionDef* function_def, AttrSlice attributes,
+    absl::Span<const Tensor* const> input_tensors,
+    InferenceContext* outer_context) {
+  const std::string key =
+      FunctionShapesKey(function_def->signature().name(), attributes,
+                        input_tensors, outer_context);
+  auto it = function_shapes_.find(key);
+  if (it == function_shapes_.end()) {
+    TF_RETURN_IF_ERROR(
+        InferShapesForFunctionBody(function_def, attributes, outer_context));
+
+    FunctionShapes shapes;
+    for (int i = 0; i < outer_context->num_outputs(); ++i) {
+      outer_context->ShapeHandleToProto(outer_context->output(i),
+                                        &shapes.output_shapes.emplace_back());
+      auto& handle_data = shapes.output_handle_shapes_and_types.emplace_back();
+      const std::vector<ShapeAndType>* output_handle_data =
+          outer_context->output_handle_shapes_and_types(i);
+      if (output_handle_data == nullptr) continue;
+      handle_data.emplace();
+      for (const ShapeAndType& shape_and_type : *output_handle_data) {
+        FunctionShapes::HandleShapeAndType& copy = handle_data->emplace_back();
+        outer_context->ShapeHandleToProto(shape_and_type.shape, &copy.shape);
+        copy.dtype = shape_and_type.dtype;
+        copy.type = shape_and_type.type;
+      }
+    }
+    for (int i = 0; i < outer_context->num_inputs(); ++i) {
+      if (outer_context->requested_input_tensor(i)) {
+        shapes.requested_input_tensors.push_back(i);
+      }
+    }
+    function_shapes_.emplace(key, std::move(shapes));
+    return absl::OkStatus();
+  }
+
+  ++num_function_shapes_cache_hits_;
+  const FunctionShapes& shapes = it->second;
+  for (int i = 0; i < shapes.output_shapes.size(); ++i) {
+    ShapeHandle handle;
+    TF_RETURN_IF_ERROR(outer_context->MakeShapeFromShapeProto(
+        shapes.output_shapes[i], &handle));
+    outer_context->set_output(i, handle);
+    const auto& handle_data = shapes.output_handle_shapes_and_types[i];
+    if (!handle_data.has_value()) continue;
+    std::vector<ShapeAndType> shapes_and_types;
+    for (const FunctionShapes::HandleShapeAndType& shape_and_type :
+         *handle_data) {
+      TF_RETURN_IF_ERROR(outer_context->MakeShapeFromShapeProto(
+          shape_and_type.shape, &handle));
+      shapes_and_types.push_back(
+          ShapeAndType(handle, shape_and_type.dtype, shape_and_type.type));
+    }
+    outer_context->set_output_handle_shapes_and_types(i, shapes_and_types);
+  }
+  // Requests the same constant inputs as the function body, so that the call
+  // is inferred again once they are evaluated.
+  for (int i : shapes.requested_input_tensors) {
+    outer_context->request_input_tensor(i);
+  }
+  return absl::OkStatus();
+}
+
+Status ShapeRefiner::InferShapesForFunctionBody(
+    const FunctionDef* function_def, AttrSlice attributes,
+    InferenceContext* outer_context) {
   const Graph* graph;
   const string& fname = function_def->signature().name();
   auto it = functions_.find(fname);
@@ -743,7 +837,7 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
           auto const_tensor_map_copy = const_tensor_map_;
           const_tensor_map_.clear();
           Status function_inference_status = InferShapesForFunction(
-              function_def, AttrSlice(&function.attr()), c);
+              function_def, AttrSlice(&function.attr()), input_tensors, c);
           const_tensor_map_ = const_tensor_map_copy;
           return function_inference_status;
         }
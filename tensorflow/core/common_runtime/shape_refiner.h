@@ -15,15 +15,21 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
+#include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -100,8 +106,9 @@ class ShapeRefiner {
   // Set function library to enable function shape inference.
   // Without function library, function inference always yields unknown shapes.
   // With this enabled, shape inference can take more time since it descends
-  // into all function calls. It doesn't do inference once for each function
-  // definition, but once for each function call.
+  // into all function calls. The results are cached per function, attrs, input
+  // shapes and constant inputs, so that calls with the same inputs are only
+  // inferred once.
   // The function library must outlive the shape refiner.
   void set_function_library_for_shape_inference(
       const tensorflow::FunctionLibraryDefinition* lib) {
@@ -139,7 +146,17 @@ class ShapeRefiner {
   //
   // On success:
   // - outer_context will contain output shapes inferred from input shapes
+  //
+  // `input_tensors` are the constant inputs set in outer_context, or nullptr
+  // for inputs that are not constant.
   Status InferShapesForFunction(
+      const FunctionDef* function_def, AttrSlice attributes,
+      absl::Span<const Tensor* const> input_tensors,
+      shape_inference::InferenceContext* outer_context);
+
+  // Runs the shape inference of InferShapesForFunction() on the function body,
+  // without looking up the cache.
+  Status InferShapesForFunctionBody(
       const FunctionDef* function_def, AttrSlice attributes,
       shape_inference::InferenceContext* outer_context);
 
@@ -283,6 +300,26 @@ class ShapeRefiner {
   // are refined.
   absl::flat_hash_map<std::string, std::unique_ptr<const Graph>> functions_;
 
+  // The shapes inferred for a function body, which are independent of the
+  // inference context of its call.
+  struct FunctionShapes {
+    struct HandleShapeAndType {
+      TensorShapeProto shape;
+      DataType dtype;
+      FullTypeDef type;
+    };
+    std::vector<TensorShapeProto> output_shapes;
+    std::vector<std::optional<std::vector<HandleShapeAndType>>>
+        output_handle_shapes_and_types;
+    // Inputs whose constant value was requested by the function body.
+    std::vector<int> requested_input_tensors;
+  };
+
+  // Cache of the shapes inferred for each function, keyed by the function
+  // name, attrs, input shapes and constant inputs of its calls.
+  absl::flat_hash_map<std::string, FunctionShapes> function_shapes_;
+  int64_t num_function_shapes_cache_hits_ = 0;
+
   ShapeRefiner(const ShapeRefiner&) = delete;
   void operator=(const ShapeRefiner&) = delete;
 };
@@ -61,6 +61,10 @@ class ShapeRefinerTest : public ::testing::Test {
 
   static constexpr int64_t kMaxTensorSize = ShapeRefiner::kMaxTensorSize;
 
+  int64_t NumFunctionShapesCacheHits(const ShapeRefiner& m) {
+    return m.num_function_shapes_cache_hits_;
+  }
+
   void TestStridedSlice(const PartialTensorShape& input_shape, int begin,
                         int end, int stride, const char* expected,
                         int begin_mask = 0, int end_mask = 0,
@@ -1527,6 +1531,37 @@ TEST_F(ShapeRefinerTest, ChainedFunctionShapeInferenceWithMultipleInputs) {
   EXPECT_SHAPE("[3,3]", m, wxplusb16, 0);
 }
 
+TEST_F(ShapeRefinerTest, FunctionShapeInferenceIsCachedPerInputShapes) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x1 = ops::Const(root, {{.0f, .0f}});
+  auto x2 = ops::Const(root, {{1.0f, 1.0f}});
+  auto x3 = ops::Const(root, {{.0f, .0f, .0f}});
+  auto y1 = test::function::Call(&root, "y1", "XTimesTwo", {x1});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {x2});
+  auto y3 = test::function::Call(&root, "y3", "XTimesTwo", {x3});
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+  m.set_function_library_for_shape_inference(&f_lib);
+  TF_ASSERT_OK(m.AddNode(x1.node()));
+  TF_ASSERT_OK(m.AddNode(x2.node()));
+  TF_ASSERT_OK(m.AddNode(x3.node()));
+  TF_ASSERT_OK(m.AddNode(y1.node()));
+  EXPECT_EQ(NumFunctionShapesCacheHits(m), 0);
+  TF_ASSERT_OK(m.AddNode(y2.node()));
+  EXPECT_EQ(NumFunctionShapesCacheHits(m), 1);
+  TF_ASSERT_OK(m.AddNode(y3.node()));
+  EXPECT_EQ(NumFunctionShapesCacheHits(m), 1);
+
+  EXPECT_SHAPE("[1,2]", m, y1, 0);
+  EXPECT_SHAPE("[1,2]", m, y2, 0);
+  EXPECT_SHAPE("[1,3]", m, y3, 0);
+}
+
 TEST_F(ShapeRefinerTest, FunctionShapeInferenceWorksForResourceHandles) {
   FunctionDefLibrary f_lib_proto;
   *(f_lib_proto.add_function()) = test::function::Swap();
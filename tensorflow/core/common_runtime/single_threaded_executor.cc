@@ -15,18 +15,25 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <atomic>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/refcount.h"
 
 namespace tensorflow {
 
@@ -67,11 +74,90 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
+static const string& kStaticMemorySingleThreadedExecutor =
+    *new string("SINGLE_THREADED_STATIC_MEMORY_EXECUTOR");
+
+// Serves the allocations of each kernel from the arena slots that a
+// `StaticMemoryPlan` assigned to its outputs, and forwards all other
+// allocations to the device allocator.
+//
+// One instance is created per step. Every allocation holds a reference, so the
+// arena is freed only after the step and all tensors allocated from it are
+// done.
+class StaticPlanAllocator : public Allocator, public core::RefCounted {
+ public:
+  StaticPlanAllocator(Allocator* device_allocator, int64_t arena_size)
+      : device_allocator_(device_allocator),
+        arena_(static_cast<char*>(device_allocator->AllocateRaw(
+            Allocator::kAllocatorAlignment, arena_size))),
+        arena_size_(arena_ == nullptr ? 0 : arena_size) {}
+
+  ~StaticPlanAllocator() override {
+    if (arena_ != nullptr) device_allocator_->DeallocateRaw(arena_);
+  }
+
+  // The maximum number of slots per kernel.
+  static constexpr int kMaxSlots = 64;
+
+  // Sets the slots of the kernel that runs next. Must not be called while a
+  // kernel runs.
+  void SetSlots(absl::Span<const StaticMemoryPlan::Slot> slots) {
+    slots_ = arena_ == nullptr ? absl::Span<const StaticMemoryPlan::Slot>()
+                               : slots;
+    claimed_.store(0, std::memory_order_relaxed);
+  }
+
+  std::string Name() override { return "static_memory_plan"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    if (alignment <= Allocator::kAllocatorAlignment) {
+      for (int i = 0; i < slots_.size(); ++i) {
+        if (static_cast<size_t>(slots_[i].size) != num_bytes) continue;
+        const uint64_t bit = uint64_t{1} << i;
+        if ((claimed_.fetch_or(bit, std::memory_order_relaxed) & bit) == 0) {
+          Ref();
+          return arena_ + slots_[i].offset;
+        }
+      }
+    }
+    void* ptr =
+        device_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    if (ptr != nullptr) Ref();
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    char* p = static_cast<char*>(ptr);
+    if (p < arena_ || p >= arena_ + arena_size_) {
+      device_allocator_->DeallocateRaw(ptr);
+    }
+    Unref();
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return device_allocator_->GetMemoryType();
+  }
+
+ private:
+  Allocator* const device_allocator_;  // Not owned.
+  char* const arena_;
+  const int64_t arena_size_;
+
+  absl::Span<const StaticMemoryPlan::Slot> slots_;
+  // Bit `i` is set once `slots_[i]` has been handed out.
+  std::atomic<uint64_t> claimed_{0};
+};
 
 class SingleThreadedExecutorImpl : public Executor {
  public:
-  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
-      : params_(params) {}
+  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params,
+                                      bool plan_memory = false)
+      : params_(params), plan_memory_(plan_memory) {}
 
   ~SingleThreadedExecutorImpl() override {
     for (const KernelState& kernel_state : kernels_) {
@@ -251,6 +337,32 @@ class SingleThreadedExecutorImpl : public Executor {
     } else {
       total_num_inputs_ = 0;
     }
+
+    if (plan_memory_) {
+      TF_RETURN_IF_ERROR(PlanMemory(graph, ordered_nodes, nodes_with_kernels));
+    }
+    return absl::OkStatus();
+  }
+
+  // Computes the static memory plan of the intermediate outputs of `graph`,
+  // which runs in `ordered_nodes`. Only CPU devices are supported.
+  Status PlanMemory(const Graph& graph, absl::Span<Node* const> ordered_nodes,
+                    absl::Span<Node* const> nodes_with_kernels) {
+    if (params_.device->device_type() != DEVICE_CPU) {
+      VLOG(1) << "Static memory planning is not supported on "
+              << params_.device->device_type() << " devices.";
+      return absl::OkStatus();
+    }
+    StaticMemoryPlan plan;
+    TF_RETURN_IF_ERROR(PlanStaticMemory(graph, ordered_nodes, &plan));
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      std::vector<StaticMemoryPlan::Slot>& slots =
+          plan.node_slots[nodes_with_kernels[i]->id()];
+      if (slots.size() <= StaticPlanAllocator::kMaxSlots) {
+        kernels_[i].planned_slots = std::move(slots);
+      }
+    }
+    arena_size_ = plan.arena_size;
     return absl::OkStatus();
   }
 
@@ -328,7 +440,17 @@ class SingleThreadedExecutorImpl : public Executor {
     params.runner = &runner_copy;
     params.run_all_kernels_inline = args.run_all_kernels_inline;
     params.stats_collector = args.stats_collector;
-    params.executor_type = &kSingleThreadedExecutor;
+    params.executor_type = plan_memory_ ? &kStaticMemorySingleThreadedExecutor
+                                        : &kSingleThreadedExecutor;
+
+    // Serve the planned outputs from a per-step arena. Once the step is over,
+    // tensors that are still alive keep the arena alive.
+    core::RefCountPtr<StaticPlanAllocator> planned_allocator;
+    if (arena_size_ > 0) {
+      planned_allocator.reset(new StaticPlanAllocator(
+          device->GetAllocator(AllocatorAttributes()), arena_size_));
+      params.default_allocator_override = planned_allocator.get();
+    }
 
     // NOTE(mrry): We are assuming that the graph is loopless and condless.
     params.frame_iter = FrameAndIter(0, 0);
@@ -440,6 +562,9 @@ class SingleThreadedExecutorImpl : public Executor {
       params.input_alloc_attrs = input_alloc_attrs;
       params.op_kernel = kernel_state.kernel;
       params.output_attr_array = kernel_state.output_alloc_attrs.data();
+      if (planned_allocator) {
+        planned_allocator->SetSlots(kernel_state.planned_slots);
+      }
       OpKernelContext ctx(&params, num_outputs);
 
       // Actually execute the kernel.
@@ -497,6 +622,14 @@ class SingleThreadedExecutorImpl : public Executor {
 
   const LocalExecutorParams params_;
 
+  // If true, intermediate outputs are placed according to a static memory
+  // plan. See `PlanStaticMemory()`.
+  const bool plan_memory_;
+
+  // The size of the arena for the static memory plan, or 0 if no output is
+  // planned.
+  int64_t arena_size_ = 0;
+
   // All following members are read-only after Initialize().
 
   // The sum of the number of inputs for each node in the graph. This determines
@@ -528,6 +661,10 @@ class SingleThreadedExecutorImpl : public Executor {
     // Memory space information for each output of `kernel`.
     std::vector<AllocatorAttributes>
         output_alloc_attrs;  // Length = `num_outputs`.
+
+    // The arena slots that the static memory plan assigned to the outputs of
+    // `kernel`, if any.
+    std::vector<StaticMemoryPlan::Slot> planned_slots;
   };
   std::vector<KernelState> kernels_;
 
@@ -574,6 +711,8 @@ class SingleThreadedExecutorRegistrar {
  public:
   SingleThreadedExecutorRegistrar() {
     ExecutorFactory::Register(kSingleThreadedExecutor, new Factory());
+    ExecutorFactory::Register(kStaticMemorySingleThreadedExecutor,
+                              new StaticMemoryFactory());
   }
 
  private:
@@ -586,6 +725,17 @@ class SingleThreadedExecutorRegistrar {
       return absl::OkStatus();
     }
   };
+
+  class StaticMemoryFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = std::make_unique<SingleThreadedExecutorImpl>(
+          params, /*plan_memory=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
 };
 static SingleThreadedExecutorRegistrar registrar;
 
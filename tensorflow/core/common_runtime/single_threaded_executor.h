@@ -51,6 +51,12 @@ namespace tensorflow {
 //
 // The single-threaded executor is primarily suitable for executing simple
 // TensorFlow functions, such as one might find in a `tf.data` pipeline.
+//
+// The same executor is also registered as
+// "SINGLE_THREADED_STATIC_MEMORY_EXECUTOR". In that mode, intermediate outputs
+// whose shapes are fully known are served from a per-step arena according to a
+// static memory plan (see `PlanStaticMemory()`), instead of being allocated
+// one at a time from the device allocator.
 Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
                                  const Graph& graph, Executor** executor);
 
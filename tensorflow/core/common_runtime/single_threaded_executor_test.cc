@@ -85,7 +85,8 @@ class ExecutorTest : public ::testing::Test {
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
   void Create(std::unique_ptr<const Graph> graph,
-              std::function<void(OpKernelContext*)> mock_fn = nullptr) {
+              std::function<void(OpKernelContext*)> mock_fn = nullptr,
+              const string& executor_type = "SINGLE_THREADED_EXECUTOR") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -103,8 +104,7 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
-    TF_CHECK_OK(
-        NewExecutor("SINGLE_THREADED_EXECUTOR", params, *graph, &exec_));
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec_));
     runner_ = [](const std::function<void()>& fn) { fn(); };
     rendez_ = NewLocalRendezvous();
   }
@@ -324,6 +324,42 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(retvals[0]));
 }
 
+TEST_F(ExecutorTest, StaticMemoryPlan) {
+  // a1 = c + c; r1 = sum(a1); a2 = c + r1; out = sum(a2).
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Tensor ones(DT_FLOAT, TensorShape({64}));
+  ones.flat<float>().setConstant(1.0);
+  auto c = test::graph::Constant(g.get(), ones);
+  auto axis = test::graph::Constant(g.get(), Tensor(0));
+  auto a1 = test::graph::Add(g.get(), c, c);
+  auto r1 = test::graph::Reduce(g.get(), "Sum", a1, axis);
+  auto a2 = test::graph::Add(g.get(), c, r1);
+  auto r2 = test::graph::Reduce(g.get(), "Sum", a2, axis);
+  test::graph::Retval(g.get(), 0, r2);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g), nullptr, "SINGLE_THREADED_STATIC_MEMORY_EXECUTOR");
+  // The arena is reused across steps.
+  for (int i = 0; i < 3; ++i) {
+    FunctionCallFrame call_frame({}, {DT_FLOAT});
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(64 * (128 + 1), V(retvals[0]));
+  }
+}
+
+TEST_F(ExecutorTest, StaticMemoryPlanRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), nullptr, "SINGLE_THREADED_STATIC_MEMORY_EXECUTOR");
+  FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+  TF_ASSERT_OK(call_frame.SetArgs({V(1.0)}));
+  TF_ASSERT_OK(Run(&call_frame));
+  std::vector<Tensor> retvals;
+  TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+  EXPECT_EQ(4096.0, V(retvals[0]));
+}
+
 TEST_F(ExecutorTest, OpError) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto zero = test::graph::Constant(g.get(), V(0.0));
@@ -0,0 +1,278 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64_t RoundUp(int64_t size, int64_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Returns the number of bytes of output `index` of the node described by
+// `context`, or -1 if it cannot be planned.
+int64_t PlannableOutputBytes(shape_inference::InferenceContext* context,
+                             DataType dtype, int index) {
+  if (context == nullptr || !DataTypeCanUseMemcpy(dtype)) return -1;
+  const int64_t element_size = DataTypeSize(dtype);
+  if (element_size <= 0) return -1;
+  shape_inference::ShapeHandle shape = context->output(index);
+  if (!context->FullyDefined(shape)) return -1;
+  int64_t num_elements = 1;
+  for (int d = 0; d < context->Rank(shape); ++d) {
+    num_elements *= context->Value(context->Dim(shape, d));
+  }
+  return num_elements * element_size;
+}
+
+// Returns true if `node` may hold on to its input buffers after it runs.
+// Besides the nodes that hand tensors out of the step, this includes nodes
+// with variant or resource outputs, which may wrap their inputs.
+bool MayRetainInputs(const Node* node) {
+  if (node->IsRetval() || node->IsSend() || node->op_def().is_stateful()) {
+    return true;
+  }
+  for (DataType dtype : node->output_types()) {
+    if (dtype == DT_VARIANT || dtype == DT_RESOURCE) return true;
+  }
+  return false;
+}
+
+// Returns true if an output of `node` of `output_size` bytes may share the
+// buffer of an input of `input_size` bytes (-1 if unknown). Forwarding and
+// reshaping preserve the size, and only the view ops return a smaller part of
+// an input buffer.
+bool MayAlias(const Node* node, int64_t input_size, int64_t output_size) {
+  if (input_size < 0 || output_size < 0 || output_size == input_size) {
+    return true;
+  }
+  if (output_size > input_size) return false;
+  const string& op = node->type_string();
+  return op == "Slice" || op == "StridedSlice" || op == "Split" ||
+         op == "SplitV" || op == "Unpack";
+}
+
+// A node output, i.e. the buffer that the kernel allocates for it.
+struct Candidate {
+  const Node* node;
+  int output;
+  // The number of bytes of the buffer, or -1 if unknown.
+  int64_t size;
+  // False if the buffer is not allocated by the step.
+  bool plannable;
+  int first_use;
+  // The last position at which the buffer, or an output that may alias it, is
+  // used.
+  int last_use;
+  // True if the buffer, or an output that may alias it, may be used after the
+  // step.
+  bool escapes;
+};
+
+}  // namespace
+
+int64_t AssignStaticOffsets(absl::Span<const StaticBuffer> buffers,
+                            int64_t alignment, std::vector<int64_t>* offsets) {
+  std::vector<int> placement_order(buffers.size());
+  std::iota(placement_order.begin(), placement_order.end(), 0);
+  std::stable_sort(placement_order.begin(), placement_order.end(),
+                   [&buffers](int a, int b) {
+                     if (buffers[a].size != buffers[b].size) {
+                       return buffers[a].size > buffers[b].size;
+                     }
+                     return buffers[a].first_use < buffers[b].first_use;
+                   });
+
+  offsets->assign(buffers.size(), 0);
+  // The buffers placed so far, in increasing order of offset.
+  std::vector<int> placed;
+  placed.reserve(buffers.size());
+  int64_t arena_size = 0;
+  for (int i : placement_order) {
+    const StaticBuffer& buffer = buffers[i];
+    const int64_t size = RoundUp(buffer.size, alignment);
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t current_offset = 0;
+    for (int j : placed) {
+      const StaticBuffer& other = buffers[j];
+      if (other.last_use < buffer.first_use ||
+          other.first_use > buffer.last_use) {
+        continue;
+      }
+      const int64_t gap = (*offsets)[j] - current_offset;
+      if (gap >= size && gap < best_gap) {
+        best_offset = current_offset;
+        best_gap = gap;
+      }
+      current_offset = std::max(current_offset,
+                                (*offsets)[j] + RoundUp(other.size, alignment));
+    }
+    if (best_offset < 0) best_offset = current_offset;
+    (*offsets)[i] = best_offset;
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), best_offset,
+                                   [offsets](int64_t offset, int j) {
+                                     return offset < (*offsets)[j];
+                                   }),
+                  i);
+    arena_size = std::max(arena_size, best_offset + size);
+  }
+  return arena_size;
+}
+
+Status PlanStaticMemory(const Graph& graph, absl::Span<Node* const> order,
+                        StaticMemoryPlan* plan) {
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    position[order[i]->id()] = i;
+  }
+
+  // Collect one candidate per node output, with the sizes that shape inference
+  // determines. Once a node fails shape inference, so do all of its
+  // successors, so planning stops at the first failure.
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  bool shapes_known = true;
+  std::vector<Candidate> candidates;
+  std::vector<int> first_candidate(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    const Node* node = order[i];
+    first_candidate[node->id()] = candidates.size();
+    if (node->IsSource() || node->IsSink()) continue;
+    shape_inference::InferenceContext* context = nullptr;
+    if (shapes_known) {
+      Status s = refiner.AddNode(node);
+      if (s.ok()) {
+        context = refiner.GetContext(node);
+      } else {
+        VLOG(1) << "Static memory planning stops at node " << node->name()
+                << ": " << s;
+        shapes_known = false;
+      }
+    }
+    // Arguments and constants are not allocated by the step, and stateful
+    // kernels may keep a reference to their outputs.
+    const bool stateful = node->op_def().is_stateful();
+    const bool plannable = !node->IsArg() && !node->IsConstant() && !stateful;
+    for (int j = 0; j < node->num_outputs(); ++j) {
+      candidates.push_back({node, j,
+                            PlannableOutputBytes(context, node->output_type(j),
+                                                 j),
+                            plannable, i, i, /*escapes=*/stateful});
+    }
+  }
+
+  // Extend every lifetime to the last consumer.
+  for (int i = 0; i < order.size(); ++i) {
+    const Node* node = order[i];
+    if (node->IsSource() || node->IsSink()) continue;
+    const bool retains_inputs = MayRetainInputs(node);
+    for (const Edge* e : node->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      const int input = first_candidate[e->src()->id()] + e->src_output();
+      if (position[e->src()->id()] < 0 || position[e->src()->id()] > i) {
+        return errors::InvalidArgument(
+            "Static memory planning requires a topological order, but node ",
+            node->name(), " runs before its input ", e->src()->name());
+      }
+      Candidate& producer = candidates[input];
+      producer.last_use = std::max(producer.last_use, i);
+      producer.escapes |= retains_inputs;
+    }
+  }
+
+  // A buffer must also live as long as every consumer output that may alias
+  // it. Visiting the nodes in reverse order extends the lifetimes of all
+  // consumer outputs before those of their inputs.
+  for (int i = order.size() - 1; i >= 0; --i) {
+    const Node* node = order[i];
+    if (node->IsSource() || node->IsSink()) continue;
+    for (const Edge* e : node->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      Candidate& producer =
+          candidates[first_candidate[e->src()->id()] + e->src_output()];
+      for (int j = 0; j < node->num_outputs(); ++j) {
+        const Candidate& output = candidates[first_candidate[node->id()] + j];
+        if (MayAlias(node, producer.size, output.size)) {
+          producer.last_use = std::max(producer.last_use, output.last_use);
+          producer.escapes |= output.escapes;
+        }
+      }
+    }
+  }
+
+  std::vector<bool> planned(candidates.size(), false);
+  for (int i = 0; i < candidates.size(); ++i) {
+    planned[i] = candidates[i].plannable && candidates[i].size > 0 &&
+                 !candidates[i].escapes;
+  }
+
+  // A kernel's allocations are matched to slots by size alone, so a slot is
+  // only safe to hand out if no unplanned output of the same node could have
+  // that size, and if all planned outputs of that size live equally long.
+  std::vector<StaticBuffer> buffers;
+  std::vector<int> buffer_candidates;
+  for (const Node* node : order) {
+    const int begin = first_candidate[node->id()];
+    const int end = begin + node->num_outputs();
+    for (int i = begin; i < end; ++i) {
+      if (!planned[i]) continue;
+      int last_use = candidates[i].last_use;
+      bool ambiguous = false;
+      for (int j = begin; j < end; ++j) {
+        const int64_t size = candidates[j].size;
+        if (size >= 0 && size != candidates[i].size) continue;
+        if (!planned[j]) {
+          ambiguous = true;
+          break;
+        }
+        last_use = std::max(last_use, candidates[j].last_use);
+      }
+      if (ambiguous) continue;
+      buffers.push_back(
+          {candidates[i].size, candidates[i].first_use, last_use});
+      buffer_candidates.push_back(i);
+    }
+  }
+
+  std::vector<int64_t> offsets;
+  plan->arena_size = AssignStaticOffsets(
+      buffers, Allocator::kAllocatorAlignment, &offsets);
+  plan->node_slots.assign(graph.num_node_ids(), {});
+  for (int i = 0; i < buffers.size(); ++i) {
+    const Candidate& candidate = candidates[buffer_candidates[i]];
+    plan->node_slots[candidate.node->id()].push_back(
+        {candidate.output, candidate.size, offsets[i]});
+  }
+  VLOG(1) << "Static memory plan: " << buffers.size() << " of "
+          << candidates.size() << " outputs in " << plan->arena_size
+          << " bytes";
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// A buffer whose size and lifetime are known before the graph runs. The
+// lifetime is the closed interval [first_use, last_use] of positions in a
+// sequential execution order.
+struct StaticBuffer {
+  int64_t size;
+  int first_use;
+  int last_use;
+};
+
+// Assigns an offset in a single arena to each of `buffers`, such that buffers
+// with overlapping lifetimes never overlap in memory, and returns the size of
+// the arena. Buffers are placed in decreasing order of size, each in the
+// smallest gap that fits it (the "greedy by size" strategy of TFLite's
+// `ArenaPlanner`). All offsets are multiples of `alignment`.
+int64_t AssignStaticOffsets(absl::Span<const StaticBuffer> buffers,
+                            int64_t alignment, std::vector<int64_t>* offsets);
+
+// A static memory plan for the outputs of a graph whose nodes run one at a
+// time in a fixed order.
+struct StaticMemoryPlan {
+  struct Slot {
+    // The output of the node that the slot is planned for.
+    int output;
+    // The number of bytes that the output occupies.
+    int64_t size;
+    // The offset of the slot in the arena.
+    int64_t offset;
+  };
+
+  // The number of bytes of the arena that holds all slots.
+  int64_t arena_size = 0;
+
+  // The slots planned for the outputs of each node, indexed by `Node::id()`.
+  std::vector<std::vector<Slot>> node_slots;
+};
+
+// Computes a static memory plan for the outputs of `graph` when its nodes run
+// sequentially in `order`, which must be a topological order of all nodes.
+//
+// An output is planned only if its size is known after shape inference, its
+// type can be copied with memcpy, and its buffer cannot outlive the step:
+// outputs of stateful nodes and outputs that reach a `_Retval`, `_Send` or
+// stateful node are left to the device allocator. Because a kernel may forward
+// an input buffer to an output, or return a view of it, the slot of an input
+// lives as long as every output that could alias it.
+//
+// Kernels of stateless ops must not retain their inputs beyond the step.
+Status PlanStaticMemory(const Graph& graph, absl::Span<Node* const> order,
+                        StaticMemoryPlan* plan);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
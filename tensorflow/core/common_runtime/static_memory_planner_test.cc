@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(StaticMemoryPlannerTest, AssignStaticOffsets) {
+  // Buffers 0 and 2 are never live at the same time, so they share an offset.
+  const std::vector<StaticBuffer> buffers = {
+      {/*size=*/100, /*first_use=*/0, /*last_use=*/1},
+      {/*size=*/10, /*first_use=*/1, /*last_use=*/2},
+      {/*size=*/64, /*first_use=*/2, /*last_use=*/3},
+  };
+  std::vector<int64_t> offsets;
+  EXPECT_EQ(AssignStaticOffsets(buffers, /*alignment=*/64, &offsets), 192);
+  EXPECT_EQ(offsets, std::vector<int64_t>({0, 128, 0}));
+}
+
+TEST(StaticMemoryPlannerTest, AssignStaticOffsetsFillsSmallestGap) {
+  // Buffer 3 fits both the 128 byte gap left by buffer 0 and the 64 byte gap
+  // left by buffer 2, and takes the smaller one.
+  const std::vector<StaticBuffer> buffers = {
+      {/*size=*/128, /*first_use=*/0, /*last_use=*/0},
+      {/*size=*/128, /*first_use=*/0, /*last_use=*/1},
+      {/*size=*/64, /*first_use=*/0, /*last_use=*/0},
+      {/*size=*/64, /*first_use=*/1, /*last_use=*/1},
+      {/*size=*/64, /*first_use=*/0, /*last_use=*/1},
+  };
+  std::vector<int64_t> offsets;
+  EXPECT_EQ(AssignStaticOffsets(buffers, /*alignment=*/64, &offsets), 384);
+  EXPECT_EQ(offsets, std::vector<int64_t>({0, 128, 256, 256, 320}));
+}
+
+TEST(StaticMemoryPlannerTest, PlanStaticMemory) {
+  // a1 = c + c; r1 = sum(a1); a2 = c + r1; r2 = sum(a2); return r2.
+  Graph g(OpRegistry::Global());
+  Node* c = test::graph::Constant(&g, Tensor(DT_FLOAT, TensorShape({64})));
+  Node* axis = test::graph::Constant(&g, Tensor(0));
+  Node* a1 = test::graph::Add(&g, c, c);
+  Node* r1 = test::graph::Reduce(&g, "Sum", a1, axis);
+  Node* a2 = test::graph::Add(&g, c, r1);
+  Node* r2 = test::graph::Reduce(&g, "Sum", a2, axis);
+  test::graph::Retval(&g, 0, r2);
+  FixupSourceAndSinkEdges(&g);
+  std::vector<Node*> order;
+  GetReversePostOrder(g, &order);
+
+  StaticMemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(g, order, &plan));
+  ASSERT_EQ(plan.node_slots.size(), g.num_node_ids());
+  EXPECT_TRUE(plan.node_slots[c->id()].empty());
+  // The returned value escapes the step.
+  EXPECT_TRUE(plan.node_slots[r2->id()].empty());
+
+  ASSERT_EQ(plan.node_slots[a1->id()].size(), 1);
+  ASSERT_EQ(plan.node_slots[r1->id()].size(), 1);
+  ASSERT_EQ(plan.node_slots[a2->id()].size(), 1);
+  EXPECT_EQ(plan.node_slots[a1->id()][0].size, 64 * sizeof(float));
+  EXPECT_EQ(plan.node_slots[r1->id()][0].size, sizeof(float));
+  // a1 is dead by the time a2 is computed, but r1 overlaps with both.
+  EXPECT_EQ(plan.node_slots[a1->id()][0].offset,
+            plan.node_slots[a2->id()][0].offset);
+  EXPECT_NE(plan.node_slots[r1->id()][0].offset,
+            plan.node_slots[a1->id()][0].offset);
+  EXPECT_EQ(plan.arena_size, 256 + 64);
+}
+
+TEST(StaticMemoryPlannerTest, ForwardedOutputsExtendLifetime) {
+  // a = c + c; b = -a; return b. The kernel of `b` may forward the buffer of
+  // `a`, so `a` escapes too.
+  Graph g(OpRegistry::Global());
+  Node* c = test::graph::Constant(&g, Tensor(DT_FLOAT, TensorShape({64})));
+  Node* a = test::graph::Add(&g, c, c);
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  test::graph::Retval(&g, 0, b);
+  FixupSourceAndSinkEdges(&g);
+  std::vector<Node*> order;
+  GetReversePostOrder(g, &order);
+
+  StaticMemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(g, order, &plan));
+  EXPECT_TRUE(plan.node_slots[a->id()].empty());
+  EXPECT_TRUE(plan.node_slots[b->id()].empty());
+  EXPECT_EQ(plan.arena_size, 0);
+}
+
+TEST(StaticMemoryPlannerTest, UnknownShapesAreNotPlanned) {
+  Graph g(OpRegistry::Global());
+  Node* arg = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* a = test::graph::Add(&g, arg, arg);
+  Node* axis = test::graph::Constant(&g, Tensor(0));
+  Node* r = test::graph::Reduce(&g, "Sum", a, axis);
+  test::graph::Retval(&g, 0, r);
+  FixupSourceAndSinkEdges(&g);
+  std::vector<Node*> order;
+  GetReversePostOrder(g, &order);
+
+  StaticMemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(g, order, &plan));
+  EXPECT_TRUE(plan.node_slots[a->id()].empty());
+  EXPECT_EQ(plan.arena_size, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -122,9 +122,26 @@ void NodeExecStatsWrapper::RecordComputeStarted() {
   stats_->set_op_start_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                   stats_->all_start_micros());
   stats_->set_op_start_rel_nanos(now_nanos - stats_->all_start_nanos());
+  if (step_stats_collector_->hardware_counters_enabled()) {
+    compute_thread_id_ = Env::Default()->GetCurrentThreadId();
+    has_counters_start_ = ReadThreadHardwareCounters(&counters_start_);
+  }
 }
 
 void NodeExecStatsWrapper::RecordComputeEnded() {
+  HardwareCounterValues counters_end;
+  // Asynchronous kernels can end on another thread, whose counters are
+  // unrelated.
+  if (has_counters_start_ &&
+      compute_thread_id_ == Env::Default()->GetCurrentThreadId() &&
+      ReadThreadHardwareCounters(&counters_end)) {
+    HardwareCounters* counters = stats_->mutable_hardware_counters();
+    counters->set_cycles(counters_end.cycles - counters_start_.cycles);
+    counters->set_instructions(counters_end.instructions -
+                               counters_start_.instructions);
+    counters->set_llc_misses(counters_end.llc_misses -
+                             counters_start_.llc_misses);
+  }
   int64_t now_nanos = Env::Default()->NowNanos();
   DCHECK_NE(stats_->all_start_micros(), 0);
   DCHECK_NE(stats_->all_start_nanos(), 0);
@@ -19,6 +19,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/hardware_counters.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -114,6 +115,12 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
  private:
   friend class StepStatsCollector;
 
+  // Whether counters_start_ holds the hardware counters of the thread that
+  // started the compute.
+  bool has_counters_start_ = false;
+  HardwareCounterValues counters_start_;
+  int32 compute_thread_id_ = 0;
+
   NodeExecStats* stats() { return stats_.get(); }
 
   // Populates stats_ and releases TrackingAllocator.
@@ -178,6 +185,11 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
   string ReportAllocsOnResourceExhausted(absl::string_view err) override;
 
+  // Records the CPU hardware counters of each node, see
+  // NodeExecStats.hardware_counters. Must be called before the step starts.
+  void EnableHardwareCounters() { hardware_counters_enabled_ = true; }
+  bool hardware_counters_enabled() const { return hardware_counters_enabled_; }
+
   // The following 2 Finalize methods populate the StepStats passed
   // from the constructor. Calling it more than once won't have any effect.
   // User shouldn't call Save() methods after Finalize.
@@ -195,6 +207,7 @@ class StepStatsCollector : public StepStatsCollectorInterface {
 
   void FinalizeInternal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  bool hardware_counters_enabled_ = false;
   mutex mu_;
   bool finalized_ TF_GUARDED_BY(mu_);
   std::unordered_map<string, NodeStatsVector> dev_stats_ TF_GUARDED_BY(mu_);
@@ -50,9 +50,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/batch_util.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -787,9 +789,20 @@ Status ProcessBatch(int64_t batch_size, int64_t num_elements,
   return absl::OkStatus();
 }
 
+AllocatorAttributes GetBatchAllocatorAttributes() {
+  static const bool in_experiment =
+      GetExperiments().contains("pinned_host_batches");
+  AllocatorAttributes attr;
+  attr.set_gpu_compatible(in_experiment);
+  return attr;
+}
+
 Status CopyBatch(AnyContext ctx,
                  std::vector<std::vector<Tensor>>&& batch_elements,
                  bool parallel_copy, std::vector<Tensor>* out_tensors) {
+  Allocator* allocator = GetBatchAllocatorAttributes().gpu_compatible()
+                             ? ctx.gpu_compatible_allocator
+                             : ctx.allocator;
   const size_t num_tuple_components = batch_elements.at(0).size();
   out_tensors->reserve(num_tuple_components);
   const int64_t num_batch_elements = batch_elements.size();
@@ -799,7 +812,7 @@ Status CopyBatch(AnyContext ctx,
     TensorShape first_element_shape(first_element.shape());
     TensorShape batch_component_shape({num_batch_elements});
     batch_component_shape.AppendShape(first_element_shape);
-    out_tensors->emplace_back(ctx.allocator, first_element.dtype(),
+    out_tensors->emplace_back(allocator, first_element.dtype(),
                               batch_component_shape);
     if (!out_tensors->back().IsInitialized()) {
       return errors::ResourceExhausted(
@@ -872,6 +885,127 @@ Status CopyBatch(AnyContext ctx,
   return absl::OkStatus();
 }
 
+Status CopyPaddedBatch(IteratorContext* ctx,
+                       const std::vector<std::vector<Tensor>>& batch_elements,
+                       const std::vector<PartialTensorShape>& padded_shapes,
+                       const std::vector<Tensor>& padding_values,
+                       bool parallel_copy, std::vector<Tensor>* out_tensors) {
+  const size_t num_tuple_components = batch_elements[0].size();
+  const int64_t num_batch_elements = batch_elements.size();
+  for (size_t component_index = 0; component_index < num_tuple_components;
+       ++component_index) {
+    // 1. Determine the shape of the padded tensor.
+    TensorShape batch_component_shape({num_batch_elements});
+    const PartialTensorShape& padded_shape = padded_shapes[component_index];
+
+    for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+      if (padded_shape.dim_size(dim) == -1) {
+        TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(0));
+      } else {
+        TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(
+            padded_shape.dim_size(dim)));
+      }
+    }
+
+    for (int64_t i = 0; i < num_batch_elements; ++i) {
+      const TensorShape& element_shape =
+          batch_elements[i][component_index].shape();
+      // TODO(mrry): Perform this check in the shape function if
+      // enough static information is available to do so.
+      if (element_shape.dims() != padded_shape.dims()) {
+        return errors::InvalidArgument(
+            "All elements in a batch must have the same rank as the "
+            "padded shape for component",
+            component_index, ": expected rank ", padded_shape.dims(),
+            " but got element with rank ", element_shape.dims());
+      }
+      for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+        if (padded_shape.dim_size(dim) == -1) {
+          // Take the max of all batch elements in this dimension.
+          if (batch_elements[i][component_index].shape().dim_size(dim) >
+              batch_component_shape.dim_size(dim + 1)) {
+            batch_component_shape.set_dim(
+                dim + 1,
+                batch_elements[i][component_index].shape().dim_size(dim));
+          }
+        } else {
+          if (batch_elements[i][component_index].shape().dim_size(dim) >
+              batch_component_shape.dim_size(dim + 1)) {
+            return errors::DataLoss(
+                "Attempted to pad to a smaller size than the input "
+                "element.");
+          }
+        }
+      }
+    }
+
+    // 2. Copy each batch element to the appropriate location in
+    // the output component tensor.
+    out_tensors->emplace_back(ctx->allocator(GetBatchAllocatorAttributes()),
+                              padding_values[component_index].dtype(),
+                              batch_component_shape);
+    Tensor& batch_component = out_tensors->back();
+    TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+        &batch_component, padding_values[component_index]));
+
+    // Build the output tuple component by copying one slice from each input
+    // element in the batch.
+    TensorShape component_shape({});
+    for (int i = 1; i < batch_component_shape.dims(); ++i) {
+      TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
+          batch_component_shape.dim_size(i)));
+    }
+    auto copy_element_fn = [component_index, &batch_elements, &batch_component,
+                            &component_shape](int index) {
+      // Take the fast path if possible.
+      if (batch_elements[index][component_index].shape() == component_shape) {
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+            batch_elements[index][component_index], &batch_component, index));
+      } else {
+        TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+            batch_elements[index][component_index], &batch_component, index));
+      }
+      return absl::OkStatus();
+    };
+
+    if (parallel_copy &&
+        (batch_component.AllocatedBytes() / num_batch_elements) >= (1 << 15)) {
+      BlockingCounter counter(num_batch_elements);
+      Status status;
+      mutex status_mu;
+      const auto num_threads = ctx->runner_threadpool_size();
+      const auto slice_size = num_batch_elements / num_threads;
+      int64_t offset = 0;
+      for (size_t i = 0; i < num_threads; ++i) {
+        int64_t length = slice_size;
+        // When the number of threads does not divide the number of elements
+        // evenly, the size of some slices is incremented to guarantee their
+        // sizes add up to the total number of elements.
+        if (i < num_batch_elements % num_threads) ++length;
+        (*ctx->runner())([offset, length, &status, &status_mu, &counter,
+                          &copy_element_fn]() {
+          for (size_t j = offset; j < offset + length; ++j) {
+            {
+              Status s = copy_element_fn(j);
+              mutex_lock l(status_mu);
+              status.Update(s);
+            }
+            counter.DecrementCount();
+          }
+        });
+        offset += length;
+      }
+      counter.Wait();
+      TF_RETURN_IF_ERROR(status);
+    } else {
+      for (size_t i = 0; i < num_batch_elements; ++i) {
+        TF_RETURN_IF_ERROR(copy_element_fn(i));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::flat_hash_set<tstring> CreateGraphRewriteConfigs(const Options& options) {
   absl::flat_hash_set<tstring> configs;
   const auto& autotune_options = options.autotune_options();
@@ -928,6 +1062,17 @@ bool ShouldUseAutotuning(const Options& options) {
          options.autotune_options().enabled();
 }
 
+ThreadOptions GetPipelineThreadOptions(const DeviceBase* device) {
+  ThreadOptions thread_options;
+  static const bool in_experiment =
+      GetExperiments().contains("numa_aware_threads");
+  if (in_experiment && device != nullptr && port::NUMAEnabled() &&
+      port::NUMANumNodes() > 1) {
+    thread_options.numa_node = device->NumaNode();
+  }
+  return thread_options;
+}
+
 bool ShouldApplyOptimizations(
     const Options& options,
     const absl::flat_hash_set<tstring>& optimizations_enabled,
@@ -1022,8 +1167,16 @@ REGISTER_DATASET_EXPERIMENT("no_compression_v2", RandomJobSamplePercentage<50>,
                             AllTasks);
 REGISTER_DATASET_EXPERIMENT("inject_io_prefetch", RandomJobSamplePercentage<0>,
                             AllTasks);
+REGISTER_DATASET_EXPERIMENT("jpeg_decode_resize_fusion",
+                            RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("map_fusion", RandomJobSamplePercentage<0>,
                             AllTasks);
+REGISTER_DATASET_EXPERIMENT("map_vectorization", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("numa_aware_threads", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("pinned_host_batches", RandomJobSamplePercentage<0>,
+                            AllTasks);
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
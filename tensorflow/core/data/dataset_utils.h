@@ -279,17 +279,34 @@ Status ProcessBatch(int64_t batch_size, int64_t num_elements,
                     IteratorContext* ctx, std::vector<Tensor>* output,
                     bool* end_of_sequence, std::vector<Tensor>* batch);
 
+// Returns the allocator attributes for the tensors of batches. In the
+// "pinned_host_batches" experiment, batches are allocated in GPU-compatible
+// host memory, which is pinned in GPU builds, so that copying a batch to a GPU
+// does not first stage it through a pinned buffer.
+AllocatorAttributes GetBatchAllocatorAttributes();
+
 // Copies the input elements to a batch.
 //
 // The `batch_elements` argument contains the individual elements to copy into a
 // batch. The `parallel_copy` argument indicates whether to parallelize the
 // copy.
 // The `out_tensors` argument will be used to store the resulting batch (one for
-// each component of the input).
+// each component of the input), allocated with `GetBatchAllocatorAttributes()`.
 Status CopyBatch(AnyContext ctx,
                  std::vector<std::vector<Tensor>>&& batch_elements,
                  bool parallel_copy, std::vector<Tensor>* out_tensors);
 
+// Copies the input elements to a batch, in which each component is padded to
+// the corresponding shape of `padded_shapes` with the corresponding scalar of
+// `padding_values`. Unknown dimensions of `padded_shapes` are padded to the
+// largest size of the dimension in the batch. The `parallel_copy` argument
+// indicates whether to parallelize the copy of large elements.
+Status CopyPaddedBatch(IteratorContext* ctx,
+                       const std::vector<std::vector<Tensor>>& batch_elements,
+                       const std::vector<PartialTensorShape>& padded_shapes,
+                       const std::vector<Tensor>& padding_values,
+                       bool parallel_copy, std::vector<Tensor>* out_tensors);
+
 // Computes the set of experiments to apply based on the job name, task id,
 // rollout percentage of registered experiments, and the
 // TF_DATA_EXPERIMENT_OPT_IN and TF_DATA_EXPERIMENT_OPT_OUT environment
@@ -338,6 +355,12 @@ inline int GetCpuBudget() {
   return (in_experiment ? 1.2 : 1.0) * port::NumSchedulableCPUs();
 }
 
+// Returns the options for the threads of tf.data thread pools that produce
+// elements consumed on `device`. In the "numa_aware_threads" experiment, on
+// hosts with multiple NUMA nodes, the threads are pinned to the NUMA node of
+// `device`, so that elements are produced in the memory local to the consumer.
+ThreadOptions GetPipelineThreadOptions(const DeviceBase* device);
+
 // Returns the initial value for parallelism parameter before the first Autotune
 // optimization.
 int64 GetAutotuneDefaultParallelism(IteratorContext* ctx);
@@ -15,19 +15,45 @@ limitations under the License.
 #include "tensorflow/core/data/global_shuffle_utils.h"
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
+#include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Returns the number of elements a `GlobalShuffleIterator` loads in parallel.
+int64_t GetNumParallelLoads() {
+  static const int64_t num_parallel_loads = []() {
+    int64_t num_parallel_loads;
+    absl::Status s =
+        ReadInt64FromEnvVar("TF_DATA_GLOBAL_SHUFFLE_PARALLEL_LOADS",
+                            /*default_val=*/1, &num_parallel_loads);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to read TF_DATA_GLOBAL_SHUFFLE_PARALLEL_LOADS: "
+                   << s;
+      return int64_t{1};
+    }
+    return num_parallel_loads;
+  }();
+  return num_parallel_loads;
+}
+
+}  // namespace
 
 IteratorContextWithIndexMapper::IteratorContextWithIndexMapper(
     IteratorContext* ctx, const IteratorBase* iterator)
@@ -50,6 +76,18 @@ void IteratorContextWithIndexMapper::MergeCheckpoint() {
   }
 }
 
+GlobalShuffleIterator::GlobalShuffleIterator(const DatasetBase* dataset)
+    : GlobalShuffleIterator(dataset, GetNumParallelLoads()) {}
+
+GlobalShuffleIterator::GlobalShuffleIterator(const DatasetBase* dataset,
+                                             int64_t num_parallel_loads)
+    : dataset_(dataset), num_parallel_loads_(num_parallel_loads) {}
+
+GlobalShuffleIterator::~GlobalShuffleIterator() {
+  absl::MutexLock l(&mu_);
+  CancelLoads();
+}
+
 absl::Status GlobalShuffleIterator::GetNext(IteratorContext* ctx,
                                             std::vector<Tensor>* out_tensors,
                                             bool* end_of_sequence) {
@@ -59,11 +97,15 @@ absl::Status GlobalShuffleIterator::GetNext(IteratorContext* ctx,
         " which is not globally shuffled."));
   }
 
-  absl::MutexLock l(&mu_);
-  TF_ASSIGN_OR_RETURN(int64_t output_index,
-                      ctx->index_mapper()(element_count_++));
-  absl::Status status =
-      dataset_->Get(AnyContext(ctx), output_index, out_tensors);
+  absl::Status status;
+  if (num_parallel_loads_ > 1) {
+    status = GetNextLoaded(ctx, out_tensors);
+  } else {
+    absl::MutexLock l(&mu_);
+    TF_ASSIGN_OR_RETURN(int64_t output_index,
+                        ctx->index_mapper()(element_count_++));
+    status = dataset_->Get(AnyContext(ctx), output_index, out_tensors);
+  }
   if (absl::IsOutOfRange(status)) {
     *end_of_sequence = true;
     return absl::OkStatus();
@@ -73,6 +115,71 @@ absl::Status GlobalShuffleIterator::GetNext(IteratorContext* ctx,
   return absl::OkStatus();
 }
 
+absl::Status GlobalShuffleIterator::GetNextLoaded(
+    IteratorContext* ctx, std::vector<Tensor>* out_tensors) {
+  std::vector<std::function<void()>> closures;
+  std::shared_ptr<Load> load;
+  {
+    absl::MutexLock l(&mu_);
+    closures = ScheduleLoads(ctx);
+    load = std::move(loads_.front());
+    loads_.pop_front();
+    ++element_count_;
+  }
+  // The runner may run the loads inline, so they are started without holding
+  // `mu_`.
+  for (auto& closure : closures) {
+    (*ctx->runner())(std::move(closure));
+  }
+  absl::MutexLock l(&mu_);
+  while (!load->done) {
+    cond_var_.Wait(&mu_);
+  }
+  *out_tensors = std::move(load->out_tensors);
+  return load->status;
+}
+
+std::vector<std::function<void()>> GlobalShuffleIterator::ScheduleLoads(
+    IteratorContext* ctx) {
+  if (!runner_) {
+    runner_ = *ctx->runner();
+  }
+  AnyContext any_ctx(ctx);
+  any_ctx.runner = &runner_;
+  std::vector<std::function<void()>> closures;
+  while (loads_.size() < static_cast<size_t>(num_parallel_loads_)) {
+    const int64_t position = element_count_ + loads_.size();
+    auto load = std::make_shared<Load>();
+    loads_.push_back(load);
+    ++num_outstanding_loads_;
+    closures.push_back([this, any_ctx, index_mapper = ctx->index_mapper(),
+                        position, load]() {
+      absl::Status status;
+      std::vector<Tensor> out_tensors;
+      absl::StatusOr<size_t> output_index = index_mapper(position);
+      if (output_index.ok()) {
+        status = dataset_->Get(any_ctx, *output_index, &out_tensors);
+      } else {
+        status = output_index.status();
+      }
+      absl::MutexLock l(&mu_);
+      load->status = std::move(status);
+      load->out_tensors = std::move(out_tensors);
+      load->done = true;
+      --num_outstanding_loads_;
+      cond_var_.SignalAll();
+    });
+  }
+  return closures;
+}
+
+void GlobalShuffleIterator::CancelLoads() {
+  while (num_outstanding_loads_ > 0) {
+    cond_var_.Wait(&mu_);
+  }
+  loads_.clear();
+}
+
 absl::Status GlobalShuffleIterator::Restore(IteratorContext* ctx) {
   if (!ctx->restored_element_count().has_value()) {
     return absl::FailedPreconditionError(absl::StrCat(
@@ -81,6 +188,7 @@ absl::Status GlobalShuffleIterator::Restore(IteratorContext* ctx) {
   }
 
   absl::MutexLock l(&mu_);
+  CancelLoads();
   element_count_ = *(ctx->restored_element_count());
   return absl::OkStatus();
 }
@@ -16,6 +16,9 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_GLOBAL_SHUFFLE_UTILS_H_
 
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -67,8 +70,18 @@ class GlobalShuffleIterator {
  public:
   // The dataset is expected to support random access by implementing the
   // absl::Status Get(int64_t index, std::vector<Tensor>* out_tensors) const.
-  explicit GlobalShuffleIterator(const DatasetBase* dataset)
-      : dataset_(dataset) {}
+  //
+  // If `TF_DATA_GLOBAL_SHUFFLE_PARALLEL_LOADS` is set to N > 1, the iterator
+  // loads the next N elements of the shuffled order in parallel, so that
+  // random reads of file-based sources overlap. At most N elements are
+  // buffered at a time.
+  explicit GlobalShuffleIterator(const DatasetBase* dataset);
+  // Same as above, loading `num_parallel_loads` elements in parallel.
+  GlobalShuffleIterator(const DatasetBase* dataset,
+                        int64_t num_parallel_loads);
+
+  // Waits for the outstanding parallel loads.
+  ~GlobalShuffleIterator();
 
   // Returns the next shuffled element.
   // REQUIRES: ctx->index_mapper() != nullptr.
@@ -80,13 +93,47 @@ class GlobalShuffleIterator {
   absl::Status Restore(IteratorContext* ctx);
 
  private:
+  // An element that is loaded in the background.
+  struct Load {
+    absl::Status status;
+    std::vector<Tensor> out_tensors;
+    bool done = false;
+  };
+
+  // Returns the next element from the parallel loads, after starting the
+  // loads of the following positions. Each caller takes its own load off the
+  // queue before waiting for it, so concurrent callers get distinct elements.
+  absl::Status GetNextLoaded(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Adds loads of the positions following the last added one until
+  // `num_parallel_loads_` elements are loaded or in flight, and returns the
+  // closures that perform them.
+  std::vector<std::function<void()>> ScheduleLoads(IteratorContext* ctx)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Waits for the scheduled loads and drops them.
+  void CancelLoads() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const DatasetBase* const dataset_;
+  const int64_t num_parallel_loads_;
 
   mutable absl::Mutex mu_;
+  absl::CondVar cond_var_;
 
   // Count of elements produced by this iterator when it runs in the random
   // access mode.
   int64_t element_count_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // The loads of the positions `element_count_` and after, in order. Loads
+  // taken by `GetNextLoaded()` callers are already counted in
+  // `element_count_`.
+  std::deque<std::shared_ptr<Load>> loads_ ABSL_GUARDED_BY(mu_);
+  int64_t num_outstanding_loads_ ABSL_GUARDED_BY(mu_) = 0;
+  // A copy of the runner of the first `GetNext()` call, for the loads, which
+  // may outlive the call.
+  std::function<void(std::function<void()>)> runner_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace data
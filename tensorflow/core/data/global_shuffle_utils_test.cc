@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/global_shuffle_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::UnorderedElementsAreArray;
+
+constexpr int64_t kNumElements = 64;
+
+class GlobalShuffleIteratorTest : public DatasetOpsTestBase {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK(Initialize(RangeDatasetParams(0, kNumElements, 1)));
+    // Reverses the range, so that the loads complete out of the shuffled
+    // order more often than not.
+    IteratorContext::Params params(iterator_ctx_.get());
+    params.index_mapper = [](size_t position) -> absl::StatusOr<size_t> {
+      if (position >= kNumElements) return position;
+      return kNumElements - 1 - position;
+    };
+    shuffled_ctx_ = std::make_unique<IteratorContext>(params);
+  }
+
+  // Returns the next element of `iterator`, or -1 at the end of the sequence.
+  int64_t GetNext(GlobalShuffleIterator& iterator) {
+    std::vector<Tensor> out_tensors;
+    bool end_of_sequence = false;
+    TF_EXPECT_OK(
+        iterator.GetNext(shuffled_ctx_.get(), &out_tensors, &end_of_sequence));
+    if (end_of_sequence) return -1;
+    EXPECT_EQ(out_tensors.size(), 1);
+    if (out_tensors.size() != 1) return -2;
+    return out_tensors[0].scalar<int64_t>()();
+  }
+
+  std::unique_ptr<IteratorContext> shuffled_ctx_;
+};
+
+std::vector<int64_t> ReversedRange(int64_t first, int64_t last) {
+  std::vector<int64_t> elements;
+  for (int64_t i = last; i >= first; --i) elements.push_back(i);
+  return elements;
+}
+
+TEST_F(GlobalShuffleIteratorTest, ParallelLoadsKeepShuffledOrder) {
+  for (int64_t num_parallel_loads : {1, 2, 8}) {
+    GlobalShuffleIterator iterator(dataset_, num_parallel_loads);
+    std::vector<int64_t> elements;
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      elements.push_back(GetNext(iterator));
+    }
+    EXPECT_THAT(elements, ElementsAreArray(ReversedRange(0, kNumElements - 1)))
+        << "num_parallel_loads: " << num_parallel_loads;
+    EXPECT_EQ(GetNext(iterator), -1);
+  }
+}
+
+TEST_F(GlobalShuffleIteratorTest, ConcurrentCallersGetDistinctElements) {
+  constexpr int kNumThreads = 4;
+  GlobalShuffleIterator iterator(dataset_, /*num_parallel_loads=*/8);
+  absl::Mutex mu;
+  std::vector<int64_t> elements;
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "get_next", [&]() {
+            for (int64_t i = 0; i < kNumElements / kNumThreads; ++i) {
+              const int64_t element = GetNext(iterator);
+              absl::MutexLock l(&mu);
+              elements.push_back(element);
+            }
+          }));
+    }
+  }
+  EXPECT_THAT(elements,
+              UnorderedElementsAreArray(ReversedRange(0, kNumElements - 1)));
+  EXPECT_EQ(GetNext(iterator), -1);
+}
+
+TEST_F(GlobalShuffleIteratorTest, RestoreDropsParallelLoads) {
+  GlobalShuffleIterator iterator(dataset_, /*num_parallel_loads=*/8);
+  EXPECT_EQ(GetNext(iterator), kNumElements - 1);
+  EXPECT_EQ(GetNext(iterator), kNumElements - 2);
+
+  IteratorContext::Params params(shuffled_ctx_.get());
+  params.restored_element_count = 1;
+  IteratorContext restore_ctx(params);
+  TF_ASSERT_OK(iterator.Restore(&restore_ctx));
+  EXPECT_EQ(GetNext(iterator), kNumElements - 2);
+  EXPECT_EQ(GetNext(iterator), kNumElements - 3);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -24,8 +24,10 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -34,9 +36,11 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/host_info.h"
 
 namespace tensorflow {
@@ -57,6 +61,10 @@ constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
 constexpr char kWarmStart[] = "warm_start";
+// If set, tuned autotuning parameters are persisted in and restored from this
+// directory, keyed by the fingerprint of the input pipeline.
+constexpr char kAutotuneWarmStartDirEnvVar[] =
+    "TF_DATA_AUTOTUNE_WARM_START_DIR";
 
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
 inline int64_t value_or_default(int64_t x, int64_t y, int64_t z) {
@@ -183,9 +191,6 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
                            port::MaxParallelism());
-      thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
-          threadpool_size_);
     }
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
@@ -200,6 +205,14 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     // we need to pass ram_budget_manager_ to the downstream dataset operations
     ram_budget_manager_ = std::make_shared<model::RamBudgetManager>(
         dataset()->params_.ComputeInitialAutotuneRamBudget());
+    if (dataset()->params_.private_threadpool_size >= 0) {
+      // The pool is created here rather than in the constructor to pin its
+      // threads to the NUMA node of the device that consumes the elements.
+      thread_pool_ = std::make_unique<thread::ThreadPool>(
+          Env::Default(),
+          GetPipelineThreadOptions(ctx->flr() ? ctx->flr()->device() : nullptr),
+          "data_private_threadpool", threadpool_size_);
+    }
 
     if (dataset()->params_.autotune) {
       if (ctx->model() != nullptr) {
@@ -227,6 +240,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
                                                        prefix(), &input_impl_));
     ctx->MergeCheckpoint(iter_ctx.checkpoint());
+    if (model_) {
+      MaybeWarmStartAutotuning();
+    }
     return absl::OkStatus();
   }
 
@@ -340,6 +356,32 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     return params;
   }
 
+  // Restores the tuned parameters of a previous run of the same input
+  // pipeline, and persists the tuned parameters of this run, if
+  // `kAutotuneWarmStartDirEnvVar` is set.
+  void MaybeWarmStartAutotuning() {
+    std::string dir;
+    Status s = ReadStringFromEnvVar(kAutotuneWarmStartDirEnvVar, "", &dir);
+    if (!s.ok() || dir.empty()) {
+      return;
+    }
+    GraphDef graph_def;
+    uint64 fingerprint;
+    s = AsGraphDef(dataset()->input_, SerializationContext({}), &graph_def);
+    if (s.ok()) {
+      s = HashGraph(graph_def, &fingerprint);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to fingerprint the input pipeline, autotuning "
+                      "will not be warm-started: "
+                   << s;
+      return;
+    }
+    model_->UseTunedParametersFile(io::JoinPath(
+        dir, strings::Printf("autotune_%016llx.pb",
+                             static_cast<unsigned long long>(fingerprint))));
+  }
+
   Status EnsureModelThreadStarted(IteratorContext* ctx) {
     mutex_lock l(mu_);
     if (!model_thread_) {
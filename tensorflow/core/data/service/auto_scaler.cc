@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
 
@@ -37,6 +38,33 @@ namespace data {
 
 constexpr double kAutoScalerOutlierSigmas = 1.0;
 
+// Smoothing factors of the level and the trend of the consumption rate
+// forecast. Higher values follow recent reports more closely.
+constexpr double kForecastLevelSmoothing = 0.5;
+constexpr double kForecastTrendSmoothing = 0.2;
+
+// Consumers report their target processing times at roughly the same time, so
+// the trend is updated at most once per interval, to keep it from following
+// the order of the reports. Reports in between only move the level.
+constexpr absl::Duration kMinForecastUpdateInterval = absl::Seconds(1);
+
+// The trend is damped: it halves every half-life, so that the forecast of a
+// consumption rate that stopped changing converges to its level.
+constexpr absl::Duration kForecastTrendHalfLife = absl::Minutes(1);
+
+// Returns the factor by which the trend decays over `duration`.
+double TrendDecay(absl::Duration duration) {
+  return std::exp2(-absl::FDivDuration(duration, kForecastTrendHalfLife));
+}
+
+// Returns how much a unit trend, decaying from now on, adds to the
+// consumption rate over `duration`.
+double DampedTrendGrowth(absl::Duration duration) {
+  const double decay_rate =
+      std::log(2.0) / absl::ToDoubleSeconds(kForecastTrendHalfLife);
+  return (1.0 - TrendDecay(duration)) / decay_rate;
+}
+
 template <typename T>
 double GetMedian(const absl::flat_hash_map<T, double>& rates) {
   std::vector<double> sorted_rates;
@@ -114,6 +142,34 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
       std::accumulate(consumption_rates_without_outliers.begin(),
                       consumption_rates_without_outliers.end(), 0.0);
 
+  int64_t optimal_number_of_workers =
+      ceil(consumption_rates_sum_ / GetAverageWorkerThroughput());
+
+  return std::max(int64_t{1}, optimal_number_of_workers);
+}
+
+std::optional<int64_t> AutoScaler::GetPredictedNumberOfWorkers(
+    absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+
+  if (worker_throughputs_.empty() || consumption_rates_.empty())
+    return std::nullopt;
+
+  // The trend has been decaying since the last update.
+  absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  double trend =
+      consumption_rate_trend_ *
+      TrendDecay(now - last_forecast_update_time_.value_or(now));
+  double predicted_consumption_rate = std::max(
+      0.0, consumption_rate_level_ + trend * DampedTrendGrowth(horizon));
+  int64_t predicted_number_of_workers =
+      ceil(predicted_consumption_rate / GetAverageWorkerThroughput());
+
+  return std::max(int64_t{1}, predicted_number_of_workers);
+}
+
+double AutoScaler::GetAverageWorkerThroughput() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<double> worker_throughputs_without_outliers;
   ReplaceOutliers(worker_throughputs_, worker_throughputs_without_outliers,
                   kAutoScalerOutlierSigmas);
@@ -121,13 +177,53 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
       std::accumulate(worker_throughputs_without_outliers.begin(),
                       worker_throughputs_without_outliers.end(), 0.0);
 
-  double average_worker_throughput =
-      worker_throughputs_sum_ / static_cast<double>(worker_throughputs_.size());
+  return worker_throughputs_sum_ /
+         static_cast<double>(worker_throughputs_.size());
+}
 
-  int64_t optimal_number_of_workers =
-      ceil(consumption_rates_sum_ / average_worker_throughput);
+void AutoScaler::UpdateConsumptionRateForecast()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<double> consumption_rates_without_outliers;
+  ReplaceOutliers(consumption_rates_, consumption_rates_without_outliers,
+                  kAutoScalerOutlierSigmas);
+  double consumption_rates_sum =
+      std::accumulate(consumption_rates_without_outliers.begin(),
+                      consumption_rates_without_outliers.end(), 0.0);
 
-  return std::max(int64_t{1}, optimal_number_of_workers);
+  absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  if (!last_forecast_update_time_.has_value()) {
+    consumption_rate_level_ = consumption_rates_sum;
+    consumption_rate_trend_ = 0.0;
+    last_forecast_update_time_ = now;
+    last_consumption_rates_sum_ = consumption_rates_sum;
+    return;
+  }
+  absl::Duration elapsed = now - *last_forecast_update_time_;
+  if (elapsed < kMinForecastUpdateInterval) {
+    // Part of the same round of reports: a step of the level, not a trend.
+    consumption_rate_level_ +=
+        consumption_rates_sum - last_consumption_rates_sum_;
+    last_consumption_rates_sum_ = consumption_rates_sum;
+    return;
+  }
+
+  // Holt's linear method with a damped trend.
+  double previous_level = consumption_rate_level_;
+  consumption_rate_level_ =
+      kForecastLevelSmoothing * consumption_rates_sum +
+      (1 - kForecastLevelSmoothing) *
+          (previous_level +
+           consumption_rate_trend_ * DampedTrendGrowth(elapsed));
+  consumption_rate_trend_ =
+      kForecastTrendSmoothing * (consumption_rate_level_ - previous_level) /
+          absl::ToDoubleSeconds(elapsed) +
+      (1 - kForecastTrendSmoothing) * consumption_rate_trend_ *
+          TrendDecay(elapsed);
+  last_forecast_update_time_ = now;
+  last_consumption_rates_sum_ = consumption_rates_sum;
+  VLOG(3) << "Forecast consumption rate: " << consumption_rate_level_
+          << " elements/s, trend: " << consumption_rate_trend_
+          << " elements/s^2";
 }
 
 absl::Status AutoScaler::ReportProcessingTime(const std::string& worker_address,
@@ -159,6 +255,7 @@ absl::Status AutoScaler::ReportTargetProcessingTime(
   double consumption_rate = 1.0 / absl::ToDoubleSeconds(target_processing_time);
   tsl::mutex_lock l(mu_);
   consumption_rates_[consumer_id] = consumption_rate;
+  UpdateConsumptionRateForecast();
 
   return absl::OkStatus();
 }
@@ -183,6 +280,7 @@ absl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
         absl::StrCat("Consumer with ID ", consumer_id, " not found"));
 
   consumption_rates_.erase(consumer_id);
+  UpdateConsumptionRateForecast();
 
   return absl::OkStatus();
 }
@@ -190,7 +288,7 @@ absl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
 void MultipleIterationsAutoScaler::EnsureIterationIsRegistered(
     int64_t iteration_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (!auto_scalers_.contains(iteration_id)) {
-    auto_scalers_[iteration_id] = std::make_unique<AutoScaler>();
+    auto_scalers_[iteration_id] = std::make_unique<AutoScaler>(env_);
   }
 }
 
@@ -263,6 +361,29 @@ std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     return optimal_number_of_workers;
 }
 
+std::optional<int64_t>
+MultipleIterationsAutoScaler::GetPredictedNumberOfWorkers(
+    absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_) {
+  int64_t predicted_number_of_workers = 0;
+  {
+    tsl::tf_shared_lock l(mu_);
+    for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+      std::optional<int64_t> current_predicted_number_of_workers =
+          auto_scaler->GetPredictedNumberOfWorkers(horizon);
+      if (!current_predicted_number_of_workers.has_value()) continue;
+
+      predicted_number_of_workers =
+          std::max(predicted_number_of_workers,
+                   current_predicted_number_of_workers.value());
+    }
+  }
+
+  if (predicted_number_of_workers == 0)
+    return std::nullopt;
+  else
+    return predicted_number_of_workers;
+}
+
 absl::Status MultipleIterationsAutoScaler::ReportProcessingTime(
     int64_t iteration_id, const std::string& worker_address,
     absl::Duration processing_time) TF_LOCKS_EXCLUDED(mu_) {
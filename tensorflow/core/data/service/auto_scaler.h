@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/thread_annotations.h"
@@ -63,16 +64,26 @@ namespace data {
 // follows:
 //  N = (Sum of CRs reported by all consumers) /
 //      (Average of WTs reported by all workers)
+// 3. To scale ahead of demand, e.g. while consumers join at the start of an
+// epoch, it also smooths the sum of CRs over time with Holt's linear method,
+// which tracks its level and trend, and extrapolates the trend to forecast the
+// number of workers needed in the near future. The trend decays over time, so
+// that it stops counting once the CRs stop changing.
 //
 // AutoScaler is thread-safe.
 class AutoScaler {
  public:
-  AutoScaler() = default;
+  explicit AutoScaler(tsl::Env* env = tsl::Env::Default()) : env_(env) {}
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated number of workers needed for the workload forecast
+  // `horizon` from now. Returns nullopt in the same cases as
+  // `GetOptimalNumberOfWorkers`.
+  std::optional<int64_t> GetPredictedNumberOfWorkers(
+      absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address`. Returns an error if `processing_time` is ZeroDuration or
   // negative.
@@ -96,12 +107,27 @@ class AutoScaler {
   absl::Status RemoveConsumer(int64_t consumer_id) TF_LOCKS_EXCLUDED(mu_);
 
  private:
+  // Returns the average worker throughput, with outliers replaced by the
+  // median.
+  double GetAverageWorkerThroughput() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Updates the consumption rate forecast with the current sum of CRs.
+  void UpdateConsumptionRateForecast() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  tsl::Env* const env_;
   mutable tsl::mutex mu_;
   // Map from worker address to worker throughput.
   absl::flat_hash_map<std::string, double> worker_throughputs_
       TF_GUARDED_BY(mu_);
   // Map from consumer id to consumption rate.
   absl::flat_hash_map<int64_t, double> consumption_rates_ TF_GUARDED_BY(mu_);
+  // The smoothed sum of CRs, in elements per second, and its trend, in
+  // elements per second per second.
+  double consumption_rate_level_ TF_GUARDED_BY(mu_) = 0.0;
+  double consumption_rate_trend_ TF_GUARDED_BY(mu_) = 0.0;
+  // The time of the last update of the trend, or nullopt if there is none.
+  std::optional<absl::Time> last_forecast_update_time_ TF_GUARDED_BY(mu_);
+  // The sum of CRs at the last report.
+  double last_consumption_rates_sum_ TF_GUARDED_BY(mu_) = 0.0;
 };
 
 // Exports a metric (/tensorflow/data/service/optimal_number_of_workers) with
@@ -114,7 +140,8 @@ class AutoScaler {
 // MultipleIterationsAutoScaler is thread-safe.
 class MultipleIterationsAutoScaler {
  public:
-  MultipleIterationsAutoScaler() = default;
+  explicit MultipleIterationsAutoScaler(tsl::Env* env = tsl::Env::Default())
+      : env_(env) {}
   // Unregisters iteration with `iteration_id`, removing its reported
   // times from consideration of the current workload estimation.
   // Returns an error if the specified iteration does not exist.
@@ -131,6 +158,12 @@ class MultipleIterationsAutoScaler {
   // target processing times for at least one iteration, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated number of workers needed for the workload forecast
+  // `horizon` from now, as the maximum of the forecasts of all Iterations. If
+  // there are no previously reported processing and target processing times
+  // for at least one iteration, returns nullopt.
+  std::optional<int64_t> GetPredictedNumberOfWorkers(
+      absl::Duration horizon) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address` for iteration with `iteration_id`. Returns an error if
   // `processing_time` is ZeroDuration or negative.
@@ -167,6 +200,7 @@ class MultipleIterationsAutoScaler {
   // workload estimation.
   void EnsureIterationIsRegistered(int64_t iteration_id)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  tsl::Env* const env_;
   mutable tsl::mutex mu_;
   // Map from iteration id to AutoScaler.
   absl::flat_hash_map<int64_t, std::unique_ptr<AutoScaler>> auto_scalers_
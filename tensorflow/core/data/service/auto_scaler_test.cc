@@ -20,6 +20,8 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/fake_clock_env.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/status_matchers.h"
 
@@ -308,6 +310,86 @@ TEST(AutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
 }
 
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersInitialState) {
+  AutoScaler auto_scaler;
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(1)),
+            std::nullopt);
+}
+
+// Worker 0:
+//   - Processing time = 0.2 [s] -> Throughput = 5 [elements/s]
+// t = 0 [s]: Consumer 0 reports a consumption rate of 10 [elements/s].
+//   - Level = 10 [elements/s], trend = 0 [elements/s^2]
+// t = 10 [s]: Consumer 1 joins with a consumption rate of 10 [elements/s].
+//   - Level = 0.5 * 20 + 0.5 * (10 + 0) = 15 [elements/s]
+//   - Trend = 0.2 * (15 - 10) / 10 + 0.8 * 0 = 0.1 [elements/s^2]
+//
+// The trend halves every 60 [s], so over a horizon h [s] it adds
+// trend * (1 - 2^(-h / 60)) * 60 / ln(2) to the consumption rate.
+//
+// Predicted consumption rate in 10 [min] =
+//   15 + 0.1 * (1 - 2^-10) * 86.56 = 23.65 [elements/s]
+// Predicted number of workers = ⌈23.65 / 5⌉ = 5
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersFollowsTrend) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.1)));
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(10)), 2);
+
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Seconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(1, absl::Seconds(0.1)));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 4);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::ZeroDuration()), 3);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(10)), 5);
+}
+
+// Same as above, then no consumer reports a new consumption rate for 5 [min].
+//   - Trend = 0.1 * 2^-5 = 0.003125 [elements/s^2]
+//
+// Predicted consumption rate in 10 [min] =
+//   15 + 0.003125 * (1 - 2^-10) * 86.56 = 15.27 [elements/s]
+// Predicted number of workers = ⌈15.27 / 5⌉ = 4
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersTrendDecays) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.1)));
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Seconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(1, absl::Seconds(0.1)));
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(10)), 5);
+
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Minutes(5)));
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(10)), 4);
+}
+
+// Worker 0:
+//   - Processing time = 0.2 [s] -> Throughput = 5 [elements/s]
+// t = 0 [s]: Consumer 0 reports a consumption rate of 10 [elements/s].
+//   - Level = 10 [elements/s], trend = 0 [elements/s^2]
+// t = 0.1 [s]: Consumer 1 joins with a consumption rate of 10 [elements/s].
+//   - The level steps by 10, to 20 [elements/s], and the trend stays 0.
+// t = 10 [s]: Consumer 1 reports the same consumption rate.
+//   - Level = 0.5 * 20 + 0.5 * (20 + 0) = 20 [elements/s], trend = 0
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersReportsInTheSameSecond) {
+  FakeClockEnv env(Env::Default());
+  AutoScaler auto_scaler(&env);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.1)));
+  env.AdvanceByMicroseconds(
+      absl::ToInt64Microseconds(absl::Milliseconds(100)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(1, absl::Seconds(0.1)));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 4);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(1)), 4);
+
+  env.AdvanceByMicroseconds(absl::ToInt64Microseconds(absl::Seconds(9.9)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(1, absl::Seconds(0.1)));
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(10)), 4);
+}
+
 TEST(MultipleIterationsAutoScalerTest, UnregisterExistingIteration) {
   MultipleIterationsAutoScaler auto_scaler;
   TF_ASSERT_OK(
@@ -743,6 +825,22 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest, GetPredictedNumberOfWorkers) {
+  FakeClockEnv env(Env::Default());
+  MultipleIterationsAutoScaler auto_scaler(&env);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(1)),
+            std::nullopt);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.1)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 0, absl::Seconds(0.025)));
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::Minutes(1)), 8);
+}
+
 }  // namespace
 
 }  // namespace data
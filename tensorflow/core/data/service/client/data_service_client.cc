@@ -27,16 +27,19 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/client/common.h"
+#include "tensorflow/core/data/service/client/utils.h"
 #include "tensorflow/core/data/service/client/validate_utils.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/url.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/data/utils.h"
@@ -61,6 +64,41 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+// A task is hot if it takes more than this factor times the median processing
+// time of the iteration's tasks to produce an element.
+constexpr double kHotTaskFactor = 2.0;
+
+// Non-coordinated reads only read from hot tasks every this many rounds, or
+// when no other task is available.
+constexpr int64_t kHotTaskReadInterval = 4;
+
+// Smoothing factors of the moving averages of the `GetElement` latency, its
+// deviation, and the consumer interval, from which autotuned clients size
+// `max_outstanding_requests_`.
+constexpr double kLatencySmoothing = 0.125;
+constexpr double kLatencyDeviationSmoothing = 0.25;
+constexpr double kConsumerIntervalSmoothing = 0.125;
+
+// Autotuned clients keep at most this many requests per task in flight or
+// buffered.
+constexpr int64_t kMaxOutstandingRequestsPerTask = 8;
+
+// Returns the exponential moving average of `average` and `sample`, or
+// `sample` if there is no average yet.
+absl::Duration Smooth(absl::Duration average, absl::Duration sample,
+                      double smoothing) {
+  if (average == absl::ZeroDuration()) {
+    return sample;
+  }
+  return average + smoothing * (sample - average);
+}
+
+// Returns true if the worker of `task` runs on the same host as the client.
+bool IsSameHostTask(const TaskInfo& task) {
+  return LocalWorkers::Get(task.worker_address()) != nullptr ||
+         URL(task.worker_address()).host() == tsl::port::Hostname();
+}
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -192,6 +230,7 @@ absl::StatusOr<GetNextResult> DataServiceClient::GetNext(
     VLOG(1) << "Consumer " << *params_.consumer_index << ": Result "
             << get_next_index_++;
   }
+  RecordConsumerRead();
   next.tensors.swap(result->element);
   return next;
 }
@@ -536,6 +575,14 @@ void DataServiceClient::UpdateTasks(const ClientHeartbeatResponse& resp)
       break;
     }
   }
+  if (!IsCoordinatedRead()) {
+    const absl::flat_hash_set<int64_t> hot_tasks =
+        FindHotTasks(resp, kHotTaskFactor);
+    for (std::shared_ptr<Task>& task : tasks_) {
+      task->hot = hot_tasks.contains(task->info.task_id()) &&
+                  !IsSameHostTask(task->info);
+    }
+  }
 }
 
 bool DataServiceClient::ShouldReadFromTask(const TaskInfo& task) const
@@ -578,8 +625,13 @@ void DataServiceClient::UpdateBufferSize() TF_LOCKS_EXCLUDED(mu_) {
     // `tasks_` includes the local tasks, so we subtract one from the
     // configured local task buffer size.
     mutex_lock l(mu_);
+    const int64_t requested_outstanding_requests =
+        EstimateMaxOutstandingRequests(
+            tasks_.size(), get_element_latency_,
+            get_element_latency_deviation_, consumer_interval_,
+            kMaxOutstandingRequestsPerTask);
     int64_t max_outstanding_requests = ctx_->UpdateMaxOutstandingRequests(
-        max_outstanding_requests_, tasks_.size());
+        max_outstanding_requests_, requested_outstanding_requests);
     if (max_outstanding_requests > max_outstanding_requests_) {
       worker_thread_cv_.notify_all();
     }
@@ -710,13 +762,16 @@ bool DataServiceClient::ShouldProcessTask() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
 }
 
 // Searches for a task to process, visiting tasks in-order and giving every
-// task a chance to proceed.
+// task a chance to proceed. Non-coordinated reads skip hot tasks, except every
+// `kHotTaskReadInterval` rounds or if no other task is available.
 std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (!ShouldProcessTask()) {
     return nullptr;
   }
 
+  // The first hot task skipped, to read from if no other task is available.
+  std::shared_ptr<Task> hot_task;
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
     if (IsCoordinatedRead() &&
@@ -740,11 +795,23 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
       AdvanceTaskIndex();
       continue;
     }
+    if (!IsCoordinatedRead() && task->hot &&
+        current_round_ % kHotTaskReadInterval != 0) {
+      VLOG(3) << "Deprioritizing hot task " << task->info.task_id();
+      if (hot_task == nullptr) {
+        hot_task = task;
+      }
+      AdvanceTaskIndex();
+      continue;
+    }
     task->round = current_round_;
     AdvanceTaskIndex();
     return task;
   }
-  return nullptr;
+  if (hot_task != nullptr) {
+    hot_task->round = current_round_;
+  }
+  return hot_task;
 }
 
 // Increments the next task index, starting over if all tasks have been
@@ -820,10 +887,15 @@ Status DataServiceClient::GetElementTraced(Task* task, int64_t deadline_micros,
            {"round_index", task->round}});
     });
   }
+  const int64_t start_micros = Env::Default()->NowMicros();
   Status s =
       GetElement(task, deadline_micros, enqueue_result, allow_skip, result);
   mutex_lock l(mu_);
   VLOG(3) << "Got an element for task id " << task->info.task_id();
+  if (s.ok() && !result->skip) {
+    RecordGetElementLatency(
+        absl::Microseconds(Env::Default()->NowMicros() - start_micros));
+  }
   return s;
 }
 
@@ -928,6 +1000,33 @@ bool DataServiceClient::ResultReady() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   return !results_.empty() && results_.front()->ready;
 }
 
+void DataServiceClient::RecordGetElementLatency(absl::Duration latency)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (get_element_latency_ == absl::ZeroDuration()) {
+    // As for TCP round-trip times, the first deviation is half the latency.
+    get_element_latency_ = latency;
+    get_element_latency_deviation_ = latency / 2;
+    return;
+  }
+  get_element_latency_deviation_ =
+      Smooth(get_element_latency_deviation_,
+             absl::AbsDuration(latency - get_element_latency_),
+             kLatencyDeviationSmoothing);
+  get_element_latency_ =
+      Smooth(get_element_latency_, latency, kLatencySmoothing);
+}
+
+void DataServiceClient::RecordConsumerRead() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t now_micros = Env::Default()->NowMicros();
+  if (last_consumer_read_micros_.has_value()) {
+    consumer_interval_ = Smooth(
+        consumer_interval_,
+        absl::Microseconds(now_micros - *last_consumer_read_micros_),
+        kConsumerIntervalSmoothing);
+  }
+  last_consumer_read_micros_ = now_micros;
+}
+
 std::shared_ptr<DataServiceClient::Result> DataServiceClient::PopNextResult()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::shared_ptr<Result> result = results_.front();
@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/client/common.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -112,6 +113,10 @@ class DataServiceClient {
     bool in_use TF_GUARDED_BY(&DataServiceClient::mu_) = false;
     // Indicates whether the worker has returned end_of_sequence for the task.
     bool end_of_sequence TF_GUARDED_BY(&DataServiceClient::mu_) = false;
+    // Whether the task is much slower than the other tasks of the iteration
+    // and not on the same host as the client, in which case non-coordinated
+    // reads deprioritize it.
+    bool hot TF_GUARDED_BY(&DataServiceClient::mu_) = false;
     // Number of retries. The more it is retried, the longer it should wait
     // before the next retry.
     int64_t num_retries = 0;
@@ -173,7 +178,7 @@ class DataServiceClient {
   // `max_outstanding_requests_`.
   bool ShouldProcessTask();
   // Searches for a task to process, visiting tasks in-order and giving every
-  // task a chance to proceed.
+  // task a chance to proceed. Non-coordinated reads visit hot tasks less often.
   std::shared_ptr<Task> GetTaskToProcess();
   void AdvanceTaskIndex();
   Status TryGetElement(const Task& task, bool allow_skip,
@@ -188,6 +193,10 @@ class DataServiceClient {
   Status GetElement(Task* task, int64_t deadline_micros, bool enqueue_result,
                     bool allow_skip, std::shared_ptr<Result> result);
   bool ResultReady() const;
+  // Updates the moving averages from which autotuned clients size
+  // `max_outstanding_requests_`.
+  void RecordGetElementLatency(absl::Duration latency);
+  void RecordConsumerRead();
   std::shared_ptr<Result> PopNextResult();
   bool IsCoordinatedRead() const;
   std::string DebugString() const;
@@ -209,6 +218,15 @@ class DataServiceClient {
   // elements as well as completed requests which haven't yet been produced.
   int64_t max_outstanding_requests_ TF_GUARDED_BY(mu_);
 
+  // Moving averages of the latency of successful `GetElement` requests, of its
+  // deviation, and of the interval between reads of the consumer. When
+  // `max_outstanding_requests` is autotuned, they determine how many requests
+  // to keep in flight or buffered.
+  absl::Duration get_element_latency_ TF_GUARDED_BY(mu_);
+  absl::Duration get_element_latency_deviation_ TF_GUARDED_BY(mu_);
+  absl::Duration consumer_interval_ TF_GUARDED_BY(mu_);
+  std::optional<int64_t> last_consumer_read_micros_ TF_GUARDED_BY(mu_);
+
   // The number of threads in `worker_threads_` which are still running.
   int64_t num_running_worker_threads_ TF_GUARDED_BY(mu_) = 0;
 
@@ -14,10 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/client/utils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
@@ -137,5 +141,47 @@ int64_t EstimateCardinality(const ProcessingModeDef& processing_mode,
   }
   return kUnknownCardinality;
 }
+absl::flat_hash_set<int64_t> FindHotTasks(const ClientHeartbeatResponse& resp,
+                                          double hot_task_factor) {
+  std::vector<double> processing_times_nsec;
+  for (const TaskInfo& task : resp.task_info()) {
+    if (task.processing_time_nsec() > 0) {
+      processing_times_nsec.push_back(task.processing_time_nsec());
+    }
+  }
+  absl::flat_hash_set<int64_t> hot_tasks;
+  if (processing_times_nsec.empty()) {
+    return hot_tasks;
+  }
+  // Uses the upper median, so that at most half of the tasks are hot.
+  auto median =
+      processing_times_nsec.begin() + processing_times_nsec.size() / 2;
+  std::nth_element(processing_times_nsec.begin(), median,
+                   processing_times_nsec.end());
+  for (const TaskInfo& task : resp.task_info()) {
+    if (task.processing_time_nsec() > hot_task_factor * *median) {
+      hot_tasks.insert(task.task_id());
+    }
+  }
+  return hot_tasks;
+}
+
+int64_t EstimateMaxOutstandingRequests(
+    int64_t num_tasks, absl::Duration latency, absl::Duration latency_deviation,
+    absl::Duration consumer_interval,
+    int64_t max_outstanding_requests_per_task) {
+  if (latency <= absl::ZeroDuration() ||
+      consumer_interval <= absl::ZeroDuration()) {
+    return num_tasks;
+  }
+  const double requests = std::ceil(
+      absl::FDivDuration(latency + 4 * latency_deviation, consumer_interval));
+  const int64_t max_requests = max_outstanding_requests_per_task * num_tasks;
+  if (requests >= max_requests) {
+    return max_requests;
+  }
+  return std::max(num_tasks, static_cast<int64_t>(requests));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -19,6 +19,8 @@ limitations under the License.
 #include <optional>
 #include <string>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
@@ -51,6 +53,24 @@ int64_t EstimateCardinality(const ProcessingModeDef& processing_mode,
                             const DataServiceMetadata& metadata,
                             bool is_coordinated_read);
 
+// Returns the IDs of the tasks in `resp` that take more than `hot_task_factor`
+// times the median reported processing time to produce an element. Tasks with
+// unknown processing times are never hot.
+absl::flat_hash_set<int64_t> FindHotTasks(const ClientHeartbeatResponse& resp,
+                                          double hot_task_factor);
+
+// Estimates how many `GetElement` requests a client reading from `num_tasks`
+// tasks should keep in flight or buffered so that its consumer does not wait.
+// By Little's law, a consumer reading an element every `consumer_interval`
+// needs enough requests to cover the `GetElement` latency, plus four times
+// `latency_deviation` of headroom for variable latency. The estimate is at
+// least `num_tasks` and at most `max_outstanding_requests_per_task` times
+// `num_tasks`. Returns `num_tasks` until the latency and interval are known.
+int64_t EstimateMaxOutstandingRequests(
+    int64_t num_tasks, absl::Duration latency, absl::Duration latency_deviation,
+    absl::Duration consumer_interval,
+    int64_t max_outstanding_requests_per_task);
+
 }  // namespace data
 }  // namespace tensorflow
 
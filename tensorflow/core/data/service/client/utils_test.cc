@@ -14,9 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/client/utils.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
@@ -127,6 +131,74 @@ TEST(UtilsTest, EstimateCardinalityUnknownCardinality) {
                                 /*is_coordinated_read=*/false),
             kUnknownCardinality);
 }
+
+TEST(UtilsTest, FindHotTasks) {
+  ClientHeartbeatResponse resp;
+  // Task 4 has not reported its processing time yet.
+  for (const auto& [task_id, processing_time_nsec] :
+       std::vector<std::pair<int64_t, double>>{
+           {0, 100}, {1, 120}, {2, 150}, {3, 500}, {4, 0}}) {
+    TaskInfo* task = resp.add_task_info();
+    task->set_task_id(task_id);
+    task->set_processing_time_nsec(processing_time_nsec);
+  }
+  EXPECT_THAT(FindHotTasks(resp, /*hot_task_factor=*/2.0),
+              ::testing::UnorderedElementsAre(3));
+  EXPECT_THAT(FindHotTasks(resp, /*hot_task_factor=*/5.0),
+              ::testing::IsEmpty());
+}
+
+TEST(UtilsTest, EstimateMaxOutstandingRequests) {
+  EXPECT_EQ(EstimateMaxOutstandingRequests(
+                /*num_tasks=*/2, /*latency=*/absl::Milliseconds(10),
+                /*latency_deviation=*/absl::ZeroDuration(),
+                /*consumer_interval=*/absl::Milliseconds(1),
+                /*max_outstanding_requests_per_task=*/8),
+            10);
+  EXPECT_EQ(EstimateMaxOutstandingRequests(
+                /*num_tasks=*/4, /*latency=*/absl::Milliseconds(10),
+                /*latency_deviation=*/absl::Milliseconds(5),
+                /*consumer_interval=*/absl::Milliseconds(1),
+                /*max_outstanding_requests_per_task=*/8),
+            30);
+  // Capped by `max_outstanding_requests_per_task`.
+  EXPECT_EQ(EstimateMaxOutstandingRequests(
+                /*num_tasks=*/2, /*latency=*/absl::Milliseconds(10),
+                /*latency_deviation=*/absl::Milliseconds(5),
+                /*consumer_interval=*/absl::Milliseconds(1),
+                /*max_outstanding_requests_per_task=*/8),
+            16);
+  // At least one request per task.
+  EXPECT_EQ(EstimateMaxOutstandingRequests(
+                /*num_tasks=*/4, /*latency=*/absl::Milliseconds(1),
+                /*latency_deviation=*/absl::ZeroDuration(),
+                /*consumer_interval=*/absl::Milliseconds(1),
+                /*max_outstanding_requests_per_task=*/8),
+            4);
+}
+
+TEST(UtilsTest, EstimateMaxOutstandingRequestsUnknownLatency) {
+  EXPECT_EQ(EstimateMaxOutstandingRequests(
+                /*num_tasks=*/2, /*latency=*/absl::ZeroDuration(),
+                /*latency_deviation=*/absl::ZeroDuration(),
+                /*consumer_interval=*/absl::Milliseconds(1),
+                /*max_outstanding_requests_per_task=*/8),
+            2);
+  EXPECT_EQ(EstimateMaxOutstandingRequests(
+                /*num_tasks=*/2, /*latency=*/absl::Milliseconds(10),
+                /*latency_deviation=*/absl::ZeroDuration(),
+                /*consumer_interval=*/absl::ZeroDuration(),
+                /*max_outstanding_requests_per_task=*/8),
+            2);
+}
+
+TEST(UtilsTest, FindHotTasksUnknownProcessingTimes) {
+  ClientHeartbeatResponse resp;
+  resp.add_task_info()->set_task_id(0);
+  resp.add_task_info()->set_task_id(1);
+  EXPECT_THAT(FindHotTasks(resp, /*hot_task_factor=*/2.0),
+              ::testing::IsEmpty());
+}
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
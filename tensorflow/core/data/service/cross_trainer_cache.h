@@ -15,18 +15,24 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -46,6 +52,11 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements evicted from memory are spilled to a local directory
+// instead, so that trainers which fall behind the in-memory window can keep
+// reading from disk. Spilling and reading ahead of the trainers on disk happen
+// on background threads. See `CrossTrainerCacheSpillOptions`.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -89,6 +100,30 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes and deserializes elements for spilling them to disk. Only
+  // sequences used with spilling need to implement them. They may be called
+  // concurrently with each other and with `GetNext`.
+  virtual StatusOr<std::string> SerializeElement(const ElementType&) const {
+    return errors::Unimplemented(
+        "This cachable sequence does not support spilling to disk.");
+  }
+  virtual StatusOr<ElementType> DeserializeElement(const std::string&) const {
+    return errors::Unimplemented(
+        "This cachable sequence does not support spilling to disk.");
+  }
+};
+
+// Options for the on-disk tier of the `CrossTrainerCache`.
+struct CrossTrainerCacheSpillOptions {
+  // The directory to spill elements to, preferably on a local SSD. It must not
+  // be shared with other caches.
+  std::string directory;
+  // The maximum size of the spilled elements in bytes. 0 disables spilling.
+  size_t max_spill_size_bytes = 0;
+  // The number of spilled elements to read ahead of a trainer reading from
+  // disk.
+  size_t num_prefetch_elements = 4;
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -101,7 +136,19 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
-  virtual ~CrossTrainerCache() = default;
+
+  // Creates a `CrossTrainerCache` that spills the elements it evicts from
+  // memory to `spill_options.directory`. Elements waiting to be written count
+  // towards a separate budget of `max_cache_size_bytes`, so the cache uses
+  // about twice that much memory. If spilling fails, the cache logs a warning
+  // and continues with its in-memory tier only.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      CrossTrainerCacheSpillOptions spill_options, Env* env = Env::Default());
+
+  // Waits for the background threads and deletes the spilled elements.
+  virtual ~CrossTrainerCache();
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
 
@@ -126,6 +173,16 @@ class CrossTrainerCache {
     bool cache_hit;
   };
 
+  // An element evicted from memory to disk.
+  struct SpilledElement {
+    size_t size_bytes = 0;
+    // The element, while it is waiting to be written, or after it has been
+    // read ahead of a trainer.
+    std::shared_ptr<const ElementType> element;
+    bool on_disk = false;
+    bool loading = false;
+  };
+
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
@@ -138,7 +195,8 @@ class CrossTrainerCache {
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
 
-  // Returns the next element for `trainer_id`.
+  // Returns the next element for `trainer_id`, or nullptr if it has to be
+  // read from disk.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
       const std::string& trainer_id);
 
@@ -149,6 +207,38 @@ class CrossTrainerCache {
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
 
+  // Moves an element evicted from memory to the on-disk tier, evicting the
+  // oldest spilled elements to stay within `max_spill_size_bytes`.
+  void SpillElement(std::shared_ptr<const ElementType> element,
+                    size_t size_bytes);
+
+  // Drops the oldest spilled element.
+  void EvictSpilledElement();
+
+  // Drops all spilled elements and stops spilling because of `status`.
+  void DisableSpilling(const Status& status);
+
+  // Schedules reading the spilled elements starting at `element_index` ahead
+  // of a trainer.
+  void SchedulePrefetch(size_t element_index);
+
+  // Returns the path of the spilled element at `element_index`.
+  std::string SpillFilePath(size_t element_index) const;
+
+  // Reads the spilled element at `element_index` from disk.
+  StatusOr<std::shared_ptr<const ElementType>> ReadSpilledElement(
+      size_t element_index) const;
+
+  // Writes the evicted elements to disk, and deletes the files of spilled
+  // elements evicted from disk.
+  void SpillThread();
+
+  // Reads spilled elements ahead of the trainers.
+  void PrefetchThread();
+
+  // Returns true if the background threads should exit.
+  bool ShouldStopSpilling() const;
+
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
 
@@ -158,8 +248,13 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  const CrossTrainerCacheSpillOptions spill_options_;
+  Env* const env_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
+  // Wakes up the spill and prefetch threads.
+  condition_variable spill_cv_;
 
   // If `status_` is non-OK, the cache is cancelled, and all method calls will
   // return this status.
@@ -178,18 +273,85 @@ class CrossTrainerCache {
   // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
+
+  // `spilled_` stores the elements evicted from `cache_` to disk, which
+  // immediately precede it: `spill_start_index_ + spilled_.size()` is always
+  // `cache_start_index_`.
+  bool spilling_enabled_ TF_GUARDED_BY(mu_) = false;
+  std::deque<SpilledElement> spilled_ TF_GUARDED_BY(mu_);
+  size_t spill_start_index_ TF_GUARDED_BY(mu_) = 0;
+  size_t spill_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The size of the spilled elements that have not been written yet.
+  size_t pending_spill_bytes_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<size_t> indices_to_write_ TF_GUARDED_BY(mu_);
+  std::deque<size_t> indices_to_load_ TF_GUARDED_BY(mu_);
+  std::deque<std::string> files_to_delete_ TF_GUARDED_BY(mu_);
+  bool stop_spilling_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> spill_thread_;
+  std::unique_ptr<Thread> prefetch_thread_;
 };
 
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
     std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    : CrossTrainerCache(max_cache_size_bytes, std::move(cachable_sequence),
+                        CrossTrainerCacheSpillOptions()) {}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    CrossTrainerCacheSpillOptions spill_options, Env* env)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_options_(std::move(spill_options)),
+      env_(env) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+  if (spill_options_.max_spill_size_bytes == 0) {
+    return;
+  }
+  if (spill_options_.directory.empty()) {
+    LOG(WARNING) << "tf.data service cross-trainer cache spilling requires a "
+                 << "directory. Spilling is disabled.";
+    return;
+  }
+  {
+    mutex_lock l(mu_);
+    spilling_enabled_ = true;
+  }
+  spill_thread_ = absl::WrapUnique(env_->StartThread(
+      {}, "tf_data_cross_trainer_cache_spill", [this]() { SpillThread(); }));
+  prefetch_thread_ = absl::WrapUnique(
+      env_->StartThread({}, "tf_data_cross_trainer_cache_prefetch",
+                        [this]() { PrefetchThread(); }));
+  VLOG(2) << "Spilling tf.data service cross-trainer cache to "
+          << spill_options_.directory << " with "
+          << ByteSize::Bytes(spill_options_.max_spill_size_bytes)
+          << " of disk space.";
+}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::~CrossTrainerCache() {
+  {
+    mutex_lock l(mu_);
+    stop_spilling_ = true;
+    spill_cv_.notify_all();
+  }
+  spill_thread_.reset();
+  prefetch_thread_.reset();
+  mutex_lock l(mu_);
+  for (size_t i = 0; i < spilled_.size(); ++i) {
+    if (spilled_[i].on_disk) {
+      files_to_delete_.push_back(SpillFilePath(spill_start_index_ + i));
+    }
+  }
+  for (const std::string& file : files_to_delete_) {
+    env_->DeleteFile(file).IgnoreError();
+  }
 }
 
 template <class ElementType>
@@ -212,20 +374,23 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> spilled_element_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
+        const size_t element_index = GetElementIndex(trainer_id);
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+        if (element != nullptr) {
+          return CacheQueryResult{element,
+                                  /*is_cache_hit=*/!should_extend_cache};
+        }
+        spilled_element_index = element_index;
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of
+        // them should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +399,21 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_element_index.has_value()) {
+      StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadSpilledElement(*spilled_element_index);
+      if (element.ok()) {
+        return CacheQueryResult{*element, /*is_cache_hit=*/true};
+      }
+      // The element may have been evicted from disk while it was being read,
+      // in which case the trainer skips ahead.
+      mutex_lock l(mu_);
+      if (*spilled_element_index >= spill_start_index_) {
+        DisableSpilling(element.status());
+      }
+      continue;
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -261,9 +441,18 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
         element_index);
   }
 
-  std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
   trainer_to_element_index_map_[trainer_id] = element_index + 1;
+  if (element_index >= cache_start_index_) {
+    return cache_[element_index - cache_start_index_];
+  }
+
+  SchedulePrefetch(element_index + 1);
+  SpilledElement& spilled = spilled_[element_index - spill_start_index_];
+  std::shared_ptr<const ElementType> result = spilled.element;
+  if (spilled.on_disk) {
+    // Elements read ahead are only kept until the first trainer reads them.
+    spilled.element.reset();
+  }
   return result;
 }
 
@@ -271,8 +460,8 @@ template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  if (element_index < spill_start_index_) {
+    element_index = spill_start_index_;
   }
   return element_index;
 }
@@ -290,6 +479,13 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
   }
 
   mutex_lock l(mu_);
+  // Waits for the background writes to catch up, so that the elements waiting
+  // to be spilled do not use more than `max_cache_size_bytes_` of memory.
+  while (status_.ok() && spilling_enabled_ && pending_spill_bytes_ > 0 &&
+         pending_spill_bytes_ + new_element_size_bytes >
+             max_cache_size_bytes_) {
+    cv_.wait(l);
+  }
   TF_RETURN_IF_ERROR(status_);
   FreeSpace(new_element_size_bytes);
   cache_.push_back(std::make_shared<ElementType>(std::move(element)));
@@ -305,10 +501,12 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    std::shared_ptr<const ElementType> element = std::move(cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
     ++num_elements_discarded;
+    SpillElement(std::move(element), free_bytes);
   }
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
@@ -316,6 +514,202 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
           << ByteSize::Bytes(cache_size_bytes_) << ".";
 }
 
+template <class ElementType>
+void CrossTrainerCache<ElementType>::SpillElement(
+    std::shared_ptr<const ElementType> element, size_t size_bytes)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!spilling_enabled_ || size_bytes > spill_options_.max_spill_size_bytes) {
+    while (!spilled_.empty()) {
+      EvictSpilledElement();
+    }
+    spill_start_index_ = cache_start_index_;
+    return;
+  }
+
+  spilled_.push_back(SpilledElement{size_bytes, std::move(element)});
+  spill_size_bytes_ += size_bytes;
+  pending_spill_bytes_ += size_bytes;
+  indices_to_write_.push_back(cache_start_index_ - 1);
+  while (spill_size_bytes_ > spill_options_.max_spill_size_bytes) {
+    EvictSpilledElement();
+  }
+  spill_cv_.notify_all();
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::EvictSpilledElement()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  SpilledElement& spilled = spilled_.front();
+  if (spilled.on_disk) {
+    files_to_delete_.push_back(SpillFilePath(spill_start_index_));
+    spill_cv_.notify_all();
+  } else {
+    // The spill thread deletes the file if it is being written.
+    pending_spill_bytes_ -= spilled.size_bytes;
+    cv_.notify_all();
+  }
+  spill_size_bytes_ -= spilled.size_bytes;
+  spilled_.pop_front();
+  ++spill_start_index_;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::DisableSpilling(const Status& status)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!spilling_enabled_) {
+    return;
+  }
+  LOG(WARNING) << "Failed to spill tf.data service cross-trainer cache to "
+               << spill_options_.directory << ": " << status
+               << ". Spilling is disabled.";
+  spilling_enabled_ = false;
+  while (!spilled_.empty()) {
+    EvictSpilledElement();
+  }
+  indices_to_write_.clear();
+  indices_to_load_.clear();
+  cv_.notify_all();
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::SchedulePrefetch(size_t element_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const size_t end_index = std::min(
+      element_index + spill_options_.num_prefetch_elements, cache_start_index_);
+  for (size_t i = element_index; i < end_index; ++i) {
+    SpilledElement& spilled = spilled_[i - spill_start_index_];
+    if (spilled.on_disk && spilled.element == nullptr && !spilled.loading) {
+      spilled.loading = true;
+      indices_to_load_.push_back(i);
+      spill_cv_.notify_all();
+    }
+  }
+}
+
+template <class ElementType>
+std::string CrossTrainerCache<ElementType>::SpillFilePath(
+    size_t element_index) const {
+  return io::JoinPath(spill_options_.directory,
+                      absl::StrCat("element_", element_index));
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadSpilledElement(size_t element_index) const {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(env_, SpillFilePath(element_index), &serialized));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->DeserializeElement(serialized));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::ShouldStopSpilling() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return stop_spilling_ || !status_.ok();
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::SpillThread() TF_LOCKS_EXCLUDED(mu_) {
+  Status s = env_->RecursivelyCreateDir(spill_options_.directory);
+  if (!s.ok()) {
+    mutex_lock l(mu_);
+    DisableSpilling(s);
+  }
+
+  while (true) {
+    std::string file_to_delete;
+    size_t element_index = 0;
+    std::shared_ptr<const ElementType> element;
+    {
+      mutex_lock l(mu_);
+      while (!ShouldStopSpilling() && files_to_delete_.empty() &&
+             indices_to_write_.empty()) {
+        spill_cv_.wait(l);
+      }
+      if (ShouldStopSpilling()) {
+        return;
+      }
+      if (!files_to_delete_.empty()) {
+        file_to_delete = std::move(files_to_delete_.front());
+        files_to_delete_.pop_front();
+      } else {
+        element_index = indices_to_write_.front();
+        indices_to_write_.pop_front();
+        if (element_index < spill_start_index_) {
+          continue;
+        }
+        element = spilled_[element_index - spill_start_index_].element;
+      }
+    }
+
+    if (!file_to_delete.empty()) {
+      env_->DeleteFile(file_to_delete).IgnoreError();
+      continue;
+    }
+
+    const std::string file_path = SpillFilePath(element_index);
+    StatusOr<std::string> serialized =
+        cachable_sequence_->SerializeElement(*element);
+    s = serialized.status();
+    if (s.ok()) {
+      s = WriteStringToFile(env_, file_path, *serialized);
+    }
+    mutex_lock l(mu_);
+    if (!s.ok()) {
+      DisableSpilling(s);
+      files_to_delete_.push_back(file_path);
+      continue;
+    }
+    if (element_index < spill_start_index_) {
+      // Evicted while it was being written.
+      files_to_delete_.push_back(file_path);
+      continue;
+    }
+    SpilledElement& spilled = spilled_[element_index - spill_start_index_];
+    spilled.on_disk = true;
+    spilled.element.reset();
+    pending_spill_bytes_ -= spilled.size_bytes;
+    cv_.notify_all();
+  }
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::PrefetchThread() TF_LOCKS_EXCLUDED(mu_) {
+  while (true) {
+    size_t element_index = 0;
+    {
+      mutex_lock l(mu_);
+      while (!ShouldStopSpilling() && indices_to_load_.empty()) {
+        spill_cv_.wait(l);
+      }
+      if (ShouldStopSpilling()) {
+        return;
+      }
+      element_index = indices_to_load_.front();
+      indices_to_load_.pop_front();
+      if (element_index < spill_start_index_) {
+        continue;
+      }
+    }
+
+    StatusOr<std::shared_ptr<const ElementType>> element =
+        ReadSpilledElement(element_index);
+    mutex_lock l(mu_);
+    if (element_index < spill_start_index_) {
+      continue;
+    }
+    SpilledElement& spilled = spilled_[element_index - spill_start_index_];
+    spilled.loading = false;
+    if (!element.ok()) {
+      DisableSpilling(element.status());
+      continue;
+    }
+    spilled.element = *std::move(element);
+  }
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::Cancel(Status status)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -327,6 +721,7 @@ void CrossTrainerCache<ElementType>::Cancel(Status status)
   mutex_lock l(mu_);
   status_ = std::move(status);
   cv_.notify_all();
+  spill_cv_.notify_all();
 }
 
 template <class ElementType>
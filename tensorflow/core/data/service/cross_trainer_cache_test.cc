@@ -22,14 +22,17 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -46,6 +49,7 @@ using ::tensorflow::testing::IsOkAndHolds;
 using ::tensorflow::testing::StatusIs;
 using ::testing::Gt;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Pointee;
 using ::testing::UnorderedElementsAreArray;
 
@@ -61,6 +65,30 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+class SpillableRange : public InfiniteRange {
+ public:
+  absl::StatusOr<std::string> SerializeElement(
+      const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+  absl::StatusOr<int64_t> DeserializeElement(
+      const std::string& serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Invalid spilled element: ", serialized);
+    }
+    return element;
+  }
+};
+
+CrossTrainerCacheSpillOptions GetSpillOptions(size_t max_spill_size_bytes) {
+  CrossTrainerCacheSpillOptions spill_options;
+  spill_options.directory = io::JoinPath(
+      testing::TmpDir(), absl::StrCat("cross_trainer_cache_", random::New64()));
+  spill_options.max_spill_size_bytes = max_spill_size_bytes;
+  return spill_options;
+}
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   absl::StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -205,6 +233,52 @@ TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   }
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/2 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      GetSpillOptions(/*max_spill_size_bytes=*/100 * sizeof(int64_t)));
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SpilledDataIsBounded) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/2 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(),
+      GetSpillOptions(/*max_spill_size_bytes=*/3 * sizeof(int64_t)));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 8 and 9 are in memory, and 5 to 7 are on disk.
+  for (int i = 5; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SpilledDataIsDeleted) {
+  CrossTrainerCacheSpillOptions spill_options =
+      GetSpillOptions(/*max_spill_size_bytes=*/5 * sizeof(int64_t));
+  const std::string directory = spill_options.directory;
+  {
+    CrossTrainerCache<int64_t> cache(
+        /*max_cache_size_bytes=*/2 * sizeof(int64_t),
+        std::make_unique<SpillableRange>(), std::move(spill_options));
+    for (int i = 0; i < 20; ++i) {
+      EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+    }
+  }
+
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &files));
+  EXPECT_THAT(files, IsEmpty());
+}
+
 TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   // The cache size is smaller than one int64_t.
   CrossTrainerCache<int64_t> cache(
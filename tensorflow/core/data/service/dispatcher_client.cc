@@ -380,6 +380,20 @@ Status DataServiceDispatcherClient::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetNumberOfWorkersEstimate(
+    int64_t forecast_horizon_ms,
+    GetNumberOfWorkersEstimateResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  GetNumberOfWorkersEstimateRequest request;
+  request.set_forecast_horizon_ms(forecast_horizon_ms);
+  grpc::Status s = stub_->GetNumberOfWorkersEstimate(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get number of workers estimate", s);
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
@@ -137,6 +137,12 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       const std::string& dataset_id, bool disable_compression_at_runtime,
       DisableCompressionAtRuntimeResponse& response);
 
+  // Returns the current and forecast number of workers needed by the clients,
+  // forecasting `forecast_horizon_ms` ahead.
+  Status GetNumberOfWorkersEstimate(
+      int64_t forecast_horizon_ms,
+      GetNumberOfWorkersEstimateResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -104,6 +104,7 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr absl::Duration kDefaultJournalCompactionInterval = absl::Hours(1);
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -183,6 +184,10 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.journal_compaction_interval_ms() == 0) {
+    new_config.set_journal_compaction_interval_ms(
+        absl::ToInt64Milliseconds(kDefaultJournalCompactionInterval));
+  }
   return new_config;
 }
 }  // namespace
@@ -267,6 +272,8 @@ Status DataServiceDispatcherImpl::Start() {
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
   TF_RETURN_IF_ERROR(journal_writer_.value()->EnsureInitialized());
+  next_journal_compaction_micros_ =
+      env_->NowMicros() + config_.journal_compaction_interval_ms() * 1000;
   TF_RETURN_IF_ERROR(RestoreSnapshots());
   started_ = true;
   LOG(INFO) << "Started tf.data service dispatcher with config "
@@ -391,9 +398,13 @@ Status DataServiceDispatcherImpl::FindNewTasks(
 void DataServiceDispatcherImpl::ReportProcessingTimesFromActiveTasks(
     const std::vector<ActiveTask>& active_tasks,
     const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  absl::flat_hash_map<int64_t, double>& processing_times_nsec =
+      latest_task_processing_times_nsec_[worker_address];
+  processing_times_nsec.clear();
   for (const ActiveTask& active_task : active_tasks) {
     const int64_t task_id = active_task.task_id();
     const double processing_time_nsec = active_task.processing_time_nsec();
+    processing_times_nsec[task_id] = processing_time_nsec;
     VLOG(3) << "Received processing time from task id " << task_id
             << " in worker with address " << worker_address
             << ". Time in nanoseconds: " << processing_time_nsec;
@@ -1155,6 +1166,14 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_iteration_id(iteration->iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
+    auto worker_it =
+        latest_task_processing_times_nsec_.find(task->worker_address);
+    if (worker_it != latest_task_processing_times_nsec_.end()) {
+      auto task_it = worker_it->second.find(task->task_id);
+      if (task_it != worker_it->second.end()) {
+        task_info->set_processing_time_nsec(task_it->second);
+      }
+    }
   }
   response->set_iteration_finished(iteration->finished);
   response->set_deployment_mode(config_.deployment_mode());
@@ -1304,6 +1323,29 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetNumberOfWorkersEstimate(
+    const GetNumberOfWorkersEstimateRequest* request,
+    GetNumberOfWorkersEstimateResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  if (request->forecast_horizon_ms() < 0) {
+    return errors::InvalidArgument(
+        "The forecast horizon must be non-negative, but got ",
+        request->forecast_horizon_ms(), " ms.");
+  }
+  {
+    mutex_lock l(mu_);
+    response->set_current_number_of_workers(state_.ListWorkers().size());
+  }
+  response->set_optimal_number_of_workers(
+      auto_scaler_.GetOptimalNumberOfWorkers().value_or(0));
+  response->set_predicted_number_of_workers(
+      auto_scaler_
+          .GetPredictedNumberOfWorkers(
+              absl::Milliseconds(request->forecast_horizon_ms()))
+          .value_or(0));
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1380,42 +1422,78 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
+    std::optional<int64_t> journal_end;
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
       }
-    }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
-      if (!s.ok()) {
-        VLOG(1) << "Error updating the optimal number of workers metric "
-                   "in tf.data service AutoScaler: "
-                << s;
+      if (cancelled_) {
+        return;
+      }
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          VLOG(1) << "Error updating the optimal number of workers metric "
+                     "in tf.data service AutoScaler: "
+                  << s;
+        }
       }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      {
+        absl::StatusOr<std::optional<int64_t>> rotated = MaybeRotateJournal();
+        if (rotated.ok()) {
+          journal_end = *rotated;
+        } else {
+          LOG(WARNING) << "Error starting a new journal file: "
+                       << rotated.status();
+        }
+      }
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
     }
-    {
-      Status s = GcOldIterations();
+    // Compaction only reads and deletes journal files which are no longer
+    // written to, so it doesn't need to block the dispatcher.
+    if (journal_end.has_value()) {
+      Status s =
+          CompactJournal(env_, JournalDir(config_.work_dir()), *journal_end);
       if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        LOG(WARNING) << "Error compacting the dispatcher journal: " << s;
       }
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
+absl::StatusOr<std::optional<int64_t>>
+DataServiceDispatcherImpl::MaybeRotateJournal()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!journal_writer_.has_value() ||
+      config_.journal_compaction_interval_ms() < 0 ||
+      env_->NowMicros() < next_journal_compaction_micros_) {
+    return std::nullopt;
+  }
+  next_journal_compaction_micros_ =
+      env_->NowMicros() + config_.journal_compaction_interval_ms() * 1000;
+  TF_ASSIGN_OR_RETURN(int64_t sequence_number,
+                      journal_writer_.value()->Rotate());
+  return sequence_number;
+}
+
 void DataServiceDispatcherImpl::RemoveClientFromAutoScaler(int64_t client_id)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::shared_ptr<const Iteration> iteration;
@@ -1487,6 +1565,7 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
 
+      latest_task_processing_times_nsec_.erase(it->first);
       latest_worker_heartbeats_time_.erase(it++);
     } else {
       ++it;
@@ -188,6 +188,9 @@ class DataServiceDispatcherImpl {
   Status DisableCompressionAtRuntime(
       const DisableCompressionAtRuntimeRequest* request,
       DisableCompressionAtRuntimeResponse* response);
+  Status GetNumberOfWorkersEstimate(
+      const GetNumberOfWorkersEstimateRequest* request,
+      GetNumberOfWorkersEstimateResponse* response);
 
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
@@ -254,7 +257,8 @@ class DataServiceDispatcherImpl {
       const absl::flat_hash_set<int64_t>& current_tasks,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& assigned_tasks,
       WorkerHeartbeatResponse* response);
-  // Reports the processing time of each active task to `auto_scaler_`.
+  // Reports the processing time of each active task to `auto_scaler_`, and
+  // records it for the client heartbeats.
   void ReportProcessingTimesFromActiveTasks(
       const std::vector<ActiveTask>& active_tasks,
       const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -334,6 +338,11 @@ class DataServiceDispatcherImpl {
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Starts a new journal file if the journal is due for compaction. Returns the
+  // sequence number of the new file, before which the journal can be
+  // compacted, or `std::nullopt` if it is not due.
+  absl::StatusOr<std::optional<int64_t>> MaybeRotateJournal()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
   bool ShouldGcIteration(const DispatcherState::Iteration& iteration,
                          int64_t now_us) const;
@@ -379,6 +388,10 @@ class DataServiceDispatcherImpl {
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // Map from worker address to the processing times of its active tasks, keyed
+  // by task id, as of the worker's last heartbeat.
+  absl::flat_hash_map<std::string, absl::flat_hash_map<int64_t, double>>
+      latest_task_processing_times_nsec_ TF_GUARDED_BY(mu_);
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
@@ -391,6 +404,8 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // When the journal is next due for compaction.
+  int64_t next_journal_compaction_micros_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
@@ -16,12 +16,19 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -35,6 +42,8 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kCheckpoint = "checkpoint";
+constexpr StringPiece kTempFileSuffix = ".tmp";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
@@ -44,6 +53,133 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return absl::OkStatus();
 }
+
+// A journal or checkpoint file in the journal directory.
+struct JournalDirEntry {
+  std::string filename;
+  int64_t sequence_number;
+  bool is_checkpoint;
+};
+
+// Lists the journal and checkpoint files in `journal_dir`, skipping the
+// temporary files of checkpoints which were not completely written.
+Status ListJournalDir(Env* env, const std::string& journal_dir,
+                      std::vector<JournalDirEntry>& entries) {
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &files));
+  entries.clear();
+  for (const std::string& file : files) {
+    if (absl::EndsWith(file, kTempFileSuffix)) {
+      continue;
+    }
+    JournalDirEntry entry;
+    entry.filename = io::JoinPath(journal_dir, file);
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &entry.sequence_number));
+    entry.is_checkpoint = absl::StartsWith(file, kCheckpoint);
+    entries.push_back(std::move(entry));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the sequence number of the latest checkpoint, or -1 if there is none.
+int64_t LatestCheckpoint(const std::vector<JournalDirEntry>& entries) {
+  int64_t latest_checkpoint = -1;
+  for (const JournalDirEntry& entry : entries) {
+    if (entry.is_checkpoint) {
+      latest_checkpoint = std::max(latest_checkpoint, entry.sequence_number);
+    }
+  }
+  return latest_checkpoint;
+}
+
+// Appends the updates in the journal or checkpoint file `filename` to
+// `updates`.
+Status ReadUpdates(Env* env, const std::string& filename,
+                   std::vector<Update>& updates) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReaderOptions opts;
+  opts.buffer_size = 2 << 20;  // 2MB
+  io::SequentialRecordReader reader(file.get(), opts);
+  while (true) {
+    tstring record;
+    Status s = reader.ReadRecord(&record);
+    if (absl::IsOutOfRange(s)) {
+      return absl::OkStatus();
+    }
+    TF_RETURN_IF_ERROR(s);
+    Update update;
+    if (!update.ParseFromString(record)) {
+      return errors::DataLoss("Failed to parse journal record in ", filename);
+    }
+    updates.push_back(std::move(update));
+  }
+}
+
+// Writes `updates` to `filename`, replacing it atomically so that readers never
+// see a partially written checkpoint.
+Status WriteCheckpoint(Env* env, const std::string& filename,
+                       const std::vector<Update>& updates) {
+  std::string temp_filename = absl::StrCat(filename, kTempFileSuffix);
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(temp_filename, &file));
+  io::RecordWriter writer(file.get());
+  for (const Update& update : updates) {
+    std::string s = update.SerializeAsString();
+    if (s.empty()) {
+      return errors::Internal("Failed to serialize update ",
+                              update.DebugString(), " to string");
+    }
+    TF_RETURN_IF_ERROR(writer.WriteRecord(s));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(file->Sync());
+  TF_RETURN_IF_ERROR(file->Close());
+  return env->RenameFile(temp_filename, filename);
+}
+
+// Drops the updates which don't affect the state restored from `updates`.
+//
+// The split progress of a split provider is its latest repetition and the
+// number of splits produced in it, so only the latest finished
+// `ProduceSplitUpdate` and the ones after it are needed. Garbage collected
+// iterations don't produce splits any more, so their progress is dropped
+// entirely.
+std::vector<Update> CompactUpdates(std::vector<Update> updates) {
+  absl::flat_hash_set<int64_t> garbage_collected_iterations;
+  // Index of the latest finished `ProduceSplitUpdate` of each split provider,
+  // keyed by iteration id and split provider index.
+  absl::flat_hash_map<std::pair<int64_t, int64_t>, size_t> latest_finished;
+  for (size_t i = 0; i < updates.size(); ++i) {
+    const Update& update = updates[i];
+    if (update.has_garbage_collect_iteration()) {
+      garbage_collected_iterations.insert(
+          update.garbage_collect_iteration().iteration_id());
+    }
+    if (update.has_produce_split() && update.produce_split().finished()) {
+      latest_finished[{update.produce_split().iteration_id(),
+                       update.produce_split().split_provider_index()}] = i;
+    }
+  }
+
+  std::vector<Update> compacted;
+  compacted.reserve(updates.size());
+  for (size_t i = 0; i < updates.size(); ++i) {
+    if (updates[i].has_produce_split()) {
+      const ProduceSplitUpdate& produce_split = updates[i].produce_split();
+      if (garbage_collected_iterations.contains(produce_split.iteration_id())) {
+        continue;
+      }
+      auto it = latest_finished.find(
+          {produce_split.iteration_id(), produce_split.split_provider_index()});
+      if (it != latest_finished.end() && i < it->second) {
+        continue;
+      }
+    }
+    compacted.push_back(std::move(updates[i]));
+  }
+  return compacted;
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -52,6 +188,56 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalCheckpointFile(const std::string& journal_dir,
+                                             int64_t sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kCheckpoint, "_", sequence_number));
+}
+
+Status CompactJournal(Env* env, const std::string& journal_dir,
+                      int64_t end_sequence_number) {
+  std::vector<JournalDirEntry> entries;
+  TF_RETURN_IF_ERROR(ListJournalDir(env, journal_dir, entries));
+  int64_t latest_checkpoint = LatestCheckpoint(entries);
+  if (end_sequence_number <= std::max<int64_t>(latest_checkpoint, 0)) {
+    return absl::OkStatus();
+  }
+
+  std::vector<Update> updates;
+  int64_t sequence_number = 0;
+  if (latest_checkpoint >= 0) {
+    TF_RETURN_IF_ERROR(ReadUpdates(
+        env, DataServiceJournalCheckpointFile(journal_dir, latest_checkpoint),
+        updates));
+    sequence_number = latest_checkpoint;
+  }
+  // Like `FileJournalReader`, stop at the first missing journal file.
+  for (; sequence_number < end_sequence_number; ++sequence_number) {
+    std::string journal_file =
+        DataServiceJournalFile(journal_dir, sequence_number);
+    if (absl::IsNotFound(env->FileExists(journal_file))) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(ReadUpdates(env, journal_file, updates));
+  }
+  size_t num_updates = updates.size();
+  std::vector<Update> compacted = CompactUpdates(std::move(updates));
+  TF_RETURN_IF_ERROR(WriteCheckpoint(
+      env, DataServiceJournalCheckpointFile(journal_dir, end_sequence_number),
+      compacted));
+
+  // The new checkpoint is complete, so the files it replaces can be deleted.
+  for (const JournalDirEntry& entry : entries) {
+    if (entry.sequence_number < end_sequence_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(entry.filename));
+    }
+  }
+  VLOG(1) << "Compacted " << num_updates << " journal updates into "
+          << compacted.size() << " updates in checkpoint "
+          << end_sequence_number;
+  return absl::OkStatus();
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -59,17 +245,20 @@ Status FileJournalWriter::EnsureInitialized() {
   if (writer_) {
     return absl::OkStatus();
   }
-  std::vector<std::string> journal_files;
+  std::vector<JournalDirEntry> entries;
   TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(journal_dir_));
-  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
-  int64_t latest_sequence_number = -1;
-  for (const auto& file : journal_files) {
-    int64_t sequence_number;
-    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
-    latest_sequence_number = std::max(latest_sequence_number, sequence_number);
+  TF_RETURN_IF_ERROR(ListJournalDir(env_, journal_dir_, entries));
+  // A checkpoint replaces the journal files before its sequence number, so the
+  // next journal file may have the same sequence number as the checkpoint.
+  sequence_number_ = 0;
+  for (const JournalDirEntry& entry : entries) {
+    sequence_number_ =
+        std::max(sequence_number_, entry.is_checkpoint
+                                       ? entry.sequence_number
+                                       : entry.sequence_number + 1);
   }
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
@@ -92,6 +281,16 @@ Status FileJournalWriter::Write(const Update& update) {
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t> FileJournalWriter::Rotate() {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(writer_->Close());
+  TF_RETURN_IF_ERROR(file_->Close());
+  writer_.reset();
+  file_.reset();
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return sequence_number_;
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -99,6 +298,18 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return absl::OkStatus();
   }
+  std::vector<JournalDirEntry> entries;
+  Status s = ListJournalDir(env_, journal_dir_, entries);
+  if (!s.ok() && !absl::IsNotFound(s)) {
+    return s;
+  }
+  int64_t latest_checkpoint = LatestCheckpoint(entries);
+  if (latest_checkpoint >= 0) {
+    // Continue with the first journal file after the checkpoint.
+    sequence_number_ = latest_checkpoint - 1;
+    return UpdateFile(
+        DataServiceJournalCheckpointFile(journal_dir_, latest_checkpoint));
+  }
   return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
 }
 
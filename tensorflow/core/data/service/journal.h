@@ -15,9 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -31,6 +33,22 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the checkpoint file within the journal directory
+// which replaces the journal files before `sequence_number`.
+std::string DataServiceJournalCheckpointFile(const std::string& journal_dir,
+                                             int64_t sequence_number);
+
+// Compacts the journal files before `end_sequence_number` into a checkpoint
+// file, then deletes them. Replaying the checkpoint restores the same
+// dispatcher state as replaying the deleted files. The journal files before
+// `end_sequence_number` must no longer be written to.
+//
+// The checkpoint leaves out updates which no longer affect the dispatcher
+// state: the split progress of garbage collected iterations, and the split
+// progress of each split provider up to its latest finished repetition.
+Status CompactJournal(Env* env, const std::string& journal_dir,
+                      int64_t end_sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -39,6 +57,10 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Closes the current journal file and starts writing to a new one. Returns
+  // the sequence number of the new file. The files before it are complete and
+  // may be passed to `CompactJournal`.
+  virtual absl::StatusOr<int64_t> Rotate() = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -48,15 +70,18 @@ class JournalWriter {
 // directory is laid out in the following format:
 //
 // journal_dir/
-//   journal_0
-//   journal_1
+//   checkpoint_2
+//   journal_2
+//   journal_3
 //   ...
 //
 // When the writer is created, it lists the directory to find the next available
 // journal file name. For example, if the journal directory contains
 // "journal_0", "journal_1", and "journal_2", the writer will write to
-// "journal_3". The writer will flush updates as they are written, so that they
-// can be stored durably in case of machine failure.
+// "journal_3". A checkpoint file "checkpoint_N" written by `CompactJournal`
+// replaces the journal files before "journal_N". The writer will flush updates
+// as they are written, so that they can be stored durably in case of machine
+// failure.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -68,10 +93,13 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  absl::StatusOr<int64_t> Rotate() override;
 
  private:
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the journal file being written.
+  int64_t sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -89,7 +117,9 @@ class JournalReader {
 // used by multiple threads.
 //
 // The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// directory, in order of their sequence numbers. If the directory contains a
+// checkpoint file, the reader starts with the latest checkpoint and skips the
+// journal files it replaces. See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
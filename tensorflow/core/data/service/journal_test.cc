@@ -14,17 +14,20 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
@@ -67,6 +70,22 @@ Update MakeRegisterDatasetUpdate() {
   return update;
 }
 
+Update MakeProduceSplitUpdate(int64_t iteration_id, int64_t repetition,
+                              bool finished) {
+  Update update;
+  ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+  produce_split->set_iteration_id(iteration_id);
+  produce_split->set_repetition(repetition);
+  produce_split->set_finished(finished);
+  return update;
+}
+
+Update MakeGarbageCollectIterationUpdate(int64_t iteration_id) {
+  Update update;
+  update.mutable_garbage_collect_iteration()->set_iteration_id(iteration_id);
+  return update;
+}
+
 Status CheckJournalContent(StringPiece journal_dir,
                            const std::vector<Update>& expected) {
   FileJournalReader reader(Env::Default(), journal_dir);
@@ -115,6 +134,85 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, RotateAndCompact) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(updates[0]));
+  TF_ASSERT_OK(writer.Write(updates[1]));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.Rotate());
+  EXPECT_EQ(sequence_number, 1);
+  TF_ASSERT_OK(writer.Write(updates[2]));
+
+  TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir, sequence_number));
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(
+      DataServiceJournalFile(journal_dir, /*sequence_number=*/0))));
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      DataServiceJournalCheckpointFile(journal_dir, sequence_number)));
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, AppendAfterCompaction) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  for (const auto& update : updates) {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_ASSERT_OK(writer.Write(update));
+    TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.Rotate());
+    TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir, sequence_number));
+  }
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, CompactionDropsSplitProgress) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  std::vector<Update> updates = {
+      MakeProduceSplitUpdate(/*iteration_id=*/1, /*repetition=*/0, false),
+      MakeProduceSplitUpdate(/*iteration_id=*/2, /*repetition=*/0, false),
+      MakeProduceSplitUpdate(/*iteration_id=*/1, /*repetition=*/0, true),
+      MakeProduceSplitUpdate(/*iteration_id=*/1, /*repetition=*/1, false),
+      MakeProduceSplitUpdate(/*iteration_id=*/2, /*repetition=*/0, false),
+      MakeGarbageCollectIterationUpdate(/*iteration_id=*/2)};
+  for (const auto& update : updates) {
+    TF_ASSERT_OK(writer.Write(update));
+  }
+  TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.Rotate());
+
+  TF_ASSERT_OK(CompactJournal(Env::Default(), journal_dir, sequence_number));
+  TF_EXPECT_OK(
+      CheckJournalContent(journal_dir, {updates[2], updates[3], updates[5]}));
+}
+
+TEST(Journal, IncompleteCheckpointIsIgnored) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate()};
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    for (const auto& update : updates) {
+      TF_ASSERT_OK(writer.Write(update));
+    }
+  }
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(),
+      absl::StrCat(DataServiceJournalCheckpointFile(journal_dir, 1), ".tmp"),
+      "partial checkpoint"));
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.EnsureInitialized());
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/compression_autotuner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/data/service/byte_size.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The weight of the latest measurement in the moving average.
+constexpr double kSmoothingFactor = 0.5;
+
+}  // namespace
+
+CompressionAutotuner::CompressionAutotuner(std::vector<std::string> candidates,
+                                           int64_t exploration_interval)
+    : candidates_(std::move(candidates)),
+      exploration_interval_(std::max<int64_t>(exploration_interval, 1)),
+      measurements_(candidates_.size()) {}
+
+std::string CompressionAutotuner::NextCompression() {
+  ++round_;
+  size_t next = 0;
+  for (size_t i = 0; i < candidates_.size(); ++i) {
+    if (measurements_[i].round < 0) {
+      return candidates_[i];
+    }
+    if (round_ % exploration_interval_ == 0
+            ? measurements_[i].round < measurements_[next].round
+            : measurements_[i].bytes_per_second >
+                  measurements_[next].bytes_per_second) {
+      next = i;
+    }
+  }
+  return candidates_[next];
+}
+
+void CompressionAutotuner::RecordChunks(absl::string_view compression,
+                                        ByteSize bytes,
+                                        absl::Duration write_time) {
+  auto it = std::find(candidates_.begin(), candidates_.end(), compression);
+  if (it == candidates_.end() || bytes == ByteSize::Bytes(0) ||
+      write_time <= absl::ZeroDuration()) {
+    return;
+  }
+  Measurement& measurement = measurements_[it - candidates_.begin()];
+  const double bytes_per_second =
+      bytes.ToDoubleBytes() / absl::ToDoubleSeconds(write_time);
+  measurement.bytes_per_second =
+      measurement.round < 0
+          ? bytes_per_second
+          : kSmoothingFactor * bytes_per_second +
+                (1 - kSmoothingFactor) * measurement.bytes_per_second;
+  measurement.round = round_;
+  VLOG(2) << "Snapshot chunks with compression " << compression
+          << " are written at " << ByteSize::Bytes(measurement.bytes_per_second)
+          << "/s.";
+}
+
+}  // namespace data
+}  // namespace tensorflow
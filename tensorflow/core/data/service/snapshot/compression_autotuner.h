@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COMPRESSION_AUTOTUNER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COMPRESSION_AUTOTUNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/lib/io/compression.h"
+
+namespace tensorflow {
+namespace data {
+
+// Chooses the compression of snapshot chunks from the observed write
+// throughput, i.e. the uncompressed bytes written per second spent compressing
+// and writing them. A codec that compresses well wins when the file system is
+// slow, and a fast codec, or none, wins when compression is the bottleneck.
+//
+// Each candidate is tried once, after which the best candidate is used, except
+// that every `exploration_interval`-th round re-measures the candidate that
+// was measured least recently, so that the choice follows changes in the data
+// or in the file system. This class is not thread-safe.
+class CompressionAutotuner {
+ public:
+  explicit CompressionAutotuner(
+      std::vector<std::string> candidates = {io::compression::kNone,
+                                             io::compression::kSnappy,
+                                             io::compression::kGzip},
+      int64_t exploration_interval = 10);
+
+  // Returns the compression to write the next chunks with.
+  std::string NextCompression();
+
+  // Records that it took `write_time` to write `bytes` uncompressed bytes with
+  // `compression`.
+  void RecordChunks(absl::string_view compression, ByteSize bytes,
+                    absl::Duration write_time);
+
+ private:
+  struct Measurement {
+    // Exponential moving average of the throughput.
+    double bytes_per_second = 0.0;
+    // The round of the last measurement, or -1 if there is none.
+    int64_t round = -1;
+  };
+
+  const std::vector<std::string> candidates_;
+  const int64_t exploration_interval_;
+  std::vector<Measurement> measurements_;
+  int64_t round_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COMPRESSION_AUTOTUNER_H_
@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/compression_autotuner.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::io::compression::kGzip;
+using ::tensorflow::io::compression::kNone;
+using ::tensorflow::io::compression::kSnappy;
+
+TEST(CompressionAutotunerTest, TriesEveryCandidate) {
+  CompressionAutotuner autotuner({kNone, kSnappy, kGzip});
+  EXPECT_EQ(autotuner.NextCompression(), kNone);
+  autotuner.RecordChunks(kNone, ByteSize::MB(100), absl::Seconds(1));
+  EXPECT_EQ(autotuner.NextCompression(), kSnappy);
+  autotuner.RecordChunks(kSnappy, ByteSize::MB(100), absl::Seconds(1));
+  EXPECT_EQ(autotuner.NextCompression(), kGzip);
+}
+
+TEST(CompressionAutotunerTest, ChoosesHighestThroughput) {
+  CompressionAutotuner autotuner({kNone, kSnappy, kGzip},
+                                 /*exploration_interval=*/100);
+  const std::vector<std::pair<std::string, int>> write_seconds = {
+      {kNone, 4}, {kSnappy, 1}, {kGzip, 2}};
+  for (const auto& [compression, seconds] : write_seconds) {
+    EXPECT_EQ(autotuner.NextCompression(), compression);
+    autotuner.RecordChunks(compression, ByteSize::MB(100),
+                           absl::Seconds(seconds));
+  }
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(autotuner.NextCompression(), kSnappy);
+    autotuner.RecordChunks(kSnappy, ByteSize::MB(100), absl::Seconds(1));
+  }
+}
+
+TEST(CompressionAutotunerTest, FollowsChangingThroughput) {
+  CompressionAutotuner autotuner({kNone, kSnappy},
+                                 /*exploration_interval=*/2);
+  EXPECT_EQ(autotuner.NextCompression(), kNone);
+  autotuner.RecordChunks(kNone, ByteSize::MB(100), absl::Seconds(1));
+  EXPECT_EQ(autotuner.NextCompression(), kSnappy);
+  autotuner.RecordChunks(kSnappy, ByteSize::MB(100), absl::Seconds(2));
+  EXPECT_EQ(autotuner.NextCompression(), kNone);
+  // The file system slows down, which makes compression pay off.
+  autotuner.RecordChunks(kNone, ByteSize::MB(100), absl::Seconds(10));
+  // Re-measures the least recently measured candidate.
+  EXPECT_EQ(autotuner.NextCompression(), kSnappy);
+  autotuner.RecordChunks(kSnappy, ByteSize::MB(100), absl::Seconds(1));
+  EXPECT_EQ(autotuner.NextCompression(), kSnappy);
+}
+
+TEST(CompressionAutotunerTest, IgnoresEmptyMeasurements) {
+  CompressionAutotuner autotuner({kNone, kSnappy});
+  EXPECT_EQ(autotuner.NextCompression(), kNone);
+  autotuner.RecordChunks(kNone, ByteSize::Bytes(0), absl::Seconds(1));
+  EXPECT_EQ(autotuner.NextCompression(), kNone);
+  autotuner.RecordChunks(kNone, ByteSize::MB(1), absl::ZeroDuration());
+  EXPECT_EQ(autotuner.NextCompression(), kNone);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -28,10 +28,12 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/snapshot/utils.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/path.h"
@@ -48,12 +50,14 @@ ParallelTFRecordWriter::ParallelTFRecordWriter(const std::string& file_prefix,
                                                tsl::Env* env,
                                                ByteSize max_file_size,
                                                int64_t num_write_threads,
-                                               int64_t buffer_size)
+                                               int64_t buffer_size,
+                                               bool write_record_index)
     : env_(env),
       file_prefix_(file_prefix),
       compression_(compression),
       max_file_size_(max_file_size),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      write_record_index_(write_record_index) {
   thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
       env_, tsl::ThreadOptions{}, "write_tfrecord_thread", num_write_threads);
   for (int64_t i = 0; i < num_write_threads; ++i) {
@@ -116,15 +120,29 @@ bool ParallelTFRecordWriter::HasNext() const ABSL_LOCKS_EXCLUDED(mu_) {
 
 absl::Status ParallelTFRecordWriter::WriteFile() ABSL_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(const std::string filename, GetUniqueFile());
-  snapshot_util::TFRecordWriter writer(filename, compression_);
+  snapshot_util::TFRecordWriter writer(filename, compression_,
+                                       write_record_index_);
   TF_RETURN_IF_ERROR(writer.Initialize(env_));
   while (ShouldWriteFile(filename)) {
     TF_RETURN_IF_ERROR(WriteRecord(filename, writer));
   }
+  const uint64_t start_micros = env_->NowMicros();
   TF_RETURN_IF_ERROR(writer.Close());
+  AddWriteTime(filename,
+               absl::Microseconds(env_->NowMicros() - start_micros));
   return DeleteEmptyFile(filename);
 }
 
+void ParallelTFRecordWriter::AddWriteTime(const std::string& filename,
+                                          absl::Duration write_time)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  auto iterator = file_stats_.find(filename);
+  if (iterator != file_stats_.end()) {
+    iterator->second.write_time += write_time;
+  }
+}
+
 bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
     ABSL_LOCKS_EXCLUDED(mu_) {
   if (!HasNext()) {
@@ -146,7 +164,10 @@ absl::Status ParallelTFRecordWriter::WriteRecord(
 
   tsl::profiler::TraceMe activity("WriteTFRecord",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  const uint64_t start_micros = env_->NowMicros();
   TF_RETURN_IF_ERROR(writer.WriteTensors(*std::move(record)));
+  AddWriteTime(filename,
+               absl::Microseconds(env_->NowMicros() - start_micros));
   return absl::OkStatus();
 }
 
@@ -182,6 +203,11 @@ absl::Status ParallelTFRecordWriter::DeleteEmptyFile(
   }
 
   TF_RETURN_IF_ERROR(env_->DeleteFile(filename));
+  const std::string index_filename =
+      absl::StrCat(filename, io::kRecordIndexSuffix);
+  if (env_->FileExists(index_filename).ok()) {
+    TF_RETURN_IF_ERROR(env_->DeleteFile(index_filename));
+  }
   if (iterator != file_stats_.end()) {
     file_stats_.erase(iterator);
   }
@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -54,13 +55,18 @@ namespace data {
 // }
 // TF_ASSIGN_OR_RETURN(ParallelTFRecordWriter::FileToStatsMap file_stats,
 //                     writer.Finalize());
+//
+// If `write_record_index` is true and the files are not compressed, every file
+// gets a record index next to it (see `io::ReadRecordIndex`), so that its
+// records can be read in any order.
 class ParallelTFRecordWriter {
  public:
   explicit ParallelTFRecordWriter(const std::string& file_prefix,
                                   const std::string& compression, tsl::Env* env,
                                   ByteSize max_file_size = ByteSize::GB(6),
                                   int64_t num_write_threads = 2,
-                                  int64_t buffer_size = 1);
+                                  int64_t buffer_size = 1,
+                                  bool write_record_index = false);
   virtual ~ParallelTFRecordWriter();
   ParallelTFRecordWriter(const ParallelTFRecordWriter&) = delete;
   ParallelTFRecordWriter& operator=(const ParallelTFRecordWriter&) = delete;
@@ -70,10 +76,12 @@ class ParallelTFRecordWriter {
   // blocks until there is enough space to buffer the record.
   absl::Status Write(std::vector<Tensor> record);
 
-  // File stats: number of records in a file and the estimated size of the file.
+  // File stats: number of records in a file, the estimated size of the file,
+  // and the time spent serializing, compressing, and writing the records.
   struct FileStats {
     int64_t num_records = 0;
     ByteSize estimated_size;
+    absl::Duration write_time;
   };
   using FileToStatsMap = absl::flat_hash_map<std::string, FileStats>;
 
@@ -91,6 +99,9 @@ class ParallelTFRecordWriter {
   // Whether there are more records to be written.
   bool HasNext() const;
 
+  // Adds `write_time` to the stats of `filename`.
+  void AddWriteTime(const std::string& filename, absl::Duration write_time);
+
   // Writes a new file.
   absl::Status WriteFile();
 
@@ -106,7 +117,7 @@ class ParallelTFRecordWriter {
   absl::StatusOr<std::optional<std::vector<Tensor>>> GetNextRecord(
       const std::string& filename);
 
-  // Deletes the file if it's empty.
+  // Deletes the file, and its record index, if it's empty.
   absl::Status DeleteEmptyFile(const std::string& filename);
 
   // Generates a unique file name in the requested directory.
@@ -120,6 +131,7 @@ class ParallelTFRecordWriter {
   const std::string compression_;
   const ByteSize max_file_size_;
   const int64_t buffer_size_;
+  const bool write_record_index_;
 
   mutable absl::Mutex mu_;
   mutable absl::CondVar ready_to_push_;
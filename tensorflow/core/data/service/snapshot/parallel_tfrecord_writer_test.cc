@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/platform/env.h"
@@ -302,6 +303,25 @@ TEST(ParallelTFRecordWriterTest, CannotWriteFinalizedWriter) {
   client_thread.reset();
 }
 
+TEST(ParallelTFRecordWriterTest, WriteRecordIndex) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
+  ParallelTFRecordWriter parallel_tfrecord_writer(
+      test_dir, tsl::io::compression::kNone, tsl::Env::Default(),
+      /*max_file_size=*/ByteSize::Bytes(100), /*num_write_threads=*/2,
+      /*buffer_size=*/1, /*write_record_index=*/true);
+  RangeIterator range_iterator(100);
+  TF_ASSERT_OK_AND_ASSIGN(
+      ParallelTFRecordWriter::FileToStatsMap file_stats,
+      WriteRecords(parallel_tfrecord_writer, range_iterator));
+
+  ASSERT_THAT(file_stats, SizeIs(Gt(1)));
+  for (const auto& [filename, stats] : file_stats) {
+    std::vector<uint64_t> offsets;
+    TF_ASSERT_OK(io::ReadRecordIndex(tsl::Env::Default(), filename, &offsets));
+    EXPECT_THAT(offsets, SizeIs(stats.num_records + 1));
+  }
+}
+
 TEST(ParallelTFRecordWriterTest, DirectoryDoesNotExist) {
   ParallelTFRecordWriter parallel_tfrecord_writer("/directory/does/not/exists",
                                                   tsl::io::compression::kNone,
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,6 +30,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/tstring.h"
@@ -66,18 +70,21 @@ class SnapshotChunkDatasetOp : public DatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   std::string compression_;
+  int64_t prefetch_bytes_ = 0;
 };
 
 class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(DatasetContext&& ctx, const std::string& chunk_file,
           const std::string& compression, const DataTypeVector& dtypes,
-          const std::vector<PartialTensorShape>& shapes)
+          const std::vector<PartialTensorShape>& shapes,
+          int64_t prefetch_bytes)
       : DatasetBase(std::move(ctx)),
         chunk_file_(chunk_file),
         compression_(compression),
         dtypes_(dtypes),
-        shapes_(shapes) {}
+        shapes_(shapes),
+        prefetch_bytes_(prefetch_bytes) {}
 
   const DataTypeVector& output_dtypes() const override { return dtypes_; }
 
@@ -120,12 +127,24 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  // If `prefetch_bytes_` is positive, elements are read and parsed ahead of
+  // the consumer on a background thread, up to that many bytes. The elements
+  // are returned in file order either way.
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
-    ~Iterator() override { RecordBytesRead(); }
+    ~Iterator() override {
+      {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cv_.notify_all();
+      }
+      // Joins the prefetch thread before `reader_` is destroyed.
+      prefetch_thread_.reset();
+      RecordBytesRead();
+    }
 
     absl::Status Initialize(IteratorContext* ctx) override {
       reader_ = std::make_unique<snapshot_util::TFRecordReader>(
@@ -139,6 +158,9 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
       *end_of_sequence = false;
+      if (dataset()->prefetch_bytes_ > 0) {
+        return GetNextFromBuffer(ctx, out_tensors, end_of_sequence);
+      }
       absl::Status status = reader_->ReadTensors(out_tensors);
       if (absl::IsOutOfRange(status)) {
         *end_of_sequence = true;
@@ -147,19 +169,24 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_WITH_CONTEXT_IF_ERROR(
           status,
           " Failed to read tf.data snapshot file: ", dataset()->chunk_file_);
+      mutex_lock l(mu_);
       ++start_index_;
       return status;
     }
 
     absl::Status SaveInternal(SerializationContext* ctx,
                               IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(full_name(kStartIndex), start_index_));
       return absl::OkStatus();
     }
 
+    // The iterator is restored before the prefetch thread starts, because the
+    // thread is only started by the first `GetNext` call.
     absl::Status RestoreInternal(IteratorContext* ctx,
                                  IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(
           reader->ReadScalar(full_name(kStartIndex), &start_index_));
       TF_RETURN_IF_ERROR(Initialize(ctx));
@@ -167,6 +194,69 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    absl::Status GetNextFromBuffer(IteratorContext* ctx,
+                                   std::vector<Tensor>* out_tensors,
+                                   bool* end_of_sequence) {
+      mutex_lock l(mu_);
+      if (!prefetch_thread_) {
+        prefetch_thread_ = ctx->StartThread(
+            "tf_data_snapshot_chunk_prefetch", [this]() { PrefetchThread(); });
+      }
+      while (buffer_.empty() && prefetch_status_.ok()) {
+        cv_.wait(l);
+      }
+      if (buffer_.empty()) {
+        if (absl::IsOutOfRange(prefetch_status_)) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        return prefetch_status_;
+      }
+      *out_tensors = std::move(buffer_.front().tensors);
+      buffered_bytes_ -= buffer_.front().bytes;
+      buffer_.pop_front();
+      ++start_index_;
+      cv_.notify_all();
+      return absl::OkStatus();
+    }
+
+    // Reads elements into `buffer_` until the chunk ends, reading fails, or the
+    // iterator is destroyed. An element larger than the budget is read once
+    // the buffer is empty.
+    void PrefetchThread() {
+      while (true) {
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && !buffer_.empty() &&
+                 buffered_bytes_ >= dataset()->prefetch_bytes_) {
+            cv_.wait(l);
+          }
+          if (cancelled_) {
+            return;
+          }
+        }
+        BufferedElement element;
+        absl::Status status = reader_->ReadTensors(&element.tensors);
+        mutex_lock l(mu_);
+        if (!status.ok()) {
+          if (!absl::IsOutOfRange(status)) {
+            errors::AppendToMessage(&status,
+                                    " Failed to read tf.data snapshot file: ",
+                                    dataset()->chunk_file_);
+          }
+          prefetch_status_ = status;
+          cv_.notify_all();
+          return;
+        }
+        for (const Tensor& tensor : element.tensors) {
+          element.bytes += tensor.TotalBytes();
+        }
+        buffered_bytes_ += element.bytes;
+        buffer_.push_back(std::move(element));
+        cv_.notify_all();
+      }
+    }
+
     // TODO(b/250921378): Optimize this to not parse every single element. We
     // may consider switching the data format to ArrayRecords so we can use the
     // index to jump straight to the starting record.
@@ -184,14 +274,32 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
           ->IncrementBy(bytes_read);
     }
 
+    // An element read by the prefetch thread.
+    struct BufferedElement {
+      std::vector<Tensor> tensors;
+      int64_t bytes = 0;
+    };
+
     std::unique_ptr<snapshot_util::TFRecordReader> reader_;
-    int64_t start_index_ = 0;
+
+    mutex mu_;
+    condition_variable cv_;
+    // The number of elements returned to the consumer.
+    int64_t start_index_ TF_GUARDED_BY(mu_) = 0;
+    std::deque<BufferedElement> buffer_ TF_GUARDED_BY(mu_);
+    int64_t buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+    // OutOfRange once the prefetch thread reaches the end of the chunk, or the
+    // error it failed with.
+    absl::Status prefetch_status_ TF_GUARDED_BY(mu_);
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    std::unique_ptr<Thread> prefetch_thread_;
   };
 
   const tstring chunk_file_;
   const tstring compression_;
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
+  const int64_t prefetch_bytes_;
 };
 
 SnapshotChunkDatasetOp::SnapshotChunkDatasetOp(OpKernelConstruction* ctx)
@@ -199,6 +307,13 @@ SnapshotChunkDatasetOp::SnapshotChunkDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  // The number of bytes of elements which each chunk iterator reads ahead.
+  // Prefetching is off by default: it costs a thread and up to this many bytes
+  // per chunk iterator, and snapshots are loaded by interleaving many chunk
+  // datasets in parallel.
+  OP_REQUIRES_OK(
+      ctx, ReadInt64FromEnvVar("TF_DATA_SNAPSHOT_CHUNK_PREFETCH_BYTES",
+                               /*default_val=*/0, &prefetch_bytes_));
 }
 
 void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -208,7 +323,8 @@ void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
 
   *output = new SnapshotChunkDatasetOp::Dataset(DatasetContext(ctx), chunk_file,
                                                 compression_, output_types_,
-                                                output_shapes_);
+                                                output_shapes_,
+                                                prefetch_bytes_);
   metrics::RecordTFDataServiceSnapshotOp(
       std::string(GetSnapshotPath(chunk_file)), kSnapshotChunkDataset);
 }
@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
+#include "tensorflow/core/data/service/snapshot/compression_autotuner.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/parallel_tfrecord_writer.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
@@ -96,12 +97,24 @@ ByteSize TotalBytes(const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
   }
   return bytes;
 }
+
+absl::Duration TotalWriteTime(
+    const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
+  absl::Duration write_time;
+  for (const auto& [file, stats] : file_stats) {
+    write_time += stats.write_time;
+  }
+  return write_time;
+}
 }  // namespace
 
 SnapshotStreamWriter::SnapshotStreamWriter(
     const SnapshotWriterParams& params, std::unique_ptr<TaskIterator> iterator)
     : params_(params), iterator_(std::move(iterator)) {
   DCHECK_NE(iterator_.get(), nullptr);
+  if (params_.compression == snapshot_util::kAutotuneCompression) {
+    compression_autotuner_.emplace();
+  }
   last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   snapshot_thread_ = absl::WrapUnique(params_.env->StartThread(
       /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_thread",
@@ -142,9 +155,13 @@ absl::Status SnapshotStreamWriter::WriteSnapshot() TF_LOCKS_EXCLUDED(mu_) {
   // TODO(b/258691097): Write the "LEASE" file periodically.
   TF_RETURN_IF_ERROR(InitializeDirectories());
   TF_RETURN_IF_ERROR(Restore());
-  while (ShouldWriteChunks()) {
-    TF_RETURN_IF_ERROR(WriteChunks());
+  absl::Status status;
+  while (status.ok() && ShouldWriteChunks()) {
+    status = WriteChunks();
   }
+  // The last checkpoint is written before the stream is finalized.
+  status.Update(WaitForPendingCommit());
+  TF_RETURN_IF_ERROR(status);
   mutex_lock l(mu_);
   return completed_.status();
 }
@@ -165,7 +182,7 @@ absl::Status SnapshotStreamWriter::InitializeDirectories() {
 
 bool SnapshotStreamWriter::ShouldWriteChunks() const TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  return !end_of_sequence_ && completed_.ok();
+  return !end_of_sequence_ && completed_.ok() && commit_status_.ok();
 }
 
 absl::Status SnapshotStreamWriter::WriteChunks() {
@@ -176,9 +193,12 @@ absl::Status SnapshotStreamWriter::WriteChunks() {
   std::string chunks_prefix = tsl::io::JoinPath(
       params_.UncommittedChunksDirectory(),
       absl::StrCat("chunk_", chunk_index_, kFileShardDelimiter));
-  ParallelTFRecordWriter writer(TranslateFileName(chunks_prefix),
-                                params_.compression, params_.env,
-                                params_.max_chunk_size);
+  const std::string compression =
+      compression_autotuner_.has_value()
+          ? compression_autotuner_->NextCompression()
+          : params_.compression;
+  ParallelTFRecordWriter writer(TranslateFileName(chunks_prefix), compression,
+                                params_.env, params_.max_chunk_size);
   do {
     TF_RETURN_IF_ERROR(WriteRecord(writer));
   } while (ShouldWriteRecord());
@@ -186,6 +206,10 @@ absl::Status SnapshotStreamWriter::WriteChunks() {
                       writer.Finalize());
   TF_RETURN_IF_ERROR(Completed().status());
   TF_RETURN_IF_ERROR(Commit(file_stats));
+  if (compression_autotuner_.has_value()) {
+    compression_autotuner_->RecordChunks(compression, TotalBytes(file_stats),
+                                         TotalWriteTime(file_stats));
+  }
   metrics::RecordTFDataServiceSnapshotBytesCommitted(
       TotalBytes(file_stats).ToUnsignedBytes());
   return absl::OkStatus();
@@ -193,7 +217,7 @@ absl::Status SnapshotStreamWriter::WriteChunks() {
 
 bool SnapshotStreamWriter::ShouldWriteRecord() const {
   mutex_lock l(mu_);
-  if (!completed_.ok() || end_of_sequence_) {
+  if (!completed_.ok() || !commit_status_.ok() || end_of_sequence_) {
     return false;
   }
   const absl::Time now = absl::FromUnixMicros(params_.env->NowMicros());
@@ -215,24 +239,63 @@ absl::Status SnapshotStreamWriter::WriteRecord(ParallelTFRecordWriter& writer) {
 
 absl::Status SnapshotStreamWriter::Commit(
     const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
+  // Waits for the previous checkpoint, so that only one serialized iterator is
+  // held in memory.
+  TF_RETURN_IF_ERROR(WaitForPendingCommit());
+  tsl::profiler::TraceMe activity("SnapshotSaveIterator",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  TF_ASSIGN_OR_RETURN(std::vector<Tensor> serialized_iterator,
+                      iterator_->Save());
+  const int64_t first_chunk_index = chunk_index_;
+  chunk_index_ += file_stats.size();
+  last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
+  if (!params_.async_checkpoint) {
+    return WriteCheckpointAndCommit(file_stats, first_chunk_index,
+                                    serialized_iterator);
+  }
+
+  // The next chunks have indexes from `chunk_index_` on. If the worker
+  // restarts before this checkpoint is written, they are discarded together
+  // with the chunks in `file_stats` (see SyncCheckpointWithChunks).
+  commit_thread_ = absl::WrapUnique(params_.env->StartThread(
+      /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_commit",
+      [this, file_stats, first_chunk_index,
+       serialized_iterator = std::move(serialized_iterator)]() {
+        absl::Status status = WriteCheckpointAndCommit(
+            file_stats, first_chunk_index, serialized_iterator);
+        mutex_lock l(mu_);
+        commit_status_.Update(status);
+      }));
+  return absl::OkStatus();
+}
+
+absl::Status SnapshotStreamWriter::WriteCheckpointAndCommit(
+    const ParallelTFRecordWriter::FileToStatsMap& file_stats,
+    int64_t first_chunk_index, const std::vector<Tensor>& serialized_iterator) {
   // Writes the checkpoint before committing the chunks. Once the checkpoint is
   // written, the chunks before the checkpoint are considered done. If the
   // worker restarts before committing the files in `file_stats`, the restarted
   // worker should commit the uncommitted chunks (see SyncCheckpointWithChunks).
-  TF_RETURN_IF_ERROR(Save(file_stats));
+  TF_RETURN_IF_ERROR(Save(file_stats, first_chunk_index, serialized_iterator));
 
   // Commits all chunks since the last commit.
+  int64_t chunk_index = first_chunk_index;
   for (const auto& [file, stats] : file_stats) {
     std::string committed_chunk_path =
         tsl::io::JoinPath(params_.CommittedChunksDirectory(),
                           absl::StrCat("chunk_", params_.stream_index, "_",
-                                       chunk_index_++, "_", stats.num_records));
+                                       chunk_index++, "_", stats.num_records));
     TF_RETURN_IF_ERROR(params_.env->RenameFile(file, committed_chunk_path));
   }
-  last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   return absl::OkStatus();
 }
 
+absl::Status SnapshotStreamWriter::WaitForPendingCommit() {
+  commit_thread_.reset();
+  mutex_lock l(mu_);
+  return commit_status_;
+}
+
 absl::Status SnapshotStreamWriter::FinalizeStream(absl::Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -282,12 +345,13 @@ void SnapshotStreamWriter::Cancel() TF_LOCKS_EXCLUDED(mu_) {
 }
 
 absl::Status SnapshotStreamWriter::Save(
-    const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
+    const ParallelTFRecordWriter::FileToStatsMap& file_stats,
+    int64_t first_chunk_index, const std::vector<Tensor>& serialized_iterator) {
   const size_t num_elements = TotalNumElements(file_stats);
   const ByteSize byte_size = TotalBytes(file_stats);
   LOG(INFO) << "Checkpointing distributed tf.data snapshot writer for snapshot "
             << params_.DebugString() << ". Stream " << params_.stream_index
-            << ", chunk " << chunk_index_
+            << ", chunk " << first_chunk_index
             << ", number of elements in chunk: " << num_elements
             << ", chunk size: " << byte_size << ".";
   tsl::profiler::TraceMe activity("SnapshotCheckpoint",
@@ -296,10 +360,8 @@ absl::Status SnapshotStreamWriter::Save(
   // The checkpoint index identifies the first chunk index after the checkpoint:
   // When a worker restarts, all the files before `checkpoint_index` should be
   // committed; all the files at/after `checkpoint_index` should be discarded.
-  int64_t checkpoint_index = chunk_index_ + file_stats.size();
+  int64_t checkpoint_index = first_chunk_index + file_stats.size();
   std::string checkpoint_path = CheckpointPath(checkpoint_index, num_elements);
-  TF_ASSIGN_OR_RETURN(std::vector<Tensor> serialized_iterator,
-                      iterator_->Save());
   TF_RETURN_IF_ERROR(AtomicallyWriteTFRecords(
       checkpoint_path, serialized_iterator, params_.compression, params_.env));
   absl::Time end_time = absl::FromUnixMicros(params_.env->NowMicros());
@@ -30,6 +30,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/snapshot/compression_autotuner.h"
 #include "tensorflow/core/data/service/snapshot/parallel_tfrecord_writer.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -55,7 +56,8 @@ struct SnapshotWriterParams {
   // processed by a worker.
   int64_t stream_index = 0;
 
-  // Compression method as defined in tsl/lib/io/compression.h.
+  // Compression method as defined in tsl/lib/io/compression.h, or
+  // `snapshot_util::kAutotuneCompression` to choose it for every commit.
   std::string compression;
 
   // The Tensorflow environment.
@@ -73,6 +75,11 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // If true, checkpoints are written and chunks are committed on a background
+  // thread while the next chunks are written. The iterator is still saved
+  // synchronously, and at most one checkpoint is written at a time.
+  bool async_checkpoint = false;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -175,14 +182,28 @@ class SnapshotStreamWriter {
   // Commits the chunks since the last commit.
   absl::Status Commit(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
 
+  // Writes the checkpoint `serialized_iterator`, then commits the chunks in
+  // `file_stats`, starting at chunk index `first_chunk_index`.
+  absl::Status WriteCheckpointAndCommit(
+      const ParallelTFRecordWriter::FileToStatsMap& file_stats,
+      int64_t first_chunk_index,
+      const std::vector<Tensor>& serialized_iterator);
+
+  // Waits for the asynchronous commit started by the last `Commit` call, if
+  // any. Returns the first error of an asynchronous commit.
+  absl::Status WaitForPendingCommit();
+
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
   absl::Status FinalizeStream(absl::Status status);
   absl::Status WriteDoneFile();
   absl::Status WriteErrorFile(const absl::Status& status);
 
-  // Saves an iterator checkpoint.
-  absl::Status Save(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
+  // Writes an iterator checkpoint for the chunks in `file_stats`, starting at
+  // chunk index `first_chunk_index`.
+  absl::Status Save(const ParallelTFRecordWriter::FileToStatsMap& file_stats,
+                    int64_t first_chunk_index,
+                    const std::vector<Tensor>& serialized_iterator);
 
   // After committing a checkpoint, deletes the previous checkpoints.
   absl::Status DeleteOutdatedCheckpoints(int64_t checkpoint_index);
@@ -219,6 +240,10 @@ class SnapshotStreamWriter {
   // The dataset iterator that produces the dataset elements.
   std::unique_ptr<TaskIterator> iterator_;
 
+  // Chooses the compression of the chunks if `params_.compression` is
+  // `snapshot_util::kAutotuneCompression`.
+  std::optional<CompressionAutotuner> compression_autotuner_;
+
   // Index of the next chunk to write.
   int64_t chunk_index_ = 0;
   // Timestamp when the last chunks are committed.
@@ -235,6 +260,13 @@ class SnapshotStreamWriter {
   // - If the snapshot has not finished, this is false.
   absl::StatusOr<bool> completed_ TF_GUARDED_BY(mu_) = false;
 
+  // The first error of an asynchronous commit.
+  absl::Status commit_status_ TF_GUARDED_BY(mu_);
+
+  // Writes the last checkpoint and commits its chunks if
+  // `params_.async_checkpoint` is true. Only accessed by the snapshot thread.
+  std::unique_ptr<Thread> commit_thread_;
+
   std::unique_ptr<Thread> snapshot_thread_;
 };
 
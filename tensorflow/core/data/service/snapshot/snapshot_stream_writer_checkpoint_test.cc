@@ -219,6 +219,30 @@ TEST(SnapshotStreamWriterCheckpointTest, MultipleCheckpoints) {
               IsOkAndHolds(range + 1));
 }
 
+TEST(SnapshotStreamWriterCheckpointTest, AsyncCheckpoints) {
+  int64_t range = 5;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          testing::TestIterator(testing::RangeDataset(range)));
+
+  const std::string compression = tsl::io::compression::kSnappy;
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{
+      snapshot_path,
+      /*stream_index=*/0,
+      compression,
+      Env::Default(),
+      /*max_chunk_size=*/ByteSize::Bytes(1),
+      /*checkpoint_interval=*/absl::Microseconds(1),
+      /*test_only_keep_temp_files=*/true,
+      /*async_checkpoint=*/true};
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+  EXPECT_THAT(testing::ReadSnapshot<int64_t>(snapshot_path, compression),
+              IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4)));
+  EXPECT_THAT(NumCheckpoints(snapshot_path, /*stream_index=*/0),
+              IsOkAndHolds(range + 1));
+}
+
 TEST(SnapshotStreamWriterCheckpointTest, CleanupCheckpoint) {
   int64_t range = 5;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
@@ -152,8 +152,11 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // read the full dataset.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  // If `spill_options.max_spill_size_bytes` is positive, elements evicted from
+  // memory are spilled to `spill_options.directory`.
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      CrossTrainerCacheSpillOptions spill_options = {});
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -179,6 +182,10 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    StatusOr<std::string> SerializeElement(
+        const GetElementResult& element) const override;
+    StatusOr<GetElementResult> DeserializeElement(
+        const std::string& serialized) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
@@ -23,6 +23,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -33,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -323,6 +327,27 @@ TEST(CachingTaskRunnerTest, GetNext) {
   }
 }
 
+TEST(CachingTaskRunnerTest, SlowTrainerReadsSpilledElements) {
+  size_t range = 100;
+  CrossTrainerCacheSpillOptions spill_options;
+  spill_options.directory =
+      io::JoinPath(testing::TmpDir(),
+                   absl::StrCat("caching_task_runner_spill_", random::New64()));
+  spill_options.max_spill_size_bytes = kLargeCache;
+  CachingTaskRunner runner(std::make_unique<InfiniteRangeIterator>(),
+                           /*max_cache_size_bytes=*/kSmallCache,
+                           std::move(spill_options));
+
+  for (const std::string trainer_id : {"Fast trainer", "Slow trainer"}) {
+    GetElementRequest request;
+    request.set_trainer_id(trainer_id);
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> output,
+        GetElementsFromTaskRunner<int64_t>(runner, request, range));
+    EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+  }
+}
+
 TEST(CachingTaskRunnerTest, EmptyDataset) {
   CachingTaskRunner runner(
       std::make_unique<RangeIterator>(/*range=*/0, /*repeat=*/false),
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker_client.h"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -51,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/errors.h"
 
 namespace tensorflow {
@@ -99,6 +102,15 @@ std::string DataServiceWorkerClient::GetDataTransferProtocol() const {
 
 void DataServiceWorkerClient::TryCancel() { client_->TryCancel(); }
 
+// The number of elements to request per `GetElements` call, read from the
+// `TF_DATA_SERVICE_GET_ELEMENTS_BATCH_SIZE` environment variable. A value of 1
+// uses one `GetElement` call per element.
+constexpr int64_t kDefaultGetElementsBatchSize = 1;
+
+// `GetElements` calls stop adding elements once their response reaches this
+// size.
+constexpr int64_t kMaxGetElementsBatchBytes = 4 << 20;  // 4MB
+
 class GrpcDataTransferClient : public DataTransferClient {
  public:
   GrpcDataTransferClient(std::shared_ptr<grpc::ChannelCredentials> credentials,
@@ -108,17 +120,38 @@ class GrpcDataTransferClient : public DataTransferClient {
     args.SetMaxReceiveMessageSize(-1);
     auto channel = grpc::CreateCustomChannel(address, credentials, args);
     stub_ = WorkerService::NewStub(channel);
+    Status s = ReadInt64FromEnvVar("TF_DATA_SERVICE_GET_ELEMENTS_BATCH_SIZE",
+                                   kDefaultGetElementsBatchSize,
+                                   &get_elements_batch_size_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to read the tf.data service GetElements batch "
+                   << "size: " << s;
+    }
   }
 
   Status GetElement(const GetElementRequest& req,
                     GetElementResult& result) override {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
             << "server.";
+    // Coordinated reads and cross-trainer cache reads get one element per
+    // call, see worker.proto.
+    bool batched = get_elements_batch_size_ > 1 && !req.has_round_index() &&
+                   req.trainer_id().empty();
     {
       mutex_lock l(mu_);
       if (cancelled_) {
         return errors::Cancelled("Client was cancelled.");
       }
+      batched = batched && !get_elements_unimplemented_;
+      if (batched) {
+        std::deque<GetElementResponse>& buffered =
+            buffered_elements_[req.task_id()];
+        if (!buffered.empty()) {
+          GetElementResponse resp = std::move(buffered.front());
+          buffered.pop_front();
+          return ResponseToResult(resp, result);
+        }
+      }
     }
     grpc::ClientContext ctx;
     gtl::Cleanup<std::function<void()>> cleanup;
@@ -130,6 +163,9 @@ class GrpcDataTransferClient : public DataTransferClient {
         active_contexts_.erase(&ctx);
       });
     }
+    if (batched) {
+      return GetElements(ctx, req, result);
+    }
     GetElementResponse resp;
     int64_t start_time_us = env_->NowMicros();
     grpc::Status s = stub_->GetElement(&ctx, req, &resp);
@@ -139,12 +175,70 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
                                                    end_time_us - start_time_us);
+    return ResponseToResult(resp, result);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    buffered_elements_.clear();
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  // Reads a batch of elements with a `GetElements` call, returning the first
+  // one in `result` and buffering the others. Falls back to `GetElement` calls
+  // if the worker does not support `GetElements`.
+  Status GetElements(grpc::ClientContext& ctx, const GetElementRequest& req,
+                     GetElementResult& result) {
+    GetElementsRequest batch_req;
+    *batch_req.mutable_request() = req;
+    batch_req.set_max_elements(get_elements_batch_size_);
+    batch_req.set_max_bytes(kMaxGetElementsBatchBytes);
+    GetElementsResponse batch_resp;
+    int64_t start_time_us = env_->NowMicros();
+    grpc::Status s = stub_->GetElements(&ctx, batch_req, &batch_resp);
+    int64_t end_time_us = env_->NowMicros();
+    if (s.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+      VLOG(1) << "The tf.data service worker does not support GetElements. "
+              << "Falling back to GetElement.";
+      {
+        mutex_lock l(mu_);
+        get_elements_unimplemented_ = true;
+      }
+      return GetElement(req, result);
+    }
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get elements", s);
+    }
+    if (batch_resp.elements().empty()) {
+      return errors::Internal("Expected at least one element, but got none.");
+    }
+    metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
+                                                   end_time_us - start_time_us);
+    {
+      mutex_lock l(mu_);
+      std::deque<GetElementResponse>& buffered =
+          buffered_elements_[req.task_id()];
+      for (int i = 1; i < batch_resp.elements_size(); ++i) {
+        buffered.push_back(std::move(*batch_resp.mutable_elements(i)));
+      }
+    }
+    return ResponseToResult(*batch_resp.mutable_elements(0), result);
+  }
+
+  // Moves the element in `resp` to `result`.
+  static Status ResponseToResult(GetElementResponse& resp,
+                                 GetElementResult& result) {
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
       case GetElementResponse::kCompressed: {
         Tensor tensor(DT_VARIANT, TensorShape{});
-        tensor.scalar<Variant>()() = std::move(resp.compressed());
+        tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
         result.components.push_back(tensor);
         break;
       }
@@ -162,18 +256,15 @@ class GrpcDataTransferClient : public DataTransferClient {
     return absl::OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
-
- private:
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
+  int64_t get_elements_batch_size_ = kDefaultGetElementsBatchSize;
+  // Set if the worker does not support `GetElements`.
+  bool get_elements_unimplemented_ TF_GUARDED_BY(mu_) = false;
+  // Elements received in `GetElements` batches that have not been returned
+  // yet, keyed by task ID.
+  absl::flat_hash_map<int64_t, std::deque<GetElementResponse>>
+      buffered_elements_ TF_GUARDED_BY(mu_);
   // Set of all currently active clients contexts. Used to support
   // cancellation.
   absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_client.h"
 
+#include <cstdlib>
 #include <memory>
 #include <optional>
 #include <string>
@@ -177,6 +178,28 @@ TEST_F(WorkerClientTest, LocalReadEmptyDataset) {
                        MatchesRegex("Local worker.*is no longer available.*")));
 }
 
+TEST_F(WorkerClientTest, GrpcBatchedRead) {
+  setenv("TF_DATA_SERVICE_GET_ELEMENTS_BATCH_SIZE", "4", /*overwrite=*/1);
+  const int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcTransferProtocol));
+  unsetenv("TF_DATA_SERVICE_GET_ELEMENTS_BATCH_SIZE");
+  for (int64_t i = 0; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
 TEST_F(WorkerClientTest, GrpcRead) {
   const int64_t range = 5;
   TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
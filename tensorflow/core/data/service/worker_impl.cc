@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -64,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/status_to_from_proto.h"
 #include "tsl/platform/statusor.h"
@@ -80,8 +82,9 @@ constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
 using WorkerConfig = experimental::WorkerConfig;
 
 // Moves the element into the response. If the tensor contains a single
-// CompressedElement variant, the move will be zero-copy. Otherwise, the tensor
-// data will be serialized as TensorProtos.
+// CompressedElement variant that no one else references, the move will be
+// zero-copy. Otherwise, the compressed element is copied, or the tensor data
+// will be serialized as TensorProtos.
 Status MoveElementToResponse(std::vector<Tensor>&& element,
                              GetElementResponse& resp) {
   if (element.size() != 1 || element[0].dtype() != DT_VARIANT ||
@@ -100,7 +103,13 @@ Status MoveElementToResponse(std::vector<Tensor>&& element,
         "it produced ",
         variant.TypeName());
   }
-  *resp.mutable_compressed() = *compressed;
+  // Elements may be shared, e.g. by the cross-trainer cache, in which case the
+  // other readers still need the compressed data.
+  if (element[0].RefCountIsOne()) {
+    *resp.mutable_compressed() = std::move(*compressed);
+  } else {
+    *resp.mutable_compressed() = *compressed;
+  }
   return absl::OkStatus();
 }
 
@@ -491,6 +500,36 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   return absl::OkStatus();
 }
 
+Status DataServiceWorkerImpl::GetElements(const GetElementsRequest* request,
+                                          GetElementsResponse* response) {
+  VLOG(3) << "Received GetElements request for task "
+          << request->request().task_id();
+  const bool batchable = !request->request().has_round_index() &&
+                         request->request().trainer_id().empty();
+  const int64_t max_elements =
+      batchable ? std::max<int64_t>(request->max_elements(), 1) : 1;
+  GetElementRequest element_request = request->request();
+  int64_t num_bytes = 0;
+  while (response->elements_size() < max_elements) {
+    GetElementResponse element;
+    TF_RETURN_IF_ERROR(GetElement(&element_request, &element));
+    if (element.skip_task() && response->elements_size() > 0) {
+      break;
+    }
+    num_bytes += element.ByteSizeLong();
+    const bool last = element.end_of_sequence() || element.skip_task() ||
+                      (request->max_bytes() > 0 &&
+                       num_bytes >= request->max_bytes());
+    *response->add_elements() = std::move(element);
+    if (last) {
+      break;
+    }
+    // Only batches the elements that are ready.
+    element_request.set_allow_skip(true);
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -743,15 +782,19 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams writer_params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())};
+    TF_RETURN_IF_ERROR(
+        ReadBoolFromEnvVar("TF_DATA_SERVICE_SNAPSHOT_ASYNC_CHECKPOINT",
+                           /*default_val=*/false,
+                           &writer_params.async_checkpoint));
     mutex_lock l(mu_);
     snapshot_writers_.emplace(
         snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(writer_params,
+                                               std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
@@ -33,8 +33,10 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -115,6 +117,38 @@ std::string GetCheckpointFileName(const std::string& shard_directory,
                       static_cast<unsigned long long>(checkpoint_id)));
 }
 
+absl::StatusOr<std::string> DetectTFRecordCompression(RandomAccessFile* file) {
+  // The length and the masked checksum of the length of the first record.
+  constexpr size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
+  char scratch[kHeaderSize];
+  StringPiece header;
+  Status s = file->Read(/*offset=*/0, kHeaderSize, &header, scratch);
+  if (!s.ok() && !absl::IsOutOfRange(s)) {
+    return s;
+  }
+  if (header.empty()) {
+    return std::string(io::compression::kNone);
+  }
+  if (header.size() == kHeaderSize &&
+      crc32c::Unmask(core::DecodeFixed32(header.data() + sizeof(uint64))) ==
+          crc32c::Value(header.data(), sizeof(uint64))) {
+    return std::string(io::compression::kNone);
+  }
+  const uint8 b0 = static_cast<uint8>(header[0]);
+  const uint8 b1 = header.size() > 1 ? static_cast<uint8>(header[1]) : 0;
+  if (b0 == 0x1f && b1 == 0x8b) {
+    return std::string(io::compression::kGzip);
+  }
+  // A zlib stream header names the deflate method in the low bits of the first
+  // byte, and the two bytes read as a big-endian number are a multiple of 31.
+  if (header.size() > 1 && (b0 & 0x0f) == 8 && ((b0 << 8) | b1) % 31 == 0) {
+    return std::string(io::compression::kZlib);
+  }
+  // Snappy blocks start with their big-endian compressed size, whose first
+  // byte is 0 for any block the snappy output buffer writes.
+  return std::string(io::compression::kSnappy);
+}
+
 Status Writer::Create(Env* env, const std::string& filename,
                       const std::string& compression_type, int version,
                       const DataTypeVector& dtypes,
@@ -137,15 +171,29 @@ Status Writer::Create(Env* env, const std::string& filename,
 }
 
 TFRecordWriter::TFRecordWriter(const std::string& filename,
-                               const std::string& compression_type)
-    : filename_(filename), compression_type_(compression_type) {}
+                               const std::string& compression_type,
+                               bool write_record_index)
+    : filename_(filename),
+      compression_type_(compression_type),
+      write_record_index_(write_record_index) {}
 
 Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
 
-  record_writer_ = std::make_unique<io::RecordWriter>(
-      dest_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
-                       /*compression_type=*/compression_type_));
+  // Readers detect the compression of autotuned files, so any codec works.
+  // Snappy is the cheapest one that still compresses.
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions(
+          /*compression_type=*/compression_type_ == kAutotuneCompression
+              ? io::compression::kSnappy
+              : compression_type_);
+  if (write_record_index_ &&
+      options.compression_type == io::RecordWriterOptions::NONE) {
+    TF_RETURN_IF_ERROR(env->NewWritableFile(
+        absl::StrCat(filename_, io::kRecordIndexSuffix), &index_dest_));
+    options.index_file = index_dest_.get();
+  }
+  record_writer_ = std::make_unique<io::RecordWriter>(dest_.get(), options);
   return absl::OkStatus();
 }
 
@@ -187,8 +235,12 @@ Status TFRecordWriter::Close() {
     TF_RETURN_IF_ERROR(Sync());
     TF_RETURN_IF_ERROR(record_writer_->Close());
     TF_RETURN_IF_ERROR(dest_->Close());
+    if (index_dest_ != nullptr) {
+      TF_RETURN_IF_ERROR(index_dest_->Close());
+    }
     record_writer_ = nullptr;
     dest_ = nullptr;
+    index_dest_ = nullptr;
   }
   return absl::OkStatus();
 }
@@ -748,8 +800,12 @@ TFRecordReaderImpl::TFRecordReaderImpl(
 
 Status TFRecordReaderImpl::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+  std::string compression = compression_;
+  if (compression == kAutotuneCompression) {
+    TF_ASSIGN_OR_RETURN(compression, DetectTFRecordCompression(file_.get()));
+  }
   auto options = io::RecordReaderOptions::CreateRecordReaderOptions(
-      /*compression_type=*/compression_);
+      /*compression_type=*/compression);
 #if !defined(IS_SLIM_BUILD)
   if (output_buffer_size_.has_value()) {
     options.snappy_options.output_buffer_size = *output_buffer_size_;
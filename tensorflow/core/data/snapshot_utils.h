@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -62,6 +63,10 @@ constexpr char kModeRead[] = "read";
 constexpr char kModePassthrough[] = "passthrough";
 constexpr char kShardDirectorySuffix[] = ".shard";
 
+// A compression type for TFRecord snapshot files that lets the writer choose
+// the codec of each file. Readers detect the codec from the file contents.
+constexpr char kAutotuneCompression[] = "AUTOTUNE";
+
 enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2 };
 
 // Returns the name of the "hash" directory for the given base path and hash ID.
@@ -80,6 +85,12 @@ std::string ShardDirectory(const std::string& run_directory, int64_t shard_id);
 std::string GetCheckpointFileName(const std::string& shard_directory,
                                   uint64 checkpoint_id);
 
+// Returns the compression type (as defined in tsl/lib/io/compression.h) of a
+// TFRecord file, determined from its first bytes: an uncompressed file starts
+// with a record header with a valid checksum, and GZIP and ZLIB files start
+// with their stream headers. Any other non-empty file is assumed to be SNAPPY.
+absl::StatusOr<std::string> DetectTFRecordCompression(RandomAccessFile* file);
+
 // This is a interface class that exposes snapshot writing functionality.
 class Writer {
  public:
@@ -108,8 +119,11 @@ class Writer {
 // Writes snapshots with the standard TFRecord file format.
 class TFRecordWriter : public Writer {
  public:
+  // If `write_record_index` is true and the file is not compressed, also
+  // writes the record index of the file (see `io::ReadRecordIndex`).
   TFRecordWriter(const std::string& filename,
-                 const std::string& compression_type);
+                 const std::string& compression_type,
+                 bool write_record_index = false);
 
   Status Initialize(tensorflow::Env* env) override;
 
@@ -124,8 +138,10 @@ class TFRecordWriter : public Writer {
  private:
   const std::string filename_;
   const std::string compression_type_;
+  const bool write_record_index_;
 
   std::unique_ptr<WritableFile> dest_;
+  std::unique_ptr<WritableFile> index_dest_;
   std::unique_ptr<io::RecordWriter> record_writer_;
 };
 
@@ -251,7 +267,8 @@ class TFRecordReaderImpl {
   // Constructs a `TFRecordReaderImpl`.
   // `filename` is the file to read from.
   // `compression_type` is the compression method, as defined in
-  // tensorflow/tsl/lib/io/compression.h.
+  // tensorflow/tsl/lib/io/compression.h, or `kAutotuneCompression` to detect
+  // it from the file.
   // `output_buffer_size` specifies the buffer size required by Snappy/Zlib
   // compression algorithms. Ignored if compression is not enabled.
   TFRecordReaderImpl(const std::string& filename, const string& compression,
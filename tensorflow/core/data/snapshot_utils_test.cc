@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
@@ -120,6 +121,35 @@ TEST(SnapshotUtilTest, MetadataFileDoesntExist) {
   EXPECT_FALSE(file_exists);
 }
 
+TEST(SnapshotUtilTest, DetectTFRecordCompression) {
+  std::vector<Tensor> tensors;
+  tensorflow::DataTypeVector dtypes;
+  GenerateTensorVector(dtypes, tensors);
+  for (const char* compression :
+       {io::compression::kNone, io::compression::kGzip,
+        io::compression::kZlib, io::compression::kSnappy}) {
+    std::string filename = LocalTempFilename();
+    TFRecordWriter writer(filename, compression);
+    TF_ASSERT_OK(writer.Initialize(Env::Default()));
+    TF_ASSERT_OK(writer.WriteTensors(tensors));
+    TF_ASSERT_OK(writer.Close());
+
+    std::unique_ptr<RandomAccessFile> file;
+    TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+    TF_ASSERT_OK_AND_ASSIGN(std::string detected,
+                            DetectTFRecordCompression(file.get()));
+    EXPECT_EQ(detected, compression);
+
+    TFRecordReaderImpl reader(filename, kAutotuneCompression);
+    TF_ASSERT_OK(reader.Initialize(Env::Default()));
+    TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> read_tensors,
+                            reader.GetTensors());
+    ASSERT_EQ(read_tensors.size(), tensors.size());
+    EXPECT_EQ(read_tensors[0].scalar<tstring>()(),
+              tensors[0].scalar<tstring>()());
+  }
+}
+
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
   tensorflow::DataTypeVector dtypes;
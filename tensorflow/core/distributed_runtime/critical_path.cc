@@ -0,0 +1,226 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/critical_path.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+struct NodeInfo {
+  const NodeDef* def = nullptr;
+  // Names of the nodes this node waits for.
+  std::vector<string> preds;
+  bool is_transfer = false;
+  bool has_stats = false;
+  string device;
+  int64_t start_micros = 0;
+  int64_t end_micros = 0;
+};
+
+bool IsSendOp(const NodeDef& node) {
+  return node.op() == "_Send" || node.op() == "_HostSend";
+}
+
+bool IsRecvOp(const NodeDef& node) {
+  return node.op() == "_Recv" || node.op() == "_HostRecv";
+}
+
+// Returns the key matching a _Send with the _Recv of the same tensor.
+string TransferKey(const NodeDef& node) {
+  AttrSlice attrs(node);
+  return strings::StrCat(GetNodeAttrString(attrs, "send_device"), ";",
+                         GetNodeAttrString(attrs, "recv_device"), ";",
+                         GetNodeAttrString(attrs, "tensor_name"));
+}
+
+// Returns the name of the node producing `input`, e.g. "foo" for "^foo" or
+// "foo:1".
+string InputNodeName(const string& input) {
+  StringPiece name(input);
+  if (absl::ConsumePrefix(&name, "^")) return string(name);
+  const size_t colon = name.rfind(':');
+  if (colon != StringPiece::npos) name = name.substr(0, colon);
+  return string(name);
+}
+
+}  // namespace
+
+Status ComputeCriticalPath(const RunMetadata& run_metadata,
+                           CriticalPath* path) {
+  std::unordered_map<string, NodeInfo> nodes;
+  std::unordered_map<string, string> sends;  // Transfer key -> node name.
+  for (const GraphDef& graph : run_metadata.partition_graphs()) {
+    for (const NodeDef& node : graph.node()) {
+      NodeInfo& info = nodes[node.name()];
+      info.def = &node;
+      for (const string& input : node.input()) {
+        info.preds.push_back(InputNodeName(input));
+      }
+      if (IsSendOp(node)) sends[TransferKey(node)] = node.name();
+    }
+  }
+  if (nodes.empty()) {
+    return errors::InvalidArgument(
+        "Computing the critical path requires the partition graphs, see "
+        "RunOptions.output_partition_graphs");
+  }
+  for (auto& it : nodes) {
+    NodeInfo& info = it.second;
+    if (!IsRecvOp(*info.def)) continue;
+    auto send = sends.find(TransferKey(*info.def));
+    if (send != sends.end()) {
+      info.preds.push_back(send->second);
+      info.is_transfer = true;
+    }
+  }
+
+  const NodeInfo* last = nullptr;
+  for (const DeviceStepStats& ds : run_metadata.step_stats().dev_stats()) {
+    for (const NodeExecStats& ns : ds.node_stats()) {
+      auto it = nodes.find(ns.node_name());
+      // Skip stats which do not belong to a node, e.g. of RPCs.
+      if (it == nodes.end()) continue;
+      NodeInfo& info = it->second;
+      const int64_t end_micros =
+          ns.all_start_micros() +
+          std::max(ns.all_end_rel_micros(), ns.op_end_rel_micros());
+      if (info.has_stats && info.end_micros >= end_micros) continue;
+      info.has_stats = true;
+      info.device = ds.device();
+      info.start_micros = ns.all_start_micros();
+      info.end_micros = end_micros;
+      if (last == nullptr || end_micros > last->end_micros) last = &info;
+    }
+  }
+  if (last == nullptr) {
+    return errors::InvalidArgument(
+        "Computing the critical path requires the step stats, see "
+        "RunOptions.trace_level");
+  }
+
+  path->nodes.clear();
+  std::unordered_set<const NodeInfo*> visited;
+  for (const NodeInfo* current = last; current != nullptr;) {
+    visited.insert(current);
+    const NodeInfo* pred = nullptr;
+    for (const string& name : current->preds) {
+      auto it = nodes.find(name);
+      if (it == nodes.end() || !it->second.has_stats) continue;
+      const NodeInfo* candidate = &it->second;
+      // Back edges of loops may point to nodes which finished later.
+      if (visited.count(candidate) ||
+          candidate->end_micros > current->end_micros) {
+        continue;
+      }
+      if (pred == nullptr || candidate->end_micros > pred->end_micros) {
+        pred = candidate;
+      }
+    }
+    CriticalPathNode node;
+    node.node_name = current->def->name();
+    node.device = current->device;
+    node.op = current->def->op();
+    node.start_micros = current->start_micros;
+    node.end_micros = current->end_micros;
+    if (pred != nullptr) {
+      node.wait_micros =
+          std::max<int64_t>(0, current->start_micros - pred->end_micros);
+    }
+    node.is_transfer = current->is_transfer;
+    path->nodes.push_back(std::move(node));
+    current = pred;
+  }
+  std::reverse(path->nodes.begin(), path->nodes.end());
+  path->start_micros = path->nodes.front().start_micros;
+  path->end_micros = path->nodes.back().end_micros;
+  return absl::OkStatus();
+}
+
+string CriticalPathReport(const CriticalPath& path, int max_nodes) {
+  struct DeviceTotals {
+    int64_t op_micros = 0;
+    int64_t wait_micros = 0;
+    int num_nodes = 0;
+  };
+  std::unordered_map<string, DeviceTotals> totals;
+  DeviceTotals transfers;
+  for (const CriticalPathNode& node : path.nodes) {
+    DeviceTotals& t = node.is_transfer ? transfers : totals[node.device];
+    t.op_micros += node.end_micros - node.start_micros;
+    t.wait_micros += node.wait_micros;
+    ++t.num_nodes;
+  }
+  std::vector<std::pair<string, DeviceTotals>> devices(totals.begin(),
+                                                       totals.end());
+  std::sort(devices.begin(), devices.end(), [](const auto& a, const auto& b) {
+    return a.second.op_micros + a.second.wait_micros >
+           b.second.op_micros + b.second.wait_micros;
+  });
+
+  string report = strings::StrCat(
+      "Critical path: ", path.end_micros - path.start_micros, " us, ",
+      path.nodes.size(), " nodes\n");
+  auto append_totals = [&report](const string& name, const DeviceTotals& t) {
+    strings::StrAppend(&report, "  ", name, ": ", t.op_micros, " us in ",
+                       t.num_nodes, " nodes, ", t.wait_micros,
+                       " us waiting\n");
+  };
+  for (const auto& device : devices) {
+    append_totals(device.first, device.second);
+  }
+  if (transfers.num_nodes > 0) append_totals("transfers", transfers);
+
+  // Select the most expensive nodes, and list them in path order.
+  const int num_nodes = path.nodes.size();
+  std::vector<int> indices(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) indices[i] = i;
+  auto cost = [&path](int i) {
+    const CriticalPathNode& node = path.nodes[i];
+    return node.end_micros - node.start_micros + node.wait_micros;
+  };
+  if (max_nodes < num_nodes) {
+    std::nth_element(
+        indices.begin(), indices.begin() + max_nodes, indices.end(),
+        [&cost](int a, int b) { return cost(a) > cost(b); });
+    indices.resize(max_nodes);
+    std::sort(indices.begin(), indices.end());
+  }
+  for (int i : indices) {
+    const CriticalPathNode& node = path.nodes[i];
+    strings::StrAppend(&report, "  +", node.start_micros - path.start_micros,
+                       " us ", node.is_transfer ? "transfer to " : "on ",
+                       node.device, " ", node.node_name, " (", node.op, "): ",
+                       node.end_micros - node.start_micros, " us, waited ",
+                       node.wait_micros, " us\n");
+  }
+  return report;
+}
+
+}  // namespace tensorflow
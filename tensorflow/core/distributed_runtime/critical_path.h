@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_CRITICAL_PATH_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// A node on the critical path of a step.
+struct CriticalPathNode {
+  string node_name;
+  string device;
+  string op;
+  int64_t start_micros = 0;
+  int64_t end_micros = 0;
+  // Time between the end of the previous node on the path and the start of
+  // this node, e.g. spent waiting for a free inter-op thread.
+  int64_t wait_micros = 0;
+  // True for a _Recv fed by a _Send on another device: its time is the
+  // transfer of the tensor, including the wait for the RecvTensor RPC.
+  bool is_transfer = false;
+};
+
+struct CriticalPath {
+  // The nodes of the path, in execution order.
+  std::vector<CriticalPathNode> nodes;
+  int64_t start_micros = 0;
+  int64_t end_micros = 0;
+};
+
+// Reconstructs the critical path of a step from the stats and partition
+// graphs in `run_metadata`, i.e. from a step run with
+// `RunOptions.trace_level = FULL_TRACE` and `output_partition_graphs = true`.
+//
+// The path ends at the node which finished last. Walking backwards, the
+// predecessor of each node is the input (data, control, or the _Send feeding
+// a _Recv on another partition) which finished last. Nodes executed several
+// times, e.g. in loops, are represented by their last execution. Timestamps
+// from different workers are compared as is, so clock skew between machines
+// shifts the time attributed to transfers between them.
+Status ComputeCriticalPath(const RunMetadata& run_metadata,
+                           CriticalPath* path);
+
+// Returns a human-readable report of `path`: the time spent on each device
+// and in transfers, followed by the `max_nodes` nodes of the path which took
+// the most time (including their wait), in path order.
+string CriticalPathReport(const CriticalPath& path, int max_nodes);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_CRITICAL_PATH_H_
@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/critical_path.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Two partitions: "b" on task 0 is sent to task 1, where "c" waits for the
+// transfer and for "d".
+constexpr char kRunMetadata[] = R"pb(
+  partition_graphs {
+    node { name: "a" op: "Const" }
+    node { name: "b" op: "MatMul" input: "a" input: "a:0" }
+    node {
+      name: "send"
+      op: "_Send"
+      input: "b"
+      attr {
+        key: "send_device"
+        value { s: "/job:worker/replica:0/task:0/device:CPU:0" }
+      }
+      attr {
+        key: "recv_device"
+        value { s: "/job:worker/replica:0/task:1/device:CPU:0" }
+      }
+      attr {
+        key: "tensor_name"
+        value { s: "edge_1_b" }
+      }
+    }
+  }
+  partition_graphs {
+    node {
+      name: "recv"
+      op: "_Recv"
+      attr {
+        key: "send_device"
+        value { s: "/job:worker/replica:0/task:0/device:CPU:0" }
+      }
+      attr {
+        key: "recv_device"
+        value { s: "/job:worker/replica:0/task:1/device:CPU:0" }
+      }
+      attr {
+        key: "tensor_name"
+        value { s: "edge_1_b" }
+      }
+    }
+    node { name: "d" op: "Const" }
+    node { name: "c" op: "Identity" input: "recv" input: "^d" }
+  }
+  step_stats {
+    dev_stats {
+      device: "/job:worker/replica:0/task:0/device:CPU:0"
+      node_stats { node_name: "a" all_start_micros: 0 all_end_rel_micros: 10 }
+      node_stats { node_name: "b" all_start_micros: 10 all_end_rel_micros: 40 }
+      node_stats {
+        node_name: "send"
+        all_start_micros: 60
+        all_end_rel_micros: 2
+      }
+    }
+    dev_stats {
+      device: "/job:worker/replica:0/task:1/device:CPU:0"
+      node_stats { node_name: "d" all_start_micros: 0 all_end_rel_micros: 5 }
+      node_stats {
+        node_name: "recv"
+        all_start_micros: 5
+        all_end_rel_micros: 75
+      }
+      node_stats { node_name: "c" all_start_micros: 85 all_end_rel_micros: 15 }
+    }
+  }
+)pb";
+
+TEST(CriticalPathTest, FollowsTransfers) {
+  RunMetadata run_metadata;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(kRunMetadata,
+                                                    &run_metadata));
+  CriticalPath path;
+  TF_ASSERT_OK(ComputeCriticalPath(run_metadata, &path));
+
+  std::vector<string> names;
+  for (const CriticalPathNode& node : path.nodes) {
+    names.push_back(node.node_name);
+  }
+  EXPECT_EQ(names, std::vector<string>({"a", "b", "send", "recv", "c"}));
+  EXPECT_EQ(path.start_micros, 0);
+  EXPECT_EQ(path.end_micros, 100);
+  EXPECT_EQ(path.nodes[1].wait_micros, 0);
+  EXPECT_EQ(path.nodes[2].wait_micros, 10);
+  EXPECT_TRUE(path.nodes[3].is_transfer);
+  EXPECT_EQ(path.nodes[4].wait_micros, 5);
+  EXPECT_FALSE(path.nodes[4].is_transfer);
+
+  const string report = CriticalPathReport(path, /*max_nodes=*/2);
+  EXPECT_NE(report.find("Critical path: 100 us, 5 nodes"), string::npos)
+      << report;
+  EXPECT_NE(report.find("transfers: 75 us in 1 nodes"), string::npos)
+      << report;
+  // Only "recv" and "b" are listed.
+  EXPECT_NE(report.find("+5 us transfer to"), string::npos) << report;
+  EXPECT_NE(report.find("+10 us on"), string::npos) << report;
+  EXPECT_EQ(report.find("(Identity)"), string::npos) << report;
+}
+
+TEST(CriticalPathTest, RequiresPartitionGraphs) {
+  RunMetadata run_metadata;
+  CriticalPath path;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(ComputeCriticalPath(run_metadata, &path)));
+}
+
+}  // namespace
+}  // namespace tensorflow
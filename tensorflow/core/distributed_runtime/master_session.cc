@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
+#include "tensorflow/core/distributed_runtime/critical_path.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -63,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/tracing.h"
 #include "tsl/protobuf/coordination_config.pb.h"
 
@@ -227,6 +229,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
                     const RunOptions& options, RunMetadata* resp);
   void ProcessDeviceStats(ProfileHandler* ph, const DeviceStepStats& ds,
                           bool is_rpc);
+  // If the TF_MASTER_LOG_CRITICAL_PATH environment variable is true, logs the
+  // critical path of a step traced with its partition graphs.
+  void LogCriticalPath(int64_t step_id, const RunMetadata& run_metadata);
   // Checks that the requested fetches can be computed from the provided feeds.
   Status CheckFetches(const RunStepRequestWrapper& req,
                       const RunState* run_state,
@@ -982,6 +987,7 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64_t step_id,
     // down calls that trigger the automatic profiling.
     if (options.trace_level() == RunOptions::FULL_TRACE) {
       resp->mutable_step_stats()->Swap(&step_stats_proto);
+      LogCriticalPath(step_id, *resp);
     } else {
       // If FULL_TRACE, it can be fetched from Session API, no need for
       // duplicated publishing.
@@ -990,6 +996,26 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64_t step_id,
   }
 }
 
+void MasterSession::ReffedClientGraph::LogCriticalPath(
+    int64_t step_id, const RunMetadata& run_metadata) {
+  static const bool log_critical_path = []() {
+    bool value;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_MASTER_LOG_CRITICAL_PATH", false, &value));
+    return value;
+  }();
+  if (!log_critical_path) return;
+  CriticalPath path;
+  Status s = ComputeCriticalPath(run_metadata, &path);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to compute the critical path of step " << step_id
+                 << ": " << s;
+    return;
+  }
+  LOG(INFO) << "Step " << step_id << ": "
+            << CriticalPathReport(path, /*max_nodes=*/20);
+}
+
 void MasterSession::ReffedClientGraph::ProcessDeviceStats(
     ProfileHandler* ph, const DeviceStepStats& ds, bool is_rpc) {
   const string& dev_name = ds.device();
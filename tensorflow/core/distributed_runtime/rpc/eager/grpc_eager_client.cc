@@ -16,16 +16,21 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "xla/tsl/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
@@ -74,6 +79,18 @@ bool EnableStreaming() {
   return result;
 }
 
+// Returns the maximum number of queue items merged into one streaming
+// EnqueueRequest, or 0 if requests are not merged.
+int64_t MaxEnqueueBatchItems() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_SIZE", 0,
+                                  &result));
+  return result;
+}
+
+using GrpcEnqueueBatcher =
+    EnqueueBatcher<StreamingRPCDispatcher<EnqueueResponse>>;
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -208,9 +225,13 @@ class GrpcEagerClient : public EagerClient {
 
     mutex_lock l(mu_);
     const auto& it = enqueue_dispatchers_.find(request->context_id());
+    const auto& batcher = enqueue_batchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
       it->second.CancelCall();
       enqueue_dispatchers_.erase(it);
+    } else if (batcher != enqueue_batchers_.end()) {
+      batcher->second->CancelCall();
+      enqueue_batchers_.erase(batcher);
     } else if (EnableStreaming()) {
       LOG(ERROR) << "Remote EagerContext with id " << request->context_id()
                  << " does not seem to exist.";
@@ -227,7 +248,23 @@ class GrpcEagerClient : public EagerClient {
     // 1. The global env variable, as checked in EnableStreaming().
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
-    if (EnableStreaming() && enable_streaming_enqueue) {
+    if (EnableStreaming() && enable_streaming_enqueue &&
+        max_enqueue_batch_items_ > 0) {
+      core::RefCountPtr<GrpcEnqueueBatcher> batcher;
+      {
+        mutex_lock l(mu_);
+        auto& entry = enqueue_batchers_[request->context_id()];
+        if (entry == nullptr) {
+          entry.reset(new GrpcEnqueueBatcher(
+              std::make_unique<StreamingRPCDispatcher<EnqueueResponse>>(
+                  &stub_, cq_,
+                  "/tensorflow.eager.EagerService/StreamingEnqueue"),
+              max_enqueue_batch_items_));
+        }
+        batcher = entry.GetNewRef();
+      }
+      batcher->Add(*request, response, std::move(done_wrapped));
+    } else if (EnableStreaming() && enable_streaming_enqueue) {
       mutex_lock l(mu_);
       auto it = enqueue_dispatchers_.find(request->context_id());
       if (it == enqueue_dispatchers_.end()) {
@@ -265,6 +302,10 @@ class GrpcEagerClient : public EagerClient {
 
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  // Used instead of `enqueue_dispatchers_` when requests are merged.
+  std::unordered_map<uint64, core::RefCountPtr<GrpcEnqueueBatcher>>
+      enqueue_batchers_ TF_GUARDED_BY(mu_);
+  const int64_t max_enqueue_batch_items_ = MaxEnqueueBatchItems();
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
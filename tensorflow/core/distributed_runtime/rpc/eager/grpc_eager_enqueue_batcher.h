@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_GRPC_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_GRPC_EAGER_ENQUEUE_BATCHER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Streams the EnqueueRequests of one remote context, merging the requests
+// which are issued while earlier ones are in flight. A stream of ops is then
+// sent as a few large messages, each processed in one go by the server, rather
+// than as one message per op. Requests are sent in the order they are added.
+//
+// The server stops at the first failing item of a merged request, so an error
+// is reported to all the requests merged with the failing one.
+//
+// `Dispatcher` sends the merged requests in order, like a
+// StreamingRPCDispatcher<EnqueueResponse>. It must provide
+//   void SendNextRequest(const EnqueueRequest&, EnqueueResponse*,
+//                        StatusCallback);
+//   void CancelCall();
+template <class Dispatcher>
+class EnqueueBatcher : public core::RefCounted {
+ public:
+  EnqueueBatcher(std::unique_ptr<Dispatcher> dispatcher,
+                 int64_t max_batch_items)
+      : dispatcher_(std::move(dispatcher)),
+        max_batch_items_(max_batch_items) {}
+
+  void Add(const EnqueueRequest& request, EnqueueResponse* response,
+           StatusCallback done) {
+    {
+      mutex_lock l(mu_);
+      if (pending_ == nullptr) {
+        pending_ = std::make_shared<Batch>();
+        pending_->request.set_context_id(request.context_id());
+      }
+      for (const QueueItem& item : request.queue()) {
+        *pending_->request.add_queue() = item;
+      }
+      pending_->calls.push_back(
+          {response, request.queue_size(), std::move(done)});
+      // Wait for more requests while earlier batches are in flight.
+      if (num_in_flight_ > 0 &&
+          pending_->request.queue_size() < max_batch_items_) {
+        return;
+      }
+      if (!MakePendingReadyLocked()) return;
+    }
+    SendReady();
+  }
+
+  void CancelCall() { dispatcher_->CancelCall(); }
+
+ private:
+  struct Call {
+    EnqueueResponse* response;
+    int num_items;
+    StatusCallback done;
+  };
+
+  struct Batch {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<Call> calls;
+  };
+
+  // Moves `pending_` to `ready_`. Returns true if the caller must send the
+  // ready batches, i.e. if no other thread is sending them.
+  bool MakePendingReadyLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ready_.push_back(std::move(pending_));
+    ++num_in_flight_;
+    if (sending_) return false;
+    sending_ = true;
+    return true;
+  }
+
+  // Sends the batches in `ready_` until it is empty. `done` of a batch may be
+  // called inline, so `mu_` is not held while sending.
+  void SendReady() {
+    while (true) {
+      std::shared_ptr<Batch> batch;
+      {
+        mutex_lock l(mu_);
+        if (ready_.empty()) {
+          sending_ = false;
+          return;
+        }
+        batch = std::move(ready_.front());
+        ready_.pop_front();
+      }
+      Ref();
+      dispatcher_->SendNextRequest(batch->request, &batch->response,
+                                   [this, batch](const Status& status) {
+                                     BatchDone(batch.get(), status);
+                                     Unref();
+                                   });
+    }
+  }
+
+  void BatchDone(Batch* batch, const Status& status) {
+    bool send = false;
+    {
+      mutex_lock l(mu_);
+      --num_in_flight_;
+      if (pending_ != nullptr) send = MakePendingReadyLocked();
+    }
+    if (send) SendReady();
+
+    int offset = 0;
+    for (Call& call : batch->calls) {
+      Status s = status;
+      if (s.ok() &&
+          batch->response.queue_response_size() < offset + call.num_items) {
+        s = errors::Internal("Expected ", offset + call.num_items,
+                             " queue responses to a merged EnqueueRequest, "
+                             "got ",
+                             batch->response.queue_response_size());
+      }
+      if (s.ok()) {
+        for (int i = 0; i < call.num_items; ++i) {
+          call.response->add_queue_response()->Swap(
+              batch->response.mutable_queue_response(offset + i));
+        }
+      }
+      offset += call.num_items;
+      call.done(s);
+    }
+  }
+
+  const std::unique_ptr<Dispatcher> dispatcher_;
+  const int64_t max_batch_items_;
+
+  mutex mu_;
+  // Requests added while batches are in flight.
+  std::shared_ptr<Batch> pending_ TF_GUARDED_BY(mu_);
+  // Batches to send, in order.
+  std::deque<std::shared_ptr<Batch>> ready_ TF_GUARDED_BY(mu_);
+  int64_t num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // True while a thread is running SendReady().
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_GRPC_EAGER_ENQUEUE_BATCHER_H_
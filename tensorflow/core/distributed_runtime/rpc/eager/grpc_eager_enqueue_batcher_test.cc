@@ -0,0 +1,230 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_enqueue_batcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+constexpr uint64 kContextId = 42;
+
+// Records the requests instead of sending them, so that the test decides when
+// and how each of them completes.
+class FakeDispatcher {
+ public:
+  struct Sent {
+    EnqueueRequest request;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  void SendNextRequest(const EnqueueRequest& request,
+                       EnqueueResponse* response, StatusCallback done) {
+    sent.push_back({request, response, std::move(done)});
+  }
+
+  void CancelCall() { ++num_cancels; }
+
+  std::vector<Sent> sent;
+  int num_cancels = 0;
+};
+
+// A request with the operations `first_id`, ..., `first_id + num_items - 1`.
+EnqueueRequest MakeRequest(int first_id, int num_items) {
+  EnqueueRequest request;
+  request.set_context_id(kContextId);
+  for (int i = 0; i < num_items; ++i) {
+    request.add_queue()->mutable_operation()->set_id(first_id + i);
+  }
+  return request;
+}
+
+// Returns the ids of the operations in `request`.
+std::vector<int64_t> OperationIds(const EnqueueRequest& request) {
+  std::vector<int64_t> ids;
+  for (const QueueItem& item : request.queue()) {
+    ids.push_back(item.operation().id());
+  }
+  return ids;
+}
+
+// Returns the ids which `Respond` wrote to the devices of the responses.
+std::vector<std::string> ResponseIds(const EnqueueResponse& response) {
+  std::vector<std::string> ids;
+  for (const QueueResponse& queue_response : response.queue_response()) {
+    ids.push_back(queue_response.device(0));
+  }
+  return ids;
+}
+
+class EnqueueBatcherTest : public ::testing::Test {
+ protected:
+  void Create(int64_t max_batch_items) {
+    auto dispatcher = std::make_unique<FakeDispatcher>();
+    dispatcher_ = dispatcher.get();
+    batcher_.reset(new EnqueueBatcher<FakeDispatcher>(std::move(dispatcher),
+                                                      max_batch_items));
+  }
+
+  // Adds a request and records its status in `statuses_[index]`.
+  void Add(const EnqueueRequest& request, int index) {
+    batcher_->Add(request, &responses_[index],
+                  [this, index](const Status& s) { statuses_[index] = s; });
+  }
+
+  // Completes the `i`-th sent request with `status`, after answering its first
+  // `num_responses` items with their operation ids, or all if negative.
+  void Respond(int i, const Status& status, int num_responses = -1) {
+    ASSERT_LT(i, static_cast<int>(dispatcher_->sent.size()));
+    const EnqueueRequest& request = dispatcher_->sent[i].request;
+    EnqueueResponse* response = dispatcher_->sent[i].response;
+    if (num_responses < 0) num_responses = request.queue_size();
+    for (int j = 0; j < num_responses; ++j) {
+      response->add_queue_response()->add_device(
+          absl::StrCat(request.queue(j).operation().id()));
+    }
+    // Completing a batch may send the next one, which grows `sent`.
+    StatusCallback done = std::move(dispatcher_->sent[i].done);
+    done(status);
+  }
+
+  void TearDown() override {
+    // The batches still in flight hold a reference to the batcher.
+    if (dispatcher_ == nullptr) return;
+    for (int i = 0; i < dispatcher_->sent.size(); ++i) {
+      if (dispatcher_->sent[i].done) Respond(i, errors::Cancelled("Test done"));
+    }
+  }
+
+  FakeDispatcher* dispatcher_ = nullptr;
+  core::RefCountPtr<EnqueueBatcher<FakeDispatcher>> batcher_;
+  EnqueueResponse responses_[4];
+  Status statuses_[4] = {errors::Unknown("not done"),
+                         errors::Unknown("not done"),
+                         errors::Unknown("not done"),
+                         errors::Unknown("not done")};
+};
+
+TEST_F(EnqueueBatcherTest, SendsImmediatelyWhenIdle) {
+  Create(/*max_batch_items=*/100);
+  Add(MakeRequest(/*first_id=*/0, /*num_items=*/2), 0);
+  ASSERT_EQ(dispatcher_->sent.size(), 1);
+  EXPECT_EQ(dispatcher_->sent[0].request.context_id(), kContextId);
+  EXPECT_EQ(OperationIds(dispatcher_->sent[0].request),
+            std::vector<int64_t>({0, 1}));
+
+  Respond(0, OkStatus());
+  TF_EXPECT_OK(statuses_[0]);
+  EXPECT_EQ(ResponseIds(responses_[0]), std::vector<std::string>({"0", "1"}));
+
+  // Nothing is in flight anymore, so the next request is sent on its own.
+  Add(MakeRequest(/*first_id=*/2, /*num_items=*/1), 1);
+  ASSERT_EQ(dispatcher_->sent.size(), 2);
+  EXPECT_EQ(OperationIds(dispatcher_->sent[1].request),
+            std::vector<int64_t>({2}));
+}
+
+TEST_F(EnqueueBatcherTest, MergesRequestsWhileInFlight) {
+  Create(/*max_batch_items=*/100);
+  Add(MakeRequest(/*first_id=*/0, /*num_items=*/1), 0);
+  Add(MakeRequest(/*first_id=*/1, /*num_items=*/2), 1);
+  Add(MakeRequest(/*first_id=*/3, /*num_items=*/1), 2);
+  ASSERT_EQ(dispatcher_->sent.size(), 1);
+
+  // The requests added in the meantime are sent as one, in order.
+  Respond(0, OkStatus());
+  TF_EXPECT_OK(statuses_[0]);
+  ASSERT_EQ(dispatcher_->sent.size(), 2);
+  EXPECT_EQ(OperationIds(dispatcher_->sent[1].request),
+            std::vector<int64_t>({1, 2, 3}));
+  EXPECT_FALSE(statuses_[1].ok());
+  EXPECT_FALSE(statuses_[2].ok());
+
+  // Its responses are split back per request.
+  Respond(1, OkStatus());
+  TF_EXPECT_OK(statuses_[1]);
+  TF_EXPECT_OK(statuses_[2]);
+  EXPECT_EQ(ResponseIds(responses_[1]), std::vector<std::string>({"1", "2"}));
+  EXPECT_EQ(ResponseIds(responses_[2]), std::vector<std::string>({"3"}));
+}
+
+TEST_F(EnqueueBatcherTest, SendsFullBatchWithoutWaiting) {
+  Create(/*max_batch_items=*/2);
+  Add(MakeRequest(/*first_id=*/0, /*num_items=*/1), 0);
+  Add(MakeRequest(/*first_id=*/1, /*num_items=*/1), 1);
+  EXPECT_EQ(dispatcher_->sent.size(), 1);
+  Add(MakeRequest(/*first_id=*/2, /*num_items=*/1), 2);
+  ASSERT_EQ(dispatcher_->sent.size(), 2);
+  EXPECT_EQ(OperationIds(dispatcher_->sent[1].request),
+            std::vector<int64_t>({1, 2}));
+
+  // Both batches are in flight, so the next request waits for one of them.
+  Add(MakeRequest(/*first_id=*/3, /*num_items=*/1), 3);
+  EXPECT_EQ(dispatcher_->sent.size(), 2);
+  Respond(0, OkStatus());
+  ASSERT_EQ(dispatcher_->sent.size(), 3);
+  EXPECT_EQ(OperationIds(dispatcher_->sent[2].request),
+            std::vector<int64_t>({3}));
+}
+
+TEST_F(EnqueueBatcherTest, ReportsErrorToAllMergedRequests) {
+  Create(/*max_batch_items=*/100);
+  Add(MakeRequest(/*first_id=*/0, /*num_items=*/1), 0);
+  Add(MakeRequest(/*first_id=*/1, /*num_items=*/1), 1);
+  Add(MakeRequest(/*first_id=*/2, /*num_items=*/1), 2);
+  Respond(0, OkStatus());
+  Respond(1, errors::InvalidArgument("bad op"), /*num_responses=*/0);
+  TF_EXPECT_OK(statuses_[0]);
+  EXPECT_TRUE(errors::IsInvalidArgument(statuses_[1]));
+  EXPECT_TRUE(errors::IsInvalidArgument(statuses_[2]));
+  EXPECT_EQ(responses_[1].queue_response_size(), 0);
+  EXPECT_EQ(responses_[2].queue_response_size(), 0);
+}
+
+TEST_F(EnqueueBatcherTest, MissingResponsesAreAnError) {
+  Create(/*max_batch_items=*/100);
+  Add(MakeRequest(/*first_id=*/0, /*num_items=*/1), 0);
+  Add(MakeRequest(/*first_id=*/1, /*num_items=*/1), 1);
+  Add(MakeRequest(/*first_id=*/2, /*num_items=*/2), 2);
+  Respond(0, OkStatus());
+  Respond(1, OkStatus(), /*num_responses=*/2);
+  TF_EXPECT_OK(statuses_[1]);
+  EXPECT_EQ(ResponseIds(responses_[1]), std::vector<std::string>({"1"}));
+  EXPECT_TRUE(errors::IsInternal(statuses_[2]));
+}
+
+TEST_F(EnqueueBatcherTest, CancelCallCancelsDispatcher) {
+  Create(/*max_batch_items=*/100);
+  batcher_->CancelCall();
+  EXPECT_EQ(dispatcher_->num_cancels, 1);
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -50,6 +50,12 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Copying a ByteBuffer only takes references on its slices, which keep the
+  // received bytes alive.
+  std::shared_ptr<const void> RetainContents() override {
+    return std::make_shared<const ::grpc::ByteBuffer>(*buffer_);
+  }
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -145,6 +145,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(CompleteInstance, 10, true);
     SETUP_FOR_REQUEST(GetStepSequence, 10, true);
     SETUP_FOR_REQUEST(RecvBuf, 500, true);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
@@ -284,6 +285,25 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -434,6 +454,44 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = std::make_unique<RpcResponseCache>();
 }
 
+namespace {
+// Calls `done` with `val`, after copying it to host memory if it was produced
+// in the memory of an accelerator, so that it can be encoded on the wire.
+void CopyToHostIfNeeded(
+    Device* src_dev, const Rendezvous::Args& send_args, int64_t step_id,
+    const string& key, const Tensor& val, bool is_dead,
+    std::function<void(const Tensor&, bool, const Status&)> done) {
+  const bool on_host = send_args.alloc_attrs.on_host();
+  if (!src_dev->tensorflow_accelerator_device_info() || on_host) {
+    done(val, is_dead, absl::OkStatus());
+    return;
+  }
+
+  DeviceContext* send_dev_context = send_args.device_context;
+  AllocatorAttributes alloc_attrs;
+  alloc_attrs.set_gpu_compatible(true);
+  alloc_attrs.set_on_host(true);
+  tsl::profiler::ScopedMemoryDebugAnnotation op_annotation(
+      "GrpcWorker::RecvTensorAsync::consumer_callback", step_id, "dynamic",
+      val.dtype(), [shape = val.shape()]() { return shape.DebugString(); });
+  Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+  Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+  CHECK(send_dev_context)
+      << "send dev name: " << src_dev->name()
+      << " gpu_info: " << src_dev->tensorflow_accelerator_device_info();
+
+  StatusCallback copy_ready = [done = std::move(done), copy,
+                               is_dead](const Status& s) {
+    // The value is now ready to be returned on the wire.
+    done(*copy, is_dead, s);
+    delete copy;
+  };
+
+  CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy, send_dev_context,
+                   copy_ready);
+}
+}  // namespace
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -523,37 +581,110 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
           return rendezvous_done(val, is_dead, status);
         }
 
-        const bool on_host = send_args.alloc_attrs.on_host();
-        if (!src_dev->tensorflow_accelerator_device_info() || on_host) {
-          return rendezvous_done(val, is_dead, status);
-        }
-
-        DeviceContext* send_dev_context = send_args.device_context;
-        AllocatorAttributes alloc_attrs;
-        alloc_attrs.set_gpu_compatible(true);
-        alloc_attrs.set_on_host(true);
-        tsl::profiler::ScopedMemoryDebugAnnotation op_annotation(
-            "GrpcWorker::RecvTensorAsync::consumer_callback",
-            request->step_id(), "dynamic", val.dtype(),
-            [shape = val.shape()]() { return shape.DebugString(); });
-        Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
-        Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
-        CHECK(send_dev_context)
-            << "send dev name: " << src_dev->name()
-            << " gpu_info: " << src_dev->tensorflow_accelerator_device_info();
-
-        StatusCallback copy_ready = [rendezvous_done, copy,
-                                     is_dead](const Status& s) {
-          // The value is now ready to be returned on the wire.
-          rendezvous_done(*copy, is_dead, s);
-          delete copy;
-        };
-
-        CopyDeviceToHost(&val, alloc, alloc, request->rendezvous_key(), src_dev,
-                         copy, send_dev_context, copy_ready);
+        CopyToHostIfNeeded(src_dev, send_args, request->step_id(),
+                           request->rendezvous_key(), val, is_dead,
+                           rendezvous_done);
       });
 }
 
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int num_tensors = request->request_size();
+  if (num_tensors == 0) {
+    done(absl::OkStatus());
+    return;
+  }
+  const int64_t step_id = request->request(0).step_id();
+
+  // Validate all the requests before starting any rendezvous, so that a bad
+  // request does not leave the other tensors received but never returned.
+  std::vector<Rendezvous::ParsedKey> parsed(num_tensors);
+  std::vector<Device*> src_devs(num_tensors, nullptr);
+  for (int i = 0; i < num_tensors; ++i) {
+    const RecvTensorRequest& req = request->request(i);
+    Status s;
+    if (req.step_id() != step_id) {
+      s = errors::InvalidArgument("RecvTensorBatch requests must all have ",
+                                  "step_id ", step_id, ", got ",
+                                  req.step_id());
+    }
+    if (s.ok()) {
+      s = recent_request_ids_.TrackUnique(
+          req.request_id(), "RecvTensorBatch (GrpcWorker)", req);
+    }
+    if (s.ok()) {
+      TRACEPRINTF("RecvTensorBatch: %lld %s", step_id,
+                  req.rendezvous_key().c_str());
+      s = Rendezvous::ParseKey(req.rendezvous_key(), &parsed[i]);
+    }
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_devs[i]);
+    }
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+  }
+
+  // Every response is added up front, so that the callbacks below fill in
+  // distinct elements of `response` concurrently.
+  for (int i = 0; i < num_tensors; ++i) {
+    response->add_response();
+  }
+  struct BatchState {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<BatchState>();
+  {
+    mutex_lock l(state->mu);
+    state->pending = num_tensors;
+  }
+
+  // As in `GrpcRecvTensorAsync()`, a cancellation of the RPC aborts the step.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensorBatch cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  for (int i = 0; i < num_tensors; ++i) {
+    auto tensor_done = [opts, response, done, state, i](
+                           const Tensor& tensor, bool is_dead,
+                           const Status& status) {
+      if (status.ok()) {
+        RecvTensorResponse* resp = response->mutable_response(i);
+        resp->set_is_dead(is_dead);
+        resp->set_send_start_micros(Env::Default()->NowMicros());
+        tensor.AsProtoTensorContent(resp->mutable_tensor());
+      }
+      Status batch_status;
+      {
+        mutex_lock l(state->mu);
+        state->status.Update(status);
+        if (--state->pending > 0) return;
+        batch_status = state->status;
+      }
+      opts->ClearCancelCallback();
+      done(batch_status);
+    };
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, parsed[i],
+        [src_dev = src_devs[i], request, i, tensor_done](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& val,
+            const bool is_dead) {
+          if (!status.ok()) {
+            return tensor_done(val, is_dead, status);
+          }
+          CopyToHostIfNeeded(src_dev, send_args, request->request(i).step_id(),
+                             request->request(i).rendezvous_key(), val,
+                             is_dead, tensor_done);
+        });
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
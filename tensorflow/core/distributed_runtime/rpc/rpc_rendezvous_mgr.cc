@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -31,15 +36,21 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+class RpcRecvTensorBatch;
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      int64_t batch_window_micros)
+      : BaseRemoteRendezvous(env, step_id),
+        batch_window_micros_(batch_window_micros) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +60,22 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Adds `call` to the pending batch of calls to its source worker. The batch
+  // is issued `batch_window_micros_` after its first call was added.
+  void EnqueueBatchedCall(RpcRecvTensorCall* call,
+                          std::function<void()> recv_done);
+
+  // Issues the pending batch of calls to `src_worker`.
+  void FlushBatch(const string& src_worker);
+
+  // If positive, recvs from the same worker that start within this many
+  // microseconds of each other are issued as a single RecvTensorBatch RPC.
+  const int64_t batch_window_micros_;
+
+  mutex batch_mu_;
+  absl::flat_hash_map<string, RpcRecvTensorBatch*> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -131,6 +158,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   const Rendezvous::DoneCallback& done() const { return done_; }
 
  private:
+  friend class RpcRecvTensorBatch;
   friend class RpcRemoteRendezvous;
 
   // Start the main RecvTensor call, checking for an async abort.
@@ -185,6 +213,118 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   void operator=(const RpcRecvTensorCall&) = delete;
 };
 
+// Workers that returned Unimplemented for a RecvTensorBatch RPC, e.g. because
+// they run an older version of TensorFlow. Recvs from them are never batched.
+class UnbatchedWorkers {
+ public:
+  static bool Contains(const string& worker) {
+    UnbatchedWorkers* workers = Get();
+    mutex_lock l(workers->mu_);
+    return workers->workers_.contains(worker);
+  }
+
+  static void Insert(const string& worker) {
+    UnbatchedWorkers* workers = Get();
+    mutex_lock l(workers->mu_);
+    workers->workers_.insert(worker);
+  }
+
+ private:
+  static UnbatchedWorkers* Get() {
+    static UnbatchedWorkers* workers = new UnbatchedWorkers;
+    return workers;
+  }
+
+  mutex mu_;
+  absl::flat_hash_set<string> workers_ TF_GUARDED_BY(mu_);
+};
+
+// A set of RpcRecvTensorCalls to the same worker in the same step, which are
+// issued as a single RecvTensorBatch RPC. Deletes itself once the callbacks
+// of all its calls have run.
+class RpcRecvTensorBatch {
+ public:
+  explicit RpcRecvTensorBatch(const string& src_worker)
+      : src_worker_(src_worker) {}
+
+  void Add(RpcRecvTensorCall* call, std::function<void()> recv_done) {
+    call->resp_.InitAlloc(call->dst_device_, call->alloc_attrs_);
+    *req_.add_request() = call->req_;
+    calls_.emplace_back(call, std::move(recv_done));
+  }
+
+  void Start() {
+    // An abort of any call cancels the whole RPC. The rendezvous aborts all
+    // its calls at once, so this is no worse than cancelling them one by one.
+    for (auto& call : calls_) {
+      call.first->opts_.SetCancelCallback([this]() { opts_.StartCancel(); });
+    }
+    auto abort_checked = std::make_shared<Notification>();
+    // All the calls use the same worker, so any of them can issue the RPC.
+    calls_.front().first->wi_->RecvTensorBatchAsync(
+        &opts_, &req_, &resp_, [this, abort_checked](const Status& s) {
+          // As in RpcRecvTensorCall::StartRTCall(), wait for the abort check
+          // before running the callbacks, which delete this object.
+          abort_checked->WaitForNotification();
+          Done(s);
+        });
+
+    // Check for calls aborted before the RPC registered its cancellation to
+    // `opts_`.
+    for (auto& call : calls_) {
+      if (!call.first->status().ok()) {
+        opts_.StartCancel();
+        break;
+      }
+    }
+    abort_checked->Notify();
+  }
+
+ private:
+  void Done(const Status& s) {
+    for (auto& call : calls_) {
+      call.first->opts_.ClearCancelCallback();
+    }
+    if (errors::IsUnimplemented(s)) {
+      VLOG(1) << "Worker " << src_worker_
+              << " does not support RecvTensorBatch, falling back to "
+                 "RecvTensor";
+      UnbatchedWorkers::Insert(src_worker_);
+      for (auto& call : calls_) {
+        call.first->Start(std::move(call.second));
+      }
+      delete this;
+      return;
+    }
+    const int num_calls = calls_.size();
+    Status status = s;
+    if (status.ok() && resp_.response_size() != num_calls) {
+      status = errors::Internal("RecvTensorBatch returned ",
+                                resp_.response_size(), " tensors, expected ",
+                                num_calls);
+    }
+    for (int i = 0; i < num_calls; ++i) {
+      RpcRecvTensorCall* call = calls_[i].first;
+      Status call_status = status;
+      if (call_status.ok()) {
+        call_status = call->resp_.InitFrom(resp_.mutable_response(i));
+      }
+      if (!call_status.ok()) {
+        mutex_lock l(call->mu_);
+        call->status_.Update(call_status);
+      }
+      calls_[i].second();
+    }
+    delete this;
+  }
+
+  const string src_worker_;
+  std::vector<std::pair<RpcRecvTensorCall*, std::function<void()>>> calls_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+};
+
 class RpcRecvTensorFreeList {
  public:
   RpcRecvTensorFreeList() {}
@@ -289,7 +429,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  auto recv_done = [this, call, recv_args, worker_cache]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -302,18 +442,54 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
-  });
+  };
+  if (batch_window_micros_ > 0 &&
+      !UnbatchedWorkers::Contains(call->src_worker_)) {
+    EnqueueBatchedCall(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::EnqueueBatchedCall(RpcRecvTensorCall* call,
+                                             std::function<void()> recv_done) {
+  mutex_lock l(batch_mu_);
+  RpcRecvTensorBatch*& batch = pending_batches_[call->src_worker_];
+  if (batch == nullptr) {
+    batch = new RpcRecvTensorBatch(call->src_worker_);
+    Ref();
+    SchedNonBlockingClosureAfter(
+        batch_window_micros_, [this, src_worker = call->src_worker_]() {
+          FlushBatch(src_worker);
+          Unref();
+        });
+  }
+  batch->Add(call, std::move(recv_done));
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker) {
+  RpcRecvTensorBatch* batch;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    batch = it->second;
+    pending_batches_.erase(it);
+  }
+  batch->Start();
 }
 
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env) {
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_US", 0,
+                                  &batch_window_micros_));
+}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, batch_window_micros_));
 }
 
 }  // end namespace tensorflow
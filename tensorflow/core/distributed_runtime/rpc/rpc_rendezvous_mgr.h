@@ -42,6 +42,12 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If the TF_RPC_RECV_TENSOR_BATCH_WINDOW_US environment variable is positive,
+// the recvs of a step from the same remote worker which start within that many
+// microseconds of each other are issued as a single RecvTensorBatch RPC. This
+// saves RPC overhead when a step reads many small tensors, e.g. variables
+// from a parameter server, at the cost of this delay on every remote recv.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
@@ -51,6 +57,8 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  int64_t batch_window_micros_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
@@ -15,13 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,10 +72,31 @@ class DummyWorker : public TestWorkerInterface {
       done(absl::OkStatus());
     });
   }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    ++num_batches_;
+    for (int i = 0; i < request->request_size(); ++i) {
+      V("batched").AsProtoTensorContent(
+          response->add_response()->mutable_tensor());
+    }
+    SchedClosure([done = std::move(done)]() { done(absl::OkStatus()); });
+  }
+
+  int num_batches() const { return num_batches_; }
+
+ private:
+  std::atomic<int> num_batches_{0};
 };
 
 // Fake cache implementation for WorkerEnv.
 class DummyWorkerCache : public WorkerCacheInterface {
+ public:
+  DummyWorker* dummy_remote_worker() const { return dummy_remote_worker_; }
+
+ private:
   void ListWorkers(std::vector<string>* workers) const override {}
   void ListWorkersInJob(const string& job_name,
                         std::vector<string>* workers) const override {}
@@ -104,7 +131,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return absl::OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -342,4 +371,47 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatched) {
+  setenv("TF_RPC_RECV_TENSOR_BATCH_WINDOW_US", "100000", /*overwrite=*/1);
+  RpcRendezvousMgr rmgr(&env);
+  unsetenv("TF_RPC_RECV_TENSOR_BATCH_WINDOW_US");
+  const int64_t step_id = 123;
+  const int num_recvs = 10;
+  {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Rendezvous::Args args;
+
+    mutex mu;
+    Status status = absl::OkStatus();
+    std::vector<Tensor> vals(num_recvs);
+    BlockingCounter counter(num_recvs);
+    for (int i = 0; i < num_recvs; ++i) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          key, args,
+          [&mu, &status, &vals, &counter, i](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              vals[i] = val;
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    for (const Tensor& val : vals) {
+      EXPECT_EQ(V(val), "batched");
+    }
+  }
+  rmgr.Cleanup(step_id);
+  EXPECT_EQ(cache_->dummy_remote_worker()->num_batches(), 1);
+}
+
 }  // namespace tensorflow
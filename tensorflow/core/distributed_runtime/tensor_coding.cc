@@ -15,19 +15,58 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstdint>
+#include <memory>
+#include <utility>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Tensor contents smaller than this are copied, since aliasing them would
+// keep the whole received message alive for only a small saving.
+constexpr int kMinAliasedTensorBytes = 64 << 10;
+
+// A tensor buffer pointing into a received message, which is kept alive by
+// `owner`.
+class AliasedTensorBuffer : public TensorBuffer {
+ public:
+  AliasedTensorBuffer(std::shared_ptr<const void> owner, const void* data,
+                      size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        owner_(std::move(owner)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("rpc_message");
+  }
+  // Never forward the buffer to an op output, since other tensors may alias
+  // the same message.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<const void> owner_;
+  const size_t size_;
+};
+
+}  // namespace
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
   on_host_ = false;
   device_ = nullptr;
+  alias_contents_ = false;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
   already_used_ = false;
@@ -47,6 +86,9 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   if (alloc_attrs_.on_host() || da.device_type() == "CPU") {
     on_host_ = true;
   }
+  // Host memory of other devices may need to come from their allocator, e.g.
+  // to be pinned for DMA.
+  alias_contents_ = da.device_type() == "CPU";
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
 
@@ -143,8 +185,29 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+bool TensorResponse::AliasTensorContent(Source* source,
+                                        protobuf::io::CodedInputStream* input,
+                                        DataType dtype,
+                                        const TensorShape& shape,
+                                        int num_bytes) {
+  if (!alias_contents_ || num_bytes < kMinAliasedTensorBytes) return false;
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  std::shared_ptr<const void> owner = source->RetainContents();
+  if (owner == nullptr || !input->Skip(num_bytes)) return false;
+  auto* buf = new AliasedTensorBuffer(std::move(owner), data, num_bytes);
+  tensor_ = Tensor(dtype, shape, buf);
+  buf->Unref();
+  return true;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -195,12 +258,16 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        if (shape.num_elements() * DataTypeSize(tensor_meta->dtype()) !=
+            num_bytes) {
+          return false;
+        }
+        if (AliasTensorContent(source, input, tensor_meta->dtype(), shape,
+                               num_bytes)) {
+          break;
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
-        if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +300,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
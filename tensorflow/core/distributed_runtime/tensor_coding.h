@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
 
+#include <memory>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -63,6 +65,12 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns an object which keeps the bytes yielded by contents() alive
+    // and unchanged for as long as it is referenced, even after the Source
+    // is destroyed, or nullptr if the Source can not provide one. If
+    // provided, large tensor contents are aliased instead of copied.
+    virtual std::shared_ptr<const void> RetainContents() { return nullptr; }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,12 +99,23 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  // Sets tensor_ to a tensor aliasing the next `num_bytes` bytes of `input`
+  // and skips them, if they are contiguous, suitably aligned and retained by
+  // `source`. Returns false, without consuming input, otherwise.
+  bool AliasTensorContent(Source* source,
+                          protobuf::io::CodedInputStream* input,
+                          DataType dtype, const TensorShape& shape,
+                          int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
   bool on_host_ = false;
+  // Whether tensor contents may be aliased, i.e. the tensor is received in
+  // the memory of a CPU device.
+  bool alias_contents_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
@@ -15,13 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstring>
+#include <memory>
+#include <utility>
+
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -156,6 +162,70 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A source which keeps its data alive, so that tensor contents can be aliased.
+class RetainedSource : public TensorResponse::Source {
+ public:
+  RetainedSource(std::shared_ptr<const char> buffer, const char* data,
+                 int size)
+      : buffer_(std::move(buffer)), data_(data), size_(size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_ = std::make_unique<protobuf::io::ArrayInputStream>(data_, size_);
+    return stream_.get();
+  }
+
+  std::shared_ptr<const void> RetainContents() override { return buffer_; }
+
+ private:
+  std::shared_ptr<const char> buffer_;
+  const char* data_;
+  int size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+};
+
+TEST_F(TensorResponseTest, AliasesLargeTensorContent) {
+  Tensor src(DT_FLOAT, TensorShape({100000}));
+  test::FillIota<float>(&src, 0.0f);
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  const size_t offset = encoded.find(string(src.tensor_data()));
+  ASSERT_NE(offset, string::npos);
+
+  // Place the message so that the tensor content is aligned.
+  std::shared_ptr<char> buffer(
+      static_cast<char*>(port::AlignedMalloc(
+          encoded.size() + EIGEN_MAX_ALIGN_BYTES, EIGEN_MAX_ALIGN_BYTES)),
+      port::AlignedFree);
+  char* data = buffer.get() + (EIGEN_MAX_ALIGN_BYTES -
+                               offset % EIGEN_MAX_ALIGN_BYTES) %
+                                  EIGEN_MAX_ALIGN_BYTES;
+  memcpy(data, encoded.data(), encoded.size());
+
+  DummyDevice cpu_device(Env::Default());
+  Tensor result;
+  {
+    RetainedSource source(buffer, data, encoded.size());
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    result = response.tensor();
+  }
+  // The result outlives the source and the response.
+  buffer.reset();
+  EXPECT_EQ(result.tensor_data().data(), data + offset);
+  test::ExpectTensorEqual<float>(src, result);
+
+  // Without a retained buffer, the content is copied.
+  StringSource source(&encoded, encoded.size());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_NE(response.tensor().tensor_data().data(), encoded.data() + offset);
+  test::ExpectTensorEqual<float>(src, response.tensor());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
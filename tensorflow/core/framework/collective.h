@@ -116,6 +116,7 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  string compression;  // lossy wire format for reductions, e.g. bfloat16
 };
 
 // Data common to all members of a collective instance.
@@ -998,17 +998,26 @@ class IteratorContext {
 // `IteratorContext`.
 struct AnyContext {
   Allocator* allocator;
+  // Allocates host memory that can be copied to a GPU without staging, if the
+  // device supports it.
+  Allocator* gpu_compatible_allocator;
   std::function<void(std::function<void()>)>* runner;
   int64_t runner_threadpool_size;
 
   explicit AnyContext(IteratorContext* ctx) {
     allocator = ctx->allocator({});
+    AllocatorAttributes gpu_compatible_attr;
+    gpu_compatible_attr.set_gpu_compatible(true);
+    gpu_compatible_allocator = ctx->allocator(gpu_compatible_attr);
     runner = ctx->runner();
     runner_threadpool_size = ctx->runner_threadpool_size();
   }
 
   explicit AnyContext(OpKernelContext* ctx) {
     allocator = ctx->get_allocator({});
+    AllocatorAttributes gpu_compatible_attr;
+    gpu_compatible_attr.set_gpu_compatible(true);
+    gpu_compatible_allocator = ctx->get_allocator(gpu_compatible_attr);
     runner = ctx->runner();
     runner_threadpool_size = GetRunnerThreadpoolSizeFromOpKernelContext(ctx);
   }
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/local_rendezvous.h"
 
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -118,6 +119,40 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
   }
 }
 
+namespace {
+// Maximum number of free items kept for reuse by each bucket.
+constexpr size_t kMaxFreeItemsPerBucket = 32;
+}  // namespace
+
+LocalRendezvous::TableBucket::~TableBucket() {
+  for (void* item : free_items) {
+    ::operator delete(item);
+  }
+}
+
+void* LocalRendezvous::AllocateItem(TableBucket* bucket) {
+  if (bucket->free_items.empty()) {
+    return ::operator new(sizeof(Item));
+  }
+  void* item = bucket->free_items.back();
+  bucket->free_items.pop_back();
+  return item;
+}
+
+tsl::core::RefCountPtr<Rendezvous> LocalRendezvous::DestroyItem(Item* item) {
+  tsl::core::RefCountPtr<Rendezvous> rc_owner = std::move(item->rc_owner);
+  item->~Item();
+  return rc_owner;
+}
+
+void LocalRendezvous::FreeItem(TableBucket* bucket, void* item) {
+  if (bucket->free_items.size() < kMaxFreeItemsPerBucket) {
+    bucket->free_items.push_back(item);
+  } else {
+    ::operator delete(item);
+  }
+}
+
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
@@ -172,8 +207,6 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
     // Only send-related fields need to be filled.
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
     auto rc_owner = tsl::core::GetNewRef(rc_owner_);
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
     activity_watcher::ActivityScope activity_scope(
@@ -188,8 +221,9 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
               });
         },
         /*level=*/1);
-    queue->push_back(new Item(std::move(rc_owner), send_args, val, is_dead,
-                              std::move(activity_scope)));
+    queue->push_back(new (AllocateItem(&bucket)) Item(
+        std::move(rc_owner), send_args, val, is_dead,
+        std::move(activity_scope)));
     bucket.mu.unlock();
     return OkStatus();
   }
@@ -211,15 +245,17 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   DCHECK_EQ(item->type, Item::kRecv);
   (*item->recv_state.waiter)(OkStatus(), send_args, item->args, val, is_dead);
+  auto rc_owner = DestroyItem(item);
   {
     mutex_lock l(bucket.mu);
+    FreeItem(&bucket, item);
     bucket.pending_callback_counter--;
     if (bucket.pending_callback_counter == 0) {
       bucket.pending_callback_cond_var.notify_all();
     }
   }
-  // Delete the item at last since it may unref and destruct the rendezvous.
-  delete item;
+  // Release the owner at last since it may destruct the rendezvous.
+  rc_owner.reset();
   return OkStatus();
 }
 
@@ -307,8 +343,6 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
 
     DVLOG(2) << "Enqueue Recv Item (key:" << key.FullKey() << "). ";
 
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
     activity_watcher::ActivityScope activity_scope(
         [&]() {
           return std::make_unique<activity_watcher::Activity>(
@@ -326,7 +360,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       // NOTE(mrry): We must wrap `done` with code that deregisters the
       // cancellation callback before calling the `done` callback, because the
       // cancellation manager may no longer be live after `done` is called.
-      queue->push_back(new Item(
+      queue->push_back(new (AllocateItem(&bucket)) Item(
           std::move(rc_owner), recv_args,
           [this, cm, token, done = std::move(done)](
               const Status& s, const Rendezvous::Args& send_args,
@@ -342,8 +376,10 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
           },
           token, std::move(activity_scope)));
     } else {
-      queue->push_back(new Item(std::move(rc_owner), recv_args, std::move(done),
-                                token, std::move(activity_scope)));
+      queue->push_back(new (AllocateItem(&bucket))
+                           Item(std::move(rc_owner), recv_args,
+                                std::move(done), token,
+                                std::move(activity_scope)));
     }
 
     bucket.mu.unlock();
@@ -369,15 +405,17 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   DCHECK_EQ(item->type, Item::kSend);
   done(OkStatus(), item->args, recv_args, *item->send_state.value,
        item->send_state.is_dead);
+  auto rc_owner = DestroyItem(item);
   {
     mutex_lock l(bucket.mu);
+    FreeItem(&bucket, item);
     bucket.pending_callback_counter--;
     if (bucket.pending_callback_counter == 0) {
       bucket.pending_callback_cond_var.notify_all();
     }
   }
-  // Delete the item at last since it may unref and destruct the rendezvous.
-  delete item;
+  // Release the owner at last since it may destruct the rendezvous.
+  rc_owner.reset();
 }
 
 mutex& LocalRendezvous::aborted_rendezs_mu_ = *new mutex();
@@ -400,6 +438,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
@@ -436,6 +475,9 @@ void LocalRendezvous::DoAbort(const Status& status) {
 }
 
 Status LocalRendezvous::status() {
+  if (TF_PREDICT_TRUE(!aborted_.load(std::memory_order_acquire))) {
+    return OkStatus();
+  }
   tf_shared_lock ml(mu_);
   return status_;
 }
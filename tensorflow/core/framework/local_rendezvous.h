@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -90,18 +91,40 @@ class LocalRendezvous {
   Rendezvous* rc_owner_;
 
   struct TableBucket {
+    ~TableBucket();
+
     mutex mu;
     Table table TF_GUARDED_BY(mu);
 
     // Track the number of pening callbacks using a counter.
     int pending_callback_counter TF_GUARDED_BY(mu) = 0;
     condition_variable pending_callback_cond_var TF_GUARDED_BY(mu);
+
+    // Memory of consumed items, reused by the next items enqueued in this
+    // bucket so that most Sends and Recvs do not allocate.
+    std::vector<void*> free_items TF_GUARDED_BY(mu);
   };
 
+  // Returns memory for a new Item, reusing a free item of `bucket` if any.
+  static void* AllocateItem(TableBucket* bucket)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(bucket->mu);
+
+  // Destroys the consumed `item` and returns its reference to the owner,
+  // which the caller must release last, since it may destroy the rendezvous.
+  static tsl::core::RefCountPtr<Rendezvous> DestroyItem(Item* item);
+
+  // Releases the memory of an item destroyed by DestroyItem(), keeping it in
+  // `bucket` for reuse.
+  static void FreeItem(TableBucket* bucket, void* item)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(bucket->mu);
+
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // Set once `status_` is an error, so that Send and Recv need not lock `mu_`
+  // to check the status of a rendezvous that has not been aborted.
+  std::atomic<bool> aborted_{false};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
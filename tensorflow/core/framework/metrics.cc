@@ -79,6 +79,13 @@ auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* resource_gather_hot_row_cache_lookups =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/core/resource_gather_hot_row_cache_lookups",
+        "The number of rows looked up by ResourceGather ops in their hot row "
+        "cache, by result (hit or miss).",
+        "result");
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -428,6 +435,18 @@ auto* tpu_variable_distribution_time_usecs = tsl::monitoring::Counter<0>::New(
     "at the start of a call to TPUExecute.  Timer starts at RunGraph "
     "invocation and ends when TPUExecute args are ready on the current task.");
 
+auto* grappler_pass_node_count = tsl::monitoring::Counter<2>::New(
+    "/tensorflow/core/grappler/pass_node_count",
+    "The total number of nodes in the graphs before and after each Grappler "
+    "optimization pass.",
+    "name", "stage");
+
+auto* grappler_pass_estimated_cost_ns = tsl::monitoring::Counter<2>::New(
+    "/tensorflow/core/grappler/pass_estimated_cost_ns",
+    "The total estimated execution time of the graphs in nanoseconds before "
+    "and after each Grappler optimization pass.",
+    "name", "stage");
+
 auto* test_counters = tsl::monitoring::Counter<2>::New(
     "/tensorflow/core/test_counters", "Counters used for testing.", "name",
     "label");
@@ -921,10 +940,37 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordGrapplerPassGraphSize(const string& optimizer, int64_t nodes_before,
+                                 int64_t nodes_after) {
+  grappler_pass_node_count->GetCell(optimizer, "before")
+      ->IncrementBy(nodes_before);
+  grappler_pass_node_count->GetCell(optimizer, "after")
+      ->IncrementBy(nodes_after);
+}
+
+void RecordGrapplerPassEstimatedCost(const string& optimizer,
+                                     int64_t cost_before_ns,
+                                     int64_t cost_after_ns) {
+  grappler_pass_estimated_cost_ns->GetCell(optimizer, "before")
+      ->IncrementBy(cost_before_ns);
+  grappler_pass_estimated_cost_ns->GetCell(optimizer, "after")
+      ->IncrementBy(cost_after_ns);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordResourceGatherHotRowCacheLookups(int64_t hits, int64_t misses) {
+  if (hits > 0) {
+    resource_gather_hot_row_cache_lookups->GetCell("hit")->IncrementBy(hits);
+  }
+  if (misses > 0) {
+    resource_gather_hot_row_cache_lookups->GetCell("miss")->IncrementBy(
+        misses);
+  }
+}
+
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec) {
   GetTFDataPipelineProcessingTimeGauge(id)->Set(pipeline_processing_time_usec);
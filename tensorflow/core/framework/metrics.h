@@ -272,6 +272,10 @@ void UpdateGraphPendingQueueLength(uint64 len);
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records the number of rows a ResourceGather found (`hits`) or didn't find
+// (`misses`) in its hot row cache.
+void RecordResourceGatherHotRowCacheLookups(int64_t hits, int64_t misses);
+
 // Records the pipeline processing time in microseconds
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec);
@@ -516,6 +520,17 @@ class ScopedCounter final {
 // passes.
 monitoring::Counter<2>* GetGraphOptimizationCounter();
 
+// Records the number of nodes in the graph before and after a Grappler
+// optimization pass named `optimizer` ran on it.
+void RecordGrapplerPassGraphSize(const string& optimizer, int64_t nodes_before,
+                                 int64_t nodes_after);
+
+// Records the execution time of the graph, in nanoseconds, estimated before
+// and after a Grappler optimization pass named `optimizer` ran on it.
+void RecordGrapplerPassEstimatedCost(const string& optimizer,
+                                     int64_t cost_before_ns,
+                                     int64_t cost_after_ns);
+
 // Updates metrics for time to distribute variables to all TPU hosts.
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 
@@ -18,20 +18,26 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <queue>
+#include <string>
+#include <utility>
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tsl/platform/protobuf.h"
 
@@ -361,6 +367,26 @@ inline void UpdateStateValues(Node::ModelParameters* parameters) {
   }
 }
 
+// Calls `f` for every node in the tree rooted in `root` with the path of the
+// node, which identifies it across runs of the same input pipeline: the path
+// consists of the names of the nodes from `root` and the index of each node
+// among the inputs of its output node.
+void ForEachNodePath(std::shared_ptr<Node> root,
+                     const std::function<void(const std::string&, Node&)>& f) {
+  std::deque<std::pair<std::string, std::shared_ptr<Node>>> queue;
+  queue.emplace_back(root->name(), std::move(root));
+  while (!queue.empty()) {
+    auto [path, node] = std::move(queue.front());
+    queue.pop_front();
+    f(path, *node);
+    int index = 0;
+    for (const auto& input : node->inputs()) {
+      queue.emplace_back(
+          strings::StrCat(path, "/", index++, ":", input->name()), input);
+    }
+  }
+}
+
 // Recursively produces protos for nodes in a subtree of `output` node and
 // appends them to nodes of the given model.
 Status ModelToProtoHelper(std::shared_ptr<Node> output, ModelProto* model) {
@@ -1640,6 +1666,28 @@ Node::ModelParameters Node::CollectTunableParameters() const {
   return CollectTunableParametersLocked();
 }
 
+Status Node::SetTunableParameterValue(const std::string& parameter_name,
+                                      double value) {
+  std::shared_ptr<Parameter> parameter;
+  {
+    tf_shared_lock l(mu_);
+    auto it = parameters_.find(parameter_name);
+    if (it != parameters_.end()) {
+      parameter = it->second;
+    }
+  }
+  if (parameter == nullptr || parameter->state == nullptr ||
+      !parameter->state->tunable) {
+    return errors::NotFound("Tunable parameter ", parameter_name,
+                            " was not found in model node ", long_name());
+  }
+  mutex_lock l(*parameter->state->mu);
+  parameter->value = std::clamp(value, parameter->min, parameter->max);
+  parameter->state->value = parameter->value;
+  parameter->state->cond_var->notify_all();
+  return OkStatus();
+}
+
 Node::ModelParameters Node::CollectNodeTunableParameters() const {
   tf_shared_lock l(mu_);
   Node::ModelParameters parameters;
@@ -2403,6 +2451,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::LATENCY:
+      OptimizeLatency(snapshot, optimization_params, cancellation_manager,
+                      ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2554,6 +2606,15 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
       /*deregister_fn=*/&unused));
 
   int64_t last_optimization_ms = 0;
+  {
+    mutex_lock l(mu_);
+    if (tuned_parameters_restored_) {
+      // Keep the restored parameter values for a full optimization period
+      // rather than retuning them from the first few elements.
+      last_optimization_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+      optimization_period_ms_ = kOptimizationPeriodMaxMs;
+    }
+  }
   int64_t current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
   while (true) {
     {
@@ -2574,14 +2635,27 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
     int64_t start_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     double model_input_time = 0.0;
     // Model input time is set to 0 for all optimization algorithms except for
-    // stage-based optimization algorithm for historical reason. In stage-based
-    // optimization algorithm, the model input time is used as a target
+    // stage-based and latency optimization algorithms for historical reason.
+    // In these algorithms, the model input time is used as a target
     // optimization time of all stages in the pipeline.
-    if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
+    if (algorithm == AutotuneAlgorithm::STAGE_BASED ||
+        algorithm == AutotuneAlgorithm::LATENCY) {
       model_input_time = ComputeTargetTimeNsec();
     }
     Optimize(algorithm, cpu_budget_func, ram_budget_share, fixed_ram_budget,
              model_input_time, ram_budget_manager, cancellation_manager);
+    std::string tuned_parameters_file;
+    {
+      tf_shared_lock l(mu_);
+      tuned_parameters_file = tuned_parameters_file_;
+    }
+    if (!tuned_parameters_file.empty()) {
+      Status s = SaveTunedParameters(tuned_parameters_file);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to save tuned parameters to "
+                     << tuned_parameters_file << ": " << s;
+      }
+    }
     int64_t end_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     VLOG(2) << "Optimized for " << end_ms - start_ms << " ms.";
 
@@ -2839,6 +2913,72 @@ void Model::OptimizeStageBased(std::shared_ptr<Node> snapshot,
       cancellation_manager, ram_budget_manager);
 }
 
+void Model::OptimizeLatency(std::shared_ptr<Node> snapshot,
+                            const OptimizationParams& optimization_params,
+                            CancellationManager* cancellation_manager,
+                            RamBudgetManager& ram_budget_manager) {
+  const double target_time_nsec = optimization_params.model_input_time();
+  VLOG(2) << "Starting optimization of tunable parameters for latency with a "
+             "target time of "
+          << target_time_nsec << " nanoseconds.";
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  for (auto& pair : parameters) {
+    pair.second->value = pair.second->min;
+  }
+  // Orders parameter values by how much the slowest stage exceeds the target
+  // time first, and by the latency of the output elements second.
+  auto objective = [&snapshot, target_time_nsec]() {
+    ModelTiming model_timing(snapshot, target_time_nsec);
+    ModelTimingPriorityQueue priority_queue(model_timing);
+    absl::StatusOr<std::pair<double, Node*>> slowest_stage =
+        priority_queue.PopSlowestStageRoot();
+    const double excess_time_nsec =
+        slowest_stage.ok()
+            ? std::max(slowest_stage->first - target_time_nsec, 0.0)
+            : 0.0;
+    return std::make_pair(excess_time_nsec,
+                          model_timing.GetTiming(snapshot.get())->latency_nsec);
+  };
+
+  std::pair<double, double> current = objective();
+  while (!cancellation_manager->IsCancelled()) {
+    Parameter* best_parameter = nullptr;
+    std::pair<double, double> best = current;
+    for (auto& pair : parameters) {
+      Parameter* parameter = pair.second.get();
+      if (parameter->value >= parameter->max) {
+        continue;
+      }
+      parameter->value += 1.0;
+      if (TotalMaximumBufferedBytes(snapshot) <=
+          optimization_params.ram_budget()) {
+        std::pair<double, double> candidate = objective();
+        if (candidate < best) {
+          best = candidate;
+          best_parameter = parameter;
+        }
+      }
+      parameter->value -= 1.0;
+    }
+    if (best_parameter == nullptr) {
+      metrics::RecordTFDataAutotuneStoppingCriteria(
+          current.first > 0.0 ? "target_time_not_reached"
+                              : "latency_not_improved");
+      break;
+    }
+    best_parameter->value += 1.0;
+    current = best;
+  }
+  if (ram_budget_manager.RequestModelAllocation(
+          TotalMaximumBufferedBytes(snapshot))) {
+    UpdateStateValues(&parameters);
+  }
+}
+
 void Model::OptimizeStageBasedAsyncInterleaveManyNodes(
     std::shared_ptr<Node> snapshot,
     const OptimizationParams& optimization_params,
@@ -3235,6 +3375,84 @@ Status Model::Load(const string& fname, std::unique_ptr<Model>* model,
   return OkStatus();
 }
 
+Status Model::SaveTunedParameters(const string& fname) {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  TunedParametersProto tuned_parameters;
+  if (output != nullptr) {
+    ForEachNodePath(output, [&tuned_parameters](const std::string& path,
+                                                Node& node) {
+      for (const auto& pair : node.CollectNodeTunableParameters()) {
+        const std::shared_ptr<Parameter>& parameter = pair.second;
+        tf_shared_lock l(*parameter->state->mu);
+        (*(*tuned_parameters.mutable_nodes())[path]
+              .mutable_parameters())[parameter->name] =
+            parameter->state->value;
+      }
+    });
+  }
+  // Write to a temporary file first so that a crash never leaves a partially
+  // written file behind.
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(
+      env->RecursivelyCreateDir(std::string(io::Dirname(fname))));
+  std::string tmp_fname = fname;
+  if (!env->CreateUniqueFileName(&tmp_fname, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            fname);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_fname, tuned_parameters));
+  return env->RenameFile(tmp_fname, fname);
+}
+
+Status Model::RestoreTunedParameters(const string& fname) {
+  TunedParametersProto tuned_parameters;
+  TF_RETURN_IF_ERROR(
+      ReadBinaryProto(Env::Default(), fname, &tuned_parameters));
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  if (output == nullptr) {
+    return OkStatus();
+  }
+  int64_t num_restored = 0;
+  ForEachNodePath(output, [&tuned_parameters, &num_restored](
+                              const std::string& path, Node& node) {
+    const TunedParametersProto::Node* node_parameters =
+        gtl::FindOrNull(tuned_parameters.nodes(), path);
+    if (node_parameters == nullptr) {
+      return;
+    }
+    for (const auto& [name, value] : node_parameters->parameters()) {
+      if (node.SetTunableParameterValue(name, value).ok()) {
+        VLOG(2) << "Restored tunable parameter " << node.long_name()
+                << ":: " << name << " to " << value;
+        ++num_restored;
+      }
+    }
+  });
+  if (num_restored > 0) {
+    mutex_lock l(mu_);
+    tuned_parameters_restored_ = true;
+  }
+  return OkStatus();
+}
+
+void Model::UseTunedParametersFile(const string& fname) {
+  Status s = RestoreTunedParameters(fname);
+  if (!s.ok() && !errors::IsNotFound(s)) {
+    LOG(WARNING) << "Failed to restore tuned parameters from " << fname << ": "
+                 << s;
+  }
+  mutex_lock l(mu_);
+  tuned_parameters_file_ = fname;
+}
+
 std::string Model::DebugString() {
   constexpr int64_t kMinSecondsBetweenCalls = 30;
   if (absl::Now() < cache_until_) return cached_debug_string_;
@@ -3256,13 +3474,16 @@ std::string Model::DebugString() {
   return cached_debug_string_;
 }
 
-ModelTiming::ModelTiming(std::shared_ptr<Node> root) : root_(root) {
+ModelTiming::ModelTiming(std::shared_ptr<Node> root,
+                         double output_interval_nsec)
+    : root_(root) {
   DCHECK(root_.get() != nullptr);
   auto bfs_nodes = CollectNodes(root_, TraversalOrder::BFS, IsAnyNode);
   auto reverse_bfs_nodes = bfs_nodes;
   std::reverse(reverse_bfs_nodes.begin(), reverse_bfs_nodes.end());
   ComputePipelineRatios(bfs_nodes);
   ComputeTotalTimes(reverse_bfs_nodes);
+  ComputeLatencies(reverse_bfs_nodes, output_interval_nsec);
 }
 
 Node::NodeVector ModelTiming::CollectNodes(
@@ -3476,6 +3697,85 @@ void ModelTiming::ComputeTotalTimes(const Node::NodeVector& reverse_bfs_nodes) {
   }
 }
 
+void ModelTiming::ComputeLatencies(const Node::NodeVector& reverse_bfs_nodes,
+                                   double output_interval_nsec) {
+  // The pipeline produces elements at the pace of its consumer or of its
+  // slowest stage, whichever is slower.
+  double root_interval_nsec = output_interval_nsec;
+  for (const auto& stage_root : GetStageRoots()) {
+    const NodeTiming& stage_timing = timing_nodes_[stage_root.get()];
+    root_interval_nsec =
+        std::max(root_interval_nsec,
+                 stage_timing.total_time_nsec * stage_timing.pipeline_ratio);
+  }
+  for (const auto& node : reverse_bfs_nodes) {
+    NodeTiming& node_timing = timing_nodes_[node.get()];
+    if (!node->autotune() || node->num_elements() <= 0) {
+      continue;
+    }
+    double parallelism = 1.0;
+    auto parallelism_param = node->ParameterValue(kParallelism);
+    if (parallelism_param.ok()) {
+      parallelism = parallelism_param.value();
+    }
+    // The self time of a node is amortized over its parallel calls, but each
+    // call takes the full processing time.
+    double latency_nsec =
+        node_timing.self_time_nsec * parallelism + ComputeInputsLatency(*node);
+    if (node->IsAsync() && node_timing.pipeline_ratio > 0.0) {
+      // If the node produces elements faster than they are consumed, its
+      // buffer stays full and each element waits for the buffered elements
+      // ahead of it to be consumed first. The buffer of a node without a
+      // `buffer_size` parameter holds the results of its parallel calls.
+      const double consumer_interval_nsec =
+          root_interval_nsec / node_timing.pipeline_ratio;
+      if (node_timing.total_time_nsec < consumer_interval_nsec) {
+        auto buffer_size_param = node->ParameterValue(kBufferSize);
+        const double buffer_size = buffer_size_param.ok()
+                                       ? buffer_size_param.value()
+                                       : parallelism;
+        latency_nsec += buffer_size * consumer_interval_nsec;
+      }
+    }
+    node_timing.latency_nsec = latency_nsec;
+  }
+}
+
+double ModelTiming::ComputeInputsLatency(const Node& node) {
+  auto inputs = node.inputs();
+  auto input = inputs.begin();
+  const bool is_interleave = absl::StartsWith(node.name(), kFlatMap) ||
+                             absl::StartsWith(node.name(), kInterleave) ||
+                             absl::StartsWith(node.name(), kParallelInterleave);
+  if (is_interleave && input != inputs.end()) {
+    // The elements of the first input are amortized over all the elements of
+    // the interleaved inputs, and each element comes from one of the
+    // interleaved inputs.
+    ++input;
+  }
+  double sum_latency_nsec = 0.0;
+  int num_inputs = 0;
+  for (; input != inputs.end(); ++input) {
+    if (!(*input)->autotune() || (*input)->num_elements() <= 0) {
+      continue;
+    }
+    DCHECK(timing_nodes_.contains((*input).get()))
+        << "Input " << (*input)->long_name() << " of node " << node.long_name()
+        << " has no timing node.";
+    sum_latency_nsec += timing_nodes_[(*input).get()].latency_nsec;
+    ++num_inputs;
+  }
+  if (num_inputs == 0) {
+    return 0.0;
+  }
+  if (is_interleave) {
+    return sum_latency_nsec / num_inputs;
+  }
+  // An element needs the next `Ratio()` elements of each input, which are
+  // produced one after the other.
+  return sum_latency_nsec * (node.Ratio() > 0.0 ? node.Ratio() : 1.0);
+}
+
 void ModelTiming::ComputeNodeTotalTime(const Node& node) {
   NodeTiming& node_timing = timing_nodes_[&node];
   node_timing.self_time_nsec = node.ComputeSelfTime();
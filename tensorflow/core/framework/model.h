@@ -536,6 +536,12 @@ class Node {
                             " was not found in model node ", long_name());
   }
 
+  // Sets the state value of the tunable parameter `parameter_name`, clamped to
+  // its feasible interval, and notifies the threads waiting on it. Returns
+  // not ok status if the node has no such tunable parameter.
+  Status SetTunableParameterValue(const std::string& parameter_name,
+                                  double value) TF_LOCKS_EXCLUDED(mu_);
+
   // Given the average time between events when the elements in the buffer are
   // produced (`producer_time`), the average time between events when elements
   // in the buffer are consumed (`consumer_time`) and the buffer size, the
@@ -1022,6 +1028,23 @@ class Model {
   static Status Load(const string& fname, std::unique_ptr<Model>* model,
                      OptimizationParams* optimization_params);
 
+  // Saves the state values of the tunable parameters of all nodes to a file,
+  // so that autotuning of the same input pipeline can be warm-started from
+  // them.
+  Status SaveTunedParameters(const string& fname) TF_LOCKS_EXCLUDED(mu_);
+
+  // Restores the tunable parameters saved by `SaveTunedParameters()` to the
+  // nodes at the same position in this model. Nodes without saved values,
+  // e.g. inputs of interleave nodes created later, keep their values.
+  Status RestoreTunedParameters(const string& fname) TF_LOCKS_EXCLUDED(mu_);
+
+  // Restores the tunable parameters from `fname` if the file exists, and saves
+  // them to `fname` after every optimization. If parameters were restored, the
+  // optimization loop keeps them for a full optimization period before
+  // retuning them from the model's own measurements. `fname` should identify
+  // the input pipeline, e.g. by the fingerprint of its dataset graph.
+  void UseTunedParametersFile(const string& fname) TF_LOCKS_EXCLUDED(mu_);
+
   // Records gap time between consecutive `GetNext()` calls.
   void RecordIteratorGapTime(uint64_t duration_usec);
 
@@ -1131,6 +1154,19 @@ class Model {
                           CancellationManager* cancellation_manager,
                           RamBudgetManager& ram_budget_manager);
 
+  // This optimization starts by setting all tunable parameters to their
+  // minimum values. It then repeatedly increases the parameter which brings
+  // the slowest stage closest to the target time, or once all stages are
+  // faster than the target time, the parameter which decreases the latency of
+  // the output elements the most. It stops when no parameter improves either
+  // or the memory budget is fully utilized. Unlike the throughput-oriented
+  // algorithms, it keeps buffers small, since buffered elements wait to be
+  // consumed.
+  void OptimizeLatency(std::shared_ptr<Node> snapshot,
+                       const OptimizationParams& optimization_params,
+                       CancellationManager* cancellation_manager,
+                       RamBudgetManager& ram_budget_manager);
+
   // This is the first part of the stage-based optimization that optimizes
   // tunable parallelism parameters for async interleave many nodes only. We
   // separately optimize async interleave many nodes more aggressively because
@@ -1185,6 +1221,11 @@ class Model {
   // Determines the time the optimization loop should wait between
   // running optimizations.
   int64_t optimization_period_ms_ TF_GUARDED_BY(mu_);
+  // The file the tunable parameters are saved to after every optimization, or
+  // empty if they are not saved.
+  std::string tuned_parameters_file_ TF_GUARDED_BY(mu_);
+  // Whether `RestoreTunedParameters()` restored any parameter value.
+  bool tuned_parameters_restored_ TF_GUARDED_BY(mu_) = false;
 
   // Gauge cell that can be used to collect the state of the model.
   monitoring::GaugeCell<std::function<std::string()>>* model_gauge_cell_ =
@@ -1234,9 +1275,18 @@ class ModelTiming {
     // produce the elements needed to produce one element at the root of the
     // pipeline.
     double total_time_nsec = 0.0;
+    // The expected time from when this node starts computing an element until
+    // the element is consumed from its output, including the time the inputs
+    // of the element spend in the subtree rooted at this node and the time
+    // elements wait in the buffers of asynchronous nodes.
+    double latency_nsec = 0.0;
   };
 
-  explicit ModelTiming(std::shared_ptr<Node> root);
+  // `output_interval_nsec` is the time between two consecutive requests for
+  // an element of `root`. It is used to estimate how long elements wait in
+  // buffers, and is rounded up to the time of the slowest stage.
+  explicit ModelTiming(std::shared_ptr<Node> root,
+                       double output_interval_nsec = 0.0);
 
   // Returns the timing data for `node`.
   const NodeTiming* GetTiming(const Node* node) const;
@@ -1259,6 +1309,14 @@ class ModelTiming {
   // to be a vector of model nodes in reversed BFS manner.
   void ComputeTotalTimes(const Node::NodeVector& reverse_bfs_nodes);
 
+  // Computes the latencies of all nodes. The `reverse_bfs_nodes` are assumed
+  // to be a vector of model nodes in reversed BFS manner.
+  void ComputeLatencies(const Node::NodeVector& reverse_bfs_nodes,
+                        double output_interval_nsec);
+
+  // Computes the latency of the inputs of an element of `node`.
+  double ComputeInputsLatency(const Node& node);
+
   // Computes the first input total time of an interleave node.
   double ComputeInterleaveManyFirstInputTotalTime(const Node& node);
 
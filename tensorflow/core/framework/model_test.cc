@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -1407,6 +1408,53 @@ TEST(ModelTest, ModelMetrics) {
                     HasSubstr("autotune: true")));
 }
 
+TEST(ModelTest, SaveAndRestoreTunedParameters) {
+  auto make_model = [](double max_parallelism, std::shared_ptr<Node>* map) {
+    auto model = std::make_shared<Model>();
+    std::shared_ptr<Node> root = model::MakeUnknownNode({0, "root", nullptr});
+    model->AddNode([&root](model::Node::Args args) { return root; }, "root",
+                   nullptr, &root);
+    *map = model::MakeAsyncKnownRatioNode(
+        {1, "ParallelMapV2", root}, 1,
+        {model::MakeParameter(
+            "parallelism",
+            std::make_shared<SharedState>(
+                /*value=*/model::kAutotune, std::make_shared<mutex>(),
+                std::make_shared<condition_variable>()),
+            /*min=*/1, /*max=*/max_parallelism)});
+    model->AddNode([map](model::Node::Args args) { return *map; },
+                   "ParallelMapV2", root, map);
+    (*map)->record_element();
+    return model;
+  };
+  const std::string fname =
+      io::JoinPath(testing::TmpDir(), "tuned_parameters", "autotune.pb");
+
+  std::shared_ptr<Node> map;
+  std::shared_ptr<Model> model = make_model(/*max_parallelism=*/16, &map);
+  TF_ASSERT_OK(map->SetTunableParameterValue("parallelism", 7));
+  EXPECT_FALSE(map->SetTunableParameterValue("buffer_size", 7).ok());
+  TF_ASSERT_OK(model->SaveTunedParameters(fname));
+
+  std::shared_ptr<Node> restored_map;
+  std::shared_ptr<Model> restored_model =
+      make_model(/*max_parallelism=*/16, &restored_map);
+  EXPECT_EQ(restored_map->parameter_value("parallelism"), model::kAutotune);
+  TF_ASSERT_OK(restored_model->RestoreTunedParameters(fname));
+  EXPECT_EQ(restored_map->parameter_value("parallelism"), 7);
+
+  // Restored values are clamped to the range of the parameter.
+  std::shared_ptr<Node> clamped_map;
+  std::shared_ptr<Model> clamped_model =
+      make_model(/*max_parallelism=*/4, &clamped_map);
+  TF_ASSERT_OK(clamped_model->RestoreTunedParameters(fname));
+  EXPECT_EQ(clamped_map->parameter_value("parallelism"), 4);
+
+  // So are the values set directly.
+  TF_ASSERT_OK(map->SetTunableParameterValue("parallelism", 100));
+  EXPECT_EQ(map->parameter_value("parallelism"), 16);
+}
+
 TEST(ModelTest, ModelCollectOptimizationMetrics) {
   CellReader<std::string> cell_reader("/tensorflow/data/model");
   model::Model model;
@@ -3158,6 +3206,152 @@ TEST_F(ModelTimingTest, OptimizeStageBased_PipelineRatioLessThanOne) {
   EXPECT_EQ(14, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
 }
 
+TEST_F(ModelTimingTest, Latency) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Prefetch"
+        autotune: true
+        num_elements: 100
+        processing_time: 500
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "buffer_size"
+          value: 2
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 3000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+  model_timing_ = std::make_unique<ModelTiming>(model_->output(),
+                                                /*output_interval_nsec=*/100);
+
+  EXPECT_DOUBLE_EQ(10, GetNodeTiming(/*node_id=*/3)->latency_nsec);
+  EXPECT_DOUBLE_EQ(40, GetNodeTiming(/*node_id=*/2)->latency_nsec);
+  // The prefetch node produces an element every 45ns, faster than the consumer
+  // requests them, so each element also waits for the 2 buffered elements to
+  // be consumed.
+  EXPECT_DOUBLE_EQ(5 + 40 + 2 * 100,
+                   GetNodeTiming(/*node_id=*/1)->latency_nsec);
+}
+
+TEST_F(ModelTimingTest, OptimizeLatency) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Prefetch"
+        autotune: true
+        num_elements: 100
+        processing_time: 100
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "buffer_size"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 97
+        buffered_elements: 3
+        processing_time: 5000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 3000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 4
+      }
+    }
+    nodes: {
+      key: 4
+      value: {
+        id: 4
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model_->Optimize(AutotuneAlgorithm::LATENCY, CpuBudgetFunc(20),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/100000,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+
+  // The parallelism is just high enough to keep up with the consumer, and the
+  // prefetch buffer is not grown.
+  EXPECT_EQ(5, GetNode(/*node_id=*/2)->parameter_value("parallelism"));
+  EXPECT_EQ(1, GetNode(/*node_id=*/1)->parameter_value("buffer_size"));
+}
+
 TEST_F(ModelTimingTest, ComputeTargetTime) {
   model_ = std::make_unique<Model>();
 
@@ -377,6 +377,9 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (TF_PREDICT_FALSE(params_->default_allocator_override != nullptr) &&
+             attr.value == 0) {
+    allocator = params_->default_allocator_override;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -619,6 +619,11 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, serves the allocations that the kernel makes with default
+    // allocator attributes, in place of `device->GetAllocator()`. Executors
+    // set this to place intermediate tensors according to a memory plan.
+    Allocator* default_allocator_override = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
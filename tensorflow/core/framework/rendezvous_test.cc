@@ -356,6 +356,23 @@ TEST_F(LocalRendezvousTest, MultiSends) {
   }
 }
 
+TEST_F(LocalRendezvousTest, QueuedSendsKeepOrder) {
+  // Queues more items than a bucket keeps for reuse, then consumes them.
+  static const int N = 100;
+  Rendezvous::Args args;
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < N; ++i) {
+      TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V(strings::StrCat(i)), false));
+    }
+    Tensor val;
+    bool val_dead;
+    for (int i = 0; i < N; ++i) {
+      TF_ASSERT_OK(rendez_->Recv(KeyFoo(), args, &val, &val_dead));
+      EXPECT_EQ(strings::StrCat(i), V(val));
+    }
+  }
+}
+
 TEST_F(LocalRendezvousTest, RecvAbort) {
   rendez_->Ref();
   SchedClosure([this]() {
@@ -0,0 +1,147 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/calibrated_op_level_cost_estimator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+std::string OpKey(const OpInfo& op_info) {
+  return absl::StrCat(op_info.device().type(), "/", op_info.op());
+}
+
+std::string ShapeKey(const OpInfo& op_info) {
+  return absl::StrCat(op_info.device().type(), "/", GetOpDescription(op_info));
+}
+
+}  // namespace
+
+CalibratedOpLevelCostEstimator::CalibratedOpLevelCostEstimator(
+    const OpPerformanceList& measurements) {
+  struct Totals {
+    int64_t measured_ns = 0;
+    int64_t analytical_ns = 0;
+    int64_t count = 0;
+  };
+  absl::flat_hash_map<std::string, Totals> shape_totals;
+  absl::flat_hash_map<std::string, Totals> op_totals;
+  for (const OpPerformance& perf : measurements.op_performance()) {
+    if (perf.compute_cost() < 0) continue;
+    OpContext op_context;
+    op_context.name = perf.node();
+    op_context.op_info = perf.op();
+    const int64_t analytical_ns =
+        OpLevelCostEstimator::PredictCosts(op_context).execution_time.count();
+
+    Totals& shape = shape_totals[ShapeKey(perf.op())];
+    shape.measured_ns += perf.compute_cost();
+    ++shape.count;
+    Totals& op = op_totals[OpKey(perf.op())];
+    op.measured_ns += perf.compute_cost();
+    op.analytical_ns += analytical_ns;
+  }
+
+  auto calibration = std::make_shared<Calibration>();
+  for (const auto& [key, totals] : shape_totals) {
+    calibration->measured_ns[key] = totals.measured_ns / totals.count;
+  }
+  for (const auto& [key, totals] : op_totals) {
+    if (totals.analytical_ns > 0) {
+      calibration->op_scale[key] =
+          static_cast<double>(totals.measured_ns) / totals.analytical_ns;
+    }
+  }
+  VLOG(1) << "Calibrated the op costs with " << shape_totals.size()
+          << " measured op shapes of " << op_totals.size() << " ops.";
+  calibration_ = std::move(calibration);
+}
+
+Costs CalibratedOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  const OpInfo& op_info = op_context.op_info;
+
+  auto measured = calibration_->measured_ns.find(ShapeKey(op_info));
+  if (measured != calibration_->measured_ns.end()) {
+    // The measurement includes the memory accesses.
+    costs.execution_time = Costs::Duration(measured->second);
+    costs.compute_time = costs.execution_time;
+    costs.memory_time = Costs::Duration::zero();
+    costs.intermediate_memory_time = Costs::Duration::zero();
+    costs.inaccurate = false;
+    return costs;
+  }
+
+  auto scale = calibration_->op_scale.find(OpKey(op_info));
+  if (scale != calibration_->op_scale.end()) {
+    const double factor = scale->second;
+    costs.execution_time =
+        Costs::Duration(costs.execution_time.count() * factor);
+    costs.compute_time = Costs::Duration(costs.compute_time.count() * factor);
+    costs.memory_time = Costs::Duration(costs.memory_time.count() * factor);
+    costs.intermediate_memory_time =
+        Costs::Duration(costs.intermediate_memory_time.count() * factor);
+  }
+  return costs;
+}
+
+Status ReadCostTable(const std::string& filename, OpPerformanceList* table) {
+  Status status = ReadBinaryProto(Env::Default(), filename, table);
+  if (!status.ok()) {
+    table->Clear();
+    status = ReadTextProto(Env::Default(), filename, table);
+  }
+  return status;
+}
+
+std::unique_ptr<OpLevelCostEstimator> CreateOpLevelCostEstimator() {
+  static const CalibratedOpLevelCostEstimator* calibrated = [] {
+    std::string filename;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_COST_TABLE",
+                                     /*default_val=*/"", &filename));
+    if (filename.empty()) return (CalibratedOpLevelCostEstimator*)nullptr;
+    OpPerformanceList table;
+    Status status = ReadCostTable(filename, &table);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to read the cost table " << filename << ": "
+                   << status;
+      return (CalibratedOpLevelCostEstimator*)nullptr;
+    }
+    return new CalibratedOpLevelCostEstimator(table);
+  }();
+  if (calibrated == nullptr) return std::make_unique<OpLevelCostEstimator>();
+  return std::make_unique<CalibratedOpLevelCostEstimator>(*calibrated);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// An OpLevelCostEstimator calibrated with measured op costs.
+//
+// The measurements are an OpPerformanceList, the "cost table", usually built
+// with CostGraphToOpPerformanceData() from the cost graph that a session
+// returns in RunMetadata when GraphOptions.build_cost_model is set. The
+// execution time of an op is:
+//  - the average measured compute_cost of the measurements with the same
+//    device type, op and input shapes, if any;
+//  - otherwise the analytical estimate scaled by the ratio of the measured to
+//    the analytical execution time of the measurements with the same device
+//    type and op, if any;
+//  - otherwise the analytical estimate.
+class CalibratedOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  explicit CalibratedOpLevelCostEstimator(
+      const OpPerformanceList& measurements);
+
+  // Shares the calibration of `other`.
+  CalibratedOpLevelCostEstimator(const CalibratedOpLevelCostEstimator& other)
+      : OpLevelCostEstimator(), calibration_(other.calibration_) {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  struct Calibration {
+    // Average measured execution time in nanoseconds, keyed by device type
+    // and op description.
+    absl::flat_hash_map<std::string, int64_t> measured_ns;
+    // Ratio of the measured to the analytical execution time, keyed by device
+    // type and op.
+    absl::flat_hash_map<std::string, double> op_scale;
+  };
+
+  std::shared_ptr<const Calibration> calibration_;
+
+  void operator=(const CalibratedOpLevelCostEstimator&) = delete;
+};
+
+// Reads the cost table in `filename`, a binary or text OpPerformanceList.
+Status ReadCostTable(const std::string& filename, OpPerformanceList* table);
+
+// Returns the op level cost estimator used by default by grappler: a
+// CalibratedOpLevelCostEstimator for the cost table in the file named by the
+// TF_GRAPPLER_COST_TABLE environment variable, or an OpLevelCostEstimator if
+// it is unset or the table can't be read. The table is read once per process.
+std::unique_ptr<OpLevelCostEstimator> CreateOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_OP_LEVEL_COST_ESTIMATOR_H_
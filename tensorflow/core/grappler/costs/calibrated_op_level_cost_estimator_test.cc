@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/calibrated_op_level_cost_estimator.h"
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void DescribeMatrix(int rows, int columns, OpInfo* op_info) {
+  auto input = op_info->add_inputs();
+  auto shape = input->mutable_shape();
+  shape->add_dim()->set_size(rows);
+  shape->add_dim()->set_size(columns);
+  input->set_dtype(DT_FLOAT);
+}
+
+OpContext DescribeMatMul(int m, int n, int l, int k) {
+  OpContext op_context;
+  auto device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(10);
+  device->set_bandwidth(10000000);  // 10000000 KB/s = 10 GB/s
+  device->set_frequency(1000);      // 1000 Mhz = 1 GHz
+  op_context.op_info.set_op("MatMul");
+  DescribeMatrix(m, l, &op_context.op_info);
+  DescribeMatrix(k, n, &op_context.op_info);
+  return op_context;
+}
+
+void AddMeasurement(const OpContext& op_context, int64_t compute_cost_ns,
+                    OpPerformanceList* measurements) {
+  OpPerformance* perf = measurements->add_op_performance();
+  *perf->mutable_op() = op_context.op_info;
+  perf->set_compute_cost(compute_cost_ns);
+}
+
+class CalibratedOpLevelCostEstimatorTest : public ::testing::Test {
+ protected:
+  // The analytical execution time of `op_context`.
+  int64_t AnalyticalTime(const OpContext& op_context) const {
+    return analytical_.PredictCosts(op_context).execution_time.count();
+  }
+
+  OpLevelCostEstimator analytical_;
+};
+
+TEST_F(CalibratedOpLevelCostEstimatorTest, UsesMeasuredTimeOfSameShape) {
+  const OpContext matmul = DescribeMatMul(100, 100, 100, 100);
+  OpPerformanceList measurements;
+  AddMeasurement(matmul, 3000, &measurements);
+  AddMeasurement(matmul, 5000, &measurements);
+  CalibratedOpLevelCostEstimator estimator(measurements);
+
+  Costs costs = estimator.PredictCosts(matmul);
+  EXPECT_EQ(costs.execution_time.count(), 4000);
+  EXPECT_EQ(costs.compute_time.count(), 4000);
+  EXPECT_EQ(costs.memory_time.count(), 0);
+  EXPECT_FALSE(costs.inaccurate);
+}
+
+TEST_F(CalibratedOpLevelCostEstimatorTest, ScalesOtherShapesOfMeasuredOp) {
+  const OpContext measured = DescribeMatMul(100, 100, 100, 100);
+  OpPerformanceList measurements;
+  AddMeasurement(measured, 2 * AnalyticalTime(measured), &measurements);
+  CalibratedOpLevelCostEstimator estimator(measurements);
+
+  const OpContext other = DescribeMatMul(200, 300, 400, 400);
+  const int64_t analytical = AnalyticalTime(other);
+  EXPECT_NEAR(estimator.PredictCosts(other).execution_time.count(),
+              2 * analytical, 2);
+}
+
+TEST_F(CalibratedOpLevelCostEstimatorTest, KeepsAnalyticalTimeOfOtherOps) {
+  const OpContext matmul = DescribeMatMul(100, 100, 100, 100);
+  OpPerformanceList measurements;
+  AddMeasurement(matmul, 1, &measurements);
+  CalibratedOpLevelCostEstimator estimator(measurements);
+
+  OpContext batch_matmul = matmul;
+  batch_matmul.op_info.set_op("BatchMatMul");
+  EXPECT_EQ(estimator.PredictCosts(batch_matmul).execution_time,
+            analytical_.PredictCosts(batch_matmul).execution_time);
+}
+
+TEST_F(CalibratedOpLevelCostEstimatorTest, CopiesShareCalibration) {
+  const OpContext matmul = DescribeMatMul(10, 10, 10, 10);
+  OpPerformanceList measurements;
+  AddMeasurement(matmul, 1234, &measurements);
+  CalibratedOpLevelCostEstimator estimator(measurements);
+  CalibratedOpLevelCostEstimator copy(estimator);
+  EXPECT_EQ(copy.PredictCosts(matmul).execution_time.count(), 1234);
+}
+
+TEST_F(CalibratedOpLevelCostEstimatorTest, ReadsTextCostTable) {
+  OpPerformanceList measurements;
+  AddMeasurement(DescribeMatMul(10, 10, 10, 10), 1234, &measurements);
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "cost_table.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), filename, measurements));
+
+  OpPerformanceList table;
+  TF_ASSERT_OK(ReadCostTable(filename, &table));
+  ASSERT_EQ(table.op_performance_size(), 1);
+  EXPECT_EQ(table.op_performance(0).compute_cost(), 1234);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
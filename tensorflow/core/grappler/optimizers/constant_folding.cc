@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
@@ -1395,7 +1396,26 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     total_inputs_size += value->TotalBytes();
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  // Folding the same node on the same inputs, e.g. after a retrace, reuses
+  // the previously computed tensors.
+  ConstantFoldingCache* cache = ConstantFoldingCache::Global();
+  std::string cache_key;
+  std::vector<Tensor> cached_outputs;
+  if (cache != nullptr) {
+    std::vector<const Tensor*> input_tensors;
+    input_tensors.reserve(inputs.size());
+    for (const auto& input : inputs) input_tensors.push_back(input.tensor);
+    cache_key = ConstantFoldingCache::ComputeKey(node, input_tensors);
+  }
+  const bool cache_hit =
+      cache != nullptr && cache->Lookup(cache_key, &cached_outputs);
+  if (cache_hit) {
+    for (const Tensor& cached_output : cached_outputs) {
+      output_tensors.emplace_back(new Tensor(cached_output));
+    }
+  } else {
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  }
   if (output_tensors.empty()) {
     return Status(absl::StatusCode::kInvalidArgument,
                   "Expected at least one output.");
@@ -1420,6 +1440,18 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
       outputs->at(i) = NodeDef();
     }
   }
+
+  // Only results which fit within the constant size limits above are cached.
+  // Dead outputs are not, since they can't be told apart from a cache miss.
+  if (cache != nullptr && !cache_hit) {
+    std::vector<Tensor> outputs_to_cache;
+    outputs_to_cache.reserve(output_tensors.size());
+    for (const auto& output : output_tensors) {
+      if (output.tensor == nullptr) return absl::OkStatus();
+      outputs_to_cache.push_back(*output.tensor);
+    }
+    cache->Insert(cache_key, std::move(outputs_to_cache));
+  }
   return absl::OkStatus();
 }
 
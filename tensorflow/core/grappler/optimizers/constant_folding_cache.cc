@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Appends `field` followed by a separator, so that the concatenation of
+// fields is unambiguous.
+void AppendField(absl::string_view field, std::string* key_material) {
+  absl::StrAppend(key_material, field.size(), ":", field, ";");
+}
+
+void AppendTensor(const Tensor& tensor, std::string* key_material) {
+  AppendField(absl::StrCat(DataTypeString(tensor.dtype()), ":",
+                           tensor.shape().DebugString()),
+              key_material);
+  if (DataTypeCanUseMemcpy(tensor.dtype())) {
+    AppendField(tensor.tensor_data(), key_material);
+  } else {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    std::string serialized;
+    SerializeToStringDeterministic(proto, &serialized);
+    AppendField(serialized, key_material);
+  }
+}
+
+}  // namespace
+
+ConstantFoldingCache::ConstantFoldingCache(Options options)
+    : options_(std::move(options)) {}
+
+ConstantFoldingCache* ConstantFoldingCache::Global() {
+  static ConstantFoldingCache* cache = []() -> ConstantFoldingCache* {
+    Options options;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRAPPLER_CONSTANT_FOLDING_CACHE_BYTES",
+                                    /*default_val=*/0, &options.max_bytes));
+    if (options.max_bytes <= 0) return nullptr;
+    return new ConstantFoldingCache(std::move(options));
+  }();
+  return cache;
+}
+
+std::string ConstantFoldingCache::ComputeKey(
+    const NodeDef& node, absl::Span<const Tensor* const> inputs) {
+  NodeDef op_and_attrs;
+  op_and_attrs.set_op(node.op());
+  *op_and_attrs.mutable_attr() = node.attr();
+  std::string serialized;
+  SerializeToStringDeterministic(op_and_attrs, &serialized);
+
+  std::string key_material;
+  AppendField(serialized, &key_material);
+  AppendField(absl::StrCat(inputs.size()), &key_material);
+  for (const Tensor* input : inputs) AppendTensor(*input, &key_material);
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+bool ConstantFoldingCache::Lookup(const std::string& key,
+                                  std::vector<Tensor>* outputs) {
+  mutex_lock lock(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_position);
+  *outputs = it->second.outputs;
+  return true;
+}
+
+void ConstantFoldingCache::Insert(const std::string& key,
+                                  std::vector<Tensor> outputs) {
+  int64_t bytes = 0;
+  for (const Tensor& output : outputs) bytes += output.TotalBytes();
+  if (bytes > options_.max_bytes) {
+    VLOG(2) << "Not caching " << bytes << " bytes of folded tensors, the "
+            << "constant folding cache is limited to " << options_.max_bytes
+            << " bytes";
+    return;
+  }
+
+  mutex_lock lock(mu_);
+  Erase(key);
+  Entry& entry = entries_[key];
+  entry.outputs = std::move(outputs);
+  entry.bytes = bytes;
+  lru_list_.push_front(key);
+  entry.lru_position = lru_list_.begin();
+  total_bytes_ += bytes;
+  while (total_bytes_ > options_.max_bytes) {
+    const std::string oldest = lru_list_.back();
+    Erase(oldest);
+  }
+}
+
+int64_t ConstantFoldingCache::TotalBytes() {
+  mutex_lock lock(mu_);
+  return total_bytes_;
+}
+
+void ConstantFoldingCache::Erase(const std::string& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return;
+  total_bytes_ -= it->second.bytes;
+  lru_list_.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
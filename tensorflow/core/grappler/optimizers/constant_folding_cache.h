@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the tensors computed by constant folding, keyed by the folded node
+// and the values of its inputs, so that folding the same subgraph again (e.g.
+// when a function is retraced) does not reevaluate it. The cached tensors
+// share their buffers with the folded results, and the cache evicts the least
+// recently used entries once it holds more than `max_bytes`.
+class ConstantFoldingCache {
+ public:
+  struct Options {
+    // Maximum total size of the cached tensors. 0 disables the cache.
+    int64_t max_bytes = 0;
+  };
+
+  explicit ConstantFoldingCache(Options options);
+
+  // Returns the process-wide cache configured by the
+  // TF_GRAPPLER_CONSTANT_FOLDING_CACHE_BYTES environment variable, or nullptr
+  // if it is not set.
+  static ConstantFoldingCache* Global();
+
+  // Returns a key identifying the evaluation of `node` on `inputs`. The key
+  // covers the op and attributes of the node and the dtype, shape and content
+  // of the inputs, but not the name, inputs or device of the node.
+  static std::string ComputeKey(const NodeDef& node,
+                                absl::Span<const Tensor* const> inputs);
+
+  // Copies the cached outputs for `key` into `outputs`. Returns false if there
+  // are none.
+  bool Lookup(const std::string& key, std::vector<Tensor>* outputs);
+
+  // Caches `outputs` as the result for `key`, unless they are larger than the
+  // whole cache.
+  void Insert(const std::string& key, std::vector<Tensor> outputs);
+
+  // Total size of the cached tensors.
+  int64_t TotalBytes();
+
+ private:
+  struct Entry {
+    std::vector<Tensor> outputs;
+    int64_t bytes = 0;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  void Erase(const std::string& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  mutex mu_;
+  // Keys ordered from the most to the least recently used.
+  std::list<std::string> lru_list_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+  int64_t total_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  ConstantFoldingCache(const ConstantFoldingCache&) = delete;
+  void operator=(const ConstantFoldingCache&) = delete;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+NodeDef MakeAddNode(const std::string& name) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("AddV2");
+  node.add_input("x");
+  node.add_input("y");
+  (*node.mutable_attr())["T"].set_type(DT_FLOAT);
+  return node;
+}
+
+TEST(ConstantFoldingCacheTest, KeyDependsOnOpAttrsAndInputValues) {
+  const Tensor x = test::AsTensor<float>({1.0f, 2.0f});
+  const Tensor y = test::AsTensor<float>({3.0f, 4.0f});
+  const NodeDef node = MakeAddNode("add");
+  const std::string key = ConstantFoldingCache::ComputeKey(node, {&x, &y});
+
+  // The name and inputs of the node don't matter, only the values it reads.
+  NodeDef renamed = MakeAddNode("other_add");
+  renamed.set_input(0, "other_x");
+  const Tensor x_copy = test::AsTensor<float>({1.0f, 2.0f});
+  EXPECT_EQ(key, ConstantFoldingCache::ComputeKey(renamed, {&x_copy, &y}));
+
+  const Tensor other_x = test::AsTensor<float>({1.0f, 5.0f});
+  EXPECT_NE(key, ConstantFoldingCache::ComputeKey(node, {&other_x, &y}));
+  const Tensor reshaped_x = test::AsTensor<float>({1.0f, 2.0f}, {2, 1});
+  EXPECT_NE(key, ConstantFoldingCache::ComputeKey(node, {&reshaped_x, &y}));
+  EXPECT_NE(key, ConstantFoldingCache::ComputeKey(node, {&y, &x}));
+
+  NodeDef sub = node;
+  sub.set_op("Sub");
+  EXPECT_NE(key, ConstantFoldingCache::ComputeKey(sub, {&x, &y}));
+  NodeDef other_attr = node;
+  (*other_attr.mutable_attr())["T"].set_type(DT_DOUBLE);
+  EXPECT_NE(key, ConstantFoldingCache::ComputeKey(other_attr, {&x, &y}));
+
+  const Tensor strings = test::AsTensor<tstring>({"a", "bc"});
+  const Tensor other_strings = test::AsTensor<tstring>({"ab", "c"});
+  EXPECT_NE(ConstantFoldingCache::ComputeKey(node, {&strings}),
+            ConstantFoldingCache::ComputeKey(node, {&other_strings}));
+}
+
+TEST(ConstantFoldingCacheTest, EvictsLeastRecentlyUsedWithinMemoryBound) {
+  ConstantFoldingCache::Options options;
+  // Room for two tensors of 4 floats.
+  options.max_bytes = 2 * 4 * sizeof(float);
+  ConstantFoldingCache cache(options);
+
+  const Tensor a = test::AsTensor<float>({1.0f, 2.0f, 3.0f, 4.0f});
+  const Tensor b = test::AsTensor<float>({5.0f, 6.0f, 7.0f, 8.0f});
+  cache.Insert("a", {a});
+  cache.Insert("b", {b});
+  EXPECT_EQ(cache.TotalBytes(), options.max_bytes);
+
+  std::vector<Tensor> outputs;
+  ASSERT_TRUE(cache.Lookup("a", &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(a, outputs[0]);
+
+  // "b" is the least recently used entry.
+  cache.Insert("c", {a});
+  EXPECT_FALSE(cache.Lookup("b", &outputs));
+  EXPECT_TRUE(cache.Lookup("a", &outputs));
+  EXPECT_TRUE(cache.Lookup("c", &outputs));
+  EXPECT_EQ(cache.TotalBytes(), options.max_bytes);
+
+  // Results larger than the whole cache are not kept, and don't evict others.
+  cache.Insert("large", {a, b, a});
+  EXPECT_FALSE(cache.Lookup("large", &outputs));
+  EXPECT_TRUE(cache.Lookup("a", &outputs));
+  EXPECT_TRUE(cache.Lookup("c", &outputs));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,268 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/jpeg_decode_resize_fusion.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDecodeAndCropJpegOp[] = "DecodeAndCropJpeg";
+constexpr char kDecodeCropAndResizeJpegOp[] = "DecodeCropAndResizeJpeg";
+constexpr char kExpandDimsOp[] = "ExpandDims";
+constexpr char kResizeBilinearOp[] = "ResizeBilinear";
+constexpr char kConstOp[] = "Const";
+constexpr char kFuncAttr[] = "f";
+
+// Map datasets whose function is stored in the `f` attribute.
+constexpr const char* kMapDatasetOps[] = {
+    "MapDataset", "ParallelMapDataset", "ParallelMapDatasetV2",
+    "MapAndBatchDataset"};
+
+// Attributes of `DecodeAndCropJpeg` and `ResizeBilinear` which are forwarded
+// to the fused node.
+constexpr const char* kDecodeAttrs[] = {"channels", "fancy_upscaling",
+                                        "try_recover_truncated",
+                                        "acceptable_fraction", "dct_method"};
+constexpr const char* kResizeAttrs[] = {"align_corners", "half_pixel_centers"};
+
+// Returns the name of the node or argument of a function input or return
+// value, e.g. "x" for "x:y:0" or "^x".
+std::string InputName(absl::string_view input) {
+  input = absl::StripPrefix(input, "^");
+  return std::string(input.substr(0, input.find(':')));
+}
+
+// Returns the number of node inputs and return values of `func` which refer
+// to the node `name`, including control inputs.
+int NumReferences(const FunctionDef& func, absl::string_view name) {
+  int num_references = 0;
+  for (const NodeDef& node : func.node_def()) {
+    for (const std::string& input : node.input()) {
+      if (InputName(input) == name) ++num_references;
+    }
+  }
+  for (const auto& [unused, ret] : func.ret()) {
+    if (InputName(ret) == name) ++num_references;
+  }
+  for (const auto& [unused, control_ret] : func.control_ret()) {
+    if (control_ret == name) ++num_references;
+  }
+  return num_references;
+}
+
+// Returns the node of `func` which produces `input`, or nullptr if `input` is
+// a control input or a function argument.
+const NodeDef* InputNode(const FunctionDef& func, absl::string_view input) {
+  if (IsControlInput(input)) return nullptr;
+  const int index =
+      function_utils::FindFunctionNodeWithName(InputName(input), func);
+  return index < 0 ? nullptr : &func.node_def(index);
+}
+
+bool HasType(const NodeDef& node, DataType type) {
+  const AttrValue* t = gtl::FindOrNull(node.attr(), "T");
+  return t != nullptr && t->type() == type;
+}
+
+// Returns true if `input` is produced by a constant node holding the scalar
+// zero.
+bool IsZeroConst(const FunctionDef& func, absl::string_view input) {
+  const NodeDef* node = InputNode(func, input);
+  if (node == nullptr || node->op() != kConstOp) return false;
+  const AttrValue* value = gtl::FindOrNull(node->attr(), "value");
+  Tensor tensor;
+  if (value == nullptr || !tensor.FromProto(value->tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  switch (tensor.dtype()) {
+    case DT_INT32:
+      return tensor.flat<int32>()(0) == 0;
+    case DT_INT64:
+      return tensor.flat<int64_t>()(0) == 0;
+    default:
+      return false;
+  }
+}
+
+// Returns true if the DCT scaling of `decode` is not set, since the fused op
+// picks the scale itself.
+bool HasNoRatio(const NodeDef& decode) {
+  const AttrValue* ratio = gtl::FindOrNull(decode.attr(), "ratio");
+  return ratio == nullptr || ratio->i() == 1;
+}
+
+// Makes the references to the node `from` refer to output `to` instead, or to
+// the node of `to` for control inputs.
+void ReplaceNodeReferences(const std::string& from, const std::string& to,
+                           FunctionDef* func) {
+  const std::string to_node = InputName(to);
+  for (NodeDef& node : *func->mutable_node_def()) {
+    for (std::string& input : *node.mutable_input()) {
+      if (InputName(input) != from) continue;
+      input = IsControlInput(input) ? absl::StrCat("^", to_node) : to;
+    }
+  }
+  for (auto& [unused, ret] : *func->mutable_ret()) {
+    if (InputName(ret) == from) ret = to;
+  }
+  for (auto& [unused, control_ret] : *func->mutable_control_ret()) {
+    if (control_ret == from) control_ret = to_node;
+  }
+}
+
+void DeleteNode(const std::string& name, FunctionDef* func) {
+  const int index = function_utils::FindFunctionNodeWithName(name, *func);
+  if (index >= 0) {
+    func->mutable_node_def()->DeleteSubrange(index, 1);
+  }
+}
+
+// Fuses one `DecodeAndCropJpeg` -> `ExpandDims` -> `ResizeBilinear` chain of
+// `func`, and returns false if `func` has none. The intermediate values must
+// have no other consumers, otherwise the full-resolution crop is needed anyway.
+bool FuseDecodeAndResize(FunctionDef* func) {
+  for (const NodeDef& resize : func->node_def()) {
+    if (resize.op() != kResizeBilinearOp || resize.input_size() < 2 ||
+        !HasType(resize, DT_UINT8)) {
+      continue;
+    }
+    const NodeDef* expand_dims = InputNode(*func, resize.input(0));
+    if (expand_dims == nullptr || expand_dims->op() != kExpandDimsOp ||
+        expand_dims->input_size() < 2 ||
+        !IsZeroConst(*func, expand_dims->input(1)) ||
+        NumReferences(*func, expand_dims->name()) != 1) {
+      continue;
+    }
+    const NodeDef* decode = InputNode(*func, expand_dims->input(0));
+    if (decode == nullptr || decode->op() != kDecodeAndCropJpegOp ||
+        decode->input_size() < 2 || !HasNoRatio(*decode) ||
+        NumReferences(*func, decode->name()) != 1) {
+      continue;
+    }
+
+    // Copies what is needed, since adding the fused node invalidates the
+    // references into `func`.
+    const std::string decode_name = decode->name();
+    const std::string expand_dims_name = expand_dims->name();
+    const std::string resize_name = resize.name();
+    std::vector<std::string> inputs = {decode->input(0), decode->input(1),
+                                       resize.input(1)};
+    std::vector<std::pair<std::string, AttrValue>> attrs;
+    for (const char* attr : kDecodeAttrs) {
+      if (const AttrValue* value = gtl::FindOrNull(decode->attr(), attr)) {
+        attrs.emplace_back(attr, *value);
+      }
+    }
+    for (const char* attr : kResizeAttrs) {
+      if (const AttrValue* value = gtl::FindOrNull(resize.attr(), attr)) {
+        attrs.emplace_back(attr, *value);
+      }
+    }
+    // Keeps the control dependencies of the removed nodes.
+    for (const NodeDef* node : {decode, &resize}) {
+      for (const std::string& input : node->input()) {
+        if (IsControlInput(input)) inputs.push_back(input);
+      }
+    }
+
+    NodeDef* fused = function_utils::AddNode(
+        /*name=*/"", kDecodeCropAndResizeJpegOp, inputs, attrs, func);
+    const std::string fused_output = absl::StrCat(fused->name(), ":image:0");
+    const int expand_dims_index =
+        function_utils::FindFunctionNodeWithName(expand_dims_name, *func);
+    NodeDef* new_expand_dims = func->mutable_node_def(expand_dims_index);
+    new_expand_dims->set_input(0, fused_output);
+    (*new_expand_dims->mutable_attr())["T"].set_type(DT_FLOAT);
+
+    DeleteNode(resize_name, func);
+    DeleteNode(decode_name, func);
+    ReplaceNodeReferences(resize_name,
+                          absl::StrCat(expand_dims_name, ":output:0"), func);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+Status JpegDecodeResizeFusion::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  // Maps the names of rewritten functions to the names of their copies.
+  absl::flat_hash_map<std::string, std::string> fused_names;
+  for (NodeDef& node : *output->mutable_node()) {
+    if (!absl::c_linear_search(kMapDatasetOps, node.op())) continue;
+    AttrValue* func_attr = gtl::FindOrNull(*node.mutable_attr(), kFuncAttr);
+    if (func_attr == nullptr) continue;
+    if (const std::string* fused_name =
+            gtl::FindOrNull(fused_names, func_attr->func().name())) {
+      func_attr->mutable_func()->set_name(*fused_name);
+      continue;
+    }
+    const FunctionDef* func = function_library.Find(func_attr->func().name());
+    if (func == nullptr) continue;
+
+    // Rewrites a copy, since other nodes may share the original function.
+    FunctionDef fused_func = *func;
+    int num_fusions = 0;
+    while (FuseDecodeAndResize(&fused_func)) ++num_fusions;
+    if (num_fusions == 0) continue;
+
+    graph_utils::SetUniqueGraphFunctionName(
+        absl::StrCat(func->signature().name(), "_jpeg_decode_resize_fusion"),
+        output->mutable_library(), &fused_func);
+    fused_names[func->signature().name()] = fused_func.signature().name();
+    func_attr->mutable_func()->set_name(fused_func.signature().name());
+    *output->mutable_library()->add_function() = std::move(fused_func);
+    stats->num_changes += num_fusions;
+  }
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(JpegDecodeResizeFusion,
+                            "jpeg_decode_resize_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
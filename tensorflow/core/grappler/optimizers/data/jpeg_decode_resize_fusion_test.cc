@@ -0,0 +1,154 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/jpeg_decode_resize_fusion.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+// Returns a map function which decodes and crops a JPEG image and resizes it
+// to 224x224. If `return_crop` is true, the full-resolution crop is returned
+// as well.
+FunctionDef DecodeCropAndResize(int ratio = 1, bool return_crop = false) {
+  std::vector<std::pair<string, string>> ret = {
+      {"image", "resize:resized_images:0"}};
+  std::vector<string> out_def = {"image: float"};
+  if (return_crop) {
+    ret.push_back({"crop", "decode:image:0"});
+    out_def.push_back("crop: uint8");
+  }
+  return FunctionDefHelper::Create(
+      "DecodeCropAndResize", {"contents: string", "crop_window: int32"},
+      out_def, /*attr_def=*/{},
+      {{{"decode"},
+        "DecodeAndCropJpeg",
+        {"contents", "crop_window"},
+        {{"channels", 3},
+         {"ratio", ratio},
+         {"dct_method", "INTEGER_ACCURATE"}}},
+       {{"axis"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int32>(0)}, {"dtype", DT_INT32}}},
+       {{"expand_dims"},
+        "ExpandDims",
+        {"decode:image:0", "axis:output:0"},
+        {{"T", DT_UINT8}, {"Tdim", DT_INT32}}},
+       {{"size"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<int32>({224, 224})}, {"dtype", DT_INT32}}},
+       {{"resize"},
+        "ResizeBilinear",
+        {"expand_dims:output:0", "size:output:0"},
+        {{"T", DT_UINT8}, {"half_pixel_centers", true}}}},
+      ret);
+}
+
+GraphDef MakeGraph(const FunctionDef& func) {
+  return test::function::GDef(
+      {NDef("files", "Const", {}, {{"value", 0}, {"dtype", DT_STRING}}),
+       NDef("files_dataset", "TensorSliceDataset", {"files"}, {}),
+       MakeMapNode("map", "files_dataset", func.signature().name())},
+      {func});
+}
+
+TEST(JpegDecodeResizeFusionTest, FusesDecodeCropAndResize) {
+  GrapplerItem item;
+  item.graph = MakeGraph(DecodeCropAndResize());
+
+  JpegDecodeResizeFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithName("map", output));
+  const string& func_name = map_node.attr().at("f").func().name();
+  EXPECT_NE(func_name, "DecodeCropAndResize");
+  const FunctionDef& func = output.library().function(
+      graph_utils::FindGraphFunctionWithName(func_name, output.library()));
+  EXPECT_FALSE(function_utils::ContainsFunctionNodeWithOp("DecodeAndCropJpeg",
+                                                          func));
+  EXPECT_FALSE(
+      function_utils::ContainsFunctionNodeWithOp("ResizeBilinear", func));
+
+  const NodeDef& fused_node = func.node_def(
+      function_utils::FindFunctionNodeWithOp("DecodeCropAndResizeJpeg", func));
+  ASSERT_EQ(fused_node.input_size(), 3);
+  EXPECT_EQ(fused_node.input(0), "contents");
+  EXPECT_EQ(fused_node.input(1), "crop_window");
+  EXPECT_EQ(fused_node.input(2), "size:output:0");
+  EXPECT_EQ(fused_node.attr().at("channels").i(), 3);
+  EXPECT_EQ(fused_node.attr().at("dct_method").s(), "INTEGER_ACCURATE");
+  EXPECT_TRUE(fused_node.attr().at("half_pixel_centers").b());
+  EXPECT_FALSE(fused_node.attr().contains("ratio"));
+
+  const NodeDef& expand_dims = func.node_def(
+      function_utils::FindFunctionNodeWithName("expand_dims", func));
+  EXPECT_EQ(expand_dims.input(0), absl::StrCat(fused_node.name(), ":image:0"));
+  EXPECT_EQ(expand_dims.attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(func.ret().at("image"), "expand_dims:output:0");
+}
+
+TEST(JpegDecodeResizeFusionTest, CropHasOtherConsumers) {
+  GrapplerItem item;
+  item.graph =
+      MakeGraph(DecodeCropAndResize(/*ratio=*/1, /*return_crop=*/true));
+
+  JpegDecodeResizeFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithName("map", output));
+  EXPECT_EQ(map_node.attr().at("f").func().name(), "DecodeCropAndResize");
+  EXPECT_EQ(output.library().function_size(), 1);
+}
+
+TEST(JpegDecodeResizeFusionTest, RatioIsSet) {
+  GrapplerItem item;
+  item.graph = MakeGraph(DecodeCropAndResize(/*ratio=*/2));
+
+  JpegDecodeResizeFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithName("map", output));
+  EXPECT_EQ(map_node.attr().at("f").func().name(), "DecodeCropAndResize");
+  EXPECT_EQ(output.library().function_size(), 1);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
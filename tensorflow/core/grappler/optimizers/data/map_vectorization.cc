@@ -0,0 +1,325 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDatasetOp[] = "MapDataset";
+constexpr char kParallelMapDatasetOp[] = "ParallelMapDatasetV2";
+constexpr char kBatchDatasetOp[] = "BatchDataset";
+constexpr char kBatchDatasetV2Op[] = "BatchDatasetV2";
+constexpr char kConstOp[] = "Const";
+constexpr char kOutputShapesAttr[] = "output_shapes";
+constexpr char kOutputTypesAttr[] = "output_types";
+constexpr char kTargumentsAttr[] = "Targuments";
+
+// Element-wise ops. Applying one of them to a batch gives the batch of its
+// results for each element.
+// clang-format off
+constexpr const char* kUnaryElementwiseOps[] = {
+    "Abs", "Acos", "Acosh", "Asin", "Asinh", "Atan", "Atanh", "Cast", "Ceil",
+    "Cos", "Cosh", "Digamma", "Elu", "Erf", "Erfc", "Exp", "Expm1", "Floor",
+    "Identity", "Inv", "IsFinite", "IsInf", "IsNan", "Lgamma", "Log", "Log1p",
+    "LogicalNot", "Neg", "Reciprocal", "Relu", "Relu6", "Rint", "Round",
+    "Rsqrt", "Selu", "Sigmoid", "Sign", "Sin", "Sinh", "Softplus", "Softsign",
+    "Sqrt", "Square", "Tan", "Tanh"};
+constexpr const char* kBinaryElementwiseOps[] = {
+    "Add", "AddV2", "Atan2", "BitwiseAnd", "BitwiseOr", "BitwiseXor", "Div",
+    "DivNoNan", "Equal", "FloorDiv", "FloorMod", "Greater", "GreaterEqual",
+    "Less", "LessEqual", "LogicalAnd", "LogicalOr", "Maximum", "Minimum", "Mod",
+    "Mul", "MulNoNan", "NotEqual", "Pow", "RealDiv", "SquaredDifference", "Sub",
+    "TruncateDiv", "TruncateMod", "Xdivy", "Xlogy", "Xlog1py"};
+// clang-format on
+
+// What a value computed by a map function depends on.
+enum class ValueKind {
+  // The value is a scalar which doesn't depend on the element, so it
+  // broadcasts along the batch dimension.
+  kScalarConstant,
+  // The value is computed element-wise from the element.
+  kElement,
+  // The value can't be computed for a batch of elements at once.
+  kNotVectorizable,
+};
+
+bool IsScalarConst(const NodeDef& node) {
+  const AttrValue* value = gtl::FindOrNull(node.attr(), "value");
+  return value != nullptr && value->has_tensor() &&
+         !value->tensor().tensor_shape().unknown_rank() &&
+         value->tensor().tensor_shape().dim_size() == 0;
+}
+
+// Returns the name of the node or argument of a function input or return
+// value, e.g. "x" for "x:y:0".
+std::string InputName(absl::string_view input) {
+  return std::string(input.substr(0, input.find(':')));
+}
+
+// Returns true if applying `func` to a batch of elements gives the batch of
+// its results for each element.
+bool IsVectorizable(const FunctionDef& func) {
+  absl::flat_hash_map<std::string, const NodeDef*> nodes;
+  for (const NodeDef& node : func.node_def()) {
+    nodes[node.name()] = &node;
+  }
+  absl::flat_hash_map<std::string, ValueKind> kinds;
+  for (const auto& arg : func.signature().input_arg()) {
+    kinds[arg.name()] = ValueKind::kElement;
+  }
+
+  std::function<ValueKind(const std::string&)> kind_of =
+      [&](const std::string& name) -> ValueKind {
+    if (const ValueKind* kind = gtl::FindOrNull(kinds, name)) {
+      return *kind;
+    }
+    // Guards against cycles while the inputs are visited.
+    kinds[name] = ValueKind::kNotVectorizable;
+    const NodeDef* const* node = gtl::FindOrNull(nodes, name);
+    if (node == nullptr) {
+      return ValueKind::kNotVectorizable;
+    }
+    ValueKind kind = ValueKind::kNotVectorizable;
+    if ((*node)->op() == kConstOp) {
+      if (IsScalarConst(**node)) {
+        kind = ValueKind::kScalarConstant;
+      }
+    } else {
+      int expected_num_inputs = 0;
+      if (absl::c_linear_search(kUnaryElementwiseOps, (*node)->op())) {
+        expected_num_inputs = 1;
+      } else if (absl::c_linear_search(kBinaryElementwiseOps, (*node)->op())) {
+        expected_num_inputs = 2;
+      }
+      int num_inputs = 0;
+      kind = ValueKind::kScalarConstant;
+      for (const std::string& input : (*node)->input()) {
+        if (IsControlInput(input)) continue;
+        ++num_inputs;
+        ValueKind input_kind = kind_of(InputName(input));
+        if (input_kind == ValueKind::kNotVectorizable) {
+          kind = ValueKind::kNotVectorizable;
+          break;
+        }
+        if (input_kind == ValueKind::kElement) {
+          kind = ValueKind::kElement;
+        }
+      }
+      if (expected_num_inputs == 0 || num_inputs != expected_num_inputs) {
+        kind = ValueKind::kNotVectorizable;
+      }
+    }
+    kinds[name] = kind;
+    return kind;
+  };
+
+  for (const NodeDef& node : func.node_def()) {
+    if (kind_of(node.name()) == ValueKind::kNotVectorizable) {
+      return false;
+    }
+  }
+  // A constant output would not get a batch dimension.
+  for (const auto& [unused, ret] : func.ret()) {
+    if (kind_of(InputName(ret)) != ValueKind::kElement) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the rank shared by all components of the elements produced by
+// `node`, or `std::nullopt` if the ranks are unknown or differ. Binary ops
+// broadcast their inputs from the trailing dimensions, so components of
+// different ranks no longer line up once a batch dimension is prepended.
+std::optional<int> SharedElementRank(const NodeDef& node) {
+  const AttrValue* shapes = gtl::FindOrNull(node.attr(), kOutputShapesAttr);
+  if (shapes == nullptr || shapes->list().shape_size() == 0) {
+    return std::nullopt;
+  }
+  std::optional<int> rank;
+  for (const TensorShapeProto& shape : shapes->list().shape()) {
+    if (shape.unknown_rank() ||
+        (rank.has_value() && *rank != shape.dim_size())) {
+      return std::nullopt;
+    }
+    rank = shape.dim_size();
+  }
+  return rank;
+}
+
+// Returns true if the shapes of all components of the elements produced by
+// `node` are fully defined. Batching fails on elements of different shapes, so
+// batching the input of a map instead of its output is only safe if neither
+// varies in shape.
+bool HasStaticElementShapes(const NodeDef& node) {
+  const AttrValue* shapes = gtl::FindOrNull(node.attr(), kOutputShapesAttr);
+  if (shapes == nullptr || shapes->list().shape_size() == 0) {
+    return false;
+  }
+  for (const TensorShapeProto& shape : shapes->list().shape()) {
+    if (!PartialTensorShape(shape).IsFullyDefined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the size of the batch dimension of the elements of `batch_node`, or
+// -1 if it is unknown.
+int64_t BatchDimension(const NodeDef& batch_node) {
+  const AttrValue* shapes =
+      gtl::FindOrNull(batch_node.attr(), kOutputShapesAttr);
+  if (shapes == nullptr || shapes->list().shape_size() == 0 ||
+      shapes->list().shape(0).dim_size() == 0) {
+    return -1;
+  }
+  return shapes->list().shape(0).dim(0).size();
+}
+
+// Makes a batch node which batches the input of `map_node` instead of its
+// output.
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& map_input_node, MutableGraphView* graph) {
+  NodeDef new_node = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, map_node.input(0));
+  (*new_node.mutable_attr())[kOutputTypesAttr] =
+      map_input_node.attr().at(kOutputTypesAttr);
+  AttrValue::ListValue* shapes =
+      (*new_node.mutable_attr())[kOutputShapesAttr].mutable_list();
+  shapes->clear_shape();
+  const int64_t batch_dimension = BatchDimension(batch_node);
+  for (const TensorShapeProto& shape :
+       map_input_node.attr().at(kOutputShapesAttr).list().shape()) {
+    TensorShapeProto* batched_shape = shapes->add_shape();
+    batched_shape->add_dim()->set_size(batch_dimension);
+    for (const auto& dim : shape.dim()) {
+      *batched_shape->add_dim() = dim;
+    }
+  }
+  return new_node;
+}
+
+// Makes a map node which applies the function of `map_node` to the output of
+// `new_batch_node`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch_node, MutableGraphView* graph) {
+  NodeDef new_node = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, new_batch_node.name());
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_node);
+  return new_node;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDatasetOp && node.op() != kBatchDatasetV2Op) {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || (map_node->op() != kMapDatasetOp &&
+                                map_node->op() != kParallelMapDatasetOp)) {
+      continue;
+    }
+    // Captured inputs would not get a batch dimension, and the map can't be
+    // moved if other datasets consume its elements.
+    const AttrValue* targuments =
+        gtl::FindOrNull(map_node->attr(), kTargumentsAttr);
+    if ((targuments != nullptr && targuments->list().type_size() > 0) ||
+        graph.NumFanouts(*map_node, /*include_controlled_nodes=*/false) != 1) {
+      continue;
+    }
+    NodeDef* map_input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (map_input_node == nullptr ||
+        !map_input_node->attr().contains(kOutputTypesAttr) ||
+        !SharedElementRank(*map_input_node).has_value()) {
+      continue;
+    }
+    if (!HasStaticElementShapes(*map_input_node) ||
+        !HasStaticElementShapes(*map_node)) {
+      VLOG(2) << "Not vectorizing map " << map_node->name()
+              << " since the shapes of its input or output elements are not "
+                 "fully defined.";
+      continue;
+    }
+    const FunctionDef* func =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (func == nullptr || !IsVectorizable(*func)) {
+      VLOG(2) << "Not vectorizing map " << map_node->name()
+              << " since its function has ops which are not element-wise.";
+      continue;
+    }
+
+    NodeDef* new_batch_node = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *map_input_node, &graph));
+    NodeDef* new_map_node = graph.AddNode(
+        MakeMapNode(*map_node, batch_node, *new_batch_node, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_map_node->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using graph_tests_utils::MakeParallelMapV2Node;
+using test::function::NDef;
+
+// Returns the nodes of a `range(10)` dataset with scalar int64 elements.
+std::vector<NodeDef> RangeNodes() {
+  return {
+      NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+      NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+      NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+      NDef("range", "RangeDataset", {"start", "stop", "step"},
+           {{"output_shapes", absl::Span<const TensorShape>{TensorShape()}},
+            {"output_types", absl::Span<const DataType>{DT_INT64}}}),
+      NDef("batch_size", "Const", {}, {{"value", 5}, {"dtype", DT_INT64}}),
+      NDef("drop_remainder", "Const", {},
+           {{"value", false}, {"dtype", DT_BOOL}}),
+      NDef("num_parallel_calls", "Const", {},
+           {{"value", 2}, {"dtype", DT_INT64}}),
+  };
+}
+
+// Returns the graph `range(10).map(map_node).batch(5)`, where the elements of
+// `map_node` have the shape `map_output_shape`.
+GraphDef MakeGraph(NodeDef map_node, const FunctionDef& func,
+                   const PartialTensorShape& map_output_shape =
+                       PartialTensorShape({})) {
+  SetAttrValue(absl::Span<const PartialTensorShape>{map_output_shape},
+               &(*map_node.mutable_attr())["output_shapes"]);
+  SetAttrValue(absl::Span<const DataType>{DT_INT64},
+               &(*map_node.mutable_attr())["output_types"]);
+  std::vector<NodeDef> nodes = RangeNodes();
+  nodes.push_back(map_node);
+  nodes.push_back(MakeBatchV2Node("batch", map_node.name(), "batch_size",
+                                  "drop_remainder", /*parallel_copy=*/false));
+  return test::function::GDef(nodes, {func});
+}
+
+void ExpectVectorized(const GraphDef& output, absl::string_view map_op) {
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& batch_node = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(batch_node.attr().at("output_types").list().type(0), DT_INT64);
+  const TensorShapeProto& batch_shape =
+      batch_node.attr().at("output_shapes").list().shape(0);
+  ASSERT_EQ(batch_shape.dim_size(), 1);
+  EXPECT_EQ(batch_shape.dim(0).size(), -1);
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp(map_op, output));
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+}
+
+TEST(MapVectorizationTest, VectorizeMap) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeMapNode("map", "range", "XTimesTwo"),
+                         test::function::XTimesTwo());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  ExpectVectorized(output, "MapDataset");
+}
+
+TEST(MapVectorizationTest, VectorizeParallelMap) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeParallelMapV2Node("map", "range",
+                                               "num_parallel_calls",
+                                               "XTimesTwo", "default"),
+                         test::function::XTimesTwo());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  ExpectVectorized(output, "ParallelMapDatasetV2");
+}
+
+TEST(MapVectorizationTest, NotElementwise) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeMapNode("map", "range", "RandomUniform"),
+                         test::function::RandomUniform());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, MapOutputShapeNotFullyDefined) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeMapNode("map", "range", "XTimesTwo"),
+                         test::function::XTimesTwo(),
+                         /*map_output_shape=*/PartialTensorShape({-1}));
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, CapturedInputs) {
+  GrapplerItem item;
+  NodeDef map_node = MakeMapNode("map", "range", "XTimesTwo");
+  map_node.add_input("batch_size");
+  SetAttrValue(std::vector<DataType>{DT_INT64},
+               &(*map_node.mutable_attr())["Targuments"]);
+  item.graph = MakeGraph(map_node, test::function::XTimesTwo());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, MapWithOtherConsumers) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeMapNode("map", "range", "XTimesTwo"),
+                         test::function::XTimesTwo());
+  *item.graph.add_node() = MakeBatchV2Node(
+      "other_batch", "map", "batch_size", "drop_remainder",
+      /*parallel_copy=*/false);
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -107,6 +109,41 @@ inline bool ConvBackpropExists(const TransposeContext& context,
   return false;
 }
 
+// Returns true if the layout sensitive ops on CPU should be converted from
+// NCHW to NHWC for oneDNN, whose primitives prefer channels-last tensors: the
+// reorders between NHWC and oneDNN's blocked formats are cheaper, and many
+// primitives compute on NHWC directly. Only graphs with several NCHW layout
+// sensitive ops are converted, since the transposes between consecutive
+// converted ops cancel, leaving transposes at the boundaries of the NHWC
+// region only. The conversion can be disabled by setting
+// TF_ONEDNN_CONVERT_NCHW_TO_NHWC=0.
+inline bool OneDnnPrefersNhwc(const TransposeContext& context) {
+  if (!IsMKLEnabled()) return false;
+  bool convert = true;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_ONEDNN_CONVERT_NCHW_TO_NHWC",
+                                 /*default_val=*/true, &convert));
+  if (!convert) return false;
+
+  int num_nchw_ops = 0;
+  for (const auto& node : context.graph_view->GetNodes()) {
+    const auto* node_def = node.node();
+    if (!IsLayoutSensitiveOp(*node_def)) continue;
+    string device_type;
+    string task;
+    if (!DeviceNameUtils::SplitDeviceName(GetDeviceName(*node_def), &task,
+                                          &device_type) ||
+        !absl::StrContains(absl::AsciiStrToLower(device_type),
+                           absl::AsciiStrToLower(kCPU))) {
+      continue;
+    }
+    const auto* data_format_attr = node.GetAttr("data_format");
+    if (data_format_attr == nullptr) continue;
+    const string& data_format = data_format_attr->s();
+    if (data_format == kNCHW || data_format == "NCDHW") ++num_nchw_ops;
+  }
+  return num_nchw_ops >= 2;
+}
+
 inline std::pair<string, string> GetSrcAndDstDataFormats(
     const TransposeContext& context, GpuStats gpu_stats) {
   string src_format = kNHWC;
@@ -456,8 +493,9 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
 
 // When there is a GPU, the computation graph is converted to NCHW format.
 // When there is only CPU, there will be no conversion by default, unless user
-// chose to convert the graph to a desired format. Currently, NCHW -> NHWC
-// format conversion is available on CPU.
+// chose to convert the graph to a desired format or oneDNN is enabled and the
+// graph has several NCHW layout sensitive ops. Currently, NCHW -> NHWC format
+// conversion is available on CPU.
 Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
                                         const GrapplerItem& item,
                                         GraphDef* output) {
@@ -490,7 +528,13 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   } else {
     TF_RETURN_IF_ERROR(TransposeContext::InitializeTransposeContext(
         /*assume_valid_feeds=*/is_aggressive, item, cluster, &context));
-    switch (cpu_layout_conversion_) {
+    RewriterConfig::CpuLayout cpu_layout_conversion = cpu_layout_conversion_;
+    if (cpu_layout_conversion == RewriterConfig::NO_CONVERSION_ON_CPU &&
+        enforced_layout_.empty() && OneDnnPrefersNhwc(context)) {
+      VLOG(2) << "Converting NCHW to NHWC on CPU for oneDNN.";
+      cpu_layout_conversion = RewriterConfig::NCHW_TO_NHWC;
+    }
+    switch (cpu_layout_conversion) {
       case RewriterConfig::NCHW_TO_NHWC:
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
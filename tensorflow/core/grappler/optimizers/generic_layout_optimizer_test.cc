@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -775,6 +776,74 @@ TEST_F(GenericLayoutOptimizerTest, OptimizeSimpleConv3DGraph_CPU) {
 #endif
 }
 
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+// Builds `num_convs` chained NCHW Conv2D nodes on CPU named "Conv2D_<i>".
+GrapplerItem NchwConv2DChainItem(int num_convs) {
+  Scope s = Scope::NewRootScope();
+  Tensor input_data(DT_FLOAT, TensorShape({8, 3, 16, 16}));
+  test::FillIota<float>(&input_data, 1.0f);
+  Output output =
+      ops::Const(s.WithOpName("Input"), Input::Initializer(input_data));
+  Tensor filter_data(DT_FLOAT, TensorShape({2, 2, 3, 3}));
+  test::FillIota<float>(&filter_data, 1.0f);
+  Output filter =
+      ops::Const(s.WithOpName("Filter"), Input::Initializer(filter_data));
+  for (int i = 0; i < num_convs; ++i) {
+    output = ops::Conv2D(
+        s.WithOpName(absl::StrCat("Conv2D_", i)).WithDevice("/CPU:0"), output,
+        filter, {1, 1, 1, 1}, "SAME",
+        ops::Conv2D::Attrs().DataFormat("NCHW"));
+  }
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {output});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"Fetch"};
+  return item;
+}
+
+TEST_F(GenericLayoutOptimizerTest, OneDnnConvertsNchwChainsToNhwc) {
+  if (!IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to oneDNN.";
+
+  GrapplerItem item = NchwConv2DChainItem(/*num_convs=*/3);
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NO_CONVERSION_ON_CPU);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  for (int i = 0; i < 3; ++i) {
+    auto* conv_node = graph_view.GetNode(absl::StrCat("Conv2D_", i));
+    ASSERT_NE(conv_node, nullptr);
+    VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+  }
+  // The transposes between consecutive convolutions cancel out.
+  int num_transposes = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Transpose") ++num_transposes;
+  }
+  EXPECT_EQ(num_transposes, 2);
+}
+
+TEST_F(GenericLayoutOptimizerTest, OneDnnKeepsSingleNchwOp) {
+  if (!IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to oneDNN.";
+
+  GrapplerItem item = NchwConv2DChainItem(/*num_convs=*/1);
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NO_CONVERSION_ON_CPU);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D_0");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+}
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -440,8 +441,145 @@ void RecomputeSubgraph(
   }
 }
 
+// Recomputes all of `subgraphs`, whose nodes belong to the topologically
+// sorted `graph`.
+void RecomputeSubgraphs(const std::vector<RecomputedSubGraph>& subgraphs,
+                        const NodeMap& node_map, GraphDef* graph) {
+  if (subgraphs.empty()) return;
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < graph->node().size();
+       ++node_number) {
+    topological_numbering[graph->mutable_node(node_number)] =
+        graph->node().size() - node_number - 1;
+  }
+  // Duplicate the indicated sub-graphs and set up control dependencies
+  for (const RecomputedSubGraph& subgraph : subgraphs) {
+    RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
+                      node_map, topological_numbering, graph);
+  }
+}
+
+// Returns `subgraphs` with their nodes replaced by the nodes of the same name
+// in `node_map`, i.e. in a copy of the graph they were found in.
+std::vector<RecomputedSubGraph> TranslateSubgraphs(
+    const std::vector<RecomputedSubGraph>& subgraphs, const NodeMap& node_map) {
+  std::vector<RecomputedSubGraph> translated(subgraphs.size());
+  for (int i = 0; i < subgraphs.size(); ++i) {
+    for (const NodeDef* node : subgraphs[i].recomputed_source_nodes) {
+      translated[i].recomputed_source_nodes.insert(
+          node_map.GetNode(node->name()));
+    }
+    for (const NodeDef* node : subgraphs[i].target_nodes) {
+      translated[i].target_nodes.insert(node_map.GetNode(node->name()));
+    }
+  }
+  return translated;
+}
+
+// Simulates the execution of `item` on `cluster` with `subgraphs` of the
+// topologically sorted `graph` recomputed, and returns the memory usage of the
+// device with the highest peak.
+Status SimulatePeakMemoryUsage(const GrapplerItem& item, const GraphDef& graph,
+                               const std::vector<RecomputedSubGraph>& subgraphs,
+                               Cluster* cluster,
+                               GraphMemory::MemoryUsage* peak_usage) {
+  GraphDef recomputed_graph = graph;
+  NodeMap node_map(&recomputed_graph);
+  RecomputeSubgraphs(TranslateSubgraphs(subgraphs, node_map), node_map,
+                     &recomputed_graph);
+  GrapplerItem recomputed_item = item.WithGraph(std::move(recomputed_graph));
+  GraphMemory memory(recomputed_item);
+  TF_RETURN_IF_ERROR(memory.InferStatically(cluster->GetDevices()));
+  peak_usage->used_memory = -1;
+  for (const auto& device : cluster->GetDevices()) {
+    const GraphMemory::MemoryUsage& usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (usage.used_memory > peak_usage->used_memory) *peak_usage = usage;
+  }
+  if (peak_usage->used_memory < 0) {
+    return errors::Unavailable("Unknown peak memory usage");
+  }
+  return absl::OkStatus();
+}
+
+// Picks the subgraphs of `candidates` to recompute so that the simulated peak
+// memory usage fits in `memory_budget` bytes, at a low recomputation cost.
+// Subgraphs are picked greedily by the ratio of the memory they hold at the
+// peak to the cost of recomputing them, and the peak is simulated again after
+// each pick. The cost of a subgraph is the size of its outputs: ops which are
+// cheap to recompute are bound by memory bandwidth. Returns all the
+// candidates if the memory usage can not be simulated.
+std::vector<RecomputedSubGraph> SelectSubgraphsToRecompute(
+    const std::vector<RecomputedSubGraph>& candidates, int64_t memory_budget,
+    const GrapplerItem& item, const GraphDef& graph, Cluster* cluster) {
+  GraphProperties properties(item);
+  if (!properties
+           .InferStatically(/*assume_valid_feeds=*/true,
+                            /*aggressive_shape_inference=*/false,
+                            /*include_tensor_values=*/false)
+           .ok()) {
+    return candidates;
+  }
+  std::vector<int64_t> recompute_costs;
+  std::vector<std::unordered_set<string>> recomputed_node_names;
+  for (const RecomputedSubGraph& candidate : candidates) {
+    int64_t cost = 1;
+    std::unordered_set<string> names;
+    for (const NodeDef* node : candidate.recomputed_source_nodes) {
+      names.insert(node->name());
+      for (const auto& output : properties.GetOutputProperties(node->name())) {
+        cost += CalculateTensorSize(output);
+      }
+    }
+    recompute_costs.push_back(cost);
+    recomputed_node_names.push_back(std::move(names));
+  }
+
+  std::vector<RecomputedSubGraph> selected;
+  std::vector<bool> is_selected(candidates.size(), false);
+  while (true) {
+    GraphMemory::MemoryUsage peak_usage;
+    Status status =
+        SimulatePeakMemoryUsage(item, graph, selected, cluster, &peak_usage);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to simulate the peak memory usage: " << status;
+      return selected.empty() ? candidates : selected;
+    }
+    VLOG(2) << "Simulated peak memory usage with " << selected.size()
+            << " recomputed subgraphs: " << peak_usage.used_memory;
+    if (peak_usage.used_memory <= memory_budget) break;
+
+    int best_candidate = -1;
+    double best_score = 0.0;
+    for (int i = 0; i < candidates.size(); ++i) {
+      if (is_selected[i]) continue;
+      int64_t bytes_at_peak = 0;
+      for (const GraphMemory::LiveTensor& tensor : peak_usage.live_tensors) {
+        if (recomputed_node_names[i].count(tensor.node) > 0) {
+          bytes_at_peak += tensor.memory_used;
+        }
+      }
+      const double score = static_cast<double>(bytes_at_peak) /
+                           static_cast<double>(recompute_costs[i]);
+      if (score > best_score) {
+        best_score = score;
+        best_candidate = i;
+      }
+    }
+    // None of the remaining subgraphs holds memory at the peak.
+    if (best_candidate < 0) break;
+    is_selected[best_candidate] = true;
+    selected.push_back(candidates[best_candidate]);
+  }
+  VLOG(1) << "Recomputing " << selected.size() << " of " << candidates.size()
+          << " candidate subgraphs to fit a memory budget of "
+          << memory_budget << " bytes";
+  return selected;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
+                                int64_t memory_budget, Cluster* cluster,
                                 GraphDef* graph, const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
@@ -497,19 +635,14 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         },
         is_target);
   }
-  if (!recomputed_subgraphs.empty()) {
-    std::unordered_map<const NodeDef*, int> topological_numbering;
-    for (int node_number = 0; node_number < graph->node().size();
-         ++node_number) {
-      topological_numbering[graph->mutable_node(node_number)] =
-          graph->node().size() - node_number - 1;
-    }
-    // Duplicate the indicated sub-graphs and set up control dependencies
-    for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
-      RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
-                        node_map, topological_numbering, graph);
-    }
+  // With a memory budget, only recompute what is needed to fit in it
+  // according to the simulated execution of the graph.
+  if (memory_budget > 0 && cluster != nullptr &&
+      !recomputed_subgraphs.empty()) {
+    recomputed_subgraphs = SelectSubgraphsToRecompute(
+        recomputed_subgraphs, memory_budget, item, *graph, cluster);
   }
+  RecomputeSubgraphs(recomputed_subgraphs, node_map, graph);
 }
 
 bool SchedulingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1395,9 +1528,15 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    // If set, subgraphs are only recomputed as needed for the simulated peak
+    // memory usage to fit in this many bytes.
+    int64_t recomputation_memory_budget;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(
+        "TF_GRAPPLER_RECOMPUTATION_MEMORY_BUDGET_BYTES", /*default_val=*/0,
+        &recomputation_memory_budget));
+    RecomputationRewritingPass(
+        optimization_level_, recomputation_targets_name_scope_,
+        recomputation_memory_budget, cluster, &optimized_item.graph, item);
   }
 
   std::unordered_set<string> skip_list;
@@ -448,6 +448,59 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+// Builds a graph whose gradients need the outputs of a large and a small
+// cheap-to-recompute forward op.
+GrapplerItem CreateRecomputationBudgetItem() {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+  Output x_big = ops::Variable(s.WithOpName("x_big"), {512, 512}, DT_FLOAT);
+  Output x_small = ops::Variable(s.WithOpName("x_small"), {2, 2}, DT_FLOAT);
+  Output big = ops::Relu(s.WithOpName("big"), x_big);
+  Output small = ops::Sigmoid(s.WithOpName("small"), x_small);
+  Output big_out = ops::AddN(s.WithOpName("big_out"), {big});
+  Output small_out = ops::AddN(s.WithOpName("small_out"), {small});
+  Output big_grad = ops::AddN(s.WithOpName("gradients/big"), {big_out, big});
+  Output small_grad =
+      ops::AddN(s.WithOpName("gradients/small"), {small_out, small});
+  Output grad = ops::AddN(s.WithOpName("gradients/grad"),
+                          {ops::Sum(s.WithOpName("gradients/big_sum"),
+                                    big_grad, {0, 1}),
+                           ops::Sum(s.WithOpName("gradients/small_sum"),
+                                    small_grad, {0, 1})});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/grad"};
+  return item;
+}
+
+TEST_F(MemoryOptimizerTest, RecomputationWithinMemoryBudget) {
+  GrapplerItem item = CreateRecomputationBudgetItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+
+  // The simulated peak memory usage already fits: nothing is recomputed.
+  setenv("TF_GRAPPLER_RECOMPUTATION_MEMORY_BUDGET_BYTES", "1000000000000",
+         1 /* replace */);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+
+  // The large tensor is live at the peak and is recomputed first.
+  setenv("TF_GRAPPLER_RECOMPUTATION_MEMORY_BUDGET_BYTES", "1",
+         1 /* replace */);
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  NodeMap node_map(&output);
+  EXPECT_NE(node_map.GetNode("Recomputed/big"), nullptr);
+  EXPECT_EQ(node_map.GetNode("gradients/big")->input(1), "Recomputed/big");
+  unsetenv("TF_GRAPPLER_RECOMPUTATION_MEMORY_BUDGET_BYTES");
+
+  // Without a budget, every candidate is recomputed.
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  NodeMap heuristic_node_map(&output);
+  EXPECT_NE(heuristic_node_map.GetNode("Recomputed/big"), nullptr);
+  EXPECT_NE(heuristic_node_map.GetNode("Recomputed/small"), nullptr);
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
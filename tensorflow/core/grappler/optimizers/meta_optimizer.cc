@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -36,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/analytical_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -49,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_result_cache.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
@@ -62,10 +66,16 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
+#include "tsl/profiler/lib/traceme.h"
+#include "tsl/profiler/lib/traceme_encode.h"
 
 // #TODO(b/200087693): LLVM does not build on Fuchsia.
 #if !NO_LLVM_SUPPORT
@@ -90,6 +100,38 @@ int64_t NumEdges(const GraphDef& graph) {
   return num_edges;
 }
 
+// Returns true if the cost of the graph should be estimated before and after
+// each optimization pass, to export the cost delta of each pass. This runs the
+// analytical cost estimator twice per pass, so it is opt-in.
+bool EstimatePassCosts() {
+  static const bool estimate_pass_costs = [] {
+    bool estimate;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_GRAPPLER_ESTIMATE_PASS_COSTS",
+                                   /*default_val=*/false, &estimate));
+    return estimate;
+  }();
+  return estimate_pass_costs;
+}
+
+// Returns the execution time of `graph` in nanoseconds predicted by the
+// analytical cost estimator for `item` on the devices of `cluster`, or -1 if
+// it can't be estimated.
+int64_t EstimateExecutionTimeNs(Cluster* cluster, const GrapplerItem& item,
+                                const GraphDef& graph) {
+  AnalyticalCostEstimator estimator(cluster, /*use_static_shapes=*/true,
+                                    /*use_aggressive_shape_inference=*/false);
+  Costs costs;
+  Status status = estimator.Initialize(item);
+  if (status.ok()) {
+    status = estimator.PredictCosts(graph, /*run_metadata=*/nullptr, &costs);
+  }
+  if (!status.ok()) {
+    VLOG(2) << "Failed to estimate the cost of " << item.id << ": " << status;
+    return -1;
+  }
+  return costs.execution_time.count();
+}
+
 string PrintSizesBeforeAfter(const GraphDef& before, const GraphDef& after) {
   return strings::StrCat("Graph size after: ", after.node_size(), " nodes (",
                          after.node_size() - before.node_size(), "), ",
@@ -103,6 +145,17 @@ int NumIterations(const RewriterConfig& cfg) {
              : cfg.meta_optimizer_iterations();
 }
 
+// Returns the number of threads optimizing the function library, set by the
+// TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS environment variable. Defaults to
+// 1 (sequential); 0 uses one thread per core.
+int NumFunctionOptimizationThreads() {
+  int64_t num_threads;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS",
+                                  /*default_val=*/1, &num_threads));
+  return num_threads == 0 ? port::MaxParallelism()
+                          : static_cast<int>(num_threads);
+}
+
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
@@ -888,7 +941,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -938,6 +994,20 @@ Status MetaOptimizer::RunOptimizer(
   optimized_item->graph = std::move(*optimized_graph);
   *optimized_graph = GraphDef();
   optimizer->set_deadline_usec(this->deadline_usec());
+  const int64_t nodes_before = optimized_item->graph.node_size();
+  const bool estimate_cost = cluster != nullptr && EstimatePassCosts();
+  const int64_t cost_before_ns =
+      estimate_cost
+          ? EstimateExecutionTimeNs(cluster, *optimized_item,
+                                    optimized_item->graph)
+          : -1;
+  tsl::profiler::TraceMe trace_me(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "GrapplerPass",
+            {{"name", optimizer->name()}, {"nodes_before", nodes_before}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
   tensorflow::metrics::ScopedCounter<2> timings(
       tensorflow::metrics::GetGraphOptimizationCounter(),
       {kGrapplerCategory, optimizer->name()});
@@ -945,6 +1015,11 @@ Status MetaOptimizer::RunOptimizer(
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
   auto duration_ms = timings.DurationMicroSec().value() / 1000.0f;
   timings.ReportAndStop();
+  // Estimate the cost of the new graph before it is modified below.
+  const int64_t cost_after_ns =
+      cost_before_ns >= 0 && status.ok()
+          ? EstimateExecutionTimeNs(cluster, *optimized_item, *optimized_graph)
+          : cost_before_ns;
 
   string message;
   if (!status.ok()) {
@@ -978,6 +1053,22 @@ Status MetaOptimizer::RunOptimizer(
         optimized_graph_function_library.release());
   }
 
+  // If the optimizer failed, `optimized_graph` is the unmodified input graph.
+  const int64_t nodes_after = optimized_graph->node_size();
+  metrics::RecordGrapplerPassGraphSize(optimizer->name(), nodes_before,
+                                       nodes_after);
+  if (cost_before_ns >= 0 && cost_after_ns >= 0) {
+    metrics::RecordGrapplerPassEstimatedCost(optimizer->name(), cost_before_ns,
+                                             cost_after_ns);
+  }
+  trace_me.AppendMetadata([&] {
+    return tsl::profiler::TraceMeEncode(
+        {{"nodes_after", nodes_after},
+         {"cost_before_ns", cost_before_ns},
+         {"cost_after_ns", cost_after_ns},
+         {"status", status.ok() ? "ok" : status.ToString()}});
+  });
+
   OptimizerResult optimizer_result{optimizer->name(), message, status};
   optimization_result->results.push_back(optimizer_result);
 
@@ -1055,7 +1146,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1164,15 +1258,107 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of `func` into `optimized_func_graph`. Only reads
+  // `flib`, so it may run concurrently for different functions.
+  auto optimize_function = [&](const FunctionDef& func,
+                               GrapplerFunctionItem* func_item,
+                               GraphDef* optimized_func_graph) -> Status {
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
+  // Adds the optimized body of `func_item` to `flib`.
+  auto merge_function = [&](GrapplerFunctionItem& func_item,
+                            GraphDef&& optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    const string func_name = func_item.id;
+    func_item.SwapFunctionBody(std::move(optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+
+  // With more than one thread, the functions of a pass over the library are
+  // optimized concurrently against the library as it was at the start of the
+  // pass, and merged back in library order, so that the result does not
+  // depend on scheduling.
+  const int num_threads = NumFunctionOptimizationThreads();
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_optimizer", num_threads);
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs_to_optimize;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1192,87 +1378,47 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs_to_optimize.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    const int num_funcs = funcs_to_optimize.size();
+    std::vector<GrapplerFunctionItem> func_items(num_funcs);
+    std::vector<GraphDef> optimized_func_graphs(num_funcs);
+    if (thread_pool == nullptr || num_funcs <= 1) {
+      for (int i = 0; i < num_funcs; ++i) {
+        GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+        VLOG(3) << "Optimize function: function="
+                << funcs_to_optimize[i]->signature().name() << " [" << i
+                << " of " << optimized_graph->library().function_size() << "]";
+        TF_RETURN_IF_ERROR(optimize_function(
+            *funcs_to_optimize[i], &func_items[i], &optimized_func_graphs[i]));
+        TF_RETURN_IF_ERROR(merge_function(
+            func_items[i], std::move(optimized_func_graphs[i])));
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+    } else {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      VLOG(3) << "Optimize " << num_funcs << " functions on " << num_threads
+              << " threads";
+      std::vector<Status> statuses(num_funcs);
+      BlockingCounter counter(num_funcs);
+      for (int i = 0; i < num_funcs; ++i) {
+        thread_pool->Schedule([&, i]() {
+          statuses[i] =
+              optimize_function(*funcs_to_optimize[i], &func_items[i],
+                                &optimized_func_graphs[i]);
+          counter.DecrementCount();
+        });
       }
-
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
-        }
+      counter.Wait();
+      for (int i = 0; i < num_funcs; ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(merge_function(
+            func_items[i], std::move(optimized_func_graphs[i])));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1321,6 +1467,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock lock(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
@@ -1369,11 +1516,26 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  MetaOptimizerResultCache* cache = MetaOptimizerResultCache::Global();
+  std::string cache_key;
+  if (cache != nullptr) {
+    cache_key = MetaOptimizerResultCache::ComputeKey(item, cfg, cluster);
+    if (cache->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Reusing cached optimization result for grappler item: "
+              << item.id;
+      return absl::OkStatus();
+    }
+  }
+
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+  if (cache != nullptr) {
+    cache->Insert(cache_key, *optimized_graph);
+  }
+  return absl::OkStatus();
 }
 
 Status OptimizeGraph(
@@ -0,0 +1,273 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_result_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Appends `field` followed by a separator, so that the concatenation of
+// fields is unambiguous.
+void AppendField(absl::string_view field, std::string* key_material) {
+  absl::StrAppend(key_material, field.size(), ":", field, ";");
+}
+
+void AppendProto(const protobuf::MessageLite& proto,
+                 std::string* key_material) {
+  std::string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendField(serialized, key_material);
+}
+
+template <typename Container>
+void AppendSorted(const Container& fields, std::string* key_material) {
+  std::vector<std::string> sorted(fields.begin(), fields.end());
+  std::sort(sorted.begin(), sorted.end());
+  AppendField(absl::StrCat(sorted.size()), key_material);
+  for (const std::string& field : sorted) AppendField(field, key_material);
+}
+
+// The environment variables which change what the optimizers produce.
+constexpr const char* kOptimizerEnvVars[] = {
+    "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_EMULATE_FP16",
+    "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_IGNORE_PERFORMANCE",
+    "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL",
+    "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_SIMULATE_GPU",
+    "TF_DISABLE_MKL",
+    "TF_ENABLE_FUSED_SCALED_DOT_PRODUCT_ATTENTION",
+    "TF_ENABLE_ONEDNN_OPTS",
+    "TF_ENABLE_ZENDNN_OPTS",
+    "TF_GRAPPLER_RECOMPUTATION_MEMORY_BUDGET_BYTES",
+    "TF_ONEDNN_CONVERT_NCHW_TO_NHWC",
+    "TF_USE_CUBLASLT",
+    "TF_USE_CUDNN_BATCHNORM_SPATIAL_PERSISTENT",
+};
+
+// The op lists of the auto mixed precision optimizer, which are edited by
+// TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_<list>_ADD and _REMOVE.
+constexpr const char* kAutoMixedPrecisionLists[] = {
+    "ALLOWLIST", "INFERLIST", "DENYLIST",  "CLEARLIST",
+    "WHITELIST", "GRAYLIST",  "BLACKLIST",
+};
+
+void AppendEnvVar(const std::string& name, std::string* key_material) {
+  const char* value = std::getenv(name.c_str());
+  AppendField(name, key_material);
+  // Distinguishes an unset variable from an empty one.
+  AppendField(value == nullptr ? "0" : absl::StrCat("1", value), key_material);
+}
+
+// Appends what the optimizers depend on besides the item and the
+// configuration: the TensorFlow version, the registered custom and plugin
+// optimizers, and the environment variables which tune the optimizers.
+// Without these, a result cached on disk would be served after an upgrade
+// or a change of the environment makes it stale.
+void AppendOptimizerEnvironment(const std::set<std::string>& device_types,
+                                std::string* key_material) {
+  AppendField(TF_VERSION_STRING, key_material);
+  AppendField(absl::StrCat(TF_GRAPH_DEF_VERSION), key_material);
+  AppendSorted(CustomGraphOptimizerRegistry::GetRegisteredOptimizers(),
+               key_material);
+  std::vector<std::string> plugin_names;
+  for (const auto& optimizer :
+       PluginGraphOptimizerRegistry::CreateOptimizers(device_types)) {
+    plugin_names.push_back(optimizer->name());
+  }
+  AppendSorted(plugin_names, key_material);
+  for (const char* name : kOptimizerEnvVars) {
+    AppendEnvVar(name, key_material);
+  }
+  for (const char* list : kAutoMixedPrecisionLists) {
+    for (const char* action : {"_ADD", "_REMOVE"}) {
+      AppendEnvVar(
+          absl::StrCat("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_", list, action),
+          key_material);
+    }
+  }
+}
+
+}  // namespace
+
+MetaOptimizerResultCache::MetaOptimizerResultCache(Options options)
+    : options_(std::move(options)) {}
+
+MetaOptimizerResultCache* MetaOptimizerResultCache::Global() {
+  static MetaOptimizerResultCache* cache = []() -> MetaOptimizerResultCache* {
+    Options options;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRAPPLER_RESULT_CACHE_ENTRIES",
+                                    /*default_val=*/0, &options.max_entries));
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_RESULT_CACHE_DIR",
+                                     /*default_val=*/"", &options.directory));
+    if (options.max_entries <= 0 && options.directory.empty()) {
+      return nullptr;
+    }
+    return new MetaOptimizerResultCache(std::move(options));
+  }();
+  return cache;
+}
+
+std::string MetaOptimizerResultCache::ComputeKey(const GrapplerItem& item,
+                                                 const ConfigProto& cfg,
+                                                 const Cluster* cluster) {
+  std::string key_material;
+  AppendProto(item.graph, &key_material);
+  AppendProto(cfg, &key_material);
+
+  AppendField(absl::StrCat(item.fetch.size()), &key_material);
+  for (const std::string& fetch : item.fetch) {
+    AppendField(fetch, &key_material);
+  }
+  AppendField(absl::StrCat(item.feed.size()), &key_material);
+  for (const auto& [name, tensor] : item.feed) {
+    AppendField(absl::StrCat(name, ":", DataTypeString(tensor.dtype()), ":",
+                             tensor.shape().DebugString()),
+                &key_material);
+  }
+  AppendSorted(item.init_ops, &key_material);
+  AppendSorted(item.keep_ops, &key_material);
+  AppendSorted(item.devices(), &key_material);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  AppendField(
+      absl::StrCat(options.allow_non_differentiable_rewrites, ",",
+                   options.allow_pruning_stateful_and_dataset_ops, ",",
+                   options.optimize_function_library, ",",
+                   options.is_eager_mode, ",",
+                   options.intra_op_parallelism_threads),
+      &key_material);
+
+  std::set<std::string> device_types;
+  if (cluster != nullptr) {
+    std::vector<std::string> device_names;
+    for (const auto& device : cluster->GetDevices()) {
+      device_names.push_back(device.first);
+      device_types.insert(device.second.type());
+    }
+    std::sort(device_names.begin(), device_names.end());
+    AppendField(absl::StrCat(device_names.size()), &key_material);
+    for (const std::string& name : device_names) {
+      AppendField(name, &key_material);
+      AppendProto(cluster->GetDevices().at(name), &key_material);
+    }
+  }
+  AppendOptimizerEnvironment(device_types, &key_material);
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+bool MetaOptimizerResultCache::Lookup(const std::string& key,
+                                      GraphDef* optimized_graph) {
+  {
+    mutex_lock lock(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_position);
+      *optimized_graph = it->second.graph;
+      return true;
+    }
+  }
+  if (options_.directory.empty()) return false;
+
+  Env* env = Env::Default();
+  const std::string file_path = GetFilePath(key);
+  if (!env->FileExists(file_path).ok()) return false;
+  GraphDef graph;
+  Status status = ReadBinaryProto(env, file_path, &graph);
+  if (!status.ok()) {
+    VLOG(1) << "Failed to read cached optimization result " << file_path
+            << ": " << status;
+    return false;
+  }
+  {
+    mutex_lock lock(mu_);
+    InsertInMemory(key, graph);
+  }
+  *optimized_graph = std::move(graph);
+  return true;
+}
+
+void MetaOptimizerResultCache::Insert(const std::string& key,
+                                      const GraphDef& optimized_graph) {
+  {
+    mutex_lock lock(mu_);
+    InsertInMemory(key, optimized_graph);
+  }
+  if (options_.directory.empty()) return;
+
+  // Write to a unique temporary file and move it into place, so that other
+  // processes sharing the directory never read a partially written result.
+  Env* env = Env::Default();
+  Status status = env->RecursivelyCreateDir(options_.directory);
+  std::string temp_path = io::JoinPath(options_.directory, key);
+  if (status.ok() && !env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
+    status = absl::UnavailableError(absl::StrCat(
+        "Could not create a unique file inside ", options_.directory));
+  }
+  if (status.ok()) status = WriteBinaryProto(env, temp_path, optimized_graph);
+  if (status.ok()) status = env->RenameFile(temp_path, GetFilePath(key));
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to save grappler optimization result to "
+                 << options_.directory << ": " << status;
+  }
+}
+
+void MetaOptimizerResultCache::InsertInMemory(const std::string& key,
+                                              const GraphDef& graph) {
+  if (options_.max_entries <= 0) return;
+  auto [it, inserted] = entries_.try_emplace(key);
+  if (!inserted) {
+    lru_list_.erase(it->second.lru_position);
+  }
+  it->second.graph = graph;
+  lru_list_.push_front(key);
+  it->second.lru_position = lru_list_.begin();
+  while (lru_list_.size() > options_.max_entries) {
+    entries_.erase(lru_list_.back());
+    lru_list_.pop_back();
+  }
+}
+
+std::string MetaOptimizerResultCache::GetFilePath(
+    const std::string& key) const {
+  return io::JoinPath(options_.directory, absl::StrCat(key, ".pb"));
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
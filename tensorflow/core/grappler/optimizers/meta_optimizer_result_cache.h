@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_RESULT_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the graphs produced by the meta optimizer, so that optimizing an
+// identical item with an identical configuration (e.g. when a session is
+// recreated or a function is retraced) skips all the optimization passes.
+// Results are kept in memory and, optionally, in a directory which persists
+// them across processes.
+class MetaOptimizerResultCache {
+ public:
+  struct Options {
+    // Maximum number of results kept in memory. 0 disables the in-memory
+    // cache.
+    int64_t max_entries = 0;
+
+    // If non-empty, results are also saved to and loaded from this directory.
+    std::string directory;
+  };
+
+  explicit MetaOptimizerResultCache(Options options);
+
+  // Returns the process-wide cache configured by the
+  // TF_GRAPPLER_RESULT_CACHE_ENTRIES and TF_GRAPPLER_RESULT_CACHE_DIR
+  // environment variables, or nullptr if neither is set.
+  static MetaOptimizerResultCache* Global();
+
+  // Returns a key identifying the optimization of `item` with `cfg` on the
+  // devices of `cluster` (which may be null). The key covers the graph, the
+  // fetch, feed, init and keep nodes, the optimization options, the devices
+  // and the configuration, including its `RewriterConfig`. It also covers the
+  // TensorFlow version, the registered custom and plugin optimizers and the
+  // environment variables which tune the optimizers, so that results saved
+  // by another build or environment are not reused.
+  static std::string ComputeKey(const GrapplerItem& item,
+                                const ConfigProto& cfg, const Cluster* cluster);
+
+  // Copies the cached result for `key` into `optimized_graph`. Returns false
+  // if there is none.
+  bool Lookup(const std::string& key, GraphDef* optimized_graph);
+
+  // Caches `optimized_graph` as the result for `key`.
+  void Insert(const std::string& key, const GraphDef& optimized_graph);
+
+ private:
+  struct Entry {
+    GraphDef graph;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  void InsertInMemory(const std::string& key, const GraphDef& graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  std::string GetFilePath(const std::string& key) const;
+
+  const Options options_;
+
+  mutex mu_;
+  // Keys ordered from the most to the least recently used.
+  std::list<std::string> lru_list_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+
+  MetaOptimizerResultCache(const MetaOptimizerResultCache&) = delete;
+  void operator=(const MetaOptimizerResultCache&) = delete;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_RESULT_CACHE_H_
@@ -0,0 +1,186 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_result_cache.h"
+
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem MakeItem() {
+  GrapplerItem item;
+  item.id = "item";
+  NodeDef* node = item.graph.add_node();
+  node->set_name("a");
+  node->set_op("NoOp");
+  item.fetch.push_back("a");
+  return item;
+}
+
+GraphDef MakeOptimizedGraph(const std::string& node_name) {
+  GraphDef graph;
+  NodeDef* node = graph.add_node();
+  node->set_name(node_name);
+  node->set_op("NoOp");
+  return graph;
+}
+
+TEST(MetaOptimizerResultCacheTest, KeyDependsOnItemAndConfig) {
+  GrapplerItem item = MakeItem();
+  ConfigProto cfg;
+  const std::string key =
+      MetaOptimizerResultCache::ComputeKey(item, cfg, /*cluster=*/nullptr);
+
+  GrapplerItem same_item = MakeItem();
+  same_item.id = "other_id";
+  EXPECT_EQ(key, MetaOptimizerResultCache::ComputeKey(same_item, cfg,
+                                                      /*cluster=*/nullptr));
+
+  GrapplerItem other_fetch = MakeItem();
+  other_fetch.fetch.push_back("b");
+  EXPECT_NE(key, MetaOptimizerResultCache::ComputeKey(other_fetch, cfg,
+                                                      /*cluster=*/nullptr));
+
+  GrapplerItem other_devices = MakeItem();
+  TF_ASSERT_OK(other_devices.AddDevice("/job:a/replica:0/task:0/device:CPU:0"));
+  EXPECT_NE(key, MetaOptimizerResultCache::ComputeKey(other_devices, cfg,
+                                                      /*cluster=*/nullptr));
+
+  ConfigProto other_cfg;
+  other_cfg.mutable_graph_options()->mutable_rewrite_options()->set_remapping(
+      RewriterConfig::OFF);
+  EXPECT_NE(key, MetaOptimizerResultCache::ComputeKey(item, other_cfg,
+                                                      /*cluster=*/nullptr));
+}
+
+// Sets an environment variable for the lifetime of the object, so that a
+// failing test does not leak it into the next ones.
+class ScopedEnvVar {
+ public:
+  ScopedEnvVar(const char* name, const char* value) : name_(name) {
+    if (const char* old_value = std::getenv(name)) old_value_ = old_value;
+    setenv(name, value, /*overwrite=*/1);
+  }
+
+  ~ScopedEnvVar() {
+    if (old_value_.has_value()) {
+      setenv(name_.c_str(), old_value_->c_str(), /*overwrite=*/1);
+    } else {
+      unsetenv(name_.c_str());
+    }
+  }
+
+ private:
+  const std::string name_;
+  std::optional<std::string> old_value_;
+};
+
+class NoOpCustomOptimizer : public CustomGraphOptimizer {
+ public:
+  std::string name() const override { return "NoOpCustomOptimizer"; }
+  bool UsesFunctionLibrary() const override { return false; }
+  Status Init(const RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override {
+    *optimized_graph = item.graph;
+    return OkStatus();
+  }
+};
+
+TEST(MetaOptimizerResultCacheTest, KeyDependsOnOptimizerEnvironment) {
+  GrapplerItem item = MakeItem();
+  ConfigProto cfg;
+  const std::string key =
+      MetaOptimizerResultCache::ComputeKey(item, cfg, /*cluster=*/nullptr);
+  {
+    ScopedEnvVar env_var("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL",
+                         "UNSAFE_FORCE_ALL");
+    EXPECT_NE(key, MetaOptimizerResultCache::ComputeKey(item, cfg,
+                                                        /*cluster=*/nullptr));
+  }
+  {
+    ScopedEnvVar env_var("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_ALLOWLIST_ADD",
+                         "MatMul");
+    EXPECT_NE(key, MetaOptimizerResultCache::ComputeKey(item, cfg,
+                                                        /*cluster=*/nullptr));
+  }
+  EXPECT_EQ(key, MetaOptimizerResultCache::ComputeKey(item, cfg,
+                                                      /*cluster=*/nullptr));
+
+  // Registering an optimizer, e.g. by loading a library, invalidates the
+  // results cached without it.
+  CustomGraphOptimizerRegistry::RegisterOptimizerOrDie(
+      []() { return new NoOpCustomOptimizer; },
+      "MetaOptimizerResultCacheTestOptimizer");
+  EXPECT_NE(key, MetaOptimizerResultCache::ComputeKey(item, cfg,
+                                                      /*cluster=*/nullptr));
+}
+
+TEST(MetaOptimizerResultCacheTest, EvictsLeastRecentlyUsed) {
+  MetaOptimizerResultCache::Options options;
+  options.max_entries = 2;
+  MetaOptimizerResultCache cache(options);
+
+  cache.Insert("a", MakeOptimizedGraph("a"));
+  cache.Insert("b", MakeOptimizedGraph("b"));
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("a", &graph));
+  EXPECT_EQ(graph.node(0).name(), "a");
+
+  // "b" is the least recently used entry.
+  cache.Insert("c", MakeOptimizedGraph("c"));
+  EXPECT_FALSE(cache.Lookup("b", &graph));
+  EXPECT_TRUE(cache.Lookup("a", &graph));
+  EXPECT_TRUE(cache.Lookup("c", &graph));
+}
+
+TEST(MetaOptimizerResultCacheTest, PersistsResultsInDirectory) {
+  MetaOptimizerResultCache::Options options;
+  options.directory =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_result_cache");
+  {
+    MetaOptimizerResultCache cache(options);
+    cache.Insert("key", MakeOptimizedGraph("optimized"));
+  }
+
+  // A new cache, e.g. in another process, loads the result from disk.
+  MetaOptimizerResultCache cache(options);
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  ASSERT_EQ(graph.node_size(), 1);
+  EXPECT_EQ(graph.node(0).name(), "optimized");
+  EXPECT_FALSE(cache.Lookup("missing_key", &graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -74,6 +74,14 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// BatchMatMulV2 + Mul + <Add> + Softmax + BatchMatMulV2 ->
+//   _FusedScaledDotProductAttention  // This fusion only works on CPU, and
+//                                    // is opt-in, see
+//                                    // FusedScaledDotProductAttentionEnabled.
+//
+// RandomUniform + GreaterEqual + {Mul,RealDiv} + SelectV2 -> _FusedDropout
+//   and the SelectV2 of its gradient -> _FusedDropoutGrad
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -91,7 +99,11 @@ constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
+constexpr char kFusedScaledDotProductAttention[] =
+    "_FusedScaledDotProductAttention";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedDropout[] = "_FusedDropout";
+constexpr char kFusedDropoutGrad[] = "_FusedDropoutGrad";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -301,6 +313,21 @@ struct ContractionWithBiasAndAddActivation {
   int bias_port = 1;
 };
 
+// SelectV2(GreaterEqual(RandomUniform(shape(x)), rate), x * scale, 0) that
+// can be replaced with a _FusedDropout, where the scale may also be applied
+// with a RealDiv. `gradients` are the other SelectV2 nodes with the same
+// condition, e.g. the ones computing the gradient of the dropout, which are
+// replaced with _FusedDropoutGrad nodes.
+struct Dropout {
+  int select = kMissingIndex;
+  int greater_equal = kMissingIndex;
+  int random_uniform = kMissingIndex;
+  int scale = kMissingIndex;
+  // The input of `scale` holding the scalar.
+  int scale_port = 1;
+  std::vector<int> gradients;
+};
+
 bool IsInPreserveSet(const RemapperContext& ctx, const NodeDef* node) {
   return ctx.nodes_to_preserve.count(node->name()) > 0;
 }
@@ -2956,6 +2983,334 @@ bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
   return found_op_type_match;
 }
 
+// Finds the attention block `Softmax(scale * Q * K^T [+ mask]) * V`, rooted at
+// the BatchMatMulV2 with V, and returns the inputs of the fused op (query, key,
+// value, scale and the optional mask) in `input_node_names`.
+bool FindFusedScaledDotProductAttention(
+    RemapperContext* ctx, int node_index,
+    std::map<string, int>* matched_nodes_map,
+    std::set<int>* remove_node_indices, std::vector<string>* input_node_names) {
+  // Disable fusions on CPU when XLA JIT compilation enabled.
+  if (ctx->xla_cpu_jit_disable_fusion) return false;
+  const auto* output_node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (output_node_def->op() != "BatchMatMulV2" ||
+      !NodeIsOnCpu(output_node_def) ||
+      GetDataTypeFromAttr(*output_node_def, "T") != DT_FLOAT) {
+    return false;
+  }
+
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  utils::OpTypePattern scaled_scores_pattern =
+    {"Mul", "scale_mul", NodeStatus::kRemove,
+      {
+        {"BatchMatMulV2", "scores", NodeStatus::kRemove},
+        {"Const", "scale", NodeStatus::kRemain}
+      }
+    };
+  utils::OpTypePattern masked_attention_pattern =
+    {"BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"Add|AddV2", "mask_add", NodeStatus::kRemove,
+              {
+                scaled_scores_pattern,
+                {"*", "mask", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  utils::OpTypePattern attention_pattern =
+    {"BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            scaled_scores_pattern
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  bool has_mask = false;
+  for (const auto* pattern : {&masked_attention_pattern, &attention_pattern}) {
+    matched_nodes_map->clear();
+    remove_node_indices->clear();
+    if (graph_matcher.GetMatchedNodes(*pattern, ctx->nodes_to_preserve,
+                                      ctx->graph_view.GetNode(node_index),
+                                      matched_nodes_map, remove_node_indices)) {
+      has_mask = pattern == &masked_attention_pattern;
+      break;
+    }
+    matched_nodes_map->clear();
+  }
+  if (matched_nodes_map->empty()) return false;
+
+  auto get_node = [&](const string& label) {
+    return ctx->graph_view.GetNode(matched_nodes_map->at(label))->node();
+  };
+  const NodeDef* scores_node_def = get_node("scores");
+  const NodeDef* scale_mul_node_def = get_node("scale_mul");
+  const NodeDef* softmax_node_def = get_node("softmax");
+  // The kernel computes Q * K^T * V, where Q, K and V are not adjointed.
+  auto is_adjointed = [](const NodeDef* batch_matmul, const string& attr) {
+    auto it = batch_matmul->attr().find(attr);
+    return it != batch_matmul->attr().end() && it->second.b();
+  };
+  if (GetDataTypeFromAttr(*scores_node_def, "T") != DT_FLOAT ||
+      is_adjointed(scores_node_def, "adj_x") ||
+      !is_adjointed(scores_node_def, "adj_y") ||
+      is_adjointed(output_node_def, "adj_x") ||
+      is_adjointed(output_node_def, "adj_y")) {
+    return false;
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+
+  // BatchMatMulV2 broadcasts the batch dimensions, the fused kernel requires
+  // them to be identical.
+  const auto& scores_inputs =
+      ctx->graph_properties.GetInputProperties(scores_node_def->name());
+  const auto& output_inputs =
+      ctx->graph_properties.GetInputProperties(output_node_def->name());
+  if (scores_inputs.size() != 2 || output_inputs.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_inputs[0].shape();
+  const TensorShapeProto& key_shape = scores_inputs[1].shape();
+  const TensorShapeProto& value_shape = output_inputs[1].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 2 || Rank(key_shape) != rank || Rank(value_shape) != rank) {
+    return false;
+  }
+  for (int d = 0; d < rank - 2; ++d) {
+    const int64_t size = query_shape.dim(d).size();
+    if (size == -1 || key_shape.dim(d).size() != size ||
+        value_shape.dim(d).size() != size) {
+      return false;
+    }
+  }
+
+  const NodeDef* scale_node_def = get_node("scale");
+  const auto& scale_props =
+      ctx->graph_properties.GetOutputProperties(scale_node_def->name());
+  if (scale_props.empty() || Rank(scale_props[0].shape()) != 0) return false;
+
+  // Returns the input of the binary `node_def` which is not produced by
+  // `other_input`.
+  auto get_other_input = [](const NodeDef* node_def,
+                            const NodeDef* other_input) -> const string& {
+    const bool first_is_other =
+        ParseTensorName(node_def->input(0)).node() == other_input->name();
+    return node_def->input(first_is_other ? 1 : 0);
+  };
+
+  input_node_names->clear();
+  input_node_names->push_back(scores_node_def->input(0));
+  input_node_names->push_back(scores_node_def->input(1));
+  input_node_names->push_back(output_node_def->input(1));
+  input_node_names->push_back(
+      get_other_input(scale_mul_node_def, scores_node_def));
+  if (has_mask) {
+    // The mask must not broadcast the scores to a larger shape.
+    const NodeDef* mask_add_node_def = get_node("mask_add");
+    const auto& mask_add_props =
+        ctx->graph_properties.GetOutputProperties(mask_add_node_def->name());
+    const auto& scale_mul_props =
+        ctx->graph_properties.GetOutputProperties(scale_mul_node_def->name());
+    const auto& mask_props = ctx->graph_properties.GetOutputProperties(
+        get_node("mask")->name());
+    if (mask_add_props.empty() || scale_mul_props.empty() ||
+        mask_props.empty() ||
+        !ShapesSymbolicallyEqual(mask_add_props[0].shape(),
+                                 scale_mul_props[0].shape()) ||
+        Rank(mask_props[0].shape()) < 0 ||
+        Rank(mask_props[0].shape()) > rank) {
+      return false;
+    }
+    input_node_names->push_back(
+        get_other_input(mask_add_node_def, scale_mul_node_def));
+  }
+  return GetDataTypeFromAttr(*softmax_node_def, "T") == DT_FLOAT;
+}
+
+// Returns true if `node` is a ZerosLike or a constant of zeros.
+bool IsZerosConstant(const NodeDef& node) {
+  if (IsZerosLike(node)) return true;
+  if (!IsConstant(node)) return false;
+  Tensor value;
+  if (!value.FromProto(node.attr().at("value").tensor())) return false;
+  const auto all_zeros = [&](auto zero) {
+    const auto flat = value.flat<decltype(zero)>();
+    for (int64_t i = 0; i < flat.size(); ++i) {
+      if (flat(i) != zero) return false;
+    }
+    return true;
+  };
+  switch (value.dtype()) {
+    case DT_HALF:
+      return all_zeros(Eigen::half(0));
+    case DT_BFLOAT16:
+      return all_zeros(bfloat16(0));
+    case DT_FLOAT:
+      return all_zeros(0.0f);
+    case DT_DOUBLE:
+      return all_zeros(0.0);
+    default:
+      return false;
+  }
+}
+
+// clang-format off
+// Dropout pattern, as emitted by tf.nn.dropout
+//
+//     shape(x)
+//        |
+//  RandomUniform   rate         x   scale
+//           \      /            \   /
+//         GreaterEqual     Mul or RealDiv   Const (value: 0)
+//            |      \             |           /
+//            |       +-------- SelectV2 -----+
+//            |
+//            +---------------- SelectV2(., gradients, zeros)  // backward
+// clang-format on
+// The GPU kernels of the fused dropout ops are off unless enabled, until they
+// are tested on GPUs.
+bool GpuFusedDropoutEnabled() {
+  static bool is_enabled = [] {
+    bool is_enabled = false;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_ENABLE_GPU_FUSED_DROPOUT", /*default_val=*/false, &is_enabled));
+    return is_enabled;
+  }();
+  return is_enabled;
+}
+
+bool FindDropout(const RemapperContext& ctx, int node_index,
+                 Dropout* matched) {
+  // XLA clusters would not compile the fused ops.
+  if (ctx.xla_auto_clustering_on) return false;
+
+  const auto* select_view = ctx.graph_view.GetNode(node_index);
+  const auto* select_node_def = select_view->node();
+  if (select_node_def->op() != "SelectV2" ||
+      select_view->NumRegularFanins() != 3 ||
+      HasControlFaninOrFanout(*select_view)) {
+    return false;
+  }
+  if (!NodeIsOnCpu(select_node_def) &&
+      !(NodeIsOnGpu(select_node_def) && GpuFusedDropoutEnabled())) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*select_node_def, "T");
+  if (dtype != DT_HALF && dtype != DT_BFLOAT16 && dtype != DT_FLOAT &&
+      dtype != DT_DOUBLE) {
+    return false;
+  }
+
+  const auto* greater_equal_view = select_view->GetRegularFanin(0).node_view();
+  const auto* greater_equal_node_def = greater_equal_view->node();
+  if (!IsGreaterEqual(*greater_equal_node_def) ||
+      HasControlFaninOrFanout(*greater_equal_view) ||
+      IsInPreserveSet(ctx, greater_equal_node_def)) {
+    return false;
+  }
+  const auto& greater_equal_props =
+      ctx.graph_properties.GetInputProperties(greater_equal_node_def->name());
+  if (greater_equal_props.size() != 2 ||
+      Rank(greater_equal_props[1].shape()) != 0) {
+    return false;
+  }
+
+  // The random tensor is only used for the mask, so it is never materialized.
+  const auto* random_view = greater_equal_view->GetRegularFanin(0).node_view();
+  const auto* random_node_def = random_view->node();
+  if (random_node_def->op() != "RandomUniform" ||
+      HasControlFaninOrFanout(*random_view) ||
+      !HasAtMostOneFanoutAtPort0(*random_view) ||
+      IsInPreserveSet(ctx, random_node_def) ||
+      !HasDataType(random_node_def, dtype, "dtype")) {
+    return false;
+  }
+
+  // All the users of the mask must be SelectV2 nodes that can use the bit-mask
+  // instead, so that the random samples are drawn once. The first of them in
+  // topological order is the forward pass, and the others only depend on it.
+  std::vector<int> selects;
+  for (const auto& fanout : greater_equal_view->GetRegularFanout(0)) {
+    const auto* fanout_view = fanout.node_view();
+    const auto* fanout_node_def = fanout_view->node();
+    if (fanout_node_def->op() != "SelectV2" || fanout.index() != 0 ||
+        fanout_view->NumRegularFanins() != 3 ||
+        HasControlFaninOrFanout(*fanout_view) ||
+        !HasDataType(fanout_node_def, dtype)) {
+      return false;
+    }
+    const auto* zeros_view = fanout_view->GetRegularFanin(2).node_view();
+    if (!IsZerosConstant(*zeros_view->node())) return false;
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(fanout_node_def->name());
+    if (props.size() != 3 ||
+        !ShapesSymbolicallyEqual(props[0].shape(), props[1].shape())) {
+      return false;
+    }
+    selects.push_back(fanout_view->node_index());
+  }
+  if (*std::min_element(selects.begin(), selects.end()) != node_index) {
+    return false;
+  }
+
+  const auto* scale_view = select_view->GetRegularFanin(1).node_view();
+  const auto* scale_node_def = scale_view->node();
+  if ((!IsMul(*scale_node_def) && !IsRealDiv(*scale_node_def)) ||
+      HasControlFaninOrFanout(*scale_view) ||
+      !HasAtMostOneFanoutAtPort0(*scale_view) ||
+      IsInPreserveSet(ctx, scale_node_def)) {
+    return false;
+  }
+  const auto& scale_props =
+      ctx.graph_properties.GetInputProperties(scale_node_def->name());
+  if (scale_props.size() != 2) return false;
+  int scale_port = 1;
+  if (Rank(scale_props[1].shape()) != 0) {
+    if (!IsMul(*scale_node_def) || Rank(scale_props[0].shape()) != 0) {
+      return false;
+    }
+    scale_port = 0;
+  }
+  const auto& select_props =
+      ctx.graph_properties.GetInputProperties(select_node_def->name());
+  if (!ShapesSymbolicallyEqual(scale_props[1 - scale_port].shape(),
+                               select_props[0].shape())) {
+    return false;
+  }
+
+  matched->select = node_index;
+  matched->greater_equal = greater_equal_view->node_index();
+  matched->random_uniform = random_view->node_index();
+  matched->scale = scale_view->node_index();
+  matched->scale_port = scale_port;
+  matched->gradients.clear();
+  for (int select : selects) {
+    if (select != node_index) matched->gradients.push_back(select);
+  }
+  return true;
+}
+
 // Helper function to check if the reduction axes for a given input
 // shape align with instance normalization's mean computation.
 // Mean reduction axes for instance norm are expected to be:
@@ -4369,6 +4724,107 @@ Status AddFusedBatchMatMul(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddFusedScaledDotProductAttention(
+    RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
+    const std::set<int>& remove_node_indices,
+    const std::vector<string>& input_node_names,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op(kFusedScaledDotProductAttention);
+  fused_node.set_device(output_node->device());
+  for (const auto& name : input_node_names) fused_node.add_input(name);
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(static_cast<int>(input_node_names.size()) - 4,
+               &(*attr)["num_args"]);
+
+  VLOG(2) << "Fuse attention block into " << kFusedScaledDotProductAttention
+          << ": output=" << output_node->name();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
+Status AddFusedDropoutNodes(RemapperContext* ctx, const Dropout& matched,
+                            std::vector<bool>* invalidated_nodes,
+                            std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& select = graph->node(matched.select);
+  const NodeDef& greater_equal = graph->node(matched.greater_equal);
+  const NodeDef& random_uniform = graph->node(matched.random_uniform);
+  const NodeDef& scale = graph->node(matched.scale);
+  VLOG(2) << "Fuse dropout into " << kFusedDropout
+          << ": select=" << select.name()
+          << " num_gradients=" << matched.gradients.size();
+
+  NodeDef fused_node;
+  fused_node.set_name(select.name());
+  fused_node.set_op(kFusedDropout);
+  fused_node.set_device(select.device());
+  fused_node.add_input(scale.input(1 - matched.scale_port));  // 0: x
+  fused_node.add_input(scale.input(matched.scale_port));      // 1: scale
+  fused_node.add_input(greater_equal.input(1));               // 2: rate
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = select.attr().at("T");
+  int64_t seed = 0;
+  int64_t seed2 = 0;
+  TryGetNodeAttr(random_uniform, "seed", &seed);
+  TryGetNodeAttr(random_uniform, "seed2", &seed2);
+  SetAttrValue(seed, &(*attr)["seed"]);
+  SetAttrValue(seed2, &(*attr)["seed2"]);
+  SetAttrValue(IsRealDiv(scale), &(*attr)["divide"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+
+  const string mask = absl::StrCat(select.name(), ":1");
+  for (int gradient : matched.gradients) {
+    const NodeDef& gradient_select = graph->node(gradient);
+    NodeDef gradient_node;
+    gradient_node.set_name(gradient_select.name());
+    gradient_node.set_op(kFusedDropoutGrad);
+    gradient_node.set_device(gradient_select.device());
+    gradient_node.add_input(gradient_select.input(1));  // 0: gradients
+    gradient_node.add_input(mask);                      // 1: mask
+    (*gradient_node.mutable_attr())["T"] = gradient_select.attr().at("T");
+    mutation->AddNode(std::move(gradient_node), &status);
+    TF_RETURN_IF_ERROR(status);
+    (*invalidated_nodes)[gradient] = true;
+
+    // The zeros are no longer needed either.
+    const auto* zeros_view =
+        ctx->graph_view.GetNode(gradient)->GetRegularFanin(2).node_view();
+    if (IsZerosLike(*zeros_view->node()) &&
+        !HasControlFaninOrFanout(*zeros_view) &&
+        HasAtMostOneFanoutAtPort0(*zeros_view) &&
+        !IsInPreserveSet(*ctx, zeros_view->node())) {
+      (*nodes_to_delete)[zeros_view->node_index()] = true;
+    }
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.select] = true;
+  (*nodes_to_delete)[matched.greater_equal] = true;
+  (*nodes_to_delete)[matched.random_uniform] = true;
+  (*nodes_to_delete)[matched.scale] = true;
+  return absl::OkStatus();
+}
+
 // Helper function to get data of type T from a given tensor and
 // return them in a vector and casted to type U.
 // Note - use this function only when type cast is safe from T to U.
@@ -4809,17 +5265,24 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a _FusedDropout fusion.
+  const auto is_dropout_candidate = [&]() -> bool {
+    if (node_def->op() != "SelectV2") return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return IsGreaterEqual(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
-           IsTranspose(*node_def);
+           IsTranspose(*node_def) || is_dropout_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() || is_dropout_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -4829,6 +5292,15 @@ inline bool IsXlaCpuGlobalJitOn() {
   return std::find(tf_xla_flags.begin(), tf_xla_flags.end(),
                    tf_xla_cpu_global_jit) != tf_xla_flags.end();
 }
+
+// The attention fusion is off unless enabled, until its numerics are checked
+// against the unfused ops on more models.
+inline bool FusedScaledDotProductAttentionEnabled() {
+  bool is_enabled = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_ENABLE_FUSED_SCALED_DOT_PRODUCT_ATTENTION",
+                                 /*default_val=*/false, &is_enabled));
+  return is_enabled;
+}
 }  // namespace
 
 Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -4843,6 +5315,7 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   RemapperContext ctx(&mutable_item, &status, cpu_layout_conversion_,
                       xla_auto_clustering_on_, xla_cpu_jit_disable_fusion);
   TF_RETURN_IF_ERROR(status);
+  const bool fuse_attention = FusedScaledDotProductAttentionEnabled();
 
   // Processing graph in reverse-topological sorted order allows to remap
   // longer chains of dependent ops in one pass.
@@ -5091,6 +5564,20 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap Q * K^T attention blocks into _FusedScaledDotProductAttention.
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
+    std::vector<string> attention_input_node_names;
+    if (allow_non_differentiable_rewrites && fuse_attention &&
+        FindFusedScaledDotProductAttention(&ctx, i, &matched_nodes_map,
+                                           &remove_node_indices,
+                                           &attention_input_node_names)) {
+      TF_RETURN_IF_ERROR(AddFusedScaledDotProductAttention(
+          &ctx, matched_nodes_map, remove_node_indices,
+          attention_input_node_names, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // Fusions are disabled on XLA CPU in IsCpuCompatible(...) invoked by the
     // following fusions.
     //
@@ -5174,6 +5661,15 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap dropout and the SelectV2 nodes of its gradient into
+    // _FusedDropout and _FusedDropoutGrad.
+    Dropout dropout;
+    if (allow_non_differentiable_rewrites && FindDropout(ctx, i, &dropout)) {
+      TF_RETURN_IF_ERROR(AddFusedDropoutNodes(&ctx, dropout, &invalidated_nodes,
+                                              &nodes_to_delete));
+      continue;
+    }
+
     TensorToHashBucket tensor_to_hash_bucket;
     if (allow_non_differentiable_rewrites &&
         FindTensorToHashBucket(ctx, i, &tensor_to_hash_bucket)) {
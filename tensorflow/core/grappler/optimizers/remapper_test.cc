@@ -3108,5 +3108,264 @@ class XlaCpuJitDisableFusionTest : public RemapperTest {
 TEST_F(XlaCpuJitDisableFusionTest, MatMulWithBias) { RunTest<DT_FLOAT>(); }
 #endif  // !(DNNL_AARCH64_USE_ACL || GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 
+class RemapperFuseScaledDotProductAttentionTest : public RemapperTest {
+ protected:
+  void SetUp() override {
+    RemapperTest::SetUp();
+    // The fusion is opt-in.
+    setenv("TF_ENABLE_FUSED_SCALED_DOT_PRODUCT_ATTENTION", "1",
+           1 /* replace */);
+  }
+
+  void TearDown() override {
+    unsetenv("TF_ENABLE_FUSED_SCALED_DOT_PRODUCT_ATTENTION");
+  }
+
+  void RunTest(bool with_mask, bool expect_fused = true) {
+    using ::tensorflow::ops::Placeholder;
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    // [batch, heads, sequence, depth]
+    auto query_shape = Placeholder::Shape({2, 4, 80, 16});
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT, query_shape);
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT, query_shape);
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT, query_shape);
+    auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                            Placeholder::Shape({2, 1, 80, 80}));
+
+    auto scores =
+        ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                           ops::BatchMatMulV2::Attrs().AdjY(true));
+    auto scale = ops::Const(s.WithOpName("scale"), 0.25f);
+    Output logits = ops::Mul(s.WithOpName("scale_mul"), scale, scores);
+    if (with_mask) logits = ops::AddV2(s.WithOpName("mask_add"), logits, mask);
+    auto softmax = ops::Softmax(s.WithOpName("softmax"), logits);
+    auto attention = ops::BatchMatMulV2(s.WithOpName("attention"), softmax,
+                                        value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 80, 16});
+    auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 80, 16});
+    auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 80, 16});
+    Tensor mask_t(DT_FLOAT, TensorShape({2, 1, 80, 80}));
+    auto mask_flat = mask_t.flat<float>();
+    for (int i = 0; i < mask_flat.size(); ++i) {
+      mask_flat(i) = i % 80 > i / 80 % 80 ? -1e9f : 0.0f;
+    }
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+    if (with_mask) item.feed.push_back({"mask", mask_t});
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (!expect_fused) {
+        EXPECT_NE(node.op(), "_FusedScaledDotProductAttention");
+        continue;
+      }
+      EXPECT_NE(node.op(), "Softmax");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+        ASSERT_EQ(node.input_size(), with_mask ? 5 : 4);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        EXPECT_EQ(node.input(3), "scale");
+        if (with_mask) EXPECT_EQ(node.input(4), "mask");
+        EXPECT_EQ(node.attr().at("num_args").i(), with_mask ? 1 : 0);
+        found++;
+      }
+    }
+    EXPECT_EQ(expect_fused ? 1 : 0, found);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectClose(tensors[0], tensors_expected[0], 1e-5, 1e-4);
+  }
+};
+
+TEST_F(RemapperFuseScaledDotProductAttentionTest, WithoutMask) {
+  RunTest(/*with_mask=*/false);
+}
+
+TEST_F(RemapperFuseScaledDotProductAttentionTest, WithMask) {
+  RunTest(/*with_mask=*/true);
+}
+
+TEST_F(RemapperFuseScaledDotProductAttentionTest, DisabledByDefault) {
+  unsetenv("TF_ENABLE_FUSED_SCALED_DOT_PRODUCT_ATTENTION");
+  RunTest(/*with_mask=*/true, /*expect_fused=*/false);
+}
+
+TEST_F(RemapperFuseScaledDotProductAttentionTest,
+       DoNotFuseWithBroadcastBatch) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           Placeholder::Shape({2, 8, 16}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         Placeholder::Shape({1, 8, 16}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           Placeholder::Shape({2, 8, 16}));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::Attrs().AdjY(true));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.25f);
+  auto logits = ops::Mul(s.WithOpName("scale_mul"), scores, scale);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), logits);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedScaledDotProductAttention");
+  }
+}
+
+class RemapperFuseDropoutTest : public RemapperTest {
+ public:
+  // Builds the dropout of tf.nn.dropout and the SelectV2 of its gradient on
+  // `device`. If `use_mask` is true, the mask is also cast to float and
+  // fetched.
+  void BuildGraph(bool divide, bool use_mask, GrapplerItem* item,
+                  const string& device = "/device:CPU:0") {
+    using ::tensorflow::ops::Placeholder;
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                         Placeholder::Shape({8, 37}));
+    auto gradients = Placeholder(s.WithOpName("gradients"), DT_FLOAT,
+                                 Placeholder::Shape({8, 37}));
+    auto shape = ops::Shape(s.WithOpName("shape"), x);
+    auto random = ops::RandomUniform(s.WithOpName("random"), shape, DT_FLOAT,
+                                     ops::RandomUniform::Seed(1).Seed2(2));
+    auto rate = ops::Const(s.WithOpName("rate"), 0.3f);
+    auto keep = ops::GreaterEqual(s.WithOpName("keep"), random, rate);
+    Output scaled;
+    if (divide) {
+      auto scale = ops::Const(s.WithOpName("scale"), 0.7f);
+      scaled = ops::RealDiv(s.WithOpName("scaled"), x, scale);
+    } else {
+      auto scale = ops::Const(s.WithOpName("scale"), 1 / 0.7f);
+      scaled = ops::Mul(s.WithOpName("scaled"), x, scale);
+    }
+    auto zero = ops::Const(s.WithOpName("zero"), 0.0f);
+    auto dropout = ops::SelectV2(s.WithOpName("dropout"), keep, scaled, zero);
+    auto zeros = ops::ZerosLike(s.WithOpName("zeros"), gradients);
+    auto backprops =
+        ops::SelectV2(s.WithOpName("backprops"), keep, gradients, zeros);
+    ops::Identity(s.WithOpName("fetch"), dropout);
+    ops::Identity(s.WithOpName("fetch_backprops"), backprops);
+    item->fetch = {"fetch", "fetch_backprops"};
+    if (use_mask) {
+      ops::Cast(s.WithOpName("fetch_mask"), keep, DT_FLOAT);
+      item->fetch.push_back("fetch_mask");
+    }
+
+    item->feed = {{"x", GenerateRandomTensor<DT_FLOAT>({8, 37})},
+                  {"gradients", GenerateRandomTensor<DT_FLOAT>({8, 37})}};
+    TF_ASSERT_OK(s.ToGraphDef(&item->graph));
+    for (int i = 0; i < item->graph.node_size(); ++i) {
+      item->graph.mutable_node(i)->set_device(device);
+    }
+  }
+
+  void RunTest(bool divide) {
+    GrapplerItem item;
+    BuildGraph(divide, /*use_mask=*/false, &item);
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.op(), "RandomUniform");
+      EXPECT_NE(node.op(), "GreaterEqual");
+      EXPECT_NE(node.op(), "ZerosLike");
+      if (node.name() == "dropout") {
+        EXPECT_EQ(node.op(), "_FusedDropout");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "x");
+        EXPECT_EQ(node.input(1), "scale");
+        EXPECT_EQ(node.input(2), "rate");
+        EXPECT_EQ(node.attr().at("seed").i(), 1);
+        EXPECT_EQ(node.attr().at("seed2").i(), 2);
+        EXPECT_EQ(node.attr().at("divide").b(), divide);
+        found++;
+      }
+      if (node.name() == "backprops") {
+        EXPECT_EQ(node.op(), "_FusedDropoutGrad");
+        ASSERT_EQ(node.input_size(), 2);
+        EXPECT_EQ(node.input(0), "gradients");
+        EXPECT_EQ(node.input(1), "dropout:1");
+        found++;
+      }
+    }
+    EXPECT_EQ(2, found);
+
+    // The fused ops draw the same samples as RandomUniform.
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 2);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 2);
+    test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+    test::ExpectTensorEqual<float>(tensors[1], tensors_expected[1]);
+  }
+};
+
+TEST_F(RemapperFuseDropoutTest, Mul) { RunTest(/*divide=*/false); }
+
+TEST_F(RemapperFuseDropoutTest, RealDiv) { RunTest(/*divide=*/true); }
+
+TEST_F(RemapperFuseDropoutTest, DoNotFuseWithOtherMaskUsers) {
+  GrapplerItem item;
+  BuildGraph(/*divide=*/false, /*use_mask=*/true, &item);
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedDropout");
+    EXPECT_NE(node.op(), "_FusedDropoutGrad");
+  }
+}
+
+TEST_F(RemapperFuseDropoutTest, DoNotFuseOnGpuByDefault) {
+  GrapplerItem item;
+  BuildGraph(/*divide=*/false, /*use_mask=*/false, &item, "/device:GPU:0");
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedDropout");
+    EXPECT_NE(node.op(), "_FusedDropoutGrad");
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
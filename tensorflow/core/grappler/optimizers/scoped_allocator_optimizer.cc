@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -891,7 +892,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -1076,6 +1077,37 @@ void IdentifyRepeatedInputs(const std::vector<NodeDef*>& nodes,
   }
 }
 
+// Splits `nodes` into consecutive buckets whose outputs total at most
+// `max_bucket_bytes`, preserving their order. A node whose output alone
+// exceeds the bound gets a bucket of its own. Outputs of unknown size count as
+// empty; the rewriter rejects their bucket later.
+std::vector<std::vector<NodeDef*>> SplitIntoBuckets(
+    const GraphProperties& graph_properties, const std::vector<NodeDef*>& nodes,
+    int64_t max_bucket_bytes) {
+  if (max_bucket_bytes <= 0) return {nodes};
+  std::vector<std::vector<NodeDef*>> buckets;
+  int64_t bucket_bytes = 0;
+  for (NodeDef* node : nodes) {
+    int64_t node_bytes = 0;
+    if (graph_properties.HasOutputProperties(node->name())) {
+      const auto& props = graph_properties.GetOutputProperties(node->name());
+      if (props.size() == 1) {
+        const PartialTensorShape shape(props[0].shape());
+        if (shape.IsFullyDefined()) {
+          node_bytes = shape.num_elements() * DataTypeSize(props[0].dtype());
+        }
+      }
+    }
+    if (buckets.empty() || bucket_bytes + node_bytes > max_bucket_bytes) {
+      buckets.emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets.back().push_back(node);
+    bucket_bytes += node_bytes;
+  }
+  return buckets;
+}
+
 }  // namespace
 
 Status ScopedAllocatorOptimizer::ProcessGraphDef(
@@ -1124,7 +1156,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
-                                         &op_name, invocation_count](Tree* t) {
+                                         &graph_properties, &op_name,
+                                         invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
@@ -1132,13 +1165,19 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
-                bool applied = false;
                 Status s = OrderNodeSet(&lg);
                 TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                for (const std::vector<NodeDef*>& bucket :
+                     SplitIntoBuckets(graph_properties, lg,
+                                      max_bucket_bytes_)) {
+                  if (bucket.size() <= 1) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name << " to "
+                          << bucket.size() << " of " << lg.size() << " ops";
+                  s = rewriter->Rewrite(this, invocation_count, graph,
+                                        op_name, bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
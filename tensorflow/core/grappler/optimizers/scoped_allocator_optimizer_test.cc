@@ -414,6 +414,48 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, BucketsBoundedBySize) {
+  // Four Abs ops whose 2x2 float inputs are 16 bytes each.
+  GrapplerItem item;
+  {
+    Scope s = Scope::NewRootScope().WithDevice(
+        "/job:localhost/replica:0/task:0/device:CPU:0");
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    for (int i = 1; i <= 4; ++i) {
+      Output sum = ops::Add(s.WithOpName(strings::StrCat("s", i)), a, b);
+      ops::Abs(s.WithOpName(strings::StrCat("a", i)), sum);
+    }
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  }
+  SetShapes(&item.graph);
+
+  auto num_scoped_allocators = [&item](int64_t max_bucket_bytes) {
+    ScopedAllocatorOptions opts;
+    opts.add_enable_op("Abs");
+    opts.set_max_bucket_bytes(max_bucket_bytes);
+    ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+    GraphDef optimized_graph;
+    TF_CHECK_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+    int count = 0;
+    for (const NodeDef& node : optimized_graph.node()) {
+      if (node.op() == "_ScopedAllocator") ++count;
+    }
+    return count;
+  };
+
+  // Without a bound all four ops share one buffer.
+  EXPECT_EQ(num_scoped_allocators(/*max_bucket_bytes=*/0), 1);
+  // Buckets of two ops each.
+  EXPECT_EQ(num_scoped_allocators(/*max_bucket_bytes=*/32), 2);
+  // A bucket of three ops, and a single op which is left alone.
+  EXPECT_EQ(num_scoped_allocators(/*max_bucket_bytes=*/48), 1);
+  // No bucket can hold two ops.
+  EXPECT_EQ(num_scoped_allocators(/*max_bucket_bytes=*/16), 0);
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Builds the same graph as UnaryRewriteOnly but also executes it and
   // validates the output.
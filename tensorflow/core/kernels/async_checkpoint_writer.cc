@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+template <typename Errors>
+auto FindError(Errors& errors, const std::string& prefix) {
+  return std::find_if(errors.begin(), errors.end(),
+                      [&prefix](const auto& error) {
+                        return error.first == prefix;
+                      });
+}
+
+}  // namespace
+
+AsyncCheckpointWriter::AsyncCheckpointWriter(Env* env)
+    : thread_(std::make_unique<thread::ThreadPool>(
+          env, "async_checkpoint_writer", /*num_threads=*/1)) {}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() { thread_.reset(); }
+
+AsyncCheckpointWriter* AsyncCheckpointWriter::Global() {
+  static AsyncCheckpointWriter* writer =
+      new AsyncCheckpointWriter(Env::Default());
+  return writer;
+}
+
+void AsyncCheckpointWriter::Schedule(const std::string& prefix,
+                                     int64_t num_bytes, int64_t max_bytes,
+                                     std::function<Status()> write) {
+  {
+    mutex_lock l(mu_);
+    while (pending_bytes_ > 0 && pending_bytes_ + num_bytes > max_bytes) {
+      write_done_.wait(l);
+    }
+    pending_bytes_ += num_bytes;
+    ++pending_writes_[prefix];
+  }
+  VLOG(1) << "Scheduled the asynchronous write of checkpoint " << prefix
+          << " holding " << num_bytes << " bytes";
+  thread_->Schedule([this, prefix, num_bytes, write = std::move(write)]() {
+    const Status status = write();
+    if (!status.ok()) {
+      LOG(ERROR) << "Asynchronous write of checkpoint " << prefix
+                 << " failed: " << status;
+    }
+    mutex_lock l(mu_);
+    pending_bytes_ -= num_bytes;
+    if (!status.ok() && FindError(errors_, prefix) == errors_.end()) {
+      if (errors_.size() == kMaxErrors) {
+        LOG(WARNING) << "Dropping the error of checkpoint "
+                     << errors_.front().first << ", which was not waited for";
+        errors_.pop_front();
+      }
+      errors_.emplace_back(prefix, status);
+    }
+    auto pending = pending_writes_.find(prefix);
+    if (--pending->second == 0) pending_writes_.erase(pending);
+    write_done_.notify_all();
+  });
+}
+
+Status AsyncCheckpointWriter::Wait(const std::string& prefix) {
+  mutex_lock l(mu_);
+  while (pending_writes_.contains(prefix)) write_done_.wait(l);
+  auto error = FindError(errors_, prefix);
+  if (error == errors_.end()) return absl::OkStatus();
+  const Status status = std::move(error->second);
+  errors_.erase(error);
+  return status;
+}
+
+int64_t AsyncCheckpointWriter::pending_bytes() const {
+  mutex_lock l(mu_);
+  return pending_bytes_;
+}
+
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+#define TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+// Writes checkpoints in the background, one at a time and in the order they
+// are scheduled, for the asynchronous mode of the SaveV2 op.
+//
+// A scheduled write holds a snapshot of the tensors it saves. Scheduling
+// blocks while the snapshots of the pending writes would hold more than a
+// given number of bytes, which bounds the extra memory used by asynchronous
+// saves.
+//
+// The errors of the writes of a checkpoint are returned by Wait(), e.g. by the
+// MergeV2Checkpoints op merging it. Only the errors of the last
+// `kMaxErrors` failed checkpoints are kept, so that the errors of checkpoints
+// nobody waits for don't accumulate.
+class AsyncCheckpointWriter {
+ public:
+  static constexpr int kMaxErrors = 64;
+
+  explicit AsyncCheckpointWriter(Env* env);
+
+  // Waits for the pending writes.
+  ~AsyncCheckpointWriter();
+
+  // The writer of the process.
+  static AsyncCheckpointWriter* Global();
+
+  // Schedules `write`, which writes the checkpoint `prefix` from a snapshot of
+  // `num_bytes` bytes. Blocks until the pending writes hold at most
+  // `max_bytes - num_bytes` bytes, or until there is no pending write if
+  // `num_bytes` is larger than `max_bytes`.
+  void Schedule(const std::string& prefix, int64_t num_bytes,
+                int64_t max_bytes, std::function<Status()> write);
+
+  // Waits for the pending writes of the checkpoint `prefix`, and returns the
+  // first error of its writes since the last call.
+  Status Wait(const std::string& prefix);
+
+  // Bytes held by the snapshots of the pending writes.
+  int64_t pending_bytes() const;
+
+ private:
+  mutable mutex mu_;
+  condition_variable write_done_;
+  int64_t pending_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Number of pending writes, by checkpoint.
+  absl::flat_hash_map<std::string, int> pending_writes_ TF_GUARDED_BY(mu_);
+  // First error of the writes, by checkpoint, oldest first.
+  std::deque<std::pair<std::string, Status>> errors_ TF_GUARDED_BY(mu_);
+  // Destroyed first, which waits for the pending writes.
+  std::unique_ptr<thread::ThreadPool> thread_;
+
+  AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+  void operator=(const AsyncCheckpointWriter&) = delete;
+};
+
+}  // namespace checkpoint
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+TEST(AsyncCheckpointWriterTest, WritesInOrder) {
+  AsyncCheckpointWriter writer(Env::Default());
+  std::vector<int> order;
+  for (int i = 0; i < 3; ++i) {
+    writer.Schedule("ckpt", /*num_bytes=*/1, /*max_bytes=*/10, [&order, i]() {
+      order.push_back(i);
+      return absl::OkStatus();
+    });
+  }
+  TF_EXPECT_OK(writer.Wait("ckpt"));
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2}));
+  EXPECT_EQ(writer.pending_bytes(), 0);
+}
+
+TEST(AsyncCheckpointWriterTest, WaitReturnsErrorsOfCheckpoint) {
+  AsyncCheckpointWriter writer(Env::Default());
+  writer.Schedule("bad", 1, 10, []() { return errors::Internal("failed"); });
+  writer.Schedule("good", 1, 10, []() { return absl::OkStatus(); });
+  EXPECT_TRUE(errors::IsInternal(writer.Wait("bad")));
+  // The error is only returned once.
+  TF_EXPECT_OK(writer.Wait("bad"));
+  TF_EXPECT_OK(writer.Wait("good"));
+  TF_EXPECT_OK(writer.Wait("unknown"));
+}
+
+TEST(AsyncCheckpointWriterTest, KeepsErrorsOfLastCheckpoints) {
+  AsyncCheckpointWriter writer(Env::Default());
+  const int num_checkpoints = AsyncCheckpointWriter::kMaxErrors + 1;
+  for (int i = 0; i < num_checkpoints; ++i) {
+    writer.Schedule(absl::StrCat("ckpt", i), 1, 10,
+                    []() { return errors::Internal("failed"); });
+  }
+  const std::string last = absl::StrCat("ckpt", num_checkpoints - 1);
+  EXPECT_TRUE(errors::IsInternal(writer.Wait(last)));
+  // The error of the oldest checkpoint was dropped.
+  TF_EXPECT_OK(writer.Wait("ckpt0"));
+  EXPECT_TRUE(errors::IsInternal(writer.Wait("ckpt1")));
+}
+
+TEST(AsyncCheckpointWriterTest, BoundsPendingBytes) {
+  AsyncCheckpointWriter writer(Env::Default());
+  Notification unblock_first;
+  writer.Schedule("first", 60, 100, [&unblock_first]() {
+    unblock_first.WaitForNotification();
+    return absl::OkStatus();
+  });
+
+  std::atomic<bool> second_scheduled = false;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "schedule_second", [&writer, &second_scheduled]() {
+        writer.Schedule("second", 60, 100, []() { return absl::OkStatus(); });
+        second_scheduled = true;
+      }));
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  EXPECT_FALSE(second_scheduled);
+  EXPECT_EQ(writer.pending_bytes(), 60);
+
+  unblock_first.Notify();
+  thread.reset();
+  EXPECT_TRUE(second_scheduled);
+  TF_EXPECT_OK(writer.Wait("second"));
+  EXPECT_EQ(writer.pending_bytes(), 0);
+}
+
+TEST(AsyncCheckpointWriterTest, SchedulesLargeWriteAlone) {
+  AsyncCheckpointWriter writer(Env::Default());
+  writer.Schedule("large", 1000, 100, []() { return absl::OkStatus(); });
+  TF_EXPECT_OK(writer.Wait("large"));
+}
+
+}  // namespace
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/platform/numbers.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/statusor.h"
 
@@ -267,21 +268,35 @@ class BatchResource : public serving::BatchResourceBase {
     // times in parallel with the same rendezvous, a _Send node from one run
     // might be matched with a _Recv node of a different run. Not setting the
     // rendezvous causes a new rendezvous to be used for each run.
-    Notification done_notif;
+    auto done_notif = std::make_shared<Notification>();
 
     auto* flib = last_task_context->function_library();
     FunctionLibraryRuntime::Handle fhandle =
         down_cast<const BatchTask&>(last_task).fhandle;
     flib->Run(opts, fhandle, inputs, combined_outputs,
-              [&](const Status& run_status) {
+              [done = std::move(done), done_notif](const Status& run_status) {
                 done(run_status);
-                done_notif.Notify();
+                done_notif->Notify();
               });
     // By waiting for the notification we are ensuring that this thread isn't
     // used for processing other batches, which gives the batches time to
     // coalesce upstream. So overall the number of batches going through the
     // devices goes down, improving latency and throughput in most cases.
-    done_notif.WaitForNotification();
+    //
+    // In pipelined mode the batch thread instead moves on as soon as the
+    // function is dispatched, so that the next batch of this op, or batches of
+    // the later stages of a multi-stage model, are concatenated and dispatched
+    // while this batch is still running on the device.
+    static const bool pipeline_batches = [] {
+      bool pipeline_batches;
+      TF_CHECK_OK(ReadBoolFromEnvVar("TF_BATCH_FUNCTION_PIPELINE_BATCHES",
+                                     /*default_val=*/false,
+                                     &pipeline_batches));
+      return pipeline_batches;
+    }();
+    if (!pipeline_batches) {
+      done_notif->WaitForNotification();
+    }
   }
 };
 
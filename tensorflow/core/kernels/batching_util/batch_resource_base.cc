@@ -71,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/incremental_barrier.h"
 #include "tsl/platform/criticality.h"
 #include "tsl/platform/errors.h"
@@ -313,6 +314,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
 
 using ::tensorflow::concat_split_util::Concat;
 using ::tensorflow::concat_split_util::Split;
+using ::tensorflow::concat_split_util::SplitByAliasing;
 using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 string GetTensorNamesAndShapesString(const OpKernelContext* context,
@@ -569,9 +571,34 @@ BatchResourceBase::GetBatcherQueueOptions(
       batcher_queue_options.high_priority_queue_options
           .max_execution_batch_size = *allowed_batch_sizes.rbegin();
       batcher_queue_options.allowed_batch_sizes = allowed_batch_sizes;
+
+      // Opts into splitting inputs at the batch size with the lowest measured
+      // latency per element, see
+      // `QueueOptions::batch_size_latency_profile`. The latencies are
+      // measured while warming up all allowed batch sizes.
+      static const bool use_cost_efficient_batch_size = [] {
+        bool value = false;
+        TF_CHECK_OK(ReadBoolFromEnvVar("TF_BATCH_USE_COST_EFFICIENT_BATCH_SIZE",
+                                       /*default_val=*/false, &value));
+        return value;
+      }();
+      if (use_cost_efficient_batch_size) {
+        batcher_queue_options.batch_size_latency_profile =
+            std::make_shared<BatchSizeLatencyProfile>(allowed_batch_sizes);
+      }
     }
   }
   batcher_queue_options.disable_padding = disable_padding;
+  // Opts all batching queues into tuning their timeout to a target latency,
+  // see `QueueOptions::batch_timeout_target_latency_micros`.
+  static const int64_t batch_timeout_target_latency_micros = [] {
+    int64_t value = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_BATCH_TIMEOUT_TARGET_LATENCY_MICROS",
+                                    /*default_val=*/0, &value));
+    return value;
+  }();
+  batcher_queue_options.batch_timeout_target_latency_micros =
+      batch_timeout_target_latency_micros;
 
   return batcher_queue_options;
 }
@@ -729,6 +756,13 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    // A batch made of a single unpadded task needs no concatenation; pass its
+    // input through instead of copying it.
+    if (to_concatenate.size() == 1) {
+      concatenated_tensors->push_back(std::move(to_concatenate[0]));
+      continue;
+    }
+
     Tensor concatenated_tensor;
     Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
@@ -864,6 +898,14 @@ Status BatchResourceBase::SplitOutputTensors(
     task_sizes_plus_optional_padding.push_back(padding_size);
   }
 
+  // Opts into splitting the batched outputs without copying them.
+  static const bool zero_copy_output_split = [] {
+    bool value = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_BATCH_ZERO_COPY_OUTPUT_SPLIT",
+                                   /*default_val=*/false, &value));
+    return value;
+  }();
+
   DCHECK_EQ(batch->task(0).context->num_outputs(), combined_outputs.size());
   int combined_outputs_size = combined_outputs.size();
   if (combined_outputs_size != batch->task(0).context->num_outputs()) {
@@ -887,12 +929,19 @@ Status BatchResourceBase::SplitOutputTensors(
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status;
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.message());
+    // With zero copy splitting, the task outputs alias aligned slices of the
+    // batched output instead of copying them, at the cost of keeping the
+    // batched output alive as long as any of the task outputs.
+    if (!zero_copy_output_split ||
+        !SplitByAliasing(output_tensor, task_sizes_plus_optional_padding,
+                         &split_tensor)) {
+      const Status split_status = tensor::Split(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      DCHECK(split_status.ok()) << split_status;
+      if (!split_status.ok()) {
+        return errors::Internal("Tensor split operation failed: ",
+                                split_status.message());
+      }
     }
     DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
     if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
@@ -950,80 +999,109 @@ void BatchResourceBase::ProcessFuncBatch(
   // which are running this Session, of which this BatchOp is a part.
   WithContext wc(batch->task(batch->num_tasks() - 1).propagated_context);
 
+  // The state of the batch which outlives the function run. It is shared with
+  // the function callback, since `ProcessFuncBatchImpl()` may return before
+  // the function completes (see `ProcessFuncBatchImpl()`).
+  struct FuncBatchState {
+    std::unique_ptr<BatchT> batch;
+    std::vector<std::unique_ptr<BatchTask>> unbatched_tasks;
+    std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+    std::string model_name;
+    int64_t processed_size = 0;
+    bool cleanup_done = false;
+    std::vector<Tensor> args;
+    std::vector<Tensor> combined_outputs;
+  };
+  auto state = std::make_shared<FuncBatchState>();
+  state->batch = std::move(batch);
+  state->unbatched_tasks = std::move(unbatched_tasks);
+
   // TODO(b/185852990): Add a unit test to check the context is correctly set.
   // Creates the CostMeasurements within the same context that runs the Session.
   const CostMeasurement::Context batching_context{/*is_per_query=*/false};
-  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements =
-      CreateCostMeasurements(batching_context);
+  state->batch_cost_measurements = CreateCostMeasurements(batching_context);
 
-  auto& last_task = batch->task(batch->num_tasks() - 1);
+  auto& last_task = state->batch->task(state->batch->num_tasks() - 1);
   OpKernelContext* last_task_context = last_task.context;
-  const std::string& model_name = GetModelName(last_task_context);
+  state->model_name = GetModelName(last_task_context);
+  state->processed_size = state->batch->size();
 
   // Regardless of the outcome, we need to propagate the status to the
   // individual tasks and signal that they are done. We use MakeCleanup() to
   // ensure that this happens no matter how we exit the method below.
   Status status;
-  bool cleanup_done = false;
-  int64_t processed_size = batch->size();
-  auto cleanup_fn = [&](const Status& status) {
-    if (cleanup_done) {
+  auto cleanup_fn = [this, state](const Status& status) {
+    if (state->cleanup_done) {
       return;
     }
     // TODO(b/316379576): Update this to take the unbatch task cost into
     // consideration when excluding the wasted cost and propagate cost to the
     // unbatched tasks.
-    SplitBatchCostsAndRecordMetrics(model_name, batch_cost_measurements,
-                                    processed_size, *batch);
+    SplitBatchCostsAndRecordMetrics(state->model_name,
+                                    state->batch_cost_measurements,
+                                    state->processed_size, *state->batch);
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
-    batch_cost_measurements.clear();
-    for (int i = 0; i < batch->num_tasks(); ++i) {
-      CleanUpFunctionHelper(*batch->mutable_task(i), status);
+    state->batch_cost_measurements.clear();
+    for (int i = 0; i < state->batch->num_tasks(); ++i) {
+      CleanUpFunctionHelper(*state->batch->mutable_task(i), status);
     }
-    for (int i = 0; i < unbatched_tasks.size(); ++i) {
-      CleanUpFunctionHelper(*unbatched_tasks[i], status);
+    for (int i = 0; i < state->unbatched_tasks.size(); ++i) {
+      CleanUpFunctionHelper(*state->unbatched_tasks[i], status);
     }
-    cleanup_done = true;
+    state->cleanup_done = true;
   };
 
   auto finally =
       gtl::MakeCleanup([&cleanup_fn, &status] { cleanup_fn(status); });
 
-  status = ValidateBatch(*batch);
+  status = ValidateBatch(*state->batch);
   if (!status.ok()) {
     return;
   }
 
   std::vector<Tensor> concatenated_tensors;
-  status = ConcatInputTensors(*batch, unbatched_tasks, last_task_context,
-                              &concatenated_tensors);
-  processed_size = RoundToLowestAllowedBatchSize(batch->size());
+  status = ConcatInputTensors(*state->batch, state->unbatched_tasks,
+                              last_task_context, &concatenated_tensors);
+  state->processed_size = RoundToLowestAllowedBatchSize(state->batch->size());
   if (!status.ok()) {
     return;
   }
 
-  std::vector<Tensor> combined_outputs;
-  std::vector<Tensor> args(concatenated_tensors.begin(),
-                           concatenated_tensors.end());
+  std::vector<Tensor>& args = state->args;
+  args.assign(concatenated_tensors.begin(), concatenated_tensors.end());
   const auto& captured_inputs =
-      batch->task(batch->num_tasks() - 1).captured_inputs;
+      state->batch->task(state->batch->num_tasks() - 1).captured_inputs;
   args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
 
   uint64 current_time = EnvTime::NowNanos();
-  for (int i = 0; i < batch->num_tasks(); ++i) {
-    RecordBatchDelayUs((current_time - batch->task(i).start_time) * 1e-3,
-                       model_name, last_task_context->op_kernel().name(),
-                       processed_size);
-    RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
-                         model_name, last_task_context->op_kernel().name(),
-                         processed_size);
+  for (int i = 0; i < state->batch->num_tasks(); ++i) {
+    const uint64 start_time = state->batch->task(i).start_time;
+    RecordBatchDelayUs((current_time - start_time) * 1e-3, state->model_name,
+                       last_task_context->op_kernel().name(),
+                       state->processed_size);
+    RecordBatchDelayUsV2((current_time - start_time) * 1e-3, state->model_name,
+                         last_task_context->op_kernel().name(),
+                         state->processed_size);
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
+  const uint64 start_time_micros = EnvTime::NowMicros();
+  // Keeps this resource alive until the function completes, which may be after
+  // this method returns.
+  Ref();
   ProcessFuncBatchImpl(
-      last_task, args, &combined_outputs, [&](const Status& run_status) {
+      last_task, args, &state->combined_outputs,
+      [this, state, &last_task, cleanup_fn = std::move(cleanup_fn),
+       start_time_micros](const Status& run_status) {
+        auto unref = gtl::MakeCleanup([this] { Unref(); });
+        if (run_status.ok() && last_task.forced_warmup_batch_size > 0 &&
+            batcher_queue_options_.batch_size_latency_profile != nullptr) {
+          batcher_queue_options_.batch_size_latency_profile->RecordLatency(
+              last_task.forced_warmup_batch_size,
+              EnvTime::NowMicros() - start_time_micros);
+        }
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -1039,8 +1117,9 @@ void BatchResourceBase::ProcessFuncBatch(
           return;
         }
         if (last_task.forced_warmup_batch_size == 0) {
-          final_status = SplitOutputTensors(combined_outputs, batch.get(),
-                                            unbatched_tasks);
+          final_status =
+              SplitOutputTensors(state->combined_outputs, state->batch.get(),
+                                 state->unbatched_tasks);
         }
       });
 }
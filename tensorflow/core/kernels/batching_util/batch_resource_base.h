@@ -271,7 +271,8 @@ class BatchResourceBase : public ResourceBase {
       int64_t processed_size, BatchT& batch);
 
  private:
-  // Implementation of calling the process batch function.
+  // Implementation of calling the process batch function. May return before
+  // `done` is called; `inputs` and `combined_outputs` stay valid until then.
   virtual void ProcessFuncBatchImpl(
       const BatchResourceBase::BatchTask& last_task,
       absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
@@ -33,6 +33,8 @@ absl::StatusOr<MixedPriorityBatchingPolicy> GetMixedPriorityBatchingPolicy(
         kLowPriorityPaddingWithNextAllowedBatchSize;
   } else if (attr_value == kPriorityIsolationAttrValue) {
     return MixedPriorityBatchingPolicy::kPriorityIsolation;
+  } else if (attr_value == kPriorityLanesAttrValue) {
+    return MixedPriorityBatchingPolicy::kPriorityLanes;
   }
   return absl::InvalidArgumentError(absl::StrFormat(
       "Unknown mixed priority batching policy: %s", attr_value));
@@ -58,11 +58,13 @@ const absl::string_view kLowPriorityPaddingWithMaxBatchSizeAttrValue =
 const absl::string_view kLowPriorityPaddingWithNextAllowedBatchSizeAttrValue =
     "low_priority_padding_with_next_allowed_batch_size";
 const absl::string_view kPriorityIsolationAttrValue = "priority_isolation";
+const absl::string_view kPriorityLanesAttrValue = "priority_lanes";
 
 enum class MixedPriorityBatchingPolicy {
   kLowPriorityPaddingWithMaxBatchSize,
   kLowPriorityPaddingWithNextAllowedBatchSize,
-  kPriorityIsolation
+  kPriorityIsolation,
+  kPriorityLanes
 };
 
 absl::StatusOr<MixedPriorityBatchingPolicy> GetMixedPriorityBatchingPolicy(
@@ -0,0 +1,356 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks for the latency and batch fill of SharedBatchScheduler,
+// AdaptiveSharedBatchScheduler and SerialDeviceBatchScheduler under open-loop
+// load, i.e. tasks arrive at predetermined times regardless of how fast the
+// scheduler completes them, as requests from independent clients do.
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/serial_device_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::tensorflow::histogram::Histogram;
+
+// Fixed duration of the load injected by each benchmark.
+static int load_duration_secs = 10;
+
+constexpr int kMaxBatchSize = 64;
+constexpr int kNumBatchThreads = 4;
+constexpr int64_t kBatchTimeoutMicros = 1000;
+
+enum class SchedulerType { kShared, kAdaptiveShared, kSerialDevice };
+
+enum class CostModel {
+  // A batch costs `fixed_cost_micros + per_task_cost_micros * batch_size`.
+  kLinear,
+  // As above, but with the batch size padded to the next power of two, which
+  // models a model compiled for a few allowed batch sizes.
+  kPadded,
+};
+
+class BenchmarkBatchTask : public BatchTask {
+ public:
+  explicit BenchmarkBatchTask(uint64 start_time_micros)
+      : start_time_micros_(start_time_micros) {}
+
+  BenchmarkBatchTask(const BenchmarkBatchTask&) = delete;
+  BenchmarkBatchTask& operator=(const BenchmarkBatchTask&) = delete;
+
+  size_t size() const override { return 1; }
+
+  uint64 start_time_micros() const { return start_time_micros_; }
+
+ private:
+  // The time at which the task was scheduled to arrive, in microseconds. The
+  // latency is measured from it rather than from the time the task was
+  // actually sent, so that the delays of a stalled injector or of a blocking
+  // Schedule() call are counted instead of hidden (coordinated omission).
+  const uint64 start_time_micros_;
+};
+
+// Returns the arrival times, relative to the start of the load, in
+// microseconds, of `duration_micros` worth of tasks arriving at an average of
+// `qps` per second. Tasks arrive in bursts of `burst_size` simultaneous tasks,
+// and the bursts form a Poisson process; a `burst_size` of 1 yields Poisson
+// arrivals.
+std::vector<int64_t> GenerateArrivalTimesMicros(int64_t qps, int burst_size,
+                                                int64_t duration_micros) {
+  std::mt19937_64 rng(/*seed=*/42);
+  std::exponential_distribution<double> burst_interval_micros(
+      static_cast<double>(qps) / burst_size / 1e6);
+  std::vector<int64_t> arrival_times_micros;
+  double now_micros = 0;
+  while (true) {
+    now_micros += burst_interval_micros(rng);
+    if (now_micros >= duration_micros) break;
+    arrival_times_micros.insert(arrival_times_micros.end(), burst_size,
+                                static_cast<int64_t>(now_micros));
+  }
+  return arrival_times_micros;
+}
+
+// The state associated with an open-loop benchmark, which injects tasks into a
+// batch scheduler at predetermined arrival times and measures the distribution
+// of task latencies and batch sizes.
+class OpenLoopBenchmark {
+ public:
+  OpenLoopBenchmark(SchedulerType scheduler_type, CostModel cost_model,
+                    int64_t fixed_cost_micros, int64_t per_task_cost_micros);
+
+  OpenLoopBenchmark(const OpenLoopBenchmark&) = delete;
+  OpenLoopBenchmark& operator=(const OpenLoopBenchmark&) = delete;
+
+  // Injects tasks at `arrival_times_micros`.
+  void InjectLoad(const std::vector<int64_t>& arrival_times_micros);
+
+  // Waits for all the injected tasks to complete.
+  void ResetScheduler() {
+    queue_.reset();
+    scheduler_.reset();
+  }
+
+  // Returns the latency percentiles and the batch fill statistics.
+  string Report() const;
+
+ private:
+  // Processes a batch of tasks. (Invoked by the scheduler on one of its batch
+  // threads.)
+  void ProcessBatch(std::unique_ptr<Batch<BenchmarkBatchTask>> batch);
+
+  // Returns the processing cost of a batch of `batch_size` tasks.
+  int64_t BatchCostMicros(int batch_size) const;
+
+  const CostModel cost_model_;
+  const int64_t fixed_cost_micros_;
+  const int64_t per_task_cost_micros_;
+
+  // The number of batches being processed, which the serial device scheduler
+  // uses as the number of batches pending on the device.
+  std::atomic<int64_t> num_batches_in_flight_{0};
+
+  mutable mutex mu_;
+
+  // A histogram of the task latencies, i.e. the time from the scheduled arrival
+  // to the end of the processing, in milliseconds.
+  Histogram task_latency_millis_histogram_ TF_GUARDED_BY(mu_);
+
+  // A histogram of the batch sizes.
+  Histogram batch_size_histogram_ TF_GUARDED_BY(mu_);
+
+  // The number of tasks which the scheduler rejected.
+  int64_t num_rejected_tasks_ TF_GUARDED_BY(mu_) = 0;
+
+  // Declared last, so that the batch threads are done before the state they
+  // update is destroyed. Keeps the scheduler alive until `queue_` is
+  // destroyed.
+  std::shared_ptr<void> scheduler_;
+  std::unique_ptr<BatchScheduler<BenchmarkBatchTask>> queue_;
+};
+
+OpenLoopBenchmark::OpenLoopBenchmark(SchedulerType scheduler_type,
+                                     CostModel cost_model,
+                                     int64_t fixed_cost_micros,
+                                     int64_t per_task_cost_micros)
+    : cost_model_(cost_model),
+      fixed_cost_micros_(fixed_cost_micros),
+      per_task_cost_micros_(per_task_cost_micros) {
+  auto process_batch_callback =
+      [this](std::unique_ptr<Batch<BenchmarkBatchTask>> batch) {
+        ProcessBatch(std::move(batch));
+      };
+  switch (scheduler_type) {
+    case SchedulerType::kShared: {
+      SharedBatchScheduler<BenchmarkBatchTask>::Options options;
+      options.num_batch_threads = kNumBatchThreads;
+      std::shared_ptr<SharedBatchScheduler<BenchmarkBatchTask>> scheduler;
+      TF_CHECK_OK(SharedBatchScheduler<BenchmarkBatchTask>::Create(
+          options, &scheduler));
+      SharedBatchScheduler<BenchmarkBatchTask>::QueueOptions queue_options;
+      queue_options.input_batch_size_limit = kMaxBatchSize;
+      queue_options.batch_timeout_micros = kBatchTimeoutMicros;
+      queue_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+      TF_CHECK_OK(scheduler->AddQueue(queue_options, process_batch_callback,
+                                      &queue_));
+      scheduler_ = std::move(scheduler);
+      break;
+    }
+    case SchedulerType::kAdaptiveShared: {
+      AdaptiveSharedBatchScheduler<BenchmarkBatchTask>::Options options;
+      options.num_batch_threads = kNumBatchThreads;
+      std::shared_ptr<AdaptiveSharedBatchScheduler<BenchmarkBatchTask>>
+          scheduler;
+      TF_CHECK_OK(AdaptiveSharedBatchScheduler<BenchmarkBatchTask>::Create(
+          options, &scheduler));
+      AdaptiveSharedBatchScheduler<BenchmarkBatchTask>::QueueOptions
+          queue_options;
+      queue_options.max_batch_size = kMaxBatchSize;
+      queue_options.batch_timeout_micros = kBatchTimeoutMicros;
+      queue_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+      TF_CHECK_OK(scheduler->AddQueue(queue_options, process_batch_callback,
+                                      &queue_));
+      scheduler_ = std::move(scheduler);
+      break;
+    }
+    case SchedulerType::kSerialDevice: {
+      SerialDeviceBatchScheduler<BenchmarkBatchTask>::Options options;
+      options.num_batch_threads = kNumBatchThreads;
+      options.get_pending_on_serial_device = [this] {
+        return num_batches_in_flight_.load();
+      };
+      std::shared_ptr<SerialDeviceBatchScheduler<BenchmarkBatchTask>>
+          scheduler;
+      TF_CHECK_OK(SerialDeviceBatchScheduler<BenchmarkBatchTask>::Create(
+          options, &scheduler));
+      SerialDeviceBatchScheduler<BenchmarkBatchTask>::QueueOptions
+          queue_options;
+      queue_options.max_batch_size = kMaxBatchSize;
+      queue_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+      TF_CHECK_OK(scheduler->AddQueue(queue_options, process_batch_callback,
+                                      &queue_));
+      scheduler_ = std::move(scheduler);
+      break;
+    }
+  }
+}
+
+void OpenLoopBenchmark::InjectLoad(
+    const std::vector<int64_t>& arrival_times_micros) {
+  const int64_t start_time_micros = Env::Default()->NowMicros();
+  for (const int64_t arrival_time_micros : arrival_times_micros) {
+    // Wait until it's time for the next arrival, sleeping only when the wait
+    // is long enough for the sleep not to overshoot.
+    const int64_t next_arrival_micros = start_time_micros + arrival_time_micros;
+    int64_t now_micros = Env::Default()->NowMicros();
+    while (now_micros < next_arrival_micros) {
+      const int64_t kSleepThresholdMicros = 1000;
+      if (next_arrival_micros - now_micros >= kSleepThresholdMicros) {
+        Env::Default()->SleepForMicroseconds(1 /* minimum time */);
+      }
+      now_micros = Env::Default()->NowMicros();
+    }
+
+    auto task = std::make_unique<BenchmarkBatchTask>(next_arrival_micros);
+    if (!queue_->Schedule(&task).ok()) {
+      mutex_lock l(mu_);
+      ++num_rejected_tasks_;
+    }
+  }
+}
+
+void OpenLoopBenchmark::ProcessBatch(
+    std::unique_ptr<Batch<BenchmarkBatchTask>> batch) {
+  ++num_batches_in_flight_;
+  // Busy-waits to occupy the batch thread the way a computation would.
+  const uint64 end_time_micros =
+      Env::Default()->NowMicros() + BatchCostMicros(batch->size());
+  while (Env::Default()->NowMicros() < end_time_micros) {
+  }
+  --num_batches_in_flight_;
+
+  mutex_lock l(mu_);
+  batch_size_histogram_.Add(batch->size());
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    task_latency_millis_histogram_.Add(
+        (end_time_micros - batch->task(i).start_time_micros()) / 1000.0);
+  }
+}
+
+int64_t OpenLoopBenchmark::BatchCostMicros(int batch_size) const {
+  if (cost_model_ == CostModel::kPadded) {
+    int padded_batch_size = 1;
+    while (padded_batch_size < batch_size) padded_batch_size *= 2;
+    batch_size = padded_batch_size;
+  }
+  return fixed_cost_micros_ + per_task_cost_micros_ * batch_size;
+}
+
+string OpenLoopBenchmark::Report() const {
+  mutex_lock l(mu_);
+  VLOG(1) << "Batch sizes:\n" << batch_size_histogram_.ToString();
+  return absl::StrCat(
+      "lat_p50=", task_latency_millis_histogram_.Median(),
+      "ms,lat_p99=", task_latency_millis_histogram_.Percentile(99),
+      "ms,lat_p99.9=", task_latency_millis_histogram_.Percentile(99.9),
+      "ms,fill_mean=", batch_size_histogram_.Average() / kMaxBatchSize,
+      ",batchsz_p10=", batch_size_histogram_.Percentile(10),
+      ",batchsz_p50=", batch_size_histogram_.Median(),
+      ",batchsz_p90=", batch_size_histogram_.Percentile(90),
+      ",rejected=", num_rejected_tasks_);
+}
+
+// Injects `load_duration_secs` of open-loop load into a scheduler, and reports
+// latency percentiles and batch fill statistics in the benchmark label.
+void OpenLoopBM(::testing::benchmark::State& state) {
+  const auto scheduler_type = static_cast<SchedulerType>(state.range(0));
+  const int64_t qps = state.range(1);
+  const int burst_size = state.range(2);
+  const auto cost_model = static_cast<CostModel>(state.range(3));
+  const int64_t kFixedCostMicros = 500;
+  const int64_t kPerTaskCostMicros = 20;
+
+  const std::vector<int64_t> arrival_times_micros = GenerateArrivalTimesMicros(
+      qps, burst_size, load_duration_secs * int64_t{1000 * 1000});
+  if (arrival_times_micros.size() <= 10000) {
+    LOG(WARNING) << "Not enough tasks (" << arrival_times_micros.size() << ")"
+                 << " to report meaningful 99.9% latency!";
+  }
+  OpenLoopBenchmark bm(scheduler_type, cost_model, kFixedCostMicros,
+                       kPerTaskCostMicros);
+
+  for (auto s : state) {
+    bm.InjectLoad(arrival_times_micros);
+  }
+
+  // Wait for the scheduler to process all tasks.
+  bm.ResetScheduler();
+  state.SetLabel(bm.Report());
+  state.SetItemsProcessed(arrival_times_micros.size());
+}
+BENCHMARK(OpenLoopBM)
+    ->UseRealTime()
+    ->Iterations(1)
+    ->ArgNames({"scheduler", "qps", "burst", "cost_model"})
+    ->ArgsProduct({{static_cast<int>(SchedulerType::kShared),
+                    static_cast<int>(SchedulerType::kAdaptiveShared),
+                    static_cast<int>(SchedulerType::kSerialDevice)},
+                   {1000, 10000, 50000},
+                   {1, 32},
+                   {static_cast<int>(CostModel::kLinear),
+                    static_cast<int>(CostModel::kPadded)}});
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  const std::vector<tensorflow::Flag> flag_list = {tensorflow::Flag(
+      "scheduler_open_loop_bm_duration_secs",
+      &tensorflow::serving::load_duration_secs,
+      "Duration of the load injected by each benchmark.")};
+  if (!tensorflow::Flags::Parse(&argc, argv, flag_list)) {
+    std::cout << tensorflow::Flags::Usage(argv[0], flag_list);
+    return -1;
+  }
+
+  ::benchmark::Initialize(&argc, argv);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
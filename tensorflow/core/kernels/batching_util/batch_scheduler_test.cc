@@ -71,7 +71,10 @@ INSTANTIATE_TEST_SUITE_P(
                 kLowPriorityPaddingWithNextAllowedBatchSize),
         std::make_tuple(
             /*attr_name=*/kPriorityIsolationAttrValue,
-            /*policy=*/MixedPriorityBatchingPolicy::kPriorityIsolation)));
+            /*policy=*/MixedPriorityBatchingPolicy::kPriorityIsolation),
+        std::make_tuple(
+            /*attr_name=*/kPriorityLanesAttrValue,
+            /*policy=*/MixedPriorityBatchingPolicy::kPriorityLanes)));
 
 class FakeTask : public BatchTask {
  public:
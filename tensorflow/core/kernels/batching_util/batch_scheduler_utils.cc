@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -40,5 +44,47 @@ int GetNextAllowedBatchSize(int batch_size,
   return batch_size;
 }
 
+int GetCostEfficientBatchSize(const std::vector<int32>& allowed_batch_sizes,
+                              const std::vector<int64_t>& latencies_micros) {
+  DCHECK_EQ(allowed_batch_sizes.size(), latencies_micros.size());
+  int best = -1;
+  for (int i = 0; i < allowed_batch_sizes.size(); ++i) {
+    // Compares latency_i / size_i <= latency_best / size_best without
+    // dividing.
+    if (best < 0 || latencies_micros[i] * allowed_batch_sizes[best] <=
+                        latencies_micros[best] * allowed_batch_sizes[i]) {
+      best = i;
+    }
+  }
+  return best < 0 ? 0 : allowed_batch_sizes[best];
+}
+
+BatchSizeLatencyProfile::BatchSizeLatencyProfile(
+    std::vector<int32> allowed_batch_sizes)
+    : allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+      latencies_micros_(allowed_batch_sizes_.size(), -1),
+      num_unmeasured_batch_sizes_(allowed_batch_sizes_.size()) {}
+
+void BatchSizeLatencyProfile::RecordLatency(int batch_size,
+                                            int64_t latency_micros) {
+  auto it = std::lower_bound(allowed_batch_sizes_.begin(),
+                             allowed_batch_sizes_.end(), batch_size);
+  if (it == allowed_batch_sizes_.end() || *it != batch_size) return;
+
+  absl::MutexLock l(&mu_);
+  int64_t& latency = latencies_micros_[it - allowed_batch_sizes_.begin()];
+  if (latency < 0) {
+    latency = latency_micros;
+    --num_unmeasured_batch_sizes_;
+  } else {
+    latency = std::min(latency, latency_micros);
+  }
+  if (num_unmeasured_batch_sizes_ == 0) {
+    cost_efficient_batch_size_.store(
+        GetCostEfficientBatchSize(allowed_batch_sizes_, latencies_micros_),
+        std::memory_order_relaxed);
+  }
+}
+
 }  // namespace serving
 }  // namespace tensorflow
@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SCHEDULER_UTILS_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SCHEDULER_UTILS_H_
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -30,6 +34,46 @@ int GetNextAllowedBatchSize(int batch_size,
                             const std::vector<int32>& allowed_batch_sizes,
                             bool disable_padding);
 
+// Returns the allowed batch size with the lowest latency per element, where
+// `latencies_micros[i]` is the latency of a batch of `allowed_batch_sizes[i]`,
+// or 0 if there are no allowed batch sizes. Ties go to the larger batch size.
+//
+// When the latency steps up between two allowed batch sizes by more than the
+// sizes do, splitting inputs into batches of the returned size wastes less
+// compute than padding them up to the larger allowed batch size.
+int GetCostEfficientBatchSize(const std::vector<int32>& allowed_batch_sizes,
+                              const std::vector<int64_t>& latencies_micros);
+
+// Latencies of batches per allowed batch size, typically measured while a
+// model is warmed up for all its allowed batch sizes. Thread-safe.
+class BatchSizeLatencyProfile {
+ public:
+  // `allowed_batch_sizes` must be sorted in increasing order.
+  explicit BatchSizeLatencyProfile(std::vector<int32> allowed_batch_sizes);
+
+  // Records that a batch padded to `batch_size` took `latency_micros`. Keeps
+  // the lowest latency per batch size, which is the least skewed by one-off
+  // costs such as the compilation at the first run. Batch sizes which are not
+  // allowed are ignored.
+  void RecordLatency(int batch_size, int64_t latency_micros);
+
+  // Returns `GetCostEfficientBatchSize` of the recorded latencies once every
+  // allowed batch size has been measured, or 0 before.
+  int cost_efficient_batch_size() const {
+    return cost_efficient_batch_size_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const std::vector<int32> allowed_batch_sizes_;
+
+  absl::Mutex mu_;
+  // The lowest latency of each allowed batch size, or -1 if not measured yet.
+  std::vector<int64_t> latencies_micros_ ABSL_GUARDED_BY(mu_);
+  int num_unmeasured_batch_sizes_ ABSL_GUARDED_BY(mu_);
+
+  std::atomic<int> cost_efficient_batch_size_{0};
+};
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -42,6 +42,48 @@ TEST(GetNextAllowedBatchSizeTest, GreaterThanAllowedBatchSize) {
   EXPECT_EQ(GetNextAllowedBatchSize(10, {2, 4, 8}, false), 10);
 }
 
+TEST(GetCostEfficientBatchSizeTest, EmptyAllowedBatchSizes) {
+  EXPECT_EQ(GetCostEfficientBatchSize({}, {}), 0);
+}
+
+TEST(GetCostEfficientBatchSizeTest, LargestBatchSizeWithLinearLatency) {
+  EXPECT_EQ(GetCostEfficientBatchSize({2, 4, 8}, {20, 40, 80}), 8);
+}
+
+TEST(GetCostEfficientBatchSizeTest, SmallerBatchSizeBeforeLatencyStep) {
+  // Two batches of 8 take 20ms, one batch of 16 takes 30ms.
+  EXPECT_EQ(GetCostEfficientBatchSize({4, 8, 16}, {8, 10, 30}), 8);
+}
+
+TEST(BatchSizeLatencyProfileTest, UnknownUntilAllBatchSizesMeasured) {
+  BatchSizeLatencyProfile profile({4, 8, 16});
+  profile.RecordLatency(4, 8);
+  profile.RecordLatency(8, 10);
+  EXPECT_EQ(profile.cost_efficient_batch_size(), 0);
+
+  profile.RecordLatency(16, 30);
+  EXPECT_EQ(profile.cost_efficient_batch_size(), 8);
+}
+
+TEST(BatchSizeLatencyProfileTest, KeepsLowestLatency) {
+  BatchSizeLatencyProfile profile({4, 8, 16});
+  profile.RecordLatency(4, 8);
+  profile.RecordLatency(8, 10);
+  // The first run of each batch size may be slowed down by compilation.
+  profile.RecordLatency(16, 100);
+  EXPECT_EQ(profile.cost_efficient_batch_size(), 8);
+
+  profile.RecordLatency(16, 16);
+  EXPECT_EQ(profile.cost_efficient_batch_size(), 16);
+}
+
+TEST(BatchSizeLatencyProfileTest, IgnoresDisallowedBatchSizes) {
+  BatchSizeLatencyProfile profile({4, 8});
+  profile.RecordLatency(4, 10);
+  profile.RecordLatency(6, 10);
+  EXPECT_EQ(profile.cost_efficient_batch_size(), 0);
+}
+
 }  // namespace
 
 }  // namespace serving
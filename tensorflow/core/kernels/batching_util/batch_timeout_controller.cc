@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Weight of a new sample in the moving averages of the task arrivals.
+constexpr double kArrivalSmoothing = 0.05;
+
+// Number of recent batches the processing latency percentile is computed on.
+constexpr int kNumProcessingLatencies = 128;
+
+}  // namespace
+
+BatchTimeoutController::BatchTimeoutController(const Options& options)
+    : options_(options),
+      batch_timeout_micros_(std::min(options.initial_batch_timeout_micros,
+                                     options.target_latency_micros)) {
+  processing_latencies_.reserve(kNumProcessingLatencies);
+}
+
+void BatchTimeoutController::RecordTask(int64_t now_micros, int64_t size) {
+  if (last_task_micros_ >= 0) {
+    const double interval = static_cast<double>(
+        std::max<int64_t>(now_micros - last_task_micros_, 0));
+    if (num_intervals_ == 0) {
+      mean_task_interval_micros_ = interval;
+      mean_task_size_ = size;
+    } else {
+      mean_task_interval_micros_ +=
+          kArrivalSmoothing * (interval - mean_task_interval_micros_);
+      mean_task_size_ += kArrivalSmoothing * (size - mean_task_size_);
+    }
+    ++num_intervals_;
+  }
+  last_task_micros_ = now_micros;
+  UpdateBatchTimeout();
+}
+
+void BatchTimeoutController::RecordBatchProcessing(int64_t latency_micros) {
+  if (processing_latencies_.size() < kNumProcessingLatencies) {
+    processing_latencies_.push_back(latency_micros);
+  } else {
+    processing_latencies_[next_processing_latency_] = latency_micros;
+    next_processing_latency_ =
+        (next_processing_latency_ + 1) % kNumProcessingLatencies;
+  }
+  std::vector<int64_t> latencies = processing_latencies_;
+  auto p99 = latencies.begin() + (latencies.size() - 1) * 99 / 100;
+  std::nth_element(latencies.begin(), p99, latencies.end());
+  processing_latency_p99_micros_ = *p99;
+  UpdateBatchTimeout();
+}
+
+void BatchTimeoutController::UpdateBatchTimeout() {
+  if (processing_latency_p99_micros_ < 0 || num_intervals_ == 0) return;
+
+  int64_t timeout = std::max<int64_t>(
+      options_.target_latency_micros - processing_latency_p99_micros_, 0);
+  if (mean_task_interval_micros_ >= timeout) {
+    // Less than one more task is expected within the timeout.
+    timeout = 0;
+  } else if (mean_task_size_ > 0) {
+    const double fill_micros = options_.max_batch_size *
+                               mean_task_interval_micros_ / mean_task_size_;
+    timeout = std::min(timeout, static_cast<int64_t>(std::ceil(fill_micros)));
+  }
+  batch_timeout_micros_ = timeout;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_CONTROLLER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_CONTROLLER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace tensorflow {
+namespace serving {
+
+// Tunes the batch timeout of a batching queue from the observed task arrival
+// rate and batch processing latency, so that tasks are processed within a
+// target latency from the time they are enqueued:
+//
+//  - A task waits at most the timeout and is then processed, so the timeout
+//    never exceeds the target latency minus the (p99) processing latency.
+//  - Waiting longer than it takes to fill a batch at the current arrival rate
+//    only adds latency, and so does waiting when less than one more task is
+//    expected to arrive within the timeout, as under low load.
+//
+// Not thread-safe; the owning queue serializes the calls.
+class BatchTimeoutController {
+ public:
+  struct Options {
+    // The latency, in microseconds, from enqueuing a task to the end of the
+    // processing of its batch, which tasks should stay within. Must be
+    // positive.
+    int64_t target_latency_micros = 0;
+
+    // The timeout used until a batch has been processed and the interval
+    // between tasks has been observed, capped at `target_latency_micros`.
+    int64_t initial_batch_timeout_micros = 0;
+
+    // The largest batch the queue forms, in units of task sizes.
+    int64_t max_batch_size = 1;
+  };
+
+  explicit BatchTimeoutController(const Options& options);
+
+  // Records that a task of size `size` was enqueued at `now_micros`.
+  void RecordTask(int64_t now_micros, int64_t size);
+
+  // Records that processing a batch took `latency_micros`.
+  void RecordBatchProcessing(int64_t latency_micros);
+
+  // Returns the current batch timeout.
+  int64_t batch_timeout_micros() const { return batch_timeout_micros_; }
+
+ private:
+  void UpdateBatchTimeout();
+
+  const Options options_;
+
+  // Time of the last recorded task, or -1 before the first one.
+  int64_t last_task_micros_ = -1;
+  // Exponential moving averages of the interval between tasks and of their
+  // sizes. Valid iff `num_intervals_` is positive.
+  double mean_task_interval_micros_ = 0;
+  double mean_task_size_ = 0;
+  int64_t num_intervals_ = 0;
+
+  // The most recent processing latencies, as a ring buffer.
+  std::vector<int64_t> processing_latencies_;
+  int next_processing_latency_ = 0;
+  // The 99th percentile of `processing_latencies_`, or -1 before a batch has
+  // been processed.
+  int64_t processing_latency_p99_micros_ = -1;
+
+  int64_t batch_timeout_micros_;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_CONTROLLER_H_
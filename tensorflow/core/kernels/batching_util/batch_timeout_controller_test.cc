@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
+
+#include <gtest/gtest.h>
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+BatchTimeoutController::Options MakeOptions() {
+  BatchTimeoutController::Options options;
+  options.target_latency_micros = 10000;
+  options.initial_batch_timeout_micros = 5000;
+  options.max_batch_size = 32;
+  return options;
+}
+
+// Records `num_tasks` tasks of size 1, `interval_micros` apart.
+void RecordTasks(int num_tasks, int64_t interval_micros,
+                 BatchTimeoutController* controller) {
+  for (int i = 0; i < num_tasks; ++i) {
+    controller->RecordTask(i * interval_micros, /*size=*/1);
+  }
+}
+
+TEST(BatchTimeoutControllerTest, InitialTimeoutBeforeObservations) {
+  BatchTimeoutController controller(MakeOptions());
+  EXPECT_EQ(controller.batch_timeout_micros(), 5000);
+  RecordTasks(100, /*interval_micros=*/100, &controller);
+  EXPECT_EQ(controller.batch_timeout_micros(), 5000);
+}
+
+TEST(BatchTimeoutControllerTest, HighLoadWaitsForFullBatch) {
+  BatchTimeoutController controller(MakeOptions());
+  RecordTasks(100, /*interval_micros=*/100, &controller);
+  controller.RecordBatchProcessing(2000);
+  // 32 tasks arrive in 3200us, within the 8000us left by processing.
+  EXPECT_EQ(controller.batch_timeout_micros(), 3200);
+}
+
+TEST(BatchTimeoutControllerTest, MediumLoadBoundedByTargetLatency) {
+  BatchTimeoutController controller(MakeOptions());
+  RecordTasks(100, /*interval_micros=*/1000, &controller);
+  controller.RecordBatchProcessing(2000);
+  EXPECT_EQ(controller.batch_timeout_micros(), 8000);
+}
+
+TEST(BatchTimeoutControllerTest, LowLoadDoesNotWait) {
+  BatchTimeoutController controller(MakeOptions());
+  RecordTasks(100, /*interval_micros=*/20000, &controller);
+  controller.RecordBatchProcessing(2000);
+  EXPECT_EQ(controller.batch_timeout_micros(), 0);
+}
+
+TEST(BatchTimeoutControllerTest, TracksProcessingLatencyTail) {
+  BatchTimeoutController controller(MakeOptions());
+  RecordTasks(100, /*interval_micros=*/1000, &controller);
+  for (int i = 0; i < 100; ++i) {
+    controller.RecordBatchProcessing(i < 95 ? 2000 : 6000);
+  }
+  EXPECT_EQ(controller.batch_timeout_micros(), 4000);
+  // Processing alone exceeds the target latency.
+  for (int i = 0; i < 128; ++i) {
+    controller.RecordBatchProcessing(12000);
+  }
+  EXPECT_EQ(controller.batch_timeout_micros(), 0);
+}
+
+}  // namespace
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONCAT_SPLIT_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONCAT_SPLIT_UTIL_H_
 
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -109,6 +112,30 @@ inline Status Concat(OpKernelContext* context,
   return concat_status;
 }
 
+// Splits 'input' along the zeroth dimension into 'sizes.size()' tensors which
+// alias the buffer of 'input', with the ith split having zeroth-dimension size
+// 'sizes[i]'. Returns false and leaves 'outputs' untouched if any split would
+// not be aligned, in which case the caller needs to copy instead. Note that
+// every split keeps the whole buffer of 'input' alive.
+inline bool SplitByAliasing(const Tensor& input,
+                            const absl::Span<const int64_t> sizes,
+                            std::vector<Tensor>* outputs) {
+  std::vector<Tensor> splits;
+  splits.reserve(sizes.size());
+  int64_t position = 0;
+  for (const int64_t size : sizes) {
+    if (size < 0 || position + size > input.dim_size(0)) return false;
+    Tensor split = input.Slice(position, position + size);
+    if (!split.IsAligned()) return false;
+    splits.push_back(std::move(split));
+    position += size;
+  }
+  for (Tensor& split : splits) {
+    outputs->push_back(std::move(split));
+  }
+  return true;
+}
+
 // The Split*() functions split 'input' with element type T into 'sizes.size()'
 // tensors along the zeroth dimension, with the ith split having zeroth-
 // dimension size 'sizes[i]'. They allocate the output tensors using 'context',
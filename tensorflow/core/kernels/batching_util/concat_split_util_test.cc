@@ -0,0 +1,64 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/concat_split_util.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace concat_split_util {
+namespace {
+
+TEST(SplitByAliasingTest, AlignedSplitsAliasInput) {
+  // Rows of 64 floats keep every split aligned.
+  Tensor input(DT_FLOAT, TensorShape({4, 64}));
+  test::FillIota<float>(&input, 0.0f);
+
+  std::vector<Tensor> outputs;
+  ASSERT_TRUE(SplitByAliasing(input, {1, 3}, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  EXPECT_EQ(outputs[0].shape(), TensorShape({1, 64}));
+  EXPECT_EQ(outputs[1].shape(), TensorShape({3, 64}));
+  EXPECT_TRUE(outputs[0].SharesBufferWith(input));
+  EXPECT_TRUE(outputs[1].SharesBufferWith(input));
+  test::ExpectTensorEqual<float>(outputs[1], input.Slice(1, 4));
+}
+
+TEST(SplitByAliasingTest, UnalignedSplitsAreRejected) {
+  // Rows of a single float leave the second split unaligned.
+  Tensor input(DT_FLOAT, TensorShape({4, 1}));
+
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(SplitByAliasing(input, {1, 3}, &outputs));
+  EXPECT_TRUE(outputs.empty());
+}
+
+TEST(SplitByAliasingTest, OutOfRangeSizesAreRejected) {
+  Tensor input(DT_FLOAT, TensorShape({4, 64}));
+
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(SplitByAliasing(input, {2, 3}, &outputs));
+  EXPECT_TRUE(outputs.empty());
+}
+
+}  // namespace
+}  // namespace concat_split_util
+}  // namespace tensorflow
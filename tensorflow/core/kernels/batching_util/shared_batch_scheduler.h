@@ -18,13 +18,16 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -139,6 +143,14 @@ class SharedBatchScheduler
     // Must be >= 1, and should be tuned carefully.
     int num_batch_threads = port::MaxParallelism();
 
+    // The number of shards to split the queues and batch threads into. Each
+    // shard has its own lock, so that batch threads of different shards don't
+    // contend when picking the next batch. New queues are added to the shard
+    // with the fewest queues, and a batch thread which finds no work in its
+    // own shard takes a batch from another shard whose lock is free.
+    // Must be between 1 and `num_batch_threads`.
+    int num_shards = 1;
+
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
@@ -179,6 +191,14 @@ class SharedBatchScheduler
     // avoid latency spikes.
     int64_t batch_timeout_micros = 0;
 
+    // If positive, the queue tunes the timeout of its open batch from the
+    // observed task arrival rate and batch processing latency, so that tasks
+    // are processed within about this many microseconds of being enqueued
+    // (see BatchTimeoutController). `batch_timeout_micros`, capped at this
+    // latency, is then only used until the queue has processed its first
+    // batch. Low priority batches keep their static timeout.
+    int64_t batch_timeout_target_latency_micros = 0;
+
     // The maximum allowable number of enqueued (accepted by Schedule() but
     // not yet being processed on a batch thread) tasks in terms of batches.
     // If this limit is reached, Schedule() will return an UNAVAILABLE error.
@@ -240,6 +260,13 @@ class SharedBatchScheduler
     // If true, the padding will not be appended.
     bool disable_padding = false;
 
+    // If set and `enable_large_batch_splitting` is true (without lazy split),
+    // batches are closed at the cost efficient batch size of the profile once
+    // it is known, instead of at `max_execution_batch_size`. Inputs are then
+    // split across batches rather than padded up to an allowed batch size
+    // which is disproportionately slow.
+    std::shared_ptr<BatchSizeLatencyProfile> batch_size_latency_profile;
+
     // If true, queue implementation would split high priority and low priority
     // inputs into two sub queues.
     bool enable_priority_queue = false;
@@ -266,7 +293,9 @@ class SharedBatchScheduler
     PriorityQueueOptions low_priority_queue_options;
 
     // A policy that determines the mixed priority batching behavior. It is
-    // effective only when enable_priority_queue is true.
+    // effective only when enable_priority_queue is true. With kPriorityLanes,
+    // a high priority batch is schedulable as soon as it is non-empty, and is
+    // padded with low priority tasks up to the next allowed batch size.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
   };
@@ -277,15 +306,49 @@ class SharedBatchScheduler
  private:
   explicit SharedBatchScheduler(const Options& options);
 
-  void GetNextWorkItem_Locked(internal::Queue<TaskType>** queue_for_batch_out,
-                              BatchUniquePtr* batch_to_process_out)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // A list of queues. (We use std::list instead of std::vector to ensure that
+  // iterators are not invalidated by adding/removing elements. It also offers
+  // efficient removal of elements from the middle.)
+  using QueueList = std::list<std::unique_ptr<internal::Queue<TaskType>>>;
 
-  // The code executed in 'batch_threads_'. Obtains a batch to process from the
-  // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
-  // queue declines to provide a batch to process, moves onto the next queue. If
-  // no queues provide a batch to process, just sleeps briefly and exits.
-  void ThreadLogic();
+  // A subset of the queues, and the state the batch threads use to serve them.
+  struct Shard {
+    Shard() : next_queue_to_schedule(queues.end()) {}
+
+    mutex mu;
+
+    // All "active" queues of the shard, i.e. ones that either:
+    //  - have not been removed, or
+    //  - have been removed but are not yet empty.
+    QueueList queues TF_GUARDED_BY(mu);
+
+    // An iterator over 'queues', pointing to the queue from which the next
+    // available batch thread should grab work.
+    typename QueueList::iterator next_queue_to_schedule TF_GUARDED_BY(mu);
+
+    // Used by idle batch threads of the shard to wait for work to enter the
+    // shard. Notified whenever a batch becomes schedulable.
+    condition_variable schedulable_batch_cv;
+  };
+
+  void GetNextWorkItem_Locked(Shard& shard,
+                              internal::Queue<TaskType>** queue_for_batch_out,
+                              BatchUniquePtr* batch_to_process_out)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
+
+  // Obtains a batch to process from a shard other than `shards_[shard_index]`
+  // whose lock is free, if any.
+  void StealWorkItem(int shard_index,
+                     internal::Queue<TaskType>** queue_for_batch_out,
+                     BatchUniquePtr* batch_to_process_out);
+
+  // The code executed in 'batch_threads_' of `shards_[shard_index]`. Obtains a
+  // batch to process from the queue pointed to by the shard's
+  // 'next_queue_to_schedule', and processes it. If that queue declines to
+  // provide a batch to process, moves onto the next queue, and then onto the
+  // other shards. If no queues provide a batch to process, just sleeps briefly
+  // and exits.
+  void ThreadLogic(int shard_index);
 
   // Called by `AddQueue`.
   Status AddQueueAfterRewritingOptions(
@@ -296,25 +359,8 @@ class SharedBatchScheduler
 
   const Options options_;
 
-  mutex mu_;
-
-  // A list of queues. (We use std::list instead of std::vector to ensure that
-  // iterators are not invalidated by adding/removing elements. It also offers
-  // efficient removal of elements from the middle.)
-  using QueueList = std::list<std::unique_ptr<internal::Queue<TaskType>>>;
-
-  // All "active" queues, i.e. ones that either:
-  //  - have not been removed, or
-  //  - have been removed but are not yet empty.
-  QueueList queues_ TF_GUARDED_BY(mu_);
-
-  // An iterator over 'queues_', pointing to the queue from which the next
-  // available batch thread should grab work.
-  typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
-
-  // Used by idle batch threads to wait for work to enter the system. Notified
-  // whenever a batch becomes schedulable.
-  condition_variable schedulable_batch_cv_;
+  // See `Options::num_shards`.
+  std::vector<std::unique_ptr<Shard>> shards_;
 
   // Threads that process batches obtained from the queues.
   std::vector<std::unique_ptr<PeriodicFunction>> batch_threads_;
@@ -398,7 +444,9 @@ class Queue {
   // Returns the maximum allowed size of tasks to be executed.
   // Returned value would be less than or equal to the maximum allowed input
   // size that's provided by caller of batch scheduler.
-  size_t max_execution_batch_size() const { return max_execution_batch_size_; }
+  size_t max_execution_batch_size() const {
+    return execution_batch_size_limit_.load(std::memory_order_relaxed);
+  }
 
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
@@ -467,6 +515,18 @@ class Queue {
       std::vector<std::unique_ptr<TaskType>>* output_tasks)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the timeout of the open batch.
+  int64_t batch_timeout_micros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Lowers `execution_batch_size_limit_` to the cost efficient batch size of
+  // `options_.batch_size_latency_profile`, if any. Only takes effect while the
+  // open batch is empty, so that no open batch exceeds the limit.
+  void UpdateExecutionBatchSizeLimit() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Records the arrival of a high priority task of size `size` for the
+  // timeout controller, if any.
+  void RecordTaskForTimeout(int64_t size) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Determines whether the open batch residing at the back of
   // 'high_priority_batches_' is currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -534,6 +594,11 @@ class Queue {
   // `GetMaxExecutionBatchSize` for more details on what it means.
   const size_t max_execution_batch_size_;
 
+  // The batch size limit currently in effect, which is
+  // `max_execution_batch_size_` unless lowered by
+  // `UpdateExecutionBatchSizeLimit`. Written under `mu_`.
+  std::atomic<size_t> execution_batch_size_limit_;
+
   // A callback invoked to processes a batch of work units. Always invoked
   // from a batch thread.
   ProcessBatchCallback process_batch_callback_;
@@ -590,6 +655,11 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // Tunes the timeout of the open batch, iff
+  // `options_.batch_timeout_target_latency_micros` is positive.
+  std::optional<BatchTimeoutController> timeout_controller_
+      TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -646,6 +716,12 @@ Status SharedBatchScheduler<TaskType>::Create(
     return errors::InvalidArgument("num_batch_threads must be positive; was ",
                                    options.num_batch_threads);
   }
+  if (options.num_shards < 1 ||
+      options.num_shards > options.num_batch_threads) {
+    return errors::InvalidArgument(
+        "num_shards must be between 1 and num_batch_threads (",
+        options.num_batch_threads, "); was ", options.num_shards);
+  }
   scheduler->reset(new SharedBatchScheduler<TaskType>(options));
   return absl::OkStatus();
 }
@@ -654,15 +730,17 @@ template <typename TaskType>
 SharedBatchScheduler<TaskType>::~SharedBatchScheduler() {
   // Wait until the batch threads finish clearing out and deleting the closed
   // queues.
-  for (;;) {
-    {
-      mutex_lock l(mu_);
-      if (queues_.empty()) {
-        break;
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    for (;;) {
+      {
+        mutex_lock l(shard->mu);
+        if (shard->queues.empty()) {
+          break;
+        }
       }
+      const int64_t kSleepTimeMicros = 100;
+      options_.env->SleepForMicroseconds(kSleepTimeMicros);
     }
-    const int64_t kSleepTimeMicros = 100;
-    options_.env->SleepForMicroseconds(kSleepTimeMicros);
   }
   // Delete the batch threads before allowing state the threads may access (e.g.
   // 'mu_') to be deleted.
@@ -702,6 +780,11 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "batch_timeout_micros must be non-negative; was ",
         options.batch_timeout_micros);
   }
+  if (options.batch_timeout_target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "batch_timeout_target_latency_micros must be non-negative; was ",
+        options.batch_timeout_target_latency_micros);
+  }
   if (options.max_enqueued_batches == 0) {
     return errors::InvalidArgument(
         "max_enqueued_batches must be positive; was ",
@@ -732,9 +815,22 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
-  auto schedulable_batch_callback = [this] {
-    mutex_lock l(mu_);
-    schedulable_batch_cv_.notify_one();
+  // Add the queue to the shard with the fewest queues.
+  Shard* shard = shards_.front().get();
+  if (shards_.size() > 1) {
+    size_t min_num_queues = std::numeric_limits<size_t>::max();
+    for (const std::unique_ptr<Shard>& candidate : shards_) {
+      mutex_lock l(candidate->mu);
+      if (candidate->queues.size() < min_num_queues) {
+        min_num_queues = candidate->queues.size();
+        shard = candidate.get();
+      }
+    }
+  }
+
+  auto schedulable_batch_callback = [shard] {
+    mutex_lock l(shard->mu);
+    shard->schedulable_batch_cv.notify_one();
   };
   auto internal_queue =
       std::unique_ptr<internal::Queue<TaskType>>(new internal::Queue<TaskType>(
@@ -744,10 +840,10 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
       new internal::QueueHandle<TaskType>(this->shared_from_this(),
                                           internal_queue.get()));
   {
-    mutex_lock l(mu_);
-    queues_.push_back(std::move(internal_queue));
-    if (next_queue_to_schedule_ == queues_.end()) {
-      next_queue_to_schedule_ = queues_.begin();
+    mutex_lock l(shard->mu);
+    shard->queues.push_back(std::move(internal_queue));
+    if (shard->next_queue_to_schedule == shard->queues.end()) {
+      shard->next_queue_to_schedule = shard->queues.begin();
     }
   }
   *queue = std::move(handle);
@@ -756,14 +852,18 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
 
 template <typename TaskType>
 SharedBatchScheduler<TaskType>::SharedBatchScheduler(const Options& options)
-    : options_(options), next_queue_to_schedule_(queues_.end()) {
-  // Kick off the batch threads.
+    : options_(options) {
+  for (int i = 0; i < options.num_shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+  // Kick off the batch threads, spreading them evenly over the shards.
   PeriodicFunction::Options periodic_fn_options;
   periodic_fn_options.thread_name_prefix =
       strings::StrCat(options.thread_pool_name, "_");
   for (int i = 0; i < options.num_batch_threads; ++i) {
+    const int shard_index = i % options.num_shards;
     std::unique_ptr<PeriodicFunction> thread(new PeriodicFunction(
-        [this] { this->ThreadLogic(); },
+        [this, shard_index] { this->ThreadLogic(shard_index); },
         0 /* function invocation interval time */, periodic_fn_options));
     batch_threads_.push_back(std::move(thread));
   }
@@ -780,41 +880,43 @@ bool SharedBatchScheduler<TaskType>::BatchExists(
 
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
-    internal::Queue<TaskType>** queue_for_batch_out,
+    Shard& shard, internal::Queue<TaskType>** queue_for_batch_out,
     BatchUniquePtr* batch_to_process_out) {
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
-  const int num_queues = queues_.size();
+  const int num_queues = shard.queues.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
        ++num_queues_tried) {
-    DCHECK(next_queue_to_schedule_ != queues_.end());
+    DCHECK(shard.next_queue_to_schedule != shard.queues.end());
 
     // If a closed queue responds to ScheduleBatch() with nullptr, the queue
     // will never yield any further batches so we can drop it. To avoid a
     // race, we take a snapshot of the queue's closedness state *before*
     // calling ScheduleBatch().
-    const bool queue_closed = (*next_queue_to_schedule_)->closed();
+    const bool queue_closed = (*shard.next_queue_to_schedule)->closed();
 
-    // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-    batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+    // Ask '*next_queue_to_schedule' if it wants us to process a batch.
+    batch_to_process = (*shard.next_queue_to_schedule)->ScheduleBatch();
 
     if (BatchExists(batch_to_process)) {
-      queue_for_batch = next_queue_to_schedule_->get();
+      queue_for_batch = shard.next_queue_to_schedule->get();
     }
 
-    // Advance 'next_queue_to_schedule_'.
-    if (queue_closed && (*next_queue_to_schedule_)->IsEmpty() &&
+    // Advance 'next_queue_to_schedule'.
+    if (queue_closed && (*shard.next_queue_to_schedule)->IsEmpty() &&
         !BatchExists(batch_to_process)) {
       // We've encountered a closed queue with no work to do. Drop it.
-      DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
-      next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
+      DCHECK_NE(queue_for_batch, shard.next_queue_to_schedule->get());
+      shard.next_queue_to_schedule =
+          shard.queues.erase(shard.next_queue_to_schedule);
     } else {
-      ++next_queue_to_schedule_;
+      ++shard.next_queue_to_schedule;
     }
-    if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
+    if (shard.next_queue_to_schedule == shard.queues.end() &&
+        !shard.queues.empty()) {
       // We've hit the end. Wrap to the first queue.
-      next_queue_to_schedule_ = queues_.begin();
+      shard.next_queue_to_schedule = shard.queues.begin();
     }
   }
   *queue_for_batch_out = queue_for_batch;
@@ -822,22 +924,43 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
 }
 
 template <typename TaskType>
-void SharedBatchScheduler<TaskType>::ThreadLogic() {
+void SharedBatchScheduler<TaskType>::StealWorkItem(
+    int shard_index, internal::Queue<TaskType>** queue_for_batch_out,
+    BatchUniquePtr* batch_to_process_out) {
+  const int num_shards = shards_.size();
+  for (int i = 1; i < num_shards; ++i) {
+    Shard& shard = *shards_[(shard_index + i) % num_shards];
+    // Only try the lock, so that stealing never waits for a busy shard nor
+    // deadlocks with another thread stealing in the opposite direction.
+    mutex_lock l(shard.mu, std::try_to_lock);
+    if (!l) continue;
+    GetNextWorkItem_Locked(shard, queue_for_batch_out, batch_to_process_out);
+    if (BatchExists(*batch_to_process_out)) return;
+  }
+}
+
+template <typename TaskType>
+void SharedBatchScheduler<TaskType>::ThreadLogic(int shard_index) {
+  Shard& shard = *shards_[shard_index];
   // A batch to process next (or nullptr if no work to do).
   BatchUniquePtr batch_to_process;
   // The queue with which 'batch_to_process' is associated.
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   {
-    mutex_lock l(mu_);
+    mutex_lock l(shard.mu);
     while (true) {
-      GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process);
+      GetNextWorkItem_Locked(shard, &queue_for_batch, &batch_to_process);
       if (BatchExists(batch_to_process)) break;
+      if (shards_.size() > 1) {
+        StealWorkItem(shard_index, &queue_for_batch, &batch_to_process);
+        if (BatchExists(batch_to_process)) break;
+      }
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
       const int64_t kTimeoutMillis =
           1;  // The smallest accepted granule of time.
-      WaitForMilliseconds(&l, &schedulable_batch_cv_, kTimeoutMillis);
-      if (queues_.empty()) return;
+      WaitForMilliseconds(&l, &shard.schedulable_batch_cv, kTimeoutMillis);
+      if (shard.queues.empty()) return;
     }
   }
 
@@ -881,6 +1004,7 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       max_execution_batch_size_(GetMaxExecutionBatchSize(options_)),
+      execution_batch_size_limit_(max_execution_batch_size_),
       process_batch_callback_(process_batch_callback),
       schedulable_batch_callback_(schedulable_batch_callback) {
   // Set the higher 32 bits of traceme_context_id_counter_ to be the creation
@@ -888,6 +1012,15 @@ Queue<TaskType>::Queue(
   // the same traceme_context_id_counter_.
   traceme_context_id_counter_ = (absl::GetCurrentTimeNanos() & 0xFFFFFFFF)
                                 << 32;
+  if (options_.batch_timeout_target_latency_micros > 0) {
+    BatchTimeoutController::Options controller_options;
+    controller_options.target_latency_micros =
+        options_.batch_timeout_target_latency_micros;
+    controller_options.initial_batch_timeout_micros =
+        options_.batch_timeout_micros;
+    controller_options.max_batch_size = max_execution_batch_size_;
+    timeout_controller_.emplace(controller_options);
+  }
   // Create an initial, open batch.
   if (options_.enable_lazy_split) {
     task_handle_batches_.emplace_back(
@@ -935,6 +1068,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     DCHECK(!closed_);
 
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    RecordTaskForTimeout((*task)->size());
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
@@ -1008,6 +1142,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
   // TODO(b/161857471):
   // Add test coverage when when concurrent incoming batches arrives and
   // use up all queue capacity.
+  UpdateExecutionBatchSizeLimit();
   TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
 
   std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
@@ -1016,6 +1151,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
       max_execution_batch_size() - batches.back()->size();
 
   const int64_t input_task_size = (*task)->size();
+  RecordTaskForTimeout(input_task_size);
 
   std::vector<std::unique_ptr<TaskType>> output_tasks;
 
@@ -1308,6 +1444,7 @@ Queue<TaskType>::GetLowPriorityTasksForPadding(size_t batch_size) {
       break;
     case MixedPriorityBatchingPolicy::
         kLowPriorityPaddingWithNextAllowedBatchSize:
+    case MixedPriorityBatchingPolicy::kPriorityLanes:
       target_batch_size = GetNextAllowedBatchSize(
           batch_size, options_.allowed_batch_sizes, options_.disable_padding);
       break;
@@ -1335,6 +1472,7 @@ void Queue<TaskType>::ProcessBatch(
       tsl::profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
 
+  const uint64 start_time_micros = env_->NowMicros();
   if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
           process_batch_callback_)) {
     std::get<ProcessBatchCallbackWithoutPaddingTasks>(process_batch_callback_)(
@@ -1346,6 +1484,10 @@ void Queue<TaskType>::ProcessBatch(
 
   {
     mutex_lock l(mu_);
+    if (timeout_controller_.has_value()) {
+      timeout_controller_->RecordBatchProcessing(env_->NowMicros() -
+                                                 start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1411,15 +1553,52 @@ Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
       max_execution_batch_size(), std::move(output_tasks));
 }
 
+template <typename TaskType>
+int64_t Queue<TaskType>::batch_timeout_micros() const {
+  return timeout_controller_.has_value()
+             ? timeout_controller_->batch_timeout_micros()
+             : options_.batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::RecordTaskForTimeout(int64_t size) {
+  if (timeout_controller_.has_value()) {
+    timeout_controller_->RecordTask(env_->NowMicros(), size);
+  }
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateExecutionBatchSizeLimit() {
+  if (options_.batch_size_latency_profile == nullptr ||
+      !options_.enable_large_batch_splitting || options_.enable_lazy_split ||
+      !GetBatches().back()->empty()) {
+    return;
+  }
+  const size_t cost_efficient_batch_size =
+      options_.batch_size_latency_profile->cost_efficient_batch_size();
+  if (cost_efficient_batch_size > 0) {
+    execution_batch_size_limit_.store(
+        std::min(cost_efficient_batch_size, max_execution_batch_size_),
+        std::memory_order_relaxed);
+  }
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   Batch<TaskType>* open_batch = GetBatches().back().get();
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  // In the priority lanes mode, high priority tasks never wait for the batch
+  // to fill up; the remaining slots are left to low priority padding.
+  const bool is_priority_lane =
+      options_.enable_priority_queue &&
+      options_.mixed_priority_batching_policy ==
+          MixedPriorityBatchingPolicy::kPriorityLanes;
+  return closed_ || is_priority_lane ||
+         open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
 }
 
 template <typename TaskType>
@@ -1434,7 +1613,7 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
 }
 
 template <typename TaskType>
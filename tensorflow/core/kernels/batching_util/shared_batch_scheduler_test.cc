@@ -1016,6 +1016,135 @@ TEST_P(SharedBatchSchedulerTest, InvalidLazySplitOptions) {
                         "enable_large_batch_splitting is enabled."));
 }
 
+TEST_P(SharedBatchSchedulerTest, InvalidBatchTimeoutTargetLatency) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(2);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/100 * 1000, /*max_enqueued_batches=*/2);
+  queue_options.batch_timeout_target_latency_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(
+      scheduler->AddQueue(queue_options, callback, &queue),
+      testing::StatusIs(error::INVALID_ARGUMENT,
+                        HasSubstr("batch_timeout_target_latency_micros")));
+}
+
+// Tests that a queue with a target latency doesn't hold a task for the much
+// longer static batch timeout.
+TEST_P(SharedBatchSchedulerTest, BatchTimeoutBoundedByTargetLatency) {
+  Notification batch_processed;
+  auto callback = [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_EQ(1, batch->num_tasks());
+    batch_processed.Notify();
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/3600LL * 1000 * 1000,
+      /*max_enqueued_batches=*/2);
+  queue_options.batch_timeout_target_latency_micros = 10 * 1000;
+  std::unique_ptr<Queue> queue =
+      CreateQueue(scheduler, queue_options, callback);
+
+  TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+  batch_processed.WaitForNotification();
+}
+
+// Tests that batches are closed at the cost efficient batch size of the latency
+// profile, with the inputs split across batches.
+TEST_P(SharedBatchSchedulerTest, BatchesClosedAtCostEfficientBatchSize) {
+  if (!enable_input_batch_split() || enable_lazy_split()) {
+    GTEST_SKIP() << "Requires eager input batch splitting.";
+  }
+  mutex mu;
+  std::vector<int> batch_sizes;
+  auto callback = [&mu,
+                   &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batch_sizes.push_back(batch->size());
+  };
+
+  auto profile = std::make_shared<BatchSizeLatencyProfile>(
+      /*allowed_batch_sizes=*/std::vector<int32>{4, 8});
+  // A batch of 8 takes three times as long as a batch of 4.
+  profile->RecordLatency(4, 10);
+  profile->RecordLatency(8, 30);
+  ASSERT_EQ(profile->cost_efficient_batch_size(), 4);
+
+  {
+    auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/8, /*input_batch_size_limit=*/8,
+        /*batch_timeout_micros=*/3600LL * 1000 * 1000,
+        /*max_enqueued_batches=*/2);
+    queue_options.batch_size_latency_profile = profile;
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, callback);
+
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+  }
+  EXPECT_THAT(batch_sizes, ::testing::ElementsAre(4, 2));
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidNumShards) {
+  for (const int num_shards : {0, 3}) {
+    Scheduler::Options options;
+    options.num_batch_threads = 2;
+    options.num_shards = num_shards;
+    std::shared_ptr<Scheduler> scheduler;
+    EXPECT_THAT(Scheduler::Create(options, &scheduler),
+                testing::StatusIs(error::INVALID_ARGUMENT,
+                                  HasSubstr("num_shards must be between 1")));
+  }
+}
+
+// Tests that all tasks of queues spread over several shards get processed.
+TEST_P(SharedBatchSchedulerTest, ShardedQueuesProcessAllTasks) {
+  constexpr int kNumQueues = 5;
+  constexpr int kNumTasksPerQueue = 20;
+  mutex mu;
+  int total_size = 0;
+  auto callback = [&mu, &total_size](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    total_size += batch->size();
+  };
+
+  {
+    Scheduler::Options options;
+    options.num_batch_threads = 4;
+    options.num_shards = 2;
+    std::shared_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    for (int i = 0; i < kNumQueues; ++i) {
+      queues.push_back(CreateQueue(
+          scheduler,
+          CreateQueueOptions(/*max_execution_batch_size=*/4,
+                             /*input_batch_size_limit=*/4,
+                             /*batch_timeout_micros=*/1000,
+                             /*max_enqueued_batches=*/kNumTasksPerQueue),
+          callback));
+    }
+    for (int i = 0; i < kNumTasksPerQueue; ++i) {
+      for (const std::unique_ptr<Queue>& queue : queues) {
+        TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      }
+    }
+    // Destroying the queues blocks until all of their tasks are processed.
+  }
+  EXPECT_EQ(total_size, kNumQueues * kNumTasksPerQueue);
+}
+
 // Tests that queue configured with zero `max_enqueued_batches` get one queue.
 // Note, technically an invalid-argument error should be returned.
 // Since existing models (with very low QPS) rely on the rewrite, retain the
@@ -1602,6 +1731,58 @@ TEST_P(SharedBatchSchedulerPriorityPolicyTest,
   EXPECT_EQ(queue_callback_counter, 2);
 }
 
+TEST_P(SharedBatchSchedulerPriorityPolicyTest,
+       HighPriorityBatchScheduledImmediatelyWithPriorityLanes) {
+  Notification high_priority_batch_processed;
+  auto queue_callback = [&high_priority_batch_processed](
+                            std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    // Skip the low priority task only batch.
+    if (high_priority_batch_processed.HasBeenNotified()) return;
+    high_priority_batch_processed.Notify();
+
+    ASSERT_TRUE(batch->IsClosed());
+    ASSERT_EQ(1, batch->num_tasks());
+    EXPECT_EQ(3, batch->task(0).size());
+    // Only the padding slots up to the next allowed batch size are filled.
+    ASSERT_EQ(1, tasks.size());
+    EXPECT_EQ(1, tasks[0]->size());
+  };
+
+  {
+    std::shared_ptr<Scheduler> scheduler =
+        CreateSharedBatchScheduler(/*num_batch_threads=*/3);
+
+    // Create a queue with the priority queue enabled. The high priority batch
+    // timeout is long enough that only the priority lanes policy can schedule
+    // the high priority batch within the test.
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/8, /*input_batch_size_limit=*/8,
+        /*batch_timeout_micros=*/3600LL * 1000 * 1000,
+        /*max_enqueued_batches=*/2, /*enable_priority_queue=*/true);
+    queue_options.allowed_batch_sizes = {4, 8};
+    queue_options.low_priority_queue_options.max_execution_batch_size = 8;
+    queue_options.low_priority_queue_options.batch_timeout_micros =
+        1 * 1000 * 1000;
+    queue_options.low_priority_queue_options.input_batch_size_limit = 8;
+    queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+    queue_options.mixed_priority_batching_policy =
+        MixedPriorityBatchingPolicy::kPriorityLanes;
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get(),
+                              tsl::criticality::Criticality::kCriticalPlus));
+    high_priority_batch_processed.WaitForNotification();
+  }
+}
+
 // Lazy split is to be removed. The mixed priority batching is only supported
 // when the lazy split is not enabled.
 INSTANTIATE_TEST_SUITE_P(
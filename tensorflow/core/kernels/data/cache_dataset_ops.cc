@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
@@ -76,6 +77,37 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+
+// Bytes of elements a memory cache holds in memory before spilling the
+// following elements to the local directory TF_DATA_CACHE_SPILL_DIR, set by
+// TF_DATA_CACHE_MEMORY_BUDGET_MB. 0, the default, disables spilling.
+int64_t CacheMemoryBudgetBytes() {
+  int64_t budget_mb;
+  Status status =
+      ReadInt64FromEnvVar("TF_DATA_CACHE_MEMORY_BUDGET_MB", 0, &budget_mb);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 0;
+  }
+  return budget_mb * 1024 * 1024;
+}
+
+std::string CacheSpillDir() {
+  std::string dir;
+  Status status = ReadStringFromEnvVar("TF_DATA_CACHE_SPILL_DIR", "", &dir);
+  if (!status.ok()) LOG(ERROR) << status;
+  return dir;
+}
+
+// Reads all elements of `cache`, including the spilled ones.
+Status ReadAllElements(MemoryCache* cache,
+                       std::vector<std::vector<Tensor>>* elements) {
+  elements->resize(cache->size());
+  for (int64_t i = 0; i < elements->size(); ++i) {
+    TF_RETURN_IF_ERROR(cache->Get(i, &(*elements)[i]));
+  }
+  return absl::OkStatus();
+}
 }  // namespace
 
 class DatasetRandomAccessCache {
@@ -877,8 +909,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        if (cache_->num_spilled() == 0) {
+          TF_RETURN_IF_ERROR(
+              WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        } else {
+          std::vector<std::vector<Tensor>> elements;
+          TF_RETURN_IF_ERROR(ReadAllElements(cache_, &elements));
+          TF_RETURN_IF_ERROR(
+              WriteElementsToCheckpoint(writer, prefix(), elements));
+        }
       }
       return SaveInput(ctx, writer, iterator_);
     }
@@ -909,13 +948,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if ((!temp_cache_.empty() || spill_file_ != nullptr) &&
+            !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        memory_budget_bytes_ = CacheMemoryBudgetBytes();
+        if (memory_budget_bytes_ > 0) spill_dir_ = CacheSpillDir();
         return dataset()->input_->MakeIterator(ctx, this, prefix(),
                                                &input_impl_);
       }
@@ -929,16 +972,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(CompleteCache());
           }
           return absl::OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        TF_RETURN_IF_ERROR(AddElement(ctx, *out_tensors));
+        if (num_elements() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(CompleteCache());
         }
         return absl::OkStatus();
       }
@@ -954,8 +996,22 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          if (spill_file_ == nullptr) {
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          } else {
+            // The checkpoint holds all elements, since the spill file does
+            // not outlive the iterator.
+            TF_RETURN_IF_ERROR(spill_file_->Flush());
+            std::vector<std::vector<Tensor>> elements = temp_cache_;
+            elements.resize(num_elements());
+            for (int64_t i = 0; i < spill_file_->size(); ++i) {
+              TF_RETURN_IF_ERROR(
+                  spill_file_->Read(i, &elements[temp_cache_.size() + i]));
+            }
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), elements));
+          }
         }
         return SaveInput(ctx, writer, input_impl_);
       }
@@ -964,17 +1020,69 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              IteratorStateReader* reader) override {
         mutex_lock l(mu_);
         if (!reader->Contains(prefix(), kCacheCompleted)) {
+          std::vector<std::vector<Tensor>> elements;
           TF_RETURN_IF_ERROR(
-              ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+              ReadElementsFromCheckpoint(ctx, reader, prefix(), &elements));
+          temp_cache_.clear();
+          temp_cache_bytes_ = 0;
+          spill_file_.reset();
+          for (const std::vector<Tensor>& element : elements) {
+            TF_RETURN_IF_ERROR(AddElement(ctx, element));
+          }
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
 
      private:
+      // Adds `element` to the cache, in memory while the memory budget allows
+      // it, and to the spill file otherwise.
+      Status AddElement(IteratorContext* ctx,
+                        const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64_t bytes = GetTotalBytes(element);
+        if (spill_file_ == nullptr &&
+            (memory_budget_bytes_ <= 0 || spill_dir_.empty() ||
+             temp_cache_bytes_ + bytes <= memory_budget_bytes_)) {
+          RecordBufferEnqueue(ctx, element);
+          temp_cache_.emplace_back(element);
+          temp_cache_bytes_ += bytes;
+          return absl::OkStatus();
+        }
+        if (spill_file_ == nullptr) {
+          TF_ASSIGN_OR_RETURN(spill_file_,
+                              CacheSpillFile::Create(ctx->env(), spill_dir_));
+          VLOG(2) << "Spilling the cache to " << spill_dir_ << " after "
+                  << temp_cache_.size() << " elements of " << temp_cache_bytes_
+                  << " bytes.";
+        }
+        return spill_file_->Append(element);
+      }
+
+      Status CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_file_ != nullptr) {
+          TF_RETURN_IF_ERROR(spill_file_->Finish());
+          VLOG(2) << "Spilled " << spill_file_->size() << " elements of the "
+                  << "cache in " << spill_file_->bytes()
+                  << " compressed bytes.";
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(spill_file_));
+        return absl::OkStatus();
+      }
+
+      int64_t num_elements() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return temp_cache_.size() +
+               (spill_file_ == nullptr ? 0 : spill_file_->size());
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      int64_t temp_cache_bytes_ TF_GUARDED_BY(mu_) = 0;
+      int64_t memory_budget_bytes_ TF_GUARDED_BY(mu_) = 0;
+      std::string spill_dir_ TF_GUARDED_BY(mu_);
+      // Holds the elements that do not fit in the memory budget.
+      std::unique_ptr<CacheSpillFile> spill_file_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -991,8 +1099,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
-          RecordBufferEnqueue(ctx, cache_->at(i));
+        for (const std::vector<Tensor>& element : cache_->data()) {
+          RecordBufferEnqueue(ctx, element);
         }
         return absl::OkStatus();
       }
@@ -1002,7 +1110,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+          std::vector<Tensor> cache_tensors;
+          TF_RETURN_IF_ERROR(cache_->Get(index_, &cache_tensors));
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
           index_++;
@@ -14,14 +14,29 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
 
 namespace tensorflow {
 namespace data {
@@ -33,10 +48,89 @@ constexpr char kMemoryCache[] = "MemoryCache";
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
-void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+CacheSpillFile::CacheSpillFile(Env* env, std::string filename,
+                               std::unique_ptr<WritableFile> writable_file,
+                               std::unique_ptr<RandomAccessFile> readable_file)
+    : env_(env),
+      filename_(std::move(filename)),
+      writable_file_(std::move(writable_file)),
+      readable_file_(std::move(readable_file)) {}
+
+absl::StatusOr<std::unique_ptr<CacheSpillFile>> CacheSpillFile::Create(
+    Env* env, const std::string& dir) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  std::string filename = io::JoinPath(
+      dir, strings::StrCat("tf_data_cache_", env->NowMicros(), "_",
+                           random::New64(), ".spill"));
+  std::unique_ptr<WritableFile> writable_file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &writable_file));
+  std::unique_ptr<RandomAccessFile> readable_file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &readable_file));
+  return absl::WrapUnique(new CacheSpillFile(env, std::move(filename),
+                                             std::move(writable_file),
+                                             std::move(readable_file)));
+}
+
+CacheSpillFile::~CacheSpillFile() {
+  writable_file_.reset();
+  readable_file_.reset();
+  Status s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete the cache spill file " << filename_
+                 << ": " << s;
+  }
+}
+
+Status CacheSpillFile::Append(const std::vector<Tensor>& element) {
+  if (writable_file_ == nullptr) {
+    return errors::FailedPrecondition("Cache spill file ", filename_,
+                                      " is already finished.");
+  }
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+  const std::string record = compressed.SerializeAsString();
+  TF_RETURN_IF_ERROR(writable_file_->Append(record));
+  records_.emplace_back(bytes_, record.size());
+  bytes_ += record.size();
+  return absl::OkStatus();
+}
+
+Status CacheSpillFile::Flush() {
+  if (writable_file_ == nullptr) return absl::OkStatus();
+  return writable_file_->Flush();
+}
+
+Status CacheSpillFile::Finish() {
+  if (writable_file_ == nullptr) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(writable_file_->Close());
+  writable_file_.reset();
+  return absl::OkStatus();
+}
+
+Status CacheSpillFile::Read(int64_t index,
+                            std::vector<Tensor>* element) const {
+  DCHECK(index < records_.size());
+  const auto& [offset, length] = records_[index];
+  std::string scratch(length, '\0');
+  StringPiece record;
+  TF_RETURN_IF_ERROR(
+      readable_file_->Read(offset, length, &record, scratch.data()));
+  CompressedElement compressed;
+  if (record.size() != length ||
+      !compressed.ParseFromArray(record.data(), record.size())) {
+    return errors::DataLoss("Failed to read element ", index,
+                            " of the cache spill file ", filename_);
+  }
+  element->clear();
+  return UncompressElement(compressed, element);
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           std::unique_ptr<CacheSpillFile> spill_file) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spill_file_ = std::move(spill_file);
     completed_ = true;
   }
 }
@@ -50,6 +144,7 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spill_file_.reset();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -58,9 +153,32 @@ const std::vector<Tensor>& MemoryCache::at(int64_t index) {
   return cache_[index];
 }
 
+Status MemoryCache::Get(int64_t index, std::vector<Tensor>* element) {
+  std::shared_ptr<const CacheSpillFile> spill_file;
+  int64_t spill_index;
+  {
+    tf_shared_lock l(mu_);
+    if (index < cache_.size()) {
+      *element = cache_[index];
+      return absl::OkStatus();
+    }
+    spill_file = spill_file_;
+    spill_index = index - cache_.size();
+  }
+  if (spill_file == nullptr || spill_index >= spill_file->size()) {
+    return errors::OutOfRange("Index ", index, " is out of the cache.");
+  }
+  return spill_file->Read(spill_index, element);
+}
+
 size_t MemoryCache::size() {
   tf_shared_lock l(mu_);
-  return cache_.size();
+  return cache_.size() + (spill_file_ == nullptr ? 0 : spill_file_->size());
+}
+
+size_t MemoryCache::num_spilled() {
+  tf_shared_lock l(mu_);
+  return spill_file_ == nullptr ? 0 : spill_file_->size();
 }
 
 const std::vector<std::vector<Tensor>>& MemoryCache::data() {
@@ -16,12 +16,67 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 namespace data {
 
+// Dataset elements of a `MemoryCache` stored compressed in a local file, once
+// the memory budget of the cache is exhausted.
+//
+// Elements are appended by a single writer, and can be read concurrently, e.g.
+// by several `MemoryReaderIterator`s, since each read is a positional read of
+// the file. The file is deleted with the object.
+class CacheSpillFile {
+ public:
+  // Creates a spill file in the directory `dir`.
+  static absl::StatusOr<std::unique_ptr<CacheSpillFile>> Create(
+      Env* env, const std::string& dir);
+
+  ~CacheSpillFile();
+
+  // Compresses and appends `element` to the file.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Makes the appended elements readable.
+  Status Flush();
+
+  // Closes the file for writing, after which all elements are readable.
+  Status Finish();
+
+  // Reads the element at the given index, which must be readable.
+  Status Read(int64_t index, std::vector<Tensor>* element) const;
+
+  // Returns the number of elements in the file.
+  size_t size() const { return records_.size(); }
+
+  // Returns the number of compressed bytes in the file.
+  uint64_t bytes() const { return bytes_; }
+
+ private:
+  CacheSpillFile(Env* env, std::string filename,
+                 std::unique_ptr<WritableFile> writable_file,
+                 std::unique_ptr<RandomAccessFile> readable_file);
+
+  Env* const env_;
+  const std::string filename_;
+  std::unique_ptr<WritableFile> writable_file_;
+  std::unique_ptr<RandomAccessFile> readable_file_;
+  // The offset and the length of each element in the file.
+  std::vector<std::pair<uint64_t, uint64_t>> records_;
+  uint64_t bytes_ = 0;
+};
+
 // A thread-safe data structure for caching dataset elements.
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
@@ -31,8 +86,10 @@ class MemoryCache {
  public:
   MemoryCache() = default;
 
-  // Marks the cache as completed.
-  void Complete(std::vector<std::vector<Tensor>>&& cache);
+  // Marks the cache as completed. `spill_file`, if any, must be finished and
+  // holds the elements that follow those of `cache`.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::unique_ptr<CacheSpillFile> spill_file = nullptr);
 
   // Returns whether the cache is completed.
   bool IsCompleted();
@@ -40,14 +97,20 @@ class MemoryCache {
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
+  // Returns the element at the given index, which must be held in memory.
   const std::vector<Tensor>& at(int64_t index);
 
-  // Returns the size of the cache.
+  // Reads the element at the given index, from memory or from the spill file.
+  Status Get(int64_t index, std::vector<Tensor>* element);
+
+  // Returns the size of the cache, including the spilled elements.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
+  // Returns the number of elements in the spill file.
+  size_t num_spilled();
+
+  // Returns a reference to the cache's data held in memory. The returned
+  // reference will be invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
 
  private:
@@ -55,6 +118,9 @@ class MemoryCache {
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  // Shared with the readers, so that a spilled element can be read without
+  // holding `mu_`.
+  std::shared_ptr<const CacheSpillFile> spill_file_ TF_GUARDED_BY(mu_);
 };
 
 // A resource wrapping a shared instance of a memory cache.
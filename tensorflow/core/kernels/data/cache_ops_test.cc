@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_ops.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t value) {
+  return {test::AsScalar<int64_t>(value),
+          test::AsTensor<tstring>({"a", "b"}, {2})};
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t value) {
+  ASSERT_EQ(element.size(), 2);
+  test::ExpectTensorEqual<int64_t>(element[0], test::AsScalar<int64_t>(value));
+  test::ExpectTensorEqual<tstring>(element[1],
+                                   test::AsTensor<tstring>({"a", "b"}, {2}));
+}
+
+TEST(CacheSpillFileTest, ReadsAppendedElements) {
+  const std::string dir = io::JoinPath(testing::TmpDir(), "spill_file");
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CacheSpillFile> file,
+                          CacheSpillFile::Create(Env::Default(), dir));
+  TF_ASSERT_OK(file->Append(MakeElement(0)));
+  TF_ASSERT_OK(file->Flush());
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(file->Read(0, &element));
+  ExpectElement(element, 0);
+
+  TF_ASSERT_OK(file->Append(MakeElement(1)));
+  TF_ASSERT_OK(file->Finish());
+  EXPECT_EQ(file->size(), 2);
+  EXPECT_GT(file->bytes(), 0);
+  TF_ASSERT_OK(file->Read(1, &element));
+  ExpectElement(element, 1);
+  EXPECT_TRUE(errors::IsFailedPrecondition(file->Append(MakeElement(2))));
+
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_EQ(children.size(), 1);
+  file.reset();
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST(MemoryCacheTest, GetsInMemoryAndSpilledElements) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CacheSpillFile> file,
+      CacheSpillFile::Create(Env::Default(),
+                             io::JoinPath(testing::TmpDir(), "memory_cache")));
+  TF_ASSERT_OK(file->Append(MakeElement(2)));
+  TF_ASSERT_OK(file->Finish());
+
+  MemoryCache cache;
+  cache.Complete({MakeElement(0), MakeElement(1)}, std::move(file));
+  EXPECT_TRUE(cache.IsCompleted());
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.num_spilled(), 1);
+  EXPECT_EQ(cache.data().size(), 2);
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(cache.Get(i, &element));
+    ExpectElement(element, i);
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(cache.Get(3, &element)));
+
+  cache.Reset();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.num_spilled(), 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
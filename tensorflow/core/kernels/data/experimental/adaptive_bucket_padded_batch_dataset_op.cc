@@ -0,0 +1,584 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/adaptive_bucket_padded_batch_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kBatchSize;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kNumBuckets;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    AdaptiveBucketPaddedBatchDatasetOp::kNumPaddedShapes;
+
+namespace {
+
+constexpr char kExhausted[] = "exhausted";
+constexpr char kNumObserved[] = "num_observed";
+constexpr char kHistogram[] = "histogram";
+constexpr char kBoundaries[] = "boundaries";
+constexpr char kBucket[] = "bucket";
+
+// The boundary search merges adjacent lengths into at most this many bins, so
+// that its cost does not depend on the number of distinct lengths.
+constexpr int64_t kMaxHistogramBins = 256;
+
+// Once the histogram holds more elements than this, its counts are halved, so
+// that the boundaries follow changes of the length distribution.
+constexpr int64_t kMaxHistogramCount = 1 << 20;
+
+// A range of adjacent lengths of the histogram.
+struct LengthBin {
+  int64_t max_length = 0;
+  int64_t count = 0;
+  // The sum of the lengths of the elements in the bin.
+  double length_sum = 0;
+};
+
+}  // namespace
+
+std::vector<int64_t> ComputeBucketBoundaries(
+    const std::map<int64_t, int64_t>& length_histogram, int64_t num_buckets) {
+  int64_t total_count = 0;
+  for (const auto& [length, count] : length_histogram) {
+    total_count += count;
+  }
+  if (num_buckets <= 1 || length_histogram.size() <= 1 || total_count == 0) {
+    return {};
+  }
+
+  // Merge adjacent lengths into bins of similar counts. Padding within a bin is
+  // still accounted for exactly, because elements are padded to the largest
+  // length of their bucket, which is the largest length of one of its bins.
+  const int64_t bin_count =
+      (total_count + kMaxHistogramBins - 1) / kMaxHistogramBins;
+  std::vector<LengthBin> bins;
+  for (const auto& [length, count] : length_histogram) {
+    if (count <= 0) continue;
+    if (bins.empty() || bins.back().count >= bin_count) {
+      bins.emplace_back();
+    }
+    bins.back().max_length = length;
+    bins.back().count += count;
+    bins.back().length_sum += static_cast<double>(length) * count;
+  }
+  const int64_t num_bins = bins.size();
+  std::vector<int64_t> count_prefix(num_bins + 1, 0);
+  std::vector<double> length_sum_prefix(num_bins + 1, 0);
+  for (int64_t i = 0; i < num_bins; ++i) {
+    count_prefix[i + 1] = count_prefix[i] + bins[i].count;
+    length_sum_prefix[i + 1] = length_sum_prefix[i] + bins[i].length_sum;
+  }
+  // Returns the padding of a bucket of bins `first` to `last`.
+  auto padding = [&](int64_t first, int64_t last) {
+    return static_cast<double>(bins[last].max_length) *
+               (count_prefix[last + 1] - count_prefix[first]) -
+           (length_sum_prefix[last + 1] - length_sum_prefix[first]);
+  };
+  const int64_t min_bucket_count = total_count / (2 * num_buckets);
+  const int64_t max_buckets = std::min(num_buckets, num_bins);
+
+  // `cost[k][j]` is the least padding of bins 0 to `j` in `k + 1` buckets, and
+  // `first_bin[k][j]` is the first bin of the last of these buckets.
+  constexpr double kInfeasible = std::numeric_limits<double>::infinity();
+  std::vector<std::vector<double>> cost(
+      max_buckets, std::vector<double>(num_bins, kInfeasible));
+  std::vector<std::vector<int64_t>> first_bin(
+      max_buckets, std::vector<int64_t>(num_bins, 0));
+  for (int64_t j = 0; j < num_bins; ++j) {
+    if (count_prefix[j + 1] >= min_bucket_count) {
+      cost[0][j] = padding(0, j);
+    }
+  }
+  for (int64_t k = 1; k < max_buckets; ++k) {
+    for (int64_t j = k; j < num_bins; ++j) {
+      for (int64_t i = k; i <= j; ++i) {
+        if (cost[k - 1][i - 1] == kInfeasible ||
+            count_prefix[j + 1] - count_prefix[i] < min_bucket_count) {
+          continue;
+        }
+        const double c = cost[k - 1][i - 1] + padding(i, j);
+        if (c < cost[k][j]) {
+          cost[k][j] = c;
+          first_bin[k][j] = i;
+        }
+      }
+    }
+  }
+
+  // Prefer fewer buckets when they pad equally little.
+  int64_t best_num_buckets = 0;
+  for (int64_t k = 1; k < max_buckets; ++k) {
+    if (cost[k][num_bins - 1] < cost[best_num_buckets][num_bins - 1]) {
+      best_num_buckets = k;
+    }
+  }
+  std::vector<int64_t> boundaries;
+  int64_t last = num_bins - 1;
+  for (int64_t k = best_num_buckets; k > 0; --k) {
+    const int64_t first = first_bin[k][last];
+    boundaries.push_back(bins[first - 1].max_length);
+    last = first - 1;
+  }
+  std::reverse(boundaries.begin(), boundaries.end());
+  return boundaries;
+}
+
+class AdaptiveBucketPaddedBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, int64_t batch_size, int64_t num_buckets,
+          bool drop_remainder, std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, const DatasetBase* input)
+      : DatasetBase(DatasetContext(ctx)),
+        batch_size_(batch_size),
+        num_buckets_(num_buckets),
+        drop_remainder_(drop_remainder),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        input_(input),
+        traceme_metadata_(
+            {{"batch_size",
+              strings::Printf("%lld", static_cast<long long>(batch_size))},
+             {"num_buckets",
+              strings::Printf("%lld", static_cast<long long>(num_buckets))},
+             {"drop_remainder", drop_remainder ? "true" : "false"}}) {
+    input_->Ref();
+    output_shapes_.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      output_shapes_.push_back(
+          PartialTensorShape({drop_remainder_ ? batch_size_ : -1})
+              .Concatenate(padded_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(batch_size_, num_buckets_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    // The number of partial batches depends on the lengths of the elements.
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    Node* num_buckets = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_buckets_, &num_buckets));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+      for (int j = 0; j < padded_shape.dims(); ++j) {
+        t.vec<int64_t>()(j) = padded_shape.dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+    return b->AddDataset(this,
+                         {{0, input_graph_node},
+                          {1, batch_size},
+                          {2, num_buckets},
+                          {5, drop_remainder}},
+                         {{3, padded_shapes}, {4, padding_values}},
+                         {{kToutputTypes, output_types}, {kNumPaddedShapes, N}},
+                         output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->num_buckets_) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch_elements;
+      {
+        mutex_lock l(mu_);
+        while (input_impl_ && batch_elements.empty()) {
+          std::vector<Tensor> element;
+          bool end_of_input = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            break;
+          }
+          TF_ASSIGN_OR_RETURN(int64_t length, ElementLength(element));
+          std::vector<std::vector<Tensor>>& bucket = buckets_[Observe(length)];
+          bucket.push_back(std::move(element));
+          if (bucket.size() == dataset()->batch_size_) {
+            batch_elements = std::move(bucket);
+            bucket.clear();
+          }
+        }
+        // Once the input is exhausted, flush the partially filled buckets.
+        if (!input_impl_ && batch_elements.empty()) {
+          for (auto& bucket : buckets_) {
+            if (!bucket.empty() && !dataset()->drop_remainder_) {
+              batch_elements = std::move(bucket);
+              bucket.clear();
+              break;
+            }
+            bucket.clear();
+          }
+        }
+      }
+      if (batch_elements.empty()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      TF_RETURN_IF_ERROR(CopyPaddedBatch(
+          ctx, batch_elements, dataset()->padded_shapes_,
+          dataset()->padding_values_, /*parallel_copy=*/false, out_tensors));
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args), dataset()->batch_size_);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kExhausted, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNumObserved, num_observed_));
+      const int64_t histogram_size = histogram_.size();
+      Tensor histogram(DT_INT64, TensorShape({histogram_size, 2}));
+      auto histogram_matrix = histogram.matrix<int64_t>();
+      int64_t i = 0;
+      for (const auto& [length, count] : histogram_) {
+        histogram_matrix(i, 0) = length;
+        histogram_matrix(i, 1) = count;
+        ++i;
+      }
+      TF_RETURN_IF_ERROR(writer->WriteTensor(prefix(), kHistogram, histogram));
+      const int64_t num_boundaries = boundaries_.size();
+      Tensor boundaries(DT_INT64, TensorShape({num_boundaries}));
+      std::copy(boundaries_.begin(), boundaries_.end(),
+                boundaries.vec<int64_t>().data());
+      TF_RETURN_IF_ERROR(
+          writer->WriteTensor(prefix(), kBoundaries, boundaries));
+      for (int64_t b = 0; b < buckets_.size(); ++b) {
+        const std::string name = strings::StrCat(kBucket, "[", b, "]");
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(name, "_size"), buckets_[b].size()));
+        for (int64_t j = 0; j < buckets_[b].size(); ++j) {
+          for (int64_t k = 0; k < buckets_[b][j].size(); ++k) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                prefix(), strings::StrCat(name, "[", j, "][", k, "]"),
+                buckets_[b][j][k]));
+          }
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_exhausted;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kExhausted, &input_exhausted));
+      if (static_cast<bool>(input_exhausted)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumObserved, &num_observed_));
+      Tensor histogram;
+      TF_RETURN_IF_ERROR(
+          reader->ReadTensor(ctx->flr(), prefix(), kHistogram, &histogram));
+      histogram_.clear();
+      auto histogram_matrix = histogram.matrix<int64_t>();
+      for (int64_t i = 0; i < histogram.dim_size(0); ++i) {
+        histogram_[histogram_matrix(i, 0)] = histogram_matrix(i, 1);
+      }
+      Tensor boundaries;
+      TF_RETURN_IF_ERROR(
+          reader->ReadTensor(ctx->flr(), prefix(), kBoundaries, &boundaries));
+      boundaries_.assign(
+          boundaries.vec<int64_t>().data(),
+          boundaries.vec<int64_t>().data() + boundaries.NumElements());
+      const int64_t num_components = dataset()->output_dtypes().size();
+      for (int64_t b = 0; b < buckets_.size(); ++b) {
+        const std::string name = strings::StrCat(kBucket, "[", b, "]");
+        int64_t bucket_size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), strings::StrCat(name, "_size"), &bucket_size));
+        buckets_[b].assign(bucket_size, std::vector<Tensor>(num_components));
+        for (int64_t j = 0; j < bucket_size; ++j) {
+          for (int64_t k = 0; k < num_components; ++k) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                ctx->flr(), prefix(),
+                strings::StrCat(name, "[", j, "][", k, "]"),
+                &buckets_[b][j][k]));
+          }
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // Returns the length of `element`, which is the size of the first
+    // dimension of its first component.
+    static absl::StatusOr<int64_t> ElementLength(
+        const std::vector<Tensor>& element) {
+      if (element.empty() || element[0].dims() == 0) {
+        return errors::InvalidArgument(
+            "AdaptiveBucketPaddedBatchDataset requires the first component of "
+            "its input elements to have rank of at least 1.");
+      }
+      return element[0].dim_size(0);
+    }
+
+    // Records the length of an element in the histogram, recomputes the
+    // bucket boundaries periodically, and returns the bucket of the element.
+    int64_t Observe(int64_t length) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ++histogram_[length];
+      ++num_observed_;
+      if (num_observed_ >= kMaxHistogramCount) {
+        num_observed_ = 0;
+        for (auto it = histogram_.begin(); it != histogram_.end();) {
+          it->second /= 2;
+          num_observed_ += it->second;
+          it = it->second == 0 ? histogram_.erase(it) : std::next(it);
+        }
+      }
+      // Recompute the boundaries once for about every batch of every bucket.
+      if (num_observed_ % (dataset()->batch_size_ * dataset()->num_buckets_) ==
+          0) {
+        boundaries_ = ComputeBucketBoundaries(histogram_,
+                                              dataset()->num_buckets_);
+      }
+      return std::lower_bound(boundaries_.begin(), boundaries_.end(), length) -
+             boundaries_.begin();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // Maps the observed lengths to their numbers of elements.
+    std::map<int64_t, int64_t> histogram_ TF_GUARDED_BY(mu_);
+    int64_t num_observed_ TF_GUARDED_BY(mu_) = 0;
+    // The upper bounds of all buckets but the last one.
+    std::vector<int64_t> boundaries_ TF_GUARDED_BY(mu_);
+    // The buffered elements of each bucket, fewer than `batch_size_` each.
+    std::vector<std::vector<std::vector<Tensor>>> buckets_ TF_GUARDED_BY(mu_);
+  };
+
+  const int64_t batch_size_;
+  const int64_t num_buckets_;
+  const bool drop_remainder_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const DatasetBase* const input_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+AdaptiveBucketPaddedBatchDatasetOp::AdaptiveBucketPaddedBatchDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {}
+
+void AdaptiveBucketPaddedBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                     DatasetBase* input,
+                                                     DatasetBase** output) {
+  int64_t batch_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("Batch size must be greater than zero."));
+  int64_t num_buckets;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kNumBuckets, &num_buckets));
+  OP_REQUIRES(
+      ctx, num_buckets > 0,
+      errors::InvalidArgument("Number of buckets must be greater than zero."));
+  bool drop_remainder;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == input->output_shapes().size(),
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      input->output_shapes().size(), ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(padded_shape_tensors.size());
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+  OP_REQUIRES(ctx, padded_shapes[0].dims() > 0,
+              errors::InvalidArgument(
+                  "The first component, whose first dimension is the length "
+                  "used for bucketing, must have rank of at least 1."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, batch_size, num_buckets, drop_remainder,
+                        std::move(padded_shapes), std::move(padding_values),
+                        input);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(
+    Name("AdaptiveBucketPaddedBatchDataset").Device(DEVICE_CPU),
+    AdaptiveBucketPaddedBatchDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_ADAPTIVE_BUCKET_PADDED_BATCH_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_ADAPTIVE_BUCKET_PADDED_BATCH_DATASET_OP_H_
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Returns the upper bounds of the length buckets, in increasing order, that
+// minimize the padding of the elements of `length_histogram`, which maps
+// lengths to their numbers of elements, when each element is padded to the
+// largest length of its bucket. At most `num_buckets` buckets are used, so at
+// most `num_buckets - 1` bounds are returned; elements longer than the last
+// bound belong to the last bucket. To keep the batches of every bucket
+// filling up at a similar pace, each bucket holds at least
+// 1 / (2 * `num_buckets`) of the elements.
+std::vector<int64_t> ComputeBucketBoundaries(
+    const std::map<int64_t, int64_t>& length_histogram, int64_t num_buckets);
+
+// See tensorflow/core/api_def/base_api/
+// api_def_AdaptiveBucketPaddedBatchDataset.pbtxt for the API definition that
+// corresponds to this kernel.
+class AdaptiveBucketPaddedBatchDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  // Names of op parameters, public so that they can be accessed by test cases.
+  // Make sure that these are kept in sync with the REGISTER_OP call in
+  // tensorflow/core/ops/experimental_dataset_ops.cc
+  static constexpr const char* const kDatasetType = "AdaptiveBucketPaddedBatch";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kBatchSize = "batch_size";
+  static constexpr const char* const kNumBuckets = "num_buckets";
+  static constexpr const char* const kPaddedShapes = "padded_shapes";
+  static constexpr const char* const kPaddingValues = "padding_values";
+  static constexpr const char* const kDropRemainder = "drop_remainder";
+  static constexpr const char* const kToutputTypes = "Toutput_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kNumPaddedShapes = "N";
+
+  explicit AdaptiveBucketPaddedBatchDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_ADAPTIVE_BUCKET_PADDED_BATCH_DATASET_OP_H_
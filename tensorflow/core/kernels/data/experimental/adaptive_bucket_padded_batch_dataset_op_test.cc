@@ -0,0 +1,317 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/adaptive_bucket_padded_batch_dataset_op.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+constexpr char kNodeName[] = "adaptive_bucket_padded_batch_dataset";
+
+class AdaptiveBucketPaddedBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+class AdaptiveBucketPaddedBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  AdaptiveBucketPaddedBatchDatasetParams(
+      T input_dataset_params, int64_t batch_size, int64_t num_buckets,
+      std::vector<Tensor> padded_shapes, std::vector<Tensor> padded_values,
+      bool drop_remainder, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        batch_size_(batch_size),
+        num_buckets_(num_buckets),
+        padded_shapes_(std::move(padded_shapes)),
+        padded_values_(std::move(padded_values)),
+        drop_remainder_(drop_remainder) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors;
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {batch_size_}));
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {num_buckets_}));
+    for (auto& padded_shape : padded_shapes_) {
+      input_tensors.emplace_back(padded_shape);
+    }
+    for (auto& padded_value : padded_values_) {
+      input_tensors.emplace_back(padded_value);
+    }
+    input_tensors.emplace_back(
+        CreateTensor<bool>(TensorShape({}), {drop_remainder_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {AdaptiveBucketPaddedBatchDatasetOp::kInputDataset,
+                    AdaptiveBucketPaddedBatchDatasetOp::kBatchSize,
+                    AdaptiveBucketPaddedBatchDatasetOp::kNumBuckets};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          AdaptiveBucketPaddedBatchDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int j = 0; j < padded_values_.size(); ++j) {
+      input_names->emplace_back(strings::StrCat(
+          AdaptiveBucketPaddedBatchDatasetOp::kPaddingValues, "_", j));
+    }
+    input_names->push_back(AdaptiveBucketPaddedBatchDatasetOp::kDropRemainder);
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {AdaptiveBucketPaddedBatchDatasetOp::kToutputTypes, output_dtypes_},
+        {AdaptiveBucketPaddedBatchDatasetOp::kOutputShapes, output_shapes_},
+        {AdaptiveBucketPaddedBatchDatasetOp::kNumPaddedShapes,
+         static_cast<int64_t>(padded_shapes_.size())},
+        {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return AdaptiveBucketPaddedBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t batch_size_;
+  int64_t num_buckets_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padded_values_;
+  bool drop_remainder_;
+};
+
+// Concatenates two datasets of vectors of int64.
+template <typename T>
+ConcatenateDatasetParams Concatenate(T input_dataset_params_0,
+                                     T input_dataset_params_1,
+                                     string node_name) {
+  return ConcatenateDatasetParams(
+      std::move(input_dataset_params_0), std::move(input_dataset_params_1),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})}, std::move(node_name));
+}
+
+// A dataset of the single element `values`.
+TensorSliceDatasetParams Element(const std::vector<int64_t>& values,
+                                 string node_name) {
+  return TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(
+          TensorShape{1, static_cast<int64_t>(values.size())}, values)},
+      std::move(node_name));
+}
+
+// Eight elements alternating between the lengths 1 and 3:
+// [1], [10, 11, 12], [2], [13, 14, 15], [3], [16, 17, 18], [4], [19, 20, 21].
+//
+// With batches of 2 in 2 buckets, the boundaries are learned from the first 4
+// elements: until then, all the elements go to the first bucket. Afterwards,
+// the short elements go to the first bucket and the long ones to the second.
+AdaptiveBucketPaddedBatchDatasetParams AlternatingLengthsParams(
+    bool drop_remainder) {
+  auto input = Concatenate(
+      Concatenate(Concatenate(Element({1}, "e0"), Element({10, 11, 12}, "e1"),
+                              "concatenate_01"),
+                  Concatenate(Element({2}, "e2"), Element({13, 14, 15}, "e3"),
+                              "concatenate_23"),
+                  "concatenate_0123"),
+      Concatenate(Concatenate(Element({3}, "e4"), Element({16, 17, 18}, "e5"),
+                              "concatenate_45"),
+                  Concatenate(Element({4}, "e6"), Element({19, 20, 21}, "e7"),
+                              "concatenate_67"),
+                  "concatenate_4567"),
+      "concatenate");
+  return AdaptiveBucketPaddedBatchDatasetParams(
+      /*input_dataset_params=*/std::move(input),
+      /*batch_size=*/2,
+      /*num_buckets=*/2,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*drop_remainder=*/drop_remainder,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({drop_remainder ? 2 : -1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Empty input.
+AdaptiveBucketPaddedBatchDatasetParams EmptyInputParams() {
+  return AdaptiveBucketPaddedBatchDatasetParams(
+      /*input_dataset_params=*/RangeDatasetParams(0, 0, 1),
+      /*batch_size=*/2,
+      /*num_buckets=*/2,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*drop_remainder=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Scalar input elements, which have no length.
+AdaptiveBucketPaddedBatchDatasetParams ScalarInputParams() {
+  return AdaptiveBucketPaddedBatchDatasetParams(
+      /*input_dataset_params=*/RangeDatasetParams(0, 3, 1),
+      /*batch_size=*/2,
+      /*num_buckets=*/2,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*drop_remainder=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// The batches of AlternatingLengthsParams(), of which only the first three are
+// full.
+std::vector<Tensor> AlternatingLengthsBatches(bool drop_remainder) {
+  std::vector<Tensor> batches = {
+      CreateTensor<int64_t>(TensorShape{2, 3}, {1, 0, 0, 10, 11, 12}),
+      CreateTensor<int64_t>(TensorShape{2, 1}, {2, 3}),
+      CreateTensor<int64_t>(TensorShape{2, 3}, {13, 14, 15, 16, 17, 18})};
+  if (!drop_remainder) {
+    batches.push_back(CreateTensor<int64_t>(TensorShape{1, 1}, {4}));
+    batches.push_back(CreateTensor<int64_t>(TensorShape{1, 3}, {19, 20, 21}));
+  }
+  return batches;
+}
+
+std::vector<GetNextTestCase<AdaptiveBucketPaddedBatchDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/AlternatingLengthsParams(
+               /*drop_remainder=*/false),
+           /*expected_outputs=*/
+           AlternatingLengthsBatches(/*drop_remainder=*/false)},
+          {/*dataset_params=*/AlternatingLengthsParams(
+               /*drop_remainder=*/true),
+           /*expected_outputs=*/
+           AlternatingLengthsBatches(/*drop_remainder=*/true)},
+          {/*dataset_params=*/EmptyInputParams(),
+           /*expected_outputs=*/{}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(AdaptiveBucketPaddedBatchDatasetOpTest,
+                         AdaptiveBucketPaddedBatchDatasetParams,
+                         GetNextTestCases())
+
+std::vector<
+    IteratorSaveAndRestoreTestCase<AdaptiveBucketPaddedBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  // The breakpoints save the buckets while they hold elements, and the
+  // learned boundaries, before and after the input is exhausted.
+  return {{/*dataset_params=*/AlternatingLengthsParams(
+               /*drop_remainder=*/false),
+           /*breakpoints=*/{0, 1, 2, 4, 6},
+           /*expected_outputs=*/
+           AlternatingLengthsBatches(/*drop_remainder=*/false)},
+          {/*dataset_params=*/AlternatingLengthsParams(
+               /*drop_remainder=*/true),
+           /*breakpoints=*/{0, 1, 2, 4},
+           /*expected_outputs=*/
+           AlternatingLengthsBatches(/*drop_remainder=*/true)},
+          {/*dataset_params=*/EmptyInputParams(),
+           /*breakpoints=*/{0, 2},
+           /*expected_outputs=*/{}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(AdaptiveBucketPaddedBatchDatasetOpTest,
+                                 AdaptiveBucketPaddedBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(AdaptiveBucketPaddedBatchDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = AlternatingLengthsParams(/*drop_remainder=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(AdaptiveBucketPaddedBatchDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = AlternatingLengthsParams(/*drop_remainder=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({2, -1})}));
+}
+
+TEST_F(AdaptiveBucketPaddedBatchDatasetOpTest, ScalarElements) {
+  auto dataset_params = ScalarInputParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ComputeBucketBoundariesTest, SingleBucket) {
+  EXPECT_THAT(ComputeBucketBoundaries({{10, 100}, {100, 100}}, 1), IsEmpty());
+}
+
+TEST(ComputeBucketBoundariesTest, SingleLength) {
+  EXPECT_THAT(ComputeBucketBoundaries({{10, 100}}, 4), IsEmpty());
+}
+
+TEST(ComputeBucketBoundariesTest, SplitsBimodalLengths) {
+  EXPECT_THAT(ComputeBucketBoundaries(
+                  {{8, 50}, {10, 100}, {90, 20}, {100, 100}}, 2),
+              ElementsAre(10));
+}
+
+TEST(ComputeBucketBoundariesTest, SeparatesEveryLength) {
+  EXPECT_THAT(
+      ComputeBucketBoundaries({{1, 10}, {2, 10}, {3, 10}, {4, 10}}, 4),
+      ElementsAre(1, 2, 3));
+}
+
+TEST(ComputeBucketBoundariesTest, PrefersFewerBuckets) {
+  EXPECT_THAT(ComputeBucketBoundaries({{1, 10}, {2, 10}}, 3), ElementsAre(1));
+}
+
+TEST(ComputeBucketBoundariesTest, RequiresMinimumShareOfElements) {
+  // A bucket of the single short element would fill up far too slowly.
+  EXPECT_THAT(ComputeBucketBoundaries({{1, 1}, {100, 1000}}, 2), IsEmpty());
+}
+
+TEST(ComputeBucketBoundariesTest, ManyLengths) {
+  std::map<int64_t, int64_t> histogram;
+  for (int64_t length = 1; length <= 10000; ++length) {
+    histogram[length] = 1 + length % 7;
+  }
+  std::vector<int64_t> boundaries = ComputeBucketBoundaries(histogram, 8);
+  EXPECT_THAT(boundaries, SizeIs(7));
+  for (int i = 1; i < boundaries.size(); ++i) {
+    EXPECT_LT(boundaries[i - 1], boundaries[i]);
+  }
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <deque>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -650,13 +651,22 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
                           std::vector<Tensor>* output) {
         thread::ThreadPool* device_threadpool =
             ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        // Parses the serialized examples in place if there is a single input
+        // tensor, and through views of them otherwise.
+        absl::Span<const tstring> serialized;
         std::vector<tstring> slice_vec;
-        for (const Tensor& t : input) {
-          auto serialized_t = t.flat<tstring>();
-          absl::Span<const tstring> slice(serialized_t.data(),
-                                          serialized_t.size());
-          for (auto it = slice.begin(); it != slice.end(); it++)
-            slice_vec.push_back(*it);
+        if (input.size() == 1) {
+          auto serialized_t = input[0].flat<tstring>();
+          serialized = absl::Span<const tstring>(serialized_t.data(),
+                                                 serialized_t.size());
+        } else {
+          for (const Tensor& t : input) {
+            auto serialized_t = t.flat<tstring>();
+            for (int64_t i = 0; i < serialized_t.size(); ++i) {
+              slice_vec.emplace_back().assign_as_view(serialized_t(i));
+            }
+          }
+          serialized = slice_vec;
         }
         example::FastParseExampleConfig config = dataset()->config_;
         // local copy of config_ for modification.
@@ -664,9 +674,19 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         if (stats_aggregator) {
           config.collect_feature_stats = true;
         }
+        {
+          mutex_lock l(size_hints_mu_);
+          for (int d = 0; d < sparse_size_hints_.size(); ++d) {
+            config.sparse[d].values_per_example_hint = sparse_size_hints_[d];
+          }
+          for (int d = 0; d < ragged_size_hints_.size(); ++d) {
+            config.ragged[d].values_per_example_hint = ragged_size_hints_[d];
+          }
+        }
         example::Result example_result;
         TF_RETURN_IF_ERROR(FastParseExample(
-            config, slice_vec, {}, device_threadpool, &example_result));
+            config, serialized, {}, device_threadpool, &example_result));
+        UpdateSizeHints(serialized.size(), example_result);
         (*output).resize(dataset()->key_to_output_index_.size());
         for (int d = 0; d < dataset()->dense_keys_.size(); ++d) {
           int output_index =
@@ -725,6 +745,31 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         return absl::OkStatus();
       }
 
+      // Updates the running estimates of the number of values per example of
+      // the sparse and ragged features with the parsed "result" of
+      // "num_examples" examples.
+      void UpdateSizeHints(size_t num_examples, const example::Result& result)
+          TF_LOCKS_EXCLUDED(size_hints_mu_) {
+        if (num_examples == 0) return;
+        // Weighs recent batches more; the estimate only needs to be close.
+        constexpr float kDecay = 0.8;
+        auto update = [num_examples](const Tensor& values, float* hint) {
+          const float observed =
+              static_cast<float>(values.NumElements()) / num_examples;
+          *hint = *hint == 0 ? observed
+                             : kDecay * *hint + (1 - kDecay) * observed;
+        };
+        mutex_lock l(size_hints_mu_);
+        sparse_size_hints_.resize(result.sparse_values.size());
+        for (int d = 0; d < result.sparse_values.size(); ++d) {
+          update(result.sparse_values[d], &sparse_size_hints_[d]);
+        }
+        ragged_size_hints_.resize(result.ragged_values.size());
+        for (int d = 0; d < result.ragged_values.size(); ++d) {
+          update(result.ragged_values[d], &ragged_size_hints_[d]);
+        }
+      }
+
       Status ProcessResult(IteratorContext* ctx,
                            const std::shared_ptr<InvocationResult>& result,
                            std::vector<Tensor>* out_tensors,
@@ -914,6 +959,12 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
 
       // Method for deregistering the cancellation callback.
       std::function<void()> deregister_fn_;
+
+      // Running estimates of the number of values per example of each sparse
+      // and ragged feature, which size the buffers of the next batches.
+      mutex size_hints_mu_;
+      std::vector<float> sparse_size_hints_ TF_GUARDED_BY(size_hints_mu_);
+      std::vector<float> ragged_size_hints_ TF_GUARDED_BY(size_hints_mu_);
     };
 
     const DatasetBase* const input_;
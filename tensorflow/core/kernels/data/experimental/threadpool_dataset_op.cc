@@ -132,8 +132,9 @@ class ThreadPoolHandleOp : public OpKernel {
                               [this, ctx](ThreadPoolResource** ret)
                                   TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
                                     *ret = new ThreadPoolResource(
-                                        ctx->env(), {}, display_name_,
-                                        num_threads_,
+                                        ctx->env(),
+                                        GetPipelineThreadOptions(ctx->device()),
+                                        display_name_, num_threads_,
                                         /*low_latency_hint=*/false,
                                         max_intra_op_parallelism_);
                                     return absl::OkStatus();
@@ -445,7 +446,8 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
             {{"num_threads",
               strings::Printf("%lld", static_cast<long long>(num_threads_))}}) {
     thread_pool_ = std::make_unique<thread::ThreadPool>(
-        ctx->env(), ThreadOptions{}, "data_private_threadpool", num_threads_);
+        ctx->env(), GetPipelineThreadOptions(ctx->device()),
+        "data_private_threadpool", num_threads_);
     input_->Ref();
   }
 
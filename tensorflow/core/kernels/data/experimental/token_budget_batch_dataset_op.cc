@@ -0,0 +1,790 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/token_budget_batch_dataset_op.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kTokenBudget;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kNumParallelCalls;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kNumPaddedShapes;
+/* static */ constexpr const char* const
+    TokenBudgetBatchDatasetOp::kDeterministic;
+
+namespace {
+
+constexpr char kBatchResultsSize[] = "batch_results_size";
+constexpr char kTFDataTokenBudgetBatch[] = "tf_data_token_budget_batch";
+constexpr char kBatchResults[] = "batch_results";
+constexpr char kEndOfInput[] = "end_of_input";
+constexpr char kNumElements[] = "num_elements";
+constexpr char kCallFinished[] = "call_finished";
+constexpr char kOutputAllocated[] = "output_allocated";
+constexpr char kStatus[] = "status";
+constexpr char kInputExhausted[] = "input_exhausted";
+constexpr char kPendingElement[] = "pending_element";
+
+// Returns the number of tokens of `element`, which is the size of the first
+// dimension of its first component.
+Status GetNumTokens(const std::vector<Tensor>& element, int64_t* num_tokens) {
+  if (element.empty() || element[0].dims() == 0) {
+    return errors::InvalidArgument(
+        "TokenBudgetBatchDataset requires the first component of its input "
+        "elements to have rank of at least 1.");
+  }
+  *num_tokens = element[0].dim_size(0);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+class TokenBudgetBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, int64_t token_budget,
+          int64_t num_parallel_calls, bool drop_remainder,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, const DatasetBase* input,
+          DeterminismPolicy deterministic)
+      : DatasetBase(DatasetContext(ctx)),
+        token_budget_(token_budget),
+        num_parallel_calls_(num_parallel_calls),
+        drop_remainder_(drop_remainder),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        input_(input),
+        deterministic_(deterministic),
+        traceme_metadata_(
+            {{"autotune",
+              num_parallel_calls == model::kAutotune ? "true" : "false"},
+             {"token_budget",
+              strings::Printf("%lld", static_cast<long long>(token_budget))},
+             {"drop_remainder", drop_remainder ? "true" : "false"}}) {
+    input_->Ref();
+    // The number of elements of a batch depends on their lengths.
+    output_shapes_.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      output_shapes_.push_back(
+          PartialTensorShape({-1}).Concatenate(padded_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(token_budget_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality || n == 0) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    // Input: input_dataset
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+
+    // Input: token_budget
+    Node* token_budget = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(token_budget_, &token_budget));
+
+    // Input: num_parallel_calls
+    Node* num_parallel_calls = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_parallel_calls_, &num_parallel_calls));
+
+    // Input: padded_shapes
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+      for (int j = 0; j < padded_shape.dims(); ++j) {
+        t.vec<int64_t>()(j) = padded_shape.dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    // Input: padding_values
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    // Input: drop_remainder
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+    AttrValue deterministic_attr;
+    b->BuildAttrValue(deterministic_.String(), &deterministic_attr);
+
+    return b->AddDataset(this,
+                         {{0, input_graph_node},
+                          {1, token_budget},
+                          {2, num_parallel_calls},
+                          {5, drop_remainder}},
+                         {{3, padded_shapes}, {4, padding_values}},
+                         {{kToutputTypes, output_types},
+                          {kNumPaddedShapes, N},
+                          {kDeterministic, deterministic_attr}},
+                         output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          mu_(std::make_shared<mutex>()),
+          cond_var_(std::make_shared<condition_variable>()),
+          num_parallel_calls_(std::make_shared<model::SharedState>(
+              params.dataset->num_parallel_calls_, mu_, cond_var_)),
+          deterministic_(params.dataset->deterministic_.IsDeterministic() ||
+                         params.dataset->deterministic_.IsDefault()) {}
+
+    ~Iterator() override {
+      CancelThreads(/*wait=*/true);
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(*mu_);
+      if (num_parallel_calls_->value == model::kAutotune) {
+        num_parallel_calls_->value = GetAutotuneDefaultParallelism(ctx);
+      }
+      cancellation_manager_ = std::make_unique<CancellationManager>();
+      TF_RETURN_IF_ERROR(RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() { CancelThreads(/*wait=*/false); }, &deregister_fn_));
+      IteratorContext::Params params(ctx);
+      params.cancellation_manager = cancellation_manager_.get();
+      IteratorContext iter_ctx(std::move(params));
+      return dataset()->input_->MakeIterator(&iter_ctx, this, prefix(),
+                                             &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::shared_ptr<BatchResult> result;
+      {
+        mutex_lock l(*mu_);
+        EnsureThreadsStarted(ctx);
+        while (ShouldWait(&result)) {
+          RecordStop(ctx);
+          cond_var_->wait(l);
+          RecordStart(ctx);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+      }
+
+      tsl::profiler::TraceMe traceme([&] {
+        return tsl::profiler::TraceMeEncode("TokenBudgetBatchConsume",
+                                            {{"element_id", result->uid}});
+      });
+      mutex_lock l(result->mu);
+      // Deallocate tensors allocated for the output.
+      auto cleanup =
+          gtl::MakeCleanup([result]() TF_EXCLUSIVE_LOCKS_REQUIRED(
+                               &BatchResult::mu) { result->output.clear(); });
+      if (result->output_allocated) {
+        RecordBufferDequeue(ctx, result->output);
+      }
+      // The batch has exactly `num_elements` rows, so it is never partial.
+      TF_RETURN_IF_ERROR(ProcessBatch(
+          result->num_elements, result->num_elements,
+          /*drop_remainder=*/false, result->status, ctx, out_tensors,
+          end_of_sequence, &result->output));
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeAsyncUnknownRatioNode(
+          std::move(args),
+          {model::MakeParameter("parallelism", num_parallel_calls_, /*min=*/1,
+                                /*max=*/ctx->runner_threadpool_size())});
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(*mu_);
+      // Wait for all in-flight calls to complete.
+      while (num_calls_ > 0) {
+        cond_var_->wait(l);
+      }
+      DCHECK_EQ(num_calls_, 0);
+      if (!input_impl_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kInputExhausted, ""));
+      } else {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), strings::StrCat(kPendingElement, "_size"),
+          pending_element_.size()));
+      for (size_t i = 0; i < pending_element_.size(); ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteTensor(
+            prefix(), strings::StrCat(kPendingElement, "[", i, "]"),
+            pending_element_[i]));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kBatchResultsSize,
+                                             batch_results_.size()));
+      for (size_t i = 0; i < batch_results_.size(); ++i) {
+        TF_RETURN_IF_ERROR(WriteBatchResult(writer, i));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(*mu_);
+      DCHECK(!runner_thread_);
+      if (reader->Contains(prefix(), kInputExhausted)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      int64_t pending_element_size;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(
+          prefix(), strings::StrCat(kPendingElement, "_size"),
+          &pending_element_size));
+      pending_element_.resize(pending_element_size);
+      for (int64_t i = 0; i < pending_element_size; ++i) {
+        TF_RETURN_IF_ERROR(reader->ReadTensor(
+            ctx->flr(), prefix(), strings::StrCat(kPendingElement, "[", i, "]"),
+            &pending_element_[i]));
+      }
+      int64_t batch_results_size;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kBatchResultsSize, &batch_results_size));
+      DCHECK(batch_results_.empty());
+      for (int i = 0; i < batch_results_size; ++i) {
+        TF_RETURN_IF_ERROR(ReadBatchResult(ctx, reader, i));
+      }
+      return absl::OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      int64_t parallelism = -1;
+      // NOTE: We only set the parallelism value if the lock can be acquired
+      // right away to avoid introducing tracing overhead.
+      if (mu_->try_lock()) {
+        parallelism = num_parallel_calls_->value;
+        mu_->unlock();
+      }
+      auto result = dataset()->traceme_metadata_;
+      result.push_back(
+          std::make_pair("deterministic", deterministic_ ? "true" : "false"));
+      result.push_back(std::make_pair(
+          "parallelism",
+          parallelism == -1
+              ? kTraceInfoUnavailable
+              : strings::Printf("%lld", static_cast<long long>(parallelism))));
+      return result;
+    }
+
+   private:
+    // BatchResult encapsulates the output batch.
+    struct BatchResult {
+      BatchResult()
+          : end_of_input(false),
+            num_elements(0),
+            status(absl::OkStatus()),
+            call_finished(false),
+            output_allocated(false),
+            uid(tensorflow::EnvTime::NowNanos()) {}
+
+      mutex mu;
+      bool end_of_input TF_GUARDED_BY(mu);
+      int64_t num_elements TF_GUARDED_BY(mu);
+      std::vector<Tensor> output TF_GUARDED_BY(mu);
+      Status status TF_GUARDED_BY(mu);
+      bool call_finished TF_GUARDED_BY(&Iterator::mu_);
+      bool output_allocated TF_GUARDED_BY(mu);
+      const int64_t uid = -1;
+    };
+
+    void CallCompleted(const std::shared_ptr<BatchResult>& result)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      mutex_lock l(*mu_);
+      num_calls_--;
+      result->call_finished = true;
+      cond_var_->notify_all();
+    }
+
+    // Fetches elements from the input sequentially until their tokens exceed
+    // the budget, and then pads and copies the batch using the context runner,
+    // so that different batches are assembled in parallel. The element that
+    // exceeds the budget starts the next batch. An element that exceeds the
+    // budget on its own forms a batch by itself.
+    void CallBatching(std::shared_ptr<IteratorContext> ctx,
+                      const std::shared_ptr<BatchResult>& result)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      tsl::profiler::TraceMe traceme([&] {
+        return tsl::profiler::TraceMeEncode("TokenBudgetBatchProduce",
+                                            {{"element_id", result->uid}});
+      });
+
+      std::vector<std::vector<Tensor>> batch_elements;
+      int64_t num_tokens = 0;
+      bool end_of_input = !input_impl_;
+      while (!end_of_input) {
+        std::vector<Tensor> element;
+        if (!pending_element_.empty()) {
+          element = std::move(pending_element_);
+          pending_element_.clear();
+        } else {
+          Status status =
+              input_impl_->GetNext(ctx.get(), &element, &end_of_input);
+          if (!status.ok()) {
+            mutex_lock l(result->mu);
+            result->status.Update(status);
+            break;
+          }
+          if (end_of_input) {
+            input_impl_.reset();
+            break;
+          }
+        }
+        int64_t element_tokens;
+        Status status = GetNumTokens(element, &element_tokens);
+        if (!status.ok()) {
+          mutex_lock l(result->mu);
+          result->status.Update(status);
+          break;
+        }
+        if (!batch_elements.empty() &&
+            num_tokens + element_tokens > dataset()->token_budget_) {
+          pending_element_ = std::move(element);
+          break;
+        }
+        num_tokens += element_tokens;
+        batch_elements.push_back(std::move(element));
+      }
+      {
+        mutex_lock l(result->mu);
+        result->end_of_input = end_of_input;
+        // The batch cut short by the end of the input is the remainder.
+        if (end_of_input && dataset()->drop_remainder_) {
+          batch_elements.clear();
+        }
+        result->num_elements = batch_elements.size();
+      }
+
+      if (batch_elements.empty()) {
+        CallCompleted(result);
+        return;
+      }
+
+      auto copy_elements_fn = [this, ctx, result,
+                               batch_elements =
+                                   std::move(batch_elements)]() mutable {
+        Status status;
+        {
+          mutex_lock l(result->mu);
+          status = CopyPaddedBatch(ctx.get(), batch_elements,
+                                   dataset()->padded_shapes_,
+                                   dataset()->padding_values_,
+                                   /*parallel_copy=*/false, &result->output);
+          result->status.Update(status);
+
+          if (result->status.ok()) {
+            result->output_allocated = true;
+            RecordBufferEnqueue(ctx.get(), result->output);
+          } else {
+            result->output.clear();
+            result->output_allocated = false;
+          }
+        }
+        CallCompleted(result);
+        return status;
+      };
+
+      (*ctx->runner())(std::move(copy_elements_fn));
+    }
+
+    void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
+      cancellation_manager_->StartCancel();
+      mutex_lock l(*mu_);
+      cancelled_ = true;
+      cond_var_->notify_all();
+      // Wait for all in-flight calls to complete.
+      while (wait && num_calls_ > 0) {
+        cond_var_->wait(l);
+      }
+    }
+
+    void EnsureThreadsStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (!runner_thread_) {
+        auto new_ctx = std::make_shared<IteratorContext>(*ctx);
+        runner_thread_ =
+            ctx->StartThread(kTFDataTokenBudgetBatch,
+                             std::bind(&Iterator::RunnerThread, this, new_ctx));
+      }
+    }
+
+    void RunnerThread(const std::shared_ptr<IteratorContext>& ctx)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      std::vector<std::shared_ptr<BatchResult>> new_calls;
+      RecordStart(ctx.get());
+      auto stop_cleanup =
+          gtl::MakeCleanup([this, &ctx]() { RecordStop(ctx.get()); });
+      {
+        tf_shared_lock l(*mu_);  // mu_ == num_parallel_calls_->mu
+        new_calls.reserve(num_parallel_calls_->value);
+      }
+      auto busy = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
+        int64_t num_parallel_calls = num_parallel_calls_->value;
+        return num_calls_ >= num_parallel_calls ||
+               batch_results_.size() >= num_parallel_calls;
+      };
+      while (true) {
+        {
+          mutex_lock l(*mu_);
+          while (!cancelled_ && busy()) {
+            RecordStop(ctx.get());
+            cond_var_->wait(l);
+            RecordStart(ctx.get());
+          }
+
+          if (cancelled_) {
+            return;
+          }
+
+          while (!busy()) {
+            batch_results_.push_back(std::make_shared<BatchResult>());
+            new_calls.emplace_back(batch_results_.back());
+            num_calls_++;
+          }
+        }
+        for (const auto& call : new_calls) {
+          CallBatching(ctx, call);
+        }
+        new_calls.clear();
+      }
+    }
+
+    // Determines whether the caller needs to wait for a result. Upon returning
+    // false, `result` will point to the result.
+    bool ShouldWait(std::shared_ptr<BatchResult>* result)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (cancelled_) {
+        return false;
+      }
+      if (!deterministic_) {
+        // Return the first finished result that is not end-of-input. An
+        // end-of-input result is only returned once it is at the front, that
+        // is, once all earlier batches have been returned.
+        for (auto it = batch_results_.begin(); it != batch_results_.end();
+             ++it) {
+          if (!(*it)->call_finished) continue;
+          bool find_batch = (it == batch_results_.begin());
+          if (!find_batch) {
+            tf_shared_lock l((*it)->mu);
+            find_batch = !(*it)->end_of_input;
+          }
+          if (find_batch) {
+            std::swap(*result, *it);
+            batch_results_.erase(it);
+            cond_var_->notify_all();
+            return false;
+          }
+        }
+      } else if (!batch_results_.empty() &&
+                 batch_results_.front()->call_finished) {
+        std::swap(*result, batch_results_.front());
+        batch_results_.pop_front();
+        cond_var_->notify_all();
+        return false;
+      }
+      return true;
+    }
+
+    Status ReadBatchResult(IteratorContext* ctx, IteratorStateReader* reader,
+                           size_t index) TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      batch_results_.push_back(std::make_shared<BatchResult>());
+      std::shared_ptr<BatchResult> result = batch_results_.back();
+      string batch_prefix = strings::StrCat(kBatchResults, "_", index);
+      mutex_lock l(result->mu);
+      result->end_of_input = reader->Contains(
+          prefix(), strings::StrCat(batch_prefix, "_", kEndOfInput));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(
+          prefix(), strings::StrCat(batch_prefix, "_", kNumElements),
+          &result->num_elements));
+      result->call_finished = reader->Contains(
+          prefix(), strings::StrCat(batch_prefix, "_", kCallFinished));
+      result->output_allocated = reader->Contains(
+          prefix(), strings::StrCat(batch_prefix, "_", kOutputAllocated));
+
+      TF_RETURN_IF_ERROR(ReadBatch(ctx, reader, result->num_elements, prefix(),
+                                   batch_prefix, &result->output));
+      TF_RETURN_IF_ERROR(ReadStatus(prefix(),
+                                    strings::StrCat(batch_prefix, "_", kStatus),
+                                    reader, &result->status));
+      if (result->output_allocated) {
+        RecordBufferEnqueue(ctx, result->output);
+      }
+      return absl::OkStatus();
+    }
+
+    Status WriteBatchResult(IteratorStateWriter* writer, size_t index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      std::shared_ptr<BatchResult> result = batch_results_[index];
+      string batch_prefix = strings::StrCat(kBatchResults, "_", index);
+      mutex_lock l(result->mu);
+      if (result->end_of_input) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(batch_prefix, "_", kEndOfInput), ""));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), strings::StrCat(batch_prefix, "_", kNumElements),
+          result->num_elements));
+      if (result->call_finished) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(batch_prefix, "_", kCallFinished), ""));
+      }
+      if (result->output_allocated) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(batch_prefix, "_", kOutputAllocated),
+            ""));
+      }
+
+      TF_RETURN_IF_ERROR(WriteBatch(result->num_elements, result->num_elements,
+                                    prefix(), batch_prefix, writer,
+                                    &result->output));
+      TF_RETURN_IF_ERROR(
+          WriteStatus(prefix(), strings::StrCat(batch_prefix, "_", kStatus),
+                      result->status, writer));
+      return absl::OkStatus();
+    }
+
+    // Used for coordination between the main thread and the runner thread.
+    const std::shared_ptr<mutex> mu_;
+    // Used for coordination between the main thread and the runner thread. In
+    // particular, the runner thread should only schedule new calls when the
+    // number of in-flight calls is less than the user specified level of
+    // parallelism and there are slots available in the `batch_results_`
+    // buffer.
+    const std::shared_ptr<condition_variable> cond_var_;
+    // Identifies the maximum number of parallel calls.
+    const std::shared_ptr<model::SharedState> num_parallel_calls_;
+    const bool deterministic_;
+
+    // Controls cancellation of `input_impl_`. Must be ordered before
+    // `input_impl_` so that `input_impl_` is destroyed first.
+    std::unique_ptr<CancellationManager> cancellation_manager_;
+    // Counts the number of outstanding calls for this batch.
+    int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
+    // `input_impl_` and `pending_element_` are only accessed by the runner
+    // thread, or while no calls are outstanding.
+    std::unique_ptr<IteratorBase> input_impl_;
+    // The element that did not fit into the budget of the previous batch.
+    std::vector<Tensor> pending_element_;
+    // Buffer for storing the (intermediate) batch results. Whenever a non-empty
+    // batch result is added to or removed from `batch_results_`, call
+    // `RecordBufferEnqueue` or `RecordBufferDequeue` respectively.
+    std::deque<std::shared_ptr<BatchResult>> batch_results_ TF_GUARDED_BY(*mu_);
+    // Determines whether the transformation has been cancelled.
+    bool cancelled_ TF_GUARDED_BY(*mu_) = false;
+
+    // Method for deregistering the cancellation callback.
+    std::function<void()> deregister_fn_;
+
+    // Background thread used for coordinating input processing.
+    std::unique_ptr<Thread> runner_thread_ TF_GUARDED_BY(*mu_);
+  };
+
+  const int64_t token_budget_;
+  const int64_t num_parallel_calls_;
+  const bool drop_remainder_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const DatasetBase* const input_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const DeterminismPolicy deterministic_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+TokenBudgetBatchDatasetOp::TokenBudgetBatchDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  std::string deterministic;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kDeterministic, &deterministic));
+  OP_REQUIRES_OK(ctx,
+                 DeterminismPolicy::FromString(deterministic, &deterministic_));
+}
+
+void TokenBudgetBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                            DatasetBase* input,
+                                            DatasetBase** output) {
+  int64_t token_budget = 0;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<int64_t>(ctx, kTokenBudget, &token_budget));
+  OP_REQUIRES(
+      ctx, token_budget > 0,
+      errors::InvalidArgument("Token budget must be greater than zero."));
+
+  int64_t num_parallel_calls = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kNumParallelCalls,
+                                                   &num_parallel_calls));
+  OP_REQUIRES(
+      ctx, num_parallel_calls > 0 || num_parallel_calls == model::kAutotune,
+      errors::InvalidArgument("num_parallel_calls must be greater than zero."));
+
+  bool drop_remainder = false;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == input->output_shapes().size(),
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      input->output_shapes().size(), ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(padded_shape_tensors.size());
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+  OP_REQUIRES(ctx, padded_shapes[0].dims() > 0,
+              errors::InvalidArgument(
+                  "The first component, whose first dimension is the number "
+                  "of tokens, must have rank of at least 1."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, token_budget, num_parallel_calls, drop_remainder,
+                        std::move(padded_shapes), std::move(padding_values),
+                        input, deterministic_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("TokenBudgetBatchDataset").Device(DEVICE_CPU),
+                        TokenBudgetBatchDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,258 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/token_budget_batch_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "token_budget_batch_dataset";
+
+class TokenBudgetBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+class TokenBudgetBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  TokenBudgetBatchDatasetParams(T input_dataset_params, int64_t token_budget,
+                                int64_t num_parallel_calls,
+                                std::vector<Tensor> padded_shapes,
+                                std::vector<Tensor> padded_values,
+                                bool drop_remainder, std::string deterministic,
+                                DataTypeVector output_dtypes,
+                                std::vector<PartialTensorShape> output_shapes,
+                                string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        token_budget_(token_budget),
+        num_parallel_calls_(num_parallel_calls),
+        padded_shapes_(std::move(padded_shapes)),
+        padded_values_(std::move(padded_values)),
+        drop_remainder_(drop_remainder),
+        deterministic_(std::move(deterministic)) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors;
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {token_budget_}));
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {num_parallel_calls_}));
+    for (auto& padded_shape : padded_shapes_) {
+      input_tensors.emplace_back(padded_shape);
+    }
+    for (auto& padded_value : padded_values_) {
+      input_tensors.emplace_back(padded_value);
+    }
+    input_tensors.emplace_back(
+        CreateTensor<bool>(TensorShape({}), {drop_remainder_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {TokenBudgetBatchDatasetOp::kInputDataset,
+                    TokenBudgetBatchDatasetOp::kTokenBudget,
+                    TokenBudgetBatchDatasetOp::kNumParallelCalls};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(
+          strings::StrCat(TokenBudgetBatchDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int j = 0; j < padded_values_.size(); ++j) {
+      input_names->emplace_back(
+          strings::StrCat(TokenBudgetBatchDatasetOp::kPaddingValues, "_", j));
+    }
+    input_names->push_back(TokenBudgetBatchDatasetOp::kDropRemainder);
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {"Toutput_types", output_dtypes_},
+        {"output_shapes", output_shapes_},
+        {"N", static_cast<int64_t>(padded_shapes_.size())},
+        {"deterministic", deterministic_},
+        {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return TokenBudgetBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t token_budget_;
+  int64_t num_parallel_calls_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padded_values_;
+  bool drop_remainder_;
+  std::string deterministic_;
+};
+
+// Returns the elements [0, 1, 2], [3, 4, 5], [6], [7], [8], whose numbers of
+// tokens are 3, 3, 1, 1, 1.
+ConcatenateDatasetParams VariableLengthDatasetParams() {
+  auto tensor_slice_dataset_params_0 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{2, 3},
+                                            {{0, 1, 2, 3, 4, 5}}),
+      /*node_name=*/"tensor_slice_0");
+  auto tensor_slice_dataset_params_1 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{3, 1}, {{6, 7, 8}}),
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(std::move(tensor_slice_dataset_params_0),
+                                  std::move(tensor_slice_dataset_params_1),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+TokenBudgetBatchDatasetParams TokenBudgetBatchDatasetParams1() {
+  return TokenBudgetBatchDatasetParams(
+      /*input_dataset_params=*/VariableLengthDatasetParams(),
+      /*token_budget=*/4,
+      /*num_parallel_calls=*/2,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*drop_remainder=*/false,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Similar to the above, but drops the last batch, which is cut short by the
+// end of the input.
+TokenBudgetBatchDatasetParams TokenBudgetBatchDatasetParams2() {
+  return TokenBudgetBatchDatasetParams(
+      /*input_dataset_params=*/VariableLengthDatasetParams(),
+      /*token_budget=*/4,
+      /*num_parallel_calls=*/2,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*drop_remainder=*/true,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// The budget is smaller than every element, so each element forms a batch.
+TokenBudgetBatchDatasetParams TokenBudgetBatchDatasetParams3() {
+  return TokenBudgetBatchDatasetParams(
+      /*input_dataset_params=*/VariableLengthDatasetParams(),
+      /*token_budget=*/1,
+      /*num_parallel_calls=*/1,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {3})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, 3})},
+      /*node_name=*/kNodeName);
+}
+
+TokenBudgetBatchDatasetParams InvalidTokenBudgetDatasetParams() {
+  return TokenBudgetBatchDatasetParams(
+      /*input_dataset_params=*/VariableLengthDatasetParams(),
+      /*token_budget=*/0,
+      /*num_parallel_calls=*/1,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*drop_remainder=*/false,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<TokenBudgetBatchDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/TokenBudgetBatchDatasetParams1(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{1, 3}, {0, 1, 2}),
+            CreateTensor<int64_t>(TensorShape{2, 3}, {3, 4, 5, 6, 0, 0}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {7, 8})}},
+          {/*dataset_params=*/TokenBudgetBatchDatasetParams2(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{1, 3}, {0, 1, 2}),
+            CreateTensor<int64_t>(TensorShape{2, 3}, {3, 4, 5, 6, 0, 0})}},
+          {/*dataset_params=*/TokenBudgetBatchDatasetParams3(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{1, 3}, {0, 1, 2}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {3, 4, 5}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {6, -1, -1}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {7, -1, -1}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {8, -1, -1})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(TokenBudgetBatchDatasetOpTest,
+                         TokenBudgetBatchDatasetParams, GetNextTestCases())
+
+TEST_F(TokenBudgetBatchDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = TokenBudgetBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(TokenBudgetBatchDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = TokenBudgetBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(TokenBudgetBatchDatasetOp::kDatasetType)));
+}
+
+TEST_F(TokenBudgetBatchDatasetOpTest, DatasetCardinality) {
+  auto dataset_params = TokenBudgetBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<TokenBudgetBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/TokenBudgetBatchDatasetParams1(),
+           /*breakpoints=*/{0, 1, 2, 5},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{1, 3}, {0, 1, 2}),
+            CreateTensor<int64_t>(TensorShape{2, 3}, {3, 4, 5, 6, 0, 0}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {7, 8})}},
+          {/*dataset_params=*/TokenBudgetBatchDatasetParams3(),
+           /*breakpoints=*/{0, 2, 5},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{1, 3}, {0, 1, 2}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {3, 4, 5}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {6, -1, -1}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {7, -1, -1}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {8, -1, -1})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(TokenBudgetBatchDatasetOpTest,
+                                 TokenBudgetBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(TokenBudgetBatchDatasetOpTest, InvalidTokenBudget) {
+  auto dataset_params = InvalidTokenBudgetDatasetParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
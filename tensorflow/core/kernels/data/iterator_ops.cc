@@ -91,7 +91,8 @@ IteratorResource::IteratorResource(
     std::unique_ptr<ProcessFunctionLibraryRuntime> pflr,
     FunctionLibraryRuntime* flr)
     : metrics_collector_(flr->device()->device_type(), *env),
-      unbounded_thread_pool_(env, "tf_data_iterator_resource"),
+      unbounded_thread_pool_(env, "tf_data_iterator_resource",
+                             GetPipelineThreadOptions(flr->device())),
       env_(*env),
       device_mgr_(std::move(device_mgr)),
       iterator_state_(std::make_shared<State>(std::move(flib_def),
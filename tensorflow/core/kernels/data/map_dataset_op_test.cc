@@ -14,7 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/map_dataset_op.h"
 
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
@@ -105,6 +111,62 @@ std::vector<GetNextTestCase<MapDatasetParams>> GetNextTestCases() {
 
 ITERATOR_GET_NEXT_TEST_P(MapDatasetOpTest, MapDatasetParams, GetNextTestCases())
 
+FunctionDef XPlusOne() {
+  const Tensor kOne = test::AsScalar<int64_t>(1);
+  return FunctionDefHelper::Define(
+      // Name
+      "XPlusOne",
+      // Args
+      {"x: T"},
+      // Return values
+      {"y: T"},
+      // Attr def
+      {"T: {int64}"},
+      // Nodes
+      {{{"one"}, "Const", {}, {{"value", kOne}, {"dtype", DT_INT64}}},
+       {{"y"}, "Add", {"x", "one"}, {{"T", "$T"}}}});
+}
+
+// A stateless loop which increments its input forever.
+FunctionDef InfiniteLoop() {
+  return FunctionDefHelper::Define(
+      // Name
+      "InfiniteLoop",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: int64"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"y"},
+        "StatelessWhile",
+        {"x"},
+        {{"cond", FunctionDefHelper::FunctionRef("LessThanOrEqualToN",
+                                                 {{"T", DT_INT64}})},
+         {"body",
+          FunctionDefHelper::FunctionRef("XPlusOne", {{"T", DT_INT64}})},
+         {"T", DataTypeVector({DT_INT64})},
+         {"output_shapes", std::vector<TensorShape>({TensorShape()})}}}});
+}
+
+MapDatasetParams InfiniteLoopMapDatasetParams() {
+  return MapDatasetParams(
+      RangeDatasetParams(0, 10, 1),
+      /*other_arguments=*/{},
+      /*func=*/FunctionDefHelper::FunctionRef("InfiniteLoop", {}),
+      /*func_lib=*/
+      {InfiniteLoop(), XPlusOne(),
+       test::function::LessThanOrEqualToN(
+           std::numeric_limits<int64_t>::max())},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*use_inter_op_parallelism=*/true,
+      /*preserve_cardinality=*/true,
+      /*node_name=*/kNodeName);
+}
+
 TEST_F(MapDatasetOpTest, DatasetNodeName) {
   auto dataset_params = MapDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -161,6 +223,24 @@ TEST_F(MapDatasetOpTest, IteratorPrefix) {
       MapDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
 }
 
+// Tests that cancelling the iterator stops a stateless function which would
+// otherwise never return.
+TEST_F(MapDatasetOpTest, CancelStatelessLoop) {
+  auto dataset_params = InfiniteLoopMapDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  Status status;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "get_next", [this, &status]() {
+        std::vector<Tensor> out_tensors;
+        bool end_of_sequence = false;
+        status = iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence);
+      }));
+  cancellation_manager_->StartCancel();
+  thread.reset();
+  EXPECT_TRUE(errors::IsCancelled(status)) << status;
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<MapDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {{/*dataset_params=*/MapDatasetParams1(),
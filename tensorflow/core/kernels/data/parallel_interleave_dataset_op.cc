@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -123,6 +124,25 @@ constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
+// A cycle element is a straggler once it has produced at least
+// `kMinStragglerResults` results and its mean latency per result is more than
+// `kStragglerLatencyRatio` times the mean latency per result of all elements.
+constexpr int64_t kMinStragglerResults = 4;
+constexpr int64_t kStragglerLatencyRatio = 2;
+
+// A cycle element is also a straggler while its pending `GetNext` call has
+// taken at least `kMinStragglerMicros` and more than `kStragglerLatencyRatio`
+// times the mean latency per result of all elements.
+constexpr int64_t kMinStragglerMicros = 1000;
+
+// Period at which a consumer blocked in nondeterministic mode checks whether
+// stragglers stall the cycle.
+constexpr int kStragglerCheckPeriodMillis = 10;
+
+// Factor by which stragglers may exceed `buffer_output_elements` when the
+// iterator adapts to stragglers.
+constexpr int64_t kStragglerBufferFactor = 4;
+
 inline int64_t CeilDiv(int64_t numerator, int64_t denominator) {
   return (numerator + denominator - 1) / denominator;
 }
@@ -378,6 +398,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(*mu_);
       interleave_depth_ = ctx->interleave_depth();
+      adapt_to_stragglers_ =
+          ctx->options() != nullptr &&
+          ctx->options()->optional_interleave_adapt_to_stragglers_case() ==
+              Options::kInterleaveAdaptToStragglers &&
+          ctx->options()->interleave_adapt_to_stragglers();
+      if (adapt_to_stragglers_ && !deterministic_) {
+        // Up to `cycle_length_` extra elements may join the cycle while
+        // stragglers stall it.
+        current_elements_.resize(2 * dataset()->cycle_length_);
+      }
 
       // Note that if `ctx->thread_pool()` is non-null, then instead of creating
       // a dedicated thread pool of size `num_threads`, computation will be
@@ -385,9 +415,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // support `num_threads` concurrent tasks without blocking indefinitely.
       //
       // Allocate one thread for the worker manager, one thread for stats
-      // collection, `cycle_length_` threads for the current workers, and
-      // `future_elements_prefetch_` for the future workers.
-      int max_current_workers = dataset()->cycle_length_;
+      // collection, one thread per slot of `current_elements_` for the current
+      // workers, and `future_elements_prefetch_` for the future workers.
+      int max_current_workers = current_elements_.size();
       int future_workers =
           dataset()->prefetch_input_elements_ + dataset()->cycle_length_;
       int num_threads = 1 + max_current_workers + future_workers;
@@ -432,6 +462,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             VLOG(3) << "Blocked waiting for element "
                     << current_elements_[cycle_index_]->id;
             current_elements_[cycle_index_]->cond_var.wait(l);
+          } else if (HasFreeExtraSlot()) {
+            // Wakes up periodically so that `Consume` can notice stragglers
+            // whose pending `GetNext` calls stall the cycle.
+            any_element_available_cond_var_.wait_for(
+                l, std::chrono::milliseconds(kStragglerCheckPeriodMillis));
           } else {
             any_element_available_cond_var_.wait(l);
           }
@@ -668,6 +703,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // Whether we tried to initialize the element, but the input iterator
       // was exhausted so we could produce no inputs.
       bool no_input TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = false;
+      // Number of results produced by `iterator`, and the total time spent
+      // producing them. Used to detect stragglers.
+      int64_t num_results_produced
+          TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = 0;
+      int64_t produce_micros TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) =
+          0;
+      // Start time of the pending `GetNext` call on `iterator`, or 0 if there
+      // is none. Written by the thread processing the element without holding
+      // `mu_`.
+      std::atomic<int64_t> producing_since_micros{0};
       // Condition variable for communicating between current worker threads
       // and GetNext.
       condition_variable cond_var;
@@ -765,13 +810,112 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // If we are allowed to be nondeterministic (i.e. return results out of
       // order), try to find an element in the cycle that has a result
       // available.
-      for (int i = 0; i < dataset()->cycle_length_; ++i) {
+      for (int i = 0; i < current_elements_.size(); ++i) {
         if (ConsumeHelper(ctx, result)) {
           return true;
         }
         AdvanceToNextInCycle();
       }
-      return false;
+      // No element has a result available. If stragglers stall the cycle, read
+      // from an extra element meanwhile.
+      return AddExtraElement(ctx) && ConsumeHelper(ctx, result);
+    }
+
+    // Returns whether a slot for an extra element is free. Extra elements join
+    // the cycle after the first `cycle_length_` slots.
+    bool HasFreeExtraSlot() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return NumExtraElements() <
+             static_cast<int64_t>(current_elements_.size()) -
+                 dataset()->cycle_length_;
+    }
+
+    // Returns the number of extra elements in the cycle.
+    int64_t NumExtraElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t num_extra_elements = 0;
+      for (int64_t i = dataset()->cycle_length_; i < current_elements_.size();
+           ++i) {
+        if (current_elements_[i]) {
+          ++num_extra_elements;
+        }
+      }
+      return num_extra_elements;
+    }
+
+    // Adds an element to the cycle if there are more stragglers without
+    // results than extra elements. This adapts the cycle length to slow
+    // inputs, e.g. remote files with a high latency to the first byte. An
+    // extra element leaves the cycle once it is exhausted. Returns whether an
+    // element was added, in which case `cycle_index_` points to it.
+    bool AddExtraElement(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!HasFreeExtraSlot()) {
+        return false;
+      }
+      int64_t num_stragglers = 0;
+      for (int64_t i = 0; i < dataset()->cycle_length_; ++i) {
+        const std::shared_ptr<Element>& element = current_elements_[i];
+        if (element && element->results.empty() && IsStraggler(*element)) {
+          ++num_stragglers;
+        }
+      }
+      int64_t num_extra_elements = 0;
+      int64_t index = -1;
+      for (int64_t i = dataset()->cycle_length_; i < current_elements_.size();
+           ++i) {
+        if (current_elements_[i]) {
+          ++num_extra_elements;
+        } else if (index == -1) {
+          index = i;
+        }
+      }
+      if (index == -1 || num_extra_elements >= num_stragglers) {
+        return false;
+      }
+      std::shared_ptr<Element> element;
+      if (!future_elements_.empty()) {
+        element = std::move(future_elements_.front());
+        future_elements_.pop_front();
+        if (element->iterator) {
+          EnableAutotune(ctx, element->iterator.get());
+        }
+        future_workers_cond_var_.notify_one();
+      } else {
+        element = MakeElement(ctx);
+        if (!element) {
+          return false;
+        }
+      }
+      VLOG(2) << "Adding extra element " << element->id
+              << " to the cycle at index " << index << " for "
+              << num_stragglers << " stragglers";
+      element->cycle_index = index;
+      current_elements_[index] = element;
+      if (!element->active) {
+        elements_to_process_.push_back(index);
+        current_workers_cond_var_.notify_one();
+      }
+      // The worker manager starts a current worker for the extra element, so
+      // that the stragglers do not hold all current workers.
+      num_parallel_calls_cond_var_->notify_all();
+      last_valid_current_element_ =
+          std::max(last_valid_current_element_, index);
+      cycle_index_ = index;
+      block_index_ = 0;
+      return true;
+    }
+
+    // Moves `last_valid_current_element_` before the trailing empty slots of
+    // `current_elements_`.
+    void TrimCurrentElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (last_valid_current_element_ >= 0 &&
+             !current_elements_[last_valid_current_element_]) {
+        last_valid_current_element_--;
+        if (cycle_index_ > last_valid_current_element_) {
+          // We are about to move the cycle index below in
+          // AdvanceToNextInCycle().
+          cycle_index_ = last_valid_current_element_;
+        }
+      }
     }
 
     // Consumes a result (if available), returning an indication of whether
@@ -814,8 +958,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
-        // available.
-        if (!future_elements_.empty()) {
+        // available. Extra elements are not replaced, which shrinks the cycle
+        // back to `cycle_length_`.
+        if (cycle_index_ >= dataset()->cycle_length_) {
+          current_elements_[cycle_index_].reset();
+          TrimCurrentElements();
+        } else if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
@@ -836,15 +984,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             element->cycle_index = cycle_index_;
             current_workers_cond_var_.notify_one();
           }
-          while (last_valid_current_element_ >= 0 &&
-                 !current_elements_[last_valid_current_element_]) {
-            last_valid_current_element_--;
-            if (cycle_index_ > last_valid_current_element_) {
-              // We are about to move the cycle index below in
-              // AdvanceToNextInCycle().
-              cycle_index_ = last_valid_current_element_;
-            }
-          }
+          TrimCurrentElements();
         }
         if (last_valid_current_element_ != -1) {
           AdvanceToNextInCycle();
@@ -901,8 +1041,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       while (true) {
         {
           mutex_lock l(*mu_);
-          while (!cancelled_ &&
-                 num_current_workers_ >= num_parallel_calls_->value) {
+          while (!cancelled_ && num_current_workers_ >=
+                                    num_parallel_calls_->value +
+                                        NumExtraElements()) {
             RecordStop(ctx.get());
             num_parallel_calls_cond_var_->wait(l);
             RecordStart(ctx.get());
@@ -958,8 +1099,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         // Find an element to process.
         {
           mutex_lock l(*mu_);
-          // In case autotune changes num_parallel_calls.
-          if (num_current_workers_ > num_parallel_calls_->value) {
+          // In case autotune changes num_parallel_calls, or extra elements
+          // left the cycle.
+          if (num_current_workers_ >
+              num_parallel_calls_->value + NumExtraElements()) {
             done();
             return;
           }
@@ -1091,8 +1234,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         });
         bool end_of_input = false;
         IteratorContext nested_ctx = MakeNestedIteratorContext(ctx);
+        const int64_t start_micros = EnvTime::NowMicros();
+        element->producing_since_micros.store(start_micros,
+                                              std::memory_order_relaxed);
         result->status = iterator->GetNext(&nested_ctx, &result->return_values,
                                            &end_of_input);
+        element->producing_since_micros.store(0, std::memory_order_relaxed);
+        const int64_t elapsed_micros = EnvTime::NowMicros() - start_micros;
         result->checkpoint.Merge(nested_ctx.checkpoint());
         if (result->status.ok() && end_of_input) {
           mutex_lock l(*mu_);
@@ -1107,9 +1255,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         RecordBufferEnqueue(ctx, result->return_values);
         mutex_lock l(*mu_);
+        element->num_results_produced++;
+        element->produce_micros += elapsed_micros;
+        num_results_produced_++;
+        produce_micros_ += elapsed_micros;
         element->results.push_back(std::move(result));
         NotifyElementUpdate(*element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= MaxBufferedResults(*element)) {
           break;
         }
       }
@@ -1203,7 +1355,49 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < MaxBufferedResults(*element);
+    }
+
+    // Returns whether the results of `element` are produced much more slowly
+    // than those of the other elements, e.g. because it reads from a slow
+    // file.
+    bool IsStraggler(const Element& element) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (num_results_produced_ == 0) {
+        return false;
+      }
+      const int64_t producing_since_micros =
+          element.producing_since_micros.load(std::memory_order_relaxed);
+      if (producing_since_micros > 0) {
+        const int64_t pending_micros =
+            EnvTime::NowMicros() - producing_since_micros;
+        if (pending_micros >= kMinStragglerMicros &&
+            static_cast<double>(pending_micros) * num_results_produced_ >
+                static_cast<double>(kStragglerLatencyRatio) * produce_micros_) {
+          return true;
+        }
+      }
+      if (element.num_results_produced < kMinStragglerResults) {
+        return false;
+      }
+      // Compares the mean latencies without dividing, i.e.
+      // `element.produce_micros / element.num_results_produced >
+      // kStragglerLatencyRatio * produce_micros_ / num_results_produced_`.
+      return static_cast<double>(element.produce_micros) *
+                 num_results_produced_ >
+             static_cast<double>(kStragglerLatencyRatio) * produce_micros_ *
+                 element.num_results_produced;
+    }
+
+    // Returns the number of results which may be buffered for `element`.
+    // Stragglers may buffer more results, so that their worker keeps producing
+    // while the consumer reads from the other elements, and a latency spike of
+    // the straggler is absorbed by its buffer instead of stalling the cycle.
+    int64_t MaxBufferedResults(const Element& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (adapt_to_stragglers_ && IsStraggler(element)) {
+        return kStragglerBufferFactor * dataset()->buffer_output_elements_;
+      }
+      return dataset()->buffer_output_elements_;
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1485,7 +1679,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         TF_RETURN_IF_ERROR(
             reader->ReadScalar(prefix(), kCurrentElementsSize, &size));
-        if (current_elements_.size() != size) {
+        // A checkpoint without slots for extra elements also restores into an
+        // iterator which adapts to stragglers.
+        if (current_elements_.size() != size &&
+            size != dataset()->cycle_length_) {
           // This could mean two things: (1) the user created their checkpoint
           // from a dataset with one cycle_length, then changed the cycle_length
           // and tried to restore from the old checkpoint, or (2) the user set
@@ -1706,6 +1903,17 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     int64_t element_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
+    // Whether stragglers may buffer more results and, in nondeterministic mode,
+    // make extra elements join the cycle. Set by the
+    // `interleave_adapt_to_stragglers` option. Not modified after
+    // `Initialize`.
+    bool adapt_to_stragglers_ = false;
+
+    // Number of results produced by all elements, and the total time spent
+    // producing them.
+    int64_t num_results_produced_ TF_GUARDED_BY(mu_) = 0;
+    int64_t produce_micros_ TF_GUARDED_BY(mu_) = 0;
+
     // Set to true during checkpointing to alert element threads that they
     // should pause operation. This is needed to prevent constantly-active
     // worker threads from blocking checkpointing indefinitely.
@@ -15,7 +15,11 @@ limitations under the License.
 #include <memory>
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/platform/notification.h"
 
 namespace tensorflow {
 namespace data {
@@ -118,7 +122,28 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
   std::string deterministic_;
 };
 
-class ParallelInterleaveDatasetOpTest : public DatasetOpsTestBase {};
+// Returns options with which parallel interleave adapts to stragglers.
+const Options* AdaptToStragglersOptions() {
+  static const Options* options = [] {
+    auto* options = new Options();
+    options->set_interleave_adapt_to_stragglers(true);
+    return options;
+  }();
+  return options;
+}
+
+class ParallelInterleaveDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Recreates `iterator_` so that it adapts to stragglers.
+  Status AdaptToStragglers(const DatasetParams& dataset_params) {
+    IteratorContext::Params params(iterator_ctx_.get());
+    params.options = AdaptToStragglersOptions();
+    iterator_.reset();
+    iterator_ctx_ = std::make_unique<IteratorContext>(params);
+    return dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                  dataset_params.iterator_prefix(), &iterator_);
+  }
+};
 
 FunctionDefHelper::AttrValueWrapper MakeTensorSliceDatasetFunc(
     const DataTypeVector& output_types,
@@ -885,6 +910,210 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(ParallelInterleaveDatasetOpTest,
                                  ParallelInterleaveDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Returns a function which interleaves the slices of `x`, sleeping for
+// `sleep_microseconds` before each slice.
+FunctionDef MakeSleepingTensorSliceDataset() {
+  const DataTypeVector output_types = {DT_INT64};
+  const std::vector<PartialTensorShape> output_shapes = {
+      PartialTensorShape({1})};
+  return FunctionDefHelper::Define(
+      // Name
+      "MakeSleepingTensorSliceDataset",
+      // Args
+      {"x: int64", "sleep_microseconds: int64"},
+      // Return values
+      {"y: variant"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"slices"},
+        "TensorSliceDataset",
+        {"x"},
+        {{"Toutput_types", output_types}, {"output_shapes", output_shapes}}},
+       {{"y"},
+        "SleepDataset",
+        {"slices", "sleep_microseconds"},
+        {{"output_types", output_types}, {"output_shapes", output_shapes}}}});
+}
+
+// The first of four inputs sleeps for `straggler_sleep_microseconds` before
+// each of its results 0, 1 and 2. The other inputs produce 3 to 11 at once.
+ParallelInterleaveDatasetParams SleepingStragglerDatasetParams(
+    int64_t cycle_length, int64_t straggler_sleep_microseconds,
+    const std::string& deterministic) {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(
+                          TensorShape{4, 3, 1},
+                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}),
+                      CreateTensor<int64_t>(
+                          TensorShape{4},
+                          {straggler_sleep_microseconds, 0, 0, 0})},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/cycle_length,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/1,
+      /*num_parallel_calls=*/cycle_length,
+      /*func=*/
+      FunctionDefHelper::FunctionRef(/*name=*/"MakeSleepingTensorSliceDataset"),
+      /*func_lib=*/{MakeSleepingTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/deterministic,
+      /*node_name=*/kNodeName);
+}
+
+// The results 0, 1 and 2 of the straggler, which block until
+// `StragglerRelease()` is notified.
+constexpr int64_t kNumStragglerResults = 3;
+
+Notification& StragglerRelease() {
+  static Notification* release = new Notification();
+  return *release;
+}
+
+// Forwards its input, after waiting for `StragglerRelease()` if the input is
+// a result of the straggler.
+class WaitForStragglerOp : public OpKernel {
+ public:
+  explicit WaitForStragglerOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x = ctx->input(0);
+    if (x.flat<int64_t>()(0) < kNumStragglerResults) {
+      StragglerRelease().WaitForNotification();
+    }
+    ctx->set_output(0, x);
+  }
+};
+
+REGISTER_OP("ParallelInterleaveDatasetOpTest>WaitForStraggler")
+    .Input("x: int64")
+    .Output("y: int64")
+    .SetShapeFn(shape_inference::UnchangedShape);
+
+REGISTER_KERNEL_BUILDER(
+    Name("ParallelInterleaveDatasetOpTest>WaitForStraggler").Device(DEVICE_CPU),
+    WaitForStragglerOp);
+
+FunctionDef WaitForStraggler() {
+  return FunctionDefHelper::Define(
+      // Name
+      "WaitForStraggler",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: int64"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"y"}, "ParallelInterleaveDatasetOpTest>WaitForStraggler", {"x"}}});
+}
+
+// Returns a function which interleaves the slices of `x`, passing each slice
+// through `WaitForStraggler`.
+FunctionDef MakeBlockingTensorSliceDataset() {
+  const DataTypeVector output_types = {DT_INT64};
+  const std::vector<PartialTensorShape> output_shapes = {
+      PartialTensorShape({1})};
+  return FunctionDefHelper::Define(
+      // Name
+      "MakeBlockingTensorSliceDataset",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: variant"},
+      // Attr def
+      {},
+      // Nodes
+      {{{"slices"},
+        "TensorSliceDataset",
+        {"x"},
+        {{"Toutput_types", output_types}, {"output_shapes", output_shapes}}},
+       {{"y"},
+        "MapDataset",
+        {"slices"},
+        {{"f", FunctionDefHelper::FunctionRef("WaitForStraggler")},
+         {"Targuments", DataTypeVector{}},
+         {"output_types", output_types},
+         {"output_shapes", output_shapes}}}});
+}
+
+// The first of four inputs produces 0, 1 and 2, but blocks until
+// `StragglerRelease()` is notified. The other inputs produce 3 to 11 at once.
+ParallelInterleaveDatasetParams BlockingStragglerDatasetParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(
+          TensorShape{4, 3, 1}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11})},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/1,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/1,
+      /*num_parallel_calls=*/1,
+      /*func=*/
+      FunctionDefHelper::FunctionRef(/*name=*/"MakeBlockingTensorSliceDataset"),
+      /*func_lib=*/{MakeBlockingTensorSliceDataset(), WaitForStraggler()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/DeterminismPolicy::kNondeterministic,
+      /*node_name=*/kNodeName);
+}
+
+TEST_F(ParallelInterleaveDatasetOpTest, StragglerBuffering) {
+  auto dataset_params = SleepingStragglerDatasetParams(
+      /*cycle_length=*/2, /*straggler_sleep_microseconds=*/20000,
+      DeterminismPolicy::kDeterministic);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(AdaptToStragglers(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      CreateTensors<int64_t>(TensorShape{1}, {{0}, {3}, {1}, {4}, {2}, {5},
+                                              {6}, {9}, {7}, {10}, {8}, {11}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(ParallelInterleaveDatasetOpTest, StragglerDoesNotStallCycle) {
+  // With a cycle length of 1, the other inputs can only be read while the
+  // straggler blocks if extra elements join the cycle.
+  auto dataset_params = BlockingStragglerDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(AdaptToStragglers(dataset_params));
+  std::vector<Tensor> outputs;
+  bool end_of_sequence = false;
+  while (outputs.size() < 12 - kNumStragglerResults) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    outputs.insert(outputs.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(
+      outputs,
+      CreateTensors<int64_t>(TensorShape{1},
+                             {{3}, {4}, {5}, {6}, {7}, {8}, {9}, {10}, {11}}),
+      /*compare_order=*/false));
+
+  StragglerRelease().Notify();
+  outputs.clear();
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    outputs.insert(outputs.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(
+      outputs, CreateTensors<int64_t>(TensorShape{1}, {{0}, {1}, {2}}),
+      /*compare_order=*/true));
+}
+
 TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
   std::vector<ParallelInterleaveDatasetParams> invalid_params = {
       ParallelInterleaveDatasetParamsWithInvalidCycleLength(),
@@ -25,13 +25,16 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
@@ -39,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -69,6 +73,7 @@ constexpr char kDataProduced[] = "data_produced";
 constexpr char kEndOfInputSequence[] = "end_of_input_sequence";
 constexpr char kEpoch[] = "epoch";
 constexpr char kNumElements[] = "num_elements";
+constexpr char kBufferCompressed[] = "buffer_compressed";
 constexpr char kSlicesSize[] = "slices_size";
 constexpr char kSlicesStart[] = "slices_start";
 constexpr char kSlicesEnd[] = "slices_end";
@@ -81,6 +86,37 @@ constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
+namespace {
+
+// Whether the elements of shuffle buffers are stored compressed, and
+// uncompressed when they are produced, set by TF_DATA_SHUFFLE_BUFFER_COMPRESS.
+bool CompressShuffleBuffer() {
+  bool compress;
+  Status status =
+      ReadBoolFromEnvVar("TF_DATA_SHUFFLE_BUFFER_COMPRESS", false, &compress);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return false;
+  }
+  return compress;
+}
+
+// Bytes of stored elements above which shuffle buffers of a fixed size stop
+// filling, set by TF_DATA_SHUFFLE_BUFFER_MAX_BYTES. 0, the default, bounds
+// the buffers by their number of elements only.
+int64_t ShuffleBufferMaxBytes() {
+  int64_t max_bytes;
+  Status status =
+      ReadInt64FromEnvVar("TF_DATA_SHUFFLE_BUFFER_MAX_BYTES", 0, &max_bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 0;
+  }
+  return max_bytes;
+}
+
+}  // namespace
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -203,6 +239,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
     Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(mu_);
+      compress_buffer_ = CompressShuffleBuffer();
+      max_buffer_bytes_ = ShuffleBufferMaxBytes();
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
       ResetRngs();
       // Initialize checkpoint_indices_ to the entire buffer.
@@ -233,8 +271,21 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64_t offset =
           Random() % (slices_.front()->end - slices_.front()->start);
       int64_t index = (slices_.front()->start + offset) % buffer_->size();
-      *out_tensors = std::move(buffer_->at(index));
-      this->RecordBufferDequeue(ctx, *out_tensors);
+      std::vector<Tensor> element = std::move(buffer_->at(index));
+      this->RecordBufferDequeue(ctx, element);
+      buffer_bytes_ -= GetTotalBytes(element);
+      if (compress_buffer_) {
+        const CompressedElement* compressed =
+            element[0].scalar<Variant>()().get<CompressedElement>();
+        if (compressed == nullptr) {
+          return errors::Internal(
+              "Expected a compressed element in the shuffle buffer.");
+        }
+        out_tensors->clear();
+        TF_RETURN_IF_ERROR(UncompressElement(*compressed, out_tensors));
+      } else {
+        *out_tensors = std::move(element);
+      }
       std::swap(buffer_->at(index),
                 buffer_->at(slices_.front()->start % buffer_->size()));
       checkpoint_indices_.insert(index);
@@ -283,6 +334,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kEpoch, epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kNumElements, num_elements_));
+      if (compress_buffer_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kBufferCompressed, ""));
+      }
       const std::string key_prefix = absl::StrCat(prefix(), kColon, "buffer");
       if (ctx->symbolic_checkpoint()) {
         // When symbolic checkpointing is turned on, `writer`
@@ -350,6 +405,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(reader->ReadScalar(this->prefix(), kEpoch, &epoch_));
       TF_RETURN_IF_ERROR(
           reader->ReadScalar(this->prefix(), kNumElements, &num_elements_));
+      // The restored elements are stored as they were checkpointed.
+      compress_buffer_ = reader->Contains(this->prefix(), kBufferCompressed);
       size_t slices_size;
       {
         int64_t temp;
@@ -367,8 +424,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           checkpoint_indices_.insert(i);
         }
       }
+      buffer_bytes_ = 0;
       for (const auto& element : *buffer_) {
         RecordBufferEnqueue(ctx, element);
+        buffer_bytes_ += GetTotalBytes(element);
       }
       if (!IsShuffleAll()) {
         buffer_->resize(dataset()->buffer_size_);
@@ -463,7 +522,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
-          AddToShuffleBuffer(ctx, std::move(input_element));
+          TF_RETURN_IF_ERROR(AddToShuffleBuffer(ctx, std::move(input_element)));
           continue;
         }
         input_impl_.reset();
@@ -500,6 +559,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         // we need to add to the buffer.
         return true;
       }
+      if (max_buffer_bytes_ > 0 && num_elements_ > 0 &&
+          buffer_bytes_ >= max_buffer_bytes_) {
+        return false;
+      }
       return num_elements_ < buffer_->size();
     }
 
@@ -520,14 +583,23 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return absl::OkStatus();
     }
 
-    void AddToShuffleBuffer(IteratorContext* ctx, std::vector<Tensor>&& element)
+    Status AddToShuffleBuffer(IteratorContext* ctx,
+                              std::vector<Tensor>&& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       data_produced_ = true;
       if (num_elements_ == 0) {
         VLOG(1) << "Starting to fill up shuffle buffer of size: "
                 << BufferSizeString();
       }
+      if (compress_buffer_) {
+        CompressedElement compressed;
+        TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+        Tensor tensor(DT_VARIANT, TensorShape({}));
+        tensor.scalar<Variant>()() = std::move(compressed);
+        element = {std::move(tensor)};
+      }
       this->RecordBufferEnqueue(ctx, element);
+      buffer_bytes_ += GetTotalBytes(element);
       if (num_elements_ == buffer_->size()) {
         DCHECK(IsShuffleAll());
         checkpoint_indices_.insert(buffer_->size());
@@ -539,6 +611,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
       num_elements_++;
       slices_.back()->end++;
+      return absl::OkStatus();
     }
 
     void ClearEmptySlices() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -567,6 +640,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
     int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
     int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
+    // Bytes of the elements in `buffer_`, as stored.
+    int64_t buffer_bytes_ TF_GUARDED_BY(mu_) = 0;
+    // Whether the elements in `buffer_` are compressed.
+    bool compress_buffer_ TF_GUARDED_BY(mu_) = false;
+    int64_t max_buffer_bytes_ TF_GUARDED_BY(mu_) = 0;
     int64_t seed_ TF_GUARDED_BY(mu_) = 0;
     int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
     // Indices into `buffer_` indicating which data belongs to which epoch.
@@ -11,8 +11,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -98,7 +101,33 @@ class ShuffleDatasetParams : public DatasetParams {
   bool reshuffle_each_iteration_;
 };
 
-class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
+class ShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns all outputs of `iterator_`, saving and restoring it midway.
+  Status GetAllOutputs(const ShuffleDatasetParams& dataset_params,
+                       std::vector<Tensor>* outputs) {
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      if (outputs->size() == 5) {
+        std::unique_ptr<SerializationContext> serialization_ctx;
+        TF_RETURN_IF_ERROR(CreateSerializationContext(&serialization_ctx));
+        VariantTensorDataWriter writer;
+        TF_RETURN_IF_ERROR(iterator_->Save(serialization_ctx.get(), &writer));
+        std::vector<const VariantTensorData*> data;
+        writer.GetData(&data);
+        VariantTensorDataReader reader(data);
+        TF_RETURN_IF_ERROR(RestoreIterator(iterator_ctx_.get(), &reader,
+                                           dataset_params.iterator_prefix(),
+                                           *dataset_, &iterator_));
+      }
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      outputs->insert(outputs->end(), next.begin(), next.end());
+    }
+    return absl::OkStatus();
+  }
+};
 
 // Test case 1: test shuffle_dataset with reshuffle_each_iteration = false.
 ShuffleDatasetParams ShuffleDatasetParams1() {
@@ -583,6 +612,35 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, CompressedBuffer) {
+  auto dataset_params = ShuffleDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs;
+  TF_ASSERT_OK(GetAllOutputs(dataset_params, &expected_outputs));
+
+  setenv("TF_DATA_SHUFFLE_BUFFER_COMPRESS", "true", /*overwrite=*/1);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(GetAllOutputs(dataset_params, &outputs));
+  unsetenv("TF_DATA_SHUFFLE_BUFFER_COMPRESS");
+  TF_EXPECT_OK(ExpectEqual(outputs, expected_outputs, /*compare_order=*/true));
+}
+
+TEST_F(ShuffleDatasetOpTest, BufferBoundedByBytes) {
+  // The buffer holds a single int64 scalar, so the elements are not shuffled.
+  setenv("TF_DATA_SHUFFLE_BUFFER_MAX_BYTES", "8", /*overwrite=*/1);
+  auto dataset_params = ShuffleDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(GetAllOutputs(dataset_params, &outputs));
+  unsetenv("TF_DATA_SHUFFLE_BUFFER_MAX_BYTES");
+  TF_EXPECT_OK(ExpectEqual(
+      outputs,
+      CreateTensors<int64_t>(
+          TensorShape({}), {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}}),
+      /*compare_order=*/true));
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
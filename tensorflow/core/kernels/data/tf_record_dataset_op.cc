@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <optional>
+
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -25,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -58,6 +63,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
+                   int64_t num_prefetch_buffers,
+                   int64_t max_prefetch_buffer_size, bool use_record_index,
                    std::vector<int64_t> byte_offsets, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
@@ -65,9 +72,12 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        use_record_index_(use_record_index) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      options_.num_prefetch_buffers = num_prefetch_buffers;
+      options_.max_prefetch_buffer_size = max_prefetch_buffer_size;
     }
   }
 
@@ -102,6 +112,49 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE ||
+        !LoadRecordIndex().ok()) {
+      return kUnknownCardinality;
+    }
+    return records_before_.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    const size_t file_index =
+        std::upper_bound(records_before_.begin(), records_before_.end(),
+                         index) -
+        records_before_.begin() - 1;
+    RandomAccessFile* file = nullptr;
+    {
+      mutex_lock l(index_mu_);
+      std::unique_ptr<RandomAccessFile>& f = indexed_files_[file_index];
+      if (f == nullptr) {
+        TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(
+            TranslateFileName(filenames_[file_index]), &f));
+      }
+      file = f.get();
+    }
+    uint64 offset =
+        record_offsets_[file_index][index - records_before_[file_index]];
+    io::RecordReader reader(file);
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    return reader.ReadRecord(&offset, &out_tensors->back().scalar<tstring>()());
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    return LoadRecordIndex();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -123,13 +176,18 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
@@ -235,6 +293,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(ctx);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -285,18 +346,94 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    GlobalShuffleIterator global_shuffle_iterator_;
   };
 
+  // Loads the record index of every file on first use, and returns whether
+  // the dataset supports random access.
+  absl::Status LoadRecordIndex() const TF_LOCKS_EXCLUDED(index_mu_) {
+    mutex_lock l(index_mu_);
+    if (!record_index_status_.has_value()) {
+      record_index_status_ = LoadRecordIndexLocked();
+    }
+    return *record_index_status_;
+  }
+
+  absl::Status LoadRecordIndexLocked() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(index_mu_) {
+    if (!use_record_index_) {
+      return absl::FailedPreconditionError(
+          "TFRecordDataset supports random access only if "
+          "TF_RECORD_DATASET_USE_RECORD_INDEX is set.");
+    }
+    if (options_.compression_type != io::RecordReaderOptions::NONE ||
+        !byte_offsets_.empty()) {
+      return absl::FailedPreconditionError(
+          "TFRecordDataset supports random access only for uncompressed files "
+          "without byte offsets.");
+    }
+    std::vector<std::vector<uint64>> record_offsets(filenames_.size());
+    std::vector<int64_t> records_before = {0};
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      Status s = io::ReadRecordIndex(
+          Env::Default(), TranslateFileName(filenames_[i]), &record_offsets[i]);
+      if (!s.ok()) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "TFRecordDataset supports random access only if every file has a "
+            "record index: ",
+            s.message()));
+      }
+      records_before.push_back(records_before.back() +
+                               record_offsets[i].size() - 1);
+    }
+    record_offsets_ = std::move(record_offsets);
+    records_before_ = std::move(records_before);
+    indexed_files_.resize(filenames_.size());
+    return absl::OkStatus();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  const bool use_record_index_;
+
+  mutable mutex index_mu_;
+  mutable std::optional<absl::Status> record_index_status_
+      TF_GUARDED_BY(index_mu_);
+  // Once the record index is loaded, the offsets of the records of each file
+  // followed by its size, and the number of records before each file followed
+  // by the total. Immutable after loading, so they are read without the lock.
+  mutable std::vector<std::vector<uint64>> record_offsets_;
+  mutable std::vector<int64_t> records_before_;
+  // The files that random access reads from, opened on first use.
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> indexed_files_
+      TF_GUARDED_BY(index_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  // If positive, each reader keeps this many reads of `buffer_size` bytes in
+  // flight, so that one iterator can saturate a fast local disk without
+  // interleaving many files in parallel.
+  OP_REQUIRES_OK(ctx,
+                 ReadInt64FromEnvVar("TF_RECORD_DATASET_NUM_PREFETCH_BUFFERS",
+                                     0, &num_prefetch_buffers_));
+  // If larger than `buffer_size`, the prefetched reads grow up to this many
+  // bytes while the reader waits for them, so that a single file on a remote
+  // file system is read with few large range requests.
+  OP_REQUIRES_OK(
+      ctx, ReadInt64FromEnvVar("TF_RECORD_DATASET_MAX_PREFETCH_BUFFER_SIZE", 0,
+                               &max_prefetch_buffer_size_));
+  // If true, uncompressed datasets whose files all have a record index (see
+  // `io::ReadRecordIndex`) support random access and global shuffling. Off by
+  // default because looking up the indexes costs a file system call per file.
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_RECORD_DATASET_USE_RECORD_INDEX",
+                                         false, &use_record_index_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -362,7 +499,9 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, num_prefetch_buffers_,
+                        max_prefetch_buffer_size_, use_record_index_,
+                        std::move(byte_offsets), op_version_);
 }
 
 namespace {
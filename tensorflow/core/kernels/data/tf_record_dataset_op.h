@@ -36,6 +36,9 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  int64_t num_prefetch_buffers_ = 0;
+  int64_t max_prefetch_buffer_size_ = 0;
+  bool use_record_index_ = false;
 };
 
 }  // namespace data
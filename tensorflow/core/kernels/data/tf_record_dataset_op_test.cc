@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 
@@ -333,6 +334,57 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithRecordIndex) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb"}};
+  Env* env = Env::Default();
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(env->NewWritableFile(filenames[i], &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_ASSERT_OK(env->NewWritableFile(
+        absl::StrCat(filenames[i], io::kRecordIndexSuffix), &index_file));
+    io::RecordWriterOptions options;
+    options.index_file = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : contents[i]) {
+      TF_ASSERT_OK(writer.WriteRecord(record));
+    }
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+    TF_ASSERT_OK(index_file->Close());
+  }
+
+  setenv("TF_RECORD_DATASET_USE_RECORD_INDEX", "true", /*overwrite=*/1);
+  TFRecordDatasetParams dataset_params(filenames, CompressionType::UNCOMPRESSED,
+                                       /*buffer_size=*/10,
+                                       /*byte_offsets=*/{},
+                                       /*node_name=*/kNodeName);
+  Status status = Initialize(dataset_params);
+  unsetenv("TF_RECORD_DATASET_USE_RECORD_INDEX");
+  TF_ASSERT_OK(status);
+
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), 5);
+  const std::vector<string> expected = {"1", "22", "333", "a", "bb"};
+  for (int i = expected.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 5, &out_tensors).code(),
+      absl::StatusCode::kOutOfRange);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
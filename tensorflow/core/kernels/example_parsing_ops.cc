@@ -17,20 +17,24 @@ limitations under the License.
 
 #include <numeric>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 #include "tensorflow/core/util/example_proto_helper.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
@@ -41,6 +45,47 @@ namespace tensorflow {
 namespace {
 constexpr char kParseExampleV2[] = "ParseExampleV2";
 constexpr char kParseSequenceExampleV2[] = "ParseSequenceExampleV2";
+
+// The buffer of a string tensor whose elements may be views into serialized
+// examples, which it keeps alive.
+class BytesViewsBuffer : public TensorBuffer {
+ public:
+  BytesViewsBuffer(Tensor views, Tensor serialized)
+      : TensorBuffer(views.flat<tstring>().data()),
+        views_(std::move(views)),
+        serialized_(std::move(serialized)) {}
+
+  size_t size() const override {
+    return views_.NumElements() * sizeof(tstring);
+  }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("parse_example_views");
+  }
+  // Never forward the buffer to an op output, so that no kernel overwrites
+  // the views.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  Tensor views_;
+  Tensor serialized_;
+};
+
+// Makes the string tensors of "result", whose elements may be views into
+// "serialized", keep "serialized" alive.
+void KeepSerializedAlive(const Tensor& serialized, example::Result* result) {
+  for (std::vector<Tensor>* tensors :
+       {&result->dense_values, &result->sparse_values,
+        &result->ragged_values}) {
+    for (Tensor& t : *tensors) {
+      if (t.dtype() != DT_STRING) continue;
+      auto* buf = new BytesViewsBuffer(t, serialized);
+      t = Tensor(DT_STRING, t.shape(), buf);
+      buf->Unref();
+    }
+  }
+}
 }  // namespace
 
 // Note: this kernel is used by both the ParseExample op and the ParseExampleV2
@@ -51,6 +96,12 @@ class ParseExampleOp : public OpKernel {
   explicit ParseExampleOp(OpKernelConstruction* ctx)
       : OpKernel(ctx), op_version_(ctx->def().op() == kParseExampleV2 ? 2 : 1) {
     OP_REQUIRES_OK(ctx, attrs_.Init(ctx, op_version_));
+    // If set, the parsed bytes_list values are views into the serialized
+    // examples instead of copies, and the string outputs keep the serialized
+    // examples alive. Saves copying large values such as encoded images that
+    // are only read downstream. Copying the output strings copies the views.
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_PARSE_EXAMPLE_BYTES_AS_VIEWS",
+                                           false, &bytes_as_views_));
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -89,6 +140,7 @@ class ParseExampleOp : public OpKernel {
 
     example::FastParseExampleConfig config =
         MakeConfig(dense_keys_t, sparse_keys_t, ragged_keys_t, dense_defaults);
+    config.bytes_as_views = bytes_as_views_;
 
     example::Result result;
     if (TensorShapeUtils::IsVector(serialized->shape())) {
@@ -97,6 +149,7 @@ class ParseExampleOp : public OpKernel {
     } else {
       OP_REQUIRES_OK(ctx, ParseExampleScalar(config, serialized, ctx, &result));
     }
+    if (bytes_as_views_) KeepSerializedAlive(*serialized, &result);
     OP_REQUIRES_OK(ctx, WriteOutput(result, ctx));
   }
 
@@ -289,6 +342,7 @@ class ParseExampleOp : public OpKernel {
 
   ParseExampleAttrs attrs_;
   int op_version_;
+  bool bytes_as_views_ = false;
   absl::once_flag flag_;
 };
 
@@ -0,0 +1,230 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Number of keys whose scores are computed at once. Only one block of scores
+// per query row is live at any time, instead of the full `[Lq, Lk]` matrix.
+constexpr int64_t kKeyBlockSize = 64;
+
+// Computes `Softmax(scale * query * key^T + mask) * value` one query row at a
+// time, visiting the keys in blocks and rescaling the partial results with an
+// online softmax, as in FlashAttention
+// (https://arxiv.org/abs/2205.14135). Grappler's remapper creates this op from
+// a BatchMatMulV2 + Mul + [AddV2] + Softmax + BatchMatMulV2 subgraph.
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedScaledDotProductAttention accepts at most one "
+                    "mask, got num_args=",
+                    num_args));
+    has_mask_ = num_args == 1;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const Tensor& scale = context->input(3);
+
+    const int rank = query.dims();
+    OP_REQUIRES(context,
+                rank >= 2 && key.dims() == rank && value.dims() == rank,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank >= 2, got ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    for (int d = 0; d < rank - 2; ++d) {
+      OP_REQUIRES(context,
+                  key.dim_size(d) == query.dim_size(d) &&
+                      value.dim_size(d) == query.dim_size(d),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions, got ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+    }
+    const int64_t num_queries = query.dim_size(rank - 2);
+    const int64_t depth = query.dim_size(rank - 1);
+    const int64_t num_keys = key.dim_size(rank - 2);
+    const int64_t value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(context,
+                key.dim_size(rank - 1) == depth &&
+                    value.dim_size(rank - 2) == num_keys,
+                errors::InvalidArgument(
+                    "Incompatible query, key and value shapes: ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(scale.shape()),
+                errors::InvalidArgument("scale must be a scalar, got shape ",
+                                        scale.shape().DebugString()));
+
+    // The scores have shape [batch..., num_queries, num_keys]. A mask of
+    // lower rank is aligned with their trailing dimensions, and dimensions of
+    // size 1 are broadcast by giving them a zero stride.
+    TensorShape scores_shape = query.shape();
+    scores_shape.set_dim(rank - 1, num_keys);
+    std::vector<int64_t> mask_strides(rank, 0);
+    const T* mask_data = nullptr;
+    if (has_mask_) {
+      const Tensor& mask = context->input(4);
+      OP_REQUIRES(context, mask.dims() <= rank,
+                  errors::InvalidArgument(
+                      "mask rank must not exceed the rank of the scores, got ",
+                      mask.shape().DebugString()));
+      int64_t stride = 1;
+      for (int d = mask.dims() - 1; d >= 0; --d) {
+        const int scores_dim = rank - mask.dims() + d;
+        OP_REQUIRES(context,
+                    mask.dim_size(d) == scores_shape.dim_size(scores_dim) ||
+                        mask.dim_size(d) == 1,
+                    errors::InvalidArgument(
+                        "mask with shape ", mask.shape().DebugString(),
+                        " can not be broadcast to the attention scores"));
+        if (mask.dim_size(d) != 1) mask_strides[scores_dim] = stride;
+        stride *= mask.dim_size(d);
+      }
+      mask_data = mask.flat<T>().data();
+    }
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (num_keys == 0) {
+      output->flat<T>().setZero();
+      return;
+    }
+
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    const T scale_value = scale.scalar<T>()();
+    T* output_data = output->flat<T>().data();
+    const int64_t num_rows = output->NumElements() / value_depth;
+
+    using Vector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using ConstVectorMap = Eigen::Map<const Vector>;
+    using VectorMap = Eigen::Map<Vector>;
+
+    auto compute_rows = [&](int64_t begin, int64_t end) {
+      T scores[kKeyBlockSize];
+      Vector accumulator(value_depth);
+      for (int64_t row = begin; row < end; ++row) {
+        const int64_t batch = row / num_queries;
+        const int64_t query_index = row % num_queries;
+
+        int64_t mask_offset = query_index * mask_strides[rank - 2];
+        for (int64_t d = rank - 3, rest = batch; d >= 0; --d) {
+          mask_offset += (rest % query.dim_size(d)) * mask_strides[d];
+          rest /= query.dim_size(d);
+        }
+
+        ConstVectorMap query_row(query_data + row * depth, depth);
+        const T* batch_keys = key_data + batch * num_keys * depth;
+        const T* batch_values = value_data + batch * num_keys * value_depth;
+
+        // Running maximum and sum of exponentials of the scores seen so far;
+        // `accumulator` holds the matching unnormalized output row.
+        T running_max = -std::numeric_limits<T>::infinity();
+        T running_sum = T(0);
+        accumulator.setZero();
+        for (int64_t block = 0; block < num_keys; block += kKeyBlockSize) {
+          const int64_t block_size = std::min(kKeyBlockSize, num_keys - block);
+          T block_max = -std::numeric_limits<T>::infinity();
+          for (int64_t j = 0; j < block_size; ++j) {
+            const int64_t key_index = block + j;
+            T score = scale_value *
+                      query_row.dot(ConstVectorMap(
+                          batch_keys + key_index * depth, depth));
+            if (mask_data != nullptr) {
+              score +=
+                  mask_data[mask_offset + key_index * mask_strides[rank - 1]];
+            }
+            scores[j] = score;
+            block_max = std::max(block_max, score);
+          }
+          // Fully masked blocks do not contribute to the output.
+          if (block_max == -std::numeric_limits<T>::infinity()) continue;
+
+          const T new_max = std::max(running_max, block_max);
+          const T correction = std::exp(running_max - new_max);
+          running_sum *= correction;
+          accumulator *= correction;
+          for (int64_t j = 0; j < block_size; ++j) {
+            const T weight = std::exp(scores[j] - new_max);
+            running_sum += weight;
+            const T* value_row = batch_values + (block + j) * value_depth;
+            accumulator += weight * ConstVectorMap(value_row, value_depth);
+          }
+          running_max = new_max;
+        }
+        // Like Softmax, rows whose scores are all masked produce NaNs.
+        VectorMap(output_data + row * value_depth, value_depth) =
+            accumulator / running_sum;
+      }
+    };
+
+    const int64_t cost_per_row = num_keys * (2 * depth + 2 * value_depth + 10);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, compute_rows);
+  }
+
+ private:
+  bool has_mask_;
+};
+
+#define REGISTER_CPU(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention") \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<T>("T"),            \
+                          FusedScaledDotProductAttentionOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace
+}  // namespace tensorflow
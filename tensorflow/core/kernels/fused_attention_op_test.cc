@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedScaledDotProductAttentionOpTest : public OpsTestBase {
+ protected:
+  static gtl::ArraySlice<float> AsSlice(const Tensor& tensor) {
+    return gtl::ArraySlice<float>(tensor.flat<float>().data(),
+                                  tensor.NumElements());
+  }
+
+  // Runs the op on [batch, num_queries, depth] queries and [batch, num_keys,
+  // depth] keys and values, and compares the result with an unfused
+  // computation which materializes the scores. If `mask_shape` is non-empty,
+  // a mask with that shape is added to the scores. It masks out every third
+  // score, and its first 64 elements so that a whole key block is masked.
+  void RunAndCompare(int64_t batch, int64_t num_queries, int64_t num_keys,
+                     int64_t depth, const std::vector<int64_t>& mask_shape) {
+    const bool has_mask = !mask_shape.empty();
+    TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedScaledDotProductAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(has_mask ? 1 : 0, DT_FLOAT))
+                     .Attr("num_args", has_mask ? 1 : 0)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    Tensor query(DT_FLOAT, TensorShape({batch, num_queries, depth}));
+    Tensor key(DT_FLOAT, TensorShape({batch, num_keys, depth}));
+    Tensor value(DT_FLOAT, TensorShape({batch, num_keys, depth}));
+    query.flat<float>().setRandom();
+    key.flat<float>().setRandom();
+    value.flat<float>().setRandom();
+    const float scale = 1.0f / std::sqrt(static_cast<float>(depth));
+
+    Tensor mask(DT_FLOAT, has_mask ? TensorShape(mask_shape) : TensorShape());
+    if (has_mask) {
+      auto mask_flat = mask.flat<float>();
+      for (int64_t i = 0; i < mask_flat.size(); ++i) {
+        const bool masked = i % 3 == 0 || i < 64;
+        mask_flat(i) = masked ? -std::numeric_limits<float>::infinity() : 0.5f;
+      }
+    }
+
+    for (const Tensor* input : {&query, &key, &value}) {
+      AddInputFromArray<float>(input->shape(), AsSlice(*input));
+    }
+    AddInputFromArray<float>(TensorShape({}), {scale});
+    if (has_mask) AddInputFromArray<float>(mask.shape(), AsSlice(mask));
+    TF_ASSERT_OK(RunOpKernel());
+
+    // The mask is broadcast from its trailing dimensions.
+    auto mask_value = [&](int64_t b, int64_t i, int64_t j) {
+      if (!has_mask) return 0.0f;
+      const int64_t index[3] = {b, i, j};
+      const int offset = 3 - mask.dims();
+      int64_t flat_index = 0;
+      for (int d = 0; d < mask.dims(); ++d) {
+        const int64_t size = mask.dim_size(d);
+        flat_index = flat_index * size + (size == 1 ? 0 : index[offset + d]);
+      }
+      return mask.flat<float>()(flat_index);
+    };
+
+    Tensor expected(DT_FLOAT, TensorShape({batch, num_queries, depth}));
+    auto q = query.tensor<float, 3>();
+    auto k = key.tensor<float, 3>();
+    auto v = value.tensor<float, 3>();
+    auto out = expected.tensor<float, 3>();
+    for (int64_t b = 0; b < batch; ++b) {
+      for (int64_t i = 0; i < num_queries; ++i) {
+        std::vector<float> scores(num_keys);
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int64_t j = 0; j < num_keys; ++j) {
+          float dot = 0.0f;
+          for (int64_t d = 0; d < depth; ++d) dot += q(b, i, d) * k(b, j, d);
+          scores[j] = scale * dot + mask_value(b, i, j);
+          max_score = std::max(max_score, scores[j]);
+        }
+        float sum = 0.0f;
+        for (float& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+        for (int64_t d = 0; d < depth; ++d) {
+          float result = 0.0f;
+          for (int64_t j = 0; j < num_keys; ++j) {
+            result += scores[j] / sum * v(b, j, d);
+          }
+          out(b, i, d) = result;
+        }
+      }
+    }
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-5, /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(FusedScaledDotProductAttentionOpTest, SingleKeyBlock) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/5, /*num_keys=*/7, /*depth=*/4,
+                /*mask_shape=*/{});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, MultipleKeyBlocks) {
+  RunAndCompare(/*batch=*/3, /*num_queries=*/4, /*num_keys=*/150,
+                /*depth=*/8, /*mask_shape=*/{});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, Mask) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/3, /*num_keys=*/150,
+                /*depth=*/8, /*mask_shape=*/{2, 3, 150});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, BroadcastMaskOverBatch) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/3, /*num_keys=*/150,
+                /*depth=*/8, /*mask_shape=*/{3, 150});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, BroadcastMaskOverQueries) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/3, /*num_keys=*/150,
+                /*depth=*/8, /*mask_shape=*/{2, 1, 150});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, RejectsMismatchedBatch) {
+  TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedScaledDotProductAttention")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(0, DT_FLOAT))
+                   .Attr("num_args", 0)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 1, 1}), {1.0f});
+  AddInputFromArray<float>(TensorShape({2, 1, 1}), {1.0f, 2.0f});
+  AddInputFromArray<float>(TensorShape({2, 1, 1}), {1.0f, 2.0f});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_dropout_op.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/random_op_cpu.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/math/math_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/util/guarded_philox_random.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+template <typename T>
+struct FusedDropout<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const CPUDevice& d,
+                  random::PhiloxRandom gen, const T* x, T scale, T rate,
+                  bool divide, int64_t size, T* output, uint8* mask) {
+    using Distribution = random::UniformDistribution<random::PhiloxRandom, T>;
+    constexpr int kGroupsPerBlock =
+        kDropoutBlockSize / Distribution::kResultElementCount;
+    const int64_t num_blocks =
+        MathUtil::CeilOfRatio<int64_t>(size, kDropoutBlockSize);
+    auto work = [&](int64_t start_block, int64_t limit_block) {
+      // The groups of a shard are consecutive, so they are drawn from one
+      // batched generator.
+      random::PhiloxRandom shard_gen = gen;
+      shard_gen.Skip(start_block * kGroupsPerBlock);
+      BatchedPhiloxRandom batched_gen(shard_gen);
+      for (int64_t block = start_block; block < limit_block; ++block) {
+        const int64_t offset = block * kDropoutBlockSize;
+        mask[block] = DropoutBlock(
+            &batched_gen, x + offset, scale, rate, divide,
+            static_cast<int>(std::min<int64_t>(size - offset,
+                                               kDropoutBlockSize)),
+            output + offset);
+      }
+    };
+    const int64_t cost_per_block =
+        kDropoutBlockSize * (Distribution::kElementCost + 2);
+    const auto& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, work);
+  }
+};
+
+template <typename T>
+struct FusedDropoutGrad<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const CPUDevice& d, const T* gradients,
+                  const uint8* mask, int64_t size, T* backprops) {
+    auto work = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const int bit = i % kDropoutBlockSize;
+        const bool keep = (mask[i / kDropoutBlockSize] >> bit) & 1;
+        backprops[i] = keep ? gradients[i] : T(0);
+      }
+    };
+    const auto& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, size,
+          /*cost_per_unit=*/2, work);
+  }
+};
+
+}  // namespace functor
+
+template <typename Device, typename T>
+class FusedDropoutOp : public OpKernel {
+ public:
+  explicit FusedDropoutOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, generator_.Init(ctx));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("divide", &divide_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x = ctx->input(0);
+    const Tensor& scale = ctx->input(1);
+    const Tensor& rate = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scale.shape()),
+                errors::InvalidArgument("scale must be 0-D, got shape ",
+                                        scale.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(rate.shape()),
+                errors::InvalidArgument("rate must be 0-D, got shape ",
+                                        rate.shape().DebugString()));
+
+    // Each output element only depends on the same input element.
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, x.shape(), &output));
+    const int64_t size = x.NumElements();
+    const int64_t num_masks =
+        MathUtil::CeilOfRatio<int64_t>(size, functor::kDropoutBlockSize);
+    Tensor* mask;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(1, TensorShape({num_masks}), &mask));
+    if (size == 0) return;
+
+    functor::FusedDropout<Device, T>()(
+        ctx, ctx->eigen_device<Device>(),
+        // Reserves the same samples as RandomUniform, so that the rewrite
+        // does not change the results.
+        generator_.ReserveRandomOutputs(size, 256), x.flat<T>().data(),
+        scale.scalar<T>()(), rate.scalar<T>()(), divide_, size,
+        output->flat<T>().data(), mask->flat<uint8>().data());
+  }
+
+ private:
+  GuardedPhiloxRandom generator_;
+  bool divide_;
+};
+
+template <typename Device, typename T>
+class FusedDropoutGradOp : public OpKernel {
+ public:
+  explicit FusedDropoutGradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& gradients = ctx->input(0);
+    const Tensor& mask = ctx->input(1);
+    const int64_t size = gradients.NumElements();
+    const int64_t num_masks =
+        MathUtil::CeilOfRatio<int64_t>(size, functor::kDropoutBlockSize);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsVector(mask.shape()) &&
+                    mask.NumElements() == num_masks,
+                errors::InvalidArgument("mask must have shape [", num_masks,
+                                        "], got shape ",
+                                        mask.shape().DebugString()));
+
+    Tensor* backprops;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, gradients.shape(), &backprops));
+    if (size == 0) return;
+
+    functor::FusedDropoutGrad<Device, T>()(
+        ctx, ctx->eigen_device<Device>(), gradients.flat<T>().data(),
+        mask.flat<uint8>().data(), size, backprops->flat<T>().data());
+  }
+};
+
+#define REGISTER_CPU_KERNELS(T)                                        \
+  REGISTER_KERNEL_BUILDER(                                             \
+      Name("_FusedDropout").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedDropoutOp<CPUDevice, T>);                                   \
+  REGISTER_KERNEL_BUILDER(Name("_FusedDropoutGrad")                    \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<T>("T"),                 \
+                          FusedDropoutGradOp<CPUDevice, T>);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define REGISTER_GPU_KERNELS(T)                               \
+  REGISTER_KERNEL_BUILDER(Name("_FusedDropout")               \
+                              .Device(DEVICE_GPU)             \
+                              .HostMemory("scale")            \
+                              .HostMemory("rate")             \
+                              .TypeConstraint<T>("T"),        \
+                          FusedDropoutOp<GPUDevice, T>);      \
+  REGISTER_KERNEL_BUILDER(Name("_FusedDropoutGrad")           \
+                              .Device(DEVICE_GPU)             \
+                              .TypeConstraint<T>("T"),        \
+                          FusedDropoutGradOp<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_GPU_KERNELS);
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_double(REGISTER_GPU_KERNELS);
+
+#undef REGISTER_GPU_KERNELS
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_DROPOUT_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_DROPOUT_OP_H_
+
+#include <cstdint>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace functor {
+
+// The number of elements sharing a byte of the mask.
+constexpr int kDropoutBlockSize = 8;
+
+// Applies dropout to the first `size` <= kDropoutBlockSize elements of `x`,
+// drawing their uniform samples from `gen` in the same order as
+// RandomUniform, and returns the byte of the mask for them.
+template <class Generator, typename T>
+PHILOX_DEVICE_INLINE uint8 DropoutBlock(Generator* gen, const T* x, T scale,
+                                        T rate, bool divide, int size,
+                                        T* output) {
+  random::UniformDistribution<Generator, T> dist;
+  constexpr int kGroupSize =
+      random::UniformDistribution<Generator, T>::kResultElementCount;
+  uint8 mask = 0;
+  for (int group = 0; group < kDropoutBlockSize; group += kGroupSize) {
+    const auto samples = dist(gen);
+    for (int j = 0; j < kGroupSize; ++j) {
+      const int i = group + j;
+      if (i >= size) break;
+      const bool keep = samples[j] >= rate;
+      output[i] = keep ? (divide ? x[i] / scale : x[i] * scale) : T(0);
+      mask |= static_cast<uint8>(keep) << i;
+    }
+  }
+  return mask;
+}
+
+// Computes the outputs of _FusedDropout. Bit `i % 8` of `mask[i / 8]` is set
+// iff element `i` was kept.
+template <typename Device, typename T>
+struct FusedDropout;
+
+// Computes the backprops of _FusedDropoutGrad.
+template <typename Device, typename T>
+struct FusedDropoutGrad;
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+template <typename T>
+struct FusedDropout<Eigen::GpuDevice, T> {
+  void operator()(OpKernelContext* ctx, const Eigen::GpuDevice& d,
+                  random::PhiloxRandom gen, const T* x, T scale, T rate,
+                  bool divide, int64_t size, T* output, uint8* mask);
+};
+
+template <typename T>
+struct FusedDropoutGrad<Eigen::GpuDevice, T> {
+  void operator()(OpKernelContext* ctx, const Eigen::GpuDevice& d,
+                  const T* gradients, const uint8* mask, int64_t size,
+                  T* backprops);
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_DROPOUT_OP_H_
@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/fused_dropout_op.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Each thread computes the mask bytes, i.e. blocks of 8 elements, in a grid
+// stride loop.
+template <typename T>
+__global__ void FusedDropoutKernel(random::PhiloxRandom gen,
+                                   const T* __restrict__ x, T scale, T rate,
+                                   bool divide, int64_t size,
+                                   T* __restrict__ output,
+                                   uint8* __restrict__ mask) {
+  using Distribution = random::UniformDistribution<random::PhiloxRandom, T>;
+  constexpr int kBlockSize = functor::kDropoutBlockSize;
+  constexpr int kGroupsPerBlock =
+      kBlockSize / Distribution::kResultElementCount;
+  const int64_t num_blocks = (size + kBlockSize - 1) / kBlockSize;
+  for (int64_t block : GpuGridRangeX<int64_t>(num_blocks)) {
+    random::PhiloxRandom block_gen = gen;
+    block_gen.Skip(block * kGroupsPerBlock);
+    const int64_t offset = block * kBlockSize;
+    const int block_size =
+        size - offset < kBlockSize ? static_cast<int>(size - offset)
+                                   : kBlockSize;
+    mask[block] = functor::DropoutBlock(&block_gen, x + offset, scale, rate,
+                                        divide, block_size, output + offset);
+  }
+}
+
+template <typename T>
+__global__ void FusedDropoutGradKernel(const T* __restrict__ gradients,
+                                       const uint8* __restrict__ mask,
+                                       int64_t size,
+                                       T* __restrict__ backprops) {
+  constexpr int kBlockSize = functor::kDropoutBlockSize;
+  for (int64_t i : GpuGridRangeX<int64_t>(size)) {
+    const bool keep = (mask[i / kBlockSize] >> (i % kBlockSize)) & 1;
+    backprops[i] = keep ? gradients[i] : T(0);
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+void FusedDropout<GPUDevice, T>::operator()(
+    OpKernelContext* ctx, const GPUDevice& d, random::PhiloxRandom gen,
+    const T* x, T scale, T rate, bool divide, int64_t size, T* output,
+    uint8* mask) {
+  const int64_t num_blocks = (size + kDropoutBlockSize - 1) / kDropoutBlockSize;
+  GpuLaunchConfig config =
+      GetGpuLaunchConfig(num_blocks, d, FusedDropoutKernel<T>, 0, 0);
+  TF_CHECK_OK(GpuLaunchKernel(FusedDropoutKernel<T>, config.block_count,
+                              config.thread_per_block, 0, d.stream(), gen, x,
+                              scale, rate, divide, size, output, mask));
+}
+
+template <typename T>
+void FusedDropoutGrad<GPUDevice, T>::operator()(
+    OpKernelContext* ctx, const GPUDevice& d, const T* gradients,
+    const uint8* mask, int64_t size, T* backprops) {
+  GpuLaunchConfig config =
+      GetGpuLaunchConfig(size, d, FusedDropoutGradKernel<T>, 0, 0);
+  TF_CHECK_OK(GpuLaunchKernel(FusedDropoutGradKernel<T>, config.block_count,
+                              config.thread_per_block, 0, d.stream(),
+                              gradients, mask, size, backprops));
+}
+
+#define DEFINE_GPU_KERNELS(T)                 \
+  template struct FusedDropout<GPUDevice, T>; \
+  template struct FusedDropoutGrad<GPUDevice, T>;
+
+TF_CALL_half(DEFINE_GPU_KERNELS);
+TF_CALL_bfloat16(DEFINE_GPU_KERNELS);
+TF_CALL_float(DEFINE_GPU_KERNELS);
+TF_CALL_double(DEFINE_GPU_KERNELS);
+
+#undef DEFINE_GPU_KERNELS
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
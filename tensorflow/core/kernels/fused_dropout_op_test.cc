@@ -0,0 +1,140 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kSeed = 17;
+constexpr int kSeed2 = 42;
+
+class FusedDropoutOpTest : public OpsTestBase {
+ protected:
+  // Runs a _FusedDropout on `size` elements, and checks that it keeps the
+  // same elements as SelectV2(RandomUniform(...) >= rate, ...) with the same
+  // seeds.
+  template <typename T>
+  void RunAndCompare(int64_t size, bool divide) {
+    TF_ASSERT_OK(NodeDefBuilder("dropout", "_FusedDropout")
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))
+                     .Attr("seed", kSeed)
+                     .Attr("seed2", kSeed2)
+                     .Attr("divide", divide)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    std::vector<T> x(size);
+    for (int64_t i = 0; i < size; ++i) x[i] = static_cast<T>(i % 13 - 6);
+    const T scale = static_cast<T>(divide ? 0.7 : 1 / 0.7);
+    const T rate = static_cast<T>(0.3);
+    AddInputFromArray<T>(TensorShape({size}), x);
+    AddInputFromArray<T>(TensorShape({}), {scale});
+    AddInputFromArray<T>(TensorShape({}), {rate});
+    TF_ASSERT_OK(RunOpKernel());
+
+    using Distribution = random::UniformDistribution<random::PhiloxRandom, T>;
+    constexpr int kGroupSize = Distribution::kResultElementCount;
+    const random::PhiloxRandom gen(kSeed, kSeed2);
+    Tensor expected(DataTypeToEnum<T>::v(), TensorShape({size}));
+    Tensor expected_mask(DT_UINT8, TensorShape({(size + 7) / 8}));
+    expected_mask.flat<uint8>().setZero();
+    for (int64_t i = 0; i < size; ++i) {
+      random::PhiloxRandom group_gen = gen;
+      group_gen.Skip(i / kGroupSize);
+      Distribution dist;
+      const bool keep = dist(&group_gen)[i % kGroupSize] >= rate;
+      expected.flat<T>()(i) =
+          keep ? (divide ? x[i] / scale : x[i] * scale) : T(0);
+      expected_mask.flat<uint8>()(i / 8) |= keep << (i % 8);
+    }
+    test::ExpectTensorEqual<T>(expected, *GetOutput(0));
+    test::ExpectTensorEqual<uint8>(expected_mask, *GetOutput(1));
+  }
+};
+
+TEST_F(FusedDropoutOpTest, Float) { RunAndCompare<float>(1003, false); }
+
+TEST_F(FusedDropoutOpTest, FloatDivide) { RunAndCompare<float>(1003, true); }
+
+TEST_F(FusedDropoutOpTest, Double) { RunAndCompare<double>(77, false); }
+
+TEST_F(FusedDropoutOpTest, Half) { RunAndCompare<Eigen::half>(5, false); }
+
+TEST_F(FusedDropoutOpTest, Empty) { RunAndCompare<float>(0, false); }
+
+TEST_F(FusedDropoutOpTest, NewMaskOnEachRun) {
+  TF_ASSERT_OK(NodeDefBuilder("dropout", "_FusedDropout")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("seed", kSeed)
+                   .Attr("seed2", kSeed2)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({256}), std::vector<float>(256, 1));
+  AddInputFromArray<float>(TensorShape({}), {2});
+  AddInputFromArray<float>(TensorShape({}), {0.5});
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor first_mask = *GetOutput(1);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_NE(first_mask.tensor_data(), GetOutput(1)->tensor_data());
+}
+
+class FusedDropoutGradOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("dropout_grad", "_FusedDropoutGrad")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_UINT8))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedDropoutGradOpTest, AppliesMask) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({2, 5}),
+                           {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  AddInputFromArray<uint8>(TensorShape({2}), {0b10100101, 0b10});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1, 0, 3, 0, 0, 6, 0, 8, 0, 10},
+                            TensorShape({2, 5})),
+      *GetOutput(0));
+}
+
+TEST_F(FusedDropoutGradOpTest, ChecksMaskShape) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({9}), std::vector<float>(9, 1));
+  AddInputFromArray<uint8>(TensorShape({1}), {0xff});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,8 +20,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -36,65 +38,16 @@ namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
-namespace generator {
-
-template <typename T, typename Index, int IXDIM>
-class GatherNdSliceGenerator {
- public:
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE GatherNdSliceGenerator(
-      const Index slice_size, typename TTypes<Index>::ConstMatrix Tindices,
-      typename TTypes<T, IXDIM + 1>::ConstTensor Tparams,
-      typename TTypes<T>::Matrix Tout, std::atomic<Index>* error_loc)
-      : slice_size_(slice_size),
-        Tindices_(Tindices),
-        Tparams_(Tparams),
-        Tout_(Tout),
-        error_loc_(error_loc) {}
-
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE bool GenerateIndices(
-      const Index loc, Eigen::array<Eigen::DenseIndex, IXDIM + 1>* ix) const {
-    (*ix)[IXDIM] = 0;
-    bool out_of_bounds = false;
-    for (int i = 0; i < IXDIM; ++i) {
-      const Index ix_i = internal::SubtleMustCopy(Tindices_(loc, i));
-      (*ix)[i] = ix_i;
-      out_of_bounds |= !FastBoundsCheck(ix_i, Tparams_.dimension(i));
-    }
-    return out_of_bounds;
-  }
-
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE int32
-  operator()(const Eigen::array<Eigen::DenseIndex, 1>& loc_array) const {
-    const Index loc = loc_array[0];
-    Eigen::array<Eigen::DenseIndex, IXDIM + 1> ix;
-    Eigen::array<Eigen::DenseIndex, 2> ix_out;
-    ix_out[0] = loc;
-    ix_out[1] = 0;
-    const bool out_of_bounds = GenerateIndices(loc, &ix);
-    if (TF_PREDICT_FALSE(out_of_bounds)) {
-      error_loc_->store(loc);
-      std::fill_n(&Tout_(ix_out), slice_size_, T());
-    } else {
-      std::copy_n(&Tparams_(ix), slice_size_, &Tout_(ix_out));
-    }
-
-    return static_cast<int32>(0);  // Return something...
-  }
-
- private:
-  const Index slice_size_;
-  const typename TTypes<Index>::ConstMatrix Tindices_;
-  const typename TTypes<T, IXDIM + 1>::ConstTensor Tparams_;
-  mutable typename TTypes<T>::Matrix Tout_;
-  std::atomic<Index>* error_loc_;
-};
-
-}  // namespace generator
-
 namespace functor {
 
 template <typename T, typename Index, int IXDIM>
 struct GatherNdSlice<CPUDevice, T, Index, IXDIM> {
+  // Slices are gathered in blocks of this many indices.
+  static constexpr Eigen::Index kBlockSize = 16;
+  // At most this many bytes of every slice of the next block are prefetched.
+  static constexpr Eigen::Index kMaxPrefetchBytes = 256;
+  static constexpr Eigen::Index kCacheLineBytes = 64;
+
   Index operator()(const CPUDevice& d, const Index slice_size,
                    typename TTypes<int32>::Scalar Tscratch,
                    typename TTypes<T, IXDIM + 1>::ConstTensor Tparams,
@@ -102,13 +55,79 @@ struct GatherNdSlice<CPUDevice, T, Index, IXDIM> {
                    typename TTypes<T>::Matrix Tout) {
     std::atomic<Index> error_loc(-1);
     const Eigen::Index batch_size = Tindices.dimension(0);
-    generator::GatherNdSliceGenerator<T, Index, IXDIM> gather_nd_generator(
-        slice_size, Tindices, Tparams, Tout, &error_loc);
+
+    // Offset in `Tparams` of a step along every indexed dimension.
+    Eigen::array<Eigen::Index, IXDIM> strides;
+    Eigen::Index stride = Tparams.dimension(IXDIM);
+    for (int i = IXDIM - 1; i >= 0; --i) {
+      strides[i] = stride;
+      stride *= Tparams.dimension(i);
+    }
+    const T* params = Tparams.data();
+    const Eigen::Index prefetch_bytes =
+        std::min<Eigen::Index>(slice_size * sizeof(T), kMaxPrefetchBytes);
+
+    // Computes the offsets in `Tparams` of the slices of the block starting
+    // at `begin`, or -1 for an index out of bounds, and prefetches them.
+    auto compute_offsets = [&](Eigen::Index begin, Eigen::Index end,
+                               Eigen::Index* offsets) {
+      for (Eigen::Index loc = begin; loc < end; ++loc) {
+        Eigen::Index offset = 0;
+        bool out_of_bounds = false;
+        for (int i = 0; i < IXDIM; ++i) {
+          const Index ix_i = internal::SubtleMustCopy(Tindices(loc, i));
+          out_of_bounds |= !FastBoundsCheck(ix_i, Tparams.dimension(i));
+          offset += ix_i * strides[i];
+        }
+        offsets[loc - begin] = out_of_bounds ? -1 : offset;
+      }
+      for (Eigen::Index j = 0; j < end - begin; ++j) {
+        if (offsets[j] < 0) continue;
+        const char* slice = reinterpret_cast<const char*>(params + offsets[j]);
+        for (Eigen::Index byte = 0; byte < prefetch_bytes;
+             byte += kCacheLineBytes) {
+          absl::PrefetchToLocalCache(slice + byte);
+        }
+      }
+    };
+
+    // Copies the slices of a block, merging the slices that are adjacent in
+    // `Tparams` into a single copy.
+    auto copy_slices = [&](Eigen::Index begin, Eigen::Index end,
+                           const Eigen::Index* offsets) {
+      for (Eigen::Index j = 0; j < end - begin;) {
+        T* out = &Tout(begin + j, 0);
+        if (TF_PREDICT_FALSE(offsets[j] < 0)) {
+          error_loc.store(begin + j);
+          std::fill_n(out, slice_size, T());
+          ++j;
+          continue;
+        }
+        Eigen::Index run_end = j + 1;
+        while (run_end < end - begin &&
+               offsets[run_end] == offsets[run_end - 1] + slice_size) {
+          ++run_end;
+        }
+        std::copy_n(params + offsets[j], (run_end - j) * slice_size, out);
+        j = run_end;
+      }
+    };
 
     auto compute_shard = [&](Eigen::Index begin, Eigen::Index end) {
-      for (Eigen::Index i = begin; i < end; ++i) {
-        const Eigen::array<Eigen::Index, 1> loc{i};
-        gather_nd_generator(loc);
+      Eigen::Index offsets[kBlockSize];
+      Eigen::Index next_offsets[kBlockSize];
+      Eigen::Index block_end = std::min(begin + kBlockSize, end);
+      compute_offsets(begin, block_end, offsets);
+      for (Eigen::Index block = begin; block < end;) {
+        // The slices of the next block are loaded while the current one is
+        // copied.
+        const Eigen::Index next_block_end =
+            std::min(block_end + kBlockSize, end);
+        compute_offsets(block_end, next_block_end, next_offsets);
+        copy_slices(block, block_end, offsets);
+        std::copy_n(next_offsets, next_block_end - block_end, offsets);
+        block = block_end;
+        block_end = next_block_end;
       }
     };
     Eigen::Index bytes_moved = sizeof(T) * (slice_size + IXDIM);
@@ -0,0 +1,148 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/hot_row_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+uint64_t Mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+int64_t SketchWidth(int64_t capacity) {
+  int64_t width = 64;
+  while (width < 4 * capacity) width *= 2;
+  return width;
+}
+
+}  // namespace
+
+HotRowCache::HotRowCache(int64_t capacity, int64_t row_bytes)
+    : capacity_(capacity),
+      row_bytes_(row_bytes),
+      sketch_width_(SketchWidth(capacity)),
+      sketch_sample_size_(std::max<int64_t>(10 * capacity, 1024)),
+      sketch_(kSketchDepth * sketch_width_) {
+  rows_.resize(capacity * row_bytes);
+  slot_ids_.reserve(capacity);
+  slots_.reserve(capacity);
+}
+
+int64_t HotRowCache::SketchIndex(int64_t id, int row) const {
+  const uint64_t hash = Mix(static_cast<uint64_t>(id) + Mix(row));
+  return row * sketch_width_ + (hash & (sketch_width_ - 1));
+}
+
+uint32_t HotRowCache::EstimateFrequency(int64_t id) const {
+  uint32_t frequency = std::numeric_limits<uint32_t>::max();
+  for (int row = 0; row < kSketchDepth; ++row) {
+    frequency = std::min(frequency, sketch_[SketchIndex(id, row)]);
+  }
+  return frequency;
+}
+
+void HotRowCache::Lookup(absl::Span<const int64_t> ids, char* rows,
+                         std::vector<int64_t>* misses) const {
+  tf_shared_lock l(mu_);
+  for (int64_t i = 0; i < ids.size(); ++i) {
+    auto it = slots_.find(ids[i]);
+    if (it == slots_.end()) {
+      misses->push_back(i);
+      continue;
+    }
+    std::memcpy(rows + i * row_bytes_, rows_.data() + it->second * row_bytes_,
+                row_bytes_);
+  }
+}
+
+void HotRowCache::RecordAccesses(absl::Span<const int64_t> ids) {
+  for (const int64_t id : ids) {
+    for (int row = 0; row < kSketchDepth; ++row) {
+      ++sketch_[SketchIndex(id, row)];
+    }
+  }
+  num_accesses_ += ids.size();
+  if (num_accesses_ < sketch_sample_size_) return;
+  for (uint32_t& counter : sketch_) counter /= 2;
+  num_accesses_ = 0;
+}
+
+void HotRowCache::Update(absl::Span<const int64_t> ids,
+                         absl::Span<const int64_t> misses,
+                         const std::function<const char*(int64_t)>& get_row) {
+  if (misses.empty() || capacity_ == 0) {
+    mutex_lock l(sketch_mu_);
+    RecordAccesses(ids);
+    return;
+  }
+  mutex_lock l(mu_);
+  mutex_lock sketch_lock(sketch_mu_);
+  RecordAccesses(ids);
+  Admit(ids, misses, get_row);
+}
+
+void HotRowCache::Admit(absl::Span<const int64_t> ids,
+                        absl::Span<const int64_t> misses,
+                        const std::function<const char*(int64_t)>& get_row) {
+  for (const int64_t miss : misses) {
+    const int64_t id = ids[miss];
+    if (slots_.contains(id)) continue;
+    int64_t slot;
+    if (slot_ids_.size() < capacity_) {
+      slot = slot_ids_.size();
+      slot_ids_.push_back(id);
+    } else {
+      // Samples a few cached rows and picks the least frequent as victim.
+      int64_t victim = -1;
+      uint32_t victim_frequency = std::numeric_limits<uint32_t>::max();
+      for (int i = 0; i < kEvictionSamples; ++i) {
+        rng_state_ = Mix(rng_state_);
+        const int64_t candidate = rng_state_ % capacity_;
+        const uint32_t frequency = EstimateFrequency(slot_ids_[candidate]);
+        if (frequency < victim_frequency) {
+          victim = candidate;
+          victim_frequency = frequency;
+        }
+      }
+      if (EstimateFrequency(id) <= victim_frequency) continue;
+      slots_.erase(slot_ids_[victim]);
+      slot = victim;
+      slot_ids_[slot] = id;
+    }
+    slots_[id] = slot;
+    std::memcpy(rows_.data() + slot * row_bytes_, get_row(id), row_bytes_);
+  }
+}
+
+int64_t HotRowCache::size() const {
+  tf_shared_lock l(mu_);
+  return slot_ids_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_HOT_ROW_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_HOT_ROW_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Copies of the most frequently read rows of a large embedding table, kept
+// together in one contiguous buffer so that lookups of hot ids hit a few
+// cache lines and pages instead of being spread over the whole table.
+//
+// The access frequency of every id, cached or not, is estimated with a
+// count-min sketch whose counters are halved periodically, so that the
+// estimates follow changes of the distribution. When the cache is full, a
+// missed id is only admitted if it is more frequent than the least frequent
+// of a few sampled cached rows, which it then evicts (TinyLFU admission).
+//
+// Lookups only take a shared lock, once per batch of ids. The accesses are
+// recorded in the sketch, and the misses admitted, once per batch afterwards.
+//
+// The cached rows are copies: the cache must be cleared whenever the table is
+// written.
+class HotRowCache {
+ public:
+  HotRowCache(int64_t capacity, int64_t row_bytes);
+
+  // Copies the cached row of every `ids[i]` to `rows + i * row_bytes()`, and
+  // appends the positions `i` of the ids that are not cached to `misses`. Can
+  // be called concurrently.
+  void Lookup(absl::Span<const int64_t> ids, char* rows,
+              std::vector<int64_t>* misses) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Records one access to each of `ids`, and offers the rows of the ids at
+  // the positions `misses` in `ids`, which missed the cache as reported by
+  // `Lookup()`, for admission. `get_row` returns the row of an id in the
+  // table.
+  void Update(absl::Span<const int64_t> ids, absl::Span<const int64_t> misses,
+              const std::function<const char*(int64_t)>& get_row)
+      TF_LOCKS_EXCLUDED(mu_, sketch_mu_);
+
+  int64_t size() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t capacity() const { return capacity_; }
+  int64_t row_bytes() const { return row_bytes_; }
+
+ private:
+  static constexpr int kSketchDepth = 4;
+  static constexpr int kEvictionSamples = 8;
+
+  int64_t SketchIndex(int64_t id, int row) const;
+  uint32_t EstimateFrequency(int64_t id) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(sketch_mu_);
+  void RecordAccesses(absl::Span<const int64_t> ids)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(sketch_mu_);
+  void Admit(absl::Span<const int64_t> ids, absl::Span<const int64_t> misses,
+             const std::function<const char*(int64_t)>& get_row)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_, sketch_mu_);
+
+  const int64_t capacity_;
+  const int64_t row_bytes_;
+  const int64_t sketch_width_;
+  // Number of recorded accesses after which the sketch counters are halved.
+  const int64_t sketch_sample_size_;
+
+  // Guards the cached rows. Taken before `sketch_mu_`.
+  mutable mutex mu_;
+  // Guards the frequency sketch. Batches without misses only take this lock,
+  // so they don't block the lookups.
+  mutex sketch_mu_ TF_ACQUIRED_AFTER(mu_);
+  std::vector<uint32_t> sketch_ TF_GUARDED_BY(sketch_mu_);
+  int64_t num_accesses_ TF_GUARDED_BY(sketch_mu_) = 0;
+
+  std::vector<char> rows_ TF_GUARDED_BY(mu_);
+  std::vector<int64_t> slot_ids_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64_t, int64_t> slots_ TF_GUARDED_BY(mu_);
+  uint64_t rng_state_ TF_GUARDED_BY(mu_) = 0x9e3779b97f4a7c15ULL;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_HOT_ROW_CACHE_H_
@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/hot_row_cache.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kDim = 4;
+
+// Row `id` of a fake table is {id, id, id, id}.
+class FakeTable {
+ public:
+  explicit FakeTable(int num_rows) : rows_(num_rows * kDim) {
+    for (int i = 0; i < rows_.size(); ++i) rows_[i] = i / kDim;
+  }
+  const char* Row(int64_t id) const {
+    return reinterpret_cast<const char*>(rows_.data() + id * kDim);
+  }
+
+ private:
+  std::vector<float> rows_;
+};
+
+// Looks `id` up in `cache`, and offers it for admission on a miss.
+bool LookupOrAdmit(HotRowCache* cache, const FakeTable& table, int64_t id) {
+  float row[kDim];
+  const int64_t ids[] = {id};
+  std::vector<int64_t> misses;
+  cache->Lookup(ids, reinterpret_cast<char*>(row), &misses);
+  if (!misses.empty()) {
+    cache->Update(ids, misses, [&](int64_t id) { return table.Row(id); });
+    return false;
+  }
+  cache->Update(ids, {}, [&](int64_t id) { return table.Row(id); });
+  for (int i = 0; i < kDim; ++i) EXPECT_EQ(row[i], id);
+  return true;
+}
+
+TEST(HotRowCacheTest, HitsAfterAdmission) {
+  FakeTable table(10);
+  HotRowCache cache(/*capacity=*/4, /*row_bytes=*/kDim * sizeof(float));
+  EXPECT_FALSE(LookupOrAdmit(&cache, table, 3));
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 3));
+  EXPECT_FALSE(LookupOrAdmit(&cache, table, 7));
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 7));
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 3));
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(HotRowCacheTest, FrequentRowsAreKept) {
+  FakeTable table(100);
+  HotRowCache cache(/*capacity=*/2, /*row_bytes=*/kDim * sizeof(float));
+  for (int i = 0; i < 10; ++i) {
+    LookupOrAdmit(&cache, table, 1);
+    LookupOrAdmit(&cache, table, 2);
+  }
+  // Rows read once don't evict the frequent ones.
+  for (int id = 10; id < 50; ++id) {
+    EXPECT_FALSE(LookupOrAdmit(&cache, table, id));
+  }
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 1));
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 2));
+
+  // A row that becomes the most frequent is admitted.
+  for (int i = 0; i < 30; ++i) LookupOrAdmit(&cache, table, 5);
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 5));
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(HotRowCacheTest, LooksUpBatches) {
+  FakeTable table(10);
+  HotRowCache cache(/*capacity=*/4, /*row_bytes=*/kDim * sizeof(float));
+  EXPECT_FALSE(LookupOrAdmit(&cache, table, 2));
+  EXPECT_FALSE(LookupOrAdmit(&cache, table, 6));
+
+  const std::vector<int64_t> ids = {6, 1, 2, 1};
+  std::vector<float> rows(ids.size() * kDim, -1);
+  std::vector<int64_t> misses;
+  cache.Lookup(ids, reinterpret_cast<char*>(rows.data()), &misses);
+  EXPECT_EQ(misses, std::vector<int64_t>({1, 3}));
+  // Only the rows of the hits are written.
+  EXPECT_EQ(rows, std::vector<float>({6, 6, 6, 6, -1, -1, -1, -1,  //
+                                      2, 2, 2, 2, -1, -1, -1, -1}));
+
+  cache.Update(ids, misses, [&](int64_t id) { return table.Row(id); });
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_TRUE(LookupOrAdmit(&cache, table, 1));
+}
+
+TEST(HotRowCacheTest, ZeroCapacity) {
+  FakeTable table(10);
+  HotRowCache cache(/*capacity=*/0, /*row_bytes=*/kDim * sizeof(float));
+  EXPECT_FALSE(LookupOrAdmit(&cache, table, 1));
+  EXPECT_FALSE(LookupOrAdmit(&cache, table, 1));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
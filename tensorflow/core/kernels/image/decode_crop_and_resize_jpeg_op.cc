@@ -0,0 +1,209 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image/resize_bilinear_op.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the largest DCT scaling denominator supported by libjpeg which
+// still decodes the crop window to at least the output size, so the resize
+// never upsamples what a full decode would have downsampled.
+int ChooseRatio(int64_t crop_height, int64_t crop_width, int64_t out_height,
+                int64_t out_width) {
+  for (int ratio : {8, 4, 2}) {
+    if (crop_height / ratio >= out_height && crop_width / ratio >= out_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// Returns `x / ratio` rounded up.
+int64_t CeilDiv(int64_t x, int ratio) { return (x + ratio - 1) / ratio; }
+
+// Decodes the crop window of a JPEG image at the coarsest DCT scale which is
+// not smaller than the output size, and resizes the decoded crop bilinearly.
+// This is equivalent to `DecodeAndCropJpeg` followed by `ResizeBilinear`, up
+// to the difference between DCT and bilinear downscaling, but never
+// materializes the full-resolution crop.
+class DecodeCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // Same default as `DecodeAndCropJpeg`.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+    flags_.crop = true;
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(context, context->GetAttr("half_pixel_centers",
+                                             &half_pixel_centers_));
+    OP_REQUIRES(
+        context, !half_pixel_centers_ || !align_corners_,
+        errors::InvalidArgument("If half_pixel_centers is True, "
+                                "align_corners must be False."));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, !input.empty(),
+                errors::InvalidArgument("Input is empty."));
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument(
+                    "Input contents are too large for int: ", input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must be 1-D with four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument(
+                    "size must be 1-D with two elements, got shape ",
+                    size.shape().DebugString()));
+    auto crop_window_vec = crop_window.vec<int32>();
+    const int64_t crop_y = crop_window_vec(0);
+    const int64_t crop_x = crop_window_vec(1);
+    const int64_t crop_height = crop_window_vec(2);
+    const int64_t crop_width = crop_window_vec(3);
+    const int64_t out_height = size.vec<int32>()(0);
+    const int64_t out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int width, height;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   /*components=*/nullptr),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(context,
+                crop_height > 0 && crop_width > 0 && crop_y >= 0 &&
+                    crop_x >= 0 && crop_y + crop_height <= height &&
+                    crop_x + crop_width <= width,
+                errors::InvalidArgument("Invalid crop window: y=", crop_y,
+                                        ", x=", crop_x, ", h=", crop_height,
+                                        ", w=", crop_width, " for image of ",
+                                        height, "x", width));
+
+    // libjpeg crops in the coordinates of the scaled image, whose size is
+    // rounded up. Scale the crop window outward so that it still covers the
+    // requested window.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ChooseRatio(crop_height, crop_width, out_height, out_width);
+    const int64_t scaled_height = CeilDiv(height, flags.ratio);
+    const int64_t scaled_width = CeilDiv(width, flags.ratio);
+    flags.crop_y = crop_y / flags.ratio;
+    flags.crop_x = crop_x / flags.ratio;
+    flags.crop_height =
+        std::min(CeilDiv(crop_y + crop_height, flags.ratio), scaled_height) -
+        flags.crop_y;
+    flags.crop_width =
+        std::min(CeilDiv(crop_x + crop_width, flags.ratio), scaled_width) -
+        flags.crop_x;
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, /*nwarn=*/nullptr,
+        [&](int width, int height, int channels) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({1, height, width, channels}), &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(
+        context, buffer,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+
+    const int64_t decoded_height = decoded.dim_size(1);
+    const int64_t decoded_width = decoded.dim_size(2);
+    const int64_t channels = decoded.dim_size(3);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+    functor::ResizeBilinearUint8OnCpu(
+        context->eigen_device<Eigen::ThreadPoolDevice>(),
+        decoded.tensor<uint8, 4>(),
+        CalculateResizeScale(decoded_height, out_height, align_corners_),
+        CalculateResizeScale(decoded_width, out_width, align_corners_),
+        half_pixel_centers_,
+        output->shaped<float, 4>({1, out_height, out_width, channels}));
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+  int channels_;
+  bool align_corners_;
+  bool half_pixel_centers_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
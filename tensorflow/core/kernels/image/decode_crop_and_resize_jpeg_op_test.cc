@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class DecodeCropAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("decode_op", "DecodeCropAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", 3)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Returns a JPEG-encoded RGB image of a single color.
+  static tstring SolidJpeg(int width, int height, uint8 value) {
+    std::vector<uint8> pixels(width * height * 3, value);
+    jpeg::CompressFlags flags;
+    flags.format = jpeg::FORMAT_RGB;
+    flags.quality = 100;
+    return jpeg::Compress(pixels.data(), width, height, flags);
+  }
+};
+
+TEST_F(DecodeCropAndResizeJpegOpTest, DownscalesCrop) {
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {SolidJpeg(64, 64, 128)});
+  AddInputFromArray<int32>(TensorShape({4}), {8, 8, 48, 48});
+  AddInputFromArray<int32>(TensorShape({2}), {10, 12});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& output = *GetOutput(0);
+  EXPECT_EQ(output.shape(), TensorShape({10, 12, 3}));
+  auto values = output.flat<float>();
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_NEAR(values(i), 128, 2);
+  }
+}
+
+TEST_F(DecodeCropAndResizeJpegOpTest, UpscalesSmallCrop) {
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {SolidJpeg(16, 16, 64)});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 8, 8});
+  AddInputFromArray<int32>(TensorShape({2}), {32, 32});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& output = *GetOutput(0);
+  EXPECT_EQ(output.shape(), TensorShape({32, 32, 3}));
+  auto values = output.flat<float>();
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_NEAR(values(i), 64, 2);
+  }
+}
+
+TEST_F(DecodeCropAndResizeJpegOpTest, FailsForInvalidCropWindow) {
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {SolidJpeg(16, 16, 64)});
+  AddInputFromArray<int32>(TensorShape({4}), {8, 8, 16, 16});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,10 +19,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/image/non_max_suppression_op.h"
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 #include <limits>
 #include <queue>
+#include <type_traits>
 #include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -192,6 +194,43 @@ static inline std::function<T(int, int)> CreateOverlapSimilarityFn(
                    std::placeholders::_2);
 }
 
+// Allocates the outputs of the NMS ops for the indices and scores of the
+// selected boxes, padding them to `output_size` if requested.
+template <typename T>
+void SetNonMaxSuppressionOutputs(OpKernelContext* context, int output_size,
+                                 bool return_scores_tensor,
+                                 bool pad_to_max_output_size,
+                                 int* ptr_num_valid_outputs,
+                                 std::vector<int>* selected,
+                                 std::vector<T>* selected_scores) {
+  int num_valid_outputs = selected->size();
+  if (pad_to_max_output_size) {
+    selected->resize(output_size, 0);
+    selected_scores->resize(output_size, static_cast<T>(0));
+  }
+  if (ptr_num_valid_outputs) {
+    *ptr_num_valid_outputs = num_valid_outputs;
+  }
+
+  // Allocate output tensors
+  Tensor* output_indices = nullptr;
+  TensorShape output_shape({static_cast<int>(selected->size())});
+  OP_REQUIRES_OK(context,
+                 context->allocate_output(0, output_shape, &output_indices));
+  TTypes<int, 1>::Tensor output_indices_data = output_indices->tensor<int, 1>();
+  std::copy_n(selected->begin(), selected->size(), output_indices_data.data());
+
+  if (return_scores_tensor) {
+    Tensor* output_scores = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, output_shape, &output_scores));
+    typename TTypes<T, 1>::Tensor output_scores_data =
+        output_scores->tensor<T, 1>();
+    std::copy_n(selected_scores->begin(), selected_scores->size(),
+                output_scores_data.data());
+  }
+}
+
 template <typename T>
 void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& scores,
                            int num_boxes, const Tensor& max_output_size,
@@ -302,32 +341,119 @@ void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& scores,
     }
   }
 
-  int num_valid_outputs = selected.size();
-  if (pad_to_max_output_size) {
-    selected.resize(output_size, 0);
-    selected_scores.resize(output_size, static_cast<T>(0));
+  SetNonMaxSuppressionOutputs(context, output_size, return_scores_tensor,
+                              pad_to_max_output_size, ptr_num_valid_outputs,
+                              &selected, &selected_scores);
+}
+
+// Greedy hard NMS with IOU similarity on float boxes, computing the same
+// selection as `DoNonMaxSuppressionOp`. The candidates are sorted by score and
+// their coordinates stored in score order, so that each selected box
+// suppresses all the remaining candidates in one vectorized pass, instead of
+// each candidate being compared with the selected boxes one pair at a time.
+void DoHardIOUNonMaxSuppressionOp(OpKernelContext* context,
+                                  const Tensor& boxes, const Tensor& scores,
+                                  int num_boxes, const Tensor& max_output_size,
+                                  const float iou_threshold,
+                                  const float score_threshold,
+                                  bool return_scores_tensor,
+                                  bool pad_to_max_output_size,
+                                  int* ptr_num_valid_outputs) {
+  const int output_size = max_output_size.scalar<int>()();
+  OP_REQUIRES(context, output_size >= 0,
+              errors::InvalidArgument("output size must be non-negative"));
+
+  TTypes<float, 2>::ConstTensor boxes_data = boxes.tensor<float, 2>();
+  const float* scores_data = scores.flat<float>().data();
+  // Candidates in the order of the priority queue of `DoNonMaxSuppressionOp`.
+  std::vector<int> candidates;
+  for (int i = 0; i < num_boxes; ++i) {
+    if (scores_data[i] > score_threshold) candidates.push_back(i);
   }
-  if (ptr_num_valid_outputs) {
-    *ptr_num_valid_outputs = num_valid_outputs;
+  std::sort(candidates.begin(), candidates.end(), [&](int i, int j) {
+    return scores_data[i] > scores_data[j] ||
+           (scores_data[i] == scores_data[j] && i < j);
+  });
+
+  const int num_candidates = candidates.size();
+  Eigen::ArrayXf ymin(num_candidates), xmin(num_candidates),
+      ymax(num_candidates), xmax(num_candidates);
+  for (int k = 0; k < num_candidates; ++k) {
+    const int i = candidates[k];
+    ymin(k) = Eigen::numext::mini(boxes_data(i, 0), boxes_data(i, 2));
+    xmin(k) = Eigen::numext::mini(boxes_data(i, 1), boxes_data(i, 3));
+    ymax(k) = Eigen::numext::maxi(boxes_data(i, 0), boxes_data(i, 2));
+    xmax(k) = Eigen::numext::maxi(boxes_data(i, 1), boxes_data(i, 3));
   }
+  const Eigen::ArrayXf area = (ymax - ymin) * (xmax - xmin);
+  Eigen::Array<bool, Eigen::Dynamic, 1> suppressed =
+      Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(num_candidates, false);
 
-  // Allocate output tensors
-  Tensor* output_indices = nullptr;
-  TensorShape output_shape({static_cast<int>(selected.size())});
-  OP_REQUIRES_OK(context,
-                 context->allocate_output(0, output_shape, &output_indices));
-  TTypes<int, 1>::Tensor output_indices_data = output_indices->tensor<int, 1>();
-  std::copy_n(selected.begin(), selected.size(), output_indices_data.data());
+  std::vector<int> selected;
+  std::vector<float> selected_scores;
+  for (int k = 0; k < num_candidates && selected.size() < output_size; ++k) {
+    if (suppressed(k)) continue;
+    selected.push_back(candidates[k]);
+    selected_scores.push_back(scores_data[candidates[k]]);
+
+    const int begin = k + 1;
+    const int size = num_candidates - begin;
+    if (size == 0) break;
+    // `IOU` is 0 if either box is empty.
+    if (area(k) <= 0) {
+      if (0.0f > iou_threshold) suppressed.tail(size).setConstant(true);
+      continue;
+    }
+    const Eigen::ArrayXf intersection =
+        (ymax.segment(begin, size).min(ymax(k)) -
+         ymin.segment(begin, size).max(ymin(k)))
+            .max(0.0f) *
+        (xmax.segment(begin, size).min(xmax(k)) -
+         xmin.segment(begin, size).max(xmin(k)))
+            .max(0.0f);
+    const Eigen::ArrayXf iou =
+        (area.segment(begin, size) > 0.0f)
+            .select(intersection /
+                        (area(k) + area.segment(begin, size) - intersection),
+                    0.0f);
+    suppressed.segment(begin, size) =
+        suppressed.segment(begin, size) || (iou > iou_threshold);
+  }
 
-  if (return_scores_tensor) {
-    Tensor* output_scores = nullptr;
-    OP_REQUIRES_OK(context,
-                   context->allocate_output(1, output_shape, &output_scores));
-    typename TTypes<T, 1>::Tensor output_scores_data =
-        output_scores->tensor<T, 1>();
-    std::copy_n(selected_scores.begin(), selected_scores.size(),
-                output_scores_data.data());
+  SetNonMaxSuppressionOutputs(context, output_size, return_scores_tensor,
+                              pad_to_max_output_size, ptr_num_valid_outputs,
+                              &selected, &selected_scores);
+}
+
+// Runs `DoNonMaxSuppressionOp` with IOU similarity, taking the vectorized path
+// for hard NMS on finite float boxes.
+template <typename T>
+void DoIOUNonMaxSuppressionOp(OpKernelContext* context, const Tensor& boxes,
+                              const Tensor& scores, int num_boxes,
+                              const Tensor& max_output_size,
+                              const T iou_threshold, const T score_threshold,
+                              const T soft_nms_sigma,
+                              bool return_scores_tensor = false,
+                              bool pad_to_max_output_size = false,
+                              int* ptr_num_valid_outputs = nullptr) {
+  // Non-finite coordinates give NaN similarities, which the generic path
+  // handles like a soft suppression.
+  const auto is_finite = [](const T x) { return Eigen::numext::isfinite(x); };
+  if (std::is_same<T, float>::value &&
+      soft_nms_sigma == static_cast<T>(0.0) &&
+      std::all_of(boxes.flat<T>().data(),
+                  boxes.flat<T>().data() + boxes.NumElements(), is_finite)) {
+    DoHardIOUNonMaxSuppressionOp(
+        context, boxes, scores, num_boxes, max_output_size,
+        static_cast<float>(iou_threshold), static_cast<float>(score_threshold),
+        return_scores_tensor, pad_to_max_output_size, ptr_num_valid_outputs);
+    return;
   }
+  DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
+                           iou_threshold, score_threshold, soft_nms_sigma,
+                           CreateIOUSimilarityFn<T>(boxes),
+                           return_scores_tensor, pad_to_max_output_size,
+                           ptr_num_valid_outputs);
 }
 
 struct ResultCandidate {
@@ -648,13 +774,11 @@ class NonMaxSuppressionOp : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto similarity_fn = CreateIOUSimilarityFn<float>(boxes);
-
     const float score_threshold_val = std::numeric_limits<float>::lowest();
     const float dummy_soft_nms_sigma = static_cast<float>(0.0);
-    DoNonMaxSuppressionOp<float>(context, scores, num_boxes, max_output_size,
-                                 iou_threshold_, score_threshold_val,
-                                 dummy_soft_nms_sigma, similarity_fn);
+    DoIOUNonMaxSuppressionOp<float>(context, boxes, scores, num_boxes,
+                                    max_output_size, iou_threshold_,
+                                    score_threshold_val, dummy_soft_nms_sigma);
   }
 
  private:
@@ -695,13 +819,11 @@ class NonMaxSuppressionV2Op : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
-
     const T score_threshold_val = std::numeric_limits<T>::lowest();
     const T dummy_soft_nms_sigma = static_cast<T>(0.0);
-    DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             iou_threshold_val, score_threshold_val,
-                             dummy_soft_nms_sigma, similarity_fn);
+    DoIOUNonMaxSuppressionOp<T>(context, boxes, scores, num_boxes,
+                                max_output_size, iou_threshold_val,
+                                score_threshold_val, dummy_soft_nms_sigma);
   }
 };
 
@@ -751,12 +873,10 @@ class NonMaxSuppressionV3Op : public OpKernel {
       return;
     }
 
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
-
     const T dummy_soft_nms_sigma = static_cast<T>(0.0);
-    DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             iou_threshold_val, score_threshold_val,
-                             dummy_soft_nms_sigma, similarity_fn);
+    DoIOUNonMaxSuppressionOp<T>(context, boxes, scores, num_boxes,
+                                max_output_size, iou_threshold_val,
+                                score_threshold_val, dummy_soft_nms_sigma);
   }
 };
 
@@ -805,15 +925,14 @@ class NonMaxSuppressionV4Op : public OpKernel {
       return;
     }
 
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
     int num_valid_outputs;
 
     bool return_scores_tensor_ = false;
     const T dummy_soft_nms_sigma = static_cast<T>(0.0);
-    DoNonMaxSuppressionOp<T>(
-        context, scores, num_boxes, max_output_size, iou_threshold_val,
-        score_threshold_val, dummy_soft_nms_sigma, similarity_fn,
-        return_scores_tensor_, pad_to_max_output_size_, &num_valid_outputs);
+    DoIOUNonMaxSuppressionOp<T>(
+        context, boxes, scores, num_boxes, max_output_size, iou_threshold_val,
+        score_threshold_val, dummy_soft_nms_sigma, return_scores_tensor_,
+        pad_to_max_output_size_, &num_valid_outputs);
     if (!context->status().ok()) {
       return;
     }
@@ -884,16 +1003,15 @@ class NonMaxSuppressionV5Op : public OpKernel {
       return;
     }
 
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
     int num_valid_outputs;
 
     // For NonMaxSuppressionV5Op, we always return a second output holding
     // corresponding scores, so `return_scores_tensor` should never be false.
     const bool return_scores_tensor_ = true;
-    DoNonMaxSuppressionOp<T>(
-        context, scores, num_boxes, max_output_size, iou_threshold_val,
-        score_threshold_val, soft_nms_sigma_val, similarity_fn,
-        return_scores_tensor_, pad_to_max_output_size_, &num_valid_outputs);
+    DoIOUNonMaxSuppressionOp<T>(
+        context, boxes, scores, num_boxes, max_output_size, iou_threshold_val,
+        score_threshold_val, soft_nms_sigma_val, return_scores_tensor_,
+        pad_to_max_output_size_, &num_valid_outputs);
     if (!context->status().ok()) {
       return;
     }
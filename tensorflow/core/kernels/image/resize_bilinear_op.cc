@@ -27,6 +27,8 @@ limitations under the License.
 #endif
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
@@ -105,51 +107,21 @@ inline void compute_interpolation_weights(const Scaler scaler,
   }
 }
 
-/**
- * Computes the bilinear interpolation from the appropriate 4 float points
- * and the linear interpolation weights.
- */
-inline float compute_lerp(const float top_left, const float top_right,
-                          const float bottom_left, const float bottom_right,
-                          const float x_lerp, const float y_lerp) {
-  const float top = top_left + (top_right - top_left) * x_lerp;
-  const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
-  return top + (bottom - top) * y_lerp;
-}
-
-#ifdef __SSE4_1__
-/* Vector version of the above */
-inline __m128 compute_lerp_v(const __m128 top_left, const __m128 top_right,
-                             const __m128 bottom_left,
-                             const __m128 bottom_right, const __m128 x_lerp,
-                             const __m128 y_lerp) {
-  const __m128 top =
-      _mm_add_ps(top_left, _mm_mul_ps(_mm_sub_ps(top_right, top_left), x_lerp));
-  const __m128 bottom = _mm_add_ps(
-      bottom_left, _mm_mul_ps(_mm_sub_ps(bottom_right, bottom_left), x_lerp));
-  return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), y_lerp));
-}
-#endif
-
+// Interpolates the input row `input` along the x dimension.
 template <typename T>
-void ResizeLineChannels(const T* const ys_input_lower_ptr,
-                        const T* const ys_input_upper_ptr,
-                        const CachedInterpolation* const xs,
-                        const float ys_lerp, const int64_t out_width,
-                        float* out_y, const int channels) {
+void ResizeRowChannels(const T* const input,
+                       const CachedInterpolation* const xs,
+                       const int64_t out_width, const int channels,
+                       float* out_row) {
   for (int64_t x = 0; x < out_width; ++x) {
     const int64_t xs_lower = xs[x].lower;
     const int64_t xs_upper = xs[x].upper;
     const float xs_lerp = xs[x].lerp;
 
     for (int c = 0; c < channels; ++c) {
-      const float top_left(ys_input_lower_ptr[xs_lower + c]);
-      const float top_right(ys_input_lower_ptr[xs_upper + c]);
-      const float bottom_left(ys_input_upper_ptr[xs_lower + c]);
-      const float bottom_right(ys_input_upper_ptr[xs_upper + c]);
-
-      out_y[x * channels + c] = compute_lerp(top_left, top_right, bottom_left,
-                                             bottom_right, xs_lerp, ys_lerp);
+      const float left(input[xs_lower + c]);
+      const float right(input[xs_upper + c]);
+      out_row[x * channels + c] = left + (right - left) * xs_lerp;
     }
   }
 }
@@ -171,46 +143,56 @@ inline __m128 load_3xfloat_v(float* values) {
 }
 
 template <typename T>
-void ResizeLine3ChannelsVector(const T* const ys_input_lower_ptr,
-                               const T* const ys_input_upper_ptr,
-                               const CachedInterpolation* const xs,
-                               const float ys_lerp, const int64_t out_width,
-                               float* out_y) {
-  const __m128 ys_lerp_v = _mm_set1_ps(ys_lerp);
+void ResizeRow3ChannelsVector(const T* const input,
+                              const CachedInterpolation* const xs,
+                              const int64_t out_width, float* out_row) {
   // All pixels but the last one can overflow, vectorize the inside of the
   // row.
   int64_t x = 0;
   for (x = 0; x < out_width - 1; ++x) {
-    const int64_t xs_lower = xs[x].lower;
-    const int64_t xs_upper = xs[x].upper;
     const __m128 xs_lerp_v = _mm_set1_ps(xs[x].lerp);
-
-    const __m128 top_left_v = load_3xfloat_v(ys_input_lower_ptr + xs_lower);
-    const __m128 top_right_v = load_3xfloat_v(ys_input_lower_ptr + xs_upper);
-    const __m128 bottom_left_v = load_3xfloat_v(ys_input_upper_ptr + xs_lower);
-    const __m128 bottom_right_v = load_3xfloat_v(ys_input_upper_ptr + xs_upper);
-
-    _mm_storeu_ps(out_y + x * 3,
-                  compute_lerp_v(top_left_v, top_right_v, bottom_left_v,
-                                 bottom_right_v, xs_lerp_v, ys_lerp_v));
+    const __m128 left_v = load_3xfloat_v(input + xs[x].lower);
+    const __m128 right_v = load_3xfloat_v(input + xs[x].upper);
+    _mm_storeu_ps(out_row + x * 3,
+                  _mm_add_ps(left_v, _mm_mul_ps(_mm_sub_ps(right_v, left_v),
+                                                xs_lerp_v)));
   }
   // The last pixel of each row must be done in a non-vectorized way
   // because we cannot overflow.
-  ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs + out_width - 1,
-                     ys_lerp, 1, out_y + (out_width - 1) * 3, 3);
+  ResizeRowChannels(input, xs + out_width - 1, 1, 3,
+                    out_row + (out_width - 1) * 3);
 }
 #endif
 
+template <typename T>
+void ResizeRow(const T* const input, const CachedInterpolation* const xs,
+               const int64_t out_width, const int channels, float* out_row) {
+#ifdef __SSE4_1__
+  if (channels == 3) {
+    ResizeRow3ChannelsVector(input, xs, out_width, out_row);
+    return;
+  }
+#endif
+  ResizeRowChannels(input, xs, out_width, channels, out_row);
+}
+
+// Resizes the images separably: the input rows an output row depends on are
+// first interpolated along the x dimension, and the results are interpolated
+// along the y dimension with vectorized Eigen expressions. This computes the
+// same values as interpolating the four corners of every output pixel, but
+// consecutive output rows which read the same input rows, as when upsampling,
+// interpolate them along the x dimension only once.
 template <typename T>
 void resize_image(
-    typename TTypes<T, 4>::ConstTensor images, const int batch_size,
-    const int64_t in_height, const int64_t in_width, const int64_t out_height,
-    const int64_t out_width, const int channels,
+    const CPUDevice& d, typename TTypes<T, 4>::ConstTensor images,
+    const int batch_size, const int64_t in_height, const int64_t in_width,
+    const int64_t out_height, const int64_t out_width, const int channels,
     const std::vector<CachedInterpolation>& xs,
     const std::vector<CachedInterpolation>& ys,
     typename TTypes<float, 4>::Tensor output) TF_ATTRIBUTE_NOINLINE;
 template <typename T>
-void resize_image(typename TTypes<T, 4>::ConstTensor images,
+void resize_image(const CPUDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
                   const int batch_size, const int64_t in_height,
                   const int64_t in_width, const int64_t out_height,
                   const int64_t out_width, const int channels,
@@ -218,44 +200,58 @@ void resize_image(typename TTypes<T, 4>::ConstTensor images,
                   const std::vector<CachedInterpolation>& ys,
                   typename TTypes<float, 4>::Tensor output) {
   const int64_t in_row_size = in_width * channels;
-  const int64_t in_batch_num_values = in_height * in_row_size;
   const int64_t out_row_size = out_width * channels;
 
-  const T* input_b_ptr = images.data();
+  const T* input_ptr = images.data();
+  float* output_ptr = output.data();
   const CachedInterpolation* xs = xs_vec.data();
 
-  if (channels == 3) {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64_t y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-#ifdef __SSE4_1__
-        ResizeLine3ChannelsVector(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                                  ys[y].lerp, out_width, output_y_ptr);
-#else
-        ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                           ys[y].lerp, out_width, output_y_ptr, 3);
-#endif
-        output_y_ptr += out_row_size;
+  // Each shard resizes a range of output rows of the flattened batch.
+  auto resize_rows = [&](int64_t start, int64_t end) {
+    std::vector<float> top_buffer(out_row_size);
+    std::vector<float> bottom_buffer(out_row_size);
+    // Input rows of the flattened batch held by the buffers, if any.
+    int64_t top_row = -1;
+    int64_t bottom_row = -1;
+    for (int64_t i = start; i < end; ++i) {
+      const int64_t b = i / out_height;
+      const int64_t y = i % out_height;
+      const int64_t lower = b * in_height + ys[y].lower;
+      const int64_t upper = b * in_height + ys[y].upper;
+      if (lower == bottom_row) {
+        std::swap(top_buffer, bottom_buffer);
+        std::swap(top_row, bottom_row);
       }
-      input_b_ptr += in_batch_num_values;
-    }
-  } else {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64_t y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-
-        ResizeLineChannels(ys_input_lower_ptr, ys_input_upper_ptr, xs,
-                           ys[y].lerp, out_width, output_y_ptr, channels);
-
-        output_y_ptr += out_row_size;
+      if (lower != top_row) {
+        ResizeRow(input_ptr + lower * in_row_size, xs, out_width, channels,
+                  top_buffer.data());
+        top_row = lower;
       }
-      input_b_ptr += in_batch_num_values;
+      if (upper != lower && upper != bottom_row) {
+        ResizeRow(input_ptr + upper * in_row_size, xs, out_width, channels,
+                  bottom_buffer.data());
+        bottom_row = upper;
+      }
+
+      typename TTypes<float>::UnalignedConstFlat top(top_buffer.data(),
+                                                     out_row_size);
+      typename TTypes<float>::UnalignedConstFlat bottom(
+          upper == lower ? top_buffer.data() : bottom_buffer.data(),
+          out_row_size);
+      typename TTypes<float>::UnalignedFlat out(output_ptr + i * out_row_size,
+                                                out_row_size);
+      out = top + (bottom - top) * ys[y].lerp;
     }
-  }
+  };
+  // Each output row reads up to two input rows and interpolates each value
+  // three times.
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/2 * out_row_size * sizeof(T),
+      /*bytes_stored=*/out_row_size * sizeof(float),
+      /*compute_cycles=*/out_row_size * 3 *
+          (Eigen::TensorOpCost::AddCost<float>() * 2 +
+           Eigen::TensorOpCost::MulCost<float>()));
+  d.parallelFor(batch_size * out_height, cost, resize_rows);
 }
 
 // Casts from float16 to T.
@@ -324,10 +320,19 @@ struct ResizeBilinear<CPUDevice, T> {
       xs[i].upper *= channels;
     }
 
-    resize_image<T>(images, batch_size, in_height, in_width, out_height,
+    resize_image<T>(d, images, batch_size, in_height, in_width, out_height,
                     out_width, channels, xs, ys, output);
   }
 };
+
+void ResizeBilinearUint8OnCpu(const CPUDevice& d,
+                              TTypes<uint8, 4>::ConstTensor images,
+                              float height_scale, float width_scale,
+                              bool half_pixel_centers,
+                              TTypes<float, 4>::Tensor resized_images) {
+  ResizeBilinear<CPUDevice, uint8>()(d, images, height_scale, width_scale,
+                                     half_pixel_centers, resized_images);
+}
 }  // namespace functor
 
 template <typename Device, typename T>
@@ -40,6 +40,14 @@ struct ResizeBilinearGrad {
                   typename TTypes<T, 4>::Tensor output_grad);
 };
 
+// Resizes uint8 `images` on the CPU exactly like the ResizeBilinear kernel, for
+// kernels which fuse the resize with producing the images.
+void ResizeBilinearUint8OnCpu(const Eigen::ThreadPoolDevice& d,
+                              TTypes<uint8, 4>::ConstTensor images,
+                              float height_scale, float width_scale,
+                              bool half_pixel_centers,
+                              TTypes<float, 4>::Tensor resized_images);
+
 }  // namespace functor
 }  // namespace tensorflow
 
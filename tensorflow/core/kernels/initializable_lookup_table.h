@@ -199,6 +199,11 @@ class InitializableLookupTable : public LookupInterface {
   virtual Status DoFind(const Tensor& keys, Tensor* values,
                         const Tensor& default_value) = 0;
 
+  // Called once all the entries are inserted, before the table is marked as
+  // initialized. Implementations may convert the entries to a read-only data
+  // structure.
+  virtual Status DoFinalize() { return absl::OkStatus(); }
+
   virtual Status AreEntriesSame(const InitTableIterator& iter, bool* result);
 
   mutex mu_;
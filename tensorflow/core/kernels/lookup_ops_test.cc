@@ -15,14 +15,24 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/perfect_hash_string_map.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -100,5 +110,103 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+class PerfectHashTableTest : public OpsTestBase {
+ protected:
+  static constexpr int kNumKeys = 1000;
+
+  // Creates a HashTableV2 from strings to int64, with the attribute set to
+  // `min_size` unless it is negative, and imports kNumKeys entries in it.
+  void CreateTable(int64_t min_size) {
+    NodeDefBuilder builder("hash_table", "HashTableV2");
+    builder.Attr("key_dtype", DT_STRING).Attr("value_dtype", DT_INT64);
+    if (min_size >= 0) {
+      builder.Attr("experimental_perfect_hash_min_size", min_size);
+    }
+    TF_ASSERT_OK(builder.Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    TF_ASSERT_OK(RunOpKernel());
+    TF_ASSERT_OK(LookupResource(context_.get(),
+                                GetOutput(0)->scalar<ResourceHandle>()(),
+                                &table_));
+
+    for (int i = 0; i < kNumKeys; ++i) {
+      keys_.push_back(absl::StrCat("key", i));
+      values_.push_back(3 * i);
+    }
+    Tensor keys(DT_STRING, TensorShape({kNumKeys}));
+    Tensor values(DT_INT64, TensorShape({kNumKeys}));
+    for (int i = 0; i < kNumKeys; ++i) {
+      keys.vec<tstring>()(i) = keys_[i];
+      values.vec<int64_t>()(i) = values_[i];
+    }
+    TF_ASSERT_OK(table_->ImportValues(context_.get(), keys, values));
+  }
+
+  void TearDown() override {
+    if (table_ != nullptr) table_->Unref();
+  }
+
+  // Checks that every key is found, and that missing keys get the default.
+  void ExpectFindsAllKeys() {
+    Tensor keys(DT_STRING, TensorShape({kNumKeys + 2}));
+    Tensor expected(DT_INT64, TensorShape({kNumKeys + 2}));
+    for (int i = 0; i < kNumKeys; ++i) {
+      keys.vec<tstring>()(i) = keys_[i];
+      expected.vec<int64_t>()(i) = values_[i];
+    }
+    keys.vec<tstring>()(kNumKeys) = "missing";
+    keys.vec<tstring>()(kNumKeys + 1) = "";
+    expected.vec<int64_t>()(kNumKeys) = -1;
+    expected.vec<int64_t>()(kNumKeys + 1) = -1;
+
+    Tensor values(DT_INT64, TensorShape({kNumKeys + 2}));
+    TF_ASSERT_OK(table_->Find(context_.get(), keys, &values,
+                              test::AsScalar<int64_t>(-1)));
+    test::ExpectTensorEqual<int64_t>(values, expected);
+    EXPECT_EQ(table_->size(), static_cast<size_t>(kNumKeys));
+  }
+
+  // The memory used by the entries in a hash map.
+  static int64_t HashMapMemoryUsed() {
+    return kNumKeys * static_cast<int64_t>(sizeof(tstring) + sizeof(int64_t));
+  }
+
+  // The memory used by the entries in a PerfectHashStringMap.
+  int64_t PerfectHashMemoryUsed() {
+    std::vector<absl::string_view> keys(keys_.begin(), keys_.end());
+    std::unique_ptr<PerfectHashStringMap> map;
+    TF_CHECK_OK(PerfectHashStringMap::Create(keys, values_, &map));
+    return map->MemoryUsed();
+  }
+
+  lookup::LookupInterface* table_ = nullptr;
+  std::vector<std::string> keys_;
+  std::vector<int64_t> values_;
+};
+
+TEST_F(PerfectHashTableTest, ConvertsLargeTables) {
+  CreateTable(/*min_size=*/kNumKeys);
+  ExpectFindsAllKeys();
+  EXPECT_EQ(table_->MemoryUsed(), PerfectHashMemoryUsed());
+}
+
+TEST_F(PerfectHashTableTest, KeepsSmallerTables) {
+  CreateTable(/*min_size=*/kNumKeys + 1);
+  ExpectFindsAllKeys();
+  EXPECT_EQ(table_->MemoryUsed(), HashMapMemoryUsed());
+}
+
+TEST_F(PerfectHashTableTest, DisabledByDefault) {
+  CreateTable(/*min_size=*/-1);
+  ExpectFindsAllKeys();
+  EXPECT_EQ(table_->MemoryUsed(), HashMapMemoryUsed());
+}
+
+TEST_F(PerfectHashTableTest, DisabledByZero) {
+  CreateTable(/*min_size=*/0);
+  ExpectFindsAllKeys();
+  EXPECT_EQ(table_->MemoryUsed(), HashMapMemoryUsed());
+}
+
 }  // namespace
 }  // namespace tensorflow
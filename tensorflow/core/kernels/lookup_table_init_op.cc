@@ -149,7 +149,9 @@ class InitializeTableFromTextFileOp : public OpKernel {
         ctx, lookup::InitializeTableFromTextFile(
                  vocab_filename, vocab_size_, delimiter_, key_index_,
                  value_index_, offset_, ctx->env(),
-                 MakeInitializerSerializer(vocab_filename_tensor), table));
+                 MakeInitializerSerializer(vocab_filename_tensor),
+                 ctx->device()->tensorflow_cpu_worker_threads()->workers,
+                 table));
     if (ctx->track_allocations()) {
       ctx->record_persistent_memory_allocation(table->MemoryUsed() -
                                                memory_used_before);
@@ -16,19 +16,28 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/kernels/perfect_hash_string_map.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
@@ -209,6 +218,9 @@ std::string UniqueNodeName(const std::string& base);
 //
 // For look up, the table is required to be initialized (allocated
 // and populated). Once the table is marked as initialized it becomes read-only.
+// Large string to int64 vocabularies can then be converted to a more compact
+// perfect hash map, see the experimental_perfect_hash_min_size attribute of
+// HashTableV2.
 //
 // Sample use case:
 //
@@ -219,7 +231,11 @@ std::string UniqueNodeName(const std::string& base);
 template <class K, class V>
 class HashTable : public InitializableLookupTable {
  public:
-  HashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+  HashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    // Only HashTableV2 has the attribute, the other ops keep the hash map.
+    TryGetNodeAttr(kernel->def(), "experimental_perfect_hash_min_size",
+                   &perfect_hash_min_size_);
+  }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
     // We set use_node_name_sharing with a unique node name so that the resource
@@ -228,13 +244,21 @@ class HashTable : public InitializableLookupTable {
     // it is created in.
     // TODO(b/181695913): Provide a mechanism for deleting this resource
     // earlier when appropriate.
+    const GraphDefBuilder::Options opts =
+        builder->opts()
+            .WithName(UniqueNodeName("HashTableFromGraphDef"))
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("use_node_name_sharing", true);
+    // The attribute is left out by default, so that older binaries can load
+    // the graph.
     Node* hash_table_node = ops::SourceOp(
-        "HashTableV2", builder->opts()
-                           .WithName(UniqueNodeName("HashTableFromGraphDef"))
-                           .WithAttr("key_dtype", key_dtype())
-                           .WithAttr("value_dtype", value_dtype())
-                           .WithAttr("use_node_name_sharing", true));
-    if (table_.empty()) {
+        "HashTableV2",
+        perfect_hash_min_size_ > 0
+            ? opts.WithAttr("experimental_perfect_hash_min_size",
+                            perfect_hash_min_size_)
+            : opts);
+    if (num_entries() == 0) {
       *out = hash_table_node;
       return absl::OkStatus();
     }
@@ -258,7 +282,7 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized())
       return 0;
     else
-      return table_.size();
+      return num_entries();
   }
 
   Status ExportValues(OpKernelContext* context) override {
@@ -266,7 +290,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64_t size = table_.size();
+    const int64_t size = num_entries();
 
     Tensor* keys;
     Tensor* values;
@@ -277,6 +301,16 @@ class HashTable : public InitializableLookupTable {
 
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
+    if constexpr (kSupportsPerfectHash) {
+      if (perfect_hash_ != nullptr) {
+        for (int64_t slot = 0; slot < size; ++slot) {
+          const absl::string_view key = perfect_hash_->key(slot);
+          keys_data(slot) = tstring(key.data(), key.size());
+          values_data(slot) = perfect_hash_->value(slot);
+        }
+        return absl::OkStatus();
+      }
+    }
     int64_t i = 0;
     for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
       keys_data(i) = it->first;
@@ -320,12 +354,49 @@ class HashTable : public InitializableLookupTable {
     return absl::OkStatus();
   }
 
+  Status DoFinalize() override {
+    if constexpr (kSupportsPerfectHash) {
+      if (perfect_hash_min_size_ <= 0 ||
+          static_cast<int64_t>(table_.size()) < perfect_hash_min_size_) {
+        return absl::OkStatus();
+      }
+      std::vector<absl::string_view> keys;
+      std::vector<int64_t> values;
+      keys.reserve(table_.size());
+      values.reserve(table_.size());
+      for (const auto& entry : table_) {
+        keys.push_back(entry.first);
+        values.push_back(entry.second);
+      }
+      Status status =
+          PerfectHashStringMap::Create(keys, values, &perfect_hash_);
+      if (!status.ok()) {
+        LOG(WARNING) << "Keeping the HashTable of " << table_.size()
+                     << " entries in a hash map: " << status;
+        return absl::OkStatus();
+      }
+      table_ = absl::flat_hash_map<K, V>();
+    }
+    return absl::OkStatus();
+  }
+
   Status DoFind(const Tensor& key, Tensor* value,
                 const Tensor& default_value) override {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
+    if constexpr (kSupportsPerfectHash) {
+      if (perfect_hash_ != nullptr) {
+        std::vector<absl::string_view> keys(key_values.size());
+        for (int64_t i = 0; i < key_values.size(); ++i) {
+          keys[i] = key_values(i);
+        }
+        perfect_hash_->FindBatch(keys, default_val, value_values.data());
+        return absl::OkStatus();
+      }
+    }
+
     for (int64_t i = 0; i < key_values.size(); ++i) {
       value_values(i) = gtl::FindWithDefault(
           table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
@@ -337,12 +408,27 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized()) {
       return 0;
     }
+    if (perfect_hash_ != nullptr) {
+      return perfect_hash_->MemoryUsed();
+    }
     const int64_t num_elements = table_.size();
     return num_elements * (sizeof(K) + sizeof(V));
   }
 
  private:
+  static constexpr bool kSupportsPerfectHash =
+      std::is_same<K, tstring>::value && std::is_same<V, int64_t>::value;
+
+  int64_t num_entries() const {
+    return perfect_hash_ != nullptr ? perfect_hash_->size() : table_.size();
+  }
+
   absl::flat_hash_map<K, V> table_;
+  // Tables with at least this many entries are converted to `perfect_hash_`
+  // once initialized, if kSupportsPerfectHash. 0 disables the conversion.
+  int64_t perfect_hash_min_size_ = 0;
+  // Replaces `table_` once initialized, if kSupportsPerfectHash.
+  std::unique_ptr<PerfectHashStringMap> perfect_hash_;
 };
 
 }  // namespace lookup
@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -24,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -36,30 +44,39 @@ using InitializerSerializer =
 static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
+// Lines read, parsed and inserted in the table together.
+static const int kLinesPerBatch = 64 * 1024;
 
+// Counts the lines the way io::InputBuffer::ReadLine() splits them: the last
+// line doesn't need to end with a newline.
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64_t* num_lines) {
   std::unique_ptr<RandomAccessFile> file;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(vocab_file, &file));
 
-  io::InputBuffer input_buffer(file.get(), kInputBufferSize);
-  string line;
-  Status s = input_buffer.ReadLine(&line);
-  int64_t next_id = 0;
-  while (s.ok()) {
-    next_id++;
-    s = input_buffer.ReadLine(&line);
-  }
-  if (!absl::IsOutOfRange(s)) {
-    return s;
+  std::unique_ptr<char[]> scratch(new char[kInputBufferSize]);
+  uint64 offset = 0;
+  int64_t num_newlines = 0;
+  char last_char = '\n';
+  while (true) {
+    StringPiece chunk;
+    Status s = file->Read(offset, kInputBufferSize, &chunk, scratch.get());
+    if (!s.ok() && !absl::IsOutOfRange(s)) {
+      return s;
+    }
+    num_newlines += std::count(chunk.begin(), chunk.end(), '\n');
+    if (!chunk.empty()) last_char = chunk.back();
+    offset += chunk.size();
+    if (!s.ok() || chunk.empty()) break;
   }
-  *num_lines = next_id;
+  *num_lines = num_newlines + (last_char != '\n' ? 1 : 0);
   return absl::OkStatus();
 }
 
-// Iterator that reads a text file. Each iteration process one line, it parses
-// the line and populates the keys and values tensors used for initialization
-// with a single key and corresponding value.
+// Iterator that reads a text file. Each iteration reads a batch of lines, it
+// parses the lines and populates the keys and values tensors used for
+// initialization with one key and corresponding value per line. The lines of
+// a batch are parsed in parallel if a thread pool is given.
 //
 // What information of the line to populate the key or values is specified by
 // providing key_index and value_index.
@@ -83,15 +100,17 @@ class TextFileLineIterator
   //   delimiter.
   Status Init(const string& filename, int64_t vocab_size, char delimiter,
               DataType key_dtype, int64_t key_index, DataType value_dtype,
-              int64_t value_index, int64_t offset, Env* env) {
+              int64_t value_index, int64_t offset, Env* env,
+              thread::ThreadPool* thread_pool) {
     filename_ = filename;
     vocab_size_ = vocab_size;
     delimiter_ = delimiter;
-    key_ = Tensor(key_dtype, TensorShape({}));
-    value_ = Tensor(value_dtype, TensorShape({}));
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
     key_index_ = key_index;
     value_index_ = value_index;
     env_ = env;
+    thread_pool_ = thread_pool;
 
     status_ = env->NewRandomAccessFile(filename_, &file_);
     if (!status_.ok()) return status_;
@@ -108,62 +127,50 @@ class TextFileLineIterator
   void Next() override {
     if (!valid_) return;
 
-    string line;
-    status_ = input_buffer_->ReadLine(&line);
-    if (!status_.ok()) {
-      if (absl::IsOutOfRange(status_) && vocab_size_ != -1 &&
-          next_id_ != vocab_size_) {
-        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
-                                          ": expected ", vocab_size_,
-                                          " but got ", next_id_);
+    next_id_ += num_lines_;
+    num_lines_ = 0;
+    lines_.resize(kLinesPerBatch);
+    while (num_lines_ < kLinesPerBatch) {
+      const int64_t id = next_id_ + num_lines_;
+      // A batch ends at the vocab size, the next one reads the line past it.
+      if (num_lines_ > 0 && vocab_size_ != -1 && id >= vocab_size_) break;
+      string& line = lines_[num_lines_];
+      status_ = input_buffer_->ReadLine(&line);
+      if (!status_.ok()) {
+        // The next batch gets the end of the file again.
+        if (num_lines_ > 0 && absl::IsOutOfRange(status_)) break;
+        if (absl::IsOutOfRange(status_) && vocab_size_ != -1 &&
+            id != vocab_size_) {
+          status_ = errors::InvalidArgument("Invalid vocab_size in ",
+                                            filename_, ": expected ",
+                                            vocab_size_, " but got ", id);
+        }
+        valid_ = false;
+        return;
       }
-      valid_ = false;
-      return;
-    }
-    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
-      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
-                   << vocab_size_ << " records.";
-      LOG(WARNING) << "next_id_  : " << next_id_;
-      status_ = errors::OutOfRange("Finished reading ", vocab_size_,
-                                   " of lines from ", filename_);
-      valid_ = false;
-      return;
-    }
-    if (line.empty()) {
-      status_ = errors::InvalidArgument("Invalid content in ", filename_,
-                                        ": empty line found at position ",
-                                        input_buffer_->Tell(), ".");
-      valid_ = false;
-      return;
-    }
-
-    std::vector<string> tokens;
-    if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
-      const auto expected_size =
-          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
-      if (tokens.size() < expected_size) {
-        status_ = errors::InvalidArgument(
-            "Invalid number of columns in ", filename_, " line ", next_id_,
-            " (", line, ") : expected at least ", expected_size, " got ",
-            tokens.size());
+      if (vocab_size_ != -1 && id >= vocab_size_) {
+        LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                     << vocab_size_ << " records.";
+        LOG(WARNING) << "next_id_  : " << id;
+        status_ = errors::OutOfRange("Finished reading ", vocab_size_,
+                                     " of lines from ", filename_);
         valid_ = false;
         return;
       }
+      if (line.empty()) {
+        status_ = errors::InvalidArgument("Invalid content in ", filename_,
+                                          ": empty line found at position ",
+                                          input_buffer_->Tell(), ".");
+        valid_ = false;
+        return;
+      }
+      ++num_lines_;
     }
 
-    status_ = SetValue(line, tokens, key_index_, &key_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
-    }
-    status_ = SetValue(line, tokens, value_index_, &value_);
+    status_ = ParseLines();
     if (!status_.ok()) {
       valid_ = false;
-      return;
     }
-
-    next_id_++;
   }
 
   bool Valid() const override { return valid_; }
@@ -191,10 +198,17 @@ class TextFileLineIterator
   Tensor key_;
   Tensor value_;
   bool valid_;  // true if the iterator points to an existing range.
+  DataType key_dtype_;
+  DataType value_dtype_;
   int64_t key_index_;
   int64_t value_index_;
   Env* env_;
+  thread::ThreadPool* thread_pool_;  // Not owned, may be null.
+  // Id of the first line of the batch.
   int64_t next_id_;
+  // Lines of the batch.
+  std::vector<string> lines_;
+  int64_t num_lines_ = 0;
   int64_t offset_;
   int64_t vocab_size_;
   string filename_;
@@ -204,58 +218,109 @@ class TextFileLineIterator
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
 
-  // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
-  Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64_t index, Tensor* tensor) {
+  // Parses the lines of the batch into `key_` and `value_`. On error, returns
+  // the error of the first invalid line.
+  Status ParseLines() {
+    if (key_.NumElements() != num_lines_) {
+      key_ = Tensor(key_dtype_, TensorShape({num_lines_}));
+      value_ = Tensor(value_dtype_, TensorShape({num_lines_}));
+    }
+    mutex mu;
+    int64_t error_line = num_lines_;
+    Status error;
+    const auto parse = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        Status status = ParseLine(i);
+        if (!status.ok()) {
+          mutex_lock l(mu);
+          if (i < error_line) {
+            error_line = i;
+            error = status;
+          }
+          return;
+        }
+      }
+    };
+    if (thread_pool_ == nullptr || num_lines_ == 1) {
+      parse(0, num_lines_);
+    } else {
+      // Roughly the cycles to split and convert a line.
+      const int64_t kParseLineCost = 1000;
+      thread_pool_->ParallelFor(num_lines_, kParseLineCost, parse);
+    }
+    return error;
+  }
+
+  // Parses line `i` of the batch into element `i` of `key_` and `value_`.
+  Status ParseLine(int64_t i) {
+    const string& line = lines_[i];
+    const int64_t id = next_id_ + i;
+    std::vector<absl::string_view> tokens;
+    if (!ignore_split_) {
+      tokens = absl::StrSplit(line, delimiter_);
+      const auto expected_size =
+          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
+      if (tokens.size() < expected_size) {
+        return errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", id, " (",
+            line, ") : expected at least ", expected_size, " got ",
+            tokens.size());
+      }
+    }
+    TF_RETURN_IF_ERROR(SetValue(line, tokens, key_index_, id, i, &key_));
+    return SetValue(line, tokens, value_index_, id, i, &value_);
+  }
+
+  // Set the corresponding value from line or tokens based on 'index' into
+  // element 'i' of the tensor 't'. The value is transformed to the given data
+  // type 'dtype'. 'id' is the line number.
+  Status SetValue(const string& line,
+                  const std::vector<absl::string_view>& tokens, int64_t index,
+                  int64_t id, int64_t i, Tensor* tensor) const {
     if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
+      tensor->flat<int64_t>()(i) = id + offset_;
       return absl::OkStatus();
     }
-    const string& token = (index == kWholeLine) ? line : tokens[index];
+    const absl::string_view token =
+        (index == kWholeLine) ? absl::string_view(line) : tokens[index];
     const DataType& dtype = tensor->dtype();
     switch (dtype) {
       case DT_INT32: {
         int32_t value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+        if (!strings::safe_strto32(token, &value)) {
+          return errors::InvalidArgument("Field ", token, " in line ", id,
                                          " is not a valid int32.");
         }
-        tensor->flat<int32>()(0) = value + offset_;
+        tensor->flat<int32>()(i) = value + offset_;
       } break;
       case DT_INT64: {
         int64_t value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+        if (!strings::safe_strto64(token, &value)) {
+          return errors::InvalidArgument("Field ", token, " in line ", id,
                                          " is not a valid int64.");
         }
-        tensor->flat<int64_t>()(0) = value;
+        tensor->flat<int64_t>()(i) = value;
       } break;
       case DT_FLOAT: {
         float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+        if (!strings::safe_strtof(token, &value)) {
+          return errors::InvalidArgument("Field ", token, " in line ", id,
                                          " is not a valid float.");
         }
-        tensor->flat<float>()(0) = value;
+        tensor->flat<float>()(i) = value;
       } break;
       case DT_DOUBLE: {
         double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+        if (!strings::safe_strtod(token, &value)) {
+          return errors::InvalidArgument("Field ", token, " in line ", id,
                                          " is not a valid double.");
         }
-        tensor->flat<double>()(0) = value;
+        tensor->flat<double>()(i) = value;
       } break;
       case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+        tensor->flat<tstring>()(i) = tstring(token.data(), token.size());
         break;
       default:
-        valid_ = false;
         return errors::InvalidArgument("Data type ", DataTypeString(dtype),
                                        " not supported.");
     }
@@ -375,6 +440,17 @@ Status InitializeTableFromTextFile(
     int32_t key_index, int32_t value_index, int64_t offset, Env* env,
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table) {
+  return InitializeTableFromTextFile(filename, vocab_size, delimiter, key_index,
+                                     value_index, offset, env,
+                                     std::move(serializer),
+                                     /*thread_pool=*/nullptr, table);
+}
+
+Status InitializeTableFromTextFile(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    thread::ThreadPool* thread_pool, InitializableLookupTable* table) {
   if (key_index == kLineNumber && table->key_dtype() != DT_INT64) {
     return errors::InvalidArgument(
         "Key index for line number requires table key dtype of int64, got ",
@@ -404,7 +480,7 @@ Status InitializeTableFromTextFile(
   TextFileLineIterator iter;
   TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
                                key_index, value_dtype, value_index, offset,
-                               env));
+                               env, thread_pool));
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
@@ -23,6 +23,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -40,12 +41,18 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #include "tensorflow/core/util/matmul_bcast.h"
 #include "tensorflow/core/util/work_sharder.h"
 
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_autotune_map.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_parameters.pb.h"
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
 #if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
 #include "tsl/framework/contraction/eigen_contraction_kernel.h"
 #endif
@@ -213,9 +220,91 @@ struct SequentialMatMulKernel {
         t->dim_size(1), t->dim_size(2));
   }
 
+  // The largest matrices multiplied with sizes known at compile time, which
+  // avoids the overhead of the general Eigen product for tiny matrices.
+  static constexpr int64_t kMaxFixedSize = 8;
+
+  template <typename X, typename Y, typename Z>
+  static void Multiply(const X& x, const Y& y, bool adj_x, bool adj_y,
+                       bool trans_x, bool trans_y, Z& z) {
+    // Assume at most one of adj_x or trans_x is true. Similarly, for adj_y
+    // and trans_y.
+    if (!adj_x && !trans_x) {
+      if (!adj_y && !trans_y) {
+        z.noalias() = x * y;
+      } else if (adj_y) {
+        z.noalias() = x * y.adjoint();
+      } else {  // trans_y == true
+        z.noalias() = x * y.transpose();
+      }
+    } else if (adj_x) {
+      if (!adj_y && !trans_y) {
+        z.noalias() = x.adjoint() * y;
+      } else if (adj_y) {
+        z.noalias() = x.adjoint() * y.adjoint();
+      } else {  // trans_y == true
+        z.noalias() = x.adjoint() * y.transpose();
+      }
+    } else {  // trans_x == true
+      if (!adj_y && !trans_y) {
+        z.noalias() = x.transpose() * y;
+      } else if (adj_y) {
+        z.noalias() = x.transpose() * y.adjoint();
+      } else {  // trans_y == true
+        z.noalias() = x.transpose() * y.transpose();
+      }
+    }
+  }
+
+  // Multiplies square matrices of kSize x kSize.
+  template <int kSize>
+  static void RunFixedSize(const Tensor& in_x, const Tensor& in_y, bool adj_x,
+                           bool adj_y, bool trans_x, bool trans_y,
+                           const MatMulBCast& bcast, Tensor* out, int start,
+                           int limit) {
+    using FixedMatrix = Eigen::Matrix<Scalar, kSize, kSize, Eigen::RowMajor>;
+    constexpr int64_t kMatrixSize = kSize * kSize;
+    const bool should_bcast = bcast.IsBroadcastingRequired();
+    const auto& x_batch_indices = bcast.x_batch_indices();
+    const auto& y_batch_indices = bcast.y_batch_indices();
+    const Scalar* x_data = in_x.flat<Scalar>().data();
+    const Scalar* y_data = in_y.flat<Scalar>().data();
+    Scalar* z_data = out->flat<Scalar>().data();
+    for (int64_t i = start; i < limit; ++i) {
+      const int64_t x_batch_index = should_bcast ? x_batch_indices[i] : i;
+      const int64_t y_batch_index = should_bcast ? y_batch_indices[i] : i;
+      Eigen::Map<const FixedMatrix> x(x_data + x_batch_index * kMatrixSize);
+      Eigen::Map<const FixedMatrix> y(y_data + y_batch_index * kMatrixSize);
+      Eigen::Map<FixedMatrix> z(z_data + i * kMatrixSize);
+      Multiply(x, y, adj_x, adj_y, trans_x, trans_y, z);
+    }
+  }
+
   static void Run(const Tensor& in_x, const Tensor& in_y, bool adj_x,
                   bool adj_y, bool trans_x, bool trans_y,
                   const MatMulBCast& bcast, Tensor* out, int start, int limit) {
+    if constexpr (std::is_floating_point<Scalar>::value) {
+      const int64_t size = in_x.dim_size(1);
+      if (in_x.dim_size(2) == size && in_y.dim_size(1) == size &&
+          in_y.dim_size(2) == size && size <= kMaxFixedSize) {
+        switch (size) {
+          case 2:
+            return RunFixedSize<2>(in_x, in_y, adj_x, adj_y, trans_x, trans_y,
+                                   bcast, out, start, limit);
+          case 3:
+            return RunFixedSize<3>(in_x, in_y, adj_x, adj_y, trans_x, trans_y,
+                                   bcast, out, start, limit);
+          case 4:
+            return RunFixedSize<4>(in_x, in_y, adj_x, adj_y, trans_x, trans_y,
+                                   bcast, out, start, limit);
+          case 8:
+            return RunFixedSize<8>(in_x, in_y, adj_x, adj_y, trans_x, trans_y,
+                                   bcast, out, start, limit);
+          default:
+            break;
+        }
+      }
+    }
     const bool should_bcast = bcast.IsBroadcastingRequired();
     const auto& x_batch_indices = bcast.x_batch_indices();
     const auto& y_batch_indices = bcast.y_batch_indices();
@@ -225,33 +314,7 @@ struct SequentialMatMulKernel {
       auto x = ConstTensorSliceToEigenMatrix(in_x, x_batch_index);
       auto y = ConstTensorSliceToEigenMatrix(in_y, y_batch_index);
       auto z = TensorSliceToEigenMatrix(out, i);
-      // Assume at most one of adj_x or trans_x is true. Similarly, for adj_y
-      // and trans_y.
-      if (!adj_x && !trans_x) {
-        if (!adj_y && !trans_y) {
-          z.noalias() = x * y;
-        } else if (adj_y) {
-          z.noalias() = x * y.adjoint();
-        } else {  // trans_y == true
-          z.noalias() = x * y.transpose();
-        }
-      } else if (adj_x) {
-        if (!adj_y && !trans_y) {
-          z.noalias() = x.adjoint() * y;
-        } else if (adj_y) {
-          z.noalias() = x.adjoint() * y.adjoint();
-        } else {  // trans_y == true
-          z.noalias() = x.adjoint() * y.transpose();
-        }
-      } else {  // trans_x == true
-        if (!adj_y && !trans_y) {
-          z.noalias() = x.transpose() * y;
-        } else if (adj_y) {
-          z.noalias() = x.transpose() * y.adjoint();
-        } else {  // trans_y == true
-          z.noalias() = x.transpose() * y.transpose();
-        }
-      }
+      Multiply(x, y, adj_x, adj_y, trans_x, trans_y, z);
     }
   }
 };
@@ -410,16 +473,21 @@ struct SingleBatchParallelMatMulKernel {
 template <typename Device, typename Scalar>
 struct LaunchBatchMatMul;
 
+// The implementations of LaunchBatchMatMul<CPUDevice, Scalar>. The values
+// match CpuMatmulAlgorithm, which stores the autotuning results.
+enum class CpuMatMulKernel {
+  kInnerParallel = 1,
+  kBatchParallel = 2,
+  kOutputBlocks = 3,
+  kSequential = 4,
+};
+
 template <typename Scalar>
 struct LaunchBatchMatMul<CPUDevice, Scalar> {
   static void Launch(OpKernelContext* context, const Tensor& in_x,
                      const Tensor& in_y, bool adj_x, bool adj_y, bool trans_x,
                      bool trans_y, bool grad_x, bool grad_y,
                      const MatMulBCast& bcast, Tensor* out) {
-    typedef ParallelMatMulKernel<Scalar, Eigen::NumTraits<Scalar>::IsComplex>
-        ParallelMatMulKernel;
-    bool conjugate_result = false;
-
     // Number of matrix multiplies i.e. size of the batch.
     const int64_t batch_size = bcast.output_batch_size();
     const int64_t cost_per_unit =
@@ -429,48 +497,151 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
     // NOTE(nikhilsarda): This heuristic is optimal in benchmarks as of
     // Jan 21, 2020.
     const int64_t kMaxCostOuterParallelism = 128 * 128;  // heuristic.
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     // TODO(rmlarsen): Reconsider the heuristics now that we have asynchronous
     // evaluation in Eigen Tensor.
-    if (small_dim > 1 &&
+    CpuMatMulKernel kernel;
+    // Above this size, parallelizing each product may pay off even if there
+    // are as many products as threads.
+    const int64_t kMaxBatchParallelDim = 64;  // heuristic.
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    if (batch_size > 1 && batch_size >= num_threads &&
+        std::max({in_x.dim_size(1), in_x.dim_size(2), out->dim_size(2)}) <=
+            kMaxBatchParallelDim) {
+      // Many small products, e.g. in attention with many heads: running each
+      // of them in a single thread avoids the overhead of the parallel
+      // contraction.
+      kernel = CpuMatMulKernel::kBatchParallel;
+    } else if (small_dim > 1 &&
         (batch_size == 1 || cost_per_unit > kMaxCostOuterParallelism)) {
       // Parallelize over inner dims.
       // For large matrix products it is counter-productive to parallelize
       // over the batch dimension.
-      ParallelMatMulKernel::Run(context, in_x, in_y, adj_x, adj_y, trans_x,
-                                trans_y, bcast, out, batch_size);
-      conjugate_result = adj_x;
+      kernel = CpuMatMulKernel::kInnerParallel;
     } else if (batch_size > 1) {
       // Parallelize over outer dims. For small matrices and large batches, it
       // is counter-productive to parallelize the inner matrix multiplies.
-      Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
-            cost_per_unit,
-            [&in_x, &in_y, adj_x, adj_y, trans_x, trans_y, &bcast, out](
-                int start, int limit) {
-              SequentialMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y,
-                                                  trans_x, trans_y, bcast, out,
-                                                  start, limit);
-            });
+      kernel = CpuMatMulKernel::kBatchParallel;
     } else if (cost_per_unit > kMaxCostOuterParallelism) {
       // Split along output blocks.
-      SingleBatchParallelMatMulKernel<Scalar>::Run(context->eigen_cpu_device(),
-                                                   in_x, in_y, adj_x, adj_y,
-                                                   trans_x, trans_y, out);
+      kernel = CpuMatMulKernel::kOutputBlocks;
     } else {
       // Single small multiplication.
-      SequentialMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y, trans_x,
-                                          trans_y, bcast, out, 0, batch_size);
+      kernel = CpuMatMulKernel::kSequential;
+    }
+#if !defined(IS_MOBILE_PLATFORM)
+    if (CpuMatmulAutotuneEnable()) {
+      kernel = Autotune(context, in_x, in_y, adj_x, adj_y, trans_x, trans_y,
+                        bcast, out, kernel);
+    }
+#endif  // !defined(IS_MOBILE_PLATFORM)
+    Run(kernel, context, in_x, in_y, adj_x, adj_y, trans_x, trans_y, bcast,
+        out);
+  }
+
+ private:
+  static void Run(CpuMatMulKernel kernel, OpKernelContext* context,
+                  const Tensor& in_x, const Tensor& in_y, bool adj_x,
+                  bool adj_y, bool trans_x, bool trans_y,
+                  const MatMulBCast& bcast, Tensor* out) {
+    typedef ParallelMatMulKernel<Scalar, Eigen::NumTraits<Scalar>::IsComplex>
+        ParallelMatMulKernel;
+    const int64_t batch_size = bcast.output_batch_size();
+    switch (kernel) {
+      case CpuMatMulKernel::kInnerParallel:
+        ParallelMatMulKernel::Run(context, in_x, in_y, adj_x, adj_y, trans_x,
+                                  trans_y, bcast, out, batch_size);
+        if (adj_x) {
+          // We used one of the identities
+          //   conj(a) * conj(b) = conj(a * b)
+          //   conj(a) * b = conj(a * conj(b))
+          // above, we need to conjugate the final output. This is a
+          // no-op for non-complex types.
+          ParallelMatMulKernel::Conjugate(context, out);
+        }
+        break;
+      case CpuMatMulKernel::kBatchParallel: {
+        const int64_t cost_per_unit =
+            in_x.dim_size(1) * in_x.dim_size(2) * out->dim_size(2);
+        auto worker_threads =
+            *(context->device()->tensorflow_cpu_worker_threads());
+        Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+              cost_per_unit,
+              [&in_x, &in_y, adj_x, adj_y, trans_x, trans_y, &bcast, out](
+                  int start, int limit) {
+                SequentialMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y,
+                                                    trans_x, trans_y, bcast,
+                                                    out, start, limit);
+              });
+        break;
+      }
+      case CpuMatMulKernel::kOutputBlocks:
+        DCHECK_EQ(batch_size, 1);
+        SingleBatchParallelMatMulKernel<Scalar>::Run(
+            context->eigen_cpu_device(), in_x, in_y, adj_x, adj_y, trans_x,
+            trans_y, out);
+        break;
+      case CpuMatMulKernel::kSequential:
+        SequentialMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y, trans_x,
+                                            trans_y, bcast, out, 0,
+                                            batch_size);
+        break;
+    }
+  }
+
+#if !defined(IS_MOBILE_PLATFORM)
+  // Returns the fastest kernel for this product, timing all of them the first
+  // time its shape is seen on a device with this many threads. Every timed run
+  // computes `out` in full.
+  static CpuMatMulKernel Autotune(OpKernelContext* context, const Tensor& in_x,
+                                  const Tensor& in_y, bool adj_x, bool adj_y,
+                                  bool trans_x, bool trans_y,
+                                  const MatMulBCast& bcast, Tensor* out,
+                                  CpuMatMulKernel default_kernel) {
+    const int64_t batch_size = bcast.output_batch_size();
+    const CpuMatmulParameters params(
+        out->dim_size(1), out->dim_size(2),
+        (adj_x || trans_x) ? in_x.dim_size(1) : in_x.dim_size(2), batch_size,
+        DataTypeToEnum<Scalar>::v(), adj_x, adj_y, trans_x, trans_y,
+        context->device()->tensorflow_cpu_worker_threads()->num_threads);
+    CpuMatmulAutotuneMap* autotune_map = CpuMatmulAutotuneMap::GetInstance();
+    CpuMatmulAlgorithm algorithm;
+    if (autotune_map->Find(params, &algorithm)) {
+      return static_cast<CpuMatMulKernel>(algorithm);
     }
 
-    if (conjugate_result) {
-      // We used one of the identities
-      //   conj(a) * conj(b) = conj(a * b)
-      //   conj(a) * b = conj(a * conj(b))
-      // above, we need to conjugate the final output. This is a
-      // no-op for non-complex types.
-      ParallelMatMulKernel::Conjugate(context, out);
+    // The first run of each kernel warms up the caches, and the second one is
+    // timed.
+    constexpr int kNumRuns = 2;
+    CpuMatMulKernel best_kernel = default_kernel;
+    uint64 best_time = std::numeric_limits<uint64>::max();
+    for (CpuMatMulKernel kernel :
+         {CpuMatMulKernel::kInnerParallel, CpuMatMulKernel::kBatchParallel,
+          CpuMatMulKernel::kOutputBlocks, CpuMatMulKernel::kSequential}) {
+      if (kernel == CpuMatMulKernel::kOutputBlocks && batch_size != 1) {
+        continue;
+      }
+      uint64 time = 0;
+      for (int i = 0; i < kNumRuns; ++i) {
+        const uint64 start_time = Env::Default()->NowMicros();
+        Run(kernel, context, in_x, in_y, adj_x, adj_y, trans_x, trans_y, bcast,
+            out);
+        time = Env::Default()->NowMicros() - start_time;
+      }
+      // Ties go to the default.
+      if (time < best_time || (time == best_time && kernel == default_kernel)) {
+        best_time = time;
+        best_kernel = kernel;
+      }
     }
+    algorithm = static_cast<CpuMatmulAlgorithm>(best_kernel);
+    VLOG(1) << "Autotuned CPU matmul with " << params.ToString() << ": "
+            << CpuMatmulAlgorithm_Name(algorithm) << " in " << best_time
+            << " us";
+    autotune_map->Insert(params, algorithm);
+    return best_kernel;
   }
+#endif  // !defined(IS_MOBILE_PLATFORM)
 };
 
 #if GOOGLE_CUDA || TF_HIPBLASLT
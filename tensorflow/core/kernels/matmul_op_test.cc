@@ -21,8 +21,11 @@ limitations under the License.
 #include "tensorflow/cc/ops/nn_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -30,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_autotune_map.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_parameters.pb.h"
+#include "tensorflow/core/util/matmul_autotune.h"
 #include "tsl/platform/status.h"
 
 #if TENSORFLOW_USE_ROCM
@@ -420,6 +426,109 @@ using FusedBiasAddDataTypes = ::testing::Types<float, Eigen::half>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+// A product of `batch_size` [m, k] and [k, n] matrices, with the second ones
+// given as [n, k] if `adj_y`.
+struct BatchMatMulShape {
+  int64_t batch_size;
+  int64_t m;
+  int64_t k;
+  int64_t n;
+  bool adj_y;
+};
+
+class CpuBatchMatMulAutotuneTest
+    : public OpsTestBase,
+      public ::testing::WithParamInterface<BatchMatMulShape> {
+ protected:
+  void SetUp() override {
+    const BatchMatMulShape& shape = GetParam();
+    x_ = Tensor(DT_FLOAT, TensorShape({shape.batch_size, shape.m, shape.k}));
+    x_.flat<float>().setRandom();
+    y_ = Tensor(DT_FLOAT,
+                TensorShape({shape.batch_size, shape.adj_y ? shape.n : shape.k,
+                             shape.adj_y ? shape.k : shape.n}));
+    y_.flat<float>().setRandom();
+    TF_ASSERT_OK(NodeDefBuilder("batch_matmul", "BatchMatMulV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("adj_x", false)
+                     .Attr("adj_y", shape.adj_y)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    CpuMatmulAutotuneMap::GetInstance()->ClearMap();
+  }
+
+  void TearDown() override {
+    SetCpuMatmulAutotuneEnable(false);
+    CpuMatmulAutotuneMap::GetInstance()->ClearMap();
+  }
+
+  Tensor RunBatchMatMul() {
+    inputs_.clear();
+    inputs_.push_back(TensorValue(&x_));
+    inputs_.push_back(TensorValue(&y_));
+    TF_CHECK_OK(RunOpKernel());
+    return *GetOutput(0);
+  }
+
+  // The autotuning key of the product.
+  CpuMatmulParameters Params() {
+    const BatchMatMulShape& shape = GetParam();
+    return CpuMatmulParameters(
+        shape.m, shape.n, shape.k, shape.batch_size, DT_FLOAT,
+        /*adj_x=*/false, shape.adj_y, /*trans_x=*/false, /*trans_y=*/false,
+        device_->tensorflow_cpu_worker_threads()->num_threads);
+  }
+
+  Tensor x_;
+  Tensor y_;
+};
+
+TEST_P(CpuBatchMatMulAutotuneTest, AutotunedMatchesHeuristic) {
+  SetCpuMatmulAutotuneEnable(false);
+  const Tensor expected = RunBatchMatMul();
+  EXPECT_TRUE(CpuMatmulAutotuneMap::GetInstance()->GetMap().empty());
+
+  SetCpuMatmulAutotuneEnable(true);
+  // The first run times every kernel, the second one uses the fastest.
+  test::ExpectClose(RunBatchMatMul(), expected, /*atol=*/1e-4, /*rtol=*/1e-4);
+  CpuMatmulAlgorithm algorithm;
+  ASSERT_TRUE(CpuMatmulAutotuneMap::GetInstance()->Find(Params(), &algorithm));
+  EXPECT_NE(algorithm, CPU_MATMUL_DEFAULT);
+  test::ExpectClose(RunBatchMatMul(), expected, /*atol=*/1e-4, /*rtol=*/1e-4);
+  EXPECT_EQ(CpuMatmulAutotuneMap::GetInstance()->GetMap().size(), 1);
+}
+
+TEST_P(CpuBatchMatMulAutotuneTest, EveryAlgorithmMatchesHeuristic) {
+  SetCpuMatmulAutotuneEnable(false);
+  const Tensor expected = RunBatchMatMul();
+
+  SetCpuMatmulAutotuneEnable(true);
+  for (CpuMatmulAlgorithm algorithm :
+       {CPU_MATMUL_INNER_PARALLEL, CPU_MATMUL_BATCH_PARALLEL,
+        CPU_MATMUL_OUTPUT_BLOCKS, CPU_MATMUL_SEQUENTIAL}) {
+    if (algorithm == CPU_MATMUL_OUTPUT_BLOCKS && GetParam().batch_size != 1) {
+      continue;
+    }
+    SCOPED_TRACE(CpuMatmulAlgorithm_Name(algorithm));
+    // A stored result is used as is, as if loaded from a serialized map.
+    CpuMatmulAutotuneMap::GetInstance()->Insert(Params(), algorithm);
+    test::ExpectClose(RunBatchMatMul(), expected, /*atol=*/1e-4,
+                      /*rtol=*/1e-4);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Shapes, CpuBatchMatMulAutotuneTest,
+    ::testing::Values(BatchMatMulShape{1, 1, 1, 1, false},
+                      BatchMatMulShape{1, 1, 256, 256, false},
+                      BatchMatMulShape{1, 256, 256, 1, true},
+                      BatchMatMulShape{1, 200, 300, 100, false},
+                      BatchMatMulShape{64, 4, 4, 4, false},
+                      BatchMatMulShape{64, 8, 8, 8, true},
+                      BatchMatMulShape{8, 130, 70, 60, true},
+                      BatchMatMulShape{3, 1, 500, 1, false}));
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
@@ -775,5 +884,11 @@ BM_BatchMatmul(1, 1, 200, 10000, true, true);
 BM_BatchMatmul(8, 1, 200, 10000, true, true);
 BM_BatchMatmul(32, 1, 200, 10000, true, true);
 
+// Many small matrices, e.g. attention with many heads.
+BM_BatchMatmul(4096, 4, 4, 4, false, false);
+BM_BatchMatmul(4096, 8, 8, 8, false, true);
+BM_BatchMatmul(1024, 64, 16, 64, false, true);
+BM_BatchMatmul(1024, 64, 64, 16, false, false);
+
 }  // namespace
 }  // namespace tensorflow
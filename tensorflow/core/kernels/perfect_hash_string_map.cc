@@ -0,0 +1,426 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/kernels/perfect_hash_string_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'P', 'H', 'S', 'M', '0', '1'};
+// Average number of keys per bucket. Larger buckets take less memory for the
+// pilots, but longer to place.
+constexpr int kAverageBucketSize = 4;
+// Keys are first placed in a table that is slightly larger than the number of
+// keys, which keeps the last buckets fast to place. The keys in the slots past
+// the end are then moved to the free slots.
+constexpr double kLoadFactor = 0.97;
+// Pilots tried for a bucket before restarting with another hash seed.
+constexpr uint32_t kMaxPilot = 1 << 20;
+constexpr int kMaxSeeds = 8;
+// Keys looked up together by FindBatch().
+constexpr int kFindBlockSize = 16;
+
+struct Header {
+  char magic[8];
+  uint64_t seed;
+  uint64_t num_keys;
+  uint64_t num_buckets;
+  uint64_t table_size;
+  uint64_t arena_size;
+};
+
+// Sections are 8-byte aligned.
+uint64_t Align8(uint64_t size) { return (size + 7) & ~uint64_t{7}; }
+
+// Every entry of the arena is the value, followed by the key characters.
+constexpr uint64_t kValueSize = sizeof(int64_t);
+
+struct Layout {
+  uint64_t pilots;
+  uint64_t remap;
+  uint64_t offsets;
+  uint64_t arena;
+  uint64_t size;
+
+  Layout(uint64_t num_keys, uint64_t num_buckets, uint64_t table_size,
+         uint64_t arena_size) {
+    pilots = sizeof(Header);
+    remap = pilots + Align8(num_buckets * sizeof(uint32_t));
+    offsets = remap + Align8((table_size - num_keys) * sizeof(uint32_t));
+    arena = offsets + Align8((num_keys + 1) * sizeof(uint32_t));
+    size = arena + arena_size;
+  }
+};
+
+// Finalizer of MurmurHash3.
+inline uint64_t Mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline uint64_t HashKey(absl::string_view key, uint64_t seed) {
+  return Hash64(key.data(), key.size(), seed);
+}
+
+// Maps `hash` to [0, n) with a multiplication instead of a division.
+inline uint64_t Reduce(uint64_t hash, uint64_t n) {
+  return absl::Uint128High64(absl::uint128(hash) * n);
+}
+
+inline uint64_t BucketOf(uint64_t hash, uint64_t num_buckets) {
+  return Reduce(hash, num_buckets);
+}
+
+inline uint64_t SlotOf(uint64_t hash, uint32_t pilot, uint64_t table_size) {
+  return Reduce(Mix(hash ^ Mix(pilot + 0x9e3779b97f4a7c15ULL)), table_size);
+}
+
+// Finds a pilot for every bucket so that all the keys go to distinct slots of
+// a table of `table_size`, and returns the slot of every key. Fails if some
+// bucket can't be placed.
+bool FindPilots(const std::vector<uint64_t>& hashes, uint64_t num_buckets,
+                uint64_t table_size, std::vector<uint32_t>* pilots,
+                std::vector<uint64_t>* slots) {
+  const uint64_t num_keys = hashes.size();
+  // Keys of every bucket: bucket_keys[bucket_start[b]..bucket_start[b + 1]).
+  std::vector<uint64_t> bucket_start(num_buckets + 1, 0);
+  for (const uint64_t hash : hashes) {
+    ++bucket_start[BucketOf(hash, num_buckets) + 1];
+  }
+  uint64_t max_bucket_size = 0;
+  for (uint64_t b = 0; b < num_buckets; ++b) {
+    max_bucket_size = std::max(max_bucket_size, bucket_start[b + 1]);
+    bucket_start[b + 1] += bucket_start[b];
+  }
+  std::vector<uint64_t> bucket_keys(num_keys);
+  {
+    std::vector<uint64_t> next(bucket_start.begin(), bucket_start.end() - 1);
+    for (uint64_t i = 0; i < num_keys; ++i) {
+      bucket_keys[next[BucketOf(hashes[i], num_buckets)]++] = i;
+    }
+  }
+  // Largest buckets first, while most slots are free.
+  std::vector<uint64_t> order(num_buckets);
+  for (uint64_t b = 0; b < num_buckets; ++b) order[b] = b;
+  std::stable_sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) {
+    return bucket_start[a + 1] - bucket_start[a] >
+           bucket_start[b + 1] - bucket_start[b];
+  });
+
+  pilots->assign(num_buckets, 0);
+  slots->assign(num_keys, 0);
+  std::vector<bool> taken(table_size, false);
+  std::vector<uint64_t> bucket_slots;
+  bucket_slots.reserve(max_bucket_size);
+  for (const uint64_t b : order) {
+    const uint64_t begin = bucket_start[b];
+    const uint64_t end = bucket_start[b + 1];
+    if (begin == end) break;
+    bool placed = false;
+    for (uint32_t pilot = 0; pilot < kMaxPilot && !placed; ++pilot) {
+      bucket_slots.clear();
+      placed = true;
+      for (uint64_t j = begin; j < end && placed; ++j) {
+        const uint64_t slot =
+            SlotOf(hashes[bucket_keys[j]], pilot, table_size);
+        placed = !taken[slot] && std::find(bucket_slots.begin(),
+                                           bucket_slots.end(),
+                                           slot) == bucket_slots.end();
+        bucket_slots.push_back(slot);
+      }
+      if (placed) {
+        (*pilots)[b] = pilot;
+        for (uint64_t j = begin; j < end; ++j) {
+          taken[bucket_slots[j - begin]] = true;
+          (*slots)[bucket_keys[j]] = bucket_slots[j - begin];
+        }
+      }
+    }
+    if (!placed) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+Status PerfectHashStringMap::Build(absl::Span<const absl::string_view> keys,
+                                   absl::Span<const int64_t> values,
+                                   std::string* buffer) {
+  if (keys.size() != values.size()) {
+    return errors::InvalidArgument("Got ", keys.size(), " keys but ",
+                                   values.size(), " values.");
+  }
+  const uint64_t num_keys = keys.size();
+  uint64_t arena_size = 0;
+  for (const absl::string_view key : keys) {
+    arena_size += kValueSize + key.size();
+  }
+  if (arena_size > std::numeric_limits<uint32_t>::max()) {
+    return errors::InvalidArgument("Entries take ", arena_size,
+                                   " bytes, more than the 4GB supported.");
+  }
+  const uint64_t num_buckets =
+      std::max<uint64_t>(1, (num_keys + kAverageBucketSize - 1) /
+                                kAverageBucketSize);
+  const uint64_t table_size = std::max<uint64_t>(
+      num_keys, static_cast<uint64_t>(num_keys / kLoadFactor));
+
+  uint64_t seed = 0;
+  std::vector<uint64_t> hashes(num_keys);
+  std::vector<uint32_t> pilots;
+  std::vector<uint64_t> slots;
+  for (;; ++seed) {
+    if (seed == kMaxSeeds) {
+      // With distinct keys, this happens with a negligible probability.
+      return errors::Internal("Failed to build a perfect hash of ", num_keys,
+                              " keys.");
+    }
+    for (uint64_t i = 0; i < num_keys; ++i) {
+      hashes[i] = HashKey(keys[i], seed);
+    }
+    if (seed == 0) {
+      // Equal keys have equal hashes.
+      std::vector<uint64_t> sorted(num_keys);
+      for (uint64_t i = 0; i < num_keys; ++i) sorted[i] = i;
+      std::sort(sorted.begin(), sorted.end(), [&](uint64_t a, uint64_t b) {
+        return hashes[a] < hashes[b];
+      });
+      for (uint64_t i = 1; i < num_keys; ++i) {
+        for (uint64_t j = i;
+             j > 0 && hashes[sorted[j - 1]] == hashes[sorted[i]]; --j) {
+          if (keys[sorted[j - 1]] == keys[sorted[i]]) {
+            return errors::InvalidArgument("Duplicate key ", keys[sorted[i]]);
+          }
+        }
+      }
+    }
+    if (FindPilots(hashes, num_buckets, table_size, &pilots, &slots)) break;
+  }
+
+  // Moves the keys past the end to the free slots.
+  std::vector<bool> taken(table_size, false);
+  for (const uint64_t slot : slots) taken[slot] = true;
+  std::vector<uint32_t> remap(table_size - num_keys, 0);
+  uint64_t free_slot = 0;
+  for (uint64_t slot = num_keys; slot < table_size; ++slot) {
+    if (!taken[slot]) continue;
+    while (taken[free_slot]) ++free_slot;
+    remap[slot - num_keys] = free_slot++;
+  }
+  for (uint64_t& slot : slots) {
+    if (slot >= num_keys) slot = remap[slot - num_keys];
+  }
+
+  const Layout layout(num_keys, num_buckets, table_size, arena_size);
+  buffer->assign(layout.size, '\0');
+  char* data = &(*buffer)[0];
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.seed = seed;
+  header.num_keys = num_keys;
+  header.num_buckets = num_buckets;
+  header.table_size = table_size;
+  header.arena_size = arena_size;
+  std::memcpy(data, &header, sizeof(header));
+  std::memcpy(data + layout.pilots, pilots.data(),
+              num_buckets * sizeof(uint32_t));
+  std::memcpy(data + layout.remap, remap.data(),
+              remap.size() * sizeof(uint32_t));
+
+  // Entries in slot order.
+  std::vector<uint64_t> key_of_slot(num_keys);
+  for (uint64_t i = 0; i < num_keys; ++i) key_of_slot[slots[i]] = i;
+  uint32_t offset = 0;
+  for (uint64_t slot = 0; slot < num_keys; ++slot) {
+    const uint64_t i = key_of_slot[slot];
+    std::memcpy(data + layout.offsets + slot * sizeof(uint32_t), &offset,
+                sizeof(offset));
+    std::memcpy(data + layout.arena + offset, &values[i], kValueSize);
+    std::memcpy(data + layout.arena + offset + kValueSize, keys[i].data(),
+                keys[i].size());
+    offset += kValueSize + keys[i].size();
+  }
+  std::memcpy(data + layout.offsets + num_keys * sizeof(uint32_t), &offset,
+              sizeof(offset));
+  return absl::OkStatus();
+}
+
+Status PerfectHashStringMap::Create(
+    absl::Span<const absl::string_view> keys, absl::Span<const int64_t> values,
+    std::unique_ptr<PerfectHashStringMap>* map) {
+  std::unique_ptr<PerfectHashStringMap> result(new PerfectHashStringMap());
+  TF_RETURN_IF_ERROR(Build(keys, values, &result->owned_buffer_));
+  result->buffer_ = result->owned_buffer_;
+  TF_RETURN_IF_ERROR(result->Parse());
+  *map = std::move(result);
+  return absl::OkStatus();
+}
+
+Status PerfectHashStringMap::FromFile(
+    Env* env, const std::string& filename,
+    std::unique_ptr<PerfectHashStringMap>* map) {
+  std::unique_ptr<PerfectHashStringMap> result(new PerfectHashStringMap());
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &result->region_));
+  result->buffer_ =
+      absl::string_view(static_cast<const char*>(result->region_->data()),
+                        result->region_->length());
+  TF_RETURN_IF_ERROR(result->Parse());
+  *map = std::move(result);
+  return absl::OkStatus();
+}
+
+Status PerfectHashStringMap::FromBuffer(
+    absl::string_view buffer, std::unique_ptr<PerfectHashStringMap>* map) {
+  std::unique_ptr<PerfectHashStringMap> result(new PerfectHashStringMap());
+  result->buffer_ = buffer;
+  TF_RETURN_IF_ERROR(result->Parse());
+  *map = std::move(result);
+  return absl::OkStatus();
+}
+
+Status PerfectHashStringMap::Parse() {
+  if (reinterpret_cast<uintptr_t>(buffer_.data()) % 8 != 0) {
+    return errors::InvalidArgument("Perfect hash map buffer isn't aligned.");
+  }
+  Header header;
+  if (buffer_.size() < sizeof(header)) {
+    return errors::DataLoss("Perfect hash map is truncated.");
+  }
+  std::memcpy(&header, buffer_.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return errors::DataLoss("Not a perfect hash map.");
+  }
+  const uint64_t max_size = buffer_.size();
+  if (header.num_keys > max_size || header.num_buckets > max_size ||
+      header.num_buckets == 0 || header.table_size > 2 * max_size ||
+      header.table_size < header.num_keys ||
+      header.arena_size > max_size ||
+      Layout(header.num_keys, header.num_buckets, header.table_size,
+             header.arena_size)
+              .size != buffer_.size()) {
+    return errors::DataLoss("Perfect hash map has an invalid size.");
+  }
+  const Layout layout(header.num_keys, header.num_buckets, header.table_size,
+                      header.arena_size);
+  const char* data = buffer_.data();
+  seed_ = header.seed;
+  num_keys_ = header.num_keys;
+  num_buckets_ = header.num_buckets;
+  table_size_ = header.table_size;
+  pilots_ = reinterpret_cast<const uint32_t*>(data + layout.pilots);
+  remap_ = reinterpret_cast<const uint32_t*>(data + layout.remap);
+  offsets_ = reinterpret_cast<const uint32_t*>(data + layout.offsets);
+  arena_ = data + layout.arena;
+  // Entries are read without bounds checks.
+  if (offsets_[0] != 0 || offsets_[num_keys_] != header.arena_size) {
+    return errors::DataLoss("Perfect hash map has invalid keys.");
+  }
+  for (uint64_t slot = 0; slot < num_keys_; ++slot) {
+    if (offsets_[slot + 1] < offsets_[slot] ||
+        offsets_[slot + 1] - offsets_[slot] < kValueSize) {
+      return errors::DataLoss("Perfect hash map has invalid keys.");
+    }
+  }
+  for (uint64_t i = 0; i < table_size_ - num_keys_; ++i) {
+    if (remap_[i] >= num_keys_) {
+      return errors::DataLoss("Perfect hash map has invalid slots.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+bool PerfectHashStringMap::Find(absl::string_view key, int64_t* value) const {
+  if (num_keys_ == 0) return false;
+  const uint64_t slot = SlotOfKey(HashKey(key, seed_));
+  if (this->key(slot) != key) return false;
+  *value = this->value(slot);
+  return true;
+}
+
+void PerfectHashStringMap::FindBatch(absl::Span<const absl::string_view> keys,
+                                     int64_t default_value,
+                                     int64_t* values) const {
+  if (num_keys_ == 0) {
+    std::fill(values, values + keys.size(), default_value);
+    return;
+  }
+  // Every lookup reads a pilot, an offset and an entry, each depending on the
+  // previous one. The reads of a block of keys are issued stage by stage, so
+  // that their cache misses overlap.
+  uint64_t hashes[kFindBlockSize];
+  uint64_t slots[kFindBlockSize];
+  for (size_t begin = 0; begin < keys.size(); begin += kFindBlockSize) {
+    const int n = std::min<size_t>(kFindBlockSize, keys.size() - begin);
+    for (int j = 0; j < n; ++j) {
+      hashes[j] = HashKey(keys[begin + j], seed_);
+      port::prefetch<port::PREFETCH_HINT_T0>(
+          &pilots_[BucketOf(hashes[j], num_buckets_)]);
+    }
+    for (int j = 0; j < n; ++j) {
+      slots[j] = SlotOfKey(hashes[j]);
+      port::prefetch<port::PREFETCH_HINT_T0>(&offsets_[slots[j]]);
+    }
+    for (int j = 0; j < n; ++j) {
+      port::prefetch<port::PREFETCH_HINT_T0>(arena_ + offsets_[slots[j]]);
+    }
+    for (int j = 0; j < n; ++j) {
+      values[begin + j] = key(slots[j]) == keys[begin + j] ? value(slots[j])
+                                                           : default_value;
+    }
+  }
+}
+
+uint64_t PerfectHashStringMap::SlotOfKey(uint64_t hash) const {
+  const uint64_t slot =
+      SlotOf(hash, pilots_[BucketOf(hash, num_buckets_)], table_size_);
+  return slot < num_keys_ ? slot : remap_[slot - num_keys_];
+}
+
+absl::string_view PerfectHashStringMap::key(int64_t slot) const {
+  return absl::string_view(arena_ + offsets_[slot] + kValueSize,
+                           offsets_[slot + 1] - offsets_[slot] - kValueSize);
+}
+
+int64_t PerfectHashStringMap::value(int64_t slot) const {
+  int64_t value;
+  std::memcpy(&value, arena_ + offsets_[slot], kValueSize);
+  return value;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_KERNELS_PERFECT_HASH_STRING_MAP_H_
+#define TENSORFLOW_CORE_KERNELS_PERFECT_HASH_STRING_MAP_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Immutable map from strings to int64 values, for large static vocabularies.
+//
+// The keys are indexed with a minimal perfect hash function (PTHash): every
+// key is hashed to a bucket, and every bucket stores a 32-bit pilot that,
+// mixed with the hash, sends its keys to distinct slots of a table a few
+// percent larger than size(). The few slots past size() are remapped to the
+// free ones. The entries are packed in slot order in a single arena, every
+// value next to its key, so a lookup costs one string hash, three memory
+// accesses and one string comparison, and the map takes about 13 bytes per
+// entry plus the key characters.
+//
+// The whole map is a single flat buffer, which Build() writes. The buffer can
+// be saved to a file offline, and memory-mapped by FromFile(). It uses the
+// native byte order.
+class PerfectHashStringMap {
+ public:
+  // Writes the map from keys[i] to values[i] to `buffer`. The keys must be
+  // distinct, and their total size smaller than 4GB.
+  static Status Build(absl::Span<const absl::string_view> keys,
+                      absl::Span<const int64_t> values, std::string* buffer);
+
+  // Builds the map and keeps it in memory.
+  static Status Create(absl::Span<const absl::string_view> keys,
+                       absl::Span<const int64_t> values,
+                       std::unique_ptr<PerfectHashStringMap>* map);
+
+  // Memory-maps a map written by Build() to `filename`.
+  static Status FromFile(Env* env, const std::string& filename,
+                         std::unique_ptr<PerfectHashStringMap>* map);
+
+  // Reads a map written by Build(). `buffer` must be 8-byte aligned and
+  // outlive the map.
+  static Status FromBuffer(absl::string_view buffer,
+                           std::unique_ptr<PerfectHashStringMap>* map);
+
+  // Sets `value` to the value of `key` and returns true if it's in the map.
+  bool Find(absl::string_view key, int64_t* value) const;
+
+  // Sets values[i] to the value of keys[i], or to `default_value` if it isn't
+  // in the map. Faster than Find() for many keys, as the memory accesses of
+  // several keys are overlapped.
+  void FindBatch(absl::Span<const absl::string_view> keys,
+                 int64_t default_value, int64_t* values) const;
+
+  int64_t size() const { return num_keys_; }
+
+  // Key and value of the entry in `slot`, in [0, size()).
+  absl::string_view key(int64_t slot) const;
+  int64_t value(int64_t slot) const;
+
+  // Size of the buffer holding the map.
+  int64_t MemoryUsed() const { return buffer_.size(); }
+
+ private:
+  PerfectHashStringMap() = default;
+
+  // Parses `buffer_` and points the members below into it.
+  Status Parse();
+  uint64_t SlotOfKey(uint64_t hash) const;
+
+  std::string owned_buffer_;
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  absl::string_view buffer_;
+
+  uint64_t seed_ = 0;
+  uint64_t num_keys_ = 0;
+  uint64_t num_buckets_ = 0;
+  uint64_t table_size_ = 0;
+  const uint32_t* pilots_ = nullptr;
+  const uint32_t* remap_ = nullptr;
+  const uint32_t* offsets_ = nullptr;
+  const char* arena_ = nullptr;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_PERFECT_HASH_STRING_MAP_H_
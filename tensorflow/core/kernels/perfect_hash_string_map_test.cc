@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/kernels/perfect_hash_string_map.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void MakeVocabulary(int size, std::vector<std::string>* keys,
+                    std::vector<int64_t>* values) {
+  for (int i = 0; i < size; ++i) {
+    keys->push_back(absl::StrCat("token_", i * 31));
+    values->push_back(i);
+  }
+}
+
+std::vector<absl::string_view> Views(const std::vector<std::string>& keys) {
+  return std::vector<absl::string_view>(keys.begin(), keys.end());
+}
+
+TEST(PerfectHashStringMapTest, FindsAllKeys) {
+  std::vector<std::string> keys;
+  std::vector<int64_t> values;
+  MakeVocabulary(10000, &keys, &values);
+  std::unique_ptr<PerfectHashStringMap> map;
+  TF_ASSERT_OK(PerfectHashStringMap::Create(Views(keys), values, &map));
+  ASSERT_EQ(map->size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    int64_t value = -1;
+    ASSERT_TRUE(map->Find(keys[i], &value)) << keys[i];
+    EXPECT_EQ(value, values[i]);
+  }
+  int64_t value = -1;
+  EXPECT_FALSE(map->Find("token_1", &value));
+  EXPECT_FALSE(map->Find("", &value));
+  EXPECT_EQ(value, -1);
+
+  // The slots hold every entry once.
+  int64_t sum = 0;
+  for (int64_t slot = 0; slot < map->size(); ++slot) {
+    int64_t found;
+    ASSERT_TRUE(map->Find(map->key(slot), &found));
+    EXPECT_EQ(found, map->value(slot));
+    sum += found;
+  }
+  EXPECT_EQ(sum, 10000LL * 9999 / 2);
+}
+
+TEST(PerfectHashStringMapTest, FindBatch) {
+  std::vector<std::string> keys;
+  std::vector<int64_t> values;
+  MakeVocabulary(100, &keys, &values);
+  std::unique_ptr<PerfectHashStringMap> map;
+  TF_ASSERT_OK(PerfectHashStringMap::Create(Views(keys), values, &map));
+  std::vector<absl::string_view> queries;
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 50; ++i) {
+    queries.push_back(keys[(i * 7) % keys.size()]);
+    expected.push_back((i * 7) % keys.size());
+    queries.push_back("missing");
+    expected.push_back(-1);
+  }
+  std::vector<int64_t> found(queries.size());
+  map->FindBatch(queries, /*default_value=*/-1, found.data());
+  EXPECT_EQ(found, expected);
+}
+
+TEST(PerfectHashStringMapTest, SmallAndEmptyMaps) {
+  std::unique_ptr<PerfectHashStringMap> map;
+  TF_ASSERT_OK(PerfectHashStringMap::Create({}, {}, &map));
+  int64_t value;
+  EXPECT_EQ(map->size(), 0);
+  EXPECT_FALSE(map->Find("a", &value));
+
+  TF_ASSERT_OK(PerfectHashStringMap::Create({""}, {7}, &map));
+  ASSERT_TRUE(map->Find("", &value));
+  EXPECT_EQ(value, 7);
+  EXPECT_FALSE(map->Find("a", &value));
+}
+
+TEST(PerfectHashStringMapTest, RejectsDuplicateKeys) {
+  std::unique_ptr<PerfectHashStringMap> map;
+  EXPECT_FALSE(
+      PerfectHashStringMap::Create({"a", "b", "a"}, {1, 2, 3}, &map).ok());
+  EXPECT_FALSE(PerfectHashStringMap::Create({"a", "b"}, {1}, &map).ok());
+}
+
+TEST(PerfectHashStringMapTest, MemoryMapsFile) {
+  std::vector<std::string> keys;
+  std::vector<int64_t> values;
+  MakeVocabulary(1000, &keys, &values);
+  std::string buffer;
+  TF_ASSERT_OK(PerfectHashStringMap::Build(Views(keys), values, &buffer));
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "perfect_hash_string_map");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, buffer));
+
+  std::unique_ptr<PerfectHashStringMap> map;
+  TF_ASSERT_OK(PerfectHashStringMap::FromFile(Env::Default(), filename, &map));
+  int64_t value;
+  ASSERT_TRUE(map->Find(keys[123], &value));
+  EXPECT_EQ(value, 123);
+  EXPECT_EQ(map->MemoryUsed(), buffer.size());
+
+  // Corrupted buffers are rejected.
+  buffer[0] = 'X';
+  EXPECT_FALSE(PerfectHashStringMap::FromBuffer(buffer, &map).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,7 +20,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -72,6 +74,93 @@ struct FillPhiloxRandom {
   }
 };
 
+// Returns the same samples as a PhiloxRandom, but computes kBatchSize of them
+// at a time, with each round of Philox run on all of the counters together so
+// that it is vectorized.
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static constexpr int kElementCost = PhiloxRandom::kElementCost;
+  static constexpr int kBatchSize = 16;
+
+  explicit BatchedPhiloxRandom(const PhiloxRandom& gen)
+      : counter_(gen.counter()), key_(gen.key()) {}
+
+  ResultType operator()() {
+    if (next_ == kBatchSize) Refill();
+    return samples_[next_++];
+  }
+
+ private:
+  // The constants of PhiloxRandom.
+  static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
+  static constexpr uint32_t kPhiloxW32B = 0xBB67AE85;
+  static constexpr uint32_t kPhiloxM4x32A = 0xD2511F53;
+  static constexpr uint32_t kPhiloxM4x32B = 0xCD9E8D57;
+  static constexpr int kNumRounds = 10;
+
+  void Refill() {
+    // The counters, one array per word.
+    uint32_t c0[kBatchSize], c1[kBatchSize], c2[kBatchSize], c3[kBatchSize];
+    for (int i = 0; i < kBatchSize; ++i) {
+      c0[i] = counter_[0];
+      c1[i] = counter_[1];
+      c2[i] = counter_[2];
+      c3[i] = counter_[3];
+      if (++counter_[0] == 0 && ++counter_[1] == 0 && ++counter_[2] == 0) {
+        ++counter_[3];
+      }
+    }
+    uint32_t key0 = key_[0];
+    uint32_t key1 = key_[1];
+    for (int round = 0; round < kNumRounds; ++round) {
+      for (int i = 0; i < kBatchSize; ++i) {
+        const uint64_t product0 = uint64_t{kPhiloxM4x32A} * c0[i];
+        const uint64_t product1 = uint64_t{kPhiloxM4x32B} * c2[i];
+        c0[i] = static_cast<uint32_t>(product1 >> 32) ^ c1[i] ^ key0;
+        c2[i] = static_cast<uint32_t>(product0 >> 32) ^ c3[i] ^ key1;
+        c1[i] = static_cast<uint32_t>(product1);
+        c3[i] = static_cast<uint32_t>(product0);
+      }
+      key0 += kPhiloxW32A;
+      key1 += kPhiloxW32B;
+    }
+    for (int i = 0; i < kBatchSize; ++i) {
+      samples_[i][0] = c0[i];
+      samples_[i][1] = c1[i];
+      samples_[i][2] = c2[i];
+      samples_[i][3] = c3[i];
+    }
+    next_ = 0;
+  }
+
+  ResultType counter_;
+  PhiloxRandom::Key key_;
+  ResultType samples_[kBatchSize];
+  int next_ = kBatchSize;
+};
+
+// The same distribution as `Distribution`, but drawing from a
+// BatchedPhiloxRandom. Only for the distributions without state, i.e. that
+// are default-constructible.
+template <class Distribution, class = void>
+struct BatchedDistribution {
+  static constexpr bool kSupported = false;
+};
+
+template <template <class, class> class Distribution, typename T>
+struct BatchedDistribution<
+    Distribution<PhiloxRandom, T>,
+    std::enable_if_t<
+        std::is_empty<Distribution<PhiloxRandom, T>>::value &&
+        std::is_default_constructible<
+            Distribution<BatchedPhiloxRandom, T>>::value>> {
+  static constexpr bool kSupported = true;
+  using Type = Distribution<BatchedPhiloxRandom, T>;
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -83,15 +172,28 @@ struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
   static void Run(random::PhiloxRandom gen, T* data, int64_t size,
                   int64_t start_group, int64_t limit_group, Distribution dist) {
-    const int kGroupSize = Distribution::kResultElementCount;
-
     gen.Skip(start_group);
+    if constexpr (BatchedDistribution<Distribution>::kSupported) {
+      // Gives the same samples, faster.
+      BatchedPhiloxRandom batched_gen(gen);
+      typename BatchedDistribution<Distribution>::Type batched_dist;
+      Fill(&batched_gen, data, size, start_group, limit_group, batched_dist);
+    } else {
+      Fill(&gen, data, size, start_group, limit_group, dist);
+    }
+  }
+
+ private:
+  template <class Generator, class GeneratorDistribution>
+  static void Fill(Generator* gen, T* data, int64_t size, int64_t start_group,
+                   int64_t limit_group, GeneratorDistribution& dist) {
+    const int kGroupSize = Distribution::kResultElementCount;
     int64_t offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -99,7 +201,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64_t remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
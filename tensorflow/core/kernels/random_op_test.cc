@@ -13,12 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <random>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/random_op_cpu.h"
 #include "tensorflow/core/lib/math/math_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -100,6 +106,87 @@ void BM_cpu_RandomGamma(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_cpu_RandomGamma)->RangePair(1 << 14, 4 << 15, 2, 50);
 
+// Counters of which the first words wrap around within a batch.
+std::vector<random::PhiloxRandom::ResultType> TestCounters() {
+  return {{0, 0, 0, 0},
+          {0xFFFFFFF5, 0, 0, 0},
+          {0xFFFFFFF5, 0xFFFFFFFF, 7, 0},
+          {0xFFFFFFF5, 0xFFFFFFFF, 0xFFFFFFFF, 3},
+          {0xFFFFFFF5, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF},
+          {0x12345678, 0x9ABCDEF0, 0x0FEDCBA9, 0x87654321}};
+}
+
+TEST(BatchedPhiloxRandomTest, MatchesPhiloxRandom) {
+  const random::PhiloxRandom::Key key = {0xDEADBEEF, 0x01234567};
+  for (const auto& counter : TestCounters()) {
+    random::PhiloxRandom gen(counter, key);
+    functor::BatchedPhiloxRandom batched_gen(gen);
+    // Several batches, so that the counter is carried over between them.
+    for (int i = 0; i < 5 * functor::BatchedPhiloxRandom::kBatchSize + 3;
+         ++i) {
+      const auto expected = gen();
+      const auto actual = batched_gen();
+      for (int j = 0; j < random::PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(actual[j], expected[j])
+            << "counter " << counter[0] << " " << counter[1] << " "
+            << counter[2] << " " << counter[3] << ", sample " << i
+            << ", word " << j;
+      }
+    }
+  }
+}
+
+template <class Distribution>
+void ExpectFillMatchesPhiloxRandom() {
+  using T = typename Distribution::ResultElementType;
+  constexpr int kGroupSize = Distribution::kResultElementCount;
+  // Not a multiple of the group size, so the last group is partial.
+  constexpr int64_t kSize = 50 * kGroupSize + 1;
+  constexpr int64_t kNumGroups = (kSize + kGroupSize - 1) / kGroupSize;
+  for (const auto& counter : TestCounters()) {
+    const random::PhiloxRandom gen(counter, {0x89ABCDEF, 0x76543210});
+    std::vector<T> expected(kNumGroups * kGroupSize);
+    random::PhiloxRandom expected_gen = gen;
+    Distribution dist;
+    for (int64_t g = 0; g < kNumGroups; ++g) {
+      const auto samples = dist(&expected_gen);
+      std::copy(&samples[0], &samples[0] + kGroupSize,
+                &expected[g * kGroupSize]);
+    }
+    // Starts from a group other than the first, as the shards of a kernel do.
+    for (int64_t start_group : {0, 3}) {
+      std::vector<T> actual(kSize);
+      functor::FillPhiloxRandomTask<Distribution, false>::Run(
+          gen, actual.data(), kSize, start_group, kNumGroups, Distribution());
+      for (int64_t i = start_group * kGroupSize; i < kSize; ++i) {
+        ASSERT_EQ(std::memcmp(&actual[i], &expected[i], sizeof(T)), 0)
+            << actual[i] << " vs " << expected[i] << ", start group "
+            << start_group << ", element " << i;
+      }
+    }
+  }
+}
+
+TEST(BatchedPhiloxRandomTest, UniformFloatFillMatchesPhiloxRandom) {
+  ExpectFillMatchesPhiloxRandom<
+      random::UniformDistribution<random::PhiloxRandom, float>>();
+}
+
+TEST(BatchedPhiloxRandomTest, NormalFloatFillMatchesPhiloxRandom) {
+  ExpectFillMatchesPhiloxRandom<
+      random::NormalDistribution<random::PhiloxRandom, float>>();
+}
+
+TEST(BatchedPhiloxRandomTest, NormalDoubleFillMatchesPhiloxRandom) {
+  ExpectFillMatchesPhiloxRandom<
+      random::NormalDistribution<random::PhiloxRandom, double>>();
+}
+
+TEST(BatchedPhiloxRandomTest, UniformFullIntFillMatchesPhiloxRandom) {
+  ExpectFillMatchesPhiloxRandom<
+      random::UniformFullIntDistribution<random::PhiloxRandom, int64_t>>();
+}
+
 void BM_PhiloxRandom(::testing::benchmark::State& state) {
   // Fill 2M random numbers
   int count = 2 << 20;
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -26,6 +29,15 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Returns true if `regex` only matches its pattern literally and `rewrite`
+// has no backreference, so that the replacement can be done with plain string
+// search.
+bool IsLiteralReplacement(const RE2& regex, const string& rewrite) {
+  const string& pattern = regex.pattern();
+  return !pattern.empty() && RE2::QuoteMeta(pattern) == pattern &&
+         !absl::StrContains(rewrite, '\\');
+}
+
 // Execute the specified regex using the given context.
 // Context requirements:
 //  - "input" string Tensor at input_index=0
@@ -48,7 +60,30 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
+  if (IsLiteralReplacement(regex, rewrite)) {
+    const string& pattern = regex.pattern();
+    for (size_t i = 0; i < output_flat.size(); ++i) {
+      const absl::string_view input(output_flat(i));
+      const size_t pos = input.find(pattern);
+      if (pos == absl::string_view::npos) continue;
+      if (replace_global) {
+        output_flat(i) =
+            absl::StrReplaceAll(input, {{absl::string_view(pattern), rewrite}});
+      } else {
+        string buf(input);
+        buf.replace(pos, pattern.size(), rewrite);
+        output_flat(i) = std::move(buf);
+      }
+    }
+    return absl::OkStatus();
+  }
   for (size_t i = 0; i < output_flat.size(); ++i) {
+    // Most strings often don't match at all, which the DFA checks without
+    // copying them or extracting submatches.
+    if (!regex.Match(absl::string_view(output_flat(i)), 0,
+                     output_flat(i).size(), RE2::UNANCHORED, nullptr, 0)) {
+      continue;
+    }
     // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
     // accept std::string.
     string buf = output_flat(i);
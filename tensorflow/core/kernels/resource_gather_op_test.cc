@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::monitoring::testing::CellReader;
+
+constexpr char kLookupsMetric[] =
+    "/tensorflow/core/resource_gather_hot_row_cache_lookups";
+
+class ResourceGatherOpTest : public OpsTestBase {
+ protected:
+  // Gathers rows of a [5, 2] variable whose row `i` is {i, -i} plus `offset`.
+  void MakeOp(int64_t hot_row_cache_rows, const std::vector<int32>& indices) {
+    TF_ASSERT_OK(NodeDefBuilder("gather", "ResourceGather")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("hot_row_cache_rows", hot_row_cache_rows)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    var_ = new Var(DT_FLOAT);
+    SetTable(/*offset=*/0);
+    var_->is_initialized = true;
+    AddResourceInput("", "table", var_);
+    const int64_t num_indices = indices.size();
+    AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+  }
+
+  // Assigns a new buffer to the variable.
+  void SetTable(float offset) {
+    std::vector<float> values;
+    for (int i = 0; i < 5; ++i) {
+      values.push_back(i + offset);
+      values.push_back(-i + offset);
+    }
+    *var_->tensor() = test::AsTensor<float>(values, TensorShape({5, 2}));
+  }
+
+  // Expects the output to be the rows of `indices`.
+  void ExpectGathered(const std::vector<int32>& indices, float offset) {
+    std::vector<float> values;
+    for (const int32 i : indices) {
+      values.push_back(i + offset);
+      values.push_back(-i + offset);
+    }
+    const int64_t num_indices = indices.size();
+    test::ExpectTensorEqual<float>(
+        *GetOutput(0),
+        test::AsTensor<float>(values, TensorShape({num_indices, 2})));
+  }
+
+  // Owned by the resource manager.
+  Var* var_ = nullptr;
+};
+
+TEST_F(ResourceGatherOpTest, HotRowCacheMatchesGather) {
+  CellReader<int64_t> lookups(kLookupsMetric);
+  const std::vector<int32> indices = {3, 1, 3, 4, 1, 3};
+  MakeOp(/*hot_row_cache_rows=*/2, indices);
+
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectGathered(indices, /*offset=*/0);
+  EXPECT_EQ(lookups.Delta("hit"), 0);
+  EXPECT_EQ(lookups.Delta("miss"), 6);
+
+  // The two most frequent rows were admitted.
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectGathered(indices, /*offset=*/0);
+  EXPECT_EQ(lookups.Delta("hit"), 5);
+  EXPECT_EQ(lookups.Delta("miss"), 1);
+}
+
+TEST_F(ResourceGatherOpTest, NewBufferResetsHotRowCache) {
+  const std::vector<int32> indices = {2, 0, 2};
+  MakeOp(/*hot_row_cache_rows=*/5, indices);
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectGathered(indices, /*offset=*/0);
+
+  SetTable(/*offset=*/100);
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectGathered(indices, /*offset=*/100);
+}
+
+TEST_F(ResourceGatherOpTest, HotRowCacheIsOffByDefault) {
+  CellReader<int64_t> lookups(kLookupsMetric);
+  const std::vector<int32> indices = {1, 1};
+  MakeOp(/*hot_row_cache_rows=*/0, indices);
+  TF_ASSERT_OK(RunOpKernel());
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectGathered(indices, /*offset=*/0);
+  EXPECT_EQ(lookups.Delta("hit"), 0);
+  EXPECT_EQ(lookups.Delta("miss"), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -57,13 +57,17 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #endif
 
+#include <algorithm>
 #include <memory>
 #include <type_traits>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -73,6 +77,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/gather_functor.h"
 #include "tensorflow/core/kernels/gather_nd_op.h"
+#include "tensorflow/core/kernels/hot_row_cache.h"
 #include "tensorflow/core/kernels/resource_variable_ops.h"
 #include "tensorflow/core/kernels/resource_variable_util.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
@@ -87,6 +92,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -715,6 +721,9 @@ class ResourceGatherOp : public OpKernel {
     OP_REQUIRES(c, batch_dims_ >= 0,
                 absl::InvalidArgumentError(absl::StrCat(
                     "batch_dims is negative (", batch_dims_, ")")));
+    // Only for tables that are not updated in place while they are read,
+    // e.g. when serving, since the cached rows are copies.
+    OP_REQUIRES_OK(c, c->GetAttr("hot_row_cache_rows", &hot_row_cache_rows_));
   }
 
   void Compute(OpKernelContext* c) override {
@@ -799,6 +808,14 @@ class ResourceGatherOp : public OpKernel {
       const auto indices_flat = op_indices->flat<Index>();
       auto out_flat = out->shaped<T, 3>({1, N, out->NumElements() / N});
 
+      if (hot_row_cache_rows_ > 0 && batch_dims_ == 0 &&
+          std::is_same<Device, CPUDevice>::value &&
+          DataTypeCanUseMemcpy(params.dtype())) {
+        GatherWithHotRowCache(c, v.get(), params, indices_flat,
+                              gather_dim_size, inner_size, out);
+        return;
+      }
+
       functor::GatherFunctor<Device, T, Index> functor;
       int64_t bad_i = functor(c, params_flat, indices_flat, out_flat);
 
@@ -838,7 +855,108 @@ class ResourceGatherOp : public OpKernel {
     }
   }
 
+  // Gathers the rows of `indices` from the [gather_dim_size, inner_size]
+  // `params`, looking them up in the hot row cache first, and offers the
+  // missed rows to the cache.
+  void GatherWithHotRowCache(OpKernelContext* c, Var* v, const Tensor& params,
+                             typename TTypes<Index>::ConstFlat indices,
+                             int64_t gather_dim_size, int64_t inner_size,
+                             Tensor* out) {
+    const int64_t N = indices.size();
+    std::vector<int64_t> ids(N);
+    for (int64_t i = 0; i < N; ++i) {
+      OP_REQUIRES(c, FastBoundsCheck(indices(i), gather_dim_size),
+                  errors::InvalidArgument(
+                      "indices", SliceDebugString(c->input(1).shape(), i),
+                      " = ", indices(i), " is not in [0, ",
+                      params.dim_size(0), ")"));
+      ids[i] = indices(i);
+    }
+    const int64_t row_bytes = inner_size * sizeof(T);
+    const char* params_data =
+        reinterpret_cast<const char*>(params.flat<T>().data());
+    char* out_data = reinterpret_cast<char*>(out->flat<T>().data());
+    std::shared_ptr<HotRowCache> cache =
+        GetHotRowCache(v, params_data, gather_dim_size, row_bytes);
+
+    mutex misses_mu;
+    std::vector<int64_t> misses;
+    auto gather = [&](int64_t begin, int64_t end) {
+      const absl::Span<const int64_t> shard_ids =
+          absl::MakeConstSpan(ids).subspan(begin, end - begin);
+      std::vector<int64_t> shard_misses;
+      cache->Lookup(shard_ids, out_data + begin * row_bytes, &shard_misses);
+      if (shard_misses.empty()) return;
+      // Copies the missed rows from the table, and makes their positions
+      // relative to `ids`.
+      for (int64_t& miss : shard_misses) {
+        memcpy(out_data + (begin + miss) * row_bytes,
+               params_data + shard_ids[miss] * row_bytes, row_bytes);
+        miss += begin;
+      }
+      mutex_lock l(misses_mu);
+      misses.insert(misses.end(), shard_misses.begin(), shard_misses.end());
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, N,
+          std::max<int64_t>(row_bytes, 1), gather);
+
+    cache->Update(ids, misses,
+                  [&](int64_t id) { return params_data + id * row_bytes; });
+    metrics::RecordResourceGatherHotRowCacheLookups(N - misses.size(),
+                                                    misses.size());
+  }
+
+  // The hot row cache of a variable.
+  struct HotRowCacheEntry {
+    // Tells whether the variable is still the one at the key address.
+    core::WeakPtr<Var> var;
+    std::shared_ptr<HotRowCache> cache;
+    // The buffer and shape of the variable the cache was filled from.
+    const char* data = nullptr;
+    int64_t num_rows = 0;
+  };
+
+  // Returns the cache of the rows of `v`, whose table is at `params_data`.
+  // The cache is reset if the variable was assigned a new buffer or shape.
+  std::shared_ptr<HotRowCache> GetHotRowCache(Var* v, const char* params_data,
+                                              int64_t num_rows,
+                                              int64_t row_bytes) {
+    mutex_lock l(hot_row_caches_mu_);
+    auto it = hot_row_caches_.find(v);
+    if (it != hot_row_caches_.end() && it->second.var.GetNewRef().get() != v) {
+      // A destroyed variable was at this address.
+      hot_row_caches_.erase(it);
+      it = hot_row_caches_.end();
+    }
+    if (it == hot_row_caches_.end()) {
+      // Drops the caches of the destroyed variables.
+      absl::erase_if(hot_row_caches_, [](const auto& entry) {
+        return entry.second.var.GetNewRef() == nullptr;
+      });
+      HotRowCacheEntry entry;
+      entry.var = core::WeakPtr<Var>(v);
+      it = hot_row_caches_.emplace(v, std::move(entry)).first;
+    }
+    HotRowCacheEntry& entry = it->second;
+    if (entry.cache == nullptr || entry.data != params_data ||
+        entry.num_rows != num_rows || entry.cache->row_bytes() != row_bytes) {
+      entry.cache = std::make_shared<HotRowCache>(
+          std::min(hot_row_cache_rows_, num_rows), row_bytes);
+      entry.data = params_data;
+      entry.num_rows = num_rows;
+    }
+    return entry.cache;
+  }
+
   int32 batch_dims_ = 0;
+  // Maximum number of rows in the hot row cache, 0 if it is disabled.
+  int64_t hot_row_cache_rows_ = 0;
+  mutex hot_row_caches_mu_;
+  // The hot row caches of the variables gathered by the kernel.
+  absl::flat_hash_map<const Var*, HotRowCacheEntry> hot_row_caches_
+      TF_GUARDED_BY(hot_row_caches_mu_);
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -16,16 +16,24 @@ limitations under the License.
 // See docs in ../ops/io_ops.cc.
 
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -90,12 +98,81 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Whether `prefix` is named like the shards of ShardedFilename, i.e.
+// "<basename>-%05d-of-%05d", which MergeV2Checkpoints merges.
+bool IsShardPrefix(absl::string_view prefix) {
+  constexpr absl::string_view kSuffix = "-00000-of-00000";
+  if (prefix.size() < kSuffix.size()) return false;
+  prefix.remove_prefix(prefix.size() - kSuffix.size());
+  for (size_t i = 0; i < kSuffix.size(); ++i) {
+    if (kSuffix[i] == '0' ? !absl::ascii_isdigit(prefix[i])
+                          : prefix[i] != kSuffix[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A tensor to save with SaveV2.
+struct SavedTensor {
+  string name;
+  Tensor tensor;
+  // Set if only a slice of the full tensor is saved.
+  bool is_slice = false;
+  TensorShape full_shape;
+  TensorSlice slice;
+};
+
+// Writes `tensors` to the checkpoint `prefix`.
+Status WriteCheckpoint(const string& prefix,
+                       const std::vector<SavedTensor>& tensors) {
+  BundleWriter writer(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (const SavedTensor& saved : tensors) {
+    const Tensor& tensor = saved.tensor;
+    VLOG(2) << "Starting save of " << saved.name;
+    if (saved.is_slice) {
+      TF_RETURN_IF_ERROR(
+          writer.AddSlice(saved.name, saved.full_shape, saved.slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(saved.name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << saved.name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("async_save_max_bytes",
+                                             &async_save_max_bytes_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -111,57 +188,50 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<SavedTensor> tensors(num_tensors);
+    int64_t num_bytes = 0;
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
+      SavedTensor& saved = tensors[i];
+      saved.name = tensor_names_flat(i);
+      // Shares the buffer of the input.
+      saved.tensor = context->input(i + kFixedInputs);
+      num_bytes += saved.tensor.TotalBytes();
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
+        const Tensor& tensor = saved.tensor;
+        saved.is_slice = true;
+        saved.slice = TensorSlice(tensor.dims());
         TensorShape slice_shape;
 
         OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
+                                    shape_spec, &saved.full_shape,
+                                    &saved.slice, &slice_shape));
         OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
       }
+    }
 
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
+    if (async_save_max_bytes_ > 0 && IsShardPrefix(prefix_string)) {
+      // The inputs may share their buffers with ref variables, which are
+      // updated in place. The executor dereferences ref inputs before
+      // Compute, so they can't be told apart from other inputs and all of
+      // them are copied.
+      for (SavedTensor& saved : tensors) {
+        saved.tensor = tensor::DeepCopy(saved.tensor);
       }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      checkpoint::AsyncCheckpointWriter::Global()->Schedule(
+          prefix_string, num_bytes, async_save_max_bytes_,
+          [prefix_string, tensors = std::move(tensors)]() {
+            return WriteCheckpoint(prefix_string, tensors);
+          });
+    } else {
+      OP_REQUIRES_OK(context, WriteCheckpoint(prefix_string, tensors));
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -182,6 +252,10 @@ class SaveV2 : public OpKernel {
       checkpoint_callback_manager->Unref();
     }
   }
+
+ private:
+  // If positive, saves asynchronously within this many bytes of snapshots.
+  int64_t async_save_max_bytes_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -205,6 +279,9 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    // Waits for the asynchronous saves of the checkpoint, if any.
+    OP_REQUIRES_OK(context, checkpoint::AsyncCheckpointWriter::Global()->Wait(
+                                prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -287,6 +364,11 @@ class MergeV2Checkpoints : public OpKernel {
         absl::Span<const tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context,
+                     checkpoint::AsyncCheckpointWriter::Global()->Wait(
+                         input_prefix));
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
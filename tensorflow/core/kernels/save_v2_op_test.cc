@@ -22,13 +22,16 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -340,5 +343,85 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                     .Input(FakeInput())            // prefix
+                     .Input(FakeInput())            // tensor_names
+                     .Input(FakeInput())            // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT}))  // tensors
+                     .Attr("async_save_max_bytes", 1 << 20)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddInputs(const string& prefix) {
+    AddInput<tstring>(TensorShape({}),
+                      [&prefix](int x) -> tstring { return prefix; });
+    AddInput<tstring>(TensorShape({1}),
+                      [](int x) -> tstring { return "tensor_float"; });
+    AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+    AddInput<float>(TensorShape({2, 4}),
+                    [](int x) -> float { return static_cast<float>(x) / 10; });
+  }
+
+  void ExpectSaved(const string& prefix) {
+    BundleReader reader(Env::Default(), prefix);
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+    ASSERT_EQ(DT_FLOAT, val.dtype());
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(static_cast<float>(i) / 10, val.template flat<float>()(i));
+    }
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, Simple) {
+  const string prefix =
+      io::JoinPath(testing::TmpDir(), "tensor_async-00000-of-00001");
+  MakeOp();
+  AddInputs(prefix);
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The checkpoint is complete once its pending writes are done.
+  TF_ASSERT_OK(checkpoint::AsyncCheckpointWriter::Global()->Wait(prefix));
+  ExpectSaved(prefix);
+}
+
+TEST_F(AsyncSaveV2OpTest, UpdatesAfterSaveAreNotSaved) {
+  const string prefix =
+      io::JoinPath(testing::TmpDir(), "tensor_updated-00000-of-00001");
+  MakeOp();
+  AddInputs(prefix);
+
+  // Holds the writer until the input is updated.
+  Notification updated;
+  checkpoint::AsyncCheckpointWriter::Global()->Schedule(
+      "blocker", /*num_bytes=*/0, /*max_bytes=*/1, [&updated]() {
+        updated.WaitForNotification();
+        return absl::OkStatus();
+      });
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_FALSE(Env::Default()->FileExists(MetaFilename(prefix)).ok());
+  // Updates the tensor in place, like a ref variable assignment.
+  mutable_input(3).tensor->flat<float>().setConstant(-1);
+  updated.Notify();
+
+  TF_ASSERT_OK(checkpoint::AsyncCheckpointWriter::Global()->Wait(prefix));
+  ExpectSaved(prefix);
+}
+
+TEST_F(AsyncSaveV2OpTest, UnshardedPrefixIsSavedSynchronously) {
+  // No MergeV2Checkpoints op waits for this checkpoint, so it must be
+  // complete when the op returns.
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_unsharded");
+  MakeOp();
+  AddInputs(prefix);
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectSaved(prefix);
+}
+
 }  // namespace
 }  // namespace tensorflow
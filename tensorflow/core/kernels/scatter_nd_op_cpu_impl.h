@@ -20,10 +20,12 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -127,25 +129,53 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
           batch_strides[dim + 1] * output_shape_prefix[dim + 1];
     }
 
-    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
-      Index i = 0;
-      bool out_of_bounds = false;
-      for (int dim = 0; dim < IXDIM; ++dim) {
-        const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
-        out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
-        i += ix_d * batch_strides[dim];
+    // The updates are applied in blocks of kBlockSize indices. The output
+    // slices of a block are located and prefetched first, then the updates
+    // are applied in order, merging the updates of adjacent output slices.
+    constexpr Eigen::DenseIndex kBlockSize = 16;
+    Index offsets[kBlockSize];
+    T* output = Toutput.data();
+    const T* updates = Tupdates.data();
+    for (Eigen::DenseIndex block = 0; block < batch_size && error_loc < 0;
+         block += kBlockSize) {
+      const Eigen::DenseIndex block_size =
+          std::min(kBlockSize, batch_size - block);
+      Eigen::DenseIndex num_valid = block_size;
+      for (Eigen::DenseIndex j = 0; j < block_size; ++j) {
+        const Eigen::DenseIndex loc = block + j;
+        Index i = 0;
+        bool out_of_bounds = false;
+        for (int dim = 0; dim < IXDIM; ++dim) {
+          const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+          out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+          i += ix_d * batch_strides[dim];
+        }
+        if (TF_PREDICT_FALSE(out_of_bounds)) {
+          // The updates before the index out of bounds are still applied.
+          error_loc = loc;
+          num_valid = j;
+          break;
+        }
+        offsets[j] = i;
+        absl::PrefetchToLocalCache(output + i * slice_size);
       }
-      if (TF_PREDICT_FALSE(out_of_bounds)) {
-        error_loc = loc;
-        break;
-      } else {
-        auto input_chip = Toutput.template chip<0>(i);
-        auto output_chip = input_chip;
-        auto update_chip = Tupdates.template chip<0>(loc);
+
+      for (Eigen::DenseIndex j = 0; j < num_valid;) {
+        Eigen::DenseIndex run_end = j + 1;
+        while (run_end < num_valid &&
+               offsets[run_end] == offsets[run_end - 1] + 1) {
+          ++run_end;
+        }
+        const Eigen::DenseIndex size = (run_end - j) * slice_size;
+        typename TTypes<T>::UnalignedFlat output_run(
+            output + offsets[j] * slice_size, size);
+        typename TTypes<T>::UnalignedConstFlat update_run(
+            updates + (block + j) * slice_size, size);
         update_executor::UpdateExecutor<
-            CPUDevice, decltype(input_chip), decltype(update_chip),
-            decltype(output_chip), OP>::Execute(d, input_chip, update_chip,
-                                                output_chip);
+            CPUDevice, decltype(output_run), decltype(update_run),
+            decltype(output_run), OP>::Execute(d, output_run, update_run,
+                                               output_run);
+        j = run_end;
       }
     }
 
@@ -18,7 +18,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -41,8 +44,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -77,6 +82,30 @@ Status ValidateSparseSegmentReduction(OpKernelContext* context,
                                       const Tensor& indices,
                                       const Tensor& segment_ids,
                                       bool has_num_segments);
+
+// Splits segments into at most `max_blocks` blocks of consecutive segments
+// with about the same number of rows each, so that uneven segments don't
+// unbalance the shards. `row_offsets` holds the offset of the first row of
+// every segment, followed by the total number of rows. Block `b` is the
+// segments [blocks[b], blocks[b + 1]).
+inline std::vector<int64_t> BalanceSegmentBlocks(
+    const std::vector<int64_t>& row_offsets, int64_t max_blocks) {
+  const int64_t num_segments = row_offsets.size() - 1;
+  const int64_t num_rows = row_offsets.back() - row_offsets.front();
+  std::vector<int64_t> blocks = {0};
+  for (int64_t b = 1; b < max_blocks; ++b) {
+    const int64_t first_row = row_offsets.front() + num_rows * b / max_blocks;
+    const int64_t segment =
+        std::lower_bound(row_offsets.begin(), row_offsets.end() - 1,
+                         first_row) -
+        row_offsets.begin();
+    if (segment > blocks.back() && segment < num_segments) {
+      blocks.push_back(segment);
+    }
+  }
+  blocks.push_back(num_segments);
+  return blocks;
+}
 }  // namespace internal
 
 // This operator handles reducing segments along the first dimension.
@@ -336,6 +365,12 @@ class SegmentReductionGPUOp : public AsyncOpKernel {
 
 namespace functor {
 
+template <typename T>
+using Row = typename TTypes<T>::UnalignedVec;
+
+template <typename T>
+using ConstRow = typename TTypes<T>::UnalignedConstVec;
+
 // The ReductionFunctor implementation for CPU.
 template <typename T, typename Index, typename InitialValueF,
           typename ReductionF>
@@ -358,39 +393,45 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     T* out_ptr = output.data();
     ReductionF reduction;
 
-    const bool is_inner_dim_1d = inner_dim == 1;
-
-    // `num_real_segment` counts the rows actually reduced from input,
-    // the rows with negative segment index will be excluded.
-    // It will be used for cost model.
-    int64_t num_real_segment = N;
-    // `num_reductions` counts the rows actually reduced in output,
-    // the rows only filled with InitialValueF() will be excluded.
-    int64_t num_reductions = 0;
-    // `row_counter` records how many input rows will be reduced in each
-    // output row, the row only fills with InitialValueF() will keep 0.
-    // Length of non-zero elements is `num_reductions`.
-    std::vector<Index> row_counter(num_segments, 0);
-
+    // `row_offsets[j]` is the offset in `rows` of the first input row reduced
+    // in output row `j`. Rows with a negative segment index are excluded.
+    std::vector<int64_t> row_offsets(num_segments + 1, 0);
     for (int64_t i = 0; i < N; ++i) {
       Index j = internal::SubtleMustCopy(segment_ids(i));
-      if (j < 0) {
-        --num_real_segment;
-        continue;
-      }
+      if (j < 0) continue;
       OP_REQUIRES(ctx, FastBoundsCheck(j, num_segments),
                   errors::InvalidArgument(
                       "segment_ids", SliceDebugString(segment_ids_shape, i),
                       " = ", j, " is out of range [0, ", num_segments, ")"));
-      if (row_counter[j] == 0) num_reductions++;
-      row_counter[j]++;
+      ++row_offsets[j + 1];
     }
+    for (int64_t j = 0; j < num_segments; ++j) {
+      row_offsets[j + 1] += row_offsets[j];
+    }
+    const int64_t num_rows = row_offsets[num_segments];
 
     // Nothing to reduce. All output values equal to `InitialValueF()`.
-    if (num_reductions == 0) return;
+    if (num_rows == 0) return;
+
+    // Groups the input rows by output row. The rows of an output row stay in
+    // input order, so the results don't depend on the sharding.
+    std::vector<int64_t> rows(num_rows);
+    {
+      std::vector<int64_t> next_row(row_offsets.begin(),
+                                    row_offsets.end() - 1);
+      for (int64_t i = 0; i < N; ++i) {
+        Index j = internal::SubtleMustCopy(segment_ids(i));
+        if (!FastBoundsCheck(j, num_segments) ||
+            next_row[j] == row_offsets[j + 1]) {
+          continue;
+        }
+        rows[next_row[j]++] = i;
+      }
+    }
 
-    // Parallelize by `num_segments`. It's simple, efficient and safe
-    // (no data dependency):
+    // Parallelize by output row, in blocks of output rows that reduce about
+    // the same number of input rows. Each output row is reduced by a single
+    // worker, so there is no data dependency:
     //
     //   input   segment_ids                 num_segments  operation
     //   | a0 |  | 0 |            worker 1:  |0|           f(a0, a1)
@@ -399,82 +440,103 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     //   | b1 |  | 1 |
     //   | a1 |  | 0 |
     //
-    // TODO(intel-tf): Balance workload in `row_counter` to make parallelism
-    //                 more efficient.
+    // The columns are reduced in blocks that fit in the L1 cache, kRowBlock
+    // input rows at a time, so that each block of the output row is loaded
+    // and stored once per kRowBlock input rows.
+    constexpr int64_t kRowBlock = 4;
+    constexpr int64_t kColumnBlockBytes = 4096;
+    const int64_t column_block =
+        std::max<int64_t>(kColumnBlockBytes / sizeof(T), 1);
+    const auto input_row = [&](int64_t r, int64_t col, int64_t size) {
+      return ConstRow<T>(data_ptr + rows[r] * inner_dim + col, size);
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    const std::vector<int64_t> blocks = internal::BalanceSegmentBlocks(
+        row_offsets, 4 * static_cast<int64_t>(worker_threads.num_threads));
     auto reductionWorker = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
-        Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
-          reduction(data.template chip<0>(i), output.template chip<0>(j));
+      for (int64_t j = blocks[begin]; j < blocks[end]; ++j) {
+        const int64_t row_begin = row_offsets[j];
+        const int64_t row_end = row_offsets[j + 1];
+        T* out_row = out_ptr + j * inner_dim;
+        if (inner_dim == 1) {
+          for (int64_t r = row_begin; r < row_end; ++r) {
+            reduction(data_ptr[rows[r]], *out_row);
+          }
+          continue;
         }
-      }
-    };
-    auto reductionWorker1D = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
-        Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
-          reduction(data_ptr[i], out_ptr[j]);
+        for (int64_t col = 0; col < inner_dim; col += column_block) {
+          const int64_t size = std::min(column_block, inner_dim - col);
+          Row<T> out(out_row + col, size);
+          int64_t r = row_begin;
+          for (; r + kRowBlock <= row_end; r += kRowBlock) {
+            reduction(input_row(r, col, size), input_row(r + 1, col, size),
+                      input_row(r + 2, col, size),
+                      input_row(r + 3, col, size), out);
+          }
+          for (; r < row_end; ++r) {
+            reduction(input_row(r, col, size), out);
+          }
         }
       }
     };
     // Reduction functors includes Sum, Max, Min, etc. Simply consider it
     // will cost 5 cycles per operation.
-    const int64_t kAverTaskSize = num_real_segment / num_segments;
-    const int64_t compute_cycles = 5 * inner_dim * kAverTaskSize;
-    const int64_t input_bytes = sizeof(T) * inner_dim * kAverTaskSize;
-    const int64_t output_bytes = sizeof(T) * inner_dim * kAverTaskSize;
-    const Eigen::TensorOpCost cost(input_bytes, output_bytes, compute_cycles);
-    if (is_inner_dim_1d) {
-      cpu_device.parallelFor(num_segments, cost, reductionWorker1D);
-    } else {
-      cpu_device.parallelFor(num_segments, cost, reductionWorker);
-    }
+    const int64_t num_blocks = blocks.size() - 1;
+    const int64_t cost_per_block = 5 * inner_dim * (num_rows / num_blocks);
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          std::max<int64_t>(cost_per_block, 1), reductionWorker);
   }
 };
 
-template <typename T>
-using MatrixChip = Eigen::TensorChippingOp<0l, typename TTypes<T, 2>::Matrix>;
-
-template <typename T>
-using constMatrixChip =
-    Eigen::TensorChippingOp<0l, const typename TTypes<T, 2>::ConstMatrix>;
-
-// reduction functors
+// reduction functors. Each one also reduces four rows at once, in the same
+// order as one after the other.
 template <typename T>
 struct SumOp {
-  void operator()(const constMatrixChip<T> data, MatrixChip<T> output) {
-    output += data;
+  void operator()(ConstRow<T> data, Row<T> output) { output += data; }
+  void operator()(ConstRow<T> data0, ConstRow<T> data1, ConstRow<T> data2,
+                  ConstRow<T> data3, Row<T> output) {
+    output = output + data0 + data1 + data2 + data3;
   }
   void operator()(const T& data, T& output) { output += data; }
 };
 
 template <typename T>
 struct MaxOp {
-  void operator()(const constMatrixChip<T> data, MatrixChip<T> output) {
+  void operator()(ConstRow<T> data, Row<T> output) {
     output = data.cwiseMax(output);
   }
+  void operator()(ConstRow<T> data0, ConstRow<T> data1, ConstRow<T> data2,
+                  ConstRow<T> data3, Row<T> output) {
+    output = data3.cwiseMax(
+        data2.cwiseMax(data1.cwiseMax(data0.cwiseMax(output))));
+  }
   void operator()(const T& data, T& output) { output = std::max(data, output); }
 };
 
 template <typename T>
 struct MinOp {
-  void operator()(const constMatrixChip<T> data, MatrixChip<T> output) {
+  void operator()(ConstRow<T> data, Row<T> output) {
     output = data.cwiseMin(output);
   }
+  void operator()(ConstRow<T> data0, ConstRow<T> data1, ConstRow<T> data2,
+                  ConstRow<T> data3, Row<T> output) {
+    output = data3.cwiseMin(
+        data2.cwiseMin(data1.cwiseMin(data0.cwiseMin(output))));
+  }
   void operator()(const T& data, T& output) { output = std::min(data, output); }
 };
 
 template <typename T>
 struct ProdOp {
-  void operator()(const constMatrixChip<T> data, MatrixChip<T> output) {
-    output *= data;
+  void operator()(ConstRow<T> data, Row<T> output) { output *= data; }
+  void operator()(ConstRow<T> data0, ConstRow<T> data1, ConstRow<T> data2,
+                  ConstRow<T> data3, Row<T> output) {
+    output = output * data0 * data1 * data2 * data3;
   }
   void operator()(const T& data, T& output) { output *= data; }
 };
 }  // namespace functor
-
 // The UnsortedSegmentReduction OpKernel. The DeviceReductionFunctor
 // is the device specific implementation of the reduction. These device
 // specific implementations are templated themselves with the corresponding
@@ -531,6 +593,11 @@ class UnsortedSegmentReductionOp : public OpKernel {
 template <typename Device, class T, typename Index, typename SegmentId>
 class SparseSegmentReductionOpBase : public OpKernel {
  public:
+  // The rows of at most this many indices of the next segment are prefetched
+  // while reducing a segment.
+  static constexpr int64_t kMaxPrefetchedRows = 8;
+  static constexpr int64_t kCacheLineBytes = 64;
+
   explicit SparseSegmentReductionOpBase(OpKernelConstruction* context,
                                         bool is_mean, bool is_sqrtn,
                                         bool has_num_segments, T default_value)
@@ -612,9 +679,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
+    // First finds the [start, end) range of indices of every segment, so
+    // that the segments can then be reduced in parallel.
+    struct SegmentRange {
+      int64_t start;
+      int64_t end;
+      SegmentId out_index;
+    };
+    std::vector<SegmentRange> segments;
     int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
     SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
 
     while (true) {
@@ -638,35 +711,92 @@ class SparseSegmentReductionOpBase : public OpKernel {
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
+      segments.push_back({start, end, out_index});
 
       start = end;
       ++end;
-      uninitialized_index = out_index + 1;
       out_index = next_index;
       if (end > num_indices) break;
     }
 
+    // Then gathers and reduces the rows of every segment straight into its
+    // output row, prefetching the rows of the next segment, so that the
+    // gathered [num_indices, num_col] rows are never materialized.
+    const int64_t num_input_rows = input_flat.dimension(0);
+    const int64_t row_bytes = num_col * sizeof(T);
+    // Smallest offset in `indices` of an index out of range.
+    std::atomic<int64_t> bad_offset(num_indices);
+    auto reduce_segments = [&](int64_t begin, int64_t limit) {
+      for (int64_t s = begin; s < limit; ++s) {
+        const SegmentRange& segment = segments[s];
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        const SegmentId uninitialized_index =
+            s == 0 ? 0 : segments[s - 1].out_index + 1;
+        if (segment.out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment.out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+        if (s + 1 < limit) {
+          const SegmentRange& next = segments[s + 1];
+          for (int64_t i = next.start;
+               i < std::min(next.end, next.start + kMaxPrefetchedRows); ++i) {
+            const Index index = indices_vec(i);
+            if (!FastBoundsCheck(index, num_input_rows)) continue;
+            const char* row =
+                reinterpret_cast<const char*>(&input_flat(index, 0));
+            for (int64_t offset = 0; offset < row_bytes;
+                 offset += kCacheLineBytes) {
+              port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+            }
+          }
+        }
+
+        auto out = output_flat.template chip<0>(segment.out_index);
+        auto temp = temp_flat.template chip<0>(segment.out_index);
+        const int64_t segment_bad_offset =
+            Reduce<T, Index>(input_flat, indices_vec, segment.start,
+                             segment.end - segment.start, out, temp);
+        if (segment_bad_offset >= 0) {
+          int64_t current = bad_offset.load();
+          const int64_t offset = segment.start + segment_bad_offset;
+          while (offset < current &&
+                 !bad_offset.compare_exchange_weak(current, offset)) {
+          }
+        }
+      }
+    };
+    // Shards blocks of segments with about the same number of indices, so
+    // that a few long segments don't leave the other workers idle.
+    std::vector<int64_t> row_offsets(segments.size() + 1, num_indices);
+    for (size_t s = 0; s < segments.size(); ++s) {
+      row_offsets[s] = segments[s].start;
+    }
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const std::vector<int64_t> blocks = internal::BalanceSegmentBlocks(
+        row_offsets, 4 * static_cast<int64_t>(worker_threads.num_threads));
+    const int64_t num_blocks = blocks.size() - 1;
+    const int64_t cost_per_block = num_indices / num_blocks * num_col *
+                                   (Eigen::TensorOpCost::AddCost<T>() +
+                                    Eigen::TensorOpCost::DivCost<T>());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          std::max<int64_t>(cost_per_block, 1),
+          [&](int64_t begin, int64_t limit) {
+            reduce_segments(blocks[begin], blocks[limit]);
+          });
+    OP_REQUIRES(context, bad_offset.load() == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_offset.load(),
+                    "] == ", indices_vec(bad_offset.load()),
+                    " out of range [0, ", num_input_rows, ")"));
+
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segments.back().out_index + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -38,9 +40,151 @@ limitations under the License.
 
 namespace tensorflow {
 
+class SparseSegmentReductionOpTest : public OpsTestBase {
+ protected:
+  static constexpr int kNumRows = 1000;
+  static constexpr int kNumCols = 64;
+  static constexpr int kIndicesPerSegment = 7;
+  static constexpr int kNumIndices = 3000 * kIndicesPerSegment;
+
+  // Runs `op` on a table of small integers, so that the sums are exact, with
+  // segments of kIndicesPerSegment rows separated by empty segments. Large
+  // enough for the segments to be reduced by several shards.
+  void RunOp(const string& op) {
+    TF_ASSERT_OK(NodeDefBuilder("op", op)
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    table_.resize(kNumRows * kNumCols);
+    for (int i = 0; i < table_.size(); ++i) {
+      table_[i] = i % 17 - 8;
+    }
+    indices_.resize(kNumIndices);
+    segment_ids_.resize(kNumIndices);
+    for (int i = 0; i < kNumIndices; ++i) {
+      indices_[i] = (static_cast<int64_t>(i) * 7919) % kNumRows;
+      segment_ids_[i] = 2 * (i / kIndicesPerSegment) + 1;
+    }
+    AddInputFromArray<float>(TensorShape({kNumRows, kNumCols}), table_);
+    AddInputFromArray<int32>(TensorShape({kNumIndices}), indices_);
+    AddInputFromArray<int32>(TensorShape({kNumIndices}), segment_ids_);
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  // Returns the sums of the segments, and 0 for the empty ones, computed one
+  // segment after the other.
+  Tensor SerialSums() const {
+    const int num_segments = segment_ids_.back() + 1;
+    Tensor expected(DT_FLOAT, TensorShape({num_segments, kNumCols}));
+    auto expected_matrix = expected.matrix<float>();
+    expected_matrix.setZero();
+    for (int i = 0; i < kNumIndices; ++i) {
+      for (int c = 0; c < kNumCols; ++c) {
+        expected_matrix(segment_ids_[i], c) +=
+            table_[indices_[i] * kNumCols + c];
+      }
+    }
+    return expected;
+  }
+
+  std::vector<float> table_;
+  std::vector<int32> indices_;
+  std::vector<int32> segment_ids_;
+};
+
+TEST_F(SparseSegmentReductionOpTest, ParallelSumMatchesSerialSum) {
+  RunOp("SparseSegmentSum");
+  test::ExpectTensorEqual<float>(*GetOutput(0), SerialSums());
+}
+
+TEST_F(SparseSegmentReductionOpTest, ParallelMeanMatchesSerialMean) {
+  RunOp("SparseSegmentMean");
+  Tensor expected = SerialSums();
+  auto expected_flat = expected.flat<float>();
+  for (int i = 0; i < expected_flat.size(); ++i) {
+    expected_flat(i) /= kIndicesPerSegment;
+  }
+  test::ExpectTensorNear<float>(*GetOutput(0), expected, 1e-5);
+}
+
+class UnsortedSegmentReductionOpTest : public OpsTestBase {
+ protected:
+  static constexpr int kNumRows = 20000;
+  static constexpr int kNumCols = 64;
+  static constexpr int kNumSegments = 600;
+
+  // Runs `op` on rows of small integers, so that the sums are exact. Half of
+  // the rows go to segment 0, a few are dropped with a negative id, and the
+  // last segments are empty. Large enough for several shards.
+  void RunOp(const string& op) {
+    TF_ASSERT_OK(NodeDefBuilder("op", op)
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    data_.resize(kNumRows * kNumCols);
+    for (int i = 0; i < data_.size(); ++i) {
+      data_[i] = i % 13 - 6;
+    }
+    segment_ids_.resize(kNumRows);
+    for (int i = 0; i < kNumRows; ++i) {
+      if (i % 2 == 0) {
+        segment_ids_[i] = 0;
+      } else if (i % 101 == 0) {
+        segment_ids_[i] = -1;
+      } else {
+        segment_ids_[i] = (i / 2) % (kNumSegments - 100);
+      }
+    }
+    AddInputFromArray<float>(TensorShape({kNumRows, kNumCols}), data_);
+    AddInputFromArray<int32>(TensorShape({kNumRows}), segment_ids_);
+    AddInputFromArray<int32>(TensorShape({}), {kNumSegments});
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  // Returns the reduction of the rows of every segment with `reduce` from
+  // `initial_value`, computed one row after the other.
+  Tensor SerialReduction(float initial_value,
+                         const std::function<float(float, float)>& reduce) {
+    Tensor expected(DT_FLOAT, TensorShape({kNumSegments, kNumCols}));
+    auto expected_matrix = expected.matrix<float>();
+    expected_matrix.setConstant(initial_value);
+    for (int i = 0; i < kNumRows; ++i) {
+      if (segment_ids_[i] < 0) continue;
+      for (int c = 0; c < kNumCols; ++c) {
+        float& out = expected_matrix(segment_ids_[i], c);
+        out = reduce(out, data_[i * kNumCols + c]);
+      }
+    }
+    return expected;
+  }
+
+  std::vector<float> data_;
+  std::vector<int32> segment_ids_;
+};
+
+TEST_F(UnsortedSegmentReductionOpTest, ParallelSumMatchesSerialSum) {
+  RunOp("UnsortedSegmentSum");
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      SerialReduction(0, [](float a, float b) { return a + b; }));
+}
+
+TEST_F(UnsortedSegmentReductionOpTest, ParallelMaxMatchesSerialMax) {
+  RunOp("UnsortedSegmentMax");
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      SerialReduction(std::numeric_limits<float>::lowest(),
+                      [](float a, float b) { return std::max(a, b); }));
+}
+
 static void BM_UnsortedSegmentReduction(::testing::benchmark::State& state,
                                         const string& reduction, int num_rows,
-                                        int num_cols, int segment_size) {
+                                        int num_cols, int segment_size,
+                                        bool skewed = false) {
   std::unique_ptr<Device> device(
       DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0"));
 
@@ -53,8 +197,16 @@ static void BM_UnsortedSegmentReduction(::testing::benchmark::State& state,
 
   TensorShape shape2({num_rows});
   Tensor indices(DT_INT32, shape2);
-  test::FillFn<int>(&indices,
-                    [&segment_size](int i) -> int { return i % segment_size; });
+  if (skewed) {
+    // Half of the rows go to segment 0, like a popular item or graph node.
+    test::FillFn<int>(&indices, [&segment_size](int i) -> int {
+      return i % 2 == 0 ? 0 : (i / 2) % segment_size;
+    });
+  } else {
+    test::FillFn<int>(&indices, [&segment_size](int i) -> int {
+      return i % segment_size;
+    });
+  }
   reduction_inputs.push_back({nullptr, &indices});
 
   Tensor num_segments(DT_INT32, TensorShape({}));
@@ -106,6 +258,12 @@ static void BM_UnsortedSegmentReduction(::testing::benchmark::State& state,
 BM_UnsortedReduce_Arg(4096, 1024, 1);
 BM_UnsortedReduce_Arg(4096, 1024, 128);
 
+static void BM_UnsortedSegmentSum_Skewed(::testing::benchmark::State& state) {
+  BM_UnsortedSegmentReduction(state, "UnsortedSegmentSum", 65536, 64, 4096,
+                              /*skewed=*/true);
+}
+BENCHMARK(BM_UnsortedSegmentSum_Skewed);
+
 template <typename Index>
 static void BM_SegmentReduction(::testing::benchmark::State& state,
                                 const string& reduction, Index num_rows,
@@ -290,4 +448,43 @@ BENCHMARK(BM_SparseSegmentMeanGrad_High_FP16)
     ->Arg(1000)
     ->Arg(100000);
 
+// Embedding lookup with a sum combiner: gathers `num_indices` rows of a
+// [kVocabSize, embedding_dim] table into segments of kIndicesPerSegment rows.
+static void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  const int num_indices = state.range(0);
+  const int embedding_dim = state.range(1);
+  const int kVocabSize = 100000;
+  const int kIndicesPerSegment = 20;
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  auto segments_flat = segments.flat<int32>();
+  for (int i = 0; i < num_indices; ++i) {
+    indices_flat(i) = (static_cast<int64_t>(i) * 7919) % kVocabSize;
+    segments_flat(i) = i / kIndicesPerSegment;
+  }
+  Tensor input(DT_FLOAT, TensorShape({kVocabSize, embedding_dim}));
+  input.flat<float>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * embedding_dim * sizeof(float));
+}
+
+BENCHMARK(BM_SparseSegmentSum)
+    ->UseRealTime()
+    ->ArgPair(10000, 16)
+    ->ArgPair(10000, 128)
+    ->ArgPair(1000000, 64);
+
 }  // namespace tensorflow
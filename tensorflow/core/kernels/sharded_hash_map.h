@@ -0,0 +1,250 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_KERNELS_SHARDED_HASH_MAP_H_
+#define TENSORFLOW_CORE_KERNELS_SHARDED_HASH_MAP_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Hash map split into shards that have their own reader-writer lock, for
+// read-mostly tables that are looked up by many threads while being updated.
+//
+// A batch of keys is grouped by shard, and every shard is locked once for all
+// its keys. Lookups on different shards don't share a cache line, and an
+// update only blocks the lookups of the shards it writes, instead of the whole
+// table. Clearing the map and taking a snapshot lock all the shards, so they
+// are atomic with respect to the other operations.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  static constexpr int kNumShards = 16;
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // For every i in [0, n), calls found(i, value) if key(i) is in the map, and
+  // missing(i) otherwise. Can be called concurrently with the other methods.
+  template <typename KeyFn, typename FoundFn, typename MissingFn>
+  void FindBatch(int64_t n, KeyFn key, FoundFn found,
+                 MissingFn missing) const {
+    if (n == 1) {
+      const K key0 = key(0);
+      const Shard& shard = shards_[ShardIndex(key0)];
+      tf_shared_lock l(shard.mu);
+      FindInShard(
+          shard, 0, [&](int64_t) -> const K& { return key0; }, found, missing);
+      return;
+    }
+    std::vector<K> keys;
+    std::vector<int64_t> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+    GroupByShard(n, key, &keys, &order, &offsets);
+    const auto sorted_key = [&](int64_t i) -> const K& { return keys[i]; };
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        FindInShard(shard, order[j], sorted_key, found, missing);
+      }
+    }
+  }
+
+  // Sets the value of key(i) to value(i) for every i in [0, n). When a key is
+  // repeated, the last value wins. If `clear` is true, the map is emptied
+  // first and no lookup sees it in between.
+  template <typename KeyFn, typename ValueFn>
+  void InsertOrUpdateBatch(bool clear, int64_t n, KeyFn key, ValueFn value) {
+    std::vector<K> keys;
+    std::vector<int64_t> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+    GroupByShard(n, key, &keys, &order, &offsets);
+    if (clear) {
+      ClearAndInsert(keys, order, offsets, value);
+      return;
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      mutex_lock l(shards_[s].mu);
+      InsertInShard(&shards_[s], keys, order, offsets[s], offsets[s + 1],
+                    value);
+    }
+  }
+
+  // Removes key(i) for every i in [0, n).
+  template <typename KeyFn>
+  void EraseBatch(int64_t n, KeyFn key) {
+    std::vector<K> keys;
+    std::vector<int64_t> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+    GroupByShard(n, key, &keys, &order, &offsets);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      mutex_lock l(shards_[s].mu);
+      for (int64_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        shards_[s].map.erase(keys[order[j]]);
+      }
+    }
+  }
+
+  // Returns a copy of all the entries, taken with all the shards locked.
+  std::vector<std::pair<K, V>> Snapshot() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<std::pair<K, V>> entries;
+    LockAllShared();
+    size_t size = 0;
+    for (const Shard& shard : shards_) size += shard.map.size();
+    entries.reserve(size);
+    for (const Shard& shard : shards_) {
+      entries.insert(entries.end(), shard.map.begin(), shard.map.end());
+    }
+    UnlockAllShared();
+    return entries;
+  }
+
+  // Same estimate as MutableHashTable used for a single unordered_map: the
+  // number of entries plus the number of empty buckets.
+  int64_t NumBucketsAndEntries() const {
+    int64_t ret = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      for (size_t i = 0; i < shard.map.bucket_count(); ++i) {
+        const size_t bucket_size = shard.map.bucket_size(i);
+        ret += bucket_size == 0 ? 1 : bucket_size;
+      }
+    }
+    return ret;
+  }
+
+ private:
+  // Shards are cache line aligned, so that locking one doesn't invalidate its
+  // neighbors in the caches of the other cores.
+  struct alignas(64) Shard {
+    mutable mutex mu;
+    std::unordered_map<K, V> map TF_GUARDED_BY(mu);
+  };
+
+  static int ShardIndex(const K& key) {
+    // The map hashes integers to themselves, so the shard index is taken from
+    // the high bits of a multiplicative hash, which are independent of the
+    // buckets chosen within the shard.
+    const uint64_t hash =
+        static_cast<uint64_t>(std::hash<K>()(key)) * 0x9e3779b97f4a7c15ULL;
+    return static_cast<int>(hash >> 60);
+  }
+  static_assert(kNumShards == 16, "ShardIndex() takes 4 bits of the hash");
+
+  // Copies the n keys into `keys`, and orders their positions by shard in
+  // `order`: the positions of shard s are order[offsets[s]] to
+  // order[offsets[s + 1] - 1], in increasing order.
+  template <typename KeyFn>
+  static void GroupByShard(int64_t n, KeyFn key, std::vector<K>* keys,
+                           std::vector<int64_t>* order,
+                           std::array<int64_t, kNumShards + 1>* offsets) {
+    keys->clear();
+    keys->reserve(n);
+    std::vector<uint8_t> shard_of(n);
+    offsets->fill(0);
+    for (int64_t i = 0; i < n; ++i) {
+      keys->push_back(key(i));
+      shard_of[i] = ShardIndex(keys->back());
+      ++(*offsets)[shard_of[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      (*offsets)[s + 1] += (*offsets)[s];
+    }
+    std::array<int64_t, kNumShards> next;
+    std::copy(offsets->begin(), offsets->end() - 1, next.begin());
+    order->resize(n);
+    for (int64_t i = 0; i < n; ++i) {
+      (*order)[next[shard_of[i]]++] = i;
+    }
+  }
+
+  template <typename KeyFn, typename FoundFn, typename MissingFn>
+  static void FindInShard(const Shard& shard, int64_t i, KeyFn key,
+                          FoundFn found, MissingFn missing)
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    const auto it = shard.map.find(key(i));
+    if (it != shard.map.end()) {
+      found(i, it->second);
+    } else {
+      missing(i);
+    }
+  }
+
+  template <typename ValueFn>
+  static void InsertInShard(Shard* shard, const std::vector<K>& keys,
+                            const std::vector<int64_t>& order, int64_t begin,
+                            int64_t end, ValueFn value)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    for (int64_t j = begin; j < end; ++j) {
+      const int64_t i = order[j];
+      shard->map.insert_or_assign(keys[i], value(i));
+    }
+  }
+
+  template <typename ValueFn>
+  void ClearAndInsert(const std::vector<K>& keys,
+                      const std::vector<int64_t>& order,
+                      const std::array<int64_t, kNumShards + 1>& offsets,
+                      ValueFn value) TF_NO_THREAD_SAFETY_ANALYSIS {
+    LockAll();
+    for (int s = 0; s < kNumShards; ++s) {
+      shards_[s].map.clear();
+      InsertInShard(&shards_[s], keys, order, offsets[s], offsets[s + 1],
+                    value);
+    }
+    UnlockAll();
+  }
+
+  // The shards are always locked in increasing order.
+  void LockAll() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) shard.mu.lock();
+  }
+  void UnlockAll() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) shard.mu.unlock();
+  }
+  void LockAllShared() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.lock_shared();
+  }
+  void UnlockAllShared() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.unlock_shared();
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_SHARDED_HASH_MAP_H_
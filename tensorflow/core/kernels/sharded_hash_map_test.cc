@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/kernels/sharded_hash_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Map = ShardedHashMap<int64_t, int64_t>;
+
+void Insert(Map* map, const std::vector<int64_t>& keys,
+            const std::vector<int64_t>& values, bool clear = false) {
+  map->InsertOrUpdateBatch(
+      clear, keys.size(), [&](int64_t i) { return keys[i]; },
+      [&](int64_t i) { return values[i]; });
+}
+
+// Returns the values of `keys`, or -1 for the missing ones.
+std::vector<int64_t> Find(const Map& map, const std::vector<int64_t>& keys) {
+  std::vector<int64_t> values(keys.size(), 0);
+  map.FindBatch(
+      keys.size(), [&](int64_t i) { return keys[i]; },
+      [&](int64_t i, int64_t value) { values[i] = value; },
+      [&](int64_t i) { values[i] = -1; });
+  return values;
+}
+
+TEST(ShardedHashMapTest, InsertFindErase) {
+  Map map;
+  std::vector<int64_t> keys, values;
+  for (int64_t i = 0; i < 1000; ++i) {
+    keys.push_back(i * 7);
+    values.push_back(i);
+  }
+  Insert(&map, keys, values);
+  EXPECT_EQ(map.size(), 1000);
+  EXPECT_EQ(Find(map, keys), values);
+  EXPECT_EQ(Find(map, {7 * 3}), std::vector<int64_t>({3}));
+  EXPECT_EQ(Find(map, {1, 14, 2}), std::vector<int64_t>({-1, 2, -1}));
+
+  map.EraseBatch(2, [](int64_t i) { return i * 7; });
+  EXPECT_EQ(map.size(), 998);
+  EXPECT_EQ(Find(map, {0, 7, 14}), std::vector<int64_t>({-1, -1, 2}));
+}
+
+TEST(ShardedHashMapTest, LastValueOfRepeatedKeyWins) {
+  Map map;
+  Insert(&map, {5, 6, 5, 5}, {1, 2, 3, 4});
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(Find(map, {5, 6}), std::vector<int64_t>({4, 2}));
+}
+
+TEST(ShardedHashMapTest, ClearAndSnapshot) {
+  Map map;
+  Insert(&map, {1, 2, 3}, {10, 20, 30});
+  Insert(&map, {4, 2}, {40, 21}, /*clear=*/true);
+  auto entries = map.Snapshot();
+  std::sort(entries.begin(), entries.end());
+  EXPECT_EQ(entries, (std::vector<std::pair<int64_t, int64_t>>(
+                         {{2, 21}, {4, 40}})));
+  EXPECT_GE(map.NumBucketsAndEntries(), 2);
+}
+
+TEST(ShardedHashMapTest, StringKeys) {
+  ShardedHashMap<std::string, int> map;
+  const std::vector<std::string> keys = {"a", "bb", "ccc"};
+  map.InsertOrUpdateBatch(
+      /*clear=*/false, keys.size(), [&](int64_t i) { return keys[i]; },
+      [](int64_t i) { return static_cast<int>(i); });
+  int found = 0;
+  map.FindBatch(
+      2, [](int64_t i) { return std::string(i == 0 ? "bb" : "dd"); },
+      [&](int64_t i, int value) { found += value; },
+      [&](int64_t i) { found += 100; });
+  EXPECT_EQ(found, 101);
+}
+
+TEST(ShardedHashMapTest, ConcurrentFindAndInsert) {
+  Map map;
+  constexpr int kNumKeys = 4096;
+  std::vector<int64_t> keys(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++i) keys[i] = i;
+  Insert(&map, keys, keys);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 50; ++round) {
+        // Keys are only ever mapped to themselves or their negation.
+        const std::vector<int64_t> values = Find(map, keys);
+        for (int i = 0; i < kNumKeys; ++i) {
+          EXPECT_TRUE(values[i] == keys[i] || values[i] == -keys[i]);
+        }
+      }
+    });
+  }
+  threads.emplace_back([&] {
+    for (int round = 0; round < 50; ++round) {
+      std::vector<int64_t> values(kNumKeys);
+      for (int i = 0; i < kNumKeys; ++i) {
+        values[i] = round % 2 == 0 ? -keys[i] : keys[i];
+      }
+      Insert(&map, keys, values);
+    }
+  });
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(map.size(), kNumKeys);
+}
+
+}  // namespace
+}  // namespace tensorflow
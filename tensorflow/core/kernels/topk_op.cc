@@ -161,6 +161,21 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    // Sharding by row leaves most threads idle for a few long rows, e.g. the
+    // scores of a single query in retrieval, so the rows are then also split
+    // in shards of columns.
+    if (k < num_cols && num_rows < worker_threads.num_threads) {
+      const int64_t num_shards_per_row = std::min<int64_t>(
+          worker_threads.num_threads,
+          num_cols / std::max<int64_t>(kMinColumnShardSize, 4 * k));
+      if (num_shards_per_row > 1) {
+        SelectInColumnShards(worker_threads, sorted, k, input, num_rows,
+                             num_cols, num_shards_per_row, values, indices);
+        return OkStatus();
+      }
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -247,12 +262,131 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return OkStatus();
   }
+
+ private:
+  // Rows are split in shards of at least this many columns.
+  static constexpr int64_t kMinColumnShardSize = 32 * 1024;
+
+  // Selects the top k of every row in two phases. Each shard of
+  // `num_shards_per_row` shards of columns first selects its own top k
+  // candidates, which contain the shard's part of the row's top k. Then the
+  // candidates of all the shards of a row are merged in a final selection.
+  static void SelectInColumnShards(
+      const DeviceBase::CpuWorkerThreads& worker_threads, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t num_shards_per_row,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<Tidx, 2>::Tensor indices) {
+    const int64_t shard_size =
+        (num_cols + num_shards_per_row - 1) / num_shards_per_row;
+    const int64_t num_candidates_per_row = num_shards_per_row * k;
+    std::vector<Tidx> candidates(num_rows * num_candidates_per_row);
+    std::vector<int64_t> num_candidates(num_rows * num_shards_per_row);
+
+    auto SelectInShards = [&](int64_t start_shard, int64_t limit_shard) {
+      for (int64_t shard = start_shard; shard < limit_shard; ++shard) {
+        const int64_t b = shard / num_shards_per_row;
+        const int64_t start = (shard % num_shards_per_row) * shard_size;
+        const int64_t limit = std::min(num_cols, start + shard_size);
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const Tidx a, const Tidx b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
+        filter.reserve(k);
+        int64_t c = start;
+        for (; c < limit && filter.size() < static_cast<size_t>(k); ++c) {
+          filter.push(c);
+        }
+        if (c < limit) {
+          // Columns come in increasing order, so a column only beats the
+          // current k-th one with a greater value. Most columns don't, and are
+          // skipped a block at a time by a check that vectorizes.
+          constexpr int64_t kBlockSize = 16;
+          T threshold = input_data[filter.peek_bottom()];
+          const auto push = [&](int64_t col) {
+            if (input_data[col] > threshold) {
+              filter.push(col);
+              threshold = input_data[filter.peek_bottom()];
+            }
+          };
+          for (; c + kBlockSize <= limit; c += kBlockSize) {
+            bool any_greater = false;
+            for (int64_t i = 0; i < kBlockSize; ++i) {
+              any_greater |= input_data[c + i] > threshold;
+            }
+            if (!any_greater) continue;
+            for (int64_t i = 0; i < kBlockSize; ++i) push(c + i);
+          }
+          for (; c < limit; ++c) push(c);
+        }
+        std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                  &candidates[shard * k]);
+        num_candidates[shard] = filter.size();
+      }
+    };
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_shards_per_row,
+          static_cast<int64_t>(shard_size * Eigen::TensorOpCost::AddCost<T>() +
+                               4 * k * cmp_cost),
+          SelectInShards);
+
+    auto MergeShards = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const Tidx a, const Tidx b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
+        filter.reserve(num_candidates_per_row);
+        for (int64_t s = 0; s < num_shards_per_row; ++s) {
+          const int64_t shard = b * num_shards_per_row + s;
+          for (int64_t i = 0; i < num_candidates[shard]; ++i) {
+            filter.push(candidates[shard * k + i]);
+          }
+        }
+        int32_t i = 0;
+        if (sorted) {
+          std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
+          for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+               ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        } else {
+          for (auto top_k_it = filter.unsorted_begin();
+               top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        }
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          static_cast<int64_t>(
+              4 * num_candidates_per_row * cmp_cost *
+              Eigen::numext::log2(static_cast<float>(k + 1))),
+          MergeShards);
+  }
 };
 
 }  // namespace functor
@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Long enough for up to four shards of columns per row.
+constexpr int64_t kNumCols = 4 * 32 * 1024 + 123;
+
+class TopKOpTest : public OpsTestBase {
+ protected:
+  void MakeTopK(bool sorted) {
+    TF_ASSERT_OK(NodeDefBuilder("topk", "TopKV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("sorted", sorted)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Runs TopK on `num_rows` copies of the row given by `value`, and returns
+  // the values and indices of the first row.
+  void RunTopK(int64_t num_rows, int k,
+               const std::function<float(int64_t)>& value,
+               std::vector<float>* values, std::vector<int32>* indices) {
+    inputs_.clear();
+    AddInput<float>(TensorShape({num_rows, kNumCols}),
+                    [&](int i) { return value(i % kNumCols); });
+    AddInputFromArray<int32>(TensorShape({}), {k});
+    TF_ASSERT_OK(RunOpKernel());
+    const auto top_values = GetOutput(0)->matrix<float>();
+    const auto top_indices = GetOutput(1)->matrix<int32>();
+    values->assign(&top_values(0, 0), &top_values(0, 0) + k);
+    indices->assign(&top_indices(0, 0), &top_indices(0, 0) + k);
+  }
+
+  // Checks that a single row, split in shards of columns, gives the same top
+  // k as the per row path, which runs when there are as many rows as threads.
+  void ExpectColumnShardsMatchRows(bool sorted,
+                                   const std::function<float(int64_t)>& value) {
+    const int num_threads =
+        device_->tensorflow_cpu_worker_threads()->num_threads;
+    MakeTopK(sorted);
+    for (int k : {1, 7, 100, 1000}) {
+      SCOPED_TRACE(k);
+      std::vector<float> sharded_values, row_values;
+      std::vector<int32> sharded_indices, row_indices;
+      RunTopK(/*num_rows=*/1, k, value, &sharded_values, &sharded_indices);
+      RunTopK(num_threads, k, value, &row_values, &row_indices);
+      if (!sorted) {
+        // Both keep the same k elements, in an unspecified order.
+        std::sort(sharded_indices.begin(), sharded_indices.end());
+        std::sort(row_indices.begin(), row_indices.end());
+        std::sort(sharded_values.begin(), sharded_values.end());
+        std::sort(row_values.begin(), row_values.end());
+      }
+      EXPECT_EQ(sharded_indices, row_indices);
+      EXPECT_EQ(sharded_values, row_values);
+    }
+  }
+
+  void SetUp() override {
+    if (device_->tensorflow_cpu_worker_threads()->num_threads < 2) {
+      GTEST_SKIP() << "Columns are only sharded with several threads";
+    }
+  }
+};
+
+// Many ties, which are broken by the lower index.
+float WithTies(int64_t c) { return static_cast<float>((c * 7919) % 1000); }
+
+// Every column beats the current k-th one.
+float Increasing(int64_t c) { return static_cast<float>(c); }
+
+// The top k are all in the first shard.
+float Decreasing(int64_t c) { return static_cast<float>(kNumCols - c); }
+
+TEST_F(TopKOpTest, SortedColumnShardsWithTies) {
+  ExpectColumnShardsMatchRows(/*sorted=*/true, WithTies);
+}
+
+TEST_F(TopKOpTest, UnsortedColumnShardsWithTies) {
+  ExpectColumnShardsMatchRows(/*sorted=*/false, WithTies);
+}
+
+TEST_F(TopKOpTest, SortedColumnShardsIncreasing) {
+  ExpectColumnShardsMatchRows(/*sorted=*/true, Increasing);
+}
+
+TEST_F(TopKOpTest, UnsortedColumnShardsIncreasing) {
+  ExpectColumnShardsMatchRows(/*sorted=*/false, Increasing);
+}
+
+TEST_F(TopKOpTest, SortedColumnShardsDecreasing) {
+  ExpectColumnShardsMatchRows(/*sorted=*/true, Decreasing);
+}
+
+TEST_F(TopKOpTest, UnsortedColumnShardsDecreasing) {
+  ExpectColumnShardsMatchRows(/*sorted=*/false, Decreasing);
+}
+
+}  // namespace
+}  // namespace tensorflow
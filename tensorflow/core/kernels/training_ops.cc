@@ -17,6 +17,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -162,6 +165,97 @@ struct ApplyAdagradV2<CPUDevice, T> {
   }
 };
 
+namespace {
+
+// Groups the positions of `indices` by row. On return, `rows` holds the
+// unique indices in increasing order, and the positions in `indices` of
+// rows[k] are positions[offsets[k]] to positions[offsets[k + 1] - 1], in
+// input order. Updates of different rows never alias, so they can be sharded
+// by row without locks.
+template <typename Tindex>
+Status GroupIndicesByRow(typename TTypes<Tindex>::ConstVec indices,
+                         Tindex first_dim_size, std::vector<Tindex>* rows,
+                         std::vector<Tindex>* offsets,
+                         std::vector<Tindex>* positions) {
+  const Tindex N = static_cast<Tindex>(indices.dimension(0));
+  std::vector<std::pair<Tindex, Tindex>> sorted(N);
+  for (Tindex i = 0; i < N; ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+    sorted[i] = {index, i};
+  }
+  std::sort(sorted.begin(), sorted.end());
+  rows->clear();
+  offsets->clear();
+  positions->resize(N);
+  for (Tindex i = 0; i < N; ++i) {
+    if (i == 0 || sorted[i].first != sorted[i - 1].first) {
+      rows->push_back(sorted[i].first);
+      offsets->push_back(i);
+    }
+    (*positions)[i] = sorted[i].second;
+  }
+  offsets->push_back(N);
+  return OkStatus();
+}
+
+}  // namespace
+
+// Like SparseApplyAdagrad, but sums the gradients of duplicate indices and
+// updates every row once, with the sum as a single gradient. For the
+// `deduplicate_indices` attr of the CPU kernels.
+template <typename T, typename Tindex, bool has_epsilon>
+struct SparseApplyAdagradDeduplicated {
+  Status operator()(const CPUDevice& d, typename TTypes<T>::Matrix var,
+                    typename TTypes<T>::Matrix accum,
+                    typename TTypes<T>::ConstScalar lr,
+                    typename TTypes<T>::ConstScalar epsilon,
+                    typename TTypes<T>::ConstMatrix grad,
+                    typename TTypes<Tindex>::ConstVec indices,
+                    int64_t inner_dim, bool update_slots) {
+    const Tindex N = static_cast<Tindex>(indices.dimension(0));
+    if (N == 0) return OkStatus();
+    const Tindex first_dim_size = static_cast<Tindex>(var.dimension(0));
+    const T lr_scalar = lr();
+    std::vector<Tindex> rows, offsets, positions;
+    TF_RETURN_IF_ERROR(GroupIndicesByRow<Tindex>(indices, first_dim_size,
+                                                 &rows, &offsets, &positions));
+
+    const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+      Eigen::Tensor<T, 1, Eigen::RowMajor> g(inner_dim);
+      for (Tindex k = start_row; k < end_row; ++k) {
+        g = grad.template chip<0>(positions[offsets[k]]);
+        for (Tindex j = offsets[k] + 1; j < offsets[k + 1]; ++j) {
+          g += grad.template chip<0>(positions[j]);
+        }
+        auto a = accum.template chip<0>(rows[k]);
+        auto v = var.template chip<0>(rows[k]);
+        if (update_slots) {
+          a += g.square();
+        }
+        if (has_epsilon) {
+          v -= g.constant(lr_scalar) * g / (a.sqrt() + a.constant(epsilon()));
+        } else {
+          v -= g.constant(lr_scalar) * g * a.rsqrt();
+        }
+      }
+    };
+
+    // Every unique row reads and sums the gradients of its duplicates.
+    const double indices_per_row = static_cast<double>(N) / rows.size();
+    const Eigen::TensorOpCost cost(
+        inner_dim * sizeof(T) * (2 + indices_per_row),
+        inner_dim * sizeof(T) * 2,
+        inner_dim * (Eigen::TensorOpCost::AddCost<T>() * (2 + indices_per_row) +
+                     Eigen::TensorOpCost::MulCost<T>() * 2));
+    d.parallelFor(static_cast<Tindex>(rows.size()), cost, shard);
+    return OkStatus();
+  }
+};
+
 template <typename T, typename Tindex, bool has_epsilon>
 struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
   Status operator()(const CPUDevice& d, typename TTypes<T>::Matrix var,
@@ -1884,6 +1978,12 @@ class SparseApplyAdagradOp : public OpKernel {
   explicit SparseApplyAdagradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("deduplicate_indices", &deduplicate_indices_));
+    OP_REQUIRES(ctx,
+                !deduplicate_indices_ || std::is_same<Device, CPUDevice>::value,
+                errors::Unimplemented(
+                    "deduplicate_indices is only supported on CPU"));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
@@ -1939,6 +2039,20 @@ class SparseApplyAdagradOp : public OpKernel {
                     "Inner dimension should be greater than zero."));
 
     const Device& device = ctx->template eigen_device<Device>();
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      if (deduplicate_indices_) {
+        OP_REQUIRES_OK(
+            ctx, functor::SparseApplyAdagradDeduplicated<
+                     T, Tindex, /*has_epsilon = */ false>()(
+                     device, var.flat_outer_dims<T>(),
+                     accum.flat_outer_dims<T>(),
+                     // Note: Passing lr as a placeholder for unused epsilon.
+                     lr.scalar<T>(), lr.scalar<T>(), grad.flat_outer_dims<T>(),
+                     indices.vec<Tindex>(), inner_dim, update_slots_));
+        MaybeForwardRefInputToRefOutput(ctx, 0, 0);
+        return;
+      }
+    }
     OP_REQUIRES_OK(
         ctx, functor::SparseApplyAdagrad<Device, T, Tindex,
                                          /*has_epsilon = */ false>()(
@@ -1953,6 +2067,7 @@ class SparseApplyAdagradOp : public OpKernel {
  private:
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool deduplicate_indices_;
 };
 
 #define REGISTER_KERNELS(D, T, Tindices)                                 \
@@ -2014,6 +2129,12 @@ class SparseApplyAdagradV2Op : public OpKernel {
   explicit SparseApplyAdagradV2Op(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("deduplicate_indices", &deduplicate_indices_));
+    OP_REQUIRES(ctx,
+                !deduplicate_indices_ || std::is_same<Device, CPUDevice>::value,
+                errors::Unimplemented(
+                    "deduplicate_indices is only supported on CPU"));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
@@ -2073,6 +2194,19 @@ class SparseApplyAdagradV2Op : public OpKernel {
                     "Inner dimension should be greater than zero."));
 
     const Device& device = ctx->template eigen_device<Device>();
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      if (deduplicate_indices_) {
+        OP_REQUIRES_OK(
+            ctx, functor::SparseApplyAdagradDeduplicated<
+                     T, Tindex, /*has_epsilon = */ true>()(
+                     device, var.flat_outer_dims<T>(),
+                     accum.flat_outer_dims<T>(), lr.scalar<T>(),
+                     epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
+                     indices.vec<Tindex>(), inner_dim, update_slots_));
+        MaybeForwardRefInputToRefOutput(ctx, 0, 0);
+        return;
+      }
+    }
     OP_REQUIRES_OK(
         ctx, functor::SparseApplyAdagrad<Device, T, Tindex,
                                          /*has_epsilon = */ true>()(
@@ -2086,6 +2220,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
  private:
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool deduplicate_indices_;
 };
 
 #define REGISTER_KERNELS(D, T, Tindices)                                   \
@@ -13,9 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -80,6 +90,14 @@ static Node* Iota(Graph* g, int n) {
   return test::graph::Constant(g, data);
 }
 
+// Indices in [0, n / d), each repeated d times.
+static Node* RepeatedIndices(Graph* g, int n, int d) {
+  Tensor data(DT_INT32, TensorShape({n}));
+  int32* base = data.flat<int32>().data();
+  for (int i = 0; i < n; ++i) base[i] = i % (n / d);
+  return test::graph::Constant(g, data);
+}
+
 static Node* Scalar(Graph* g, float val) {
   Tensor data(DT_FLOAT, TensorShape({}));
   data.flat<float>()(0) = val;
@@ -154,7 +172,8 @@ static void BM_Adagrad(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Adagrad)->Arg(128 << 10)->Arg(256 << 10);
 
-static void SparseAdagrad(int32_t m, int32_t n, Graph** init_g,
+static void SparseAdagrad(int32_t m, int32_t n, int32_t duplicates,
+                          bool deduplicate_indices, Graph** init_g,
                           Graph** train_g) {
   {
     Graph* g = new Graph(OpRegistry::Global());
@@ -171,9 +190,16 @@ static void SparseAdagrad(int32_t m, int32_t n, Graph** init_g,
     auto accum = Var(g, m, n);
     auto lr = Scalar(g, 0.01);
     auto grad = Random(g, m, n);
-    auto indices = Iota(g, m);
-    test::graph::Multi(g, "SparseApplyAdagrad",
-                       {var, accum, lr, grad, indices});
+    auto indices =
+        duplicates > 1 ? RepeatedIndices(g, m, duplicates) : Iota(g, m);
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseApplyAdagrad")
+                    .Input(var)
+                    .Input(accum)
+                    .Input(lr)
+                    .Input(grad)
+                    .Input(indices)
+                    .Attr("deduplicate_indices", deduplicate_indices)
+                    .Finalize(g, nullptr));
     *train_g = g;
   }
 }
@@ -183,7 +209,8 @@ static void BM_SparseAdagrad(::testing::benchmark::State& state) {
 
   Graph* init;
   Graph* train;
-  SparseAdagrad(m, n, &init, &train);
+  SparseAdagrad(m, n, /*duplicates=*/1, /*deduplicate_indices=*/false, &init,
+                &train);
   test::Benchmark("cpu", train, GetMultiThreadedOptions(), init, nullptr, "",
                   /*old_benchmark_api*/ false)
       .Run(state);
@@ -199,6 +226,32 @@ BENCHMARK(BM_SparseAdagrad)
     ->ArgPair(128, 32 << 10)
     ->ArgPair(128, 128 << 10);
 
+// The third argument sets the `deduplicate_indices` attr.
+static void BM_SparseAdagradDuplicateIndices(
+    ::testing::benchmark::State& state) {
+  const int m = state.range(0);
+  const int n = state.range(1);
+  const bool deduplicate_indices = state.range(2);
+
+  Graph* init;
+  Graph* train;
+  SparseAdagrad(m, n, /*duplicates=*/8, deduplicate_indices, &init, &train);
+  test::Benchmark("cpu", train, GetMultiThreadedOptions(), init, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * m * n;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_SparseAdagradDuplicateIndices)
+    ->UseRealTime()
+    ->Args({1024, 64, 0})
+    ->Args({1024, 64, 1})
+    ->Args({1024, 1 << 10, 0})
+    ->Args({1024, 1 << 10, 1})
+    ->Args({16 << 10, 64, 0})
+    ->Args({16 << 10, 64, 1});
+
 static void Momentum(int32_t n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
@@ -420,4 +473,89 @@ static void BM_PowerSign(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PowerSign)->Arg(128 << 10)->Arg(256 << 10);
 
+class SparseApplyAdagradOpTest : public OpsTestBase {
+ protected:
+  // Applies the gradients {1, 2}, {3, 4} and {1, 1} to the rows 2, 0 and 2 of
+  // a [3, 2] variable and accumulator of ones, with a learning rate of 0.5.
+  void RunAdagrad(bool deduplicate_indices) {
+    TF_ASSERT_OK(NodeDefBuilder("adagrad", "ResourceSparseApplyAdagrad")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("deduplicate_indices", deduplicate_indices)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    var_ = NewOnes();
+    accum_ = NewOnes();
+    AddResourceInput("", "var", var_);
+    AddResourceInput("", "accum", accum_);
+    AddInputFromArray<float>(TensorShape({}), {0.5});
+    AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 1, 1});
+    AddInputFromArray<int32>(TensorShape({3}), {2, 0, 2});
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  static Var* NewOnes() {
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = test::AsTensor<float>({1, 1, 1, 1, 1, 1}, {3, 2});
+    var->is_initialized = true;
+    return var;
+  }
+
+  // Owned by the resource manager.
+  Var* var_ = nullptr;
+  Var* accum_ = nullptr;
+};
+
+TEST_F(SparseApplyAdagradOpTest, AppliesDuplicateIndicesInOrder) {
+  RunAdagrad(/*deduplicate_indices=*/false);
+  // Row 2 is updated with {1, 2}, then with {1, 1}.
+  test::ExpectTensorNear<float>(
+      *accum_->tensor(), test::AsTensor<float>({10, 17, 1, 1, 3, 6}, {3, 2}),
+      1e-6);
+  test::ExpectTensorNear<float>(
+      *var_->tensor(),
+      test::AsTensor<float>(
+          {1 - 1.5f / std::sqrt(10.0f), 1 - 2 / std::sqrt(17.0f), 1, 1,
+           1 - 0.5f / std::sqrt(2.0f) - 0.5f / std::sqrt(3.0f),
+           1 - 1 / std::sqrt(5.0f) - 0.5f / std::sqrt(6.0f)},
+          {3, 2}),
+      1e-6);
+}
+
+TEST_F(SparseApplyAdagradOpTest, DeduplicatesIndices) {
+  RunAdagrad(/*deduplicate_indices=*/true);
+  // Row 2 is updated once with the sum {2, 3}.
+  test::ExpectTensorNear<float>(
+      *accum_->tensor(), test::AsTensor<float>({10, 17, 1, 1, 5, 10}, {3, 2}),
+      1e-6);
+  test::ExpectTensorNear<float>(
+      *var_->tensor(),
+      test::AsTensor<float>(
+          {1 - 1.5f / std::sqrt(10.0f), 1 - 2 / std::sqrt(17.0f), 1, 1,
+           1 - 1 / std::sqrt(5.0f), 1 - 1.5f / std::sqrt(10.0f)},
+          {3, 2}),
+      1e-6);
+}
+
+TEST_F(SparseApplyAdagradOpTest, DeduplicateRejectsOutOfRangeIndices) {
+  TF_ASSERT_OK(NodeDefBuilder("adagrad", "ResourceSparseApplyAdagrad")
+                   .Input(FakeInput(DT_RESOURCE))
+                   .Input(FakeInput(DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("deduplicate_indices", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddResourceInput("", "var", NewOnes());
+  AddResourceInput("", "accum", NewOnes());
+  AddInputFromArray<float>(TensorShape({}), {0.5});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 3});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 }  // end namespace tensorflow
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +72,148 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Integer elements of 1D inputs with at least this many elements are
+// uniquified in parallel by `ParallelUnique()`.
+constexpr int64_t kMinParallelUniqueSize = 128 * 1024;
+
+template <typename T>
+constexpr bool SupportsParallelUnique() {
+  return std::is_integral<T>::value && !std::is_same<T, bool>::value;
+}
+
+// Uniquifies the integer elements of `input`, viewed as 1D, on `thread_pool`,
+// with the same output as the sequential hash map: the unique elements are
+// ordered by first occurrence. Allocates the output with the shape of `input`,
+// except for `axis`.
+//
+// The indices of the elements are first partitioned by a hash of the element,
+// keeping them in order within a partition. Each partition is then uniquified
+// with its own hash map, which finds the first occurrence of every element.
+// The first occurrences are numbered in input order by a parallel prefix sum,
+// and finally every element gets the number of its first occurrence.
+template <typename T, typename TIndex>
+Status ParallelUnique(OpKernelContext* context, const Tensor& input,
+                      int64_t axis, thread::ThreadPool* thread_pool,
+                      typename TTypes<TIndex>::Vec idx_vec,
+                      int64_t* uniq_size) {
+  constexpr int kPartitionBits = 8;
+  constexpr int64_t kNumPartitions = int64_t{1} << kPartitionBits;
+  constexpr int64_t kNumChunks = 256;
+  // Roughly the cycles to hash or copy an element, and to look it up in a
+  // hash map.
+  constexpr int64_t kElementCost = 10;
+  constexpr int64_t kLookupCost = 100;
+
+  auto Tin = input.flat<T>();
+  const int64_t N = Tin.size();
+  const int64_t chunk_size = (N + kNumChunks - 1) / kNumChunks;
+  const auto partition = [&Tin](int64_t i) {
+    return static_cast<uint64>(Tin(i)) * 0x9E3779B97F4A7C15ULL >>
+           (64 - kPartitionBits);
+  };
+  // Runs `fn(chunk, begin, end)` on every chunk of the input in parallel.
+  const auto for_each_chunk = [&](const std::function<void(int64_t, int64_t,
+                                                           int64_t)>& fn) {
+    thread_pool->ParallelFor(
+        kNumChunks, chunk_size * kElementCost,
+        [&](int64_t first_chunk, int64_t last_chunk) {
+          for (int64_t c = first_chunk; c < last_chunk; ++c) {
+            fn(c, std::min(N, c * chunk_size),
+               std::min(N, (c + 1) * chunk_size));
+          }
+        });
+  };
+
+  // The input size is at most int32 max, so uint32 fits the indices.
+  // `offsets[c * kNumPartitions + p]` is where chunk `c` writes the indices
+  // of its elements of partition `p` in `order`.
+  std::vector<uint32> offsets(kNumChunks * kNumPartitions, 0);
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    uint32* counts = &offsets[c * kNumPartitions];
+    for (int64_t i = begin; i < end; ++i) ++counts[partition(i)];
+  });
+  std::vector<uint32> partition_begin(kNumPartitions + 1, 0);
+  uint32 offset = 0;
+  for (int64_t p = 0; p < kNumPartitions; ++p) {
+    partition_begin[p] = offset;
+    for (int64_t c = 0; c < kNumChunks; ++c) {
+      const uint32 count = offsets[c * kNumPartitions + p];
+      offsets[c * kNumPartitions + p] = offset;
+      offset += count;
+    }
+  }
+  partition_begin[kNumPartitions] = offset;
+  std::vector<uint32> order(N);
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    uint32* positions = &offsets[c * kNumPartitions];
+    for (int64_t i = begin; i < end; ++i) {
+      order[positions[partition(i)]++] = static_cast<uint32>(i);
+    }
+  });
+
+  // `local_ids[q]` is the number of element `order[q]` within its partition,
+  // and `firsts[p][k]` the index of the first occurrence of element number
+  // `k` of partition `p`.
+  std::vector<uint32> local_ids(N);
+  std::vector<std::vector<uint32>> firsts(kNumPartitions);
+  std::vector<uint8> is_first(N, 0);
+  thread_pool->ParallelFor(
+      kNumPartitions, N / kNumPartitions * kLookupCost,
+      [&](int64_t first_partition, int64_t last_partition) {
+        for (int64_t p = first_partition; p < last_partition; ++p) {
+          absl::flat_hash_map<T, uint32> uniq;
+          uniq.reserve(partition_begin[p + 1] - partition_begin[p]);
+          for (uint32 q = partition_begin[p]; q < partition_begin[p + 1];
+               ++q) {
+            const uint32 i = order[q];
+            auto it = uniq.emplace(Tin(i), firsts[p].size());
+            if (it.second) {
+              firsts[p].push_back(i);
+              is_first[i] = 1;
+            }
+            local_ids[q] = it.first->second;
+          }
+        }
+      });
+
+  // Numbers the first occurrences in input order, and writes the output.
+  std::vector<int64_t> chunk_firsts(kNumChunks + 1, 0);
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    chunk_firsts[c + 1] =
+        std::count(is_first.begin() + begin, is_first.begin() + end, 1);
+  });
+  for (int64_t c = 0; c < kNumChunks; ++c) {
+    chunk_firsts[c + 1] += chunk_firsts[c];
+  }
+  *uniq_size = chunk_firsts[kNumChunks];
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, *uniq_size);
+  Tensor* output = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  for_each_chunk([&](int64_t c, int64_t begin, int64_t end) {
+    int64_t j = chunk_firsts[c];
+    for (int64_t i = begin; i < end; ++i) {
+      if (is_first[i]) {
+        idx_vec(i) = j;
+        Tout(j) = Tin(i);
+        ++j;
+      }
+    }
+  });
+  thread_pool->ParallelFor(
+      kNumPartitions, N / kNumPartitions * kElementCost,
+      [&](int64_t first_partition, int64_t last_partition) {
+        for (int64_t p = first_partition; p < last_partition; ++p) {
+          for (uint32 q = partition_begin[p]; q < partition_begin[p + 1];
+               ++q) {
+            idx_vec(order[q]) = idx_vec(firsts[p][local_ids[q]]);
+          }
+        }
+      });
+  return absl::OkStatus();
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -149,27 +295,42 @@ class UniqueOp : public OpKernel {
       // to them as in the general case.
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
+      const DeviceBase::CpuWorkerThreads& worker_threads =
+          *context->device()->tensorflow_cpu_worker_threads();
 
-      typename UniqueOpHashMap<T, TIndex>::map_type uniq;
-      uniq.reserve(2 * N);
-      for (Eigen::Index i = 0, j = 0; i < N; ++i) {
-        auto it = uniq.emplace(Tin(i), j);
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
+      bool parallel = false;
+      if constexpr (SupportsParallelUnique<T>()) {
+        parallel = N >= kMinParallelUniqueSize &&
+                   worker_threads.num_threads > 1;
+        if (parallel) {
+          OP_REQUIRES_OK(context,
+                         ParallelUnique<T, TIndex>(context, input, axis,
+                                                   worker_threads.workers,
+                                                   idx_vec, &uniq_size));
         }
       }
+      if (!parallel) {
+        typename UniqueOpHashMap<T, TIndex>::map_type uniq;
+        uniq.reserve(2 * N);
+        for (Eigen::Index i = 0, j = 0; i < N; ++i) {
+          auto it = uniq.emplace(Tin(i), j);
+          idx_vec(i) = it.first->second;
+          if (it.second) {
+            ++j;
+          }
+        }
 
-      uniq_size = static_cast<int64_t>(uniq.size());
-      TensorShape output_shape(input.shape());
-      output_shape.set_dim(axis, uniq_size);
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output(0, output_shape, &output));
-      auto Tout = output->flat<T>();
+        uniq_size = static_cast<int64_t>(uniq.size());
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->flat<T>();
 
-      for (const auto& it : uniq) {
-        Tout(it.second) = it.first;
+        for (const auto& it : uniq) {
+          Tout(it.second) = it.first;
+        }
       }
     } else {
       // General implementation when unique is run over multiple elements.
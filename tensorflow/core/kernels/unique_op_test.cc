@@ -13,12 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdlib>
 #include <functional>
 #include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -37,6 +43,44 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large integer inputs are uniquified in parallel, and must still be ordered
+// by first occurrence.
+TEST_F(UniqueOpTest, LargeInt64MatchesFirstOccurrenceOrder) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int n = 1024 * 1024;
+  std::vector<int64_t> values(n);
+  for (int i = 0; i < n; ++i) {
+    values[i] = (static_cast<int64_t>(std::rand()) % 100000 - 50000) << 20;
+  }
+  AddInputFromArray<int64_t>(TensorShape({n}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  absl::flat_hash_map<int64_t, int32> first_occurrence;
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx(n);
+  for (int i = 0; i < n; ++i) {
+    auto it = first_occurrence.emplace(values[i], expected_y.size());
+    if (it.second) expected_y.push_back(values[i]);
+    expected_idx[i] = it.first->second;
+  }
+  std::vector<int32> expected_count(expected_y.size(), 0);
+  for (int i = 0; i < n; ++i) ++expected_count[expected_idx[i]];
+  const int64_t num_unique = expected_y.size();
+  test::ExpectTensorEqual<int64_t>(
+      test::AsTensor<int64_t>(expected_y, {num_unique}), *GetOutput(0));
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>(expected_idx, {n}),
+                                 *GetOutput(1));
+  test::ExpectTensorEqual<int32>(
+      test::AsTensor<int32>(expected_count, {num_unique}), *GetOutput(2));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
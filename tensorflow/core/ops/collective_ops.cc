@@ -139,6 +139,7 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("is_stateless: bool = false")
     .Attr("Nordering_token: int >= 0 = 0")
     .Attr("max_subdivs_per_device: int = -1")
+    .Attr("compression: {'none', 'bfloat16'} = 'none'")
     .SetIsStateful()
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
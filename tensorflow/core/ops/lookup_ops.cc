@@ -374,6 +374,7 @@ REGISTER_OP("HashTableV2")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("experimental_perfect_hash_min_size: int >= 0 = 0")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
@@ -1301,6 +1301,110 @@ REGISTER_OP("LogSoftmax")
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("_FusedScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("scale: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      ShapeHandle key;
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 2, &query));
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 2, &key));
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 2, &value));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(query, -1), c->Dim(key, -1), &unused_dim));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(key, -2), c->Dim(value, -2), &unused_dim));
+
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -1, &output));
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(output, c->Vector(c->Dim(value, -1)), &output));
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes `Softmax(scale * query * key^T + mask) * value` without materializing
+the attention scores.
+
+`query` has shape `[..., Lq, D]`, `key` has shape `[..., Lk, D]` and `value`
+has shape `[..., Lk, Dv]`, with identical batch dimensions. `scale` is a
+scalar. If `num_args` is 1, `args` holds an additive mask which is broadcast
+to the `[..., Lq, Lk]` scores. The output has shape `[..., Lq, Dv]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+
+REGISTER_OP("_FusedDropout")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("rate: T")
+    .Output("output: T")
+    .Output("mask: uint8")
+    .Attr("seed: int = 0")
+    .Attr("seed2: int = 0")
+    .Attr("divide: bool = false")
+    .Attr("T: {half, bfloat16, float, double}")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      c->set_output(0, c->input(0));
+      DimensionHandle num_masks = c->UnknownDim();
+      if (c->FullyDefined(c->input(0))) {
+        num_masks =
+            c->MakeDim((c->Value(c->NumElements(c->input(0))) + 7) / 8);
+      }
+      c->set_output(1, c->Vector(num_masks));
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes `SelectV2(RandomUniform(shape(x)) >= rate, x * scale, 0)`, or
+`x / scale` if `divide` is true, without materializing the random tensor.
+
+The uniform samples are the same as the ones of a RandomUniform op with the
+same seeds. Bit `i % 8` of `mask[i / 8]` is set iff element `i` of `x` was
+kept.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
+REGISTER_OP("_FusedDropoutGrad")
+    .Input("gradients: T")
+    .Input("mask: uint8")
+    .Output("backprops: T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      c->set_output(0, c->input(0));
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes `SelectV2(keep, gradients, 0)`, where `keep` is unpacked from the
+`mask` output of a _FusedDropout.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("SoftmaxCrossEntropyWithLogits")
     .Input("features: T")
     .Input("labels: T")
@@ -256,6 +256,7 @@ REGISTER_OP("ResourceGather")
     .Input("indices: Tindices")
     .Attr("batch_dims: int = 0")
     .Attr("validate_indices: bool = true")
+    .Attr("hot_row_cache_rows: int = 0")
     .Output("output: dtype")
     .Attr("dtype: type")
     .Attr("Tindices: {int32,int64}")
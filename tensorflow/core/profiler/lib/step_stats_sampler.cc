@@ -0,0 +1,175 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/step_stats_sampler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tsl/profiler/lib/profiler_factory.h"
+#include "tsl/profiler/lib/profiler_interface.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+#include "tsl/profiler/utils/math_utils.h"
+#include "tsl/profiler/utils/xplane_builder.h"
+#include "tsl/profiler/utils/xplane_utils.h"
+#endif
+
+namespace tensorflow {
+namespace profiler {
+
+StepStatsSampler* StepStatsSampler::Global() {
+  static StepStatsSampler* sampler = [] {
+    Options options;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_PROFILER_SAMPLE_STEP_INTERVAL",
+                                    /*default_val=*/0,
+                                    &options.step_interval));
+    if (options.step_interval > 0) {
+      VLOG(1) << "Sampling the op stats of one step in "
+              << options.step_interval;
+    }
+    return new StepStatsSampler(options);
+  }();
+  return sampler;
+}
+
+void StepStatsSampler::AddStepStats(StepStats step_stats) {
+  mutex_lock l(mu_);
+  ++sampled_steps_;
+  buffered_steps_.push_back(std::move(step_stats));
+  if (buffered_steps_.size() >= options_.max_buffered_steps) {
+    AggregateBufferedSteps();
+  }
+}
+
+void StepStatsSampler::AggregateBufferedSteps() {
+  for (const StepStats& step_stats : buffered_steps_) {
+    for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+      for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+        OpKey key(device_stats.device(), node_stats.node_name());
+        auto it = op_stats_.find(key);
+        if (it == op_stats_.end()) {
+          if (op_stats_.size() >= options_.max_ops) {
+            ++dropped_ops_;
+            continue;
+          }
+          it = op_stats_.emplace(std::move(key), OpStats()).first;
+        }
+        OpStats& stats = it->second;
+        const int64_t micros = node_stats.all_end_rel_micros();
+        stats.min_micros =
+            stats.count == 0 ? micros : std::min(stats.min_micros, micros);
+        stats.max_micros = std::max(stats.max_micros, micros);
+        stats.total_micros += micros;
+        ++stats.count;
+      }
+    }
+  }
+  buffered_steps_.clear();
+}
+
+absl::flat_hash_map<StepStatsSampler::OpKey, StepStatsSampler::OpStats>
+StepStatsSampler::GetOpStats() {
+  mutex_lock l(mu_);
+  AggregateBufferedSteps();
+  return op_stats_;
+}
+
+int64_t StepStatsSampler::sampled_steps() {
+  mutex_lock l(mu_);
+  return sampled_steps_;
+}
+
+int64_t StepStatsSampler::dropped_ops() {
+  mutex_lock l(mu_);
+  AggregateBufferedSteps();
+  return dropped_ops_;
+}
+
+#if !defined(IS_MOBILE_PLATFORM)
+namespace {
+
+// Adds the aggregates of the global StepStatsSampler to the collected XSpace.
+// Each device is a line, and each op an event whose duration is the total
+// wall time of the op and whose number of occurrences is its sample count.
+class SampledOpStatsCollector : public tsl::profiler::ProfilerInterface {
+ public:
+  SampledOpStatsCollector() = default;
+
+  absl::Status Start() override { return absl::OkStatus(); }
+
+  absl::Status Stop() override { return absl::OkStatus(); }
+
+  absl::Status CollectData(tsl::profiler::XSpace* space) override {
+    StepStatsSampler* sampler = StepStatsSampler::Global();
+    tsl::profiler::XPlaneBuilder plane(
+        tsl::profiler::FindOrAddMutablePlaneWithName(
+            space, kSampledOpStatsPlaneName));
+    plane.AddStatValue(*plane.GetOrCreateStatMetadata("sampled_steps"),
+                       sampler->sampled_steps());
+    plane.AddStatValue(*plane.GetOrCreateStatMetadata("dropped_ops"),
+                       sampler->dropped_ops());
+    const tsl::profiler::XStatMetadata& min_duration =
+        *plane.GetOrCreateStatMetadata("min_duration_ps");
+    const tsl::profiler::XStatMetadata& max_duration =
+        *plane.GetOrCreateStatMetadata("max_duration_ps");
+    absl::flat_hash_map<std::string, int64_t> line_ids;
+    for (const auto& [key, stats] : sampler->GetOpStats()) {
+      const auto [it, inserted] = line_ids.emplace(key.first, line_ids.size());
+      tsl::profiler::XLineBuilder line = plane.GetOrCreateLine(it->second);
+      if (inserted) line.SetName(key.first);
+      tsl::profiler::XEventBuilder event =
+          line.AddEvent(*plane.GetOrCreateEventMetadata(key.second));
+      event.SetDurationPs(tsl::profiler::MicroToPico(stats.total_micros));
+      event.SetNumOccurrences(stats.count);
+      event.AddStatValue(min_duration,
+                         tsl::profiler::MicroToPico(stats.min_micros));
+      event.AddStatValue(max_duration,
+                         tsl::profiler::MicroToPico(stats.max_micros));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  SampledOpStatsCollector(const SampledOpStatsCollector&) = delete;
+  void operator=(const SampledOpStatsCollector&) = delete;
+};
+
+std::unique_ptr<tsl::profiler::ProfilerInterface>
+CreateSampledOpStatsCollector(const tensorflow::ProfileOptions& options) {
+  return StepStatsSampler::Global()->enabled()
+             ? std::make_unique<SampledOpStatsCollector>()
+             : nullptr;
+}
+
+}  // namespace
+
+auto register_sampled_op_stats_collector_factory = [] {
+  tsl::profiler::RegisterProfilerFactory(&CreateSampledOpStatsCollector);
+  return 0;
+}();
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
+}  // namespace profiler
+}  // namespace tensorflow
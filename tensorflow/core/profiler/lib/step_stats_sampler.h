@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_STEP_STATS_SAMPLER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_STEP_STATS_SAMPLER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Name of the XPlane holding the aggregated op stats of the sampled steps.
+inline constexpr char kSampledOpStatsPlaneName[] = "/host:sampled_op_stats";
+
+// Continuously samples one step in `step_interval`, and aggregates the wall
+// time of each op of the sampled steps in process.
+//
+// This is cheap enough to stay enabled in production: unsampled steps only pay
+// for an atomic increment, and no TraceMe is recorded. The memory is bounded
+// by `max_buffered_steps` StepStats, which are folded into the aggregates once
+// the buffer is full, and by `max_ops` aggregates.
+//
+// When enabled, the aggregates are added as an XPlane named
+// kSampledOpStatsPlaneName to every profile collected by a ProfilerSession,
+// including the ones requested through the profiler service.
+//
+// Thread-safety: This class is thread-safe.
+class StepStatsSampler {
+ public:
+  struct Options {
+    // One step in `step_interval` is sampled. Sampling is disabled if 0.
+    int64_t step_interval = 0;
+    // Number of sampled steps buffered before they are aggregated.
+    int max_buffered_steps = 16;
+    // Maximum number of ops with aggregated stats. Ops seen after that are
+    // not aggregated, and counted by dropped_ops().
+    int max_ops = 4096;
+  };
+
+  // Aggregated wall time of an op over the sampled steps.
+  struct OpStats {
+    int64_t count = 0;
+    int64_t total_micros = 0;
+    int64_t min_micros = 0;
+    int64_t max_micros = 0;
+  };
+
+  // Aggregates are keyed by device and node name.
+  using OpKey = std::pair<std::string, std::string>;
+
+  explicit StepStatsSampler(const Options& options) : options_(options) {}
+
+  // Returns the process-wide sampler. It samples one step in the value of the
+  // TF_PROFILER_SAMPLE_STEP_INTERVAL environment variable, and is disabled if
+  // the variable is unset or 0.
+  static StepStatsSampler* Global();
+
+  bool enabled() const { return options_.step_interval > 0; }
+
+  // Returns true if the stats of the current step should be collected and
+  // passed to AddStepStats.
+  bool SampleStep() {
+    if (!enabled()) return false;
+    return step_count_.fetch_add(1, std::memory_order_relaxed) %
+               options_.step_interval ==
+           0;
+  }
+
+  // Buffers the stats of a sampled step.
+  void AddStepStats(StepStats step_stats);
+
+  // Returns the aggregated stats of the steps sampled so far.
+  absl::flat_hash_map<OpKey, OpStats> GetOpStats();
+
+  // Returns the number of steps sampled so far.
+  int64_t sampled_steps();
+
+  // Returns the number of op executions that were not aggregated because
+  // `max_ops` was reached.
+  int64_t dropped_ops();
+
+ private:
+  void AggregateBufferedSteps() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+  std::atomic<int64_t> step_count_{0};
+
+  mutex mu_;
+  std::vector<StepStats> buffered_steps_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<OpKey, OpStats> op_stats_ TF_GUARDED_BY(mu_);
+  int64_t sampled_steps_ TF_GUARDED_BY(mu_) = 0;
+  int64_t dropped_ops_ TF_GUARDED_BY(mu_) = 0;
+
+  StepStatsSampler(const StepStatsSampler&) = delete;
+  void operator=(const StepStatsSampler&) = delete;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_STEP_STATS_SAMPLER_H_
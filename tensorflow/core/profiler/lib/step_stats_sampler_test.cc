@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/step_stats_sampler.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Returns the stats of a step that ran `node_micros` on `device`, with node
+// `i` named "n<i>".
+StepStats MakeStepStats(const std::string& device,
+                        const std::vector<int64_t>& node_micros) {
+  StepStats step_stats;
+  DeviceStepStats* device_stats = step_stats.add_dev_stats();
+  device_stats->set_device(device);
+  for (int i = 0; i < node_micros.size(); ++i) {
+    NodeExecStats* node_stats = device_stats->add_node_stats();
+    node_stats->set_node_name(absl::StrCat("n", i));
+    node_stats->set_all_end_rel_micros(node_micros[i]);
+  }
+  return step_stats;
+}
+
+TEST(StepStatsSamplerTest, Disabled) {
+  StepStatsSampler sampler(StepStatsSampler::Options{});
+  EXPECT_FALSE(sampler.enabled());
+  for (int i = 0; i < 10; ++i) EXPECT_FALSE(sampler.SampleStep());
+}
+
+TEST(StepStatsSamplerTest, SamplesOneStepInInterval) {
+  StepStatsSampler::Options options;
+  options.step_interval = 3;
+  StepStatsSampler sampler(options);
+  std::vector<bool> sampled;
+  for (int i = 0; i < 7; ++i) sampled.push_back(sampler.SampleStep());
+  EXPECT_EQ(sampled,
+            std::vector<bool>({true, false, false, true, false, false, true}));
+}
+
+TEST(StepStatsSamplerTest, AggregatesOpStats) {
+  StepStatsSampler::Options options;
+  options.step_interval = 1;
+  options.max_buffered_steps = 2;
+  StepStatsSampler sampler(options);
+  sampler.AddStepStats(MakeStepStats("/cpu:0", {10, 5}));
+  sampler.AddStepStats(MakeStepStats("/cpu:0", {30, 5}));
+  sampler.AddStepStats(MakeStepStats("/gpu:0", {7}));
+  EXPECT_EQ(sampler.sampled_steps(), 3);
+
+  const auto op_stats = sampler.GetOpStats();
+  ASSERT_EQ(op_stats.size(), 3);
+  const StepStatsSampler::OpStats& n0 = op_stats.at({"/cpu:0", "n0"});
+  EXPECT_EQ(n0.count, 2);
+  EXPECT_EQ(n0.total_micros, 40);
+  EXPECT_EQ(n0.min_micros, 10);
+  EXPECT_EQ(n0.max_micros, 30);
+  EXPECT_EQ(op_stats.at({"/cpu:0", "n1"}).total_micros, 10);
+  EXPECT_EQ(op_stats.at({"/gpu:0", "n0"}).count, 1);
+  EXPECT_EQ(sampler.dropped_ops(), 0);
+}
+
+TEST(StepStatsSamplerTest, BoundsNumberOfOps) {
+  StepStatsSampler::Options options;
+  options.step_interval = 1;
+  options.max_ops = 2;
+  StepStatsSampler sampler(options);
+  sampler.AddStepStats(MakeStepStats("/cpu:0", {1, 2, 3}));
+  sampler.AddStepStats(MakeStepStats("/cpu:0", {1, 2, 3}));
+  EXPECT_EQ(sampler.GetOpStats().size(), 2);
+  EXPECT_EQ(sampler.dropped_ops(), 2);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -428,11 +428,17 @@ REGISTER_OP("_BatchFunctionFallback")
     // same batch, i.e., no low priority input padding high priority batches.
     // Low priority inputs get scheduled only as part of low priority only
     // batches as described above.
+    // priority_lanes: High priority inputs are scheduled as soon as a batch
+    // thread is available, without waiting for the batch timeout, and low
+    // priority inputs only fill the padding slots of those batches up to the
+    // next allowed batch size. Low priority only batches are scheduled as
+    // described above.
     .Attr(
         "mixed_priority_policy: "
         "{'low_priority_padding_with_max_batch_size', "
         "'low_priority_padding_with_next_allowed_batch_size', "
-        "'priority_isolation'} = 'low_priority_padding_with_max_batch_size'")
+        "'priority_isolation', 'priority_lanes'} = "
+        "'low_priority_padding_with_max_batch_size'")
     .Attr("Tin: list(type)")
     .Attr("Tcaptured: list(type) >= 0")
     .Attr("Tout: list(type)")
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/summary/summary_file_writer.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -23,21 +25,65 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/summary/summary_converter.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+// Controls the background flushing of a SummaryFileWriter.
+struct AsyncFlushOptions {
+  // If true, the queued events are written and flushed by a background
+  // thread, so that the ops writing summaries do not wait for the file
+  // system. Flush() still writes all events before returning.
+  bool enabled = false;
+  // The maximum number of queued events while the background thread is
+  // writing the previous ones.
+  int64_t max_pending_events = 1000;
+  // What happens to an event written while `max_pending_events` are queued:
+  // it is dropped if true, otherwise the caller waits for the background
+  // write.
+  bool drop_when_full = false;
+};
+
+AsyncFlushOptions AsyncFlushOptionsFromEnv() {
+  AsyncFlushOptions options;
+  Status s = ReadBoolFromEnvVar("TF_SUMMARY_WRITER_ASYNC_FLUSH", false,
+                                &options.enabled);
+  if (s.ok()) {
+    s = ReadInt64FromEnvVar("TF_SUMMARY_WRITER_MAX_PENDING_EVENTS",
+                            options.max_pending_events,
+                            &options.max_pending_events);
+  }
+  if (s.ok()) {
+    s = ReadBoolFromEnvVar("TF_SUMMARY_WRITER_DROP_WHEN_FULL", false,
+                           &options.drop_when_full);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to read the summary writer options: " << s;
+    return AsyncFlushOptions();
+  }
+  return options;
+}
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(int max_queue, int flush_millis, Env* env,
+                    const AsyncFlushOptions& async_options)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
-        env_(env) {}
+        env_(env),
+        async_options_(async_options) {
+    if (async_options_.enabled) {
+      write_thread_ = std::make_unique<thread::ThreadPool>(
+          env_, "summary_file_writer", /*num_threads=*/1);
+    }
+  }
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
     const Status is_dir = env_->IsDirectory(logdir);
@@ -71,11 +117,12 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    return WaitAndFlush(ml);
   }
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    write_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -155,7 +202,26 @@ class SummaryFileWriter : public SummaryWriterInterface {
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      if (!async_options_.enabled) {
+        return InternalFlush();
+      }
+      if (write_in_flight_ &&
+          queue_.size() > async_options_.max_pending_events) {
+        if (async_options_.drop_when_full) {
+          queue_.pop_back();
+          if (++num_dropped_events_ % 1000 == 1) {
+            LOG(WARNING) << "Dropped " << num_dropped_events_
+                         << " summary events while the events file is "
+                            "written in the background.";
+          }
+          return absl::OkStatus();
+        }
+        WaitForWrite(ml);
+      }
+      if (!write_in_flight_) {
+        ScheduleWrite();
+      }
+      return ConsumeWriteStatus();
     }
     return absl::OkStatus();
   }
@@ -167,28 +233,82 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
+  // Waits for the background write, if any, then writes the queued events.
+  Status WaitAndFlush(mutex_lock& ml) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    WaitForWrite(ml);
+    TF_RETURN_IF_ERROR(ConsumeWriteStatus());
+    return InternalFlush();
+  }
+
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+    TF_RETURN_IF_ERROR(WriteEvents(queue_));
+    queue_.clear();
+    last_flush_ = env_->NowMicros();
+    return absl::OkStatus();
+  }
+
+  // Writes `events` to the events file and flushes it. Only called by the
+  // thread which set `write_in_flight_`, or with `mu_` held and no write in
+  // flight.
+  Status WriteEvents(const std::vector<std::unique_ptr<Event>>& events) {
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return absl::OkStatus();
   }
 
+  // Hands the queued events to the background thread.
+  void ScheduleWrite() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    write_in_flight_ = true;
+    auto events = std::make_shared<std::vector<std::unique_ptr<Event>>>(
+        std::move(queue_));
+    queue_.clear();
+    last_flush_ = env_->NowMicros();
+    write_thread_->Schedule([this, events]() {
+      const Status s = WriteEvents(*events);
+      mutex_lock ml(mu_);
+      if (!s.ok() && write_status_.ok()) {
+        write_status_ = s;
+      }
+      write_in_flight_ = false;
+      write_done_.notify_all();
+    });
+  }
+
+  void WaitForWrite(mutex_lock& ml) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (write_in_flight_) {
+      write_done_.wait(ml);
+    }
+  }
+
+  // Returns the first error of the background writes since the last call.
+  Status ConsumeWriteStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = write_status_;
+    write_status_ = absl::OkStatus();
+    return s;
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
   uint64 last_flush_;
   Env* env_;
+  const AsyncFlushOptions async_options_;
   mutex mu_;
+  condition_variable write_done_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  // A pointer to allow deferred construction. Guarded by `mu_`, except while
+  // `write_in_flight_` is set, when only the background thread uses it.
+  std::unique_ptr<EventsWriter> events_writer_;
+  bool write_in_flight_ TF_GUARDED_BY(mu_) = false;
+  Status write_status_ TF_GUARDED_BY(mu_);
+  int64_t num_dropped_events_ TF_GUARDED_BY(mu_) = 0;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+  // Writes the events in the background if `async_options_.enabled`.
+  std::unique_ptr<thread::ThreadPool> write_thread_;
 };
 
 }  // namespace
@@ -197,7 +317,8 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env,
+                                               AsyncFlushOptionsFromEnv());
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
@@ -14,15 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <stdlib.h>
+
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/event.pb.h"
 
@@ -40,6 +48,24 @@ class FakeClockEnv : public EnvWrapper {
   uint64 current_millis_;
 };
 
+// Starts threads which only run once `OpenGate()` is called. This holds back
+// the background writes of a SummaryFileWriter.
+class GatedThreadEnv : public FakeClockEnv {
+ public:
+  Thread* StartThread(const ThreadOptions& thread_options, const string& name,
+                      absl::AnyInvocable<void()> fn) override {
+    return FakeClockEnv::StartThread(
+        thread_options, name, [this, fn = std::move(fn)]() mutable {
+          gate_.WaitForNotification();
+          fn();
+        });
+  }
+  void OpenGate() { gate_.Notify(); }
+
+ private:
+  Notification gate_;
+};
+
 class SummaryFileWriterTest : public ::testing::Test {
  protected:
   Status SummaryTestHelper(
@@ -57,6 +83,18 @@ class SummaryFileWriterTest : public ::testing::Test {
     TF_CHECK_OK(writer_fn(writer));
     TF_CHECK_OK(writer->Flush());
 
+    std::vector<Event> events;
+    TF_RETURN_IF_ERROR(ReadEvents(test_name, &events));
+    if (events.empty()) {
+      return errors::Unknown("Found no event for ", test_name);
+    }
+    test_fn(events[0]);
+    return absl::OkStatus();
+  }
+
+  // Reads all events of the file written for `test_name`, except for the
+  // first one, which holds the file version.
+  Status ReadEvents(const string& test_name, std::vector<Event>* events) {
     std::vector<string> files;
     TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
     bool found = false;
@@ -75,10 +113,15 @@ class SummaryFileWriterTest : public ::testing::Test {
         TF_CHECK_OK(
             reader.ReadRecord(&offset,
                               &record));  // The first event is irrelevant
-        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
-        Event e;
-        e.ParseFromString(record);
-        test_fn(e);
+        while (true) {
+          Status s = reader.ReadRecord(&offset, &record);
+          if (errors::IsOutOfRange(s)) {
+            break;
+          }
+          TF_RETURN_IF_ERROR(s);
+          events->emplace_back();
+          events->back().ParseFromString(record);
+        }
       }
     }
     if (!found) {
@@ -87,6 +130,26 @@ class SummaryFileWriterTest : public ::testing::Test {
     return absl::OkStatus();
   }
 
+  // Writes scalar summaries for `num_steps` steps.
+  static Status WriteSteps(SummaryWriterInterface* writer, int num_steps) {
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    for (int step = 0; step < num_steps; ++step) {
+      TF_RETURN_IF_ERROR(writer->WriteScalar(step, one, "name"));
+    }
+    return absl::OkStatus();
+  }
+
+  // Expects that `events` hold the steps `0` to `num_steps - 1` in order.
+  static void ExpectSteps(const std::vector<Event>& events, int num_steps) {
+    ASSERT_EQ(events.size(), static_cast<size_t>(num_steps));
+    for (int step = 0; step < num_steps; ++step) {
+      EXPECT_EQ(events[step].step(), step);
+      ASSERT_EQ(events[step].summary().value_size(), 1);
+      EXPECT_EQ(events[step].summary().value(0).tag(), "name");
+    }
+  }
+
   FakeClockEnv env_;
 };
 
@@ -259,6 +322,90 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, AsyncFlush) {
+  setenv("TF_SUMMARY_WRITER_ASYNC_FLUSH", "true", /*overwrite=*/1);
+  const string test_name = "async_flush_test";
+  TF_CHECK_OK(SummaryTestHelper(
+      test_name,
+      [this](SummaryWriterInterface* writer) {
+        Tensor one(DT_FLOAT, TensorShape({}));
+        one.scalar<float>()() = 1.0;
+        for (int step = 0; step < 100; ++step) {
+          env_.AdvanceByMillis(1);
+          TF_RETURN_IF_ERROR(writer->WriteScalar(step, one, "name"));
+        }
+        return absl::OkStatus();
+      },
+      [](const Event& e) { EXPECT_EQ(e.step(), 0); }));
+  unsetenv("TF_SUMMARY_WRITER_ASYNC_FLUSH");
+
+  std::vector<Event> events;
+  TF_ASSERT_OK(ReadEvents(test_name, &events));
+  ExpectSteps(events, 100);
+}
+
+TEST_F(SummaryFileWriterTest, AsyncFlushDropsEventsWhenFull) {
+  setenv("TF_SUMMARY_WRITER_ASYNC_FLUSH", "true", /*overwrite=*/1);
+  setenv("TF_SUMMARY_WRITER_MAX_PENDING_EVENTS", "5", /*overwrite=*/1);
+  setenv("TF_SUMMARY_WRITER_DROP_WHEN_FULL", "true", /*overwrite=*/1);
+  const string test_name = "drop_when_full_test";
+  {
+    GatedThreadEnv env;
+    SummaryWriterInterface* writer;
+    TF_ASSERT_OK(CreateSummaryFileWriter(1, 1, testing::TmpDir(), test_name,
+                                         &env, &writer));
+    core::ScopedUnref deleter(writer);
+    // Steps 0 and 1 fill the queue and are handed to the background write,
+    // which waits for the gate. Steps 2 to 6 stay queued, and the later ones
+    // are dropped instead of blocking.
+    const Status write_status = WriteSteps(writer, 20);
+    env.OpenGate();
+    TF_ASSERT_OK(write_status);
+    TF_ASSERT_OK(writer->Flush());
+  }
+  unsetenv("TF_SUMMARY_WRITER_ASYNC_FLUSH");
+  unsetenv("TF_SUMMARY_WRITER_MAX_PENDING_EVENTS");
+  unsetenv("TF_SUMMARY_WRITER_DROP_WHEN_FULL");
+
+  std::vector<Event> events;
+  TF_ASSERT_OK(ReadEvents(test_name, &events));
+  ExpectSteps(events, 7);
+}
+
+TEST_F(SummaryFileWriterTest, AsyncFlushBlocksWhenFull) {
+  setenv("TF_SUMMARY_WRITER_ASYNC_FLUSH", "true", /*overwrite=*/1);
+  setenv("TF_SUMMARY_WRITER_MAX_PENDING_EVENTS", "5", /*overwrite=*/1);
+  const string test_name = "block_when_full_test";
+  {
+    GatedThreadEnv env;
+    SummaryWriterInterface* writer;
+    TF_ASSERT_OK(CreateSummaryFileWriter(1, 1, testing::TmpDir(), test_name,
+                                         &env, &writer));
+    core::ScopedUnref deleter(writer);
+    Notification written;
+    Status write_status;
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "write_steps", [&]() {
+          write_status = WriteSteps(writer, 20);
+          written.Notify();
+        }));
+    // Step 7 waits for the background write of steps 0 and 1, which waits
+    // for the gate.
+    EXPECT_FALSE(WaitForNotificationWithTimeout(&written,
+                                                /*timeout_in_us=*/100000));
+    env.OpenGate();
+    written.WaitForNotification();
+    TF_ASSERT_OK(write_status);
+    TF_ASSERT_OK(writer->Flush());
+  }
+  unsetenv("TF_SUMMARY_WRITER_ASYNC_FLUSH");
+  unsetenv("TF_SUMMARY_WRITER_MAX_PENDING_EVENTS");
+
+  std::vector<Event> events;
+  TF_ASSERT_OK(ReadEvents(test_name, &events));
+  ExpectSteps(events, 20);
+}
+
 TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
   // Keep unique with all other test names in this file.
   string test_name = "avoid_filename_collision_test";
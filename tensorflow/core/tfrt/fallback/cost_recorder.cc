@@ -51,6 +51,24 @@ uint64_t CostRecorder::GetCost(int64_t op_key) const {
   return r;
 }
 
+uint64_t CostRecorder::GetTotalCost() const {
+  tf_shared_lock l(op_cost_map_mutex_);
+  uint64_t total_cost = 0;
+  for (const auto& [op_key, op_cost] : op_cost_map_) {
+    total_cost += op_cost.first;
+  }
+  return total_cost;
+}
+
+void CostRecorder::MergeFrom(const CostRecorder& other) {
+  tf_shared_lock other_lock(other.op_cost_map_mutex_);
+  mutex_lock l(op_cost_map_mutex_);
+  for (const auto& [op_key, op_cost] : other.op_cost_map_) {
+    op_cost_map_[op_key].first += op_cost.first;
+    op_cost_map_[op_key].second += op_cost.second;
+  }
+}
+
 Status CostRecorder::WriteToFile() const {
   OpCostMapProto op_cost_map_proto;
   {
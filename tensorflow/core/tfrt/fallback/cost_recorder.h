@@ -42,6 +42,12 @@ class CostRecorder {
   // otherwise adding op costs would cause overflow.
   uint64_t GetCost(int64_t op_key) const;
 
+  // Returns the sum of all recorded execution durations.
+  uint64_t GetTotalCost() const;
+
+  // Adds the execution durations recorded by `other` to this recorder.
+  void MergeFrom(const CostRecorder& other);
+
   // Writes the op cost map (in format of `OpCostMapProto`) to a file specified
   // by the env var name `MesuredCostPathEnvVarName()`.
   // TODO(b/263837451): Fix the op_key unstableness during serialization.
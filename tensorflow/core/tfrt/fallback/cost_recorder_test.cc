@@ -56,6 +56,21 @@ TEST(CostRecorderTest, GetCostDefaultValueTest) {
             std::numeric_limits<uint32_t>::max());
 }
 
+TEST(CostRecorderTest, MergeFromTest) {
+  CostRecorder recorder;
+  recorder.RecordCost(kTestOpKey, kTestCost);
+
+  CostRecorder other;
+  other.RecordCost(kTestOpKey, 2 * kTestCost);
+  other.RecordCost(kTestOpKey + 1, kTestCost);
+  EXPECT_EQ(other.GetTotalCost(), 3 * kTestCost);
+
+  recorder.MergeFrom(other);
+  EXPECT_EQ(recorder.size(), 2);
+  EXPECT_EQ(recorder.GetCost(kTestOpKey), kTestAvgCost);
+  EXPECT_EQ(recorder.GetTotalCost(), 4 * kTestCost);
+}
+
 TEST(CostRecorderTest, WriteToFileTest) {
   CostRecorder recorder;
   ASSERT_EQ(recorder.size(), 0);
@@ -17,10 +17,12 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "absl/time/clock.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_serving_device_selector.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/tfrt/gpu/kernel/gpu_runner.h"
 #include "tensorflow/core/tfrt/runtime/runtime.h"
+#include "tsl/framework/serving_device_selector.h"
 #include "tsl/framework/serving_device_selector_policies.h"
 #include "tfrt/host_context/resource_context.h"  // from @tf_runtime
 
@@ -29,7 +31,18 @@ namespace gpu {
 
 Status InitTfrtGpu(const GpuRunnerOptions& options,
                    tensorflow::tfrt_stub::Runtime& runtime) {
-  auto policy = std::make_unique<tsl::RoundRobinPolicy>();
+  std::unique_ptr<tsl::ServingDeviceSelector::Policy> policy;
+  switch (options.serving_selector_policy) {
+    case tsl::ServingDeviceSelectorPolicy::kRoundRobin:
+      policy = std::make_unique<tsl::RoundRobinPolicy>();
+      break;
+    case tsl::ServingDeviceSelectorPolicy::kLeastLoaded:
+      // The same clock the GPU serving device selector records program start
+      // times with.
+      policy = std::make_unique<tsl::LeastLoadedPolicy>(
+          [] { return absl::GetCurrentTimeNanos(); });
+      break;
+  }
   auto serving_device_selector =
       std::make_unique<tensorflow::gpu::GpuServingDeviceSelector>(
           options.num_gpu_streams, std::move(policy));
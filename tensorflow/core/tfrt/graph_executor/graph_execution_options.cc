@@ -123,7 +123,9 @@ std::ostream& operator<<(std::ostream& os,
             << ", enable_grappler_function_optimizer = "
             << options.enable_grappler_function_optimizer
             << ", enable_tfrt_gpu = " << options.enable_tfrt_gpu
-            << ", use_ifrt = " << options.use_ifrt << ", runtime = "
+            << ", use_ifrt = " << options.use_ifrt
+            << ", enable_mlrt_inline_execution = "
+            << options.enable_mlrt_inline_execution << ", runtime = "
             << options.runtime
             // clang-tidy off
             << ", model_metadata = "
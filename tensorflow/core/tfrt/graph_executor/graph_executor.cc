@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -56,7 +57,11 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/translate/import_model.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
+#include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
+#include "tensorflow/core/common_runtime/request_cost_accessor.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/rendezvous.h"
@@ -65,6 +70,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
@@ -139,6 +145,15 @@ auto* graph_executor_mode = monitoring::Gauge<std::string, 2>::New(
     "executor modes (BEF vs MLRT interpreter)",
     "model_name", "model_version");
 
+// Returns the cost of the request served by the current thread, or nullptr if
+// the serving layer does not track request costs.
+RequestCost* GetCurrentRequestCost() {
+  static RequestCostAccessor* const request_cost_accessor =
+      CreateRequestCostAccessor().release();
+  if (request_cost_accessor == nullptr) return nullptr;
+  return request_cost_accessor->GetRequestCost();
+}
+
 }  // namespace
 
 tensorflow::Status RunMlrtFunction(
@@ -148,7 +163,7 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state) {
+    SyncResourceState* sync_resource_state, bool run_inline) {
   DCHECK(function);
   const auto* fallback_request_state =
       request_context->GetDataIfExists<tfd::KernelFallbackCompatRequestState>();
@@ -203,8 +218,15 @@ tensorflow::Status RunMlrtFunction(
 
   // TODO(chky): Set up cancellation.
 
-  work_queue.AddTask(
-      [&execution_context]() { mlrt::Execute(execution_context); });
+  if (run_inline) {
+    // For tiny graphs the hand-off to the work queue dominates the latency.
+    // Graphs without async ops complete here and `Await()` returns
+    // immediately.
+    mlrt::Execute(execution_context);
+  } else {
+    work_queue.AddTask(
+        [&execution_context]() { mlrt::Execute(execution_context); });
+  }
 
   work_queue.Await(chain);
 
@@ -318,6 +340,17 @@ tensorflow::Status GraphExecutionRunOnFunction(
     tfrt::RequestDeadlineTracker* req_deadline_tracker,
     std::optional<StreamCallbackId> stream_callback_id,
     CostRecorder* cost_recorder) {
+  // If the serving layer tracks the cost of the current request, the op costs
+  // of this run are measured separately so that they can be attributed to it.
+  // The recorder must outlive `request_info`, which is referenced by the ops.
+  RequestCost* request_cost = GetCurrentRequestCost();
+  std::optional<CostRecorder> request_cost_recorder;
+  CostRecorder* model_cost_recorder = cost_recorder;
+  if (request_cost != nullptr) {
+    request_cost_recorder.emplace();
+    cost_recorder = &*request_cost_recorder;
+  }
+
   TF_ASSIGN_OR_RETURN(
       auto request_info,
       CreateRequestInfo(options, run_options, run_options.work_queue,
@@ -325,6 +358,19 @@ tensorflow::Status GraphExecutionRunOnFunction(
                         runner_table, resource_array, fallback_state,
                         process_function_library_runtime, cost_recorder));
 
+  absl::Cleanup record_request_cost = [&, start_time = absl::Now()]() {
+    if (request_cost == nullptr) return;
+    if (model_cost_recorder != nullptr) {
+      model_cost_recorder->MergeFrom(*request_cost_recorder);
+    }
+    const absl::Duration op_cost =
+        absl::FromChrono(profile_utils::CpuUtils::ConvertClockCycleToTime(
+            request_cost_recorder->GetTotalCost()));
+    request_cost->RecordCost({{kTfrtOpCostName, op_cost},
+                              {kTfrtGraphExecutionCostName,
+                               absl::Now() - start_time}});
+  };
+
   int64_t request_id = request_info->tfrt_request_context->id();
   // The top level traceme root for this request. The thread pool used later
   // will add TraceMeProducer and TraceMeConsumer to connect async tasks.
@@ -396,7 +442,8 @@ tensorflow::Status GraphExecutionRunOnFunction(
     return RunMlrtFunction(function, *loaded_executable,
                            request_info->tfrt_request_context,
                            *request_info->request_queue, inputs, outputs,
-                           /*sync_resource_state=*/nullptr);
+                           /*sync_resource_state=*/nullptr,
+                           options.enable_mlrt_inline_execution);
   }
 
   DCHECK(func);
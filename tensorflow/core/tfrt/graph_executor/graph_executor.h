@@ -132,7 +132,9 @@ tensorflow::Status GraphExecutionRunOnFunction(
     std::optional<StreamCallbackId> stream_callback_id,
     CostRecorder* cost_recorder = nullptr);
 
-// Runs a MLRT function for executing tensorflow graphs.
+// Runs a MLRT function for executing tensorflow graphs. If `run_inline` is
+// true, the function starts on the caller thread instead of being handed over
+// to `work_queue`; only the parts resumed by async ops run on `work_queue`.
 tensorflow::Status RunMlrtFunction(
     mlrt::bc::Function function,
     const mlrt::LoadedExecutable& loaded_executable,
@@ -140,7 +142,7 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state);
+    SyncResourceState* sync_resource_state, bool run_inline = false);
 
 // Loads (if not yet) and runs a subgraph in a graph as per each request.
 class GraphExecutor {
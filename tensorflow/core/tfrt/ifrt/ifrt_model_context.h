@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_executable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
 #include "tsl/platform/threadpool.h"
@@ -107,6 +108,16 @@ class IfrtModelContext {
     checkpoint_loader_queue_ = work_queue;
   }
 
+  // Returns the on-disk cache of the compiled programs, or nullptr if programs
+  // are only cached in memory.
+  const IfrtPersistentCompilationCache* GetPersistentCompilationCache() const {
+    return persistent_compilation_cache_.get();
+  }
+  void set_persistent_compilation_cache(
+      std::unique_ptr<IfrtPersistentCompilationCache> cache) {
+    persistent_compilation_cache_ = std::move(cache);
+  }
+
   // Freeze the model: release the resources such as host tensors that are used
   // by the device only. The caller guarantees all resources released in this
   // function is no longer in use in regular execution path.
@@ -127,6 +138,10 @@ class IfrtModelContext {
   // Dedicated work queue for heavy task such as variable tensor restoration.
   tfrt::ConcurrentWorkQueue* checkpoint_loader_queue_ = nullptr;
 
+  // Persists the compiled programs across restarts. May be nullptr.
+  std::unique_ptr<const IfrtPersistentCompilationCache>
+      persistent_compilation_cache_;
+
   std::vector<ServingExecutableRegistry::Handle> handles_;
 
   IfrtLoadedVariableRegistry loaded_variable_registry_;
@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Support/raw_ostream.h"  // from @llvm-project
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/OperationSupport.h"  // from @llvm-project
+#include "xla/pjrt/compile_options.pb.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/python/ifrt/client.h"
+#include "xla/python/ifrt/device.h"
+#include "xla/python/ifrt/executable.h"
+#include "xla/python/ifrt/hlo/hlo_program.h"
+#include "xla/python/ifrt/host_callback.h"
+#include "xla/python/pjrt_ifrt/xla_compiler.h"
+#include "xla/tsl/concurrency/ref_count.h"
+#include "tsl/lib/strings/proto_serialization.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+namespace {
+
+// Returns the string the cache entry of `hlo_module` compiled by `client` with
+// `compile_options` is keyed by.
+absl::StatusOr<std::string> GetCacheKey(
+    const xla::ifrt::Client& client, mlir::ModuleOp hlo_module,
+    const xla::CompileOptions& compile_options) {
+  std::string key = absl::StrCat(
+      "version:", IfrtPersistentCompilationCache::kVersion,
+      "\nplatform:", client.platform_name(), " ", client.platform_version(),
+      "\ndevices:", client.device_count(), " ");
+  for (const xla::ifrt::Device* device : client.devices()) {
+    absl::StrAppend(&key, device->Kind(), ",");
+  }
+
+  TF_ASSIGN_OR_RETURN(xla::CompileOptionsProto compile_options_proto,
+                      compile_options.ToProto());
+  std::string serialized_compile_options;
+  if (!tsl::SerializeToStringDeterministic(compile_options_proto,
+                                           &serialized_compile_options)) {
+    return absl::InternalError("Failed to serialize the compile options.");
+  }
+  absl::StrAppend(&key, "\ncompile_options:", serialized_compile_options);
+
+  // Debug info is left out, so that the key doesn't depend on source locations.
+  absl::StrAppend(&key, "\nprogram:");
+  llvm::raw_string_ostream os(key);
+  hlo_module.print(os, mlir::OpPrintingFlags());
+  os.flush();
+  return key;
+}
+
+}  // namespace
+
+IfrtPersistentCompilationCache::IfrtPersistentCompilationCache(
+    std::string directory, bool read_only)
+    : directory_(std::move(directory)), read_only_(read_only) {}
+
+absl::StatusOr<std::string> IfrtPersistentCompilationCache::GetFilePath(
+    const xla::ifrt::Client& client, mlir::ModuleOp hlo_module,
+    const xla::CompileOptions& compile_options) const {
+  TF_ASSIGN_OR_RETURN(std::string key,
+                      GetCacheKey(client, hlo_module, compile_options));
+  const tsl::Fprint128 fingerprint = tsl::Fingerprint128(key);
+  return tsl::io::JoinPath(
+      directory_,
+      absl::StrCat("ifrt_v", kVersion, "_",
+                   absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                   absl::Hex(fingerprint.low64, absl::kZeroPad16), ".bin"));
+}
+
+absl::StatusOr<std::unique_ptr<xla::ifrt::LoadedExecutable>>
+IfrtPersistentCompilationCache::LookupOrCompile(
+    xla::ifrt::Client& client, mlir::ModuleOp hlo_module,
+    const xla::CompileOptions& compile_options,
+    const std::vector<tsl::RCReference<xla::ifrt::LoadedHostCallback>>&
+        loaded_host_callbacks) const {
+  tsl::Env* env = tsl::Env::Default();
+  absl::StatusOr<std::string> file_path =
+      GetFilePath(client, hlo_module, compile_options);
+  if (!file_path.ok()) {
+    LOG(WARNING) << "Not using the IFRT compilation cache: "
+                 << file_path.status();
+  } else if (env->FileExists(*file_path).ok()) {
+    std::string serialized;
+    absl::Status status = tsl::ReadFileToString(env, *file_path, &serialized);
+    if (status.ok()) {
+      absl::StatusOr<std::unique_ptr<xla::ifrt::LoadedExecutable>> executable =
+          client.GetDefaultCompiler()->DeserializeLoadedExecutable(
+              serialized,
+              std::make_unique<xla::ifrt::XlaDeserializeExecutableOptions>(
+                  compile_options, loaded_host_callbacks));
+      if (executable.ok()) {
+        VLOG(1) << "Loaded IFRT executable from " << *file_path;
+        return executable;
+      }
+      status = executable.status();
+    }
+    LOG(WARNING) << "Failed to load IFRT executable from " << *file_path
+                 << ", compiling it instead: " << status;
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<xla::ifrt::LoadedExecutable> executable,
+      client.GetDefaultCompiler()->Compile(
+          std::make_unique<xla::ifrt::HloProgram>(hlo_module),
+          std::make_unique<xla::ifrt::XlaCompileOptions>(
+              compile_options, loaded_host_callbacks)));
+  if (!file_path.ok() || read_only_) {
+    return executable;
+  }
+
+  // Write to a temporary file first and then move it into place, so that
+  // concurrent readers never see a partially written entry.
+  absl::Status status = [&]() -> absl::Status {
+    TF_ASSIGN_OR_RETURN(std::string serialized, executable->Serialize());
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory_));
+    std::string temp_path = *file_path;
+    if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+      return absl::UnavailableError(
+          absl::StrCat("Could not create a unique file inside ", directory_));
+    }
+    TF_RETURN_IF_ERROR(tsl::WriteStringToFile(env, temp_path, serialized));
+    return env->RenameFile(temp_path, *file_path);
+  }();
+  if (status.ok()) {
+    VLOG(1) << "Saved IFRT executable to " << *file_path;
+  } else if (absl::IsUnimplemented(status)) {
+    VLOG(1) << "IFRT executable serialization is not implemented: " << status;
+  } else {
+    LOG(WARNING) << "Failed to save IFRT executable to " << *file_path << ": "
+                 << status;
+  }
+  return executable;
+}
+
+}  // namespace ifrt_serving
+}  // namespace tensorflow
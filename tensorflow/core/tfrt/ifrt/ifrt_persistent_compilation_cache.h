@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_PERSISTENT_COMPILATION_CACHE_H_
+#define TENSORFLOW_CORE_TFRT_IFRT_IFRT_PERSISTENT_COMPILATION_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/python/ifrt/client.h"
+#include "xla/python/ifrt/executable.h"
+#include "xla/python/ifrt/host_callback.h"
+#include "xla/tsl/concurrency/ref_count.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+
+// Persists the IFRT executables compiled by `IfrtServingExecutable` in a
+// directory, so that they are loaded instead of recompiled after a restart or
+// on a new replica, similar to `DeviceExecutablePersistor` for XLA JIT.
+//
+// An entry is keyed by a fingerprint of `kVersion`, the HLO program (which
+// includes the input shapes), the XLA compile options and the device topology
+// of the client. Failures to read or write an entry are logged and fall back to
+// compiling, so a stale or corrupted cache never fails a compilation.
+//
+// This class is thread safe.
+class IfrtPersistentCompilationCache {
+ public:
+  // Version of the entries. Entries of other versions are never loaded. Bump
+  // whenever the key or the format of the entries changes.
+  static constexpr int kVersion = 1;
+
+  // If `read_only`, entries are loaded from `directory` but new ones are not
+  // written to it.
+  explicit IfrtPersistentCompilationCache(std::string directory,
+                                          bool read_only = false);
+
+  // Returns the executable of `hlo_module` compiled by `client` with
+  // `compile_options`. Loads it from the cache if it has an entry for them, and
+  // otherwise compiles it and writes it to the cache.
+  absl::StatusOr<std::unique_ptr<xla::ifrt::LoadedExecutable>> LookupOrCompile(
+      xla::ifrt::Client& client, mlir::ModuleOp hlo_module,
+      const xla::CompileOptions& compile_options,
+      const std::vector<tsl::RCReference<xla::ifrt::LoadedHostCallback>>&
+          loaded_host_callbacks) const;
+
+  // Returns the path of the cache entry of `hlo_module` compiled by `client`
+  // with `compile_options`.
+  absl::StatusOr<std::string> GetFilePath(
+      const xla::ifrt::Client& client, mlir::ModuleOp hlo_module,
+      const xla::CompileOptions& compile_options) const;
+
+  const std::string& directory() const { return directory_; }
+
+ private:
+  const std::string directory_;
+  const bool read_only_;
+};
+
+}  // namespace ifrt_serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_IFRT_IFRT_PERSISTENT_COMPILATION_CACHE_H_
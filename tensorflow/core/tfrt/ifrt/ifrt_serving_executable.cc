@@ -71,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_utils.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_tensor_utils.h"
@@ -167,7 +168,8 @@ IfrtServingExecutable::Create(
     tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
     tensorflow::DeviceMgr* device_mgr,
     tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
-    IfrtServingCoreSelector* ifrt_serving_core_selector) {
+    IfrtServingCoreSelector* ifrt_serving_core_selector,
+    const IfrtPersistentCompilationCache* persistent_compilation_cache) {
   TF_ASSIGN_OR_RETURN(
       tensorflow::tpu::TPUCompileMetadataProto original_compile_metadata,
       GetCompileMetadata(*module, *client));
@@ -177,7 +179,7 @@ IfrtServingExecutable::Create(
       std::move(client), thread_pool, ifrt_loaded_variable_registry,
       ifrt_restore, checkpoint_loader_queue, device_mgr,
       std::move(shape_representation_fn), ifrt_serving_core_selector,
-      std::move(original_compile_metadata)));
+      persistent_compilation_cache, std::move(original_compile_metadata)));
 }
 
 absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
@@ -384,13 +386,21 @@ IfrtServingExecutable::CreateExecutableSynchronously(
             std::make_unique<xla::HostCallback>(host_callback)));
   }
 
-  TF_ASSIGN_OR_RETURN(
-      std::unique_ptr<xla::ifrt::LoadedExecutable> ifrt_executable,
-      ifrt_client_->GetDefaultCompiler()->Compile(
-          std::make_unique<xla::ifrt::HloProgram>(
-              tf2hlo_result.mlir_hlo_module.get()),
-          std::make_unique<xla::ifrt::XlaCompileOptions>(
-              xla_compile_options, loaded_host_callbacks)));
+  std::unique_ptr<xla::ifrt::LoadedExecutable> ifrt_executable;
+  if (persistent_compilation_cache_ != nullptr) {
+    TF_ASSIGN_OR_RETURN(ifrt_executable,
+                        persistent_compilation_cache_->LookupOrCompile(
+                            *ifrt_client_, tf2hlo_result.mlir_hlo_module.get(),
+                            xla_compile_options, loaded_host_callbacks));
+  } else {
+    TF_ASSIGN_OR_RETURN(
+        ifrt_executable,
+        ifrt_client_->GetDefaultCompiler()->Compile(
+            std::make_unique<xla::ifrt::HloProgram>(
+                tf2hlo_result.mlir_hlo_module.get()),
+            std::make_unique<xla::ifrt::XlaCompileOptions>(
+                xla_compile_options, loaded_host_callbacks)));
+  }
 
   SharedCachedExecutableBundle executable_bundle =
       std::make_shared<CachedExecutableBundle>();
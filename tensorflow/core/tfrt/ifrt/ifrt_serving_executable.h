@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
 #include "tensorflow/core/tfrt/ifrt/tf_host_callback.h"
@@ -70,7 +71,8 @@ class IfrtServingExecutable {
       tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
       tensorflow::DeviceMgr* device_mgr,
       tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
-      IfrtServingCoreSelector* ifrt_serving_core_selector);
+      IfrtServingCoreSelector* ifrt_serving_core_selector,
+      const IfrtPersistentCompilationCache* persistent_compilation_cache);
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -141,6 +143,7 @@ class IfrtServingExecutable {
       tensorflow::DeviceMgr* device_mgr,
       tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
       IfrtServingCoreSelector* ifrt_serving_core_selector,
+      const IfrtPersistentCompilationCache* persistent_compilation_cache,
       tensorflow::tpu::TPUCompileMetadataProto original_compile_metadata)
       : program_id_(program_id),
         model_name_(std::string(model_name)),
@@ -154,7 +157,8 @@ class IfrtServingExecutable {
         checkpoint_loader_queue_(checkpoint_loader_queue),
         device_mgr_(device_mgr),
         shape_representation_fn_(std::move(shape_representation_fn)),
-        ifrt_serving_core_selector_(std::move(ifrt_serving_core_selector)) {}
+        ifrt_serving_core_selector_(std::move(ifrt_serving_core_selector)),
+        persistent_compilation_cache_(persistent_compilation_cache) {}
 
   int64_t program_id_;
   using SharedCachedExecutableBundle = std::shared_ptr<CachedExecutableBundle>;
@@ -177,6 +181,8 @@ class IfrtServingExecutable {
   tensorflow::DeviceMgr* device_mgr_;  // Not owned. For host callback.
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_;
   IfrtServingCoreSelector* ifrt_serving_core_selector_;
+  // Not owned. May be nullptr.
+  const IfrtPersistentCompilationCache* persistent_compilation_cache_;
 
   mutable absl::Mutex mutex_;
   absl::flat_hash_map<Key, xla::ifrt::Future<SharedCachedExecutableBundle>>
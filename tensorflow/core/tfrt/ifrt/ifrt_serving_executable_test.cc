@@ -39,12 +39,14 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable_test_util.h"
 #include "tsl/framework/serving_device_selector.h"
 #include "tsl/framework/test_util/mock_serving_device_selector.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
 #include "tsl/platform/tstring.h"
@@ -112,6 +114,43 @@ TEST_F(IfrtServingExecutableTest, Basic) {
   EXPECT_THAT(result, ElementsAre(TensorEq(expected_out)));
 }
 
+TEST_F(IfrtServingExecutableTest, PersistentCompilationCache) {
+  const std::string cache_dir =
+      tsl::io::JoinPath(::testing::TempDir(), "ifrt_compilation_cache");
+  TF_ASSERT_OK(tsl::Env::Default()->RecursivelyCreateDir(cache_dir));
+  IfrtPersistentCompilationCache cache(cache_dir);
+
+  int64_t program_id = 123456;
+  EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id)))
+      .Times(2)
+      .WillRepeatedly(
+          [](::testing::Unused) { return tsl::DeviceReservation(0, nullptr); });
+
+  auto x = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
+  auto y = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
+  std::vector<tensorflow::Tensor> inputs{x, y};
+  const auto expected_out =
+      AsTensor<int32_t>({14}, tensorflow::TensorShape({1, 1}));
+
+  // The second executable simulates a restart: it shares nothing with the
+  // first one but the cache directory.
+  for (int i = 0; i < 2; ++i) {
+    test_utils::IfrtServingExecutableTestHelper helper(&selector_);
+    helper.set_persistent_compilation_cache(&cache);
+    auto executable =
+        helper.MakeExecutable(program_id, GetMlirModulePath("executable.mlir"));
+
+    TF_ASSERT_OK_AND_ASSIGN(auto result,
+                            executable->Execute(absl::MakeSpan(inputs), {}));
+    EXPECT_THAT(result, ElementsAre(TensorEq(expected_out)));
+  }
+
+  // Backends which cannot serialize executables leave the directory empty.
+  std::vector<std::string> children;
+  TF_ASSERT_OK(tsl::Env::Default()->GetChildren(cache_dir, &children));
+  EXPECT_LE(children.size(), 1);
+}
+
 TEST_F(IfrtServingExecutableTest, MultipleShapes) {
   test_utils::IfrtServingExecutableTestHelper helper(&selector_);
   int64_t program_id = 123456;
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
@@ -56,6 +57,12 @@ class IfrtServingExecutableTestHelper {
     return &ifrt_restore_tensor_registry_;
   }
 
+  // Sets the persistent compilation cache of the executables made afterwards.
+  void set_persistent_compilation_cache(
+      const IfrtPersistentCompilationCache* persistent_compilation_cache) {
+    persistent_compilation_cache_ = persistent_compilation_cache;
+  }
+
  private:
   static constexpr int kThreadPoolNumThreads = 16;
 
@@ -67,6 +74,8 @@ class IfrtServingExecutableTestHelper {
   IfrtRestoreTensorRegistry ifrt_restore_tensor_registry_;
   std::unique_ptr<tfrt::ConcurrentWorkQueue> work_queue_;
   std::unique_ptr<tensorflow::StaticDeviceMgr> device_mgr_;
+  // Not owned.
+  const IfrtPersistentCompilationCache* persistent_compilation_cache_ = nullptr;
 
   mlir::DialectRegistry registry_;
   std::unique_ptr<mlir::MLIRContext> context_;
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/protobuf.h"  // IWYU pragma: keep
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
@@ -98,7 +100,17 @@ struct MlrtIfrtRestoreVariableKernel : mlrt::KernelFrame {
   void Invoke();
 
  private:
+  // Restored bytes up to which variables are restored together.
+  static constexpr int64_t kRestoreChunkBytes = int64_t{64} << 20;
+
   absl::Status InvokeHelper();
+
+  // Restores the variables at `indices` on `checkpoint_loader_queue`, and sets
+  // the corresponding `results` with the restored tensors.
+  absl::Status RestoreInBackground(
+      absl::Span<const int> indices,
+      tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
+      std::vector<xla::ifrt::Promise<tensorflow::Tensor>>& results);
 };
 
 void MlrtIfrtRestoreVariableKernel::Invoke() {
@@ -119,40 +131,117 @@ absl::Status MlrtIfrtRestoreVariableKernel::InvokeHelper() {
   }
   const int num_outputs = var_handles().size();
   DCHECK_EQ(num_outputs, tensor_names().tensor().NumElements());
-  auto& fallback_request_state = context().fallback_request_state();
+
+  std::vector<xla::ifrt::Promise<tensorflow::Tensor>> results;
+  results.reserve(num_outputs);
+  std::vector<int64_t> restored_bytes;
+  restored_bytes.reserve(num_outputs);
+  ifrt_serving::IfrtRestoreTensorRegistry& ifrt_restore_tensor_registry =
+      (*ifrt_model_context)->GetRestoreTensorRegistry();
+  for (int i = 0; i < num_outputs; ++i) {
+    auto promise = xla::ifrt::Future<tensorflow::Tensor>::CreatePromise();
+    auto future = xla::ifrt::Future<tensorflow::Tensor>(promise);
+    const ResourceHandle& var_handle =
+        var_handles()[i].tensor().scalar<ResourceHandle>()();
+
+    TF_ASSIGN_OR_RETURN(ifrt_serving::DtypeAndShape dtype_and_shape,
+                        ifrt_serving::GetDtypeAndShape(var_handle));
+    restored_bytes.push_back(dtype_and_shape.shape.num_elements() *
+                             DataTypeSize(dtype_and_shape.dtype));
+
+    std::string runtime_name =
+        ifrt_serving::GetRuntimeNameFromVarHandle(var_handle);
+    ifrt_serving::IfrtRestoreTensorRegistry::RestoredTensorInfo
+        restored_tensor_info = {false, std::move(dtype_and_shape),
+                                std::move(future)};
+    if (auto status = ifrt_restore_tensor_registry.TryRegister(
+            runtime_name, restored_tensor_info);
+        !status.ok()) {
+      // Propagate errors so that if already-registered futures are being waited
+      // on, they can be unblocked.
+      for (auto& result : results) {
+        std::move(result).Set(status);
+      };
+      return status;
+    }
+    results.push_back(std::move(promise));
+  }
+
+  // Restore the variables in chunks of about `kRestoreChunkBytes`, each by its
+  // own `tf.RestoreV2` on the dedicated work queue. A variable thus becomes
+  // available, and its transfer to the devices starts, as soon as its chunk is
+  // restored rather than once all the variables are, and the number of
+  // threads of the queue bounds the host memory being restored at a time.
+  DCHECK((*ifrt_model_context)->checkpoint_loader_queue() != nullptr);
+  std::vector<int> chunk;
+  int64_t chunk_bytes = 0;
+  for (int i = 0; i < num_outputs; ++i) {
+    chunk.push_back(i);
+    chunk_bytes += restored_bytes[i];
+    if (chunk_bytes < kRestoreChunkBytes && i < num_outputs - 1) {
+      continue;
+    }
+    if (auto status = RestoreInBackground(
+            chunk, (*ifrt_model_context)->checkpoint_loader_queue(), results);
+        !status.ok()) {
+      // Unblock the waiters of this and the remaining chunks.
+      for (int j = chunk.front(); j < num_outputs; ++j) {
+        std::move(results[j]).Set(status);
+      }
+      return status;
+    }
+    chunk.clear();
+    chunk_bytes = 0;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MlrtIfrtRestoreVariableKernel::RestoreInBackground(
+    absl::Span<const int> indices,
+    tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
+    std::vector<xla::ifrt::Promise<tensorflow::Tensor>>& results) {
+  const int num_outputs = indices.size();
   tensorflow::AttrValue dtypes_attr_value;
-  for (const auto& dtype : restored_dtypes()) {
-    dtypes_attr_value.mutable_list()->mutable_type()->Add(dtype);
+  tensorflow::Tensor prefix_tensor = prefix().tensor();
+  tensorflow::Tensor tensor_names_tensor(DT_STRING, {num_outputs});
+  tensorflow::Tensor shape_and_slices_tensor(DT_STRING, {num_outputs});
+  for (int i = 0; i < num_outputs; ++i) {
+    dtypes_attr_value.mutable_list()->mutable_type()->Add(
+        restored_dtypes()[indices[i]]);
+    tensor_names_tensor.vec<tsl::tstring>()(i) =
+        tensor_names().tensor().vec<tsl::tstring>()(indices[i]);
+    shape_and_slices_tensor.vec<tsl::tstring>()(i) =
+        shape_and_slices().tensor().vec<tsl::tstring>()(indices[i]);
   }
+
+  auto& fallback_request_state = context().fallback_request_state();
   // Use `tf.RestoreV2` to restore tensor. This will also populate
   // tensorflow::ResourceManager.
   // TODO(b/319045348): avoid populating tensorflow::ResourceManager if the
   // variable is only used by device/IFRT.
   // TODO(b/319045348): consider directly calling restore function such as that
   // in /tensorflow/core/kernels/save_restore_v2_ops.cc
-  auto runner = tfrt_stub::OpKernelRunner::Create(
-                    /*op_name=*/
-                    "RestoreV2", /*node_name=*/"RestoreV2",
-                    context().params().device->name(),
-                    /*num_args=*/3,
-                    [&](tensorflow::AttrValueMap* attr_value_map) {
-                      attr_value_map->insert({"dtypes", dtypes_attr_value});
-                      return absl::OkStatus();
-                    },
-                    fallback_request_state.device_manager(),
-                    fallback_request_state.process_function_library_runtime())
-                    .value();
+  TF_ASSIGN_OR_RETURN(
+      auto runner,
+      tfrt_stub::OpKernelRunner::Create(
+          /*op_name=*/
+          "RestoreV2", /*node_name=*/"RestoreV2",
+          context().params().device->name(),
+          /*num_args=*/3,
+          [&](tensorflow::AttrValueMap* attr_value_map) {
+            attr_value_map->insert({"dtypes", dtypes_attr_value});
+            return absl::OkStatus();
+          },
+          fallback_request_state.device_manager(),
+          fallback_request_state.process_function_library_runtime()));
 
   // Prepare the input tensors.
-  std::vector<tensorflow::TensorValue> input_tf_tensor_values;
-  input_tf_tensor_values.resize(arguments().size());
-  for (int i = 0; i < arguments().size(); ++i) {
-    auto& fallback_tensor =
-        arguments()[i].Get<tensorflow::tfrt_stub::FallbackTensor>();
-    input_tf_tensor_values[i].tensor = &fallback_tensor.tensor();
-  }
+  std::vector<tensorflow::TensorValue> input_tf_tensor_values = {
+      tensorflow::TensorValue(&prefix_tensor),
+      tensorflow::TensorValue(&tensor_names_tensor),
+      tensorflow::TensorValue(&shape_and_slices_tensor)};
 
-  auto& params = context().params();
+  OpKernelContext::Params params = context().params();
   SetUpParams(runner, input_tf_tensor_values, params);
   // Use persistent device instead of the per request device.
   params.device = context().fallback_request_state().device_manager().HostCPU();
@@ -170,60 +259,29 @@ absl::Status MlrtIfrtRestoreVariableKernel::InvokeHelper() {
   };
   auto async_state =
       std::make_unique<AsyncState>(input_tf_tensor_values, params, num_outputs);
-
   async_state->results.reserve(num_outputs);
-
-  ifrt_serving::IfrtRestoreTensorRegistry& ifrt_restore_tensor_registry =
-      (*ifrt_model_context)->GetRestoreTensorRegistry();
-  for (int i = 0; i < num_outputs; ++i) {
-    auto promise = xla::ifrt::Future<tensorflow::Tensor>::CreatePromise();
-    auto future = xla::ifrt::Future<tensorflow::Tensor>(promise);
-    const ResourceHandle& var_handle =
-        var_handles()[i].tensor().scalar<ResourceHandle>()();
-
-    TF_ASSIGN_OR_RETURN(ifrt_serving::DtypeAndShape dtype_and_shape,
-                        ifrt_serving::GetDtypeAndShape(var_handle));
-
-    std::string runtime_name =
-        ifrt_serving::GetRuntimeNameFromVarHandle(var_handle);
-    ifrt_serving::IfrtRestoreTensorRegistry::RestoredTensorInfo
-        restored_tensor_info = {false, std::move(dtype_and_shape),
-                                std::move(future)};
-    if (auto status = ifrt_restore_tensor_registry.TryRegister(
-            runtime_name, restored_tensor_info);
-        !status.ok()) {
-      // Propagate errors so that if already-registered futures are being waited
-      // on, they can be unblocked.
-      for (auto& result : async_state->results) {
-        std::move(result).Set(status);
-      };
-      return status;
-    }
-    async_state->results.push_back(std::move(promise));
+  for (int index : indices) {
+    async_state->results.push_back(std::move(results[index]));
   }
 
-  // Use dedicated work queue for restore operation.
-  DCHECK((*ifrt_model_context)->checkpoint_loader_queue() != nullptr);
-  (*ifrt_model_context)
-      ->checkpoint_loader_queue()
-      ->AddTask(
-          [runner = std::move(runner), async_state = std::move(async_state)]() {
-            auto* op_kernel_context_ptr = &async_state->context;
-            runner.Run(op_kernel_context_ptr);
-
-            auto& op_kernel_context = async_state->context;
-            if (!op_kernel_context.status().ok()) {
-              for (auto& result : async_state->results) {
-                std::move(result).Set(op_kernel_context.status());
-              }
-              return;
-            }
-            for (int i = 0; i < op_kernel_context.num_outputs(); ++i) {
-              DCHECK(op_kernel_context.mutable_output(i));
-              std::move(async_state->results[i])
-                  .Set(std::move(*op_kernel_context.mutable_output(i)));
-            }
-          });
+  checkpoint_loader_queue->AddTask(
+      [runner = std::move(runner), async_state = std::move(async_state)]() {
+        auto* op_kernel_context_ptr = &async_state->context;
+        runner.Run(op_kernel_context_ptr);
+
+        auto& op_kernel_context = async_state->context;
+        if (!op_kernel_context.status().ok()) {
+          for (auto& result : async_state->results) {
+            std::move(result).Set(op_kernel_context.status());
+          }
+          return;
+        }
+        for (int i = 0; i < op_kernel_context.num_outputs(); ++i) {
+          DCHECK(op_kernel_context.mutable_output(i));
+          std::move(async_state->results[i])
+              .Set(std::move(*op_kernel_context.mutable_output(i)));
+        }
+      });
   return absl::OkStatus();
 }
 
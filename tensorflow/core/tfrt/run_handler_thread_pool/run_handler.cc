@@ -186,54 +186,58 @@ Task ThreadWorkSource::EnqueueTask(Task t, bool is_blocking,
   IncrementPendingTaskCount();
 
   if (enable_wake_up) {
-    // Try to wake up waiting thread if there is any for the given sub thread
-    // pool. We could potentially wake up threads in other sub thread pool if we
-    // cannot find any waiting threads in the given sub thread pool.
-    // The wake up logic is best effort as the thread may be right before being
-    // added to the waiting queue or start waiting on the condition variable.
-    // However a thread will wake in short period of time in case a notification
-    // is missed.
-    Waiter* w = nullptr;
-
-    Waiter* waiter_queue;
-    tensorflow::mutex* waiter_queue_mu;
-    {
-      // When we use multiple sub thread pools, free threads wait on sub
-      // thread pool waiting queues. Wake up threads from sub thread waiting
-      // queues.
-      // The waiting queues are defined at RunHandlerPool.
-      // Get the waiter_queue and corresponding mutex. Note, the thread work
-      // source may change afterwards if a new request comes or an old request
-      // finishes.
-      tensorflow::tf_shared_lock lock(run_handler_waiter_mu_);
-      waiter_queue = sub_thread_pool_waiter_;
-      waiter_queue_mu = sub_thread_pool_waiter_mu_;
-    }
-    {
-      tensorflow::mutex_lock l(*waiter_queue_mu);
-      if (waiter_queue->next != waiter_queue) {
-        // Remove waiter from the LIFO queue
-        w = waiter_queue->next;
+    WakeUpWaiter();
+  }
+  VLOG(3) << "Added " << (is_blocking ? "inter" : "intra") << " work from "
+          << traceme_id_.load(std::memory_order_relaxed);
+  return t;
+}
 
-        CHECK(w->prev != w);  // Crash OK.
-        CHECK(w->next != w);  // Crash OK.
+void ThreadWorkSource::WakeUpWaiter() {
+  // Try to wake up waiting thread if there is any for the given sub thread
+  // pool. We could potentially wake up threads in other sub thread pool if we
+  // cannot find any waiting threads in the given sub thread pool.
+  // The wake up logic is best effort as the thread may be right before being
+  // added to the waiting queue or start waiting on the condition variable.
+  // However a thread will wake in short period of time in case a notification
+  // is missed.
+  Waiter* w = nullptr;
+
+  Waiter* waiter_queue;
+  tensorflow::mutex* waiter_queue_mu;
+  {
+    // When we use multiple sub thread pools, free threads wait on sub
+    // thread pool waiting queues. Wake up threads from sub thread waiting
+    // queues.
+    // The waiting queues are defined at RunHandlerPool.
+    // Get the waiter_queue and corresponding mutex. Note, the thread work
+    // source may change afterwards if a new request comes or an old request
+    // finishes.
+    tensorflow::tf_shared_lock lock(run_handler_waiter_mu_);
+    waiter_queue = sub_thread_pool_waiter_;
+    waiter_queue_mu = sub_thread_pool_waiter_mu_;
+  }
+  {
+    tensorflow::mutex_lock l(*waiter_queue_mu);
+    if (waiter_queue->next != waiter_queue) {
+      // Remove waiter from the LIFO queue
+      w = waiter_queue->next;
 
-        w->next->prev = w->prev;
-        w->prev->next = w->next;
+      CHECK(w->prev != w);  // Crash OK.
+      CHECK(w->next != w);  // Crash OK.
 
-        // Use `w->next == &w` to indicate that the waiter has been removed
-        // from the queue.
-        w->next = w;
-        w->prev = w;
-      }
-    }
-    if (w != nullptr) {
-      w->cv.notify_one();
+      w->next->prev = w->prev;
+      w->prev->next = w->next;
+
+      // Use `w->next == &w` to indicate that the waiter has been removed
+      // from the queue.
+      w->next = w;
+      w->prev = w;
     }
   }
-  VLOG(3) << "Added " << (is_blocking ? "inter" : "intra") << " work from "
-          << traceme_id_.load(std::memory_order_relaxed);
-  return t;
+  if (w != nullptr) {
+    w->cv.notify_one();
+  }
 }
 
 Task ThreadWorkSource::PopBlockingTask() {
@@ -356,7 +360,10 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      use_work_stealing_(ParamFromEnvBoolWithDefault(
+          "TF_RUN_HANDLER_USE_WORK_STEALING", false)),
       thread_data_(num_threads_),
+      local_queues_(use_work_stealing_ ? num_blocking_threads_ : 0),
       env_(env, thread_options, name),
       name_(name),
       waiters_mu_(waiters_mu),
@@ -365,6 +372,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       sub_thread_pool_end_request_percentage_(
           options.sub_thread_request_percentage) {
   thread_data_.resize(num_threads_);
+  local_queues_.resize(use_work_stealing_ ? num_blocking_threads_ : 0);
   for (int i = 0; i < num_threads_; ++i) {
     thread_data_[i].new_thread_work_sources =
         std::make_unique<Eigen::MaxSizeVector<ThreadWorkSource*>>(
@@ -420,6 +428,18 @@ void RunHandlerThreadPool::StartOneThreadForTesting() {
 void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking, TaskFunction fn) {
   Task t = env_.CreateTask(std::move(fn));
+  const int thread_id = CurrentThreadId();
+  if (is_blocking && thread_id >= 0 && thread_id < local_queues_.size()) {
+    tws->IncrementPendingTaskCount();
+    LocalTask local = local_queues_[thread_id].PushFront({std::move(t), tws});
+    if (!local.task.f) {
+      if (enable_wake_up_) tws->WakeUpWaiter();
+      return;
+    }
+    // The local queue is full.
+    tws->DecrementPendingTaskCount();
+    t = std::move(local.task);
+  }
   t = tws->EnqueueTask(std::move(t), is_blocking, enable_wake_up_);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -515,6 +535,37 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+RunHandlerThreadPool::LocalTask RunHandlerThreadPool::PopLocalTask(
+    int thread_id,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources) {
+  LocalQueue& queue = local_queues_[thread_id];
+  LocalTask local = queue.PopFront();
+  if (!local.task.f) return local;
+  // `thread_work_sources` is sorted by priority, so leave the task to thieves
+  // if a more important request has inter-op work waiting.
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    ThreadWorkSource* tws = thread_work_sources[i];
+    if (tws == local.tws) break;
+    if (tws->TaskQueueSize(/*is_blocking=*/true) > 0) {
+      // Only the owner pushes to the front, so there is room for the task.
+      local = queue.PushFront(std::move(local));
+      DCHECK(!local.task.f);
+      return {};
+    }
+  }
+  return local;
+}
+
+RunHandlerThreadPool::LocalTask RunHandlerThreadPool::StealLocalTask(
+    int thread_id) {
+  const int num_queues = local_queues_.size();
+  for (int i = 1; i < num_queues; ++i) {
+    LocalTask local = local_queues_[(thread_id + i) % num_queues].PopBack();
+    if (local.task.f) return local;
+  }
+  return {};
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -543,7 +594,14 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
         thread_data_[thread_id].current_thread_work_sources.get();
     sub_thread_pool_id = thread_data_[thread_id].sub_thread_pool_id;
     int active_requests = thread_work_sources->size();
-    if (may_steal_blocking_work) {
+    if (thread_id < local_queues_.size()) {
+      LocalTask local = PopLocalTask(thread_id, *thread_work_sources);
+      t = std::move(local.task);
+      tws = local.tws;
+    }
+    if (t.f) {
+      // The task comes from the local queue, no need to search.
+    } else if (may_steal_blocking_work) {
       // Each thread will first look for tasks from requests that belongs to
       // its sub thread pool.
       int search_range_start =
@@ -578,6 +636,12 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                    /*may_steal_blocking_work=*/false, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
     }
+    if (!t.f && thread_id < local_queues_.size()) {
+      LocalTask local = StealLocalTask(thread_id);
+      t = std::move(local.task);
+      tws = local.tws;
+      task_from_blocking_queue = true;
+    }
     if (t.f) {
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
@@ -229,6 +229,9 @@ class ThreadWorkSource {
 
   Task EnqueueTask(Task t, bool is_blocking, bool enable_wake_up);
 
+  // Wakes up a thread waiting for work of this request, if there is any.
+  void WakeUpWaiter();
+
   Task PopBlockingTask();
 
   Task PopNonBlockingTask(int start_index, bool search_from_all_queue);
@@ -373,6 +376,22 @@ class RunHandlerThreadPool {
                                   int sub_thread_pool_id);
 
  private:
+  // Inter-op task kept in the local queue of the worker that scheduled it.
+  struct LocalTask {
+    Task task;
+    ThreadWorkSource* tws = nullptr;
+  };
+  typedef Eigen::RunQueue<LocalTask, 256> LocalQueue;
+
+  // Pops a task from the local queue of `thread_id`, unless a request with a
+  // higher priority than the one of the task has inter-op work queued.
+  LocalTask PopLocalTask(
+      int thread_id,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources);
+
+  // Steals the oldest task from the local queue of another blocking thread.
+  LocalTask StealLocalTask(int thread_id);
+
   struct ThreadData {
     ThreadData();
     tensorflow::mutex mu;
@@ -399,7 +418,13 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  // If true, inter-op work scheduled from a blocking thread goes to the local
+  // queue of that thread. The owner pops its local queue in LIFO order for
+  // locality, and idle threads steal from it in FIFO order.
+  const bool use_work_stealing_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
+  // One queue per blocking thread if `use_work_stealing_` is true.
+  Eigen::MaxSizeVector<LocalQueue> local_queues_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
   std::string name_;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cstddef>
+#include <cstdlib>
 #include <functional>
 #include <memory>
 #include <string>
@@ -120,6 +121,31 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, WorkStealing) {
+  setenv("TF_RUN_HANDLER_USE_WORK_STEALING", "true", 1);
+  int num_threads = 2;
+  RunHandlerPool::Options options;
+  options.num_intra_op_threads = num_threads;
+  options.num_inter_op_threads = num_threads;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(options));
+  unsetenv("TF_RUN_HANDLER_USE_WORK_STEALING");
+
+  auto handler = pool->Get(/*step_id=*/1);
+  absl::Notification inner_done;
+  absl::Notification outer_done;
+  handler->ScheduleInterOpClosure(
+      TaskFunction([&handler, &inner_done, &outer_done]() {
+        // The inner closure is queued locally on this thread, which is blocked
+        // until another thread steals and runs it.
+        handler->ScheduleInterOpClosure(
+            TaskFunction([&inner_done]() { inner_done.Notify(); }));
+        inner_done.WaitForNotification();
+        outer_done.Notify();
+      }));
+  outer_done.WaitForNotification();
+  EXPECT_TRUE(inner_done.HasBeenNotified());
+}
+
 TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   int num_threads = 2;
   RunHandlerPool::Options pool_options;
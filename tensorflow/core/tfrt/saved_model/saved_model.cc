@@ -62,6 +62,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
@@ -434,6 +435,64 @@ void UpdateCompileOptions(SavedModel::Options& options) {
       !options.graph_execution_options.enable_mlrt;
 }
 
+// Compiles `mlir_module` to MLRT bytecode. If `cache_dir` is non-empty, the
+// bytecode is read from there instead when the same module was compiled with
+// the same options before, and is written there otherwise.
+absl::StatusOr<mlrt::bc::Buffer> ConvertTfMlirToBytecodeWithCache(
+    absl::string_view cache_dir, const TfrtCompileOptions& compile_options,
+    FallbackState& fallback_state, mlir::ModuleOp mlir_module,
+    ModelRuntimeContext& model_context) {
+  // Backend compilers and XLA functions change the runtime state beyond the
+  // bytecode, and inlined checkpoints are not part of the module, so those
+  // models are always compiled.
+  if (cache_dir.empty() || compile_options.backend_compiler != nullptr ||
+      compile_options.device_target != TfrtDeviceInfraTarget::kCpu ||
+      !model_context.checkpoint_path().empty()) {
+    return tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
+        compile_options, fallback_state, mlir_module, model_context);
+  }
+
+  // The key must be computed before compilation, which modifies the module.
+  Env* env = Env::Default();
+  const std::string file_path =
+      GetMlrtBytecodeCachePath(cache_dir, compile_options, mlir_module);
+  if (env->FileExists(file_path).ok()) {
+    absl::StatusOr<mlrt::bc::Buffer> bytecode =
+        DeserializeMlrtBytecodeBuffer(file_path);
+    if (bytecode.ok() && !bytecode->empty()) {
+      LOG(INFO) << "Loaded MLRT bytecode from " << file_path;
+      return bytecode;
+    }
+    LOG(WARNING) << "Failed to load MLRT bytecode from " << file_path
+                 << ", compiling it instead: " << bytecode.status();
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      mlrt::bc::Buffer bytecode,
+      tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
+          compile_options, fallback_state, mlir_module, model_context));
+
+  // Write to a temporary file first and then move it into place, so that
+  // concurrent loads never see a partially written entry.
+  absl::Status status = [&]() -> absl::Status {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(std::string(cache_dir)));
+    std::string temp_path = file_path;
+    if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+      return absl::UnavailableError(
+          absl::StrCat("Could not create a unique file inside ", cache_dir));
+    }
+    TF_RETURN_IF_ERROR(SerializeMLRTBytecode(bytecode, temp_path));
+    return env->RenameFile(temp_path, file_path);
+  }();
+  if (status.ok()) {
+    LOG(INFO) << "Saved MLRT bytecode to " << file_path;
+  } else {
+    LOG(WARNING) << "Failed to save MLRT bytecode to " << file_path << ": "
+                 << status;
+  }
+  return bytecode;
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
@@ -620,9 +679,11 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
 
     if (options.graph_execution_options.enable_mlrt) {
       ASSIGN_OR_RETURN_IN_COMPILE(
-          bytecode, tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
-                        options.graph_execution_options.compile_options,
-                        *fallback_state, mlir_module.get(), model_context));
+          bytecode,
+          ConvertTfMlirToBytecodeWithCache(
+              options.mlrt_bytecode_cache_dir,
+              options.graph_execution_options.compile_options,
+              *fallback_state, mlir_module.get(), model_context));
     } else {
       RETURN_IF_ERROR_IN_COMPILE(tensorflow::ConvertTfMlirToBef(
           options.graph_execution_options.compile_options, mlir_module.get(),
@@ -701,14 +762,23 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
               << persistent_cache_directory << ", and set it to read-only.";
   }
 
+  const int preload_num_threads =
+      options.enable_lazy_loading && !options.lazy_loading_use_graph_executor
+          ? options.lazy_loading_preload_num_threads
+          : 0;
+
   // Finally, create the saved model.
-  return {std::make_unique<SavedModelImpl>(
+  auto saved_model = std::make_unique<SavedModelImpl>(
       std::move(options), std::move(symbol_uids), std::move(meta_graph_def),
       std::move(bef), std::move(bef_file), std::move(bytecode),
       std::move(loaded_executable),
       std::move(initializers_and_signatures.signature_map),
       std::move(runner_table), std::move(resource_array),
-      std::move(graph_executor))};
+      std::move(graph_executor));
+  if (preload_num_threads > 0) {
+    TF_RETURN_IF_ERROR(saved_model->PreloadSignatures(preload_num_threads));
+  }
+  return {std::move(saved_model)};
 }
 
 SavedModelImpl::SavedModelImpl(
@@ -1047,13 +1117,17 @@ absl::StatusOr<JoinedSignature> JoinSignatures(
 }  // namespace
 
 // TODO(b/216379787): Reuse `GraphExecutor::LoadClientGraph()`.
-absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
-SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
+absl::StatusOr<std::unique_ptr<SavedModelImpl::LoadingResult>>
+SavedModelImpl::CompileJoinedSignature(const JoinedSignature& joined_signature,
+                                       bool enable_mlir_threading) {
   // Step 1: Import the combined subgraph from proto to an MLIR module.
   mlir::DialectRegistry registry;
   RegisterMlirDialect(
       registry, graph_executor_->options().compile_options.backend_compiler);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry,
+                            enable_mlir_threading
+                                ? mlir::MLIRContext::Threading::ENABLED
+                                : mlir::MLIRContext::Threading::DISABLED);
 
   ASSIGN_OR_RETURN_IN_IMPORT(auto module,
                              ImportSubgraph(&context, joined_signature.name,
@@ -1112,6 +1186,13 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
   }
   symbol_uids.tfrt_symbol_uid = MaybeUploadMlirToXsymbol(module.get());
   loading_result->symbol_uids = std::move(symbol_uids);
+  return loading_result;
+}
+
+absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
+SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
+  TF_ASSIGN_OR_RETURN(auto loading_result,
+                      CompileJoinedSignature(joined_signature));
 
   // Store loading_result in cache.
   const auto* loading_result_ptr = loading_result.get();
@@ -1148,5 +1229,48 @@ SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
   return LoadJoinedSignature(joined_signature);
 }
 
+tensorflow::Status SavedModelImpl::PreloadSignatures(int num_threads) {
+  std::vector<JoinedSignature> joined_signatures;
+  joined_signatures.reserve(signatures_.size());
+  for (const auto& entry : signatures_) {
+    TF_ASSIGN_OR_RETURN(
+        auto joined_signature,
+        JoinSignatures({entry.first}, signatures_,
+                       meta_graph_def_.signature_def()));
+    joined_signatures.push_back(std::move(joined_signature));
+  }
+
+  LOG(INFO) << "TFRT preloading " << joined_signatures.size()
+            << " signatures with " << num_threads << " threads.";
+  const auto start_time = absl::Now();
+  std::vector<absl::StatusOr<std::unique_ptr<LoadingResult>>> results(
+      joined_signatures.size());
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "tfrt_preload_signatures",
+                                        num_threads);
+    for (int i = 0; i < joined_signatures.size(); ++i) {
+      pool.Schedule([this, &joined_signatures, &results, i]() {
+        // Signatures are already compiled in parallel, so MLIR's own thread
+        // pool would only oversubscribe the machine.
+        results[i] = CompileJoinedSignature(joined_signatures[i],
+                                            /*enable_mlir_threading=*/false);
+      });
+    }
+    // The destructor of `pool` waits for all compilations.
+  }
+
+  tensorflow::mutex_lock l(loading_result_cache_mu_);
+  for (int i = 0; i < results.size(); ++i) {
+    TF_RETURN_IF_ERROR(results[i].status());
+    // A concurrent run may have already loaded the signature.
+    loading_result_cache_.try_emplace(joined_signatures[i].name,
+                                      *std::move(results[i]));
+  }
+  LOG(INFO) << "TFRT finished preloading signatures. Took "
+            << absl::ToInt64Milliseconds(absl::Now() - start_time) << " ms.";
+  return absl::OkStatus();
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
@@ -107,6 +107,19 @@ class SavedModel {
     // TODO(b/216379787): Remove this option once b/279197040 is unblocked.
     bool lazy_loading_use_graph_executor = false;
 
+    // If positive and lazy loading is enabled, all signatures are compiled at
+    // the end of loading instead of at their first run, on a pool with this
+    // many threads. As lazy loading compiles every signature as its own
+    // module, the import and lowering of different signatures run
+    // concurrently. Not supported with `lazy_loading_use_graph_executor`.
+    int lazy_loading_preload_num_threads = 0;
+
+    // If non-empty and MLRT is enabled, the MLRT bytecode compiled for the
+    // model is stored in this directory, keyed by a fingerprint of the
+    // imported module, the compile options and the TensorFlow version. Later
+    // loads of the same model read the bytecode instead of compiling it.
+    std::string mlrt_bytecode_cache_dir;
+
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
@@ -289,11 +302,23 @@ class SavedModelImpl final : public SavedModel {
       const std::vector<std::string>& output_nodes,
       const std::vector<std::string>& target_nodes);
 
+  // Given the joined signature, imports and compiles the subgraph. Does not
+  // touch `loading_result_cache_`, so different signatures can be compiled
+  // concurrently.
+  absl::StatusOr<std::unique_ptr<LoadingResult>> CompileJoinedSignature(
+      const JoinedSignature& joined_signature,
+      bool enable_mlir_threading = true);
+
   // Given the joined signature, loads the subgraph and returns loading result.
   absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
   LoadJoinedSignature(const JoinedSignature& joined_signature)
       TF_EXCLUSIVE_LOCKS_REQUIRED(loading_result_cache_mu_);
 
+  // Compiles all signatures on a pool of `num_threads` threads and stores them
+  // in `loading_result_cache_`. Used for lazy loading only.
+  tensorflow::Status PreloadSignatures(int num_threads)
+      TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
+
   // Returns the loading result given the signature names.
   absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
   GetOrCreateLoadingResult(const RunOptions& run_options,
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <iterator>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -56,12 +58,14 @@ limitations under the License.
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_import_input.h"
 #include "tensorflow/core/tfrt/saved_model/utils/serialize_utils.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/path.h"
 #include "tfrt/bef/bef_buffer.h"  // from @tf_runtime
 #include "tfrt/init_tfrt_dialects.h"  // from @tf_runtime
@@ -312,6 +316,31 @@ std::string GetMlirFilePath(const std::string& aot_package_directory) {
   return tsl::io::JoinPath(aot_package_directory, kMlirModuleFilename);
 }
 
+std::string GetMlrtBytecodeCachePath(absl::string_view cache_dir,
+                                     const TfrtCompileOptions& options,
+                                     mlir::ModuleOp mlir_module) {
+  // `operator<<` covers most of the options; the others affecting the
+  // lowering are appended explicitly.
+  std::ostringstream key;
+  key << TF_VERSION_STRING << ";" << TF_GRAPH_DEF_VERSION << ";" << options
+      << ";saved_model_dir=" << options.saved_model_dir
+      << ";graph_options=" << options.graph_options.ShortDebugString()
+      << ";tpu_allow_unpadded_batch="
+      << static_cast<int>(options.tpu_allow_unpadded_batch)
+      << ";fuse_get_resource_ops_in_hoisting="
+      << options.fuse_get_resource_ops_in_hoisting
+      << ";sink_in_invariant_ops=" << options.sink_in_invariant_ops
+      << ";use_gpu_compile_and_execute_op="
+      << options.use_gpu_compile_and_execute_op << ";"
+      << SerializeMlirModule(mlir_module);
+  const tsl::Fprint128 fingerprint = tsl::Fingerprint128(key.str());
+  return tsl::io::JoinPath(
+      cache_dir,
+      absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                   absl::Hex(fingerprint.low64, absl::kZeroPad16), ".",
+                   kMlrtBufferFileName));
+}
+
 absl::StatusOr<tfrt::BefBuffer> LoadBefAndMlir(
     const TfrtCompileOptions& options, mlir::ModuleOp mlir_module,
     const std::string& saved_model_dir,
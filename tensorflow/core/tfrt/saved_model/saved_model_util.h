@@ -125,6 +125,14 @@ std::string GetBefFilePath(std::string aot_package_directory);
 
 std::string GetMlirFilePath(const std::string& aot_package_directory);
 
+// Returns the path in `cache_dir` of the MLRT bytecode compiled from
+// `mlir_module` with `options`. The file name is a fingerprint of the module,
+// the compile options and the TensorFlow version, so that a cached bytecode is
+// never used after any of them changes.
+std::string GetMlrtBytecodeCachePath(absl::string_view cache_dir,
+                                     const TfrtCompileOptions& options,
+                                     mlir::ModuleOp mlir_module);
+
 // TODO(b/295241000): Implement MLIR deserialization to skip it AoT and remove
 // redundant steps
 absl::StatusOr<tfrt::BefBuffer> LoadBefAndMlir(
@@ -31,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_autotune_map.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_parameters.pb.h"
 #include "tsl/lib/strings/proto_serialization.h"
 #include "tsl/protobuf/dnn.pb.h"
 
@@ -170,6 +172,52 @@ Status PopulateConvMap(
   return OkStatus();
 }
 
+StatusOr<CpuMatmulMapProto> CpuMatmulMapToProto(
+    const CpuMatmulAutotuneMap &autotune_map) {
+  // Sorts the entries by their serialized keys, so that the serialization is
+  // deterministic.
+  std::map<string, CpuMatmulMapProto::Entry> sorted_map;
+  for (const auto &p : autotune_map.GetMap()) {
+    CpuMatmulMapProto::Entry kv;
+    *kv.mutable_key() = p.first.ToProto();
+    kv.set_value(p.second);
+    std::string serialized_params;
+    TF_RET_CHECK(
+        tsl::SerializeToStringDeterministic(kv.key(), &serialized_params));
+    sorted_map.insert(std::make_pair(std::move(serialized_params), kv));
+  }
+  CpuMatmulMapProto proto;
+  for (auto const &p : sorted_map) {
+    *proto.add_kv_pairs() = p.second;
+  }
+  return proto;
+}
+
+Status PopulateCpuMatmulMap(const CpuMatmulMapProto &m,
+                            CpuMatmulAutotuneMap *autotune_map) {
+  for (const CpuMatmulMapProto::Entry &kv : m.kv_pairs()) {
+    if (kv.key().version() != CpuMatmulParameters::kVersion) {
+      return errors::Aborted(
+          "Aborted because the loaded autotune results for CPU matmul "
+          "operations have a version different from runtime's version. "
+          "Expected version: ",
+          CpuMatmulParameters::kVersion, ". Actual version: ",
+          kv.key().version());
+    }
+    // The matmul kernels only handle the algorithms they can pick.
+    if (kv.value() == CPU_MATMUL_DEFAULT ||
+        !CpuMatmulAlgorithm_IsValid(kv.value()) ||
+        (kv.value() == CPU_MATMUL_OUTPUT_BLOCKS &&
+         kv.key().batch_size() != 1)) {
+      return errors::InvalidArgument("Invalid CPU matmul algorithm ",
+                                     kv.value(), " for ",
+                                     kv.key().DebugString());
+    }
+    autotune_map->Insert(CpuMatmulParameters(kv.key()), kv.value());
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
@@ -180,6 +228,9 @@ Status SerializeAutotuneMaps(std::string *output) {
                       ConvMapToProto(*ConvAutotuneMap::GetInstance()));
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+  TF_ASSIGN_OR_RETURN(
+      *proto.mutable_cpu_matmul_map(),
+      CpuMatmulMapToProto(*CpuMatmulAutotuneMap::GetInstance()));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
@@ -199,12 +250,15 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
                                      FusedConvAutotuneMap::GetInstance()));
+  TF_RETURN_IF_ERROR(PopulateCpuMatmulMap(
+      proto.cpu_matmul_map(), CpuMatmulAutotuneMap::GetInstance()));
   // TODO(b/189530096): Populate autotune maps for more ops.
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   return absl::OkStatus();
 }
 
 void ResetAutotuneMaps() {
+  CpuMatmulAutotuneMap::GetInstance()->ClearMap();
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
   FusedConvAutotuneMap::GetInstance()->ClearMap();
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_autotune_map.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+
+CpuMatmulParameters::CpuMatmulParameters(const CpuMatmulParametersProto& proto)
+    : CpuMatmulParameters(proto.m(), proto.n(), proto.k(), proto.batch_size(),
+                          proto.dtype(), proto.adj_x(), proto.adj_y(),
+                          proto.trans_x(), proto.trans_y(),
+                          proto.num_threads()) {}
+
+CpuMatmulParametersProto CpuMatmulParameters::ToProto() const {
+  CpuMatmulParametersProto proto;
+  proto.set_m(m);
+  proto.set_n(n);
+  proto.set_k(k);
+  proto.set_batch_size(batch_size);
+  proto.set_dtype(dtype);
+  proto.set_adj_x(adj_x);
+  proto.set_adj_y(adj_y);
+  proto.set_trans_x(trans_x);
+  proto.set_trans_y(trans_y);
+  proto.set_num_threads(num_threads);
+  proto.set_version(kVersion);
+  return proto;
+}
+
+std::string CpuMatmulParameters::ToString() const {
+  return absl::StrFormat(
+      "m: %d, n: %d, k: %d, batch_size: %d, dtype: %s, adj_x: %d, adj_y: %d, "
+      "trans_x: %d, trans_y: %d, num_threads: %d",
+      m, n, k, batch_size, DataTypeString(dtype), adj_x, adj_y, trans_x,
+      trans_y, num_threads);
+}
+
+CpuMatmulAutotuneMap* CpuMatmulAutotuneMap::GetInstance() {
+  static CpuMatmulAutotuneMap* instance = new CpuMatmulAutotuneMap();
+  return instance;
+}
+
+bool CpuMatmulAutotuneMap::Find(const CpuMatmulParameters& params,
+                                CpuMatmulAlgorithm* algorithm) const {
+  mutex_lock lock(mu_);
+  auto it = map_.find(params);
+  if (it == map_.end()) return false;
+  *algorithm = it->second;
+  return true;
+}
+
+void CpuMatmulAutotuneMap::Insert(const CpuMatmulParameters& params,
+                                  CpuMatmulAlgorithm algorithm) {
+  mutex_lock lock(mu_);
+  map_.insert_or_assign(params, algorithm);
+}
+
+std::vector<std::pair<CpuMatmulParameters, CpuMatmulAlgorithm>>
+CpuMatmulAutotuneMap::GetMap() const {
+  mutex_lock lock(mu_);
+  return std::vector<std::pair<CpuMatmulParameters, CpuMatmulAlgorithm>>(
+      map_.begin(), map_.end());
+}
+
+void CpuMatmulAutotuneMap::ClearMap() {
+  mutex_lock lock(mu_);
+  map_.clear();
+}
+
+}  // namespace tensorflow
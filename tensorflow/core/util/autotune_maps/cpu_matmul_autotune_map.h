@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This file defines the map storing the autotuning results of the CPU MatMul
+// and BatchMatMul kernels. Unlike the GPU maps, it is available in all builds,
+// and is serialized along with them by SerializeAutotuneMaps.
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_MATMUL_AUTOTUNE_MAP_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_MATMUL_AUTOTUNE_MAP_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_parameters.pb.h"
+
+namespace tensorflow {
+
+// Identifies a matrix product on a CPU device with a given number of threads.
+struct CpuMatmulParameters {
+  // A positive number that denotes the version of this struct. Should be
+  // incremented every time the implementations or this struct change in a way
+  // that may invalidate autotune results.
+  static constexpr int kVersion = 1;
+
+  CpuMatmulParameters(int64_t m, int64_t n, int64_t k, int64_t batch_size,
+                      DataType dtype, bool adj_x, bool adj_y, bool trans_x,
+                      bool trans_y, int num_threads)
+      : m(m),
+        n(n),
+        k(k),
+        batch_size(batch_size),
+        dtype(dtype),
+        adj_x(adj_x),
+        adj_y(adj_y),
+        trans_x(trans_x),
+        trans_y(trans_y),
+        num_threads(num_threads) {}
+  explicit CpuMatmulParameters(const CpuMatmulParametersProto& proto);
+
+  CpuMatmulParametersProto ToProto() const;
+  std::string ToString() const;
+
+  bool operator==(const CpuMatmulParameters& other) const {
+    return m == other.m && n == other.n && k == other.k &&
+           batch_size == other.batch_size && dtype == other.dtype &&
+           adj_x == other.adj_x && adj_y == other.adj_y &&
+           trans_x == other.trans_x && trans_y == other.trans_y &&
+           num_threads == other.num_threads;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const CpuMatmulParameters& params) {
+    return H::combine(std::move(h), params.m, params.n, params.k,
+                      params.batch_size, params.dtype, params.adj_x,
+                      params.adj_y, params.trans_x, params.trans_y,
+                      params.num_threads);
+  }
+
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  int64_t batch_size;
+  DataType dtype;
+  bool adj_x;
+  bool adj_y;
+  bool trans_x;
+  bool trans_y;
+  int num_threads;
+};
+
+// The fastest implementation found for each CpuMatmulParameters. Thread-safe.
+class CpuMatmulAutotuneMap {
+ public:
+  static CpuMatmulAutotuneMap* GetInstance();
+
+  // Returns false if `params` wasn't autotuned yet.
+  bool Find(const CpuMatmulParameters& params,
+            CpuMatmulAlgorithm* algorithm) const;
+
+  void Insert(const CpuMatmulParameters& params, CpuMatmulAlgorithm algorithm);
+
+  std::vector<std::pair<CpuMatmulParameters, CpuMatmulAlgorithm>> GetMap()
+      const;
+
+  void ClearMap();
+
+ private:
+  CpuMatmulAutotuneMap() = default;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<CpuMatmulParameters, CpuMatmulAlgorithm> map_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_MATMUL_AUTOTUNE_MAP_H_
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_autotune_map.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
+#include "tensorflow/core/util/autotune_maps/cpu_matmul_parameters.pb.h"
+
+namespace tensorflow {
+namespace {
+
+CpuMatmulParameters MakeParameters(int64_t m, int num_threads) {
+  return CpuMatmulParameters(m, /*n=*/8, /*k=*/256, /*batch_size=*/1,
+                             DT_FLOAT, /*adj_x=*/false, /*adj_y=*/true,
+                             /*trans_x=*/false, /*trans_y=*/false,
+                             num_threads);
+}
+
+TEST(CpuMatmulAutotuneMapTest, FindAndInsert) {
+  CpuMatmulAutotuneMap* map = CpuMatmulAutotuneMap::GetInstance();
+  map->ClearMap();
+  CpuMatmulAlgorithm algorithm;
+  EXPECT_FALSE(map->Find(MakeParameters(1024, 4), &algorithm));
+
+  map->Insert(MakeParameters(1024, 4), CPU_MATMUL_OUTPUT_BLOCKS);
+  ASSERT_TRUE(map->Find(MakeParameters(1024, 4), &algorithm));
+  EXPECT_EQ(algorithm, CPU_MATMUL_OUTPUT_BLOCKS);
+  // The number of threads is part of the key.
+  EXPECT_FALSE(map->Find(MakeParameters(1024, 8), &algorithm));
+  map->ClearMap();
+}
+
+TEST(CpuMatmulAutotuneMapTest, SerializeAndLoad) {
+  ResetAutotuneMaps();
+  CpuMatmulAutotuneMap* map = CpuMatmulAutotuneMap::GetInstance();
+  map->Insert(MakeParameters(1024, 4), CPU_MATMUL_OUTPUT_BLOCKS);
+  map->Insert(MakeParameters(16, 4), CPU_MATMUL_SEQUENTIAL);
+  std::string serialized;
+  TF_ASSERT_OK(SerializeAutotuneMaps(&serialized));
+
+  ResetAutotuneMaps();
+  EXPECT_TRUE(map->GetMap().empty());
+  TF_ASSERT_OK(LoadSerializedAutotuneMaps(serialized));
+  EXPECT_EQ(map->GetMap().size(), 2);
+  CpuMatmulAlgorithm algorithm;
+  ASSERT_TRUE(map->Find(MakeParameters(16, 4), &algorithm));
+  EXPECT_EQ(algorithm, CPU_MATMUL_SEQUENTIAL);
+
+  // Serializing the same results gives the same string.
+  std::string serialized_again;
+  TF_ASSERT_OK(SerializeAutotuneMaps(&serialized_again));
+  EXPECT_EQ(serialized, serialized_again);
+  ResetAutotuneMaps();
+}
+
+}  // namespace
+}  // namespace tensorflow
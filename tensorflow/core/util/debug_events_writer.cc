@@ -15,17 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/util/debug_events_writer.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -36,6 +40,81 @@ void MaybeSetDebugEventTimestamp(DebugEvent* debug_event, Env* env) {
     debug_event->set_wall_time(env->NowMicros() / 1e6);
   }
 }
+
+DebugEventsWriter::SamplingPolicy SamplingPolicyFromEnv() {
+  DebugEventsWriter::SamplingPolicy policy;
+  Status s = ReadInt64FromEnvVar("TFDBG_TRACE_EVERY_N", 1, &policy.every_n);
+  if (s.ok()) {
+    s = ReadFloatFromEnvVar("TFDBG_TRACE_OP_FRACTION", 1.0f,
+                            &policy.op_fraction);
+  }
+  if (s.ok()) {
+    s = ReadBoolFromEnvVar("TFDBG_TRACE_NON_FINITE_ONLY", false,
+                           &policy.non_finite_only);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to read the tfdbg sampling policy: " << s;
+    return DebugEventsWriter::SamplingPolicy();
+  }
+  return policy;
+}
+
+// Returns whether any of the elements [begin, end) of `t` is not finite, or
+// non-zero if `nonzero` is true. Tensors of other than floating-point types
+// never match.
+template <typename T>
+bool AnyElementMatches(const Tensor& t, int64_t begin, int64_t end,
+                       bool nonzero) {
+  auto flat = t.flat<T>();
+  end = std::min(end, static_cast<int64_t>(flat.size()));
+  for (int64_t i = begin; i < end; ++i) {
+    if (nonzero ? flat(i) != T(0) : !Eigen::numext::isfinite(flat(i))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AnyElementMatches(const Tensor& t, int64_t begin, int64_t end,
+                       bool nonzero) {
+  switch (t.dtype()) {
+    case DT_HALF:
+      return AnyElementMatches<Eigen::half>(t, begin, end, nonzero);
+    case DT_BFLOAT16:
+      return AnyElementMatches<bfloat16>(t, begin, end, nonzero);
+    case DT_FLOAT:
+      return AnyElementMatches<float>(t, begin, end, nonzero);
+    case DT_DOUBLE:
+      return AnyElementMatches<double>(t, begin, end, nonzero);
+    default:
+      return false;
+  }
+}
+
+// Returns whether the trace `tensor_value` of the given mode shows that the
+// debugged tensor holds an infinity or a NaN.
+bool TraceShowsNonFinite(int32_t tensor_debug_mode,
+                         const Tensor& tensor_value) {
+  switch (tensor_debug_mode) {
+    case TensorDebugMode::CURT_HEALTH:
+      // [tensor_id, any_inf_or_nan].
+      return AnyElementMatches(tensor_value, 1, 2, /*nonzero=*/true);
+    case TensorDebugMode::CONCISE_HEALTH:
+      // [tensor_id, size, neg_inf_count, pos_inf_count, nan_count].
+      return AnyElementMatches(tensor_value, 2, 5, /*nonzero=*/true);
+    case TensorDebugMode::FULL_HEALTH:
+      // [tensor_id, device_id, dtype, rank, size, neg_inf_count,
+      //  pos_inf_count, nan_count, neg_count, zero_count, pos_count].
+      return AnyElementMatches(tensor_value, 5, 8, /*nonzero=*/true);
+    case TensorDebugMode::UNSPECIFIED:
+    case TensorDebugMode::FULL_TENSOR:
+    case TensorDebugMode::REDUCE_INF_NAN_THREE_SLOTS:
+      return AnyElementMatches(tensor_value, 0, tensor_value.NumElements(),
+                               /*nonzero=*/false);
+    default:
+      return false;
+  }
+}
 }  // namespace
 
 SingleDebugEventFileWriter::SingleDebugEventFileWriter(const string& file_path)
@@ -283,6 +362,9 @@ Status DebugEventsWriter::WriteGraphExecutionTrace(
     const string& tfdbg_context_id, const string& device_name,
     const string& op_name, int32_t output_slot, int32_t tensor_debug_mode,
     const Tensor& tensor_value) {
+  if (!IsSampled(op_name, output_slot, tensor_debug_mode, tensor_value)) {
+    return absl::OkStatus();
+  }
   std::unique_ptr<GraphExecutionTrace> trace(new GraphExecutionTrace());
   trace->set_tfdbg_context_id(tfdbg_context_id);
   if (!op_name.empty()) {
@@ -299,6 +381,35 @@ Status DebugEventsWriter::WriteGraphExecutionTrace(
   return WriteGraphExecutionTrace(trace.release());
 }
 
+void DebugEventsWriter::SetSamplingPolicy(const SamplingPolicy& policy) {
+  mutex_lock l(sampling_mu_);
+  sampling_policy_ = policy;
+  num_traces_.clear();
+}
+
+bool DebugEventsWriter::IsSampled(const string& op_name, int32_t output_slot,
+                                  int32_t tensor_debug_mode,
+                                  const Tensor& tensor_value) {
+  SamplingPolicy policy;
+  {
+    mutex_lock l(sampling_mu_);
+    policy = sampling_policy_;
+    if (policy.every_n > 1 &&
+        num_traces_[std::make_pair(op_name, output_slot)]++ % policy.every_n !=
+            0) {
+      return false;
+    }
+  }
+  if (policy.op_fraction < 1.0f) {
+    constexpr uint64 kNumBuckets = 1 << 20;
+    if (Hash64(op_name) % kNumBuckets >= policy.op_fraction * kNumBuckets) {
+      return false;
+    }
+  }
+  return !policy.non_finite_only ||
+         TraceShowsNonFinite(tensor_debug_mode, tensor_value);
+}
+
 void DebugEventsWriter::WriteSerializedNonExecutionDebugEvent(
     const string& debug_event_str, DebugEventFileType type) {
   std::unique_ptr<SingleDebugEventFileWriter>* writer = nullptr;
@@ -493,7 +604,8 @@ DebugEventsWriter::DebugEventsWriter(const string& dump_root,
       graph_execution_trace_buffer_(),
       graph_execution_trace_buffer_mu_(),
       device_name_to_id_(),
-      device_mu_() {}
+      device_mu_(),
+      sampling_policy_(SamplingPolicyFromEnv()) {}
 
 Status DebugEventsWriter::InitNonMetadataFile(DebugEventFileType type) {
   std::unique_ptr<SingleDebugEventFileWriter>* writer = nullptr;
@@ -20,6 +20,7 @@ limitations under the License.
 #include <deque>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -91,6 +92,25 @@ class DebugEventsWriter {
   static constexpr const int kCurrentFormatVersion = 1;
 #endif
 
+  // Selects the graph execution traces written by the raw-value
+  // WriteGraphExecutionTrace() method, i.e. by the DebugIdentityV2 op, to
+  // reduce the overhead of debugging long-running programs. Traces that are
+  // not selected are dropped before their tensor is copied. The defaults
+  // select all traces.
+  struct SamplingPolicy {
+    // If > 1, only every `every_n`-th trace of each op output is written,
+    // starting with the first one.
+    int64_t every_n = 1;
+    // If < 1, only the traces of this fraction of the ops are written. The
+    // ops are selected by a hash of their name, so that the same ops are
+    // traced throughout the run.
+    float op_fraction = 1.0f;
+    // If true, only the traces that show an infinity or a NaN are written:
+    // the full tensors holding such values, or the health summaries that
+    // count them.
+    bool non_finite_only = false;
+  };
+
   // Get the DebugEventsWriter for the given dump_root.
   // For a given dump_root value, it is a singleton. tfdbg event files come in
   // sets of six. The singleton pattern avoids storing multiple sets in a single
@@ -190,6 +210,11 @@ class DebugEventsWriter {
   void WriteSerializedExecutionDebugEvent(const string& debug_event_str,
                                           DebugEventFileType type);
 
+  // Replaces the sampling policy, which is initially read from the
+  // TFDBG_TRACE_EVERY_N, TFDBG_TRACE_OP_FRACTION and
+  // TFDBG_TRACE_NON_FINITE_ONLY environment variables.
+  void SetSamplingPolicy(const SamplingPolicy& policy);
+
   // Given name of the device, retrieve a unique integer ID. As a side effect,
   // if this is the first time this object encounters the device name,
   // writes a DebuggedDevice proto to the .graphs file in the file set.
@@ -235,6 +260,11 @@ class DebugEventsWriter {
 
   void SelectWriter(DebugEventFileType type,
                     std::unique_ptr<SingleDebugEventFileWriter>** writer);
+
+  // Returns whether the sampling policy selects the trace of `tensor_value`
+  // for output `output_slot` of op `op_name`.
+  bool IsSampled(const string& op_name, int32_t output_slot,
+                 int32_t tensor_debug_mode, const Tensor& tensor_value);
   const string GetSuffix(DebugEventFileType type);
   string GetFileNameInternal(DebugEventFileType type);
 
@@ -256,6 +286,12 @@ class DebugEventsWriter {
   absl::flat_hash_map<string, int> device_name_to_id_ TF_GUARDED_BY(device_mu_);
   mutex device_mu_;
 
+  SamplingPolicy sampling_policy_ TF_GUARDED_BY(sampling_mu_);
+  // The number of traces seen for each op output, for `every_n`.
+  absl::flat_hash_map<std::pair<string, int32_t>, int64_t> num_traces_
+      TF_GUARDED_BY(sampling_mu_);
+  mutex sampling_mu_;
+
   std::unique_ptr<SingleDebugEventFileWriter> metadata_writer_;
   std::unique_ptr<SingleDebugEventFileWriter> source_files_writer_;
   std::unique_ptr<SingleDebugEventFileWriter> stack_frames_writer_;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -886,5 +887,61 @@ TEST_F(DebugEventsWriterTest, DisableCyclicBufferBehavior) {
   TF_ASSERT_OK(writer->Close());
 }
 
+TEST_F(DebugEventsWriterTest, SampleGraphExecutionTraces) {
+  DebugEventsWriter* writer = DebugEventsWriter::GetDebugEventsWriter(
+      dump_root_, tfdbg_run_id_, /*circular_buffer_size=*/0);
+  TF_ASSERT_OK(writer->Init());
+
+  // Writes every third trace of each op output.
+  DebugEventsWriter::SamplingPolicy policy;
+  policy.every_n = 3;
+  writer->SetSamplingPolicy(policy);
+  Tensor finite(DT_FLOAT, TensorShape({2}));
+  finite.flat<float>().setConstant(1.0f);
+  for (int i = 0; i < 9; ++i) {
+    TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+        "graph", "/device:CPU:0", "op_a", /*output_slot=*/0,
+        TensorDebugMode::FULL_TENSOR, finite));
+  }
+  TF_ASSERT_OK(writer->FlushExecutionFiles());
+  std::vector<DebugEvent> actuals;
+  ReadDebugEventProtos(writer, DebugEventFileType::GRAPH_EXECUTION_TRACES,
+                       &actuals);
+  EXPECT_EQ(actuals.size(), 3);
+
+  // Writes only the traces that show a NaN or an infinity.
+  policy = DebugEventsWriter::SamplingPolicy();
+  policy.non_finite_only = true;
+  writer->SetSamplingPolicy(policy);
+  Tensor non_finite = finite;
+  non_finite.flat<float>()(1) = std::numeric_limits<float>::quiet_NaN();
+  Tensor healthy(DT_FLOAT, TensorShape({2}));
+  healthy.flat<float>()(0) = 0.0f;  // Tensor ID.
+  healthy.flat<float>()(1) = 0.0f;  // No infinity or NaN.
+  Tensor unhealthy = healthy;
+  unhealthy.flat<float>()(1) = 1.0f;
+  TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+      "graph", "/device:CPU:0", "op_a", 0, TensorDebugMode::FULL_TENSOR,
+      finite));
+  TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+      "graph", "/device:CPU:0", "op_b", 0, TensorDebugMode::FULL_TENSOR,
+      non_finite));
+  TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+      "graph", "/device:CPU:0", "op_c", 0, TensorDebugMode::CURT_HEALTH,
+      healthy));
+  TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+      "graph", "/device:CPU:0", "op_d", 0, TensorDebugMode::CURT_HEALTH,
+      unhealthy));
+  TF_ASSERT_OK(writer->FlushExecutionFiles());
+  ReadDebugEventProtos(writer, DebugEventFileType::GRAPH_EXECUTION_TRACES,
+                       &actuals);
+  ASSERT_EQ(actuals.size(), 5);
+  EXPECT_EQ(actuals[3].graph_execution_trace().op_name(), "op_b");
+  EXPECT_EQ(actuals[4].graph_execution_trace().op_name(), "op_d");
+
+  writer->SetSamplingPolicy(DebugEventsWriter::SamplingPolicy());
+  TF_ASSERT_OK(writer->Close());
+}
+
 }  // namespace tfdbg
 }  // namespace tensorflow
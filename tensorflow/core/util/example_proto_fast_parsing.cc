@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -117,6 +119,62 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Returns the number of varints that end in [begin, end), i.e. the number of
+// bytes without continuation bit, eight bytes at a time.
+size_t CountVarints(const uint8* begin, const uint8* end) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  size_t num_continuation_bytes = 0;
+  const uint8* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    memcpy(&word, p, sizeof(word));
+    // Sums the continuation bits of the eight bytes in the top byte.
+    num_continuation_bytes +=
+        (((word & kContinuationBits) >> 7) * 0x0101010101010101ULL) >> 56;
+  }
+  for (; p < end; ++p) {
+    num_continuation_bytes += *p >> 7;
+  }
+  return (end - begin) - num_continuation_bytes;
+}
+
+// Decodes the varints in [begin, end) as by CodedInputStream::ReadVarint64(),
+// storing the first "capacity" of them in "values". Runs of eight single byte
+// varints are decoded without branching on each byte. Returns false if a
+// varint is longer than ten bytes or truncated.
+bool DecodePackedVarints(const uint8* begin, const uint8* end, int64_t* values,
+                         size_t capacity) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  constexpr int kMaxVarintBytes = 10;
+  size_t index = 0;
+  const uint8* p = begin;
+  while (p < end) {
+    if (end - p >= 8 && index + 8 <= capacity) {
+      uint64 word;
+      memcpy(&word, p, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          values[index + i] = p[i];
+        }
+        index += 8;
+        p += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    int i = 0;
+    for (;; ++i) {
+      if (i == kMaxVarintBytes || p + i == end) return false;
+      value |= static_cast<uint64>(p[i] & 0x7f) << (7 * i);
+      if (p[i] < 0x80) break;
+    }
+    p += i + 1;
+    if (index < capacity) values[index] = static_cast<int64_t>(value);
+    ++index;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -181,8 +239,10 @@ class Feature {
     return &bytes_list->emplace_back();
   }
 
+  // If "as_views" is true, the parsed strings are views into the serialized
+  // feature instead of copies.
   template <typename Result>
-  bool ParseBytesList(Result* bytes_list) {
+  bool ParseBytesList(Result* bytes_list, bool as_views = false) {
     DCHECK(bytes_list != nullptr);
 
     protobuf::io::CodedInputStream stream(
@@ -201,8 +261,14 @@ class Feature {
       if (!stream.ReadVarint32(&bytes_length)) return false;
       tstring* bytes = construct_at_end(bytes_list);
       if (bytes == nullptr) return false;
-      bytes->resize_uninitialized(bytes_length);
-      if (!stream.ReadRaw(bytes->data(), bytes_length)) return false;
+      if (as_views) {
+        bytes->assign_as_view(serialized_.data() + stream.CurrentPosition(),
+                              bytes_length);
+        if (!stream.Skip(bytes_length)) return false;
+      } else {
+        bytes->resize_uninitialized(bytes_length);
+        if (!stream.ReadRaw(bytes->data(), bytes_length)) return false;
+      }
     }
     stream.PopLimit(limit);
     return true;
@@ -305,10 +371,31 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        // The stream reads from a flat array, so all packed values are in its
+        // buffer. Counting them first resizes the output only once.
+        const void* packed_data;
+        int packed_size;
+        if (stream.GetDirectBufferPointer(&packed_data, &packed_size) &&
+            packed_size == packed_length) {
+          const uint8* begin = static_cast<const uint8*>(packed_data);
+          const uint8* end = begin + packed_size;
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size + CountVarints(begin, end));
+          // Less than the number of values if "int64_list" is a full
+          // LimitedArraySlice.
+          const size_t capacity = int64_list->size() - initial_size;
+          if (!DecodePackedVarints(begin, end,
+                                   int64_list->data() + initial_size,
+                                   capacity)) {
+            return false;
+          }
+          stream.Skip(packed_size);
+        } else {
+          while (!stream.ExpectAtEnd()) {
+            protobuf_uint64 n;  // There is no API for int64
+            if (!stream.ReadVarint64(&n)) return false;
+            int64_list->push_back(static_cast<int64_t>(n));
+          }
         }
 
         stream.PopLimit(packed_limit);
@@ -565,6 +652,29 @@ struct SeededHasher {
   uint64 seed{0xDECAFCAFFE};
 };
 
+// Reserves room in "buffer" for the values of "num_examples" examples of
+// "dtype", assuming "values_per_example" values per example.
+void ReserveSparseBuffer(DataType dtype, float values_per_example,
+                         size_t num_examples, SparseBuffer* buffer) {
+  if (values_per_example <= 0) return;
+  const size_t num_values =
+      static_cast<size_t>(std::ceil(values_per_example * num_examples));
+  buffer->example_end_indices.reserve(num_examples);
+  switch (dtype) {
+    case DT_INT64:
+      buffer->int64_list.reserve(num_values);
+      break;
+    case DT_FLOAT:
+      buffer->float_list.reserve(num_values);
+      break;
+    case DT_STRING:
+      buffer->bytes_list.reserve(num_values);
+      break;
+    default:
+      break;
+  }
+}
+
 void LogDenseFeatureDataLoss(StringPiece feature_name) {
   LOG(WARNING) << "Data loss! Feature '" << feature_name
                << "' is present in multiple concatenated "
@@ -719,7 +829,9 @@ Status FastParseSerializedExample(
           case DT_STRING: {
             auto out_p = out.flat<tstring>().data() + offset;
             LimitedArraySlice<tstring> slice(out_p, num_elements);
-            if (!feature.ParseBytesList(&slice)) return parse_error();
+            if (!feature.ParseBytesList(&slice, config.bytes_as_views)) {
+              return parse_error();
+            }
             if (slice.EndDistance() != 0) {
               return shape_error(num_elements - slice.EndDistance(), "bytes");
             }
@@ -775,7 +887,8 @@ Status FastParseSerializedExample(
           }
           case DT_STRING: {
             if (example_dtype != DT_INVALID) {
-              if (!feature.ParseBytesList(&out.bytes_list)) {
+              if (!feature.ParseBytesList(&out.bytes_list,
+                                          config.bytes_as_views)) {
                 return parse_error();
               }
               if (out.bytes_list.size() % num_elements != 0) {
@@ -851,7 +964,8 @@ Status FastParseSerializedExample(
         }
         case DT_STRING: {
           if (example_dtype != DT_INVALID) {
-            if (!feature.ParseBytesList(&out.bytes_list)) {
+            if (!feature.ParseBytesList(&out.bytes_list,
+                                        config.bytes_as_views)) {
               return parse_error();
             }
           }
@@ -1212,16 +1326,28 @@ Status FastParseExample(const Config& config,
                             std::min<size_t>(max_minibatches, result));
   }();
 
+  // Split the examples into minibatches of about the same number of bytes
+  // rather than of examples, so that a few large examples do not leave most
+  // threads idle. "bytes_before[i]" is the cost of the examples before i.
+  std::vector<size_t> bytes_before(serialized.size() + 1, 0);
+  for (size_t i = 0; i < serialized.size(); ++i) {
+    bytes_before[i + 1] = bytes_before[i] + serialized[i].size() + 1;
+  }
+  std::vector<size_t> first_example(num_minibatches + 1, serialized.size());
+  for (size_t minibatch = 0; minibatch < num_minibatches; ++minibatch) {
+    const size_t target = bytes_before.back() * minibatch / num_minibatches;
+    first_example[minibatch] =
+        std::lower_bound(bytes_before.begin(), bytes_before.end(), target) -
+        bytes_before.begin();
+  }
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
-    return (serialized.size() * minibatch) / num_minibatches;
+    return first_example[minibatch];
   };
 
-  // TODO(lew): A big performance low-hanging fruit here is to improve
-  //   num_minibatches calculation to take into account actual amount of work
-  //   needed, as the size in bytes is not perfect. Linear combination of
-  //   size in bytes and average number of features per example is promising.
-  //   Even better: measure time instead of estimating, but this is too costly
-  //   in small batches.
+  // TODO(lew): The size in bytes is not a perfect measure of the amount of
+  //   work needed. Linear combination of size in bytes and average number of
+  //   features per example is promising. Even better: measure time instead of
+  //   estimating, but this is too costly in small batches.
   //   Maybe accept outside parameter #num_minibatches?
 
   // Do minibatches in parallel.
@@ -1235,6 +1361,16 @@ Status FastParseExample(const Config& config,
     ragged_buffers[minibatch].resize(config.ragged.size());
     size_t start = first_example_of_minibatch(minibatch);
     size_t end = first_example_of_minibatch(minibatch + 1);
+    for (size_t d = 0; d < config.sparse.size(); ++d) {
+      ReserveSparseBuffer(config.sparse[d].dtype,
+                          config.sparse[d].values_per_example_hint, end - start,
+                          &sparse_buffers[minibatch][d]);
+    }
+    for (size_t d = 0; d < config.ragged.size(); ++d) {
+      ReserveSparseBuffer(config.ragged[d].dtype,
+                          config.ragged[d].values_per_example_hint, end - start,
+                          &ragged_buffers[minibatch][d]);
+    }
     for (size_t e = start; e < end; ++e) {
       PerExampleFeatureStats* stats = nullptr;
       if (config.collect_feature_stats) {
@@ -1633,7 +1769,9 @@ Status FastParseSingleExample(const Config& config, StringPiece serialized,
         case DT_STRING: {
           auto out_p = out->flat<tstring>().data();
           LimitedArraySlice<tstring> slice(out_p, num_elements);
-          if (!feature.ParseBytesList(&slice)) return parse_error();
+          if (!feature.ParseBytesList(&slice, config.bytes_as_views)) {
+            return parse_error();
+          }
           if (slice.EndDistance() != 0) {
             return parse_error();
           }
@@ -1708,7 +1846,9 @@ Status FastParseSingleExample(const Config& config, StringPiece serialized,
             return parse_error();
           }
           bytes_list.reserve(actual_num_elements);
-          if (!feature.ParseBytesList(&bytes_list)) return parse_error();
+          if (!feature.ParseBytesList(&bytes_list, config.bytes_as_views)) {
+            return parse_error();
+          }
           num_elements = bytes_list.size();
           break;
         }
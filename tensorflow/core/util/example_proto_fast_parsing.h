@@ -74,6 +74,9 @@ struct FastParseExampleConfig {
 
     tstring feature_name;
     DataType dtype;
+    // If positive, an estimate of the number of values per example, used to
+    // reserve the intermediate buffers instead of growing them while parsing.
+    float values_per_example_hint = 0;
   };
 
   struct Ragged {
@@ -87,6 +90,8 @@ struct FastParseExampleConfig {
     tstring feature_name;
     DataType dtype;
     DataType splits_dtype;
+    // As for `Sparse`.
+    float values_per_example_hint = 0;
   };
 
   std::vector<Dense> dense;
@@ -96,6 +101,12 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // If `true`, the parsed `bytes_list` values are `tstring` views into the
+  // serialized examples instead of copies, so the serialized examples must
+  // outlive the string tensors of the `Result`. Copies of a view are views
+  // too. Only `FastParseExample` and `FastParseSingleExample` support views.
+  bool bytes_as_views = false;
 };
 
 // Statistics about the features in each example passed to
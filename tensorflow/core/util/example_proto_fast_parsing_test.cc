@@ -15,14 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -172,6 +177,25 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64Varints) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  // Runs of single byte varints, and varints of every length.
+  for (int i = 0; i < 20; ++i) {
+    int64_list->add_value(i);
+  }
+  for (int shift = 0; shift < 64; shift += 7) {
+    int64_list->add_value(int64_t{1} << shift);
+    int64_list->add_value(shift);
+  }
+  int64_list->add_value(-1);
+  int64_list->add_value(std::numeric_limits<int64_t>::min());
+  int64_list->add_value(std::numeric_limits<int64_t>::max());
+  TestCorrectness(Serialize(example));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -419,6 +443,132 @@ TEST(FastParse, FuzzTest) {
   }
 }
 
+TEST(TestFastParseExample, SkewedExampleSizes) {
+  // One example is much larger than all others together, so that some
+  // minibatches are empty.
+  constexpr int kNumExamples = 20;
+  constexpr int kLargeExample = 3;
+  constexpr int kLargeExampleValues = 10000;
+  std::vector<tstring> serialized;
+  for (int i = 0; i < kNumExamples; ++i) {
+    Example example;
+    Int64List* int64_list =
+        (*example.mutable_features()->mutable_feature())["int64_list"]
+            .mutable_int64_list();
+    const int num_values = i == kLargeExample ? kLargeExampleValues : 1;
+    for (int j = 0; j < num_values; ++j) {
+      int64_list->add_value(i);
+    }
+    serialized.push_back(Serialize(example));
+  }
+  FastParseExampleConfig config;
+  AddSparseFeature("int64_list", DT_INT64, &config);
+
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, &thread_pool, &result));
+  ASSERT_EQ(result.sparse_indices.size(), 1);
+  const auto indices = result.sparse_indices[0].matrix<int64_t>();
+  const auto values = result.sparse_values[0].vec<int64_t>();
+  ASSERT_EQ(values.size(), kNumExamples - 1 + kLargeExampleValues);
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(indices(i, 0), values(i));
+  }
+  EXPECT_EQ(result.sparse_shapes[0].vec<int64_t>()(1), kLargeExampleValues);
+}
+
+TEST(TestFastParseExample, ValuesPerExampleHints) {
+  // Examples with 0 to 3 values of each feature, 1.5 on average.
+  constexpr int kNumExamples = 20;
+  std::vector<tstring> serialized;
+  for (int i = 0; i < kNumExamples; ++i) {
+    Example example;
+    auto& features = *example.mutable_features()->mutable_feature();
+    for (int j = 0; j < i % 4; ++j) {
+      features["int64_list"].mutable_int64_list()->add_value(10 * i + j);
+      features["float_list"].mutable_float_list()->add_value(i + 0.5 * j);
+      features["bytes_list"].mutable_bytes_list()->add_value(
+          strings::StrCat(i, "_", j));
+      features["ragged_list"].mutable_int64_list()->add_value(10 * i + j);
+    }
+    serialized.push_back(Serialize(example));
+  }
+  auto make_config = [](float values_per_example_hint) {
+    FastParseExampleConfig config;
+    AddSparseFeature("int64_list", DT_INT64, &config);
+    AddSparseFeature("float_list", DT_FLOAT, &config);
+    AddSparseFeature("bytes_list", DT_STRING, &config);
+    for (auto& sparse : config.sparse) {
+      sparse.values_per_example_hint = values_per_example_hint;
+    }
+    config.ragged.push_back({"ragged_list", DT_INT64, DT_INT64});
+    config.ragged[0].values_per_example_hint = values_per_example_hint;
+    return config;
+  };
+
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Result expected;
+  TF_ASSERT_OK(FastParseExample(make_config(0), serialized, {}, &thread_pool,
+                                &expected));
+  ASSERT_EQ(expected.sparse_values.size(), 3);
+  ASSERT_EQ(expected.sparse_values[0].NumElements(), 30);
+  ASSERT_EQ(expected.ragged_values.size(), 1);
+  ASSERT_EQ(expected.ragged_values[0].NumElements(), 30);
+
+  // Hints below, at and above the actual number of values per example only
+  // change how the buffers are reserved, not the result.
+  for (float hint : {0.5f, 1.5f, 100.0f}) {
+    Result result;
+    TF_ASSERT_OK(FastParseExample(make_config(hint), serialized, {},
+                                  &thread_pool, &result));
+    ASSERT_EQ(result.sparse_values.size(), 3);
+    for (int d = 0; d < 3; ++d) {
+      test::ExpectTensorEqual<int64_t>(result.sparse_indices[d],
+                                       expected.sparse_indices[d]);
+      test::ExpectTensorEqual<int64_t>(result.sparse_shapes[d],
+                                       expected.sparse_shapes[d]);
+    }
+    test::ExpectTensorEqual<int64_t>(result.sparse_values[0],
+                                     expected.sparse_values[0]);
+    test::ExpectTensorEqual<float>(result.sparse_values[1],
+                                   expected.sparse_values[1]);
+    test::ExpectTensorEqual<tstring>(result.sparse_values[2],
+                                     expected.sparse_values[2]);
+    ASSERT_EQ(result.ragged_values.size(), 1);
+    test::ExpectTensorEqual<int64_t>(result.ragged_values[0],
+                                     expected.ragged_values[0]);
+    test::ExpectTensorEqual<int64_t>(result.ragged_splits[0],
+                                     expected.ragged_splits[0]);
+  }
+}
+
+TEST(TestFastParseExample, BytesAsViews) {
+  std::vector<tstring> serialized;
+  for (const char* value : {"first value", "second value"}) {
+    Example example;
+    (*example.mutable_features()->mutable_feature())["bytes_list"]
+        .mutable_bytes_list()
+        ->add_value(value);
+    serialized.push_back(Serialize(example));
+  }
+  FastParseExampleConfig config;
+  AddSparseFeature("bytes_list", DT_STRING, &config);
+  config.bytes_as_views = true;
+
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  const auto values = result.sparse_values[0].vec<tstring>();
+  ASSERT_EQ(values.size(), 2);
+  EXPECT_EQ(values(0), "first value");
+  EXPECT_EQ(values(1), "second value");
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(values(i).type(), tstring::VIEW);
+    EXPECT_GE(values(i).data(), serialized[i].data());
+    EXPECT_LE(values(i).data() + values(i).size(),
+              serialized[i].data() + serialized[i].size());
+  }
+}
+
 TEST(TestFastParseExample, Empty) {
   Result result;
   FastParseExampleConfig config;
@@ -15,11 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/matmul_autotune.h"
 
+#include <atomic>
+
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+// Set by SetCpuMatmulAutotuneEnable: 0 or 1, or -1 to use the environment.
+std::atomic<int> cpu_matmul_autotune_enabled{-1};
+
+}  // namespace
+
 bool MatmulAutotuneEnable() {
   bool value;
   Status status =
@@ -30,6 +39,25 @@ bool MatmulAutotuneEnable() {
   return value;
 }
 
+bool CpuMatmulAutotuneEnable() {
+  const int enabled =
+      cpu_matmul_autotune_enabled.load(std::memory_order_relaxed);
+  if (enabled >= 0) {
+    return enabled;
+  }
+  bool value;
+  Status status =
+      ReadBoolFromEnvVar("TF_CPU_MATMUL_AUTOTUNE_ENABLE", false, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status.message();
+  }
+  return value;
+}
+
+void SetCpuMatmulAutotuneEnable(bool enabled) {
+  cpu_matmul_autotune_enabled.store(enabled, std::memory_order_relaxed);
+}
+
 bool MatmulDoFP32ComputationFP16Input() {
   bool value;
   // Feedback from NVIDIA: the "true floating point 16" compute capability is
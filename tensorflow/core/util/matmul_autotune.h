@@ -21,6 +21,12 @@ limitations under the License.
 namespace tensorflow {
 
 bool MatmulAutotuneEnable();
+// Whether the CPU MatMul and BatchMatMul kernels time their implementations
+// on each new shape and keep the fastest, in CpuMatmulAutotuneMap. Reads
+// TF_CPU_MATMUL_AUTOTUNE_ENABLE unless SetCpuMatmulAutotuneEnable was called.
+bool CpuMatmulAutotuneEnable();
+// Overrides TF_CPU_MATMUL_AUTOTUNE_ENABLE for the kernels run after this call.
+void SetCpuMatmulAutotuneEnable(bool enabled);
 bool MatmulDoFP32ComputationFP16Input();
 
 }  // namespace tensorflow
@@ -42,13 +42,19 @@ namespace {
 
 class ReadOnlyMemoryRegionFromMemmapped : public ReadOnlyMemoryRegion {
  public:
-  ReadOnlyMemoryRegionFromMemmapped(const void* data, uint64 length)
-      : data_(data), length_(length) {}
+  ReadOnlyMemoryRegionFromMemmapped(
+      std::shared_ptr<ReadOnlyMemoryRegion> mapped_memory, const void* data,
+      uint64 length)
+      : mapped_memory_(std::move(mapped_memory)),
+        data_(data),
+        length_(length) {}
   ~ReadOnlyMemoryRegionFromMemmapped() override = default;
   const void* data() override { return data_; }
   uint64 length() override { return length_; }
 
  private:
+  // Keeps the whole package mapped while the region is alive.
+  const std::shared_ptr<ReadOnlyMemoryRegion> mapped_memory_;
   const void* const data_;
   const uint64 length_;
   // intentionally copyable
@@ -130,7 +136,7 @@ Status MemmappedFileSystem::NewReadOnlyMemoryRegionFromFile(
     return errors::NotFound("Region ", filename, " is not found");
   }
   *result = std::make_unique<ReadOnlyMemoryRegionFromMemmapped>(
-      GetMemoryWithOffset(dir_element->second.offset),
+      mapped_memory_, GetMemoryWithOffset(dir_element->second.offset),
       dir_element->second.length);
   return absl::OkStatus();
 }
@@ -213,8 +219,10 @@ constexpr const char MemmappedFileSystem::kMemmappedPackageDefaultGraphDef[];
 
 Status MemmappedFileSystem::InitializeFromFile(Env* env,
                                                const string& filename) {
+  std::unique_ptr<ReadOnlyMemoryRegion> mapped_memory;
   TF_RETURN_IF_ERROR(
-      env->NewReadOnlyMemoryRegionFromFile(filename, &mapped_memory_));
+      env->NewReadOnlyMemoryRegionFromFile(filename, &mapped_memory));
+  mapped_memory_ = std::move(mapped_memory);
   directory_.clear();
   if (mapped_memory_->length() <= sizeof(uint64)) {
     return errors::DataLoss("Corrupted memmapped model file: ", filename,
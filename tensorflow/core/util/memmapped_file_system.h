@@ -115,7 +115,10 @@ class MemmappedFileSystem : public FileSystem {
 
   const void* GetMemoryWithOffset(uint64 offset) const;
 
-  std::unique_ptr<ReadOnlyMemoryRegion> mapped_memory_;
+  // Shared with the regions returned by NewReadOnlyMemoryRegionFromFile, so
+  // that the package stays mapped while any of them, e.g. a tensor buffer of
+  // ImmutableConst, is alive.
+  std::shared_ptr<ReadOnlyMemoryRegion> mapped_memory_;
   DirectoryType directory_;
 
   MemmappedFileSystem(const MemmappedFileSystem&) = delete;
@@ -15,14 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -54,6 +60,7 @@ limitations under the License.
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_slice_util.h"
+#include "tsl/framework/metrics.h"
 #include "tsl/lib/io/buffered_file.h"
 
 #ifdef PLATFORM_WINDOWS
@@ -223,6 +230,30 @@ Status ReadVariantTensor(io::InputBuffer* buffered_file, Tensor* ret,
   return absl::OkStatus();
 }
 
+// A read-only tensor buffer pointing into a memory mapped data file.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+  // Never forward the buffer to an op output, as it is read-only.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  // Keeps the mapping alive.
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 char* GetBackingBuffer(const Tensor& val) {
   CHECK(DataTypeCanUseMemcpy(val.dtype())) << val.dtype();
   return const_cast<char*>(val.tensor_data().data());
@@ -767,8 +798,167 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
   return status;
 }
 
+// Writing sharded tensor bundles in parallel.
+
+ParallelBundleWriter::ParallelBundleWriter(Env* env, StringPiece prefix,
+                                           const Options& options)
+    : env_(env), prefix_(prefix) {
+  if (options.num_shards < 1) {
+    status_ = errors::InvalidArgument("num_shards must be >= 1, got ",
+                                      options.num_shards);
+    return;
+  }
+  BundleWriter::Options writer_options;
+  writer_options.data_alignment = options.data_alignment;
+  const uint64 id = random::New64();
+  shards_.resize(options.num_shards);
+  for (int i = 0; i < options.num_shards; ++i) {
+    Shard& shard = shards_[i];
+    shard.prefix = strings::StrCat(prefix_, "_temp_", id, "_part_", i);
+    shard.writer =
+        std::make_unique<BundleWriter>(env_, shard.prefix, writer_options);
+    status_ = shard.writer->status();
+    if (!status_.ok()) return;
+    shard.thread = std::make_unique<thread::ThreadPool>(
+        env_, "parallel_bundle_writer", /*num_threads=*/1);
+  }
+}
+
+Status ParallelBundleWriter::Schedule(
+    const std::string& key, const Tensor& val,
+    std::function<void(BundleWriter*)> write) {
+  if (!status_.ok()) return status_;
+  if (!keys_.insert(key).second) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+  Shard* shard = &*absl::c_min_element(
+      shards_, [](const Shard& a, const Shard& b) {
+        return a.num_bytes < b.num_bytes;
+      });
+  shard->num_bytes += val.TotalBytes();
+  // BundleWriter keeps the first error, which Finish() then reports.
+  BundleWriter* writer = shard->writer.get();
+  shard->thread->Schedule(
+      [writer, write = std::move(write)]() { write(writer); });
+  return absl::OkStatus();
+}
+
+Status ParallelBundleWriter::Add(StringPiece key, const Tensor& val) {
+  const string key_string(key);
+  return Schedule(key_string, val, [key_string, val](BundleWriter* writer) {
+    writer->Add(key_string, val).IgnoreError();
+  });
+}
+
+Status ParallelBundleWriter::AddSlice(StringPiece full_tensor_key,
+                                      const TensorShape& full_tensor_shape,
+                                      const TensorSlice& slice_spec,
+                                      const Tensor& slice_tensor) {
+  if (IsFullSlice(slice_spec, full_tensor_shape)) {
+    return Add(full_tensor_key, slice_tensor);
+  }
+  const string full_tensor_key_string(full_tensor_key);
+  // Slices of the same tensor may land on different shards, MergeBundles()
+  // later merges their full tensor entries.
+  return Schedule(
+      checkpoint::EncodeTensorNameSlice(full_tensor_key_string, slice_spec),
+      slice_tensor,
+      [full_tensor_key_string, full_tensor_shape, slice_spec,
+       slice_tensor](BundleWriter* writer) {
+        writer
+            ->AddSlice(full_tensor_key_string, full_tensor_shape, slice_spec,
+                       slice_tensor)
+            .IgnoreError();
+      });
+}
+
+Status ParallelBundleWriter::Finish() {
+  if (!status_.ok()) return status_;
+  std::vector<Status> statuses(shards_.size());
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    BundleWriter* writer = shards_[i].writer.get();
+    Status* status = &statuses[i];
+    shards_[i].thread->Schedule(
+        [writer, status]() { *status = writer->Finish(); });
+  }
+  // Waits for all shards.
+  for (Shard& shard : shards_) shard.thread.reset();
+
+  std::vector<tstring> prefixes;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    status_.Update(statuses[i]);
+    prefixes.push_back(shards_[i].prefix);
+  }
+  if (status_.ok()) status_ = MergeBundles(env_, prefixes, prefix_);
+  if (!status_.ok()) {
+    // Best effort cleanup of the shards that were written.
+    for (const tstring& prefix : prefixes) {
+      env_->DeleteFile(DataFilename(prefix, 0, 1)).IgnoreError();
+      env_->DeleteFile(MetaFilename(prefix)).IgnoreError();
+    }
+    return status_;
+  }
+  status_ = errors::Internal("ParallelBundleWriter is closed");
+  return absl::OkStatus();
+}
+
 // Interface for reading a tensor bundle.
 
+// The keys and values of a metadata table, stored back to back in key order.
+class BundleReader::InMemoryIndex {
+ public:
+  // Reads all entries of the table through "iter".
+  Status Load(table::Iterator* iter) {
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      keys_.append(iter->key().data(), iter->key().size());
+      key_ends_.push_back(keys_.size());
+      values_.append(iter->value().data(), iter->value().size());
+      value_ends_.push_back(values_.size());
+    }
+    TF_RETURN_IF_ERROR(iter->status());
+    keys_.shrink_to_fit();
+    key_ends_.shrink_to_fit();
+    values_.shrink_to_fit();
+    value_ends_.shrink_to_fit();
+    return absl::OkStatus();
+  }
+
+  // Returns the value of "key", or nullopt if there is none.
+  std::optional<StringPiece> Find(StringPiece key) const {
+    size_t begin = 0;
+    size_t end = key_ends_.size();
+    while (begin < end) {
+      const size_t mid = begin + (end - begin) / 2;
+      if (this->key(mid) < key) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    if (begin == key_ends_.size() || this->key(begin) != key) {
+      return std::nullopt;
+    }
+    return value(begin);
+  }
+
+ private:
+  StringPiece key(size_t i) const {
+    const uint64_t begin = i == 0 ? 0 : key_ends_[i - 1];
+    return StringPiece(keys_.data() + begin, key_ends_[i] - begin);
+  }
+  StringPiece value(size_t i) const {
+    const uint64_t begin = i == 0 ? 0 : value_ends_[i - 1];
+    return StringPiece(values_.data() + begin, value_ends_[i] - begin);
+  }
+
+  // The concatenated keys and values, and the end offset of each of them.
+  std::string keys_;
+  std::vector<uint64_t> key_ends_;
+  std::string values_;
+  std::vector<uint64_t> value_ends_;
+};
+
 BundleReader::BundleReader(
     Env* env, StringPiece prefix,
     bool enable_multi_threading_for_testing /* = false */)
@@ -785,7 +975,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
       iter_(nullptr),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
-          options.enable_multi_threading_for_testing) {
+          options.enable_multi_threading_for_testing),
+      use_mmap_(options.use_mmap),
+      validate_mmap_checksums_(options.validate_mmap_checksums) {
   if (cache_ == nullptr) {
     // Make a cache for use just by this BundleReader.
     owned_cache_ = std::make_unique<BundleCache>(env);
@@ -808,7 +1000,18 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
   Status s =
       ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_SIZE_IN_MB", 0, &cache_size);
   if (s.ok() && cache_size > 0) {
-    index_cache_ = table::NewLRUCache(cache_size << 20);
+    // Concurrent restores look up the index blocks from many threads, and
+    // scans over the index (e.g. to read all shapes) should not evict the
+    // blocks of the tensors being restored.
+    table::LRUCacheOptions cache_options;
+    int64_t num_shard_bits;
+    s = ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_NUM_SHARD_BITS",
+                            cache_options.num_shard_bits, &num_shard_bits);
+    if (s.ok()) cache_options.num_shard_bits = num_shard_bits;
+    s = ReadBoolFromEnvVar("TF_TABLE_INDEX_CACHE_SCAN_RESISTANT", false,
+                           &cache_options.scan_resistant);
+    if (!s.ok()) cache_options.scan_resistant = false;
+    index_cache_ = table::NewLRUCache(cache_size << 20, cache_options);
     o.block_cache = index_cache_;
   }
 
@@ -837,6 +1040,15 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok() || !options.in_memory_index) return;
+
+  // Uses its own iterator, so that the position of "iter_" is unaffected.
+  std::unique_ptr<table::Iterator> index_iter(table_->NewIterator());
+  index_ = std::make_unique<InMemoryIndex>();
+  status_ = index_->Load(index_iter.get());
+  if (!status_.ok()) {
+    status_ = CorruptFileError(status_, filename, "unable to read the index");
+  }
 }
 
 BundleReader::~BundleReader() {
@@ -844,6 +1056,11 @@ BundleReader::~BundleReader() {
   delete iter_;
   delete table_;
   if (index_cache_) {
+    const table::Cache::Stats stats = index_cache_->GetStats();
+    tsl::metrics::UpdateBundleIndexCacheStats(stats.hits, stats.misses);
+    VLOG(1) << "Index cache of bundle " << prefix_ << ": " << stats.hits
+            << " hits, " << stats.misses << " misses, " << stats.evictions
+            << " evictions";
     delete index_cache_;
   }
   for (auto& temp : data_) {
@@ -860,14 +1077,23 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
-  Seek(key);
-  if (!iter_->Valid() || iter_->key() != key) {
-    return errors::NotFound("Key ", key, " not found in checkpoint");
+  StringPiece value;
+  if (index_ != nullptr) {
+    std::optional<StringPiece> found = index_->Find(key);
+    if (!found.has_value()) {
+      return errors::NotFound("Key ", key, " not found in checkpoint");
+    }
+    value = *found;
+  } else {
+    Seek(key);
+    if (!iter_->Valid() || iter_->key() != key) {
+      return errors::NotFound("Key ", key, " not found in checkpoint");
+    }
+    value = iter_->value();
   }
 
   BundleEntryProto entry_copy;
-  TF_RETURN_IF_ERROR(
-      ParseEntryProto(iter_->key(), iter_->value(), &entry_copy));
+  TF_RETURN_IF_ERROR(ParseEntryProto(key, value, &entry_copy));
   if (!TensorShape::IsValid(entry_copy.shape())) {
     return errors::DataLoss("Invalid tensor shape: ", key, " ",
                             entry_copy.shape().ShortDebugString());
@@ -877,7 +1103,71 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return absl::OkStatus();
 }
 
-Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+Status BundleReader::GetMappedValue(StringPiece key,
+                                    const BundleEntryProto& entry, Tensor* val,
+                                    bool* mapped) {
+  *mapped = false;
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!s.ok()) {
+      VLOG(1) << "Not memory mapping " << filename << ": " << s;
+      region = nullptr;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  if (it->second == nullptr) return absl::OkStatus();
+
+  const ReadOnlyMemoryRegion& region = *it->second;
+  if (entry.offset() + entry.size() > region.length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " is truncated: tensor ends at ",
+                            entry.offset() + entry.size(), " but file has ",
+                            region.length(), " bytes");
+  }
+  const char* data = static_cast<const char*>(region.data()) + entry.offset();
+  const TensorShape stored_shape(entry.shape());
+  if (stored_shape.num_elements() * DataTypeSize(entry.dtype()) !=
+      entry.size()) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ",
+                            stored_shape.num_elements() *
+                                DataTypeSize(entry.dtype()));
+  }
+  if (validate_mmap_checksums_) {
+    const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+  }
+
+  auto* buf = new MappedTensorBuffer(it->second, data, entry.size());
+  Tensor mapped_tensor(entry.dtype(), stored_shape, buf);
+  buf->Unref();
+  // Kernels expect tensor data to be aligned.
+  if (!mapped_tensor.IsAligned()) return absl::OkStatus();
+  *val = std::move(mapped_tensor);
+  *mapped = true;
+  return absl::OkStatus();
+}
+
+Status BundleReader::GetValue(StringPiece key, const BundleEntryProto& entry,
+                              Tensor* val) {
+  if (use_mmap_ && val->NumElements() == 0 &&
+      DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_) {
+    bool mapped;
+    TF_RETURN_IF_ERROR(GetMappedValue(key, entry, val, &mapped));
+    if (mapped) return absl::OkStatus();
+  }
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -887,7 +1177,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   // Validates the "size" field.
   if (entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
     if (entry.size() != ret->TotalBytes()) {
-      return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
                               "; stored size ", entry.size(),
                               "; expected size ", ret->TotalBytes());
     }
@@ -900,7 +1190,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     const size_t lower_bound = ret->NumElements() + ret->TotalBytes() -
                                sizeof(tstring) * ret->NumElements();
     if (entry.size() < lower_bound) {
-      return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
                               "; stored size ", entry.size(),
                               "; expected size is at least ", lower_bound);
     }
@@ -1025,7 +1315,7 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
 
   if (entry.slices().empty()) {
-    return GetValue(entry, val);
+    return GetValue(key, entry, val);
   } else {
     return GetSliceValue(
         key, entry,
@@ -1033,6 +1323,152 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMany(absl::Span<const StringPiece> keys,
+                                absl::Span<Tensor* const> vals,
+                                const LookupManyOptions& options) {
+  if (keys.size() != vals.size()) {
+    return errors::InvalidArgument("LookupMany got ", keys.size(),
+                                   " keys but ", vals.size(), " tensors");
+  }
+  std::vector<BundleEntryProto> entries(keys.size());
+  // Indices of the tensors that are restored with parallel reads.
+  std::vector<size_t> parallel;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entries[i]));
+    if (entries[i].slices().empty() &&
+        DataTypeCanUseMemcpy(entries[i].dtype())) {
+      parallel.push_back(i);
+      continue;
+    }
+    // Strings, variants and partitioned tensors need many small dependent
+    // reads, which InputBuffer handles well.
+    if (entries[i].slices().empty()) {
+      TF_RETURN_IF_ERROR(GetValue(keys[i], entries[i], vals[i]));
+    } else {
+      TF_RETURN_IF_ERROR(GetSliceValue(
+          keys[i], entries[i],
+          /* a full slice */
+          TensorSlice(TensorShape(entries[i].shape()).dims()), vals[i]));
+    }
+    if (options.done_callback) options.done_callback(i);
+  }
+  absl::c_sort(parallel, [&entries](size_t a, size_t b) {
+    if (entries[a].shard_id() != entries[b].shard_id()) {
+      return entries[a].shard_id() < entries[b].shard_id();
+    }
+    return entries[a].offset() < entries[b].offset();
+  });
+
+  struct PendingTensor {
+    size_t index;
+    RandomAccessFile* file;  // Owned by cache_.
+    char* buffer;
+    // The reads of this tensor are reads[first_read, first_read + num_reads).
+    size_t first_read;
+    size_t num_reads;
+    std::atomic<size_t> num_pending_reads;
+  };
+  struct Read {
+    size_t tensor;  // Index into "tensors".
+    int64_t offset;  // Relative to the start of the tensor.
+    int64_t size;
+  };
+  std::vector<PendingTensor> tensors(parallel.size());
+  std::vector<Read> reads;
+  const int64_t max_read_size = std::max<int64_t>(options.max_read_size, 1);
+  for (size_t t = 0; t < parallel.size(); ++t) {
+    const size_t i = parallel[t];
+    const BundleEntryProto& entry = entries[i];
+    Tensor* val = vals[i];
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
+    if (entry.size() != val->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", val->TotalBytes());
+    }
+    PendingTensor& tensor = tensors[t];
+    tensor.index = i;
+    TF_RETURN_IF_ERROR(cache_->GetFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &tensor.file));
+    tensor.buffer = GetBackingBuffer(*val);
+    tensor.first_read = reads.size();
+    for (int64_t offset = 0; offset < entry.size(); offset += max_read_size) {
+      reads.push_back(
+          {t, offset, std::min<int64_t>(max_read_size, entry.size() - offset)});
+    }
+    tensor.num_reads = reads.size() - tensor.first_read;
+    tensor.num_pending_reads = tensor.num_reads;
+  }
+
+  std::vector<Status> read_statuses(reads.size());
+  std::vector<Status> tensor_statuses(tensors.size());
+  // Validates the checksum of a tensor once all its reads are done.
+  auto finish_tensor = [&](size_t t) {
+    const PendingTensor& tensor = tensors[t];
+    const BundleEntryProto& entry = entries[tensor.index];
+    for (size_t r = tensor.first_read; r < tensor.first_read + tensor.num_reads;
+         ++r) {
+      if (!read_statuses[r].ok()) {
+        tensor_statuses[t] = read_statuses[r];
+        return;
+      }
+    }
+    // As in GetValue(), the checksum is on the bytes in file order.
+    const uint32 actual_crc32c = crc32c::Value(tensor.buffer, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      tensor_statuses[t] = errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+      return;
+    }
+    if (need_to_swap_bytes_) {
+      tensor_statuses[t] = ByteSwapTensor(vals[tensor.index]);
+      if (!tensor_statuses[t].ok()) return;
+    }
+    if (options.done_callback) options.done_callback(tensor.index);
+  };
+
+  for (size_t t = 0; t < tensors.size(); ++t) {
+    if (tensors[t].num_reads == 0) finish_tensor(t);
+  }
+  if (!reads.empty()) {
+    thread::ThreadPool reader_pool(
+        env_, "bundle_lookup_many",
+        std::clamp<int64_t>(options.num_threads, 1, reads.size()));
+    // Reads are scheduled in file order, so each shard is mostly read
+    // sequentially while all shards are read concurrently.
+    for (size_t r = 0; r < reads.size(); ++r) {
+      reader_pool.Schedule([&, r]() {
+        const Read& read = reads[r];
+        PendingTensor& tensor = tensors[read.tensor];
+        const BundleEntryProto& entry = entries[tensor.index];
+        char* dst = tensor.buffer + read.offset;
+        StringPiece sp;
+        Status status = tensor.file->Read(entry.offset() + read.offset,
+                                          read.size, &sp, dst);
+        if (status.ok() && sp.data() != dst) {
+          memmove(dst, sp.data(), read.size);
+        }
+        read_statuses[r] = std::move(status);
+        if (tensor.num_pending_reads.fetch_sub(1) == 1) {
+          finish_tensor(read.tensor);
+        }
+      });
+    }
+    // The destructor of reader_pool waits for all reads to finish.
+  }
+
+  for (const Status& status : tensor_statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1043,7 +1479,7 @@ Status BundleReader::ReadCurrent(Tensor* val) {
   }
 
   if (entry.slices().empty()) {
-    return GetValue(entry, val);
+    return GetValue(iter_->key(), entry, val);
   } else {
     return GetSliceValue(
         iter_->key(), entry,
@@ -1119,12 +1555,11 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 
     // We already have the entry for the full tensor, so don't query again if
     // the slice is full.
+    string stored_slice_key = full_tensor_key_string;
     if (!stored_slice.IsFull()) {
-      const string encoded_stored_slice_name =
-          checkpoint::EncodeTensorNameSlice(full_tensor_key_string,
-                                            stored_slice);
-      status_ =
-          GetBundleEntryProto(encoded_stored_slice_name, &stored_slice_entry);
+      stored_slice_key = checkpoint::EncodeTensorNameSlice(
+          full_tensor_key_string, stored_slice);
+      status_ = GetBundleEntryProto(stored_slice_key, &stored_slice_entry);
       if (!status_.ok()) return status_;
     }
 
@@ -1145,12 +1580,13 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       VLOG(1) << "Optimized for common case: directly copying into "
                  "pre-allocated buffer; spec: "
               << slice_spec.DebugString();
-      status_ = GetValue(stored_slice_entry, val);
+      status_ = GetValue(stored_slice_key, stored_slice_entry, val);
       return status_;
     }
 
     Tensor stored_slice_tensor(stored_slice_entry.dtype(), stored_slice_shape);
-    status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
+    status_ = GetValue(stored_slice_key, stored_slice_entry,
+                       &stored_slice_tensor);
     if (!status_.ok()) return status_;
 
     // Copies the intersection over.
@@ -1189,6 +1625,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (index_ != nullptr) return index_->Find(key).has_value();
   Seek(key);
   return Valid() && (this->key() == key);
 }
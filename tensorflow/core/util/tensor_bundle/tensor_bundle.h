@@ -62,6 +62,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -70,11 +71,13 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
@@ -168,6 +171,63 @@ class BundleWriter {
   void operator=(const BundleWriter&) = delete;
 };
 
+// Writes a tensor bundle whose data is sharded across several data files, each
+// written by its own thread, so that saving scales with the available disk and
+// network bandwidth instead of the copy and checksum throughput of one thread.
+//
+// Each tensor goes to the shard with the fewest bytes so far. Add() and
+// AddSlice() only schedule the write: the tensor shares its buffer with the
+// writer and must not be modified until Finish() returns. Write errors are
+// reported by Finish(), which merges the shards into one bundle under
+// "prefix" (see MergeBundles()).
+//
+// All threads accessing the same ParallelBundleWriter must synchronize.
+class ParallelBundleWriter {
+ public:
+  struct Options {
+    Options() {}
+    // Number of data files, and of threads writing them. Must be >= 1.
+    int num_shards{4};
+    // Alignment, in bytes, for tensor data. See BundleWriter::Options.
+    int data_alignment{1};
+  };
+  ParallelBundleWriter(Env* env, absl::string_view prefix,
+                       const Options& options = Options());
+
+  // Same as BundleWriter::Add() and BundleWriter::AddSlice().
+  Status Add(absl::string_view key, const Tensor& val);
+  Status AddSlice(absl::string_view full_tensor_key,
+                  const TensorShape& full_tensor_shape,
+                  const TensorSlice& slice_spec, const Tensor& slice_tensor);
+
+  // Waits for all writes, then finishes and merges the shards.
+  Status Finish() TF_MUST_USE_RESULT;
+
+  Status status() const { return status_; }
+
+ private:
+  struct Shard {
+    std::string prefix;
+    std::unique_ptr<BundleWriter> writer;
+    // Runs the writes of this shard one at a time. Destroyed before "writer".
+    std::unique_ptr<thread::ThreadPool> thread;
+    int64_t num_bytes = 0;
+  };
+
+  // Schedules writing "val" under "key" on the least loaded shard.
+  Status Schedule(const std::string& key, const Tensor& val,
+                  std::function<void(BundleWriter*)> write);
+
+  Env* const env_;  // Not owned.
+  const std::string prefix_;
+  std::vector<Shard> shards_;
+  absl::flat_hash_set<std::string> keys_;
+  Status status_;
+
+  ParallelBundleWriter(const ParallelBundleWriter&) = delete;
+  void operator=(const ParallelBundleWriter&) = delete;
+};
+
 // Merges a set of bundles (given their prefixes) into a single bundle with the
 // given "merged_prefix".  The merged metadata is guaranteed to be consistent.
 //
@@ -212,6 +272,32 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, Lookup() returns non-partitioned tensors that can be memcpy'd
+    // as read-only views into a memory mapping of their data file instead of
+    // copying them, when the caller does not provide a buffer (i.e. "val" has
+    // no elements). This requires the tensor data to be aligned in the file,
+    // see BundleWriter::Options::data_alignment, and the file system to
+    // support memory mapping. Tensors that cannot be mapped are read as usual.
+    //
+    // The returned tensors keep the mapping alive and must not be modified.
+    // Replicas of a model in one or several processes then share the page
+    // cache pages of the checkpoint.
+    bool use_mmap = false;
+
+    // Whether to validate the checksum of memory mapped tensors, which reads
+    // their full contents. Only applies if "use_mmap" is true.
+    bool validate_mmap_checksums = true;
+
+    // If true, the constructor reads all keys of the metadata table into a
+    // compact sorted array, together with their serialized entries, in one
+    // sequential pass. Contains() and the lookups by key then run a binary
+    // search in memory instead of reading and parsing a table block per call,
+    // and decode only the entries they need. This pays off when looking up
+    // many of the keys of a large bundle, e.g. when restoring a checkpoint
+    // with millions of entries. The index takes about as much memory as the
+    // metadata file.
+    bool in_memory_index = false;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -264,6 +350,37 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  struct LookupManyOptions {
+    LookupManyOptions() {}
+    // Maximum number of concurrent reads across all data shards.
+    int num_threads{8};
+    // Reads of a single tensor larger than this are split into several
+    // concurrent reads.
+    int64_t max_read_size{int64_t{64} << 20};
+    // If set, called with the position of a tensor in "keys" as soon as it is
+    // restored and its checksum validated. May be called concurrently from
+    // several threads and in any order. This allows overlapping restore with
+    // e.g. copies of the restored tensors to devices.
+    std::function<void(size_t)> done_callback;
+  };
+
+  // Looks up the tensors keyed by "keys" into "vals", which must have the
+  // same length. Usage of each element of "vals" follows Lookup(), so the
+  // caller may provide preallocated (e.g. pinned) buffers.
+  //
+  // Unlike calling Lookup() in a loop, the reads of all non-partitioned
+  // tensors whose type can be memcpy'd are sorted by shard and offset and
+  // issued in parallel, split into reads of at most "max_read_size" bytes.
+  // Other tensors are looked up sequentially as by Lookup().
+  //
+  // On error, returns the first error encountered and "vals" may contain
+  // nonsense data.
+  // REQUIRES: status().ok()
+  Status LookupMany(absl::Span<const absl::string_view> keys,
+                    absl::Span<Tensor* const> vals,
+                    const LookupManyOptions& options = LookupManyOptions())
+      TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -311,17 +428,22 @@ class BundleReader {
   std::string DebugString();
 
  private:
-  // Seeks for "key" and reads the metadata proto.
-  // On non-OK return, clears "entry" for the caller.
+  // Seeks for "key" (or searches the in-memory index) and reads the metadata
+  // proto. On non-OK return, clears "entry" for the caller.
   // REQUIRES: status().ok()
   Status GetBundleEntryProto(absl::string_view key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
-  // Reads the tensor value described by the metadata proto "entry".
+  // Reads the tensor value described by the metadata proto "entry" of "key".
   // Usage for "val" follows the comment of "Lookup()".
-  Status GetValue(const BundleEntryProto& entry,
+  Status GetValue(absl::string_view key, const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Sets "val" to a view of the tensor described by "entry" of "key" in the
+  // memory mapped data file, if possible. "mapped" tells whether it was.
+  Status GetMappedValue(absl::string_view key, const BundleEntryProto& entry,
+                        Tensor* val, bool* mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -341,9 +463,19 @@ class BundleReader {
   table::Cache* index_cache_;
   table::Iterator* iter_;
 
+  // The keys and serialized entries of the metadata table, if
+  // Options::in_memory_index is set.
+  class InMemoryIndex;
+  std::unique_ptr<InMemoryIndex> index_;
+
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // Memory mapped data files, shared with the tensors that point into them.
+  // Holds nullptr for shards that could not be mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -359,6 +491,8 @@ class BundleReader {
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
+  bool use_mmap_ = false;
+  bool validate_mmap_checksums_ = true;
 
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <cstdlib>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -24,6 +26,7 @@ limitations under the License.
 #endif  // _WIN32
 
 #include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -34,8 +37,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -954,6 +959,109 @@ TEST(TensorBundleTest, SortForSequentialAccess) {
                           "tensor-1-2", "tensor-1-1", "tensor-1-0"));
 }
 
+TEST(TensorBundleTest, LookupMany) {
+  Env* env = Env::Default();
+  const std::vector<string> kBundlePrefixes = {Prefix("lookup_many0"),
+                                               Prefix("lookup_many1")};
+  for (int i = 0; i < 2; ++i) {
+    BundleWriter writer(env, kBundlePrefixes[i]);
+    TF_EXPECT_OK(writer.Add(strings::StrCat("float", i),
+                            Constant_100x100<float>(i + 1.f)));
+    TF_EXPECT_OK(writer.Add(strings::StrCat("int", i),
+                            Constant_2x3<int64_t>(i + 10)));
+    TF_EXPECT_OK(writer.Add(strings::StrCat("string", i),
+                            Constant_2x3<tstring>(strings::StrCat("s", i))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const string kMerged = Prefix("lookup_many_merged");
+  TF_ASSERT_OK(MergeBundles(env, kBundlePrefixes, kMerged));
+
+  BundleReader reader(env, kMerged);
+  TF_ASSERT_OK(reader.status());
+  const std::vector<StringPiece> keys = {"int1",    "float0", "string1",
+                                         "float1",  "int0",   "string0"};
+  std::vector<Tensor> vals(keys.size());
+  // Preallocated buffers are filled in place.
+  vals[1] = Tensor(DT_FLOAT, TensorShape({100, 100}));
+  const float* preallocated = vals[1].flat<float>().data();
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+
+  BundleReader::LookupManyOptions options;
+  options.num_threads = 3;
+  // Splits each 100x100 float tensor into several reads.
+  options.max_read_size = 1000;
+  mutex mu;
+  std::vector<size_t> done;
+  options.done_callback = [&](size_t i) {
+    mutex_lock l(mu);
+    done.push_back(i);
+  };
+  TF_ASSERT_OK(reader.LookupMany(keys, val_ptrs, options));
+
+  test::ExpectTensorEqual<int64_t>(vals[0], Constant_2x3<int64_t>(11));
+  test::ExpectTensorEqual<float>(vals[1], Constant_100x100<float>(1.f));
+  test::ExpectTensorEqual<tstring>(vals[2], Constant_2x3<tstring>("s1"));
+  test::ExpectTensorEqual<float>(vals[3], Constant_100x100<float>(2.f));
+  test::ExpectTensorEqual<int64_t>(vals[4], Constant_2x3<int64_t>(10));
+  test::ExpectTensorEqual<tstring>(vals[5], Constant_2x3<tstring>("s0"));
+  EXPECT_EQ(vals[1].flat<float>().data(), preallocated);
+  EXPECT_THAT(done, ::testing::UnorderedElementsAre(0, 1, 2, 3, 4, 5));
+
+  Tensor missing;
+  Tensor* missing_ptr = &missing;
+  EXPECT_TRUE(absl::IsNotFound(reader.LookupMany(
+      std::vector<StringPiece>{"missing"}, {&missing_ptr, 1})));
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      reader.LookupMany(keys, {&missing_ptr, 1})));
+}
+
+TEST(TensorBundleTest, ParallelWriter) {
+  const TensorShape kFullShape({5, 10});
+  {
+    ParallelBundleWriter::Options opts;
+    opts.num_shards = 3;
+    ParallelBundleWriter writer(Env::Default(), Prefix("parallel"), opts);
+    TF_ASSERT_OK(writer.status());
+    for (int i = 0; i < 5; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("float", i),
+                              Constant_100x100<float>(i)));
+    }
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int64_t>(7)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("s")));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape,
+                                 TensorSlice::ParseOrDie("-:0,1"),
+                                 Constant<float>(0., TensorShape({5, 1}))));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape,
+                                 TensorSlice::ParseOrDie("-:1,9"),
+                                 Constant<float>(1., TensorShape({5, 9}))));
+    TF_ASSERT_OK(writer.Finish());
+    EXPECT_FALSE(writer.status().ok());
+  }
+  {
+    ParallelBundleWriter writer(Env::Default(), Prefix("parallel_duplicate"));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int64_t>(7)));
+    EXPECT_TRUE(absl::IsInvalidArgument(
+        writer.Add("int", Constant_2x3<int64_t>(8))));
+    EXPECT_TRUE(absl::IsInvalidArgument(writer.Finish()));
+  }
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      DataFilename(Prefix("parallel"), 2, 3)));
+
+  BundleReader reader(Env::Default(), Prefix("parallel"));
+  TF_ASSERT_OK(reader.status());
+  for (int i = 0; i < 5; ++i) {
+    Expect<float>(&reader, strings::StrCat("float", i),
+                  Constant_100x100<float>(i));
+  }
+  Expect<int64_t>(&reader, "int", Constant_2x3<int64_t>(7));
+  Expect<tstring>(&reader, "string", Constant_2x3<tstring>("s"));
+  Tensor expected_val(DT_FLOAT, kFullShape);
+  test::FillFn<float>(&expected_val,
+                      [](int offset) -> float { return offset % 10 != 0; });
+  Expect<float>(&reader, "sliced", expected_val);
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
@@ -1270,6 +1378,135 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, MemoryMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.f)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int64_t>(2)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("s")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  auto allocator_name = [](const Tensor& t) {
+    TensorDescription desc;
+    t.FillDescription(&desc);
+    return desc.allocation_description().allocator_name();
+  };
+
+  Tensor float_val, int_val, string_val, preallocated;
+  {
+    BundleReader::Options opts;
+    opts.use_mmap = true;
+    BundleReader reader(Env::Default(), Prefix("mmap"), opts);
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("float", &float_val));
+    TF_ASSERT_OK(reader.Lookup("int", &int_val));
+    TF_ASSERT_OK(reader.Lookup("string", &string_val));
+    // Preallocated buffers are still filled in place.
+    preallocated = Tensor(DT_FLOAT, TensorShape({2, 3}));
+    TF_ASSERT_OK(reader.Lookup("float", &preallocated));
+  }
+  // The mapped tensors outlive the reader.
+  test::ExpectTensorEqual<float>(float_val, Constant_2x3<float>(1.f));
+  test::ExpectTensorEqual<int64_t>(int_val, Constant_2x3<int64_t>(2));
+  test::ExpectTensorEqual<tstring>(string_val, Constant_2x3<tstring>("s"));
+  test::ExpectTensorEqual<float>(preallocated, Constant_2x3<float>(1.f));
+  EXPECT_EQ(allocator_name(float_val), "mmap");
+  EXPECT_EQ(allocator_name(int_val), "mmap");
+  EXPECT_NE(allocator_name(string_val), "mmap");
+  EXPECT_NE(allocator_name(preallocated), "mmap");
+}
+
+TEST(TensorBundleTest, InMemoryIndex) {
+  const TensorShape kFullShape({2, 3});
+  {
+    BundleWriter writer(Env::Default(), Prefix("in_memory_index"));
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.f)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int64_t>(2)));
+    TF_EXPECT_OK(writer.AddSlice("part", kFullShape,
+                                 TensorSlice::ParseOrDie("0,1:-"),
+                                 Constant<float>(3.f, TensorShape({1, 3}))));
+    TF_EXPECT_OK(writer.AddSlice("part", kFullShape,
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant<float>(3.f, TensorShape({1, 3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options opts;
+  opts.in_memory_index = true;
+  BundleReader reader(Env::Default(), Prefix("in_memory_index"), opts);
+  TF_ASSERT_OK(reader.status());
+
+  EXPECT_TRUE(reader.Contains("float"));
+  EXPECT_TRUE(reader.Contains("part"));
+  EXPECT_FALSE(reader.Contains("floa"));
+  EXPECT_FALSE(reader.Contains("zzz"));
+
+  DataType dtype;
+  TensorShape shape;
+  TF_ASSERT_OK(reader.LookupDtypeAndShape("int", &dtype, &shape));
+  EXPECT_EQ(dtype, DT_INT64);
+  EXPECT_EQ(shape, kFullShape);
+  EXPECT_TRUE(
+      errors::IsNotFound(reader.LookupDtypeAndShape("foo", &dtype, &shape)));
+
+  Tensor val(DT_FLOAT, kFullShape);
+  TF_ASSERT_OK(reader.Lookup("float", &val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1.f));
+  TF_ASSERT_OK(reader.Lookup("part", &val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(3.f));
+
+  // Iteration still goes through the table.
+  reader.Seek("int");
+  ASSERT_TRUE(reader.Valid());
+  EXPECT_EQ(reader.key(), "int");
+}
+
+// Sets the environment variable `name` to `value` for the lifetime of the
+// object.
+class ScopedEnvVar {
+ public:
+  ScopedEnvVar(const char* name, const char* value) : name_(name) {
+    if (const char* old_value = std::getenv(name)) old_value_ = old_value;
+    setenv(name, value, /*overwrite=*/1);
+  }
+
+  ~ScopedEnvVar() {
+    if (old_value_.has_value()) {
+      setenv(name_.c_str(), old_value_->c_str(), /*overwrite=*/1);
+    } else {
+      unsetenv(name_.c_str());
+    }
+  }
+
+ private:
+  const std::string name_;
+  std::optional<std::string> old_value_;
+};
+
+TEST(TensorBundleTest, IndexCacheMetrics) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("index_cache"));
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  monitoring::testing::CellReader<int64_t> hits(
+      "/tensorflow/core/bundle_reader/index_cache_hits");
+  monitoring::testing::CellReader<int64_t> misses(
+      "/tensorflow/core/bundle_reader/index_cache_misses");
+  {
+    ScopedEnvVar cache_size("TF_TABLE_INDEX_CACHE_SIZE_IN_MB", "1");
+    BundleReader reader(Env::Default(), Prefix("index_cache"));
+    TF_ASSERT_OK(reader.status());
+    // The first lookup of the index block misses, the next ones hit.
+    EXPECT_TRUE(reader.Contains("float"));
+    EXPECT_TRUE(reader.Contains("float"));
+  }
+  // The counters are updated when the reader is destroyed.
+  EXPECT_GT(misses.Delta(), 0);
+  EXPECT_GT(hits.Delta(), 0);
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
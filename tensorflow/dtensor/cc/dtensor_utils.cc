@@ -147,6 +147,17 @@ bool EnableAllToAllForRelayout() {
   return is_enabled;
 }
 
+bool EnableCostBasedLayoutPropagation() {
+  static bool is_enabled = [] {
+    bool ret = false;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar(
+        "DTENSOR_ENABLE_COST_BASED_LAYOUT_PROPAGATION",
+        /*default_val=*/false, &ret));
+    return ret;
+  }();
+  return is_enabled;
+}
+
 int AllReduceCombineOptimizationGroupSize() {
   char* group_size_str =
       std::getenv("DTENSOR_ALLREDUCE_COMBINE_OPTIMIZATION_GROUP_SIZE");
@@ -66,6 +66,11 @@ bool EnableReplicatedSpmdAsDefault(const std::string& op_name);
 // Returns whether to use all-to-all collective for relayout when possible.
 bool EnableAllToAllForRelayout();
 
+// Returns whether layout propagation picks, among the layouts requested for a
+// value, the one minimizing the estimated communication of its relayouts
+// instead of unsharding the dimensions its consumers disagree on.
+bool EnableCostBasedLayoutPropagation();
+
 // Returns the maximum number of AllReduce ops to merge into a group. This value
 // determines the AllReduce grouping in dtensor_allreduce_combine_optimization.
 // The input value should be in range of [0, INT_MAX]. It is advised to pick
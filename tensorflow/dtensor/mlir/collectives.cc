@@ -164,33 +164,6 @@ StatusOr<const mlir::Value> EmitAllScatter(
   return all_scatter.getOutput();
 }
 
-bool CanUseAllToAll(const dtensor::Layout& src_layout,
-                    const dtensor::Layout& tgt_layout) {
-  // All-to-all can be used for relayout if one dimension is becoming more
-  // sharded while another is becoming less sharded, for example x,unsharded ->
-  // unsharded,x.
-  // TODO(trevor-m): There may be more types of relayouts which can utilize
-  // all-to-all in addition to these which can be supported later.
-  int num_split_dims = 0;
-  int num_concat_dims = 0;
-  std::string split_spec;
-  std::string concat_spec;
-  for (int i = 0; i < src_layout.rank(); ++i) {
-    if (src_layout.sharding_spec(i) == tgt_layout.sharding_spec(i)) continue;
-    if (Layout::IsUnshardedDimension(src_layout.sharding_spec(i)) &&
-        Layout::IsShardedDimension(tgt_layout.sharding_spec(i))) {
-      num_split_dims++;
-      split_spec = tgt_layout.sharding_spec(i);
-    } else if (Layout::IsShardedDimension(src_layout.sharding_spec(i)) &&
-               Layout::IsUnshardedDimension(tgt_layout.sharding_spec(i))) {
-      num_concat_dims++;
-      concat_spec = src_layout.sharding_spec(i);
-    }
-  }
-  return num_split_dims == 1 && num_concat_dims == 1 &&
-         split_spec == concat_spec;
-}
-
 StatusOr<mlir::Value> EmitAllToAll(
     mlir::OpBuilder& builder, mlir::Value input,
     const dtensor::Layout& src_layout, const dtensor::Layout& tgt_layout,
@@ -345,40 +318,16 @@ StatusOr<mlir::Value> EmitRelayout(
     return all_to_all_result;
   }
 
-  absl::flat_hash_set<std::string> src_sharding_dims;
-  for (int i = 0; i < src_layout.rank(); ++i)
-    src_sharding_dims.emplace(src_layout.sharding_spec(i));
-
-  std::vector<std::string> intermediate_specs_1(src_layout.rank());
-  for (int i = 0; i < src_layout.rank(); ++i) {
-    if (Layout::IsShardedDimension(tgt_layout.sharding_spec(i)) &&
-        !Layout::IsShardedDimension(src_layout.sharding_spec(i)) &&
-        !src_sharding_dims.contains(tgt_layout.sharding_spec(i)))
-      intermediate_specs_1[i] = tgt_layout.sharding_spec(i);
-    else
-      intermediate_specs_1[i] = src_layout.sharding_spec(i);
-  }
-  TF_ASSIGN_OR_RETURN(Layout intermediate_layout_1,
-                      Layout::GetLayout(tgt_layout.type(), intermediate_specs_1,
-                                        src_layout.mesh()));
+  TF_ASSIGN_OR_RETURN(auto intermediate_layouts,
+                      GetRelayoutIntermediateLayouts(src_layout, tgt_layout));
+  const Layout& intermediate_layout_1 = intermediate_layouts.first;
+  const Layout& intermediate_layout_2 = intermediate_layouts.second;
 
   llvm::SmallPtrSet<mlir::Operation*, 4> local_newly_created_ops;
   TF_ASSIGN_OR_RETURN(mlir::Value split_result,
                       EmitAllScatter(builder, input, src_layout,
                                      intermediate_layout_1, newly_created_ops));
 
-  std::vector<std::string> intermediate_specs_2(src_layout.rank());
-  for (int i = 0; i < src_layout.rank(); ++i) {
-    if (Layout::IsShardedDimension(intermediate_specs_1[i]) &&
-        intermediate_specs_1[i] != tgt_layout.sharding_spec(i))
-      intermediate_specs_2[i] = Layout::kUnshardedDim;
-    else
-      intermediate_specs_2[i] = intermediate_specs_1[i];
-  }
-  TF_ASSIGN_OR_RETURN(Layout intermediate_layout_2,
-                      Layout::GetLayout(tgt_layout.type(), intermediate_specs_2,
-                                        src_layout.mesh()));
-
   TF_ASSIGN_OR_RETURN(
       mlir::Value concat_result,
       EmitAllGather(builder, split_result, intermediate_layout_1,
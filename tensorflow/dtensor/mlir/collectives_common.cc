@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/dtensor/mlir/collectives_common.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/dtensor/cc/dstatus.h"
@@ -91,5 +94,115 @@ StatusOr<std::string> DeviceTypeFromMesh(const Mesh& mesh) {
   return device_path.substr(0, device_path_pos);
 }
 
+bool CanUseAllToAll(const Layout& src_layout, const Layout& tgt_layout) {
+  // All-to-all can be used for relayout if one dimension is becoming more
+  // sharded while another is becoming less sharded, for example x,unsharded ->
+  // unsharded,x.
+  // TODO(trevor-m): There may be more types of relayouts which can utilize
+  // all-to-all in addition to these which can be supported later.
+  int num_split_dims = 0;
+  int num_concat_dims = 0;
+  std::string split_spec;
+  std::string concat_spec;
+  for (int i = 0; i < src_layout.rank(); ++i) {
+    if (src_layout.sharding_spec(i) == tgt_layout.sharding_spec(i)) continue;
+    if (Layout::IsUnshardedDimension(src_layout.sharding_spec(i)) &&
+        Layout::IsShardedDimension(tgt_layout.sharding_spec(i))) {
+      num_split_dims++;
+      split_spec = tgt_layout.sharding_spec(i);
+    } else if (Layout::IsShardedDimension(src_layout.sharding_spec(i)) &&
+               Layout::IsUnshardedDimension(tgt_layout.sharding_spec(i))) {
+      num_concat_dims++;
+      concat_spec = src_layout.sharding_spec(i);
+    }
+  }
+  return num_split_dims == 1 && num_concat_dims == 1 &&
+         split_spec == concat_spec;
+}
+
+StatusOr<std::pair<Layout, Layout>> GetRelayoutIntermediateLayouts(
+    const Layout& src_layout, const Layout& tgt_layout) {
+  // The first split opportunistically splits input tensor dimension i on mesh
+  // axis x if:
+  // 1.  tgt_layout contains x at position i
+  // 2.  src_layout is unsharded at position i.
+  // 3.  src_layout does not contain mesh axis x.
+  absl::flat_hash_set<std::string> src_sharding_dims;
+  for (int i = 0; i < src_layout.rank(); ++i)
+    src_sharding_dims.emplace(src_layout.sharding_spec(i));
+
+  std::vector<std::string> intermediate_specs_1(src_layout.rank());
+  for (int i = 0; i < src_layout.rank(); ++i) {
+    if (Layout::IsShardedDimension(tgt_layout.sharding_spec(i)) &&
+        !Layout::IsShardedDimension(src_layout.sharding_spec(i)) &&
+        !src_sharding_dims.contains(tgt_layout.sharding_spec(i)))
+      intermediate_specs_1[i] = tgt_layout.sharding_spec(i);
+    else
+      intermediate_specs_1[i] = src_layout.sharding_spec(i);
+  }
+  TF_ASSIGN_OR_RETURN(Layout intermediate_layout_1,
+                      Layout::GetLayout(tgt_layout.type(), intermediate_specs_1,
+                                        src_layout.mesh()));
+
+  // The all-gather then unshards any axis that does not agree with the
+  // sharding of the output.
+  std::vector<std::string> intermediate_specs_2(src_layout.rank());
+  for (int i = 0; i < src_layout.rank(); ++i) {
+    if (Layout::IsShardedDimension(intermediate_specs_1[i]) &&
+        intermediate_specs_1[i] != tgt_layout.sharding_spec(i))
+      intermediate_specs_2[i] = Layout::kUnshardedDim;
+    else
+      intermediate_specs_2[i] = intermediate_specs_1[i];
+  }
+  TF_ASSIGN_OR_RETURN(Layout intermediate_layout_2,
+                      Layout::GetLayout(tgt_layout.type(), intermediate_specs_2,
+                                        src_layout.mesh()));
+  return std::make_pair(std::move(intermediate_layout_1),
+                        std::move(intermediate_layout_2));
+}
+
+StatusOr<int64_t> GetRelayoutCommunicationBytes(
+    const Layout& src_layout, const Layout& tgt_layout,
+    absl::Span<const int64_t> global_shape, int64_t element_bytes,
+    bool use_all_to_all) {
+  if (src_layout.rank() != tgt_layout.rank() ||
+      src_layout.rank() != global_shape.size()) {
+    return errors::InvalidArgument(
+        "Expected layouts of rank ", global_shape.size(), ", got ",
+        src_layout.rank(), " and ", tgt_layout.rank());
+  }
+  if (src_layout.IsEquivalentIgnoringType(tgt_layout)) return 0;
+
+  std::vector<int64_t> static_shape(global_shape.begin(), global_shape.end());
+  for (int64_t& dim : static_shape) {
+    if (dim < 0) dim = 1;
+  }
+  auto local_bytes = [&](const Layout& layout) {
+    int64_t num_elements = 1;
+    for (int64_t dim : layout.LocalShapeFromGlobalShape(static_shape)) {
+      num_elements *= dim;
+    }
+    return num_elements * element_bytes;
+  };
+
+  if (use_all_to_all && CanUseAllToAll(src_layout, tgt_layout)) {
+    // Each device keeps one of the `num_devices` blocks of its shard.
+    for (int i = 0; i < src_layout.rank(); ++i) {
+      if (Layout::IsUnshardedDimension(src_layout.sharding_spec(i)) &&
+          Layout::IsShardedDimension(tgt_layout.sharding_spec(i))) {
+        TF_ASSIGN_OR_RETURN(
+            const int64_t num_devices,
+            src_layout.mesh().dim_size(tgt_layout.sharding_spec(i)));
+        return local_bytes(src_layout) * (num_devices - 1) / num_devices;
+      }
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(auto intermediate_layouts,
+                      GetRelayoutIntermediateLayouts(src_layout, tgt_layout));
+  return local_bytes(intermediate_layouts.second) -
+         local_bytes(intermediate_layouts.first);
+}
+
 }  // namespace dtensor
 }  // namespace tensorflow
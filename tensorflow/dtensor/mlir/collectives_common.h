@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_DTENSOR_MLIR_COLLECTIVES_COMMON_H_
 #define TENSORFLOW_DTENSOR_MLIR_COLLECTIVES_COMMON_H_
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/dtensor/cc/dstatus.h"
 #include "tensorflow/dtensor/cc/tensor_layout.h"
@@ -37,6 +40,26 @@ GetAllReducePartitionsFromReducedDims(
 // Use the first device in the mesh to extract the device name.
 StatusOr<std::string> DeviceTypeFromMesh(const Mesh& mesh);
 
+// Returns true if a relayout from `src_layout` to `tgt_layout` can be done
+// with a single all-to-all, i.e. if one tensor dimension becomes sharded over
+// the mesh dimension another one stops being sharded over.
+bool CanUseAllToAll(const Layout& src_layout, const Layout& tgt_layout);
+
+// Returns the intermediate layouts of a relayout from `src_layout` to
+// `tgt_layout` without all-to-all: the input is split to the first layout,
+// all-gathered to the second one and split again to `tgt_layout`.
+StatusOr<std::pair<Layout, Layout>> GetRelayoutIntermediateLayouts(
+    const Layout& src_layout, const Layout& tgt_layout);
+
+// Estimates the number of bytes received by each device to relayout a tensor
+// of shape `global_shape` and elements of `element_bytes` bytes from
+// `src_layout` to `tgt_layout`, as emitted by EmitRelayout. Splits are local
+// and free, and dynamic dimensions are counted as a single element.
+StatusOr<int64_t> GetRelayoutCommunicationBytes(
+    const Layout& src_layout, const Layout& tgt_layout,
+    absl::Span<const int64_t> global_shape, int64_t element_bytes,
+    bool use_all_to_all);
+
 }  // namespace dtensor
 }  // namespace tensorflow
 
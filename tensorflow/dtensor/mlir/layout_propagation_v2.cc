@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <iterator>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
@@ -59,6 +61,7 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/constants.h"
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
 #include "tensorflow/dtensor/cc/tensor_layout.h"
+#include "tensorflow/dtensor/mlir/collectives_common.h"
 #include "tensorflow/dtensor/mlir/dtensor_dialect/ir/dialect.h"
 #include "tensorflow/dtensor/mlir/dtensor_dialect/ir/dtensor_attributes.h"
 #include "tensorflow/dtensor/mlir/dtensor_mlir_passes.h"
@@ -66,6 +69,7 @@ limitations under the License.
 #include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
 #include "tensorflow/dtensor/mlir/layout_parsing.h"
 #include "tensorflow/dtensor/mlir/op_utils.h"
+#include "tensorflow/dtensor/mlir/shape_utils.h"
 #include "tensorflow/dtensor/mlir/spmd_expander.h"
 #include "tensorflow/dtensor/mlir/spmd_expander_common.h"
 #include "tensorflow/dtensor/mlir/value_utils.h"
@@ -311,6 +315,148 @@ StatusOr<Layout> MergeLayouts(
   return Layout::GetLayout(producer->type(), proposed_specs, mesh);
 }
 
+// Returns the size in bytes of the elements of `value`, for the estimates of
+// the communication of its relayouts.
+int64_t GetElementBytes(const mlir::Value& value) {
+  const mlir::Type element_type =
+      mlir::getElementTypeOrSelf(GetSubtypeOrSelf(value));
+  if (element_type.isIntOrFloat()) {
+    return std::max<int64_t>(1, element_type.getIntOrFloatBitWidth() / 8);
+  }
+  return 4;
+}
+
+// Estimates the number of bytes received by each device to relayout `value`
+// from `src_layout` to `tgt_layout`. The dimensions of `tgt_layout` that can
+// have any sharding keep the sharding of `src_layout`.
+StatusOr<int64_t> GetRelayoutCost(const mlir::Value& value,
+                                  const Layout& src_layout,
+                                  const Layout& tgt_layout) {
+  if (src_layout.mesh() != tgt_layout.mesh() ||
+      src_layout.rank() != tgt_layout.rank()) {
+    return errors::InvalidArgument("Cannot relayout from ",
+                                   src_layout.ToString(), " to ",
+                                   tgt_layout.ToString());
+  }
+  std::vector<std::string> src_specs = src_layout.sharding_spec_strs();
+  FilterkAnySpecs(src_specs);
+  std::vector<std::string> tgt_specs = tgt_layout.sharding_spec_strs();
+  for (int i = 0; i < tgt_specs.size(); ++i) {
+    if (tgt_specs[i] == Layout::kAny) tgt_specs[i] = src_specs[i];
+  }
+  TF_ASSIGN_OR_RETURN(const Layout src,
+                      Layout::GetLayout(src_layout.type(), src_specs,
+                                        src_layout.mesh()));
+  TF_ASSIGN_OR_RETURN(const Layout tgt,
+                      Layout::GetLayout(tgt_layout.type(), tgt_specs,
+                                        tgt_layout.mesh()));
+  TF_ASSIGN_OR_RETURN(llvm::ArrayRef<int64_t> shape, GetShapeOfValue(value));
+  return GetRelayoutCommunicationBytes(src, tgt, shape, GetElementBytes(value),
+                                       EnableAllToAllForRelayout());
+}
+
+// Returns the layout of `producer_value` minimizing the estimated
+// communication of the relayouts from the layout requested by its producer and
+// to the layouts requested by its consumers. The candidates are `merged`, the
+// layout picked by MergeLayouts, and the requested layouts. Ties are broken in
+// favor of `merged`.
+Layout GetMinimumCostLayout(
+    const mlir::Value& producer_value, const absl::optional<Layout>& producer,
+    const mlir::DenseMap<mlir::OpOperand*, Layout>& consumers,
+    const Layout& merged) {
+  const bool has_producer =
+      producer &&
+      !IsProducerResourceOpWithEmptyLayout(producer_value, *producer);
+  auto total_cost = [&](const Layout& candidate) -> StatusOr<int64_t> {
+    int64_t cost = 0;
+    if (has_producer) {
+      TF_ASSIGN_OR_RETURN(
+          cost, GetRelayoutCost(producer_value, *producer, candidate));
+    }
+    for (const auto& consumer : consumers) {
+      TF_ASSIGN_OR_RETURN(
+          const int64_t consumer_cost,
+          GetRelayoutCost(producer_value, candidate, consumer.second));
+      cost += consumer_cost;
+    }
+    return cost;
+  };
+
+  StatusOr<int64_t> merged_cost = total_cost(merged);
+  if (!merged_cost.ok()) return merged;
+  Layout best_layout = merged;
+  int64_t best_cost = merged_cost.value();
+
+  std::vector<Layout> requested_layouts;
+  if (has_producer) requested_layouts.push_back(*producer);
+  for (const auto& consumer : consumers) {
+    requested_layouts.push_back(consumer.second);
+  }
+  for (const Layout& requested_layout : requested_layouts) {
+    if (requested_layout.mesh() != merged.mesh()) continue;
+    std::vector<std::string> specs = requested_layout.sharding_spec_strs();
+    FilterkAnySpecs(specs);
+    StatusOr<Layout> candidate =
+        Layout::GetLayout(merged.type(), specs, merged.mesh());
+    if (!candidate.ok()) continue;
+    StatusOr<int64_t> cost = total_cost(candidate.value());
+    if (cost.ok() && cost.value() < best_cost) {
+      best_layout = candidate.value();
+      best_cost = cost.value();
+    }
+  }
+  if (best_layout != merged) {
+    VLOG(2) << "Picked layout " << best_layout.ToString() << " instead of "
+            << merged.ToString() << ", reducing the estimated relayout "
+            << "communication from " << merged_cost.value() << " to "
+            << best_cost << " bytes per device";
+  }
+  return best_layout;
+}
+
+// Logs the estimated communication of the relayouts to the layouts requested
+// by the consumers of the values, by consumer op.
+void LogRelayoutCosts(
+    const llvm::DenseMap<mlir::Value, Layout>& merged_layouts,
+    const llvm::DenseMap<mlir::Value, mlir::DenseMap<mlir::OpOperand*, Layout>>&
+        consumer_requests) {
+  struct RelayoutCost {
+    int64_t bytes;
+    std::string description;
+  };
+  std::vector<RelayoutCost> relayout_costs;
+  int64_t total_bytes = 0;
+  for (const auto& [value, requests] : consumer_requests) {
+    const auto merged_layout = merged_layouts.find(value);
+    if (merged_layout == merged_layouts.end()) continue;
+    for (const auto& [operand, requested_layout] : requests) {
+      StatusOr<int64_t> bytes =
+          GetRelayoutCost(value, merged_layout->second, requested_layout);
+      if (!bytes.ok() || bytes.value() == 0) continue;
+      total_bytes += bytes.value();
+      mlir::Operation* consumer = operand->getOwner();
+      relayout_costs.push_back(
+          {bytes.value(),
+           absl::StrCat(consumer->getName().getStringRef().str(), " operand ",
+                        operand->getOperandNumber(), " at ",
+                        mlir::debugString(consumer->getLoc()), ": ",
+                        merged_layout->second.ToString(), " -> ",
+                        requested_layout.ToString())});
+    }
+  }
+  std::sort(relayout_costs.begin(), relayout_costs.end(),
+            [](const RelayoutCost& a, const RelayoutCost& b) {
+              return a.bytes > b.bytes;
+            });
+  VLOG(1) << "Layout propagation requires " << relayout_costs.size()
+          << " relayouts, receiving an estimated " << total_bytes
+          << " bytes per device";
+  for (const RelayoutCost& relayout_cost : relayout_costs) {
+    VLOG(1) << "  " << relayout_cost.bytes
+            << " bytes: " << relayout_cost.description;
+  }
+}
+
 mlir::LogicalResult InsertLayoutsForDTensorLayout(
     mlir::ModuleOp& module,
     llvm::DenseMap<mlir::Value, std::optional<Layout>>& producer_request,
@@ -473,6 +619,10 @@ mlir::LogicalResult MergeAndGetUpdatedLayouts(
         MergeLayouts(value, producer_layout, consumer_requests[value]);
     if (!merged.ok())
       return value.getDefiningOp()->emitOpError() << merged.status().message();
+    if (EnableCostBasedLayoutPropagation()) {
+      merged = GetMinimumCostLayout(value, producer_layout,
+                                    consumer_requests[value], merged.value());
+    }
 
     auto current_layout = merged_layouts.find(value);
     if (current_layout == merged_layouts.end() ||
@@ -1580,6 +1730,9 @@ struct DLayoutPropagationPassV2
                              "layout_propagation", kDebugGroupDTensorLayout)) {
       LogLayoutsAndOps(stage, -1, merged_layouts, module);
     }
+    if (VLOG_IS_ON(1) && !module->hasAttr(kDoNotLog)) {
+      LogRelayoutCosts(merged_layouts, consumer_requests);
+    }
 
     if (!AllOpResultsHaveLayouts(&module, tf_dialect, merged_layouts))
       return signalPassFailure();
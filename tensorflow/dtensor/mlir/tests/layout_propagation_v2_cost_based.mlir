@@ -0,0 +1,30 @@
+// RUN: DTENSOR_ENABLE_COST_BASED_LAYOUT_PROPAGATION=1 dtensor-opt %s -dtensor-annotate-global-shape -dtensor-layout-propagation-v2 -split-input-file -verify-diagnostics | FileCheck %s --check-prefix=COST
+// RUN: dtensor-opt %s -dtensor-annotate-global-shape -dtensor-layout-propagation-v2 -split-input-file -verify-diagnostics | FileCheck %s --check-prefix=RULE
+
+// Check that the layout of a value is the requested layout needing the least
+// relayout communication. The Identity produces x,unsharded and its three
+// consumers request unsharded,x. Merging the layouts keeps the producer's
+// layout, which needs a relayout for each consumer. The cost-based layout is
+// unsharded,x, which needs a single relayout from the producer.
+// COST-LABEL: func @main
+// COST:         %[[IDENTITY_OUT:.*]] = "tf.Identity"
+// COST-NEXT:    "tf.DTensorLayout"(%[[IDENTITY_OUT]])
+// COST-SAME:    layout = #dtensor.layout<sharding_specs:unsharded,x, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3>
+// RULE-LABEL: func @main
+// RULE:         %[[IDENTITY_OUT:.*]] = "tf.Identity"
+// RULE-NEXT:    "tf.DTensorLayout"(%[[IDENTITY_OUT]])
+// RULE-SAME:    layout = #dtensor.layout<sharding_specs:x,unsharded, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3>
+func.func @main(%arg0: tensor<4x4xf32> {tf._layout = "sharding_specs:x,unsharded, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3"}) -> (tensor<4x4xf32>, tensor<4x4xf32>, tensor<4x4xf32>) {
+  %0:3 = "tf_device.cluster"() ({
+    %1 = "tf.DTensorLayout"(%arg0) {global_shape = #tf_type.shape<4x4>, layout = #dtensor.layout<sharding_specs:x,unsharded, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3>} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %2 = "tf.Identity"(%1) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %3 = "tf.Neg"(%2) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %4 = "tf.DTensorLayout"(%3) {global_shape = #tf_type.shape<4x4>, layout = #dtensor.layout<sharding_specs:unsharded,x, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3>} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %5 = "tf.Neg"(%2) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %6 = "tf.DTensorLayout"(%5) {global_shape = #tf_type.shape<4x4>, layout = #dtensor.layout<sharding_specs:unsharded,x, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3>} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %7 = "tf.Neg"(%2) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %8 = "tf.DTensorLayout"(%7) {global_shape = #tf_type.shape<4x4>, layout = #dtensor.layout<sharding_specs:unsharded,x, mesh:|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3>} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    tf_device.return %4, %6, %8 : tensor<4x4xf32>, tensor<4x4xf32>, tensor<4x4xf32>
+  }) {_mesh = "|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1,/job:localhost/replica:0/task:0/device:CPU:2,/job:localhost/replica:0/task:0/device:CPU:3"} : () -> (tensor<4x4xf32>, tensor<4x4xf32>, tensor<4x4xf32>)
+  func.return %0#0, %0#1, %0#2 : tensor<4x4xf32>, tensor<4x4xf32>, tensor<4x4xf32>
+}
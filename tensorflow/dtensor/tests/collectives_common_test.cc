@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/mlir/collectives_common.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+using ::tsl::testing::IsOkAndHolds;
+
+constexpr int64_t kElementBytes = 4;
+
+class RelayoutCostTest : public ::testing::Test {
+ protected:
+  Mesh GetMesh() {
+    return Mesh::CreateMesh("MyMesh", /*dim_names=*/{"x", "y"},
+                            /*mesh_shape=*/{2, 2},
+                            /*global_device_ids=*/{0, 1, 2, 3},
+                            /*global_devices_str=*/
+                            {"/job:localhost/task:0/device:CPU:0",
+                             "/job:localhost/task:0/device:CPU:1",
+                             "/job:localhost/task:0/device:CPU:2",
+                             "/job:localhost/task:0/device:CPU:3"},
+                            /*local_device_ids=*/{0, 1, 2, 3},
+                            /*local_devices_str=*/
+                            {"/job:localhost/task:0/device:CPU:0",
+                             "/job:localhost/task:0/device:CPU:1",
+                             "/job:localhost/task:0/device:CPU:2",
+                             "/job:localhost/task:0/device:CPU:3"},
+                            /*use_xla_spmd=*/false);
+  }
+
+  Layout GetLayout(const std::vector<std::string>& specs) {
+    return *Layout::GetLayout(specs, GetMesh());
+  }
+};
+
+TEST_F(RelayoutCostTest, SameLayoutIsFree) {
+  const Layout layout = GetLayout({"x", Layout::kUnshardedDim});
+  EXPECT_THAT(GetRelayoutCommunicationBytes(layout, layout, {8, 8},
+                                            kElementBytes,
+                                            /*use_all_to_all=*/true),
+              IsOkAndHolds(0));
+}
+
+TEST_F(RelayoutCostTest, SplitIsFree) {
+  EXPECT_THAT(GetRelayoutCommunicationBytes(
+                  GetLayout({Layout::kUnshardedDim, Layout::kUnshardedDim}),
+                  GetLayout({"x", "y"}), {8, 8}, kElementBytes,
+                  /*use_all_to_all=*/true),
+              IsOkAndHolds(0));
+}
+
+TEST_F(RelayoutCostTest, AllGatherReceivesMissingShards) {
+  // Each device holds 4x8 elements and receives the other 4x8 elements.
+  EXPECT_THAT(GetRelayoutCommunicationBytes(
+                  GetLayout({"x", Layout::kUnshardedDim}),
+                  GetLayout({Layout::kUnshardedDim, Layout::kUnshardedDim}),
+                  {8, 8}, kElementBytes, /*use_all_to_all=*/true),
+              IsOkAndHolds(4 * 8 * kElementBytes));
+}
+
+TEST_F(RelayoutCostTest, AllToAllIsCheaperThanAllGather) {
+  const Layout src_layout = GetLayout({"x", Layout::kUnshardedDim});
+  const Layout tgt_layout = GetLayout({Layout::kUnshardedDim, "x"});
+  EXPECT_TRUE(CanUseAllToAll(src_layout, tgt_layout));
+  // Each device keeps half of its 4x8 elements and receives the other half.
+  EXPECT_THAT(
+      GetRelayoutCommunicationBytes(src_layout, tgt_layout, {8, 8},
+                                    kElementBytes, /*use_all_to_all=*/true),
+      IsOkAndHolds(4 * 4 * kElementBytes));
+  // Without all-to-all, the tensor is all-gathered and split again.
+  EXPECT_THAT(
+      GetRelayoutCommunicationBytes(src_layout, tgt_layout, {8, 8},
+                                    kElementBytes, /*use_all_to_all=*/false),
+      IsOkAndHolds(4 * 8 * kElementBytes));
+}
+
+TEST_F(RelayoutCostTest, RankMismatchFails) {
+  const Layout layout = GetLayout({"x", Layout::kUnshardedDim});
+  EXPECT_FALSE(GetRelayoutCommunicationBytes(layout, layout, {8},
+                                             kElementBytes,
+                                             /*use_all_to_all=*/true)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
@@ -33,6 +33,8 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+// Maximum number of tensor size configurations whose allocations are cached.
+constexpr size_t kMaxCachedAllocations = 8;
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
@@ -205,6 +207,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_allocations_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -360,14 +363,41 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     }
   }
 
+  // Allocations of the whole graph after a reset only depend on the sizes and
+  // allocation types of the tensors, so they can be cached.
+  const bool use_cache = first_node == 0 &&
+                         last_node >= num_execution_nodes - 1 &&
+                         last_active_node_ == kLastActiveNodeUndefined;
+  std::vector<size_t> cache_key;
+  bool cache_hit = false;
+  if (use_cache) {
+    cache_key = GetAllocationCacheKey();
+    auto it = cached_allocations_.find(cache_key);
+    if (it != cached_allocations_.end()) {
+      allocs_ = it->second.allocs;
+      actual_tensor_id_ = it->second.actual_tensor_id;
+      arena_.RestorePlan(it->second.arena_plan);
+      persistent_arena_.RestorePlan(it->second.persistent_arena_plan);
+      last_active_node_ = last_node;
+      cache_hit = true;
+    }
+  }
+
   std::vector<int32_t> tensors_allocated;
-  TF_LITE_ENSURE_STATUS(
-      CalculateAllocations(first_node, last_node, &tensors_allocated));
+  if (!cache_hit) {
+    TF_LITE_ENSURE_STATUS(
+        CalculateAllocations(first_node, last_node, &tensors_allocated));
+    if (use_cache && cached_allocations_.size() < kMaxCachedAllocations) {
+      cached_allocations_[std::move(cache_key)] = {
+          allocs_, actual_tensor_id_, arena_.SavePlan(),
+          persistent_arena_.SavePlan()};
+    }
+  }
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
 
   TfLiteTensor* tensors = graph_info_->tensors();
-  if (arena_reallocated) {
+  if (arena_reallocated || cache_hit) {
     for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
     }
@@ -413,7 +443,47 @@ TfLiteStatus ArenaPlanner::AcquireNonPersistentMemory() {
 }
 
 bool ArenaPlanner::HasNonPersistentMemory() {
-  return has_nonpersistent_memory_;
+  // Another planner sharing the arena may have used it since.
+  return has_nonpersistent_memory_ && arena_.IsCommitted();
+}
+
+TfLiteStatus ArenaPlanner::ShareNonPersistentMemoryWith(ArenaPlanner& other) {
+  TF_LITE_ENSURE_STATUS(ReleaseNonPersistentMemory());
+  arena_.ShareBufferWith(other.arena_);
+  return kTfLiteOk;
+}
+
+void ArenaPlanner::SetConcurrentNodeGroups(
+    const std::vector<std::pair<int, int>>& groups) {
+  if (groups == concurrent_node_groups_) return;
+  concurrent_node_groups_ = groups;
+  group_first_node_.clear();
+  group_last_node_.clear();
+  for (const auto& [first, last] : groups) {
+    for (int node = static_cast<int>(group_first_node_.size()); node <= last;
+         ++node) {
+      group_first_node_.push_back(node);
+      group_last_node_.push_back(node);
+    }
+    for (int node = first; node <= last; ++node) {
+      group_first_node_[node] = first;
+      group_last_node_[node] = last;
+    }
+  }
+  // The cached allocations were calculated with other tensor lifetimes.
+  cached_allocations_.clear();
+}
+
+int32_t ArenaPlanner::GroupFirstNode(int32_t node) const {
+  return node >= 0 && static_cast<size_t>(node) < group_first_node_.size()
+             ? group_first_node_[node]
+             : node;
+}
+
+int32_t ArenaPlanner::GroupLastNode(int32_t node) const {
+  return node >= 0 && static_cast<size_t>(node) < group_last_node_.size()
+             ? group_last_node_[node]
+             : node;
 }
 
 void ArenaPlanner::DumpDebugInfo(const std::vector<int>& execution_plan) const {
@@ -471,6 +541,24 @@ void ArenaPlanner::CreateTensorAllocationVector(
             tensor_compare);
 }
 
+std::vector<size_t> ArenaPlanner::GetAllocationCacheKey() const {
+  const size_t num_tensors = graph_info_->num_tensors();
+  const size_t num_execution_nodes = graph_info_->num_execution_nodes();
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<size_t> key;
+  key.reserve(2 * num_tensors + num_execution_nodes);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    key.push_back(tensors[i].bytes);
+    key.push_back(tensors[i].allocation_type);
+  }
+  // Ops may request a different number of temporaries depending on the sizes
+  // of their inputs.
+  for (size_t i = 0; i < num_execution_nodes; ++i) {
+    key.push_back(graph_info_->node(i).temporaries->size);
+  }
+  return key;
+}
+
 std::vector<int32_t> ArenaPlanner::GetTensorsToAllocate(int first_node,
                                                         int last_node) {
   int num_tensors = static_cast<int>(graph_info_->num_tensors());
@@ -541,10 +629,10 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(
+          context_, tensor_alignment_, tensor.bytes, tensor_index,
+          GroupFirstNode(alloc_node_[tensor_index]),
+          GroupLastNode(dealloc_node_[tensor_index]), &allocs_[tensor_index]));
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -17,9 +17,11 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -72,6 +74,19 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Makes the non-persistent arena of this planner use the same buffer as the
+  // one of `other`. The two planners must never be in use at the same time,
+  // e.g. because they belong to subgraphs of which only one runs. The memory
+  // is released like by ReleaseNonPersistentMemory(), and acquired again on
+  // the next AcquireNonPersistentMemory() or ExecuteAllocations().
+  TfLiteStatus ShareNonPersistentMemoryWith(ArenaPlanner& other);
+
+  // Sets the groups of consecutive nodes which may be invoked concurrently, as
+  // pairs of the first and the last node of each group. The tensors used by a
+  // node of a group stay allocated during the whole group, so that tensors of
+  // concurrent nodes never overlap. Takes effect on the next allocations.
+  void SetConcurrentNodeGroups(const std::vector<std::pair<int, int>>& groups);
+
  private:
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
@@ -120,6 +135,16 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns the key under which the allocations of the whole graph are cached,
+  // made of the sizes and allocation types of all tensors. The key is only
+  // valid until the next call to `PlanAllocations`.
+  std::vector<size_t> GetAllocationCacheKey() const;
+
+  // Returns the first and the last node of the concurrent node group which
+  // contains `node`, or `node` if it's in none.
+  int32_t GroupFirstNode(int32_t node) const;
+  int32_t GroupLastNode(int32_t node) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -166,6 +191,26 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // The allocations of the whole graph, as computed by `CalculateAllocations`.
+  struct CachedAllocations {
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+    SimpleMemoryArena::Plan arena_plan;
+    SimpleMemoryArena::Plan persistent_arena_plan;
+  };
+
+  // Allocations of previously seen tensor sizes, e.g. when the inputs are
+  // resized back and forth between a few shapes. Restoring them skips
+  // recalculating the offsets of all tensors. Since the arena never shrinks,
+  // it ends up sized for the largest of the cached allocations.
+  std::map<std::vector<size_t>, CachedAllocations> cached_allocations_;
+
+  // See SetConcurrentNodeGroups(). `group_first_node_` and `group_last_node_`
+  // map each node to the bounds of its group.
+  std::vector<std::pair<int, int>> concurrent_node_groups_;
+  std::vector<int32_t> group_first_node_;
+  std::vector<int32_t> group_last_node_;
 };
 
 }  // namespace tflite
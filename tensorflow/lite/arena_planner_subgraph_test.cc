@@ -15,6 +15,8 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/kernels/subgraph_test_util.h"
 
 namespace tflite {
@@ -123,5 +125,47 @@ TEST(ArenaPlannerSubgraphTest, TestOffsetAddSharing) {
   subgraph_test_util::CheckIntTensor(subgraph_output, {3}, {10, 12, 11});
 }
 
+class ArenaPlannerSharedArenaTest
+    : public subgraph_test_util::ControlFlowOpTest {};
+
+TEST_F(ArenaPlannerSharedArenaTest, TestIfBranchesShareArena) {
+  AddSubgraphs(2);
+  // Only the THEN branch has arena allocated intermediate tensors.
+  builder_->BuildInplaceOpSubgraph(interpreter_->subgraph(1));
+  builder_->BuildMulSubgraph(interpreter_->subgraph(2));
+  builder_->BuildIfSubgraph(&interpreter_->primary_subgraph());
+  InterpreterOptions options;
+  options.SetShareControlFlowArenas();
+  ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {1});
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {2});
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[2], {2});
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  subgraph_test_util::FillIntTensor(
+      interpreter_->tensor(interpreter_->inputs()[1]), {5, 7});
+  subgraph_test_util::FillIntTensor(
+      interpreter_->tensor(interpreter_->inputs()[2]), {1, 2});
+
+  Subgraph::SubgraphAllocInfo then_info, else_info;
+  interpreter_->subgraph(1)->GetMemoryAllocInfo(&then_info);
+  interpreter_->subgraph(2)->GetMemoryAllocInfo(&else_info);
+  EXPECT_GT(then_info.arena_size, 0);
+  EXPECT_EQ(else_info.arena_size, then_info.arena_size);
+
+  // Switching between the branches re-resolves the tensors of each branch.
+  for (bool cond : {true, false, true, false}) {
+    interpreter_->typed_input_tensor<bool>(0)[0] = cond;
+    ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+    const TfLiteTensor* output =
+        interpreter_->tensor(interpreter_->outputs()[0]);
+    if (cond) {
+      subgraph_test_util::CheckIntTensor(output, {2}, {7, 11});
+    } else {
+      subgraph_test_util::CheckIntTensor(output, {2}, {5, 14});
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tflite
@@ -370,6 +370,73 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, AllocationsRestoredForPreviousTensorSizes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  auto get_offsets = [&]() {
+    std::vector<std::ptrdiff_t> offsets;
+    for (int i = 0; i < tensors.size(); ++i) offsets.push_back(GetOffset(i));
+    return offsets;
+  };
+  auto resize = [&](size_t bytes) {
+    ResetAllocations();
+    for (int i = 0; i < tensors.size(); ++i) tensors[i].bytes = bytes * (i + 1);
+    Execute(0, graph.nodes().size() - 1);
+  };
+
+  resize(/*bytes=*/3);
+  const std::vector<std::ptrdiff_t> small_offsets = get_offsets();
+  resize(/*bytes=*/100);
+  const std::vector<std::ptrdiff_t> large_offsets = get_offsets();
+  size_t arena_size, arena_persist_size;
+  planner_->GetAllocInfo(&arena_size, &arena_persist_size);
+
+  // Switching back and forth reuses the allocations computed before, and the
+  // arena keeps the size required by the largest tensors.
+  for (int i = 0; i < 2; ++i) {
+    resize(/*bytes=*/3);
+    EXPECT_EQ(get_offsets(), small_offsets);
+    resize(/*bytes=*/100);
+    EXPECT_EQ(get_offsets(), large_offsets);
+  }
+  size_t final_arena_size;
+  planner_->GetAllocInfo(&final_arena_size, &arena_persist_size);
+  EXPECT_EQ(final_arena_size, arena_size);
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentNodeGroupsDontShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{1}, {2}, {5}},    // Second op
+                      {{1}, {3}, {6}},    // Third op
+                      {{2, 3}, {4}, {}},  // Fourth op
+                  },
+                  {4});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // The temporaries of the second and the third op share memory.
+  EXPECT_EQ(GetOffset(5), GetOffset(6));
+
+  // Unless the two ops may run concurrently.
+  planner_->SetConcurrentNodeGroups({{1, 2}});
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_TRUE(GetOffset(6) >= GetOffsetAfter(5) ||
+              GetOffset(5) >= GetOffsetAfter(6));
+  EXPECT_TRUE(GetOffset(3) >= GetOffsetAfter(5) ||
+              GetOffset(5) >= GetOffsetAfter(3));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
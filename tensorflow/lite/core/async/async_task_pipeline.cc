@@ -0,0 +1,66 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_task_pipeline.h"
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace async {
+
+AsyncTaskPipeline::AsyncTaskPipeline(AsyncSignatureRunner* runner, int depth)
+    : runner_(runner) {
+  for (int slot = 0; slot < depth; ++slot) {
+    tasks_.push_back(runner_->CreateTask());
+  }
+}
+
+AsyncTaskPipeline::~AsyncTaskPipeline() {
+  int slot;
+  while (num_in_flight_ > 0) {
+    Wait(&slot);
+  }
+  for (TfLiteExecutionTask* task : tasks_) {
+    runner_->Finish(task);
+  }
+}
+
+TfLiteStatus AsyncTaskPipeline::InvokeAsync() {
+  if (num_in_flight_ == depth()) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+               "All the tasks of the pipeline are in flight.");
+    return kTfLiteError;
+  }
+  TfLiteExecutionTask* task = tasks_[next_slot()];
+  ++num_in_flight_;
+  return runner_->InvokeAsync(task);
+}
+
+TfLiteStatus AsyncTaskPipeline::Wait(int* slot) {
+  if (num_in_flight_ == 0) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+               "No task of the pipeline is in flight.");
+    return kTfLiteError;
+  }
+  *slot = oldest_slot_;
+  oldest_slot_ = (oldest_slot_ + 1) % depth();
+  --num_in_flight_;
+  return runner_->Wait(tasks_[*slot]);
+}
+
+}  // namespace async
+}  // namespace tflite
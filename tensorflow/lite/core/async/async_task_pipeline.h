@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_ASYNC_TASK_PIPELINE_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_ASYNC_TASK_PIPELINE_H_
+
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace async {
+
+// WARNING: Experimental interface, subject to change
+//
+// Keeps up to `depth` execution tasks of an AsyncSignatureRunner in flight,
+// so that the application can prepare the inputs of the next task and consume
+// the outputs of the previous one while the backend executes the current one.
+// Each slot of the pipeline has its own task, whose buffers and
+// synchronizations are typically set once, for double or triple buffering of
+// the I/O. Tasks are scheduled in the order of their slots, and waited for in
+// the same order.
+//
+// Usage:
+//
+//   AsyncTaskPipeline pipeline(runner, /*depth=*/3);
+//   for (int slot = 0; slot < pipeline.depth(); ++slot) {
+//     // Set the buffers of pipeline.task(slot).
+//   }
+//   while (HasFrames()) {
+//     if (pipeline.num_in_flight() == pipeline.depth()) {
+//       int slot;
+//       if (pipeline.Wait(&slot) != kTfLiteOk) { /* handle error */ }
+//       Postprocess(slot);
+//     }
+//     Preprocess(pipeline.next_slot());
+//     if (pipeline.InvokeAsync() != kTfLiteOk) { /* handle error */ }
+//   }
+//
+// This class is not thread safe.
+class AsyncTaskPipeline {
+ public:
+  // Creates `depth` tasks on `runner`, which must outlive the pipeline.
+  // `depth` must be positive.
+  AsyncTaskPipeline(AsyncSignatureRunner* runner, int depth);
+
+  // Waits for the tasks in flight and finishes all the tasks.
+  ~AsyncTaskPipeline();
+
+  AsyncTaskPipeline(const AsyncTaskPipeline&) = delete;
+  AsyncTaskPipeline& operator=(const AsyncTaskPipeline&) = delete;
+
+  // Returns the number of slots of the pipeline.
+  int depth() const { return static_cast<int>(tasks_.size()); }
+
+  // Returns the number of tasks which are scheduled and not waited for yet.
+  int num_in_flight() const { return num_in_flight_; }
+
+  // Returns the task of the given slot, in [0, depth()).
+  TfLiteExecutionTask* task(int slot) const { return tasks_[slot]; }
+
+  // Returns the slot of the task which is scheduled by the next InvokeAsync().
+  int next_slot() const { return (oldest_slot_ + num_in_flight_) % depth(); }
+
+  // Schedules the task of `next_slot()`.
+  // Returns kTfLiteError if all tasks are in flight, or if the backend failed
+  // to schedule the execution. In the latter case, the task still needs to
+  // be waited for.
+  TfLiteStatus InvokeAsync();
+
+  // Blocks and waits for the oldest task in flight to finish, and returns its
+  // slot in `slot`, whose buffers may then be reused.
+  // Returns kTfLiteError if no task is in flight, or if the execution failed.
+  TfLiteStatus Wait(int* slot);
+
+ private:
+  AsyncSignatureRunner* runner_;
+  std::vector<TfLiteExecutionTask*> tasks_;
+  // The slots of the tasks in flight are the `num_in_flight_` slots from
+  // `oldest_slot_` onward, in circular order.
+  int oldest_slot_ = 0;
+  int num_in_flight_ = 0;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_ASYNC_TASK_PIPELINE_H_
@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_task_pipeline.h"
+
+#include <cstdlib>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/testing/mock_async_kernel.h"
+#include "tensorflow/lite/core/async/testing/test_backend.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/interpreter_test_util.h"
+
+using ::testing::_;
+using ::testing::Eq;
+using ::testing::InSequence;
+using ::testing::Return;
+
+namespace tflite {
+namespace async {
+
+class AsyncTaskPipelineTest : public InterpreterTest {
+ protected:
+  void SetUp() override {
+    kernel_ =
+        std::make_unique<::testing::StrictMock<testing::MockAsyncKernel>>();
+    backend_ = std::make_unique<testing::TestBackend>(kernel_->kernel());
+
+    interpreter_ = std::make_unique<Interpreter>();
+    interpreter_->AddTensors(2);
+    interpreter_->SetInputs({0});
+    interpreter_->SetOutputs({1});
+    TfLiteQuantizationParams quant;
+    interpreter_->SetTensorParametersReadWrite(0, kTfLiteFloat32, "x", {3},
+                                               quant);
+    interpreter_->SetTensorParametersReadWrite(1, kTfLiteFloat32, "a", {3},
+                                               quant);
+    TfLiteRegistration* reg = ops::builtin::Register_ADD();
+    void* builtin_data_1 = malloc(sizeof(int));
+    interpreter_->AddNodeWithParameters({0, 0}, {1}, nullptr, 0, builtin_data_1,
+                                        reg);
+    interpreter_->ModifyGraphWithDelegate(backend_->get_delegate());
+    BuildSignature("serving_default", {{"input", 0}}, {{"output", 1}});
+    runner_ = interpreter_->GetAsyncSignatureRunner("serving_default");
+  }
+
+  std::unique_ptr<::testing::StrictMock<testing::MockAsyncKernel>> kernel_;
+  std::unique_ptr<testing::TestBackend> backend_;
+  AsyncSignatureRunner* runner_ = nullptr;
+};
+
+TEST_F(AsyncTaskPipelineTest, TasksAreWaitedForInOrder) {
+  ASSERT_NE(runner_, nullptr);
+  auto pipeline = std::make_unique<AsyncTaskPipeline>(runner_, /*depth=*/2);
+  ASSERT_EQ(pipeline->depth(), 2);
+  ASSERT_NE(pipeline->task(0), pipeline->task(1));
+  {
+    InSequence sequence;
+    EXPECT_CALL(*kernel_, Eval(_, _, Eq(pipeline->task(0))));
+    EXPECT_CALL(*kernel_, Eval(_, _, Eq(pipeline->task(1))));
+    EXPECT_CALL(*kernel_, Wait(_, Eq(pipeline->task(0))));
+    EXPECT_CALL(*kernel_, Eval(_, _, Eq(pipeline->task(0))));
+    EXPECT_CALL(*kernel_, Wait(_, Eq(pipeline->task(1))))
+        .WillOnce(Return(kTfLiteError));
+    // The remaining task is waited for when destroying the pipeline.
+    EXPECT_CALL(*kernel_, Wait(_, Eq(pipeline->task(0))));
+  }
+  EXPECT_CALL(*kernel_, Finish(_, _)).Times(2);
+
+  int slot = -1;
+  EXPECT_EQ(pipeline->Wait(&slot), kTfLiteError);
+  EXPECT_EQ(pipeline->next_slot(), 0);
+  EXPECT_EQ(pipeline->InvokeAsync(), kTfLiteOk);
+  EXPECT_EQ(pipeline->next_slot(), 1);
+  EXPECT_EQ(pipeline->InvokeAsync(), kTfLiteOk);
+  EXPECT_EQ(pipeline->num_in_flight(), 2);
+  // All the slots are in flight.
+  EXPECT_EQ(pipeline->InvokeAsync(), kTfLiteError);
+
+  EXPECT_EQ(pipeline->Wait(&slot), kTfLiteOk);
+  EXPECT_EQ(slot, 0);
+  EXPECT_EQ(pipeline->next_slot(), 0);
+  EXPECT_EQ(pipeline->InvokeAsync(), kTfLiteOk);
+  EXPECT_EQ(pipeline->Wait(&slot), kTfLiteError);
+  EXPECT_EQ(slot, 1);
+  EXPECT_EQ(pipeline->num_in_flight(), 1);
+  pipeline.reset();
+}
+
+}  // namespace async
+}  // namespace tflite
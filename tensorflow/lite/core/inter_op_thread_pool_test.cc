@@ -0,0 +1,51 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(InterOpThreadPoolTest, RunsAllTasks) {
+  InterOpThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 4, 17}) {
+    std::vector<std::atomic<int>> calls(num_tasks);
+    std::atomic<bool> valid_threads(true);
+    pool.Run(num_tasks, [&](int task, int thread) {
+      ++calls[task];
+      if (thread < 0 || thread >= 4) valid_threads = false;
+    });
+    for (int task = 0; task < num_tasks; ++task) {
+      EXPECT_EQ(calls[task], 1) << "task " << task;
+    }
+    EXPECT_TRUE(valid_threads);
+  }
+}
+
+TEST(InterOpThreadPoolTest, SingleThreadRunsOnCaller) {
+  InterOpThreadPool pool(1);
+  EXPECT_EQ(pool.num_threads(), 1);
+  std::vector<int> threads;
+  pool.Run(3, [&](int task, int thread) { threads.push_back(thread); });
+  EXPECT_EQ(threads, std::vector<int>({0, 0, 0}));
+}
+
+}  // namespace
+}  // namespace tflite
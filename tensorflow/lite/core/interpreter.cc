@@ -234,6 +234,9 @@ TfLiteStatus Interpreter::Invoke() {
   // will not take effect.
   if (cancellation_enabled_) (void)continue_invocation_.test_and_set();
 
+  // Takes turns with the interpreters sharing the cpu backend context, if any.
+  ScopedCpuBackendContextInvocation cpu_backend_context_invocation(context_);
+
   // Denormal floating point numbers could cause significant slowdown on
   // platforms like x86, therefore, we suppress denormals here to prevent this
   // from happening.
@@ -537,7 +540,8 @@ impl::SignatureRunner* Interpreter::GetSignatureRunner(
     if (signature.signature_key == signature_key) {
       auto status = signature_runner_map_.insert(
           {signature_key,
-           SignatureRunner(&signature, subgraph(signature.subgraph_index))});
+           SignatureRunner(&signature, subgraph(signature.subgraph_index),
+                           &signature_runner_with_memory_)});
       return &(status.first->second);
     }
   }
@@ -968,6 +968,10 @@ class Interpreter {
   // its SignatureDef.
   std::map<std::string, SignatureRunner> signature_runner_map_;
 
+  // The SignatureRunner whose tensors were allocated last, if its
+  // non-persistent memory was not released since.
+  SignatureRunner* signature_runner_with_memory_ = nullptr;
+
   // Map of signature key to its corresponding AsyncSignatureRunner object.
   // An AsyncSignatureRunner is basically a wrapper of the AsyncSubgraph
   // corresponding to its SignatureDef.
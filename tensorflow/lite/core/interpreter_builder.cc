@@ -447,15 +447,24 @@ TfLiteStatus InterpreterBuilder::ParseQuantization(
 
   // Ensure that the number of scales is 1 for per-layer quantization, and
   // matches number of quantization dimensions for per-axis quantization.
+  // 2-D tensors quantized along dimension 0 may also be quantized block-wise:
+  // each row then has one scale per block of consecutive columns.
   if (num_scales != 1 &&
       (!dims.empty() &&
        num_scales != dims[src_quantization->quantized_dimension()])) {
-    TF_LITE_REPORT_ERROR(
-        error_reporter_,
-        "num_scales must be 1 for per-layer quantization, or %d for per-axis "
-        "quantization, but got %d.",
-        dims[src_quantization->quantized_dimension()], num_scales);
-    return kTfLiteError;
+    const bool is_blockwise =
+        dims.size() == 2 && src_quantization->quantized_dimension() == 0 &&
+        dims[0] > 0 && num_scales > dims[0] && num_scales % dims[0] == 0 &&
+        dims[1] % (num_scales / dims[0]) == 0;
+    if (!is_blockwise) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter_,
+          "num_scales must be 1 for per-layer quantization, %d for per-axis "
+          "quantization, or a multiple of it for block-wise quantization, but "
+          "got %d.",
+          dims[src_quantization->quantized_dimension()], num_scales);
+      return kTfLiteError;
+    }
   }
 
   // Affine-quantization.
@@ -89,6 +89,20 @@ std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyAndBuildFromFile(
 #endif
 }
 
+std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyTrustedAndBuildFromFile(
+    const char* filename, TfLiteVerifier* trust_verifier,
+    ErrorReporter* error_reporter) {
+  error_reporter = ValidateErrorReporter(error_reporter);
+  std::unique_ptr<FlatBufferModel> model = VerifyTrustedAndBuildFromAllocation(
+      GetAllocationFromFile(filename, error_reporter), trust_verifier,
+      error_reporter);
+#if FLATBUFFERS_LITTLEENDIAN == 1
+  return model;
+#else
+  return ByteConvertModel(std::move(model), error_reporter);
+#endif
+}
+
 }  // namespace impl
 
 #endif
@@ -307,6 +321,37 @@ std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyAndBuildFromAllocation(
   return BuildFromAllocation(std::move(allocation), error_reporter);
 }
 
+std::unique_ptr<FlatBufferModel>
+FlatBufferModel::VerifyTrustedAndBuildFromAllocation(
+    std::unique_ptr<Allocation> allocation, TfLiteVerifier* trust_verifier,
+    ErrorReporter* error_reporter) {
+  error_reporter = ValidateErrorReporter(error_reporter);
+  if (!allocation || !allocation->valid()) {
+    TF_LITE_REPORT_ERROR(error_reporter, "The model allocation is null/empty");
+    return nullptr;
+  }
+
+  const size_t allocation_size =
+      std::min(allocation->bytes(),
+               static_cast<size_t>(FLATBUFFERS_MAX_BUFFER_SIZE - 1));
+  if (!trust_verifier ||
+      !trust_verifier->Verify(static_cast<const char*>(allocation->base()),
+                              allocation_size, error_reporter)) {
+    return VerifyAndBuildFromAllocation(std::move(allocation),
+                                        /*extra_verifier=*/nullptr,
+                                        error_reporter);
+  }
+
+  // The contents are trusted, so only checks that they hold a model.
+  if (allocation_size < sizeof(flatbuffers::uoffset_t) + 4 ||
+      !ModelBufferHasIdentifier(allocation->base())) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "The trusted model is not a TFLite model");
+    return nullptr;
+  }
+  return BuildFromAllocation(std::move(allocation), error_reporter);
+}
+
 std::unique_ptr<FlatBufferModel> FlatBufferModel::BuildFromModel(
     const tflite::Model* caller_owned_model_spec,
     ErrorReporter* error_reporter) {
@@ -95,6 +95,22 @@ class FlatBufferModel {
       const char* filename, TfLiteVerifier* extra_verifier = nullptr,
       ErrorReporter* error_reporter = DefaultErrorReporter());
 
+  /// Builds a model based on a file that the caller may trust, e.g. a model
+  /// shipped with a signed application, without its deep verification.
+  /// The trust_verifier argument checks whether the file contents can be
+  /// trusted, e.g. by comparing their hash with one from a trusted source or
+  /// by checking their signature. If it accepts the contents, only the buffer
+  /// identifier of the model is checked, which avoids walking the whole
+  /// flatbuffer when loading large models. Otherwise, the file is verified as
+  /// by VerifyAndBuildFromFile(filename, nullptr, error_reporter).
+  /// Caller retains ownership of `trust_verifier` and `error_reporter`, and
+  /// must ensure the lifetime of `error_reporter` is longer than the
+  /// FlatBufferModel instance.
+  /// Returns a nullptr in case of failure.
+  static std::unique_ptr<FlatBufferModel> VerifyTrustedAndBuildFromFile(
+      const char* filename, TfLiteVerifier* trust_verifier,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
   /// Builds a model based on a pre-loaded flatbuffer.
   /// Caller retains ownership of the buffer and should keep it alive until
   /// the returned object is destroyed. Caller also retains ownership of
@@ -146,6 +162,18 @@ class FlatBufferModel {
       TfLiteVerifier* extra_verifier = nullptr,
       ErrorReporter* error_reporter = DefaultErrorReporter());
 
+  /// Builds a model based on the provided allocation, without verifying it
+  /// if the trust_verifier argument accepts its contents. See
+  /// VerifyTrustedAndBuildFromFile.
+  /// Ownership of the allocation is passed to the model, but the caller
+  /// retains ownership of `trust_verifier` and `error_reporter`, and must
+  /// ensure the lifetime of `error_reporter` is longer than the
+  /// FlatBufferModel instance.
+  /// Returns a nullptr in case of failure.
+  static std::unique_ptr<FlatBufferModel> VerifyTrustedAndBuildFromAllocation(
+      std::unique_ptr<Allocation> allocation, TfLiteVerifier* trust_verifier,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
   /// Builds a model directly from a flatbuffer pointer
   /// Caller retains ownership of the buffer and should keep it alive until the
   /// returned object is destroyed. Caller retains ownership of `error_reporter`
@@ -423,6 +423,35 @@ TEST(BasicFlatBufferModel, TestWithNullVerifier) {
       "tensorflow/lite/testdata/test_model.bin", nullptr));
 }
 
+TEST(BasicFlatBufferModel, TestTrustedModel) {
+  FakeVerifier trusting_verifier(true);
+  ASSERT_TRUE(FlatBufferModel::VerifyTrustedAndBuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin", &trusting_verifier));
+  // Models that are not trusted are fully verified.
+  FakeVerifier distrusting_verifier(false);
+  ASSERT_TRUE(FlatBufferModel::VerifyTrustedAndBuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin", &distrusting_verifier));
+  ASSERT_TRUE(FlatBufferModel::VerifyTrustedAndBuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin", nullptr));
+  ASSERT_FALSE(FlatBufferModel::VerifyTrustedAndBuildFromFile(
+      "tensorflow/lite/testdata/test_model_broken.bin",
+      &distrusting_verifier));
+}
+
+TEST(BasicFlatBufferModel, TestTrustedModelWithoutIdentifier) {
+  const std::vector<uint32_t> data(16, 0x12345678);
+  const char* buffer = reinterpret_cast<const char*>(data.data());
+  const size_t size = data.size() * sizeof(uint32_t);
+  FakeVerifier trusting_verifier(true);
+  ASSERT_FALSE(FlatBufferModel::VerifyTrustedAndBuildFromAllocation(
+      std::make_unique<MemoryAllocation>(buffer, size, DefaultErrorReporter()),
+      &trusting_verifier));
+  FakeVerifier distrusting_verifier(false);
+  ASSERT_FALSE(FlatBufferModel::VerifyTrustedAndBuildFromAllocation(
+      std::make_unique<MemoryAllocation>(buffer, size, DefaultErrorReporter()),
+      &distrusting_verifier));
+}
+
 // This makes sure the ErrorReporter is marshalled from FlatBufferModel to
 // the Interpreter.
 TEST(BasicFlatBufferModel, TestCustomErrorReporter) {
@@ -18,13 +18,18 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/interpreter_options.h"
 
 namespace tflite {
 namespace impl {
 
 SignatureRunner::SignatureRunner(const internal::SignatureDef* signature_def,
-                                 Subgraph* subgraph)
-    : signature_def_(signature_def), subgraph_(subgraph) {
+                                 Subgraph* subgraph,
+                                 SignatureRunner** runner_with_memory)
+    : signature_def_(signature_def),
+      subgraph_(subgraph),
+      runner_with_memory_(runner_with_memory) {
   // Collects the list of input and output tensor names.
   for (const auto& it : signature_def_->inputs) {
     input_names_.push_back(it.first.c_str());
@@ -73,12 +78,49 @@ TfLiteStatus SignatureRunner::ResizeInputTensorStrict(
   return subgraph_->ResizeInputTensorStrict(it->second, new_size);
 }
 
+TfLiteStatus SignatureRunner::AllocateTensors() {
+  // Releases the idle signature first, so that both arenas are not held at
+  // the same time.
+  const InterpreterOptions* options = subgraph_->GetOptions();
+  SignatureRunner* idle_runner = *runner_with_memory_;
+  if (options && options->GetReleaseIdleSignatureMemory() &&
+      idle_runner != nullptr && idle_runner != this &&
+      idle_runner->subgraph_ != subgraph_) {
+    TF_LITE_ENSURE_STATUS(idle_runner->ReleaseNonPersistentMemory());
+  }
+  TF_LITE_ENSURE_STATUS(subgraph_->AllocateTensors());
+  bound_buffers_need_allocation_ = false;
+  *runner_with_memory_ = this;
+  return kTfLiteOk;
+}
+
+TfLiteStatus SignatureRunner::ReleaseNonPersistentMemory() {
+  if (*runner_with_memory_ == this) *runner_with_memory_ = nullptr;
+  // Delegate kernels may hold on to the buffers of the tensors, so they must
+  // be prepared again.
+  if (!subgraph_->delegates_applied_.empty()) {
+    return subgraph_->ReleaseNonPersistentMemory();
+  }
+  if (subgraph_->memory_planner_ &&
+      subgraph_->memory_planner_->HasNonPersistentMemory()) {
+    TF_LITE_ENSURE_STATUS(
+        subgraph_->memory_planner_->ReleaseNonPersistentMemory());
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus SignatureRunner::Invoke() {
   // "Resets" cancellation flag so cancellation happens before this invoke will
   // not take effect.
   if (subgraph_->continue_invocation_)
     (void)subgraph_->continue_invocation_->test_and_set();
 
+  if (bound_buffers_need_allocation_) {
+    TF_LITE_ENSURE_STATUS(AllocateTensors());
+  }
+  // Takes turns with the interpreters sharing the cpu backend context, if any.
+  ScopedCpuBackendContextInvocation cpu_backend_context_invocation(
+      subgraph_->context());
   TF_LITE_ENSURE_STATUS(subgraph_->Invoke());
 
   // Makes sure output tensors are readable.
@@ -113,5 +155,51 @@ TfLiteStatus SignatureRunner::SetCustomAllocationForOutputTensor(
   return subgraph_->SetCustomAllocationForTensor(it->second, allocation, flags);
 }
 
+TfLiteStatus SignatureRunner::BindInputBuffer(
+    const char* input_name, const TfLiteCustomAllocation& buffer,
+    int64_t flags) {
+  const auto& it = signature_def_->inputs.find(input_name);
+  if (it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  return BindBuffer(it->second, buffer, flags);
+}
+
+TfLiteStatus SignatureRunner::BindOutputBuffer(
+    const char* output_name, const TfLiteCustomAllocation& buffer,
+    int64_t flags) {
+  const auto& it = signature_def_->outputs.find(output_name);
+  if (it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return BindBuffer(it->second, buffer, flags);
+}
+
+TfLiteStatus SignatureRunner::BindBuffer(int tensor_index,
+                                         const TfLiteCustomAllocation& buffer,
+                                         int64_t flags) {
+  const TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+  // Rebinding a bound tensor keeps the memory plan valid, only the buffer of
+  // the tensor changes.
+  const bool keeps_plan = tensor->allocation_type == kTfLiteCustom &&
+                          subgraph_->state_ != Subgraph::kStateUninvokable &&
+                          subgraph_->delegates_applied_.empty();
+  if (keeps_plan && buffer.bytes < tensor->bytes) {
+    subgraph_->ReportError(
+        "Buffer of %zu bytes is too small for tensor %d of %zu bytes",
+        buffer.bytes, tensor_index, tensor->bytes);
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(
+      subgraph_->SetCustomAllocationForTensor(tensor_index, buffer, flags));
+  if (!keeps_plan) {
+    subgraph_->state_ = Subgraph::kStateUninvokable;
+    bound_buffers_need_allocation_ = true;
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace impl
 }  // namespace tflite
@@ -143,7 +143,18 @@ class SignatureRunner {
                                        const std::vector<int>& new_size);
 
   /// Updates allocations for all tensors, related to the given signature.
-  TfLiteStatus AllocateTensors() { return subgraph_->AllocateTensors(); }
+  /// If InterpreterOptions::SetReleaseIdleSignatureMemory() is enabled, this
+  /// first releases the non-persistent memory of the signature whose tensors
+  /// were allocated last.
+  TfLiteStatus AllocateTensors();
+
+  /// Releases the non-persistent memory of the signature, i.e. the arena of
+  /// its inputs, outputs and intermediate tensors, whose data become invalid.
+  /// The memory plan is kept, unless delegates were applied, so that the next
+  /// AllocateTensors() call, which must precede the next invocation, only
+  /// reacquires the arena.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus ReleaseNonPersistentMemory();
 
   /// Invokes the signature runner (run the graph identified by the given
   /// signature in dependency order).
@@ -207,6 +218,37 @@ class SignatureRunner {
       const char* output_name, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  /// \brief Binds a caller-owned buffer to the given input for this and all
+  /// following invocations, so that input data can be written to it directly
+  /// instead of being copied into the input tensor. The runtime does NOT take
+  /// ownership of the buffer, which must outlive its binding.
+  ///
+  /// The first binding of an input changes the memory plan, which is
+  /// recomputed by the next AllocateTensors() or Invoke() call, and resets the
+  /// variable tensors like AllocateTensors(). Binding another buffer to an
+  /// input which is already bound only swaps the buffer, without recomputing
+  /// the memory plan: the buffer is validated immediately instead, and must be
+  /// at least as large as the tensor. This allows, e.g., to bind each frame of
+  /// a camera or audio pipeline without copies or re-planning. Buffers must
+  /// be aligned to kDefaultTensorAlignment, unless
+  /// kTfLiteCustomAllocationFlagsSkipAlignCheck is set through `flags`.
+  ///
+  /// If delegates were applied, every binding changes the memory plan, since
+  /// delegate kernels may hold on to the buffers of the tensors.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindInputBuffer(
+      const char* input_name, const TfLiteCustomAllocation& buffer,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
+  /// \brief Binds a caller-owned buffer to the given output for this and all
+  /// following invocations, so that the output is computed into it directly
+  /// instead of having to be copied out of the output tensor. See
+  /// BindInputBuffer() for the lifetime and validation of the buffer.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindOutputBuffer(
+      const char* output_name, const TfLiteCustomAllocation& buffer,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
   /// \brief Set if buffer handle output is allowed.
   ///
   /// When using hardware delegation, Interpreter will make the data of output
@@ -225,22 +267,33 @@ class SignatureRunner {
   // responsibility to create and manage SignatureRunner objects to make sure
   // SignatureRunner objects don't outlive their corresponding Subgraph objects.
   SignatureRunner(const internal::SignatureDef* signature_def,
-                  Subgraph* subgraph);
+                  Subgraph* subgraph, SignatureRunner** runner_with_memory);
   friend class ::tflite::impl::Interpreter;
   friend class ::tflite::SignatureRunnerHelper;
   friend class ::tflite::SignatureRunnerJNIHelper;
   friend class ::tflite::TensorHandle;
 
+  // Binds `buffer` to the tensor at `tensor_index`, see BindInputBuffer().
+  TfLiteStatus BindBuffer(int tensor_index,
+                          const TfLiteCustomAllocation& buffer, int64_t flags);
+
   // The SignatureDef object is owned by the interpreter.
   const internal::SignatureDef* signature_def_;
   // The Subgraph object is owned by the interpreter.
   Subgraph* subgraph_;
+  // The runner of the interpreter whose tensors were allocated last, owned by
+  // the interpreter.
+  SignatureRunner** runner_with_memory_;
   // The list of input tensor names.
   std::vector<const char*> input_names_;
   // The list of output tensor names.
   std::vector<const char*> output_names_;
 
   bool allow_buffer_handle_output_ = false;
+
+  // True if buffers were bound since the last memory planning, and the next
+  // invocation needs to allocate the tensors first.
+  bool bound_buffers_need_allocation_ = false;
 };
 
 }  // namespace impl
@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/lite/core/interpreter.h"
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace impl {
@@ -96,6 +98,94 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, TestReleaseIdleSignatureMemory) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterOptions options;
+  options.SetReleaseIdleSignatureMemory();
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver, &options)(&interpreter),
+            kTfLiteOk);
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  SignatureRunner* sub_runner = interpreter->GetSignatureRunner("sub");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_NE(sub_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(sub_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+    add_runner->input_tensor("x")->data.f[0] = 2;
+    add_runner->input_tensor("x")->data.f[1] = 4;
+    ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+    EXPECT_EQ(add_runner->output_tensor("output_0")->data.f[0], 4);
+    EXPECT_EQ(add_runner->output_tensor("output_0")->data.f[1], 6);
+
+    // Allocating the tensors of another signature releases the idle one.
+    ASSERT_EQ(sub_runner->AllocateTensors(), kTfLiteOk);
+    EXPECT_EQ(add_runner->input_tensor("x")->data.raw, nullptr);
+    EXPECT_EQ(add_runner->Invoke(), kTfLiteError);
+    sub_runner->input_tensor("x")->data.f[0] = 2;
+    sub_runner->input_tensor("x")->data.f[1] = 4;
+    ASSERT_EQ(sub_runner->Invoke(), kTfLiteOk);
+    EXPECT_EQ(sub_runner->output_tensor("output_0")->data.f[0], -1);
+    EXPECT_EQ(sub_runner->output_tensor("output_0")->data.f[1], 1);
+  }
+
+  ASSERT_EQ(sub_runner->ReleaseNonPersistentMemory(), kTfLiteOk);
+  EXPECT_EQ(sub_runner->input_tensor("x")->data.raw, nullptr);
+}
+
+TEST(SignatureRunnerTest, TestBindBuffers) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver)(&interpreter), kTfLiteOk);
+  SignatureRunner* runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(runner, nullptr);
+  ASSERT_EQ(runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(runner->AllocateTensors(), kTfLiteOk);
+
+  alignas(kDefaultTensorAlignment) float inputs[2][16] = {{2, 4}, {3, 5}};
+  alignas(kDefaultTensorAlignment) float outputs[2][16] = {};
+  auto buffer = [](float* data) {
+    return TfLiteCustomAllocation{data, 16 * sizeof(float)};
+  };
+  ASSERT_EQ(runner->BindInputBuffer("x", buffer(inputs[0])), kTfLiteOk);
+  ASSERT_EQ(runner->BindOutputBuffer("output_0", buffer(outputs[0])),
+            kTfLiteOk);
+  ASSERT_EQ(runner->BindInputBuffer("dummy", buffer(inputs[0])), kTfLiteError);
+  // The tensors are allocated by the first invocation.
+  ASSERT_EQ(runner->Invoke(), kTfLiteOk);
+  EXPECT_EQ(runner->output_tensor("output_0")->data.f, outputs[0]);
+  EXPECT_EQ(outputs[0][0], 4);
+  EXPECT_EQ(outputs[0][1], 6);
+
+  // Rebinding swaps the buffers for the next invocation.
+  ASSERT_EQ(runner->BindInputBuffer("x", buffer(inputs[1])), kTfLiteOk);
+  ASSERT_EQ(runner->BindOutputBuffer("output_0", buffer(outputs[1])),
+            kTfLiteOk);
+  ASSERT_EQ(runner->Invoke(), kTfLiteOk);
+  EXPECT_EQ(runner->input_tensor("x")->data.f, inputs[1]);
+  EXPECT_EQ(runner->output_tensor("output_0")->data.f, outputs[1]);
+  EXPECT_EQ(outputs[1][0], 5);
+  EXPECT_EQ(outputs[1][1], 7);
+  EXPECT_EQ(outputs[0][0], 4);
+
+  // Buffers which are too small or misaligned are rejected.
+  EXPECT_EQ(runner->BindInputBuffer(
+                "x", TfLiteCustomAllocation{inputs[0], sizeof(float)}),
+            kTfLiteError);
+  EXPECT_EQ(runner->BindInputBuffer("x", buffer(inputs[0] + 1)), kTfLiteError);
+  EXPECT_EQ(runner->input_tensor("x")->data.f, inputs[1]);
+}
+
 }  // namespace
 }  // namespace impl
 }  // namespace tflite
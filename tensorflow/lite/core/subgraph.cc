@@ -191,6 +191,10 @@ TfLiteStatus VerifyCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+// The CPU backend context of the current thread while it invokes nodes
+// concurrently with other threads, see `Subgraph::InvokeConcurrently()`.
+thread_local TfLiteExternalContext* inter_op_cpu_backend_context = nullptr;
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -616,6 +620,10 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      inter_op_cpu_backend_context != nullptr) {
+    return inter_op_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1249,6 +1257,18 @@ TfLiteStatus Subgraph::ReleaseNonPersistentMemory() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::ShareNonPersistentArenaWith(Subgraph* other) {
+  TF_LITE_ENSURE(&context_, memory_planner_ && other->memory_planner_);
+#ifndef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+  // Both planners are created by `PrepareOpsAndTensors` as `ArenaPlanner`.
+  TF_LITE_ENSURE_STATUS(
+      static_cast<ArenaPlanner*>(memory_planner_.get())
+          ->ShareNonPersistentMemoryWith(
+              *static_cast<ArenaPlanner*>(other->memory_planner_.get())));
+#endif
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ReleaseMemory() {
   state_ = kStateUninvokable;
   ReleaseNonPersistentMemory();
@@ -1539,6 +1559,7 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #endif
     memory_planner_->PlanAllocations();
   }
+  UpdateConcurrentNodeGroups();
 
   // Execute arena allocations.
   TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
@@ -1576,6 +1597,176 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   return kTfLiteOk;
 }
 
+void Subgraph::UpdateConcurrentNodeGroups() {
+#ifndef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+  concurrent_node_groups_.clear();
+  const int num_threads = options_ ? options_->GetNumInterOpThreads() : 1;
+  if (num_threads > 1 && !profiler_ && !has_dynamic_tensors_ &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    // A node joins the current group if it doesn't read the outputs of the
+    // group, so that it could run in any order with the nodes of the group.
+    std::unordered_set<int> group_outputs;
+    int group_start = 0;
+    bool group_is_barrier = false;
+    bool has_concurrent_nodes = false;
+    for (int i = 0; i < execution_plan_.size(); ++i) {
+      const auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[i]];
+      const bool is_barrier = IsConcurrencyBarrier(node, registration);
+      bool joins_group = i > group_start && i - group_start < num_threads &&
+                         !group_is_barrier && !is_barrier;
+      for (int j = 0; joins_group && j < node.inputs->size; ++j) {
+        joins_group = group_outputs.count(node.inputs->data[j]) == 0;
+      }
+      if (i > 0 && !joins_group) {
+        concurrent_node_groups_.emplace_back(group_start, i - 1);
+        group_start = i;
+        group_outputs.clear();
+      }
+      has_concurrent_nodes |= joins_group;
+      group_is_barrier = is_barrier;
+      group_outputs.insert(node.outputs->data,
+                           node.outputs->data + node.outputs->size);
+    }
+    if (has_concurrent_nodes) {
+      concurrent_node_groups_.emplace_back(group_start,
+                                           execution_plan_.size() - 1);
+    } else {
+      concurrent_node_groups_.clear();
+    }
+  }
+  if (!concurrent_node_groups_.empty() &&
+      (!inter_op_thread_pool_ ||
+       inter_op_thread_pool_->num_threads() != num_threads)) {
+    inter_op_thread_pool_ = std::make_unique<InterOpThreadPool>(num_threads);
+    inter_op_cpu_backend_contexts_.clear();
+    for (int thread = 1; thread < num_threads; ++thread) {
+      inter_op_cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+  }
+  static_cast<ArenaPlanner*>(memory_planner_.get())
+      ->SetConcurrentNodeGroups(concurrent_node_groups_);
+#endif  // TFLITE_USE_SIMPLE_MEMORY_PLANNER
+}
+
+bool Subgraph::IsConcurrencyBarrier(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  if (node.delegate != nullptr) return true;
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinDelegate:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinStablehloComposite:
+    case kTfLiteBuiltinStablehloWhile:
+    case kTfLiteBuiltinWhile:
+      return true;
+    default:
+      break;
+  }
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrently() {
+  for (const auto& context : inter_op_cpu_backend_contexts_) {
+    if (context->internal_backend_context() &&
+        context_.recommended_num_threads != -1) {
+      context->internal_backend_context()->SetMaxNumThreads(
+          context_.recommended_num_threads);
+    }
+  }
+  std::vector<TfLiteStatus> statuses;
+  for (const auto& [first, last] : concurrent_node_groups_) {
+    for (int i = first; i <= last; ++i) {
+      const auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[i]];
+      TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    EnsureTensorsVectorCapacity();
+    statuses.assign(last - first + 1, kTfLiteOk);
+    inter_op_thread_pool_->Run(last - first + 1, [&](int task, int thread) {
+      inter_op_cpu_backend_context =
+          thread == 0 ? nullptr
+                      : inter_op_cpu_backend_contexts_[thread - 1].get();
+      auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[first + task]];
+      statuses[task] = OpInvoke(registration, &node);
+      inter_op_cpu_backend_context = nullptr;
+    });
+    // Errors are reported in node order, by the calling thread.
+    for (int task = 0; task < statuses.size(); ++task) {
+      if (statuses[task] == kTfLiteOk) continue;
+      const int node_index = execution_plan_[first + task];
+      const auto& [node, registration] = nodes_and_registration_[node_index];
+      auto err = ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+      return statuses[task] == kTfLiteCancelled ? kTfLiteCancelled : err;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::EnsureOpInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::RemoveUnusedInputs() {
   std::vector<int> input_tensors_count = GetInputTensorsCount();
   // Mark unused inputs as kTfLiteOptionalTensor.
@@ -1608,6 +1799,12 @@ TfLiteStatus Subgraph::InvokeImpl() {
     ReportError("Non-persistent memory is not available.");
     return kTfLiteError;
   }
+  // Nodes are invoked one after the other when profiling, or when not all
+  // of them are prepared anymore.
+  if (!concurrent_node_groups_.empty() && !profiler_ &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    return InvokeConcurrently();
+  }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tensorflow::profiler::TraceMe* trace_subgraph =
@@ -1648,37 +1845,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureOpInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -35,9 +35,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -481,6 +483,21 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if the branch subgraphs of control flow ops should share their arenas.
+  bool ShouldShareControlFlowArenas() const {
+    return (options_ && options_->GetShareControlFlowArenas() &&
+            !options_->GetPreserveAllTensors());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Makes the non-persistent tensors of this subgraph use the same arena
+  // buffer as the ones of `other`. The two subgraphs must never be in use at
+  // the same time, and the tensors of one are invalidated when the other is
+  // allocated. Both subgraphs must have allocated tensors. It's a no-op if
+  // the memory planner doesn't use arenas.
+  TfLiteStatus ShareNonPersistentArenaWith(Subgraph* other);
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -727,6 +744,25 @@ class Subgraph {
   // Does not report invoke status through profiler.
   TfLiteStatus InvokeImpl();
 
+  // Makes the inputs of 'node' readable, and checks that they have data.
+  TfLiteStatus EnsureOpInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Splits the execution plan into groups of consecutive nodes which don't
+  // depend on each other, if ops are invoked concurrently as set by
+  // InterpreterOptions::SetNumInterOpThreads(). Must be called once the whole
+  // execution plan is prepared, before executing the allocations.
+  void UpdateConcurrentNodeGroups();
+
+  // Returns true if 'node' must not be invoked concurrently with other nodes,
+  // e.g. because it has side effects or invokes other subgraphs.
+  bool IsConcurrencyBarrier(const TfLiteNode& node,
+                            const TfLiteRegistration& registration) const;
+
+  // Invokes the groups of `concurrent_node_groups_` one after the other, and
+  // the nodes of each group concurrently.
+  TfLiteStatus InvokeConcurrently();
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -1164,6 +1200,18 @@ class Subgraph {
   // Maps tensor constant buffers used in the subgraph to a model-wide
   // identifiers.
   std::unordered_map<size_t, size_t> tensor_buffer_identifiers_;
+
+  // Groups of consecutive execution plan indices whose nodes are invoked
+  // concurrently, as pairs of the first and the last index. Empty if ops are
+  // invoked one after the other.
+  std::vector<std::pair<int, int>> concurrent_node_groups_;
+
+  // The threads invoking the nodes of `concurrent_node_groups_`, and the CPU
+  // backend contexts of all of them but the calling thread, which uses the one
+  // of the interpreter.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_cpu_backend_contexts_;
 };
 
 }  // namespace tflite
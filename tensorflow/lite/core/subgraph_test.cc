@@ -124,6 +124,43 @@ TEST(MarkSubgraphAsDelegationSkippable, MarkSubgraphAsDelegationSkippable) {
   ASSERT_TRUE(subgraphs[1]->IsDelegationSkippable());
 }
 
+TEST(InterOpParallelism, InvokesIndependentOpsConcurrently) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetNumInterOpThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  // Two independent chains of two NEG ops each.
+  subgraph.AddTensors(5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {256}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({3, 4});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({0}, {1}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({0}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {3}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({2}, {4}, {}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  for (int invocation = 0; invocation < 3; ++invocation) {
+    float* input = subgraph.tensor(0)->data.f;
+    std::iota(input, input + 256, invocation);
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    std::vector<float> expected(256);
+    std::iota(expected.begin(), expected.end(), invocation);
+    for (const int output : {3, 4}) {
+      const float* data = subgraph.tensor(output)->data.f;
+      EXPECT_THAT(std::vector<float>(data, data + 256),
+                  ElementsAreArray(expected))
+          << "tensor " << output;
+    }
+  }
+}
+
 // Helper to get the minimal buffer size to allocate for a buffer of given
 // shape.
 size_t BytesFor(const TfLiteType type, const int* const data,
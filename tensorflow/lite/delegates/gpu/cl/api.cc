@@ -694,6 +694,11 @@ CreateGpuModelInfo GetCreateInfo(const Environment& environment,
   CreateGpuModelInfo create_info;
   create_info.precision = GetPrecision(environment, options);
   create_info.storage_type = GetStorageTypeFromOptions(environment, options);
+  if (create_info.precision == CalculationsPrecision::F32_F16) {
+    // Precision is the second priority, so the operations that are the most
+    // sensitive to it aren't run in F16.
+    create_info.hints.Add(ModelHints::kMixedPrecision);
+  }
   if (options.usage == InferenceUsage::FAST_SINGLE_ANSWER) {
     create_info.hints.Add(ModelHints::kReduceKernelsCount);
     create_info.hints.Add(ModelHints::kFastTuning);
@@ -962,7 +967,14 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
         CreateProfilingCommandQueue(device, context, &profiling_queue));
     environment_ = Environment(std::move(device), std::move(context),
                                std::move(queue), std::move(profiling_queue));
-    return environment_.Init();
+    RETURN_IF_ERROR(environment_.Init());
+    if (environment_.program_cache() && !options_.program_cache_dir.empty()) {
+      environment_.program_cache()->SetPersistentCache(
+          std::make_unique<PersistentProgramCache>(
+              options_.program_cache_dir,
+              options_.program_cache_max_size_bytes));
+    }
+    return absl::OkStatus();
   }
 
   absl::Status BuildSerializedModel(
@@ -24,9 +24,11 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/persistent_program_cache.h"
 #include "tensorflow/lite/delegates/gpu/common/model.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
 
@@ -129,6 +131,15 @@ struct InferenceEnvironmentOptions {
   // incompatible when GPU driver is updated.
   absl::Span<const uint8_t> serialized_binary_cache;
 
+  // If set, compiled programs are also cached in this directory, which may be
+  // shared by all the models of an app, and reused across launches. The
+  // directory must exist and should be private to the app.
+  std::string program_cache_dir;
+  // Size above which the least recently used programs are deleted from
+  // program_cache_dir.
+  uint64_t program_cache_max_size_bytes =
+      PersistentProgramCache::kDefaultMaxSizeBytes;
+
   bool IsGlAware() const {
     return egl_context != EGL_NO_CONTEXT && egl_display != EGL_NO_DISPLAY;
   }
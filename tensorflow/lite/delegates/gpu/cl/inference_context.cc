@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/task/tensor_desc.h"
 #include "tensorflow/lite/delegates/gpu/common/types.h"
 #include "tensorflow/lite/delegates/gpu/common/util.h"
+#include <farmhash.h>
 
 namespace tflite {
 namespace gpu {
@@ -293,6 +294,9 @@ void InferenceContext::ExecutionHints::Init(const GpuInfo& gpu_info) {
     need_flush = false;
     flush_periodically = false;
   }
+  use_command_buffer = gpu_info.SupportsExtension("cl_khr_command_buffer") &&
+                       clCreateCommandBufferKHR && clCommandNDRangeKernelKHR &&
+                       clFinalizeCommandBufferKHR && clEnqueueCommandBufferKHR;
 }
 
 absl::Status InferenceContext::InitFromGraph(
@@ -357,8 +361,7 @@ absl::Status InferenceContext::InitFromGpuModel(
       tuning_type = TuningType::kFast;
     }
   }
-  RETURN_IF_ERROR(
-      Tune(tuning_type, env->device().GetInfo(), env->profiling_queue()));
+  RETURN_IF_ERROR(TuneOrRestoreWorkGroupSizes(tuning_type, env));
   if (external_mutable_tensors_.empty()) {
     // using recordable queue only when no mutable external tensors
     InitRecordableQueue(env);
@@ -787,7 +790,58 @@ absl::Status InferenceContext::Tune(TuningType tuning_type,
   return absl::OkStatus();
 }
 
+uint64_t InferenceContext::GetTuningFingerprint(TuningType tuning_type) const {
+  std::vector<int64_t> key = {static_cast<int64_t>(tuning_type)};
+  for (const auto& node : nodes_) {
+    key.push_back(node.cl_operation.GetKernelFingerprint());
+    const GPUOperation& op = node.cl_operation.GetGpuOperation();
+    for (const auto* tensors : {&op.GetSrcTensors(), &op.GetDstTensors()}) {
+      for (const GpuSpatialTensor* tensor : *tensors) {
+        if (!tensor) continue;
+        key.insert(key.end(), {tensor->Batch(), tensor->Width(),
+                               tensor->Height(), tensor->Depth(),
+                               tensor->Channels()});
+      }
+    }
+  }
+  return ::util::Fingerprint64(reinterpret_cast<const char*>(key.data()),
+                               key.size() * sizeof(int64_t));
+}
+
+absl::Status InferenceContext::TuneOrRestoreWorkGroupSizes(
+    TuningType tuning_type, Environment* env) {
+  const GpuInfo& gpu_info = env->device().GetInfo();
+  // Fast tuning doesn't run the kernels, so it isn't worth persisting.
+  if (tuning_type == TuningType::kFast) {
+    return Tune(tuning_type, gpu_info, env->profiling_queue());
+  }
+  const uint64_t fingerprint = GetTuningFingerprint(tuning_type);
+  std::vector<int3> work_group_sizes;
+  if (env->program_cache()
+          ->GetWorkGroupSizes(env->device(), fingerprint, &work_group_sizes)
+          .ok() &&
+      work_group_sizes.size() == nodes_.size()) {
+    for (int i = 0; i < nodes_.size(); ++i) {
+      GPUOperation& op = nodes_[i].cl_operation.GetGpuOperation();
+      op.work_group_size_ = work_group_sizes[i];
+      op.RecalculateWorkGroupsCount();
+    }
+    return absl::OkStatus();
+  }
+  RETURN_IF_ERROR(Tune(tuning_type, gpu_info, env->profiling_queue()));
+  work_group_sizes.clear();
+  for (const auto& node : nodes_) {
+    work_group_sizes.push_back(node.cl_operation.GetWorkGroupSize());
+  }
+  // Ignore returned error. The model is tuned again next time.
+  env->program_cache()
+      ->AddWorkGroupSizes(env->device(), fingerprint, work_group_sizes)
+      .IgnoreError();
+  return absl::OkStatus();
+}
+
 absl::Status InferenceContext::UpdateParams() {
+  command_buffer_ = CLCommandBuffer();
   for (auto& node : nodes_) {
     RETURN_IF_ERROR(node.cl_operation.UpdateParams());
   }
@@ -800,6 +854,9 @@ absl::Status InferenceContext::SetTensor(const ValueId& tensor_id,
   if (it == external_mutable_tensors_.end()) {
     return absl::InvalidArgumentError("No external tensor with this id.");
   }
+  if (it->second != tensor_ptr) {
+    command_buffer_ = CLCommandBuffer();
+  }
   external_mutable_tensors_[tensor_id] = tensor_ptr;
   for (int node_index : external_tensor_to_nodes_[tensor_id]) {
     auto& node = nodes_[node_index];
@@ -840,10 +897,45 @@ void InferenceContext::PrepareExternal() {
   }
 }
 
+absl::Status InferenceContext::RecordCommandBuffer(CLCommandQueue* queue) {
+  // The kernel arguments may have changed for the new recording, so the
+  // replays of the previous one must be done.
+  if (command_buffer_event_.is_valid()) {
+    command_buffer_event_.Wait();
+    command_buffer_event_ = CLEvent();
+  }
+  command_buffer_ = CLCommandBuffer();
+  CLCommandBuffer command_buffer;
+  RETURN_IF_ERROR(command_buffer.Init(queue, /*simultaneous_use=*/true));
+  RETURN_IF_ERROR(AddToCommanBuffer(command_buffer.GetCommandBuffer()));
+  RETURN_IF_ERROR(command_buffer.Finalize());
+  command_buffer_ = std::move(command_buffer);
+  command_buffer_queue_ = queue->queue();
+  return absl::OkStatus();
+}
+
 absl::Status InferenceContext::AddToQueue(CLCommandQueue* queue) {
   if (recordable_queue_ && recordable_queue_->IsSupported()) {
     return recordable_queue_->Execute(queue);
   }
+  if (execution_hints_.use_command_buffer) {
+    if (!command_buffer_.GetCommandBuffer() ||
+        command_buffer_queue_ != queue->queue()) {
+      execution_hints_.use_command_buffer = RecordCommandBuffer(queue).ok();
+    }
+    if (execution_hints_.use_command_buffer) {
+      execution_hints_.use_command_buffer =
+          command_buffer_.Enqueue(queue, &command_buffer_event_).ok();
+    }
+    if (execution_hints_.use_command_buffer) {
+      if (execution_hints_.need_flush) {
+        clFlush(queue->queue());
+      }
+      return absl::OkStatus();
+    }
+    // Falls back to enqueuing the kernels one by one.
+    command_buffer_ = CLCommandBuffer();
+  }
   if (execution_hints_.need_manual_release) {
     if (execution_hints_.prev_enqueue_start_point.is_valid()) {
       execution_hints_.prev_enqueue_start_point.Wait();
@@ -25,7 +25,9 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/lite/delegates/gpu/cl/buffer.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_command_buffer.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_event.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_operation.h"
 #include "tensorflow/lite/delegates/gpu/cl/environment.h"
 #include "tensorflow/lite/delegates/gpu/cl/gpu_object.h"
@@ -142,11 +144,21 @@ class InferenceContext {
   absl::Status Compile(const CreationContext& creation_context);
   absl::Status Tune(TuningType tuning_type, const GpuInfo& gpu_info,
                     ProfilingCommandQueue* profiling_queue);
+  // Fingerprint of the kernels and tensor shapes, that determine the tuned
+  // work group sizes on a given device.
+  uint64_t GetTuningFingerprint(TuningType tuning_type) const;
+  // Restores the work group sizes tuned by a previous initialization of the
+  // same model from the persistent program cache, or tunes and stores them.
+  absl::Status TuneOrRestoreWorkGroupSizes(TuningType tuning_type,
+                                           Environment* env);
   absl::Status UpdateParams();
   void PrepareExternal();
 
   void InitRecordableQueue(Environment* env);
 
+  // Records the kernels of all nodes into command_buffer_.
+  absl::Status RecordCommandBuffer(CLCommandQueue* queue);
+
   absl::Status ProfileTime(ProfilingCommandQueue* queue, ProfilingInfo* result);
   absl::Status ClarifyTimeMultipleEnqueue(double ops_total_duration_ms,
                                           int min_ops, int max_ops,
@@ -169,6 +181,11 @@ class InferenceContext {
     bool need_manual_release = false;
     CLEvent prev_enqueue_start_point;
 
+    // With cl_khr_command_buffer, the kernels of the whole inference are
+    // recorded into a command buffer at the first run, which is then replayed
+    // with a single enqueue. Reset if recording or replaying fails.
+    bool use_command_buffer = false;
+
     void Init(const GpuInfo& gpu_info);
   };
   ExecutionHints execution_hints_;
@@ -203,6 +220,16 @@ class InferenceContext {
 
   std::unique_ptr<RecordableQueue> recordable_queue_ = nullptr;
 
+  // Recorded inference, for the queue command_buffer_queue_. Kernel arguments
+  // are captured when recording, so it is reset whenever they change.
+  CLCommandBuffer command_buffer_;
+  cl_command_queue command_buffer_queue_ = nullptr;
+  // Completion of the last replay. The command buffer is created for
+  // simultaneous use, so replays are enqueued without waiting for the previous
+  // ones, and the in-order queue runs them one after the other. Only
+  // re-recording waits for it.
+  CLEvent command_buffer_event_;
+
   GpuInfo gpu_info_;
 };
 
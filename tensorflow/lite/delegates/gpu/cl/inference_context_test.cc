@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/inference_context.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/cl/cl_test.h"
+#include "tensorflow/lite/delegates/gpu/cl/environment.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_model.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/operations.h"
+#include "tensorflow/lite/delegates/gpu/common/precision.h"
+#include "tensorflow/lite/delegates/gpu/common/shape.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/tensor.h"
+
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+// input -> relu -> output
+void BuildReluGraph(const BHWC& shape, GraphFloat32* graph) {
+  Node* node = graph->NewNode();
+  node->operation.type = ToString(OperationType::RELU);
+  node->operation.attributes = ReLUAttributes();
+  Value* input = graph->NewValue();
+  input->tensor.shape = shape;
+  Value* output = graph->NewValue();
+  output->tensor.shape = shape;
+  ASSERT_OK(graph->AddConsumer(node->id, input->id));
+  ASSERT_OK(graph->SetProducer(node->id, output->id));
+}
+
+// Runs the inference `num_runs` times without waiting in between, which the
+// command buffer path replays with one enqueue each, and returns the output.
+std::vector<float> Run(InferenceContext* context, CLCommandQueue* queue,
+                       const std::vector<float>& input_data, int num_runs) {
+  TensorFloat32 input;
+  input.id = context->GetInputIds()[0];
+  input.shape = BHWC(1, 2, 2, 2);
+  input.data = input_data;
+  EXPECT_TRUE(context->SetInputTensor(input.id, input, queue).ok());
+  for (int i = 0; i < num_runs; ++i) {
+    EXPECT_TRUE(context->AddToQueue(queue).ok());
+  }
+  TensorFloat32 output;
+  EXPECT_TRUE(
+      context->GetOutputTensor(context->GetOutputIds()[0], queue, &output)
+          .ok());
+  return output.data;
+}
+
+TEST_F(OpenCLTest, InferenceContextRepeatedRunsUseCurrentInput) {
+  GraphFloat32 graph;
+  BuildReluGraph(BHWC(1, 2, 2, 2), &graph);
+  CreateGpuModelInfo create_info;
+  create_info.precision = CalculationsPrecision::F32;
+  create_info.storage_type = GetFastestStorageType(env_.device().GetInfo());
+  InferenceContext context;
+  ASSERT_OK(context.InitFromGraph(create_info, graph, &env_));
+
+  // Whether the device records a command buffer or falls back to enqueuing
+  // the kernels one by one, every run must read the input written last.
+  const std::vector<float> input0 = {-1, 2, -3, 4, 5, -6, 7, -8};
+  const std::vector<float> expected0 = {0, 2, 0, 4, 5, 0, 7, 0};
+  EXPECT_THAT(Run(&context, env_.queue(), input0, /*num_runs=*/3),
+              Pointwise(FloatNear(0.0f), expected0));
+  const std::vector<float> input1 = {1, -2, 3, -4, -5, 6, -7, 8};
+  const std::vector<float> expected1 = {1, 0, 3, 0, 0, 6, 0, 8};
+  EXPECT_THAT(Run(&context, env_.queue(), input1, /*num_runs=*/3),
+              Pointwise(FloatNear(0.0f), expected1));
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
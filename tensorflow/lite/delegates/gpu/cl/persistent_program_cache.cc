@@ -0,0 +1,274 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/persistent_program_cache.h"
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif  // !defined(_WIN32)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/delegates/gpu/cl/compiled_program_cache_generated.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+#include <farmhash.h>
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+constexpr char kFilePrefix[] = "gpu_cl_program_";
+// Matches the file_extension of compiled_program_cache.fbs.
+constexpr char kFileSuffix[] = ".jetbin";
+// Distinguishes the work group sizes of a model from a program with the same
+// fingerprint.
+constexpr uint64_t kWorkGroupSizesSalt = 0x9e3779b97f4a7c15ULL;
+constexpr size_t kWorkGroupSizeBytes = 3 * sizeof(int32_t);
+
+// Farmhash Fingerprint
+inline uint64_t CombineFingerprints(uint64_t l, uint64_t h) {
+  // Murmur-inspired hashing.
+  const uint64_t kMul = 0x9ddfea08eb382d69ULL;
+  uint64_t a = (l ^ h) * kMul;
+  a ^= (a >> 47);
+  uint64_t b = (h ^ a) * kMul;
+  b ^= (b >> 44);
+  b *= kMul;
+  b ^= (b >> 41);
+  b *= kMul;
+  return b;
+}
+
+std::string JoinPath(const std::string& directory, const std::string& name) {
+  return (!directory.empty() && directory.back() == '/')
+             ? directory + name
+             : absl::StrCat(directory, "/", name);
+}
+
+#if !defined(_WIN32)
+absl::Status ReadFile(const std::string& path, std::vector<uint8_t>* data) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(absl::StrCat("No cached program at ", path));
+  }
+  data->clear();
+  uint8_t buffer[4096];
+  while (true) {
+    const ssize_t bytes_read = read(fd, buffer, sizeof(buffer));
+    if (bytes_read == 0) break;
+    if (bytes_read < 0) {
+      close(fd);
+      return absl::UnavailableError(absl::StrCat("Failed to read ", path));
+    }
+    data->insert(data->end(), buffer, buffer + bytes_read);
+  }
+  close(fd);
+  return absl::OkStatus();
+}
+
+absl::Status WriteFileAtomically(const std::string& path,
+                                 const uint8_t* data, size_t size) {
+  // Another process may write the same program concurrently, so the temporary
+  // file name is unique per process.
+  const std::string temp_path =
+      absl::StrCat(path, ".", getpid(), ".", time(nullptr), ".tmp");
+  const int fd =
+      open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return absl::UnavailableError(absl::StrCat("Failed to open ", temp_path));
+  }
+  size_t written = 0;
+  while (written < size) {
+    const ssize_t ret = write(fd, data + written, size - written);
+    if (ret <= 0) {
+      close(fd);
+      unlink(temp_path.c_str());
+      return absl::UnavailableError(
+          absl::StrCat("Failed to write ", temp_path));
+    }
+    written += ret;
+  }
+  if (close(fd) < 0 || rename(temp_path.c_str(), path.c_str()) < 0) {
+    unlink(temp_path.c_str());
+    return absl::UnavailableError(absl::StrCat("Failed to write ", path));
+  }
+  return absl::OkStatus();
+}
+#endif  // !defined(_WIN32)
+
+}  // namespace
+
+PersistentProgramCache::PersistentProgramCache(const std::string& directory,
+                                               uint64_t max_size_bytes)
+    : directory_(directory), max_size_bytes_(max_size_bytes) {}
+
+std::string PersistentProgramCache::GetFilePath(
+    const std::string& driver_version, uint64_t fingerprint) const {
+  const uint64_t key =
+      CombineFingerprints(fingerprint, ::util::Fingerprint64(driver_version));
+  return JoinPath(directory_, absl::StrCat(kFilePrefix, key, kFileSuffix));
+}
+
+absl::Status PersistentProgramCache::Load(const std::string& driver_version,
+                                          uint64_t fingerprint,
+                                          std::vector<uint8_t>* binary) const {
+#if defined(_WIN32)
+  return absl::NotFoundError("Persistent program cache is not supported.");
+#else
+  const std::string path = GetFilePath(driver_version, fingerprint);
+  std::vector<uint8_t> data;
+  RETURN_IF_ERROR(ReadFile(path, &data));
+  flatbuffers::Verifier verifier(data.data(), data.size());
+  if (!data::VerifyCompiledCacheBuffer(verifier)) {
+    return absl::DataLossError(absl::StrCat("Corrupted cached program ", path));
+  }
+  const data::CompiledCache* cache = data::GetCompiledCache(data.data());
+  // The file name is only a hash, so the key is checked in full.
+  if (!cache->driver_version() || !cache->programs() ||
+      cache->driver_version()->str() != driver_version ||
+      cache->programs()->size() != 1 ||
+      cache->programs()->Get(0)->fingerprint() != fingerprint ||
+      !cache->programs()->Get(0)->binary()) {
+    return absl::NotFoundError(absl::StrCat("No cached program at ", path));
+  }
+  const auto* program_binary = cache->programs()->Get(0)->binary();
+  binary->assign(program_binary->begin(), program_binary->end());
+  // Marks the program as recently used for the eviction.
+  utime(path.c_str(), nullptr);
+  return absl::OkStatus();
+#endif  // defined(_WIN32)
+}
+
+absl::Status PersistentProgramCache::Store(
+    const std::string& driver_version, uint64_t fingerprint,
+    absl::Span<const uint8_t> binary) const {
+#if defined(_WIN32)
+  return absl::OkStatus();
+#else
+  ::flatbuffers::FlatBufferBuilder builder;
+  auto binary_offset = builder.CreateVector(binary.data(), binary.size());
+  data::ProgramBuilder program_builder(builder);
+  program_builder.add_fingerprint(fingerprint);
+  program_builder.add_binary(binary_offset);
+  std::vector<flatbuffers::Offset<data::Program>> programs = {
+      program_builder.Finish()};
+  auto driver_version_offset = builder.CreateString(driver_version);
+  auto programs_offset = builder.CreateVector(programs);
+  data::CompiledCacheBuilder cache_builder(builder);
+  cache_builder.add_driver_version(driver_version_offset);
+  cache_builder.add_programs(programs_offset);
+  data::FinishCompiledCacheBuffer(builder, cache_builder.Finish());
+  const std::string path = GetFilePath(driver_version, fingerprint);
+  RETURN_IF_ERROR(WriteFileAtomically(path, builder.GetBufferPointer(),
+                                      builder.GetSize()));
+  EvictLeastRecentlyUsed(path);
+  return absl::OkStatus();
+#endif  // defined(_WIN32)
+}
+
+absl::Status PersistentProgramCache::LoadWorkGroupSizes(
+    const std::string& driver_version, uint64_t fingerprint,
+    std::vector<int3>* work_group_sizes) const {
+  std::vector<uint8_t> data;
+  RETURN_IF_ERROR(Load(driver_version,
+                       CombineFingerprints(fingerprint, kWorkGroupSizesSalt),
+                       &data));
+  if (data.size() % kWorkGroupSizeBytes != 0) {
+    return absl::DataLossError("Corrupted cached work group sizes.");
+  }
+  work_group_sizes->resize(data.size() / kWorkGroupSizeBytes);
+  for (int i = 0; i < work_group_sizes->size(); ++i) {
+    int32_t size[3];
+    std::memcpy(size, data.data() + i * kWorkGroupSizeBytes,
+                kWorkGroupSizeBytes);
+    (*work_group_sizes)[i] = int3(size[0], size[1], size[2]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status PersistentProgramCache::StoreWorkGroupSizes(
+    const std::string& driver_version, uint64_t fingerprint,
+    const std::vector<int3>& work_group_sizes) const {
+  std::vector<uint8_t> data(work_group_sizes.size() * kWorkGroupSizeBytes);
+  for (int i = 0; i < work_group_sizes.size(); ++i) {
+    const int32_t size[3] = {work_group_sizes[i].x, work_group_sizes[i].y,
+                             work_group_sizes[i].z};
+    std::memcpy(data.data() + i * kWorkGroupSizeBytes, size,
+                kWorkGroupSizeBytes);
+  }
+  return Store(driver_version,
+               CombineFingerprints(fingerprint, kWorkGroupSizesSalt), data);
+}
+
+void PersistentProgramCache::EvictLeastRecentlyUsed(
+    const std::string& keep_path) const {
+#if !defined(_WIN32)
+  DIR* dir = opendir(directory_.c_str());
+  if (dir == nullptr) return;
+  struct CachedFile {
+    std::string path;
+    time_t last_used;
+    uint64_t size;
+  };
+  std::vector<CachedFile> files;
+  uint64_t total_size = 0;
+  while (const dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (!absl::StartsWith(name, kFilePrefix) ||
+        !absl::EndsWith(name, kFileSuffix)) {
+      continue;
+    }
+    const std::string path = JoinPath(directory_, name);
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) != 0) continue;
+    files.push_back({path, file_stat.st_mtime,
+                     static_cast<uint64_t>(file_stat.st_size)});
+    total_size += file_stat.st_size;
+  }
+  closedir(dir);
+  if (total_size <= max_size_bytes_) return;
+  std::sort(files.begin(), files.end(),
+            [](const CachedFile& a, const CachedFile& b) {
+              return a.last_used < b.last_used;
+            });
+  for (const CachedFile& file : files) {
+    if (total_size <= max_size_bytes_) break;
+    if (file.path == keep_path) continue;
+    // Another process may have deleted the file already.
+    unlink(file.path.c_str());
+    total_size -= file.size;
+  }
+#endif  // !defined(_WIN32)
+}
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_PERSISTENT_PROGRAM_CACHE_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_CL_PERSISTENT_PROGRAM_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+
+// Directory of compiled OpenCL program binaries that is shared by all the
+// models, so that kernels common to several models are compiled only once.
+//
+// Every program is stored in its own file, named after the fingerprint of its
+// source code and compiler options and of the driver version, that holds a
+// CompiledCache flatbuffer with a single program. Files are written
+// atomically, so several processes can share the directory. Once the files
+// take more than `max_size_bytes`, the least recently used ones are deleted.
+// The work group sizes tuned for a model are stored the same way, so that the
+// tuning runs once per device and model.
+//
+// Only supported on POSIX systems. Elsewhere, Load() always returns NotFound
+// and Store() does nothing.
+class PersistentProgramCache {
+ public:
+  static constexpr uint64_t kDefaultMaxSizeBytes = 64 * 1024 * 1024;
+
+  explicit PersistentProgramCache(
+      const std::string& directory,
+      uint64_t max_size_bytes = kDefaultMaxSizeBytes);
+
+  // Reads the binary of the program with `fingerprint` compiled by the driver
+  // with `driver_version`. Returns NotFound if it isn't cached.
+  absl::Status Load(const std::string& driver_version, uint64_t fingerprint,
+                    std::vector<uint8_t>* binary) const;
+
+  // Stores the binary of the program with `fingerprint`, and evicts the least
+  // recently used programs if the cache gets too big.
+  absl::Status Store(const std::string& driver_version, uint64_t fingerprint,
+                     absl::Span<const uint8_t> binary) const;
+
+  // Reads the work group sizes tuned on the driver with `driver_version` for
+  // the model with `fingerprint`. Returns NotFound if they aren't cached.
+  absl::Status LoadWorkGroupSizes(const std::string& driver_version,
+                                  uint64_t fingerprint,
+                                  std::vector<int3>* work_group_sizes) const;
+
+  // Stores the work group sizes tuned for the model with `fingerprint`. They
+  // are evicted like the programs.
+  absl::Status StoreWorkGroupSizes(
+      const std::string& driver_version, uint64_t fingerprint,
+      const std::vector<int3>& work_group_sizes) const;
+
+ private:
+  std::string GetFilePath(const std::string& driver_version,
+                          uint64_t fingerprint) const;
+  // Deletes the least recently used files other than `keep_path` until the
+  // cache fits in max_size_bytes_.
+  void EvictLeastRecentlyUsed(const std::string& keep_path) const;
+
+  std::string directory_;
+  uint64_t max_size_bytes_;
+};
+
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_CL_PERSISTENT_PROGRAM_CACHE_H_
@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/persistent_program_cache.h"
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/common/types.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+constexpr char kDriverVersion[] = "OpenCL 3.0 driver_jet_version_0";
+
+std::string MakeCacheDir(const std::string& name) {
+  const std::string dir = ::testing::TempDir() + "/" + name;
+  mkdir(dir.c_str(), 0700);
+  return dir;
+}
+
+TEST(PersistentProgramCacheTest, StoreAndLoad) {
+  const std::string dir = MakeCacheDir("store_and_load");
+  const std::vector<uint8_t> binary = {1, 2, 3, 4, 5};
+  {
+    PersistentProgramCache cache(dir);
+    ASSERT_TRUE(cache.Store(kDriverVersion, /*fingerprint=*/42, binary).ok());
+  }
+
+  // A cache on the same directory, e.g. in another process, finds it.
+  PersistentProgramCache cache(dir);
+  std::vector<uint8_t> loaded;
+  ASSERT_TRUE(cache.Load(kDriverVersion, /*fingerprint=*/42, &loaded).ok());
+  EXPECT_EQ(loaded, binary);
+
+  EXPECT_TRUE(absl::IsNotFound(
+      cache.Load(kDriverVersion, /*fingerprint=*/43, &loaded)));
+  EXPECT_TRUE(absl::IsNotFound(
+      cache.Load("OpenCL 3.0 other_driver", /*fingerprint=*/42, &loaded)));
+}
+
+TEST(PersistentProgramCacheTest, EvictsLeastRecentlyUsed) {
+  const std::string dir = MakeCacheDir("evicts_least_recently_used");
+  const std::vector<uint8_t> binary(1000, 7);
+  // Fits two programs, but not three.
+  PersistentProgramCache cache(dir, /*max_size_bytes=*/2500);
+  ASSERT_TRUE(cache.Store(kDriverVersion, /*fingerprint=*/1, binary).ok());
+  ASSERT_TRUE(cache.Store(kDriverVersion, /*fingerprint=*/2, binary).ok());
+  ASSERT_TRUE(cache.Store(kDriverVersion, /*fingerprint=*/3, binary).ok());
+
+  std::vector<uint8_t> loaded;
+  // The program just stored is never evicted.
+  EXPECT_TRUE(cache.Load(kDriverVersion, /*fingerprint=*/3, &loaded).ok());
+  const int num_cached =
+      cache.Load(kDriverVersion, /*fingerprint=*/1, &loaded).ok() +
+      cache.Load(kDriverVersion, /*fingerprint=*/2, &loaded).ok();
+  EXPECT_EQ(num_cached, 1);
+}
+
+TEST(PersistentProgramCacheTest, StoreAndLoadWorkGroupSizes) {
+  const std::string dir = MakeCacheDir("work_group_sizes");
+  PersistentProgramCache cache(dir);
+  const std::vector<int3> work_group_sizes = {{8, 4, 1}, {32, 1, 2}};
+  ASSERT_TRUE(cache
+                  .StoreWorkGroupSizes(kDriverVersion, /*fingerprint=*/42,
+                                       work_group_sizes)
+                  .ok());
+
+  std::vector<int3> loaded;
+  ASSERT_TRUE(
+      cache.LoadWorkGroupSizes(kDriverVersion, /*fingerprint=*/42, &loaded)
+          .ok());
+  EXPECT_EQ(loaded, work_group_sizes);
+  // Programs and work group sizes with the same fingerprint don't collide.
+  std::vector<uint8_t> binary;
+  EXPECT_TRUE(absl::IsNotFound(
+      cache.Load(kDriverVersion, /*fingerprint=*/42, &binary)));
+  EXPECT_TRUE(absl::IsNotFound(cache.LoadWorkGroupSizes(
+      "OpenCL 3.0 other_driver", /*fingerprint=*/42, &loaded)));
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -67,11 +67,13 @@ ProgramCache::ProgramDescriptor::ProgramDescriptor(uint64_t fingerprints)
     : fingerprint(fingerprints) {}
 
 ProgramCache::ProgramCache(ProgramCache&& program_cache)
-    : programs_(std::move(program_cache.programs_)) {}
+    : programs_(std::move(program_cache.programs_)),
+      persistent_cache_(std::move(program_cache.persistent_cache_)) {}
 
 ProgramCache& ProgramCache::operator=(ProgramCache&& program_cache) {
   if (this != &program_cache) {
     programs_ = std::move(program_cache.programs_);
+    persistent_cache_ = std::move(program_cache.persistent_cache_);
   }
   return *this;
 }
@@ -93,7 +95,20 @@ absl::Status ProgramCache::GetOrCreateCLKernel(
   }
 
   CLProgram program;
-  RETURN_IF_ERROR(CreateCLProgram(code, options, context, device, &program));
+  std::vector<uint8_t> binary;
+  if (!persistent_cache_ ||
+      !persistent_cache_
+           ->Load(GetDriverVersion(device), desc.fingerprint, &binary)
+           .ok() ||
+      !CreateCLProgramFromBinary(context, device, binary, &program).ok()) {
+    RETURN_IF_ERROR(CreateCLProgram(code, options, context, device, &program));
+    if (persistent_cache_ && program.GetBinary(&binary).ok()) {
+      // Ignore returned error. The program is compiled again next time.
+      persistent_cache_
+          ->Store(GetDriverVersion(device), desc.fingerprint, binary)
+          .IgnoreError();
+    }
+  }
   RETURN_IF_ERROR(result->CreateFromProgram(program, function_name));
   programs_.insert(std::make_pair(std::move(desc), std::move(program)));
   return absl::OkStatus();
@@ -109,6 +124,26 @@ absl::Status ProgramCache::GetOrCreateCLKernel(const std::string& code,
                              kernel_fingerprint);
 }
 
+absl::Status ProgramCache::GetWorkGroupSizes(
+    const CLDevice& device, uint64_t fingerprint,
+    std::vector<int3>* work_group_sizes) const {
+  if (!persistent_cache_) {
+    return absl::NotFoundError("No persistent program cache.");
+  }
+  return persistent_cache_->LoadWorkGroupSizes(GetDriverVersion(device),
+                                               fingerprint, work_group_sizes);
+}
+
+absl::Status ProgramCache::AddWorkGroupSizes(
+    const CLDevice& device, uint64_t fingerprint,
+    const std::vector<int3>& work_group_sizes) const {
+  if (!persistent_cache_) {
+    return absl::NotFoundError("No persistent program cache.");
+  }
+  return persistent_cache_->StoreWorkGroupSizes(GetDriverVersion(device),
+                                                fingerprint, work_group_sizes);
+}
+
 absl::Status ProgramCache::GetKernel(uint64_t fingerprint,
                                      const std::string& function_name,
                                      CLKernel* result) const {
@@ -17,7 +17,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_DELEGATES_GPU_CL_PROGRAM_CACHE_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -26,7 +28,9 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/cl_device.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_kernel.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_program.h"
+#include "tensorflow/lite/delegates/gpu/cl/persistent_program_cache.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
 
 namespace tflite {
 namespace gpu {
@@ -68,6 +72,21 @@ class ProgramCache {
   absl::Status GetSerializedCache(const CLDevice& device,
                                   std::vector<uint8_t>* serialized_cache) const;
 
+  // Programs missing from this cache are looked up in `persistent_cache`
+  // before being compiled, and newly compiled programs are added to it.
+  void SetPersistentCache(
+      std::unique_ptr<PersistentProgramCache> persistent_cache) {
+    persistent_cache_ = std::move(persistent_cache);
+  }
+
+  // Work group sizes tuned for the model with `fingerprint`, kept in the
+  // persistent cache. Return NotFound without a persistent cache.
+  absl::Status GetWorkGroupSizes(const CLDevice& device, uint64_t fingerprint,
+                                 std::vector<int3>* work_group_sizes) const;
+  absl::Status AddWorkGroupSizes(
+      const CLDevice& device, uint64_t fingerprint,
+      const std::vector<int3>& work_group_sizes) const;
+
  private:
   struct ProgramDescriptor {
     ProgramDescriptor() = default;
@@ -92,6 +111,7 @@ class ProgramCache {
   absl::flat_hash_map<ProgramDescriptor, CLProgram, ProgramDescriptorHasher,
                       ProgramDescriptorEqual>
       programs_;
+  std::unique_ptr<PersistentProgramCache> persistent_cache_;
 };
 
 }  // namespace cl
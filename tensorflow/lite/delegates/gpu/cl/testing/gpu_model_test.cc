@@ -90,6 +90,11 @@ TEST_F(OpenCLOperationTest, LinkingAddMulOp) {
   ASSERT_TRUE(status.ok()) << status.message();
 }
 
+TEST_F(OpenCLOperationTest, MixedPrecisionSoftmax) {
+  auto status = TestMixedPrecisionSoftmax(&exec_env_);
+  ASSERT_TRUE(status.ok()) << status.message();
+}
+
 }  // namespace
 }  // namespace cl
 }  // namespace gpu
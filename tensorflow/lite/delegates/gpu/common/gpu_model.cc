@@ -20,16 +20,19 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "tensorflow/lite/delegates/gpu/common/mixed_precision.h"
 #include "tensorflow/lite/delegates/gpu/common/operations.h"
 #include "tensorflow/lite/delegates/gpu/common/selectors/operation_selector.h"
 #include "tensorflow/lite/delegates/gpu/common/selectors/special_selector.h"
 #include "tensorflow/lite/delegates/gpu/common/selectors/subgraph.h"
 #include "tensorflow/lite/delegates/gpu/common/task/serialization_base.h"
+#include "tensorflow/lite/delegates/gpu/common/tasks/cast.h"
 #include "tensorflow/lite/delegates/gpu/common/transformations/add_bias.h"
 #include "tensorflow/lite/delegates/gpu/common/transformations/global_pooling_to_reduce_op.h"
 #include "tensorflow/lite/delegates/gpu/common/transformations/merge_padding_with.h"
@@ -261,6 +264,33 @@ absl::Status ReserveGraphTensors(const CreateGpuModelInfo& create_info,
   return absl::OkStatus();
 }
 
+// Reserves a F32 copy of the tensor `id`.
+absl::Status ReserveF32Tensor(const GpuInfo& gpu_info, ValueId id,
+                              TensorReserver* tensor_reserver,
+                              ValueId* f32_id) {
+  TensorDescriptor f32_desc;
+  RETURN_IF_ERROR(CreateF32TensorDescriptor(
+      gpu_info, tensor_reserver->Get(id), &f32_desc));
+  *f32_id = tensor_reserver->Add(f32_desc);
+  return absl::OkStatus();
+}
+
+void AddCastNode(const GpuInfo& gpu_info, ValueId src_id, ValueId dst_id,
+                 const std::string& name, TensorReserver* tensor_reserver,
+                 GpuModel* gpu_model) {
+  OperationDef op_def;
+  op_def.precision = CalculationsPrecision::F32;
+  op_def.src_tensors.push_back(tensor_reserver->Get(src_id));
+  op_def.dst_tensors.push_back(tensor_reserver->Get(dst_id));
+  GpuNode gpu_node;
+  gpu_node.gpu_operation =
+      std::make_unique<GPUOperation>(CreateCast(op_def, gpu_info));
+  gpu_node.inputs = {src_id};
+  gpu_node.outputs = {dst_id};
+  gpu_node.name = name;
+  gpu_model->nodes.push_back(std::move(gpu_node));
+}
+
 absl::Status ConvertOperations(const GpuInfo& gpu_info,
                                const GraphFloat32& graph,
                                const CreateGpuModelInfo& create_info,
@@ -284,6 +314,17 @@ absl::Status ConvertOperations(const GpuInfo& gpu_info,
       create_info.hints.Check(ModelHints::kReuseConvWeights)
           ? &shared_conv_weights
           : nullptr;
+  absl::flat_hash_set<NodeId> f32_nodes;
+  if (create_info.precision != CalculationsPrecision::F32) {
+    f32_nodes = create_info.f32_nodes;
+    if (create_info.hints.Check(ModelHints::kMixedPrecision)) {
+      for (const NodeId id : GetNumericallySensitiveNodes(graph)) {
+        f32_nodes.insert(id);
+      }
+    }
+  }
+  // F32 copies of the F16 tensors read or written by the f32_nodes.
+  std::map<ValueId, ValueId> f32_tensors;
   for (int i = 0; i < graph_nodes.size(); ++i) {
     const Node& node = *graph_nodes[i];
     if (consumed_nodes.find(node.id) != consumed_nodes.end()) {
@@ -299,8 +340,12 @@ absl::Status ConvertOperations(const GpuInfo& gpu_info,
       gpu_model->const_tensors[outputs[0]->id].UploadData(attr.tensor);
       continue;
     }
+    const bool run_in_f32 = f32_nodes.contains(node.id);
+    // F32 tensors used by the node instead of its F16 outputs.
+    std::map<ValueId, ValueId> f32_outputs;
     GPUOperationsSubgraph gpu_subgraph;
-    if (GPUSubgraphFromGraph(create_info.hints, gpu_info, create_info.precision,
+    if (!run_in_f32 &&
+        GPUSubgraphFromGraph(create_info.hints, gpu_info, create_info.precision,
                              graph, node.id, tensor_descriptors,
                              &consumed_nodes, &gpu_subgraph)
             .ok()) {
@@ -325,17 +370,65 @@ absl::Status ConvertOperations(const GpuInfo& gpu_info,
         std::swap(inputs[0], inputs[latest_written_tensor_index]);
       }
       consumed_nodes.insert(node.id);
+      // Maps the F16 tensors of the node to the F32 tensors it uses instead.
+      std::map<ValueId, ValueId> f32_ids;
+      if (run_in_f32) {
+        for (const Value* input : inputs) {
+          if (tensor_reserver->Get(input->id).GetDataType() !=
+              DataType::FLOAT16) {
+            continue;
+          }
+          auto it = f32_tensors.find(input->id);
+          if (it == f32_tensors.end()) {
+            ValueId f32_id;
+            RETURN_IF_ERROR(ReserveF32Tensor(gpu_info, input->id,
+                                             tensor_reserver, &f32_id));
+            AddCastNode(gpu_info, input->id, f32_id,
+                        node.operation.type + " input to F32",
+                        tensor_reserver, gpu_model);
+            it = f32_tensors.insert({input->id, f32_id}).first;
+          }
+          f32_ids[input->id] = it->second;
+        }
+        for (const Value* output : outputs) {
+          if (tensor_reserver->Get(output->id).GetDataType() !=
+              DataType::FLOAT16) {
+            continue;
+          }
+          ValueId f32_id;
+          RETURN_IF_ERROR(ReserveF32Tensor(gpu_info, output->id,
+                                           tensor_reserver, &f32_id));
+          f32_tensors[output->id] = f32_id;
+          f32_outputs[output->id] = f32_id;
+          f32_ids[output->id] = f32_id;
+        }
+      }
+      auto get_id = [&f32_ids](ValueId id) {
+        auto it = f32_ids.find(id);
+        return it == f32_ids.end() ? id : it->second;
+      };
       OperationDef op_def;
-      op_def.precision = create_info.precision;
+      op_def.precision =
+          run_in_f32 ? CalculationsPrecision::F32 : create_info.precision;
       for (int j = 0; j < inputs.size(); ++j) {
-        op_def.src_tensors.push_back(tensor_reserver->Get(inputs[j]->id));
+        op_def.src_tensors.push_back(
+            tensor_reserver->Get(get_id(inputs[j]->id)));
       }
       for (int j = 0; j < outputs.size(); ++j) {
-        op_def.dst_tensors.push_back(tensor_reserver->Get(outputs[j]->id));
+        op_def.dst_tensors.push_back(
+            tensor_reserver->Get(get_id(outputs[j]->id)));
       }
       RETURN_IF_ERROR(GPUOperationFromNode(
           gpu_info, op_def, create_info.hints, inputs, outputs, node,
           shared_conv_weights_ptr, &gpu_subgraph));
+      for (auto& gpu_op : gpu_subgraph.operations) {
+        for (int& id : gpu_op.input_ids) {
+          if (id >= 0) id = get_id(id);
+        }
+        for (int& id : gpu_op.output_ids) {
+          if (id >= 0) id = get_id(id);
+        }
+      }
     }
     absl::flat_hash_map<int, ValueId> mapping_to_global_ids;
     for (int j = 0; j < gpu_subgraph.new_tensors.size(); ++j) {
@@ -378,6 +471,12 @@ absl::Status ConvertOperations(const GpuInfo& gpu_info,
       gpu_node.name = gpu_op.name;
       gpu_model->nodes.push_back(std::move(gpu_node));
     }
+    for (const auto& output : f32_outputs) {
+      AddCastNode(gpu_info, output.second, output.first,
+                  node.operation.type + " output to F16", tensor_reserver,
+                  gpu_model);
+      tensor_usages[output.first] = i;
+    }
   }
 
   return absl::OkStatus();
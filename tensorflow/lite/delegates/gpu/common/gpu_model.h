@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/lite/delegates/gpu/common/gpu_model_generated.h"
 #include "tensorflow/lite/delegates/gpu/common/model.h"
 #include "tensorflow/lite/delegates/gpu/common/model_hints.h"
@@ -93,6 +94,13 @@ struct CreateGpuModelInfo {
   // IMPORTANT: tensors ids from predefined / external_immutable_tensors /
   // external_mutable_tensors should not intersect.
   absl::flat_hash_map<ValueId, TensorDescriptor> external_mutable_tensors;
+
+  // Nodes that run in F32 when precision is F16 or F32_F16, e.g. as chosen by
+  // comparing the outputs on calibration data. With ModelHints::kMixedPrecision
+  // the numerically sensitive nodes are added to them.
+  // Their F16 inputs and outputs are cast to F32 tensors.
+  // WARNING: This is an experimental API and subject to change.
+  absl::flat_hash_set<NodeId> f32_nodes;
 };
 
 struct GpuModel {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/common/gpu_model_test_util.h"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -1824,5 +1825,99 @@ absl::Status TestLinkingConcatAndCosOp(TestExecutionEnvironment* env) {
   return absl::OkStatus();
 }
 
+absl::Status TestMixedPrecisionSoftmax(TestExecutionEnvironment* env) {
+  GraphFloat32 graph;
+  auto input = graph.NewValue();
+  input->tensor.type = DataType::FLOAT32;
+  input->tensor.shape = BHWC(1, 2, 2, 37);
+
+  auto softmax_node = graph.NewNode();
+  softmax_node->operation.type = ToString(OperationType::SOFTMAX);
+  SoftmaxAttributes softmax_attr;
+  softmax_attr.axis = Axis::CHANNELS;
+  softmax_node->operation.attributes = softmax_attr;
+  RETURN_IF_ERROR(graph.AddConsumer(softmax_node->id, input->id));
+
+  tflite::gpu::Value* softmax_output = nullptr;
+  RETURN_IF_ERROR(AddOutput(&graph, softmax_node, &softmax_output));
+  softmax_output->tensor.type = DataType::FLOAT32;
+  softmax_output->tensor.shape = input->tensor.shape;
+
+  RETURN_IF_ERROR(RunGraphTransformsForGpuModel(&graph));
+
+  TensorFloat32 src_tensor;
+  src_tensor.shape = input->tensor.shape;
+  src_tensor.data.resize(src_tensor.shape.DimensionsProduct());
+  for (int i = 0; i < src_tensor.data.size(); ++i) {
+    src_tensor.data[i] = 8.0f * std::sin(i * 0.12345f);
+  }
+  const int channels = src_tensor.shape.c;
+  std::vector<float> expected(src_tensor.data.size());
+  for (int i = 0; i < src_tensor.data.size(); i += channels) {
+    const float max_value = *std::max_element(
+        src_tensor.data.begin() + i, src_tensor.data.begin() + i + channels);
+    float sum = 0.0f;
+    for (int c = 0; c < channels; ++c) {
+      expected[i + c] = std::exp(src_tensor.data[i + c] - max_value);
+      sum += expected[i + c];
+    }
+    for (int c = 0; c < channels; ++c) {
+      expected[i + c] /= sum;
+    }
+  }
+
+  const BHWDC shape(1, 2, 2, 1, 37);
+  for (auto precision : env->GetSupportedPrecisions()) {
+    if (precision == CalculationsPrecision::F32) {
+      continue;
+    }
+    auto data_type = DeduceDataTypeFromPrecision(precision);
+    for (auto storage : env->GetSupportedStorages(data_type)) {
+      CreateGpuModelInfo create_info;
+      create_info.precision = precision;
+      create_info.storage_type = storage;
+      create_info.f32_nodes = {softmax_node->id};
+
+      GpuModel gpu_model;
+      RETURN_IF_ERROR(
+          GraphToGpuModel(graph, create_info, env->GetGpuInfo(), &gpu_model));
+
+      if (gpu_model.tensors.at(input->id).GetDataType() != data_type ||
+          gpu_model.tensors.at(softmax_output->id).GetDataType() !=
+              data_type) {
+        return absl::InternalError("Expected graph tensors of global type.");
+      }
+      // The casts and the softmax all run in F32.
+      for (const auto& node : gpu_model.nodes) {
+        if (node.gpu_operation->GetDefinition().precision !=
+            CalculationsPrecision::F32) {
+          return absl::InternalError("Expected only F32 nodes.");
+        }
+      }
+      // The output cast can be fused into the softmax, but the input one
+      // can't.
+      int f32_tensors = 0;
+      for (const auto& tensor : gpu_model.tensors) {
+        if (tensor.second.GetDataType() != DataType::FLOAT32) {
+          continue;
+        }
+        if (tensor.second.GetBHWDCShape() != shape) {
+          return absl::InternalError("Expected F32 copies of the same shape.");
+        }
+        ++f32_tensors;
+      }
+      if (f32_tensors == 0) {
+        return absl::InternalError("Expected F32 copies of F16 tensors.");
+      }
+
+      TensorFloat32 dst_tensor;
+      RETURN_IF_ERROR(env->ExecuteGpuModel(
+          {src_tensor}, std::vector<TensorFloat32*>{&dst_tensor}, &gpu_model));
+      RETURN_IF_ERROR(PointWiseNear(expected, dst_tensor.data, 1e-3f));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace gpu
 }  // namespace tflite
@@ -189,6 +189,13 @@ absl::Status TestLinkingAddAddMulOp(TestExecutionEnvironment* env,
 //   output
 absl::Status TestLinkingConcatAndCosOp(TestExecutionEnvironment* env);
 
+//    input
+//      |
+//   softmax (in F32 with F16 precision)
+//      |
+//   output
+absl::Status TestMixedPrecisionSoftmax(TestExecutionEnvironment* env);
+
 }  // namespace gpu
 }  // namespace tflite
 
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/common/mixed_precision.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/operations.h"
+#include "tensorflow/lite/delegates/gpu/common/shape.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tensor_desc.h"
+
+namespace tflite {
+namespace gpu {
+
+bool IsNumericallySensitive(const GraphFloat32& graph, const Node& node) {
+  switch (OperationTypeFromString(node.operation.type)) {
+    case OperationType::SOFTMAX:
+    case OperationType::MEAN_STDDEV_NORMALIZATION:
+      return true;
+    case OperationType::MEAN:
+    case OperationType::REDUCE_PRODUCT:
+    case OperationType::REDUCE_SUM: {
+      const std::vector<Value*> inputs = graph.FindInputs(node.id);
+      const std::vector<Value*> outputs = graph.FindOutputs(node.id);
+      if (inputs.empty() || outputs.empty()) {
+        return false;
+      }
+      const int64_t dst_size = outputs[0]->tensor.shape.DimensionsProduct();
+      return dst_size != 0 &&
+             inputs[0]->tensor.shape.DimensionsProduct() / dst_size >=
+                 kMinF32ReductionSize;
+    }
+    default:
+      return false;
+  }
+}
+
+absl::flat_hash_set<NodeId> GetNumericallySensitiveNodes(
+    const GraphFloat32& graph) {
+  absl::flat_hash_set<NodeId> nodes;
+  for (const Node* node : graph.nodes()) {
+    if (IsNumericallySensitive(graph, *node)) {
+      nodes.insert(node->id);
+    }
+  }
+  return nodes;
+}
+
+absl::Status CreateF32TensorDescriptor(const GpuInfo& gpu_info,
+                                       const TensorDescriptor& desc,
+                                       TensorDescriptor* f32_desc) {
+  const BHWDC shape = desc.GetBHWDCShape();
+  Layout layout;
+  if (desc.HasAxis(Axis::DEPTH)) {
+    layout = desc.HasAxis(Axis::BATCH) ? Layout::BHWDC : Layout::HWDC;
+  } else {
+    layout = desc.HasAxis(Axis::BATCH) ? Layout::BHWC : Layout::HWC;
+  }
+  *f32_desc =
+      TensorDescriptor(DataType::FLOAT32, desc.GetStorageType(), layout);
+  RETURN_IF_ERROR(f32_desc->UpdateToSupportedStorageType(gpu_info, shape));
+  f32_desc->SetBHWDCShape(shape);
+  return absl::OkStatus();
+}
+
+}  // namespace gpu
+}  // namespace tflite
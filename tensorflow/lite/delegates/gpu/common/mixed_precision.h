@@ -0,0 +1,54 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_COMMON_MIXED_PRECISION_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_COMMON_MIXED_PRECISION_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tensor_desc.h"
+
+namespace tflite {
+namespace gpu {
+
+// Reductions over at least this many elements are computed in F32 with mixed
+// precision, as F16 sums lose too many bits.
+inline constexpr int64_t kMinF32ReductionSize = 256;
+
+// Returns true if `node` is numerically sensitive, i.e. F16 calculations
+// overflow or are too imprecise for it: softmax, normalizations and large
+// reductions.
+bool IsNumericallySensitive(const GraphFloat32& graph, const Node& node);
+
+// Returns the nodes of `graph` that should run in F32 when the rest of the
+// model runs in F16.
+absl::flat_hash_set<NodeId> GetNumericallySensitiveNodes(
+    const GraphFloat32& graph);
+
+// Creates the descriptor of a F32 copy of the tensor `desc`, with the same
+// shape and layout. The storage type changes only if the device can't
+// allocate the copy with the storage type of `desc`.
+absl::Status CreateF32TensorDescriptor(const GpuInfo& gpu_info,
+                                       const TensorDescriptor& desc,
+                                       TensorDescriptor* f32_desc);
+
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_COMMON_MIXED_PRECISION_H_
@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/common/mixed_precision.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/common/data_type.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_info.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/operations.h"
+#include "tensorflow/lite/delegates/gpu/common/shape.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tensor_desc.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+Node* AddNode(OperationType type, const BHWC& src_shape, const BHWC& dst_shape,
+              GraphFloat32* graph) {
+  Node* node = graph->NewNode();
+  node->operation.type = ToString(type);
+  Value* src = graph->NewValue();
+  src->tensor.shape = src_shape;
+  Value* dst = graph->NewValue();
+  dst->tensor.shape = dst_shape;
+  EXPECT_TRUE(graph->AddConsumer(node->id, src->id).ok());
+  EXPECT_TRUE(graph->SetProducer(node->id, dst->id).ok());
+  return node;
+}
+
+TEST(MixedPrecision, GetNumericallySensitiveNodes) {
+  GraphFloat32 graph;
+  Node* softmax = AddNode(OperationType::SOFTMAX, BHWC(1, 1, 1, 8),
+                          BHWC(1, 1, 1, 8), &graph);
+  Node* normalization =
+      AddNode(OperationType::MEAN_STDDEV_NORMALIZATION, BHWC(1, 4, 4, 8),
+              BHWC(1, 4, 4, 8), &graph);
+  Node* large_mean = AddNode(OperationType::MEAN, BHWC(1, 32, 32, 8),
+                             BHWC(1, 1, 1, 8), &graph);
+  AddNode(OperationType::MEAN, BHWC(1, 2, 2, 8), BHWC(1, 1, 1, 8), &graph);
+  AddNode(OperationType::ADD, BHWC(1, 32, 32, 8), BHWC(1, 32, 32, 8), &graph);
+
+  EXPECT_THAT(GetNumericallySensitiveNodes(graph),
+              UnorderedElementsAre(softmax->id, normalization->id,
+                                   large_mean->id));
+}
+
+TEST(MixedPrecision, CreateF32TensorDescriptorKeepsDepth) {
+  TensorDescriptor desc(DataType::FLOAT16, TensorStorageType::BUFFER,
+                        Layout::HWDC);
+  desc.SetBHWDCShape(BHWDC(1, 4, 6, 3, 8));
+  TensorDescriptor f32_desc;
+  ASSERT_TRUE(CreateF32TensorDescriptor(GpuInfo(), desc, &f32_desc).ok());
+  EXPECT_EQ(f32_desc.GetDataType(), DataType::FLOAT32);
+  EXPECT_EQ(f32_desc.GetStorageType(), TensorStorageType::BUFFER);
+  EXPECT_TRUE(f32_desc.HasAxis(Axis::DEPTH));
+  EXPECT_FALSE(f32_desc.HasAxis(Axis::BATCH));
+  EXPECT_EQ(f32_desc.GetBHWDCShape(), BHWDC(1, 4, 6, 3, 8));
+}
+
+TEST(MixedPrecision, CreateF32TensorDescriptorKeepsBatch) {
+  TensorDescriptor desc(DataType::FLOAT16, TensorStorageType::BUFFER,
+                        Layout::BHWC);
+  desc.SetBHWCShape(BHWC(2, 4, 6, 8));
+  TensorDescriptor f32_desc;
+  ASSERT_TRUE(CreateF32TensorDescriptor(GpuInfo(), desc, &f32_desc).ok());
+  EXPECT_EQ(f32_desc.GetDataType(), DataType::FLOAT32);
+  EXPECT_TRUE(f32_desc.HasAxis(Axis::BATCH));
+  EXPECT_FALSE(f32_desc.HasAxis(Axis::DEPTH));
+  EXPECT_EQ(f32_desc.GetBHWDCShape(), BHWDC(2, 4, 6, 1, 8));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tflite
@@ -46,6 +46,12 @@ struct ModelHints {
   // Can decrease constant memory usage(if model has the same weights).
   static constexpr ModelHint kReuseConvWeights = 0x00000001 << 4;
 
+  // With F16 or F32_F16 precision, runs the numerically sensitive operations
+  // (softmax, normalizations, large reductions) in F32, with casts between F16
+  // and F32 tensors around them.
+  // Can fix the accuracy of models broken by F16, at a small speed cost.
+  static constexpr ModelHint kMixedPrecision = 0x00000001 << 5;
+
   void Add(ModelHint hint) {
     if (hint == kFastestInference) {
       hints = kFastestInference;
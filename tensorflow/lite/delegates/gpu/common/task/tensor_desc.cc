@@ -1552,6 +1552,12 @@ absl::Status TensorDescriptor::CanCreateTensorWithShape(
 
 absl::Status TensorDescriptor::UpdateToSupportedStorageType(
     const GpuInfo& gpu_info, const BHWC& shape) {
+  const BHWDC shape5D(shape.b, shape.h, shape.w, 1, shape.c);
+  return UpdateToSupportedStorageType(gpu_info, shape5D);
+}
+
+absl::Status TensorDescriptor::UpdateToSupportedStorageType(
+    const GpuInfo& gpu_info, const BHWDC& shape) {
   if (CanCreateTensorWithShape(gpu_info, shape).ok()) {
     return absl::OkStatus();
   }
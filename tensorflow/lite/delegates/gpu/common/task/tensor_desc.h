@@ -131,6 +131,9 @@ class TensorDescriptor : public GPUObjectDescriptor {
   // Usual scenario is to create new tensor_desc on base of another and may be
   // update storage type for new tensor_desc shape because it can be unsuported
   // with old storage type
+  absl::Status UpdateToSupportedStorageType(const GpuInfo& gpu_info,
+                                            const BHWDC& shape);
+
   absl::Status UpdateToSupportedStorageType(const GpuInfo& gpu_info,
                                             const BHWC& shape);
 
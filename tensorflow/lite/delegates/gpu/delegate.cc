@@ -38,6 +38,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/builtin_ops.h"
 
@@ -53,6 +54,9 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/android_hardware_buffer.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
 #include "tensorflow/lite/delegates/gpu/cl/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/buffer.h"
+#include "tensorflow/lite/delegates/gpu/cl/environment.h"
+#include "tensorflow/lite/delegates/gpu/cl/opencl_wrapper.h"
 #include "tensorflow/lite/delegates/gpu/cl/util.h"
 #include "tensorflow/lite/delegates/gpu/common/model_builder.h"
 #include "tensorflow/lite/delegates/gpu/common/model_builder_helper.h"
@@ -221,6 +225,12 @@ bool ParseOptions(const char* const* options_keys,
 
 // Forward declarations.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
+TfLiteStatus DelegateCopyFromBufferHandle(TfLiteContext* context,
+                                          TfLiteDelegate* delegate,
+                                          TfLiteBufferHandle buffer_handle,
+                                          TfLiteTensor* tensor);
+void DelegateFreeBufferHandle(TfLiteContext* context, TfLiteDelegate* delegate,
+                              TfLiteBufferHandle* handle);
 
 #if defined(__ANDROID__)
 class DelegateAsyncKernel;
@@ -234,9 +244,9 @@ class Delegate {
         std::make_unique<TfLiteTelemetryGpuDelegateSettings>();
     delegate_.data_ = reinterpret_cast<void*>(this);
     delegate_.Prepare = DelegatePrepare;
-    delegate_.CopyFromBufferHandle = nullptr;
+    delegate_.CopyFromBufferHandle = DelegateCopyFromBufferHandle;
     delegate_.CopyToBufferHandle = nullptr;
-    delegate_.FreeBufferHandle = nullptr;
+    delegate_.FreeBufferHandle = DelegateFreeBufferHandle;
     delegate_.flags = kTfLiteDelegateFlagsPerOperatorProfiling;
     options_ = options ? *options : TfLiteGpuDelegateOptionsV2Default();
     if (options_.max_delegated_partitions <= 0) {
@@ -271,6 +281,46 @@ class Delegate {
     return telemetry_settings_.get();
   }
 
+  // Non-constant float tensors of `context` that are both produced and
+  // consumed by delegated nodes. When such a tensor is an output of a
+  // partition, it stays in an OpenCL buffer that the partitions consuming it
+  // read directly. It is copied to CPU memory only when a CPU op or the user
+  // reads it, through the tensor's buffer handle.
+  void SetGpuResidentCandidates(TfLiteContext* context,
+                                absl::flat_hash_set<int> tensors) {
+    gpu_resident_candidates_[context] = std::move(tensors);
+  }
+  bool IsGpuResidentCandidate(TfLiteContext* context, int tensor_index) const {
+    auto it = gpu_resident_candidates_.find(context);
+    return it != gpu_resident_candidates_.end() &&
+           it->second.contains(tensor_index);
+  }
+
+  // OpenCL environment shared by the partitions, so that they can exchange
+  // buffers. It is created for the `env_options` of the first partition that
+  // asks for it, and only the partitions with the same options share it.
+  // Returns nullptr if there are no GPU resident candidates, if it can't be
+  // created, or if `env_options` differ from the ones it was created for.
+  cl::Environment* GetSharedClEnvironment(
+      const cl::InferenceEnvironmentOptions& env_options);
+
+  TfLiteBufferHandle AddGpuResidentBuffer() {
+    gpu_resident_buffers_.emplace_back();
+    return gpu_resident_buffers_.size() - 1;
+  }
+  // Returns the buffer of `handle`, (re)allocated with `size_in_bytes`.
+  absl::Status GetGpuResidentBuffer(TfLiteBufferHandle handle,
+                                    size_t size_in_bytes, cl::Buffer** buffer);
+  // Copies the buffer of `handle` to the CPU memory of `tensor`. Fails if the
+  // buffer was never written or doesn't have the size of `tensor`.
+  absl::Status ReadGpuResidentBuffer(TfLiteBufferHandle handle,
+                                     TfLiteTensor* tensor);
+  void FreeGpuResidentBuffer(TfLiteBufferHandle handle) {
+    if (handle >= 0 && handle < gpu_resident_buffers_.size()) {
+      gpu_resident_buffers_[handle] = cl::Buffer();
+    }
+  }
+
  private:
   TfLiteDelegate delegate_;
   TfLiteGpuDelegateOptionsV2 options_;
@@ -282,12 +332,92 @@ class Delegate {
 
   bool async_;
 
+  absl::flat_hash_map<TfLiteContext*, absl::flat_hash_set<int>>
+      gpu_resident_candidates_;
+  std::unique_ptr<cl::Environment> shared_cl_environment_;
+  bool shared_cl_environment_failed_ = false;
+  // The options shared_cl_environment_ was created for.
+  std::string shared_cl_program_cache_dir_;
+  uint64_t shared_cl_program_cache_max_size_bytes_ = 0;
+  // Indexed by buffer handle. Released before shared_cl_environment_.
+  std::vector<cl::Buffer> gpu_resident_buffers_;
+
   friend class DelegateKernelCore;
 #if defined(__ANDROID__)
   friend TfLiteRegistration CreateAsyncRegistration();
 #endif
 };
 
+cl::Environment* Delegate::GetSharedClEnvironment(
+    const cl::InferenceEnvironmentOptions& env_options) {
+  // A GL aware context or a context, device or queue provided by the caller
+  // belongs to that partition only.
+  if (env_options.IsGlAware() || env_options.context != nullptr ||
+      env_options.device != nullptr || env_options.command_queue != nullptr) {
+    return nullptr;
+  }
+  if (shared_cl_environment_) {
+    if (env_options.program_cache_dir != shared_cl_program_cache_dir_ ||
+        env_options.program_cache_max_size_bytes !=
+            shared_cl_program_cache_max_size_bytes_) {
+      return nullptr;
+    }
+    return shared_cl_environment_.get();
+  }
+  if (!shared_cl_environment_failed_ && !async_ &&
+      !gpu_resident_candidates_.empty()) {
+    auto environment = std::make_unique<cl::Environment>();
+    absl::Status status = cl::LoadOpenCL();
+    if (status.ok()) {
+      status = cl::CreateEnvironment(environment.get());
+    }
+    if (status.ok()) {
+      shared_cl_environment_ = std::move(environment);
+      shared_cl_program_cache_dir_ = env_options.program_cache_dir;
+      shared_cl_program_cache_max_size_bytes_ =
+          env_options.program_cache_max_size_bytes;
+    } else {
+      // Every partition creates its own environment instead.
+      shared_cl_environment_failed_ = true;
+    }
+  }
+  return shared_cl_environment_.get();
+}
+
+absl::Status Delegate::GetGpuResidentBuffer(TfLiteBufferHandle handle,
+                                            size_t size_in_bytes,
+                                            cl::Buffer** buffer) {
+  if (!shared_cl_environment_ || handle < 0 ||
+      handle >= gpu_resident_buffers_.size()) {
+    return absl::NotFoundError("Unknown GPU delegate buffer handle.");
+  }
+  cl::Buffer& resident_buffer = gpu_resident_buffers_[handle];
+  if (resident_buffer.GetMemorySizeInBytes() != size_in_bytes) {
+    RETURN_IF_ERROR(cl::CreateReadWriteBuffer(
+        size_in_bytes, &shared_cl_environment_->context(), &resident_buffer));
+  }
+  *buffer = &resident_buffer;
+  return absl::OkStatus();
+}
+
+absl::Status Delegate::ReadGpuResidentBuffer(TfLiteBufferHandle handle,
+                                             TfLiteTensor* tensor) {
+  if (!shared_cl_environment_ || handle < 0 ||
+      handle >= gpu_resident_buffers_.size()) {
+    return absl::NotFoundError("Unknown GPU delegate buffer handle.");
+  }
+  // Reallocating here would read uninitialized memory.
+  const cl::Buffer& buffer = gpu_resident_buffers_[handle];
+  if (buffer.GetMemorySizeInBytes() != tensor->bytes) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "GPU delegate buffer ", handle, " holds ",
+        buffer.GetMemorySizeInBytes(), " bytes, tensor ",
+        tensor->name ? tensor->name : "", " needs ", tensor->bytes, "."));
+  }
+  return shared_cl_environment_->queue()->EnqueueReadBuffer(
+      buffer.GetMemoryPtr(), tensor->bytes, tensor->data.raw);
+}
+
 // Utility class to assist DelegateKernel and DelegateKernelAsync.
 //
 // A single DelegateKernelCore cannot be used for multiple concurrent
@@ -312,6 +442,13 @@ class DelegateKernelCore {
     return quant_conversion_map_;
   }
   const std::unique_ptr<InferenceRunner>& runner() const { return runner_; }
+  // Maps the index of each input and output tensor that is kept in an OpenCL
+  // buffer of the delegate to its buffer handle.
+  const absl::flat_hash_map<int, TfLiteBufferHandle>& gpu_resident_tensors()
+      const {
+    return gpu_resident_tensors_;
+  }
+  Delegate* delegate() const { return delegate_; }
 
   absl::Status Setup(TfLiteContext* context,
                      const TfLiteDelegateParams* delegate_params);
@@ -368,6 +505,10 @@ class DelegateKernelCore {
   // model_builder - and vice versa.
   absl::flat_hash_map<int, int> quant_conversion_map_;
 
+  absl::flat_hash_map<int, TfLiteBufferHandle> gpu_resident_tensors_;
+  // Whether the OpenCL API runs in the environment shared by the partitions.
+  bool uses_shared_cl_environment_ = false;
+
   bool enforce_same_thread_ = false;  // flag to enforce same thread for Invoke
 
   std::unique_ptr<TfLiteTelemetryGpuDelegateSettings> telemetry_settings_;
@@ -492,6 +633,17 @@ absl::Status DelegateKernelCore::Setup(
       context, "GpuDelegateKernel::Prepare",
       telemetry::TelemetrySource::TFLITE_GPU, telemetry_settings_.get());
 
+  // Tensors exchanged with the other partitions stay in OpenCL buffers of the
+  // shared environment. An output gets its buffer handle here, before the
+  // partitions that consume it are set up.
+  const bool use_gpu_residency =
+      backend_opencl && uses_shared_cl_environment_;
+  ObjectDef gpu_resident_object_def;
+  gpu_resident_object_def.data_type = DataType::FLOAT32;
+  gpu_resident_object_def.data_layout = DataLayout::BHWC;
+  gpu_resident_object_def.object_type = ObjectType::OPENCL_BUFFER;
+  gpu_resident_object_def.user_provided = true;
+
   // At this point, TFLite hasn't allocated tensors yet, therefore, collect
   // indices and set all input and output tensors from TFLite later.
   input_indices_.reserve(input_refs.size());
@@ -499,6 +651,14 @@ absl::Status DelegateKernelCore::Setup(
     const int64_t object_index = input_indices_.size();
     input_indices_.push_back(tensor_index);
     const TfLiteTensor& tflite_tensor = context->tensors[tensor_index];
+    if (use_gpu_residency &&
+        tflite_tensor.delegate == delegate_->tflite_delegate() &&
+        tflite_tensor.buffer_handle != kTfLiteNullBufferHandle) {
+      gpu_resident_tensors_[tensor_index] = tflite_tensor.buffer_handle;
+      RETURN_IF_ERROR(
+          builder->SetInputObjectDef(object_index, gpu_resident_object_def));
+      continue;
+    }
     const DataType data_type = ToDataType(tflite_tensor.type);
     RETURN_IF_ERROR(builder->SetInputObjectDef(
         object_index, GetObjectDef(tensor_index, data_type)));
@@ -507,7 +667,20 @@ absl::Status DelegateKernelCore::Setup(
   for (uint32_t tensor_index : output_refs) {
     const int64_t object_index = output_indices_.size();
     output_indices_.push_back(tensor_index);
-    const TfLiteTensor& tflite_tensor = context->tensors[tensor_index];
+    TfLiteTensor& tflite_tensor = context->tensors[tensor_index];
+    if (use_gpu_residency &&
+        delegate_->IsGpuResidentCandidate(context, tensor_index) &&
+        quant_conversion_map_.find(tensor_index) ==
+            quant_conversion_map_.end()) {
+      if (tflite_tensor.buffer_handle == kTfLiteNullBufferHandle) {
+        tflite_tensor.buffer_handle = delegate_->AddGpuResidentBuffer();
+      }
+      tflite_tensor.delegate = delegate_->tflite_delegate();
+      gpu_resident_tensors_[tensor_index] = tflite_tensor.buffer_handle;
+      RETURN_IF_ERROR(
+          builder->SetOutputObjectDef(object_index, gpu_resident_object_def));
+      continue;
+    }
     const DataType data_type = ToDataType(tflite_tensor.type);
     RETURN_IF_ERROR(builder->SetOutputObjectDef(
         object_index, GetObjectDef(tensor_index, data_type)));
@@ -543,6 +716,20 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     }
   }
   options.usage = ToUsage(delegate_options.inference_preference);
+  // Compiled programs are shared with the other models in the same directory,
+  // even the ones without a model token.
+  if (delegate_options.serialization_dir) {
+    env_options.program_cache_dir = delegate_options.serialization_dir;
+  }
+  // Partitions exchanging GPU resident tensors share one context and queue,
+  // which also orders their kernels.
+  if (cl::Environment* shared_environment =
+          delegate_->GetSharedClEnvironment(env_options)) {
+    env_options.device = shared_environment->device().id();
+    env_options.context = shared_environment->context().context();
+    env_options.command_queue = shared_environment->queue()->queue();
+    uses_shared_cl_environment_ = true;
+  }
 
 #ifdef TFLITE_GPU_ENABLE_INVOKE_LOOP
   options.gpu_invoke_loop_times = delegate_options.gpu_invoke_loop_times;
@@ -725,6 +912,18 @@ class DelegateKernel {
       }
     }
 
+    // Inputs left on the GPU by another partition are brought back to the CPU
+    // if this partition reads them from CPU memory, e.g. on OpenGL.
+    for (int64_t index : core_.input_indices()) {
+      TfLiteTensor& tensor = context->tensors[index];
+      if (tensor.data_is_stale &&
+          tensor.delegate == core_.delegate()->tflite_delegate() &&
+          !core_.gpu_resident_tensors().contains(index)) {
+        RETURN_IF_ERROR(core_.delegate()->ReadGpuResidentBuffer(
+            tensor.buffer_handle, &tensor));
+        tensor.data_is_stale = false;
+      }
+    }
     const bool is_dequant_required = !core_.quant_conversion_map().empty();
     if (is_dequant_required) {
       RETURN_IF_ERROR(DequantizeInputs(context, core_.input_indices(),
@@ -736,25 +935,46 @@ class DelegateKernel {
       RETURN_IF_ERROR(QuantizeOutputs(context, core_.output_indices(),
                                       core_.quant_conversion_map()));
     }
+    // The CPU copy of the outputs kept on the GPU is updated on demand, see
+    // DelegateCopyFromBufferHandle.
+    for (int64_t index : core_.output_indices()) {
+      if (core_.gpu_resident_tensors().contains(index)) {
+        context->tensors[index].data_is_stale = true;
+      }
+    }
     return absl::OkStatus();
   }
 
  private:
   absl::Status SetInputsAndOutputs(TfLiteContext* context) {
     for (int i = 0; i < core_.input_indices().size(); ++i) {
-      RETURN_IF_ERROR(core_.runner()->SetInputObject(
-          i, GetTensorObject(core_.input_indices()[i], context)));
+      TensorObject object;
+      RETURN_IF_ERROR(
+          GetTensorObject(core_.input_indices()[i], context, &object));
+      RETURN_IF_ERROR(core_.runner()->SetInputObject(i, object));
     }
     for (int i = 0; i < core_.output_indices().size(); ++i) {
-      RETURN_IF_ERROR(core_.runner()->SetOutputObject(
-          i, GetTensorObject(core_.output_indices()[i], context)));
+      TensorObject object;
+      RETURN_IF_ERROR(
+          GetTensorObject(core_.output_indices()[i], context, &object));
+      RETURN_IF_ERROR(core_.runner()->SetOutputObject(i, object));
     }
     return absl::OkStatus();
   }
 
-  TensorObject GetTensorObject(int index, TfLiteContext* context) const {
+  absl::Status GetTensorObject(int index, TfLiteContext* context,
+                               TensorObject* object) const {
     auto& tensor = context->tensors[index];
-    return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
+    auto it = core_.gpu_resident_tensors().find(index);
+    if (it != core_.gpu_resident_tensors().end()) {
+      cl::Buffer* buffer;
+      RETURN_IF_ERROR(core_.delegate()->GetGpuResidentBuffer(
+          it->second, tensor.bytes, &buffer));
+      *object = OpenClBuffer(buffer->GetMemoryPtr());
+      return absl::OkStatus();
+    }
+    *object = MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
+    return absl::OkStatus();
   }
 
  private:
@@ -1526,6 +1746,42 @@ TfLiteRegistration CreateAsyncRegistration() {
 }
 #endif  // defined(__ANDROID__)
 
+// Returns the non-constant float tensors that are both produced and consumed by
+// the nodes in `ops_to_replace`, i.e. the tensors that may cross the boundary
+// of two GPU partitions.
+absl::flat_hash_set<int> GetGpuResidentCandidates(
+    TfLiteContext* context, const TfLiteIntArray* ops_to_replace) {
+  absl::flat_hash_set<int> produced;
+  absl::flat_hash_set<int> candidates;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int i = 0; i < ops_to_replace->size; ++i) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      if (context->GetNodeAndRegistration(context, ops_to_replace->data[i],
+                                          &node, &registration) != kTfLiteOk) {
+        return {};
+      }
+      if (pass == 0) {
+        for (int j = 0; j < node->outputs->size; ++j) {
+          const int index = node->outputs->data[j];
+          if (index < 0) continue;
+          const TfLiteTensor& tensor = context->tensors[index];
+          if (tensor.type == kTfLiteFloat32 &&
+              tensor.allocation_type == kTfLiteArenaRw) {
+            produced.insert(index);
+          }
+        }
+        continue;
+      }
+      for (int j = 0; j < node->inputs->size; ++j) {
+        const int index = node->inputs->data[j];
+        if (produced.contains(index)) candidates.insert(index);
+      }
+    }
+  }
+  return candidates;
+}
+
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   auto* gpu_delegate = GetDelegate(delegate);
 
@@ -1552,6 +1808,10 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
                       gpu_delegate->options().first_delegate_node_index,
                       gpu_delegate->options().last_delegate_node_index);
 #endif
+  if (!gpu_delegate->async() && gpu_delegate->MaxDelegatedPartitions() > 1) {
+    gpu_delegate->SetGpuResidentCandidates(
+        context, GetGpuResidentCandidates(context, ops_to_replace));
+  }
   const auto status = context->ReplaceNodeSubsetsWithDelegateKernels(
       context, kRegistration, ops_to_replace, delegate);
   TFLITE_LOG_PROD(TFLITE_LOG_INFO, "Created %d GPU delegate kernels.",
@@ -1569,6 +1829,26 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   return status;
 }
 
+TfLiteStatus DelegateCopyFromBufferHandle(TfLiteContext* context,
+                                          TfLiteDelegate* delegate,
+                                          TfLiteBufferHandle buffer_handle,
+                                          TfLiteTensor* tensor) {
+  const absl::Status status =
+      GetDelegate(delegate)->ReadGpuResidentBuffer(buffer_handle, tensor);
+  if (!status.ok()) {
+    TF_LITE_KERNEL_LOG(context, "TfLiteGpuDelegate CopyFromBufferHandle: %s",
+                       std::string(status.message()).c_str());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+void DelegateFreeBufferHandle(TfLiteContext* context, TfLiteDelegate* delegate,
+                              TfLiteBufferHandle* handle) {
+  GetDelegate(delegate)->FreeGpuResidentBuffer(*handle);
+  *handle = kTfLiteNullBufferHandle;
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tflite
@@ -122,6 +122,8 @@ typedef struct {
   // and validity of this directory.
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
   // delegate will not try serialization.
+  // With the CL backend, compiled programs and tuned work group sizes are also
+  // cached in this directory, even without a model_token.
   //
   // NOTE: Users should ensure that this directory is private to the app to
   // avoid data access issues.
@@ -0,0 +1,175 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/delegate.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+// Doubles its input on the CPU. The GPU delegate doesn't claim custom ops, so
+// it splits the graph in two partitions.
+TfLiteRegistration* RegisterCpuDouble() {
+  static TfLiteRegistration registration = {
+      /*init=*/nullptr, /*free=*/nullptr,
+      /*prepare=*/
+      [](TfLiteContext* context, TfLiteNode* node) {
+        const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+        TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+        return context->ResizeTensor(context, output,
+                                     TfLiteIntArrayCopy(input.dims));
+      },
+      /*invoke=*/
+      [](TfLiteContext* context, TfLiteNode* node) {
+        const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+        TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+        const int size = input.bytes / sizeof(float);
+        for (int i = 0; i < size; ++i) {
+          output->data.f[i] = 2.0f * input.data.f[i];
+        }
+        return kTfLiteOk;
+      }};
+  return &registration;
+}
+
+// input -> ADD(input, input) = boundary               (first GPU partition)
+// boundary -> CpuDouble = doubled                     (CPU)
+// ADD(boundary, doubled) = output                     (second GPU partition)
+//
+// `boundary` is produced by the first partition and consumed by the second
+// one, so it stays in an OpenCL buffer of the delegate. The CPU op and, if
+// `boundary_is_output`, the user read it back through its buffer handle.
+class PartitionedAddModel : public MultiOpModel {
+ public:
+  PartitionedAddModel(TfLiteDelegate* delegate, bool boundary_is_output) {
+    const TensorData tensor = {TensorType_FLOAT32, {1, 2, 2, 1}};
+    input_ = AddInput(tensor);
+    boundary_ = boundary_is_output ? AddOutput(tensor)
+                                   : AddInnerTensor<float>(tensor);
+    const int doubled = AddInnerTensor<float>(tensor);
+    output_ = AddOutput(tensor);
+    AddBuiltinOp(BuiltinOperator_ADD, BuiltinOptions_AddOptions,
+                 CreateAddOptions(builder_).Union(), {input_, input_},
+                 {boundary_});
+    AddCustomOp("CpuDouble", {}, RegisterCpuDouble, {boundary_}, {doubled});
+    AddBuiltinOp(BuiltinOperator_ADD, BuiltinOptions_AddOptions,
+                 CreateAddOptions(builder_).Union(), {boundary_, doubled},
+                 {output_});
+    SetDelegate(delegate);
+    BuildInterpreter({GetShape(input_)}, /*num_threads=*/-1,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+
+  int input() const { return input_; }
+  int boundary() const { return boundary_; }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<float> GetBoundary() { return ExtractVector<float>(boundary_); }
+  const TfLiteTensor* tensor(int index) { return interpreter_->tensor(index); }
+
+ private:
+  int input_;
+  int boundary_;
+  int output_;
+};
+
+std::unique_ptr<TfLiteDelegate, decltype(&TfLiteGpuDelegateV2Delete)>
+CreateClDelegate() {
+  TfLiteGpuDelegateOptionsV2 options = TfLiteGpuDelegateOptionsV2Default();
+  options.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY;
+  options.max_delegated_partitions = 2;
+  return {TfLiteGpuDelegateV2Create(&options), TfLiteGpuDelegateV2Delete};
+}
+
+TEST(GpuResidentTensorsTest, BoundaryTensorStaysInDelegateBuffer) {
+  // Declared first so that it outlives the interpreter.
+  auto delegate = CreateClDelegate();
+  PartitionedAddModel model(delegate.get(), /*boundary_is_output=*/false);
+  ASSERT_EQ(model.ApplyDelegate(), kTfLiteOk);
+
+  const TfLiteTensor* boundary = model.tensor(model.boundary());
+  EXPECT_EQ(boundary->delegate, delegate.get());
+  EXPECT_NE(boundary->buffer_handle, kTfLiteNullBufferHandle);
+
+  model.PopulateTensor<float>(model.input(), {1, 2, 3, 4});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  // boundary = 2 * input, output = boundary + 2 * boundary.
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({6, 12, 18, 24})));
+}
+
+TEST(GpuResidentTensorsTest, BoundaryTensorIsRefreshedOnEveryInvoke) {
+  auto delegate = CreateClDelegate();
+  PartitionedAddModel model(delegate.get(), /*boundary_is_output=*/false);
+  ASSERT_EQ(model.ApplyDelegate(), kTfLiteOk);
+
+  model.PopulateTensor<float>(model.input(), {1, 2, 3, 4});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({6, 12, 18, 24})));
+
+  // The CPU op must see the new contents of the buffer, not the host copy
+  // made during the first run.
+  model.PopulateTensor<float>(model.input(), {-1, 0, 0.5, 10});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({-6, 0, 3, 60})));
+}
+
+TEST(GpuResidentTensorsTest, BoundaryModelOutputIsReadableAfterInvoke) {
+  auto delegate = CreateClDelegate();
+  PartitionedAddModel model(delegate.get(), /*boundary_is_output=*/true);
+  ASSERT_EQ(model.ApplyDelegate(), kTfLiteOk);
+
+  model.PopulateTensor<float>(model.input(), {1, 2, 3, 4});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_FALSE(model.tensor(model.boundary())->data_is_stale);
+  EXPECT_THAT(model.GetBoundary(),
+              ElementsAreArray(ArrayFloatNear({2, 4, 6, 8})));
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({6, 12, 18, 24})));
+}
+
+TEST(GpuResidentTensorsTest, SinglePartitionKeepsCpuTensors) {
+  TfLiteGpuDelegateOptionsV2 options = TfLiteGpuDelegateOptionsV2Default();
+  options.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY;
+  options.max_delegated_partitions = 1;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteGpuDelegateV2Delete)>
+      delegate(TfLiteGpuDelegateV2Create(&options), TfLiteGpuDelegateV2Delete);
+  PartitionedAddModel model(delegate.get(), /*boundary_is_output=*/false);
+  ASSERT_EQ(model.ApplyDelegate(), kTfLiteOk);
+
+  EXPECT_EQ(model.tensor(model.boundary())->buffer_handle,
+            kTfLiteNullBufferHandle);
+  model.PopulateTensor<float>(model.input(), {1, 2, 3, 4});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({6, 12, 18, 24})));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tflite
@@ -58,6 +58,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate_kernel.h"
 #include "tensorflow/lite/delegates/nnapi/quant_lstm_sup.h"
+#include "tensorflow/lite/delegates/telemetry.h"
 #include "tensorflow/lite/delegates/utils.h"
 #include "tensorflow/lite/kernels/internal/utils/sparsity_format_converter.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -751,6 +752,60 @@ TfLiteStatus GetTargetDevices(TfLiteContext* context, TfLiteDelegate* delegate,
   return kTfLiteOk;
 }
 
+// Derives a compilation cache token from the content of the model: the
+// operators in `plan` and the types, shapes and constant data of the tensors.
+// An updated model gets a new token, so the compilations cached for the
+// previous version are never reused.
+std::string ModelTokenFromContent(TfLiteContext* context,
+                                  const TfLiteIntArray* plan) {
+  std::vector<uint64_t> content;
+  for (int node_index : TfLiteIntArrayView(plan)) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, node_index, &node,
+                                        &registration) != kTfLiteOk) {
+      continue;
+    }
+    content.push_back(registration->builtin_code);
+    content.push_back(registration->version);
+    if (registration->custom_name) {
+      content.push_back(::util::Fingerprint64(
+          registration->custom_name, strlen(registration->custom_name)));
+    }
+    content.insert(content.end(), node->inputs->data,
+                   node->inputs->data + node->inputs->size);
+    content.insert(content.end(), node->outputs->data,
+                   node->outputs->data + node->outputs->size);
+  }
+  for (int i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    content.push_back(tensor.type);
+    if (tensor.dims) {
+      content.insert(content.end(), tensor.dims->data,
+                     tensor.dims->data + tensor.dims->size);
+    }
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+      content.push_back(::util::Fingerprint64(tensor.data.raw, tensor.bytes));
+    }
+  }
+  return "nnapi_" + delegates::StrFingerprint(
+                        content.data(), content.size() * sizeof(uint64_t));
+}
+
+// Reports to the profiler the nodes of the execution plan that the delegate
+// leaves to the TFLite CPU kernels.
+void ReportFallbackNodes(TfLiteContext* context, TfLiteDelegate* delegate,
+                         int num_plan_nodes, int num_delegated_nodes,
+                         int nnapi_errno) {
+  if (num_delegated_nodes < num_plan_nodes) {
+    delegates::ReportDelegateFallback(
+        context, delegate,
+        delegates::DelegateStatus(delegates::DelegateStatusSource::TFLITE_NNAPI,
+                                  nnapi_errno),
+        num_plan_nodes - num_delegated_nodes);
+  }
+}
+
 // The context to be used with NnapiMappingUtilCInterface.
 class NnapiMappingContext {
  public:
@@ -4777,24 +4832,31 @@ TfLiteStatus NNAPIDelegateKernel::Prepare(TfLiteContext* context,
     should_use_burst_mode = true;
   }
   // Create burst object to be reused across a sequence of executions
-  if (should_use_burst_mode &&
-      nnapi_->android_sdk_version >= kMinSdkVersionForNNAPI12 &&
-      nnapi_->ANeuralNetworksBurst_create) {
-    ANeuralNetworksBurst* burst = nullptr;
-    const int create_burst_result =
-        nnapi_->ANeuralNetworksBurst_create(nn_compilation_.get(), &burst);
-    if (create_burst_result != ANEURALNETWORKS_NO_ERROR) {
-      nnapi_->ANeuralNetworksBurst_free(burst);
-      burst = nullptr;
-    }
-    RETURN_TFLITE_ERROR_IF_NN_ERROR(context, create_burst_result,
+  if (should_use_burst_mode && IsBurstSupported()) {
+    RETURN_TFLITE_ERROR_IF_NN_ERROR(context, CreateBurst(),
                                     "creating NNAPI burst", nnapi_errno);
-    nn_burst_.reset(burst);
   }
 
   return kTfLiteOk;
 }
 
+bool NNAPIDelegateKernel::IsBurstSupported() const {
+  return nnapi_->android_sdk_version >= kMinSdkVersionForNNAPI12 &&
+         nnapi_->ANeuralNetworksBurst_create != nullptr;
+}
+
+int NNAPIDelegateKernel::CreateBurst() {
+  ANeuralNetworksBurst* burst = nullptr;
+  const int create_burst_result =
+      nnapi_->ANeuralNetworksBurst_create(nn_compilation_.get(), &burst);
+  if (create_burst_result != ANEURALNETWORKS_NO_ERROR) {
+    nnapi_->ANeuralNetworksBurst_free(burst);
+    burst = nullptr;
+  }
+  nn_burst_.reset(burst);
+  return create_burst_result;
+}
+
 TfLiteStatus NNAPIDelegateKernel::GetOperationsSupportedByTargetNnApiDevices(
     TfLiteContext* context, std::vector<int>* supported_nodes,
     int* nnapi_errno) {
@@ -5220,6 +5282,16 @@ TfLiteStatus NNAPIDelegateKernel::Invoke(TfLiteContext* context,
                                     "waiting for async computation completion",
                                     nnapi_errno);
   } else {
+    // Models invoked repeatedly, e.g. always-on ones, switch to burst mode on
+    // their second invocation, which keeps the driver resources of the
+    // execution alive between invocations. Starting from NNAPI feature level
+    // 8, reusable executions are preferred.
+    if (!nn_burst_ && !burst_creation_failed_ &&
+        target_feature_level_ < kNNAPIRuntimeFeatureLevel8 &&
+        IsBurstSupported() && ++num_invocations_ >= 2) {
+      // Not a critical error, the computation runs without burst.
+      burst_creation_failed_ = CreateBurst() != ANEURALNETWORKS_NO_ERROR;
+    }
     // Use Burst mode by default for NNAPI 1.2+.
     if (nn_burst_) {
       RETURN_TFLITE_ERROR_IF_NN_ERROR(
@@ -6940,7 +7012,14 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
             reinterpret_cast<NNAPIDelegateKernel*>(node->user_data);
         int* nnapi_errno =
             &(static_cast<Data*>(node->delegate->data_)->nnapi_errno);
-        return state->Prepare(context, node, nnapi_errno);
+        const TfLiteStatus status = state->Prepare(context, node, nnapi_errno);
+        if (status != kTfLiteOk) {
+          delegates::ReportDelegateStatus(
+              context, node->delegate,
+              delegates::DelegateStatus(
+                  delegates::DelegateStatusSource::TFLITE_NNAPI, *nnapi_errno));
+        }
+        return status;
       },
 
       .invoke = [](TfLiteContext* context, TfLiteNode* node) -> TfLiteStatus {
@@ -6948,7 +7027,14 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
             reinterpret_cast<NNAPIDelegateKernel*>(node->user_data);
         int* nnapi_errno =
             &(static_cast<Data*>(node->delegate->data_)->nnapi_errno);
-        return state->Invoke(context, node, nnapi_errno);
+        const TfLiteStatus status = state->Invoke(context, node, nnapi_errno);
+        if (status != kTfLiteOk) {
+          delegates::ReportDelegateStatus(
+              context, node->delegate,
+              delegates::DelegateStatus(
+                  delegates::DelegateStatusSource::TFLITE_NNAPI, *nnapi_errno));
+        }
+        return status;
       },
 
       .profiling_string = nullptr,
@@ -6960,6 +7046,16 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
   // Initialize caching, if applicable, from Options.
   const char* cache_dir = delegate_options.cache_dir;
   const char* model_token = delegate_options.model_token;
+  if (cache_dir && !model_token) {
+    // Fingerprinting the constant data is costly for large models, so the
+    // token is derived once for the model the delegate is applied to.
+    if (delegate_data->model_token_context != context) {
+      delegate_data->model_token_from_content =
+          ModelTokenFromContent(context, plan.get());
+      delegate_data->model_token_context = context;
+    }
+    model_token = delegate_data->model_token_from_content.c_str();
+  }
   delegates::SerializationParams params = {model_token, cache_dir};
   if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir &&
       model_token) {
@@ -6974,6 +7070,8 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
     TfLiteIntArray* cached_nodes_to_delegate = nullptr;
     if (delegates::GetDelegatedNodes(context, cache_ptr, accelerator_id,
                                      &cached_nodes_to_delegate) == kTfLiteOk) {
+      ReportFallbackNodes(context, delegate, plan->size,
+                          cached_nodes_to_delegate->size, *nnapi_errno);
       if (cached_nodes_to_delegate->size == 0) return kTfLiteOk;
       auto status = context->ReplaceNodeSubsetsWithDelegateKernels(
           context, nnapi_delegate_kernel, cached_nodes_to_delegate, delegate);
@@ -7050,6 +7148,8 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
     }
   }
 
+  ReportFallbackNodes(context, delegate, plan->size,
+                      nodes_to_delegate_int_array->size, *nnapi_errno);
   if (nodes_to_delegate_int_array->size == 0) {
     return kTfLiteOk;
   } else {
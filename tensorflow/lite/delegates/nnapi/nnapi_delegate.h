@@ -71,9 +71,10 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     const char* cache_dir = nullptr;
 
     // The unique nul-terminated token string for NNAPI model.
-    // Default to nullptr, which implies the NNAPI will not try caching the
-    // compilation. It is the caller's responsibility to ensure there is no
-    // clash of the tokens.
+    // Default to nullptr, which implies that the token is derived from the
+    // operators and the constant tensors of the model when cache_dir is set,
+    // so that an updated model doesn't reuse stale compilations. Otherwise, it
+    // is the caller's responsibility to ensure there is no clash of the tokens.
     // NOTE: when using compilation caching, it is not recommended to use the
     // same delegate instance for multiple models.
     const char* model_token = nullptr;
@@ -137,6 +138,9 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // higher, NNAPI delegate will automatically enable burst mode for better
     // performance.
     // Default: Disabled for devices with NNAPI feature level 4 or lower.
+    // Even when disabled, models invoked more than once switch to burst mode
+    // from their second invocation if burst is supported and the devices are
+    // of NNAPI feature level 7 or lower.
     bool use_burst_computation = false;
 
     // Specifies the max number of NNAPI reusable executions to cache. An
@@ -308,6 +312,10 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     std::string cache_dir;
     // The unique token string for NNAPI model.
     std::string model_token;
+    // The token derived from the model content when a cache dir is set
+    // without a model token, and the context of the model it was derived for.
+    std::string model_token_from_content;
+    const TfLiteContext* model_token_context = nullptr;
     // Whether to disallow NNAPI CPU.
     bool disallow_nnapi_cpu;
     // Tensor to ANeuralNetworksMemory mapping.
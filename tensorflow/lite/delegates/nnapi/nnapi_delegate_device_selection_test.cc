@@ -211,6 +211,70 @@ TEST_F(NnApiDeviceSelectionTest,
   EXPECT_EQ(m.CountOpsExecutedByCpuKernel(), 1);
 }
 
+std::vector<std::vector<uint8_t>>* compilation_caching_tokens =
+    new std::vector<std::vector<uint8_t>>();
+int compilation_caching_burst_create_count = 0;
+int compilation_caching_burst_compute_count = 0;
+
+TEST_F(NnApiDeviceSelectionTest,
+       StatefulDelegateWithCompilationCachingWithoutToken) {
+  compilation_caching_tokens->clear();
+  compilation_caching_burst_create_count = 0;
+  compilation_caching_burst_compute_count = 0;
+  nnapi_mock_->StubCompilationSetCachingWith(
+      [](ANeuralNetworksCompilation* compilation, const char* cacheDir,
+         const uint8_t* token) -> int {
+        compilation_caching_tokens->emplace_back(token, token + 32);
+        return ANEURALNETWORKS_NO_ERROR;
+      });
+  nnapi_mock_->StubBurstCreateWith(
+      [](ANeuralNetworksCompilation* compilation,
+         ANeuralNetworksBurst** burst) -> int {
+        ++compilation_caching_burst_create_count;
+        *burst = reinterpret_cast<ANeuralNetworksBurst*>(5);
+        return ANEURALNETWORKS_NO_ERROR;
+      });
+  nnapi_mock_->StubExecutionBurstComputeWith(
+      [](ANeuralNetworksExecution* execution,
+         ANeuralNetworksBurst* burst) -> int {
+        ++compilation_caching_burst_compute_count;
+        return ANEURALNETWORKS_NO_ERROR;
+      });
+
+  const std::string cache_dir = ::testing::TempDir();
+  tflite::StatefulNnApiDelegate::Options options;
+  options.disallow_nnapi_cpu = false;
+  options.cache_dir = cache_dir.c_str();
+  InitWithOptions(options);
+  EXPECT_EQ(m.GetCompilationStatus(), kTfLiteOk);
+
+  // The compilation is cached with a token derived from the model content.
+  ASSERT_EQ(compilation_caching_tokens->size(), 1);
+  EXPECT_NE(compilation_caching_tokens->at(0), std::vector<uint8_t>(32, 0));
+
+  // The first invocation runs without burst, the next ones with it.
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(compilation_caching_burst_create_count, 0);
+  EXPECT_EQ(compilation_caching_burst_compute_count, 0);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(compilation_caching_burst_create_count, 1);
+  EXPECT_EQ(compilation_caching_burst_compute_count, 1);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(compilation_caching_burst_create_count, 1);
+  EXPECT_EQ(compilation_caching_burst_compute_count, 2);
+
+  // The same model content gets the same token.
+  FloatAddOpModel same_model;
+  same_model.Init(nnapi_mock_->GetNnApi(), options,
+                  {TensorType_FLOAT32, {1, 2, 2, 1}},
+                  {TensorType_FLOAT32, {1, 2, 2, 1}}, {TensorType_FLOAT32, {}},
+                  ActivationFunctionType_NONE);
+  EXPECT_EQ(same_model.GetCompilationStatus(), kTfLiteOk);
+  ASSERT_EQ(compilation_caching_tokens->size(), 2);
+  EXPECT_EQ(compilation_caching_tokens->at(1),
+            compilation_caching_tokens->at(0));
+}
+
 struct UnsupportedOperationOnDeviceTest
     : ::tflite::delegate::nnapi::NnApiDelegateMockTest {};
 
@@ -385,6 +385,18 @@ class NNAPIDelegateKernel {
   // Fully initialized in NNAPIDelegateKernel::AddOpsAndTensors
   int target_feature_level_ = 27;  // kMinSdkVersionForNNAPI10
 
+  // Number of calls to Invoke, used to switch to burst mode once the model is
+  // invoked repeatedly.
+  int num_invocations_ = 0;
+  // True if creating a burst for repeated invocations failed, in which case
+  // it isn't retried.
+  bool burst_creation_failed_ = false;
+
+  // Whether ANeuralNetworksBurst is available for nn_compilation_.
+  bool IsBurstSupported() const;
+  // Creates nn_burst_ for nn_compilation_ and returns the NNAPI result code.
+  int CreateBurst();
+
   void AddDequantizeOperatorsWhereNeeded(
       const TfLiteContext* context, int builtin_code, const TfLiteNode* node,
       int tflite_node_index, NNAPIOpBuilder* builder, int* nnapi_errno);
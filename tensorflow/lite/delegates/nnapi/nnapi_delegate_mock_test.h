@@ -54,6 +54,7 @@ class NnApiMock : public ::tflite::nnapi::NnApiHandler {
       return open("/dev/zero", O_RDWR);
     };
     nnapi_->ANeuralNetworksEvent_free = [](ANeuralNetworksEvent* event) {};
+    nnapi_->ANeuralNetworksBurst_free = [](ANeuralNetworksBurst* burst) {};
 
     ModelCreateReturns<ANEURALNETWORKS_NO_ERROR>();
     AddOperandReturns<ANEURALNETWORKS_NO_ERROR>();
@@ -45,5 +45,16 @@ TfLiteStatus ReportDelegateStatus(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus ReportDelegateFallback(TfLiteContext* context,
+                                    TfLiteDelegate* delegate,
+                                    const DelegateStatus& reason,
+                                    int num_fallback_nodes) {
+  auto* profiler = reinterpret_cast<Profiler*>(context->profiler);
+  TFLITE_ADD_RUNTIME_INSTRUMENTATION_EVENT(
+      profiler, kDelegateFallbackTag, reason.full_status(),
+      static_cast<int64_t>(num_fallback_nodes));
+  return kTfLiteOk;
+}
+
 }  // namespace delegates
 }  // namespace tflite
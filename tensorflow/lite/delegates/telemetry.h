@@ -33,6 +33,7 @@ namespace delegates {
 // Used to identify specific events for tflite::Profiler.
 constexpr char kDelegateSettingsTag[] = "delegate_settings";
 constexpr char kDelegateStatusTag[] = "delegate_status";
+constexpr char kDelegateFallbackTag[] = "delegate_fallback";
 
 // Defines the delegate or hardware-specific 'namespace' that a status code
 // belongs to. For example, GPU delegate errors might be belong to TFLITE_GPU,
@@ -104,6 +105,18 @@ TfLiteStatus ReportDelegateStatus(TfLiteContext* context,
                                   TfLiteDelegate* delegate,
                                   const DelegateStatus& status);
 
+// Used by delegates to report that `num_fallback_nodes` of the nodes in the
+// execution plan run on the TFLite CPU kernels instead of the delegate.
+// `reason` is the status that caused the fallback, with a code of 0 if the
+// nodes are just not supported.
+// Calling this method adds a new GENERAL_RUNTIME_INSTRUMENTATION_EVENT to
+// the runtime Profiler, with the full status as first metadata and
+// `num_fallback_nodes` as second metadata.
+TfLiteStatus ReportDelegateFallback(TfLiteContext* context,
+                                    TfLiteDelegate* delegate,
+                                    const DelegateStatus& reason,
+                                    int num_fallback_nodes);
+
 }  // namespace delegates
 }  // namespace tflite
 
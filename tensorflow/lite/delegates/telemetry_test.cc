@@ -30,6 +30,7 @@ namespace delegates {
 namespace {
 
 constexpr int32_t kDummyCode = 2;
+constexpr int kDummyNumFallbackNodes = 3;
 constexpr bool kDummyGpuPrecisionLossAllowed = true;
 constexpr tflite::Delegate kDummyDelegate = tflite::Delegate_GPU;
 constexpr DelegateStatusSource kDummySource =
@@ -81,6 +82,16 @@ class DelegateProfiler : public Profiler {
       DelegateStatus reported_status(event_metadata1);
       EXPECT_EQ(reported_status.source(), kDummySource);
       EXPECT_EQ(reported_status.code(), kDummyCode);
+    } else if (event_type ==
+                   Profiler::EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT &&
+               std::string(tag) == kDelegateFallbackTag) {
+      event_buffer_.emplace_back();
+      event_handle = event_buffer_.size();
+
+      DelegateStatus reason(event_metadata1);
+      EXPECT_EQ(reason.source(), kDummySource);
+      EXPECT_EQ(reason.code(), kDummyCode);
+      EXPECT_EQ(event_metadata2, kDummyNumFallbackNodes);
     }
 
     EXPECT_NE(-1, event_handle);
@@ -109,6 +120,19 @@ TEST(TelemetryTest, DelegateStatusReport) {
   EXPECT_EQ(profiler.NumRecordedEvents(), 2);
 }
 
+TEST(TelemetryTest, DelegateFallbackReport) {
+  DelegateProfiler profiler;
+  TfLiteDelegate delegate = TfLiteDelegateCreate();
+  TfLiteContext context;
+  context.profiler = &profiler;
+  DelegateStatus reason(kDummySource, kDummyCode);
+
+  EXPECT_EQ(ReportDelegateFallback(&context, &delegate, reason,
+                                   kDummyNumFallbackNodes),
+            kTfLiteOk);
+  EXPECT_EQ(profiler.NumRecordedEvents(), 1);
+}
+
 TEST(TelemetryTest, DelegateSettingsReport) {
   DelegateProfiler profiler;
   TfLiteDelegate delegate = TfLiteDelegateCreate();
@@ -122,6 +122,76 @@ GraphPartitionHelper::GetFirstNLargestPartitions(
   return results;
 }
 
+bool OpLatencyProfile::GetNodeLatency(TfLiteContext* context, TfLiteNode* node,
+                                      TfLiteRegistration* registration,
+                                      float* cpu_latency_us,
+                                      float* delegate_latency_us) const {
+  auto it = latencies_.find(registration->builtin_code);
+  if (it == latencies_.end()) return false;
+  int64_t num_output_elements = 0;
+  for (int i = 0; i < node->outputs->size; ++i) {
+    const int tensor_index = node->outputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    num_output_elements += NumElements(&context->tensors[tensor_index]);
+  }
+  *cpu_latency_us = it->second.first * num_output_elements;
+  *delegate_latency_us = it->second.second * num_output_elements;
+  return true;
+}
+
+std::vector<int> GraphPartitionHelper::GetNodesOfProfitablePartitions(
+    const PartitionCostModel& cost_model, int n) const {
+  std::vector<std::pair<float, TfLiteDelegateParams*>> profitable_partitions;
+  for (TfLiteDelegateParams* partition : partitions_) {
+    float savings_us = -cost_model.invoke_overhead_us;
+    for (int node_index : TfLiteIntArrayView(partition->nodes_to_replace)) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      float cpu_latency_us;
+      float delegate_latency_us;
+      if (cost_model.node_latency &&
+          context_->GetNodeAndRegistration(context_, node_index, &node,
+                                           &registration) == kTfLiteOk &&
+          cost_model.node_latency(context_, node, registration,
+                                  &cpu_latency_us, &delegate_latency_us)) {
+        savings_us += cpu_latency_us - delegate_latency_us;
+      }
+    }
+    size_t transfer_bytes = 0;
+    if (partition->input_tensors) {
+      for (int tensor_index : TfLiteIntArrayView(partition->input_tensors)) {
+        const TfLiteTensor& tensor = context_->tensors[tensor_index];
+        if (!IsConstantTensor(&tensor)) transfer_bytes += tensor.bytes;
+      }
+    }
+    if (partition->output_tensors) {
+      for (int tensor_index : TfLiteIntArrayView(partition->output_tensors)) {
+        transfer_bytes += context_->tensors[tensor_index].bytes;
+      }
+    }
+    savings_us -= cost_model.transfer_latency_us_per_byte * transfer_bytes;
+    if (savings_us > 0.0f) {
+      profitable_partitions.emplace_back(savings_us, partition);
+    }
+  }
+  std::stable_sort(profitable_partitions.begin(), profitable_partitions.end(),
+                   [](const std::pair<float, TfLiteDelegateParams*>& left,
+                      const std::pair<float, TfLiteDelegateParams*>& right) {
+                     // Reverse sort
+                     return left.first > right.first;
+                   });
+
+  std::vector<int> ops_to_replace;
+  const int num_partitions =
+      std::min(static_cast<int>(profitable_partitions.size()), n);
+  for (int i = 0; i < num_partitions; ++i) {
+    auto nodes = profitable_partitions[i].second->nodes_to_replace;
+    ops_to_replace.insert(ops_to_replace.end(), nodes->data,
+                          nodes->data + nodes->size);
+  }
+  return ops_to_replace;
+}
+
 std::vector<int> GraphPartitionHelper::GetNodesOfFirstNLargestPartitionsImpl(
     int n, int min_nodes_per_partition) {
   auto first_n_partitions =
@@ -96,6 +96,47 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Estimates the latency of a node on the TFLite CPU kernels and on the
+// delegate, in microseconds. Returns false if there is no estimate for the
+// node, in which case it is assumed to be as fast on both.
+using NodeLatencyFn = std::function<bool(
+    TfLiteContext*, TfLiteNode*, TfLiteRegistration*, float* cpu_latency_us,
+    float* delegate_latency_us)>;
+
+// Cost model used to decide whether delegating a partition is faster than
+// running it on the CPU.
+struct PartitionCostModel {
+  NodeLatencyFn node_latency;
+  // Latency of copying one byte of a partition input or output between the
+  // CPU and the delegate.
+  float transfer_latency_us_per_byte = 0.0f;
+  // Fixed latency of invoking a delegate kernel, e.g. submitting its work and
+  // waiting for the results.
+  float invoke_overhead_us = 0.0f;
+};
+
+// Per-op latencies measured on the device, keyed by builtin code. They are
+// normalized by the number of output elements, so that the latencies of an op
+// measured on one model apply to the shapes of another. Typically filled once
+// from profiling runs with and without the delegate, e.g. the op summaries of
+// benchmark_model, and cached by the app.
+class OpLatencyProfile {
+ public:
+  void AddOp(int builtin_code, float cpu_latency_us_per_element,
+             float delegate_latency_us_per_element) {
+    latencies_[builtin_code] = {cpu_latency_us_per_element,
+                                delegate_latency_us_per_element};
+  }
+
+  // Implements NodeLatencyFn.
+  bool GetNodeLatency(TfLiteContext* context, TfLiteNode* node,
+                      TfLiteRegistration* registration, float* cpu_latency_us,
+                      float* delegate_latency_us) const;
+
+ private:
+  std::unordered_map<int, std::pair<float, float>> latencies_;
+};
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -160,6 +201,16 @@ class GraphPartitionHelper {
     return GetNodesOfFirstNLargestPartitionsImpl(n, min_nodes_per_partition);
   }
 
+  // Returns a list of node indices of all nodes from the partitions that are
+  // estimated by 'cost_model' to run faster on the delegate than on the CPU,
+  // once the latency of their inputs and outputs transfers and of invoking the
+  // delegate are counted. At most 'n' partitions are returned, ranked
+  // according to their estimated savings. This avoids the fragmented
+  // delegation of small partitions that makes a model slower than on the CPU.
+  std::vector<int> GetNodesOfProfitablePartitions(
+      const PartitionCostModel& cost_model,
+      int n = std::numeric_limits<int>::max()) const;
+
   int num_total_nodes() const { return num_total_nodes_; }
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
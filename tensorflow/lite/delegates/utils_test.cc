@@ -253,6 +253,35 @@ TEST(GraphPartitionHelper, CheckPartitions) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+bool OneMicrosecondFasterOnDelegate(TfLiteContext* context, TfLiteNode* node,
+                                    TfLiteRegistration* registration,
+                                    float* cpu_latency_us,
+                                    float* delegate_latency_us) {
+  *cpu_latency_us = 3.0f;
+  *delegate_latency_us = 2.0f;
+  return true;
+}
+
+TEST(GraphPartitionHelper, CheckProfitablePartitions) {
+  // The mocked TfLiteContext has 4 partitions: {1}, {0,3,7,8}, {2,4,9}, {5,6}.
+  MockTfLiteContext mocked_context;
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+
+  PartitionCostModel cost_model;
+  cost_model.node_latency = OneMicrosecondFasterOnDelegate;
+  // Only partitions with at least 3 nodes are faster on the delegate.
+  cost_model.invoke_overhead_us = 2.5f;
+  EXPECT_THAT(helper.GetNodesOfProfitablePartitions(cost_model),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
+  EXPECT_THAT(helper.GetNodesOfProfitablePartitions(cost_model, 1),
+              testing::ElementsAreArray({0, 3, 7, 8}));
+
+  // Without an estimate, no partition is worth the invoke overhead.
+  EXPECT_TRUE(helper.GetNodesOfProfitablePartitions(PartitionCostModel())
+                  .empty());
+}
+
 TfLiteStatus ErrorGetExecutionPlan(TfLiteContext* context,
                                    TfLiteIntArray** execution_plan) {
   return kTfLiteError;
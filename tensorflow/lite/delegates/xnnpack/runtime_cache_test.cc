@@ -0,0 +1,208 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// A model that adds two float inputs of the same shape.
+std::vector<char> CreateAddModel() {
+  flatbuffers::FlatBufferBuilder builder;
+  flatbuffers::Offset<OperatorCode> operator_code =
+      CreateOperatorCode(builder, BuiltinOperator_ADD);
+
+  const std::array<flatbuffers::Offset<Buffer>, 1> buffers{{
+      CreateBuffer(builder, builder.CreateVector({})),
+  }};
+
+  const std::array<int32_t, 4> shape{{1, 2, 2, 3}};
+  const std::array<flatbuffers::Offset<Tensor>, 3> tensors{{
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>(shape.data(), shape.size()),
+                   TensorType_FLOAT32),
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>(shape.data(), shape.size()),
+                   TensorType_FLOAT32),
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>(shape.data(), shape.size()),
+                   TensorType_FLOAT32),
+  }};
+
+  const std::array<int32_t, 2> op_inputs{{0, 1}};
+  const std::array<int32_t, 1> op_outputs{{2}};
+  flatbuffers::Offset<Operator> op = CreateOperator(
+      builder, /*opcode_index=*/0,
+      builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
+      builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+      BuiltinOptions_AddOptions, CreateAddOptions(builder).Union());
+
+  flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
+      builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+      builder.CreateVector(&op, 1));
+
+  flatbuffers::Offset<flatbuffers::String> description =
+      builder.CreateString("Runtime cache model");
+
+  flatbuffers::Offset<Model> model_buffer = CreateModel(
+      builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(&operator_code, 1),
+      builder.CreateVector(&subgraph, 1), description,
+      builder.CreateVector(buffers.data(), buffers.size()));
+
+  builder.Finish(model_buffer);
+
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+class RuntimeCacheTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    buffer_ = CreateAddModel();
+    ASSERT_EQ(
+        InterpreterBuilder(
+            GetModel(buffer_.data()),
+            ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+            &interpreter_),
+        kTfLiteOk);
+    ASSERT_TRUE(interpreter_);
+
+    TfLiteXNNPackDelegateOptions delegate_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    delegate_options.flags |=
+        TFLITE_XNNPACK_DELEGATE_FLAG_ENABLE_SUBGRAPH_RESHAPING;
+    delegate_options.experimental_max_cached_runtimes = GetParam();
+    delegate_.reset(TfLiteXNNPackDelegateCreate(&delegate_options));
+
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(delegate_.get()),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+    ASSERT_EQ(interpreter_->node_and_registration(
+                  interpreter_->execution_plan()[0])->first.delegate,
+              delegate_.get());
+  }
+
+  // Resizes the inputs to `shape`, runs the model, and checks the output.
+  void InvokeWithShape(const std::vector<int>& shape) {
+    SCOPED_TRACE(::testing::PrintToString(shape));
+    for (int input : interpreter_->inputs()) {
+      ASSERT_EQ(interpreter_->ResizeInputTensor(input, shape), kTfLiteOk);
+    }
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+    const int size = std::accumulate(shape.begin(), shape.end(), 1,
+                                     std::multiplies<int>());
+    float* input0 = interpreter_->typed_input_tensor<float>(0);
+    float* input1 = interpreter_->typed_input_tensor<float>(1);
+    // Different data on every run, so that stale outputs are detected.
+    for (int i = 0; i < size; ++i) {
+      input0[i] = static_cast<float>(i);
+      input1[i] = 0.5f * static_cast<float>(num_invocations_);
+    }
+    ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+    ++num_invocations_;
+
+    const TfLiteTensor* output =
+        interpreter_->tensor(interpreter_->outputs()[0]);
+    ASSERT_EQ(output->dims->size, static_cast<int>(shape.size()));
+    for (int i = 0; i < shape.size(); ++i) {
+      ASSERT_EQ(output->dims->data[i], shape[i]);
+    }
+    const float* output_data = interpreter_->typed_output_tensor<float>(0);
+    for (int i = 0; i < size; ++i) {
+      ASSERT_EQ(output_data[i], input0[i] + input1[i]) << "at " << i;
+    }
+  }
+
+  const std::vector<int> kShapeA{1, 2, 2, 3};
+  const std::vector<int> kShapeB{1, 4, 3, 3};
+  const std::vector<int> kShapeC{2, 5, 1, 3};
+  const std::vector<int> kShapeD{1, 7, 7, 3};
+
+  std::vector<char> buffer_;
+  // Declared before the interpreter, so that it outlives it.
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate_{nullptr, TfLiteXNNPackDelegateDelete};
+  std::unique_ptr<Interpreter> interpreter_;
+  int num_invocations_ = 0;
+};
+
+TEST_P(RuntimeCacheTest, SameShape) {
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeA);
+}
+
+TEST_P(RuntimeCacheTest, SwapsBetweenTwoShapes) {
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeA);
+}
+
+TEST_P(RuntimeCacheTest, EvictsLeastRecentlyUsedRuntime) {
+  // With two runtimes, C recycles the runtime of A, then A the one of B, so
+  // that C and A remain cached.
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeC);
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeC);
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeC);
+}
+
+TEST_P(RuntimeCacheTest, EvictsAfterReuse) {
+  // Using A again makes B the least recently used runtime, so D recycles the
+  // runtime of B with three runtimes.
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeC);
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeD);
+  InvokeWithShape(kShapeA);
+  InvokeWithShape(kShapeC);
+  InvokeWithShape(kShapeB);
+  InvokeWithShape(kShapeD);
+}
+
+INSTANTIATE_TEST_SUITE_P(MaxCachedRuntimes, RuntimeCacheTest,
+                         ::testing::Values(0, 1, 2, 3, 8));
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
@@ -228,6 +228,7 @@ bool WriteData(const int fd, const uint8_t* data, size_t size,
           tflite::TFLITE_LOG_ERROR,
           "XNNPack weight cache: file write incomplete (%s). %s: %s.",
           file_path, step_description, strerror(errno))
+      return false;
     }
     bytes += written_bytes;
   }
@@ -238,13 +239,26 @@ bool WriteData(const int fd, const uint8_t* data, size_t size,
 }  // namespace
 
 bool WeightCacheBuilder::Write(const char* path) {
-  const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#if defined(_MSC_VER)
+  const std::string tmp_path = path;
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#else
+  // The cache is written to a temporary file that replaces `path` once it is
+  // complete. This way, other processes loading the cache at the same time
+  // never see a partially written file and the mappings they already hold
+  // stay valid.
+  std::string tmp_path = std::string(path) + ".XXXXXX";
+  int fd = mkstemp(tmp_path.data());
+  if (fd != -1) {
+    fchmod(fd, 0644);
+  }
+#endif
   if (fd == -1) {
     TFLITE_LOG_PROD(
         tflite::TFLITE_LOG_ERROR,
         "XNNPack weight cache: could not open cache file ('%s') for "
         "writing: %s.",
-        path, strerror(errno))
+        tmp_path.c_str(), strerror(errno))
     return false;
   }
 
@@ -253,6 +267,8 @@ bool WeightCacheBuilder::Write(const char* path) {
       close(fd);
     }
   });
+  ScopeGuard remove_tmp_file_on_error(
+      [&tmp_path] { unlink(tmp_path.c_str()); });
 
   flatbuffers::FlatBufferBuilder builder;
   // Add a fake size and the base offset to mutate them afterwards. Otherwise
@@ -288,6 +304,23 @@ bool WeightCacheBuilder::Write(const char* path) {
                  "Buffer data")) {
     return false;
   }
+  if (close(fd)) {
+    fd = -1;
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                    "XNNPack weight cache: could not close '%s': %s.",
+                    tmp_path.c_str(), strerror(errno));
+    return false;
+  }
+  fd = -1;
+#if !defined(_MSC_VER)
+  if (rename(tmp_path.c_str(), path)) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                    "XNNPack weight cache: could not move '%s' to '%s': %s.",
+                    tmp_path.c_str(), path, strerror(errno));
+    return false;
+  }
+#endif
+  remove_tmp_file_on_error.Deactivate();
   TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
                   "XNNPack weight cache: written to '%s'.", path);
   return true;
@@ -347,6 +380,13 @@ bool MMapWeightCacheProvider::Load() {
     return false;
   }
 
+  // A cache that fails validation is not used, the caller can rebuild it.
+  ScopeGuard unmap_on_error([this] {
+    mmap_handle_ = MMapHandle();
+    mmap_buffer_base_offset_ = 0;
+    cache_key_to_offset_.clear();
+  });
+
   // Verifiy the flabuffer part of the file.
   const size_t verifier_size =
       std::min(mmap_handle_.size(),
@@ -367,7 +407,22 @@ bool MMapWeightCacheProvider::Load() {
         "XNNPack weight cache: could not get packed weights from flatbuffer.");
     return false;
   }
-  mmap_buffer_base_offset_ = packed_weights->base_offset();
+
+  // The file may have been truncated or may not have been written by this
+  // version of the cache builder. Check that everything it describes fits in
+  // the mapping before handing out addresses into it.
+  const size_t file_size = mmap_handle_.size();
+  const uint64_t base_offset = packed_weights->base_offset();
+  if (packed_weights->flatbuffer_size() > file_size ||
+      base_offset < packed_weights->flatbuffer_size() ||
+      base_offset > file_size || base_offset % kMinAlignment) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                    "XNNPack weight cache: invalid header in '%s'.",
+                    file_path_.c_str());
+    return false;
+  }
+  const uint64_t data_size = file_size - base_offset;
+  mmap_buffer_base_offset_ = base_offset;
   if (const auto buffers = packed_weights->buffers(); buffers) {
     for (auto* buffer : *buffers) {
       if (!buffer) {
@@ -376,6 +431,14 @@ bool MMapWeightCacheProvider::Load() {
             "XNNPack weight cache: Invalid buffer address in buffer list.");
         return false;
       }
+      if (buffer->offset() > data_size ||
+          buffer->size() > data_size - buffer->offset()) {
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                        "XNNPack weight cache: buffer out of the bounds of "
+                        "'%s'. The file may be truncated.",
+                        file_path_.c_str());
+        return false;
+      }
       cache_key_to_offset_.emplace(
           PackIdentifier{.pack_algorithm_id = buffer->packing_algorithm_id(),
                          .weights_id = buffer->weights_id(),
@@ -383,6 +446,7 @@ bool MMapWeightCacheProvider::Load() {
           BufferLocation{.offset = buffer->offset(), .size = buffer->size()});
     }
   }
+  unmap_on_error.Deactivate();
   return true;
 }
 
@@ -592,6 +592,50 @@ TEST_F(LoadMMapWeightCacheProviderTest, LookUpSucceeds) {
               ElementsAreArray(reference_2.buffer));
 }
 
+TEST_F(LoadMMapWeightCacheProviderTest, LoadFailsOnTruncatedFile) {
+  std::vector<uint8_t> contents;
+  {
+    MMapHandle handle;
+    ASSERT_TRUE(handle.Map(tmp_file.GetCPath()));
+    contents.assign(handle.data(), handle.data() + handle.size() - 1);
+  }
+  TempFileDesc truncated_file;
+  ASSERT_TRUE(truncated_file.IsOpen());
+  ASSERT_EQ(write(truncated_file.GetFd(), contents.data(), contents.size()),
+            contents.size());
+  truncated_file.Close();
+
+  MMapWeightCacheProvider truncated_provider;
+  EXPECT_FALSE(truncated_provider.Load(truncated_file.GetPath()));
+  EXPECT_FALSE(truncated_provider.IsFinalized());
+  EXPECT_TRUE(truncated_provider.IsBuilding());
+}
+
+TEST(WeightCacheBuilderTest, WriteReplacesExistingFile) {
+  const std::string payload = "This is some data in the file.";
+  WeightCacheBuilder builder;
+  builder.Append(PackIdentifier{1, 2, 3}, payload.c_str(), payload.size());
+
+  TempFileDesc tmp_file;
+  ASSERT_TRUE(tmp_file.IsOpen());
+  MMapHandle old_handle;
+  const char old_payload[] = "Old data";
+  ASSERT_EQ(write(tmp_file.GetFd(), old_payload, sizeof(old_payload)),
+            sizeof(old_payload));
+  tmp_file.Close();
+  ASSERT_TRUE(old_handle.Map(tmp_file.GetCPath()));
+
+  ASSERT_TRUE(builder.Write(tmp_file.GetCPath()));
+
+  // Mappings of the previous file stay valid.
+  EXPECT_THAT(LightSpan<const char>(old_handle.data(), sizeof(old_payload)),
+              ElementsAreArray(old_payload));
+
+  MMapWeightCacheProvider provider;
+  ASSERT_TRUE(provider.Load(tmp_file.GetPath()));
+  EXPECT_TRUE(provider.IsFinalized());
+}
+
 TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   using std::size;
   TempFileDesc temp_fd(TempFileDesc::kAutoCLose);
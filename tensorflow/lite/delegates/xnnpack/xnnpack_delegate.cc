@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <memory>
@@ -604,6 +605,10 @@ class Delegate {
 #endif
   }
 
+  int max_cached_runtimes() const {
+    return options_.experimental_max_cached_runtimes;
+  }
+
   bool support_variable_ops() const {
     if (options_.flags & TFLITE_XNNPACK_DELEGATE_FLAG_VARIABLE_OPERATORS) {
       return true;
@@ -1155,8 +1160,16 @@ class Subgraph {
       return nullptr;
     }
 
-    return new Subgraph(delegate, runtime_ptr, externals, external_inputs,
-                        external_outputs, tflite_tensor_to_xnnpack);
+    Subgraph* result =
+        new Subgraph(delegate, runtime_ptr, externals, external_inputs,
+                     external_outputs, tflite_tensor_to_xnnpack);
+    // Keep the XNNPACK subgraph to create runtimes for other input shapes.
+    if (delegate.enable_subgraph_reshaping() &&
+        delegate.max_cached_runtimes() > 1 && !result->has_variables_) {
+      result->xnn_subgraph_ = std::move(subgraph);
+      result->runtime_flags_ = flags;
+    }
+    return result;
   }
 
   TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node,
@@ -1176,28 +1189,50 @@ class Subgraph {
 
     if (enable_subgraph_reshaping) {
       xnn_status status = xnn_status_invalid_state;
+      // Flattened list of the input ranks, each followed by the dimensions.
+      std::vector<size_t> input_shapes;
       for (int i = 0; i < inputs_.size(); ++i) {
         const TfLiteTensor* tensor = &context->tensors[inputs_[i]];
-        const int dims_count = NumDimensions(tensor);
-        std::array<size_t, XNN_MAX_TENSOR_DIMS> xnn_dims;
-        std::copy(&tensor->dims->data[0], &tensor->dims->data[dims_count],
-                  xnn_dims.begin());
-        status = xnn_reshape_external_value(
-            runtime_.get(), tflite_tensor_to_xnnpack_[inputs_[i]], dims_count,
-            xnn_dims.data());
-        if (status != xnn_status_success) {
-          TF_LITE_KERNEL_LOG(
-              context, "XNNPack delegate failed to reshape external value");
+        input_shapes.push_back(NumDimensions(tensor));
+        input_shapes.insert(input_shapes.end(), &tensor->dims->data[0],
+                            &tensor->dims->data[NumDimensions(tensor)]);
+      }
+      bool needs_reshape = true;
+      if (xnn_subgraph_ != nullptr && !runtime_input_shapes_.empty()) {
+        if (input_shapes == runtime_input_shapes_) {
+          needs_reshape = false;
+        } else if (SwitchRuntime(context, input_shapes, *delegate,
+                                 &needs_reshape) != kTfLiteOk) {
           return kTfLiteError;
         }
-        // signal that setup must be called.
-        externals_[inputs_[i]] = nullptr;
       }
-      status = xnn_reshape_runtime(runtime_.get());
-      if (status != xnn_status_success) {
-        TF_LITE_KERNEL_LOG(context,
-                           "XNNPack delegate failed to reshape runtime");
-        return kTfLiteError;
+      if (needs_reshape) {
+        // The shapes of the runtime are unknown until the reshape succeeded.
+        runtime_input_shapes_.clear();
+        for (int i = 0; i < inputs_.size(); ++i) {
+          const TfLiteTensor* tensor = &context->tensors[inputs_[i]];
+          const int dims_count = NumDimensions(tensor);
+          std::array<size_t, XNN_MAX_TENSOR_DIMS> xnn_dims;
+          std::copy(&tensor->dims->data[0], &tensor->dims->data[dims_count],
+                    xnn_dims.begin());
+          status = xnn_reshape_external_value(
+              runtime_.get(), tflite_tensor_to_xnnpack_[inputs_[i]],
+              dims_count, xnn_dims.data());
+          if (status != xnn_status_success) {
+            TF_LITE_KERNEL_LOG(
+                context, "XNNPack delegate failed to reshape external value");
+            return kTfLiteError;
+          }
+          // signal that setup must be called.
+          externals_[inputs_[i]] = nullptr;
+        }
+        status = xnn_reshape_runtime(runtime_.get());
+        if (status != xnn_status_success) {
+          TF_LITE_KERNEL_LOG(context,
+                             "XNNPack delegate failed to reshape runtime");
+          return kTfLiteError;
+        }
+        runtime_input_shapes_ = std::move(input_shapes);
       }
 
       for (int i = 0; i < outputs_.size(); ++i) {
@@ -3234,6 +3269,22 @@ class Subgraph {
             ? NumDimensions(&input_b) - 2
             : NumDimensions(&input_b) - 1,
         node->inputs->data[1], node_index));
+    if (input_b.quantization.type == kTfLiteAffineQuantization) {
+      const auto* input_b_params =
+          static_cast<const TfLiteAffineQuantization*>(
+              input_b.quantization.params);
+      if (input_b_params->scale != nullptr && input_b_params->scale->size > 1 &&
+          input_b_params->scale->size !=
+              SizeOfDimension(&input_b,
+                              input_b_params->quantized_dimension)) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "unsupported block-wise quantization of tensor #%d in %s node #%d",
+            node->inputs->data[1],
+            EnumNameBuiltinOperator(BuiltinOperator_BATCH_MATMUL), node_index);
+        return kTfLiteError;
+      }
+    }
 
     // Check whether input_a will be quantized dynamically.
     const bool dynamically_quantized =
@@ -4139,6 +4190,19 @@ class Subgraph {
 
     const int32_t output_channels = SizeOfDimension(&filter_tensor, 0);
     const int32_t input_channels = SizeOfDimension(&filter_tensor, 1);
+    if (filter_tensor.quantization.type == kTfLiteAffineQuantization) {
+      const auto* filter_params = static_cast<const TfLiteAffineQuantization*>(
+          filter_tensor.quantization.params);
+      if (filter_params->scale != nullptr && filter_params->scale->size > 1 &&
+          filter_params->scale->size != output_channels) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "unsupported block-wise quantization of filter tensor #%d in "
+            "FULLY_CONNECTED node #%d",
+            node->inputs->data[1], node_index);
+        return kTfLiteError;
+      }
+    }
 
     int bias_tensor_id = -1;
     if (node->inputs->size >= 3) {
@@ -7379,6 +7443,49 @@ class Subgraph {
   inline Delegate* GetDelegate() const { return delegate_; }
 
  private:
+  // Makes the runtime for `input_shapes` the active one. The previously active
+  // runtime is kept for its input shapes. If no runtime matches, a new one is
+  // created, or the least recently used one is recycled when the cache is
+  // full. In these cases `needs_reshape` is set to true.
+  TfLiteStatus SwitchRuntime(TfLiteContext* context,
+                             const std::vector<size_t>& input_shapes,
+                             Delegate& delegate, bool* needs_reshape) {
+    auto cached = std::find_if(cached_runtimes_.begin(), cached_runtimes_.end(),
+                               [&input_shapes](const CachedRuntime& entry) {
+                                 return entry.input_shapes == input_shapes;
+                               });
+    *needs_reshape = cached == cached_runtimes_.end();
+    if (*needs_reshape &&
+        cached_runtimes_.size() + 1 <
+            static_cast<size_t>(delegate.max_cached_runtimes())) {
+      xnn_runtime_t runtime_ptr = nullptr;
+      const xnn_status status = xnn_create_runtime_v4(
+          xnn_subgraph_.get(), delegate.weights_cache(), delegate.workspace(),
+          delegate.threadpool(), runtime_flags_, &runtime_ptr);
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(context, "failed to create XNNPACK runtime");
+        return kTfLiteError;
+      }
+      cached_runtimes_.push_back(CachedRuntime{
+          /*input_shapes=*/{},
+          std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)>(
+              runtime_ptr, &xnn_delete_runtime)});
+      cached = std::prev(cached_runtimes_.end());
+    } else if (*needs_reshape) {
+      cached = cached_runtimes_.begin();
+    }
+    // Swap the active runtime with the selected one and mark it as the most
+    // recently used.
+    std::swap(runtime_, cached->runtime);
+    std::swap(runtime_input_shapes_, cached->input_shapes);
+    std::rotate(cached, std::next(cached), cached_runtimes_.end());
+    // The new runtime has not been set up with the external values yet.
+    for (auto& external : externals_) {
+      external.second = nullptr;
+    }
+    return kTfLiteOk;
+  }
+
   Subgraph(Delegate& delegate, xnn_runtime_t runtime,
            const std::unordered_set<int>& externals, std::vector<int>& inputs,
            std::vector<int>& outputs,
@@ -7399,6 +7506,21 @@ class Subgraph {
   // management.
   std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime_{
       nullptr, &xnn_delete_runtime};
+  // Input shapes that the active runtime was reshaped for, in the format
+  // built by Prepare. Empty if the runtime wasn't reshaped yet.
+  std::vector<size_t> runtime_input_shapes_;
+  // Inactive runtimes created for other input shapes, from the least to the
+  // most recently used. Only used with `xnn_subgraph_`.
+  struct CachedRuntime {
+    std::vector<size_t> input_shapes;
+    std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime;
+  };
+  std::vector<CachedRuntime> cached_runtimes_;
+  // XNNPACK subgraph used to create the runtimes for new input shapes, and the
+  // flags to create them with. Only kept when runtimes are cached.
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> xnn_subgraph_{
+      nullptr, &xnn_delete_subgraph};
+  uint32_t runtime_flags_ = 0;
   // Mapping from TFLite Tensor IDs for input/output tensors in the delegated
   // subgraph to their data locations.
   std::unordered_map<int, void*> externals_;
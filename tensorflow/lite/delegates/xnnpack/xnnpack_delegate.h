@@ -74,6 +74,17 @@ typedef struct {
   //
   // WARNING this is an experimental flag.
   const char* experimental_weight_cache_file_path;
+  // Maximum number of XNNPACK runtimes that each delegated partition keeps,
+  // one per set of input shapes, when subgraph reshaping is enabled.
+  // Switching back to input shapes that were seen before reuses the matching
+  // runtime instead of reshaping it. All runtimes share the delegate
+  // workspace. Without a weights cache, each runtime holds its own copy of the
+  // packed weights. 0 or 1 keeps a single runtime that is reshaped for every
+  // new set of input shapes. Partitions with variables always use a single
+  // runtime.
+  //
+  // WARNING this is an experimental flag.
+  int32_t experimental_max_cached_runtimes;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
@@ -26,6 +26,10 @@ extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver) {
                       tflite::ops::custom::Register_KV_CACHE());
   resolver->AddCustom("odml.scaled_dot_product_attention",
                       tflite::ops::custom::Register_SDPA());
+  resolver->AddCustom("odml.layer_norm",
+                      tflite::ops::custom::Register_LAYER_NORM());
+  resolver->AddCustom("odml.rms_norm",
+                      tflite::ops::custom::Register_RMS_NORM());
 }
 
 }  // namespace custom
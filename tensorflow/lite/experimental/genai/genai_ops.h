@@ -16,14 +16,46 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_GENAI_OPS_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_GENAI_OPS_H_
 
+#include <cstdint>
+
+#include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/mutable_op_resolver.h"
 
 namespace tflite {
+
+class Subgraph;
+
 namespace ops {
 namespace custom {
 
 TfLiteRegistration* Register_KV_CACHE();
+// Scaled dot product attention, computed in tiles with an online softmax so
+// that its memory use is linear in the sequence length. With the `is_causal`
+// custom option, each query attends to the keys up to its position in the KV
+// cache, given by a fifth int64 input, and the attention mask input may be
+// omitted.
 TfLiteRegistration* Register_SDPA();
+// Normalize float32 tensors along their innermost dimension, in place of the
+// chain of mean, sub, square, rsqrt, mul and add ops of a decomposed norm.
+// Inputs are (input, scale, offset) for LAYER_NORM and (input, scale) for
+// RMS_NORM, with an optional `epsilon` custom option.
+TfLiteRegistration* Register_LAYER_NORM();
+TfLiteRegistration* Register_RMS_NORM();
+
+// Prefix sharing for KV_CACHE ops in paged mode (`kv_cache_block_size` > 0).
+//
+// Saves the first `num_entries` cache entries of every layer of `subgraph`
+// under `prefix_id`. The cache blocks are shared, not copied, and a block is
+// only copied once a sequence that loaded the prefix writes to it. This lets
+// sequences that start with the same tokens (e.g. a system prompt) skip its
+// prefill and store it once.
+TfLiteStatus SaveKVCachePrefix(Subgraph* subgraph, int prefix_id,
+                               int64_t num_entries);
+// Resets the KV cache of `subgraph` to the prefix saved under `prefix_id`.
+// The next position to write is the one following the last prefix entry.
+TfLiteStatus LoadKVCachePrefix(Subgraph* subgraph, int prefix_id);
+// Releases the prefix saved under `prefix_id`.
+void EraseKVCachePrefix(Subgraph* subgraph, int prefix_id);
 
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver);
 
@@ -14,14 +14,19 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <string>
 
+#include "Eigen/Core"  // from @eigen_archive
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/experimental/resource/cache_buffer.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -43,16 +48,27 @@ static const int kDefaultTransformerLayerId = 0;
 
 static const int KVCACHE_KEY_RESOURCE = 42;
 static const int KVCACHE_VALUE_RESOURCE = 43;
+static const int KVCACHE_PAGED_KEY_RESOURCE = 44;
+static const int KVCACHE_PAGED_VALUE_RESOURCE = 45;
 
 struct OpData {
   int num_layers;
   int layer_index;
   int max_num_entries;
   int first_slot_index;
+  // Number of entries per block in paged mode, 0 for the contiguous cache.
+  int block_size;
+  // Maximum number of blocks in the pool shared by all layers in paged mode.
+  int max_num_blocks;
+  // Storage type of the cache: kTfLiteFloat32, kTfLiteFloat16 or kTfLiteInt8.
+  TfLiteType cache_type;
   // Pointers to the key and value cache buffers that this Op doesn't own
   // (and therefore does not free on destruction of this Op).
   resource::CacheBuffer* key_cache_buffer;
   resource::CacheBuffer* value_cache_buffer;
+  // Same as above, for paged mode.
+  resource::PagedCacheBuffer* key_paged_cache_buffer;
+  resource::PagedCacheBuffer* value_paged_cache_buffer;
   bool is_initialized;
   uint8_t* key_cache_ptr;
   uint8_t* value_cache_ptr;
@@ -66,14 +82,191 @@ void* KVCacheInit(TfLiteContext* context, const char* buffer, size_t length) {
   op_data->num_layers = -1;
   op_data->layer_index = -1;
   op_data->first_slot_index = -1;
+  op_data->block_size = 0;
+  op_data->max_num_blocks = 0;
+  op_data->cache_type = kTfLiteFloat32;
   op_data->key_cache_buffer = nullptr;
   op_data->value_cache_buffer = nullptr;
+  op_data->key_paged_cache_buffer = nullptr;
+  op_data->value_paged_cache_buffer = nullptr;
   op_data->is_initialized = false;
   op_data->key_cache_ptr = nullptr;
   op_data->value_cache_ptr = nullptr;
   return op_data;
 }
 
+size_t CacheElementSize(TfLiteType type) {
+  switch (type) {
+    case kTfLiteFloat16:
+      return sizeof(Eigen::half);
+    case kTfLiteInt8:
+      return sizeof(int8_t);
+    default:
+      return sizeof(float);
+  }
+}
+
+// Gives `tensor` a zero point of 0 and one (yet unset) scale per head, i.e.
+// along dimension 2 of <batch, seq length, num heads, head dim>.
+void SetPerHeadQuantization(TfLiteTensor* tensor, int num_heads) {
+  TfLiteQuantizationFree(&tensor->quantization);
+  auto* params = reinterpret_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  params->scale = TfLiteFloatArrayCreate(num_heads);
+  params->zero_point = TfLiteIntArrayCreate(num_heads);
+  for (int i = 0; i < num_heads; ++i) {
+    params->scale->data[i] = 0.0f;
+    params->zero_point->data[i] = 0;
+  }
+  params->quantized_dimension = 2;
+  tensor->quantization.type = kTfLiteAffineQuantization;
+  tensor->quantization.params = params;
+}
+
+// Stores `num_entries` float entries of <num heads, head dim> into the cache
+// layer at `layer_ptr`, starting at entry `first_slot` and converting them to
+// the cache type.
+//
+// Int8 caches use one symmetric scale per head. When a new entry exceeds the
+// range of its head's scale, the scale grows and the entries already stored
+// for that head are requantized. Ranges settle quickly in practice, so this
+// is rare after the first few tokens.
+void StoreEntries(resource::CacheBuffer* cache, int layer_index,
+                  uint8_t* layer_ptr, const float* src, int64_t first_slot,
+                  int64_t num_entries, int64_t max_num_entries, int num_heads,
+                  int head_dim) {
+  const int elements_in_one_entry = num_heads * head_dim;
+  switch (cache->GetType()) {
+    case kTfLiteFloat16: {
+      Eigen::half* dst = reinterpret_cast<Eigen::half*>(layer_ptr) +
+                         first_slot * elements_in_one_entry;
+      for (int64_t i = 0; i < num_entries * elements_in_one_entry; ++i) {
+        dst[i] = Eigen::half_impl::float_to_half_rtne(src[i]);
+      }
+      return;
+    }
+    case kTfLiteInt8: {
+      int8_t* layer_data = reinterpret_cast<int8_t*>(layer_ptr);
+      float* scales = cache->GetScales(layer_index);
+      for (int h = 0; h < num_heads; ++h) {
+        float max_abs = 0.0f;
+        for (int64_t e = 0; e < num_entries; ++e) {
+          const float* head = src + e * elements_in_one_entry + h * head_dim;
+          for (int d = 0; d < head_dim; ++d) {
+            max_abs = std::max(max_abs, std::abs(head[d]));
+          }
+        }
+        const float old_scale = scales[h];
+        if (max_abs > old_scale * 127.0f) {
+          const float new_scale = max_abs / 127.0f;
+          if (old_scale > 0.0f) {
+            const float ratio = old_scale / new_scale;
+            for (int64_t e = 0; e < max_num_entries; ++e) {
+              int8_t* head =
+                  layer_data + e * elements_in_one_entry + h * head_dim;
+              for (int d = 0; d < head_dim; ++d) {
+                head[d] = static_cast<int8_t>(std::round(head[d] * ratio));
+              }
+            }
+          }
+          scales[h] = new_scale;
+        }
+        const float inverse_scale = scales[h] > 0.0f ? 1.0f / scales[h] : 0.0f;
+        for (int64_t e = 0; e < num_entries; ++e) {
+          const float* head = src + e * elements_in_one_entry + h * head_dim;
+          int8_t* dst = layer_data + (first_slot + e) * elements_in_one_entry +
+                        h * head_dim;
+          for (int d = 0; d < head_dim; ++d) {
+            const float q = std::round(head[d] * inverse_scale);
+            dst[d] = static_cast<int8_t>(std::clamp(q, -127.0f, 127.0f));
+          }
+        }
+      }
+      return;
+    }
+    default:
+      memcpy(layer_ptr + first_slot * elements_in_one_entry * sizeof(float),
+             src, num_entries * elements_in_one_entry * sizeof(float));
+      return;
+  }
+}
+
+// Copies the per-head scales of an int8 cache layer into `tensor`.
+void UpdateQuantizationScales(resource::CacheBuffer* cache, int layer_index,
+                              TfLiteTensor* tensor) {
+  auto* params =
+      reinterpret_cast<TfLiteAffineQuantization*>(tensor->quantization.params);
+  const float* scales = cache->GetScales(layer_index);
+  for (int h = 0; h < params->scale->size; ++h) {
+    params->scale->data[h] = scales[h];
+  }
+}
+
+// Looks up the paged cache buffer `resource_id`, creating it on first use.
+TfLiteStatus GetOrCreatePagedCacheBuffer(TfLiteContext* context,
+                                         const OpData* op_data,
+                                         int entry_size, int resource_id,
+                                         resource::PagedCacheBuffer** buffer) {
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  if (resources.count(resource_id) == 0) {
+    auto* cbuffer = new resource::PagedCacheBuffer();
+    TF_LITE_ENSURE_OK(
+        context, cbuffer->Initialize(op_data->num_layers, op_data->block_size,
+                                     op_data->max_num_blocks, entry_size));
+    resources.emplace(resource_id, cbuffer);
+    *buffer = cbuffer;
+  } else {
+    *buffer = static_cast<resource::PagedCacheBuffer*>(
+        resources.at(resource_id).get());
+  }
+  TF_LITE_ENSURE_EQ(context, (*buffer)->GetEntrySize(), entry_size);
+  TF_LITE_ENSURE_EQ(context, (*buffer)->GetBlockSize(), op_data->block_size);
+  return kTfLiteOk;
+}
+
+// In paged mode the cache entries live in blocks of a pool shared by all
+// layers and are only allocated when written. Each Eval gathers the used
+// entries of the layer into a dense view shared by all layers, and the outputs
+// point to it with the shape <1, num used entries, num heads, head dim>. The
+// view is overwritten by the next layer, which is fine since the keys of the
+// next layer depend on the attention output of this one.
+//
+// The outputs have the shape of the full cache until the first Eval, so that
+// the attention mask is checked against the capacity of the cache.
+TfLiteStatus KVCachePreparePaged(TfLiteContext* context, TfLiteNode* node,
+                                 OpData* op_data, const TfLiteTensor* key,
+                                 TfLiteTensor* kfull, TfLiteTensor* vfull) {
+  const int entry_size = key->dims->data[2] * key->dims->data[3];
+  TF_LITE_ENSURE_OK(context,
+                    GetOrCreatePagedCacheBuffer(
+                        context, op_data, entry_size,
+                        KVCACHE_PAGED_KEY_RESOURCE,
+                        &op_data->key_paged_cache_buffer));
+  TF_LITE_ENSURE_OK(context,
+                    GetOrCreatePagedCacheBuffer(
+                        context, op_data, entry_size,
+                        KVCACHE_PAGED_VALUE_RESOURCE,
+                        &op_data->value_paged_cache_buffer));
+
+  kfull->type = kTfLiteFloat32;
+  vfull->type = kTfLiteFloat32;
+  kfull->allocation_type = kTfLiteCustom;
+  vfull->allocation_type = kTfLiteCustom;
+  kfull->data.data = nullptr;
+  vfull->data.data = nullptr;
+
+  TfLiteIntArray* kcache_dims = TfLiteIntArrayCopy(key->dims);
+  TfLiteIntArray* vcache_dims = TfLiteIntArrayCopy(key->dims);
+  kcache_dims->data[1] = op_data->max_num_entries;
+  vcache_dims->data[1] = op_data->max_num_entries;
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, kfull, kcache_dims));
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, vfull, vcache_dims));
+  return kTfLiteOk;
+}
+
 TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
@@ -88,6 +281,21 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
     int32_t max_num_entries = flexbuffer_map["kv_cache_max"].AsInt32();
     int32_t num_layers = flexbuffer_map["num_layers"].AsInt32();
     int32_t layer_index = flexbuffer_map["layer_index"].AsInt32();
+    int32_t block_size = flexbuffer_map["kv_cache_block_size"].AsInt32();
+    int32_t max_num_blocks = flexbuffer_map["kv_cache_num_blocks"].AsInt32();
+    const std::string cache_dtype =
+        flexbuffer_map["kv_cache_dtype"].AsString().str();
+    if (cache_dtype.empty() || cache_dtype == "float32") {
+      op_data->cache_type = kTfLiteFloat32;
+    } else if (cache_dtype == "float16") {
+      op_data->cache_type = kTfLiteFloat16;
+    } else if (cache_dtype == "int8") {
+      op_data->cache_type = kTfLiteInt8;
+    } else {
+      TF_LITE_KERNEL_LOG(context, "Unsupported kv_cache_dtype: %s",
+                         cache_dtype.c_str());
+      return kTfLiteError;
+    }
     op_data->max_num_entries =
         max_num_entries > 0 ? max_num_entries : kDefaultMaxNumCacheEntries;
     op_data->num_layers =
@@ -95,6 +303,17 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
     op_data->layer_index =
         layer_index > 0 ? layer_index : kDefaultTransformerLayerId;
     op_data->first_slot_index = 0;
+    op_data->block_size = block_size > 0 ? block_size : 0;
+    if (op_data->block_size > 0) {
+      // By default the pool can hold the full cache of every layer, which is
+      // never more than the contiguous cache would use.
+      const int blocks_per_layer =
+          (op_data->max_num_entries + op_data->block_size - 1) /
+          op_data->block_size;
+      op_data->max_num_blocks = max_num_blocks > 0
+                                    ? max_num_blocks
+                                    : blocks_per_layer * op_data->num_layers;
+    }
     op_data->is_initialized = true;
   }
 
@@ -127,12 +346,27 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
                     GetOutputSafe(context, node, kFullKeyTensor, &kfull));
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kFullValueTensor, &vfull));
+  if (op_data->block_size > 0) {
+    if (op_data->cache_type != kTfLiteFloat32) {
+      TF_LITE_KERNEL_LOG(context,
+                         "kv_cache_dtype is only supported without paging");
+      return kTfLiteError;
+    }
+    return KVCachePreparePaged(context, node, op_data, key, kfull, vfull);
+  }
+
   // Custom data pointer to the resource cache buffer.
   kfull->allocation_type = kTfLiteCustom;
   vfull->allocation_type = kTfLiteCustom;
 
-  kfull->type = kTfLiteFloat32;
-  vfull->type = kTfLiteFloat32;
+  kfull->type = op_data->cache_type;
+  vfull->type = op_data->cache_type;
+  if (op_data->cache_type == kTfLiteInt8) {
+    // One scale per head; the values are refreshed from the cache buffer on
+    // each Eval.
+    SetPerHeadQuantization(kfull, key->dims->data[2]);
+    SetPerHeadQuantization(vfull, key->dims->data[2]);
+  }
 
   TfLiteIntArray* input_dims = key->dims;
   TfLiteIntArray* kcache_dims = TfLiteIntArrayCopy(input_dims);
@@ -160,7 +394,7 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
 
   if (resources.count(KVCACHE_KEY_RESOURCE) == 0) {
     auto* cbuffer = new resource::CacheBuffer();
-    cbuffer->Initialize(*kcache_buffer_dims);
+    cbuffer->Initialize(*kcache_buffer_dims, op_data->cache_type);
     resources.emplace(KVCACHE_KEY_RESOURCE, cbuffer);
     op_data->key_cache_buffer = cbuffer;
   } else {
@@ -171,7 +405,7 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   }
   if (resources.count(KVCACHE_VALUE_RESOURCE) == 0) {
     auto* cbuffer = new resource::CacheBuffer();
-    cbuffer->Initialize(*vcache_buffer_dims);
+    cbuffer->Initialize(*vcache_buffer_dims, op_data->cache_type);
     resources.emplace(KVCACHE_VALUE_RESOURCE, cbuffer);
     op_data->value_cache_buffer = cbuffer;
   } else {
@@ -180,18 +414,23 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
     resource::CacheBuffer* cbuffer = (resource::CacheBuffer*)(resourcePtr);
     op_data->value_cache_buffer = cbuffer;
   }
+  TF_LITE_ENSURE_EQ(context, op_data->key_cache_buffer->GetType(),
+                    op_data->cache_type);
+  TF_LITE_ENSURE_EQ(context, op_data->value_cache_buffer->GetType(),
+                    op_data->cache_type);
 
   // Get the pointers to the individual caches for a layer.
   RuntimeShape shape(GetTensorShape(key));
   const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
   const int elements_in_one_block =
       op_data->max_num_entries * elements_in_one_entry;
+  const size_t element_size = CacheElementSize(op_data->cache_type);
   uint8_t* k_ptr =
-      reinterpret_cast<uint8_t*>(op_data->key_cache_buffer->GetBuffer());
+      reinterpret_cast<uint8_t*>(op_data->key_cache_buffer->GetRawBuffer());
   uint8_t* v_ptr =
-      reinterpret_cast<uint8_t*>(op_data->value_cache_buffer->GetBuffer());
-  k_ptr = k_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
-  v_ptr = v_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
+      reinterpret_cast<uint8_t*>(op_data->value_cache_buffer->GetRawBuffer());
+  k_ptr = k_ptr + element_size * op_data->layer_index * elements_in_one_block;
+  v_ptr = v_ptr + element_size * op_data->layer_index * elements_in_one_block;
 
   size_t kcache_dims_flatsize = kcache_dims->data[0] * kcache_dims->data[1] *
                                 kcache_dims->data[2] * kcache_dims->data[3];
@@ -226,6 +465,86 @@ void KVCacheFree(TfLiteContext* context, void* buffer) {
   delete static_cast<OpData*>(buffer);
 }
 
+TfLiteStatus KVCacheEvalPaged(TfLiteContext* context, TfLiteNode* node,
+                              OpData* op_data, const TfLiteTensor* position,
+                              const TfLiteTensor* key,
+                              const TfLiteTensor* value, TfLiteTensor* kfull,
+                              TfLiteTensor* vfull) {
+  resource::PagedCacheBuffer* kcache = op_data->key_paged_cache_buffer;
+  resource::PagedCacheBuffer* vcache = op_data->value_paged_cache_buffer;
+  const int layer_index = op_data->layer_index;
+  const int64_t max_num_entries = op_data->max_num_entries;
+
+  RuntimeShape shape(GetTensorShape(key));
+  const int64_t num_slots_needed = shape.Dims(1);
+  const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
+  const int64_t num_bytes_per_tensor = sizeof(float) * elements_in_one_entry;
+
+  // The window start lives in the cache buffer rather than in `op_data` so that
+  // it follows the layer state when a saved prefix is loaded.
+  const int64_t first_slot_index = kcache->GetFirstPosition(layer_index);
+  const int64_t input_first_idx = position->data.i64[0];
+  const int64_t input_last_idx = input_first_idx + num_slots_needed - 1;
+  const int64_t cache_last_slot_idx = first_slot_index + max_num_entries - 1;
+  const int64_t slots_to_shift = std::min(
+      std::max(static_cast<int64_t>(0), input_last_idx - cache_last_slot_idx),
+      max_num_entries);
+
+  if (input_first_idx < first_slot_index) {
+    TF_LITE_KERNEL_LOG(
+        context,
+        "Can not specify a position before this cache's first slot index of %d",
+        static_cast<int>(first_slot_index));
+    return kTfLiteError;
+  }
+
+  // Sliding the window only drops blocks from the front of the block table,
+  // no entry is moved.
+  if (slots_to_shift > 0) {
+    kcache->DropFrontEntries(layer_index, slots_to_shift);
+    vcache->DropFrontEntries(layer_index, slots_to_shift);
+  }
+
+  const int64_t first_slot =
+      input_first_idx - kcache->GetFirstPosition(layer_index);
+  const float* key_data = GetTensorData<float>(key);
+  const float* value_data = GetTensorData<float>(value);
+  for (int64_t i = 0; i < num_slots_needed; ++i) {
+    float* k_entry = kcache->GetOrAllocateEntry(layer_index, first_slot + i);
+    float* v_entry = vcache->GetOrAllocateEntry(layer_index, first_slot + i);
+    if (k_entry == nullptr || v_entry == nullptr) {
+      TF_LITE_KERNEL_LOG(context, "KV cache block pool of %d blocks exhausted",
+                         op_data->max_num_blocks);
+      return kTfLiteError;
+    }
+    memcpy(k_entry, key_data + i * elements_in_one_entry,
+           num_bytes_per_tensor);
+    memcpy(v_entry, value_data + i * elements_in_one_entry,
+           num_bytes_per_tensor);
+  }
+
+  const int64_t current_num_entries =
+      std::min(first_slot + num_slots_needed, max_num_entries);
+  kcache->SetNumEntries(layer_index, current_num_entries);
+  vcache->SetNumEntries(layer_index, current_num_entries);
+
+  // Only the used entries are gathered, so the outputs never take more memory
+  // than the cache itself.
+  TfLiteIntArray* kview_dims = TfLiteIntArrayCopy(key->dims);
+  TfLiteIntArray* vview_dims = TfLiteIntArrayCopy(key->dims);
+  kview_dims->data[1] = current_num_entries;
+  vview_dims->data[1] = current_num_entries;
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, kfull, kview_dims));
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, vfull, vview_dims));
+  kfull->data.data = const_cast<float*>(
+      kcache->GatherView(layer_index, current_num_entries));
+  vfull->data.data = const_cast<float*>(
+      vcache->GatherView(layer_index, current_num_entries));
+  return kTfLiteOk;
+}
+
 TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* position;
   TF_LITE_ENSURE_OK(context,
@@ -243,9 +562,13 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kFullValueTensor, &vfull));
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  if (op_data->block_size > 0) {
+    return KVCacheEvalPaged(context, node, op_data, position, key, value, kfull,
+                            vfull);
+  }
 
-  float* key_cache_ptr = op_data->key_cache_buffer->GetBuffer();
-  float* value_cache_ptr = op_data->value_cache_buffer->GetBuffer();
+  void* key_cache_ptr = op_data->key_cache_buffer->GetRawBuffer();
+  void* value_cache_ptr = op_data->value_cache_buffer->GetRawBuffer();
   const int layer_index = op_data->layer_index;
   const int64_t max_num_entries = op_data->max_num_entries;
   int current_num_entries =
@@ -257,13 +580,14 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
   const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
   const int elements_in_one_block =
       op_data->max_num_entries * elements_in_one_entry;
-  const int64_t num_bytes_per_tensor = sizeof(float) * elements_in_one_entry;
+  const size_t element_size = CacheElementSize(op_data->cache_type);
+  const int64_t num_bytes_per_tensor = element_size * elements_in_one_entry;
 
   // Get the pointers to the individual caches for a layer.
   uint8_t* k_ptr = reinterpret_cast<uint8_t*>(key_cache_ptr);
   uint8_t* v_ptr = reinterpret_cast<uint8_t*>(value_cache_ptr);
-  k_ptr = k_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
-  v_ptr = v_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
+  k_ptr = k_ptr + element_size * op_data->layer_index * elements_in_one_block;
+  v_ptr = v_ptr + element_size * op_data->layer_index * elements_in_one_block;
 
   // 0. Ensure output ptr is pointing to the cache data
   TF_LITE_ENSURE_EQ(context, k_ptr, op_data->key_cache_ptr);
@@ -313,8 +637,8 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
     // And we need to write the entire cache.
     num_slots_for_output = max_num_entries;
     const int bytes_offset =
-        sizeof(float) * elements_in_one_entry * slots_to_shift;
-    const int size_bytes_to_shift = sizeof(float) * elements_in_one_entry *
+        element_size * elements_in_one_entry * slots_to_shift;
+    const int size_bytes_to_shift = element_size * elements_in_one_entry *
                                     (max_num_entries - slots_to_shift);
     // TODO(b/333893996): This is O(cache_size) data motion. Consider optimizing
     // with a circular buffer or similar.
@@ -327,11 +651,18 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
 
   // Recompute the first slot in case any shifting occurred.
   first_slot = input_first_idx - op_data->first_slot_index;
-  const int64_t bytes_offset_for_cache = first_slot * num_bytes_per_tensor;
 
   // 4. Put the key and value in their respective caches.
-  memcpy(k_ptr + bytes_offset_for_cache, key->data.data, key->bytes);
-  memcpy(v_ptr + bytes_offset_for_cache, value->data.data, value->bytes);
+  StoreEntries(op_data->key_cache_buffer, layer_index, k_ptr,
+               GetTensorData<float>(key), first_slot, num_slots_needed,
+               max_num_entries, shape.Dims(2), shape.Dims(3));
+  StoreEntries(op_data->value_cache_buffer, layer_index, v_ptr,
+               GetTensorData<float>(value), first_slot, num_slots_needed,
+               max_num_entries, shape.Dims(2), shape.Dims(3));
+  if (op_data->cache_type == kTfLiteInt8) {
+    UpdateQuantizationScales(op_data->key_cache_buffer, layer_index, kfull);
+    UpdateQuantizationScales(op_data->value_cache_buffer, layer_index, vfull);
+  }
 
   // Update counts.
   current_num_entries =
@@ -342,8 +673,57 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+namespace {
+
+TfLiteStatus GetPagedCacheBuffers(Subgraph* subgraph,
+                                  resource::PagedCacheBuffer** kcache,
+                                  resource::PagedCacheBuffer** vcache) {
+  auto& resources = subgraph->resources();
+  if (resources.count(KVCACHE_PAGED_KEY_RESOURCE) == 0 ||
+      resources.count(KVCACHE_PAGED_VALUE_RESOURCE) == 0) {
+    return kTfLiteError;
+  }
+  *kcache = static_cast<resource::PagedCacheBuffer*>(
+      resources.at(KVCACHE_PAGED_KEY_RESOURCE).get());
+  *vcache = static_cast<resource::PagedCacheBuffer*>(
+      resources.at(KVCACHE_PAGED_VALUE_RESOURCE).get());
+  return kTfLiteOk;
+}
+
+}  // namespace
+
 }  // namespace llm
 
+TfLiteStatus SaveKVCachePrefix(Subgraph* subgraph, int prefix_id,
+                               int64_t num_entries) {
+  resource::PagedCacheBuffer* kcache;
+  resource::PagedCacheBuffer* vcache;
+  TF_LITE_ENSURE_STATUS(llm::GetPagedCacheBuffers(subgraph, &kcache, &vcache));
+  TF_LITE_ENSURE_STATUS(kcache->SavePrefix(prefix_id, num_entries));
+  return vcache->SavePrefix(prefix_id, num_entries);
+}
+
+TfLiteStatus LoadKVCachePrefix(Subgraph* subgraph, int prefix_id) {
+  resource::PagedCacheBuffer* kcache;
+  resource::PagedCacheBuffer* vcache;
+  TF_LITE_ENSURE_STATUS(llm::GetPagedCacheBuffers(subgraph, &kcache, &vcache));
+  if (!kcache->HasPrefix(prefix_id) || !vcache->HasPrefix(prefix_id)) {
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(kcache->LoadPrefix(prefix_id));
+  return vcache->LoadPrefix(prefix_id);
+}
+
+void EraseKVCachePrefix(Subgraph* subgraph, int prefix_id) {
+  resource::PagedCacheBuffer* kcache;
+  resource::PagedCacheBuffer* vcache;
+  if (llm::GetPagedCacheBuffers(subgraph, &kcache, &vcache) != kTfLiteOk) {
+    return;
+  }
+  kcache->ErasePrefix(prefix_id);
+  vcache->ErasePrefix(prefix_id);
+}
+
 TfLiteRegistration* Register_KV_CACHE() {
   static TfLiteRegistration r = {llm::KVCacheInit, llm::KVCacheFree,
                                  llm::KVCachePrepare, llm::KVCacheEval};
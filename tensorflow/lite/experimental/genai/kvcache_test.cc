@@ -13,10 +13,16 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include <vector>
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "Eigen/Core"  // from @eigen_archive
+#include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/experimental/genai/genai_ops.h"
 #include "tensorflow/lite/kernels/test_util.h"
@@ -25,18 +31,32 @@ limitations under the License.
 namespace tflite {
 namespace {
 
+using ::testing::ElementsAreArray;
+
 static const int kDefaultMaxNumCacheEntries = 2048;
 
 class SimpleCacheOpModel : public SingleOpModel {
  public:
   SimpleCacheOpModel(const TensorData& pos_tensor, const TensorData& k_tensor,
-                     const TensorData& v_tensor) {
+                     const TensorData& v_tensor, int block_size = 0,
+                     int num_blocks = 0, const std::string& cache_dtype = "") {
     pos_ = AddInput(pos_tensor);
     k_ = AddInput(k_tensor);
     v_ = AddInput(v_tensor);
     kfull_ = AddOutput(k_tensor.type);
     vfull_ = AddOutput(v_tensor.type);
-    SetCustomOp("KV_Cache", {}, ops::custom::Register_KV_CACHE);
+    if (block_size > 0 || !cache_dtype.empty()) {
+      flexbuffers::Builder fbb;
+      fbb.Map([&]() {
+        fbb.Int("kv_cache_block_size", block_size);
+        fbb.Int("kv_cache_num_blocks", num_blocks);
+        fbb.String("kv_cache_dtype", cache_dtype);
+      });
+      fbb.Finish();
+      SetCustomOp("KV_Cache", fbb.GetBuffer(), ops::custom::Register_KV_CACHE);
+    } else {
+      SetCustomOp("KV_Cache", {}, ops::custom::Register_KV_CACHE);
+    }
 
     BuildInterpreter({GetShape(pos_), GetShape(k_), GetShape(v_)});
   }
@@ -69,6 +89,38 @@ class SimpleCacheOpModel : public SingleOpModel {
 
   TfLiteStatus ReAllocate() { return interpreter_->AllocateTensors(); }
 
+  Subgraph* GetSubgraph() { return interpreter_->subgraph(0); }
+
+  // Returns the number of bytes held by the cache buffers.
+  size_t GetCacheMemoryUsage() {
+    size_t bytes = 0;
+    for (auto& resource : GetSubgraph()->resources()) {
+      bytes += resource.second->GetMemoryUsage();
+    }
+    return bytes;
+  }
+
+  // Returns the first `num_entries` entries of the key cache as floats.
+  std::vector<float> GetDequantizedK(int num_entries) {
+    const TfLiteTensor* k = interpreter_->tensor(kfull_);
+    const int entry_size = k->dims->data[2] * k->dims->data[3];
+    std::vector<float> result(num_entries * entry_size);
+    for (int i = 0; i < result.size(); ++i) {
+      if (k->type == kTfLiteFloat16) {
+        result[i] = Eigen::half_impl::half_to_float(
+            reinterpret_cast<const Eigen::half*>(k->data.raw)[i]);
+      } else if (k->type == kTfLiteInt8) {
+        const auto* params = reinterpret_cast<const TfLiteAffineQuantization*>(
+            k->quantization.params);
+        const int head = (i % entry_size) / k->dims->data[3];
+        result[i] = k->data.int8[i] * params->scale->data[head];
+      } else {
+        result[i] = k->data.f[i];
+      }
+    }
+    return result;
+  }
+
  protected:
   int pos_;
   int k_;
@@ -237,5 +289,200 @@ TEST(SimpleCacheOp2Test, ShiftSlotsInCache) {
   ASSERT_EQ(m.Invoke(), kTfLiteError);
 }
 
+TEST(PagedCacheOpTest, MatchesContiguousCache) {
+  SimpleCacheOpModel contiguous({TensorType_INT64, {2}},
+                                {TensorType_FLOAT32, {1, 2, 2, 3}},
+                                {TensorType_FLOAT32, {1, 2, 2, 3}});
+  SimpleCacheOpModel paged({TensorType_INT64, {2}},
+                           {TensorType_FLOAT32, {1, 2, 2, 3}},
+                           {TensorType_FLOAT32, {1, 2, 2, 3}},
+                           /*block_size=*/16);
+
+  // Fill past the end of the cache so that the window slides.
+  for (int i = 0; i < 1030; ++i) {
+    const float k = i + 1;
+    const float v = -(i + 1);
+    const std::vector<float> key = {k, k, k, k, k, k, k, k, k, k, k, k};
+    const std::vector<float> value = {v, v, v, v, v, v, v, v, v, v, v, v};
+    for (SimpleCacheOpModel* m : {&contiguous, &paged}) {
+      m->SetPosition({2 * i, 2 * i + 1});
+      m->SetKey(key);
+      m->SetValue(value);
+      ASSERT_EQ(m->Invoke(), kTfLiteOk);
+    }
+    if (i % 100 == 0 || i >= 1020) {
+      // The paged outputs only hold the used entries.
+      const int num_used_floats =
+          std::min(2 * (i + 1), kDefaultMaxNumCacheEntries) * 2 * 3;
+      const std::vector<float> fullk = contiguous.GetFullK();
+      const std::vector<float> fullv = contiguous.GetFullV();
+      ASSERT_EQ(paged.GetFullK(),
+                std::vector<float>(fullk.begin(),
+                                   fullk.begin() + num_used_floats));
+      ASSERT_EQ(paged.GetFullV(),
+                std::vector<float>(fullv.begin(),
+                                   fullv.begin() + num_used_floats));
+    }
+  }
+}
+
+TEST(PagedCacheOpTest, OutputsHoldOnlyUsedEntries) {
+  SimpleCacheOpModel m({TensorType_INT64, {2}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       /*block_size=*/4);
+  m.SetPosition({0, 1});
+  std::vector<float> key = {1, 5, -6, 2, 4, 3, 8, 9, -8, 7, 2, 11};
+  m.SetKey(key);
+  std::vector<float> value = {2, 3, -4, 5, 6, 7, 1, 8, -12, 11, 14, 21};
+  m.SetValue(value);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(m.GetFullK(), key);
+  EXPECT_EQ(m.GetFullV(), value);
+
+  m.SetPosition({2, 3});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  std::vector<float> fullk = m.GetFullK();
+  ASSERT_EQ(fullk.size(), 2 * key.size());
+  for (int i = 0; i < key.size(); ++i) {
+    ASSERT_EQ(fullk[i], key[i]);
+    ASSERT_EQ(fullk[key.size() + i], key[i]);
+  }
+}
+
+TEST(PagedCacheOpTest, MemoryUsageScalesWithUsedEntries) {
+  SimpleCacheOpModel m({TensorType_INT64, {2}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       /*block_size=*/4);
+  const std::vector<float> key = {1, 5, -6, 2, 4, 3, 8, 9, -8, 7, 2, 11};
+  m.SetKey(key);
+  m.SetValue(key);
+  const size_t entry_bytes = 2 * 3 * sizeof(float);
+  // Blocks of 4 entries for the keys and the values, plus views that hold
+  // between one and two times the used entries.
+  auto expect_memory_for = [&](int num_entries) {
+    const int num_block_entries = (num_entries + 3) / 4 * 4;
+    EXPECT_GE(m.GetCacheMemoryUsage(),
+              2 * (num_block_entries + num_entries) * entry_bytes);
+    EXPECT_LE(m.GetCacheMemoryUsage(),
+              2 * (num_block_entries + 2 * num_entries) * entry_bytes);
+  };
+  for (int i = 0; i < 32; ++i) {
+    m.SetPosition({2 * i, 2 * i + 1});
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    expect_memory_for(2 * (i + 1));
+  }
+  // Far below the <max entries> dense cache of the contiguous mode.
+  EXPECT_LT(m.GetCacheMemoryUsage(),
+            kDefaultMaxNumCacheEntries * entry_bytes / 4);
+
+  // Going back to a short prefix frees the blocks past it.
+  ASSERT_EQ(ops::custom::SaveKVCachePrefix(m.GetSubgraph(), /*prefix_id=*/1,
+                                           /*num_entries=*/0),
+            kTfLiteOk);
+  ASSERT_EQ(ops::custom::LoadKVCachePrefix(m.GetSubgraph(), 1), kTfLiteOk);
+  m.SetPosition({0, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  expect_memory_for(2);
+}
+
+TEST(PagedCacheOpTest, FailsWhenPoolIsExhausted) {
+  SimpleCacheOpModel m({TensorType_INT64, {2}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       /*block_size=*/2, /*num_blocks=*/2);
+  m.SetKey({1, 5, -6, 2, 4, 3, 8, 9, -8, 7, 2, 11});
+  m.SetValue({2, 3, -4, 5, 6, 7, 1, 8, -12, 11, 14, 21});
+  m.SetPosition({0, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  m.SetPosition({2, 3});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  m.SetPosition({4, 5});
+  ASSERT_EQ(m.Invoke(), kTfLiteError);
+}
+
+TEST(PagedCacheOpTest, LoadPrefix) {
+  SimpleCacheOpModel m({TensorType_INT64, {2}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       /*block_size=*/4);
+  const std::vector<float> prefix = {1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2};
+  m.SetKey(prefix);
+  m.SetValue(prefix);
+  m.SetPosition({0, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  m.SetPosition({2, 3});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  ASSERT_EQ(ops::custom::SaveKVCachePrefix(m.GetSubgraph(), /*prefix_id=*/1,
+                                           /*num_entries=*/3),
+            kTfLiteOk);
+  const std::vector<float> after_prefix = m.GetFullK();
+
+  // Diverge from the prefix, then go back to it and write a different suffix.
+  const std::vector<float> other = {5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6};
+  m.SetKey(other);
+  m.SetValue(other);
+  m.SetPosition({3, 4});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  ASSERT_EQ(ops::custom::LoadKVCachePrefix(m.GetSubgraph(), 1), kTfLiteOk);
+  const std::vector<float> suffix = {7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8};
+  m.SetKey(suffix);
+  m.SetValue(suffix);
+  m.SetPosition({3, 4});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  const std::vector<float> fullk = m.GetFullK();
+  const int entry_size = 2 * 3;
+  for (int i = 0; i < 3 * entry_size; ++i) {
+    ASSERT_EQ(fullk[i], after_prefix[i]);
+  }
+  for (int i = 0; i < 2 * entry_size; ++i) {
+    ASSERT_EQ(fullk[3 * entry_size + i], suffix[i]);
+  }
+
+  ops::custom::EraseKVCachePrefix(m.GetSubgraph(), 1);
+  EXPECT_EQ(ops::custom::LoadKVCachePrefix(m.GetSubgraph(), 1), kTfLiteError);
+}
+
+TEST(QuantizedCacheOpTest, Float16) {
+  SimpleCacheOpModel m({TensorType_INT64, {2}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       /*block_size=*/0, /*num_blocks=*/0, "float16");
+  const std::vector<float> key = {1, 5, -6, 2, 4, 3, 8, 9, -8, 7, 2, 11};
+  m.SetKey(key);
+  m.SetValue(key);
+  m.SetPosition({0, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(m.GetDequantizedK(2), key);
+}
+
+TEST(QuantizedCacheOpTest, Int8RescalesHeads) {
+  SimpleCacheOpModel m({TensorType_INT64, {2}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       {TensorType_FLOAT32, {1, 2, 2, 3}},
+                       /*block_size=*/0, /*num_blocks=*/0, "int8");
+  const std::vector<float> key = {1, 0.5, -1, 2, 4, 3, 0.25, 1, -0.5, 7, 2, 1};
+  m.SetKey(key);
+  m.SetValue(key);
+  m.SetPosition({0, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetDequantizedK(2),
+              ElementsAreArray(ArrayFloatNear(key, 7.0f / 127)));
+
+  // A larger value in the first head grows its scale, and the entries already
+  // stored are requantized to it.
+  const std::vector<float> key2 = {10, 0, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1};
+  m.SetKey(key2);
+  m.SetValue(key2);
+  m.SetPosition({2, 3});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  std::vector<float> expected = key;
+  expected.insert(expected.end(), key2.begin(), key2.end());
+  EXPECT_THAT(m.GetDequantizedK(4),
+              ElementsAreArray(ArrayFloatNear(expected, 2 * 10.0f / 127)));
+}
+
 }  // namespace
 }  // namespace tflite
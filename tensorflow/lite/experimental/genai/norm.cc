@@ -0,0 +1,216 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+static const int kInputTensor = 0;
+static const int kScaleTensor = 1;
+static const int kOffsetTensor = 2;
+static const int kOutputTensor = 0;
+
+// Number of independent accumulators, so that the statistics of a row are
+// computed in vector lanes rather than with a serial dependency.
+static const int kNumLanes = 8;
+
+enum class NormType { kLayerNorm, kRmsNorm };
+
+struct OpData {
+  float epsilon;
+};
+
+template <NormType kType>
+void* NormInit(TfLiteContext* context, const char* buffer, size_t length) {
+  OpData* op_data = new OpData();
+  op_data->epsilon = kType == NormType::kLayerNorm ? 1e-5f : 1e-6f;
+  if (buffer != nullptr && length > 0) {
+    auto flexbuffer_map =
+        flexbuffers::GetRoot(reinterpret_cast<const uint8_t*>(buffer), length)
+            .AsMap();
+    const auto epsilon = flexbuffer_map["epsilon"];
+    if (!epsilon.IsNull()) op_data->epsilon = epsilon.AsFloat();
+  }
+  return op_data;
+}
+
+void NormFree(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+template <NormType kType>
+TfLiteStatus NormPrepare(TfLiteContext* context, TfLiteNode* node) {
+  const int num_inputs = kType == NormType::kLayerNorm ? 3 : 2;
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), num_inputs);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, NumDimensions(input) >= 1);
+  const int depth = SizeOfDimension(input, NumDimensions(input) - 1);
+  // The scale and offset apply along the normalized, innermost, dimension.
+  for (int i = kScaleTensor; i < num_inputs; ++i) {
+    const TfLiteTensor* param;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, i, &param));
+    TF_LITE_ENSURE_TYPES_EQ(context, param->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, NumElements(param), depth);
+  }
+
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(input->dims));
+}
+
+// Computes the mean and variance of `row` in a single pass with Welford's
+// algorithm. Each lane keeps the statistics of every kNumLanes-th element, so
+// all the lanes have the same count and share the reciprocal, and the lanes
+// are merged at the end with Chan's formula.
+void RowMeanAndVariance(const float* row, int depth, float* mean,
+                        float* variance) {
+  float lane_mean[kNumLanes] = {};
+  float lane_m2[kNumLanes] = {};
+  const int num_blocks = depth / kNumLanes;
+  for (int b = 0; b < num_blocks; ++b) {
+    const float* x = row + b * kNumLanes;
+    const float inv_count = 1.0f / (b + 1);
+    for (int l = 0; l < kNumLanes; ++l) {
+      const float delta = x[l] - lane_mean[l];
+      lane_mean[l] += delta * inv_count;
+      lane_m2[l] += delta * (x[l] - lane_mean[l]);
+    }
+  }
+  float count = 0.0f;
+  float row_mean = 0.0f;
+  float row_m2 = 0.0f;
+  if (num_blocks > 0) {
+    const float lane_count = num_blocks;
+    for (int l = 0; l < kNumLanes; ++l) {
+      const float new_count = count + lane_count;
+      const float delta = lane_mean[l] - row_mean;
+      row_mean += delta * lane_count / new_count;
+      row_m2 += lane_m2[l] + delta * delta * count * lane_count / new_count;
+      count = new_count;
+    }
+  }
+  for (int i = num_blocks * kNumLanes; i < depth; ++i) {
+    count += 1.0f;
+    const float delta = row[i] - row_mean;
+    row_mean += delta / count;
+    row_m2 += delta * (row[i] - row_mean);
+  }
+  *mean = row_mean;
+  *variance = row_m2 / depth;
+}
+
+float RowMeanSquare(const float* row, int depth) {
+  float lane_sum[kNumLanes] = {};
+  const int num_blocks = depth / kNumLanes;
+  for (int b = 0; b < num_blocks; ++b) {
+    const float* x = row + b * kNumLanes;
+    for (int l = 0; l < kNumLanes; ++l) {
+      lane_sum[l] += x[l] * x[l];
+    }
+  }
+  float sum = 0.0f;
+  for (int l = 0; l < kNumLanes; ++l) sum += lane_sum[l];
+  for (int i = num_blocks * kNumLanes; i < depth; ++i) sum += row[i] * row[i];
+  return sum / depth;
+}
+
+template <NormType kType>
+TfLiteStatus NormEval(TfLiteContext* context, TfLiteNode* node) {
+  const OpData* op_data = reinterpret_cast<const OpData*>(node->user_data);
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  const TfLiteTensor* scale;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kScaleTensor, &scale));
+  const float* offset_data = nullptr;
+  if (kType == NormType::kLayerNorm) {
+    const TfLiteTensor* offset;
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kOffsetTensor, &offset));
+    offset_data = GetTensorData<float>(offset);
+  }
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  const int depth = SizeOfDimension(input, NumDimensions(input) - 1);
+  if (depth == 0) return kTfLiteOk;
+  const int num_rows = NumElements(input) / depth;
+  const float* input_data = GetTensorData<float>(input);
+  const float* scale_data = GetTensorData<float>(scale);
+  float* output_data = GetTensorData<float>(output);
+
+  // Every row is read twice, once for its statistics and once to normalize
+  // it, instead of once per op of the decomposed norm. The second read
+  // usually hits the cache.
+  for (int r = 0; r < num_rows; ++r) {
+    const float* in = input_data + r * depth;
+    float* out = output_data + r * depth;
+    if (kType == NormType::kLayerNorm) {
+      float mean, variance;
+      RowMeanAndVariance(in, depth, &mean, &variance);
+      const float inv_stddev = 1.0f / std::sqrt(variance + op_data->epsilon);
+      for (int i = 0; i < depth; ++i) {
+        out[i] = (in[i] - mean) * inv_stddev * scale_data[i] + offset_data[i];
+      }
+    } else {
+      const float inv_rms =
+          1.0f / std::sqrt(RowMeanSquare(in, depth) + op_data->epsilon);
+      for (int i = 0; i < depth; ++i) {
+        out[i] = in[i] * inv_rms * scale_data[i];
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+TfLiteRegistration* Register_LAYER_NORM() {
+  static TfLiteRegistration r = {
+      llm::NormInit<llm::NormType::kLayerNorm>, llm::NormFree,
+      llm::NormPrepare<llm::NormType::kLayerNorm>,
+      llm::NormEval<llm::NormType::kLayerNorm>};
+  return &r;
+}
+
+TfLiteRegistration* Register_RMS_NORM() {
+  static TfLiteRegistration r = {llm::NormInit<llm::NormType::kRmsNorm>,
+                                 llm::NormFree,
+                                 llm::NormPrepare<llm::NormType::kRmsNorm>,
+                                 llm::NormEval<llm::NormType::kRmsNorm>};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
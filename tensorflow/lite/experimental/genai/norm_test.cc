@@ -0,0 +1,149 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class NormOpModel : public SingleOpModel {
+ public:
+  NormOpModel(bool rms_norm, const std::vector<int>& shape, float epsilon) {
+    input_ = AddInput({TensorType_FLOAT32, shape});
+    const int depth = shape.back();
+    scale_ = AddInput({TensorType_FLOAT32, {depth}});
+    if (!rms_norm) offset_ = AddInput({TensorType_FLOAT32, {depth}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("epsilon", epsilon); });
+    fbb.Finish();
+    if (rms_norm) {
+      SetCustomOp("odml.rms_norm", fbb.GetBuffer(),
+                  ops::custom::Register_RMS_NORM);
+      BuildInterpreter({shape, {depth}});
+    } else {
+      SetCustomOp("odml.layer_norm", fbb.GetBuffer(),
+                  ops::custom::Register_LAYER_NORM);
+      BuildInterpreter({shape, {depth}, {depth}});
+    }
+  }
+
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
+  void SetScale(const std::vector<float>& data) {
+    PopulateTensor(scale_, data);
+  }
+  void SetOffset(const std::vector<float>& data) {
+    PopulateTensor(offset_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int scale_;
+  int offset_;
+  int output_;
+};
+
+// Rows longer than the accumulator lanes, with a tail, and large values
+// that lose precision in a naive sum of squares.
+std::vector<float> MakeInput(int num_rows, int depth) {
+  std::vector<float> input(num_rows * depth);
+  for (int i = 0; i < input.size(); ++i) {
+    input[i] = 1000.0f + (i % depth) * 0.5f - (i / depth) * 3.0f +
+               ((i * 7) % 5) * 0.25f;
+  }
+  return input;
+}
+
+TEST(NormOpTest, LayerNorm) {
+  constexpr int kNumRows = 3;
+  constexpr int kDepth = 19;
+  constexpr float kEpsilon = 1e-5f;
+  NormOpModel m(/*rms_norm=*/false, {1, kNumRows, kDepth}, kEpsilon);
+  const std::vector<float> input = MakeInput(kNumRows, kDepth);
+  std::vector<float> scale(kDepth);
+  std::vector<float> offset(kDepth);
+  for (int i = 0; i < kDepth; ++i) {
+    scale[i] = 0.5f + i * 0.1f;
+    offset[i] = i * -0.2f;
+  }
+  m.SetInput(input);
+  m.SetScale(scale);
+  m.SetOffset(offset);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected(input.size());
+  for (int r = 0; r < kNumRows; ++r) {
+    const float* row = input.data() + r * kDepth;
+    double mean = 0.0;
+    for (int i = 0; i < kDepth; ++i) mean += row[i];
+    mean /= kDepth;
+    double variance = 0.0;
+    for (int i = 0; i < kDepth; ++i) {
+      variance += (row[i] - mean) * (row[i] - mean);
+    }
+    variance /= kDepth;
+    for (int i = 0; i < kDepth; ++i) {
+      expected[r * kDepth + i] =
+          (row[i] - mean) / std::sqrt(variance + kEpsilon) * scale[i] +
+          offset[i];
+    }
+  }
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, kNumRows, kDepth}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected, 1e-4)));
+}
+
+TEST(NormOpTest, RmsNorm) {
+  constexpr int kNumRows = 2;
+  constexpr int kDepth = 13;
+  constexpr float kEpsilon = 1e-6f;
+  NormOpModel m(/*rms_norm=*/true, {kNumRows, kDepth}, kEpsilon);
+  std::vector<float> input(kNumRows * kDepth);
+  for (int i = 0; i < input.size(); ++i) input[i] = (i % 7) - 3.0f;
+  std::vector<float> scale(kDepth);
+  for (int i = 0; i < kDepth; ++i) scale[i] = 1.0f + i * 0.25f;
+  m.SetInput(input);
+  m.SetScale(scale);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected(input.size());
+  for (int r = 0; r < kNumRows; ++r) {
+    const float* row = input.data() + r * kDepth;
+    double mean_square = 0.0;
+    for (int i = 0; i < kDepth; ++i) mean_square += row[i] * row[i];
+    mean_square /= kDepth;
+    for (int i = 0; i < kDepth; ++i) {
+      expected[r * kDepth + i] =
+          row[i] / std::sqrt(mean_square + kEpsilon) * scale[i];
+    }
+  }
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected, 1e-5)));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -15,23 +15,20 @@ limitations under the License.
 
 #include <math.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <limits>
+#include <vector>
 
+#include "Eigen/Core"  // from @eigen_archive
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/common.h"
-#include "tensorflow/lite/kernels/internal/reference/add.h"
-#include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
-#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
-#include "tensorflow/lite/kernels/internal/reference/softmax.h"
-#include "tensorflow/lite/kernels/internal/reference/transpose.h"
-#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
-#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
@@ -43,314 +40,411 @@ static const int kQueryTensor = 0;
 static const int kKeyTensor = 1;
 static const int kValueTensor = 2;
 static const int kAttentionMaskTensor = 3;
+// Optional int64 <query length> positions of the queries in the KV cache,
+// like the position input of the KV cache op. Required with `is_causal`.
+static const int kInputPositionTensor = 4;
 static const int kOutputTensor = 0;
 
-static const int kNumTempTensors = 10;
-static const int kTransposeQueryTempTensorIndex = 0;
-static const int kTransposeKeyTempTensorIndex = 1;
-static const int kMatMul1TempTensorIndex = 2;
-static const int kAddTempTensorIndex = 3;
-static const int kTransposeValueTempTensorIndex = 4;
-static const int kMatMul2TempTensorIndex = 5;
-static const int kReshape1TempTensorIndex = 6;
-static const int kReshape2TempTensorIndex = 7;
-static const int kBroadcastKTempTensorIndex = 8;
-static const int kBroadcastVTempTensorIndex = 9;
+// Queries and keys/values are processed in tiles of this many rows, so that
+// the scores of a tile fit in the cache and the full <query length, key
+// length> score matrix is never materialized.
+static const int kQueryBlockSize = 16;
+static const int kKeyBlockSize = 64;
 
 struct OpData {
   float scale;
+  // If set, query i only attends to the keys up to its position in the KV
+  // cache, and the attention mask is optional.
+  bool is_causal;
   int scratch_tensor_index;
+  // Number of threads the scratch tensor has room for.
+  int num_threads;
 };
 
-void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
-  OpData* op_data = new OpData();
-  op_data->scale = 0.0f;
-  context->AddTensors(context, kNumTempTensors, &op_data->scratch_tensor_index);
-  return op_data;
+// Computes the attention of a tile of queries of one head, with the online
+// (streaming) softmax of flash attention: the keys and values are read one
+// block at a time, and the running maximum, softmax denominator and output of
+// each query are rescaled whenever the maximum increases.
+struct SDPAParams {
+  const float* query;
+  const TfLiteTensor* key;
+  const TfLiteTensor* value;
+  // Null if there is no mask.
+  const float* mask;
+  // Strides of the [batch, head, query, key] mask, 0 for broadcast dims.
+  int mask_strides[4];
+  // Positions of the queries in the KV cache. Only set if `is_causal`.
+  const int64_t* positions;
+  float* output;
+  float scale;
+  bool is_causal;
+  int batch_size;
+  int query_length;
+  int key_length;
+  int num_heads;
+  int num_kv_heads;
+  int head_dim;
+  int value_dim;
+};
+
+// Returns the dequantization scale of head `head` of an int8 K/V tensor with
+// per-tensor or per-head (dimension 2) quantization.
+float HeadScale(const TfLiteTensor* tensor, int head) {
+  const auto* params = reinterpret_cast<const TfLiteAffineQuantization*>(
+      tensor->quantization.params);
+  return params->scale->size == 1 ? params->scale->data[0]
+                                  : params->scale->data[head];
 }
 
-TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
-  TF_LITE_ENSURE_EQ(context, NumInputs(node), 4);
-  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
-  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+template <typename T>
+float ToFloat(T value, float scale);
 
-  const TfLiteTensor* q_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kQueryTensor, &q_tensor));
-  const TfLiteTensor* k_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kKeyTensor, &k_tensor));
-  const TfLiteTensor* v_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kValueTensor, &v_tensor));
-  const TfLiteTensor* mask_tensor;
-  TF_LITE_ENSURE_OK(
-      context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), NumDimensions(k_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(k_tensor), NumDimensions(v_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
-                    NumDimensions(mask_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+template <>
+float ToFloat(float value, float scale) {
+  return value;
+}
 
-  // Get custom op params
-  const uint8_t* buffer =
-      reinterpret_cast<const uint8_t*>(node->custom_initial_data);
-  const size_t length = node->custom_initial_data_size;
-  auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
-  float scale = flexbuffer_map["scale"].AsFloat();
-  op_data->scale = scale > 0.0f ? scale : 0.0f;
+template <>
+float ToFloat(Eigen::half value, float scale) {
+  return Eigen::half_impl::half_to_float(value);
+}
 
-  // If scale is not set, use sqrt(q_tensor->dims->data[3])
-  if (op_data->scale == 0.0f)
-    op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
+template <>
+float ToFloat(int8_t value, float scale) {
+  return value * scale;
+}
 
-  TfLiteIntArrayFree(node->temporaries);
-  node->temporaries = TfLiteIntArrayCreate(kNumTempTensors);
-  bool mqa = k_tensor->dims->data[2] == 1;
-
-  // Temp tensor for Transposed Q;
-  {
-    node->temporaries->data[kTransposeQueryTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeQueryTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeQueryTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = q_tensor->dims->data[i];
+// Copies `num_rows` rows of `dim` elements, `row_stride` apart, from `input`
+// to `output` as float32. If `transpose`, `output` is <dim, num_rows>.
+// Float16 and int8 key/value caches are dequantized one block at a time, so
+// that they never need to be expanded to float32 in full.
+template <typename T>
+void LoadBlock(const T* input, float scale, int row_stride, int num_rows,
+               int dim, bool transpose, float* output) {
+  for (int r = 0; r < num_rows; ++r) {
+    const T* row = input + r * row_stride;
+    if (transpose) {
+      for (int d = 0; d < dim; ++d) {
+        output[d * num_rows + r] = ToFloat(row[d], scale);
+      }
+    } else {
+      for (int d = 0; d < dim; ++d) {
+        output[r * dim + d] = ToFloat(row[d], scale);
+      }
     }
-    // Swap middle two dimensions.
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = q_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
+}
 
-  // Temp tensor for Transposed K;
-  {
-    node->temporaries->data[kTransposeKeyTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeKeyTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeKeyTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = k_tensor->dims->data[i];
-    }
-    // Swap to middle two dimensions.
-    scratch_buffer_size->data[1] = k_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+// Loads rows [first_row, first_row + num_rows) of head `head` of batch `b` of
+// a <batch, seq length, num kv heads, dim> key or value tensor.
+void LoadKeyOrValueBlock(const TfLiteTensor* tensor, int b, int head,
+                         int first_row, int num_rows, bool transpose,
+                         float* output) {
+  const int seq_length = tensor->dims->data[1];
+  const int num_kv_heads = tensor->dims->data[2];
+  const int dim = tensor->dims->data[3];
+  const int row_stride = num_kv_heads * dim;
+  const int offset =
+      ((b * seq_length + first_row) * num_kv_heads + head) * dim;
+  switch (tensor->type) {
+    case kTfLiteFloat16:
+      LoadBlock(reinterpret_cast<const Eigen::half*>(tensor->data.raw) + offset,
+                1.0f, row_stride, num_rows, dim, transpose, output);
+      break;
+    case kTfLiteInt8:
+      LoadBlock(GetTensorData<int8_t>(tensor) + offset,
+                HeadScale(tensor, head), row_stride, num_rows, dim, transpose,
+                output);
+      break;
+    default:
+      LoadBlock(GetTensorData<float>(tensor) + offset, 1.0f, row_stride,
+                num_rows, dim, transpose, output);
+      break;
   }
+}
 
-  TfLiteIntArray* add_broadcast_shape = nullptr;
-  // Temp tensor for Matmul1 output;
-  {
-    node->temporaries->data[kMatMul1TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // mha/gqa: [permute_q[0], permute_q[1], permute_q[2], permute_k[2]]
-    int matmul_out_shape[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
-                               q_tensor->dims->data[1],
-                               k_tensor->dims->data[1]};
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = matmul_out_shape[i];
-    }
+// Number of floats of scratch space used by every thread.
+int ScratchSizePerThread(int head_dim, int value_dim) {
+  return kQueryBlockSize * head_dim +    // Scaled queries.
+         kKeyBlockSize * head_dim +      // Keys.
+         kKeyBlockSize * value_dim +     // Transposed values.
+         kQueryBlockSize * kKeyBlockSize +  // Scores, then probabilities.
+         kQueryBlockSize * value_dim +   // Unnormalized outputs.
+         2 * kQueryBlockSize;            // Running maxima and denominators.
+}
 
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-    // get dims from attention_mask, matmul1_out for add broadcast
-    CalculateShapeForBroadcast(context, mask_tensor, scratch_buffer,
-                               &add_broadcast_shape);
-  }
+// Returns the last key that query `query` attends to in causal attention,
+// clamped to [-1, key length - 1].
+int LastCausalKey(const SDPAParams& params, int query) {
+  const int64_t position = params.positions[query];
+  return static_cast<int>(std::min<int64_t>(
+      std::max<int64_t>(position, -1), params.key_length - 1));
+}
 
-  // Temp tensor for add output;
-  int add_out_shape[4];
-  {
-    node->temporaries->data[kAddTempTensorIndex] =
-        op_data->scratch_tensor_index + kAddTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                                /*index=*/kAddTempTensorIndex,
-                                                &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = add_broadcast_shape;
-    for (int i = 0; i < 4; ++i) {
-      add_out_shape[i] = scratch_buffer_size->data[i];
+// Computes the outputs of queries [q_begin, q_begin + num_queries) of head
+// `head` of batch `b`.
+void ComputeQueryBlock(const SDPAParams& params, int b, int head, int q_begin,
+                       int num_queries, float* scratch) {
+  const int head_dim = params.head_dim;
+  const int value_dim = params.value_dim;
+  float* queries = scratch;
+  float* keys = queries + kQueryBlockSize * head_dim;
+  float* values = keys + kKeyBlockSize * head_dim;
+  float* scores = values + kKeyBlockSize * value_dim;
+  float* acc = scores + kQueryBlockSize * kKeyBlockSize;
+  float* row_max = acc + kQueryBlockSize * value_dim;
+  float* row_sum = row_max + kQueryBlockSize;
+
+  const float kNegInf = -std::numeric_limits<float>::infinity();
+  // Heads are grouped like torch.repeat_interleave in GQA and MQA.
+  const int kv_head = head / (params.num_heads / params.num_kv_heads);
+  const int query_row_stride = params.num_heads * head_dim;
+  for (int i = 0; i < num_queries; ++i) {
+    const float* query = params.query +
+                         (b * params.query_length + q_begin + i) *
+                             query_row_stride +
+                         head * head_dim;
+    for (int d = 0; d < head_dim; ++d) {
+      queries[i * head_dim + d] = query[d] * params.scale;
     }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+    row_max[i] = kNegInf;
+    row_sum[i] = 0.0f;
   }
-
-  // Temp tensor for Transposed V;
-  {
-    node->temporaries->data[kTransposeValueTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeValueTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeValueTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // Swap to {0, 2, 3, 1} dimensions.
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = v_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+  std::fill(acc, acc + num_queries * value_dim, 0.0f);
+
+  // In causal attention, a query attends to the keys up to its position in
+  // the KV cache. The key length is the capacity of the cache, so the keys
+  // past the last position of the block are skipped.
+  int key_end = params.key_length;
+  if (params.is_causal) {
+    key_end = 0;
+    for (int i = 0; i < num_queries; ++i) {
+      key_end = std::max(key_end, LastCausalKey(params, q_begin + i) + 1);
+    }
   }
+  const float* mask =
+      params.mask == nullptr
+          ? nullptr
+          : params.mask + b * params.mask_strides[0] +
+                head * params.mask_strides[1];
+
+  for (int k_begin = 0; k_begin < key_end; k_begin += kKeyBlockSize) {
+    const int num_keys = std::min(kKeyBlockSize, key_end - k_begin);
+    LoadKeyOrValueBlock(params.key, b, kv_head, k_begin, num_keys,
+                        /*transpose=*/false, keys);
+    LoadKeyOrValueBlock(params.value, b, kv_head, k_begin, num_keys,
+                        /*transpose=*/true, values);
+
+    // scores[i][j] = <queries[i], keys[j]>
+    std::fill(scores, scores + num_queries * num_keys, 0.0f);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        keys, num_keys, head_dim, queries, num_queries, scores);
+
+    for (int i = 0; i < num_queries; ++i) {
+      float* row = scores + i * num_keys;
+      if (mask != nullptr) {
+        const float* mask_row = mask +
+                                (q_begin + i) * params.mask_strides[2] +
+                                k_begin * params.mask_strides[3];
+        for (int j = 0; j < num_keys; ++j) {
+          row[j] += mask_row[j * params.mask_strides[3]];
+        }
+      }
+      if (params.is_causal) {
+        const int last_key = LastCausalKey(params, q_begin + i);
+        for (int j = std::max(0, last_key + 1 - k_begin); j < num_keys; ++j) {
+          row[j] = kNegInf;
+        }
+      }
+      float new_max = row_max[i];
+      for (int j = 0; j < num_keys; ++j) new_max = std::max(new_max, row[j]);
+      if (new_max == kNegInf) {
+        // Every key so far is masked out.
+        std::fill(row, row + num_keys, 0.0f);
+        continue;
+      }
+      const float correction = expf(row_max[i] - new_max);
+      float sum = 0.0f;
+      for (int j = 0; j < num_keys; ++j) {
+        row[j] = expf(row[j] - new_max);
+        sum += row[j];
+      }
+      row_sum[i] = row_sum[i] * correction + sum;
+      row_max[i] = new_max;
+      float* out = acc + i * value_dim;
+      for (int d = 0; d < value_dim; ++d) out[d] *= correction;
+    }
 
-  // Temp tensor for Matmul2 output;
-  {
-    node->temporaries->data[kMatMul2TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // logits_out_shape = add_out_shape
-    // mha/gqa: [logits_out[0], logits_out[1], logits_out[2], permute_v[2]]
-    scratch_buffer_size->data[0] = add_out_shape[0];
-    scratch_buffer_size->data[1] = add_out_shape[1];
-    scratch_buffer_size->data[2] = add_out_shape[2];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+    // acc[i] += sum_j probabilities[i][j] * values[j]
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        values, value_dim, num_keys, scores, num_queries, acc);
   }
 
-  // Temp tensor for Reshape K / Transpose Q;
-  {
-    node->temporaries->data[kReshape1TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = k_tensor->dims->data[1];
-      scratch_buffer_size->data[1] = k_tensor->dims->data[3];
-    } else {
-      scratch_buffer_size->data[0] = q_tensor->dims->data[0];
-      scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-      scratch_buffer_size->data[2] = q_tensor->dims->data[3];
-      scratch_buffer_size->data[3] = q_tensor->dims->data[1];
+  const int output_row_stride = params.num_heads * value_dim;
+  for (int i = 0; i < num_queries; ++i) {
+    float* output = params.output +
+                    (b * params.query_length + q_begin + i) *
+                        output_row_stride +
+                    head * value_dim;
+    // Queries that can't attend to any key have a zero output.
+    const float inv_sum = row_sum[i] > 0.0f ? 1.0f / row_sum[i] : 0.0f;
+    for (int d = 0; d < value_dim; ++d) {
+      output[d] = acc[i * value_dim + d] * inv_sum;
     }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
+}
 
-  // Temp tensor for Reshape V / Add_out (softmax_out);
-  {
-    node->temporaries->data[kReshape2TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = v_tensor->dims->data[3];
-      scratch_buffer_size->data[1] = v_tensor->dims->data[1];
-    } else {
-      scratch_buffer_size->data[0] = add_out_shape[0];
-      scratch_buffer_size->data[1] = add_out_shape[1];
-      scratch_buffer_size->data[2] = add_out_shape[3];
-      scratch_buffer_size->data[3] = add_out_shape[2];
+// Computes every `num_tasks`-th block of queries, starting from
+// `task_index`, with its own slice of the scratch tensor.
+struct SDPATask : cpu_backend_threadpool::Task {
+  SDPATask(const SDPAParams& params, int task_index, int num_tasks,
+           float* scratch)
+      : params(params),
+        task_index(task_index),
+        num_tasks(num_tasks),
+        scratch(scratch) {}
+
+  void Run() override {
+    const int num_query_blocks =
+        (params.query_length + kQueryBlockSize - 1) / kQueryBlockSize;
+    const int num_blocks =
+        params.batch_size * params.num_heads * num_query_blocks;
+    for (int i = task_index; i < num_blocks; i += num_tasks) {
+      const int q_block = i % num_query_blocks;
+      const int head = (i / num_query_blocks) % params.num_heads;
+      const int b = i / (num_query_blocks * params.num_heads);
+      const int q_begin = q_block * kQueryBlockSize;
+      ComputeQueryBlock(
+          params, b, head, q_begin,
+          std::min(kQueryBlockSize, params.query_length - q_begin), scratch);
     }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
 
-  // Temp tensor for Broadcast K
-  {
-    node->temporaries->data[kBroadcastKTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastKTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastKTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = k_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-    scratch_buffer_size->data[3] = k_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+  const SDPAParams& params;
+  const int task_index;
+  const int num_tasks;
+  float* scratch;
+};
+
+void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
+  OpData* op_data = new OpData();
+  op_data->scale = 0.0f;
+  op_data->is_causal = false;
+  op_data->num_threads = 1;
+  context->AddTensors(context, 1, &op_data->scratch_tensor_index);
+  return op_data;
+}
+
+TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE(context, NumInputs(node) == 4 || NumInputs(node) == 5);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+
+  // Get custom op params
+  const uint8_t* buffer =
+      reinterpret_cast<const uint8_t*>(node->custom_initial_data);
+  const size_t length = node->custom_initial_data_size;
+  auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+  float scale = flexbuffer_map["scale"].AsFloat();
+  op_data->scale = scale > 0.0f ? scale : 0.0f;
+  op_data->is_causal = flexbuffer_map["is_causal"].AsBool();
+
+  const TfLiteTensor* q_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kQueryTensor, &q_tensor));
+  const TfLiteTensor* k_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeyTensor, &k_tensor));
+  const TfLiteTensor* v_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValueTensor, &v_tensor));
+  const TfLiteTensor* mask_tensor =
+      GetOptionalInputTensor(context, node, kAttentionMaskTensor);
+  TF_LITE_ENSURE(context, mask_tensor != nullptr || op_data->is_causal);
+  const TfLiteTensor* position_tensor =
+      NumInputs(node) == 5
+          ? GetOptionalInputTensor(context, node, kInputPositionTensor)
+          : nullptr;
+  TF_LITE_ENSURE(context, position_tensor != nullptr || !op_data->is_causal);
+  TF_LITE_ENSURE_TYPES_EQ(context, q_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(k_tensor), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor), 4);
+  // Keys and values may come from a float16 or int8 KV cache.
+  TF_LITE_ENSURE(context, k_tensor->type == kTfLiteFloat32 ||
+                              k_tensor->type == kTfLiteFloat16 ||
+                              k_tensor->type == kTfLiteInt8);
+  TF_LITE_ENSURE_TYPES_EQ(context, k_tensor->type, v_tensor->type);
+  for (const TfLiteTensor* kv_tensor : {k_tensor, v_tensor}) {
+    if (kv_tensor->type != kTfLiteInt8) continue;
+    TF_LITE_ENSURE_EQ(context, kv_tensor->quantization.type,
+                      kTfLiteAffineQuantization);
+    const auto* params = reinterpret_cast<const TfLiteAffineQuantization*>(
+        kv_tensor->quantization.params);
+    TF_LITE_ENSURE(context, params != nullptr && params->scale != nullptr);
+    const int num_kv_heads = kv_tensor->dims->data[2];
+    TF_LITE_ENSURE(context, params->scale->size == 1 ||
+                                params->scale->size == num_kv_heads);
+    // The K/V caches are quantized symmetrically.
+    if (params->zero_point != nullptr) {
+      for (int i = 0; i < params->zero_point->size; ++i) {
+        TF_LITE_ENSURE_EQ(context, params->zero_point->data[i], 0);
+      }
+    }
   }
 
-  // Temp tensor for Broadcast V
-  {
-    node->temporaries->data[kBroadcastVTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastVTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastVTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+  const int batch_size = SizeOfDimension(q_tensor, 0);
+  const int query_length = SizeOfDimension(q_tensor, 1);
+  const int num_heads = SizeOfDimension(q_tensor, 2);
+  const int head_dim = SizeOfDimension(q_tensor, 3);
+  const int key_length = SizeOfDimension(k_tensor, 1);
+  const int num_kv_heads = SizeOfDimension(k_tensor, 2);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_tensor, 0), batch_size);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_tensor, 3), head_dim);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(v_tensor, 0), batch_size);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(v_tensor, 1), key_length);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(v_tensor, 2), num_kv_heads);
+  TF_LITE_ENSURE(context, num_kv_heads > 0 && num_heads % num_kv_heads == 0);
+  if (position_tensor != nullptr) {
+    TF_LITE_ENSURE_TYPES_EQ(context, position_tensor->type, kTfLiteInt64);
+    TF_LITE_ENSURE_EQ(context, NumDimensions(position_tensor), 1);
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(position_tensor, 0),
+                      query_length);
+  }
+  if (mask_tensor != nullptr) {
+    TF_LITE_ENSURE_TYPES_EQ(context, mask_tensor->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+    // The mask is broadcast to <batch, num heads, query length, key length>.
+    const int attention_shape[4] = {batch_size, num_heads, query_length,
+                                    key_length};
+    for (int i = 0; i < 4; ++i) {
+      const int dim = SizeOfDimension(mask_tensor, i);
+      TF_LITE_ENSURE(context, dim == 1 || dim == attention_shape[i]);
+    }
   }
 
+  // If scale is not set, use sqrt(q_tensor->dims->data[3])
+  if (op_data->scale == 0.0f) op_data->scale = 1 / sqrt(head_dim);
+
+  // Only the tiles being processed by each thread need scratch space, so it
+  // grows linearly with the dimensions, not with the query length times the
+  // key length.
+  op_data->num_threads =
+      CpuBackendContext::GetFromContext(context)->max_num_threads();
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(1);
+  node->temporaries->data[0] = op_data->scratch_tensor_index;
+  TfLiteTensor* scratch_buffer;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/0, &scratch_buffer));
+  scratch_buffer->type = kTfLiteFloat32;
+  scratch_buffer->allocation_type = kTfLiteArenaRw;
+  TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
+  scratch_buffer_size->data[0] = op_data->num_threads;
+  scratch_buffer_size->data[1] =
+      ScratchSizePerThread(head_dim, SizeOfDimension(v_tensor, 3));
+  TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
+                                                   scratch_buffer_size));
   return kTfLiteOk;
 }
 
@@ -360,304 +454,96 @@ void SDPAFree(TfLiteContext* context, void* buffer) {
 
 TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   /*
-  Simple implementation of Scaled Dot Product Attention.
+  Scaled Dot Product Attention.
   Takes query_proj, key_proj, value_proj, mask tensors as inputs, and
   outputs the attention result.
 
   Notes:
   Scale is computed using 1/sqrt(head_dim),
   head_dim = q[-1] = embedding_dim // num_q_heads
-  Only support for FLOAT32 inputs for now.
-  Only support static tensors for now (k/v[1] = max sequence length)
+  Only support for FLOAT32 inputs for now, except for key and value which may
+  also be FLOAT16 or INT8 (per-tensor or per-head scales).
+  k/v[1] is the max sequence length, or the number of used entries of a paged
+  KV cache, whose mask still covers the capacity of the cache.
   */
-
+  const OpData* op_data = reinterpret_cast<const OpData*>(node->user_data);
   const TfLiteTensor* query_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kQueryTensor, &query_tensor));
-  auto query_shape = GetTensorShape(query_tensor);
-  auto query_data = GetTensorData<float>(query_tensor);
   const TfLiteTensor* key_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
   const TfLiteTensor* value_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
-  const TfLiteTensor* attention_mask_tensor;
-  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
-                                          &attention_mask_tensor));
-  auto attention_mask_shape = GetTensorShape(attention_mask_tensor);
-  auto attention_mask_data = GetTensorData<float>(attention_mask_tensor);
+  const TfLiteTensor* attention_mask_tensor =
+      GetOptionalInputTensor(context, node, kAttentionMaskTensor);
   TfLiteTensor* output_tensor;
   TF_LITE_ENSURE_OK(
       context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
-  auto output_shape = GetTensorShape(output_tensor);
-  auto output_data = GetTensorData<float>(output_tensor);
-
-  // temporaries
-  TfLiteTensor* transpose_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeQueryTempTensorIndex,
-                       &transpose_q_out_tensor));
-  auto transpose_q_out_shape = GetTensorShape(transpose_q_out_tensor);
-  auto transpose_q_out_data = GetTensorData<float>(transpose_q_out_tensor);
-  TfLiteTensor* transpose_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeKeyTempTensorIndex,
-                       &transpose_k_out_tensor));
-  auto transpose_k_out_shape = GetTensorShape(transpose_k_out_tensor);
-  auto transpose_k_out_data = GetTensorData<float>(transpose_k_out_tensor);
-  TfLiteTensor* matmul1_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul1TempTensorIndex,
-                                              &matmul1_out_tensor));
-  auto matmul1_out_shape = GetTensorShape(matmul1_out_tensor);
-  auto matmul1_out_data = GetTensorData<float>(matmul1_out_tensor);
-  TfLiteTensor* add_out_tensor;
+  TfLiteTensor* scratch_buffer;
   TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, /*index=*/kAddTempTensorIndex,
-                                &add_out_tensor));
-  auto add_out_shape = GetTensorShape(add_out_tensor);
-  auto add_out_data = GetTensorData<float>(add_out_tensor);
-  TfLiteTensor* transpose_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeValueTempTensorIndex,
-                       &transpose_v_out_tensor));
-  auto transpose_v_out_shape = GetTensorShape(transpose_v_out_tensor);
-  auto transpose_v_out_data = GetTensorData<float>(transpose_v_out_tensor);
-  TfLiteTensor* matmul2_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul2TempTensorIndex,
-                                              &matmul2_out_tensor));
-  auto matmul2_out_shape = GetTensorShape(matmul2_out_tensor);
-  auto matmul2_out_data = GetTensorData<float>(matmul2_out_tensor);
-  TfLiteTensor* reshape_k_or_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape1TempTensorIndex,
-                       &reshape_k_or_q_out_tensor));
-  auto reshape_k_or_q_out_shape = GetTensorShape(reshape_k_or_q_out_tensor);
-  auto reshape_k_or_q_out_data =
-      GetTensorData<float>(reshape_k_or_q_out_tensor);
-  TfLiteTensor* reshape_v_or_add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape2TempTensorIndex,
-                       &reshape_v_or_add_out_tensor));
-  auto reshape_v_or_add_out_shape = GetTensorShape(reshape_v_or_add_out_tensor);
-  auto reshape_v_or_add_out_data =
-      GetTensorData<float>(reshape_v_or_add_out_tensor);
-  TfLiteTensor* broadcast_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastKTempTensorIndex,
-                       &broadcast_k_out_tensor));
-  auto broadcast_k_out_shape = GetTensorShape(broadcast_k_out_tensor);
-  auto broadcast_k_out_data = GetTensorData<float>(broadcast_k_out_tensor);
-  TfLiteTensor* broadcast_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastVTempTensorIndex,
-                       &broadcast_v_out_tensor));
-  auto broadcast_v_out_shape = GetTensorShape(broadcast_v_out_tensor);
-  auto broadcast_v_out_data = GetTensorData<float>(broadcast_v_out_tensor);
-
-  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
-
-  bool mqa = key_tensor->dims->data[2] == 1;
-  bool gqa = !mqa && (key_tensor->dims->data[2] != query_tensor->dims->data[2]);
-
-  // scale * q
-  float scale = op_data->scale;
-  int flat_size = query_shape.FlatSize();
-  float output_min = -std::numeric_limits<float>::infinity();
-  float output_max = std::numeric_limits<float>::infinity();
-  for (int i = 0; i < flat_size; ++i) {
-    query_tensor->data.f[i] = ActivationFunctionWithMinMax(
-        query_tensor->data.f[i] * scale, output_min, output_max);
+      context, GetTemporarySafe(context, node, /*index=*/0, &scratch_buffer));
+
+  SDPAParams params;
+  params.query = GetTensorData<float>(query_tensor);
+  params.key = key_tensor;
+  params.value = value_tensor;
+  params.output = GetTensorData<float>(output_tensor);
+  params.scale = op_data->scale;
+  params.is_causal = op_data->is_causal;
+  params.batch_size = SizeOfDimension(query_tensor, 0);
+  params.query_length = SizeOfDimension(query_tensor, 1);
+  params.num_heads = SizeOfDimension(query_tensor, 2);
+  params.head_dim = SizeOfDimension(query_tensor, 3);
+  params.key_length = SizeOfDimension(key_tensor, 1);
+  params.num_kv_heads = SizeOfDimension(key_tensor, 2);
+  params.value_dim = SizeOfDimension(value_tensor, 3);
+  params.positions = nullptr;
+  if (op_data->is_causal) {
+    const TfLiteTensor* position_tensor;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputPositionTensor,
+                                            &position_tensor));
+    params.positions = GetTensorData<int64_t>(position_tensor);
   }
-
-  // permute q {0, 2, 1, 3}
-  tflite::TransposeParams transpose_q_params;
-  transpose_q_params.perm_count = 4;
-  transpose_q_params.perm[0] = 0;
-  transpose_q_params.perm[1] = 2;
-  transpose_q_params.perm[2] = 1;
-  transpose_q_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_q_params, query_shape, query_data,
-                           transpose_q_out_shape, transpose_q_out_data);
-
-  // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
-
-  // broadcast k to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_k_ptr = transpose_k_out_data;
-    float* broadcast_k_ptr = broadcast_k_out_data;
-    int num_elements =
-        transpose_k_out_shape.Dims(2) * transpose_k_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_k_out_shape.Dims(1) / transpose_k_out_shape.Dims(1);
-    for (int i = 0; i < transpose_k_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_k_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_k_ptr, transpose_k_ptr,
-                 num_elements * sizeof(float));
-          broadcast_k_ptr += num_elements;
-        }
-        transpose_k_ptr += num_elements;
-      }
+  params.mask = nullptr;
+  if (attention_mask_tensor != nullptr) {
+    // Only the columns of the keys in use are read.
+    const int mask_key_length = SizeOfDimension(attention_mask_tensor, 3);
+    TF_LITE_ENSURE(context, mask_key_length == 1 ||
+                                mask_key_length >= params.key_length);
+    params.mask = GetTensorData<float>(attention_mask_tensor);
+    int stride = 1;
+    for (int i = 3; i >= 0; --i) {
+      const int dim = SizeOfDimension(attention_mask_tensor, i);
+      params.mask_strides[i] = dim == 1 ? 0 : stride;
+      stride *= dim;
     }
   }
 
-  // reshape k for MQA, or transpose q for MHA
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_k_out_tensor->bytes,
-                      reshape_k_or_q_out_tensor->bytes);
-    memcpy(reshape_k_or_q_out_tensor->data.data,
-           transpose_k_out_tensor->data.data, transpose_k_out_tensor->bytes);
-  } else {
-    // permute q2 {0, 1, 3, 2}
-    tflite::TransposeParams transpose_q2_params;
-    transpose_q2_params.perm_count = 4;
-    transpose_q2_params.perm[0] = 0;
-    transpose_q2_params.perm[1] = 1;
-    transpose_q2_params.perm[2] = 3;
-    transpose_q2_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_q2_params, transpose_q_out_shape,
-                             transpose_q_out_data, reshape_k_or_q_out_shape,
-                             reshape_k_or_q_out_data);
+  const int scratch_size_per_thread =
+      ScratchSizePerThread(params.head_dim, params.value_dim);
+  float* scratch = GetTensorData<float>(scratch_buffer);
+  const int num_blocks =
+      params.batch_size * params.num_heads *
+      ((params.query_length + kQueryBlockSize - 1) / kQueryBlockSize);
+  // Heads and query blocks are independent, so they are split across
+  // threads. The scratch tensor was sized for op_data->num_threads.
+  const int num_threads = std::min(
+      {op_data->num_threads, num_blocks,
+       CpuBackendContext::GetFromContext(context)->max_num_threads()});
+  if (num_threads <= 1) {
+    SDPATask(params, /*task_index=*/0, /*num_tasks=*/1, scratch).Run();
+    return kTfLiteOk;
   }
-
-  // mqa FC (q, squeezed_k)
-  // mha BMM(q, k) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(
-        fc_params, transpose_q_out_shape, transpose_q_out_data,
-        reshape_k_or_q_out_shape, reshape_k_or_q_out_data, RuntimeShape(),
-        nullptr, matmul1_out_shape, matmul1_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose q above)
-    reference_ops::BatchMatMul(
-        broadcast_k_out_shape, broadcast_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_k_out_shape, transpose_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
+  std::vector<SDPATask> tasks;
+  tasks.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    tasks.emplace_back(params, i, num_threads,
+                       scratch + i * scratch_size_per_thread);
   }
-
-  // add matmul_out + mask
-  tflite::ArithmeticParams add_params;
-  SetActivationParams(output_min, output_max, &add_params);
-  reference_ops::BroadcastAdd6DSlow(
-      add_params, attention_mask_shape, attention_mask_data, matmul1_out_shape,
-      matmul1_out_data, add_out_shape, add_out_data);
-
-  // softmax, can do in-place
-  tflite::SoftmaxParams softmax_params;
-  softmax_params.beta = 1.0f;
-  reference_ops::Softmax(softmax_params, add_out_shape, add_out_data,
-                         add_out_shape, add_out_data);
-
-  // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
-
-  // broadcast v to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_v_ptr = transpose_v_out_data;
-    float* broadcast_v_ptr = broadcast_v_out_data;
-    int num_elements =
-        transpose_v_out_shape.Dims(2) * transpose_v_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_v_out_shape.Dims(1) / transpose_v_out_shape.Dims(1);
-    for (int i = 0; i < transpose_v_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_v_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_v_ptr, transpose_v_ptr,
-                 num_elements * sizeof(float));
-          broadcast_v_ptr += num_elements;
-        }
-        transpose_v_ptr += num_elements;
-      }
-    }
-  }
-
-  // reshape v for MQA, or add_out (softmax_out)
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_v_out_tensor->bytes,
-                      reshape_v_or_add_out_tensor->bytes);
-    memcpy(reshape_v_or_add_out_tensor->data.data,
-           transpose_v_out_tensor->data.data, transpose_v_out_tensor->bytes);
-  } else {
-    // permute softmax_out {0, 1, 3, 2}
-    tflite::TransposeParams transpose_softmax_out_params;
-    transpose_softmax_out_params.perm_count = 4;
-    transpose_softmax_out_params.perm[0] = 0;
-    transpose_softmax_out_params.perm[1] = 1;
-    transpose_softmax_out_params.perm[2] = 3;
-    transpose_softmax_out_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_softmax_out_params, add_out_shape,
-                             add_out_data, reshape_v_or_add_out_shape,
-                             reshape_v_or_add_out_data);
-  }
-
-  // mqa FC (softmax_out, squeezed_v)
-  // mha BMM(softmax_out, v) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(fc_params, add_out_shape, add_out_data,
-                                  reshape_v_or_add_out_shape,
-                                  reshape_v_or_add_out_data, RuntimeShape(),
-                                  nullptr, matmul2_out_shape, matmul2_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose add_out above)
-    reference_ops::BatchMatMul(
-        broadcast_v_out_shape, broadcast_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_v_out_shape, transpose_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  }
-
-  // permute out {0, 2, 1, 3}
-  tflite::TransposeParams transpose_out_params;
-  transpose_out_params.perm_count = 4;
-  transpose_out_params.perm[0] = 0;
-  transpose_out_params.perm[1] = 2;
-  transpose_out_params.perm[2] = 1;
-  transpose_out_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_out_params, matmul2_out_shape,
-                           matmul2_out_data, output_shape, output_data);
-
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  CpuBackendContext::GetFromContext(context));
   return kTfLiteOk;
 }
 
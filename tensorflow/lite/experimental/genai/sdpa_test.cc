@@ -0,0 +1,346 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "Eigen/Core"  // from @eigen_archive
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+struct SDPAShape {
+  int query_length;
+  // Number of entries of the K/V cache.
+  int key_length;
+  int num_heads;
+  int num_kv_heads;
+  int head_dim;
+};
+
+struct SDPAConfig {
+  SDPAShape shape;
+  TensorType kv_type = TensorType_FLOAT32;
+  // Per head scales of an int8 K/V cache.
+  std::vector<float> kv_scales;
+  int64_t kv_zero_point = 0;
+  bool is_causal = false;
+  bool has_mask = true;
+};
+
+class SDPAOpModel : public SingleOpModel {
+ public:
+  // Q is <1, query length, num heads, head dim> and K/V are <1, key length,
+  // num kv heads, head dim>. The mask is <1, 1, query length, key length>.
+  // With `is_causal`, the positions of the queries in the cache are a fifth
+  // input.
+  explicit SDPAOpModel(const SDPAConfig& config) : config_(config) {
+    const SDPAShape& s = config.shape;
+    q_ = AddInput(
+        {TensorType_FLOAT32, {1, s.query_length, s.num_heads, s.head_dim}});
+    const std::vector<int> kv_shape = {1, s.key_length, s.num_kv_heads,
+                                       s.head_dim};
+    if (config.kv_type == TensorType_INT8) {
+      const TensorData kv_data(
+          TensorType_INT8, kv_shape, /*min=*/0, /*max=*/0, /*scale=*/0,
+          /*zero_point=*/0, /*per_channel_quantization=*/true,
+          config.kv_scales,
+          std::vector<int64_t>(config.kv_scales.size(), config.kv_zero_point),
+          /*channel_index=*/2);
+      k_ = AddInput(kv_data);
+      v_ = AddInput(kv_data);
+    } else {
+      k_ = AddInput({config.kv_type, kv_shape});
+      v_ = AddInput({config.kv_type, kv_shape});
+    }
+    std::vector<std::vector<int>> input_shapes = {GetShape(q_), GetShape(k_),
+                                                  GetShape(v_)};
+    if (config.has_mask) {
+      mask_ =
+          AddInput({TensorType_FLOAT32, {1, 1, s.query_length, s.key_length}});
+      input_shapes.push_back(GetShape(mask_));
+    } else {
+      mask_ = AddNullInput();
+    }
+    if (config.is_causal) {
+      positions_ = AddInput({TensorType_INT64, {s.query_length}});
+      input_shapes.push_back(GetShape(positions_));
+    }
+    output_ = AddOutput(
+        {TensorType_FLOAT32, {1, s.query_length, s.num_heads, s.head_dim}});
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Bool("is_causal", config.is_causal); });
+    fbb.Finish();
+    SetCustomOp("odml.scaled_dot_product_attention", fbb.GetBuffer(),
+                ops::custom::Register_SDPA);
+    BuildInterpreter(input_shapes, /*num_threads=*/-1,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false,
+                     /*allocate_and_delegate=*/false);
+  }
+
+  TfLiteStatus AllocateTensors() { return interpreter_->AllocateTensors(); }
+
+  void SetQuery(const std::vector<float>& data) { PopulateTensor(q_, data); }
+  // Returns the values the op sees after the conversion to the K/V type.
+  std::vector<float> SetKey(const std::vector<float>& data) {
+    return SetKeyOrValue(k_, data);
+  }
+  std::vector<float> SetValue(const std::vector<float>& data) {
+    return SetKeyOrValue(v_, data);
+  }
+  void SetMask(const std::vector<float>& data) { PopulateTensor(mask_, data); }
+  void SetPositions(const std::vector<int64_t>& data) {
+    PopulateTensor(positions_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  std::vector<float> SetKeyOrValue(int index, const std::vector<float>& data) {
+    std::vector<float> converted(data.size());
+    switch (config_.kv_type) {
+      case TensorType_FLOAT16: {
+        std::vector<Eigen::half> halfs(data.size());
+        for (int i = 0; i < data.size(); ++i) {
+          halfs[i] = Eigen::half(data[i]);
+          converted[i] = static_cast<float>(halfs[i]);
+        }
+        PopulateTensor(index, halfs);
+        break;
+      }
+      case TensorType_INT8: {
+        const int head_dim = config_.shape.head_dim;
+        const int num_kv_heads = config_.shape.num_kv_heads;
+        std::vector<int8_t> quantized(data.size());
+        for (int i = 0; i < data.size(); ++i) {
+          const float scale = config_.kv_scales[(i / head_dim) % num_kv_heads];
+          quantized[i] = static_cast<int8_t>(
+              std::clamp(std::round(data[i] / scale), -127.0f, 127.0f));
+          converted[i] = quantized[i] * scale;
+        }
+        PopulateTensor(index, quantized);
+        break;
+      }
+      default:
+        converted = data;
+        PopulateTensor(index, data);
+        break;
+    }
+    return converted;
+  }
+
+  SDPAConfig config_;
+  int q_;
+  int k_;
+  int v_;
+  int mask_;
+  int positions_ = -1;
+  int output_;
+};
+
+std::vector<float> MakeData(int size, float step) {
+  std::vector<float> data(size);
+  for (int i = 0; i < size; ++i) {
+    data[i] = std::sin(i * step);
+  }
+  return data;
+}
+
+// Computes softmax(Q Kᵀ / sqrt(head dim) + mask) V one query and one head at
+// a time. If `positions` is not empty, query i only attends to the keys up to
+// positions[i]. The heads of GQA and MQA map to their kv head like
+// torch.repeat_interleave.
+std::vector<float> ReferenceSDPA(const SDPAShape& s,
+                                 const std::vector<float>& query,
+                                 const std::vector<float>& key,
+                                 const std::vector<float>& value,
+                                 const std::vector<float>& mask,
+                                 const std::vector<int64_t>& positions) {
+  const float scale = 1.0f / std::sqrt(static_cast<float>(s.head_dim));
+  std::vector<float> output(s.query_length * s.num_heads * s.head_dim, 0.0f);
+  std::vector<float> scores(s.key_length);
+  for (int h = 0; h < s.num_heads; ++h) {
+    const int kv_h = h / (s.num_heads / s.num_kv_heads);
+    for (int i = 0; i < s.query_length; ++i) {
+      const float* q = &query[(i * s.num_heads + h) * s.head_dim];
+      float max_score = kNegInf;
+      for (int j = 0; j < s.key_length; ++j) {
+        const float* k = &key[(j * s.num_kv_heads + kv_h) * s.head_dim];
+        float dot = 0.0f;
+        for (int d = 0; d < s.head_dim; ++d) dot += q[d] * k[d];
+        scores[j] = dot * scale;
+        if (!mask.empty()) scores[j] += mask[i * s.key_length + j];
+        if (!positions.empty() && j > positions[i]) scores[j] = kNegInf;
+        max_score = std::max(max_score, scores[j]);
+      }
+      if (max_score == kNegInf) continue;
+      float sum = 0.0f;
+      for (int j = 0; j < s.key_length; ++j) {
+        scores[j] = std::exp(scores[j] - max_score);
+        sum += scores[j];
+      }
+      float* out = &output[(i * s.num_heads + h) * s.head_dim];
+      for (int j = 0; j < s.key_length; ++j) {
+        const float* v = &value[(j * s.num_kv_heads + kv_h) * s.head_dim];
+        for (int d = 0; d < s.head_dim; ++d) {
+          out[d] += scores[j] / sum * v[d];
+        }
+      }
+    }
+  }
+  return output;
+}
+
+std::vector<float> CausalMask(int query_length, int key_length) {
+  std::vector<float> mask(query_length * key_length, 0.0f);
+  for (int i = 0; i < query_length; ++i) {
+    for (int j = i + 1; j < key_length; ++j) {
+      mask[i * key_length + j] = kNegInf;
+    }
+  }
+  return mask;
+}
+
+std::vector<int64_t> Positions(int first, int count) {
+  std::vector<int64_t> positions(count);
+  for (int i = 0; i < count; ++i) positions[i] = first + i;
+  return positions;
+}
+
+// Runs the op on sinusoidal inputs and compares it with ReferenceSDPA.
+void ExpectMatchesReference(const SDPAConfig& config,
+                            const std::vector<float>& mask,
+                            const std::vector<int64_t>& positions,
+                            float tolerance) {
+  const SDPAShape& s = config.shape;
+  const std::vector<float> query =
+      MakeData(s.query_length * s.num_heads * s.head_dim, 0.37f);
+  const int kv_size = s.key_length * s.num_kv_heads * s.head_dim;
+  SDPAOpModel model(config);
+  ASSERT_EQ(model.AllocateTensors(), kTfLiteOk);
+  model.SetQuery(query);
+  const std::vector<float> key = model.SetKey(MakeData(kv_size, 0.11f));
+  const std::vector<float> value = model.SetValue(MakeData(kv_size, 0.23f));
+  if (config.has_mask) model.SetMask(mask);
+  if (config.is_causal) model.SetPositions(positions);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  ReferenceSDPA(s, query, key, value, mask, positions),
+                  tolerance)));
+}
+
+// A causal mask with GQA over longer sequences than a tile, once with an
+// explicit mask and once with `is_causal`.
+TEST(SDPAOpTest, CausalMatchesExplicitMask) {
+  const SDPAShape shape = {/*query_length=*/80, /*key_length=*/80,
+                           /*num_heads=*/4, /*num_kv_heads=*/2,
+                           /*head_dim=*/8};
+  SDPAConfig masked;
+  masked.shape = shape;
+  ExpectMatchesReference(masked, CausalMask(80, 80), {}, 1e-5);
+
+  SDPAConfig causal;
+  causal.shape = shape;
+  causal.is_causal = true;
+  causal.has_mask = false;
+  ExpectMatchesReference(causal, {}, Positions(0, 80), 1e-5);
+}
+
+// The mask broadcasts over the heads and may mask out every key of a query.
+TEST(SDPAOpTest, ExplicitMaskMatchesReference) {
+  SDPAConfig config;
+  config.shape = {/*query_length=*/20, /*key_length=*/70, /*num_heads=*/3,
+                  /*num_kv_heads=*/1, /*head_dim=*/16};
+  std::vector<float> mask = MakeData(20 * 70, 0.05f);
+  for (int j = 0; j < 70; ++j) {
+    mask[3 * 70 + j] = kNegInf;
+    if (j % 3 == 0) mask[7 * 70 + j] = kNegInf;
+  }
+  ExpectMatchesReference(config, mask, {}, 1e-5);
+}
+
+// When decoding, the queries are at the end of the filled part of the cache,
+// not at the end of the cache. The entries past the last position must be
+// ignored.
+TEST(SDPAOpTest, CausalAttendsUpToCachePosition) {
+  SDPAConfig config;
+  config.shape = {/*query_length=*/3, /*key_length=*/128, /*num_heads=*/4,
+                  /*num_kv_heads=*/4, /*head_dim=*/8};
+  config.is_causal = true;
+  config.has_mask = false;
+  ExpectMatchesReference(config, {}, Positions(40, 3), 1e-5);
+}
+
+// Causal attention combined with an explicit mask of the same shape.
+TEST(SDPAOpTest, CausalAndMaskMatchReference) {
+  SDPAConfig config;
+  config.shape = {/*query_length=*/17, /*key_length=*/96, /*num_heads=*/2,
+                  /*num_kv_heads=*/1, /*head_dim=*/8};
+  config.is_causal = true;
+  ExpectMatchesReference(config, MakeData(17 * 96, 0.07f), Positions(10, 17),
+                         1e-5);
+}
+
+TEST(SDPAOpTest, Float16KVCacheMatchesReference) {
+  SDPAConfig config;
+  config.shape = {/*query_length=*/20, /*key_length=*/100, /*num_heads=*/4,
+                  /*num_kv_heads=*/2, /*head_dim=*/8};
+  config.kv_type = TensorType_FLOAT16;
+  config.is_causal = true;
+  config.has_mask = false;
+  ExpectMatchesReference(config, {}, Positions(50, 20), 1e-5);
+}
+
+TEST(SDPAOpTest, Int8KVCacheMatchesReference) {
+  SDPAConfig config;
+  config.shape = {/*query_length=*/20, /*key_length=*/100, /*num_heads=*/4,
+                  /*num_kv_heads=*/2, /*head_dim=*/8};
+  config.kv_type = TensorType_INT8;
+  config.kv_scales = {1.0f / 127, 1.0f / 100};
+  config.is_causal = true;
+  config.has_mask = false;
+  ExpectMatchesReference(config, {}, Positions(50, 20), 1e-5);
+}
+
+TEST(SDPAOpTest, Int8KVCacheRequiresZeroZeroPoint) {
+  SDPAConfig config;
+  config.shape = {/*query_length=*/4, /*key_length=*/16, /*num_heads=*/2,
+                  /*num_kv_heads=*/2, /*head_dim=*/8};
+  config.kv_type = TensorType_INT8;
+  config.kv_scales = {1.0f / 127, 1.0f / 127};
+  config.kv_zero_point = 3;
+  config.is_causal = true;
+  config.has_mask = false;
+  SDPAOpModel model(config);
+  EXPECT_NE(model.AllocateTensors(), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/resource/cache_buffer.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 
@@ -27,25 +28,57 @@ namespace tflite {
 namespace resource {
 
 TfLiteStatus CacheBuffer::Initialize(const TfLiteIntArray& shape) {
+  return Initialize(shape, kTfLiteFloat32);
+}
+
+TfLiteStatus CacheBuffer::Initialize(const TfLiteIntArray& shape,
+                                     TfLiteType type) {
+  if (type != kTfLiteFloat32 && type != kTfLiteFloat16 && type != kTfLiteInt8) {
+    return kTfLiteError;
+  }
+  if (type == kTfLiteInt8 && shape.size != 5) return kTfLiteError;
   // Set the dims and allocate the memory.
+  type_ = type;
   dims_ = TfLiteIntArrayCopy(&shape);
-  const size_t buf_size = NumElements(&shape);
+  const size_t buf_bytes = GetSize();
+  const size_t buf_size = (buf_bytes + sizeof(float) - 1) / sizeof(float);
   buffer_.reset(new float[buf_size]);
   memset(buffer_.get(), 0, sizeof(float) * buf_size);
 
+  if (type == kTfLiteInt8) {
+    const size_t num_scales = shape.data[1] * shape.data[3];
+    scales_.reset(new float[num_scales]);
+    memset(scales_.get(), 0, sizeof(float) * num_scales);
+  }
+
   num_entries_.reset(new size_t[shape.data[1]]);
   memset(num_entries_.get(), 0, sizeof(size_t) * shape.data[1]);
   is_initialized_ = true;
   return kTfLiteOk;
 }
 
-size_t CacheBuffer::GetSize() { return sizeof(float) * NumElements(dims_); }
+size_t CacheBuffer::GetSize() {
+  size_t element_size = sizeof(float);
+  if (type_ == kTfLiteFloat16) element_size = sizeof(TfLiteFloat16);
+  if (type_ == kTfLiteInt8) element_size = sizeof(int8_t);
+  return element_size * NumElements(dims_);
+}
 
 size_t CacheBuffer::GetNumEntries(int idx) const { return num_entries_[idx]; }
 
 CacheBuffer::~CacheBuffer() { TfLiteIntArrayFree(dims_); }
 
-float* CacheBuffer::GetBuffer() { return buffer_.get(); }
+float* CacheBuffer::GetBuffer() {
+  TFLITE_DCHECK(type_ == kTfLiteFloat32);
+  return buffer_.get();
+}
+
+void* CacheBuffer::GetRawBuffer() { return buffer_.get(); }
+
+float* CacheBuffer::GetScales(int idx) {
+  TFLITE_DCHECK(type_ == kTfLiteInt8);
+  return scales_.get() + idx * dims_->data[3];
+}
 
 void CacheBuffer::SetNumEntries(int idx, size_t count) {
   TFLITE_DCHECK(count <= dims_->data[2]);
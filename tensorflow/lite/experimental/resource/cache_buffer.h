@@ -36,19 +36,36 @@ class CacheBuffer : public ResourceVariable {
   CacheBuffer(const CacheBuffer &) = delete;
   ~CacheBuffer() override;
   CacheBuffer &operator=(const CacheBuffer &) = delete;
-  // Initialize tensor of a certain shape using the provided type.
+  // Initialize a float buffer of a certain shape.
   TfLiteStatus Initialize(const TfLiteIntArray &shape);
+  // Initialize a buffer of a certain shape using the provided type, which is
+  // one of kTfLiteFloat32, kTfLiteFloat16 or kTfLiteInt8. Int8 buffers also
+  // keep one quantization scale per <layer, head>, which requires `shape` to
+  // be <batch, num layers, seq length, num heads, head dim>.
+  TfLiteStatus Initialize(const TfLiteIntArray &shape, TfLiteType type);
   size_t GetNumEntries(int idx) const;
+  // Returns the buffer of a kTfLiteFloat32 cache.
   float *GetBuffer();
+  // Returns the buffer, regardless of its type.
+  void *GetRawBuffer();
+  TfLiteType GetType() const { return type_; }
+  // Returns the size of the buffer in bytes.
   size_t GetSize();
   void SetNumEntries(int idx, size_t count);
+  // Returns the `num heads` quantization scales of layer `idx` of an int8
+  // buffer. The scales start out as zero, meaning no entry was written yet.
+  float *GetScales(int idx);
 
  private:
   // The number of entries currently used in the buffer;
   std::unique_ptr<size_t[]> num_entries_;
-  // The float buffer for storage. Has shape:
+  // The storage, of type `type_`. Allocated as floats to keep it aligned for
+  // any of the supported types. Has shape:
   // <batch, num layers, seq length, num heads, head dim>
   std::unique_ptr<float[]> buffer_;
+  TfLiteType type_ = kTfLiteFloat32;
+  // Quantization scales of an int8 buffer. Has shape <num layers, num heads>.
+  std::unique_ptr<float[]> scales_;
   TfLiteIntArray *dims_;
 };
 
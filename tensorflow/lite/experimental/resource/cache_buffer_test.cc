@@ -40,5 +40,40 @@ TEST(CacheBufferTest, Initialize) {
   TfLiteIntArrayFree(shape);
 }
 
+TEST(CacheBufferTest, InitializeInt8) {
+  TfLiteIntArray* shape = TfLiteIntArrayCreate(5);
+  shape->data[0] = 1;
+  shape->data[1] = 2;
+  shape->data[2] = 5;
+  shape->data[3] = 3;
+  shape->data[4] = 4;
+
+  CacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(*shape, kTfLiteInt8), kTfLiteOk);
+
+  EXPECT_EQ(cache_buffer.GetType(), kTfLiteInt8);
+  EXPECT_EQ(cache_buffer.GetSize(), 120);
+  ASSERT_NE(cache_buffer.GetRawBuffer(), nullptr);
+  EXPECT_EQ(cache_buffer.GetScales(1) - cache_buffer.GetScales(0), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(cache_buffer.GetScales(1)[i], 0.f);
+  }
+  TfLiteIntArrayFree(shape);
+}
+
+TEST(CacheBufferTest, InitializeFloat16) {
+  TfLiteIntArray* shape = TfLiteIntArrayCreate(4);
+  shape->data[0] = 1;
+  shape->data[1] = 3;
+  shape->data[2] = 5;
+  shape->data[3] = 7;
+
+  CacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(*shape, kTfLiteFloat16), kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetSize(), 210);
+  EXPECT_EQ(cache_buffer.Initialize(*shape, kTfLiteInt32), kTfLiteError);
+  TfLiteIntArrayFree(shape);
+}
+
 }  // namespace resource
 }  // namespace tflite
@@ -0,0 +1,240 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus PagedCacheBuffer::Initialize(int num_layers, int block_size,
+                                          int max_num_blocks, int entry_size) {
+  if (num_layers <= 0 || block_size <= 0 || max_num_blocks <= 0 ||
+      entry_size <= 0) {
+    return kTfLiteError;
+  }
+  block_size_ = block_size;
+  max_num_blocks_ = max_num_blocks;
+  entry_size_ = entry_size;
+  layers_.clear();
+  layers_.resize(num_layers);
+  blocks_.clear();
+  ref_counts_.clear();
+  free_blocks_.clear();
+  num_allocated_blocks_ = 0;
+  view_.clear();
+  view_.shrink_to_fit();
+  prefixes_.clear();
+  is_initialized_ = true;
+  return kTfLiteOk;
+}
+
+size_t PagedCacheBuffer::GetMemoryUsage() {
+  return (static_cast<size_t>(num_allocated_blocks_) * block_size_ *
+              entry_size_ +
+          view_.capacity()) *
+         sizeof(float);
+}
+
+size_t PagedCacheBuffer::GetNumEntries(int layer) const {
+  return layers_[layer].num_entries;
+}
+
+void PagedCacheBuffer::SetNumEntries(int layer, size_t count) {
+  Layer& l = layers_[layer];
+  l.num_entries = count;
+  // Keep only the blocks needed to hold `count` entries.
+  const size_t num_needed_blocks =
+      (l.first_entry_offset + count + block_size_ - 1) / block_size_;
+  while (l.block_table.size() > num_needed_blocks) {
+    if (l.block_table.back() >= 0) ReleaseBlock(l.block_table.back());
+    l.block_table.pop_back();
+  }
+}
+
+int PagedCacheBuffer::AllocateBlock() {
+  if (num_allocated_blocks_ >= max_num_blocks_) return -1;
+  int block;
+  if (!free_blocks_.empty()) {
+    block = free_blocks_.back();
+    free_blocks_.pop_back();
+  } else {
+    block = blocks_.size();
+    blocks_.emplace_back();
+    ref_counts_.push_back(0);
+  }
+  blocks_[block].reset(new float[block_size_ * entry_size_]);
+  ref_counts_[block] = 1;
+  ++num_allocated_blocks_;
+  return block;
+}
+
+void PagedCacheBuffer::ReleaseBlock(int block) {
+  TFLITE_DCHECK(ref_counts_[block] > 0);
+  if (--ref_counts_[block] > 0) return;
+  blocks_[block].reset();
+  free_blocks_.push_back(block);
+  --num_allocated_blocks_;
+}
+
+void PagedCacheBuffer::RetainBlocks(const Layer& layer) {
+  for (int block : layer.block_table) {
+    if (block >= 0) ++ref_counts_[block];
+  }
+}
+
+void PagedCacheBuffer::ReleaseBlocks(Layer& layer) {
+  for (int block : layer.block_table) {
+    if (block >= 0) ReleaseBlock(block);
+  }
+  layer.block_table.clear();
+}
+
+float* PagedCacheBuffer::GetOrAllocateEntry(int layer, int64_t entry) {
+  Layer& l = layers_[layer];
+  const int64_t slot = l.first_entry_offset + entry;
+  const size_t logical_block = slot / block_size_;
+  if (logical_block >= l.block_table.size()) {
+    l.block_table.resize(logical_block + 1, -1);
+  }
+  int& block = l.block_table[logical_block];
+  if (block < 0) {
+    block = AllocateBlock();
+    if (block < 0) return nullptr;
+    // Fresh blocks read as zero, like the contiguous CacheBuffer.
+    memset(blocks_[block].get(), 0,
+           sizeof(float) * block_size_ * entry_size_);
+  } else if (ref_counts_[block] > 1) {
+    // Copy on write: this block is shared with another layer state.
+    const int copy = AllocateBlock();
+    if (copy < 0) return nullptr;
+    memcpy(blocks_[copy].get(), blocks_[block].get(),
+           sizeof(float) * block_size_ * entry_size_);
+    ReleaseBlock(block);
+    block = copy;
+  }
+  return blocks_[block].get() + (slot % block_size_) * entry_size_;
+}
+
+const float* PagedCacheBuffer::GetEntry(int layer, int64_t entry) const {
+  const Layer& l = layers_[layer];
+  const int64_t slot = l.first_entry_offset + entry;
+  const size_t logical_block = slot / block_size_;
+  if (logical_block >= l.block_table.size()) return nullptr;
+  const int block = l.block_table[logical_block];
+  if (block < 0) return nullptr;
+  return blocks_[block].get() + (slot % block_size_) * entry_size_;
+}
+
+void PagedCacheBuffer::DropFrontEntries(int layer, int64_t count) {
+  Layer& l = layers_[layer];
+  TFLITE_DCHECK(count >= 0);
+  l.first_entry_offset += count;
+  l.first_position += count;
+  const size_t num_dropped_blocks = std::min<size_t>(
+      l.first_entry_offset / block_size_, l.block_table.size());
+  for (size_t i = 0; i < num_dropped_blocks; ++i) {
+    if (l.block_table[i] >= 0) ReleaseBlock(l.block_table[i]);
+  }
+  l.block_table.erase(l.block_table.begin(),
+                      l.block_table.begin() + num_dropped_blocks);
+  l.first_entry_offset -= num_dropped_blocks * block_size_;
+  l.num_entries -= std::min<size_t>(l.num_entries, count);
+}
+
+void PagedCacheBuffer::Gather(int layer, int64_t count, float* dst) const {
+  const size_t entry_bytes = sizeof(float) * entry_size_;
+  int64_t entry = 0;
+  while (entry < count) {
+    // Copy as many entries as are contiguous in the current block.
+    const int64_t slot = layers_[layer].first_entry_offset + entry;
+    const int64_t run =
+        std::min<int64_t>(block_size_ - slot % block_size_, count - entry);
+    const float* src = GetEntry(layer, entry);
+    if (src != nullptr) {
+      memcpy(dst, src, run * entry_bytes);
+    } else {
+      memset(dst, 0, run * entry_bytes);
+    }
+    dst += run * entry_size_;
+    entry += run;
+  }
+}
+
+const float* PagedCacheBuffer::GatherView(int layer, int64_t count) {
+  view_.resize(count * entry_size_);
+  // Give memory back once the view is much larger than needed, e.g. after a
+  // shorter prefix is loaded.
+  if (view_.capacity() > 2 * view_.size()) view_.shrink_to_fit();
+  Gather(layer, count, view_.data());
+  return view_.data();
+}
+
+TfLiteStatus PagedCacheBuffer::SavePrefix(int prefix_id,
+                                          int64_t num_entries) {
+  for (const Layer& l : layers_) {
+    if (num_entries < 0 || num_entries > static_cast<int64_t>(l.num_entries)) {
+      return kTfLiteError;
+    }
+  }
+  std::vector<Layer> prefix(layers_.size());
+  for (size_t i = 0; i < layers_.size(); ++i) {
+    const Layer& l = layers_[i];
+    const size_t num_blocks =
+        (l.first_entry_offset + num_entries + block_size_ - 1) / block_size_;
+    prefix[i].block_table.assign(l.block_table.begin(),
+                                 l.block_table.begin() +
+                                     std::min(num_blocks, l.block_table.size()));
+    prefix[i].first_entry_offset = l.first_entry_offset;
+    prefix[i].first_position = l.first_position;
+    prefix[i].num_entries = num_entries;
+    RetainBlocks(prefix[i]);
+  }
+  ErasePrefix(prefix_id);
+  prefixes_.emplace(prefix_id, std::move(prefix));
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedCacheBuffer::LoadPrefix(int prefix_id) {
+  auto it = prefixes_.find(prefix_id);
+  if (it == prefixes_.end()) return kTfLiteError;
+  for (size_t i = 0; i < layers_.size(); ++i) {
+    // Retain before releasing in case the layer already holds the prefix.
+    RetainBlocks(it->second[i]);
+    ReleaseBlocks(layers_[i]);
+    layers_[i] = it->second[i];
+  }
+  return kTfLiteOk;
+}
+
+void PagedCacheBuffer::ErasePrefix(int prefix_id) {
+  auto it = prefixes_.find(prefix_id);
+  if (it == prefixes_.end()) return;
+  for (Layer& l : it->second) ReleaseBlocks(l);
+  prefixes_.erase(it);
+}
+
+}  // namespace resource
+}  // namespace tflite
@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged variant of CacheBuffer. Instead of reserving
+// <batch, num layers, seq length, num heads, head dim> up front, storage is
+// carved out of a pool of fixed-size blocks of `block_size` entries that are
+// only allocated once an entry in them is written. Each layer keeps a block
+// table mapping its logical blocks to physical blocks in the pool, so the
+// entries of a layer are not contiguous in memory.
+//
+// Blocks are reference counted so that the cache state of several sequences
+// can share the blocks of a common prefix (e.g. a system prompt). A shared
+// block is copied on the first write to it. A block is freed as soon as no
+// block table references it, so the memory held tracks the used entries.
+class PagedCacheBuffer : public ResourceBase {
+ public:
+  PagedCacheBuffer() = default;
+  PagedCacheBuffer(const PagedCacheBuffer &) = delete;
+  ~PagedCacheBuffer() override = default;
+  PagedCacheBuffer &operator=(const PagedCacheBuffer &) = delete;
+
+  // Initializes the pool. `entry_size` is the number of floats in one cache
+  // entry (num heads * head dim). At most `max_num_blocks` blocks are ever
+  // allocated, shared between all `num_layers` layers.
+  TfLiteStatus Initialize(int num_layers, int block_size, int max_num_blocks,
+                          int entry_size);
+
+  bool IsInitialized() override { return is_initialized_; }
+
+  // Returns the number of bytes held by allocated blocks and the dense view.
+  size_t GetMemoryUsage() override;
+
+  int GetBlockSize() const { return block_size_; }
+  int GetEntrySize() const { return entry_size_; }
+  int GetNumAllocatedBlocks() const { return num_allocated_blocks_; }
+  int GetNumFreeBlocks() const {
+    return max_num_blocks_ - num_allocated_blocks_;
+  }
+
+  // Returns the absolute position of entry 0 of `layer`, i.e. the number of
+  // entries dropped from its front since it was last reset.
+  int64_t GetFirstPosition(int layer) const {
+    return layers_[layer].first_position;
+  }
+
+  size_t GetNumEntries(int layer) const;
+  // Sets the number of used entries of `layer`. Blocks past the last used
+  // entry are returned to the pool.
+  void SetNumEntries(int layer, size_t count);
+
+  // Returns a pointer to `entry` of `layer`, allocating the block that holds
+  // it if needed, or copying it if it is shared. Returns nullptr if the pool is
+  // exhausted.
+  float *GetOrAllocateEntry(int layer, int64_t entry);
+  // Returns a pointer to `entry` of `layer`, or nullptr if its block was
+  // never allocated.
+  const float *GetEntry(int layer, int64_t entry) const;
+
+  // Drops the first `count` entries of `layer`, so that entry `count` becomes
+  // entry 0. Blocks that no longer hold any entry are returned to the pool.
+  // This is O(number of dropped blocks) and does not move any data.
+  void DropFrontEntries(int layer, int64_t count);
+
+  // Copies the first `count` entries of `layer` into the contiguous `dst`.
+  // Entries whose block was never allocated are zero filled.
+  void Gather(int layer, int64_t count, float *dst) const;
+  // Gathers the first `count` entries of `layer` into a dense view shared by
+  // all layers and returns it. The view only has room for the entries
+  // gathered last, and is overwritten by the next call.
+  const float *GatherView(int layer, int64_t count);
+
+  // Returns the physical block indices backing `layer`, in logical order.
+  const std::vector<int> &GetBlockTable(int layer) const {
+    return layers_[layer].block_table;
+  }
+
+  // Returns how many block tables (of layers or saved prefixes) reference
+  // `block`.
+  int GetBlockRefCount(int block) const { return ref_counts_[block]; }
+
+  // Saves the first `num_entries` entries of every layer under `prefix_id`,
+  // replacing any prefix saved under the same id. No data is copied, the
+  // blocks are shared until either side writes to them.
+  TfLiteStatus SavePrefix(int prefix_id, int64_t num_entries);
+  // Replaces the state of every layer with the prefix saved under
+  // `prefix_id`. Returns an error if there is no such prefix.
+  TfLiteStatus LoadPrefix(int prefix_id);
+  // Forgets `prefix_id`, releasing the blocks only it references.
+  void ErasePrefix(int prefix_id);
+  bool HasPrefix(int prefix_id) const { return prefixes_.count(prefix_id); }
+
+ private:
+  struct Layer {
+    // Physical block index for each logical block, -1 if not yet allocated.
+    std::vector<int> block_table;
+    // Offset of entry 0 inside the first logical block.
+    int64_t first_entry_offset = 0;
+    // Absolute position of entry 0.
+    int64_t first_position = 0;
+    size_t num_entries = 0;
+  };
+
+  int AllocateBlock();
+  void ReleaseBlock(int block);
+  // Takes a reference to all blocks in `layer`.
+  void RetainBlocks(const Layer &layer);
+  // Drops the references of `layer` to its blocks.
+  void ReleaseBlocks(Layer &layer);
+
+  bool is_initialized_ = false;
+  int block_size_ = 0;
+  int max_num_blocks_ = 0;
+  int entry_size_ = 0;
+  std::vector<Layer> layers_;
+  // The physical blocks. Each block holds `block_size_ * entry_size_` floats,
+  // or is null once freed.
+  std::vector<std::unique_ptr<float[]>> blocks_;
+  // Number of block tables referencing each block in `blocks_`.
+  std::vector<int> ref_counts_;
+  // Indices into `blocks_` of the freed blocks, reused by AllocateBlock().
+  std::vector<int> free_blocks_;
+  int num_allocated_blocks_ = 0;
+  // See GatherView().
+  std::vector<float> view_;
+  // Saved prefixes, holding one entry per layer.
+  std::unordered_map<int, std::vector<Layer>> prefixes_;
+};
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
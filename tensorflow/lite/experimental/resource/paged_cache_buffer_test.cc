@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace resource {
+
+TEST(PagedCacheBufferTest, AllocatesBlocksLazily) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/2, /*block_size=*/4,
+                                    /*max_num_blocks=*/8, /*entry_size=*/3),
+            kTfLiteOk);
+
+  EXPECT_TRUE(cache_buffer.IsInitialized());
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), 0);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 8);
+
+  // Entry 5 lives in the second logical block; only that block is allocated.
+  float* entry = cache_buffer.GetOrAllocateEntry(0, 5);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(cache_buffer.GetNumAllocatedBlocks(), 1);
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), 4 * 3 * sizeof(float));
+  EXPECT_EQ(cache_buffer.GetEntry(0, 0), nullptr);
+  EXPECT_EQ(cache_buffer.GetEntry(0, 5), entry);
+  EXPECT_EQ(cache_buffer.GetBlockTable(0).size(), 2);
+  EXPECT_EQ(cache_buffer.GetBlockTable(1).size(), 0);
+}
+
+TEST(PagedCacheBufferTest, GatherAcrossBlocks) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(1, 2, 4, 2), kTfLiteOk);
+  for (int i = 0; i < 5; ++i) {
+    float* entry = cache_buffer.GetOrAllocateEntry(0, i);
+    ASSERT_NE(entry, nullptr);
+    entry[0] = i;
+    entry[1] = 10 * i;
+  }
+  cache_buffer.SetNumEntries(0, 5);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0), 5);
+
+  std::vector<float> dst(10);
+  cache_buffer.Gather(0, 5, dst.data());
+  EXPECT_EQ(dst, std::vector<float>({0, 0, 1, 10, 2, 20, 3, 30, 4, 40}));
+}
+
+TEST(PagedCacheBufferTest, DropFrontEntriesReleasesBlocks) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(1, 2, 3, 1), kTfLiteOk);
+  for (int i = 0; i < 6; ++i) {
+    *cache_buffer.GetOrAllocateEntry(0, i) = i;
+  }
+  cache_buffer.SetNumEntries(0, 6);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 0);
+  EXPECT_EQ(cache_buffer.GetOrAllocateEntry(0, 6), nullptr);
+
+  cache_buffer.DropFrontEntries(0, 3);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0), 3);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 1);
+  EXPECT_EQ(*cache_buffer.GetEntry(0, 0), 3);
+
+  // The released block is reused for new entries.
+  float* entry = cache_buffer.GetOrAllocateEntry(0, 3);
+  ASSERT_NE(entry, nullptr);
+  *entry = 6;
+  cache_buffer.SetNumEntries(0, 4);
+  std::vector<float> dst(4);
+  cache_buffer.Gather(0, 4, dst.data());
+  EXPECT_EQ(dst, std::vector<float>({3, 4, 5, 6}));
+  EXPECT_EQ(cache_buffer.GetNumAllocatedBlocks(), 3);
+}
+
+TEST(PagedCacheBufferTest, SetNumEntriesReleasesTrailingBlocks) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(1, 2, 4, 1), kTfLiteOk);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(cache_buffer.GetOrAllocateEntry(0, i), nullptr);
+  }
+  cache_buffer.SetNumEntries(0, 3);
+  EXPECT_EQ(cache_buffer.GetBlockTable(0).size(), 2);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 2);
+}
+
+TEST(PagedCacheBufferTest, MemoryUsageTracksUsedEntries) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/2, /*block_size=*/4,
+                                    /*max_num_blocks=*/64, /*entry_size=*/3),
+            kTfLiteOk);
+  const size_t block_bytes = 4 * 3 * sizeof(float);
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_NE(cache_buffer.GetOrAllocateEntry(0, i), nullptr);
+  }
+  cache_buffer.SetNumEntries(0, 16);
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), 4 * block_bytes);
+
+  // Released blocks are freed rather than kept for reuse.
+  cache_buffer.SetNumEntries(0, 4);
+  EXPECT_EQ(cache_buffer.GetNumAllocatedBlocks(), 1);
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), block_bytes);
+  cache_buffer.DropFrontEntries(0, 4);
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), 0);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 64);
+}
+
+TEST(PagedCacheBufferTest, GatherViewHoldsOnlyGatheredEntries) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(2, 2, 8, 1), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    *cache_buffer.GetOrAllocateEntry(0, i) = i;
+    *cache_buffer.GetOrAllocateEntry(1, i) = 10 * i;
+  }
+  const size_t blocks_bytes = cache_buffer.GetMemoryUsage();
+
+  const float* view = cache_buffer.GatherView(0, 3);
+  EXPECT_EQ(std::vector<float>(view, view + 3),
+            std::vector<float>({0, 1, 2}));
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), blocks_bytes + 3 * sizeof(float));
+
+  // All layers share the view.
+  view = cache_buffer.GatherView(1, 2);
+  EXPECT_EQ(std::vector<float>(view, view + 2), std::vector<float>({0, 10}));
+  EXPECT_LE(cache_buffer.GetMemoryUsage(), blocks_bytes + 3 * sizeof(float));
+}
+
+TEST(PagedCacheBufferTest, LoadPrefixSharesBlocks) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(1, 2, 8, 1), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    *cache_buffer.GetOrAllocateEntry(0, i) = i;
+  }
+  cache_buffer.SetNumEntries(0, 4);
+  ASSERT_EQ(cache_buffer.SavePrefix(/*prefix_id=*/7, 3), kTfLiteOk);
+  EXPECT_TRUE(cache_buffer.HasPrefix(7));
+  EXPECT_EQ(cache_buffer.SavePrefix(8, 5), kTfLiteError);
+  EXPECT_EQ(cache_buffer.GetBlockRefCount(cache_buffer.GetBlockTable(0)[0]),
+            2);
+
+  // Diverge after the prefix, then start another sequence from it.
+  *cache_buffer.GetOrAllocateEntry(0, 3) = 30;
+  ASSERT_EQ(cache_buffer.LoadPrefix(7), kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0), 3);
+  std::vector<float> dst(3);
+  cache_buffer.Gather(0, 3, dst.data());
+  EXPECT_EQ(dst, std::vector<float>({0, 1, 2}));
+  // The copy of the diverged block is freed, only the prefix blocks remain.
+  EXPECT_EQ(cache_buffer.GetNumAllocatedBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 6);
+
+  // Writing into the shared block copies it and leaves the prefix intact.
+  const int shared_block = cache_buffer.GetBlockTable(0)[1];
+  *cache_buffer.GetOrAllocateEntry(0, 3) = 40;
+  EXPECT_NE(cache_buffer.GetBlockTable(0)[1], shared_block);
+  EXPECT_EQ(cache_buffer.GetBlockRefCount(shared_block), 1);
+  EXPECT_EQ(*cache_buffer.GetEntry(0, 2), 2);
+  ASSERT_EQ(cache_buffer.LoadPrefix(7), kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetBlockTable(0)[1], shared_block);
+
+  cache_buffer.ErasePrefix(7);
+  EXPECT_FALSE(cache_buffer.HasPrefix(7));
+  EXPECT_EQ(cache_buffer.LoadPrefix(7), kTfLiteError);
+  EXPECT_EQ(cache_buffer.GetBlockRefCount(shared_block), 1);
+}
+
+}  // namespace resource
+}  // namespace tflite
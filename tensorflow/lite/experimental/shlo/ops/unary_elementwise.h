@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_UNARY_ELEMENTWISE_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_UNARY_ELEMENTWISE_H_
 
+#include <array>
 #include <cstddef>
 
 #include "absl/algorithm/container.h"
@@ -118,6 +119,29 @@ void DequantizeOpQuantizePerTensor(F& func, const Tensor& input,
   const StorageT* input_data = input.GetDataAs<storage_type>();
   StorageT* output_data = output.GetDataAs<storage_type>();
   const ExpressedT inv_scale = static_cast<ExpressedT>(1) / output_scale;
+  // 8-bit and narrower inputs only take a few values: computes the result of
+  // each of them once and looks the results up, instead of dequantizing,
+  // evaluating and quantizing every element.
+  if constexpr (sizeof(StorageT) == 1) {
+    constexpr int kMinValue =
+        static_cast<int>(Storage<storage_type>::kMinValue);
+    constexpr int kNumValues =
+        static_cast<int>(Storage<storage_type>::kMaxValue) - kMinValue + 1;
+    if (num_elements > kNumValues) {
+      std::array<StorageT, kNumValues> results;
+      for (int v = 0; v < kNumValues; ++v) {
+        const ExpressedT dequantized_input = Dequantize(
+            static_cast<StorageT>(v + kMinValue), input_zero_point,
+            input_scale);
+        results[v] = Quantize<storage_type, expressed_type>(
+            func(dequantized_input), output_zero_point, inv_scale);
+      }
+      for (DimensionSize i = 0; i < num_elements; ++i) {
+        output_data[i] = results[static_cast<int>(input_data[i]) - kMinValue];
+      }
+      return;
+    }
+  }
   for (DimensionSize i = 0; i < num_elements;
        ++i, ++input_data, ++output_data) {
     const ExpressedT dequantized_input =
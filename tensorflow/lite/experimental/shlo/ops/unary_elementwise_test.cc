@@ -81,11 +81,11 @@ struct QuantizedUnaryElementWiseTest : ::testing::Test {};
 
 TYPED_TEST_SUITE(QuantizedUnaryElementWiseTest, QuantizedTestTypes);
 
-TYPED_TEST(QuantizedUnaryElementWiseTest, QuantizedPerTensorWithAbs) {
+template <class TypeParam>
+void TestQuantizedPerTensorWithAbs(const Shape& shape) {
   using StorageT = typename TypeParam::StorageT;
   using ExpressedT = typename TypeParam::ExpressedT;
 
-  const Shape shape({2, 3, 4});
   Vector<StorageT> input_data = RandomBuffer<TypeParam::kStorage>(shape);
   Vector<StorageT> output_data(shape.NumElements());
   const ExpressedT scale = static_cast<ExpressedT>(1.5);
@@ -117,6 +117,15 @@ TYPED_TEST(QuantizedUnaryElementWiseTest, QuantizedPerTensorWithAbs) {
   EXPECT_THAT(output_data, ElementsAreArray(expected_data));
 }
 
+TYPED_TEST(QuantizedUnaryElementWiseTest, QuantizedPerTensorWithAbs) {
+  TestQuantizedPerTensorWithAbs<TypeParam>(Shape({2, 3, 4}));
+}
+
+// Large 8-bit tensors are evaluated through a table of the results.
+TYPED_TEST(QuantizedUnaryElementWiseTest, LargeQuantizedPerTensorWithAbs) {
+  TestQuantizedPerTensorWithAbs<TypeParam>(Shape({4, 16, 16}));
+}
+
 TYPED_TEST(QuantizedUnaryElementWiseTest, QuantizedPerAxisWithAbs) {
   using StorageT = typename TypeParam::StorageT;
   using ExpressedT = typename TypeParam::ExpressedT;
@@ -37,4 +37,17 @@ ExternalCpuBackendContext::ExternalCpuBackendContext()
   this->Refresh = RefreshExternalCpuBackendContext;
 }
 
+ScopedCpuBackendContextInvocation::ScopedCpuBackendContextInvocation(
+    TfLiteContext* context) {
+  auto* const external_context = static_cast<ExternalCpuBackendContext*>(
+      context->GetExternalContext(context, kTfLiteCpuBackendContext));
+  if (external_context == nullptr ||
+      !external_context->serialize_invocations()) {
+    return;
+  }
+  lock_ = std::unique_lock<std::mutex>(external_context->invocation_mutex_);
+  // Another interpreter sharing the context may have changed its #thread info.
+  RefreshExternalCpuBackendContext(context);
+}
+
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <utility>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -73,6 +74,14 @@ class TfLiteInternalBackendContext {
 // interpreters, don't call 'SetNumThreads' consecutively but call it
 // separately between each interpreter's invocation as illustrated above.
 //
+// Alternatively, the context-sharing interpreters can take turns by calling
+// 'set_serialize_invocations(true)' on the context. Each invocation then holds
+// the context until it finishes, and refreshes the #thread info with the one
+// of the invoking interpreter first, so that the interpreters can be invoked
+// simultaneously from several threads and each of them keeps its own number of
+// threads, without oversubscribing the cores. Other calls, like
+// 'AllocateTensors', must still be serialized by the user.
+//
 // Note: it is the responsibility of the user of this context (i.e. a
 // TFLiteInterpreter) to clear any state from the internal backend
 // context if/when the interpreter no longer needs the shared context.
@@ -92,15 +101,46 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // Sets whether the invocations of the interpreters sharing this context are
+  // serialized, see above. Must not be changed while an interpreter using the
+  // context is being invoked.
+  void set_serialize_invocations(bool serialize_invocations) {
+    serialize_invocations_ = serialize_invocations;
+  }
+
+  bool serialize_invocations() const { return serialize_invocations_; }
+
  private:
+  friend class ScopedCpuBackendContextInvocation;
+
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
 
+  bool serialize_invocations_ = false;
+  // Held by the invocation using the context if invocations are serialized.
+  std::mutex invocation_mutex_;
+
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
       delete;
 };
 
+// Holds the ExternalCpuBackendContext of `context` during an invocation, if
+// the context serializes the invocations of the interpreters sharing it, and
+// refreshes its #thread info with the one of `context`.
+class ScopedCpuBackendContextInvocation {
+ public:
+  explicit ScopedCpuBackendContextInvocation(TfLiteContext* context);
+
+ private:
+  std::unique_lock<std::mutex> lock_;
+
+  ScopedCpuBackendContextInvocation(const ScopedCpuBackendContextInvocation&) =
+      delete;
+  ScopedCpuBackendContextInvocation& operator=(
+      const ScopedCpuBackendContextInvocation&) = delete;
+};
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
@@ -103,12 +103,77 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  // If set to `true`, the then and else branch subgraphs of an IF op share a
+  // single arena for their non-persistent tensors, since only one of them runs
+  // at a time. This reduces the memory of models with many control flow
+  // subgraphs, at the cost of re-resolving tensor pointers when switching
+  // between the branches. It has no effect if all tensors are preserved.
+  // Branches which contain control flow ops themselves don't share arenas, and
+  // a branch subgraph must not be invoked by other ops than the IF op.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetShareControlFlowArenas(bool value = true) {
+    experimental_share_control_flow_arenas_ = value;
+  }
+
+  // Returns if the `experimental_share_control_flow_arenas_` feature is
+  // enabled.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetShareControlFlowArenas() const {
+    return experimental_share_control_flow_arenas_;
+  }
+
+  // Sets the number of threads used to invoke independent ops of a subgraph
+  // concurrently. Ops are invoked one after the other by default, i.e. if
+  // `value` is 1 or less. Ops are only invoked concurrently in subgraphs
+  // without dynamic tensors or profilers, and a delegate kernel, a custom op,
+  // a control flow op or an op using variables or resources is never invoked
+  // together with other ops. Each thread uses its own CPU backend context, so
+  // that ops may use up to `value` times the number of threads set on the
+  // interpreter.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int value) {
+    experimental_num_inter_op_threads_ = value;
+  }
+
+  // Returns the number of threads used to invoke independent ops
+  // concurrently.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() const {
+    return experimental_num_inter_op_threads_;
+  }
+
+  // If set to `true`, the non-persistent arena of a signature is released
+  // when the tensors of another signature are allocated through its
+  // SignatureRunner, so that models with many signatures only hold the arena
+  // of the one in use. A released signature keeps its memory plan, and its
+  // `AllocateTensors()` must be called again before it is invoked.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetReleaseIdleSignatureMemory(bool value = true) {
+    experimental_release_idle_signature_memory_ = value;
+  }
+
+  // Returns if the `experimental_release_idle_signature_memory_` feature is
+  // enabled.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetReleaseIdleSignatureMemory() const {
+    return experimental_release_idle_signature_memory_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  bool experimental_share_control_flow_arenas_ = false;
+  int experimental_num_inter_op_threads_ = 1;
+  bool experimental_release_idle_signature_memory_ = false;
 };
 
 }  // namespace tflite
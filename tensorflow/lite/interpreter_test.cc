@@ -1263,6 +1263,50 @@ TEST_F(InterpreterTest, ExternalBackendContextClearsCachesOnDelete) {
   EXPECT_EQ(cpu_backend_context->num_calls, 1);
 }
 
+TEST_F(InterpreterTest, ExternalBackendContextSerializesInvocations) {
+  struct ThreadCountingBackendContext : public TfLiteInternalBackendContext {
+    void ClearCaches() override {}
+    void SetMaxNumThreads(int num_threads) override {
+      max_num_threads = num_threads;
+    }
+    int max_num_threads = -1;
+  };
+  ExternalCpuBackendContext external_cpu_context;
+  external_cpu_context.set_serialize_invocations(true);
+  auto* backend_context = new ThreadCountingBackendContext();
+  external_cpu_context.set_internal_backend_context(
+      std::unique_ptr<TfLiteInternalBackendContext>(backend_context));
+
+  std::vector<std::unique_ptr<Interpreter>> interpreters;
+  for (int num_threads : {2, 4}) {
+    interpreters.push_back(std::make_unique<Interpreter>());
+    Interpreter* interpreter = interpreters.back().get();
+    interpreter->SetExternalContext(kTfLiteCpuBackendContext,
+                                    &external_cpu_context);
+    ASSERT_EQ(interpreter->SetNumThreads(num_threads), kTfLiteOk);
+    interpreter->SetInputs({});
+    interpreter->SetOutputs({});
+    ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  }
+  EXPECT_EQ(backend_context->max_num_threads, 4);
+
+  // Each invocation uses the number of threads of its interpreter.
+  ASSERT_EQ(interpreters[0]->Invoke(), kTfLiteOk);
+  EXPECT_EQ(backend_context->max_num_threads, 2);
+  ASSERT_EQ(interpreters[1]->Invoke(), kTfLiteOk);
+  EXPECT_EQ(backend_context->max_num_threads, 4);
+
+  std::vector<std::thread> threads;
+  for (auto& interpreter : interpreters) {
+    threads.emplace_back([&interpreter]() {
+      for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+}
+
 // Test fixture that allows playing with execution plans. It creates a two
 // node graph that can be executed in either [0,1] order or [1,0] order.
 // The CopyOp records when it is invoked in the class member run_order_
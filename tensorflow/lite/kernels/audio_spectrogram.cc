@@ -17,6 +17,7 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
@@ -44,8 +45,14 @@ typedef struct {
   int window_size;
   int stride;
   bool magnitude_squared;
+  // If true, each invocation gets the `stride * output_height` samples that
+  // follow the ones of the previous invocation, and only computes the frames
+  // ending in them, keeping the samples of the overlapping windows in
+  // `channel_spectrograms`. The samples before the first invocation are zeros.
+  bool stateful;
   int output_height;
   internal::Spectrogram* spectrogram;
+  std::vector<internal::Spectrogram> channel_spectrograms;
 } TfLiteAudioSpectrogramParams;
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -57,6 +64,7 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   data->window_size = m["window_size"].AsInt64();
   data->stride = m["stride"].AsInt64();
   data->magnitude_squared = m["magnitude_squared"].AsBool();
+  data->stateful = m["stateful"].AsBool();
 
   data->spectrogram = new internal::Spectrogram;
 
@@ -90,11 +98,30 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, params->spectrogram->Initialize(params->window_size,
                                                           params->stride));
   const int64_t sample_count = input->dims->data[0];
-  const int64_t length_minus_window = (sample_count - params->window_size);
-  if (length_minus_window < 0) {
-    params->output_height = 0;
+  if (params->stateful) {
+    TF_LITE_ENSURE_MSG(context, sample_count % params->stride == 0,
+                       "Stateful audio spectrograms need a whole number of "
+                       "strides of samples.");
+    params->output_height = sample_count / params->stride;
+    // (Re)starts the streams with zeros, so that every stride of samples ends
+    // a window.
+    const std::vector<float> initial_samples(
+        std::max(params->window_size - params->stride, 0), 0.0f);
+    std::vector<std::vector<float>> initial_output;
+    params->channel_spectrograms.resize(input->dims->data[1]);
+    for (internal::Spectrogram& spectrogram : params->channel_spectrograms) {
+      TF_LITE_ENSURE(context, spectrogram.Initialize(params->window_size,
+                                                     params->stride));
+      TF_LITE_ENSURE(context, spectrogram.ComputeSquaredMagnitudeSpectrogram(
+                                  initial_samples, &initial_output));
+    }
   } else {
-    params->output_height = 1 + (length_minus_window / params->stride);
+    const int64_t length_minus_window = (sample_count - params->window_size);
+    if (length_minus_window < 0) {
+      params->output_height = 0;
+    } else {
+      params->output_height = 1 + (length_minus_window / params->stride);
+    }
   }
   TfLiteIntArray* output_size = TfLiteIntArrayCreate(3);
   output_size->data[0] = input->dims->data[1];
@@ -132,11 +159,15 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       input_for_channel[i] = input_data[i * channel_count + channel];
     }
     std::vector<std::vector<float>> spectrogram_output;
-    TF_LITE_ENSURE(context, params->spectrogram->Initialize(params->window_size,
-                                                            params->stride));
-    TF_LITE_ENSURE(context,
-                   params->spectrogram->ComputeSquaredMagnitudeSpectrogram(
-                       input_for_channel, &spectrogram_output));
+    internal::Spectrogram* spectrogram = params->spectrogram;
+    if (params->stateful) {
+      spectrogram = &params->channel_spectrograms[channel];
+    } else {
+      // Keeps the FFT working areas of the previous channels and invocations.
+      spectrogram->Reset();
+    }
+    TF_LITE_ENSURE(context, spectrogram->ComputeSquaredMagnitudeSpectrogram(
+                                input_for_channel, &spectrogram_output));
     TF_LITE_ENSURE_EQ(context, spectrogram_output.size(),
                       params->output_height);
     TF_LITE_ENSURE(context, spectrogram_output.empty() ||
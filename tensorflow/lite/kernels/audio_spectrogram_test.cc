@@ -36,7 +36,8 @@ class BaseAudioSpectrogramOpModel : public SingleOpModel {
  public:
   BaseAudioSpectrogramOpModel(const TensorData& input1,
                               const TensorData& output, int window_size,
-                              int stride, bool magnitude_squared) {
+                              int stride, bool magnitude_squared,
+                              bool stateful = false) {
     input1_ = AddInput(input1);
     output_ = AddOutput(output);
 
@@ -45,6 +46,7 @@ class BaseAudioSpectrogramOpModel : public SingleOpModel {
       fbb.Int("window_size", window_size);
       fbb.Int("stride", stride);
       fbb.Bool("magnitude_squared", magnitude_squared);
+      fbb.Bool("stateful", stateful);
     });
     fbb.Finish();
     SetCustomOp("AudioSpectrogram", fbb.GetBuffer(),
@@ -107,6 +109,35 @@ TEST(SpectrogramOpTest, StrideTest) {
                                  {0, 1, 4, 1, 0, 1, 2, 1, 2, 1}, 1e-3)));
 }
 
+TEST(SpectrogramOpTest, StatefulTest) {
+  const std::vector<float> samples = {-1.0f, 0.0f, 1.0f, 0.0f,
+                                      -1.0f, 0.0f, 1.0f, 1.0f};
+  // The stream starts with the samples of a window minus a stride of zeros.
+  std::vector<float> padded_samples(6, 0.0f);
+  padded_samples.insert(padded_samples.end(), samples.begin(), samples.end());
+  BaseAudioSpectrogramOpModel full({TensorType_FLOAT32, {14, 1}},
+                                   {TensorType_FLOAT32, {}}, 8, 2, true);
+  full.PopulateTensor<float>(full.input1(), padded_samples);
+  ASSERT_EQ(full.Invoke(), kTfLiteOk);
+  EXPECT_THAT(full.GetOutputShape(), ElementsAre(1, 4, 5));
+  const std::vector<float> full_output = full.GetOutput();
+
+  BaseAudioSpectrogramOpModel m({TensorType_FLOAT32, {4, 1}},
+                                {TensorType_FLOAT32, {}}, 8, 2, true,
+                                /*stateful=*/true);
+  std::vector<float> output;
+  for (int i = 0; i < 2; ++i) {
+    m.PopulateTensor<float>(
+        m.input1(), std::vector<float>(samples.begin() + 4 * i,
+                                       samples.begin() + 4 * (i + 1)));
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(1, 2, 5));
+    const std::vector<float> frames = m.GetOutput();
+    output.insert(output.end(), frames.begin(), frames.end());
+  }
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(full_output, 1e-5)));
+}
+
 }  // namespace
 }  // namespace custom
 }  // namespace ops
@@ -65,6 +65,8 @@ struct OpData {
   int scratch_tensor_index;
   bool rhs_transposed;
   bool compute_row_sums = false;
+  // Size of the blocks of a block-wise quantized hybrid RHS, 0 otherwise.
+  int block_size = 0;
 };
 
 struct OpContext {
@@ -351,6 +353,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, (lhs_data->type == kTfLiteFloat32 &&
                            rhs_data->type == kTfLiteInt8) ||
                               lhs_data->type == rhs_data->type);
+  // Block-wise quantization is only supported for an adjoint hybrid RHS, which
+  // is laid out like the filter of FULLY_CONNECTED: [output_channels, accum].
+  op_data->block_size =
+      lhs_data->type == kTfLiteFloat32 && rhs_data->type == kTfLiteInt8 && adj_y
+          ? GetBlockwiseQuantizationBlockSize(rhs_data)
+          : 0;
   // Support dimensions between 2 and 5, inclusive.
   TF_LITE_ENSURE(context, NumDimensions(lhs_data) >= 2);
   TF_LITE_ENSURE(context, NumDimensions(lhs_data) <= 5);
@@ -483,10 +491,6 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                                     input_size, quant_data, scaling_factors_ptr,
                                     input_offset_ptr,
                                     params->asymmetric_quantize_inputs);
-  for (int b = 0; b < num_batches_to_quantize; ++b) {
-    // Incorporate scaling of the filter.
-    scaling_factors_ptr[b] *= filter->params.scale;
-  }
 
   RuntimeShape output_shape = GetTensorShape(output);
   int output_size = 1;
@@ -494,6 +498,22 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
     output_size *= output_shape.Dims(i);
   }
   std::fill_n(GetTensorData<float>(output), output_size, 0.0f);
+  if (data->block_size > 0) {
+    // The RHS is 2D, so all batches are multiplied with the same filter.
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            filter->quantization.params);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulateBlockwise(
+        filter_data, filter_shape.Dims(0), input_size, quant_data,
+        scaling_factors_ptr, num_batches_to_quantize,
+        affine_quantization->scale->data, data->block_size, input_offset_ptr,
+        GetTensorData<float>(output));
+    return kTfLiteOk;
+  }
+  for (int b = 0; b < num_batches_to_quantize; ++b) {
+    // Incorporate scaling of the filter.
+    scaling_factors_ptr[b] *= filter->params.scale;
+  }
   if (kernel_type == kGenericOptimized) {
     optimized_ops::BatchMatMul(
         filter_shape, filter_data, input_shape, quant_data, scaling_factors_ptr,
@@ -463,6 +463,11 @@ class HybridBatchMatMulOpModel : public SingleOpModel {
     AllocateAndDelegate(true);
   }
 
+  void SetQuantizedWeights(const std::vector<int8_t>& data) {
+    PopulateTensor(rhs_id_, data);
+    AllocateAndDelegate(true);
+  }
+
   void SetInput(const std::vector<float>& f) { PopulateTensor(lhs_id_, f); }
   std::vector<float> GetOutput() { return ExtractVector<float>(output_id_); }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_id_); }
@@ -521,6 +526,56 @@ TEST_P(HybridAsymmetricBatchMatMulOpTest, SimpleTestQuantizedInt8) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3}));
 }
 
+TEST_P(HybridAsymmetricBatchMatMulOpTest, BlockwiseQuantizedInt8) {
+  constexpr int kUnits = 2;
+  constexpr int kBatches = 2;
+  constexpr int kInputSize = 8;
+  constexpr int kBlockSize = 4;
+  const std::vector<int8_t> weights = {
+      1, 2, 3, 4, 5,  6,  7,  8,   // unit 0
+      1, 1, 1, 1, -1, -1, -1, -1,  // unit 1
+  };
+  const std::vector<float> scales = {0.5, 1.0, 0.25, 2.0};
+  const std::vector<float> input = {
+      127,  1, 2, 3, 4, 5, 6, 7,    // batch 0
+      -127, 0, 0, 0, 0, 0, 0, 127,  // batch 1
+  };
+
+  // Reference result using the dequantized RHS.
+  std::vector<float> expected(kBatches * kUnits, 0.0f);
+  for (int b = 0; b < kBatches; ++b) {
+    for (int u = 0; u < kUnits; ++u) {
+      for (int i = 0; i < kInputSize; ++i) {
+        const float scale =
+            scales[u * (kInputSize / kBlockSize) + i / kBlockSize];
+        expected[b * kUnits + u] +=
+            input[b * kInputSize + i] * weights[u * kInputSize + i] * scale;
+      }
+    }
+  }
+
+  // With adj_y the RHS is laid out as [units, input_size], and each unit has
+  // one scale per block of kBlockSize input values.
+  HybridBatchMatMulOpModel m(
+      kUnits, kBatches,
+      /*lhs=*/{TensorType_FLOAT32, {kBatches, kInputSize}},
+      /*rhs=*/
+      {TensorType_INT8, {kUnits, kInputSize}, 0, 0, 0.0f, 0, true, scales,
+       std::vector<int64_t>(scales.size(), 0)},
+      /*output=*/{TensorType_FLOAT32}, /*asymmetric_quantize_inputs=*/true,
+      /*adj_x=*/false, /*adj_y=*/true);
+
+  m.SetQuantizedWeights(weights);
+  m.SetInput(input);
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(expected,
+                                              /*max_abs_error=*/1e-2f)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({kBatches, kUnits}));
+}
+
 TEST_P(HybridAsymmetricBatchMatMulOpTest, MultipleNumBatchQuantizedInt8) {
   // need 4 scale factors
   HybridBatchMatMulOpModel m(
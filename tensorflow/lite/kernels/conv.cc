@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/structured_sparsity.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -122,6 +123,13 @@ struct OpData {
   // Number of convolution groups.
   int32_t groups = 1;
 
+  // Packed copy of a constant float filter with N:M structured sparsity,
+  // only set while the structured sparse kernel is used.
+  std::unique_ptr<optimized_ops::StructuredSparseMatrix>
+      structured_sparse_filter = nullptr;
+  // Set once the filter was found to have no N:M structured sparsity.
+  bool structured_sparsity_rejected = false;
+
   TfLiteType quantized_bias_type = kTfLiteNoType;
 };
 
@@ -503,6 +511,35 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
 
   if (output_status != kTfLiteOk) return output_status;
 
+  // Constant float filters with N:M structured sparsity are packed for the
+  // structured sparse kernel. EvalFloat only uses it on the generic optimized
+  // path, for GEMMs with few rows.
+  const bool uses_generic_optimized_kernel =
+      kernel_type == kGenericOptimized || kernel_type == kCblasOptimized ||
+      (kernel_type == kMultithreadOptimized &&
+       !data->supports_multithreaded_kernel);
+  if (uses_generic_optimized_kernel && !data->im2col_oversized &&
+      input_type == kTfLiteFloat32 && filter->type == kTfLiteFloat32 &&
+      data->groups == 1 && NumElements(filter) > 0 &&
+      IsConstantTensor(filter) &&
+      static_cast<int64_t>(batches) * out_height * out_width <=
+          optimized_ops::kStructuredSparseMaxBatches) {
+    if (!data->structured_sparse_filter &&
+        !data->structured_sparsity_rejected) {
+      auto packed_filter =
+          std::make_unique<optimized_ops::StructuredSparseMatrix>();
+      if (optimized_ops::PackStructuredSparseMatrix(
+              GetTensorData<float>(filter), channels_out,
+              NumElements(filter) / channels_out, packed_filter.get())) {
+        data->structured_sparse_filter = std::move(packed_filter);
+      } else {
+        data->structured_sparsity_rejected = true;
+      }
+    }
+  } else {
+    data->structured_sparse_filter.reset();
+  }
+
   if (data->need_im2col) {
     node->temporaries->data[data->im2col_index] = data->im2col_id;
 
@@ -964,6 +1001,18 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
     }
     case kCblasOptimized:
     case kGenericOptimized: {
+      if (data->structured_sparse_filter &&
+          FlatSizeSkipDim(GetTensorShape(output), 3) <=
+              optimized_ops::kStructuredSparseMaxBatches) {
+        optimized_ops::ConvStructuredSparseWeight(
+            op_params, GetTensorShape(input), GetTensorData<float>(input),
+            GetTensorShape(filter), *data->structured_sparse_filter,
+            GetTensorData<float>(bias), GetTensorShape(output),
+            GetTensorData<float>(output), GetTensorShape(im2col),
+            GetTensorData<float>(im2col),
+            CpuBackendContext::GetFromContext(context));
+        break;
+      }
       optimized_ops::Conv(op_params, GetTensorShape(input),
                           GetTensorData<float>(input), GetTensorShape(filter),
                           GetTensorData<float>(filter), GetTensorShape(bias),
@@ -672,6 +672,54 @@ TEST_P(ConvolutionOpTest, HandCalculatedFloat32WithConstFilter) {
   }
 }
 
+// A constant filter where every group of 4 weights has at most 2 non-zeros
+// takes the structured sparse kernel of the generic optimized path when there
+// are few output pixels. It must match the dense kernel, which runs for the
+// same filter given as a non-constant input.
+TEST_P(ConvolutionOpTest, StructuredSparseConstFilterMatchesDense) {
+  // clang-format off
+  const std::initializer_list<float> filter_data = {
+      // First 2x2x4 filter.
+      1, 0, 2, 0,   0, 3, 0, -1,
+      0, 0, 4, 5,   -2, 0, 0, 1,
+      // Second 2x2x4 filter.
+      0, 1, 0, 0,   2, 0, 0, -3,
+      1, 1, 0, 0,   0, 0, -1, 2,
+  };
+  const std::initializer_list<float> input_data = {
+      1,  -2, 3,  4,   5,  6,  -7, 8,   9,  10, 11, -12,
+      13, 14, -15, 16, 17, 18, 19, 20,  -21, 22, 23, 24,
+      25, 26, 27, -28, 29, -30, 31, 32, 33, 34, 35, 36,
+  };
+  // clang-format on
+  const TensorData input = {TensorType_FLOAT32, {1, 3, 3, 4}};
+  const TensorData filter = {TensorType_FLOAT32, {2, 2, 2, 4}};
+  ConvolutionOpModel sparse(GetRegistration(), input, filter,
+                            {TensorType_FLOAT32, {}}, /*stride_width=*/1,
+                            /*stride_height=*/1, Padding_VALID,
+                            ActivationFunctionType_NONE,
+                            /*dilation_width_factor=*/1,
+                            /*dilation_height_factor=*/1,
+                            /*num_threads=*/-1, filter_data);
+  sparse.SetInput(input_data);
+  sparse.SetBias({1, -1});
+  ASSERT_EQ(sparse.Invoke(), kTfLiteOk);
+
+  ConvolutionOpModel dense(GetRegistration(), input, filter,
+                           {TensorType_FLOAT32, {}}, /*stride_width=*/1,
+                           /*stride_height=*/1, Padding_VALID);
+  dense.SetInput(input_data);
+  dense.SetFilter(filter_data);
+  dense.SetBias({1, -1});
+  ASSERT_EQ(dense.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(sparse.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(dense.GetOutput())));
+  // First output channel of the top left pixel:
+  // (1 + 6) + (18 - 8) + (-60 + 80) + (-34 + 20) + 1 = 24.
+  EXPECT_FLOAT_EQ(sparse.GetOutput()[0], 24);
+}
+
 TEST_P(ConvolutionOpTest, HandCalculatedWithBiasFloat32) {
   const int depth = 1;
   const int image_width = 4;
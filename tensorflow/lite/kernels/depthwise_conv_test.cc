@@ -471,6 +471,34 @@ TEST_P(DepthwiseConvolutionOpTest, MultithreadSimpleDilatedTestPaddingSame) {
   SimpleDilatedTestPaddingSame(GetRegistration(), /*num_thread=*/4);
 }
 
+// Exercises the kernels with a variable input depth and a depth multiplier of
+// 4, with dilation.
+TEST_P(DepthwiseConvolutionOpTest, DilatedDepthMultiplier4Test) {
+  DepthwiseConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {1, 3, 3, 5}},
+      {TensorType_FLOAT32, {1, 2, 2, 20}}, {TensorType_FLOAT32, {}},
+      Padding_VALID, /*dilation_factor=*/2);
+
+  // Every pixel of the image is [1, 2, 3, 4, 5].
+  m.SetInput({1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5,
+              1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5,
+              1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5});
+  // Every tap of the filter is [1, 2, 3, 4] for each input channel.
+  m.SetFilter({1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,
+               1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,
+               1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,
+               1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4});
+  m.SetBias({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+  m.SetNumThreads(2);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  // The dilated 2x2 filter reads the corners of the image, so output channel
+  // c * 4 + k is 4 * (c + 1) * (k + 1).
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray({4,  8,  12, 16, 8,  16, 24, 32, 12, 24,
+                                36, 48, 16, 32, 48, 64, 20, 40, 60, 80}));
+}
+
 void BatchPaddingValidTest(TfLiteRegistration* registration, int num_thread) {
   const int input_batch = 2;
   const int input_width = 3;
@@ -1816,6 +1844,100 @@ TEST_P(PerChannelQuantizedDepthwiseConvolutionOpTest,
               ElementsAreArray({85, 95, 41, 43, 5, -9, -61, -73}));
 }
 
+// Exercises the int8 kernel with a variable input depth and a depth
+// multiplier of 8, with dilation. The fixed-depth kernels don't handle an
+// input depth of 3.
+TEST_P(PerChannelQuantizedDepthwiseConvolutionOpTest,
+       DilatedDepthMultiplier8Test) {
+  PerChannelQuantizedDepthwiseConvolutionOpModel m(
+      GetRegistration(), {TensorType_INT8, {1, 3, 3, 3}, -63.5, 64, 0.5, -1},
+      {TensorType_INT8,
+       // [1 * 2 * 2 * 24] as [input_channel, y, x, output_channel]
+       {1, 2, 2, 24},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_quantization=*/true,
+       /*per_channel_quantization_scales=*/
+       {0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1,
+        0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1},
+       /*per_channel_quantization_offsets=*/
+       {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+       /*channel_index=*/3},
+      {TensorType_INT8, {}, -63.5, 64, 0.5, -1}, Padding_VALID,
+      /*dilation_factor=*/2);
+  // Every pixel of the image is [1, 0.5, 2].
+  m.SetInput({1, 0.5, 2, 1, 0.5, 2, 1, 0.5, 2, 1, 0.5, 2, 1, 0.5, 2,
+              1, 0.5, 2, 1, 0.5, 2, 1, 0.5, 2, 1, 0.5, 2});
+  m.SetFilter(
+      /*filter data*/
+      {// Every tap is [1, ..., 8] for each input channel.
+       1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8,
+       1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8,
+       1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8,
+       1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8, 1, 2, 3, 4, 5, 6, 7, 8});
+  m.SetBias({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+
+  // Invoke and verify output.
+  // The dilated 2x2 filter reads the corners of the image, so output channel
+  // c * 8 + k is 4 * input[c] * (k + 1).
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {4, 8,  12, 16, 20, 24, 28, 32, 2, 4,  6,  8,
+                   10, 12, 14, 16, 8, 16, 24, 32, 40, 48, 56, 64})));
+}
+
+// Exercises the int8 kernel with a variable input depth and a depth
+// multiplier of 4. With a stride of 2, the fixed-depth kernels are skipped,
+// and an input depth of 9 goes through both the 8 channel loop and the one
+// channel loop.
+TEST_P(PerChannelQuantizedDepthwiseConvolutionOpTest,
+       StridedDepthMultiplier4Test) {
+  PerChannelQuantizedDepthwiseConvolutionOpModel m(
+      GetRegistration(), {TensorType_INT8, {1, 2, 2, 9}, -63.5, 64, 0.5, -1},
+      {TensorType_INT8,
+       // [1 * 1 * 1 * 36] as [input_channel, y, x, output_channel]
+       {1, 1, 1, 36},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_quantization=*/true,
+       /*per_channel_quantization_scales=*/
+       {0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1,
+        0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1,
+        0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1},
+       /*per_channel_quantization_offsets=*/
+       {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+       /*channel_index=*/3},
+      {TensorType_INT8, {}, -63.5, 64, 0.5, -1}, Padding_VALID,
+      /*dilation_factor=*/1,
+      /*stride_width=*/2,
+      /*stride_height=*/2);
+  // Only the top left pixel, [1, ..., 9], is read.
+  m.SetInput({1,  2,  3,  4,  5,  6,  7,  8,  9,  -1, -1, -1,
+              -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+              -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1});
+  // The filter is [1, 2, 3, 4] for each input channel.
+  m.SetFilter({1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2,
+               3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4});
+  m.SetBias({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+  m.SetNumThreads(2);
+
+  // Output channel c * 4 + k is (c + 1) * (k + 1).
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {1, 2,  3,  4,  2, 4,  6,  8,  3, 6,  9,  12,
+                   4, 8,  12, 16, 5, 10, 15, 20, 6, 12, 18, 24,
+                   7, 14, 21, 28, 8, 16, 24, 32, 9, 18, 27, 36})));
+}
+
 TEST_P(PerChannelQuantizedDepthwiseConvolutionOpTest, Simple3x3FilterTest) {
   PerChannelQuantizedDepthwiseConvolutionOpModel m(
       GetRegistration(), {TensorType_INT8, {1, 3, 3, 8}, -63.5, 64, 0.5, -1},
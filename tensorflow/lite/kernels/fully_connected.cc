@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/structured_sparsity.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
@@ -159,6 +160,14 @@ struct OpData {
   bool ledger_initialized;
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
+  // Size of the blocks of a block-wise quantized hybrid filter, 0 otherwise.
+  int block_size = 0;
+  // Constant block-wise quantized int4 filter unpacked to int8 once in Prepare.
+  std::vector<int8_t> unpacked_blockwise_filter;
+  // Packed copy of a constant float filter with N:M structured sparsity.
+  std::unique_ptr<optimized_ops::StructuredSparseMatrix>
+      structured_sparse_filter = nullptr;
+  bool structured_sparsity_checked = false;
   TfLiteType quantized_bias_type = kTfLiteNoType;
 };
 
@@ -510,9 +519,30 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
        (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8 ||
         filter->type == kTfLiteInt4));
   const bool is_sparse = filter->sparsity != nullptr;
+  data->block_size = is_hybrid ? GetBlockwiseQuantizationBlockSize(filter) : 0;
+  if (data->block_size > 0) {
+    TF_LITE_ENSURE_MSG(context, !is_sparse,
+                       "Block-wise quantized filters can't be sparse.");
+    TF_LITE_ENSURE_MSG(
+        context,
+        kTfLiteOk == VerifyQuantizationZeroPoint(filter, /*expected_value=*/0),
+        "Block-wise quantized filters must be symmetric.");
+    if (filter->type == kTfLiteInt4 && IsConstantTensor(filter)) {
+      const size_t flat_size = GetTensorShape(filter).FlatSize();
+      if (data->unpacked_blockwise_filter.size() != flat_size) {
+        data->unpacked_blockwise_filter.resize(flat_size);
+        tensor_utils::UnpackDenseInt4IntoInt8(
+            GetTensorData<int8_t>(filter), flat_size,
+            data->unpacked_blockwise_filter.data());
+      }
+    }
+  } else {
+    data->unpacked_blockwise_filter.clear();
+  }
   if (is_hybrid) {
     // Use optimized implementation for 4bit
     if (filter->type == kTfLiteInt4 && kernel_type == kGenericOptimized &&
+        data->block_size == 0 &&
         IsConstantTensor(filter) && batch_size &&
         ((input_size / batch_size) % 2 == 0) &&
         num_units >= optimized_4bit::FilterWidth &&
@@ -624,6 +654,21 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
     }
   }
 
+  // Constant float filters with N:M structured sparsity are packed once for
+  // the structured sparse kernel.
+  if (kernel_type == kGenericOptimized && !data->structured_sparsity_checked &&
+      input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32 &&
+      !is_sparse && IsConstantTensor(filter)) {
+    data->structured_sparsity_checked = true;
+    auto packed_filter =
+        std::make_unique<optimized_ops::StructuredSparseMatrix>();
+    if (optimized_ops::PackStructuredSparseMatrix(
+            GetTensorData<float>(filter), num_units, filter->dims->data[1],
+            packed_filter.get())) {
+      data->structured_sparse_filter = std::move(packed_filter);
+    }
+  }
+
   // Resize output.
   return UpdateOutputSize(context, params, input, output, batch_size, num_units,
                           filter->dims->data[1]);
@@ -742,7 +787,9 @@ TfLiteStatus EvalHybridDense(
   int8_t* quant_data = GetTensorData<int8_t>(input_quantized);
   const int8_t* filter_data = nullptr;
   std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
-  if (filter->type == kTfLiteInt4) {
+  if (!data->unpacked_blockwise_filter.empty()) {
+    filter_data = data->unpacked_blockwise_filter.data();
+  } else if (filter->type == kTfLiteInt4) {
     const size_t bytes_unpacked = filter->bytes * 2;
     unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
     tflite::tensor_utils::UnpackDenseInt4IntoInt8(
@@ -757,6 +804,20 @@ TfLiteStatus EvalHybridDense(
       input_ptr, batch_size, input_size, quant_data, scaling_factors_ptr,
       input_offset_ptr, params->asymmetric_quantize_inputs);
 
+  if (data->block_size > 0) {
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            filter->quantization.params);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulateBlockwise(
+        filter_data, num_units, input_size, quant_data, scaling_factors_ptr,
+        batch_size, affine_quantization->scale->data, data->block_size,
+        input_offset_ptr, GetTensorData<float>(output));
+    tensor_utils::ApplyActivationToVector(
+        GetTensorData<float>(output), batch_size * num_units,
+        params->activation, GetTensorData<float>(output));
+    return kTfLiteOk;
+  }
+
   float* per_channel_scale_ptr = nullptr;
   if (VerifyPerChannelQuantization(context, filter) == kTfLiteOk) {
     //  Per channel quantization.
@@ -1536,6 +1597,8 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
     FullyConnectedParams op_params;
     op_params.float_activation_min = output_activation_min;
     op_params.float_activation_max = output_activation_max;
+    const int batches =
+        FlatSizeSkipDim(GetTensorShape(output), NumDimensions(output) - 1);
     if (filter->sparsity != nullptr) {
       const auto& sparsity = *filter->sparsity;
       if (!SupportedSparsityFormat(sparsity)) {
@@ -1576,6 +1639,13 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteError;
       }
 
+    } else if (data->structured_sparse_filter &&
+               batches <= optimized_ops::kStructuredSparseMaxBatches) {
+      optimized_ops::FullyConnectedStructuredSparseWeight(
+          *data->structured_sparse_filter, op_params,
+          GetTensorData<float>(input), GetTensorData<float>(bias), batches,
+          GetTensorData<float>(output),
+          CpuBackendContext::GetFromContext(context));
     } else {
       op_params.lhs_cacheable = IsConstantTensor(filter);
       op_params.rhs_cacheable = IsConstantTensor(input);
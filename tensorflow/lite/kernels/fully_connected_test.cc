@@ -463,6 +463,10 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
     SignedSymmetricQuantizeAndPopulate4Bit(weights_, f);
   }
 
+  void SetQuantizedWeights(const std::vector<int8_t>& data) {
+    PopulateTensor(weights_, data);
+  }
+
   void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
@@ -1484,6 +1488,128 @@ TEST(HybridAsymmetricInputPerChannelWeightsFullyConnectedOpTest,
                                  /*max_abs_error=*/1.3f)));
 }
 
+TEST(HybridFullyConnectedOpTest, SimpleTestBlockwiseQuantizedInt8) {
+  // Two blocks of 4 input values per unit, each with its own scale.
+  HybridFullyConnectedOpModel m(
+      /*units=*/2, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 8}},
+      /*weights=*/
+      {TensorType_INT8,
+       {2, 8},
+       0,
+       0,
+       0.0f,
+       0,
+       true,
+       {0.5, 1.0, 0.25, 2.0},
+       {0, 0, 0, 0}});
+
+  m.SetQuantizedWeights({
+      1, 2, 3, 4, 5,  6,  7,  8,   // u = 0
+      1, 1, 1, 1, -1, -1, -1, -1,  // u = 1
+  });
+  m.SetBias({1, 20});
+
+  m.SetInput({
+      127,  1, 2, 3, 4, 5, 6, 7,    // b = 0
+      -127, 0, 0, 0, 0, 0, 0, 127,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     222.5, 9.25,  //
+                                     953.5, 0,     //
+                                 },
+                                 /*max_abs_error=*/1e-3f)));
+}
+
+// Hybrid fully connected op with a constant block-wise quantized int4 filter,
+// which the kernel unpacks once in Prepare.
+class BlockwiseInt4HybridFullyConnectedOpModel : public SingleOpModel {
+ public:
+  BlockwiseInt4HybridFullyConnectedOpModel(
+      int units, int batches, int input_size,
+      const std::vector<int8_t>& weights, const std::vector<float>& scales) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    // Pack two int4 values per byte, the low nibble holding the first one.
+    std::vector<int8_t> packed((weights.size() + 1) / 2, 0);
+    for (size_t i = 0; i < weights.size(); ++i) {
+      const uint8_t nibble = static_cast<uint8_t>(weights[i]) & 0x0F;
+      packed[i / 2] |= static_cast<int8_t>(i % 2 ? nibble << 4 : nibble);
+    }
+    weights_ = AddConstInput(
+        TensorData{TensorType_INT4, {units, input_size}, 0, 0, 0.0f, 0, true,
+                   scales, std::vector<int64_t>(scales.size(), 0)},
+        packed);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(builder_,
+                                             ActivationFunctionType_RELU)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED,
+        ops::builtin::Register_FULLY_CONNECTED_PIE());
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+TEST(HybridFullyConnectedOpTest, BlockwiseQuantizedInt4MatchesDequantized) {
+  constexpr int kUnits = 2;
+  constexpr int kBatches = 2;
+  constexpr int kInputSize = 8;
+  constexpr int kBlockSize = 4;
+  const std::vector<int8_t> weights = {
+      1, 2, 3, 4, 5,  6,  7,  -7,  // u = 0
+      1, 1, 1, 1, -1, -1, -1, -1,  // u = 1
+  };
+  const std::vector<float> scales = {0.5, 1.0, 0.25, 2.0};
+  const std::vector<float> bias = {1, 20};
+  const std::vector<float> input = {
+      127,  1, 2, 3, 4, 5, 6, 7,    // b = 0
+      -127, 0, 0, 0, 0, 0, 0, 127,  // b = 1
+  };
+
+  // Reference result using the dequantized filter.
+  std::vector<float> expected(kBatches * kUnits);
+  for (int b = 0; b < kBatches; ++b) {
+    for (int u = 0; u < kUnits; ++u) {
+      float acc = bias[u];
+      for (int i = 0; i < kInputSize; ++i) {
+        const float scale =
+            scales[u * (kInputSize / kBlockSize) + i / kBlockSize];
+        acc += input[b * kInputSize + i] * weights[u * kInputSize + i] * scale;
+      }
+      expected[b * kUnits + u] = std::max(acc, 0.0f);
+    }
+  }
+
+  BlockwiseInt4HybridFullyConnectedOpModel m(kUnits, kBatches, kInputSize,
+                                             weights, scales);
+  m.SetBias(bias);
+  m.SetInput(input);
+  // Invoke twice so the second run reuses the filter unpacked in Prepare.
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    EXPECT_THAT(m.GetOutput(),
+                ElementsAreArray(ArrayFloatNear(expected,
+                                                /*max_abs_error=*/1e-3f)));
+  }
+}
+
 TEST_P(FloatFullyConnectedOpTest, SimpleTest4DInput) {
   // Note that it is not required that the first dimension be the number of
   // batches. All we care is that the input can be evenly distributed in
@@ -2194,6 +2320,62 @@ TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16PerChannelTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
                                  {10.9061, 2, 25.0938, 0, 2, 20.9691}, 1e-3)));
 }
+
+// Dense float weights stored as a constant tensor, which the optimized kernel
+// packs if they have N:M structured sparsity.
+class ConstantWeightsFullyConnectedOpModel : public SingleOpModel {
+ public:
+  ConstantWeightsFullyConnectedOpModel(TfLiteRegistration* registration,
+                                       int units, int batches, int input_size,
+                                       const std::vector<float>& weights_data) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    AddConstInput(TensorType_FLOAT32, weights_data, {units, input_size});
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), {units, input_size}, GetShape(bias_)},
+                     /*num_threads=*/1, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+  void SetBias(const std::vector<float>& data) { PopulateTensor(bias_, data); }
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(SparseFullyConnectedOpTest, StructuredSparseConstantWeights) {
+  // Every group of 4 weights has at most 2 non-zeros.
+  ConstantWeightsFullyConnectedOpModel m(GetRegistration(), /*units=*/3,
+                                         /*batches=*/2, /*input_size=*/8,
+                                         {
+                                             1, 0, 2, 0, 0, 3, 0, -1,  // u = 0
+                                             0, 0, 1, 1, 2, 0, 0, 0,   // u = 1
+                                             -1, 0, 0, 2, 0, 0, 1, 1,  // u = 2
+                                         });
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  // b = 0
+      8, 7, 6, 5, 4, 3, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(18, 19, 25, 29, 21, 8));
+}
+
 // TODO(b/148391360): Add tests for unsupported sparsity format.
 // TEST_P(SparseFullyConnectedOpTest, TestUnsupportedSparsityFormat)
 
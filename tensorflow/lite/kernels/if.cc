@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -53,6 +54,24 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
+// Returns true if `subgraph` has ops which invoke other subgraphs. Such a
+// branch may invoke the other branch, so the branches can't share an arena.
+bool HasControlFlowOps(const Subgraph& subgraph) {
+  for (const auto& node_and_registration : subgraph.nodes_and_registration()) {
+    switch (node_and_registration.second.builtin_code) {
+      case kTfLiteBuiltinCallOnce:
+      case kTfLiteBuiltinIf:
+      case kTfLiteBuiltinStablehloComposite:
+      case kTfLiteBuiltinStablehloWhile:
+      case kTfLiteBuiltinWhile:
+        return true;
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
@@ -115,6 +134,15 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         subgraph->HasDynamicTensors();
   }
 
+  // Only one branch runs per invocation and its memory is released afterwards,
+  // so both branches can plan their tensors into the same buffer.
+  if (this_subgraph->ShouldShareControlFlowArenas() &&
+      then_subgraph != else_subgraph && !HasControlFlowOps(*then_subgraph) &&
+      !HasControlFlowOps(*else_subgraph)) {
+    TF_LITE_ENSURE_OK(
+        context, else_subgraph->ShareNonPersistentArenaWith(then_subgraph));
+  }
+
   if (!op_data->subgraph_has_dynamic_output_tensors) {
     for (int i = 0; i < num_outputs; ++i) {
       TfLiteTensor* then_output =
@@ -771,6 +771,108 @@ struct QuantizedDepthwiseConvKernel<false, 4, 4> {
   }
 };
 
+template <>
+struct QuantizedDepthwiseConvKernel<true, 0, 8> {
+  static void Run(int num_output_pixels, int input_depth, int depth_multiplier,
+                  const int8* input_ptr, int16 input_offset,
+                  int input_ptr_increment, const int8* filter_ptr,
+                  int32* acc_buffer_ptr) {
+    // Handle one output pixel at a time.
+    for (int outp = 0; outp < num_output_pixels; outp++) {
+      const int8* local_filter_ptr = filter_ptr;
+      const int8* local_input_ptr = input_ptr;
+      // Handle one input channel at a time.
+      for (int ic = 0; ic < input_depth; ic++) {
+        // Load the filters.
+        const int8x8_t filter_s8 = vld1_s8(local_filter_ptr);
+        const int16x8_t filter = vmovl_s8(filter_s8);
+        local_filter_ptr += 8;
+        // Load the input and add input_offset.
+        const int16 input =
+            static_cast<int16>(*local_input_ptr++ + input_offset);
+        // Load the accumulators from acc_buffer
+        int32x4_t acc[2];
+        for (int i = 0; i < 2; i++) {
+          acc[i] = vld1q_s32(acc_buffer_ptr + 4 * i);
+        }
+        // Multiply-accumulate
+        acc[0] = vmlal_n_s16(acc[0], vget_low_s16(filter), input);
+        acc[1] = vmlal_n_s16(acc[1], vget_high_s16(filter), input);
+        // Store the accumulators back to acc_buffer
+        for (int i = 0; i < 2; i++) {
+          vst1q_s32(acc_buffer_ptr + 4 * i, acc[i]);
+        }
+        acc_buffer_ptr += 8;
+      }
+      input_ptr += input_ptr_increment;
+    }
+  }
+};
+
+template <>
+struct QuantizedDepthwiseConvKernel<true, 0, 4> {
+  static void Run(int num_output_pixels, int input_depth, int depth_multiplier,
+                  const int8* input_ptr, int16 input_offset,
+                  int input_ptr_increment, const int8* filter_ptr,
+                  int32* acc_buffer_ptr) {
+    // Handle one output pixel at a time.
+    for (int outp = 0; outp < num_output_pixels; outp++) {
+      const int8* local_filter_ptr = filter_ptr;
+      const int8* local_input_ptr = input_ptr;
+      int ic = 0;
+      // Handle 8 input channels at a time.
+      for (; ic <= input_depth - 8; ic += 8) {
+        // Load the filters.
+        int16x8_t filter[4];
+        for (int i = 0; i < 4; i++) {
+          filter[i] = vmovl_s8(vld1_s8(local_filter_ptr + 8 * i));
+        }
+        local_filter_ptr += 32;
+        // Load the inputs, add input_offset, duplicate 4-fold.
+        const int8x8_t input_s8 = vld1_s8(local_input_ptr);
+        local_input_ptr += 8;
+        const int16x8_t input_s16 = vmovl_s8(input_s8);
+        const int16x8_t input = vaddq_s16(input_s16, vdupq_n_s16(input_offset));
+        const int16x8x2_t input_dup2 = vzipq_s16(input, input);
+        int16x8_t input_dup4[4];
+        for (int i = 0; i < 2; i++) {
+          const int16x8x2_t input_dup4_pair =
+              vzipq_s16(input_dup2.val[i], input_dup2.val[i]);
+          input_dup4[2 * i] = input_dup4_pair.val[0];
+          input_dup4[2 * i + 1] = input_dup4_pair.val[1];
+        }
+        // Load the accumulators from acc_buffer.
+        int32x4_t acc[8];
+        for (int i = 0; i < 8; i++) {
+          acc[i] = vld1q_s32(acc_buffer_ptr + 4 * i);
+        }
+        // Multiply-accumulate.
+        for (int j = 0; j < 4; j++) {
+          acc[2 * j] = vmlal_s16(acc[2 * j], vget_low_s16(filter[j]),
+                                 vget_low_s16(input_dup4[j]));
+          acc[2 * j + 1] = vmlal_s16(acc[2 * j + 1], vget_high_s16(filter[j]),
+                                     vget_high_s16(input_dup4[j]));
+        }
+        // Store the accumulators back to acc_buffer.
+        for (int i = 0; i < 8; i++) {
+          vst1q_s32(acc_buffer_ptr + 4 * i, acc[i]);
+        }
+        acc_buffer_ptr += 32;
+      }
+      // Handle one input channel at a time.
+      for (; ic < input_depth; ic++) {
+        const int16 input_val = *local_input_ptr++ + input_offset;
+        for (int i = 0; i < 4; i++) {
+          *acc_buffer_ptr++ +=
+              static_cast<int32>(local_filter_ptr[i]) * input_val;
+        }
+        local_filter_ptr += 4;
+      }
+      input_ptr += input_ptr_increment;
+    }
+  }
+};
+
 template <>
 struct QuantizedDepthwiseConvKernel<true, 0, 3> {
   static void Run(int num_output_pixels, int input_depth, int depth_multiplier,
@@ -1708,6 +1810,8 @@ inline void DepthwiseConvGeneral(
   TFMINI_USE_DEPTHWISECONV_KERNEL(true, 0, 1)
   TFMINI_USE_DEPTHWISECONV_KERNEL(true, 0, 2)
   TFMINI_USE_DEPTHWISECONV_KERNEL(true, 0, 3)
+  TFMINI_USE_DEPTHWISECONV_KERNEL(true, 0, 4)
+  TFMINI_USE_DEPTHWISECONV_KERNEL(true, 0, 8)
 #endif  // USE_NEON
 
   // No matching fast kernel found, use slow fallback.
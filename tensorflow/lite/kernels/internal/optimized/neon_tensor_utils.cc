@@ -1492,6 +1492,47 @@ void NeonMatrixBatchVectorMultiplyAccumulate(
       per_channel_scale, input_offset, row_sums);
 }
 
+void NeonMatrixBatchVectorMultiplyAccumulateBlockwise(
+    const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
+    const int8_t* __restrict__ vectors, const float* scaling_factors,
+    int n_batch, const float* block_scales, int block_size,
+    const int32_t* input_offset, float* __restrict__ result) {
+  const int num_blocks = m_cols / block_size;
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int32_t batch_offset = input_offset ? input_offset[batch] : 0;
+    const int8_t* row_ptr = matrix;
+    const float* row_scales = block_scales;
+    for (int row = 0; row < m_rows; ++row, row_scales += num_blocks) {
+      float sum = 0.0f;
+      for (int block = 0; block < num_blocks; ++block) {
+        const int8_t* block_vector = vectors + block * block_size;
+        int32x4_t dotprod_32x4 = vmovq_n_s32(0);
+        int32x4_t block_sum_32x4 = vmovq_n_s32(0);
+        for (int col = 0; col < block_size; col += 16) {
+          const int8x16_t s1_8x16 = vld1q_s8(row_ptr + col);
+          const int8x16_t s2_8x16 = vld1q_s8(block_vector + col);
+          // Multiply the low bits (i.e. the lower 8 8bit numbers in the
+          // registers), then multiply and accumulate the high bits. As the
+          // matrix values lie in [-127, 127], the sums fit in 16 bits.
+          int16x8_t prod_16x8 =
+              vmull_s8(vget_low_s8(s1_8x16), vget_low_s8(s2_8x16));
+          prod_16x8 =
+              vmlal_s8(prod_16x8, vget_high_s8(s1_8x16), vget_high_s8(s2_8x16));
+          dotprod_32x4 = vpadalq_s16(dotprod_32x4, prod_16x8);
+          block_sum_32x4 = vpadalq_s16(block_sum_32x4, vpaddlq_s8(s1_8x16));
+        }
+        const int32_t dotprod = AccumulateNeonLane(dotprod_32x4) -
+                                AccumulateNeonLane(block_sum_32x4) *
+                                    batch_offset;
+        sum += dotprod * row_scales[block];
+        row_ptr += block_size;
+      }
+      *result += sum * scaling_factors[batch];
+      ++result;
+    }
+  }
+}
+
 inline int64x2x2_t MulAdd(int32x4_t acc, int32x4_t lhs, int32x4_t rhs) {
   int64x2x2_t result;
   const int64x2_t lhs_low = vmovl_s32(vget_low_s32(lhs));
@@ -1961,6 +2002,52 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonStructuredSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int n, int m, int m_rows, int m_cols, const float* __restrict__ vector,
+    int n_batch, float* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % m, 0);
+  const int kept_per_row = m_cols / m * n;
+  // If n divides the vector size, every vector of kept values covers whole
+  // groups.
+  const int postamble_start = kFloatValuesPerNeonVector % n == 0
+                                  ? RoundDownVectors<kFloatValuesPerNeonVector>(
+                                        kept_per_row)
+                                  : 0;
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      int i = 0;
+      for (; i < postamble_start; i += kFloatValuesPerNeonVector) {
+        // Gather the 4 vector values matching the kept matrix values.
+        const float* group_vector = vector_in_batch + (i / n) * m;
+        float32x4_t vector_f32x4 = vmovq_n_f32(0.0);
+        vector_f32x4 =
+            vld1q_lane_f32(group_vector + indices_ptr[i], vector_f32x4, 0);
+        vector_f32x4 = vld1q_lane_f32(
+            group_vector + (1 / n) * m + indices_ptr[i + 1], vector_f32x4, 1);
+        vector_f32x4 = vld1q_lane_f32(
+            group_vector + (2 / n) * m + indices_ptr[i + 2], vector_f32x4, 2);
+        vector_f32x4 = vld1q_lane_f32(
+            group_vector + (3 / n) * m + indices_ptr[i + 3], vector_f32x4, 3);
+        const float32x4_t matrix_f32x4 = vld1q_f32(matrix_ptr + i);
+        acc_32x4 = vmlaq_f32(acc_32x4, matrix_f32x4, vector_f32x4);
+      }
+      float dot_prod = AccumulateNeonLane(acc_32x4);
+      for (; i < kept_per_row; i++) {
+        const int col = (i / n) * m + indices_ptr[i];
+        dot_prod += matrix_ptr[i] * vector_in_batch[col];
+      }
+      result[batch * m_rows + row] += dot_prod;
+      matrix_ptr += kept_per_row;
+      indices_ptr += kept_per_row;
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -63,6 +63,22 @@ void MatrixBatchVectorMultiplyAccumulate(
                    input_offset, scratch, row_sums, compute_row_sums, context);
 }
 
+void MatrixBatchVectorMultiplyAccumulateBlockwise(
+    const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
+    const int8_t* __restrict__ vectors, const float* scaling_factors,
+    int n_batch, const float* block_scales, int block_size,
+    const int32_t* input_offset, float* __restrict__ result) {
+  if (block_size % 16 == 0) {
+    NEON_OR_PORTABLE(MatrixBatchVectorMultiplyAccumulateBlockwise, matrix,
+                     m_rows, m_cols, vectors, scaling_factors, n_batch,
+                     block_scales, block_size, input_offset, result);
+    return;
+  }
+  PortableMatrixBatchVectorMultiplyAccumulateBlockwise(
+      matrix, m_rows, m_cols, vectors, scaling_factors, n_batch,
+      block_scales, block_size, input_offset, result);
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const float* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -71,6 +87,14 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
                    segments, indices, m_rows, m_cols, vector, n_batch, result);
 }
 
+void StructuredSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int n, int m, int m_rows, int m_cols, const float* __restrict__ vector,
+    int n_batch, float* __restrict__ result) {
+  NEON_OR_PORTABLE(StructuredSparseMatrixBatchVectorMultiplyAccumulate, matrix,
+                   indices, n, m, m_rows, m_cols, vector, n_batch, result);
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
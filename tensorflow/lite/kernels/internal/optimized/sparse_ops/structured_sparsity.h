@@ -0,0 +1,240 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_STRUCTURED_SPARSITY_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_STRUCTURED_SPARSITY_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/im2col_utils.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Number of batches up to which the structured sparse kernels are used. With
+// more batches, the dense GEMM, which reuses each weight for several batches,
+// is faster than gathering the inputs of the kept weights.
+constexpr int kStructuredSparseMaxBatches = 8;
+
+// A [rows, cols] float matrix with N:M structured sparsity, i.e. each group of
+// m consecutive values of a row has at most n non-zeros, stored as expected by
+// tensor_utils::StructuredSparseMatrixBatchVectorMultiplyAccumulate.
+struct StructuredSparseMatrix {
+  int n = 0;
+  int m = 0;
+  int rows = 0;
+  int cols = 0;
+  std::vector<float> values;
+  std::vector<uint8_t> indices;
+};
+
+// Packs the [rows, cols] `matrix` if it has N:M structured sparsity with m = 4
+// or m = 8 and at most half of the values kept. n is rounded up to a power of
+// two, so that the kept values of whole groups fill SIMD vectors. Returns false
+// if the matrix doesn't have such a pattern.
+inline bool PackStructuredSparseMatrix(const float* matrix, int rows, int cols,
+                                       StructuredSparseMatrix* packed) {
+  const int size = rows * cols;
+  if (size == 0) return false;
+  int best_n = 0;
+  int best_m = 0;
+  for (const int m : {4, 8}) {
+    if (cols % m != 0) continue;
+    int n = 1;
+    for (int i = 0; i < size && 2 * n <= m; i += m) {
+      int non_zeros = 0;
+      for (int j = 0; j < m; ++j) {
+        non_zeros += matrix[i + j] != 0.0f;
+      }
+      while (n < non_zeros) n *= 2;
+    }
+    if (2 * n > m) continue;
+    // Keep the pattern with the fewest values, preferring smaller groups.
+    if (best_m == 0 || n * best_m < best_n * m) {
+      best_n = n;
+      best_m = m;
+    }
+  }
+  if (best_m == 0) return false;
+
+  packed->n = best_n;
+  packed->m = best_m;
+  packed->rows = rows;
+  packed->cols = cols;
+  // Groups with fewer non-zeros are padded with zeros.
+  packed->values.assign(size / best_m * best_n, 0.0f);
+  packed->indices.assign(size / best_m * best_n, 0);
+  float* values = packed->values.data();
+  uint8_t* indices = packed->indices.data();
+  for (int i = 0; i < size; i += best_m) {
+    int kept = 0;
+    for (int j = 0; j < best_m; ++j) {
+      if (matrix[i + j] != 0.0f) {
+        values[kept] = matrix[i + j];
+        indices[kept] = j;
+        ++kept;
+      }
+    }
+    values += best_n;
+    indices += best_n;
+  }
+  return true;
+}
+
+// Computes the rows [row_start, row_end) of the output of a fully connected
+// layer with `batches` inputs and structured sparse `weights`.
+inline void FullyConnectedStructuredSparseWeightImpl(
+    const StructuredSparseMatrix& weights, const FullyConnectedParams& params,
+    const float* input_data, const float* bias_data, int batches,
+    float* output_data, int row_start, int row_end) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("N:M Structured Sparse");
+  const int kept_per_row = weights.cols / weights.m * weights.n;
+  const int rows = row_end - row_start;
+  for (int b = 0; b < batches; ++b) {
+    float* output_ptr = output_data + b * weights.rows + row_start;
+    std::fill_n(output_ptr, rows, 0.0f);
+    tensor_utils::StructuredSparseMatrixBatchVectorMultiplyAccumulate(
+        weights.values.data() + row_start * kept_per_row,
+        weights.indices.data() + row_start * kept_per_row, weights.n,
+        weights.m, rows, weights.cols, input_data + b * weights.cols,
+        /*n_batch=*/1, output_ptr);
+    for (int r = 0; r < rows; ++r) {
+      const float bias_value = bias_data ? bias_data[row_start + r] : 0;
+      output_ptr[r] = ActivationFunctionWithMinMax(
+          output_ptr[r] + bias_value, params.float_activation_min,
+          params.float_activation_max);
+    }
+  }
+}
+
+struct FullyConnectedStructuredSparseWeightTask : cpu_backend_threadpool::Task {
+  FullyConnectedStructuredSparseWeightTask(
+      const StructuredSparseMatrix& weights, const FullyConnectedParams& params,
+      const float* input_data, const float* bias_data, int batches,
+      float* output_data, int row_start, int row_end)
+      : weights(weights),
+        params(params),
+        input_data(input_data),
+        bias_data(bias_data),
+        batches(batches),
+        output_data(output_data),
+        row_start(row_start),
+        row_end(row_end) {}
+
+  void Run() override {
+    FullyConnectedStructuredSparseWeightImpl(weights, params, input_data,
+                                             bias_data, batches, output_data,
+                                             row_start, row_end);
+  }
+
+ private:
+  const StructuredSparseMatrix& weights;
+  const FullyConnectedParams& params;
+  const float* input_data;
+  const float* bias_data;
+  int batches;
+  float* output_data;
+  int row_start;
+  int row_end;
+};
+
+// Fully connected layer with structured sparse weights of shape
+// [output_depth, accum_depth], for small numbers of batches. The
+// multi-threaded kernel slices the workload along the output depth, as there
+// are usually too few batches to keep all threads busy.
+inline void FullyConnectedStructuredSparseWeight(
+    const StructuredSparseMatrix& weights, const FullyConnectedParams& params,
+    const float* input_data, const float* bias_data, int batches,
+    float* output_data, CpuBackendContext* cpu_backend_context) {
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int thread_count = std::max(1, std::min(weights.rows, max_threads));
+  if (thread_count == 1) {
+    return FullyConnectedStructuredSparseWeightImpl(
+        weights, params, input_data, bias_data, batches, output_data, 0,
+        weights.rows);
+  }
+  std::vector<FullyConnectedStructuredSparseWeightTask> tasks;
+  tasks.reserve(thread_count);
+  int row_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int row_end = row_start + weights.rows / thread_count;
+    if (i < weights.rows % thread_count) row_end++;
+    tasks.emplace_back(weights, params, input_data, bias_data, batches,
+                       output_data, row_start, row_end);
+    row_start = row_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+// Float convolution with a structured sparse filter, packed from its
+// [output_depth, filter_height * filter_width * input_depth] layout. Mirrors
+// the im2col handling of the GEMM based optimized_ops::Conv, and then
+// multiplies every row of the im2col buffer with the filter.
+inline void ConvStructuredSparseWeight(
+    const ConvParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& filter_shape,
+    const StructuredSparseMatrix& filter, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    const RuntimeShape& im2col_shape, float* im2col_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Conv/N:M Structured Sparse");
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  // NB: the float 0.0f value is represented by all zero bytes.
+  const uint8_t float_zero_byte = 0x00;
+  const float* gemm_input_data = nullptr;
+  const int filter_width = filter_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const bool need_dilated_im2col =
+      params.dilation_width_factor != 1 || params.dilation_height_factor != 1;
+  const bool need_im2col = params.stride_width != 1 ||
+                           params.stride_height != 1 || filter_width != 1 ||
+                           filter_height != 1;
+  if (need_dilated_im2col) {
+    DilatedIm2col(params, float_zero_byte, input_shape, input_data,
+                  filter_shape, output_shape, im2col_data);
+    gemm_input_data = im2col_data;
+  } else if (need_im2col) {
+    TFLITE_DCHECK(im2col_data);
+    Im2col(params, filter_height, filter_width, float_zero_byte, input_shape,
+           input_data, im2col_shape, im2col_data);
+    gemm_input_data = im2col_data;
+  } else {
+    TFLITE_DCHECK(!im2col_data);
+    gemm_input_data = input_data;
+  }
+
+  FullyConnectedParams fc_params;
+  fc_params.float_activation_min = params.float_activation_min;
+  fc_params.float_activation_max = params.float_activation_max;
+  FullyConnectedStructuredSparseWeight(
+      filter, fc_params, gemm_input_data, bias_data,
+      FlatSizeSkipDim(output_shape, 3), output_data, cpu_backend_context);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_STRUCTURED_SPARSITY_H_
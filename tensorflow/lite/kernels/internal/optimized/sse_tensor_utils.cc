@@ -492,6 +492,129 @@ void SseMatrixBatchVectorMultiplyAccumulate(
       per_channel_scale, input_offset, row_sums);
 }
 
+void SseMatrixBatchVectorMultiplyAccumulateBlockwise(
+    const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
+    const int8_t* __restrict__ vectors, const float* scaling_factors,
+    int n_batch, const float* block_scales, int block_size,
+    const int32_t* input_offset, float* __restrict__ result) {
+  const int num_blocks = m_cols / block_size;
+  const __m128i ones_8x16 = _mm_set1_epi8(1);
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int32_t batch_offset = input_offset ? input_offset[batch] : 0;
+    const int8_t* row_ptr = matrix;
+    const float* row_scales = block_scales;
+    for (int row = 0; row < m_rows; ++row, row_scales += num_blocks) {
+      float sum = 0.0f;
+      for (int block = 0; block < num_blocks; ++block) {
+        const int8_t* block_vector = vectors + block * block_size;
+        __m128i dotprod_32x4 = _mm_setzero_si128();
+        __m128i block_sum_32x4 = _mm_setzero_si128();
+        // The sign is transferred from the vector to the matrix values, which
+        // can't be -128.
+        int col = 0;
+#ifdef __AVX2__
+        const __m256i ones_8x32 = _mm256_set1_epi8(1);
+        __m256i dotprod_32x8 = _mm256_setzero_si256();
+        __m256i block_sum_32x8 = _mm256_setzero_si256();
+        for (; col + 32 <= block_size; col += 32) {
+          const __m256i row_8x32 = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(row_ptr + col));
+          const __m256i vec_8x32 = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(block_vector + col));
+          dotprod_32x8 = _mm256_add_epi32(dotprod_32x8,
+                                          DotProdInt8x4x8(vec_8x32, row_8x32));
+          block_sum_32x8 = _mm256_add_epi32(
+              block_sum_32x8, DotProdInt8x4x8(ones_8x32, row_8x32));
+        }
+        dotprod_32x4 =
+            _mm_add_epi32(_mm256_castsi256_si128(dotprod_32x8),
+                          _mm256_extracti128_si256(dotprod_32x8, 1));
+        block_sum_32x4 =
+            _mm_add_epi32(_mm256_castsi256_si128(block_sum_32x8),
+                          _mm256_extracti128_si256(block_sum_32x8, 1));
+#endif  // __AVX2__
+        for (; col < block_size; col += 16) {
+          const __m128i row_8x16 = _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(row_ptr + col));
+          const __m128i vec_8x16 = _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(block_vector + col));
+          dotprod_32x4 = _mm_add_epi32(dotprod_32x4,
+                                       DotProdInt8x4x4(vec_8x16, row_8x16));
+          block_sum_32x4 = _mm_add_epi32(block_sum_32x4,
+                                         DotProdInt8x4x4(ones_8x16, row_8x16));
+        }
+        const int32_t dotprod = ReduceInt32x4(dotprod_32x4) -
+                                ReduceInt32x4(block_sum_32x4) * batch_offset;
+        sum += dotprod * row_scales[block];
+        row_ptr += block_size;
+      }
+      *result += sum * scaling_factors[batch];
+      ++result;
+    }
+  }
+}
+
+void SseStructuredSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int n, int m, int m_rows, int m_cols, const float* __restrict__ vector,
+    int n_batch, float* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % m, 0);
+  const int kept_per_row = m_cols / m * n;
+#ifdef __AVX2__
+  // If n divides the vector size, every vector of kept values covers whole
+  // groups, and the column of each lane is its index plus a fixed offset from
+  // the first group.
+  const bool use_avx2 = kFloatValuesPerAvx2Vector % n == 0;
+  const int groups_per_vector = kFloatValuesPerAvx2Vector / n;
+  __m256i lane_offsets_32x8 = _mm256_setzero_si256();
+  if (use_avx2) {
+    int32_t lane_offsets[kFloatValuesPerAvx2Vector];
+    for (int lane = 0; lane < kFloatValuesPerAvx2Vector; ++lane) {
+      lane_offsets[lane] = lane / n * m;
+    }
+    lane_offsets_32x8 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lane_offsets));
+  }
+#endif  // __AVX2__
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      float dot_prod = 0.0f;
+      int i = 0;
+#ifdef __AVX2__
+      if (use_avx2) {
+        __m256 acc_32x8 = _mm256_setzero_ps();
+        const float* group_vector = vector_in_batch;
+        for (; i + kFloatValuesPerAvx2Vector <= kept_per_row;
+             i += kFloatValuesPerAvx2Vector) {
+          // Gather the 8 vector values matching the kept matrix values.
+          const __m256i cols_32x8 = _mm256_add_epi32(
+              lane_offsets_32x8,
+              _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                  reinterpret_cast<const __m128i*>(indices_ptr + i))));
+          const __m256 vector_f32x8 =
+              _mm256_i32gather_ps(group_vector, cols_32x8, sizeof(float));
+          const __m256 matrix_f32x8 = _mm256_loadu_ps(matrix_ptr + i);
+          acc_32x8 = _mm256_add_ps(acc_32x8,
+                                   _mm256_mul_ps(vector_f32x8, matrix_f32x8));
+          group_vector += groups_per_vector * m;
+        }
+        dot_prod = ReduceFloat32x8(acc_32x8);
+      }
+#endif  // __AVX2__
+      for (; i < kept_per_row; ++i) {
+        const int col = (i / n) * m + indices_ptr[i];
+        dot_prod += matrix_ptr[i] * vector_in_batch[col];
+      }
+      result[batch * m_rows + row] += dot_prod;
+      matrix_ptr += kept_per_row;
+      indices_ptr += kept_per_row;
+    }
+  }
+}
+
 namespace {
 
 // Implements sparse-matrix - vector multiply-accumulate.
@@ -193,6 +193,17 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 
+// Same as the function above, but the matrix has N:M structured sparsity, i.e.
+// each group of `m` consecutive values of a row has at most `n` non-zeros. The
+// matrix is stored as two arrays of m_rows * (m_cols / m) * n elements:
+//   1. `matrix` stores the n kept, possibly zero, values of each group.
+//   2. `indices` stores the position of each kept value within its group.
+// This function assumes that m_cols is a multiple of m.
+void StructuredSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int n, int m, int m_rows, int m_cols, const float* __restrict__ vector,
+    int n_batch, float* __restrict__ result);
+
 // Same as the function above, but the matrix is stored in block compressed
 // sparse row format with block pattern 1x16 which consists of two arrays:
 //   1. A matrix array stores non-zero blocks of the matrix in row major.
@@ -231,6 +242,19 @@ void MatrixBatchVectorMultiplyAccumulate(
     float* __restrict__ result, const float* __restrict__ per_channel_scale,
     const int32_t* __restrict__ input_offset);
 
+// Same as the function above, but the matrix is quantized block-wise: each
+// row is split into blocks of `block_size` consecutive values which have their
+// own scale. `block_scales` has `m_rows * m_cols / block_size` values, with
+// the scales of each row stored consecutively. The vectors are quantized
+// per-batch, `input_offset` may be null for symmetric quantization.
+// This function assumes that m_cols is a multiple of block_size and that the
+// matrix values lie in [-127, 127].
+void MatrixBatchVectorMultiplyAccumulateBlockwise(
+    const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
+    const int8_t* __restrict__ vectors, const float* scaling_factors,
+    int n_batch, const float* block_scales, int block_size,
+    const int32_t* input_offset, float* __restrict__ result);
+
 // Same as the function above, but the matrix is a sparse tensor with block
 // pattern 1x16.
 // This function assumes that m_cols is a multiple of the block size (16 in this
@@ -203,6 +203,35 @@ void PortableMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
+void PortableMatrixBatchVectorMultiplyAccumulateBlockwise(
+    const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
+    const int8_t* __restrict__ vectors, const float* scaling_factors,
+    int n_batch, const float* block_scales, int block_size,
+    const int32_t* input_offset, float* __restrict__ result) {
+  const int num_blocks = m_cols / block_size;
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int32_t batch_offset = input_offset ? input_offset[batch] : 0;
+    const int8_t* row_ptr = matrix;
+    const float* row_scales = block_scales;
+    for (int row = 0; row < m_rows; ++row, row_scales += num_blocks) {
+      float sum = 0.0f;
+      for (int block = 0; block < num_blocks; ++block) {
+        const int8_t* block_vector = vectors + block * block_size;
+        int32_t dotprod = 0;
+        int32_t block_sum = 0;
+        for (int col = 0; col < block_size; ++col, ++row_ptr) {
+          dotprod += (*row_ptr) * block_vector[col];
+          block_sum += *row_ptr;
+        }  // for col
+        dotprod -= block_sum * batch_offset;
+        sum += dotprod * row_scales[block];
+      }  // for block
+      *result += sum * scaling_factors[batch];
+      ++result;
+    }  // for row
+  }  // for batch
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
     const float* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -227,6 +256,27 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void PortableStructuredSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ indices,
+    int n, int m, int m_rows, int m_cols, const float* __restrict__ vector,
+    int n_batch, float* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % m, 0);
+  const int kept_per_row = m_cols / m * n;
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* indices_ptr = indices;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      float dot_prod = 0.0f;
+      for (int i = 0; i < kept_per_row; i++) {
+        const int col = (i / n) * m + *indices_ptr++;
+        dot_prod += *matrix_ptr++ * vector_in_batch[col];
+      }
+      result[batch * m_rows + row] += dot_prod;
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -111,6 +111,11 @@ bool Spectrogram::Initialize(const std::vector<double>& window,
   return true;
 }
 
+void Spectrogram::Reset() {
+  input_queue_.clear();
+  samples_to_next_step_ = window_length_;
+}
+
 template <class InputSample, class OutputSample>
 bool Spectrogram::ComputeComplexSpectrogram(
     const std::vector<InputSample>& input,
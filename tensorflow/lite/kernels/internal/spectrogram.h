@@ -55,6 +55,11 @@ class Spectrogram {
   // Initialize with an explicit window instead of a length.
   bool Initialize(const std::vector<double>& window, int step_length);
 
+  // Drops the buffered audio input, as if the class had just been
+  // initialized, but keeps the FFT working areas that are set up by the first
+  // FFT. Must be called after a successful call to Initialize().
+  void Reset();
+
   // Processes an arbitrary amount of audio data (contained in input)
   // to yield complex spectrogram frames. After a successful call to
   // Initialize(), Process() may be called repeatedly with new input data
@@ -17,6 +17,8 @@ limitations under the License.
 #include <math.h>
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include "tensorflow/lite/core/c/builtin_op_data.h"
@@ -514,6 +516,59 @@ TEST(uKernels, HybridMatrixBatchVectorMultiplyAccumulate8x8_16Test) {
   }
 }
 
+// Block-wise quantized matmul with 3 * 64 input and 5 * 64 matrix, for block
+// sizes with and without a vectorized implementation.
+TEST(uKernels, BlockwiseMatrixBatchVectorMultiplyAccumulateTest) {
+  constexpr int kRows = 5;
+  constexpr int kCols = 64;
+  constexpr int kBatches = 3;
+  std::vector<int8_t> matrix(kRows * kCols);
+  std::vector<int8_t> vectors(kBatches * kCols);
+  for (int i = 0; i < matrix.size(); ++i) {
+    matrix[i] = static_cast<int8_t>((i * 37) % 255 - 127);
+  }
+  for (int i = 0; i < vectors.size(); ++i) {
+    vectors[i] = static_cast<int8_t>((i * 53) % 256 - 128);
+  }
+  const std::vector<float> scaling_factors = {0.5f, 0.25f, 2.0f};
+  const std::vector<int32_t> input_offsets = {0, -3, 17};
+
+  for (const int block_size : {8, 16, 32, 64}) {
+    const int num_blocks = kCols / block_size;
+    std::vector<float> block_scales(kRows * num_blocks);
+    for (int i = 0; i < block_scales.size(); ++i) {
+      block_scales[i] = 0.125f * (i % 7 + 1);
+    }
+    for (const int32_t* offsets : {static_cast<const int32_t*>(nullptr),
+                                   input_offsets.data()}) {
+      std::vector<float> expected_output(kBatches * kRows, 1.0f);
+      for (int b = 0; b < kBatches; ++b) {
+        const int32_t offset = offsets ? offsets[b] : 0;
+        for (int r = 0; r < kRows; ++r) {
+          float sum = 0.0f;
+          for (int k = 0; k < num_blocks; ++k) {
+            int32_t dotprod = 0;
+            for (int c = k * block_size; c < (k + 1) * block_size; ++c) {
+              dotprod +=
+                  matrix[r * kCols + c] * (vectors[b * kCols + c] - offset);
+            }
+            sum += dotprod * block_scales[r * num_blocks + k];
+          }
+          expected_output[b * kRows + r] += sum * scaling_factors[b];
+        }
+      }
+
+      std::vector<float> output(kBatches * kRows, 1.0f);
+      MatrixBatchVectorMultiplyAccumulateBlockwise(
+          matrix.data(), kRows, kCols, vectors.data(), scaling_factors.data(),
+          kBatches, block_scales.data(), block_size, offsets, output.data());
+      EXPECT_THAT(output, testing::Pointwise(testing::FloatEq(),
+                                             expected_output))
+          << "block_size: " << block_size;
+    }
+  }
+}
+
 // Qautnized matmul with 2 * 30 input and 9 * 30 matrix.
 TEST(uKernels, QuantMatrixBatchVectorMultiplyAccumulate8x8_8Test) {
   CpuBackendContext context;
@@ -1557,6 +1612,47 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
               ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
 }
 
+TEST(uKernels, StructuredSparseMatrixBatchVectorMultiplyAccumulateTest) {
+  constexpr int kRows = 5;
+  constexpr int kBatches = 3;
+  for (const auto& [n, m] : std::vector<std::pair<int, int>>{
+           {1, 4}, {2, 4}, {2, 8}, {3, 8}, {4, 8}}) {
+    // 13 groups leave a remainder for every vector size.
+    const int cols = 13 * m;
+    const int kept = cols / m * n;
+    std::vector<float> matrix(kRows * cols, 0.0f);
+    std::vector<float> values(kRows * kept);
+    std::vector<uint8_t> indices(kRows * kept);
+    for (int r = 0; r < kRows; ++r) {
+      for (int k = 0; k < kept; ++k) {
+        const int group = k / n;
+        // Keep every other position, shifted with the group and the row.
+        const int index = (2 * (k % n) + group + r) % m;
+        const int i = r * kept + k;
+        indices[i] = index;
+        values[i] = 0.25f * (i % 11) - 1.0f;
+        matrix[r * cols + group * m + index] = values[i];
+      }
+    }
+    std::vector<float> vectors(kBatches * cols);
+    for (int i = 0; i < vectors.size(); ++i) {
+      vectors[i] = 0.5f * (i % 9) - 2.0f;
+    }
+
+    std::vector<float> dense_output(kBatches * kRows, 1.0f);
+    MatrixBatchVectorMultiplyAccumulate(matrix.data(), kRows, cols,
+                                        vectors.data(), kBatches,
+                                        dense_output.data());
+    std::vector<float> sparse_output(kBatches * kRows, 1.0f);
+    StructuredSparseMatrixBatchVectorMultiplyAccumulate(
+        values.data(), indices.data(), n, m, kRows, cols, vectors.data(),
+        kBatches, sparse_output.data());
+    EXPECT_THAT(sparse_output,
+                ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)))
+        << n << ":" << m;
+  }
+}
+
 #ifdef __ANDROID__
 TEST(uKernels,
      SparseMatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
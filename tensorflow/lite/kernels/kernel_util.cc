@@ -410,6 +410,27 @@ TfLiteStatus CalculateActivationRangeQuantized(TfLiteContext* context,
                                                output, act_min, act_max);
 }
 
+int GetBlockwiseQuantizationBlockSize(const TfLiteTensor* filter) {
+  if (filter->quantization.type != kTfLiteAffineQuantization ||
+      NumDimensions(filter) != 2) {
+    return 0;
+  }
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  if (!affine_quantization || !affine_quantization->scale ||
+      affine_quantization->quantized_dimension != 0) {
+    return 0;
+  }
+  const int num_units = filter->dims->data[0];
+  const int input_depth = filter->dims->data[1];
+  const int num_scales = affine_quantization->scale->size;
+  if (num_units == 0 || num_scales <= num_units || num_scales % num_units) {
+    return 0;
+  }
+  const int num_blocks = num_scales / num_units;
+  return input_depth % num_blocks == 0 ? input_depth / num_blocks : 0;
+}
+
 bool HaveSameShapes(const TfLiteTensor* input1, const TfLiteTensor* input2) {
   return TfLiteIntArrayEqual(input1->dims, input2->dims);
 }
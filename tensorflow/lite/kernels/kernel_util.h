@@ -239,6 +239,12 @@ inline bool IsHybridOp(const TfLiteTensor* input, const TfLiteTensor* weight) {
           input->type == kTfLiteFloat32);
 }
 
+// Returns the block size if `filter` is quantized block-wise, i.e. with one
+// scale per block of consecutive values along the input dimension of each
+// output channel, and 0 otherwise. The scales of an output channel are stored
+// consecutively.
+int GetBlockwiseQuantizationBlockSize(const TfLiteTensor* filter);
+
 // Check dimensionality match and populate OpData for Conv and DepthwiseConv.
 TfLiteStatus PopulateConvolutionQuantizationParams(
     TfLiteContext* context, const TfLiteTensor* input,
@@ -807,6 +807,35 @@ TEST_F(QuantizationParamsTest, IsMobilePlatform) {
 #endif
 }
 
+TEST_F(QuantizationParamsTest, BlockwiseQuantizationBlockSize) {
+  TensorUniquePtr filter =
+      BuildTfLiteTensor(kTfLiteInt8, {3, 8}, kTfLiteDynamic);
+  filter->quantization.type = kTfLiteAffineQuantization;
+  auto* filter_params = reinterpret_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  filter_params->scale = TfLiteFloatArrayCreate(3);
+  filter_params->zero_point = TfLiteIntArrayCreate(3);
+  filter_params->quantized_dimension = 0;
+  filter->quantization.params = reinterpret_cast<void*>(filter_params);
+  // Per-channel quantization.
+  EXPECT_EQ(GetBlockwiseQuantizationBlockSize(filter.get()), 0);
+
+  // Two blocks of 4 values per output channel.
+  TfLiteFloatArrayFree(filter_params->scale);
+  filter_params->scale = TfLiteFloatArrayCreate(6);
+  EXPECT_EQ(GetBlockwiseQuantizationBlockSize(filter.get()), 4);
+
+  // 8 values can't be split into 3 blocks.
+  TfLiteFloatArrayFree(filter_params->scale);
+  filter_params->scale = TfLiteFloatArrayCreate(9);
+  EXPECT_EQ(GetBlockwiseQuantizationBlockSize(filter.get()), 0);
+
+  TfLiteFloatArrayFree(filter_params->scale);
+  filter_params->scale = TfLiteFloatArrayCreate(6);
+  filter_params->quantized_dimension = 1;
+  EXPECT_EQ(GetBlockwiseQuantizationBlockSize(filter.get()), 0);
+}
+
 TEST(HasUnspecifiedDimensions, ReturnsTrueIfADimIsMinusOne) {
   auto tensor = BuildTfLiteTensor(kTfLiteInt32, {1, 1, 3}, kTfLiteDynamic);
   tensor->dims_signature = ConvertVectorToTfLiteIntArray({1, -1, 3});
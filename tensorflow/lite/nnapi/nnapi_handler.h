@@ -211,6 +211,17 @@ class NnApiHandler {
         [](ANeuralNetworksCompilation* compilation) { return Value; };
   }
 
+  void StubCompilationSetCachingWith(
+      int(stub)(ANeuralNetworksCompilation* compilation, const char* cacheDir,
+                const uint8_t* token)) {
+    nnapi_->ANeuralNetworksCompilation_setCaching = stub;
+  }
+
+  void StubBurstCreateWith(int(stub)(ANeuralNetworksCompilation* compilation,
+                                     ANeuralNetworksBurst** burst)) {
+    nnapi_->ANeuralNetworksBurst_create = stub;
+  }
+
   template <int Value>
   void ExecutionCreateReturns() {
     nnapi_->ANeuralNetworksExecution_create =
@@ -244,6 +255,11 @@ class NnApiHandler {
         [](ANeuralNetworksExecution* execution) { return Value; };
   }
 
+  void StubExecutionBurstComputeWith(int(stub)(
+      ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst)) {
+    nnapi_->ANeuralNetworksExecution_burstCompute = stub;
+  }
+
   template <int Value>
   void GetSupportedOperationsForDevicesReturns() {
     nnapi_->ANeuralNetworksModel_getSupportedOperationsForDevices =
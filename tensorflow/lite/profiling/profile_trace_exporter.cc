@@ -0,0 +1,509 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/profile_trace_exporter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common_internal.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+// The trace has a single process, whose tracks are the subgraphs.
+constexpr int kTracePid = 1;
+// Ops run inside delegate kernels overlap with the kernels, so they are put
+// on their own track per subgraph.
+constexpr int64_t kDelegateOpsTrackOffset = 1000;
+
+constexpr char kOpSummaryCsvHeader[] =
+    "name,type,runs,count,avg_us,min_us,max_us";
+
+std::string JsonString(const std::string& s) {
+  std::string escaped = "\"";
+  for (const char c : s) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buffer[8];
+          snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+          escaped += buffer;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped + "\"";
+}
+
+std::string CsvField(const std::string& s) {
+  if (s.find_first_of(",\"\n") == std::string::npos) return s;
+  std::string quoted = "\"";
+  for (const char c : s) {
+    if (c == '"') quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+// Splits a CSV line into its fields, handling quoted fields.
+bool SplitCsvLine(const std::string& line, std::vector<std::string>* fields) {
+  fields->clear();
+  std::string field;
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (quoted) {
+      if (c != '"') {
+        field += c;
+      } else if (i + 1 < line.size() && line[i + 1] == '"') {
+        field += '"';
+        ++i;
+      } else {
+        quoted = false;
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      fields->push_back(field);
+      field.clear();
+    } else {
+      field += c;
+    }
+  }
+  fields->push_back(field);
+  return !quoted;
+}
+
+std::string GetTensorNames(const tflite::Interpreter& interpreter,
+                           const TfLiteIntArray* tensor_indices) {
+  std::string names = "[";
+  for (int i = 0; i < tensor_indices->size; ++i) {
+    if (i > 0) names += ", ";
+    const TfLiteTensor* tensor = interpreter.tensor(tensor_indices->data[i]);
+    names += tensor && tensor->name ? tensor->name : "Unknown";
+  }
+  return names + "]";
+}
+
+std::string GetOpType(const TfLiteRegistration& registration) {
+  if (registration.builtin_code == BuiltinOperator_CUSTOM ||
+      registration.builtin_code == BuiltinOperator_DELEGATE) {
+    return registration.custom_name ? registration.custom_name : "Unknown";
+  }
+  return EnumNameBuiltinOperator(
+      static_cast<BuiltinOperator>(registration.builtin_code));
+}
+
+// Returns the nodes replaced by the delegate kernel `node` as a JSON array.
+std::string GetDelegatePartition(Subgraph* subgraph, const TfLiteNode& node) {
+  const TfLiteIntArray* nodes_to_replace = nullptr;
+  if (node.builtin_data != nullptr) {
+    if (TfLiteDelegateHasValidOpaqueDelegateBuilder(node.delegate)) {
+      nodes_to_replace =
+          static_cast<const TfLiteOpaqueDelegateParams*>(node.builtin_data)
+              ->nodes_to_replace;
+    } else {
+      nodes_to_replace =
+          static_cast<const TfLiteDelegateParams*>(node.builtin_data)
+              ->nodes_to_replace;
+    }
+  }
+  std::string partition = "[";
+  for (int i = 0; nodes_to_replace && i < nodes_to_replace->size; ++i) {
+    const int node_index = nodes_to_replace->data[i];
+    const auto* node_and_reg = subgraph->node_and_registration(node_index);
+    if (i > 0) partition += ",";
+    partition += JsonString(
+        (node_and_reg ? GetOpType(node_and_reg->second) : "Unknown") + ":" +
+        std::to_string(node_index));
+  }
+  return partition + "]";
+}
+
+}  // namespace
+
+ProfileTraceExporter::ProfileTraceExporter(const std::string& trace_name,
+                                           int max_traced_runs)
+    : trace_name_(trace_name), max_traced_runs_(max_traced_runs) {}
+
+void ProfileTraceExporter::AddInitEvents(
+    const std::vector<const ProfileEvent*>& events,
+    const tflite::Interpreter& interpreter) {
+  AddEvents(events, interpreter, /*is_run=*/false);
+}
+
+void ProfileTraceExporter::AddRunEvents(
+    const std::vector<const ProfileEvent*>& events,
+    const tflite::Interpreter& interpreter) {
+  if (events.empty()) return;
+  AddEvents(events, interpreter, /*is_run=*/true);
+  ++num_runs_;
+}
+
+void ProfileTraceExporter::AddCounter(const std::string& name, double value) {
+  std::ostringstream args;
+  args << "{\"value\":" << value << "}";
+  AddCounterEvent(name, last_timestamp_us_, args.str());
+}
+
+void ProfileTraceExporter::AddEvents(
+    const std::vector<const ProfileEvent*>& events,
+    const tflite::Interpreter& interpreter, bool is_run) {
+  const bool add_to_trace = !is_run || num_runs_ < max_traced_runs_;
+  auto& mutable_interpreter = const_cast<tflite::Interpreter&>(interpreter);
+  for (const ProfileEvent* event : events) {
+    const int64_t subgraph_index = event->extra_event_metadata;
+    const uint64_t begin_us = RelativeTime(event->begin_timestamp_us);
+    const uint64_t end_us = RelativeTime(event->begin_timestamp_us +
+                                         event->elapsed_time);
+    std::string name(event->tag);
+    std::string category;
+    int64_t track = subgraph_index;
+    std::ostringstream args;
+    args << "{";
+    switch (event->event_type) {
+      case Profiler::EventType::OPERATOR_INVOKE_EVENT: {
+        const int64_t node_index = event->event_metadata;
+        Subgraph* subgraph = mutable_interpreter.subgraph(subgraph_index);
+        const auto* node_and_reg =
+            subgraph ? subgraph->node_and_registration(node_index) : nullptr;
+        if (node_and_reg == nullptr) continue;
+        const TfLiteNode& node = node_and_reg->first;
+        std::string type = name;
+        const char* profiling_string =
+            interpreter.OpProfilingString(node_and_reg->second, &node);
+        if (profiling_string) type += std::string("/") + profiling_string;
+        const std::string outputs = GetTensorNames(interpreter, node.outputs);
+        category = node.delegate ? "delegate" : "op";
+        args << "\"node_index\":" << node_index
+             << ",\"subgraph_index\":" << subgraph_index
+             << ",\"outputs\":" << JsonString(outputs);
+        if (node.delegate) {
+          args << ",\"partition\":" << GetDelegatePartition(subgraph, node);
+        }
+        if (is_run) {
+          AddOpStats(outputs + ":" + std::to_string(node_index), type,
+                     event->elapsed_time);
+        }
+        break;
+      }
+      case Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT:
+      case Profiler::EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT: {
+        category = "delegate_op";
+        if (event->event_type ==
+            Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
+          track = kDelegateOpsTrackOffset + subgraph_index;
+        }
+        args << "\"delegate_node_index\":" << event->event_metadata;
+        if (is_run) {
+          AddOpStats(
+              "Delegate/" + name + ":" + std::to_string(event->event_metadata),
+              event->event_type ==
+                      Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT
+                  ? "DelegateOpInvoke"
+                  : name,
+              event->elapsed_time);
+        }
+        break;
+      }
+      default: {
+        category = is_run ? "runtime" : "init";
+        const memory::MemoryUsage& mem = event->end_mem_usage;
+        if (add_to_trace && memory::MemoryUsage::IsSupported() &&
+            mem.total_allocated_bytes != memory::MemoryUsage::kValueNotSet) {
+          std::ostringstream mem_args;
+          mem_args << "{\"footprint_kb\":" << mem.mem_footprint_kb
+                   << ",\"in_use_kb\":" << mem.in_use_allocated_bytes / 1024
+                   << "}";
+          AddCounterEvent("Memory", end_us, mem_args.str());
+        }
+        break;
+      }
+    }
+    args << "}";
+    if (add_to_trace) {
+      if (track_names_.count(track) == 0) {
+        track_names_[track] =
+            track < kDelegateOpsTrackOffset
+                ? "Subgraph " + std::to_string(track)
+                : "Subgraph " +
+                      std::to_string(track - kDelegateOpsTrackOffset) +
+                      " delegate ops";
+      }
+      AddTraceEvent(name, category, begin_us, end_us - begin_us, track,
+                    args.str());
+    }
+  }
+  if (add_to_trace) AddArenaCounters(interpreter);
+}
+
+void ProfileTraceExporter::AddArenaCounters(
+    const tflite::Interpreter& interpreter) {
+  auto& mutable_interpreter = const_cast<tflite::Interpreter&>(interpreter);
+  for (int i = 0; i < interpreter.subgraphs_size(); ++i) {
+    Subgraph::SubgraphAllocInfo info;
+    mutable_interpreter.subgraph(i)->GetMemoryAllocInfo(&info);
+    std::ostringstream args;
+    args << "{\"arena_kb\":" << info.arena_size / 1024
+         << ",\"persistent_arena_kb\":" << info.arena_persist_size / 1024
+         << ",\"dynamic_kb\":" << info.dynamic_size / 1024 << "}";
+    AddCounterEvent("Subgraph " + std::to_string(i) + " arena",
+                    last_timestamp_us_, args.str());
+  }
+}
+
+void ProfileTraceExporter::AddTraceEvent(const std::string& name,
+                                         const std::string& category,
+                                         uint64_t begin_us,
+                                         uint64_t duration_us, int64_t track,
+                                         const std::string& args) {
+  std::ostringstream event;
+  event << "{\"name\":" << JsonString(name)
+        << ",\"cat\":" << JsonString(category) << ",\"ph\":\"X\",\"ts\":"
+        << begin_us << ",\"dur\":" << duration_us << ",\"pid\":" << kTracePid
+        << ",\"tid\":" << track << ",\"args\":" << args << "}";
+  trace_events_.push_back(event.str());
+}
+
+void ProfileTraceExporter::AddCounterEvent(const std::string& name,
+                                           uint64_t timestamp_us,
+                                           const std::string& args) {
+  std::ostringstream event;
+  event << "{\"name\":" << JsonString(name) << ",\"ph\":\"C\",\"ts\":"
+        << timestamp_us << ",\"pid\":" << kTracePid << ",\"args\":" << args
+        << "}";
+  trace_events_.push_back(event.str());
+}
+
+void ProfileTraceExporter::AddOpStats(const std::string& name,
+                                      const std::string& type,
+                                      int64_t elapsed_us) {
+  const auto key = std::make_pair(name, type);
+  auto it = op_stats_index_.find(key);
+  if (it == op_stats_index_.end()) {
+    it = op_stats_index_.emplace(key, op_stats_.size()).first;
+    op_stats_.emplace_back();
+    op_stats_.back().summary.name = name;
+    op_stats_.back().summary.type = type;
+    op_stats_.back().summary.min_us = elapsed_us;
+  }
+  OpStats& stats = op_stats_[it->second];
+  stats.total_us += elapsed_us;
+  stats.summary.min_us = std::min(stats.summary.min_us, elapsed_us);
+  stats.summary.max_us = std::max(stats.summary.max_us, elapsed_us);
+  ++stats.summary.count;
+}
+
+uint64_t ProfileTraceExporter::RelativeTime(uint64_t timestamp_us) {
+  if (!has_base_timestamp_) {
+    has_base_timestamp_ = true;
+    base_timestamp_us_ = timestamp_us;
+  }
+  const uint64_t relative_us =
+      timestamp_us > base_timestamp_us_ ? timestamp_us - base_timestamp_us_
+                                        : 0;
+  last_timestamp_us_ = std::max(last_timestamp_us_, relative_us);
+  return relative_us;
+}
+
+std::string ProfileTraceExporter::GetChromeTrace() const {
+  std::ostringstream trace;
+  trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kTracePid
+        << ",\"args\":{\"name\":" << JsonString(trace_name_) << "}}";
+  for (const auto& track : track_names_) {
+    trace << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << kTracePid
+          << ",\"tid\":" << track.first
+          << ",\"args\":{\"name\":" << JsonString(track.second) << "}}";
+  }
+  for (const std::string& event : trace_events_) {
+    trace << ",\n" << event;
+  }
+  trace << "\n]}\n";
+  return trace.str();
+}
+
+std::string ProfileTraceExporter::GetOpSummaryCsv() const {
+  std::ostringstream csv;
+  csv << kOpSummaryCsvHeader << "\n";
+  for (const OpStats& stats : op_stats_) {
+    const OpSummary& op = stats.summary;
+    csv << CsvField(op.name) << "," << CsvField(op.type) << "," << num_runs_
+        << "," << op.count << ","
+        << static_cast<double>(stats.total_us) / op.count << "," << op.min_us
+        << "," << op.max_us << "\n";
+  }
+  return csv.str();
+}
+
+bool ParseOpSummaryCsv(const std::string& csv, std::vector<OpSummary>* ops) {
+  ops->clear();
+  std::istringstream stream(csv);
+  std::string line;
+  if (!std::getline(stream, line) || line != kOpSummaryCsvHeader) {
+    return false;
+  }
+  std::vector<std::string> fields;
+  while (std::getline(stream, line)) {
+    if (line.empty()) continue;
+    if (!SplitCsvLine(line, &fields) || fields.size() != 7) return false;
+    OpSummary op;
+    op.name = fields[0];
+    op.type = fields[1];
+    char* end = nullptr;
+    op.runs = strtoll(fields[2].c_str(), &end, 10);
+    if (*end != '\0') return false;
+    op.count = strtoll(fields[3].c_str(), &end, 10);
+    if (*end != '\0') return false;
+    op.avg_us = strtod(fields[4].c_str(), &end);
+    if (*end != '\0') return false;
+    op.min_us = strtoll(fields[5].c_str(), &end, 10);
+    if (*end != '\0') return false;
+    op.max_us = strtoll(fields[6].c_str(), &end, 10);
+    if (*end != '\0') return false;
+    ops->push_back(op);
+  }
+  return true;
+}
+
+namespace {
+
+// Average latency of `op` per inference.
+double UsPerRun(const OpSummary& op) {
+  return op.runs > 0 ? op.avg_us * op.count / op.runs : 0;
+}
+
+void AppendComparisonRow(const std::string& label, const double* baseline_us,
+                         const double* current_us, std::ostringstream* out) {
+  *out << std::left << std::setw(48) << label << std::right << std::fixed
+       << std::setprecision(3);
+  if (baseline_us) {
+    *out << std::setw(16) << *baseline_us;
+  } else {
+    *out << std::setw(16) << "-";
+  }
+  if (current_us) {
+    *out << std::setw(16) << *current_us;
+  } else {
+    *out << std::setw(16) << "-";
+  }
+  if (baseline_us && current_us && *baseline_us > 0) {
+    *out << std::setw(11) << std::setprecision(1)
+         << (*current_us - *baseline_us) * 100 / *baseline_us << "%";
+  } else {
+    *out << std::setw(12) << "-";
+  }
+  *out << "\n";
+}
+
+void AppendComparisonHeader(const std::string& title, const std::string& label,
+                            std::ostringstream* out) {
+  *out << title << "\n"
+       << std::left << std::setw(48) << label << std::right << std::setw(16)
+       << "[baseline us]" << std::setw(16) << "[us]" << std::setw(12)
+       << "[delta]"
+       << "\n";
+}
+
+}  // namespace
+
+std::string CompareOpSummaries(const std::vector<OpSummary>& baseline,
+                               const std::vector<OpSummary>& current) {
+  std::map<std::pair<std::string, std::string>, double> baseline_ops;
+  for (const OpSummary& op : baseline) {
+    baseline_ops[{op.name, op.type}] = UsPerRun(op);
+  }
+  std::ostringstream out;
+  AppendComparisonHeader("Per-inference latency of the ops:",
+                         "[node type] [name]", &out);
+  std::map<std::pair<std::string, std::string>, bool> seen;
+  for (const OpSummary& op : current) {
+    const auto key = std::make_pair(op.name, op.type);
+    seen[key] = true;
+    const auto it = baseline_ops.find(key);
+    const double current_us = UsPerRun(op);
+    AppendComparisonRow(op.type + " " + op.name,
+                        it != baseline_ops.end() ? &it->second : nullptr,
+                        &current_us, &out);
+  }
+  for (const OpSummary& op : baseline) {
+    const auto key = std::make_pair(op.name, op.type);
+    if (seen.count(key)) continue;
+    AppendComparisonRow(op.type + " " + op.name, &baseline_ops[key], nullptr,
+                        &out);
+  }
+
+  // Totals per op type, ordered by the current latency.
+  std::map<std::string, std::pair<double, double>> type_us;
+  std::map<std::string, std::pair<bool, bool>> type_present;
+  for (const OpSummary& op : baseline) {
+    type_us[op.type].first += UsPerRun(op);
+    type_present[op.type].first = true;
+  }
+  for (const OpSummary& op : current) {
+    type_us[op.type].second += UsPerRun(op);
+    type_present[op.type].second = true;
+  }
+  std::vector<std::string> types;
+  for (const auto& it : type_us) types.push_back(it.first);
+  std::stable_sort(types.begin(), types.end(),
+                   [&](const std::string& a, const std::string& b) {
+                     return type_us[a].second > type_us[b].second;
+                   });
+  out << "\n";
+  AppendComparisonHeader("Per-inference latency by op type:", "[node type]",
+                         &out);
+  double baseline_total = 0;
+  double current_total = 0;
+  for (const std::string& type : types) {
+    const auto& us = type_us[type];
+    const auto& present = type_present[type];
+    baseline_total += us.first;
+    current_total += us.second;
+    AppendComparisonRow(type, present.first ? &us.first : nullptr,
+                        present.second ? &us.second : nullptr, &out);
+  }
+  AppendComparisonRow("Total", &baseline_total, &current_total, &out);
+  return out.str();
+}
+
+}  // namespace profiling
+}  // namespace tflite
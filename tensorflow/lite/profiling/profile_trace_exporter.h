@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PROFILE_TRACE_EXPORTER_H_
+#define TENSORFLOW_LITE_PROFILING_PROFILE_TRACE_EXPORTER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/profiling/profile_buffer.h"
+
+namespace tflite {
+namespace profiling {
+
+// Average latency of an op over the profiled runs, as exported by
+// ProfileTraceExporter::GetOpSummaryCsv().
+struct OpSummary {
+  // Output tensors of the op and its node index, e.g. "[conv]:3".
+  std::string name;
+  // Op type, e.g. "CONV_2D" or the name of a delegate kernel.
+  std::string type;
+  // Number of profiled runs.
+  int64_t runs = 0;
+  // Number of invocations of the op over all runs.
+  int64_t count = 0;
+  double avg_us = 0;
+  int64_t min_us = 0;
+  int64_t max_us = 0;
+};
+
+// Converts the events recorded by a BufferedProfiler into a timeline in the
+// JSON trace event format, which both chrome://tracing and the Perfetto UI
+// load, and into per-op latency averages.
+//
+// In the trace, the ops of each subgraph are on their own track, and the ops
+// run inside delegate kernels on a separate one. Delegate kernels carry the
+// list of nodes of their partition, and the memory footprint, the arena sizes
+// of every subgraph and any counter added with AddCounter() are shown as
+// counter tracks.
+// This class is *not thread safe*.
+class ProfileTraceExporter {
+ public:
+  // Default number of runs kept in the timeline. The op summary includes all
+  // runs.
+  static constexpr int kDefaultMaxTracedRuns = 20;
+
+  // `trace_name` is shown as the process name in the trace, e.g. the path of
+  // the model.
+  explicit ProfileTraceExporter(const std::string& trace_name,
+                                int max_traced_runs = kDefaultMaxTracedRuns);
+
+  // Adds the events recorded while the interpreter was initialized, e.g. the
+  // delegate application and the tensor allocation. They are only part of
+  // the timeline.
+  void AddInitEvents(const std::vector<const ProfileEvent*>& events,
+                     const tflite::Interpreter& interpreter);
+
+  // Adds the events of one inference.
+  void AddRunEvents(const std::vector<const ProfileEvent*>& events,
+                    const tflite::Interpreter& interpreter);
+
+  // Adds a sample of the counter `name` after the last recorded event, e.g.
+  // the peak memory usage reported by a MemoryUsageMonitor.
+  void AddCounter(const std::string& name, double value);
+
+  bool HasEvents() const { return !trace_events_.empty(); }
+
+  // Returns the recorded events as a JSON trace.
+  std::string GetChromeTrace() const;
+
+  // Returns the per-op averages of all runs as CSV, one op per line, with the
+  // columns of OpSummary.
+  std::string GetOpSummaryCsv() const;
+
+ private:
+  struct OpStats {
+    OpSummary summary;
+    int64_t total_us = 0;
+  };
+
+  void AddEvents(const std::vector<const ProfileEvent*>& events,
+                 const tflite::Interpreter& interpreter, bool is_run);
+  void AddArenaCounters(const tflite::Interpreter& interpreter);
+  void AddTraceEvent(const std::string& name, const std::string& category,
+                     uint64_t begin_us, uint64_t duration_us, int64_t track,
+                     const std::string& args);
+  void AddCounterEvent(const std::string& name, uint64_t timestamp_us,
+                       const std::string& args);
+  void AddOpStats(const std::string& name, const std::string& type,
+                  int64_t elapsed_us);
+  uint64_t RelativeTime(uint64_t timestamp_us);
+
+  std::string trace_name_;
+  int max_traced_runs_;
+  int64_t num_runs_ = 0;
+  bool has_base_timestamp_ = false;
+  uint64_t base_timestamp_us_ = 0;
+  uint64_t last_timestamp_us_ = 0;
+  // Serialized JSON objects of the trace events.
+  std::vector<std::string> trace_events_;
+  // Names of the tracks used by the events.
+  std::map<int64_t, std::string> track_names_;
+  // Op stats in the order the ops were first seen.
+  std::vector<OpStats> op_stats_;
+  std::map<std::pair<std::string, std::string>, size_t> op_stats_index_;
+};
+
+// Parses the output of ProfileTraceExporter::GetOpSummaryCsv(). Returns false
+// if `csv` is malformed.
+bool ParseOpSummaryCsv(const std::string& csv, std::vector<OpSummary>* ops);
+
+// Returns a report comparing the per-inference latency of the ops in
+// `current` with the ops of the same name and type in `baseline`, and the
+// total latency per op type. The latter is also meaningful when comparing two
+// different models or delegate configurations, whose ops don't match one by
+// one.
+std::string CompareOpSummaries(const std::vector<OpSummary>& baseline,
+                               const std::vector<OpSummary>& current);
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PROFILE_TRACE_EXPORTER_H_
@@ -0,0 +1,164 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/profile_trace_exporter.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TfLiteStatus SimpleOpEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, /*index=*/0, &input));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, /*index=*/0, &output));
+  *output->data.i32 = *input->data.i32 + 1;
+  return kTfLiteOk;
+}
+
+TfLiteRegistration* RegisterSimpleOp() {
+  static TfLiteRegistration registration = {
+      nullptr,        nullptr, nullptr,
+      SimpleOpEval,   nullptr, tflite::BuiltinOperator_CUSTOM,
+      "SimpleOpEval", 1};
+  return &registration;
+}
+
+class SimpleOpModel : public SingleOpModel {
+ public:
+  SimpleOpModel() {
+    input_ = AddInput({TensorType_INT32, {1}});
+    output_ = AddOutput({TensorType_INT32, {}});
+    SetCustomOp("SimpleOpEval", {}, RegisterSimpleOp);
+    BuildInterpreter({GetShape(input_)});
+  }
+  tflite::Interpreter* GetInterpreter() { return interpreter_.get(); }
+  void SetInput(int32_t x) { PopulateTensor(input_, {x}); }
+
+ private:
+  int input_;
+  int output_;
+};
+
+// Profiles `num_runs` inferences of a SimpleOpModel.
+ProfileTraceExporter ProfileSimpleOp(int num_runs, int max_traced_runs) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  Interpreter* interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  ProfileTraceExporter exporter("simple_model", max_traced_runs);
+  m.SetInput(1);
+  for (int i = 0; i < num_runs; ++i) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    EXPECT_EQ(m.Invoke(), kTfLiteOk);
+    profiler.StopProfiling();
+    exporter.AddRunEvents(profiler.GetProfileEvents(), *interpreter);
+  }
+  interpreter->SetProfiler(nullptr);
+  return exporter;
+}
+
+TEST(ProfileTraceExporterTest, Empty) {
+  ProfileTraceExporter exporter("empty");
+  EXPECT_FALSE(exporter.HasEvents());
+  EXPECT_THAT(exporter.GetChromeTrace(), HasSubstr("\"traceEvents\":["));
+  std::vector<OpSummary> ops;
+  ASSERT_TRUE(ParseOpSummaryCsv(exporter.GetOpSummaryCsv(), &ops));
+  EXPECT_TRUE(ops.empty());
+}
+
+TEST(ProfileTraceExporterTest, ChromeTrace) {
+  ProfileTraceExporter exporter = ProfileSimpleOp(/*num_runs=*/2,
+                                                  /*max_traced_runs=*/1);
+  ASSERT_TRUE(exporter.HasEvents());
+  const std::string trace = exporter.GetChromeTrace();
+  EXPECT_THAT(trace, HasSubstr("\"args\":{\"name\":\"simple_model\"}"));
+  EXPECT_THAT(trace, HasSubstr("\"args\":{\"name\":\"Subgraph 0\"}"));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"Invoke\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"SimpleOpEval\",\"cat\":\"op\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"Subgraph 0 arena\",\"ph\":\"C\""));
+  // Only the first run is in the timeline.
+  const std::string op_event = "\"name\":\"SimpleOpEval\"";
+  const size_t first = trace.find(op_event);
+  ASSERT_NE(first, std::string::npos);
+  EXPECT_EQ(trace.find(op_event, first + 1), std::string::npos);
+}
+
+TEST(ProfileTraceExporterTest, OpSummaryIncludesAllRuns) {
+  ProfileTraceExporter exporter = ProfileSimpleOp(/*num_runs=*/3,
+                                                  /*max_traced_runs=*/1);
+  std::vector<OpSummary> ops;
+  ASSERT_TRUE(ParseOpSummaryCsv(exporter.GetOpSummaryCsv(), &ops));
+  ASSERT_EQ(ops.size(), 1);
+  EXPECT_EQ(ops[0].type, "SimpleOpEval");
+  EXPECT_THAT(ops[0].name, HasSubstr(":0"));
+  EXPECT_EQ(ops[0].runs, 3);
+  EXPECT_EQ(ops[0].count, 3);
+  EXPECT_LE(ops[0].min_us, ops[0].max_us);
+}
+
+TEST(ProfileTraceExporterTest, ParseOpSummaryCsv) {
+  std::vector<OpSummary> ops;
+  ASSERT_TRUE(ParseOpSummaryCsv(
+      "name,type,runs,count,avg_us,min_us,max_us\n"
+      "\"[a, b]:0\",CONV_2D,2,2,10.5,10,11\n"
+      "\"[\"\"c\"\"]:1\",ADD,2,4,1,1,1\n",
+      &ops));
+  ASSERT_EQ(ops.size(), 2);
+  EXPECT_EQ(ops[0].name, "[a, b]:0");
+  EXPECT_EQ(ops[0].type, "CONV_2D");
+  EXPECT_DOUBLE_EQ(ops[0].avg_us, 10.5);
+  EXPECT_EQ(ops[0].max_us, 11);
+  EXPECT_EQ(ops[1].name, "[\"c\"]:1");
+  EXPECT_EQ(ops[1].count, 4);
+
+  EXPECT_FALSE(ParseOpSummaryCsv("a,b\n", &ops));
+  EXPECT_FALSE(ParseOpSummaryCsv(
+      "name,type,runs,count,avg_us,min_us,max_us\nx,ADD,2,two,1,1,1\n", &ops));
+}
+
+TEST(ProfileTraceExporterTest, CompareOpSummaries) {
+  std::vector<OpSummary> baseline(2);
+  baseline[0] = {"[a]:0", "CONV_2D", 1, 1, 100, 100, 100};
+  baseline[1] = {"[b]:1", "ADD", 1, 1, 10, 10, 10};
+  std::vector<OpSummary> current(1);
+  current[0] = {"[b]:0", "TfLiteXNNPackDelegate", 2, 2, 50, 50, 50};
+
+  const std::string report = CompareOpSummaries(baseline, current);
+  EXPECT_THAT(report, HasSubstr("CONV_2D [a]:0"));
+  EXPECT_THAT(report, HasSubstr("TfLiteXNNPackDelegate [b]:0"));
+  EXPECT_THAT(report, HasSubstr("Per-inference latency by op type:"));
+  // 110 us in the baseline vs 50 us.
+  EXPECT_THAT(report, HasSubstr("110.000"));
+  EXPECT_THAT(report, HasSubstr("-54.5%"));
+  EXPECT_THAT(report, Not(HasSubstr("nan")));
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -596,6 +596,8 @@ def build_conversion_flags(
     qdq_conversion_mode=None,
     disable_per_channel_quantization_for_dense_layers=False,
     enable_composite_direct_lowering=False,
+    weight_block_size=0,
+    weight_block_int4=False,
     **_,
 ):
   """Builds protocol buffer describing a conversion of a model.
@@ -727,6 +729,12 @@ def build_conversion_flags(
       layers. The flag works only for integer quantized model.
     enable_composite_direct_lowering: If set, attempts to lower composite ops
       directly to tflite ops.
+    weight_block_size: If positive with post-training dynamic range
+      quantization, quantizes the weights of fully connected ops block-wise
+      with one scale per `weight_block_size` input values of each output
+      channel.
+    weight_block_int4: If set, stores the block-wise quantized weights as int4
+      instead of int8.
 
   Returns:
     conversion_flags: protocol buffer describing the conversion process.
@@ -850,6 +858,8 @@ def build_conversion_flags(
   conversion_flags.enable_composite_direct_lowering = (
       enable_composite_direct_lowering
   )
+  conversion_flags.weight_block_size = weight_block_size
+  conversion_flags.weight_block_int4 = weight_block_int4
   return conversion_flags
 
 
@@ -672,6 +672,8 @@ class TFLiteConverterBase:
     self._experimental_qdq_conversion_mode = None
     self._experimental_disable_per_channel_quantization_for_dense_layers = False
     self._experimental_enable_composite_direct_lowering = False
+    self._experimental_weight_block_size = 0
+    self._experimental_weight_block_int4 = False
 
     # Debug parameters
     self.ir_dump_dir = None
@@ -832,6 +834,8 @@ class TFLiteConverterBase:
         "enable_composite_direct_lowering": (
             self._experimental_enable_composite_direct_lowering
         ),
+        "weight_block_size": self._experimental_weight_block_size,
+        "weight_block_int4": self._experimental_weight_block_int4,
     }
 
     if self.saved_model_dir:
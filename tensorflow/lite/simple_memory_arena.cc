@@ -234,7 +234,8 @@ TfLiteStatus SimpleMemoryArena::Allocate(
     TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
     int32_t first_node, int32_t last_node,
     ArenaAllocWithUsageInterval* new_alloc) {
-  TF_LITE_ENSURE(context, alignment <= underlying_buffer_.GetAlignment());
+  TF_LITE_ENSURE(context,
+                 alignment <= underlying_buffer_->buffer.GetAlignment());
   new_alloc->tensor = tensor;
   new_alloc->first_node = first_node;
   new_alloc->last_node = last_node;
@@ -288,7 +289,14 @@ TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
   // based, they will remain valid in the new memory block.
-  *arena_reallocated = underlying_buffer_.Resize(high_water_mark_);
+  *arena_reallocated = underlying_buffer_->buffer.Resize(high_water_mark_);
+  // Tensors must be resolved again if another arena sharing the buffer used it
+  // in between.
+  if (underlying_buffer_->committed_by != nullptr &&
+      underlying_buffer_->committed_by != this) {
+    *arena_reallocated = true;
+  }
+  underlying_buffer_->committed_by = this;
   committed_ = true;
   return kTfLiteOk;
 }
@@ -296,14 +304,14 @@ TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
 TfLiteStatus SimpleMemoryArena::ResolveAlloc(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc,
     char** output_ptr) {
-  TF_LITE_ENSURE(context, committed_);
+  TF_LITE_ENSURE(context, IsCommitted());
   TF_LITE_ENSURE(context, output_ptr != nullptr);
-  TF_LITE_ENSURE(context,
-                 underlying_buffer_.GetSize() >= (alloc.offset + alloc.size));
+  TF_LITE_ENSURE(context, underlying_buffer_->buffer.GetSize() >=
+                              (alloc.offset + alloc.size));
   if (alloc.size == 0) {
     *output_ptr = nullptr;
   } else {
-    *output_ptr = underlying_buffer_.GetPtr() + alloc.offset;
+    *output_ptr = underlying_buffer_->buffer.GetPtr() + alloc.offset;
   }
   return kTfLiteOk;
 }
@@ -317,10 +325,21 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
 
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
-  underlying_buffer_.Release();
+  // Keep the memory another arena sharing the buffer may be using.
+  if (underlying_buffer_->committed_by == this ||
+      underlying_buffer_->committed_by == nullptr) {
+    underlying_buffer_->buffer.Release();
+    underlying_buffer_->committed_by = nullptr;
+  }
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::ShareBufferWith(SimpleMemoryArena& other) {
+  if (underlying_buffer_ == other.underlying_buffer_) return;
+  ReleaseBuffer();
+  underlying_buffer_ = other.underlying_buffer_;
+}
+
 // Using weak symbols to create a pluggable debugging module.
 TFLITE_ATTRIBUTE_WEAK void DumpArenaInfo(
     const std::string& name, const std::vector<int>& execution_plan,
@@ -329,8 +348,7 @@ TFLITE_ATTRIBUTE_WEAK void DumpArenaInfo(
 
 void SimpleMemoryArena::DumpDebugInfo(
     const std::string& name, const std::vector<int>& execution_plan) const {
-  tflite::DumpArenaInfo(name, execution_plan, underlying_buffer_.GetSize(),
-                        active_allocs_);
+  tflite::DumpArenaInfo(name, execution_plan, GetBufferSize(), active_allocs_);
 }
 
 }  // namespace tflite
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -107,10 +108,17 @@ class ResizableAlignedBuffer {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
+  // The allocation plan of an arena, i.e. everything `Allocate` computes.
+  struct Plan {
+    size_t high_water_mark = 0;
+    std::vector<ArenaAllocWithUsageInterval> active_allocs;
+  };
+
   explicit SimpleMemoryArena(size_t arena_alignment, int subgraph_index = 0)
       : committed_(false),
         high_water_mark_(0),
-        underlying_buffer_(arena_alignment, subgraph_index),
+        underlying_buffer_(
+            std::make_shared<SharedBuffer>(arena_alignment, subgraph_index)),
         active_allocs_() {}
 
   // Delete all allocs. This should be called when allocating the first node of
@@ -153,15 +161,44 @@ class SimpleMemoryArena {
   // again.
   TfLiteStatus ClearPlan();
 
+  // Returns the current allocation plan, which can be passed to `RestorePlan`
+  // later to avoid recomputing it.
+  Plan SavePlan() const { return {high_water_mark_, active_allocs_}; }
+
+  // Replaces the current allocation plan with `plan`. Like after `Allocate`,
+  // the arena must be committed & allocations resolved before use.
+  void RestorePlan(const Plan& plan) {
+    committed_ = false;
+    high_water_mark_ = plan.high_water_mark;
+    active_allocs_ = plan.active_allocs;
+  }
+
   // This releases the underlying buffer but does not clear the allocation plan.
   // Since all associated pointers are invalidated, the arena cannot be used
   // again until Commit() is called & tensor allocations are resolved.
+  // If the buffer is shared and currently committed by another arena, it is
+  // left untouched.
   TfLiteStatus ReleaseBuffer();
 
-  size_t GetBufferSize() const { return underlying_buffer_.GetSize(); }
+  // Makes this arena use the same underlying buffer as `other`, releasing its
+  // own. Only one of the arenas sharing a buffer can be used at a time: once
+  // another arena commits the buffer, this arena is no longer committed and
+  // Commit() must be called & tensor allocations resolved again.
+  void ShareBufferWith(SimpleMemoryArena& other);
+
+  // Returns true if the underlying buffer is shared with other arenas.
+  bool IsBufferShared() const { return underlying_buffer_.use_count() > 1; }
+
+  // Returns true if Commit() was called and no other arena sharing the
+  // underlying buffer committed it since.
+  bool IsCommitted() const {
+    return committed_ && underlying_buffer_->committed_by == this;
+  }
+
+  size_t GetBufferSize() const { return underlying_buffer_->buffer.GetSize(); }
 
   std::intptr_t BasePointer() const {
-    return reinterpret_cast<std::intptr_t>(underlying_buffer_.GetPtr());
+    return reinterpret_cast<std::intptr_t>(underlying_buffer_->buffer.GetPtr());
   }
 
   // Dumps the memory allocation information of this memory arena (which could
@@ -182,9 +219,20 @@ class SimpleMemoryArena {
                      const std::vector<int>& execution_plan) const;
 
  private:
+  // A buffer which may back several arenas, see ShareBufferWith().
+  struct SharedBuffer {
+    SharedBuffer(size_t alignment, int subgraph_index)
+        : buffer(alignment, subgraph_index) {}
+
+    ResizableAlignedBuffer buffer;
+    // The arena which committed the buffer last, if any. The allocations of
+    // the other arenas may have been moved or overwritten.
+    const SimpleMemoryArena* committed_by = nullptr;
+  };
+
   bool committed_;
   size_t high_water_mark_;
-  ResizableAlignedBuffer underlying_buffer_;
+  std::shared_ptr<SharedBuffer> underlying_buffer_;
   std::vector<ArenaAllocWithUsageInterval> active_allocs_;
 };
 
@@ -279,6 +279,47 @@ TEST(SimpleMemoryArenaTest, TestResetAllocs) {
   ASSERT_EQ(allocs[3].offset, 0);
 }
 
+TEST(SimpleMemoryArenaTest, TestSharedBuffer) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  SimpleMemoryArena arena1(64);
+  SimpleMemoryArena arena2(64);
+  arena2.ShareBufferWith(arena1);
+  EXPECT_TRUE(arena1.IsBufferShared());
+  EXPECT_TRUE(arena2.IsBufferShared());
+  ArenaAllocWithUsageInterval alloc1, alloc2;
+  arena1.Allocate(&context, 32, 1023, 0, 0, 2, &alloc1);
+  arena2.Allocate(&context, 32, 4095, 0, 0, 2, &alloc2);
+
+  bool reallocated = false;
+  ASSERT_EQ(arena1.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  EXPECT_TRUE(arena1.IsCommitted());
+  char* resolved_ptr = nullptr;
+  ASSERT_EQ(arena1.ResolveAlloc(&context, alloc1, &resolved_ptr), kTfLiteOk);
+  EXPECT_NE(resolved_ptr, nullptr);
+
+  // Committing the other arena invalidates the allocations of the first one,
+  // and grows the buffer to fit both.
+  ASSERT_EQ(arena2.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(arena2.IsCommitted());
+  EXPECT_FALSE(arena1.IsCommitted());
+  EXPECT_NE(arena1.ResolveAlloc(&context, alloc1, &resolved_ptr), kTfLiteOk);
+  EXPECT_EQ(arena1.GetBufferSize(), 4095);
+  EXPECT_EQ(arena1.BasePointer(), arena2.BasePointer());
+
+  // Releasing an arena which is not committed keeps the buffer of the other.
+  ASSERT_EQ(arena1.ReleaseBuffer(), kTfLiteOk);
+  EXPECT_NE(arena2.BasePointer(), 0);
+
+  // Committing the first arena again must resolve the tensors again.
+  ASSERT_EQ(arena1.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  ASSERT_EQ(arena1.ResolveAlloc(&context, alloc1, &resolved_ptr), kTfLiteOk);
+  ASSERT_EQ(arena1.ReleaseBuffer(), kTfLiteOk);
+  EXPECT_EQ(arena2.BasePointer(), 0);
+}
+
 TEST(SimpleMemoryArenaTest, TestClearBuffer) {
   TfLiteContext context;
   context.ReportError = ReportError;
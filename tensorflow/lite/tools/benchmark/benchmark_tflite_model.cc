@@ -485,6 +485,12 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_profiling_trace_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_profiling_summary_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_profiling_baseline_file",
+                          BenchmarkParam::Create<std::string>(""));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -573,6 +579,18 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<std::string>(
+          "op_profiling_trace_file", &params_,
+          "File path to export the timeline of the profiled ops to, in the "
+          "JSON trace format of chrome://tracing and the Perfetto UI."),
+      CreateFlag<std::string>(
+          "op_profiling_summary_file", &params_,
+          "File path to export the per-op average latencies to as CSV."),
+      CreateFlag<std::string>(
+          "op_profiling_baseline_file", &params_,
+          "Path of a file exported with --op_profiling_summary_file, e.g. for "
+          "another model or delegate configuration, to compare the per-op "
+          "latencies with."),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -657,6 +675,13 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "op_profiling_trace_file",
+                      "File to export the op trace to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "op_profiling_summary_file",
+                      "File to export the per-op latencies to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "op_profiling_baseline_file",
+                      "File with the per-op latencies to compare with",
+                      verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -1125,7 +1150,11 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      ProfileExportOptions{
+          params_.Get<std::string>("op_profiling_trace_file"),
+          params_.Get<std::string>("op_profiling_summary_file"),
+          params_.Get<std::string>("op_profiling_baseline_file")}));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() {
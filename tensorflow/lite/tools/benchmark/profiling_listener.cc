@@ -16,8 +16,12 @@ limitations under the License.
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
+#include "tensorflow/lite/profiling/profile_trace_exporter.h"
 #include "tensorflow/lite/tools/logging.h"
 
 namespace tflite {
@@ -26,12 +30,14 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_initial_entries,
     bool allow_dynamic_buffer_increase, const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    const ProfileExportOptions& export_options)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
       interpreter_(interpreter),
-      profiler_(max_num_initial_entries, allow_dynamic_buffer_increase) {
+      profiler_(max_num_initial_entries, allow_dynamic_buffer_increase),
+      export_options_(export_options) {
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
 
@@ -49,6 +55,13 @@ void ProfilingListener::OnBenchmarkStart(const BenchmarkParams& params) {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   init_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (!export_options_.trace_file_path.empty() ||
+      !export_options_.op_summary_file_path.empty() ||
+      !export_options_.baseline_op_summary_file_path.empty()) {
+    trace_exporter_ = std::make_unique<profiling::ProfileTraceExporter>(
+        params.HasParam("graph") ? params.Get<std::string>("graph") : "");
+    trace_exporter_->AddInitEvents(profile_events, *interpreter_);
+  }
   profiler_.Reset();
 }
 
@@ -63,6 +76,9 @@ void ProfilingListener::OnSingleRunEnd() {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   run_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (trace_exporter_) {
+    trace_exporter_->AddRunEvents(profile_events, *interpreter_);
+  }
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
@@ -81,6 +97,48 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
   }
+  if (trace_exporter_) ExportProfiles(results);
+}
+
+void ProfilingListener::ExportProfiles(const BenchmarkResults& results) {
+  if (results.peak_mem_mb() > 0) {
+    trace_exporter_->AddCounter("Peak memory footprint (MB)",
+                                results.peak_mem_mb());
+  }
+  if (!export_options_.trace_file_path.empty()) {
+    std::ofstream trace_file(export_options_.trace_file_path);
+    trace_file << trace_exporter_->GetChromeTrace();
+    if (!trace_file.good()) {
+      TFLITE_LOG(ERROR) << "Failed to write the op trace to "
+                        << export_options_.trace_file_path;
+    }
+  }
+  const std::string op_summary = trace_exporter_->GetOpSummaryCsv();
+  if (!export_options_.op_summary_file_path.empty()) {
+    std::ofstream summary_file(export_options_.op_summary_file_path);
+    summary_file << op_summary;
+    if (!summary_file.good()) {
+      TFLITE_LOG(ERROR) << "Failed to write the op summary to "
+                        << export_options_.op_summary_file_path;
+    }
+  }
+  if (!export_options_.baseline_op_summary_file_path.empty()) {
+    std::ifstream baseline_file(export_options_.baseline_op_summary_file_path);
+    std::stringstream baseline_csv;
+    baseline_csv << baseline_file.rdbuf();
+    std::vector<profiling::OpSummary> baseline;
+    std::vector<profiling::OpSummary> current;
+    if (!baseline_file.is_open() ||
+        !profiling::ParseOpSummaryCsv(baseline_csv.str(), &baseline)) {
+      TFLITE_LOG(ERROR) << "Failed to read the op summary in "
+                        << export_options_.baseline_op_summary_file_path;
+    } else if (profiling::ParseOpSummaryCsv(op_summary, &current)) {
+      WriteOutput("Op Profiling Comparison with " +
+                      export_options_.baseline_op_summary_file_path + ":",
+                  profiling::CompareOpSummaries(baseline, current),
+                  &TFLITE_LOG(INFO));
+    }
+  }
 }
 
 void ProfilingListener::WriteOutput(const std::string& header,
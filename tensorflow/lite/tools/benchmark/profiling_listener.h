@@ -22,11 +22,25 @@ limitations under the License.
 #include "tensorflow/lite/profiling/buffered_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/profile_trace_exporter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 
 namespace tflite {
 namespace benchmark {
 
+// Machine-readable exports of the profiling events. Exports with an empty
+// path are disabled.
+struct ProfileExportOptions {
+  // Timeline of the ops in the JSON trace format of chrome://tracing and the
+  // Perfetto UI.
+  std::string trace_file_path;
+  // Per-op average latencies as CSV.
+  std::string op_summary_file_path;
+  // Per-op latencies exported by a previous benchmark, which the latencies of
+  // this one are compared with.
+  std::string baseline_op_summary_file_path;
+};
+
 // Dumps profiling events if profiling is enabled.
 class ProfilingListener : public BenchmarkListener {
  public:
@@ -34,7 +48,8 @@ class ProfilingListener : public BenchmarkListener {
       Interpreter* interpreter, uint32_t max_num_initial_entries,
       bool allow_dynamic_buffer_increase, const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      const ProfileExportOptions& export_options = {});
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -52,8 +67,11 @@ class ProfilingListener : public BenchmarkListener {
  private:
   void WriteOutput(const std::string& header, const string& data,
                    std::ostream* stream);
+  void ExportProfiles(const BenchmarkResults& results);
   Interpreter* interpreter_;
   profiling::BufferedProfiler profiler_;
+  ProfileExportOptions export_options_;
+  std::unique_ptr<profiling::ProfileTraceExporter> trace_exporter_;
 };
 
 }  // namespace benchmark
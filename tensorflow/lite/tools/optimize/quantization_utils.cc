@@ -620,6 +620,69 @@ TfLiteStatus SymmetricQuantizeTensorPerChannel(ModelT* model, TensorT* tensor,
                                model, tensor, error_reporter);
 }
 
+TfLiteStatus SymmetricQuantizeTensorBlockwise(ModelT* model, TensorT* tensor,
+                                              int32_t block_size,
+                                              TensorType output_type,
+                                              ErrorReporter* error_reporter) {
+  if (tensor->shape.size() != 2 || block_size <= 0 ||
+      tensor->shape[1] % block_size != 0) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter,
+        "SymmetricQuantizeTensorBlockwise requires a 2-D tensor whose last "
+        "dimension is a multiple of the block size %d.",
+        block_size);
+    return kTfLiteError;
+  }
+  if (output_type != TensorType_INT8 && output_type != TensorType_INT4) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Block-wise quantization supports only INT8 and INT4 "
+                         "output types.");
+    return kTfLiteError;
+  }
+  const int32_t num_rows = tensor->shape[0];
+  const int32_t num_blocks = tensor->shape[1] / block_size;
+  const int8_t max_value = output_type == TensorType_INT4
+                               ? kMaxQuantizedValue4bit
+                               : kMaxQuantizedValue8bit;
+  const float* float_data = reinterpret_cast<const float*>(
+      model->buffers[tensor->buffer]->data.data());
+
+  std::vector<float> scales(num_rows * num_blocks);
+  std::vector<int8_t> quantized(num_rows * tensor->shape[1]);
+  for (int32_t block = 0; block < num_rows * num_blocks; ++block) {
+    const float* block_data = float_data + block * block_size;
+    float half_range = 0;
+    for (int32_t i = 0; i < block_size; ++i) {
+      half_range = std::max(half_range, std::abs(block_data[i]));
+    }
+    scales[block] = half_range / max_value;
+    const float scale_inv = half_range == 0 ? 0 : max_value / half_range;
+    for (int32_t i = 0; i < block_size; ++i) {
+      const int32_t quantized_value =
+          static_cast<int32_t>(TfLiteRound(block_data[i] * scale_inv));
+      quantized[block * block_size + i] = static_cast<int8_t>(
+          std::min<int32_t>(max_value, std::max<int32_t>(-max_value,
+                                                         quantized_value)));
+    }
+  }
+
+  std::vector<uint8_t> buffer;
+  if (output_type == TensorType_INT4) {
+    // Two values per byte, the first one in the low nibble.
+    buffer.resize((quantized.size() + 1) / 2);
+    for (size_t i = 0; i < quantized.size(); ++i) {
+      buffer[i / 2] |= (static_cast<uint8_t>(quantized[i]) & 0x0F)
+                       << (i % 2 * 4);
+    }
+  } else {
+    buffer.assign(quantized.begin(), quantized.end());
+  }
+  std::vector<int64_t> zero_point(scales.size(), 0);
+  return AddQuantizationParams(scales, zero_point, /*quantized_dimension=*/0,
+                               buffer.data(), buffer.size(), output_type,
+                               model, tensor, error_reporter);
+}
+
 template <class BiasType>
 std::vector<BiasType> SymmetricBiasQuantize(const float* data,
                                             uint64_t num_elements,
@@ -109,6 +109,15 @@ TfLiteStatus SymmetricQuantizeTensorPerChannel(ModelT* model, TensorT* tensor,
                                                int32_t channel_dim_index,
                                                ErrorReporter* error_reporter);
 
+// Quantizes a 2-D tensor block-wise: each row gets one symmetric scale per
+// `block_size` consecutive values. The scales are stored row-major with
+// quantized dimension 0, and `output_type` is either TensorType_INT8 or
+// TensorType_INT4 (packed two values per byte).
+TfLiteStatus SymmetricQuantizeTensorBlockwise(ModelT* model, TensorT* tensor,
+                                              int32_t block_size,
+                                              TensorType output_type,
+                                              ErrorReporter* error_reporter);
+
 // Symmetrically quantizes float to 16bits.
 TfLiteStatus SymmetricQuantizeFloatsToInt16(ModelT* model, TensorT* tensor,
                                             float scaling_factor,
@@ -713,6 +713,66 @@ TEST_F(QuantizationUtilsTest, QuantizeFloat16) {
   EXPECT_EQ(quant_buffer_size * 2, float_buffer_size);
 }
 
+// Returns a model with a single [2, 4] float tensor with 4 blocks of 2 values.
+std::unique_ptr<ModelT> CreateBlockwiseModel() {
+  auto model = std::make_unique<ModelT>();
+  auto subgraph = std::make_unique<tflite::SubGraphT>();
+  auto tensor = std::make_unique<TensorT>();
+  auto buffer = std::make_unique<tflite::BufferT>();
+  const std::vector<float> weights = {1, -2, 4, 0.5, 0, 0, -8, 2};
+  auto weights_reinterpreted_data =
+      reinterpret_cast<const unsigned char*>(weights.data());
+  buffer->data.assign(weights_reinterpreted_data,
+                      weights_reinterpreted_data + weights.size() * 4);
+  tensor->buffer = 0;
+  tensor->shape = {2, 4};
+  model->subgraphs.push_back(std::move(subgraph));
+  model->subgraphs[0]->tensors.push_back(std::move(tensor));
+  model->buffers.push_back(std::move(buffer));
+  return model;
+}
+
+TEST_F(QuantizationUtilsTest, SymmetricQuantizeTensorBlockwise) {
+  auto model = CreateBlockwiseModel();
+  TensorT* tensor = model->subgraphs[0]->tensors[0].get();
+  EXPECT_EQ(SymmetricQuantizeTensorBlockwise(model.get(), tensor,
+                                             /*block_size=*/2, TensorType_INT8,
+                                             &error_reporter_),
+            kTfLiteOk);
+  EXPECT_EQ(tensor->type, TensorType_INT8);
+  EXPECT_EQ(tensor->quantization->quantized_dimension, 0);
+  EXPECT_THAT(tensor->quantization->scale,
+              ElementsAreArray({2 / 127.f, 4 / 127.f, 0.f, 8 / 127.f}));
+  EXPECT_THAT(tensor->quantization->zero_point, ElementsAreArray({0, 0, 0, 0}));
+  const auto& data = model->buffers[tensor->buffer]->data;
+  EXPECT_THAT(std::vector<int8_t>(data.begin(), data.end()),
+              ElementsAreArray({64, -127, 127, 16, 0, 0, -127, 32}));
+}
+
+TEST_F(QuantizationUtilsTest, SymmetricQuantizeTensorBlockwiseInt4) {
+  auto model = CreateBlockwiseModel();
+  TensorT* tensor = model->subgraphs[0]->tensors[0].get();
+  EXPECT_EQ(SymmetricQuantizeTensorBlockwise(model.get(), tensor,
+                                             /*block_size=*/2, TensorType_INT4,
+                                             &error_reporter_),
+            kTfLiteOk);
+  EXPECT_EQ(tensor->type, TensorType_INT4);
+  EXPECT_THAT(tensor->quantization->scale,
+              ElementsAreArray({2 / 7.f, 4 / 7.f, 0.f, 8 / 7.f}));
+  // {4, -7}, {7, 1}, {0, 0} and {-7, 2} packed with the first value in the low
+  // nibble.
+  EXPECT_THAT(model->buffers[tensor->buffer]->data,
+              ElementsAreArray({0x94, 0x17, 0x00, 0x29}));
+}
+
+TEST_F(QuantizationUtilsTest, SymmetricQuantizeTensorBlockwiseBadBlockSize) {
+  auto model = CreateBlockwiseModel();
+  EXPECT_EQ(SymmetricQuantizeTensorBlockwise(
+                model.get(), model->subgraphs[0]->tensors[0].get(),
+                /*block_size=*/3, TensorType_INT8, &error_reporter_),
+            kTfLiteError);
+}
+
 TEST_F(QuantizationUtilsTest, AddQuantizationParams) {
   // Create data.
   auto model = std::make_unique<ModelT>();
@@ -198,7 +198,7 @@ bool CheckAllOpInputsQuantized(const SubGraphT* subgraph, const OperatorT* op,
 
     TensorT* tensor = subgraph->tensors[tensor_idx].get();
 
-    if (tensor->type != TensorType_INT8) {
+    if (tensor->type != TensorType_INT8 && tensor->type != TensorType_INT4) {
       return false;
     }
   }
@@ -392,14 +392,47 @@ inline bool IsOpDenylisted(const flat_hash_set<BuiltinOperator>& op_denylist,
   return op_denylist.find(op_code) != op_denylist.end();
 }
 
+// Returns true if the weights `tensor_idx` can be quantized block-wise: they
+// are a 2-D filter whose input depth is a multiple of `block_size`, only read
+// by hybrid FULLY_CONNECTED ops and not an output of the subgraph.
+bool IsBlockwiseQuantizable(const ModelT* model, const SubGraphT* subgraph,
+                            int32_t tensor_idx, int32_t block_size,
+                            const flat_hash_set<BuiltinOperator>& op_denylist) {
+  const TensorT* tensor = subgraph->tensors[tensor_idx].get();
+  if (tensor->shape.size() != 2 || tensor->shape[1] % block_size != 0) {
+    return false;
+  }
+  if (std::find(subgraph->outputs.begin(), subgraph->outputs.end(),
+                tensor_idx) != subgraph->outputs.end()) {
+    return false;
+  }
+  const std::vector<ConsumerOpInfo> consumer_op_infos =
+      GetTensorConsumers(model, subgraph, tensor_idx);
+  if (consumer_op_infos.empty()) return false;
+  for (const ConsumerOpInfo& consumer_op_info : consumer_op_infos) {
+    const BuiltinOperator op_code = GetBuiltinCode(
+        model->operator_codes[consumer_op_info.op->opcode_index].get());
+    if (op_code != BuiltinOperator_FULLY_CONNECTED ||
+        consumer_op_info.op_input_idx != 1 ||
+        IsOpDenylisted(op_denylist, op_code)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// If `block_size` is positive, the filters of hybrid FULLY_CONNECTED ops that
+// allow it are quantized block-wise to `blockwise_type`.
 TfLiteStatus QuantizeWeightsInt8(
     flatbuffers::FlatBufferBuilder* builder, const Model* input_model,
     bool use_hybrid_evaluation, uint64_t weights_min_num_elements,
     const CustomOpMap& custom_op_map, bool use_updated_hybrid_scheme,
-    const flat_hash_set<BuiltinOperator>& op_denylist = {}) {
+    const flat_hash_set<BuiltinOperator>& op_denylist = {},
+    int32_t block_size = 0, TensorType blockwise_type = TensorType_INT8) {
   std::unique_ptr<ModelT> model;
   model.reset(input_model->UnPack());
 
+  bool has_blockwise_weights = false;
   for (int subgraph_index = 0, end = model->subgraphs.size();
        subgraph_index < end; ++subgraph_index) {
     SubGraphT* subgraph = model->subgraphs.at(subgraph_index).get();
@@ -414,7 +447,14 @@ TfLiteStatus QuantizeWeightsInt8(
 
     for (std::pair<int32_t, TensorPerChannel> tensor_pair : tensor_map) {
       // Quantize the tensor.
-      if (tensor_pair.second.is_per_channel) {
+      if (block_size > 0 && use_hybrid_evaluation &&
+          IsBlockwiseQuantizable(model.get(), subgraph, tensor_pair.first,
+                                 block_size, op_denylist)) {
+        TF_LITE_ENSURE_STATUS(utils::SymmetricQuantizeTensorBlockwise(
+            model.get(), tensor_pair.second.t, block_size, blockwise_type,
+            nullptr));
+        has_blockwise_weights = true;
+      } else if (tensor_pair.second.is_per_channel) {
         TF_LITE_ENSURE_STATUS(utils::SymmetricQuantizeTensorPerChannel(
             model.get(), tensor_pair.second.t, tensor_pair.second.channel_dim,
             nullptr));
@@ -512,6 +552,14 @@ TfLiteStatus QuantizeWeightsInt8(
 
   // Update the modified operator code versions.
   UpdateInt8OperatorVersions(model.get(), use_updated_hybrid_scheme);
+  if (has_blockwise_weights) {
+    // Block-wise filters have more than one scale, like per-channel ones.
+    for (auto& op_code : model->operator_codes) {
+      if (GetBuiltinCode(op_code.get()) == BuiltinOperator_FULLY_CONNECTED) {
+        op_code->version = std::max(op_code->version, 12);
+      }
+    }
+  }
 
   flatbuffers::Offset<Model> output_model_location =
       Model::Pack(*builder, model.get());
@@ -689,5 +737,24 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
                              use_updated_hybrid_scheme, op_denylist);
 }
 
+TfLiteStatus QuantizeWeightsBlockwise(flatbuffers::FlatBufferBuilder* builder,
+                                      const Model* input_model,
+                                      int32_t block_size,
+                                      TensorType weights_type,
+                                      uint64_t weights_min_num_elements) {
+  if (block_size <= 0 ||
+      (weights_type != TensorType_INT8 && weights_type != TensorType_INT4)) {
+    LOG(ERROR) << "Block-wise quantization requires a positive block size and "
+                  "INT8 or INT4 weights.";
+    return kTfLiteError;
+  }
+  CustomOpMap custom_op_map;
+  return QuantizeWeightsInt8(builder, input_model,
+                             /*use_hybrid_evaluation=*/true,
+                             weights_min_num_elements, custom_op_map,
+                             kUseUpdatedHybridSchemeDefault,
+                             /*op_denylist=*/{}, block_size, weights_type);
+}
+
 }  // namespace optimize
 }  // namespace tflite
@@ -88,6 +88,18 @@ TfLiteStatus QuantizeWeights(
     const flat_hash_set<BuiltinOperator>& op_denylist = {},
     QuantizerType quantizer_type = QuantizerType::OLD_QUANTIZER);
 
+// Same as QuantizeWeights with BufferType::QUANTIZED_INT8, except that the
+// filters of hybrid FULLY_CONNECTED ops are quantized block-wise: each output
+// channel gets one scale per `block_size` consecutive input values, and the
+// values are stored as `weights_type`, TensorType_INT8 or TensorType_INT4.
+// Filters whose input depth is not a multiple of `block_size`, or that are
+// read by other ops, are quantized as before.
+TfLiteStatus QuantizeWeightsBlockwise(flatbuffers::FlatBufferBuilder* builder,
+                                      const Model* input_model,
+                                      int32_t block_size,
+                                      TensorType weights_type = TensorType_INT8,
+                                      uint64_t weights_min_num_elements = 1024);
+
 namespace internal {
 // If use_hybrid_evaluation is false, will disable using hybrid eval for
 // operations that support it.
@@ -27,6 +27,9 @@ from tensorflow.core.framework import step_stats_pb2
 from tensorflow.python.platform import build_info
 from tensorflow.python.platform import tf_logging as logging
 
+# Bytes read from memory per last level cache miss.
+_CACHE_LINE_BYTES = 64
+
 
 class AllocationMaximum(
     collections.namedtuple(
@@ -526,8 +529,37 @@ class Timeline(object):
       args['kernel'] = nodestats.timeline_label.split('@@')[0]
     for i, iname in enumerate(inputs):
       args['input%d' % i] = iname
+    if nodestats.HasField('hardware_counters'):
+      self._add_hardware_counters(nodestats, args)
     self._chrome_trace.emit_region(start, duration, pid, tid, 'Op', op, args)
 
+  def _add_hardware_counters(
+      self, nodestats: step_stats_pb2.NodeExecStats, args: Dict[str, Any]
+  ) -> None:
+    """Adds the CPU hardware counters of an op to its event arguments.
+
+    Besides the raw counters, adds the instructions per cycle, and the memory
+    bandwidth estimated from the last level cache misses, which separate the
+    compute-bound ops from the memory-bound ones.
+
+    Args:
+      nodestats: The 'step_stats_pb2.NodeExecStats' proto recording op
+        execution.
+      args: The event arguments of the op.
+    """
+    counters = nodestats.hardware_counters
+    args['cycles'] = counters.cycles
+    args['instructions'] = counters.instructions
+    args['llc_misses'] = counters.llc_misses
+    if counters.cycles > 0:
+      args['ipc'] = counters.instructions / counters.cycles
+    compute_micros = nodestats.op_end_rel_micros - nodestats.op_start_rel_micros
+    if compute_micros > 0:
+      # Bytes per microsecond are MB/s.
+      args['memory_bandwidth_mb_per_s'] = (
+          counters.llc_misses * _CACHE_LINE_BYTES / compute_micros
+      )
+
   def _emit_tensor_snapshot(
       self,
       tensor: _TensorTracker,
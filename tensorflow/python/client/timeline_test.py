@@ -16,6 +16,7 @@
 
 import json
 
+from tensorflow.core.framework import step_stats_pb2
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.client import session
 from tensorflow.python.client import timeline
@@ -38,6 +39,32 @@ class TimelineTest(test.TestCase):
     for event in trace['traceEvents']:
       self.assertTrue('ph' in event)
 
+  def testHardwareCounters(self):
+    step_stats = step_stats_pb2.StepStats()
+    dev_stats = step_stats.dev_stats.add(device='/cpu:0')
+    node_stats = dev_stats.node_stats.add(
+        node_name='x',
+        timeline_label='x = MatMul(a, b)',
+        all_start_micros=100,
+        op_start_rel_micros=10,
+        op_end_rel_micros=20,
+        all_end_rel_micros=30)
+    node_stats.hardware_counters.cycles = 4000
+    node_stats.hardware_counters.instructions = 8000
+    node_stats.hardware_counters.llc_misses = 50
+    tl = timeline.Timeline(step_stats)
+    ctf = tl.generate_chrome_trace_format()
+    self._validateTrace(ctf)
+    (op_event,) = [
+        event for event in json.loads(ctf)['traceEvents']
+        if event.get('cat') == 'Op'
+    ]
+    self.assertEqual(op_event['args']['cycles'], 4000)
+    self.assertEqual(op_event['args']['llc_misses'], 50)
+    self.assertAlmostEqual(op_event['args']['ipc'], 2.0)
+    self.assertAlmostEqual(op_event['args']['memory_bandwidth_mb_per_s'],
+                           50 * 64 / 10)
+
   def testSimpleTimeline(self):
     run_options = config_pb2.RunOptions(
         trace_level=config_pb2.RunOptions.FULL_TRACE)
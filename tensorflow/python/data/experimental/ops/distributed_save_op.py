@@ -78,8 +78,10 @@ def distributed_save(
     data_service_address: tf.data service dispatcher address.
     compression: (Optional.) Whether and how to compress the `dataset` snapshot.
       If `"AUTO"`, the tf.data runtime decides which algorithm to use. If
-      `"GZIP"` or `"SNAPPY"`, that specific algorithm is used.  If `None`, the
-      `dataset` snapshot is not compressed.
+      `"AUTOTUNE"`, every worker chooses the algorithm of each checkpoint's
+      chunks from the measured write throughput. If `"GZIP"` or `"SNAPPY"`,
+      that specific algorithm is used.  If `None`, the `dataset` snapshot is
+      not compressed.
 
   Returns:
     An operation which when executed performs the distributed save.
@@ -164,6 +164,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.shuffle_and_repeat_fusion = True
     options.experimental_optimization.seq_interleave_prefetch = True
     options.experimental_warm_start = True
+    options.experimental_interleave_adapt_to_stragglers = True
     options.experimental_slack = True
     options.dataset_name = "test_name"
     options.framework_type = ["TFDS", "TfGrain"]
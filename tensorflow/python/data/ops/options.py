@@ -45,12 +45,17 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  LATENCY: Similar to STAGE_BASED until the pipeline keeps up with its
+  consumer, after which it only increases parameters that decrease the time
+  elements spend in the pipeline. Buffers are kept small.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  LATENCY = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,6 +69,8 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.LATENCY:
+      return model_pb2.AutotuneAlgorithm.LATENCY
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
         f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
@@ -80,6 +87,8 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.LATENCY:
+      return cls.LATENCY
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
         f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
@@ -586,6 +595,18 @@ class Options(options_lib.OptionsBase):
       "state is ignored and a warning is logged; FAIL: External state results "
       "in an error.")
 
+  experimental_interleave_adapt_to_stragglers = options_lib.create_option(
+      name="experimental_interleave_adapt_to_stragglers",
+      ty=bool,
+      docstring=(
+          "Whether `interleave` with `num_parallel_calls` adapts to inputs "
+          "which produce their elements much more slowly than the others. "
+          "Such stragglers may buffer more elements, and if the interleave "
+          "is nondeterministic, extra inputs are read while stragglers stall "
+          "the cycle. Defaults to `False`."
+      ),
+  )
+
   experimental_optimization = options_lib.create_option(
       name="experimental_optimization",
       ty=OptimizationOptions,
@@ -699,6 +720,9 @@ class Options(options_lib.OptionsBase):
       pb.symbolic_checkpoint = self.experimental_symbolic_checkpoint
     if self.experimental_warm_start is not None:
       pb.warm_start = self.experimental_warm_start
+    if self.experimental_interleave_adapt_to_stragglers is not None:
+      pb.interleave_adapt_to_stragglers = (
+          self.experimental_interleave_adapt_to_stragglers)
     if self.dataset_name is not None:
       pb.dataset_name = self.dataset_name
     if self.framework_type:
@@ -723,6 +747,9 @@ class Options(options_lib.OptionsBase):
       self.experimental_symbolic_checkpoint = pb.symbolic_checkpoint
     if pb.WhichOneof("optional_warm_start") is not None:
       self.experimental_warm_start = pb.warm_start
+    if pb.WhichOneof("optional_interleave_adapt_to_stragglers") is not None:
+      self.experimental_interleave_adapt_to_stragglers = (
+          pb.interleave_adapt_to_stragglers)
     if pb.WhichOneof("optional_dataset_name") is not None:
       self.dataset_name = pb.dataset_name
     if pb.framework_type:
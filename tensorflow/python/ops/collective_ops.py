@@ -102,6 +102,7 @@ def all_reduce_v2(t,
                   timeout=0,
                   ordering_token=None,
                   max_subdivs_per_device=-1,
+                  compression='none',
                   name=None):
   """Reduces tensors collectively, across devices.
 
@@ -132,6 +133,10 @@ def all_reduce_v2(t,
       parallelize processing of each per-device tensor. Setting to -1 disables
       subdivision and reverts to previous behavior of not sub-dividing tensor.
       Setting to 0 uses sytem defaults.
+    compression: lossy format of the values exchanged between devices, either
+      `none` or `bfloat16`. With `bfloat16`, float32 values are sent as
+      bfloat16, roughly halving the transferred bytes. Currently only used by
+      ring reductions on CPU devices.
     name: name of the Op.
 
   Returns:
@@ -154,6 +159,7 @@ def all_reduce_v2(t,
       is_stateless=False,
       ordering_token=ordering_token,
       max_subdivs_per_device=max_subdivs_per_device,
+      compression=compression,
       name=name)
 
 
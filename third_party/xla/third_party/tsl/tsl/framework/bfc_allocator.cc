@@ -17,12 +17,16 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
+#include "tsl/framework/metrics.h"
 #include "tsl/lib/core/bits.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
@@ -46,8 +50,17 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
+      use_thread_caches_(opts.thread_cache_bytes > 0),
+      thread_cache_key_([] {
+        static std::atomic<int64_t> next_key{0};
+        return next_key.fetch_add(1, std::memory_order_relaxed);
+      }()),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
+  if (use_thread_caches_) {
+    cacheable_chunk_shards_ =
+        std::make_unique<CacheableChunkShard[]>(kNumCacheableChunkShards);
+  }
   if (opts.allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -205,6 +218,7 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   // Maybe merge adjacent chunks and insert the chunk into the right bin.
   InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
 
+  PublishFragmentationMetrics();
   return true;
 }
 
@@ -259,6 +273,18 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  // Cached chunks carry no free time, so they cannot serve allocations that
+  // must only reuse memory freed before a given count.
+  if (use_thread_caches_ && num_bytes > 0 &&
+      num_bytes <= opts_.thread_cache_max_chunk_bytes &&
+      allocation_attr.freed_by_func == nullptr) {
+    void* ptr = AllocateFromThreadCache(RoundedBytes(num_bytes));
+    if (ptr != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << ptr
+              << " from thread cache";
+      return ptr;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -438,6 +464,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     return ptr;
   }
 
+  // Return the idle chunks of the thread caches before growing the pool.
+  if (FlushThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
@@ -477,6 +512,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
+  PublishFragmentationMetrics();
   MaybeWriteMemoryMap();
   if (dump_log_on_failure) {
     LOG(WARNING)
@@ -512,6 +548,58 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+double BFCAllocator::GetBinFragmentation(BinNum bin_num) {
+  const Bin* b = BinFromIndex(bin_num);
+  if (b->free_chunks.empty()) return 0;
+  const size_t largest = ChunkFromHandle(*b->free_chunks.rbegin())->size;
+  return static_cast<double>(b->free_bytes - largest) / b->free_bytes;
+}
+
+void BFCAllocator::PublishFragmentationMetrics() {
+  std::array<double, kNumBins> bin_fragmentation;
+  size_t free_bytes = 0;
+  for (BinNum bin_num = 0; bin_num < kNumBins; bin_num++) {
+    bin_fragmentation[bin_num] = GetBinFragmentation(bin_num);
+    free_bytes += BinFromIndex(bin_num)->free_bytes;
+  }
+  const int64_t largest_free_chunk = LargestFreeChunk();
+  const double fragmentation =
+      free_bytes == 0
+          ? 0
+          : static_cast<double>(free_bytes - largest_free_chunk) / free_bytes;
+  metrics::UpdateBfcAllocatorFragmentation(Name(), largest_free_chunk,
+                                           region_manager_.regions().size(),
+                                           fragmentation, bin_fragmentation);
+}
+
+void BFCAllocator::RecordTimelineEvent(bool is_allocation, const Chunk* chunk,
+                                       size_t requested_size) {
+  if (opts_.timeline_size == 0) return;
+  if (timeline_.empty()) timeline_.resize(opts_.timeline_size);
+  TimelineEvent& event =
+      timeline_[num_timeline_events_ % opts_.timeline_size];
+  event.is_allocation = is_allocation;
+  event.action_count = num_timeline_events_;
+  event.time_micros = Env::Default()->NowMicros();
+  event.ptr = chunk->ptr;
+  event.size = chunk->size;
+  event.requested_size = requested_size;
+  event.bytes_in_use = stats_.bytes_in_use;
+  const auto& annotation =
+      tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  event.step_id = annotation.pending_step_id;
+  const absl::string_view op_name =
+      annotation.pending_op_name ? annotation.pending_op_name : "";
+  const size_t op_name_size =
+      std::min(op_name.size(), sizeof(event.op_name) - 1);
+  std::memcpy(event.op_name, op_name.data(), op_name_size);
+  event.op_name[op_name_size] = '\0';
+
+  if (++num_timeline_events_ % kFragmentationMetricsInterval == 0) {
+    PublishFragmentationMetrics();
+  }
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -628,6 +716,12 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         }
 #endif
 
+        if (use_thread_caches_ && freed_before == 0 &&
+            chunk->size <= opts_.thread_cache_max_chunk_bytes) {
+          RecordCacheableChunk(chunk->ptr, chunk->size);
+        }
+        RecordTimelineEvent(/*is_allocation=*/true, chunk, num_bytes);
+
         VLOG(4) << "Returning: " << chunk->ptr;
         if (VLOG_IS_ON(4)) {
           LOG(INFO) << "A: " << RenderOccupancy();
@@ -684,6 +778,9 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (use_thread_caches_ && ptr != nullptr && DeallocateToThreadCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -694,7 +791,11 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  if (use_thread_caches_) ForgetCacheableChunk(ptr);
+  FreeChunk(ptr);
+}
 
+void BFCAllocator::FreeChunk(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -705,6 +806,7 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   int64_t alloc_bytes = chunk->size;
 
   MarkFree(h);
+  RecordTimelineEvent(/*is_allocation=*/false, chunk, req_bytes);
 
   // Consider coalescing it.
   if (timing_counter_) {
@@ -723,6 +825,99 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   }
 }
 
+BFCAllocator::ThreadCache* BFCAllocator::GetThreadCache() {
+  // Keyed by `thread_cache_key_`, which outlives the allocators.
+  static thread_local absl::flat_hash_map<int64_t, ThreadCache*> caches;
+  ThreadCache*& cache = caches[thread_cache_key_];
+  if (cache == nullptr) {
+    mutex_lock l(thread_caches_mu_);
+    thread_caches_.push_back(std::make_unique<ThreadCache>());
+    cache = thread_caches_.back().get();
+  }
+  return cache;
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t rounded_bytes) {
+  // Chunks in the same bin differ in size by less than a factor of two, so
+  // any cached chunk that fits wastes no more than `FindChunkPtr()` would
+  // before splitting.
+  static constexpr int kMaxChunksToSearch = 8;
+  ThreadCache* cache = GetThreadCache();
+  mutex_lock l(cache->mu);
+  std::vector<std::pair<void*, size_t>>& bin =
+      cache->bins[BinNumForSize(rounded_bytes)];
+  const int num_chunks = bin.size();
+  const int end = std::max(0, num_chunks - kMaxChunksToSearch);
+  for (int i = num_chunks - 1; i >= end; --i) {
+    if (bin[i].second >= rounded_bytes) {
+      void* ptr = bin[i].first;
+      cache->bytes -= bin[i].second;
+      bin[i] = bin.back();
+      bin.pop_back();
+      return ptr;
+    }
+  }
+  return nullptr;
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  // Timestamped chunks must go through the bins to record their free time.
+  if (timing_counter_) return false;
+  size_t size;
+  {
+    CacheableChunkShard& shard = CacheableChunkShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.sizes.find(ptr);
+    if (it == shard.sizes.end()) return false;
+    size = it->second;
+  }
+  ThreadCache* cache = GetThreadCache();
+  mutex_lock l(cache->mu);
+  if (cache->bytes + size > opts_.thread_cache_bytes) return false;
+  cache->bins[BinNumForSize(size)].emplace_back(ptr, size);
+  cache->bytes += size;
+  return true;
+}
+
+void BFCAllocator::RecordCacheableChunk(void* ptr, size_t size) {
+  CacheableChunkShard& shard = CacheableChunkShardFor(ptr);
+  mutex_lock l(shard.mu);
+  shard.sizes[ptr] = size;
+}
+
+void BFCAllocator::ForgetCacheableChunk(void* ptr) {
+  CacheableChunkShard& shard = CacheableChunkShardFor(ptr);
+  mutex_lock l(shard.mu);
+  shard.sizes.erase(ptr);
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  if (!use_thread_caches_) return false;
+  std::vector<void*> ptrs;
+  {
+    mutex_lock l(thread_caches_mu_);
+    for (const std::unique_ptr<ThreadCache>& cache : thread_caches_) {
+      mutex_lock cache_lock(cache->mu);
+      for (std::vector<std::pair<void*, size_t>>& bin : cache->bins) {
+        for (const std::pair<void*, size_t>& entry : bin) {
+          ptrs.push_back(entry.first);
+        }
+        bin.clear();
+      }
+      cache->bytes = 0;
+    }
+  }
+  for (void* ptr : ptrs) {
+    ForgetCacheableChunk(ptr);
+    FreeChunk(ptr);
+  }
+  if (!ptrs.empty()) {
+    VLOG(2) << "Returned " << ptrs.size() << " chunks from thread caches of "
+            << Name();
+  }
+  return !ptrs.empty();
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -772,6 +967,7 @@ void BFCAllocator::InsertFreeChunkIntoBin(BFCAllocator::ChunkHandle h) {
   Bin* new_bin = BinFromIndex(bin_num);
   c->bin_num = bin_num;
   new_bin->free_chunks.insert(h);
+  new_bin->free_bytes += c->size;
 }
 
 void BFCAllocator::RemoveFreeChunkIterFromBin(
@@ -781,6 +977,7 @@ void BFCAllocator::RemoveFreeChunkIterFromBin(
   Chunk* c = ChunkFromHandle(h);
   CHECK(!c->in_use() && (c->bin_num != kInvalidBinNum));
   free_chunks->erase(citer);
+  BinFromIndex(c->bin_num)->free_bytes -= c->size;
   c->bin_num = kInvalidBinNum;
 }
 
@@ -789,6 +986,7 @@ void BFCAllocator::RemoveFreeChunkFromBin(BFCAllocator::ChunkHandle h) {
   CHECK(!c->in_use() && (c->bin_num != kInvalidBinNum));
   CHECK_GT(BinFromIndex(c->bin_num)->free_chunks.erase(h), 0)
       << "Could not find chunk in bin";
+  BinFromIndex(c->bin_num)->free_bytes -= c->size;
   c->bin_num = kInvalidBinNum;
 }
 
@@ -1163,6 +1361,11 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
     bs->set_total_bytes_in_bin(bin_info.total_bytes_in_bin);
     bs->set_total_chunks_in_use(bin_info.total_chunks_in_use);
     bs->set_total_chunks_in_bin(bin_info.total_chunks_in_bin);
+    if (!b->free_chunks.empty()) {
+      bs->set_largest_free_chunk(
+          ChunkFromHandle(*b->free_chunks.rbegin())->size);
+    }
+    bs->set_fragmentation(GetBinFragmentation(bin_num));
   }
 
   // Record state of every defined Chunk.
@@ -1189,6 +1392,26 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   }
 
   mas->set_fragmentation_metric(GetFragmentation());
+  mas->set_largest_free_chunk(LargestFreeChunk());
+  mas->set_num_regions(region_manager_.regions().size());
+
+  // Record the timeline, oldest event first.
+  const int64_t timeline_len =
+      std::min<int64_t>(num_timeline_events_, timeline_.size());
+  for (int64_t i = num_timeline_events_ - timeline_len;
+       i < num_timeline_events_; ++i) {
+    const TimelineEvent& event = timeline_[i % timeline_.size()];
+    tensorflow::AllocationEvent* ae = md.add_event();
+    ae->set_is_allocation(event.is_allocation);
+    ae->set_action_count(event.action_count);
+    ae->set_time_micros(event.time_micros);
+    ae->set_address(reinterpret_cast<uint64>(event.ptr));
+    ae->set_size(event.size);
+    ae->set_requested_size(event.requested_size);
+    ae->set_bytes_in_use(event.bytes_in_use);
+    ae->set_op_name(event.op_name);
+    ae->set_step_id(event.step_id);
+  }
 
 #ifdef TENSORFLOW_MEM_DEBUG
   // Record the recent size history
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
@@ -69,6 +70,24 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, every thread keeps up to this many bytes of the chunks it
+    // frees, bucketed by bin, and serves its own allocations from them
+    // without taking the allocator lock. Only chunks of at most
+    // `thread_cache_max_chunk_bytes` are cached. Cached chunks count as in use
+    // in the allocator stats, and are returned to the bins before the
+    // allocator grows its pool or fails an allocation.
+    //
+    // `RequestedSize()` and `AllocationId()` of an allocation served from a
+    // thread cache report the allocation that last took the chunk from the
+    // bins.
+    size_t thread_cache_bytes = 0;
+    size_t thread_cache_max_chunk_bytes = 64 << 10;
+
+    // The number of the most recent allocations and deallocations from the
+    // bins, with the op that requested them, that `RecordMemoryMap()`
+    // exports. Allocations served from a thread cache are not recorded.
+    size_t timeline_size = 1024;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -163,6 +182,39 @@ class BFCAllocator : public Allocator {
   // The following means that the largest bin'd chunk size is 256 << 21 = 512MB.
   static constexpr int kNumBins = 21;
 
+  // Returns the chunk at `ptr` to the bins.
+  void FreeChunk(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // A per-thread cache of freed chunks. See `Options::thread_cache_bytes`.
+  struct ThreadCache {
+    mutex mu;
+    // The cached chunks of each bin, as (pointer, chunk size) pairs.
+    std::array<std::vector<std::pair<void*, size_t>>, kNumBins> bins
+        TF_GUARDED_BY(mu);
+    size_t bytes TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Returns the cache of the calling thread.
+  ThreadCache* GetThreadCache() TF_LOCKS_EXCLUDED(lock_);
+
+  // Returns a cached chunk of at least `rounded_bytes` bytes, or nullptr.
+  void* AllocateFromThreadCache(size_t rounded_bytes) TF_LOCKS_EXCLUDED(lock_);
+
+  // Caches the chunk at `ptr` in the calling thread's cache. Returns false if
+  // the chunk cannot be cached and must be returned to the bins.
+  bool DeallocateToThreadCache(void* ptr) TF_LOCKS_EXCLUDED(lock_);
+
+  // Records that the chunk at `ptr` of `size` bytes may be cached once freed.
+  void RecordCacheableChunk(void* ptr, size_t size)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Forgets the chunk at `ptr`, if it was cacheable.
+  void ForgetCacheableChunk(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the chunks in all thread caches to the bins. Returns true if any
+  // chunk was returned.
+  bool FlushThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // A Chunk points to a piece of memory that's either entirely free or entirely
   // in use by one user memory allocation.
   //
@@ -271,6 +323,8 @@ class BFCAllocator : public Allocator {
     // List of free chunks within the bin, sorted by chunk size.
     // Chunk * not owned.
     FreeChunkSet free_chunks;
+    // The total size of `free_chunks`.
+    size_t free_bytes = 0;
     Bin(BFCAllocator* allocator, size_t bs)
         : bin_size(bs), free_chunks(ChunkComparator(allocator)) {}
   };
@@ -519,6 +573,38 @@ class BFCAllocator : public Allocator {
   // size over total free memory, and returns a value within [0, 1].
   double GetFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Like `GetFragmentation()`, but within the bin `bin_num`. Returns 0 if the
+  // bin is empty.
+  double GetBinFragmentation(BinNum bin_num) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Publishes the fragmentation of the allocator and of its bins, its largest
+  // free chunk and its number of regions to the monitoring gauges.
+  void PublishFragmentationMetrics() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // An allocation or deallocation from the bins.
+  struct TimelineEvent {
+    bool is_allocation;
+    int64_t action_count;
+    uint64 time_micros;
+    const void* ptr;
+    size_t size;
+    size_t requested_size;
+    // The bytes in use after the event.
+    int64_t bytes_in_use;
+    int64_t step_id;
+    // The name of the op that requested the allocation, truncated. Copied
+    // because the annotation does not outlive the op.
+    char op_name[48];
+  };
+
+  // Records the allocation or deallocation of `chunk` in the timeline, and
+  // publishes the fragmentation metrics every `kFragmentationMetricsInterval`
+  // events.
+  void RecordTimelineEvent(bool is_allocation, const Chunk* chunk,
+                           size_t requested_size)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  static constexpr int64_t kFragmentationMetricsInterval = 1024;
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -572,6 +658,33 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // True if `opts_.thread_cache_bytes` is positive.
+  const bool use_thread_caches_;
+
+  // Distinguishes the thread caches of different allocators. Never reused.
+  const int64_t thread_cache_key_;
+
+  // The thread caches of all threads that used this allocator. Lock order:
+  // `lock_`, then `thread_caches_mu_`, then `ThreadCache::mu`.
+  mutex thread_caches_mu_;
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_
+      TF_GUARDED_BY(thread_caches_mu_);
+
+  // The sizes of the allocated chunks that may be cached once freed, sharded
+  // by address so that `DeallocateRaw()` does not need `lock_` to find them.
+  // Each shard's mutex is only taken after any other lock.
+  struct CacheableChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, size_t> sizes TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumCacheableChunkShards = 64;
+  CacheableChunkShard& CacheableChunkShardFor(const void* ptr) {
+    return cacheable_chunk_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                                    kMinAllocationBits) %
+                                   kNumCacheableChunkShards];
+  }
+  std::unique_ptr<CacheableChunkShard[]> cacheable_chunk_shards_;
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -587,6 +700,11 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // A ring buffer of the last `opts_.timeline_size` events, and the number of
+  // events recorded so far.
+  std::vector<TimelineEvent> timeline_ TF_GUARDED_BY(lock_);
+  int64_t num_timeline_events_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
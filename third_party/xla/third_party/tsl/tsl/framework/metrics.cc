@@ -16,8 +16,13 @@ limitations under the License.
 #include "tsl/framework/metrics.h"
 
 #include <cstdint>
+#include <string>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tsl/lib/monitoring/counter.h"
+#include "tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +33,37 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_largest_free_chunk = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+    "The size of the largest free chunk of a BFC allocator in bytes.",
+    "allocator");
+
+auto* bfc_allocator_regions = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/regions",
+    "The number of memory regions of a BFC allocator.", "allocator");
+
+auto* bfc_allocator_fragmentation = monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/bfc_allocator/fragmentation",
+    "The fraction of the free memory of a BFC allocator that is not in its "
+    "largest free chunk.",
+    "allocator");
+
+auto* bfc_allocator_bin_fragmentation = monitoring::Gauge<double, 2>::New(
+    "/tensorflow/core/bfc_allocator/bin_fragmentation",
+    "The fraction of the free memory in a bin of a BFC allocator that is not "
+    "in the largest free chunk of the bin.",
+    "allocator", "bin");
+
+auto* bundle_index_cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/core/bundle_reader/index_cache_hits",
+    "The number of lookups in the index caches of checkpoint readers that "
+    "found the block.");
+
+auto* bundle_index_cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/core/bundle_reader/index_cache_misses",
+    "The number of lookups in the index caches of checkpoint readers that "
+    "did not find the block.");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +73,27 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorFragmentation(
+    absl::string_view allocator_name, int64_t largest_free_chunk_bytes,
+    int64_t num_regions, double fragmentation,
+    absl::Span<const double> bin_fragmentation) {
+  const std::string name(allocator_name);
+  bfc_allocator_largest_free_chunk->GetCell(name)->Set(
+      largest_free_chunk_bytes);
+  bfc_allocator_regions->GetCell(name)->Set(num_regions);
+  bfc_allocator_fragmentation->GetCell(name)->Set(fragmentation);
+  for (int bin = 0; bin < bin_fragmentation.size(); ++bin) {
+    bfc_allocator_bin_fragmentation->GetCell(name, absl::StrCat(bin))
+        ->Set(bin_fragmentation[bin]);
+  }
+}
+
+void UpdateBundleIndexCacheStats(uint64_t hits, uint64_t misses) {
+  static auto* hits_cell = bundle_index_cache_hits->GetCell();
+  static auto* misses_cell = bundle_index_cache_misses->GetCell();
+  if (hits > 0) hits_cell->IncrementBy(hits);
+  if (misses > 0) misses_cell->IncrementBy(misses);
+}
+
 }  // namespace metrics
 }  // namespace tsl
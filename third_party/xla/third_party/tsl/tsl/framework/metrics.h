@@ -18,12 +18,27 @@ limitations under the License.
 
 #include <cstdint>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
 namespace tsl {
 namespace metrics {
 
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the fragmentation metrics of the BFC allocator `allocator_name`:
+// the size of its largest free chunk, its number of memory regions, its
+// overall fragmentation, and the fragmentation within each of its bins.
+void UpdateBfcAllocatorFragmentation(
+    absl::string_view allocator_name, int64_t largest_free_chunk_bytes,
+    int64_t num_regions, double fragmentation,
+    absl::Span<const double> bin_fragmentation);
+
+// Adds `hits` and `misses` to the lookups of the index caches of the
+// checkpoint readers.
+void UpdateBundleIndexCacheStats(uint64_t hits, uint64_t misses);
+
 }  // namespace metrics
 }  // namespace tsl
 
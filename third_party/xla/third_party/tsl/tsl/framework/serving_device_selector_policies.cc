@@ -15,11 +15,31 @@ limitations under the License.
 #include "tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "tsl/framework/serving_device_selector.h"
 
 namespace tsl {
+namespace {
+
+// Returns the number of programs enqueued or scheduled on `device_state`.
+int64_t NumQueuedPrograms(
+    const ServingDeviceSelector::DeviceState& device_state) {
+  int64_t num_programs = 0;
+  for (const auto& programs : device_state.enqueued_programs) {
+    num_programs += programs.size();
+  }
+  for (const auto& programs : device_state.scheduled_programs) {
+    num_programs += programs.size();
+  }
+  return num_programs;
+}
+
+}  // namespace
 
 int RoundRobinPolicy::SelectDevice(
     absl::string_view program_fingerprint,
@@ -28,4 +48,35 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+LeastLoadedPolicy::LeastLoadedPolicy(std::function<int64_t()> now_ns)
+    : now_ns_(std::move(now_ns)), ordinal_(0) {}
+
+int LeastLoadedPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int64_t now_ns = now_ns_();
+  // Start the scan at a rotating device, so that ties are broken round-robin.
+  const int first_device =
+      ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
+  int selected_device = first_device;
+  std::tuple<int64_t, int64_t, bool> min_load;
+  for (int i = 0; i < num_devices; ++i) {
+    const int device_index = (first_device + i) % num_devices;
+    const ServingDeviceSelector::DeviceState& device_state =
+        device_states.states[device_index];
+    const int32_t lowest_priority = device_state.enqueued_programs.size() - 1;
+    const std::tuple<int64_t, int64_t, bool> load = {
+        ServingDeviceSelector::EstimateTimeTillIdleNs(
+            device_state, lowest_priority, /*min_exec_time=*/0, now_ns),
+        NumQueuedPrograms(device_state),
+        device_state.last_fingerprint != program_fingerprint};
+    if (i == 0 || load < min_load) {
+      selected_device = device_index;
+      min_load = load;
+    }
+  }
+  return selected_device;
+}
+
 }  // namespace tsl
@@ -16,6 +16,8 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
 
 #include "tsl/framework/serving_device_selector.h"
 
@@ -23,6 +25,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kLeastLoaded,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +40,28 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device which is estimated to become idle the soonest, based on
+// the average execution time of its queued programs and the time the running
+// program has already spent on the device. Devices busy with long-running
+// programs are thus avoided. Ties, e.g. among idle devices or among devices
+// whose programs have no recorded execution time yet, are broken by the number
+// of queued programs, then by preferring the device which last ran the same
+// program, then round-robin.
+class LeastLoadedPolicy : public ServingDeviceSelector::Policy {
+ public:
+  // `now_ns` returns the current time in nanoseconds, on the same clock as the
+  // one the device selector records program start times with.
+  explicit LeastLoadedPolicy(std::function<int64_t()> now_ns);
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  std::function<int64_t()> now_ns_;
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
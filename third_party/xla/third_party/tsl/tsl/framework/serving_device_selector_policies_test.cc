@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/framework/serving_device_selector_policies.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tsl/framework/serving_device_selector.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+using DeviceState = ServingDeviceSelector::DeviceState;
+using ExecutionInfo = ServingDeviceSelector::ExecutionInfo;
+
+constexpr int64_t kNowNs = 1000;
+
+// Enqueues a program with the given `execution_info` on `device_state`.
+void EnqueueProgram(DeviceState& device_state, const ExecutionInfo& info,
+                    const char* fingerprint, int64_t started_ns) {
+  DeviceState::ProgramInfo program;
+  program.fingerprint = fingerprint;
+  program.priority = 0;
+  program.execution_info = &info;
+  program.prefetch_results = 0;
+  if (device_state.enqueued_programs[0].empty()) {
+    device_state.last_started_ns = started_ns;
+  }
+  device_state.enqueued_programs[0].push_back(program);
+  device_state.last_fingerprint = fingerprint;
+}
+
+int SelectDevice(LeastLoadedPolicy& policy,
+                 const std::vector<DeviceState>& device_states,
+                 const char* fingerprint) {
+  ServingDeviceSelector::DeviceStates states;
+  states.states = absl::MakeConstSpan(device_states);
+  return policy.SelectDevice(fingerprint, states);
+}
+
+TEST(LeastLoadedPolicyTest, AvoidsDeviceBusyWithLongRunningProgram) {
+  ExecutionInfo long_program, short_program;
+  long_program.AddTime(/*value=*/10000, /*result=*/0);
+  short_program.AddTime(/*value=*/100, /*result=*/0);
+  std::vector<DeviceState> device_states(2);
+  EnqueueProgram(device_states[0], long_program, "long", /*started_ns=*/500);
+  EnqueueProgram(device_states[1], short_program, "short", /*started_ns=*/900);
+  EnqueueProgram(device_states[1], short_program, "short", /*started_ns=*/900);
+
+  LeastLoadedPolicy policy([] { return kNowNs; });
+  for (int i = 0; i < 4; ++i) {
+    // Device 1 has more programs queued, but becomes idle much sooner.
+    EXPECT_EQ(SelectDevice(policy, device_states, "short"), 1);
+  }
+}
+
+TEST(LeastLoadedPolicyTest, AccountsForElapsedTimeOfRunningProgram) {
+  ExecutionInfo info;
+  info.AddTime(/*value=*/1000, /*result=*/0);
+  std::vector<DeviceState> device_states(2);
+  EnqueueProgram(device_states[0], info, "a", /*started_ns=*/900);
+  // Started earlier, so closer to completion.
+  EnqueueProgram(device_states[1], info, "a", /*started_ns=*/100);
+
+  LeastLoadedPolicy policy([] { return kNowNs; });
+  EXPECT_EQ(SelectDevice(policy, device_states, "a"), 1);
+}
+
+TEST(LeastLoadedPolicyTest, BreaksTiesByQueueDepthThenFingerprint) {
+  // Programs without recorded execution time all estimate to zero.
+  ExecutionInfo unknown_program;
+  std::vector<DeviceState> device_states(3);
+  EnqueueProgram(device_states[0], unknown_program, "a", /*started_ns=*/900);
+  EnqueueProgram(device_states[0], unknown_program, "a", /*started_ns=*/900);
+  EnqueueProgram(device_states[1], unknown_program, "a", /*started_ns=*/900);
+  EnqueueProgram(device_states[2], unknown_program, "b", /*started_ns=*/900);
+
+  LeastLoadedPolicy policy([] { return kNowNs; });
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(SelectDevice(policy, device_states, "b"), 2);
+    EXPECT_EQ(SelectDevice(policy, device_states, "a"), 1);
+  }
+}
+
+TEST(LeastLoadedPolicyTest, SpreadsOverIdleDevicesRoundRobin) {
+  std::vector<DeviceState> device_states(3);
+  LeastLoadedPolicy policy([] { return kNowNs; });
+  EXPECT_EQ(SelectDevice(policy, device_states, "a"), 0);
+  EXPECT_EQ(SelectDevice(policy, device_states, "a"), 1);
+  EXPECT_EQ(SelectDevice(policy, device_states, "a"), 2);
+  EXPECT_EQ(SelectDevice(policy, device_states, "a"), 0);
+}
+
+}  // namespace
+}  // namespace tsl
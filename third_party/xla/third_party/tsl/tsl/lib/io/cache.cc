@@ -20,6 +20,9 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <memory>
+
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/raw_coding.h"
 
@@ -49,6 +52,10 @@ namespace {
 // Elements are moved between these lists by the Ref() and Unref() methods,
 // when they detect an element in the cache acquiring or losing its only
 // external reference.
+//
+// With the scan-resistant policy, the unreferenced items that were never hit
+// after their insertion are kept on a third "probation" list instead of the LRU
+// list, and are evicted first.
 
 // An entry is a variable length heap-allocated structure.  Entries
 // are kept in a circular doubly linked list ordered by access time.
@@ -61,6 +68,7 @@ struct LRUHandle {
   size_t charge;  // TODO(opt): Only allow uint32_t?
   size_t key_length;
   bool in_cache;     // Whether entry is in the cache.
+  bool is_protected;  // Whether entry was hit with the scan-resistant policy.
   uint32_t refs;     // References, including cache reference, if present.
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
   char key_data[1];  // Beginning of key
@@ -167,6 +175,9 @@ class LRUCache {
 
   // Separate from constructor so caller can easily make an array of LRUCache
   void SetCapacity(size_t capacity) { capacity_ = capacity; }
+  void SetScanResistant(bool scan_resistant) {
+    scan_resistant_ = scan_resistant;
+  }
 
   // Like Cache methods, but with an extra "hash" parameter.
   Cache::Handle* Insert(const Slice& key, uint32_t hash, void* value,
@@ -180,6 +191,14 @@ class LRUCache {
     mutex_lock l(mutex_);
     return usage_;
   }
+  // Adds the counters of this shard to *stats.
+  void AddStats(Cache::Stats* stats) const {
+    mutex_lock l(mutex_);
+    stats->hits += stats_.hits;
+    stats->misses += stats_.misses;
+    stats->inserts += stats_.inserts;
+    stats->evictions += stats_.evictions;
+  }
 
  private:
   void LRU_Remove(LRUHandle* e);
@@ -187,9 +206,13 @@ class LRUCache {
   void Ref(LRUHandle* e);
   void Unref(LRUHandle* e);
   bool FinishErase(LRUHandle* e) TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Moves the oldest protected entries to the probation list while the
+  // protected entries use more than their part of the capacity.
+  void DemoteProtected() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Initialized before use.
   size_t capacity_;
+  bool scan_resistant_ = false;
 
   // mutex_ protects the following state.
   mutable mutex mutex_;
@@ -204,7 +227,15 @@ class LRUCache {
   // Entries are in use by clients, and have refs >= 2 and in_cache==true.
   LRUHandle in_use_ TF_GUARDED_BY(mutex_);
 
+  // Dummy head of the probation list, only used by the scan-resistant policy.
+  // Entries have refs==1, in_cache==true and is_protected==false, and are
+  // evicted before the entries of lru_.
+  LRUHandle probation_ TF_GUARDED_BY(mutex_);
+  // The combined charges of the entries with is_protected==true.
+  size_t protected_usage_ TF_GUARDED_BY(mutex_) = 0;
+
   HandleTable table_ TF_GUARDED_BY(mutex_);
+  Cache::Stats stats_ TF_GUARDED_BY(mutex_);
 };
 
 LRUCache::LRUCache() : capacity_(0), usage_(0) {
@@ -213,17 +244,21 @@ LRUCache::LRUCache() : capacity_(0), usage_(0) {
   lru_.prev = &lru_;
   in_use_.next = &in_use_;
   in_use_.prev = &in_use_;
+  probation_.next = &probation_;
+  probation_.prev = &probation_;
 }
 
 LRUCache::~LRUCache() {
   assert(in_use_.next == &in_use_);  // Error if caller has an unreleased handle
-  for (LRUHandle* e = lru_.next; e != &lru_;) {
-    LRUHandle* next = e->next;
-    assert(e->in_cache);
-    e->in_cache = false;
-    assert(e->refs == 1);  // Invariant of lru_ list.
-    Unref(e);
-    e = next;
+  for (LRUHandle* list : {&probation_, &lru_}) {
+    for (LRUHandle* e = list->next; e != list;) {
+      LRUHandle* next = e->next;
+      assert(e->in_cache);
+      e->in_cache = false;
+      assert(e->refs == 1);  // Invariant of lru_ and probation_ lists.
+      Unref(e);
+      e = next;
+    }
   }
 }
 
@@ -243,9 +278,25 @@ void LRUCache::Unref(LRUHandle* e) {
     (*e->deleter)(e->key(), e->value);
     free(e);
   } else if (e->in_cache && e->refs == 1) {
-    // No longer in use; move to lru_ list.
+    // No longer in use; move to lru_ list, or to probation_ list if the
+    // scan-resistant policy never saw a hit on it.
     LRU_Remove(e);
-    LRU_Append(&lru_, e);
+    if (scan_resistant_ && !e->is_protected) {
+      LRU_Append(&probation_, e);
+    } else {
+      LRU_Append(&lru_, e);
+    }
+  }
+}
+
+void LRUCache::DemoteProtected() {
+  const size_t protected_capacity = capacity_ / 5 * 4;
+  while (protected_usage_ > protected_capacity && lru_.next != &lru_) {
+    LRUHandle* e = lru_.next;
+    e->is_protected = false;
+    protected_usage_ -= e->charge;
+    LRU_Remove(e);
+    LRU_Append(&probation_, e);
   }
 }
 
@@ -266,7 +317,17 @@ Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash) {
   mutex_lock l(mutex_);
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
+    ++stats_.hits;
+    if (scan_resistant_ && !e->is_protected) {
+      e->is_protected = true;
+      protected_usage_ += e->charge;
+    }
     Ref(e);
+    if (scan_resistant_) {
+      DemoteProtected();
+    }
+  } else {
+    ++stats_.misses;
   }
   return reinterpret_cast<Cache::Handle*>(e);
 }
@@ -290,8 +351,10 @@ Cache::Handle* LRUCache::Insert(const Slice& key, uint32_t hash, void* value,
   e->key_length = key.size();
   e->hash = hash;
   e->in_cache = false;
+  e->is_protected = false;
   e->refs = 1;  // for the returned handle.
   memcpy(e->key_data, key.data(), key.size());
+  ++stats_.inserts;
 
   if (capacity_ > 0) {
     e->refs++;  // for the cache's reference.
@@ -303,13 +366,16 @@ Cache::Handle* LRUCache::Insert(const Slice& key, uint32_t hash, void* value,
     // next is read by key() in an assert, so it must be initialized
     e->next = nullptr;
   }
-  while (usage_ > capacity_ && lru_.next != &lru_) {
-    LRUHandle* old = lru_.next;
+  while (usage_ > capacity_ &&
+         (probation_.next != &probation_ || lru_.next != &lru_)) {
+    LRUHandle* old =
+        probation_.next != &probation_ ? probation_.next : lru_.next;
     assert(old->refs == 1);
     bool erased = FinishErase(table_.Remove(old->key(), old->hash));
     if (!erased) {  // to avoid unused variable when compiled NDEBUG
       assert(erased);
     }
+    ++stats_.evictions;
   }
 
   return reinterpret_cast<Cache::Handle*>(e);
@@ -323,6 +389,9 @@ bool LRUCache::FinishErase(LRUHandle* e) {
     LRU_Remove(e);
     e->in_cache = false;
     usage_ -= e->charge;
+    if (e->is_protected) {
+      protected_usage_ -= e->charge;
+    }
     Unref(e);
   }
   return e != nullptr;
@@ -335,22 +404,25 @@ void LRUCache::Erase(const Slice& key, uint32_t hash) {
 
 void LRUCache::Prune() {
   mutex_lock l(mutex_);
-  while (lru_.next != &lru_) {
-    LRUHandle* e = lru_.next;
-    assert(e->refs == 1);
-    bool erased = FinishErase(table_.Remove(e->key(), e->hash));
-    if (!erased) {  // to avoid unused variable when compiled NDEBUG
-      assert(erased);
+  for (LRUHandle* list : {&probation_, &lru_}) {
+    while (list->next != list) {
+      LRUHandle* e = list->next;
+      assert(e->refs == 1);
+      bool erased = FinishErase(table_.Remove(e->key(), e->hash));
+      if (!erased) {  // to avoid unused variable when compiled NDEBUG
+        assert(erased);
+      }
     }
   }
 }
 
-static const int kNumShardBits = 4;
-static const int kNumShards = 1 << kNumShardBits;
+static const int kMaxNumShardBits = 16;
 
 class ShardedLRUCache : public Cache {
  private:
-  LRUCache shard_[kNumShards];
+  const int num_shard_bits_;
+  const int num_shards_;
+  std::unique_ptr<LRUCache[]> shard_;
   mutex id_mutex_;
   uint64_t last_id_;
 
@@ -358,13 +430,22 @@ class ShardedLRUCache : public Cache {
     return Hash(s.data(), s.size(), 0);
   }
 
-  static uint32_t Shard(uint32_t hash) { return hash >> (32 - kNumShardBits); }
+  uint32_t Shard(uint32_t hash) const {
+    // Shifting a 32-bit value by 32 is undefined.
+    return num_shard_bits_ == 0 ? 0 : hash >> (32 - num_shard_bits_);
+  }
 
  public:
-  explicit ShardedLRUCache(size_t capacity) : last_id_(0) {
-    const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
-    for (int s = 0; s < kNumShards; s++) {
+  ShardedLRUCache(size_t capacity, const LRUCacheOptions& options)
+      : num_shard_bits_(
+            std::min(std::max(options.num_shard_bits, 0), kMaxNumShardBits)),
+        num_shards_(1 << num_shard_bits_),
+        shard_(new LRUCache[num_shards_]),
+        last_id_(0) {
+    const size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+    for (int s = 0; s < num_shards_; s++) {
       shard_[s].SetCapacity(per_shard);
+      shard_[s].SetScanResistant(options.scan_resistant);
     }
   }
   ~ShardedLRUCache() override {}
@@ -393,17 +474,24 @@ class ShardedLRUCache : public Cache {
     return ++(last_id_);
   }
   void Prune() override {
-    for (int s = 0; s < kNumShards; s++) {
+    for (int s = 0; s < num_shards_; s++) {
       shard_[s].Prune();
     }
   }
   size_t TotalCharge() const override {
     size_t total = 0;
-    for (int s = 0; s < kNumShards; s++) {
+    for (int s = 0; s < num_shards_; s++) {
       total += shard_[s].TotalCharge();
     }
     return total;
   }
+  Stats GetStats() const override {
+    Stats stats;
+    for (int s = 0; s < num_shards_; s++) {
+      shard_[s].AddStats(&stats);
+    }
+    return stats;
+  }
 
  private:
   // TODO(byronyi): Figure out why Hash32 fails EvictionPolicy test.
@@ -443,7 +531,13 @@ class ShardedLRUCache : public Cache {
 
 }  // end anonymous namespace
 
-Cache* NewLRUCache(size_t capacity) { return new ShardedLRUCache(capacity); }
+Cache* NewLRUCache(size_t capacity) {
+  return new ShardedLRUCache(capacity, LRUCacheOptions());
+}
+
+Cache* NewLRUCache(size_t capacity, const LRUCacheOptions& options) {
+  return new ShardedLRUCache(capacity, options);
+}
 
 }  // namespace table
 
@@ -45,6 +45,23 @@ class Cache;
 // of Cache uses a least-recently-used eviction policy.
 Cache* NewLRUCache(size_t capacity);
 
+struct LRUCacheOptions {
+  // The cache is split into 2^num_shard_bits shards, each with its own lock
+  // and an equal part of the capacity.  More shards reduce the contention
+  // between concurrent lookups, but make the eviction less accurate.
+  int num_shard_bits = 4;
+
+  // If true, each shard uses a segmented LRU policy: entries that have been
+  // looked up at least once after their insertion are protected, and the
+  // entries that were never hit are evicted first.  A scan over many entries
+  // that are each read once then only evicts other such entries, instead of
+  // the working set.  Protected entries use at most 80% of the capacity.
+  bool scan_resistant = false;
+};
+
+// Like NewLRUCache(capacity), with the given sharding and eviction policy.
+Cache* NewLRUCache(size_t capacity, const LRUCacheOptions& options);
+
 class Cache {
  public:
   Cache() = default;
@@ -111,6 +128,18 @@ class Cache {
   // cache.
   virtual size_t TotalCharge() const = 0;
 
+  // Counters of the cache operations since its creation.
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+  };
+
+  // Return the counters of the cache operations.  The default implementation
+  // returns zero counters.
+  virtual Stats GetStats() const { return Stats(); }
+
  private:
   void LRU_Remove(Handle* e);
   void LRU_Append(Handle* e);
@@ -227,6 +227,51 @@ TEST_F(CacheTest, Prune) {
   ASSERT_EQ(-1, Lookup(2));
 }
 
+TEST_F(CacheTest, Stats) {
+  delete cache_;
+  LRUCacheOptions options;
+  options.num_shard_bits = 0;
+  cache_ = NewLRUCache(kCacheSize, options);
+
+  ASSERT_EQ(-1, Lookup(1));
+  for (int i = 0; i < kCacheSize + 100; i++) {
+    Insert(i, 1000 + i);
+  }
+  ASSERT_EQ(-1, Lookup(0));
+  ASSERT_EQ(1000 + kCacheSize, Lookup(kCacheSize));
+
+  const Cache::Stats stats = cache_->GetStats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(kCacheSize + 100, stats.inserts);
+  EXPECT_EQ(100, stats.evictions);
+}
+
+TEST_F(CacheTest, ScanResistance) {
+  for (bool scan_resistant : {false, true}) {
+    delete cache_;
+    LRUCacheOptions options;
+    options.num_shard_bits = 0;
+    options.scan_resistant = scan_resistant;
+    cache_ = NewLRUCache(kCacheSize, options);
+
+    // A working set which is hit once, then a scan over more entries than
+    // the capacity.
+    for (int i = 0; i < 100; i++) {
+      Insert(i, 1000 + i);
+      ASSERT_EQ(1000 + i, Lookup(i));
+    }
+    for (int i = 0; i < 10 * kCacheSize; i++) {
+      Insert(10000 + i, 20000 + i);
+    }
+
+    for (int i = 0; i < 100; i++) {
+      EXPECT_EQ(scan_resistant ? 1000 + i : -1, Lookup(i));
+    }
+    EXPECT_EQ(20000 + 10 * kCacheSize - 1, Lookup(10000 + 10 * kCacheSize - 1));
+  }
+}
+
 TEST_F(CacheTest, ZeroSizeCache) {
   delete cache_;
   cache_ = NewLRUCache(0);
@@ -0,0 +1,196 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/prefetching_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// The reads mostly wait for the file system rather than use the CPU, so the
+// shared pool has more threads than there are cores. It bounds the reads in
+// flight across all the streams which use it.
+constexpr int kNumSharedThreads = 64;
+
+thread::ThreadPool* SharedThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "prefetching_inputstream", kNumSharedThreads);
+  return thread_pool;
+}
+
+}  // namespace
+
+PrefetchingInputStream::PrefetchingInputStream(RandomAccessFile* file,
+                                               size_t buffer_bytes,
+                                               int num_buffers,
+                                               size_t max_buffer_bytes,
+                                               thread::ThreadPool* thread_pool)
+    : file_(file),
+      buffer_bytes_(buffer_bytes),
+      num_buffers_(std::max(num_buffers, 1)),
+      max_buffer_bytes_(std::max(max_buffer_bytes, buffer_bytes)),
+      thread_pool_(thread_pool != nullptr ? thread_pool : SharedThreadPool()),
+      read_bytes_(buffer_bytes) {}
+
+PrefetchingInputStream::~PrefetchingInputStream() {
+  mutex_lock l(mu_);
+  WaitForOutstandingReads(l);
+}
+
+void PrefetchingInputStream::WaitForOutstandingReads(mutex_lock& l) {
+  while (num_outstanding_ > 0) {
+    cv_.wait(l);
+  }
+}
+
+void PrefetchingInputStream::ScheduleReads() {
+  while (!done_reading_ &&
+         buffers_.size() < static_cast<size_t>(num_buffers_)) {
+    buffers_.push_back(std::make_unique<Buffer>());
+    Buffer* buffer = buffers_.back().get();
+    buffer->offset = next_offset_;
+    buffer->bytes = read_bytes_;
+    buffer->data.resize(buffer->bytes);
+    next_offset_ += buffer->bytes;
+    ++num_outstanding_;
+    thread_pool_->Schedule([this, buffer]() {
+      StringPiece data;
+      Status s =
+          file_->Read(buffer->offset, buffer->bytes, &data, &buffer->data[0]);
+      if (data.data() != buffer->data.data()) {
+        memmove(&buffer->data[0], data.data(), data.size());
+      }
+      buffer->data.resize(data.size());
+      mutex_lock l(mu_);
+      buffer->status = s;
+      buffer->done = true;
+      if (!s.ok() || data.size() < buffer->bytes) {
+        done_reading_ = true;
+      }
+      --num_outstanding_;
+      cv_.notify_all();
+    });
+  }
+}
+
+Status PrefetchingInputStream::ReadOrSkip(int64_t bytes, tstring* result) {
+  mutex_lock l(mu_);
+  while (bytes > 0) {
+    ScheduleReads();
+    Buffer* front = buffers_.front().get();
+    if (!front->done && read_bytes_ < max_buffer_bytes_) {
+      // The reads in flight do not keep up with the reader, so the next ones
+      // are larger to amortize the latency of each read.
+      read_bytes_ = std::min(2 * read_bytes_, max_buffer_bytes_);
+    }
+    while (!front->done) {
+      cv_.wait(l);
+    }
+    if (!front->status.ok() && !errors::IsOutOfRange(front->status)) {
+      return front->status;
+    }
+    const size_t available = front->data.size() - pos_in_front_;
+    if (available == 0) {
+      // A short buffer is the last one, and stays at the front so that all
+      // further reads fail too.
+      if (front->data.size() < front->bytes) {
+        return errors::OutOfRange("reached end of file");
+      }
+      buffers_.pop_front();
+      pos_in_front_ = 0;
+      continue;
+    }
+    const size_t n = std::min<int64_t>(bytes, available);
+    if (result != nullptr) {
+      result->append(front->data.data() + pos_in_front_, n);
+    }
+    pos_in_front_ += n;
+    position_ += n;
+    bytes -= n;
+  }
+  return OkStatus();
+}
+
+Status PrefetchingInputStream::ReadNBytes(int64_t bytes_to_read,
+                                          tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return ReadOrSkip(bytes_to_read, result);
+}
+
+Status PrefetchingInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  if (bytes_to_skip == 0) {
+    return OkStatus();
+  }
+  {
+    mutex_lock l(mu_);
+    const int64_t target = position_ + bytes_to_skip;
+    if (target >= next_offset_) {
+      // All the reads issued so far end before `target`, so their data is
+      // dropped and the next reads start at `target`, if the file gets there.
+      WaitForOutstandingReads(l);
+      buffers_.clear();
+      pos_in_front_ = 0;
+      next_offset_ = position_;
+      done_reading_ = false;
+      char scratch;
+      StringPiece data;
+      Status s = file_->Read(target - 1, 1, &data, &scratch);
+      if ((s.ok() || errors::IsOutOfRange(s)) && data.size() == 1) {
+        position_ = target;
+        next_offset_ = target;
+        return OkStatus();
+      }
+      if (!s.ok() && !errors::IsOutOfRange(s)) {
+        return s;
+      }
+      // The file ends before `target`. Reading up to its end reports the
+      // error and leaves the stream at the end of the file.
+    }
+  }
+  return ReadOrSkip(bytes_to_skip, nullptr);
+}
+
+int64_t PrefetchingInputStream::Tell() const { return position_; }
+
+Status PrefetchingInputStream::Reset() {
+  mutex_lock l(mu_);
+  WaitForOutstandingReads(l);
+  buffers_.clear();
+  pos_in_front_ = 0;
+  next_offset_ = 0;
+  read_bytes_ = buffer_bytes_;
+  done_reading_ = false;
+  position_ = 0;
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
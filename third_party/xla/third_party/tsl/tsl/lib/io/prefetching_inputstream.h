@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_PREFETCHING_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_PREFETCHING_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+
+// Reads a RandomAccessFile sequentially, keeping up to `num_buffers` reads of
+// `buffer_bytes` each in flight ahead of the reader, on `thread_pool`. By
+// default, all the streams share a bounded pool of the process, so reading
+// many files at once does not need a thread per buffer of each file.
+// Unlike BufferedInputStream, which issues one synchronous read whenever its
+// buffer runs dry, the next reads are already outstanding while the caller
+// consumes the current buffer, so a single stream can keep a fast local disk
+// busy. A single instance is NOT safe for concurrent use by multiple threads.
+//
+// If `max_buffer_bytes` is larger than `buffer_bytes`, the size of the reads
+// adapts to the file system: each time the reader has to wait for a read, the
+// reads issued next are twice as large, up to `max_buffer_bytes`. This suits
+// remote file systems such as GCS or S3, where each read is a range request
+// whose latency is only amortized by large reads, while a fast local file
+// keeps its reads of `buffer_bytes`.
+//
+// SkipNBytes() only consumes the buffered data it skips over. Past that, it
+// repositions the reads instead of reading the skipped bytes.
+class PrefetchingInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` and `thread_pool`, which must outlive
+  // *this. If `thread_pool` is null, the reads run on the shared pool.
+  PrefetchingInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                         int num_buffers, size_t max_buffer_bytes = 0,
+                         thread::ThreadPool* thread_pool = nullptr);
+
+  // Waits for the outstanding reads.
+  ~PrefetchingInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  // Drops all buffers and restarts reading at the beginning of the file.
+  Status Reset() override;
+
+ private:
+  // The result of one read of the file.
+  struct Buffer {
+    int64_t offset;
+    // The number of bytes requested. The buffer is the last one if it holds
+    // fewer bytes.
+    size_t bytes;
+    std::string data;
+    Status status;
+    bool done = false;
+  };
+
+  // Copies the next `bytes` bytes to `result` if it is not null, or skips
+  // them.
+  Status ReadOrSkip(int64_t bytes, tstring* result);
+
+  // Issues reads until `num_buffers_` are in flight or buffered.
+  void ScheduleReads() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void WaitForOutstandingReads(mutex_lock& l)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t buffer_bytes_;
+  const int num_buffers_;
+  const size_t max_buffer_bytes_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+
+  mutex mu_;
+  condition_variable cv_;
+  // The buffers in file order. The reader consumes the front buffer, starting
+  // at `pos_in_front_`.
+  std::deque<std::unique_ptr<Buffer>> buffers_ TF_GUARDED_BY(mu_);
+  size_t pos_in_front_ TF_GUARDED_BY(mu_) = 0;
+  // The file offset and the size of the next read to issue.
+  int64_t next_offset_ TF_GUARDED_BY(mu_) = 0;
+  size_t read_bytes_ TF_GUARDED_BY(mu_);
+  // Set once a read fails or returns fewer bytes than requested, after which
+  // no more reads are issued.
+  bool done_reading_ TF_GUARDED_BY(mu_) = false;
+  int num_outstanding_ TF_GUARDED_BY(mu_) = 0;
+  // The position of the reader in the file.
+  int64_t position_ = 0;
+
+  PrefetchingInputStream(const PrefetchingInputStream&) = delete;
+  void operator=(const PrefetchingInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_PREFETCHING_INPUTSTREAM_H_
@@ -0,0 +1,230 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/prefetching_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// An in-memory file whose reads take `read_micros` each, like the range
+// requests of a remote file system. Records the size of every read.
+class SlowFile : public RandomAccessFile {
+ public:
+  SlowFile(std::string contents, int64_t read_micros)
+      : contents_(std::move(contents)), read_micros_(read_micros) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    {
+      mutex_lock l(mu_);
+      read_sizes_.push_back(n);
+    }
+    Env::Default()->SleepForMicroseconds(read_micros_);
+    if (offset >= contents_.size()) {
+      *result = StringPiece();
+      return errors::OutOfRange("reached end of file");
+    }
+    const size_t size = std::min(n, contents_.size() - offset);
+    memcpy(scratch, contents_.data() + offset, size);
+    *result = StringPiece(scratch, size);
+    if (size < n) {
+      return errors::OutOfRange("reached end of file");
+    }
+    return OkStatus();
+  }
+
+  // Returns the number of bytes requested by all the reads so far.
+  size_t total_read_bytes() const {
+    mutex_lock l(mu_);
+    size_t total = 0;
+    for (size_t n : read_sizes_) total += n;
+    return total;
+  }
+
+  std::vector<size_t> read_sizes() const {
+    mutex_lock l(mu_);
+    return read_sizes_;
+  }
+
+  void clear_read_sizes() {
+    mutex_lock l(mu_);
+    read_sizes_.clear();
+  }
+
+ private:
+  const std::string contents_;
+  const int64_t read_micros_;
+  mutable mutex mu_;
+  mutable std::vector<size_t> read_sizes_ TF_GUARDED_BY(mu_);
+};
+
+std::string MakeContents(size_t size) {
+  std::string contents(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    contents[i] = 'a' + i % 26;
+  }
+  return contents;
+}
+
+TEST(PrefetchingInputStreamTest, ReadsFile) {
+  const std::string contents = MakeContents(1000);
+  SlowFile file(contents, /*read_micros=*/0);
+  for (int buffer_bytes : {1, 7, 64, 4096}) {
+    for (int num_buffers : {1, 4}) {
+      PrefetchingInputStream in(&file, buffer_bytes, num_buffers);
+      tstring read;
+      TF_ASSERT_OK(in.ReadNBytes(300, &read));
+      EXPECT_EQ(contents.substr(0, 300), read);
+      TF_ASSERT_OK(in.SkipNBytes(200));
+      EXPECT_EQ(500, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(600, &read)));
+      EXPECT_EQ(contents.substr(500), read);
+    }
+  }
+}
+
+TEST(PrefetchingInputStreamTest, SlowReadsGrowUpToMaxBufferBytes) {
+  const std::string contents = MakeContents(16384);
+  SlowFile file(contents, /*read_micros=*/1000);
+  PrefetchingInputStream in(&file, /*buffer_bytes=*/16, /*num_buffers=*/2,
+                            /*max_buffer_bytes=*/256);
+  std::string read;
+  tstring chunk;
+  while (read.size() < contents.size()) {
+    TF_ASSERT_OK(in.ReadNBytes(16, &chunk));
+    read.append(chunk.data(), chunk.size());
+  }
+  EXPECT_EQ(contents, read);
+
+  // The reader waits for every read, so each wait doubles the next reads
+  // until they stay capped at `max_buffer_bytes`. The file takes at least 64
+  // reads of 256 bytes.
+  std::vector<size_t> read_sizes = file.read_sizes();
+  ASSERT_FALSE(read_sizes.empty());
+  EXPECT_EQ(16, read_sizes.front());
+  EXPECT_EQ(256, *std::max_element(read_sizes.begin(), read_sizes.end()));
+  EXPECT_GE(std::count(read_sizes.begin(), read_sizes.end(), 256), 50);
+  for (size_t read_size : read_sizes) {
+    EXPECT_TRUE(read_size == 16 || read_size == 32 || read_size == 64 ||
+                read_size == 128 || read_size == 256)
+        << read_size;
+  }
+
+  // Resetting the stream restarts with reads of `buffer_bytes`.
+  TF_ASSERT_OK(in.Reset());
+  file.clear_read_sizes();
+  TF_ASSERT_OK(in.ReadNBytes(16, &chunk));
+  EXPECT_EQ(contents.substr(0, 16), chunk);
+  read_sizes = file.read_sizes();
+  ASSERT_FALSE(read_sizes.empty());
+  EXPECT_EQ(16, read_sizes.front());
+}
+
+TEST(PrefetchingInputStreamTest, ReadsDoNotGrowWithoutMaxBufferBytes) {
+  const std::string contents = MakeContents(1024);
+  SlowFile file(contents, /*read_micros=*/1000);
+  PrefetchingInputStream in(&file, /*buffer_bytes=*/16, /*num_buffers=*/2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(contents.size(), &read));
+  EXPECT_EQ(contents, read);
+  for (size_t read_size : file.read_sizes()) {
+    EXPECT_EQ(16, read_size);
+  }
+}
+
+TEST(PrefetchingInputStreamTest, SkipRepositionsReads) {
+  const std::string contents = MakeContents(100000);
+  SlowFile file(contents, /*read_micros=*/0);
+  PrefetchingInputStream in(&file, /*buffer_bytes=*/16, /*num_buffers=*/2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(10, &read));
+  TF_ASSERT_OK(in.SkipNBytes(90000));
+  EXPECT_EQ(90010, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(10, &read));
+  EXPECT_EQ(contents.substr(90010, 10), read);
+  // Only the data around the two reads was read, not the skipped bytes.
+  EXPECT_LT(file.total_read_bytes(), 1000);
+
+  // Skipping within the buffered data does not read again.
+  TF_ASSERT_OK(in.SkipNBytes(3));
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(contents.substr(90023, 3), read);
+
+  // Seeking by Reset() and SkipNBytes(), as RecordReader does on restore.
+  TF_ASSERT_OK(in.Reset());
+  file.clear_read_sizes();
+  TF_ASSERT_OK(in.SkipNBytes(50000));
+  TF_ASSERT_OK(in.ReadNBytes(20, &read));
+  EXPECT_EQ(contents.substr(50000, 20), read);
+  EXPECT_LT(file.total_read_bytes(), 1000);
+}
+
+TEST(PrefetchingInputStreamTest, SkipPastEndOfFile) {
+  const std::string contents = MakeContents(1000);
+  SlowFile file(contents, /*read_micros=*/0);
+  PrefetchingInputStream in(&file, /*buffer_bytes=*/16, /*num_buffers=*/2);
+  TF_ASSERT_OK(in.SkipNBytes(1000));
+  EXPECT_EQ(1000, in.Tell());
+  tstring read;
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(1001)));
+  EXPECT_EQ(1000, in.Tell());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+}
+
+TEST(PrefetchingInputStreamTest, StreamsShareThreadPool) {
+  const std::string contents = MakeContents(1000);
+  SlowFile file(contents, /*read_micros=*/100);
+  thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/1);
+  std::vector<std::unique_ptr<PrefetchingInputStream>> streams;
+  for (int i = 0; i < 4; ++i) {
+    streams.push_back(std::make_unique<PrefetchingInputStream>(
+        &file, /*buffer_bytes=*/64, /*num_buffers=*/4,
+        /*max_buffer_bytes=*/0, &thread_pool));
+  }
+  // The streams take turns, so that their reads share the single thread.
+  std::vector<std::string> reads(streams.size());
+  tstring chunk;
+  for (int offset = 0; offset < 1000; offset += 100) {
+    for (size_t i = 0; i < streams.size(); ++i) {
+      TF_ASSERT_OK(streams[i]->ReadNBytes(100, &chunk));
+      reads[i].append(chunk.data(), chunk.size());
+    }
+  }
+  for (const std::string& read : reads) {
+    EXPECT_EQ(contents, read);
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
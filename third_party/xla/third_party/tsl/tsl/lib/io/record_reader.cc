@@ -20,10 +20,12 @@ limitations under the License.
 #include "tsl/lib/hash/crc32c.h"
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
+#include "tsl/lib/io/prefetching_inputstream.h"
 #include "tsl/lib/io/random_inputstream.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
+#include "tsl/platform/strcat.h"
 
 namespace tsl {
 namespace io {
@@ -59,7 +61,11 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.num_prefetch_buffers > 0) {
+    input_stream_.reset(new PrefetchingInputStream(
+        file, options.buffer_size, options.num_prefetch_buffers,
+        options.max_prefetch_buffer_size));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -255,6 +261,44 @@ Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   return OkStatus();
 }
 
+Status ReadRecordIndex(Env* env, const std::string& filename,
+                       std::vector<uint64>* offsets) {
+  const std::string index_filename =
+      strings::StrCat(filename, kRecordIndexSuffix);
+  uint64 index_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &index_size));
+  uint64 file_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (index_size == 0 || index_size % sizeof(uint64) != 0) {
+    return errors::DataLoss("corrupted record index ", index_filename,
+                            " of size ", index_size);
+  }
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() != index_size) {
+    return errors::DataLoss("record index ", index_filename,
+                            " changed while reading it");
+  }
+
+  offsets->resize(index_size / sizeof(uint64));
+  uint64 expected_offset = 0;
+  for (size_t i = 0; i < offsets->size(); ++i) {
+    (*offsets)[i] = core::DecodeFixed64(contents.data() + i * sizeof(uint64));
+    if ((*offsets)[i] < expected_offset) {
+      return errors::DataLoss("record index ", index_filename,
+                              " is not sorted at entry ", i);
+    }
+    expected_offset =
+        (*offsets)[i] + RecordReader::kHeaderSize + RecordReader::kFooterSize;
+  }
+  if ((*offsets)[0] != 0 || offsets->back() != file_size) {
+    return errors::DataLoss("record index ", index_filename,
+                            " does not match ", filename, " of size ",
+                            file_size);
+  }
+  return OkStatus();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <string>
+#include <vector>
+
 #include "tsl/lib/io/inputstream_interface.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/stringpiece.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "tsl/platform/types.h"
 
 namespace tsl {
+class Env;
 class RandomAccessFile;
 
 namespace io {
@@ -46,6 +50,17 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If positive, and buffer_size is non-zero, up to this many reads of
+  // buffer_size bytes are issued ahead of the reader in the background, so
+  // that reading the file overlaps with consuming the records. The same
+  // restrictions as for buffer_size apply.
+  int num_prefetch_buffers = 0;
+
+  // If larger than buffer_size, the reads issued ahead of the reader grow up
+  // to this many bytes while the reader has to wait for them (see
+  // PrefetchingInputStream), e.g. for files on GCS or S3.
+  int64_t max_prefetch_buffer_size = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -128,6 +143,19 @@ class RecordReader {
   void operator=(const RecordReader&) = delete;
 };
 
+// The record index of an uncompressed TFRecord file is a sidecar file, named
+// by appending kRecordIndexSuffix to the TFRecord file name, that holds the
+// fixed64 offset of every record followed by the size of the TFRecord file.
+// RecordWriter writes it if RecordWriterOptions::index_file is set.
+inline constexpr char kRecordIndexSuffix[] = ".idx";
+
+// Reads the record index of the TFRecord file "filename" into "*offsets", so
+// that record i starts at (*offsets)[i] and offsets->back() is the size of the
+// file. Returns NOT_FOUND if the file has no index, and DATA_LOSS if the index
+// does not match the file.
+Status ReadRecordIndex(Env* env, const std::string& filename,
+                       std::vector<uint64>* offsets);
+
 // High-level interface to read TFRecord files.
 //
 // Note: this class is not thread safe; external synchronization required.
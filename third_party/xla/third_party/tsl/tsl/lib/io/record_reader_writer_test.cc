@@ -162,6 +162,105 @@ TEST(RecordReaderWriterTest, TestBasics) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestPrefetching) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_prefetch_test";
+  std::vector<string> records;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 100; ++i) {
+      records.push_back(string(i * 7 % 300, 'a' + i % 26));
+      TF_EXPECT_OK(writer.WriteRecord(records.back()));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (int buf_size : {1, 7, 64, 4096, 65536}) {
+    for (int num_buffers : {1, 4}) {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.buffer_size = buf_size;
+      options.num_prefetch_buffers = num_buffers;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      for (int i = 0; i < 50; ++i) {
+        TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(records[i], record);
+      }
+      int num_skipped = 0;
+      TF_ASSERT_OK(reader.SkipRecords(&offset, 25, &num_skipped));
+      EXPECT_EQ(25, num_skipped);
+      for (int i = 75; i < 100; ++i) {
+        TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(records[i], record);
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+
+      // Computing the metadata restarts from the beginning of the file.
+      io::RecordReader::Metadata md;
+      TF_ASSERT_OK(reader.GetMetadata(&md));
+      EXPECT_EQ(100, md.stats.entries);
+      EXPECT_EQ(GetFileSize(fname), md.stats.file_size);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestRecordIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  std::vector<string> records = {"abc", "", "defg", string(1000, 'x')};
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(
+        env->NewWritableFile(fname + io::kRecordIndexSuffix, &index_file));
+    io::RecordWriterOptions options;
+    options.index_file = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  std::vector<uint64> offsets;
+  TF_ASSERT_OK(io::ReadRecordIndex(env, fname, &offsets));
+  ASSERT_EQ(records.size() + 1, offsets.size());
+  EXPECT_EQ(GetFileSize(fname), offsets.back());
+
+  // Read the records in reverse order, seeking with the index.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  for (int i = records.size() - 1; i >= 0; --i) {
+    uint64 offset = offsets[i];
+    tstring record;
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+    EXPECT_EQ(offsets[i + 1], offset);
+  }
+
+  // The index no longer matches once the file changes.
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewAppendableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("hij"));
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  EXPECT_TRUE(errors::IsDataLoss(io::ReadRecordIndex(env, fname, &offsets)));
+  EXPECT_TRUE(errors::IsNotFound(
+      io::ReadRecordIndex(env, fname + "_missing", &offsets)));
+}
+
 TEST(RecordReaderWriterTest, TestSkipBasic) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_skip_basic_test";
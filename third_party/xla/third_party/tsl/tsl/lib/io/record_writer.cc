@@ -85,6 +85,13 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 #endif
+  if (options.index_file != nullptr) {
+    if (options.compression_type == RecordWriterOptions::NONE) {
+      index_dest_ = options.index_file;
+    } else {
+      LOG(ERROR) << "Record indexes are only written for uncompressed files.";
+    }
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -110,6 +117,7 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
+  TF_RETURN_IF_ERROR(AppendToIndex(data.size()));
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -130,14 +138,30 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   char footer[kFooterSize];
   PopulateHeader(header, data);
   PopulateFooter(footer, data);
+  TF_RETURN_IF_ERROR(AppendToIndex(data.size()));
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
 }
 #endif
 
+Status RecordWriter::AppendToIndex(size_t n) {
+  if (index_dest_ == nullptr) return OkStatus();
+  char entry[sizeof(uint64)];
+  core::EncodeFixed64(entry, offset_);
+  offset_ += kHeaderSize + n + kFooterSize;
+  return index_dest_->Append(StringPiece(entry, sizeof(entry)));
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
+  if (index_dest_ != nullptr) {
+    // The index ends with the size of the file.
+    char entry[sizeof(uint64)];
+    core::EncodeFixed64(entry, offset_);
+    TF_RETURN_IF_ERROR(index_dest_->Append(StringPiece(entry, sizeof(entry))));
+    index_dest_ = nullptr;
+  }
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
@@ -48,6 +48,13 @@ struct RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If set, the record index of the file (see kRecordIndexSuffix in
+  // record_reader.h) is appended to "*index_file", which must be initially
+  // empty and remain live while the writer is in use. The index is complete
+  // once the writer is closed. Ignored for compressed files, whose records
+  // can't be read at an offset.
+  WritableFile* index_file = nullptr;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
@@ -111,8 +118,15 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends the offset of a record of "n" bytes to the index, if any.
+  Status AppendToIndex(size_t n);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // The file that the record index is appended to, or nullptr.
+  WritableFile* index_dest_ = nullptr;
+  // The offset of the next record.
+  uint64 offset_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -96,6 +96,13 @@ struct CoordinatedTaskEqual {
   }
 };
 
+// Order-independent fingerprint of a set of tasks, which can be updated one
+// task at a time.
+uint64_t AddToTasksFingerprint(uint64_t fingerprint,
+                               const CoordinatedTask& task) {
+  return fingerprint + CoordinatedTaskHash()(task);
+}
+
 // Standalone implementation of the coordination service.
 class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
  public:
@@ -144,7 +151,7 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   uint64_t GetServiceIncarnation() override;
   void StartCheckStaleness();  // Checks both heartbeat and barrier timeouts.
   void Stop(bool shut_staleness_thread = true);
-  bool ServiceHasStopped() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
+  bool ServiceHasStopped() const ABSL_SHARED_LOCKS_REQUIRED(state_mu_);
   // Report service error to a specified task.
   void ReportServiceErrorToTaskAsync(const CoordinatedTask& destination_task,
                                      absl::Status error);
@@ -166,6 +173,8 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
         "Invalid barrier result.");  // Only valid if `passed` is true.
     uint64_t deadline_in_micros = 0;
     int num_pending_tasks = 0;
+    // Fingerprint of the participating tasks, see TasksFingerprint().
+    uint64_t tasks_fingerprint = 0;
     // Specifies which tasks have called the barrier so far.
     absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
                         CoordinatedTaskEqual>
@@ -176,11 +185,11 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
                    BarrierState* barrier)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
   // Check if participating tasks are specified correctly across barrier calls.
-  bool ValidateTaskArgs(
-      const std::vector<CoordinatedTask>& tasks_args,
-      const absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
-                                CoordinatedTaskEqual>& tasks_at_barrier,
-      int64_t cluster_size);
+  // `tasks_args_fingerprint` is the fingerprint of `tasks_args`, so that each
+  // call is checked in constant time.
+  bool ValidateTaskArgs(const std::vector<CoordinatedTask>& tasks_args,
+                        uint64_t tasks_args_fingerprint,
+                        const BarrierState& barrier, int64_t cluster_size);
   bool isRecoverableJob(absl::string_view task_name) const;
 
   class TaskState {
@@ -393,10 +402,10 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
               return;
             }
           }
-          // Heartbeat check.
-          absl::Status status = absl::OkStatus();
+          // Heartbeat check. The tasks are scanned under a shared lock, so
+          // that the heartbeats of large clusters are not blocked by the scan.
           {
-            absl::MutexLock l(&state_mu_);
+            absl::ReaderMutexLock l(&state_mu_);
             for (const auto& [task_name, task_state] : cluster_state_) {
               // Skip tasks that are not registered or in error state
               if (task_state->GetState() !=
@@ -409,18 +418,39 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
                        << " stale?=" << is_stale;
               if (is_stale) {
                 stale_task_names.push_back(task_name);
-                status = MakeCoordinationError(absl::UnavailableError(
-                    absl::StrCat("Task ", task_name,
-                                 " heartbeat timeout. This indicates that the "
-                                 "remote task "
-                                 "has failed, got preempted, or crashed "
-                                 "unexpectedly. Check "
-                                 "the task logs for an earlier error to debug "
-                                 "further.")));
-                SetTaskError(task_name, status);
               }
             }
           }
+          if (!stale_task_names.empty()) {
+            absl::MutexLock l(&state_mu_);
+            if (shutting_down_) {
+              return;
+            }
+            // Skips the tasks whose state changed since the scan.
+            std::vector<absl::string_view> still_stale_task_names;
+            for (const absl::string_view task_name : stale_task_names) {
+              TaskState* task_state = cluster_state_.at(task_name).get();
+              if (task_state->GetState() ==
+                      CoordinatedTaskState::TASKSTATE_CONNECTED &&
+                  task_state->TimeSinceLastHeartbeatMs() >
+                      heartbeat_timeout_ms_) {
+                still_stale_task_names.push_back(task_name);
+              }
+            }
+            stale_task_names = std::move(still_stale_task_names);
+            for (const absl::string_view task_name : stale_task_names) {
+              const absl::Status status =
+                  MakeCoordinationError(absl::UnavailableError(
+                      absl::StrCat("Task ", task_name,
+                                   " heartbeat timeout. This indicates that "
+                                   "the remote task "
+                                   "has failed, got preempted, or crashed "
+                                   "unexpectedly. Check "
+                                   "the task logs for an earlier error to "
+                                   "debug further.")));
+              SetTaskError(task_name, status);
+            }
+          }
           // Propagate heartbeat timeout errors to other connected tasks.
           if (!stale_task_names.empty()) {
             if (!has_service_to_client_connection) {
@@ -783,7 +813,9 @@ absl::Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   const std::string task_name = GetTaskName(task);
   absl::Status s = absl::OkStatus();
   {
-    absl::MutexLock l(&state_mu_);
+    // Heartbeats only update the state of their task, which has its own lock,
+    // so that the heartbeats of different tasks are recorded concurrently.
+    absl::ReaderMutexLock l(&state_mu_);
     if (ServiceHasStopped()) {
       return MakeCoordinationError(absl::InternalError(absl::StrCat(
           "Coordination service has stopped. RecordHeartbeat() from task: ",
@@ -792,26 +824,27 @@ absl::Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
           "coordination service to shut down before the workers disconnect "
           "gracefully. Check the task leader's logs for an earlier error to "
           "debug the root cause.")));
-    } else if (!cluster_state_.contains(task_name)) {
+    }
+    const auto task_state = cluster_state_.find(task_name);
+    if (task_state == cluster_state_.end()) {
       return MakeCoordinationError(absl::InvalidArgumentError(
           absl::StrCat("Unexpected heartbeat request from task: ", task_name,
                        ". This usually implies a configuration error.")));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
+    if (!task_state->second->GetStatus().ok()) {
+      return task_state->second->GetStatus();
+    } else if (task_state->second->GetState() ==
                    CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->second->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(absl::InvalidArgumentError(absl::StrCat(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages")));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->second->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
@@ -1078,13 +1111,15 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
   // Check if caller task is participating in the barrier. If not, update
   // `barriers_` to cause subsequent calls from the same task and other tasks
   // that have already called this instance of the barrier to fail.
-  const std::string source_task_name = GetTaskName(task);
-
-  bool among_participating_tasks =
-      std::find_if(participating_tasks.begin(), participating_tasks.end(),
-                   [&](const CoordinatedTask& task) {
-                     return GetTaskName(task) == source_task_name;
-                   }) != participating_tasks.end();
+  // The participating tasks are scanned once, outside of the lock.
+  uint64_t tasks_args_fingerprint = 0;
+  bool among_participating_tasks = false;
+  for (const CoordinatedTask& participating_task : participating_tasks) {
+    tasks_args_fingerprint =
+        AddToTasksFingerprint(tasks_args_fingerprint, participating_task);
+    among_participating_tasks |= CoordinatedTaskEqual()(participating_task,
+                                                        task);
+  }
 
   if (!participating_tasks.empty() && !among_participating_tasks) {
     const std::string task_name = GetTaskName(task);
@@ -1151,6 +1186,10 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
       }
     }
     barrier->num_pending_tasks = barrier->tasks_at_barrier.size();
+    for (const auto& pending_task : barrier->tasks_at_barrier) {
+      barrier->tasks_fingerprint =
+          AddToTasksFingerprint(barrier->tasks_fingerprint, pending_task.first);
+    }
 
     // Fail the barrier immediately if any tasks are already in error.
     for (const auto& pending_task : barrier->tasks_at_barrier) {
@@ -1205,7 +1244,7 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
   barrier->done_callbacks.push_back(done);
 
   // Check if task args are specified consistently across barrier calls.
-  if (!ValidateTaskArgs(participating_tasks, barrier->tasks_at_barrier,
+  if (!ValidateTaskArgs(participating_tasks, tasks_args_fingerprint, *barrier,
                         cluster_state_.size())) {
     absl::Status error =
         MakeCoordinationError(absl::InvalidArgumentError(absl::StrCat(
@@ -1319,21 +1358,13 @@ void CoordinationServiceStandaloneImpl::PassBarrier(
 bool CoordinationServiceStandaloneImpl::ValidateTaskArgs(
 
     const std::vector<CoordinatedTask>& tasks_args,
-    const absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
-                              CoordinatedTaskEqual>& tasks_at_barrier,
+    uint64_t tasks_args_fingerprint, const BarrierState& barrier,
     int64_t cluster_size) {
   if (tasks_args.empty()) {
-    return tasks_at_barrier.size() == cluster_size;
-  } else if (tasks_at_barrier.size() != tasks_args.size()) {
-    return false;
-  } else {
-    for (const auto& task : tasks_args) {
-      if (!tasks_at_barrier.contains(task)) {
-        return false;
-      }
-    }
+    return barrier.tasks_at_barrier.size() == cluster_size;
   }
-  return true;
+  return barrier.tasks_at_barrier.size() == tasks_args.size() &&
+         barrier.tasks_fingerprint == tasks_args_fingerprint;
 }
 
 void CoordinationServiceStandaloneImpl::AggregateClusterDevices() {